@@ -0,0 +1,569 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/customAllReduceUtils.h"
+#include "tensorrt_llm/common/dataType.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/common/warmStartCache.h"
+#include "tensorrt_llm/kernels/customAllReduceKernels.h"
+#include "tensorrt_llm/runtime/allReduceTuner.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/ipcUtils.h"
+#include "tensorrt_llm/runtime/ncclCommunicator.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <cxxopts.hpp>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace tc = tensorrt_llm::common;
+namespace tk = tensorrt_llm::kernels;
+
+namespace
+{
+
+using tk::AllReduceFusionOp;
+using tk::AllReduceStrategyConfig;
+using tk::AllReduceStrategyType;
+
+struct BenchmarkConfig
+{
+    nvinfer1::DataType dataType;
+    std::size_t minBytes;
+    std::size_t maxBytes;
+    SizeType32 hiddenSize;
+    std::vector<AllReduceFusionOp> fusionOps;
+    std::vector<AllReduceStrategyConfig> strategyConfigs;
+    int warmUp;
+    int numRuns;
+};
+
+// One row of the all reduce table, the times are the mean over the runs on the slowest rank, in microseconds, and
+// nullopt for the strategies that don't support the message
+struct AllReduceResult
+{
+    std::size_t messageBytes;
+    AllReduceFusionOp fusionOp;
+    AllReduceStrategyConfig strategyConfig;
+    std::map<AllReduceStrategyType, std::optional<float>> times;
+};
+
+std::vector<AllReduceStrategyType> const kStrategies{AllReduceStrategyType::NCCL, AllReduceStrategyType::ONESHOT,
+    AllReduceStrategyType::TWOSHOT, AllReduceStrategyType::NVLS};
+
+std::map<std::string, AllReduceFusionOp> const kFusionOps{{"none", AllReduceFusionOp::NONE},
+    {"residual_rms_norm", AllReduceFusionOp::RESIDUAL_RMS_NORM},
+    {"residual_rms_norm_quant_int8", AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8},
+    {"residual_rms_norm_quant_fp8", AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_FP8}};
+
+std::map<std::string, AllReduceStrategyConfig> const kStrategyConfigs{
+    {"default", static_cast<AllReduceStrategyConfig>(0)}, {"use_memcpy", AllReduceStrategyConfig::USE_MEMCPY},
+    {"push_mode", AllReduceStrategyConfig::PUSH_MODE}};
+
+template <typename T>
+std::string nameOf(std::map<std::string, T> const& names, T value)
+{
+    auto const iter = std::find_if(
+        names.begin(), names.end(), [value](auto const& name) { return name.second == value; });
+    return iter != names.end() ? iter->first : std::to_string(static_cast<int>(value));
+}
+
+std::string strategyName(AllReduceStrategyType strategy)
+{
+    switch (strategy)
+    {
+    case AllReduceStrategyType::NCCL: return "nccl";
+    case AllReduceStrategyType::ONESHOT: return "oneshot";
+    case AllReduceStrategyType::TWOSHOT: return "twoshot";
+    case AllReduceStrategyType::NVLS: return "nvls";
+    default: return std::to_string(static_cast<int>(strategy));
+    }
+}
+
+template <typename T>
+std::vector<T> parseList(std::string const& arg, std::map<std::string, T> const& names)
+{
+    std::vector<T> values;
+    std::istringstream ss{arg};
+    for (std::string token; std::getline(ss, token, ';');)
+    {
+        auto const iter = names.find(token);
+        TLLM_CHECK_WITH_INFO(iter != names.end(), "Unexpected value: " + token);
+        values.push_back(iter->second);
+    }
+    return values;
+}
+
+//! \brief Times launch on every rank and returns the mean time of a launch on the slowest rank, in microseconds.
+float timeCollective(std::function<void()> const& launch, BenchmarkConfig const& config, CudaStream const& stream,
+    tensorrt_llm::mpi::MpiComm const& comm)
+{
+    CudaEvent start{cudaEventDefault};
+    CudaEvent stop{cudaEventDefault};
+    for (int iter = 0; iter < config.warmUp; ++iter)
+    {
+        launch();
+    }
+    // Start all ranks together, so that the first launch doesn't include waiting for the other ranks
+    stream.synchronize();
+    comm.barrier();
+    stream.record(start);
+    for (int iter = 0; iter < config.numRuns; ++iter)
+    {
+        launch();
+    }
+    stream.record(stop);
+    stop.synchronize();
+    float ms{};
+    TLLM_CUDA_CHECK(cudaEventElapsedTime(&ms, start.get(), stop.get()));
+    auto const localUs = ms * 1000.f / static_cast<float>(config.numRuns);
+    float us{};
+    comm.allreduce(&localUs, &us, 1, tensorrt_llm::mpi::MpiType::kFLOAT, tensorrt_llm::mpi::MpiOp::MAX);
+    return us;
+}
+
+//! \brief The buffers of the inputs and outputs of the all reduce and of the fused residual and RMS norm.
+struct AllReduceTensors
+{
+    IBuffer::SharedPtr input;
+    IBuffer::SharedPtr output;
+    IBuffer::SharedPtr residual;
+    IBuffer::SharedPtr normWeight;
+    IBuffer::SharedPtr intermediate;
+    IBuffer::SharedPtr quantScale;
+
+    AllReduceTensors(std::size_t maxBytes, SizeType32 hiddenSize, nvinfer1::DataType dataType,
+        BufferManager const& manager)
+    {
+        auto const maxElts = maxBytes / tc::getDTypeSize(dataType);
+        input = manager.gpu(maxElts, dataType);
+        output = manager.gpu(maxElts, dataType);
+        residual = manager.gpu(maxElts, dataType);
+        intermediate = manager.gpu(maxElts, dataType);
+        normWeight = manager.gpu(hiddenSize, dataType);
+        for (auto const& buffer : {input, residual, normWeight})
+        {
+            manager.setZero(*buffer);
+        }
+        std::vector<float> const scale{1.f};
+        quantScale = manager.copyFrom(scale, MemoryType::kGPU);
+    }
+
+    void setFusionParams(tk::AllReduceParams& params, SizeType32 hiddenSize) const
+    {
+        params.fusion_params.residual_buffer = residual->data();
+        params.fusion_params.weight_buffer = normWeight->data();
+        params.fusion_params.hidden_size = hiddenSize;
+        params.fusion_params.eps = 1e-5f;
+        params.fusion_params.intermediate_buffer = intermediate->data();
+        params.fusion_params.quant_scale = bufferCast<float>(*quantScale);
+    }
+};
+
+std::vector<AllReduceResult> benchmarkAllReduce(BenchmarkConfig const& config, AllReduceBuffers const* buffers,
+    std::size_t customMaxBytes, NcclCommunicator const& nccl, BufferManager const& manager,
+    WorldConfig const& worldConfig, tensorrt_llm::mpi::MpiComm const& comm)
+{
+    auto const tpSize = worldConfig.getTensorParallelism();
+    auto const tpRank = worldConfig.getTensorParallelRank();
+    auto const& stream = manager.getStream();
+    auto const dataType = config.dataType;
+    auto const eltSize = tc::getDTypeSize(dataType);
+    AllReduceTensors const tensors{config.maxBytes, config.hiddenSize, dataType, manager};
+    auto const* commPtrs
+        = buffers ? reinterpret_cast<int32_t const*>(buffers->mAllReduceCommPtrs->data()) : nullptr;
+    // The flag must change between launches, starting above the zeroed flags
+    uint32_t flag = 0;
+
+    std::vector<AllReduceResult> results;
+    for (auto messageBytes = config.minBytes; messageBytes <= config.maxBytes; messageBytes *= 2)
+    {
+        auto const elts = messageBytes / eltSize;
+        auto inputView = IBuffer::slice(tensors.input, 0, elts);
+        auto outputView = IBuffer::slice(tensors.output, 0, elts);
+        auto intermediateView = IBuffer::slice(tensors.intermediate, 0, elts);
+        for (auto const fusionOp : config.fusionOps)
+        {
+            // The fused norm needs whole rows
+            if (fusionOp != AllReduceFusionOp::NONE && elts % config.hiddenSize != 0)
+            {
+                continue;
+            }
+            for (auto const strategyConfig : config.strategyConfigs)
+            {
+                AllReduceResult result{messageBytes, fusionOp, strategyConfig, {}};
+                for (auto const strategy : kStrategies)
+                {
+                    auto const isNccl = strategy == AllReduceStrategyType::NCCL;
+                    auto const isNvls = strategy == AllReduceStrategyType::NVLS;
+                    // The NVLS buffers are set up with TRTLLM_ALLREDUCE_NVLS on NVSwitch systems
+                    bool const nvlsMissing = isNvls
+                        && (buffers == nullptr || !buffers->mNvlsMemory
+                            || messageBytes > buffers->mNvlsMemory->getSize());
+                    if (nvlsMissing
+                        || (!isNccl
+                            && (buffers == nullptr || messageBytes > customMaxBytes
+                                || !tk::configurationSupported(strategy, elts, tpSize, dataType))))
+                    {
+                        result.times[strategy] = std::nullopt;
+                        continue;
+                    }
+                    auto const launch = [&]()
+                    {
+                        tk::AllReduceParams params{};
+                        if (isNccl)
+                        {
+                            // As the plugin does, NCCL is followed by the unfused residual and norm
+                            auto& ncclOutput = fusionOp == AllReduceFusionOp::NONE ? *outputView : *intermediateView;
+                            nccl.allReduce(*inputView, ncclOutput, stream);
+                            if (fusionOp != AllReduceFusionOp::NONE)
+                            {
+                                tensors.setFusionParams(params, config.hiddenSize);
+                                params.local_output_buffer_ptr = outputView->data();
+                                params.elts_total = elts;
+                                tk::residualRmsNorm(params, dataType, stream.get(), fusionOp);
+                            }
+                            return;
+                        }
+                        params = tk::AllReduceParams::deserialize(commPtrs, tpSize, tpRank, ++flag);
+                        params.local_input_buffer_ptr = inputView->data();
+                        params.local_output_buffer_ptr = outputView->data();
+                        params.elts_total = elts;
+                        if (isNvls)
+                        {
+                            // As the plugin does, the NVLS all reduce is followed by the unfused residual and norm
+                            params.nvls_unicast_ptr = buffers->mNvlsMemory->getUnicastPtr();
+                            params.nvls_multicast_ptr = buffers->mNvlsMemory->getMulticastPtr();
+                            if (fusionOp != AllReduceFusionOp::NONE)
+                            {
+                                params.local_output_buffer_ptr = intermediateView->data();
+                            }
+                            tk::customNvlsAllReduce(params, dataType, stream.get());
+                            if (fusionOp != AllReduceFusionOp::NONE)
+                            {
+                                tensors.setFusionParams(params, config.hiddenSize);
+                                params.local_output_buffer_ptr = outputView->data();
+                                tk::residualRmsNorm(params, dataType, stream.get(), fusionOp);
+                            }
+                            return;
+                        }
+                        if (fusionOp != AllReduceFusionOp::NONE)
+                        {
+                            tensors.setFusionParams(params, config.hiddenSize);
+                        }
+                        tk::customAllReduce(params, dataType, strategy, strategyConfig, fusionOp, stream.get());
+                    };
+                    // The strategy configs only apply to the custom kernels, NCCL is timed with the first one
+                    if (isNccl && strategyConfig != config.strategyConfigs.front())
+                    {
+                        result.times[strategy] = results.back().times.at(strategy);
+                        continue;
+                    }
+                    try
+                    {
+                        result.times[strategy] = timeCollective(launch, config, stream, comm);
+                    }
+                    catch (std::exception const& e)
+                    {
+                        // The checks of the kernels only depend on the message, so all ranks skip it together
+                        TLLM_LOG_WARNING("Skipping %s for %zu bytes: %s", strategyName(strategy).c_str(), messageBytes,
+                            e.what());
+                        result.times[strategy] = std::nullopt;
+                    }
+                }
+                results.push_back(result);
+            }
+        }
+    }
+    return results;
+}
+
+struct SendRecvResult
+{
+    std::size_t messageBytes;
+    float us;
+};
+
+//! \brief Times NcclCommunicator::send and receive between the pairs of ranks 2i and 2i + 1.
+std::vector<SendRecvResult> benchmarkSendRecv(BenchmarkConfig const& config, NcclCommunicator const& nccl,
+    BufferManager const& manager, WorldConfig const& worldConfig, tensorrt_llm::mpi::MpiComm const& comm)
+{
+    auto const rank = worldConfig.getTensorParallelRank();
+    auto const size = worldConfig.getTensorParallelism();
+    auto const& stream = manager.getStream();
+    auto buffer = manager.gpu(config.maxBytes, nvinfer1::DataType::kINT8);
+    manager.setZero(*buffer);
+
+    std::vector<SendRecvResult> results;
+    for (auto messageBytes = config.minBytes; messageBytes <= config.maxBytes; messageBytes *= 2)
+    {
+        auto view = IBuffer::slice(buffer, 0, messageBytes);
+        auto const launch = [&]()
+        {
+            // An odd last rank has no peer
+            if (rank % 2 == 0 && rank + 1 < size)
+            {
+                nccl.send(*view, rank + 1, stream);
+            }
+            else if (rank % 2 == 1)
+            {
+                nccl.receive(*view, rank - 1, stream);
+            }
+        };
+        results.push_back({messageBytes, timeCollective(launch, config, stream, comm)});
+    }
+    return results;
+}
+
+//! \brief The fastest strategy by message size, merged into the crossover table setupAllReduceStrategyTable loads.
+std::vector<tk::AllReduceStrategyCrossover> getCrossoverTable(
+    std::vector<AllReduceResult> const& results, BenchmarkConfig const& config)
+{
+    std::vector<tk::AllReduceStrategyCrossover> table;
+    for (auto const& result : results)
+    {
+        // The plugins run the AUTO strategy without fusion and with the default config
+        if (result.fusionOp != AllReduceFusionOp::NONE || result.strategyConfig != config.strategyConfigs.front())
+        {
+            continue;
+        }
+        auto best = AllReduceStrategyType::NCCL;
+        auto bestUs = std::numeric_limits<float>::infinity();
+        for (auto const& [strategy, us] : result.times)
+        {
+            if (us && *us < bestUs)
+            {
+                best = strategy;
+                bestUs = *us;
+            }
+        }
+        if (!table.empty() && table.back().strategy == best)
+        {
+            table.back().max_message_bytes = result.messageBytes;
+        }
+        else
+        {
+            table.push_back({result.messageBytes, best});
+        }
+    }
+    return table;
+}
+
+void printResults(std::ostream& os, std::vector<AllReduceResult> const& allReduceResults,
+    std::vector<SendRecvResult> const& sendRecvResults, SizeType32 tpSize)
+{
+    os << "collective,bytes,fusion_op,strategy_config";
+    for (auto const strategy : kStrategies)
+    {
+        os << "," << strategyName(strategy) << "_us";
+    }
+    os << ",best,best_bus_bw_gbps\n";
+    for (auto const& result : allReduceResults)
+    {
+        os << "allreduce," << result.messageBytes << "," << nameOf(kFusionOps, result.fusionOp) << ","
+           << nameOf(kStrategyConfigs, result.strategyConfig);
+        std::optional<AllReduceStrategyType> best;
+        for (auto const strategy : kStrategies)
+        {
+            auto const& us = result.times.at(strategy);
+            os << "," << (us ? std::to_string(*us) : "");
+            if (us && (!best || *us < *result.times.at(*best)))
+            {
+                best = strategy;
+            }
+        }
+        // The bus bandwidth of an all reduce, as nccl-tests reports it
+        auto const busBytes = 2.0 * (tpSize - 1) / tpSize * static_cast<double>(result.messageBytes);
+        os << "," << (best ? strategyName(*best) : "") << ","
+           << (best ? std::to_string(busBytes / *result.times.at(*best) / 1e3) : "") << "\n";
+    }
+    for (auto const& result : sendRecvResults)
+    {
+        os << "sendrecv," << result.messageBytes << ",,," << std::to_string(result.us) << ",,,,nccl,"
+           << std::to_string(static_cast<double>(result.messageBytes) / result.us / 1e3) << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options("TensorRT-LLM All Reduce Benchmark",
+        "Times the custom all reduce kernels and NCCL over the ranks of the MPI world, with the buffers of the "
+        "runtime.");
+    options.add_options()("h,help", "Print usage");
+    options.add_options()("dtype", "Data type of the messages: float, half or bfloat16.",
+        cxxopts::value<std::string>()->default_value("half"));
+    options.add_options()(
+        "min_bytes", "Smallest message size in bytes.", cxxopts::value<std::size_t>()->default_value("4096"));
+    options.add_options()("max_bytes", "Largest message size in bytes, the sizes are the powers of two in between.",
+        cxxopts::value<std::size_t>()->default_value("67108864"));
+    options.add_options()("hidden_size", "Hidden size of the fused residual and RMS norm.",
+        cxxopts::value<SizeType32>()->default_value("4096"));
+    options.add_options()("fusion_ops",
+        "Fusion ops separated by \";\": none, residual_rms_norm, residual_rms_norm_quant_int8 and "
+        "residual_rms_norm_quant_fp8.",
+        cxxopts::value<std::string>()->default_value("none;residual_rms_norm"));
+    options.add_options()("strategy_configs",
+        "Configs of the custom all reduce separated by \";\": default, use_memcpy and push_mode. The crossover "
+        "table is built from the first one.",
+        cxxopts::value<std::string>()->default_value("default"));
+    options.add_options()(
+        "warm_up", "Warm up launches before the timed ones.", cxxopts::value<int>()->default_value("5"));
+    options.add_options()("num_runs", "Timed launches per message.", cxxopts::value<int>()->default_value("20"));
+    options.add_options()("skip_send_recv", "Don't time NcclCommunicator send and receive.");
+    options.add_options()("output_csv", "Write the table to this file as well.", cxxopts::value<std::string>());
+    options.add_options()("store_table",
+        "Store the crossover table in the warm-start cache given by TRTLLM_WARM_START_CACHE_DIR, where the runtime "
+        "loads it instead of tuning with TRTLLM_ALLREDUCE_AUTOTUNE.");
+    options.add_options()("log_level", "Choose log level between verbose/info/warning/error.",
+        cxxopts::value<std::string>()->default_value("error"));
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help"))
+    {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    auto const logLevel = result["log_level"].as<std::string>();
+    auto* logger = tc::Logger::getLogger();
+    if (logLevel == "verbose")
+    {
+        logger->setLevel(tc::Logger::TRACE);
+    }
+    else if (logLevel == "info")
+    {
+        logger->setLevel(tc::Logger::INFO);
+    }
+    else if (logLevel == "warning")
+    {
+        logger->setLevel(tc::Logger::WARNING);
+    }
+    else if (logLevel == "error")
+    {
+        logger->setLevel(tc::Logger::ERROR);
+    }
+    else
+    {
+        TLLM_LOG_ERROR("Unexpected log level: " + logLevel);
+        return 1;
+    }
+
+    std::map<std::string, nvinfer1::DataType> const dataTypes{{"float", nvinfer1::DataType::kFLOAT},
+        {"half", nvinfer1::DataType::kHALF}, {"bfloat16", nvinfer1::DataType::kBF16}};
+    auto const dataTypeArg = result["dtype"].as<std::string>();
+    if (dataTypes.count(dataTypeArg) == 0)
+    {
+        TLLM_LOG_ERROR("Unexpected dtype: " + dataTypeArg);
+        return 1;
+    }
+
+    BenchmarkConfig config{};
+    config.dataType = dataTypes.at(dataTypeArg);
+    config.minBytes = result["min_bytes"].as<std::size_t>();
+    config.maxBytes = result["max_bytes"].as<std::size_t>();
+    config.hiddenSize = result["hidden_size"].as<SizeType32>();
+    config.fusionOps = parseList(result["fusion_ops"].as<std::string>(), kFusionOps);
+    config.strategyConfigs = parseList(result["strategy_configs"].as<std::string>(), kStrategyConfigs);
+    config.warmUp = result["warm_up"].as<int>();
+    config.numRuns = result["num_runs"].as<int>();
+    TLLM_CHECK_WITH_INFO(config.minBytes > 0 && config.minBytes <= config.maxBytes, "Invalid message sizes");
+    TLLM_CHECK_WITH_INFO(!config.strategyConfigs.empty(), "At least one strategy config is needed");
+
+    try
+    {
+        SizeType32 deviceCount{0};
+        TLLM_CUDA_CHECK(cudaGetDeviceCount(&deviceCount));
+        auto const worldConfig = WorldConfig::mpi(deviceCount);
+        auto const& comm = COMM_SESSION;
+        auto const tpSize = worldConfig.getTensorParallelism();
+        auto const tpRank = worldConfig.getTensorParallelRank();
+        TLLM_CHECK_WITH_INFO(tpSize > 1, "The benchmark needs at least two ranks, launch it with mpirun");
+
+        auto stream = std::make_shared<CudaStream>();
+        BufferManager const manager{stream};
+        NcclCommunicator const nccl{tpSize, tpRank, comm};
+
+        // The custom all reduce shares the buffers of the ranks of a node, a larger world only runs NCCL
+        std::unique_ptr<AllReduceBuffers> buffers;
+        std::size_t customMaxBytes{0};
+        if (tpSize <= worldConfig.getGpusPerNode())
+        {
+            auto const eltsPerToken = static_cast<std::size_t>(config.hiddenSize) * sizeof(float);
+            auto const maxTokens = static_cast<SizeType32>((config.maxBytes + eltsPerToken - 1) / eltsPerToken);
+            buffers = std::make_unique<AllReduceBuffers>(maxTokens, 1, 1, config.hiddenSize, manager, worldConfig);
+            customMaxBytes = std::min(config.maxBytes,
+                tensorrt_llm::utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(tpSize));
+        }
+
+        auto const allReduceResults
+            = benchmarkAllReduce(config, buffers.get(), customMaxBytes, nccl, manager, worldConfig, comm);
+        auto const sendRecvResults = result.count("skip_send_recv")
+            ? std::vector<SendRecvResult>{}
+            : benchmarkSendRecv(config, nccl, manager, worldConfig, comm);
+        auto const table = getCrossoverTable(allReduceResults, config);
+
+        if (tpRank == 0)
+        {
+            printResults(std::cout, allReduceResults, sendRecvResults, tpSize);
+            if (result.count("output_csv"))
+            {
+                std::ofstream csv{result["output_csv"].as<std::string>()};
+                printResults(csv, allReduceResults, sendRecvResults, tpSize);
+            }
+
+            std::cout << "\nCrossover table over " << tpSize << " ranks:\n";
+            for (auto const& entry : table)
+            {
+                std::cout << "  up to " << entry.max_message_bytes << " bytes: " << strategyName(entry.strategy)
+                          << "\n";
+            }
+            if (result.count("store_table"))
+            {
+                auto const& cache = tc::WarmStartCache::getInstance();
+                TLLM_CHECK_WITH_INFO(cache.isEnabled(), "--store_table needs TRTLLM_WARM_START_CACHE_DIR");
+                cache.store(getAllReduceStrategyCacheKey(tpSize), table.data(),
+                    table.size() * sizeof(tk::AllReduceStrategyCrossover));
+                std::cout << "Stored the crossover table in the warm-start cache\n";
+            }
+        }
+        stream->synchronize();
+        comm.barrier();
+    }
+    catch (std::exception const& e)
+    {
+        TLLM_LOG_ERROR(e.what());
+        return 1;
+    }
+    return 0;
+}
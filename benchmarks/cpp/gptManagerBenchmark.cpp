@@ -27,18 +27,25 @@
 #include "tensorrt_llm/plugins/api/tllmPlugin.h"
 #include "tensorrt_llm/runtime/common.h"
 #include "tensorrt_llm/runtime/gptJsonConfig.h"
+#include "tensorrt_llm/runtime/offlineRunner.h"
+#include "tensorrt_llm/runtime/startupProfiler.h"
 #include "tensorrt_llm/runtime/tllmLogger.h"
 #include "tensorrt_llm/runtime/utils/numpyUtils.h"
 #include "tensorrt_llm/runtime/worldConfig.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <cxxopts.hpp>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <numeric>
 #include <optional>
+#include <queue>
 #include <random>
 #include <string>
 #include <thread>
@@ -62,7 +69,6 @@ class LoraLib
 public:
     LoraLib(std::string const& loraDir)
         : mLoraDir(loraDir)
-        , mBufferManager(std::make_shared<CudaStream>())
         , mTaskPaths(parseDirPaths(mLoraDir))
         , mLoras(readLoras(mTaskPaths))
     {
@@ -90,7 +96,6 @@ public:
 
 private:
     std::string const mLoraDir;
-    BufferManager mBufferManager;
     std::map<uint64_t, fs::path> mTaskPaths;
     std::map<uint64_t, std::pair<TensorPtr, TensorPtr>> mLoras;
 
@@ -99,10 +104,8 @@ private:
         std::map<uint64_t, std::pair<TensorPtr, TensorPtr>> loras;
         for (auto const& [id, p] : taskPaths)
         {
-            TensorPtr loraWeights
-                = utils::loadNpy(mBufferManager, (p / "model.lora_weights.npy").string(), MemoryType::kCPU);
-            TensorPtr loraConfig
-                = utils::loadNpy(mBufferManager, (p / "model.lora_config.npy").string(), MemoryType::kCPU);
+            TensorPtr loraWeights = utils::mapNpy((p / "model.lora_weights.npy").string());
+            TensorPtr loraConfig = utils::mapNpy((p / "model.lora_config.npy").string());
             loras.insert_or_assign(id, std::make_pair(loraWeights, loraConfig));
         }
         return loras;
@@ -151,6 +154,15 @@ struct BenchmarkParams
     bool enableExpDelays{false};
     std::optional<float> requestRate{std::nullopt};
     int randomSeed = 430;
+
+    // Service level objectives, a request meets them if its time to first token and time per output token are below
+    std::optional<float> ttftSlo{std::nullopt}; // millisecond
+    std::optional<float> tpotSlo{std::nullopt}; // millisecond
+    // Sweep of the request rate, from requestRate in steps of requestRateSweepStep while the fraction of the requests
+    // meeting the SLOs is at least sloAttainmentTarget
+    std::optional<float> requestRateSweepStep{std::nullopt};
+    float sloAttainmentTarget{0.9F};
+    int requestRateSweepMaxSteps{20};
     std::optional<int> maxAttentionWindow{std::nullopt};
 
     // lora / peft params
@@ -164,6 +176,13 @@ struct BenchmarkParams
 
     // Weights offloading
     float gpuWeightsPercent{1.0};
+
+    // Startup breakdown and time to the first servable request, also written to startupReportJson if not empty
+    bool reportStartup{false};
+    std::string startupReportJson;
+
+    // Offline run of the whole dataset, ordered and packed by predicted length and shared prefixes
+    bool offlinePacking{false};
 };
 
 class InferenceRequestsSyncSend
@@ -397,6 +416,25 @@ public:
         mStart = std::chrono::steady_clock::now();
     }
 
+    //! \brief Sets the SLOs in milliseconds for the goodput. Without streaming, the time to first token is the latency.
+    void setSlo(std::optional<float> ttftSlo, std::optional<float> tpotSlo)
+    {
+        TLLM_CHECK_WITH_INFO(!tpotSlo || mStreaming, "The time per output token SLO needs streaming");
+        mTtftSlo = ttftSlo;
+        mTpotSlo = tpotSlo;
+    }
+
+    [[nodiscard]] bool hasSlo() const
+    {
+        return mTtftSlo || mTpotSlo;
+    }
+
+    //! \returns The fraction of the requests that met the SLOs, requests with an error don't.
+    [[nodiscard]] float getSloAttainment() const
+    {
+        return mSloAttainment;
+    }
+
     void finalize()
     {
         mEnd = std::chrono::steady_clock::now();
@@ -575,6 +613,27 @@ public:
 
         mAvgSeqLatency = std::accumulate(reqLatencies.begin(), reqLatencies.end(), 0.F) / reqLatencies.size();
 
+        if (hasSlo())
+        {
+            int numSloMet{0};
+            int sloMetOutputTokens{0};
+            for (auto const& [reqId, reqInfo] : mRequestBenchInfos)
+            {
+                auto const ttft = mStreaming ? reqInfo.firstTokenLatency : reqInfo.latency;
+                bool const sloMet = !reqInfo.hasError && (!mTtftSlo || ttft <= mTtftSlo.value())
+                    && (!mTpotSlo || reqInfo.avgGenT2TLatency.value_or(0.F) <= mTpotSlo.value());
+                if (sloMet)
+                {
+                    ++numSloMet;
+                    sloMetOutputTokens += reqInfo.outputLength;
+                }
+            }
+            mSloAttainment = mRequestBenchInfos.empty() ? 0.F
+                                                         : static_cast<float>(numSloMet) / mRequestBenchInfos.size();
+            mSeqGoodput = numSloMet / (mTotalLatency / 1000);
+            mTokenGoodput = sloMetOutputTokens / (mTotalLatency / 1000);
+        }
+
         std::sort(reqLatencies.begin(), reqLatencies.end());
 
         mP99SeqLatency = calcPercentile(reqLatencies, 99);
@@ -621,6 +680,15 @@ public:
         printf("[BENCHMARK] seq_throughput(seq/sec) %.2f\n", mSeqThroughput);
         printf("[BENCHMARK] token_throughput(token/sec) %.2f\n\n", mTokenThroughput);
 
+        if (hasSlo())
+        {
+            printf("[BENCHMARK] slo_ttft(ms) %.2f\n", mTtftSlo.value_or(-1.F));
+            printf("[BENCHMARK] slo_tpot(ms) %.2f\n", mTpotSlo.value_or(-1.F));
+            printf("[BENCHMARK] slo_attainment %.4f\n", mSloAttainment);
+            printf("[BENCHMARK] seq_goodput(seq/sec) %.2f\n", mSeqGoodput);
+            printf("[BENCHMARK] token_goodput(token/sec) %.2f\n\n", mTokenGoodput);
+        }
+
         printf("[BENCHMARK] avg_sequence_latency(ms) %.2f\n", mAvgSeqLatency);
         printf("[BENCHMARK] max_sequence_latency(ms) %.2f\n", mMaxSeqLatency);
         printf("[BENCHMARK] min_sequence_latency(ms) %.2f\n", mMinSeqLatency);
@@ -665,6 +733,13 @@ public:
 
                 headers.insert(headers.end(), streamingHeaders.begin(), streamingHeaders.end());
             }
+            if (hasSlo())
+            {
+                std::vector<std::string> sloHeaders = {"slo_ttft(ms)", "slo_tpot(ms)", "slo_attainment",
+                    "seq_goodput(seq/sec)", "token_goodput(token/sec)"};
+
+                headers.insert(headers.end(), sloHeaders.begin(), sloHeaders.end());
+            }
 
             std::ofstream outputFile(mOpCsvFile);
 
@@ -685,6 +760,11 @@ public:
                                << mAvgGenT2TLatency << "," << mMaxGenT2TLatency << "," << mMinGenT2TLatency << ","
                                << mP99GenT2TLatency << "," << mP90GenT2TLatency << "," << mP50GenT2TLatency;
                 }
+                if (hasSlo())
+                {
+                    outputFile << "," << mTtftSlo.value_or(-1.F) << "," << mTpotSlo.value_or(-1.F) << ","
+                               << mSloAttainment << "," << mSeqGoodput << "," << mTokenGoodput;
+                }
 
                 outputFile << "\n";
             }
@@ -749,6 +829,11 @@ private:
     float mP50GenT2TLatency{};
     float mMaxGenT2TLatency{};
     float mMinGenT2TLatency{};
+    std::optional<float> mTtftSlo{};
+    std::optional<float> mTpotSlo{};
+    float mSloAttainment{};
+    float mSeqGoodput{};
+    float mTokenGoodput{};
 
     std::string mOpCsvFile;
     bool mStreaming;
@@ -803,7 +888,7 @@ public:
         }
     }
 
-    void enqueue(std::vector<texec::Request> requests, bool warmup = false)
+    std::vector<texec::IdType> enqueue(std::vector<texec::Request> requests, bool warmup = false)
     {
         try
         {
@@ -824,6 +909,7 @@ public:
                 }
                 mActiveCount++;
             }
+            return reqIds;
         }
         catch (std::exception const& e)
         {
@@ -831,6 +917,49 @@ public:
         }
     }
 
+    // Runs the requests to completion in the order of the offline planner, see runtime::OfflineRunner
+    void runOffline(std::vector<texec::Request> requests, SizeType32 tokensPerBlock)
+    {
+        std::vector<SizeType32> inputLengths;
+        std::vector<SizeType32> maxNewTokens;
+        for (auto const& request : requests)
+        {
+            inputLengths.push_back(request.getInputTokenIds().size());
+            maxNewTokens.push_back(request.getMaxNewTokens());
+        }
+        OfflineRunnerConfig config;
+        config.tokensPerBlock = tokensPerBlock;
+        OfflineRunner runner{*mExecutor, config};
+        static_cast<void>(runner.run(
+            std::move(requests), std::nullopt,
+            [&](std::size_t requestIdx, texec::IdType reqId)
+            {
+                mRecorder->recordStart(inputLengths.at(requestIdx), maxNewTokens.at(requestIdx), reqId,
+                    std::chrono::steady_clock::now());
+            },
+            [this](std::size_t, texec::Response const& response)
+            {
+                if (response.hasError() || response.getResult().isFinal)
+                {
+                    mRecorder->recordEnd(response.getRequestId(), response);
+                }
+                else
+                {
+                    mRecorder->recordToken(response.getRequestId());
+                }
+            }));
+    }
+
+    void cancel(texec::IdType reqId)
+    {
+        mExecutor->cancelRequest(reqId);
+    }
+
+    void setRecorder(std::shared_ptr<Recorder> recorder)
+    {
+        mRecorder = std::move(recorder);
+    }
+
     void waitForResponses(SizeType32 numRequests, bool warmup = false)
     {
         SizeType32 numFinished = 0;
@@ -1197,6 +1326,101 @@ Samples parseWorkloadJson(
     return samples;
 }
 
+//! \brief A request of a trace, replayed at its arrival time.
+struct TraceRequest
+{
+    Sample sample;
+    //! Seconds from the start of the trace.
+    double arrivalTime;
+    //! Seconds from the start of the trace at which the request is cancelled, if it is still running.
+    std::optional<double> cancelTime;
+    texec::SamplingConfig samplingConfig;
+};
+
+using Trace = std::vector<TraceRequest>;
+
+//! \brief Parses a JSONL trace, one request per line, sorted by arrival time. The fields of a request are:
+//!   arrival_time (seconds), output_len, and either input_ids or prefix_group, prefix_len and input_len. Requests of
+//!   the same prefix group share their first prefix_len tokens, the rest of their input_len tokens is unique.
+//!   Optional: task_id (LoRA), cancel_time (seconds), beam_width, top_k, top_p, temperature, random_seed.
+Trace parseTraceJsonl(std::filesystem::path const& tracePath, int maxNumSamples,
+    std::optional<SizeType32> const maxPromptLen, SizeType32 beamWidth, SizeType32 randomSeed)
+{
+    // Token ids of synthesized prompts are drawn from [1, kSyntheticVocabSize), valid for the usual vocabularies
+    SizeType32 constexpr kSyntheticVocabSize = 32000;
+    TLLM_CHECK_WITH_INFO(std::filesystem::exists(tracePath), "File does not exist: %s", tracePath.c_str());
+    std::ifstream traceStream(tracePath);
+    std::uniform_int_distribution<TokenIdType> tokenDist(1, kSyntheticVocabSize - 1);
+
+    Trace trace;
+    std::string line;
+    for (std::size_t lineIdx = 0; std::getline(traceStream, line) && trace.size() < maxNumSamples; ++lineIdx)
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+        auto const json = nlohmann::json::parse(line);
+
+        std::vector<int32_t> inputIds;
+        if (json.contains("input_ids"))
+        {
+            inputIds = json["input_ids"].template get<std::vector<int32_t>>();
+        }
+        else
+        {
+            auto const prefixGroup = json.at("prefix_group").template get<std::uint32_t>();
+            auto const prefixLen = json.at("prefix_len").template get<SizeType32>();
+            auto const inputLen = json.at("input_len").template get<SizeType32>();
+            TLLM_CHECK_WITH_INFO(prefixLen <= inputLen, "Line %zu: prefix_len is larger than input_len.", lineIdx);
+            std::seed_seq prefixSeed{randomSeed, static_cast<SizeType32>(prefixGroup), 0};
+            std::seed_seq suffixSeed{randomSeed, static_cast<SizeType32>(lineIdx), 1};
+            std::mt19937 prefixGen(prefixSeed);
+            std::mt19937 suffixGen(suffixSeed);
+            inputIds.reserve(inputLen);
+            for (SizeType32 i = 0; i < inputLen; ++i)
+            {
+                inputIds.push_back(tokenDist(i < prefixLen ? prefixGen : suffixGen));
+            }
+        }
+        if (maxPromptLen && (inputIds.size() > maxPromptLen.value()))
+        {
+            inputIds.resize(maxPromptLen.value());
+        }
+
+        texec::SamplingConfig samplingConfig{json.value("beam_width", beamWidth)};
+        if (json.contains("top_k"))
+        {
+            samplingConfig.setTopK(json["top_k"].template get<SizeType32>());
+        }
+        if (json.contains("top_p"))
+        {
+            samplingConfig.setTopP(json["top_p"].template get<float>());
+        }
+        if (json.contains("temperature"))
+        {
+            samplingConfig.setTemperature(json["temperature"].template get<float>());
+        }
+        if (json.contains("random_seed"))
+        {
+            samplingConfig.setRandomSeed(json["random_seed"].template get<texec::RandomSeedType>());
+        }
+
+        std::optional<double> cancelTime;
+        if (json.contains("cancel_time"))
+        {
+            cancelTime = json["cancel_time"].template get<double>();
+        }
+        auto const taskId = json.value("task_id", int32_t{-1});
+        Sample sample{std::move(inputIds), json.at("output_len").template get<int32_t>(), taskId};
+        auto const arrivalTime = json.at("arrival_time").template get<double>();
+        trace.emplace_back(TraceRequest{std::move(sample), arrivalTime, cancelTime, samplingConfig});
+    }
+    std::stable_sort(trace.begin(), trace.end(),
+        [](TraceRequest const& lhs, TraceRequest const& rhs) { return lhs.arrivalTime < rhs.arrivalTime; });
+    return trace;
+}
+
 std::vector<double> generateRandomExponentialValues(int count, float lambda, int seed)
 {
     // Set a constant seed for reproducibility
@@ -1465,27 +1689,115 @@ void benchmarkGptManager(std::filesystem::path const& engineDir, TrtGptModelType
     gptServer->waitBatchManager();
 }
 
+//! \brief Enqueues the requests of trace at their arrival times, and cancels them at their cancel times.
+void replayTrace(Trace const& trace, ExecutorServer& executorServer, std::optional<int32_t> const& eosId,
+    std::optional<int32_t> const& padId, BenchmarkParams const& benchmarkParams, bool returnContextLogits,
+    bool returnGenerationLogits)
+{
+    using Clock = std::chrono::steady_clock;
+    using Cancellation = std::pair<double, texec::IdType>;
+    std::priority_queue<Cancellation, std::vector<Cancellation>, std::greater<>> cancellations;
+    std::size_t numCancelled{0};
+
+    auto const start = Clock::now();
+    auto const timePoint = [start](double seconds)
+    { return start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds)); };
+    auto const cancelUntil = [&](double until)
+    {
+        while (!cancellations.empty() && cancellations.top().first <= until)
+        {
+            std::this_thread::sleep_until(timePoint(cancellations.top().first));
+            executorServer.cancel(cancellations.top().second);
+            cancellations.pop();
+            ++numCancelled;
+        }
+    };
+
+    for (auto const& traceRequest : trace)
+    {
+        cancelUntil(traceRequest.arrivalTime);
+        std::this_thread::sleep_until(timePoint(traceRequest.arrivalTime));
+
+        auto request = makeExecutorRequest(traceRequest.sample, traceRequest.samplingConfig.getBeamWidth(), eosId,
+            padId, benchmarkParams.streaming, returnContextLogits, returnGenerationLogits,
+            traceRequest.sample.taskId >= 0 ? std::optional{texec::LoraConfig(traceRequest.sample.taskId)}
+                                            : std::nullopt);
+        request.setSamplingConfig(traceRequest.samplingConfig);
+        auto const reqIds = executorServer.enqueue({std::move(request)});
+        if (traceRequest.cancelTime)
+        {
+            cancellations.emplace(std::max(traceRequest.cancelTime.value(), traceRequest.arrivalTime), reqIds.at(0));
+        }
+    }
+    cancelUntil(std::numeric_limits<double>::infinity());
+    printf("[BENCHMARK] trace requests %zu, cancelled %zu\n", trace.size(), numCancelled);
+}
+
+void reportStartup(float executorCreationMs, float firstServableMs, std::string const& jsonPath)
+{
+    auto const& profiler = tensorrt_llm::runtime::StartupProfiler::getInstance();
+    printf("[BENCHMARK] executor creation(ms) %.2f\n", executorCreationMs);
+    printf("[BENCHMARK] time to first servable request(ms) %.2f\n", firstServableMs);
+    printf("[BENCHMARK] startup phases\n%s", profiler.report().c_str());
+    if (!jsonPath.empty())
+    {
+        nlohmann::json json;
+        json["executorCreationMs"] = executorCreationMs;
+        json["timeToFirstServableRequestMs"] = firstServableMs;
+        json["phases"] = nlohmann::json::parse(profiler.toJsonStr());
+        std::ofstream file(jsonPath);
+        TLLM_CHECK_WITH_INFO(file.is_open(), "Cannot open %s.", jsonPath.c_str());
+        file << json.dump(4) << std::endl;
+    }
+}
+
 void benchmarkExecutor(std::filesystem::path const& engineDir, TrtGptModelType modelType,
     std::string const& datasetPath, std::string const& opCsvFile, int maxNumSamples, int beamWidth, int warmUp,
     std::optional<int32_t> const& eosId, std::optional<int32_t> const& padId, BenchmarkParams const& benchmarkParams,
     texec::CapacitySchedulerPolicy capacitySchedulerPolicy, std::chrono::milliseconds waitSleep,
     bool returnContextLogits, bool returnGenerationLogits, std::optional<int> const staticEmulatedBatchSize,
-    bool logIterationData, std::optional<SizeType32> const maxPromptLen)
+    bool logIterationData, std::optional<SizeType32> const maxPromptLen, std::string const& tracePath)
 {
     auto const& world = tensorrt_llm::mpi::MpiComm::world();
     auto worldRank = world.getRank();
 
-    // Load dataset
-    auto const samples = parseWorkloadJson(datasetPath, maxNumSamples, maxPromptLen);
+    // Load dataset, or the trace to replay
+    Trace trace;
+    Samples samples;
+    if (tracePath.empty())
+    {
+        samples = parseWorkloadJson(datasetPath, maxNumSamples, maxPromptLen);
+    }
+    else
+    {
+        trace = parseTraceJsonl(tracePath, maxNumSamples, maxPromptLen, beamWidth, benchmarkParams.randomSeed);
+        std::transform(trace.begin(), trace.end(), std::back_inserter(samples),
+            [](TraceRequest const& traceRequest) { return traceRequest.sample; });
+    }
+    TLLM_CHECK_WITH_INFO(!samples.empty(), "No requests to benchmark.");
     auto const numSamples = samples.size();
 
     auto recorder = std::make_shared<Recorder>(opCsvFile, benchmarkParams.streaming, beamWidth);
 
+    auto const startupBegin = std::chrono::steady_clock::now();
     auto executorServer = std::make_shared<ExecutorServer>(engineDir, modelType, beamWidth, capacitySchedulerPolicy,
         benchmarkParams, recorder, waitSleep, staticEmulatedBatchSize, logIterationData);
+    auto const executorCreated = std::chrono::steady_clock::now();
 
     if (worldRank == 0)
     {
+        if (benchmarkParams.reportStartup)
+        {
+            // The first request pays for what is deferred to the first execution, e.g. the XQA JIT
+            std::vector<texec::Request> requests;
+            requests.emplace_back(makeExecutorRequest(Sample{samples[0].inputIds, 1, -1}, beamWidth, eosId, padId));
+            executorServer->enqueue(std::move(requests), true);
+            executorServer->waitForResponses(1, true);
+            auto const firstResponse = std::chrono::steady_clock::now();
+            reportStartup(std::chrono::duration<float, std::milli>(executorCreated - startupBegin).count(),
+                std::chrono::duration<float, std::milli>(firstResponse - startupBegin).count(),
+                benchmarkParams.startupReportJson);
+        }
         if (benchmarkParams.loraDir)
         {
             auto startLoraLoad = std::chrono::steady_clock::now();
@@ -1517,77 +1829,138 @@ void benchmarkExecutor(std::filesystem::path const& engineDir, TrtGptModelType m
         }
 
         // Benchmark
+        auto const runBenchmark = [&](BenchmarkParams const& params)
         {
-            auto timeDelays = computeTimeDelays(benchmarkParams, numSamples - 1);
+            recorder = std::make_shared<Recorder>(opCsvFile, params.streaming, beamWidth);
+            recorder->setSlo(params.ttftSlo, params.tpotSlo);
+            executorServer->setRecorder(recorder);
+            if (!trace.empty())
+            {
+                TLLM_CHECK_WITH_INFO(
+                    !staticEmulatedBatchSize, "Trace replay doesn't support emulated static batch sizes");
+                recorder->initialize();
+                std::thread waitThread(
+                    [numSamples, executorServer]() { executorServer->waitForResponses(numSamples); });
+                replayTrace(
+                    trace, *executorServer, eosId, padId, params, returnContextLogits, returnGenerationLogits);
+                waitThread.join();
+            }
+            else
+            {
+                auto timeDelays = computeTimeDelays(params, numSamples - 1);
 
-            // Create requests
-            recorder->initialize();
-            std::vector<texec::Request> requests;
+                // Create requests
+                recorder->initialize();
+                std::vector<texec::Request> requests;
 
-            for (std::size_t i = 0; i < numSamples; ++i)
-            {
-                std::optional<texec::LoraConfig> loraConfig;
-                if (samples[i].taskId >= 0)
+                for (std::size_t i = 0; i < numSamples; ++i)
                 {
-                    loraConfig = texec::LoraConfig(samples[i].taskId);
+                    std::optional<texec::LoraConfig> loraConfig;
+                    if (samples[i].taskId >= 0)
+                    {
+                        loraConfig = texec::LoraConfig(samples[i].taskId);
+                    }
+                    requests.emplace_back(makeExecutorRequest(samples[i], beamWidth, eosId, padId,
+                        params.streaming, returnContextLogits, returnGenerationLogits, loraConfig));
                 }
-                requests.emplace_back(makeExecutorRequest(samples[i], beamWidth, eosId, padId,
-                    benchmarkParams.streaming, returnContextLogits, returnGenerationLogits, loraConfig));
-            }
 
-            bool hasDelay
-                = std::any_of(timeDelays.begin(), timeDelays.end(), [](auto const& delay) { return delay > 0.0; });
-            if (hasDelay && staticEmulatedBatchSize)
-            {
-                TLLM_THROW("Executor benchmark doesn't support delays with emulated static batch sizes");
-            }
+                bool hasDelay
+                    = std::any_of(timeDelays.begin(), timeDelays.end(), [](auto const& delay) { return delay > 0.0; });
+                if (hasDelay && staticEmulatedBatchSize)
+                {
+                    TLLM_THROW("Executor benchmark doesn't support delays with emulated static batch sizes");
+                }
 
-            if (!hasDelay)
-            {
-                if (!staticEmulatedBatchSize)
+                if (!hasDelay)
                 {
-                    executorServer->enqueue(std::move(requests));
-                    executorServer->waitForResponses(numSamples);
+                    if (params.offlinePacking)
+                    {
+                        TLLM_CHECK_WITH_INFO(
+                            !staticEmulatedBatchSize, "Offline packing doesn't support emulated static batch sizes");
+                        auto const jsonConfig = GptJsonConfig::parse(engineDir / "config.json");
+                        auto const tokensPerBlock = jsonConfig.getModelConfig().getTokensPerBlock();
+                        executorServer->runOffline(std::move(requests), tokensPerBlock);
+                    }
+                    else if (!staticEmulatedBatchSize)
+                    {
+                        executorServer->enqueue(std::move(requests));
+                        executorServer->waitForResponses(numSamples);
+                    }
+                    else
+                    {
+                        SizeType32 numRequests = requests.size();
+                        SizeType32 maxBatchSize = staticEmulatedBatchSize.value();
+                        for (SizeType32 req = 0; req < numRequests; req += maxBatchSize)
+                        {
+                            auto batchSize = std::min(maxBatchSize, numRequests - req);
+
+                            std::vector<texec::Request> requestsBatch(std::make_move_iterator(requests.begin() + req),
+                                std::make_move_iterator(requests.begin() + req + batchSize));
+                            // Enqueue in batches
+                            executorServer->enqueue(std::move(requestsBatch));
+                            // Wait for current batch to be done
+                            executorServer->waitForResponses(batchSize);
+                        }
+                    }
                 }
                 else
                 {
-                    SizeType32 numRequests = requests.size();
-                    SizeType32 maxBatchSize = staticEmulatedBatchSize.value();
-                    for (SizeType32 req = 0; req < numRequests; req += maxBatchSize)
+                    // Launch a thread that will wait for responses
+                    std::thread waitThread(
+                        [numSamples, executorServer]() { executorServer->waitForResponses(numSamples); });
+                    // Enqueue requests one by one
+                    for (std::size_t i = 0; i < numSamples; ++i)
                     {
-                        auto batchSize = std::min(maxBatchSize, numRequests - req);
-
-                        std::vector<texec::Request> requestsBatch(std::make_move_iterator(requests.begin() + req),
-                            std::make_move_iterator(requests.begin() + req + batchSize));
-                        // Enqueue in batches
-                        executorServer->enqueue(std::move(requestsBatch));
-                        // Wait for current batch to be done
-                        executorServer->waitForResponses(batchSize);
+                        executorServer->enqueue({std::move(requests.at(i))});
+                        if (i < numSamples - 1)
+                        {
+                            std::this_thread::sleep_for(
+                                std::chrono::milliseconds(static_cast<int>(timeDelays.at(i) * 1000)));
+                        }
                     }
+                    waitThread.join();
                 }
             }
-            else
+            recorder->finalize();
+            recorder->calculateMetrics();
+            recorder->report();
+        };
+
+        if (!benchmarkParams.requestRateSweepStep)
+        {
+            runBenchmark(benchmarkParams);
+            recorder->writeOpMetricsToCsv();
+        }
+        else
+        {
+            // Step the request rate until the SLO attainment falls below the target, the CSV gets the metrics of the
+            // highest rate that met it
+            auto params = benchmarkParams;
+            std::shared_ptr<Recorder> sustainedRecorder;
+            std::optional<float> sustainedRate;
+            for (int step = 0; step < params.requestRateSweepMaxSteps; ++step)
             {
-                // Launch a thread that will wait for responses
-                std::thread waitThread(
-                    [numSamples, executorServer]() { executorServer->waitForResponses(numSamples); });
-                // Enqueue requests one by one
-                for (std::size_t i = 0; i < numSamples; ++i)
+                auto const requestRate = params.requestRate.value();
+                printf("[BENCHMARK] sweep request_rate(req/sec) %.2f\n", requestRate);
+                runBenchmark(params);
+                if (recorder->getSloAttainment() < params.sloAttainmentTarget)
                 {
-                    executorServer->enqueue({std::move(requests.at(i))});
-                    if (i < numSamples - 1)
-                    {
-                        std::this_thread::sleep_for(
-                            std::chrono::milliseconds(static_cast<int>(timeDelays.at(i) * 1000)));
-                    }
+                    break;
                 }
-                waitThread.join();
+                sustainedRecorder = recorder;
+                sustainedRate = requestRate;
+                params.requestRate = requestRate + params.requestRateSweepStep.value();
+            }
+            if (sustainedRecorder)
+            {
+                printf("[BENCHMARK] max_sustainable_request_rate(req/sec) %.2f\n", sustainedRate.value());
+                sustainedRecorder->writeOpMetricsToCsv();
+            }
+            else
+            {
+                printf("[BENCHMARK] no request rate met slo_attainment %.4f\n", params.sloAttainmentTarget);
             }
         }
-        recorder->finalize();
-        recorder->calculateMetrics();
-        recorder->report();
-        recorder->writeOpMetricsToCsv();
         // Send terminateReqId to terminate servers on all ranks
         // Sever on rank 0 will broadcast the terminate signal to other servers on multi-GPU cases
         // gptServer->enqueue(std::make_shared<InferenceRequest>(terminateReqId));
@@ -1608,6 +1981,10 @@ int main(int argc, char* argv[])
         cxxopts::value<std::string>()->default_value("IFB"));
     options.add_options()("dataset", "Dataset that is used for benchmarking BatchManager.",
         cxxopts::value<std::string>()->default_value(""));
+    options.add_options()("trace",
+        "JSONL trace of requests with arrival times to replay instead of the dataset. (Only works if --api is "
+        "executor)",
+        cxxopts::value<std::string>()->default_value(""));
     options.add_options()(
         "output_csv", "Write output metrics to CSV", cxxopts::value<std::string>()->default_value(""));
     options.add_options()("max_num_samples", "maximum number of samples to use from dataset/generate",
@@ -1632,11 +2009,28 @@ int main(int argc, char* argv[])
         cxxopts::value<bool>()->default_value("false"));
     options.add_options()("enable_exp_delays", "Enables exponential delay distr to mimic real world request arrival",
         cxxopts::value<bool>()->default_value("false"));
+    options.add_options()("slo_ttft_ms",
+        "Time to first token SLO in ms, reports the goodput of the requests meeting it.", cxxopts::value<float>());
+    options.add_options()("slo_tpot_ms",
+        "Time per output token SLO in ms, reports the goodput of the requests meeting it. Needs --streaming.",
+        cxxopts::value<float>());
+    options.add_options()("request_rate_sweep_step",
+        "Steps the request rate from --request_rate by this value until the SLO attainment falls below "
+        "--slo_attainment_target, and reports the highest sustained rate. (Only works if --api is executor)",
+        cxxopts::value<float>());
+    options.add_options()("slo_attainment_target", "Fraction of the requests that must meet the SLOs in the sweep.",
+        cxxopts::value<float>()->default_value("0.9"));
+    options.add_options()("request_rate_sweep_max_steps", "Maximum number of request rates of the sweep.",
+        cxxopts::value<int>()->default_value("20"));
     options.add_options()("streaming", "Operate in streaming mode", cxxopts::value<bool>()->default_value("false"));
     options.add_options()(
         "enable_kv_cache_reuse", "Enables the KV cache reuse.", cxxopts::value<bool>()->default_value("false"));
     options.add_options()("enable_chunked_context", "Whether to enable context chunking.",
         cxxopts::value<bool>()->default_value("false"));
+    options.add_options()("offline_packing",
+        "Run the whole dataset offline, ordered and packed by predicted length and shared prefixes to keep the KV "
+        "cache full. Executor API only, best with enable_kv_cache_reuse.",
+        cxxopts::value<bool>()->default_value("false"));
     options.add_options()(
         "return_context_logits", "Whether to return context logits.", cxxopts::value<bool>()->default_value("false"));
     options.add_options()("return_generation_logits", "Whether to return generation logits.",
@@ -1682,6 +2076,11 @@ int main(int argc, char* argv[])
         "max_prompt_len", "Truncate all prompts from dataset to the length specified.", cxxopts::value<SizeType32>());
 
     options.add_options()("dump_profile", "Print profile information per layer.", cxxopts::value<bool>());
+    options.add_options()("report_startup",
+        "Report the startup phases and the time to the first servable request (only works if --api is executor).",
+        cxxopts::value<bool>()->default_value("false"));
+    options.add_options()("startup_report_json", "When specified, writes the startup report to this JSON file.",
+        cxxopts::value<std::string>()->default_value(""));
     options.add_options()("gpu_weights_percent",
         "Specify the percentage of weights that reside on GPU (from 0.0 to 1.0).",
         cxxopts::value<float>()->default_value("1.0"));
@@ -1771,6 +2170,9 @@ int main(int argc, char* argv[])
     // Argument: streaming
     benchmarkParams.streaming = result["streaming"].as<bool>();
 
+    // Argument: offline packing
+    benchmarkParams.offlinePacking = result["offline_packing"].as<bool>();
+
     // Argument: request rate
     if (result.count("request_rate"))
     {
@@ -1779,6 +2181,43 @@ int main(int argc, char* argv[])
 
     benchmarkParams.enableExpDelays = result["enable_exp_delays"].as<bool>();
 
+    // Argument: SLOs and request rate sweep
+    if (result.count("slo_ttft_ms"))
+    {
+        benchmarkParams.ttftSlo = result["slo_ttft_ms"].as<float>();
+    }
+    if (result.count("slo_tpot_ms"))
+    {
+        benchmarkParams.tpotSlo = result["slo_tpot_ms"].as<float>();
+        if (!benchmarkParams.streaming)
+        {
+            TLLM_LOG_ERROR("--slo_tpot_ms needs --streaming.");
+            return 1;
+        }
+    }
+    benchmarkParams.sloAttainmentTarget = result["slo_attainment_target"].as<float>();
+    benchmarkParams.requestRateSweepMaxSteps = result["request_rate_sweep_max_steps"].as<int>();
+    if (result.count("request_rate_sweep_step"))
+    {
+        benchmarkParams.requestRateSweepStep = result["request_rate_sweep_step"].as<float>();
+        if (!benchmarkParams.ttftSlo && !benchmarkParams.tpotSlo)
+        {
+            TLLM_LOG_ERROR("--request_rate_sweep_step needs --slo_ttft_ms or --slo_tpot_ms.");
+            return 1;
+        }
+        if (!benchmarkParams.requestRate || benchmarkParams.requestRate.value() <= 0
+            || benchmarkParams.requestRateSweepStep.value() <= 0)
+        {
+            TLLM_LOG_ERROR("--request_rate_sweep_step needs a positive step and --request_rate to start from.");
+            return 1;
+        }
+        if (!result["trace"].as<std::string>().empty())
+        {
+            TLLM_LOG_ERROR("--request_rate_sweep_step can't be used with --trace, which has its own arrival times.");
+            return 1;
+        }
+    }
+
     // Argument: Enable batch stats output
     bool logIterationData = result["log_iteration_data"].as<bool>();
 
@@ -1870,6 +2309,10 @@ int main(int argc, char* argv[])
     }
     benchmarkParams.gpuWeightsPercent = gpuWeightsPercent;
 
+    // Argument: Startup report
+    benchmarkParams.startupReportJson = result["startup_report_json"].as<std::string>();
+    benchmarkParams.reportStartup = result["report_startup"].as<bool>() || !benchmarkParams.startupReportJson.empty();
+
     // Argument: Log level
     auto logger = std::make_shared<TllmLogger>();
     auto const logLevel = result["log_level"].as<std::string>();
@@ -1928,7 +2371,7 @@ int main(int argc, char* argv[])
             benchmarkExecutor(result["engine_dir"].as<std::string>(), modelType, datasetPath, opCsvFile, maxNumSamples,
                 beamWidth, result["warm_up"].as<int>(), eosId, padId, benchmarkParams, capacitySchedulerPolicy,
                 waitSleep, returnContextLogits, returnGenerationLogits, staticEmulatedBatchSize, logIterationData,
-                maxPromptLen);
+                maxPromptLen, result["trace"].as<std::string>());
         }
         catch (std::exception const& e)
         {
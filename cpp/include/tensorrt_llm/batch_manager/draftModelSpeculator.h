@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/batch_manager/kvCacheConfig.h"
+#include "tensorrt_llm/batch_manager/kvCacheManager.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Configuration of a draft model executed in the same process as the target model.
+//! \details The draft engine gets its own KV cache, typically much smaller than the one of the target model since it
+//! only needs to hold the sequences currently in flight.
+class DraftModelConfig
+{
+    using KvCacheConfig = kv_cache_manager::KvCacheConfig;
+
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+
+    explicit DraftModelConfig(std::filesystem::path engineDir, SizeType32 maxDraftLen,
+        KvCacheConfig const& kvCacheConfig = KvCacheConfig{})
+        : engineDir{std::move(engineDir)}
+        , maxDraftLen{maxDraftLen}
+        , kvCacheConfig{kvCacheConfig}
+    {
+        TLLM_CHECK_WITH_INFO(maxDraftLen > 0, "maxDraftLen must be positive.");
+    }
+
+    bool operator==(DraftModelConfig const& other) const
+    {
+        return engineDir == other.engineDir && maxDraftLen == other.maxDraftLen
+            && kvCacheConfig == other.kvCacheConfig;
+    }
+
+    std::filesystem::path engineDir;
+    //! Maximum number of tokens drafted per request and step.
+    SizeType32 maxDraftLen;
+    KvCacheConfig kvCacheConfig;
+};
+
+//! \brief Keeps the KV caches of a draft and a target model consistent across speculation steps.
+//! \details A step first runs the draft model autoregressively for numDraftTokens iterations, then verifies the draft
+//! tokens with one iteration of the target model. Both engines are enqueued on the same stream so that no
+//! synchronization is needed between drafting and verification. The draft model processes the last accepted token
+//! followed by the first numDraftTokens - 1 draft tokens, since the last draft token is never fed back. The target
+//! model processes the last accepted token and all draft tokens. After verification the KV of the rejected tokens is
+//! dropped from both caches. When all draft tokens are accepted, the KV of the last draft token is missing from the
+//! draft cache, so the draft model catches up by processing it in front of the next step.
+class DraftModelSpeculator
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+
+    //! Number of tokens to remove from the end of each KV cache after verification.
+    struct RewindLengths
+    {
+        SizeType32 draft{0};
+        SizeType32 target{0};
+    };
+
+    DraftModelSpeculator(SizeType32 maxNumSequences, SizeType32 maxDraftLen)
+        : mMaxDraftLen{maxDraftLen}
+        , mSequences(maxNumSequences)
+    {
+        TLLM_CHECK_WITH_INFO(maxDraftLen > 0, "maxDraftLen must be positive.");
+    }
+
+    void addSequence(SizeType32 seqSlotIdx, SizeType32 numDraftTokens)
+    {
+        auto& seq = getSequence(seqSlotIdx);
+        TLLM_CHECK_WITH_INFO(!seq.active, "Sequence slot %d is already in use.", seqSlotIdx);
+        seq = Sequence{};
+        seq.active = true;
+        setNumDraftTokens(seqSlotIdx, numDraftTokens);
+    }
+
+    void removeSequence(SizeType32 seqSlotIdx)
+    {
+        getSequence(seqSlotIdx) = Sequence{};
+    }
+
+    //! \brief Changes the draft length of the next steps, e.g. to follow the acceptance rate of the request.
+    void setNumDraftTokens(SizeType32 seqSlotIdx, SizeType32 numDraftTokens)
+    {
+        auto& seq = getActiveSequence(seqSlotIdx);
+        TLLM_CHECK_WITH_INFO(!seq.drafting, "Can't change the draft length of sequence %d while drafting.", seqSlotIdx);
+        TLLM_CHECK_WITH_INFO(numDraftTokens > 0 && numDraftTokens <= mMaxDraftLen,
+            "numDraftTokens (%d) must be in [1, %d].", numDraftTokens, mMaxDraftLen);
+        seq.numDraftTokens = numDraftTokens;
+    }
+
+    [[nodiscard]] SizeType32 getNumDraftTokens(SizeType32 seqSlotIdx) const
+    {
+        return getActiveSequence(seqSlotIdx).numDraftTokens;
+    }
+
+    //! \brief Starts a speculation step.
+    //! \returns Number of tokens the first draft iteration processes: the last accepted token, preceded by the last
+    //! draft token of the previous step if it hasn't been processed by the draft model yet.
+    SizeType32 beginStep(SizeType32 seqSlotIdx)
+    {
+        auto& seq = getActiveSequence(seqSlotIdx);
+        TLLM_CHECK_WITH_INFO(!seq.drafting, "Sequence %d is already drafting.", seqSlotIdx);
+        seq.drafting = true;
+        auto const numInputTokens = 1 + (seq.catchUp ? 1 : 0);
+        seq.catchUp = false;
+        return numInputTokens;
+    }
+
+    //! \brief Ends a speculation step with the verification result of the target model.
+    //! \param numAcceptedDraftTokens Number of draft tokens matching the target model, the target model contributes
+    //! one more token after them.
+    //! \returns KV rewind lengths of the draft and the target cache.
+    [[nodiscard]] RewindLengths endStep(SizeType32 seqSlotIdx, SizeType32 numAcceptedDraftTokens)
+    {
+        auto& seq = getActiveSequence(seqSlotIdx);
+        TLLM_CHECK_WITH_INFO(seq.drafting, "Sequence %d is not drafting.", seqSlotIdx);
+        TLLM_CHECK_WITH_INFO(numAcceptedDraftTokens >= 0 && numAcceptedDraftTokens <= seq.numDraftTokens,
+            "numAcceptedDraftTokens (%d) must be in [0, %d].", numAcceptedDraftTokens, seq.numDraftTokens);
+        seq.drafting = false;
+        seq.catchUp = numAcceptedDraftTokens == seq.numDraftTokens;
+
+        RewindLengths rewindLengths;
+        rewindLengths.draft = std::max(seq.numDraftTokens - 1 - numAcceptedDraftTokens, 0);
+        rewindLengths.target = seq.numDraftTokens - numAcceptedDraftTokens;
+        return rewindLengths;
+    }
+
+    //! \brief Drops the KV of the rejected tokens of a sequence from both caches.
+    static void rewindKVCaches(SizeType32 seqSlotIdx, RewindLengths const& rewindLengths,
+        kv_cache_manager::KVCacheManager& draftKvCacheManager, kv_cache_manager::KVCacheManager& targetKvCacheManager)
+    {
+        if (rewindLengths.draft > 0)
+        {
+            draftKvCacheManager.rewindKVCache(seqSlotIdx, rewindLengths.draft);
+        }
+        if (rewindLengths.target > 0)
+        {
+            targetKvCacheManager.rewindKVCache(seqSlotIdx, rewindLengths.target);
+        }
+    }
+
+    [[nodiscard]] SizeType32 getMaxDraftLen() const noexcept
+    {
+        return mMaxDraftLen;
+    }
+
+private:
+    struct Sequence
+    {
+        bool active{false};
+        bool drafting{false};
+        //! The last draft token of the previous step was accepted but never processed by the draft model.
+        bool catchUp{false};
+        SizeType32 numDraftTokens{0};
+    };
+
+    [[nodiscard]] Sequence& getSequence(SizeType32 seqSlotIdx)
+    {
+        TLLM_CHECK_WITH_INFO(seqSlotIdx >= 0 && seqSlotIdx < static_cast<SizeType32>(mSequences.size()),
+            "Sequence slot %d is out of range.", seqSlotIdx);
+        return mSequences[seqSlotIdx];
+    }
+
+    [[nodiscard]] Sequence& getActiveSequence(SizeType32 seqSlotIdx)
+    {
+        auto& seq = getSequence(seqSlotIdx);
+        TLLM_CHECK_WITH_INFO(seq.active, "Sequence slot %d is not in use.", seqSlotIdx);
+        return seq;
+    }
+
+    [[nodiscard]] Sequence const& getActiveSequence(SizeType32 seqSlotIdx) const
+    {
+        return const_cast<DraftModelSpeculator*>(this)->getActiveSequence(seqSlotIdx);
+    }
+
+    SizeType32 mMaxDraftLen;
+    std::vector<Sequence> mSequences;
+};
+
+} // namespace tensorrt_llm::batch_manager
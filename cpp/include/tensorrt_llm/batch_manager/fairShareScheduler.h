@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Capacity scheduler sharing the batch and the KV cache fairly between tenants, e.g. the LoRA adapters.
+//! \details Weighted fair queuing over the tenants: every tenant has a virtual time, the tokens it was served divided
+//! by its weight, and the tenant with the lowest virtual time admits its next request, in arrival order within the
+//! tenant. A tenant that was idle resumes at the virtual time of the busy ones, it doesn't bank credit while idle.
+//! The share of the requests and of the KV cache blocks of a tenant is bounded, so one heavy tenant can't take the
+//! whole batch. Tenants scheduled in the previous iteration are favoured by an affinity credit, so the requests of an
+//! adapter run in consecutive iterations and the adapters don't thrash in the PEFT cache. Generating requests that are
+//! not admitted are preempted, like with SloAwareScheduler.
+class FairShareScheduler
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using RequestIdType = std::uint64_t;
+    using TenantIdType = std::uint64_t;
+
+    //! The tenant of the requests without adapter
+    static TenantIdType constexpr kNO_ADAPTER = std::numeric_limits<TenantIdType>::max();
+
+    struct Config
+    {
+        SizeType32 maxNumRequests;
+        SizeType32 maxNumBlocks;
+        //! Share of the requests and of the blocks of an iteration a tenant can take at most, in (0, 1]. The first
+        //! request of a tenant is exempt from the share of the blocks, so that long requests still run.
+        float maxTenantShare{1.f};
+        //! Distinct tenants per iteration at most, e.g. the adapters the PEFT device cache holds
+        std::optional<SizeType32> maxNumTenants{std::nullopt};
+        //! Tokens a tenant of the previous iteration may be ahead of the others by and still go first
+        float tenantAffinity{256.f};
+    };
+
+    struct Candidate
+    {
+        RequestIdType requestId;
+        TenantIdType tenantId{kNO_ADAPTER};
+        //! The request has started generating and holds KV cache blocks.
+        bool inProgress{false};
+        //! KV cache blocks the request needs to run this iteration, including the ones it already holds.
+        SizeType32 requiredBlocks{0};
+        //! Tokens the request processes this iteration, which its tenant is charged for.
+        SizeType32 numTokens{1};
+    };
+
+    struct Schedule
+    {
+        std::vector<RequestIdType> scheduled;
+        //! Generating requests to pause, their blocks should be offloaded.
+        std::vector<RequestIdType> preempted;
+    };
+
+    struct Stats
+    {
+        std::uint64_t numScheduled{0};
+        std::uint64_t numPreempted{0};
+        //! Tenants scheduled in an iteration that weren't in the previous one, the adapter loads at worst
+        std::uint64_t numTenantSwitches{0};
+    };
+
+    explicit FairShareScheduler(Config const& config)
+        : mConfig{config}
+    {
+        TLLM_CHECK_WITH_INFO(mConfig.maxNumRequests > 0, "maxNumRequests must be positive.");
+        TLLM_CHECK_WITH_INFO(mConfig.maxNumBlocks >= 0, "maxNumBlocks must not be negative.");
+        TLLM_CHECK_WITH_INFO(0.f < mConfig.maxTenantShare && mConfig.maxTenantShare <= 1.f,
+            "maxTenantShare must be in (0, 1], got %f", mConfig.maxTenantShare);
+        TLLM_CHECK_WITH_INFO(!mConfig.maxNumTenants || mConfig.maxNumTenants.value() > 0,
+            "maxNumTenants must be positive.");
+        TLLM_CHECK_WITH_INFO(mConfig.tenantAffinity >= 0.f, "tenantAffinity must not be negative.");
+        mMaxTenantRequests = std::max(1, static_cast<SizeType32>(mConfig.maxTenantShare * mConfig.maxNumRequests));
+        mMaxTenantBlocks = static_cast<SizeType32>(mConfig.maxTenantShare * mConfig.maxNumBlocks);
+    }
+
+    //! \brief The tenant of a request, its LoRA task.
+    [[nodiscard]] static TenantIdType getTenantId(executor::Request const& request)
+    {
+        auto const loraConfig = request.getLoraConfig();
+        return loraConfig ? loraConfig->getTaskId() : kNO_ADAPTER;
+    }
+
+    //! \brief Sets the weight of a tenant, 1 by default. A tenant with twice the weight is served twice the tokens.
+    void setWeight(TenantIdType tenantId, float weight)
+    {
+        TLLM_CHECK_WITH_INFO(weight > 0.f, "The weight of a tenant must be positive, got %f", weight);
+        mWeights[tenantId] = weight;
+    }
+
+    [[nodiscard]] float getWeight(TenantIdType tenantId) const
+    {
+        auto const it = mWeights.find(tenantId);
+        return it != mWeights.end() ? it->second : 1.f;
+    }
+
+    //! \param candidates The requests that may run this iteration, in arrival order.
+    [[nodiscard]] Schedule schedule(std::vector<Candidate> const& candidates)
+    {
+        std::vector<TenantQueue> queues;
+        std::unordered_map<TenantIdType, std::size_t> queueIndices;
+        for (std::size_t idx = 0; idx < candidates.size(); ++idx)
+        {
+            auto const tenantId = candidates[idx].tenantId;
+            auto [it, inserted] = queueIndices.try_emplace(tenantId, queues.size());
+            if (inserted)
+            {
+                auto const weight = getWeight(tenantId);
+                auto const vtimeIt = mVirtualTimes.find(tenantId);
+                auto const vtime = std::max(vtimeIt != mVirtualTimes.end() ? vtimeIt->second : 0., mVirtualTime);
+                auto const affinity = mLastTenants.count(tenantId) != 0 ? mConfig.tenantAffinity / weight : 0.;
+                queues.push_back(TenantQueue{tenantId, weight, vtime, affinity});
+            }
+            queues[it->second].requests.push_back(idx);
+        }
+        // The generating requests of a tenant go first, they already hold their blocks
+        for (auto& queue : queues)
+        {
+            std::stable_partition(queue.requests.begin(), queue.requests.end(),
+                [&candidates](std::size_t idx) { return candidates[idx].inProgress; });
+        }
+
+        Schedule schedule;
+        SizeType32 numBlocks{0};
+        SizeType32 numTenants{0};
+        std::unordered_set<TenantIdType> scheduledTenants;
+        while (static_cast<SizeType32>(schedule.scheduled.size()) < mConfig.maxNumRequests)
+        {
+            TenantQueue* next{nullptr};
+            for (auto& queue : queues)
+            {
+                if (!queue.blocked && queue.next < queue.requests.size()
+                    && (next == nullptr || queue.getKey() < next->getKey()))
+                {
+                    next = &queue;
+                }
+            }
+            if (next == nullptr)
+            {
+                break;
+            }
+            auto const& candidate = candidates[next->requests[next->next]];
+            auto const isNewTenant = next->numRequests == 0;
+            auto const fits = numBlocks + candidate.requiredBlocks <= mConfig.maxNumBlocks
+                && next->numRequests < mMaxTenantRequests
+                && (isNewTenant || next->numBlocks + candidate.requiredBlocks <= mMaxTenantBlocks)
+                && (!isNewTenant || !mConfig.maxNumTenants || numTenants < mConfig.maxNumTenants.value());
+            if (!fits)
+            {
+                // The requests of a tenant are admitted in order
+                next->blocked = true;
+                continue;
+            }
+            numBlocks += candidate.requiredBlocks;
+            numTenants += isNewTenant ? 1 : 0;
+            ++next->numRequests;
+            next->numBlocks += candidate.requiredBlocks;
+            next->vtime += candidate.numTokens / next->weight;
+            ++next->next;
+            schedule.scheduled.push_back(candidate.requestId);
+            scheduledTenants.insert(next->tenantId);
+        }
+
+        auto minVirtualTime = std::numeric_limits<double>::max();
+        for (auto const& queue : queues)
+        {
+            for (auto idx = queue.next; idx < queue.requests.size(); ++idx)
+            {
+                if (candidates[queue.requests[idx]].inProgress)
+                {
+                    schedule.preempted.push_back(candidates[queue.requests[idx]].requestId);
+                }
+            }
+            mVirtualTimes[queue.tenantId] = queue.vtime;
+            minVirtualTime = std::min(minVirtualTime, queue.vtime);
+        }
+        if (!queues.empty())
+        {
+            mVirtualTime = std::max(mVirtualTime, minVirtualTime);
+        }
+        for (auto const tenantId : scheduledTenants)
+        {
+            mStats.numTenantSwitches += mLastTenants.count(tenantId) == 0 ? 1 : 0;
+        }
+        mLastTenants = std::move(scheduledTenants);
+
+        mStats.numScheduled += schedule.scheduled.size();
+        mStats.numPreempted += schedule.preempted.size();
+        return schedule;
+    }
+
+    //! \returns The tokens served to the tenant divided by its weight, the lowest goes first.
+    [[nodiscard]] double getVirtualTime(TenantIdType tenantId) const
+    {
+        auto const it = mVirtualTimes.find(tenantId);
+        return std::max(it != mVirtualTimes.end() ? it->second : 0., mVirtualTime);
+    }
+
+    //! \brief Forgets a tenant that won't come back, e.g. an unloaded adapter.
+    void removeTenant(TenantIdType tenantId)
+    {
+        mWeights.erase(tenantId);
+        mVirtualTimes.erase(tenantId);
+        mLastTenants.erase(tenantId);
+    }
+
+    [[nodiscard]] Stats const& getStats() const noexcept
+    {
+        return mStats;
+    }
+
+private:
+    struct TenantQueue
+    {
+        TenantIdType tenantId;
+        float weight;
+        double vtime;
+        //! Affinity credit in virtual time, for the tenants of the previous iteration
+        double affinity;
+        //! Indices of the candidates of the tenant
+        std::vector<std::size_t> requests{};
+        std::size_t next{0};
+        SizeType32 numRequests{0};
+        SizeType32 numBlocks{0};
+        bool blocked{false};
+
+        [[nodiscard]] double getKey() const noexcept
+        {
+            return vtime - affinity;
+        }
+    };
+
+    Config mConfig;
+    SizeType32 mMaxTenantRequests;
+    SizeType32 mMaxTenantBlocks;
+    std::unordered_map<TenantIdType, float> mWeights;
+    std::unordered_map<TenantIdType, double> mVirtualTimes;
+    //! Virtual time of the least served busy tenant, where idle tenants resume
+    double mVirtualTime{0.};
+    std::unordered_set<TenantIdType> mLastTenants;
+    Stats mStats;
+};
+
+} // namespace tensorrt_llm::batch_manager
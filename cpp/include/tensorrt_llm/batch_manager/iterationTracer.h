@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Phases of an executor iteration recorded by the IterationTracer.
+enum class TracePhase : std::uint8_t
+{
+    kITERATION = 0,
+    kSCHEDULING = 1,
+    kKV_CACHE_ALLOCATION = 2,
+    kFORWARD_ENQUEUE = 3,
+    kDECODER = 4,
+    kRESPONSE_DISPATCH = 5,
+    kLORA_LOAD = 6,
+    kKV_CACHE_OFFLOAD = 7,
+};
+
+[[nodiscard]] inline char const* toString(TracePhase phase) noexcept
+{
+    switch (phase)
+    {
+    case TracePhase::kITERATION: return "iteration";
+    case TracePhase::kSCHEDULING: return "scheduling";
+    case TracePhase::kKV_CACHE_ALLOCATION: return "kv_cache_allocation";
+    case TracePhase::kFORWARD_ENQUEUE: return "forward_enqueue";
+    case TracePhase::kDECODER: return "decoder";
+    case TracePhase::kRESPONSE_DISPATCH: return "response_dispatch";
+    case TracePhase::kLORA_LOAD: return "lora_load";
+    case TracePhase::kKV_CACHE_OFFLOAD: return "kv_cache_offload";
+    }
+    return "unknown";
+}
+
+//! \brief Requests and tokens scheduled in an iteration.
+struct BatchComposition
+{
+    runtime::SizeType32 numContextRequests{0};
+    runtime::SizeType32 numGenerationRequests{0};
+    runtime::SizeType32 numContextTokens{0};
+    runtime::SizeType32 numGenerationTokens{0};
+};
+
+//! \brief Always-on, fixed size timeline of the phases of the executor iterations.
+//! \details Events go into a ring buffer of a fixed capacity, so that recording doesn't allocate and the memory is
+//! bounded, the oldest events are overwritten. The timeline is written in the Chrome trace event format, which
+//! chrome://tracing and Perfetto open, either on demand or by the slow iteration callback, which gets the timeline
+//! whenever an iteration takes longer than the threshold. Events may be recorded from any thread, e.g. by the
+//! workers that load LoRA weights or offload KV cache blocks, they are attributed to the current iteration.
+class IterationTracer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using SlowIterationCallback = std::function<void(std::uint64_t iteration, std::string const& chromeTrace)>;
+
+    static constexpr std::size_t kDefaultCapacity = 1 << 16;
+
+    struct Event
+    {
+        TracePhase phase{TracePhase::kITERATION};
+        std::uint64_t iteration{0};
+        Clock::time_point start;
+        Clock::duration duration{};
+        std::size_t threadId{0};
+        //! Only set for kITERATION events
+        BatchComposition batch;
+    };
+
+    //! \brief Records the duration of a phase from its construction to its destruction.
+    class ScopedEvent
+    {
+    public:
+        ScopedEvent(IterationTracer& tracer, TracePhase phase)
+            : mTracer{tracer}
+            , mPhase{phase}
+            , mStart{Clock::now()}
+        {
+        }
+
+        ScopedEvent(ScopedEvent const&) = delete;
+        ScopedEvent& operator=(ScopedEvent const&) = delete;
+
+        ~ScopedEvent()
+        {
+            mTracer.record(mPhase, mStart, Clock::now());
+        }
+
+    private:
+        IterationTracer& mTracer;
+        TracePhase mPhase;
+        Clock::time_point mStart;
+    };
+
+    //! \param slowIterationThreshold Iterations that take longer call onSlowIteration, std::nullopt disables it.
+    explicit IterationTracer(std::size_t capacity = kDefaultCapacity,
+        std::optional<std::chrono::microseconds> slowIterationThreshold = std::nullopt,
+        SlowIterationCallback onSlowIteration = {})
+        : mEvents(capacity)
+        , mSlowIterationThreshold{slowIterationThreshold}
+        , mOnSlowIteration{std::move(onSlowIteration)}
+        , mOrigin{Clock::now()}
+    {
+        TLLM_CHECK_WITH_INFO(capacity > 0, "The capacity of the tracer must be positive.");
+        TLLM_CHECK_WITH_INFO(!mSlowIterationThreshold || mOnSlowIteration,
+            "A slow iteration threshold needs a callback for the slow iterations.");
+    }
+
+    void beginIteration(std::uint64_t iteration, BatchComposition const& batch = {})
+    {
+        mIteration.store(iteration, std::memory_order_relaxed);
+        mIterationStart = Clock::now();
+        mBatch = batch;
+    }
+
+    //! \brief The batch is often only known after scheduling, which is part of the iteration.
+    void setBatchComposition(BatchComposition const& batch)
+    {
+        mBatch = batch;
+    }
+
+    //! \brief Records the iteration started by beginIteration, and calls the slow iteration callback if it's slow.
+    //! \returns The duration of the iteration.
+    Clock::duration endIteration()
+    {
+        auto const end = Clock::now();
+        auto const iteration = mIteration.load(std::memory_order_relaxed);
+        record(TracePhase::kITERATION, mIterationStart, end, mBatch);
+        auto const duration = end - mIterationStart;
+        if (mSlowIterationThreshold && duration > *mSlowIterationThreshold)
+        {
+            std::ostringstream trace;
+            dumpChromeTrace(trace);
+            mOnSlowIteration(iteration, trace.str());
+        }
+        return duration;
+    }
+
+    [[nodiscard]] ScopedEvent scope(TracePhase phase)
+    {
+        return ScopedEvent{*this, phase};
+    }
+
+    void record(TracePhase phase, Clock::time_point start, Clock::time_point end, BatchComposition const& batch = {})
+    {
+        Event event{phase, mIteration.load(std::memory_order_relaxed), start, end - start,
+            std::hash<std::thread::id>{}(std::this_thread::get_id()), batch};
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEvents[mNumRecorded % mEvents.size()] = event;
+        ++mNumRecorded;
+    }
+
+    //! \returns The events in the buffer, oldest first.
+    [[nodiscard]] std::vector<Event> getEvents() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto const numEvents = std::min<std::size_t>(mNumRecorded, mEvents.size());
+        std::vector<Event> events;
+        events.reserve(numEvents);
+        for (auto i = mNumRecorded - numEvents; i < mNumRecorded; ++i)
+        {
+            events.push_back(mEvents[i % mEvents.size()]);
+        }
+        return events;
+    }
+
+    //! \returns The number of events recorded since the construction, including the overwritten ones.
+    [[nodiscard]] std::size_t getNumRecorded() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mNumRecorded;
+    }
+
+    //! \brief Writes the events in the buffer as a Chrome trace, with times in microseconds since the construction.
+    void dumpChromeTrace(std::ostream& os) const
+    {
+        auto const toUs = [](Clock::duration d)
+        { return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(d).count(); };
+        os << "{\"traceEvents\":[";
+        bool first = true;
+        for (auto const& event : getEvents())
+        {
+            os << (first ? "" : ",") << "\n{\"name\":\"" << toString(event.phase) << "\",\"cat\":\"executor\""
+               << ",\"ph\":\"X\",\"ts\":" << toUs(event.start - mOrigin) << ",\"dur\":" << toUs(event.duration)
+               << ",\"pid\":0,\"tid\":" << event.threadId << ",\"args\":{\"iteration\":" << event.iteration;
+            if (event.phase == TracePhase::kITERATION)
+            {
+                auto const& batch = event.batch;
+                os << ",\"numContextRequests\":" << batch.numContextRequests
+                   << ",\"numGenerationRequests\":" << batch.numGenerationRequests
+                   << ",\"numContextTokens\":" << batch.numContextTokens
+                   << ",\"numGenerationTokens\":" << batch.numGenerationTokens;
+            }
+            os << "}}";
+            first = false;
+        }
+        os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    }
+
+private:
+    std::vector<Event> mEvents;
+    std::size_t mNumRecorded{0};
+    mutable std::mutex mMutex;
+
+    std::optional<std::chrono::microseconds> mSlowIterationThreshold;
+    SlowIterationCallback mOnSlowIteration;
+    Clock::time_point mOrigin;
+
+    // Written by the executor loop only, read by the other threads to attribute their events
+    std::atomic<std::uint64_t> mIteration{0};
+    Clock::time_point mIterationStart;
+    BatchComposition mBatch;
+};
+
+} // namespace tensorrt_llm::batch_manager
@@ -77,6 +77,8 @@ public:
     std::optional<float> freeGpuMemoryFraction;
     bool enableBlockReuse;
     static constexpr auto kDefaultGpuMemFraction = 0.9f;
+    // Allocates the primary pool in unified memory, which may oversubscribe the device. The blocks of the scheduled
+    // sequences are prefetched before each step of GptSession, see KvCacheUvmPrefetcher.
     bool useUvm;
     std::optional<size_t> hostCacheSize;
     bool onboardBlocks;
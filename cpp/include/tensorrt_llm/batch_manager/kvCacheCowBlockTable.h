@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+//! \brief Block tables of sequences that share KV cache blocks copy-on-write.
+//! \details Beams forked from one another and parallel samples of one prompt start out referencing the same blocks.
+//! A block is only duplicated when a sequence is about to write into it while another sequence still references it,
+//! and the copy is limited to the tokens already written into the block. Full blocks are therefore never copied,
+//! only the partial last block of a sequence is, the first time each fork writes a token into it.
+class CowBlockTable
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using IdType = std::int32_t;
+    using SequenceIdType = std::uint64_t;
+    //! \brief Returns a free block id for a new private copy.
+    using BlockAllocator = std::function<IdType()>;
+
+    //! \brief Copy of the first numTokens of a shared block, to be performed before the write.
+    struct CopyOp
+    {
+        IdType srcBlockId;
+        IdType dstBlockId;
+        SizeType32 numTokens;
+    };
+
+    explicit CowBlockTable(SizeType32 tokensPerBlock)
+        : mTokensPerBlock{tokensPerBlock}
+    {
+        TLLM_CHECK_WITH_INFO(tokensPerBlock > 0, "tokensPerBlock must be positive.");
+    }
+
+    //! \brief Register a sequence owning blocks, numTokens tokens are already written into them.
+    void addSequence(SequenceIdType seqId, std::vector<IdType> blockIds, SizeType32 numTokens)
+    {
+        TLLM_CHECK_WITH_INFO(!mSequences.count(seqId), "Sequence %lu already exists.", seqId);
+        TLLM_CHECK_WITH_INFO(getNumBlocks(numTokens) <= static_cast<SizeType32>(blockIds.size()),
+            "%lu blocks can't hold %d tokens.", blockIds.size(), numTokens);
+        for (auto const blockId : blockIds)
+        {
+            ++mRefCounts[blockId];
+        }
+        mSequences.emplace(seqId, Sequence{std::move(blockIds), numTokens});
+    }
+
+    //! \brief Create a sequence sharing all blocks of an existing one.
+    void fork(SequenceIdType srcSeqId, SequenceIdType dstSeqId)
+    {
+        auto const& src = getSequence(srcSeqId);
+        addSequence(dstSeqId, src.blockIds, src.numTokens);
+    }
+
+    //! \brief Append a token to a sequence.
+    //! \details Allocates a block when the token starts a new block, or a private copy of the last block if it is
+    //! shared. In the latter case, the returned copy must be performed before the token's KV is written.
+    [[nodiscard]] std::optional<CopyOp> addToken(SequenceIdType seqId, BlockAllocator const& allocator)
+    {
+        auto& seq = getSequence(seqId);
+        auto const blockIdx = seq.numTokens / mTokensPerBlock;
+        auto const tokenInBlock = seq.numTokens % mTokensPerBlock;
+        std::optional<CopyOp> copy;
+        if (blockIdx >= static_cast<SizeType32>(seq.blockIds.size()))
+        {
+            auto const blockId = allocator();
+            ++mRefCounts[blockId];
+            seq.blockIds.push_back(blockId);
+        }
+        else if (getRefCount(seq.blockIds[blockIdx]) > 1)
+        {
+            auto const srcBlockId = seq.blockIds[blockIdx];
+            auto const dstBlockId = allocator();
+            decRef(srcBlockId);
+            ++mRefCounts[dstBlockId];
+            seq.blockIds[blockIdx] = dstBlockId;
+            if (tokenInBlock > 0)
+            {
+                copy = CopyOp{srcBlockId, dstBlockId, tokenInBlock};
+            }
+        }
+        ++seq.numTokens;
+        return copy;
+    }
+
+    //! \brief Remove a sequence.
+    //! \return Blocks no longer referenced by any sequence, to be released by the caller.
+    [[nodiscard]] std::vector<IdType> removeSequence(SequenceIdType seqId)
+    {
+        auto it = mSequences.find(seqId);
+        TLLM_CHECK_WITH_INFO(it != mSequences.end(), "Unknown sequence %lu.", seqId);
+        std::vector<IdType> freed;
+        for (auto const blockId : it->second.blockIds)
+        {
+            if (decRef(blockId))
+            {
+                freed.push_back(blockId);
+            }
+        }
+        mSequences.erase(it);
+        return freed;
+    }
+
+    [[nodiscard]] std::vector<IdType> const& getBlockIds(SequenceIdType seqId) const
+    {
+        return getSequence(seqId).blockIds;
+    }
+
+    [[nodiscard]] SizeType32 getNumTokens(SequenceIdType seqId) const
+    {
+        return getSequence(seqId).numTokens;
+    }
+
+    [[nodiscard]] SizeType32 getRefCount(IdType blockId) const
+    {
+        auto it = mRefCounts.find(blockId);
+        return it == mRefCounts.end() ? 0 : it->second;
+    }
+
+    //! \brief Number of distinct blocks referenced by all sequences.
+    [[nodiscard]] SizeType32 getNumUsedBlocks() const noexcept
+    {
+        return static_cast<SizeType32>(mRefCounts.size());
+    }
+
+private:
+    struct Sequence
+    {
+        std::vector<IdType> blockIds;
+        SizeType32 numTokens;
+    };
+
+    [[nodiscard]] SizeType32 getNumBlocks(SizeType32 numTokens) const noexcept
+    {
+        return (numTokens + mTokensPerBlock - 1) / mTokensPerBlock;
+    }
+
+    [[nodiscard]] Sequence& getSequence(SequenceIdType seqId)
+    {
+        auto it = mSequences.find(seqId);
+        TLLM_CHECK_WITH_INFO(it != mSequences.end(), "Unknown sequence %lu.", seqId);
+        return it->second;
+    }
+
+    [[nodiscard]] Sequence const& getSequence(SequenceIdType seqId) const
+    {
+        auto it = mSequences.find(seqId);
+        TLLM_CHECK_WITH_INFO(it != mSequences.end(), "Unknown sequence %lu.", seqId);
+        return it->second;
+    }
+
+    //! \return true if the block is no longer referenced.
+    bool decRef(IdType blockId)
+    {
+        auto it = mRefCounts.find(blockId);
+        TLLM_CHECK(it != mRefCounts.end());
+        if (--it->second == 0)
+        {
+            mRefCounts.erase(it);
+            return true;
+        }
+        return false;
+    }
+
+    SizeType32 mTokensPerBlock;
+    std::unordered_map<SequenceIdType, Sequence> mSequences;
+    std::unordered_map<IdType, SizeType32> mRefCounts;
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/batch_manager/kvCacheRadixTree.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+//! \brief Hash of the encoder input tokens of a request.
+//! \param salt Anything besides the tokens the encoder output depends on, e.g. the LoRA task id.
+[[nodiscard]] inline BlockHashType hashEncoderInput(
+    runtime::TokenIdType const* tokens, runtime::SizeType32 numTokens, std::uint64_t salt = 0) noexcept
+{
+    return hashBlockTokens(kRootBlockHash ^ salt, tokens, numTokens);
+}
+
+//! \brief Hash of encoder input features given as raw bytes, e.g. the mel spectrogram of Whisper.
+[[nodiscard]] inline BlockHashType hashEncoderInput(
+    void const* data, std::size_t numBytes, std::uint64_t salt = 0) noexcept
+{
+    auto const* bytes = static_cast<std::uint8_t const*>(data);
+    BlockHashType seed = kRootBlockHash ^ salt ^ (static_cast<BlockHashType>(numBytes) * 0xff51afd7ed558ccdULL);
+    for (std::size_t offset = 0; offset < numBytes; offset += sizeof(std::uint64_t))
+    {
+        std::uint64_t y = 0;
+        std::memcpy(&y, bytes + offset, std::min(sizeof(y), numBytes - offset));
+        // splitmix64 finalizer
+        y = (y ^ (y >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        y = (y ^ (y >> 27)) * 0x94d049bb133111ebULL;
+        y = y ^ (y >> 31);
+        seed ^= y + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+//! \brief Cross-attention KV cache blocks of enc-dec models, indexed by the hash of the encoder input.
+//! \details The cross KV of a request only depends on the encoder output, not on the decoder prompt, so requests with
+//! the same encoder input can share the blocks of the first one and skip the encoder phase altogether. Blocks of a
+//! cached encoder input stay referenced while any request uses them. Once released by all requests they remain cached
+//! until evicted, least recently used first, when the pool needs free blocks.
+class CrossKvCacheIndex
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using IdType = std::int32_t;
+
+    //! \brief Cross KV blocks of an encoder input.
+    struct Entry
+    {
+        std::vector<IdType> blockIds;
+        //! Length of the encoder output the blocks hold.
+        SizeType32 encoderOutputLen;
+    };
+
+    //! \brief Look up the cross KV of an encoder input.
+    //! \return The cached blocks, referenced for the caller until release(hash), or nullopt if the encoder must run.
+    [[nodiscard]] std::optional<Entry> acquire(BlockHashType hash)
+    {
+        auto it = mEntries.find(hash);
+        if (it == mEntries.end())
+        {
+            ++mNumMisses;
+            return std::nullopt;
+        }
+        ++mNumHits;
+        auto& cached = it->second;
+        if (cached.refCount++ == 0)
+        {
+            mEvictionOrder.erase(cached.evictionIt);
+            mNumEvictableBlocks -= static_cast<SizeType32>(cached.entry.blockIds.size());
+        }
+        return cached.entry;
+    }
+
+    //! \brief Cache the cross KV an encoder phase has just computed, referenced for the caller until release(hash).
+    void insert(BlockHashType hash, Entry entry)
+    {
+        TLLM_CHECK_WITH_INFO(!mEntries.count(hash), "Encoder input %lu is already cached.", hash);
+        mNumCachedBlocks += static_cast<SizeType32>(entry.blockIds.size());
+        mEntries.emplace(hash, CachedEntry{std::move(entry), 1, mEvictionOrder.end()});
+    }
+
+    //! \brief Drop the reference of a finished request, the blocks become evictable once no request uses them.
+    void release(BlockHashType hash)
+    {
+        auto it = mEntries.find(hash);
+        TLLM_CHECK_WITH_INFO(it != mEntries.end(), "Unknown encoder input %lu.", hash);
+        auto& cached = it->second;
+        TLLM_CHECK_WITH_INFO(cached.refCount > 0, "Encoder input %lu is not referenced.", hash);
+        if (--cached.refCount == 0)
+        {
+            cached.evictionIt = mEvictionOrder.insert(mEvictionOrder.end(), hash);
+            mNumEvictableBlocks += static_cast<SizeType32>(cached.entry.blockIds.size());
+        }
+    }
+
+    //! \brief Evict unreferenced encoder inputs, least recently released first, until numBlocks blocks are freed or
+    //! nothing is left to evict.
+    //! \return The freed blocks, to be returned to the pool by the caller.
+    [[nodiscard]] std::vector<IdType> evict(SizeType32 numBlocks)
+    {
+        std::vector<IdType> freed;
+        while (static_cast<SizeType32>(freed.size()) < numBlocks && !mEvictionOrder.empty())
+        {
+            auto it = mEntries.find(mEvictionOrder.front());
+            mEvictionOrder.pop_front();
+            auto const& blockIds = it->second.entry.blockIds;
+            freed.insert(freed.end(), blockIds.begin(), blockIds.end());
+            mNumCachedBlocks -= static_cast<SizeType32>(blockIds.size());
+            mNumEvictableBlocks -= static_cast<SizeType32>(blockIds.size());
+            mEntries.erase(it);
+        }
+        return freed;
+    }
+
+    [[nodiscard]] bool contains(BlockHashType hash) const
+    {
+        return mEntries.count(hash) > 0;
+    }
+
+    [[nodiscard]] SizeType32 getNumCachedBlocks() const noexcept
+    {
+        return mNumCachedBlocks;
+    }
+
+    //! \brief Number of cached blocks no request references.
+    [[nodiscard]] SizeType32 getNumEvictableBlocks() const noexcept
+    {
+        return mNumEvictableBlocks;
+    }
+
+    [[nodiscard]] std::size_t getNumHits() const noexcept
+    {
+        return mNumHits;
+    }
+
+    [[nodiscard]] std::size_t getNumMisses() const noexcept
+    {
+        return mNumMisses;
+    }
+
+private:
+    struct CachedEntry
+    {
+        Entry entry;
+        SizeType32 refCount;
+        //! Position in mEvictionOrder, only valid while refCount is 0.
+        std::list<BlockHashType>::iterator evictionIt;
+    };
+
+    std::unordered_map<BlockHashType, CachedEntry> mEntries;
+    //! Unreferenced encoder inputs, least recently released first.
+    std::list<BlockHashType> mEvictionOrder;
+    SizeType32 mNumCachedBlocks{0};
+    SizeType32 mNumEvictableBlocks{0};
+    std::size_t mNumHits{0};
+    std::size_t mNumMisses{0};
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
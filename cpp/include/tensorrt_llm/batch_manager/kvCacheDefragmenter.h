@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+//! \brief Plans the migration of sequences' KV cache blocks into contiguous runs of a pool.
+//! \details Meant to run during idle iterations of long-running servers. A pass moves whole sequences into the first
+//! free run that can hold them, so that paged attention kernels read consecutive blocks. Blocks vacated during a pass
+//! are not reused as destinations in the same pass, so all moves of a pass can be performed by a single gather launch
+//! (e.g. runtime::kernels::invokeCopyBlocks with the pool as source and destination). Block tables must be switched to
+//! the planned ones only after the moves have completed.
+class KVCacheDefragmenter
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using IdType = std::int32_t;
+
+    struct BlockMove
+    {
+        IdType srcBlockIdx;
+        IdType dstBlockIdx;
+    };
+
+    struct Plan
+    {
+        std::vector<BlockMove> moves;
+        //! New block tables of the moved sequences, indexed like the input.
+        std::vector<std::optional<std::vector<IdType>>> newBlockTables;
+    };
+
+    //! \brief Number of places where consecutive blocks of a sequence are not adjacent in the pool.
+    [[nodiscard]] static SizeType32 countDiscontinuities(std::vector<IdType> const& blockIndices)
+    {
+        SizeType32 count{0};
+        for (std::size_t i = 1; i < blockIndices.size(); ++i)
+        {
+            count += blockIndices[i] != blockIndices[i - 1] + 1;
+        }
+        return count;
+    }
+
+    //! \brief Plan one compaction pass.
+    //! \param blockTables Pool block indices of each sequence, in priority order (e.g. longest lived first).
+    //! \param isFree Free state of every block of the pool. Destinations are taken from free blocks only, so free
+    //! blocks still cached by the reuse tree must either be marked as not free or be evicted from the tree.
+    //! \param isShared Whether every block of the pool has other owners than the sequence at hand, i.e. a reference
+    //! count above 1 or a node in the reuse tree. Switching one block table would leave the other owners on the old
+    //! block, so sequences with a shared block are never moved.
+    //! \param maxMoves Budget of block moves for this pass. Sequences that don't fit in the budget are skipped.
+    [[nodiscard]] static Plan plan(std::vector<std::vector<IdType>> const& blockTables, std::vector<bool> isFree,
+        std::vector<bool> const& isShared, SizeType32 maxMoves)
+    {
+        TLLM_CHECK(isShared.size() == isFree.size());
+        Plan plan;
+        plan.newBlockTables.resize(blockTables.size());
+        for (std::size_t seqIdx = 0; seqIdx < blockTables.size(); ++seqIdx)
+        {
+            auto const& blocks = blockTables[seqIdx];
+            if (countDiscontinuities(blocks) == 0)
+            {
+                continue;
+            }
+            if (std::any_of(blocks.begin(), blocks.end(), [&isShared](IdType block) { return isShared.at(block); }))
+            {
+                continue;
+            }
+            auto const numBlocks = static_cast<SizeType32>(blocks.size());
+            if (static_cast<SizeType32>(plan.moves.size()) + numBlocks > maxMoves)
+            {
+                continue;
+            }
+            auto const runStart = findFreeRun(isFree, numBlocks);
+            if (!runStart)
+            {
+                continue;
+            }
+            std::vector<IdType> newBlocks(numBlocks);
+            for (SizeType32 i = 0; i < numBlocks; ++i)
+            {
+                auto const dst = runStart.value() + i;
+                TLLM_CHECK(isFree.at(dst));
+                isFree[dst] = false;
+                newBlocks[i] = dst;
+                plan.moves.push_back(BlockMove{blocks[i], dst});
+            }
+            plan.newBlockTables[seqIdx] = std::move(newBlocks);
+        }
+        return plan;
+    }
+
+private:
+    [[nodiscard]] static std::optional<IdType> findFreeRun(std::vector<bool> const& isFree, SizeType32 length)
+    {
+        SizeType32 runLength{0};
+        for (std::size_t idx = 0; idx < isFree.size(); ++idx)
+        {
+            runLength = isFree[idx] ? runLength + 1 : 0;
+            if (runLength == length)
+            {
+                return static_cast<IdType>(idx) - length + 1;
+            }
+        }
+        return std::nullopt;
+    }
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
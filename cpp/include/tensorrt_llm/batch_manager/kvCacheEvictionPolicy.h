@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <optional>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+enum class EvictionPolicyType
+{
+    //! Evict the block that was released the longest time ago.
+    kLRU = 0,
+    //! Evict the block that was reused the least, ties broken by release order.
+    kLFU = 1,
+    //! Evict the block with the lowest retention priority, ties broken by release order.
+    kPRIORITY = 2,
+};
+
+//! \brief Decides which free KV cache block is reclaimed next.
+//! \details The policy tracks the free blocks of one pool by block id. A block enters the policy when it is released
+//! and leaves it when it is claimed, either because it was reused or because it is being reallocated. getFreeBlock()
+//! returns the best candidate without removing it; the caller claims it once it has freed it from the reuse tree.
+class BaseEvictionPolicy
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using IdType = std::int32_t;
+    //! \brief Returns false for blocks that can't be reclaimed yet, e.g. blocks with children in the primary pool.
+    using EvictablePredicate = std::function<bool(IdType)>;
+
+    static SizeType32 constexpr kMinRetentionPriority = 0;
+    static SizeType32 constexpr kMaxRetentionPriority = 100;
+    static SizeType32 constexpr kDefaultRetentionPriority = 35;
+
+    explicit BaseEvictionPolicy(SizeType32 numBlocks)
+        : mIsFree(numBlocks, false)
+        , mPinCounts(numBlocks, 0)
+        , mReleasePriorities(numBlocks, kDefaultRetentionPriority)
+        , mReleasedToFront(numBlocks, false)
+    {
+    }
+
+    virtual ~BaseEvictionPolicy() = default;
+
+    //! \brief Add a block to the free set.
+    //! \param toFront Make the block the next eviction candidate, used for blocks that hold no reusable state.
+    //! \param priority Retention priority of the request that released the block.
+    void releaseBlock(IdType blockId, bool toFront = false, SizeType32 priority = kDefaultRetentionPriority)
+    {
+        TLLM_CHECK_WITH_INFO(!isFree(blockId), "Block %d is already free.", blockId);
+        mIsFree[blockId] = true;
+        priority = std::clamp(priority, kMinRetentionPriority, kMaxRetentionPriority);
+        // Kept so that a block pinned while free is released the same way when unpinned
+        mReleasePriorities[blockId] = priority;
+        mReleasedToFront[blockId] = toFront;
+        if (isPinned(blockId))
+        {
+            // Kept out of the policy until unpinned
+            return;
+        }
+        ++mNumFreeBlocks;
+        doRelease(blockId, toFront, priority);
+    }
+
+    //! \brief Remove a block from the free set.
+    //! \param isReuse The block is claimed because its content is reused, which counts as an access.
+    void claimBlock(IdType blockId, bool isReuse = false)
+    {
+        TLLM_CHECK_WITH_INFO(isFree(blockId), "Block %d is not free.", blockId);
+        mIsFree[blockId] = false;
+        if (isPinned(blockId))
+        {
+            return;
+        }
+        --mNumFreeBlocks;
+        doClaim(blockId, isReuse);
+    }
+
+    //! \brief Protect a block from eviction, e.g. a block of a shared system prompt.
+    //! \details Pins are counted, a block can be pinned for several prefixes. A pinned block can still be claimed for
+    //! reuse, but once released it is never returned by getFreeBlock() until it is unpinned.
+    void pinBlock(IdType blockId)
+    {
+        if (mPinCounts.at(blockId)++ == 0)
+        {
+            ++mNumPinnedBlocks;
+            if (isFree(blockId))
+            {
+                --mNumFreeBlocks;
+                doClaim(blockId, false);
+            }
+        }
+    }
+
+    void unpinBlock(IdType blockId)
+    {
+        TLLM_CHECK_WITH_INFO(isPinned(blockId), "Block %d is not pinned.", blockId);
+        if (--mPinCounts[blockId] == 0)
+        {
+            --mNumPinnedBlocks;
+            if (isFree(blockId))
+            {
+                ++mNumFreeBlocks;
+                doRelease(blockId, mReleasedToFront[blockId], mReleasePriorities[blockId]);
+            }
+        }
+    }
+
+    [[nodiscard]] bool isPinned(IdType blockId) const
+    {
+        return mPinCounts.at(blockId) > 0;
+    }
+
+    //! \brief Number of pinned blocks, free or in use. Multiply by the block size to report pinned bytes.
+    [[nodiscard]] SizeType32 getNumPinnedBlocks() const noexcept
+    {
+        return mNumPinnedBlocks;
+    }
+
+    //! \brief Get the best block to reclaim among the free blocks accepted by isEvictable.
+    [[nodiscard]] virtual std::optional<IdType> getFreeBlock(EvictablePredicate const& isEvictable = {}) const = 0;
+
+    [[nodiscard]] bool isFree(IdType blockId) const
+    {
+        TLLM_CHECK(blockId >= 0 && static_cast<std::size_t>(blockId) < mIsFree.size());
+        return mIsFree[blockId];
+    }
+
+    //! \brief Number of free blocks that can be evicted, pinned free blocks are not counted.
+    [[nodiscard]] SizeType32 getNumFreeBlocks() const noexcept
+    {
+        return mNumFreeBlocks;
+    }
+
+protected:
+    virtual void doRelease(IdType blockId, bool toFront, SizeType32 priority) = 0;
+    virtual void doClaim(IdType blockId, bool isReuse) = 0;
+
+    //! \brief Find the first evictable block of an ordered range of tuples holding the block id last.
+    template <typename TIt>
+    [[nodiscard]] static std::optional<IdType> findFirst(TIt begin, TIt end, EvictablePredicate const& isEvictable)
+    {
+        using Entry = typename std::iterator_traits<TIt>::value_type;
+        for (auto it = begin; it != end; ++it)
+        {
+            IdType const blockId = std::get<std::tuple_size_v<Entry> - 1>(*it);
+            if (!isEvictable || isEvictable(blockId))
+            {
+                return blockId;
+            }
+        }
+        return std::nullopt;
+    }
+
+private:
+    std::vector<bool> mIsFree;
+    SizeType32 mNumFreeBlocks{0};
+    std::vector<SizeType32> mPinCounts;
+    // How each free block was released, applied again when a pinned free block is unpinned
+    std::vector<SizeType32> mReleasePriorities;
+    std::vector<bool> mReleasedToFront;
+    SizeType32 mNumPinnedBlocks{0};
+};
+
+//! \brief Least recently released block first. This is the historical behavior of the free blocks queue.
+class LRUEvictionPolicy : public BaseEvictionPolicy
+{
+public:
+    explicit LRUEvictionPolicy(SizeType32 numBlocks)
+        : BaseEvictionPolicy(numBlocks)
+        , mIterators(numBlocks)
+    {
+    }
+
+    [[nodiscard]] std::optional<IdType> getFreeBlock(EvictablePredicate const& isEvictable = {}) const override
+    {
+        return findFirst(mQueue.begin(), mQueue.end(), isEvictable);
+    }
+
+protected:
+    void doRelease(IdType blockId, bool toFront, SizeType32 /*priority*/) override
+    {
+        mIterators[blockId] = toFront ? mQueue.emplace(mQueue.begin(), blockId) : mQueue.emplace(mQueue.end(), blockId);
+    }
+
+    void doClaim(IdType blockId, bool /*isReuse*/) override
+    {
+        mQueue.erase(mIterators[blockId]);
+    }
+
+private:
+    // Tuple so that findFirst can be shared with the ordered policies
+    using Entry = std::tuple<IdType>;
+
+    std::list<Entry> mQueue;
+    std::vector<std::list<Entry>::iterator> mIterators;
+};
+
+//! \brief Least frequently reused block first, least recently released among equally used blocks.
+//! \details Reuse counts saturate at kMaxFrequency and are halved for all blocks every time the number of reuses
+//! since the last aging reaches the number of blocks, so blocks that were popular long ago don't pin the cache forever.
+//! Blocks released to the front get frequency zero and are therefore evicted before any reused block.
+class LFUEvictionPolicy : public BaseEvictionPolicy
+{
+public:
+    static SizeType32 constexpr kMaxFrequency = 15;
+
+    explicit LFUEvictionPolicy(SizeType32 numBlocks)
+        : BaseEvictionPolicy(numBlocks)
+        , mFrequencies(numBlocks, 0)
+        , mKeys(numBlocks)
+        , mAgingPeriod(std::max(numBlocks, SizeType32{1}))
+    {
+    }
+
+    [[nodiscard]] std::optional<IdType> getFreeBlock(EvictablePredicate const& isEvictable = {}) const override
+    {
+        return findFirst(mOrder.begin(), mOrder.end(), isEvictable);
+    }
+
+    [[nodiscard]] SizeType32 getFrequency(IdType blockId) const
+    {
+        return mFrequencies.at(blockId);
+    }
+
+protected:
+    void doRelease(IdType blockId, bool toFront, SizeType32 /*priority*/) override
+    {
+        if (toFront)
+        {
+            mFrequencies[blockId] = 0;
+        }
+        // Blocks released to the front are ordered before all others of frequency zero.
+        auto const tick = toFront ? -(++mTick) : ++mTick;
+        mKeys[blockId] = Key{mFrequencies[blockId], tick, blockId};
+        mOrder.insert(mKeys[blockId]);
+    }
+
+    void doClaim(IdType blockId, bool isReuse) override
+    {
+        mOrder.erase(mKeys[blockId]);
+        if (!isReuse)
+        {
+            // The block gets new content, its history is irrelevant.
+            mFrequencies[blockId] = 0;
+            return;
+        }
+        mFrequencies[blockId] = std::min(mFrequencies[blockId] + 1, kMaxFrequency);
+        if (++mReusesSinceAging >= mAgingPeriod)
+        {
+            age();
+        }
+    }
+
+private:
+    // (frequency, release tick, block id)
+    using Key = std::tuple<SizeType32, std::int64_t, IdType>;
+
+    void age()
+    {
+        mReusesSinceAging = 0;
+        std::set<Key> aged;
+        for (auto& frequency : mFrequencies)
+        {
+            frequency /= 2;
+        }
+        for (auto const& key : mOrder)
+        {
+            auto const blockId = std::get<2>(key);
+            mKeys[blockId] = Key{mFrequencies[blockId], std::get<std::int64_t>(key), blockId};
+            aged.insert(mKeys[blockId]);
+        }
+        mOrder = std::move(aged);
+    }
+
+    std::vector<SizeType32> mFrequencies;
+    std::vector<Key> mKeys;
+    std::set<Key> mOrder;
+    std::int64_t mTick{0};
+    SizeType32 mAgingPeriod;
+    SizeType32 mReusesSinceAging{0};
+};
+
+//! \brief Lowest retention priority first, least recently released among blocks of equal priority.
+//! \details Lets requests mark their blocks (e.g. shared system prompts) as worth keeping, so that a burst of one-off
+//! requests with default priority does not evict them.
+class PriorityEvictionPolicy : public BaseEvictionPolicy
+{
+public:
+    explicit PriorityEvictionPolicy(SizeType32 numBlocks)
+        : BaseEvictionPolicy(numBlocks)
+        , mKeys(numBlocks)
+    {
+    }
+
+    [[nodiscard]] std::optional<IdType> getFreeBlock(EvictablePredicate const& isEvictable = {}) const override
+    {
+        return findFirst(mOrder.begin(), mOrder.end(), isEvictable);
+    }
+
+protected:
+    void doRelease(IdType blockId, bool toFront, SizeType32 priority) override
+    {
+        // Blocks released to the front hold nothing worth keeping, evict them before any prioritized block.
+        mKeys[blockId]
+            = toFront ? Key{kMinRetentionPriority - 1, -(++mTick), blockId} : Key{priority, ++mTick, blockId};
+        mOrder.insert(mKeys[blockId]);
+    }
+
+    void doClaim(IdType blockId, bool /*isReuse*/) override
+    {
+        mOrder.erase(mKeys[blockId]);
+    }
+
+private:
+    // (priority, release tick, block id)
+    using Key = std::tuple<SizeType32, std::int64_t, IdType>;
+
+    std::vector<Key> mKeys;
+    std::set<Key> mOrder;
+    std::int64_t mTick{0};
+};
+
+[[nodiscard]] inline std::unique_ptr<BaseEvictionPolicy> createEvictionPolicy(
+    EvictionPolicyType type, BaseEvictionPolicy::SizeType32 numBlocks)
+{
+    switch (type)
+    {
+    case EvictionPolicyType::kLRU: return std::make_unique<LRUEvictionPolicy>(numBlocks);
+    case EvictionPolicyType::kLFU: return std::make_unique<LFUEvictionPolicy>(numBlocks);
+    case EvictionPolicyType::kPRIORITY: return std::make_unique<PriorityEvictionPolicy>(numBlocks);
+    }
+    TLLM_THROW("Unknown eviction policy type %d", static_cast<int>(type));
+}
+
+//! \brief Selection of the eviction policy and the retention priorities of the requests it uses.
+//! \details Kept beside the KV cache config and the requests, whose layouts are fixed by the prebuilt batch manager
+//! library. Requests without a priority use kDefaultRetentionPriority.
+class EvictionPolicyConfig
+{
+public:
+    using SizeType32 = BaseEvictionPolicy::SizeType32;
+    using RequestIdType = std::uint64_t;
+
+    explicit EvictionPolicyConfig(EvictionPolicyType type = EvictionPolicyType::kLRU)
+        : mType{type}
+    {
+    }
+
+    [[nodiscard]] EvictionPolicyType getType() const noexcept
+    {
+        return mType;
+    }
+
+    //! \brief Set the priority with which the KV cache blocks of a request are retained for reuse once released.
+    //! \details Only used by the priority eviction policy. Blocks of higher priority requests are evicted last.
+    void setRetentionPriority(RequestIdType requestId, SizeType32 priority)
+    {
+        TLLM_CHECK_WITH_INFO(priority >= BaseEvictionPolicy::kMinRetentionPriority
+                && priority <= BaseEvictionPolicy::kMaxRetentionPriority,
+            "KV cache retention priority (%d) must be in [%d, %d].", priority,
+            BaseEvictionPolicy::kMinRetentionPriority, BaseEvictionPolicy::kMaxRetentionPriority);
+        mRetentionPriorities[requestId] = priority;
+    }
+
+    [[nodiscard]] SizeType32 getRetentionPriority(RequestIdType requestId) const
+    {
+        auto const it = mRetentionPriorities.find(requestId);
+        return it != mRetentionPriorities.end() ? it->second : BaseEvictionPolicy::kDefaultRetentionPriority;
+    }
+
+    //! \brief Drop the priority of a request once its blocks are released.
+    void eraseRetentionPriority(RequestIdType requestId)
+    {
+        mRetentionPriorities.erase(requestId);
+    }
+
+    [[nodiscard]] std::unique_ptr<BaseEvictionPolicy> createPolicy(SizeType32 numBlocks) const
+    {
+        return createEvictionPolicy(mType, numBlocks);
+    }
+
+private:
+    EvictionPolicyType mType;
+    std::unordered_map<RequestIdType, SizeType32> mRetentionPriorities;
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/dataType.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <NvInferRuntime.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+//! \brief KV cache shape of one attention layer.
+struct LayerKvCacheConfig
+{
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+
+    SizeType32 numKvHeads;
+    SizeType32 sizePerHead;
+    //! Number of past tokens attended to, maxSequenceLength or above for global attention.
+    SizeType32 attentionWindow;
+    nvinfer1::DataType dtype;
+
+    bool operator==(LayerKvCacheConfig const& other) const
+    {
+        return numKvHeads == other.numKvHeads && sizePerHead == other.sizePerHead
+            && attentionWindow == other.attentionWindow && dtype == other.dtype;
+    }
+};
+
+//! \brief Layers sharing one KV cache pool, because they have the same KV cache shape.
+//! \details A block of the group holds tokensPerBlock tokens of all layers of the group, like the single pool of
+//! KVCacheManager does for all layers.
+struct KvCachePoolGroup
+{
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+
+    LayerKvCacheConfig config;
+    std::vector<SizeType32> layerIds;
+
+    [[nodiscard]] std::size_t getBlockSizeInBytes(SizeType32 tokensPerBlock) const
+    {
+        return layerIds.size() * 2 * static_cast<std::size_t>(config.numKvHeads) * tokensPerBlock
+            * config.sizePerHead * common::getDTypeSize(config.dtype);
+    }
+
+    //! \brief Blocks needed by a sequence of maxSequenceLength tokens.
+    //! \details Sliding window layers only keep the blocks covering the window, plus one block being overwritten
+    //! cyclically.
+    [[nodiscard]] SizeType32 getMaxBlocksPerSeq(SizeType32 tokensPerBlock, SizeType32 maxSequenceLength) const
+    {
+        auto const numTokens = std::min(config.attentionWindow, maxSequenceLength);
+        auto const isCyclic = config.attentionWindow < maxSequenceLength;
+        return (numTokens + tokensPerBlock - 1) / tokensPerBlock + (isCyclic ? 1 : 0);
+    }
+};
+
+//! \brief Group layers with identical KV cache configs, in order of first appearance.
+[[nodiscard]] inline std::vector<KvCachePoolGroup> groupLayersByKvCacheConfig(
+    std::vector<LayerKvCacheConfig> const& layerConfigs)
+{
+    std::vector<KvCachePoolGroup> groups;
+    for (std::size_t layerIdx = 0; layerIdx < layerConfigs.size(); ++layerIdx)
+    {
+        auto const& config = layerConfigs[layerIdx];
+        auto it = std::find_if(
+            groups.begin(), groups.end(), [&config](auto const& group) { return group.config == config; });
+        if (it == groups.end())
+        {
+            groups.push_back(KvCachePoolGroup{config, {}});
+            it = std::prev(groups.end());
+        }
+        it->layerIds.push_back(static_cast<KvCachePoolGroup::SizeType32>(layerIdx));
+    }
+    return groups;
+}
+
+//! \brief Split a memory budget into a number of blocks per pool group.
+//! \details Groups are sized so that all of them fit the same number of sequences of maxSequenceLength tokens. Compared
+//! to sizing every layer for the longest window, sliding window groups only get the blocks their window needs.
+[[nodiscard]] inline std::vector<tensorrt_llm::runtime::SizeType32> calculateBlocksPerPoolGroup(
+    std::vector<KvCachePoolGroup> const& groups, tensorrt_llm::runtime::SizeType32 tokensPerBlock,
+    tensorrt_llm::runtime::SizeType32 maxSequenceLength, std::size_t memoryBudgetInBytes)
+{
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    TLLM_CHECK_WITH_INFO(tokensPerBlock > 0 && maxSequenceLength > 0, "Invalid KV cache dimensions.");
+
+    // Bytes needed by all groups for one sequence of maxSequenceLength tokens
+    std::size_t bytesPerSequence{0};
+    for (auto const& group : groups)
+    {
+        bytesPerSequence
+            += group.getBlockSizeInBytes(tokensPerBlock) * group.getMaxBlocksPerSeq(tokensPerBlock, maxSequenceLength);
+    }
+    TLLM_CHECK_WITH_INFO(bytesPerSequence > 0, "KV cache pool groups are empty.");
+    auto const numSequences = memoryBudgetInBytes / bytesPerSequence;
+
+    std::vector<SizeType32> blocksPerGroup;
+    blocksPerGroup.reserve(groups.size());
+    for (auto const& group : groups)
+    {
+        blocksPerGroup.push_back(
+            static_cast<SizeType32>(numSequences * group.getMaxBlocksPerSeq(tokensPerBlock, maxSequenceLength)));
+    }
+    return blocksPerGroup;
+}
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
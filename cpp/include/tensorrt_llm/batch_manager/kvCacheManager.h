@@ -18,6 +18,7 @@
 
 #include "tensorrt_llm/batch_manager/kvCacheConfig.h"
 #include "tensorrt_llm/batch_manager/llmRequest.h" // TODO forward declare
+#include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/kernels/kvCacheIndex.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/common.h"
@@ -339,6 +340,34 @@ public:
         return getMaxNumBlocks() - getNumFreeBlocks();
     }
 
+    //! \brief Number of blocks allocated to sequences since the creation of the manager, reused or not.
+    [[nodiscard]] std::size_t getNumAllocTotalBlocks() const noexcept
+    {
+        return mAllocTotalBlocks;
+    }
+
+    //! \brief Number of blocks allocated to sequences since the creation of the manager, without reuse.
+    [[nodiscard]] std::size_t getNumAllocNewBlocks() const noexcept
+    {
+        return mAllocNewBlocks;
+    }
+
+    [[nodiscard]] SizeType32 getNumSecondaryBlocks() const noexcept
+    {
+        return mNumSecondaryBlocks;
+    }
+
+    [[nodiscard]] SizeType32 getNumFreeSecondaryBlocks() const noexcept
+    {
+        return static_cast<SizeType32>(mFreeSecondaryBlocks.size());
+    }
+
+    //! \brief All blocks, primary and secondary, by id.
+    [[nodiscard]] std::vector<BlockPtr> const& getAllBlocks() const noexcept
+    {
+        return mAllBlocksById;
+    }
+
     [[nodiscard]] bool hasFreeBlocks(SizeType32 numRequired = 1) const noexcept
     {
         return getNumFreeBlocks() >= numRequired;
@@ -349,6 +378,24 @@ public:
         return mSchedulingNumFreeBlocks >= numRequired;
     }
 
+    //! \brief Forget the blocks stored for reuse, e.g. because their values are stale after the weights were
+    //! refitted. The blocks stay in the pools, as free blocks. No sequence must hold blocks.
+    void clearReusableBlocks()
+    {
+        TLLM_CHECK_WITH_INFO(
+            getNumAllocatedBlocks() == 0, "Reusable blocks can only be cleared without sequences holding blocks.");
+        // Detach the leaves until the tree of reusable blocks is empty, each block is a leaf once at most
+        for (std::size_t i = 0; i < mAllBlocksById.size(); ++i)
+        {
+            auto const leaf = KVCacheBlock::findLeafBlock(mCachedBlocksRoot);
+            if (!leaf || leaf == mCachedBlocksRoot)
+            {
+                break;
+            }
+            leaf->freeLeafBlock();
+        }
+    }
+
     [[nodiscard]] SizeType32 getMaxNumBlocks() const noexcept
     {
         return static_cast<SizeType32>(mAllBlocksById.size());
@@ -573,11 +620,23 @@ public:
         return prepopulatedTokens.size() > 0 ? prepopulatedTokens.at(beamIdx) : 0;
     }
 
+    //! @return The number of tokens in the cache of the sequence
+    [[nodiscard]] SizeType32 getNumTokens(SizeType32 seqSlotIdx) const
+    {
+        return mSequences.at(seqSlotIdx)->getNumTokens();
+    }
+
     [[nodiscard]] bool isEnableBlockReuse() const
     {
         return mEnableBlockReuse;
     }
 
+    //! \brief See BlockManager::clearReusableBlocks.
+    void clearReusableBlocks()
+    {
+        mBlockManager.clearReusableBlocks();
+    }
+
     void removeToken(SizeType32 seqSlotIdx);
     void rewindKVCache(SizeType32 seqSlotIdx, SizeType32 rewindLengths);
 
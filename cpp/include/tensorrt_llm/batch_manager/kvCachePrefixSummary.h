@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/batch_manager/kvCacheRadixTree.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+//! \brief Compact summary of the reusable blocks of a replica, for KV cache aware request routing.
+//! \details A Bloom filter of the rolling block hashes (see hashBlockTokens) of the blocks cached by a replica. A
+//! router hashes the blocks of an incoming prompt once and estimates, for each replica's summary, how many leading
+//! blocks are cached there, without contacting the replicas. Since block hashes chain on their prefix, a false
+//! positive for a block only matters if all preceding blocks matched too. The words are trivially serializable, and
+//! summaries of the same size can be merged with a bitwise OR.
+class PrefixCacheSummary
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using WordType = std::uint64_t;
+
+    //! \param numBits Size of the filter, rounded up to a multiple of 64. About 10 bits per cached block give a false
+    //! positive rate of 1% with 7 hash functions.
+    PrefixCacheSummary(SizeType32 numBits, SizeType32 numHashes)
+        : mWords((static_cast<std::size_t>(numBits) + kBitsPerWord - 1) / kBitsPerWord, 0)
+        , mNumHashes{numHashes}
+    {
+        TLLM_CHECK_WITH_INFO(numBits > 0 && numHashes > 0, "Invalid prefix cache summary size.");
+    }
+
+    //! \brief Restore a summary from its words, e.g. after receiving them from a replica.
+    PrefixCacheSummary(std::vector<WordType> words, SizeType32 numHashes)
+        : mWords{std::move(words)}
+        , mNumHashes{numHashes}
+    {
+        TLLM_CHECK_WITH_INFO(!mWords.empty() && numHashes > 0, "Invalid prefix cache summary size.");
+    }
+
+    //! \brief Summarize all blocks of a reuse tree.
+    template <typename TValue>
+    [[nodiscard]] static PrefixCacheSummary fromTree(
+        BlockRadixTree<TValue> const& tree, SizeType32 numBits, SizeType32 numHashes)
+    {
+        PrefixCacheSummary summary{numBits, numHashes};
+        tree.forEachBlockHash([&summary](BlockHashType hash, SizeType32) { summary.add(hash); });
+        return summary;
+    }
+
+    void add(BlockHashType hash)
+    {
+        forEachBit(
+            hash, [this](std::size_t bit) { mWords[bit / kBitsPerWord] |= WordType{1} << (bit % kBitsPerWord); });
+    }
+
+    [[nodiscard]] bool mightContain(BlockHashType hash) const
+    {
+        bool contained{true};
+        forEachBit(hash,
+            [this, &contained](std::size_t bit)
+            { contained &= ((mWords[bit / kBitsPerWord] >> (bit % kBitsPerWord)) & 1) != 0; });
+        return contained;
+    }
+
+    //! \brief Estimated number of leading blocks of a prompt cached by the replica.
+    //! \param blockHashes Rolling hashes of the full blocks of the prompt, in order.
+    [[nodiscard]] SizeType32 getNumMatchedBlocks(std::vector<BlockHashType> const& blockHashes) const
+    {
+        SizeType32 numBlocks{0};
+        for (auto const hash : blockHashes)
+        {
+            if (!mightContain(hash))
+            {
+                break;
+            }
+            ++numBlocks;
+        }
+        return numBlocks;
+    }
+
+    void merge(PrefixCacheSummary const& other)
+    {
+        TLLM_CHECK_WITH_INFO(mWords.size() == other.mWords.size() && mNumHashes == other.mNumHashes,
+            "Only summaries of the same size can be merged.");
+        for (std::size_t i = 0; i < mWords.size(); ++i)
+        {
+            mWords[i] |= other.mWords[i];
+        }
+    }
+
+    void clear()
+    {
+        std::fill(mWords.begin(), mWords.end(), 0);
+    }
+
+    [[nodiscard]] std::vector<WordType> const& getWords() const noexcept
+    {
+        return mWords;
+    }
+
+    [[nodiscard]] SizeType32 getNumHashes() const noexcept
+    {
+        return mNumHashes;
+    }
+
+private:
+    static constexpr std::size_t kBitsPerWord = 64;
+
+    //! \brief Kirsch-Mitzenmacher double hashing, the block hash is already well mixed.
+    template <typename Func>
+    void forEachBit(BlockHashType hash, Func&& func) const
+    {
+        auto const numBits = mWords.size() * kBitsPerWord;
+        auto const h1 = hash;
+        auto const h2 = ((hash >> 32) | (hash << 32)) * 0x9e3779b97f4a7c15ULL | 1;
+        for (SizeType32 i = 0; i < mNumHashes; ++i)
+        {
+            func((h1 + static_cast<BlockHashType>(i) * h2) % numBits);
+        }
+    }
+
+    std::vector<WordType> mWords;
+    SizeType32 mNumHashes;
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
@@ -0,0 +1,451 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+//! \brief Identity of a full token block, chained on the identity of all blocks preceding it.
+//! \details Two blocks have the same hash iff (barring collisions) their whole token prefix is identical,
+//! so the hash can be used as a key for a block in any cache tier without storing the prefix itself.
+using BlockHashType = std::uint64_t;
+
+//! \brief Hash of the (empty) prefix preceding the first block of a sequence.
+static constexpr BlockHashType kRootBlockHash = 0x9e3779b97f4a7c15ULL;
+
+//! \brief Compute the hash of a block from the hash of its parent and its tokens.
+//! \details The hash is a rolling hash: the hash of block i only depends on the hash of block i-1 and the tokens of
+//! block i, so hashing the blocks of a prompt costs a single pass over the prompt.
+[[nodiscard]] inline BlockHashType hashBlockTokens(
+    BlockHashType parentHash, runtime::TokenIdType const* tokens, runtime::SizeType32 numTokens) noexcept
+{
+    BlockHashType seed = parentHash ^ (static_cast<BlockHashType>(numTokens) * 0xff51afd7ed558ccdULL);
+    for (runtime::SizeType32 i = 0; i < numTokens; ++i)
+    {
+        // splitmix64 finalizer
+        BlockHashType y = static_cast<std::uint32_t>(tokens[i]);
+        y = (y ^ (y >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        y = (y ^ (y >> 27)) * 0x94d049bb133111ebULL;
+        y = y ^ (y >> 31);
+        seed ^= y + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+//! \brief Compressed radix tree indexing full KV cache blocks by their token prefix.
+//!
+//! \details Every edge of the tree holds a run of one or more consecutive full blocks together with one value per
+//! block (typically a block id). Chains of blocks without branching are stored in a single node, so the tree has at
+//! most as many nodes as there are distinct branch points. Children are keyed by the rolling hash of their first block
+//! (see hashBlockTokens), so finding the longest cached prefix of a prompt costs O(matched blocks) hash lookups and
+//! token comparisons against the caller's buffer; no per-block token vector is materialized.
+//!
+//! Partially filled blocks are not indexed.
+template <typename TValue>
+class BlockRadixTree
+{
+public:
+    using SizeType32 = runtime::SizeType32;
+    using TokenIdType = runtime::TokenIdType;
+    using VecTokens = std::vector<TokenIdType>;
+
+    //! \brief Result of a prefix lookup.
+    struct MatchResult
+    {
+        //! One value per matched block, in sequence order.
+        std::vector<TValue> values;
+        //! Hash of each matched block.
+        std::vector<BlockHashType> hashes;
+
+        [[nodiscard]] SizeType32 getNumBlocks() const noexcept
+        {
+            return static_cast<SizeType32>(values.size());
+        }
+    };
+
+    explicit BlockRadixTree(SizeType32 tokensPerBlock)
+        : mTokensPerBlock{tokensPerBlock}
+        , mRoot{std::make_unique<Node>()}
+        , mNumBlocks{0}
+    {
+        TLLM_CHECK_WITH_INFO(tokensPerBlock > 0, "tokensPerBlock must be positive.");
+        mRoot->parent = nullptr;
+    }
+
+    [[nodiscard]] SizeType32 getTokensPerBlock() const noexcept
+    {
+        return mTokensPerBlock;
+    }
+
+    //! \brief Number of blocks stored in the tree.
+    [[nodiscard]] SizeType32 getNumBlocks() const noexcept
+    {
+        return mNumBlocks;
+    }
+
+    //! \brief Find the longest prefix of tokens made of full cached blocks.
+    [[nodiscard]] MatchResult match(TokenIdType const* tokens, SizeType32 numTokens) const
+    {
+        MatchResult result;
+        walk(tokens, numTokens,
+            [&result](Node const& node, SizeType32 blockIdx)
+            {
+                result.values.push_back(node.values[blockIdx]);
+                result.hashes.push_back(node.hashes[blockIdx]);
+            });
+        return result;
+    }
+
+    [[nodiscard]] MatchResult match(VecTokens const& tokens) const
+    {
+        return match(tokens.data(), static_cast<SizeType32>(tokens.size()));
+    }
+
+    //! \brief Number of leading tokens that can be served from cached blocks.
+    //! \details Cheaper than match() since no values are collected. Intended for scheduling decisions.
+    [[nodiscard]] SizeType32 getNumMatchedTokens(TokenIdType const* tokens, SizeType32 numTokens) const
+    {
+        SizeType32 numBlocks{0};
+        walk(tokens, numTokens, [&numBlocks](Node const&, SizeType32) { ++numBlocks; });
+        return numBlocks * mTokensPerBlock;
+    }
+
+    [[nodiscard]] SizeType32 getNumMatchedTokens(VecTokens const& tokens) const
+    {
+        return getNumMatchedTokens(tokens.data(), static_cast<SizeType32>(tokens.size()));
+    }
+
+    //! \brief Insert the leading full blocks of tokens.
+    //! \details The number of inserted blocks is min(values.size(), numTokens / tokensPerBlock). Blocks already present
+    //! keep their current value.
+    //! \return Number of blocks that were newly added to the tree.
+    SizeType32 insert(TokenIdType const* tokens, SizeType32 numTokens, std::vector<TValue> const& values)
+    {
+        auto const numBlocks = std::min(static_cast<SizeType32>(values.size()), numTokens / mTokensPerBlock);
+        Node* node = mRoot.get();
+        BlockHashType parentHash = kRootBlockHash;
+        SizeType32 blockIdx = 0;
+        while (blockIdx < numBlocks)
+        {
+            auto const* blockTokens = tokens + blockIdx * mTokensPerBlock;
+            auto const hash = hashBlockTokens(parentHash, blockTokens, mTokensPerBlock);
+            auto const it = node->children.find(hash);
+            if (it == node->children.end())
+            {
+                break;
+            }
+            auto* child = it->second.get();
+            if (!blockEquals(*child, 0, blockTokens))
+            {
+                // Hash collision with a different prefix, the block can't be indexed.
+                return 0;
+            }
+            SizeType32 edgeIdx = 0;
+            while (edgeIdx < child->getNumBlocks() && blockIdx < numBlocks
+                && blockEquals(*child, edgeIdx, tokens + blockIdx * mTokensPerBlock))
+            {
+                parentHash = child->hashes[edgeIdx];
+                ++edgeIdx;
+                ++blockIdx;
+            }
+            if (edgeIdx < child->getNumBlocks())
+            {
+                if (blockIdx == numBlocks)
+                {
+                    return 0;
+                }
+                split(*child, edgeIdx);
+            }
+            node = child;
+        }
+
+        if (blockIdx == numBlocks)
+        {
+            return 0;
+        }
+
+        // Extend a leaf in place to keep chains compressed, otherwise start a new edge.
+        Node* target = node;
+        if (node == mRoot.get() || !node->children.empty())
+        {
+            auto newNode = std::make_unique<Node>();
+            newNode->parent = node;
+            target = newNode.get();
+            auto const firstHash = hashBlockTokens(parentHash, tokens + blockIdx * mTokensPerBlock, mTokensPerBlock);
+            node->children.emplace(firstHash, std::move(newNode));
+        }
+        auto const numNewBlocks = numBlocks - blockIdx;
+        for (; blockIdx < numBlocks; ++blockIdx)
+        {
+            auto const* blockTokens = tokens + blockIdx * mTokensPerBlock;
+            parentHash = hashBlockTokens(parentHash, blockTokens, mTokensPerBlock);
+            target->tokens.insert(target->tokens.end(), blockTokens, blockTokens + mTokensPerBlock);
+            target->values.push_back(values[blockIdx]);
+            target->hashes.push_back(parentHash);
+        }
+        mNumBlocks += numNewBlocks;
+        return numNewBlocks;
+    }
+
+    SizeType32 insert(VecTokens const& tokens, std::vector<TValue> const& values)
+    {
+        return insert(tokens.data(), static_cast<SizeType32>(tokens.size()), values);
+    }
+
+    //! \brief Remove the last full block of tokens from the tree.
+    //! \details Only leaf blocks can be removed, i.e. the block must not be the prefix of another cached block.
+    //! \return The value that was stored for the removed block, or std::nullopt if it isn't a cached leaf block.
+    std::optional<TValue> eraseLeaf(TokenIdType const* tokens, SizeType32 numTokens)
+    {
+        auto const numBlocks = numTokens / mTokensPerBlock;
+        if (numBlocks == 0)
+        {
+            return std::nullopt;
+        }
+        Node const* lastNode = nullptr;
+        SizeType32 lastIdx = -1;
+        SizeType32 numMatched = 0;
+        walk(tokens, numBlocks * mTokensPerBlock,
+            [&](Node const& node, SizeType32 blockIdx)
+            {
+                lastNode = &node;
+                lastIdx = blockIdx;
+                ++numMatched;
+            });
+        if (numMatched != numBlocks || lastIdx != lastNode->getNumBlocks() - 1 || !lastNode->children.empty())
+        {
+            return std::nullopt;
+        }
+
+        auto* node = const_cast<Node*>(lastNode);
+        auto const removedHash = node->hashes.back();
+        auto value = std::move(node->values.back());
+        node->values.pop_back();
+        node->hashes.pop_back();
+        node->tokens.resize(node->tokens.size() - mTokensPerBlock);
+        --mNumBlocks;
+
+        if (node->values.empty())
+        {
+            // The edge only held the removed block, which is also the key of the edge in its parent.
+            auto* parent = node->parent;
+            parent->children.erase(removedHash);
+            if (parent != mRoot.get() && parent->children.size() == 1)
+            {
+                merge(*parent);
+            }
+        }
+        return value;
+    }
+
+    std::optional<TValue> eraseLeaf(VecTokens const& tokens)
+    {
+        return eraseLeaf(tokens.data(), static_cast<SizeType32>(tokens.size()));
+    }
+
+    //! \brief Call visitor(hash, depth) for every block of the tree, depth being the index of the block in its
+    //! sequence. Parents are visited before their children.
+    template <typename Visitor>
+    void forEachBlockHash(Visitor&& visitor) const
+    {
+        std::vector<std::pair<Node const*, SizeType32>> stack{{mRoot.get(), 0}};
+        while (!stack.empty())
+        {
+            auto const [node, depth] = stack.back();
+            stack.pop_back();
+            for (SizeType32 blockIdx = 0; blockIdx < node->getNumBlocks(); ++blockIdx)
+            {
+                visitor(node->hashes[blockIdx], depth + blockIdx);
+            }
+            for (auto const& [hash, child] : node->children)
+            {
+                stack.emplace_back(child.get(), depth + node->getNumBlocks());
+            }
+        }
+    }
+
+    //! \brief Remove all blocks.
+    void clear()
+    {
+        mRoot->children.clear();
+        mNumBlocks = 0;
+    }
+
+private:
+    struct Node
+    {
+        // Tokens of all blocks on the edge leading to this node, [numBlocks * tokensPerBlock]
+        VecTokens tokens;
+        // Value of each block on the edge
+        std::vector<TValue> values;
+        // Rolling hash of each block on the edge
+        std::vector<BlockHashType> hashes;
+        // Children keyed by the hash of their first block
+        std::unordered_map<BlockHashType, std::unique_ptr<Node>> children;
+        Node* parent;
+
+        [[nodiscard]] SizeType32 getNumBlocks() const noexcept
+        {
+            return static_cast<SizeType32>(values.size());
+        }
+    };
+
+    [[nodiscard]] bool blockEquals(Node const& node, SizeType32 blockIdx, TokenIdType const* tokens) const
+    {
+        auto const* nodeTokens = node.tokens.data() + blockIdx * mTokensPerBlock;
+        return std::equal(nodeTokens, nodeTokens + mTokensPerBlock, tokens);
+    }
+
+    //! \brief Walk the longest cached prefix of tokens, calling visitor(node, blockIdxInNode) for each matched block.
+    template <typename Visitor>
+    void walk(TokenIdType const* tokens, SizeType32 numTokens, Visitor&& visitor) const
+    {
+        auto const numBlocks = numTokens / mTokensPerBlock;
+        Node const* node = mRoot.get();
+        BlockHashType parentHash = kRootBlockHash;
+        SizeType32 blockIdx = 0;
+        while (blockIdx < numBlocks)
+        {
+            auto const* blockTokens = tokens + blockIdx * mTokensPerBlock;
+            auto const it = node->children.find(hashBlockTokens(parentHash, blockTokens, mTokensPerBlock));
+            if (it == node->children.end())
+            {
+                return;
+            }
+            auto const& child = *it->second;
+            SizeType32 edgeIdx = 0;
+            while (edgeIdx < child.getNumBlocks() && blockIdx < numBlocks
+                && blockEquals(child, edgeIdx, tokens + blockIdx * mTokensPerBlock))
+            {
+                visitor(child, edgeIdx);
+                parentHash = child.hashes[edgeIdx];
+                ++edgeIdx;
+                ++blockIdx;
+            }
+            if (edgeIdx < child.getNumBlocks())
+            {
+                return;
+            }
+            node = &child;
+        }
+    }
+
+    //! \brief Split node so that it keeps blocks [0, blockIdx) and a new single child holds the rest.
+    void split(Node& node, SizeType32 blockIdx)
+    {
+        auto tail = std::make_unique<Node>();
+        tail->parent = &node;
+        auto const tokenOffset = blockIdx * mTokensPerBlock;
+        tail->tokens.assign(node.tokens.begin() + tokenOffset, node.tokens.end());
+        tail->values.assign(std::make_move_iterator(node.values.begin() + blockIdx),
+            std::make_move_iterator(node.values.end()));
+        tail->hashes.assign(node.hashes.begin() + blockIdx, node.hashes.end());
+        tail->children = std::move(node.children);
+        for (auto& [hash, grandChild] : tail->children)
+        {
+            grandChild->parent = tail.get();
+        }
+        node.tokens.resize(tokenOffset);
+        node.values.erase(node.values.begin() + blockIdx, node.values.end());
+        node.hashes.resize(blockIdx);
+        node.children.clear();
+        auto const tailHash = tail->hashes.front();
+        node.children.emplace(tailHash, std::move(tail));
+    }
+
+    //! \brief Merge the single child of node into node.
+    void merge(Node& node)
+    {
+        TLLM_CHECK(node.children.size() == 1);
+        auto child = std::move(node.children.begin()->second);
+        node.children.clear();
+        node.tokens.insert(node.tokens.end(), child->tokens.begin(), child->tokens.end());
+        node.values.insert(node.values.end(), std::make_move_iterator(child->values.begin()),
+            std::make_move_iterator(child->values.end()));
+        node.hashes.insert(node.hashes.end(), child->hashes.begin(), child->hashes.end());
+        node.children = std::move(child->children);
+        for (auto& [hash, grandChild] : node.children)
+        {
+            grandChild->parent = &node;
+        }
+    }
+
+    SizeType32 mTokensPerBlock;
+    std::unique_ptr<Node> mRoot;
+    SizeType32 mNumBlocks;
+};
+
+//! \brief Number of prompt tokens each waiting request is expected to find in reusable blocks.
+//! \details Kept beside the requests, keyed by request id, so that schedulers can favor requests with cache hits
+//! without touching the requests themselves. These are estimates: blocks may be evicted before a request is scheduled.
+class ReusableTokensEstimates
+{
+public:
+    using SizeType32 = runtime::SizeType32;
+    using RequestIdType = std::uint64_t;
+
+    //! \brief Estimate the reusable tokens of a request from the prefix index and record them.
+    //! \return The number of leading prompt tokens found in the tree.
+    template <typename TValue>
+    SizeType32 estimate(RequestIdType requestId, BlockRadixTree<TValue> const& tree,
+        typename BlockRadixTree<TValue>::VecTokens const& promptTokens)
+    {
+        auto const numTokens = tree.getNumMatchedTokens(promptTokens);
+        set(requestId, numTokens, static_cast<SizeType32>(promptTokens.size()));
+        return numTokens;
+    }
+
+    void set(RequestIdType requestId, SizeType32 numTokens, SizeType32 promptLen)
+    {
+        TLLM_CHECK_WITH_INFO(numTokens >= 0, "The number of reusable tokens (%d) can't be negative.", numTokens);
+        mEstimates[requestId] = std::min(numTokens, promptLen);
+    }
+
+    //! \return The estimate of the request, 0 if it has none.
+    [[nodiscard]] SizeType32 get(RequestIdType requestId) const
+    {
+        auto const it = mEstimates.find(requestId);
+        return it != mEstimates.end() ? it->second : 0;
+    }
+
+    //! \brief Drop the estimate of a request, once it is scheduled or terminated.
+    void erase(RequestIdType requestId)
+    {
+        mEstimates.erase(requestId);
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return mEstimates.size();
+    }
+
+private:
+    std::unordered_map<RequestIdType, SizeType32> mEstimates;
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
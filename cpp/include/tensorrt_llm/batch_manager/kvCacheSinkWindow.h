@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+//! \brief Block tables of sequences using attention sinks (StreamingLLM) with a cyclic KV cache.
+//! \details The first sinkTokenLength tokens of a sequence are kept in pinned sink blocks, padded with a bubble to a
+//! block boundary. The following tokens go through a ring of cyclic blocks that is just large enough to cover the
+//! attention window, so a sequence never holds more than getMaxBlocksPerSeq() blocks however long it runs. Block
+//! slots follow the token to block mapping of kernels::KVBlockArray, the block ids of a sequence can be copied to
+//! its block offsets as is. When the window slides into a slot that is already allocated, the block is overwritten
+//! in place instead of allocating a new one, and the scheduler is told so through getNeededBlocksToCompletion(): a
+//! request of unbounded length only ever reserves the blocks of its window.
+class SinkWindowBlockTable
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using IdType = std::int32_t;
+    using SequenceIdType = std::uint64_t;
+    //! \brief Returns a free block id.
+    using BlockAllocator = std::function<IdType()>;
+
+    //! \param useOneMoreBlock Add one more cyclic block, so that the oldest block of the window isn't overwritten
+    //! while the token being generated still attends to it. Same as the KVCacheManager argument.
+    SinkWindowBlockTable(
+        SizeType32 tokensPerBlock, SizeType32 maxAttentionWindow, SizeType32 sinkTokenLength, bool useOneMoreBlock)
+        : mTokensPerBlock{tokensPerBlock}
+        , mSinkTokenLength{sinkTokenLength}
+    {
+        TLLM_CHECK_WITH_INFO(tokensPerBlock > 0, "tokensPerBlock must be positive.");
+        TLLM_CHECK_WITH_INFO(sinkTokenLength >= 0 && sinkTokenLength < maxAttentionWindow,
+            "sinkTokenLength (%d) must be in [0, maxAttentionWindow (%d)).", sinkTokenLength, maxAttentionWindow);
+        auto const sinkTokensInLastBlock = sinkTokenLength % tokensPerBlock;
+        mBubbleLength = sinkTokensInLastBlock == 0 ? 0 : tokensPerBlock - sinkTokensInLastBlock;
+        mNumSinkBlocks = (sinkTokenLength + mBubbleLength) / tokensPerBlock;
+        mCyclicLength = useOneMoreBlock ? maxAttentionWindow + tokensPerBlock - sinkTokenLength
+                                        : maxAttentionWindow - sinkTokenLength;
+        mMaxBlocksPerSeq = mNumSinkBlocks + ceilDiv(mCyclicLength, tokensPerBlock);
+    }
+
+    [[nodiscard]] SizeType32 getMaxBlocksPerSeq() const noexcept
+    {
+        return mMaxBlocksPerSeq;
+    }
+
+    [[nodiscard]] SizeType32 getNumSinkBlocks() const noexcept
+    {
+        return mNumSinkBlocks;
+    }
+
+    //! \brief Slot of the block holding a token, same as KVBlockArray::getKVTokenIdx(tokenIdx) / tokensPerBlock.
+    [[nodiscard]] SizeType32 getBlockSlot(SizeType32 tokenIdx) const noexcept
+    {
+        if (tokenIdx < mSinkTokenLength)
+        {
+            return tokenIdx / mTokensPerBlock;
+        }
+        return mNumSinkBlocks + ((tokenIdx - mSinkTokenLength) % mCyclicLength) / mTokensPerBlock;
+    }
+
+    //! \brief Number of blocks a sequence of numTokens tokens holds, bounded by getMaxBlocksPerSeq().
+    [[nodiscard]] SizeType32 getNumBlocks(SizeType32 numTokens) const noexcept
+    {
+        if (numTokens <= mSinkTokenLength)
+        {
+            return ceilDiv(numTokens, mTokensPerBlock);
+        }
+        return mNumSinkBlocks + ceilDiv(std::min(numTokens - mSinkTokenLength, mCyclicLength), mTokensPerBlock);
+    }
+
+    //! \brief Number of new blocks needed to take a sequence of numTokens tokens to numTokens + maxNewTokens.
+    //! \details Zero once the ring is complete, whatever maxNewTokens is.
+    [[nodiscard]] SizeType32 getNeededBlocksToCompletion(SizeType32 numTokens, SizeType32 maxNewTokens) const noexcept
+    {
+        return getNumBlocks(numTokens + maxNewTokens) - getNumBlocks(numTokens);
+    }
+
+    //! \brief Register a new sequence and allocate the blocks of its first numTokens tokens.
+    void addSequence(SequenceIdType seqId, SizeType32 numTokens, BlockAllocator const& allocator)
+    {
+        TLLM_CHECK_WITH_INFO(!mSequences.count(seqId), "Sequence %lu already exists.", seqId);
+        TLLM_CHECK_WITH_INFO(numTokens >= 0, "numTokens must not be negative.");
+        auto& seq = mSequences[seqId];
+        for (SizeType32 i = 0; i < numTokens; ++i)
+        {
+            addToken(seq, allocator);
+        }
+    }
+
+    //! \brief Append a token to a sequence.
+    //! \return true if the token starts a new block, either freshly allocated or overwritten in place.
+    bool addToken(SequenceIdType seqId, BlockAllocator const& allocator)
+    {
+        return addToken(getSequence(seqId), allocator);
+    }
+
+    //! \brief Remove a sequence.
+    //! \return Its blocks, sink blocks included, to be released by the caller.
+    [[nodiscard]] std::vector<IdType> removeSequence(SequenceIdType seqId)
+    {
+        auto it = mSequences.find(seqId);
+        TLLM_CHECK_WITH_INFO(it != mSequences.end(), "Unknown sequence %lu.", seqId);
+        auto blockIds = std::move(it->second.blockIds);
+        mNumUsedBlocks -= static_cast<SizeType32>(blockIds.size());
+        mSequences.erase(it);
+        return blockIds;
+    }
+
+    //! \brief Block ids of a sequence, indexed by slot.
+    [[nodiscard]] std::vector<IdType> const& getBlockIds(SequenceIdType seqId) const
+    {
+        return getSequence(seqId).blockIds;
+    }
+
+    [[nodiscard]] SizeType32 getNumTokens(SequenceIdType seqId) const
+    {
+        return getSequence(seqId).numTokens;
+    }
+
+    //! \brief Number of blocks held by all sequences.
+    [[nodiscard]] SizeType32 getNumUsedBlocks() const noexcept
+    {
+        return mNumUsedBlocks;
+    }
+
+private:
+    struct Sequence
+    {
+        std::vector<IdType> blockIds;
+        SizeType32 numTokens{0};
+    };
+
+    [[nodiscard]] static SizeType32 ceilDiv(SizeType32 a, SizeType32 b) noexcept
+    {
+        return (a + b - 1) / b;
+    }
+
+    bool addToken(Sequence& seq, BlockAllocator const& allocator)
+    {
+        auto const tokenIdx = seq.numTokens++;
+        auto const posInCache = tokenIdx < mSinkTokenLength ? tokenIdx : (tokenIdx - mSinkTokenLength) % mCyclicLength;
+        auto const startsBlock = posInCache % mTokensPerBlock == 0;
+        if (!startsBlock)
+        {
+            return false;
+        }
+        // Slots are filled in order until the ring wraps around, after which they are all allocated.
+        if (getBlockSlot(tokenIdx) == static_cast<SizeType32>(seq.blockIds.size()))
+        {
+            seq.blockIds.push_back(allocator());
+            ++mNumUsedBlocks;
+        }
+        return true;
+    }
+
+    [[nodiscard]] Sequence& getSequence(SequenceIdType seqId)
+    {
+        auto it = mSequences.find(seqId);
+        TLLM_CHECK_WITH_INFO(it != mSequences.end(), "Unknown sequence %lu.", seqId);
+        return it->second;
+    }
+
+    [[nodiscard]] Sequence const& getSequence(SequenceIdType seqId) const
+    {
+        auto it = mSequences.find(seqId);
+        TLLM_CHECK_WITH_INFO(it != mSequences.end(), "Unknown sequence %lu.", seqId);
+        return it->second;
+    }
+
+    SizeType32 mTokensPerBlock;
+    SizeType32 mSinkTokenLength;
+    // Number of tokens padding the sink tokens to a full block
+    SizeType32 mBubbleLength;
+    SizeType32 mNumSinkBlocks;
+    // Number of tokens in the ring of cyclic blocks
+    SizeType32 mCyclicLength;
+    SizeType32 mMaxBlocksPerSeq;
+    SizeType32 mNumUsedBlocks{0};
+    std::unordered_map<SequenceIdType, Sequence> mSequences;
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
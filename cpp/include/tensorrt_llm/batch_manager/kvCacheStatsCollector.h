@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/batch_manager/kvCacheManager.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Derives the reuse and block lifecycle stats of the KV cache over an iteration from snapshots of its block
+//! manager, taken at the end of every iteration.
+//! \details The block manager counts the allocations and reuses since its creation, the collector reports the
+//! difference between consecutive snapshots. Onboarding and offloading are detected from the blocks that changed pool
+//! between snapshots, a block moved there and back within an iteration isn't counted. The age of a free block counts
+//! from the last snapshot in which a sequence held it. A snapshot visits every block.
+class KvCacheStatsCollector
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using KvCacheReuseStats = executor::KvCacheReuseStats;
+
+    static constexpr SizeType32 kNUM_AGE_BUCKETS = 16;
+
+    struct Snapshot
+    {
+        std::size_t numAllocTotalBlocks{0};
+        std::size_t numAllocNewBlocks{0};
+        SizeType32 numSecondaryBlocks{0};
+        SizeType32 numFreeSecondaryBlocks{0};
+        //! Whether each block, by id, is in the primary pool
+        std::vector<bool> isPrimary;
+        //! Whether a sequence holds each block, by id
+        std::vector<bool> hasRefs;
+    };
+
+    explicit KvCacheStatsCollector(SizeType32 tokensPerBlock)
+        : mTokensPerBlock{tokensPerBlock}
+    {
+        TLLM_CHECK_WITH_INFO(tokensPerBlock > 0, "tokensPerBlock must be positive.");
+    }
+
+    [[nodiscard]] static Snapshot takeSnapshot(kv_cache_manager::BlockManager const& blockManager)
+    {
+        Snapshot snapshot;
+        snapshot.numAllocTotalBlocks = blockManager.getNumAllocTotalBlocks();
+        snapshot.numAllocNewBlocks = blockManager.getNumAllocNewBlocks();
+        snapshot.numSecondaryBlocks = blockManager.getNumSecondaryBlocks();
+        snapshot.numFreeSecondaryBlocks = blockManager.getNumFreeSecondaryBlocks();
+        auto const& blocks = blockManager.getAllBlocks();
+        snapshot.isPrimary.reserve(blocks.size());
+        snapshot.hasRefs.reserve(blocks.size());
+        for (auto const& block : blocks)
+        {
+            snapshot.isPrimary.push_back(block->isPrimary());
+            snapshot.hasRefs.push_back(block->hasRefs());
+        }
+        return snapshot;
+    }
+
+    //! \brief Ends the current iteration.
+    //! \param snapshot The state of the block manager at the end of the iteration.
+    //! \returns The stats of the iteration.
+    KvCacheReuseStats endIteration(Snapshot snapshot)
+    {
+        auto const numBlocks = snapshot.isPrimary.size();
+        TLLM_CHECK_WITH_INFO(snapshot.hasRefs.size() == numBlocks, "The snapshot must have the state of every block.");
+        if (mPrevious)
+        {
+            TLLM_CHECK_WITH_INFO(mPrevious->isPrimary.size() == numBlocks, "The number of blocks can't change.");
+        }
+        mLastUsedIteration.resize(numBlocks, -1);
+
+        KvCacheReuseStats stats;
+        auto const previousTotal = mPrevious ? mPrevious->numAllocTotalBlocks : 0;
+        auto const previousNew = mPrevious ? mPrevious->numAllocNewBlocks : 0;
+        auto const numAllocated = snapshot.numAllocTotalBlocks - previousTotal;
+        auto const numReused = numAllocated - (snapshot.numAllocNewBlocks - previousNew);
+        stats.numAllocatedBlocks = static_cast<SizeType32>(numAllocated);
+        stats.numReusedBlocks = static_cast<SizeType32>(numReused);
+        stats.numReusedTokens = stats.numReusedBlocks * mTokensPerBlock;
+        stats.numSecondaryBlocks = snapshot.numSecondaryBlocks;
+        stats.numUsedSecondaryBlocks = snapshot.numSecondaryBlocks - snapshot.numFreeSecondaryBlocks;
+        stats.freeBlockAgeHistogram.assign(kNUM_AGE_BUCKETS, 0);
+
+        for (std::size_t id = 0; id < numBlocks; ++id)
+        {
+            if (mPrevious && mPrevious->isPrimary[id] != snapshot.isPrimary[id])
+            {
+                ++(snapshot.isPrimary[id] ? stats.numOnboardedBlocks : stats.numOffloadedBlocks);
+            }
+            if (snapshot.hasRefs[id])
+            {
+                mLastUsedIteration[id] = mIteration;
+            }
+            else if (snapshot.isPrimary[id] && mLastUsedIteration[id] >= 0)
+            {
+                ++stats.freeBlockAgeHistogram[getAgeBucket(mIteration - mLastUsedIteration[id])];
+            }
+        }
+
+        mPrevious = std::move(snapshot);
+        ++mIteration;
+        return stats;
+    }
+
+    [[nodiscard]] SizeType32 getTokensPerBlock() const noexcept
+    {
+        return mTokensPerBlock;
+    }
+
+private:
+    //! \returns 0 for an age of 0 iterations, i for an age in [2^(i-1), 2^i), the last bucket beyond.
+    [[nodiscard]] static SizeType32 getAgeBucket(std::int64_t age) noexcept
+    {
+        SizeType32 bucket{0};
+        while (age > 0 && bucket < kNUM_AGE_BUCKETS - 1)
+        {
+            age >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    SizeType32 mTokensPerBlock;
+    std::optional<Snapshot> mPrevious;
+    //! The iteration in which a sequence last held each block, -1 if never
+    std::vector<std::int64_t> mLastUsedIteration;
+    std::int64_t mIteration{0};
+};
+
+} // namespace tensorrt_llm::batch_manager
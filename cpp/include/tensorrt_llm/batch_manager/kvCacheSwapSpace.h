@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+enum class PreemptionMode
+{
+    //! Free the blocks of the paused request and recompute its context when it resumes.
+    kRECOMPUTE = 0,
+    //! Move the blocks of the paused request to the secondary pool and move them back when it resumes.
+    kSWAP = 1,
+};
+
+//! \brief Secondary pool blocks holding the KV cache of paused requests.
+//! \details Swapping a request out queues the offload of all its primary blocks into secondary blocks reserved for the
+//! request; its primary blocks can be released once the offloads have completed (see
+//! KVCacheTransferManager::syncMainStream). Swapping it back in queues the onboard of the secondary blocks into newly
+//! allocated primary blocks, in the same order, and returns the secondary blocks to the swap space. The swap space is
+//! separate from the secondary blocks used for reuse, so that swapped out requests can't be evicted.
+//!
+//! TTransferManager needs offload(primaryIdx, secondaryIdx) and onboard(secondaryIdx, primaryIdx), as provided by
+//! runtime::KVCacheTransferManager.
+class KVCacheSwapSpace
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using IdType = std::int32_t;
+    using RequestIdType = std::uint64_t;
+
+    //! \param secondaryBlockIds Secondary pool blocks dedicated to swapping.
+    explicit KVCacheSwapSpace(std::vector<IdType> secondaryBlockIds)
+        : mFreeBlocks{std::move(secondaryBlockIds)}
+    {
+    }
+
+    //! \brief Choose how to preempt a request.
+    //! \details Recomputing a context costs compute roughly proportional to its length, while swapping only costs a
+    //! PCIe round trip of its blocks, so long contexts are swapped as long as the swap space can hold them.
+    //! \param minTokensToSwap Contexts shorter than this are recomputed.
+    [[nodiscard]] PreemptionMode choosePreemptionMode(
+        SizeType32 numTokens, SizeType32 numBlocks, SizeType32 minTokensToSwap) const
+    {
+        return numTokens >= minTokensToSwap && canSwapOut(numBlocks) ? PreemptionMode::kSWAP
+                                                                     : PreemptionMode::kRECOMPUTE;
+    }
+
+    [[nodiscard]] bool canSwapOut(SizeType32 numBlocks) const noexcept
+    {
+        return numBlocks <= getNumFreeBlocks();
+    }
+
+    //! \brief Queue the offload of the primary blocks of a request.
+    template <typename TTransferManager>
+    void swapOut(RequestIdType requestId, std::vector<IdType> const& primaryBlockIds, TTransferManager& transferManager)
+    {
+        TLLM_CHECK_WITH_INFO(!isSwappedOut(requestId), "Request %lu is already swapped out.", requestId);
+        auto const numBlocks = static_cast<SizeType32>(primaryBlockIds.size());
+        TLLM_CHECK_WITH_INFO(canSwapOut(numBlocks), "Swap space can't hold %d more blocks, %d are free.", numBlocks,
+            getNumFreeBlocks());
+        std::vector<IdType> secondaryBlockIds(mFreeBlocks.end() - numBlocks, mFreeBlocks.end());
+        mFreeBlocks.resize(mFreeBlocks.size() - numBlocks);
+        for (SizeType32 i = 0; i < numBlocks; ++i)
+        {
+            transferManager.offload(primaryBlockIds[i], secondaryBlockIds[i]);
+        }
+        mSwappedOut.emplace(requestId, std::move(secondaryBlockIds));
+    }
+
+    //! \brief Queue the onboard of the blocks of a swapped out request into newly allocated primary blocks.
+    template <typename TTransferManager>
+    void swapIn(RequestIdType requestId, std::vector<IdType> const& primaryBlockIds, TTransferManager& transferManager)
+    {
+        auto it = mSwappedOut.find(requestId);
+        TLLM_CHECK_WITH_INFO(it != mSwappedOut.end(), "Request %lu is not swapped out.", requestId);
+        auto& secondaryBlockIds = it->second;
+        TLLM_CHECK_WITH_INFO(primaryBlockIds.size() == secondaryBlockIds.size(),
+            "Request %lu has %zu swapped blocks, %zu primary blocks given.", requestId, secondaryBlockIds.size(),
+            primaryBlockIds.size());
+        for (std::size_t i = 0; i < secondaryBlockIds.size(); ++i)
+        {
+            transferManager.onboard(secondaryBlockIds[i], primaryBlockIds[i]);
+        }
+        // Secondary blocks are only reused by later offloads, which are ordered after this onboard on the copy stream
+        mFreeBlocks.insert(mFreeBlocks.end(), secondaryBlockIds.begin(), secondaryBlockIds.end());
+        mSwappedOut.erase(it);
+    }
+
+    //! \brief Release the blocks of a swapped out request that won't resume, e.g. a cancelled one.
+    void drop(RequestIdType requestId)
+    {
+        auto it = mSwappedOut.find(requestId);
+        TLLM_CHECK_WITH_INFO(it != mSwappedOut.end(), "Request %lu is not swapped out.", requestId);
+        mFreeBlocks.insert(mFreeBlocks.end(), it->second.begin(), it->second.end());
+        mSwappedOut.erase(it);
+    }
+
+    [[nodiscard]] bool isSwappedOut(RequestIdType requestId) const
+    {
+        return mSwappedOut.count(requestId) > 0;
+    }
+
+    [[nodiscard]] SizeType32 getNumSwappedBlocks(RequestIdType requestId) const
+    {
+        auto it = mSwappedOut.find(requestId);
+        return it == mSwappedOut.end() ? 0 : static_cast<SizeType32>(it->second.size());
+    }
+
+    [[nodiscard]] SizeType32 getNumFreeBlocks() const noexcept
+    {
+        return static_cast<SizeType32>(mFreeBlocks.size());
+    }
+
+private:
+    std::vector<IdType> mFreeBlocks;
+    std::unordered_map<RequestIdType, std::vector<IdType>> mSwappedOut;
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
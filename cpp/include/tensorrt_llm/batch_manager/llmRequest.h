@@ -25,6 +25,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -63,6 +64,9 @@ public:
     using BeamTokens = std::vector<VecTokens>;
     using TensorPtr = TTensor;
     using LogitsPostProcessor = std::function<void(RequestIdType, TensorPtr&, BeamTokens const&, TStream)>;
+    //! Processes the logits of all participating requests of an iteration in one call.
+    using LogitsPostProcessorBatched = std::function<void(std::vector<RequestIdType> const&, std::vector<TensorPtr>&,
+        std::vector<std::reference_wrapper<BeamTokens const>> const&, TStream const&)>;
 
     GenericLlmRequest(RequestIdType requestId, SizeType32 maxNewTokens, std::shared_ptr<VecTokens> inputTokens,
         runtime::SamplingConfig const& samplingConfig, bool isStreaming, std::optional<SizeType32> endId = std::nullopt,
@@ -118,8 +122,15 @@ public:
     }
 
     GenericLlmRequest(RequestIdType requestId, executor::Request const& req)
+        : GenericLlmRequest(requestId, req, req.getInputTokenIds())
+    {
+    }
+
+private:
+    // executor::Request::getInputTokenIds returns a copy, take it once and move it into the beams.
+    GenericLlmRequest(RequestIdType requestId, executor::Request const& req, VecTokens inputTokens)
         : mRequestId(requestId)
-        , mPromptLen(req.getInputTokenIds().size())
+        , mPromptLen(inputTokens.size())
         , mMaxNewTokens(req.getMaxNewTokens())
         , mSamplingConfig(req.getSamplingConfig(), req.getExternalDraftTokensConfig())
         , mState(REQUEST_STATE_CONTEXT_INIT)
@@ -210,9 +221,10 @@ public:
             // NOTE: Draft acceptance threshold is stored in mSamplingConfig
         }
 
-        initialize(req.getInputTokenIds(), req.getOutputConfig().returnLogProbs);
+        initialize(std::move(inputTokens), req.getOutputConfig().returnLogProbs);
     }
 
+public:
     void validate(SizeType32 maxInputLen, SizeType32 maxSequenceLen, SizeType32 maxDraftLen,
         std::optional<SizeType32> maxEncoderInputLen = std::nullopt)
     {
@@ -999,10 +1011,11 @@ protected:
     SizeType32 mDecodingIter;
 
 private:
-    void initialize(VecTokens const& inputTokens, bool outputLogProbs)
+    void initialize(VecTokens inputTokens, bool outputLogProbs)
     {
-        // Scatter the input tokens to other beam
-        mTokens = BeamTokens(mSamplingConfig.beamWidth, inputTokens);
+        // Scatter the input tokens to other beam, the last beam takes ownership of them
+        mTokens = BeamTokens(mSamplingConfig.beamWidth - 1, inputTokens);
+        mTokens.push_back(std::move(inputTokens));
 
         if ((mPromptEmbeddingTable.has_value() && !mPromptVocabSize.has_value())
             || (!mPromptEmbeddingTable.has_value() && mPromptVocabSize.has_value()))
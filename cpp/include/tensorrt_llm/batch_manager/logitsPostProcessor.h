@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Run the logits post-processors of the requests of an iteration.
+//! \details Requests that opted into the batched post-processor are handed to it in a single call, the others run
+//! their own post-processor, if any. All callbacks get the same stream, so the caller only needs to synchronize with
+//! it once after this function.
+//! \param requests Requests of the iteration, LlmRequest or a type with the same interface.
+//! \param logits Logits of each request, indexed like requests.
+//! \param batchedRequestIds Ids of the requests that opted into the batched post-processor. Kept by the caller rather
+//! than in the requests, whose layout is fixed by the prebuilt batch manager library.
+//! \return true if any post-processor was called.
+template <typename TRequest, typename TTensorPtr, typename TStream>
+bool applyLogitsPostProcessors(std::vector<std::shared_ptr<TRequest>> const& requests, std::vector<TTensorPtr>& logits,
+    TStream const& stream, std::optional<typename TRequest::LogitsPostProcessorBatched> const& batchedPostProcessor,
+    std::unordered_set<typename TRequest::RequestIdType> const& batchedRequestIds)
+{
+    TLLM_CHECK_WITH_INFO(requests.size() == logits.size(), "Number of logits (%zu) and requests (%zu) do not match.",
+        logits.size(), requests.size());
+    bool invoked{false};
+
+    std::vector<typename TRequest::RequestIdType> batchedIds;
+    std::vector<TTensorPtr> batchedLogits;
+    std::vector<std::reference_wrapper<typename TRequest::BeamTokens const>> batchedTokens;
+    std::vector<std::size_t> batchedIndices;
+    for (std::size_t idx = 0; idx < requests.size(); ++idx)
+    {
+        auto const& request = requests[idx];
+        if (batchedPostProcessor && batchedRequestIds.count(request->mRequestId) != 0)
+        {
+            batchedIds.push_back(request->mRequestId);
+            batchedLogits.push_back(logits[idx]);
+            batchedTokens.emplace_back(request->getTokens());
+            batchedIndices.push_back(idx);
+        }
+        else if (request->mLogitsPostProcessor)
+        {
+            request->mLogitsPostProcessor.value()(request->mRequestId, logits[idx], request->getTokens(), stream);
+            invoked = true;
+        }
+    }
+
+    if (!batchedIds.empty())
+    {
+        batchedPostProcessor.value()(batchedIds, batchedLogits, batchedTokens, stream);
+        // The post-processor may have replaced the tensors
+        for (std::size_t i = 0; i < batchedIndices.size(); ++i)
+        {
+            logits[batchedIndices[i]] = std::move(batchedLogits[i]);
+        }
+        invoked = true;
+    }
+    return invoked;
+}
+
+} // namespace tensorrt_llm::batch_manager
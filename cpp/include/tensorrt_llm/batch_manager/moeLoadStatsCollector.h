@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Accumulates the number of tokens routed to every expert of the MoE layers, per iteration and in total.
+//! \details Every expert parallel rank reports the counts of its own experts, as accumulated by the MoE runner in
+//! `CutlassMoeFCRunnerInterface::expert_load_counts`. The counts of a replica slot are reported under the expert it
+//! holds. The totals are the input of `kernels::MoeReplicationPlan`.
+class MoeLoadStatsCollector
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using MoeLoadStats = executor::MoeLoadStats;
+
+    MoeLoadStatsCollector(SizeType32 numLayers, SizeType32 numExperts)
+        : mNumExperts{numExperts}
+    {
+        TLLM_CHECK_WITH_INFO(numLayers > 0, "numLayers must be positive.");
+        TLLM_CHECK_WITH_INFO(numExperts > 0, "numExperts must be positive.");
+        mIterationStats = makeStats(numLayers);
+        mTotalCounts.assign(numLayers, std::vector<std::int64_t>(numExperts, 0));
+    }
+
+    //! \brief Records the token counts of the experts [firstExpert, firstExpert + counts.size()) of a layer.
+    void recordLayer(SizeType32 layerIdx, SizeType32 firstExpert, std::vector<SizeType32> const& counts)
+    {
+        TLLM_CHECK_WITH_INFO(layerIdx >= 0 && layerIdx < static_cast<SizeType32>(mTotalCounts.size()),
+            "layerIdx (%d) is out of range.", layerIdx);
+        TLLM_CHECK_WITH_INFO(firstExpert >= 0 && firstExpert + static_cast<SizeType32>(counts.size()) <= mNumExperts,
+            "Experts [%d, %d) are out of range.", firstExpert, firstExpert + static_cast<SizeType32>(counts.size()));
+        auto& iterationCounts = mIterationStats.expertTokenCounts[layerIdx];
+        for (std::size_t i = 0; i < counts.size(); ++i)
+        {
+            iterationCounts[firstExpert + i] += counts[i];
+            mTotalCounts[layerIdx][firstExpert + i] += counts[i];
+        }
+    }
+
+    //! \brief Ends the current iteration.
+    //! \returns The stats of the iteration, the collector starts a new iteration.
+    MoeLoadStats endIteration()
+    {
+        auto iterationStats = std::move(mIterationStats);
+        mIterationStats = makeStats(static_cast<SizeType32>(mTotalCounts.size()));
+        return iterationStats;
+    }
+
+    //! \returns The token counts of every expert of a layer accumulated over all iterations.
+    [[nodiscard]] std::vector<std::int64_t> const& getTotalCounts(SizeType32 layerIdx) const
+    {
+        return mTotalCounts.at(layerIdx);
+    }
+
+    //! \brief Forgets the totals, e.g. after the replicas were placed for the current traffic.
+    void resetTotals()
+    {
+        for (auto& counts : mTotalCounts)
+        {
+            std::fill(counts.begin(), counts.end(), 0);
+        }
+    }
+
+private:
+    [[nodiscard]] MoeLoadStats makeStats(SizeType32 numLayers) const
+    {
+        MoeLoadStats stats;
+        stats.expertTokenCounts.assign(numLayers, std::vector<SizeType32>(mNumExperts, 0));
+        return stats;
+    }
+
+    SizeType32 mNumExperts;
+    MoeLoadStats mIterationStats;
+    std::vector<std::vector<std::int64_t>> mTotalCounts;
+};
+
+} // namespace tensorrt_llm::batch_manager
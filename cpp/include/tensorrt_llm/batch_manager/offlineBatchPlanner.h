@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Orders and packs the requests of an offline run, whose whole dataset is known up front.
+//! \details The prompts that share their first KV cache block are grouped so that they run close together and reuse
+//! the cached blocks of their prefix, lexicographically within the group so that longer shared prefixes are adjacent.
+//! The groups go by decreasing predicted total length, the long requests first, so that the run doesn't end with a
+//! few stragglers in an empty batch. The requests are released while their predicted blocks fit the KV cache: the
+//! first requests of the plan go first, and smaller ones of the next few fill the blocks left over, so the cache stays
+//! full without submission order deciding the batches.
+class OfflineBatchPlanner
+{
+public:
+    using SizeType32 = runtime::SizeType32;
+    using TokenIdType = runtime::TokenIdType;
+    using VecTokens = std::vector<TokenIdType>;
+
+    //! \param lookahead The requests of the plan considered to fill the leftover blocks, also the requests released
+    //! at once while the capacity of the KV cache is unknown.
+    OfflineBatchPlanner(SizeType32 tokensPerBlock, SizeType32 lookahead)
+        : mTokensPerBlock{tokensPerBlock}
+        , mLookahead{lookahead}
+    {
+        TLLM_CHECK_WITH_INFO(mTokensPerBlock > 0, "tokensPerBlock must be positive, got %d", mTokensPerBlock);
+        TLLM_CHECK_WITH_INFO(mLookahead > 0, "lookahead must be positive, got %d", mLookahead);
+    }
+
+    //! \brief Plans the order of the requests, replacing the requests of a previous plan.
+    //! \param outputLengths The predicted output length of each request, e.g. its maxNewTokens.
+    void plan(std::vector<VecTokens> const& prompts, std::vector<SizeType32> const& outputLengths)
+    {
+        TLLM_CHECK_WITH_INFO(prompts.size() == outputLengths.size(), "Every request needs a predicted output length.");
+        auto const numRequests = prompts.size();
+        mNumBlocks.resize(numRequests);
+        std::vector<SizeType32> totalLengths(numRequests);
+        for (std::size_t idx = 0; idx < numRequests; ++idx)
+        {
+            totalLengths[idx] = static_cast<SizeType32>(prompts[idx].size()) + outputLengths[idx];
+            mNumBlocks[idx] = (totalLengths[idx] + mTokensPerBlock - 1) / mTokensPerBlock;
+        }
+
+        // Prompts shorter than a block share nothing and form groups of their own
+        std::map<VecTokens, std::vector<std::size_t>> sharedGroups;
+        std::vector<std::vector<std::size_t>> groups;
+        for (std::size_t idx = 0; idx < numRequests; ++idx)
+        {
+            auto const& prompt = prompts[idx];
+            if (static_cast<SizeType32>(prompt.size()) >= mTokensPerBlock)
+            {
+                sharedGroups[VecTokens(prompt.begin(), prompt.begin() + mTokensPerBlock)].push_back(idx);
+            }
+            else
+            {
+                groups.push_back({idx});
+            }
+        }
+        for (auto& [firstBlock, group] : sharedGroups)
+        {
+            std::stable_sort(group.begin(), group.end(),
+                [&prompts](std::size_t lhs, std::size_t rhs) { return prompts[lhs] < prompts[rhs]; });
+            groups.push_back(std::move(group));
+        }
+
+        std::vector<SizeType32> maxLengths(groups.size());
+        std::vector<std::size_t> groupOrder(groups.size());
+        for (std::size_t group = 0; group < groups.size(); ++group)
+        {
+            for (auto const idx : groups[group])
+            {
+                maxLengths[group] = std::max(maxLengths[group], totalLengths[idx]);
+            }
+        }
+        std::iota(groupOrder.begin(), groupOrder.end(), 0);
+        std::stable_sort(groupOrder.begin(), groupOrder.end(),
+            [&maxLengths](std::size_t lhs, std::size_t rhs) { return maxLengths[lhs] > maxLengths[rhs]; });
+
+        mPending.clear();
+        for (auto const group : groupOrder)
+        {
+            mPending.insert(mPending.end(), groups[group].begin(), groups[group].end());
+        }
+        mNumInFlight = 0;
+        mNumInFlightBlocks = 0;
+    }
+
+    //! \brief Sets the blocks the requests in flight may take, e.g. the blocks of the KV cache.
+    void setMaxNumBlocks(SizeType32 maxNumBlocks)
+    {
+        TLLM_CHECK_WITH_INFO(maxNumBlocks > 0, "maxNumBlocks must be positive, got %d", maxNumBlocks);
+        mMaxNumBlocks = maxNumBlocks;
+    }
+
+    //! \returns The requests to submit now, in the order of submission.
+    [[nodiscard]] std::vector<std::size_t> next()
+    {
+        std::vector<std::size_t> released;
+        if (!mMaxNumBlocks)
+        {
+            while (!mPending.empty() && mNumInFlight < mLookahead)
+            {
+                released.push_back(mPending.front());
+                mPending.pop_front();
+                addInFlight(released.back());
+            }
+            return released;
+        }
+        SizeType32 numConsidered{0};
+        for (auto it = mPending.begin(); it != mPending.end() && numConsidered < mLookahead; ++numConsidered)
+        {
+            // A request larger than the cache runs alone
+            auto const fits = mNumInFlightBlocks + mNumBlocks[*it] <= mMaxNumBlocks.value() || mNumInFlight == 0;
+            if (fits)
+            {
+                released.push_back(*it);
+                addInFlight(*it);
+                it = mPending.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        return released;
+    }
+
+    //! \brief Releases the blocks of a completed request.
+    void complete(std::size_t requestIdx)
+    {
+        TLLM_CHECK(mNumInFlight > 0);
+        --mNumInFlight;
+        mNumInFlightBlocks -= mNumBlocks.at(requestIdx);
+    }
+
+    [[nodiscard]] bool isDone() const noexcept
+    {
+        return mPending.empty() && mNumInFlight == 0;
+    }
+
+    [[nodiscard]] std::size_t getNumPending() const noexcept
+    {
+        return mPending.size();
+    }
+
+    [[nodiscard]] SizeType32 getNumInFlightBlocks() const noexcept
+    {
+        return mNumInFlightBlocks;
+    }
+
+    //! \returns The blocks of a request at its predicted total length.
+    [[nodiscard]] SizeType32 getNumBlocks(std::size_t requestIdx) const
+    {
+        return mNumBlocks.at(requestIdx);
+    }
+
+private:
+    void addInFlight(std::size_t requestIdx)
+    {
+        ++mNumInFlight;
+        mNumInFlightBlocks += mNumBlocks[requestIdx];
+    }
+
+    SizeType32 mTokensPerBlock;
+    SizeType32 mLookahead;
+    std::optional<SizeType32> mMaxNumBlocks{std::nullopt};
+    std::vector<SizeType32> mNumBlocks;
+    //! Indices of the requests not submitted yet, in the planned order
+    std::deque<std::size_t> mPending;
+    SizeType32 mNumInFlight{0};
+    SizeType32 mNumInFlightBlocks{0};
+};
+
+} // namespace tensorrt_llm::batch_manager
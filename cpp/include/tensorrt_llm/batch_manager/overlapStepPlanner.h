@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/batch_manager/kvCacheManager.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Bookkeeping of an executor loop that prepares the host state of the next iteration while the GPU runs the
+//! current one.
+//! \details Once iteration N is enqueued, the generation batch of iteration N + 1 is prepared right away, assuming that
+//! no sequence of iteration N finishes: each sequence gets its next KV token (KVCacheManager::addToken), the block
+//! offsets of the batch are gathered and the inputs are filled, all without waiting for the decoder of iteration N.
+//! When the results of iteration N are synchronized, the sequences that finished are dropped from the prepared batch
+//! instead of preparing it again. Most iterations finish no sequence, so their preparation is hidden behind the GPU.
+//! Requests scheduled for their context in iteration N + 1 are prepared after the patch, as usual.
+class OverlapStepPlanner
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+
+    //! The rows of the prepared batch whose sequence finished in the iteration in flight.
+    struct Patch
+    {
+        //! Ascending rows of the prepared batch.
+        std::vector<SizeType32> rows;
+        //! The sequence slots of the rows.
+        std::vector<SizeType32> seqSlots;
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return rows.empty();
+        }
+    };
+
+    explicit OverlapStepPlanner(SizeType32 maxNumSequences)
+        : mRowOfSlot(maxNumSequences, kNO_ROW)
+    {
+        TLLM_CHECK_WITH_INFO(maxNumSequences > 0, "maxNumSequences must be positive.");
+    }
+
+    //! \brief Prepares the generation batch of the next iteration, assuming no sequence of the iteration in flight
+    //! finishes.
+    //! \param inFlightSlots The sequence slots of the generation requests of the iteration in flight, in batch order.
+    //! \returns The sequence slots of the next iteration in batch order. The caller adds one KV token to each of them
+    //! and prepares the inputs of these rows.
+    std::vector<SizeType32> const& speculate(std::vector<SizeType32> const& inFlightSlots)
+    {
+        TLLM_CHECK_WITH_INFO(!mPending, "The previous speculation has not been reconciled.");
+        for (auto const seqSlot : inFlightSlots)
+        {
+            TLLM_CHECK_WITH_INFO(seqSlot >= 0 && seqSlot < static_cast<SizeType32>(mRowOfSlot.size()),
+                "Sequence slot %d is out of range.", seqSlot);
+        }
+        clearRows();
+        mPrepared = inFlightSlots;
+        for (std::size_t row = 0; row < mPrepared.size(); ++row)
+        {
+            auto const seqSlot = mPrepared[row];
+            TLLM_CHECK_WITH_INFO(mRowOfSlot[seqSlot] == kNO_ROW, "Sequence slot %d is in the batch twice.", seqSlot);
+            mRowOfSlot[seqSlot] = static_cast<SizeType32>(row);
+        }
+        mPending = true;
+        ++mNumSpeculatedSteps;
+        return mPrepared;
+    }
+
+    //! \brief Patches the prepared batch with the results of the iteration in flight.
+    //! \param finishedSlots The sequence slots that finished in the iteration in flight, in any order. Slots that are
+    //! not in the prepared batch, e.g. of requests that finished with their context, are ignored.
+    //! \returns The rows to drop from the prepared batch, empty if the speculation holds. The caller removes the
+    //! speculative KV token of each dropped sequence (see rollbackKvCache) before releasing the sequence.
+    [[nodiscard]] Patch reconcile(std::vector<SizeType32> const& finishedSlots)
+    {
+        TLLM_CHECK_WITH_INFO(mPending, "There's no speculation to reconcile.");
+        mPending = false;
+
+        Patch patch;
+        for (auto const seqSlot : finishedSlots)
+        {
+            if (seqSlot < 0 || seqSlot >= static_cast<SizeType32>(mRowOfSlot.size()) || mRowOfSlot[seqSlot] == kNO_ROW)
+            {
+                continue;
+            }
+            patch.rows.push_back(mRowOfSlot[seqSlot]);
+        }
+        if (patch.empty())
+        {
+            return patch;
+        }
+        ++mNumPatchedSteps;
+
+        std::sort(patch.rows.begin(), patch.rows.end());
+        patch.rows.erase(std::unique(patch.rows.begin(), patch.rows.end()), patch.rows.end());
+        patch.seqSlots.reserve(patch.rows.size());
+        for (auto const row : patch.rows)
+        {
+            patch.seqSlots.push_back(mPrepared[row]);
+        }
+
+        clearRows();
+        auto const numRows = compact(mPrepared.data(), static_cast<SizeType32>(mPrepared.size()), 1, patch);
+        mPrepared.resize(numRows);
+        for (SizeType32 row = 0; row < numRows; ++row)
+        {
+            mRowOfSlot[mPrepared[row]] = row;
+        }
+        return patch;
+    }
+
+    //! \brief Drops the rows of the patch from a host buffer of the prepared batch, e.g. the block offsets.
+    //! \param data The buffer, [numRows, rowSize].
+    //! \returns The number of rows left, in the order of the batch.
+    template <typename T>
+    static SizeType32 compact(T* data, SizeType32 numRows, SizeType32 rowSize, Patch const& patch)
+    {
+        SizeType32 dstRow{0};
+        auto dropped = patch.rows.begin();
+        for (SizeType32 srcRow = 0; srcRow < numRows; ++srcRow)
+        {
+            if (dropped != patch.rows.end() && *dropped == srcRow)
+            {
+                ++dropped;
+                continue;
+            }
+            if (dstRow != srcRow)
+            {
+                std::memmove(data + static_cast<std::size_t>(dstRow) * rowSize,
+                    data + static_cast<std::size_t>(srcRow) * rowSize, sizeof(T) * rowSize);
+            }
+            ++dstRow;
+        }
+        return dstRow;
+    }
+
+    //! \brief Removes the speculative KV token of the dropped sequences.
+    static void rollbackKvCache(Patch const& patch, kv_cache_manager::KVCacheManager& kvCacheManager)
+    {
+        for (auto const seqSlot : patch.seqSlots)
+        {
+            kvCacheManager.removeToken(seqSlot);
+        }
+    }
+
+    //! The generation batch of the next iteration, patched once reconciled.
+    [[nodiscard]] std::vector<SizeType32> const& getPrepared() const noexcept
+    {
+        return mPrepared;
+    }
+
+    [[nodiscard]] bool isPending() const noexcept
+    {
+        return mPending;
+    }
+
+    [[nodiscard]] std::uint64_t getNumSpeculatedSteps() const noexcept
+    {
+        return mNumSpeculatedSteps;
+    }
+
+    //! The speculations that had to be patched, the others were used as prepared.
+    [[nodiscard]] std::uint64_t getNumPatchedSteps() const noexcept
+    {
+        return mNumPatchedSteps;
+    }
+
+private:
+    static constexpr SizeType32 kNO_ROW = -1;
+
+    void clearRows()
+    {
+        for (auto const seqSlot : mPrepared)
+        {
+            mRowOfSlot[seqSlot] = kNO_ROW;
+        }
+    }
+
+    std::vector<SizeType32> mPrepared;
+    //! The row of each sequence slot in the prepared batch, if any
+    std::vector<SizeType32> mRowOfSlot;
+    bool mPending{false};
+    std::uint64_t mNumSpeculatedSteps{0};
+    std::uint64_t mNumPatchedSteps{0};
+};
+
+} // namespace tensorrt_llm::batch_manager
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief The samples of a request that returns several sequences, merged into a single result.
+//!
+//! \details Each sample is generated as a request of its own with beam width 1 and a seed of its own, after a single
+//! prefill of the prompt. The final results of the samples are merged like the beams of a beam search: sequence i of
+//! the merged result is sample i. The context logits are the ones of the first sample, the generation logits aren't
+//! merged.
+class ParallelSampleGroup
+{
+public:
+    using SizeType32 = runtime::SizeType32;
+
+    explicit ParallelSampleGroup(SizeType32 numSamples)
+        : mResults(numSamples)
+    {
+        TLLM_CHECK_WITH_INFO(numSamples > 0, "numReturnSequences must be positive, got %d", numSamples);
+    }
+
+    //! \brief Records the final result of a sample.
+    //! \returns Whether all the samples have their final result.
+    bool addResult(SizeType32 sampleIdx, executor::Result result)
+    {
+        TLLM_CHECK(0 <= sampleIdx && sampleIdx < getNumSamples());
+        TLLM_CHECK_WITH_INFO(result.outputTokenIds.size() == 1, "A sample must have a single sequence.");
+        if (!mResults[sampleIdx])
+        {
+            ++mNumCompleted;
+        }
+        mResults[sampleIdx] = std::move(result);
+        return isComplete();
+    }
+
+    [[nodiscard]] bool isComplete() const noexcept
+    {
+        return mNumCompleted == getNumSamples();
+    }
+
+    [[nodiscard]] SizeType32 getNumSamples() const noexcept
+    {
+        return static_cast<SizeType32>(mResults.size());
+    }
+
+    //! \returns The final result of the request, with a sequence per sample.
+    [[nodiscard]] executor::Result merge() const
+    {
+        TLLM_CHECK_WITH_INFO(isComplete(), "The samples of the request are still generating.");
+        auto const& first = *mResults.front();
+        executor::Result merged{};
+        merged.isFinal = true;
+        merged.contextLogits = first.contextLogits;
+        merged.encoderOutput = first.encoderOutput;
+        if (first.cumLogProbs)
+        {
+            merged.cumLogProbs.emplace();
+        }
+        if (first.logProbs)
+        {
+            merged.logProbs.emplace();
+        }
+        for (auto const& result : mResults)
+        {
+            merged.outputTokenIds.push_back(result->outputTokenIds.front());
+            if (merged.cumLogProbs && result->cumLogProbs && !result->cumLogProbs->empty())
+            {
+                merged.cumLogProbs->push_back(result->cumLogProbs->front());
+            }
+            if (merged.logProbs && result->logProbs && !result->logProbs->empty())
+            {
+                merged.logProbs->push_back(result->logProbs->front());
+            }
+        }
+        return merged;
+    }
+
+    //! \returns The random seed of a sample, derived from the seed of the request, or from its id without one, so
+    //! that the samples of a request differ from each other and from the samples of other requests.
+    [[nodiscard]] static executor::RandomSeedType getSampleSeed(
+        std::optional<executor::RandomSeedType> seed, executor::IdType requestId, SizeType32 sampleIdx) noexcept
+    {
+        if (seed)
+        {
+            return *seed + static_cast<executor::RandomSeedType>(sampleIdx);
+        }
+        // SplitMix64 of the id and the index
+        auto z = requestId * 0x9e3779b97f4a7c15ULL + static_cast<executor::RandomSeedType>(sampleIdx);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    std::vector<std::optional<executor::Result>> mResults;
+    SizeType32 mNumCompleted{0};
+};
+
+} // namespace tensorrt_llm::batch_manager
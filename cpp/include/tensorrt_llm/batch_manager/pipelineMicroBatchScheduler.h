@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Assigns in-flight requests to the micro batches of a pipeline parallel model.
+//! \details There are at least ppSize micro batches, so that every stage has work while the others run. A request is
+//! ready when it's new or when the micro batch it ran in has left the last stage. The next micro batch to launch takes
+//! the ready requests up to an even share of the tokens of all requests, the rest waits for the next micro batch. So
+//! when requests of one micro batch finish early, the next launches refill it from the others instead of leaving the
+//! stages waiting on a small micro batch.
+//!
+//! With virtual stages, every rank holds numVirtualStages non-contiguous chunks of layers, the global stage of chunk v
+//! of rank r is v * ppSize + r. The micro batches are then run in groups of ppSize in the order of getRankStageOrder,
+//! which divides the pipeline bubble by numVirtualStages.
+class PipelineMicroBatchScheduler
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using RequestIdType = std::uint64_t;
+
+    struct MicroBatch
+    {
+        SizeType32 microBatchIdx;
+        std::vector<RequestIdType> requestIds;
+        SizeType32 numTokens{0};
+    };
+
+    struct StageTask
+    {
+        SizeType32 microBatchIdx;
+        SizeType32 virtualStage;
+    };
+
+    //! \param numMicroBatches 0 uses ppSize micro batches.
+    PipelineMicroBatchScheduler(SizeType32 ppSize, SizeType32 maxBatchSize, SizeType32 numVirtualStages = 1,
+        SizeType32 numMicroBatches = 0)
+        : mPpSize{ppSize}
+        , mMaxBatchSize{maxBatchSize}
+        , mNumVirtualStages{numVirtualStages}
+        , mNumMicroBatches{numMicroBatches > 0 ? numMicroBatches : ppSize}
+    {
+        TLLM_CHECK_WITH_INFO(ppSize > 0, "ppSize must be positive.");
+        TLLM_CHECK_WITH_INFO(maxBatchSize > 0, "maxBatchSize must be positive.");
+        TLLM_CHECK_WITH_INFO(numVirtualStages > 0, "numVirtualStages must be positive.");
+        TLLM_CHECK_WITH_INFO(mNumMicroBatches >= ppSize,
+            "%d micro batches can't keep the %d pipeline stages busy.", mNumMicroBatches, ppSize);
+        TLLM_CHECK_WITH_INFO(numVirtualStages == 1 || mNumMicroBatches % ppSize == 0,
+            "Virtual stages need a multiple of ppSize (%d) micro batches, got %d.", ppSize, mNumMicroBatches);
+        mMicroBatches.resize(mNumMicroBatches);
+        mInFlight.assign(mNumMicroBatches, false);
+    }
+
+    //! \brief Adds a new request, it's ready for the next micro batch.
+    //! \param numTokens Tokens of the request in its next step, the prompt or chunk length or the generated tokens.
+    void addRequest(RequestIdType requestId, SizeType32 numTokens)
+    {
+        auto const [it, inserted] = mRequests.emplace(requestId, RequestState{numTokens, std::nullopt});
+        TLLM_CHECK_WITH_INFO(inserted, "Request %lu is already scheduled.", requestId);
+        mReady.push_back(requestId);
+    }
+
+    //! \brief Updates the tokens of the next step of a request, e.g. once its context phase is done.
+    void updateRequest(RequestIdType requestId, SizeType32 numTokens)
+    {
+        getRequest(requestId).numTokens = numTokens;
+    }
+
+    //! \brief Removes a finished or cancelled request. A request in flight is dropped when its micro batch completes.
+    void removeRequest(RequestIdType requestId)
+    {
+        auto const it = mRequests.find(requestId);
+        TLLM_CHECK_WITH_INFO(it != mRequests.end(), "Request %lu is not scheduled.", requestId);
+        if (!it->second.microBatchIdx)
+        {
+            mReady.erase(std::find(mReady.begin(), mReady.end(), requestId));
+        }
+        mRequests.erase(it);
+    }
+
+    //! \brief Fills and launches the next micro batch that is not in flight.
+    //! \returns Nothing when all micro batches are in flight or no request is ready.
+    [[nodiscard]] std::optional<MicroBatch> launchNext()
+    {
+        if (mReady.empty())
+        {
+            return std::nullopt;
+        }
+        std::optional<SizeType32> slot;
+        for (SizeType32 i = 0; i < mNumMicroBatches && !slot; ++i)
+        {
+            auto const candidate = (mNextMicroBatch + i) % mNumMicroBatches;
+            if (!mInFlight[candidate])
+            {
+                slot = candidate;
+            }
+        }
+        if (!slot)
+        {
+            return std::nullopt;
+        }
+
+        // Even share of the tokens of all requests, in flight or not
+        SizeType32 totalTokens{0};
+        for (auto const& [requestId, request] : mRequests)
+        {
+            totalTokens += request.numTokens;
+        }
+        auto const targetTokens = std::max((totalTokens + mNumMicroBatches - 1) / mNumMicroBatches, 1);
+
+        MicroBatch microBatch{*slot, {}, 0};
+        std::vector<RequestIdType> waiting;
+        for (auto const requestId : mReady)
+        {
+            auto const numTokens = mRequests.at(requestId).numTokens;
+            bool const fits = microBatch.requestIds.empty() || microBatch.numTokens + numTokens <= targetTokens;
+            if (fits && static_cast<SizeType32>(microBatch.requestIds.size()) < mMaxBatchSize)
+            {
+                microBatch.requestIds.push_back(requestId);
+                microBatch.numTokens += numTokens;
+                mRequests.at(requestId).microBatchIdx = *slot;
+            }
+            else
+            {
+                waiting.push_back(requestId);
+            }
+        }
+        mReady = std::move(waiting);
+        mMicroBatches[*slot] = microBatch.requestIds;
+        mInFlight[*slot] = true;
+        mNextMicroBatch = (*slot + 1) % mNumMicroBatches;
+        return microBatch;
+    }
+
+    //! \brief Marks a micro batch as done with the last stage, its remaining requests are ready again.
+    void completeMicroBatch(SizeType32 microBatchIdx)
+    {
+        TLLM_CHECK_WITH_INFO(microBatchIdx >= 0 && microBatchIdx < mNumMicroBatches && mInFlight[microBatchIdx],
+            "Micro batch %d is not in flight.", microBatchIdx);
+        for (auto const requestId : mMicroBatches[microBatchIdx])
+        {
+            if (auto const it = mRequests.find(requestId); it != mRequests.end())
+            {
+                it->second.microBatchIdx = std::nullopt;
+                mReady.push_back(requestId);
+            }
+        }
+        mMicroBatches[microBatchIdx].clear();
+        mInFlight[microBatchIdx] = false;
+    }
+
+    //! \returns The (micro batch, virtual stage) pairs in the order every rank runs them, for numMicroBatches micro
+    //! batches. Without virtual stages, the micro batches in launch order.
+    [[nodiscard]] std::vector<StageTask> getRankStageOrder() const
+    {
+        std::vector<StageTask> order;
+        auto const groupSize = mPpSize * mNumVirtualStages;
+        for (SizeType32 task = 0; task < mNumMicroBatches * mNumVirtualStages; ++task)
+        {
+            auto const group = task / groupSize;
+            auto const inGroup = task % groupSize;
+            auto const microBatchIdx = mNumVirtualStages == 1 ? task : group * mPpSize + inGroup % mPpSize;
+            order.push_back(StageTask{microBatchIdx, mNumVirtualStages == 1 ? 0 : inGroup / mPpSize});
+        }
+        return order;
+    }
+
+    [[nodiscard]] SizeType32 getNumMicroBatches() const noexcept
+    {
+        return mNumMicroBatches;
+    }
+
+    [[nodiscard]] SizeType32 getNumInFlight() const
+    {
+        return static_cast<SizeType32>(std::count(mInFlight.begin(), mInFlight.end(), true));
+    }
+
+    [[nodiscard]] SizeType32 getNumReady() const noexcept
+    {
+        return static_cast<SizeType32>(mReady.size());
+    }
+
+private:
+    struct RequestState
+    {
+        SizeType32 numTokens;
+        //! Micro batch the request is in flight with.
+        std::optional<SizeType32> microBatchIdx;
+    };
+
+    RequestState& getRequest(RequestIdType requestId)
+    {
+        auto const it = mRequests.find(requestId);
+        TLLM_CHECK_WITH_INFO(it != mRequests.end(), "Request %lu is not scheduled.", requestId);
+        return it->second;
+    }
+
+    SizeType32 mPpSize;
+    SizeType32 mMaxBatchSize;
+    SizeType32 mNumVirtualStages;
+    SizeType32 mNumMicroBatches;
+    SizeType32 mNextMicroBatch{0};
+    std::map<RequestIdType, RequestState> mRequests;
+    //! Ready requests in the order they became ready.
+    std::vector<RequestIdType> mReady;
+    std::vector<std::vector<RequestIdType>> mMicroBatches;
+    std::vector<bool> mInFlight;
+};
+
+} // namespace tensorrt_llm::batch_manager
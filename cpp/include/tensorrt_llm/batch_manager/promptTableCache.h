@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/executor/tensor.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Cache of the prompt tuning tables of multimodal requests, e.g. image embeddings of VLMs, resident on the GPU.
+//!
+//! \details A table is uploaded once per content and shared by the requests that use it, so a repeated image skips
+//! the copy from the host. Tables are keyed by the hash of their content, or by an id of the caller, e.g. the hash of
+//! the image file, which spares hashing the embeddings. The least recently used tables are evicted beyond the
+//! capacity. Tables are reference counted, an evicted table stays valid for the requests in flight that hold it.
+class PromptTableCache
+{
+public:
+    using KeyType = std::uint64_t;
+    using CudaStreamPtr = executor::Tensor::CudaStreamPtr;
+
+    PromptTableCache(std::size_t capacityBytes, CudaStreamPtr stream)
+        : mCapacityBytes{capacityBytes}
+        , mStream{std::move(stream)}
+    {
+        TLLM_CHECK_WITH_INFO(mStream != nullptr, "PromptTableCache needs a stream for the uploads.");
+    }
+
+    //! \brief The config of a request using the table, uploaded to the GPU unless the cache holds it.
+    //! \param table The embedding table, [numTokens, hiddenSize], on the host unless key is given.
+    //! \param key Identifies the content of the table, hashed from the content if not given.
+    [[nodiscard]] executor::PromptTuningConfig getOrUpload(
+        executor::Tensor const& table, std::optional<KeyType> key = std::nullopt)
+    {
+        if (!key)
+        {
+            TLLM_CHECK_WITH_INFO(table.getMemoryType() != executor::MemoryType::kGPU,
+                "A prompt table on the GPU needs a key, its content can't be hashed on the host.");
+            key = hashTable(table);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (auto const cached = findLocked(*key))
+            {
+                ++mNumHits;
+                return executor::PromptTuningConfig{*cached};
+            }
+        }
+        // Uploaded outside the lock, concurrent misses of a key both upload and the first insertion wins
+        auto deviceTable = table.getMemoryType() == executor::MemoryType::kGPU ? table : table.copyToGpu(mStream);
+        mStream->synchronize();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mNumMisses;
+        if (auto const cached = findLocked(*key))
+        {
+            return executor::PromptTuningConfig{*cached};
+        }
+        auto const sizeInBytes = deviceTable.getSizeInBytes();
+        mLru.emplace_front(*key, deviceTable);
+        mEntries.emplace(*key, mLru.begin());
+        mResidentBytes += sizeInBytes;
+        evictLocked();
+        return executor::PromptTuningConfig{std::move(deviceTable)};
+    }
+
+    //! \returns Whether the cache holds the table of the key, without touching its recency.
+    [[nodiscard]] bool contains(KeyType key) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mEntries.count(key) != 0;
+    }
+
+    //! \brief Drops the table of the key, e.g. when the image is withdrawn.
+    bool erase(KeyType key)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto const it = mEntries.find(key);
+        if (it == mEntries.end())
+        {
+            return false;
+        }
+        mResidentBytes -= it->second->second.getSizeInBytes();
+        mLru.erase(it->second);
+        mEntries.erase(it);
+        return true;
+    }
+
+    //! \brief Hash of the content of a table on the host, with its data type and shape.
+    [[nodiscard]] static KeyType hashTable(executor::Tensor const& table)
+    {
+        auto hash = mix(kHASH_SEED, static_cast<std::uint64_t>(table.getDataType()));
+        for (auto const dim : table.getShape())
+        {
+            hash = mix(hash, static_cast<std::uint64_t>(dim));
+        }
+        auto const* bytes = static_cast<std::uint8_t const*>(table.getData());
+        auto const size = table.getSizeInBytes();
+        std::size_t offset = 0;
+        for (; offset + sizeof(std::uint64_t) <= size; offset += sizeof(std::uint64_t))
+        {
+            std::uint64_t word;
+            std::memcpy(&word, bytes + offset, sizeof(word));
+            hash = mix(hash, word);
+        }
+        std::uint64_t tail{0};
+        if (offset < size)
+        {
+            std::memcpy(&tail, bytes + offset, size - offset);
+        }
+        return mix(hash, tail ^ size);
+    }
+
+    [[nodiscard]] std::size_t getNumHits() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mNumHits;
+    }
+
+    [[nodiscard]] std::size_t getNumMisses() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mNumMisses;
+    }
+
+    [[nodiscard]] std::size_t getNumTables() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mEntries.size();
+    }
+
+    [[nodiscard]] std::size_t getResidentBytes() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mResidentBytes;
+    }
+
+    [[nodiscard]] std::size_t getCapacityBytes() const noexcept
+    {
+        return mCapacityBytes;
+    }
+
+private:
+    using Lru = std::list<std::pair<KeyType, executor::Tensor>>;
+
+    static constexpr std::uint64_t kHASH_SEED = 0x9e3779b97f4a7c15ULL;
+
+    //! Multiply-xorshift of the words of the content, fast enough for tables of several MB per request
+    [[nodiscard]] static std::uint64_t mix(std::uint64_t hash, std::uint64_t word) noexcept
+    {
+        hash ^= word + kHASH_SEED + (hash << 6) + (hash >> 2);
+        hash *= 0xff51afd7ed558ccdULL;
+        return hash ^ (hash >> 33);
+    }
+
+    //! \brief The table of the key, moved to the front of the LRU list. Needs mMutex.
+    [[nodiscard]] std::optional<executor::Tensor> findLocked(KeyType key)
+    {
+        auto const it = mEntries.find(key);
+        if (it == mEntries.end())
+        {
+            return std::nullopt;
+        }
+        mLru.splice(mLru.begin(), mLru, it->second);
+        return it->second->second;
+    }
+
+    //! \brief Evicts the least recently used tables beyond the capacity, never the most recent one. Needs mMutex.
+    void evictLocked()
+    {
+        while (mResidentBytes > mCapacityBytes && mLru.size() > 1)
+        {
+            auto const& [key, table] = mLru.back();
+            mResidentBytes -= table.getSizeInBytes();
+            mEntries.erase(key);
+            mLru.pop_back();
+        }
+    }
+
+    std::size_t mCapacityBytes;
+    CudaStreamPtr mStream;
+
+    mutable std::mutex mMutex;
+    //! Most recently used first
+    Lru mLru;
+    std::unordered_map<KeyType, Lru::iterator> mEntries;
+    std::size_t mResidentBytes{0};
+    std::size_t mNumHits{0};
+    std::size_t mNumMisses{0};
+};
+
+} // namespace tensorrt_llm::batch_manager
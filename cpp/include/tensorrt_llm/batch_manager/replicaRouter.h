@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/batch_manager/kvCachePrefixSummary.h"
+#include "tensorrt_llm/batch_manager/kvCacheRadixTree.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Routes the requests of a shared admission queue to data parallel replicas of a model.
+//!
+//! \details A request goes to the replica that keeps the most free KV cache blocks once it is admitted, counting the
+//! blocks of its prompt that the replica already caches as free, plus a bonus per cached block for the prefill they
+//! spare. Without any cached prefix this is the replica with the most free blocks. A hot prefix pulls its requests to
+//! one replica until that replica runs short of blocks, then they spill over to the others.
+//!
+//! The free blocks of a replica come from its KV cache stats, which lag behind the routing. The blocks of the requests
+//! routed since are reserved until the replica reports them as used, i.e. until the request is scheduled. The cached
+//! prefixes of a replica are summarized from the prompts routed to it; since a Bloom filter can't forget, the summary
+//! is reset when it holds more blocks than the replica can cache.
+class ReplicaRouter
+{
+public:
+    using SizeType32 = runtime::SizeType32;
+    using TokenIdType = runtime::TokenIdType;
+    using BlockHashType = kv_cache_manager::BlockHashType;
+
+    struct Decision
+    {
+        SizeType32 replica;
+        //! Leading blocks of the prompt estimated to be cached by the replica
+        SizeType32 numMatchedBlocks;
+        //! Blocks reserved on the replica for the request, to be released once it is scheduled
+        SizeType32 numReservedBlocks;
+    };
+
+    //! \param prefixWeight Bonus per cached block of the prompt, in free blocks.
+    //! \param summaryBits Size of the prefix summary of each replica, see PrefixCacheSummary.
+    ReplicaRouter(SizeType32 numReplicas, SizeType32 tokensPerBlock, float prefixWeight = 1.f,
+        SizeType32 summaryBits = 1 << 20, SizeType32 summaryHashes = 7)
+        : mTokensPerBlock{tokensPerBlock}
+        , mPrefixWeight{prefixWeight}
+        , mReplicas(numReplicas, Replica{kv_cache_manager::PrefixCacheSummary{summaryBits, summaryHashes}})
+    {
+        TLLM_CHECK_WITH_INFO(numReplicas > 0, "numReplicas must be positive, got %d", numReplicas);
+        TLLM_CHECK_WITH_INFO(mTokensPerBlock > 0, "tokensPerBlock must be positive, got %d", mTokensPerBlock);
+        TLLM_CHECK_WITH_INFO(mPrefixWeight >= 0.f, "prefixWeight must not be negative");
+    }
+
+    //! \brief Updates the KV cache stats of a replica.
+    void updateStats(SizeType32 replica, SizeType32 freeNumBlocks, SizeType32 maxNumBlocks)
+    {
+        auto& state = getReplica(replica);
+        state.freeNumBlocks = freeNumBlocks;
+        state.maxNumBlocks = maxNumBlocks;
+        state.hasStats = true;
+    }
+
+    //! \brief Chooses the replica of a request, reserves its blocks there and records its prompt as cached there.
+    [[nodiscard]] Decision route(std::vector<TokenIdType> const& inputTokenIds)
+    {
+        auto const hashes = hashPrompt(inputTokenIds);
+        auto const numBlocks
+            = static_cast<SizeType32>((inputTokenIds.size() + mTokensPerBlock - 1) / mTokensPerBlock);
+
+        Decision best{0, 0, 0};
+        auto bestScore = std::numeric_limits<float>::lowest();
+        for (SizeType32 i = 0; i < static_cast<SizeType32>(mReplicas.size()); ++i)
+        {
+            auto const& state = mReplicas[i];
+            auto const numMatched = state.summary.getNumMatchedBlocks(hashes);
+            auto const numNew = numBlocks - numMatched;
+            // Replicas without stats yet are only told apart by their reservations
+            auto const available = (state.hasStats ? state.freeNumBlocks : 0) - state.numReservedBlocks;
+            auto const score = static_cast<float>(available - numNew) + mPrefixWeight * static_cast<float>(numMatched);
+            if (score > bestScore)
+            {
+                bestScore = score;
+                best = Decision{i, numMatched, numNew};
+            }
+        }
+
+        auto& state = mReplicas[best.replica];
+        state.numReservedBlocks += best.numReservedBlocks;
+        // Only the blocks missing from the summary count towards its capacity
+        auto const numNewHashes = static_cast<SizeType32>(hashes.size()) - best.numMatchedBlocks;
+        auto beginHash = best.numMatchedBlocks;
+        if (state.hasStats && state.numSummarizedBlocks + numNewHashes > state.maxNumBlocks)
+        {
+            state.summary.clear();
+            state.numSummarizedBlocks = 0;
+            beginHash = 0;
+        }
+        for (auto i = beginHash; i < static_cast<SizeType32>(hashes.size()); ++i)
+        {
+            state.summary.add(hashes[i]);
+        }
+        state.numSummarizedBlocks += static_cast<SizeType32>(hashes.size()) - beginHash;
+        return best;
+    }
+
+    //! \brief Releases the blocks reserved for a request, once the stats of the replica account for them.
+    void release(SizeType32 replica, SizeType32 numBlocks)
+    {
+        auto& state = getReplica(replica);
+        state.numReservedBlocks = std::max(state.numReservedBlocks - numBlocks, 0);
+    }
+
+    //! \returns The rolling hashes of the full blocks of the prompt.
+    [[nodiscard]] std::vector<BlockHashType> hashPrompt(std::vector<TokenIdType> const& inputTokenIds) const
+    {
+        auto const numFullBlocks = inputTokenIds.size() / mTokensPerBlock;
+        std::vector<BlockHashType> hashes;
+        hashes.reserve(numFullBlocks);
+        BlockHashType hash{0};
+        for (std::size_t b = 0; b < numFullBlocks; ++b)
+        {
+            hash = kv_cache_manager::hashBlockTokens(hash, inputTokenIds.data() + b * mTokensPerBlock, mTokensPerBlock);
+            hashes.push_back(hash);
+        }
+        return hashes;
+    }
+
+    [[nodiscard]] SizeType32 getNumReservedBlocks(SizeType32 replica) const
+    {
+        return getReplica(replica).numReservedBlocks;
+    }
+
+    [[nodiscard]] SizeType32 getNumReplicas() const noexcept
+    {
+        return static_cast<SizeType32>(mReplicas.size());
+    }
+
+    [[nodiscard]] SizeType32 getTokensPerBlock() const noexcept
+    {
+        return mTokensPerBlock;
+    }
+
+private:
+    struct Replica
+    {
+        kv_cache_manager::PrefixCacheSummary summary;
+        SizeType32 freeNumBlocks{0};
+        SizeType32 maxNumBlocks{0};
+        SizeType32 numReservedBlocks{0};
+        SizeType32 numSummarizedBlocks{0};
+        bool hasStats{false};
+    };
+
+    [[nodiscard]] Replica& getReplica(SizeType32 replica)
+    {
+        TLLM_CHECK_WITH_INFO(replica >= 0 && replica < getNumReplicas(), "Replica %d is out of range", replica);
+        return mReplicas[replica];
+    }
+
+    [[nodiscard]] Replica const& getReplica(SizeType32 replica) const
+    {
+        TLLM_CHECK_WITH_INFO(replica >= 0 && replica < getNumReplicas(), "Replica %d is out of range", replica);
+        return mReplicas[replica];
+    }
+
+    SizeType32 mTokensPerBlock;
+    float mPrefixWeight;
+    std::vector<Replica> mReplicas;
+};
+
+} // namespace tensorrt_llm::batch_manager
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Breaks down the latency of every request into its lifecycle stages.
+//! \details The batch manager reports the stage transitions with the time they happened. Waits can overlap with the
+//! queueing, the queueing time only counts what no wait explains, so that a TTFT regression can be attributed to a
+//! stage. Not thread safe, like the rest of the per-iteration bookkeeping.
+class RequestLatencyTracker
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using RequestIdType = std::uint64_t;
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using RequestLatencyStats = executor::RequestLatencyStats;
+
+    //! \brief Reasons a request can't make progress.
+    enum class WaitReason : std::uint8_t
+    {
+        kKV_CAPACITY = 0,
+        kLORA_LOAD = 1,
+        kKV_ONBOARD = 2,
+    };
+
+    void onArrival(RequestIdType requestId, TimePoint time)
+    {
+        auto const [it, inserted] = mRequests.try_emplace(requestId);
+        TLLM_CHECK_WITH_INFO(inserted, "Request %lu arrived twice.", requestId);
+        it->second.stats.id = requestId;
+        it->second.arrival = time;
+    }
+
+    void beginWait(RequestIdType requestId, WaitReason reason, TimePoint time)
+    {
+        auto& request = getRequest(requestId);
+        auto& begin = request.waitBegin[static_cast<std::size_t>(reason)];
+        if (!begin)
+        {
+            begin = time;
+        }
+    }
+
+    //! \brief Ends a wait, does nothing if the request wasn't waiting for this reason.
+    void endWait(RequestIdType requestId, WaitReason reason, TimePoint time)
+    {
+        auto& request = getRequest(requestId);
+        auto& begin = request.waitBegin[static_cast<std::size_t>(reason)];
+        if (!begin)
+        {
+            return;
+        }
+        auto const waitMs = toMs(time - *begin);
+        begin.reset();
+        switch (reason)
+        {
+        case WaitReason::kKV_CAPACITY: request.stats.kvCapacityWaitTimeMs += waitMs; break;
+        case WaitReason::kLORA_LOAD: request.stats.loraLoadWaitTimeMs += waitMs; break;
+        case WaitReason::kKV_ONBOARD: request.stats.kvOnboardWaitTimeMs += waitMs; break;
+        }
+        if (!request.scheduled)
+        {
+            request.queueWaitMs += waitMs;
+        }
+    }
+
+    //! \brief Ends the queueing, only the first scheduling of a request counts.
+    void onScheduled(RequestIdType requestId, TimePoint time)
+    {
+        auto& request = getRequest(requestId);
+        if (request.scheduled)
+        {
+            return;
+        }
+        request.scheduled = true;
+        auto const queueMs = toMs(time - request.arrival) - request.queueWaitMs;
+        request.stats.queueTimeMs = queueMs > 0.F ? queueMs : 0.F;
+    }
+
+    void recordContextChunk(RequestIdType requestId, TimePoint begin, TimePoint end)
+    {
+        getRequest(requestId).stats.contextChunkTimesMs.push_back(toMs(end - begin));
+    }
+
+    void recordGenerationStep(RequestIdType requestId, TimePoint begin, TimePoint end)
+    {
+        auto& stats = getRequest(requestId).stats;
+        stats.generationTimeMs += toMs(end - begin);
+        ++stats.numGenerationSteps;
+    }
+
+    void recordResponseSerialization(RequestIdType requestId, TimePoint begin, TimePoint end)
+    {
+        getRequest(requestId).stats.responseSerializationTimeMs += toMs(end - begin);
+    }
+
+    //! \brief Records the first token, later calls are ignored.
+    void onFirstToken(RequestIdType requestId, TimePoint time)
+    {
+        auto& request = getRequest(requestId);
+        if (!request.firstToken)
+        {
+            request.firstToken = true;
+            request.stats.timeToFirstTokenMs = toMs(time - request.arrival);
+        }
+    }
+
+    //! \brief Ends the tracking of a request.
+    //! \returns The breakdown of the request, the waits still open are closed at time.
+    RequestLatencyStats finish(RequestIdType requestId, TimePoint time)
+    {
+        for (std::size_t i = 0; i < kNumWaitReasons; ++i)
+        {
+            endWait(requestId, static_cast<WaitReason>(i), time);
+        }
+        auto const it = mRequests.find(requestId);
+        auto stats = std::move(it->second.stats);
+        stats.endToEndTimeMs = toMs(time - it->second.arrival);
+        mRequests.erase(it);
+        return stats;
+    }
+
+    //! \returns The breakdown so far of a request in flight.
+    [[nodiscard]] std::optional<RequestLatencyStats> getStats(RequestIdType requestId) const
+    {
+        auto const it = mRequests.find(requestId);
+        if (it == mRequests.end())
+        {
+            return std::nullopt;
+        }
+        return it->second.stats;
+    }
+
+    [[nodiscard]] std::size_t getNumRequests() const noexcept
+    {
+        return mRequests.size();
+    }
+
+private:
+    static constexpr std::size_t kNumWaitReasons = 3;
+
+    struct Request
+    {
+        RequestLatencyStats stats;
+        TimePoint arrival;
+        std::array<std::optional<TimePoint>, kNumWaitReasons> waitBegin;
+        //! Wait time before the first scheduling, taken out of the queueing time
+        float queueWaitMs{0.F};
+        bool scheduled{false};
+        bool firstToken{false};
+    };
+
+    static float toMs(Clock::duration duration)
+    {
+        return std::chrono::duration<float, std::milli>(duration).count();
+    }
+
+    Request& getRequest(RequestIdType requestId)
+    {
+        auto const it = mRequests.find(requestId);
+        TLLM_CHECK_WITH_INFO(it != mRequests.end(), "Request %lu is not tracked.", requestId);
+        return it->second;
+    }
+
+    std::unordered_map<RequestIdType, Request> mRequests;
+};
+
+} // namespace tensorrt_llm::batch_manager
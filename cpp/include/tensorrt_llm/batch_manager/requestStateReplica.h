@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Copy of the per-request scheduling state of the leader rank on every rank, kept in sync by deltas.
+//! \details Every iteration, the leader encodes only the requests that are new, finished or whose state changed
+//! since the previous delta, the other ranks apply the deltas in the same order. New requests carry an opaque
+//! payload, e.g. the serialized request, the others only their id and state. The format is a packed binary one:
+//!
+//!   header: iteration (u64), numNew (u32), numChanged (u32), numFinished (u32)
+//!   new:      requestId (u64), State, payloadSize (u64), payload bytes
+//!   changed:  requestId (u64), State
+//!   finished: requestId (u64)
+//!
+//! \tparam State Trivially copyable per-request state, compared bytewise.
+template <typename State>
+class RequestStateReplica
+{
+    static_assert(std::is_trivially_copyable_v<State>, "The state is copied bytewise into the deltas");
+
+public:
+    using RequestIdType = std::uint64_t;
+    using Payload = std::vector<char>;
+
+    struct Delta
+    {
+        std::uint64_t iteration{0};
+        std::vector<std::pair<RequestIdType, Payload>> newRequests;
+        std::vector<RequestIdType> changedRequests;
+        std::vector<RequestIdType> finishedRequests;
+    };
+
+    //! \brief Leader side. Encodes the changes from the previous delta to states, and takes states as the replica.
+    //! \param payloads Payloads of the requests that are new in states, requests without one get an empty payload.
+    [[nodiscard]] std::vector<char> encodeDelta(
+        std::map<RequestIdType, State> const& states, std::map<RequestIdType, Payload> const& payloads = {})
+    {
+        std::vector<std::pair<RequestIdType, State>> newRequests;
+        std::vector<std::pair<RequestIdType, State>> changedRequests;
+        std::vector<RequestIdType> finishedRequests;
+        for (auto const& [requestId, state] : states)
+        {
+            auto const it = mStates.find(requestId);
+            if (it == mStates.end())
+            {
+                newRequests.emplace_back(requestId, state);
+            }
+            else if (std::memcmp(&it->second, &state, sizeof(State)) != 0)
+            {
+                changedRequests.emplace_back(requestId, state);
+            }
+        }
+        for (auto const& [requestId, state] : mStates)
+        {
+            if (states.find(requestId) == states.end())
+            {
+                finishedRequests.push_back(requestId);
+            }
+        }
+
+        std::vector<char> delta;
+        append(delta, mIteration);
+        append(delta, static_cast<std::uint32_t>(newRequests.size()));
+        append(delta, static_cast<std::uint32_t>(changedRequests.size()));
+        append(delta, static_cast<std::uint32_t>(finishedRequests.size()));
+        for (auto const& [requestId, state] : newRequests)
+        {
+            append(delta, requestId);
+            append(delta, state);
+            auto const payload = payloads.find(requestId);
+            std::uint64_t const payloadSize = payload == payloads.end() ? 0 : payload->second.size();
+            append(delta, payloadSize);
+            if (payloadSize > 0)
+            {
+                delta.insert(delta.end(), payload->second.begin(), payload->second.end());
+            }
+        }
+        for (auto const& [requestId, state] : changedRequests)
+        {
+            append(delta, requestId);
+            append(delta, state);
+        }
+        for (auto const requestId : finishedRequests)
+        {
+            append(delta, requestId);
+        }
+
+        mStates = states;
+        ++mIteration;
+        return delta;
+    }
+
+    //! \brief Other ranks. Applies the next delta of the leader.
+    //! \returns The requests of the delta, so that the rank can create the new ones and drop the finished ones.
+    Delta applyDelta(char const* data, std::size_t size)
+    {
+        Reader reader{data, data + size};
+        Delta delta;
+        delta.iteration = reader.template read<std::uint64_t>();
+        TLLM_CHECK_WITH_INFO(delta.iteration == mIteration, "Expected the delta of iteration %lu, got iteration %lu.",
+            mIteration, delta.iteration);
+        auto const numNew = reader.template read<std::uint32_t>();
+        auto const numChanged = reader.template read<std::uint32_t>();
+        auto const numFinished = reader.template read<std::uint32_t>();
+        for (std::uint32_t i = 0; i < numNew; ++i)
+        {
+            auto const requestId = reader.template read<RequestIdType>();
+            mStates[requestId] = reader.template read<State>();
+            auto const payloadSize = reader.template read<std::uint64_t>();
+            delta.newRequests.emplace_back(requestId, reader.readBytes(payloadSize));
+        }
+        for (std::uint32_t i = 0; i < numChanged; ++i)
+        {
+            auto const requestId = reader.template read<RequestIdType>();
+            mStates.at(requestId) = reader.template read<State>();
+            delta.changedRequests.push_back(requestId);
+        }
+        for (std::uint32_t i = 0; i < numFinished; ++i)
+        {
+            auto const requestId = reader.template read<RequestIdType>();
+            mStates.erase(requestId);
+            delta.finishedRequests.push_back(requestId);
+        }
+        TLLM_CHECK_WITH_INFO(reader.done(), "%zu trailing bytes after the delta.", reader.remaining());
+        ++mIteration;
+        return delta;
+    }
+
+    [[nodiscard]] std::map<RequestIdType, State> const& getStates() const noexcept
+    {
+        return mStates;
+    }
+
+    //! \returns The iteration of the next delta.
+    [[nodiscard]] std::uint64_t getIteration() const noexcept
+    {
+        return mIteration;
+    }
+
+private:
+    template <typename T>
+    static void append(std::vector<char>& buffer, T const& value)
+    {
+        auto const* bytes = reinterpret_cast<char const*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    struct Reader
+    {
+        char const* pos;
+        char const* end;
+
+        template <typename T>
+        T read()
+        {
+            T value;
+            std::memcpy(&value, take(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        Payload readBytes(std::size_t size)
+        {
+            auto const* bytes = take(size);
+            return Payload(bytes, bytes + size);
+        }
+
+        char const* take(std::size_t size)
+        {
+            TLLM_CHECK_WITH_INFO(size <= remaining(), "Truncated delta.");
+            auto const* bytes = pos;
+            pos += size;
+            return bytes;
+        }
+
+        [[nodiscard]] std::size_t remaining() const noexcept
+        {
+            return static_cast<std::size_t>(end - pos);
+        }
+
+        [[nodiscard]] bool done() const noexcept
+        {
+            return pos == end;
+        }
+    };
+
+    std::map<RequestIdType, State> mStates;
+    std::uint64_t mIteration{0};
+};
+
+} // namespace tensorrt_llm::batch_manager
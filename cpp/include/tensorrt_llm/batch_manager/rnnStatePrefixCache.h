@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/batch_manager/kvCacheRadixTree.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+//! \brief Prefix caching of the recurrent states of hybrid models, e.g. RecurrentGemma, next to KV block reuse.
+//!
+//! \details The recurrent layers can't reuse a prefix from the KV blocks, they need their LRU and conv states right
+//! after it. These are kept as snapshots of the state store (typically runtime::RnnStateManager) under the hash of the
+//! KV block that ends the prefix (see hashBlockTokens), so a snapshot is found with the same key as the cached block
+//! and dropped when that block is evicted. Snapshots are only taken at every blocksPerSnapshot-th block boundary.
+//!
+//! The recurrent kernels only produce the state after the last token they scanned, so a snapshot can only be taken
+//! when a context chunk ends exactly on a boundary. getContextChunkEnd gives such chunk ends to the scheduler.
+//!
+//! \tparam TStateStore Provides saveSnapshot(key, requestId), restoreSnapshot(key, requestId) -> bool,
+//! hasSnapshot(key) -> bool and dropSnapshot(key) -> bool.
+template <typename TStateStore>
+class RnnStatePrefixCache
+{
+public:
+    using SizeType32 = runtime::SizeType32;
+    using TokenIdType = runtime::TokenIdType;
+    using RequestIdType = std::uint64_t;
+
+    RnnStatePrefixCache(TStateStore& store, SizeType32 tokensPerBlock, SizeType32 blocksPerSnapshot = 1)
+        : mStore{store}
+        , mTokensPerBlock{tokensPerBlock}
+        , mTokensPerSnapshot{tokensPerBlock * blocksPerSnapshot}
+    {
+        TLLM_CHECK_WITH_INFO(tokensPerBlock > 0, "tokensPerBlock must be positive.");
+        TLLM_CHECK_WITH_INFO(blocksPerSnapshot > 0, "blocksPerSnapshot must be positive.");
+    }
+
+    //! \brief Restores the states of the longest prefix of the prompt that has a snapshot into the request.
+    //! \details The last token of the prompt is never covered, since the context phase needs its logits.
+    //! \returns The number of prompt tokens the request can skip, 0 if there is no snapshot.
+    SizeType32 restore(RequestIdType requestId, TokenIdType const* tokens, SizeType32 numTokens)
+    {
+        BlockHashType hash = kRootBlockHash;
+        BlockHashType bestHash = kRootBlockHash;
+        SizeType32 bestNumTokens{0};
+        for (SizeType32 end = mTokensPerBlock; end < numTokens; end += mTokensPerBlock)
+        {
+            hash = hashBlockTokens(hash, tokens + end - mTokensPerBlock, mTokensPerBlock);
+            if (end % mTokensPerSnapshot == 0 && mStore.hasSnapshot(hash))
+            {
+                bestHash = hash;
+                bestNumTokens = end;
+            }
+        }
+        if (bestNumTokens == 0 || !mStore.restoreSnapshot(bestHash, requestId))
+        {
+            ++mNumMisses;
+            return 0;
+        }
+        ++mNumHits;
+        mNumReusedTokens += bestNumTokens;
+        return bestNumTokens;
+    }
+
+    SizeType32 restore(RequestIdType requestId, std::vector<TokenIdType> const& tokens)
+    {
+        return restore(requestId, tokens.data(), static_cast<SizeType32>(tokens.size()));
+    }
+
+    //! \brief Takes a snapshot of the request if its context so far ends on a snapshot boundary.
+    //! \param numProcessedTokens Number of prompt tokens scanned so far, i.e. the end of the last context chunk.
+    //! \returns True if a snapshot was taken.
+    bool save(RequestIdType requestId, TokenIdType const* tokens, SizeType32 numProcessedTokens)
+    {
+        if (numProcessedTokens == 0 || numProcessedTokens % mTokensPerSnapshot != 0)
+        {
+            return false;
+        }
+        BlockHashType hash = kRootBlockHash;
+        for (SizeType32 begin = 0; begin < numProcessedTokens; begin += mTokensPerBlock)
+        {
+            hash = hashBlockTokens(hash, tokens + begin, mTokensPerBlock);
+        }
+        if (!mStore.hasSnapshot(hash))
+        {
+            mStore.saveSnapshot(hash, requestId);
+        }
+        return true;
+    }
+
+    //! \brief End of the next context chunk of a prompt, shortened to the last snapshot boundary before the end of the
+    //! prompt if there is one in range, so that the chunk leaves the states of a reusable prefix.
+    [[nodiscard]] SizeType32 getContextChunkEnd(
+        SizeType32 numProcessedTokens, SizeType32 numTokens, SizeType32 maxChunkSize) const
+    {
+        auto const end = std::min(numTokens, numProcessedTokens + maxChunkSize);
+        auto const lastBoundary = std::min(end, numTokens - 1) / mTokensPerSnapshot * mTokensPerSnapshot;
+        return lastBoundary > numProcessedTokens ? lastBoundary : end;
+    }
+
+    //! \brief Drops the snapshot that ends with the block of hash, when that block leaves the reuse tree.
+    void onBlockEvicted(BlockHashType hash)
+    {
+        mStore.dropSnapshot(hash);
+    }
+
+    [[nodiscard]] std::size_t getNumHits() const noexcept
+    {
+        return mNumHits;
+    }
+
+    [[nodiscard]] std::size_t getNumMisses() const noexcept
+    {
+        return mNumMisses;
+    }
+
+    [[nodiscard]] std::size_t getNumReusedTokens() const noexcept
+    {
+        return mNumReusedTokens;
+    }
+
+private:
+    TStateStore& mStore;
+    SizeType32 mTokensPerBlock;
+    SizeType32 mTokensPerSnapshot;
+    std::size_t mNumHits{0};
+    std::size_t mNumMisses{0};
+    std::size_t mNumReusedTokens{0};
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Capacity scheduler honouring per-request priorities and latency deadlines.
+//! \details Every iteration, requests are admitted by decreasing priority, then earliest deadline first, until the
+//! request or KV cache block budget is exhausted. Within a priority, requests already generating are preferred over
+//! new ones with the same deadline so that equal traffic doesn't preempt itself. Generating requests that are not
+//! admitted are preempted: the caller pauses them and offloads their KV cache blocks to the secondary pool, they
+//! compete again in the next iteration. Interactive traffic with a higher priority therefore displaces batch
+//! generations as soon as it arrives instead of waiting for them to finish, like kMAX_UTILIZATION would.
+class SloAwareScheduler
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using RequestIdType = std::uint64_t;
+    using Clock = std::chrono::steady_clock;
+
+    static SizeType32 constexpr kDefaultPriority = 0;
+
+    struct Candidate
+    {
+        RequestIdType requestId;
+        //! Higher is more important.
+        SizeType32 priority{kDefaultPriority};
+        //! The request has started generating and holds KV cache blocks.
+        bool inProgress{false};
+        //! KV cache blocks the request needs to run this iteration, including the ones it already holds.
+        SizeType32 requiredBlocks{0};
+        //! Time by which the next token is due: arrival + TTFT target for new requests, last token + TPOT target for
+        //! generating ones.
+        std::optional<Clock::time_point> deadline{std::nullopt};
+    };
+
+    struct Schedule
+    {
+        std::vector<RequestIdType> scheduled;
+        //! Generating requests to pause, their blocks should be offloaded.
+        std::vector<RequestIdType> preempted;
+        //! Candidates whose deadline had already passed when scheduling.
+        SizeType32 numDeadlineMisses{0};
+    };
+
+    struct Stats
+    {
+        std::uint64_t numScheduled{0};
+        std::uint64_t numPreempted{0};
+        std::uint64_t numDeadlineMisses{0};
+    };
+
+    SloAwareScheduler(SizeType32 maxNumRequests, SizeType32 maxNumBlocks)
+        : mMaxNumRequests{maxNumRequests}
+        , mMaxNumBlocks{maxNumBlocks}
+    {
+        TLLM_CHECK_WITH_INFO(maxNumRequests > 0, "maxNumRequests must be positive.");
+        TLLM_CHECK_WITH_INFO(maxNumBlocks >= 0, "maxNumBlocks must not be negative.");
+    }
+
+    [[nodiscard]] Schedule schedule(std::vector<Candidate> const& candidates, Clock::time_point now = Clock::now())
+    {
+        std::vector<std::size_t> order(candidates.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+            [&candidates](std::size_t lhs, std::size_t rhs)
+            { return isMoreUrgent(candidates[lhs], candidates[rhs]); });
+
+        Schedule schedule;
+        SizeType32 numBlocks{0};
+        for (auto const idx : order)
+        {
+            auto const& candidate = candidates[idx];
+            if (candidate.deadline && candidate.deadline.value() < now)
+            {
+                ++schedule.numDeadlineMisses;
+            }
+            auto const fits = static_cast<SizeType32>(schedule.scheduled.size()) < mMaxNumRequests
+                && numBlocks + candidate.requiredBlocks <= mMaxNumBlocks;
+            if (fits)
+            {
+                numBlocks += candidate.requiredBlocks;
+                schedule.scheduled.push_back(candidate.requestId);
+            }
+            else if (candidate.inProgress)
+            {
+                schedule.preempted.push_back(candidate.requestId);
+            }
+        }
+
+        mStats.numScheduled += schedule.scheduled.size();
+        mStats.numPreempted += schedule.preempted.size();
+        mStats.numDeadlineMisses += schedule.numDeadlineMisses;
+        return schedule;
+    }
+
+    //! \brief Cumulative counters since construction, e.g. to report deadline misses with the iteration stats.
+    [[nodiscard]] Stats const& getStats() const noexcept
+    {
+        return mStats;
+    }
+
+private:
+    [[nodiscard]] static bool isMoreUrgent(Candidate const& lhs, Candidate const& rhs)
+    {
+        if (lhs.priority != rhs.priority)
+        {
+            return lhs.priority > rhs.priority;
+        }
+        if (lhs.deadline != rhs.deadline)
+        {
+            // Requests without deadline come last
+            return lhs.deadline && (!rhs.deadline || lhs.deadline.value() < rhs.deadline.value());
+        }
+        return lhs.inProgress && !rhs.inProgress;
+    }
+
+    SizeType32 mMaxNumRequests;
+    SizeType32 mMaxNumBlocks;
+    Stats mStats;
+};
+
+} // namespace tensorrt_llm::batch_manager
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Accumulates speculative decoding stats per iteration and per request.
+//! \details The collector doesn't depend on the speculative decoding mode: Medusa, lookahead, explicit and external
+//! draft tokens all report the number of draft tokens proposed and accepted for every request after verification.
+//! Draft and verification times are measured once per iteration for the whole batch, and are attributed to every
+//! request that was verified in the iteration.
+class SpecDecodingStatsCollector
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using RequestIdType = std::uint64_t;
+    using SpecDecodingStats = executor::SpecDecodingStats;
+
+    explicit SpecDecodingStatsCollector(SizeType32 maxDraftLen)
+        : mMaxDraftLen{maxDraftLen}
+    {
+        TLLM_CHECK_WITH_INFO(maxDraftLen > 0, "maxDraftLen must be positive.");
+        mIterationStats = makeStats();
+    }
+
+    //! \brief Records the verification result of one request in the current iteration.
+    //! \details Steps without draft tokens, e.g. the context phase, are not counted.
+    void recordStep(RequestIdType requestId, SizeType32 numDraftTokens, SizeType32 numAcceptedTokens)
+    {
+        TLLM_CHECK_WITH_INFO(numDraftTokens >= 0 && numDraftTokens <= mMaxDraftLen,
+            "numDraftTokens (%d) must be in [0, %d].", numDraftTokens, mMaxDraftLen);
+        TLLM_CHECK_WITH_INFO(numAcceptedTokens >= 0 && numAcceptedTokens <= numDraftTokens,
+            "numAcceptedTokens (%d) must be in [0, %d].", numAcceptedTokens, numDraftTokens);
+        if (numDraftTokens == 0)
+        {
+            return;
+        }
+        auto const it = mRequestStats.try_emplace(requestId, makeStats()).first;
+        addStep(it->second, numDraftTokens, numAcceptedTokens);
+        addStep(mIterationStats, numDraftTokens, numAcceptedTokens);
+        mIterationRequestIds.push_back(requestId);
+    }
+
+    void recordDraftTime(float timeMs)
+    {
+        mIterationStats.draftTimeMs += timeMs;
+    }
+
+    void recordVerificationTime(float timeMs)
+    {
+        mIterationStats.verificationTimeMs += timeMs;
+    }
+
+    //! \brief Ends the current iteration.
+    //! \returns The stats of the iteration, the collector starts a new iteration.
+    SpecDecodingStats endIteration()
+    {
+        for (auto const requestId : mIterationRequestIds)
+        {
+            // The request may have been removed after its last step.
+            auto const it = mRequestStats.find(requestId);
+            if (it != mRequestStats.end())
+            {
+                it->second.draftTimeMs += mIterationStats.draftTimeMs;
+                it->second.verificationTimeMs += mIterationStats.verificationTimeMs;
+            }
+        }
+        mIterationRequestIds.clear();
+        auto iterationStats = std::move(mIterationStats);
+        mIterationStats = makeStats();
+        return iterationStats;
+    }
+
+    //! \returns The stats accumulated over all iterations of a request, if any of its steps had draft tokens.
+    [[nodiscard]] std::optional<SpecDecodingStats> getRequestStats(RequestIdType requestId) const
+    {
+        auto const it = mRequestStats.find(requestId);
+        if (it == mRequestStats.end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    //! \brief Drops the stats of a finished request.
+    void removeRequest(RequestIdType requestId)
+    {
+        mRequestStats.erase(requestId);
+    }
+
+    [[nodiscard]] SizeType32 getMaxDraftLen() const noexcept
+    {
+        return mMaxDraftLen;
+    }
+
+private:
+    [[nodiscard]] SpecDecodingStats makeStats() const
+    {
+        SpecDecodingStats stats;
+        stats.acceptanceLengthHistogram.resize(mMaxDraftLen + 1, 0);
+        return stats;
+    }
+
+    static void addStep(SpecDecodingStats& stats, SizeType32 numDraftTokens, SizeType32 numAcceptedTokens)
+    {
+        stats.numDraftTokens += numDraftTokens;
+        stats.numAcceptedTokens += numAcceptedTokens;
+        stats.numRequestsWithDraftTokens++;
+        stats.acceptanceLengthHistogram[numAcceptedTokens]++;
+    }
+
+    SizeType32 mMaxDraftLen;
+    SpecDecodingStats mIterationStats;
+    //! Requests verified in the current iteration, they get the draft and verification times of the iteration.
+    std::vector<RequestIdType> mIterationRequestIds;
+    std::unordered_map<RequestIdType, SpecDecodingStats> mRequestStats;
+};
+
+} // namespace tensorrt_llm::batch_manager
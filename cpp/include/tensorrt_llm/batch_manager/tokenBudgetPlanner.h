@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager
+{
+
+//! \brief Splits a per-iteration token budget between generation and context chunks.
+//! \details Generation tokens are always scheduled first, the remaining budget is given to context chunks in order of
+//! the context requests. Chunk sizes adapt to the decode load: the more tokens are generated in an iteration, the
+//! smaller the chunks, so that a long prompt can't make the iteration, and therefore the inter-token latency of the
+//! ongoing generations, longer than the budget allows. A chunk is a multiple of chunkUnitSize (typically
+//! tokensPerBlock, so chunks end on KV cache block boundaries), except for the last chunk of a context.
+class TokenBudgetPlanner
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using RequestIdType = std::uint64_t;
+
+    struct ContextRequest
+    {
+        RequestIdType requestId;
+        //! Prompt tokens left to process after the previous chunks.
+        SizeType32 remainingLength;
+    };
+
+    struct ContextChunk
+    {
+        RequestIdType requestId;
+        SizeType32 chunkSize;
+    };
+
+    struct Plan
+    {
+        SizeType32 numGenerationTokens{0};
+        std::vector<ContextChunk> contextChunks;
+
+        [[nodiscard]] SizeType32 getNumTokens() const
+        {
+            auto numTokens = numGenerationTokens;
+            for (auto const& chunk : contextChunks)
+            {
+                numTokens += chunk.chunkSize;
+            }
+            return numTokens;
+        }
+    };
+
+    TokenBudgetPlanner(SizeType32 maxNumTokensPerIteration, SizeType32 chunkUnitSize)
+        : mMaxNumTokensPerIteration{maxNumTokensPerIteration}
+        , mChunkUnitSize{chunkUnitSize}
+    {
+        TLLM_CHECK_WITH_INFO(chunkUnitSize > 0, "chunkUnitSize must be positive.");
+        TLLM_CHECK_WITH_INFO(maxNumTokensPerIteration >= chunkUnitSize,
+            "The token budget (%d) is smaller than the chunk unit size (%d).", maxNumTokensPerIteration,
+            chunkUnitSize);
+    }
+
+    //! \param numGenerationTokens Tokens of all generation requests of the iteration, including draft tokens.
+    //! \param contextRequests Context requests in scheduling order.
+    [[nodiscard]] Plan plan(SizeType32 numGenerationTokens, std::vector<ContextRequest> const& contextRequests) const
+    {
+        Plan plan;
+        plan.numGenerationTokens = numGenerationTokens;
+        auto budget = std::max(mMaxNumTokensPerIteration - numGenerationTokens, 0);
+        for (auto const& request : contextRequests)
+        {
+            if (request.remainingLength <= 0)
+            {
+                continue;
+            }
+            SizeType32 chunkSize{0};
+            if (request.remainingLength <= budget)
+            {
+                chunkSize = request.remainingLength;
+            }
+            else
+            {
+                chunkSize = budget / mChunkUnitSize * mChunkUnitSize;
+            }
+            if (chunkSize == 0)
+            {
+                break;
+            }
+            plan.contextChunks.push_back(ContextChunk{request.requestId, chunkSize});
+            budget -= chunkSize;
+        }
+        return plan;
+    }
+
+    [[nodiscard]] SizeType32 getMaxNumTokensPerIteration() const noexcept
+    {
+        return mMaxNumTokensPerIteration;
+    }
+
+private:
+    SizeType32 mMaxNumTokensPerIteration;
+    SizeType32 mChunkUnitSize;
+};
+
+} // namespace tensorrt_llm::batch_manager
@@ -16,8 +16,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <optional>
 #include <stdexcept>
 #include <string>
 
@@ -101,8 +105,14 @@ private:
 #endif
     Level level_ = DEFAULT_LOG_LEVEL;
 
+    //! Whether records are handed to the AsyncLogWriter instead of being written by the caller (TLLM_LOG_ASYNC=1)
+    bool mAsync{false};
+
     Logger(); // NOLINT(modernize-use-equals-delete)
 
+    //! \brief Writes a formatted record, without its end of line.
+    void write(Level level, std::string record);
+
     static inline char const* getLevelName(const Level level)
     {
         switch (level)
@@ -133,17 +143,15 @@ void Logger::log(Logger::Level level, char const* format, Args const&... args)
 {
     if (level_ <= level)
     {
-        auto const fmt = getPrefix(level) + format;
-        auto& out = level_ < WARNING ? std::cout : std::cerr;
+        auto fmt = getPrefix(level) + format;
         if constexpr (sizeof...(args) > 0)
         {
-            out << fmtstr(fmt.c_str(), args...);
+            write(level, fmtstr(fmt.c_str(), args...));
         }
         else
         {
-            out << fmt;
+            write(level, std::move(fmt));
         }
-        out << std::endl;
     }
 }
 
@@ -152,21 +160,67 @@ void Logger::log(const Logger::Level level, int const rank, char const* format,
 {
     if (level_ <= level)
     {
-        auto const fmt = getPrefix(level, rank) + format;
-        auto& out = level_ < WARNING ? std::cout : std::cerr;
+        auto fmt = getPrefix(level, rank) + format;
         if constexpr (sizeof...(args) > 0)
         {
-            out << fmtstr(fmt.c_str(), args...);
+            write(level, fmtstr(fmt.c_str(), args...));
         }
         else
         {
-            out << fmt;
+            write(level, std::move(fmt));
         }
-        out << std::endl;
     }
 }
 
+//! \brief Limits the records of a call site to one per period, see TLLM_LOG_EVERY_MS.
+class LogRateLimiter
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit LogRateLimiter(std::chrono::milliseconds period)
+        : mPeriod{std::chrono::duration_cast<Clock::duration>(period).count()}
+    {
+    }
+
+    //! \returns The number of records suppressed since the previous one if a record may be written now, nullopt if
+    //! it's suppressed.
+    [[nodiscard]] std::optional<std::size_t> tryAcquire(Clock::time_point now = Clock::now())
+    {
+        auto const ticks = now.time_since_epoch().count();
+        auto next = mNext.load(std::memory_order_relaxed);
+        if (ticks < next || !mNext.compare_exchange_strong(next, ticks + mPeriod, std::memory_order_relaxed))
+        {
+            mNumSuppressed.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        return mNumSuppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::int64_t const mPeriod;
+    std::atomic<std::int64_t> mNext{0};
+    std::atomic<std::size_t> mNumSuppressed{0};
+};
+
 #define TLLM_LOG(level, ...) tensorrt_llm::common::Logger::getLogger()->log(level, __VA_ARGS__)
+//! Logs at most one record per periodMs from the call site, e.g. for records of every iteration
+#define TLLM_LOG_EVERY_MS(level, periodMs, ...)                                                                        \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        static tensorrt_llm::common::LogRateLimiter tllmLogRateLimiter{std::chrono::milliseconds{periodMs}};           \
+        if (tensorrt_llm::common::Logger::getLogger()->getLevel() <= (level))                                          \
+        {                                                                                                              \
+            if (auto const tllmNumSuppressed = tllmLogRateLimiter.tryAcquire())                                        \
+            {                                                                                                          \
+                TLLM_LOG(level, __VA_ARGS__);                                                                          \
+                if (*tllmNumSuppressed > 0)                                                                            \
+                {                                                                                                      \
+                    TLLM_LOG(level, "%zu records of %s:%d suppressed", *tllmNumSuppressed, __FILE__, __LINE__);        \
+                }                                                                                                      \
+            }                                                                                                          \
+        }                                                                                                              \
+    } while (0)
 #define TLLM_LOG_TRACE(...) TLLM_LOG(tensorrt_llm::common::Logger::TRACE, __VA_ARGS__)
 #define TLLM_LOG_DEBUG(...) TLLM_LOG(tensorrt_llm::common::Logger::DEBUG, __VA_ARGS__)
 #define TLLM_LOG_INFO(...) TLLM_LOG(tensorrt_llm::common::Logger::INFO, __VA_ARGS__)
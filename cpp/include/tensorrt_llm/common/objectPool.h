@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace tensorrt_llm::common
+{
+
+//! \brief Pool of reusable objects for the per-request and per-batch structures of the serving hot paths.
+//! \details Objects are created up front for the expected concurrency and handed out by acquire. When a handle is
+//! dropped, the object goes back to the pool instead of being destroyed, after the reset callback cleared it, so its
+//! vectors and other resources keep their capacity. The pool grows past its capacity under load, but keeps at most
+//! capacity free objects. The pool must outlive the handles it gave out.
+template <typename T>
+class ObjectPool
+{
+public:
+    class Recycler
+    {
+    public:
+        explicit Recycler(ObjectPool* pool = nullptr) noexcept
+            : mPool{pool}
+        {
+        }
+
+        void operator()(T* object) const
+        {
+            if (mPool != nullptr)
+            {
+                mPool->release(object);
+            }
+            else
+            {
+                delete object;
+            }
+        }
+
+    private:
+        ObjectPool* mPool;
+    };
+
+    using Ptr = std::unique_ptr<T, Recycler>;
+    using Reset = std::function<void(T&)>;
+
+    explicit ObjectPool(std::size_t capacity, Reset reset = {})
+        : mCapacity{capacity}
+        , mReset{std::move(reset)}
+    {
+        mFree.reserve(mCapacity);
+        for (std::size_t i = 0; i < mCapacity; ++i)
+        {
+            mFree.push_back(std::make_unique<T>());
+        }
+    }
+
+    ObjectPool(ObjectPool const&) = delete;
+    ObjectPool& operator=(ObjectPool const&) = delete;
+
+    //! \returns A free object, a new one if the pool is empty.
+    [[nodiscard]] Ptr acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!mFree.empty())
+            {
+                auto object = std::move(mFree.back());
+                mFree.pop_back();
+                ++mNumReused;
+                return Ptr{object.release(), Recycler{this}};
+            }
+            ++mNumCreated;
+        }
+        return Ptr{new T{}, Recycler{this}};
+    }
+
+    [[nodiscard]] std::size_t getNumFree() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mFree.size();
+    }
+
+    //! \returns The objects acquired from the free list.
+    [[nodiscard]] std::size_t getNumReused() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mNumReused;
+    }
+
+    //! \returns The objects created because the pool was empty, beyond the capacity.
+    [[nodiscard]] std::size_t getNumCreated() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mNumCreated;
+    }
+
+    [[nodiscard]] std::size_t getCapacity() const noexcept
+    {
+        return mCapacity;
+    }
+
+private:
+    void release(T* object)
+    {
+        std::unique_ptr<T> owned{object};
+        if (mReset)
+        {
+            mReset(*owned);
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mFree.size() < mCapacity)
+        {
+            mFree.push_back(std::move(owned));
+        }
+    }
+
+    std::size_t mCapacity;
+    Reset mReset;
+
+    mutable std::mutex mMutex;
+    std::vector<std::unique_ptr<T>> mFree;
+    std::size_t mNumReused{0};
+    std::size_t mNumCreated{0};
+};
+
+} // namespace tensorrt_llm::common
@@ -92,6 +92,25 @@ public:
         return QuantMode(BaseType(1u) << 8);
     }
 
+    // 4-bit kv cache with a scale and a zero point per group of channels. Reserved: the kv cache pools and the
+    // attention kernels don't support it yet.
+    static constexpr QuantMode int4KvCache() noexcept
+    {
+        return QuantMode(BaseType(1u) << 9);
+    }
+
+    // 4-bit floating point (e2m1) weights with a power of two scale per 32 weights.
+    static constexpr QuantMode mxfp4Weights() noexcept
+    {
+        return QuantMode(BaseType(1u) << 10);
+    }
+
+    // 4-bit floating point (e2m1) weights with an FP8 scale per 16 weights.
+    static constexpr QuantMode nvfp4Weights() noexcept
+    {
+        return QuantMode(BaseType(1u) << 11);
+    }
+
     constexpr BaseType value() const noexcept
     {
         return mValue;
@@ -152,9 +171,29 @@ public:
         return isSet(fp8Qdq());
     }
 
+    constexpr bool hasInt4KvCache() const noexcept
+    {
+        return isSet(int4KvCache());
+    }
+
+    constexpr bool hasMxfp4Weights() const noexcept
+    {
+        return isSet(mxfp4Weights());
+    }
+
+    constexpr bool hasNvfp4Weights() const noexcept
+    {
+        return isSet(nvfp4Weights());
+    }
+
+    constexpr bool hasFp4Weights() const noexcept
+    {
+        return hasMxfp4Weights() || hasNvfp4Weights();
+    }
+
     constexpr bool hasKvCacheQuant() const noexcept
     {
-        return hasInt8KvCache() || hasFp8KvCache();
+        return hasInt8KvCache() || hasFp8KvCache() || hasInt4KvCache();
     }
 
     static constexpr QuantMode fromDescription(bool quantizeWeights = false, bool quantizeActivations = false,
@@ -240,6 +279,14 @@ public:
         {
             quantMode = useWeightOnly(true, true);
         }
+        else if (quantAlgo == "W4A16_MXFP4")
+        {
+            quantMode = mxfp4Weights();
+        }
+        else if (quantAlgo == "W4A16_NVFP4")
+        {
+            quantMode = nvfp4Weights();
+        }
         else if (quantAlgo == "W8A8_SQ_PER_CHANNEL")
         {
             quantMode = useSmoothQuant(false, true);
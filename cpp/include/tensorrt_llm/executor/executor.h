@@ -26,6 +26,7 @@
 #include <list>
 #include <memory>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -835,6 +836,47 @@ public:
 
     /// @brief Utility function to convert a requestStats struct to a json serialized string
     [[nodiscard]] static std::string toJsonStr(RequestStats const& requestStats);
+
+    /// @brief Utility function to convert a requestLatencyStats struct to a json serialized string
+    [[nodiscard]] static std::string toJsonStr(RequestLatencyStats const& latencyStats)
+    {
+        std::ostringstream json;
+        json << "{\"id\":" << latencyStats.id << ",\"queueTimeMs\":" << latencyStats.queueTimeMs
+             << ",\"kvCapacityWaitTimeMs\":" << latencyStats.kvCapacityWaitTimeMs
+             << ",\"loraLoadWaitTimeMs\":" << latencyStats.loraLoadWaitTimeMs
+             << ",\"kvOnboardWaitTimeMs\":" << latencyStats.kvOnboardWaitTimeMs
+             << ",\"contextTimeMs\":" << latencyStats.getContextTimeMs() << ",\"contextChunkTimesMs\":[";
+        for (std::size_t i = 0; i < latencyStats.contextChunkTimesMs.size(); ++i)
+        {
+            json << (i > 0 ? "," : "") << latencyStats.contextChunkTimesMs[i];
+        }
+        json << "],\"generationTimeMs\":" << latencyStats.generationTimeMs
+             << ",\"numGenerationSteps\":" << latencyStats.numGenerationSteps
+             << ",\"responseSerializationTimeMs\":" << latencyStats.responseSerializationTimeMs
+             << ",\"timeToFirstTokenMs\":" << latencyStats.timeToFirstTokenMs
+             << ",\"endToEndTimeMs\":" << latencyStats.endToEndTimeMs << "}";
+        return json.str();
+    }
+
+    /// @brief Utility function to convert a kvCacheReuseStats struct to a json serialized string
+    [[nodiscard]] static std::string toJsonStr(KvCacheReuseStats const& reuseStats)
+    {
+        std::ostringstream json;
+        json << "{\"numAllocatedBlocks\":" << reuseStats.numAllocatedBlocks
+             << ",\"numReusedBlocks\":" << reuseStats.numReusedBlocks
+             << ",\"numReusedTokens\":" << reuseStats.numReusedTokens
+             << ",\"reuseHitRate\":" << reuseStats.getReuseHitRate()
+             << ",\"numOnboardedBlocks\":" << reuseStats.numOnboardedBlocks
+             << ",\"numOffloadedBlocks\":" << reuseStats.numOffloadedBlocks
+             << ",\"numUsedSecondaryBlocks\":" << reuseStats.numUsedSecondaryBlocks
+             << ",\"numSecondaryBlocks\":" << reuseStats.numSecondaryBlocks << ",\"freeBlockAgeHistogram\":[";
+        for (std::size_t i = 0; i < reuseStats.freeBlockAgeHistogram.size(); ++i)
+        {
+            json << (i > 0 ? "," : "") << reuseStats.freeBlockAgeHistogram[i];
+        }
+        json << "]}";
+        return json.str();
+    }
 };
 
 } // namespace tensorrt_llm::executor
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -55,6 +56,9 @@ using VecLogProbs = std::vector<FloatType>;
 using StreamPtr = std::shared_ptr<tensorrt_llm::runtime::CudaStream>;
 using LogitsPostProcessor = std::function<void(IdType, Tensor&, BeamTokens const&, StreamPtr&)>;
 using LogitsPostProcessorMap = std::unordered_map<std::string, LogitsPostProcessor>;
+/// @brief Called once per iteration with the ids, logits and tokens of all requests using it.
+using LogitsPostProcessorBatched = std::function<void(std::vector<IdType> const&, std::vector<Tensor>&,
+    std::vector<std::reference_wrapper<BeamTokens const>> const&, StreamPtr const&)>;
 using MedusaChoices = std::vector<std::vector<SizeType32>>;
 
 enum class DataType
@@ -260,6 +264,120 @@ struct InflightBatchingStats
     float avgNumDecodedTokensPerIter;
 };
 
+/// @brief Struct that holds the stats of speculative decoding, either for a single iteration or accumulated over the
+/// lifetime of a request
+struct SpecDecodingStats
+{
+    /// @brief Total number of draft tokens proposed
+    SizeType32 numDraftTokens{0};
+    /// @brief Total number of draft tokens accepted
+    SizeType32 numAcceptedTokens{0};
+    /// @brief Number of verification steps of requests that had draft tokens
+    SizeType32 numRequestsWithDraftTokens{0};
+    /// @brief Number of verification steps per accepted length, the entry at index i counts steps that accepted i draft
+    /// tokens, [maxDraftLen + 1]
+    std::vector<SizeType32> acceptanceLengthHistogram;
+    /// @brief Time spent generating draft tokens in milliseconds
+    float draftTimeMs{0.F};
+    /// @brief Time spent verifying draft tokens in milliseconds
+    float verificationTimeMs{0.F};
+
+    /// @brief Fraction of the proposed draft tokens that got accepted
+    [[nodiscard]] float getAcceptanceRate() const
+    {
+        return numDraftTokens > 0 ? static_cast<float>(numAcceptedTokens) / static_cast<float>(numDraftTokens) : 0.F;
+    }
+
+    /// @brief Average number of draft tokens accepted per verification step
+    [[nodiscard]] float getAvgAcceptanceLength() const
+    {
+        return numRequestsWithDraftTokens > 0
+            ? static_cast<float>(numAcceptedTokens) / static_cast<float>(numRequestsWithDraftTokens)
+            : 0.F;
+    }
+};
+
+/// @brief Struct that holds the number of tokens routed to every expert of the MoE layers, either for a single
+/// iteration or accumulated over several iterations
+struct MoeLoadStats
+{
+    /// @brief Number of tokens routed to every expert, [numLayers][numExperts]
+    std::vector<std::vector<SizeType32>> expertTokenCounts;
+
+    /// @brief Ratio of the most loaded expert parallel rank to the average rank, for the most imbalanced layer. Rank r
+    /// holds the experts [r * numExperts / epSize, (r + 1) * numExperts / epSize). 1 means perfectly balanced
+    [[nodiscard]] float getMaxRankImbalance(SizeType32 epSize) const
+    {
+        float maxImbalance = 1.F;
+        for (auto const& counts : expertTokenCounts)
+        {
+            auto const numExperts = static_cast<SizeType32>(counts.size());
+            if (epSize <= 0 || numExperts % epSize != 0)
+            {
+                continue;
+            }
+            SizeType32 const expertsPerRank = numExperts / epSize;
+            std::int64_t total = 0;
+            std::int64_t maxRank = 0;
+            for (SizeType32 rank = 0; rank < epSize; ++rank)
+            {
+                std::int64_t rankLoad = 0;
+                for (SizeType32 e = rank * expertsPerRank; e < (rank + 1) * expertsPerRank; ++e)
+                {
+                    rankLoad += counts[e];
+                }
+                total += rankLoad;
+                maxRank = std::max(maxRank, rankLoad);
+            }
+            if (total > 0)
+            {
+                maxImbalance = std::max(maxImbalance,
+                    static_cast<float>(maxRank) * static_cast<float>(epSize) / static_cast<float>(total));
+            }
+        }
+        return maxImbalance;
+    }
+};
+
+/// @brief Struct that holds the reuse and block lifecycle stats of the KV cache over an iteration
+struct KvCacheReuseStats
+{
+    /// @brief Number of blocks allocated to sequences
+    SizeType32 numAllocatedBlocks{0};
+    /// @brief Number of the allocated blocks reused from the cache with their values, their tokens skip the context
+    /// computation
+    SizeType32 numReusedBlocks{0};
+    /// @brief Number of tokens of the reused blocks
+    SizeType32 numReusedTokens{0};
+    /// @brief Number of blocks brought back from the secondary to the primary pool
+    SizeType32 numOnboardedBlocks{0};
+    /// @brief Number of blocks moved from the primary to the secondary pool
+    SizeType32 numOffloadedBlocks{0};
+    /// @brief Number of blocks of the secondary pool holding values, at the end of the iteration
+    SizeType32 numUsedSecondaryBlocks{0};
+    /// @brief Number of blocks of the secondary pool
+    SizeType32 numSecondaryBlocks{0};
+    /// @brief Number of free primary blocks by the number of iterations since they were released, bucket 0 counts the
+    /// blocks released in this iteration and bucket i > 0 the ones released [2^(i-1), 2^i) iterations ago, the last
+    /// bucket is open ended. Blocks that never held a sequence aren't counted
+    std::vector<SizeType32> freeBlockAgeHistogram;
+
+    /// @brief Fraction of the allocated blocks reused from the cache
+    [[nodiscard]] float getReuseHitRate() const
+    {
+        return numAllocatedBlocks > 0 ? static_cast<float>(numReusedBlocks) / static_cast<float>(numAllocatedBlocks)
+                                      : 0.F;
+    }
+
+    /// @brief Fraction of the secondary pool holding values
+    [[nodiscard]] float getSecondaryOccupancy() const
+    {
+        return numSecondaryBlocks > 0
+            ? static_cast<float>(numUsedSecondaryBlocks) / static_cast<float>(numSecondaryBlocks)
+            : 0.F;
+    }
+};
+
 /// @brief Struct that holds the stats of a single iteration
 struct IterationStats
 {
@@ -323,6 +441,46 @@ struct RequestStats
     bool paused;
 };
 
+/// @brief Struct that holds where the time of a request went, from its arrival to its last response
+/// @details The waits are not part of the queueing time, a request paused for KV cache capacity after it got scheduled
+/// adds to the KV cache capacity wait as well
+struct RequestLatencyStats
+{
+    /// @brief The request id
+    IdType id{0};
+    /// @brief Time spent queued before being scheduled for the first time, excluding the waits below, in milliseconds
+    float queueTimeMs{0.F};
+    /// @brief Time spent waiting for free KV cache blocks in milliseconds
+    float kvCapacityWaitTimeMs{0.F};
+    /// @brief Time spent waiting for the LoRA weights to be loaded in milliseconds
+    float loraLoadWaitTimeMs{0.F};
+    /// @brief Time spent waiting for reused KV cache blocks to be onboarded from the secondary memory in milliseconds
+    float kvOnboardWaitTimeMs{0.F};
+    /// @brief Time of each context chunk in milliseconds, a single entry without chunked context
+    std::vector<float> contextChunkTimesMs;
+    /// @brief Time spent in generation steps in milliseconds
+    float generationTimeMs{0.F};
+    /// @brief Number of generation steps
+    SizeType32 numGenerationSteps{0};
+    /// @brief Time spent serializing the responses in milliseconds
+    float responseSerializationTimeMs{0.F};
+    /// @brief Time from the arrival to the first token in milliseconds, 0 before the first token
+    float timeToFirstTokenMs{0.F};
+    /// @brief Time from the arrival to the last response in milliseconds, 0 before the request finished
+    float endToEndTimeMs{0.F};
+
+    /// @brief Time spent in the context phase over all the chunks
+    [[nodiscard]] float getContextTimeMs() const
+    {
+        float total{0.F};
+        for (auto const chunkTimeMs : contextChunkTimesMs)
+        {
+            total += chunkTimeMs;
+        }
+        return total;
+    }
+};
+
 /// @brief Struct that holds the stats of all requests in an iteration
 struct RequestStatsPerIteration
 {
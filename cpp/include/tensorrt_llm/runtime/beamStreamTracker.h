@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Streams the best beam of a beam search request as deltas, backtracking incrementally.
+//! \details The tokens of each step are added with the beams of the previous step they extend, as in the outputIds
+//! and parentIds of the decoder. The beams are kept as a tree of parent pointers, so a step is added in O(beamWidth)
+//! instead of gathering the beams over the whole generated length. A delta walks back from the best beam only until
+//! it meets the sequence already streamed: while the best beam extends it, a delta costs its new tokens, and a change
+//! of the best beam costs the tokens it rewrites.
+class BeamStreamTracker
+{
+public:
+    //! \brief The tokens of the best beam since the previous delta.
+    struct Delta
+    {
+        //! Position of the first token in the generated tokens. Below the number of tokens already streamed if the
+        //! best beam changed, the tokens from there on are replaced.
+        SizeType32 rewriteFrom{0};
+        std::vector<TokenIdType> tokens;
+        //! Whether tokens already streamed are replaced
+        bool rewrite{false};
+    };
+
+    explicit BeamStreamTracker(SizeType32 beamWidth)
+        : mBeamWidth{beamWidth}
+        , mLeaves(beamWidth, kNO_NODE)
+    {
+        TLLM_CHECK_WITH_INFO(mBeamWidth > 0, "beamWidth must be positive, got %d", mBeamWidth);
+    }
+
+    //! \brief Adds the tokens of the next step.
+    //! \param tokens [beamWidth], the token of each beam.
+    //! \param parents [beamWidth], the beam of the previous step each beam extends, ignored for the first step.
+    void addStep(TokenIdType const* tokens, SizeType32 const* parents)
+    {
+        std::vector<SizeType32> leaves(mBeamWidth);
+        for (SizeType32 beam = 0; beam < mBeamWidth; ++beam)
+        {
+            auto parent = kNO_NODE;
+            if (mNumSteps > 0)
+            {
+                TLLM_CHECK_WITH_INFO(parents[beam] >= 0 && parents[beam] < mBeamWidth,
+                    "Parent beam %d out of range [0, %d)", parents[beam], mBeamWidth);
+                parent = mLeaves[parents[beam]];
+            }
+            leaves[beam] = static_cast<SizeType32>(mNodes.size());
+            mNodes.push_back({tokens[beam], parent});
+        }
+        mLeaves = std::move(leaves);
+        ++mNumSteps;
+    }
+
+    //! \brief Adds the steps [beginStep, endStep) of a request from the [beamWidth, stride] layout of the outputIds and
+    //! parentIds of the decoder, e.g. copied to the host, with the step of a token at its position minus offset.
+    void addSteps(TokenIdType const* outputIds, SizeType32 const* parentIds, SizeType32 stride, SizeType32 offset,
+        SizeType32 beginStep, SizeType32 endStep)
+    {
+        std::vector<TokenIdType> tokens(mBeamWidth);
+        std::vector<SizeType32> parents(mBeamWidth);
+        for (auto step = beginStep; step < endStep; ++step)
+        {
+            for (SizeType32 beam = 0; beam < mBeamWidth; ++beam)
+            {
+                auto const idx = static_cast<std::size_t>(beam) * stride + offset + step;
+                tokens[beam] = outputIds[idx];
+                parents[beam] = parentIds[idx];
+            }
+            addStep(tokens.data(), parents.data());
+        }
+    }
+
+    //! \brief The tokens of the beam since the previous delta, which becomes the streamed sequence.
+    //! \param bestBeam The current best beam, beam 0 for the sorted beams of the beam search layer.
+    [[nodiscard]] Delta takeDelta(SizeType32 bestBeam = 0)
+    {
+        TLLM_CHECK_WITH_INFO(bestBeam >= 0 && bestBeam < mBeamWidth, "Beam %d out of range [0, %d)", bestBeam,
+            mBeamWidth);
+        // Walks back to the last node shared with the streamed sequence, collecting the tokens after it
+        std::vector<SizeType32> newNodes;
+        auto node = mNumSteps > 0 ? mLeaves[bestBeam] : kNO_NODE;
+        auto depth = mNumSteps - 1;
+        while (node != kNO_NODE && !(depth < static_cast<SizeType32>(mStreamed.size()) && mStreamed[depth] == node))
+        {
+            newNodes.push_back(node);
+            node = mNodes[node].parent;
+            --depth;
+        }
+        Delta delta;
+        delta.rewriteFrom = depth + 1;
+        delta.rewrite = delta.rewriteFrom < static_cast<SizeType32>(mStreamed.size());
+        mStreamed.resize(delta.rewriteFrom);
+        delta.tokens.reserve(newNodes.size());
+        for (auto it = newNodes.rbegin(); it != newNodes.rend(); ++it)
+        {
+            delta.tokens.push_back(mNodes[*it].token);
+            mStreamed.push_back(*it);
+        }
+        return delta;
+    }
+
+    //! \brief All the tokens of a beam, backtracked over the whole length.
+    [[nodiscard]] std::vector<TokenIdType> getBeam(SizeType32 beam) const
+    {
+        TLLM_CHECK_WITH_INFO(beam >= 0 && beam < mBeamWidth, "Beam %d out of range [0, %d)", beam, mBeamWidth);
+        std::vector<TokenIdType> tokens;
+        tokens.reserve(mNumSteps);
+        for (auto node = mNumSteps > 0 ? mLeaves[beam] : kNO_NODE; node != kNO_NODE; node = mNodes[node].parent)
+        {
+            tokens.push_back(mNodes[node].token);
+        }
+        std::reverse(tokens.begin(), tokens.end());
+        return tokens;
+    }
+
+    //! \returns The tokens streamed so far.
+    [[nodiscard]] std::vector<TokenIdType> getStreamed() const
+    {
+        std::vector<TokenIdType> tokens;
+        tokens.reserve(mStreamed.size());
+        for (auto const node : mStreamed)
+        {
+            tokens.push_back(mNodes[node].token);
+        }
+        return tokens;
+    }
+
+    [[nodiscard]] SizeType32 getNumSteps() const noexcept
+    {
+        return mNumSteps;
+    }
+
+    [[nodiscard]] SizeType32 getBeamWidth() const noexcept
+    {
+        return mBeamWidth;
+    }
+
+private:
+    static constexpr SizeType32 kNO_NODE = -1;
+
+    struct Node
+    {
+        TokenIdType token;
+        SizeType32 parent;
+    };
+
+    SizeType32 mBeamWidth;
+    SizeType32 mNumSteps{0};
+    //! Nodes of all the steps, beamWidth per step. The pruned beams are kept, the tree is bounded by the sequence
+    //! length like the parentIds of the decoder.
+    std::vector<Node> mNodes;
+    //! The node of each beam at the last step
+    std::vector<SizeType32> mLeaves;
+    //! The node of each streamed token
+    std::vector<SizeType32> mStreamed;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -31,6 +31,8 @@ class BufferManagerTest;
 
 namespace tensorrt_llm::runtime
 {
+class PinnedStagingRing;
+
 //! \brief A helper class for managing memory on host and device.
 class BufferManager
 {
@@ -120,7 +122,8 @@ public:
     //! \brief Set the contents of the given `buffer` to zero.
     void setZero(IBuffer& buffer) const;
 
-    //! \brief Copy `src` to `dst`.
+    //! \brief Copy `src` to `dst`. Small copies from pageable host memory to the GPU are staged through pinned memory,
+    //! so that they are asynchronous and `src` can be reused as soon as this returns.
     void copy(void const* src, IBuffer& dst, MemoryType srcType) const;
 
     //! \brief Copy `src` to `dst`.
@@ -207,8 +210,13 @@ private:
 
     void static memoryPoolTrimTo(int device, std::size_t size);
 
+    //! \brief Copies size bytes from pageable host memory to the GPU, staged if possible.
+    void copyToDevice(void* dst, void const* src, std::size_t size) const;
+
     CudaStreamPtr mStream;
     bool const mTrimPool;
+    // Shared by all the managers of the device
+    PinnedStagingRing* mStaging;
 };
 
 } // namespace tensorrt_llm::runtime
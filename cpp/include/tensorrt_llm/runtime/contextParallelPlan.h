@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Splits a prompt across the ranks of a context parallel group for ring attention.
+//! \details With causal attention the last tokens of a prompt attend the most tokens, so contiguous shares would leave
+//! the last rank with most of the work. The prompt is cut into 2 * cpSize chunks instead, and rank r takes the chunks
+//! r and 2 * cpSize - 1 - r, which gives every rank the same number of tokens and the same attention work, within one
+//! token. The KV shares move one rank forward per step of the ring: at step s a rank holds the share of rank
+//! (rank - s) mod cpSize.
+class ContextParallelPlan
+{
+public:
+    ContextParallelPlan(SizeType32 cpSize, SizeType32 promptLength)
+        : mCpSize{cpSize}
+        , mPromptLength{promptLength}
+    {
+        TLLM_CHECK_WITH_INFO(mCpSize > 0, "cpSize must be positive, got %d", mCpSize);
+        TLLM_CHECK_WITH_INFO(mPromptLength >= 0, "promptLength must not be negative, got %d", mPromptLength);
+    }
+
+    //! \returns The positions of the tokens of the rank in the prompt, ascending.
+    [[nodiscard]] std::vector<SizeType32> getPositions(SizeType32 rank) const
+    {
+        checkRank(rank);
+        std::vector<SizeType32> positions;
+        positions.reserve(getNumTokens(rank));
+        for (auto const chunk : {rank, 2 * mCpSize - 1 - rank})
+        {
+            for (auto pos = getChunkBegin(chunk); pos < getChunkBegin(chunk + 1); ++pos)
+            {
+                positions.push_back(pos);
+            }
+        }
+        return positions;
+    }
+
+    [[nodiscard]] SizeType32 getNumTokens(SizeType32 rank) const
+    {
+        checkRank(rank);
+        auto const mirror = 2 * mCpSize - 1 - rank;
+        return getChunkBegin(rank + 1) - getChunkBegin(rank) + getChunkBegin(mirror + 1) - getChunkBegin(mirror);
+    }
+
+    //! \returns The size of the largest share, which the buffers of the ring hold.
+    [[nodiscard]] SizeType32 getMaxNumTokens() const
+    {
+        SizeType32 maxNumTokens{0};
+        for (SizeType32 rank = 0; rank < mCpSize; ++rank)
+        {
+            maxNumTokens = std::max(maxNumTokens, getNumTokens(rank));
+        }
+        return maxNumTokens;
+    }
+
+    //! \returns The rank whose KV share the rank holds at the step.
+    [[nodiscard]] SizeType32 getSourceRank(SizeType32 rank, SizeType32 step) const
+    {
+        checkRank(rank);
+        TLLM_CHECK_WITH_INFO(step >= 0 && step < mCpSize, "Step %d is out of range", step);
+        return (rank - step + mCpSize) % mCpSize;
+    }
+
+    //! \returns The rank the KV shares are sent to.
+    [[nodiscard]] SizeType32 getNextRank(SizeType32 rank) const
+    {
+        checkRank(rank);
+        return (rank + 1) % mCpSize;
+    }
+
+    //! \returns The rank the KV shares are received from.
+    [[nodiscard]] SizeType32 getPrevRank(SizeType32 rank) const
+    {
+        checkRank(rank);
+        return (rank - 1 + mCpSize) % mCpSize;
+    }
+
+    [[nodiscard]] SizeType32 getCpSize() const noexcept
+    {
+        return mCpSize;
+    }
+
+    [[nodiscard]] SizeType32 getPromptLength() const noexcept
+    {
+        return mPromptLength;
+    }
+
+private:
+    [[nodiscard]] SizeType32 getChunkBegin(SizeType32 chunk) const noexcept
+    {
+        return static_cast<SizeType32>(static_cast<std::int64_t>(chunk) * mPromptLength / (2 * mCpSize));
+    }
+
+    void checkRank(SizeType32 rank) const
+    {
+        TLLM_CHECK_WITH_INFO(rank >= 0 && rank < mCpSize, "Rank %d is out of range", rank);
+    }
+
+    SizeType32 mCpSize;
+    SizeType32 mPromptLength;
+};
+
+} // namespace tensorrt_llm::runtime
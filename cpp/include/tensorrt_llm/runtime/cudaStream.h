@@ -23,11 +23,20 @@
 
 #include <cuda_runtime_api.h>
 
+#include <cstdint>
 #include <memory>
 
 namespace tensorrt_llm::runtime
 {
 
+//! \brief Priority class of the work on a stream, mapped to the priority range of the device.
+enum class StreamPriority : std::uint8_t
+{
+    kLOW = 0,    //!< Background transfers, e.g. KV cache offloading and LoRA uploads.
+    kNORMAL = 1, //!< The default priority of CUDA streams.
+    kHIGH = 2,   //!< The forward pass and decoding.
+};
+
 class CudaStream
 {
 public:
@@ -48,6 +57,16 @@ public:
         mStream = StreamPtr{stream, Deleter{ownsStream}};
     }
 
+    //! Creates a new cuda stream on the current device at the CUDA priority of the given class, see getCudaPriority.
+    explicit CudaStream(StreamPriority priority, unsigned int flags = cudaStreamNonBlocking)
+        : CudaStream{flags, getCudaPriority(priority)}
+    {
+    }
+
+    //! \brief Maps a priority class to the priority range of the current device. All classes map to the default
+    //! priority when TRTLLM_STREAM_PRIORITIES is set to 0.
+    static int getCudaPriority(StreamPriority priority);
+
     //! Pass an existing cuda stream to this object.
     //!
     //! \param stream The stream to pass to this object.
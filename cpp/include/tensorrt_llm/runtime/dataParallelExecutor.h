@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/batch_manager/replicaRouter.h"
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+struct DataParallelConfig
+{
+    //! The GPU of each replica, one replica per GPU. The replicas run without tensor or pipeline parallelism.
+    std::vector<SizeType32> deviceIds;
+    //! Tokens per KV cache block of the engine, for matching the prompts against the cached prefixes
+    SizeType32 tokensPerBlock{64};
+    //! Bonus per cached block of a prompt when routing, in free blocks, see batch_manager::ReplicaRouter
+    float prefixWeight{1.f};
+};
+
+//! \brief Data parallel replicas of a model behind a single executor API, fed from a shared admission queue.
+//! \details Every replica is an executor::Executor on a GPU of its own. A new request is routed to the replica with
+//! the most free KV cache blocks after admission, favouring the replicas that cache a prefix of its prompt, see
+//! batch_manager::ReplicaRouter. The free blocks are taken from the iteration stats of the replicas, so the executor
+//! config must keep iteration stats. Request ids are global across the replicas.
+class DataParallelExecutor
+{
+public:
+    using IdType = executor::IdType;
+
+    DataParallelExecutor(std::filesystem::path const& modelPath, executor::ModelType modelType,
+        executor::ExecutorConfig const& executorConfig, DataParallelConfig const& config);
+
+    ~DataParallelExecutor();
+
+    DataParallelExecutor(DataParallelExecutor const&) = delete;
+    DataParallelExecutor& operator=(DataParallelExecutor const&) = delete;
+
+    [[nodiscard]] IdType enqueueRequest(executor::Request const& request);
+
+    //! \brief Waits for responses of any replica, up to the timeout if given.
+    [[nodiscard]] std::vector<executor::Response> awaitResponses(
+        std::optional<std::chrono::milliseconds> const& timeout = std::nullopt);
+
+    void cancelRequest(IdType requestId);
+
+    void shutdown();
+
+    //! \returns The replica serving the request, while it is in flight.
+    [[nodiscard]] std::optional<SizeType32> getReplica(IdType requestId) const;
+
+    [[nodiscard]] SizeType32 getNumReplicas() const noexcept
+    {
+        return static_cast<SizeType32>(mReplicas.size());
+    }
+
+private:
+    struct InFlightRequest
+    {
+        SizeType32 replica;
+        IdType replicaRequestId;
+        //! Blocks reserved with the router until the first response of the request
+        SizeType32 numReservedBlocks;
+    };
+
+    //! \brief Updates the router with the latest KV cache stats of the replicas. Needs mMutex.
+    void refreshStatsLocked();
+
+    //! \brief Collects the responses of a replica, until shutdown.
+    void collectLoop(SizeType32 replica);
+
+    std::vector<std::unique_ptr<executor::Executor>> mReplicas;
+
+    mutable std::mutex mMutex;
+    batch_manager::ReplicaRouter mRouter;
+    std::unordered_map<IdType, InFlightRequest> mRequests;
+    //! Global id of each in flight request, per replica
+    std::vector<std::unordered_map<IdType, IdType>> mGlobalIds;
+    IdType mNextRequestId{1};
+    bool mShutdown{false};
+
+    std::mutex mResponseMutex;
+    std::condition_variable mResponseCv;
+    std::vector<executor::Response> mResponses;
+
+    std::vector<std::thread> mCollectors;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -86,6 +86,10 @@ public:
     TensorPtr lengths;          // [BS, BM], total sequence lengths including padding
     TensorPtr cacheIndirection; // [BS, BM, MSL], k/v indirection for next generation step
 
+    // optional parameters for top-K sampling
+    TensorPtr topLogProbs;   // [MSL, BS, N], log probs of the N most probable tokens per step, must be float*
+    TensorPtr topLogProbIds; // [MSL, BS, N], ids of the tokens of topLogProbs
+
     BeamHypotheses beamHypotheses;
 
     // Speculative decoding
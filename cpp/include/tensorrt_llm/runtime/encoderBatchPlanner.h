@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Chooses the requests of an encoder forward pass, packed without padding.
+//! \details Requests are taken in arrival order while the batch stays within the token budget and the batch size, so
+//! a long request is never starved by shorter ones arriving after it.
+class EncoderBatchPlanner
+{
+public:
+    EncoderBatchPlanner(SizeType32 maxBatchSize, SizeType32 maxNumTokens)
+        : mMaxBatchSize{maxBatchSize}
+        , mMaxNumTokens{maxNumTokens}
+    {
+        TLLM_CHECK_WITH_INFO(mMaxBatchSize > 0, "maxBatchSize must be positive, got %d", mMaxBatchSize);
+        TLLM_CHECK_WITH_INFO(mMaxNumTokens > 0, "maxNumTokens must be positive, got %d", mMaxNumTokens);
+    }
+
+    //! \returns Whether a request of the length can ever be scheduled.
+    [[nodiscard]] bool fits(SizeType32 length) const noexcept
+    {
+        return length > 0 && length <= mMaxNumTokens;
+    }
+
+    //! \param lengths The lengths of the queued requests, in arrival order. All must fit.
+    //! \returns The number of requests at the front of the queue that make the next batch.
+    template <typename Lengths>
+    [[nodiscard]] SizeType32 plan(Lengths const& lengths) const
+    {
+        SizeType32 numRequests{0};
+        SizeType32 numTokens{0};
+        for (auto const length : lengths)
+        {
+            if (numRequests == mMaxBatchSize || numTokens + length > mMaxNumTokens)
+            {
+                break;
+            }
+            numTokens += length;
+            ++numRequests;
+        }
+        return numRequests;
+    }
+
+    [[nodiscard]] SizeType32 getMaxBatchSize() const noexcept
+    {
+        return mMaxBatchSize;
+    }
+
+    [[nodiscard]] SizeType32 getMaxNumTokens() const noexcept
+    {
+        return mMaxNumTokens;
+    }
+
+private:
+    SizeType32 mMaxBatchSize;
+    SizeType32 mMaxNumTokens;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/objectPool.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/encoderBatchPlanner.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <NvInferRuntime.h>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+class TllmRuntime;
+
+struct EncoderExecutorConfig
+{
+    //! Requests of a forward pass at most
+    SizeType32 maxBatchSize{64};
+    //! Tokens of a forward pass at most, the requests are packed without padding
+    SizeType32 maxNumTokens{8192};
+    //! The output returned to the requests, per token like hidden_states or per request like pooled logits
+    std::string outputTensorName{"hidden_states"};
+    float gpuWeightsPercent{1.0f};
+    //! Priority of the stream of the encoder passes. Below the priority of the forward passes of a decoder sharing the
+    //! GPU, so that arriving encoder batches don't stall its generation steps.
+    StreamPriority streamPriority{StreamPriority::kNORMAL};
+};
+
+struct EncoderResponse
+{
+    std::uint64_t requestId{0};
+    //! [numTokens, hiddenSize] for outputs per token, [hiddenSize] for outputs per request
+    std::vector<float> output;
+    std::vector<SizeType32> outputShape;
+    std::optional<std::string> errorMsg;
+
+    [[nodiscard]] bool hasError() const noexcept
+    {
+        return errorMsg.has_value();
+    }
+};
+
+//! \brief In-flight batching of an encoder-only engine, such as BERT built with remove_input_padding, for embedding
+//! and reranking services.
+//! \details Requests are queued as they arrive. A worker packs the queued requests into ragged batches within the token
+//! budget, runs one forward pass per batch and returns the output rows of each request. There's no KV cache and no
+//! decoding, a request completes with the forward pass that contains it.
+//! The passes run on a stream of their own, two at a time: the next batch is packed and enqueued while the previous
+//! one executes, and the outputs of a batch are read back while the next one executes.
+class EncoderExecutor
+{
+public:
+    using IdType = std::uint64_t;
+
+    //! Batches enqueued on the GPU at most
+    static constexpr std::size_t kMAX_IN_FLIGHT = 2;
+
+    EncoderExecutor(
+        std::filesystem::path const& enginePath, EncoderExecutorConfig const& config, nvinfer1::ILogger& logger);
+
+    ~EncoderExecutor();
+
+    EncoderExecutor(EncoderExecutor const&) = delete;
+    EncoderExecutor& operator=(EncoderExecutor const&) = delete;
+
+    //! \param tokenTypeIds Segment ids of the tokens, zeros if not given and the engine takes them.
+    //! \returns The id of the request, which identifies its response.
+    IdType enqueueRequest(
+        std::vector<TokenIdType> inputTokenIds, std::optional<std::vector<TokenIdType>> tokenTypeIds = std::nullopt);
+
+    //! \brief Waits for responses, up to the timeout if given.
+    [[nodiscard]] std::vector<EncoderResponse> awaitResponses(
+        std::optional<std::chrono::milliseconds> const& timeout = std::nullopt);
+
+    [[nodiscard]] SizeType32 getNumQueuedRequests() const;
+
+    //! \brief Completes the queued requests and stops the worker.
+    void shutdown();
+
+private:
+    struct Request
+    {
+        IdType id;
+        std::vector<TokenIdType> inputTokenIds;
+        std::vector<TokenIdType> tokenTypeIds;
+    };
+
+    struct InFlightBatch;
+    using InFlightBatchPtr = common::ObjectPool<InFlightBatch>::Ptr;
+
+    void workerLoop();
+
+    //! \brief Takes the requests of the next batch from the queue. Needs mRequestMutex.
+    [[nodiscard]] std::vector<Request> takeBatch();
+
+    //! \brief Enqueues the forward pass of the requests and the copy of its output to the host.
+    //! \details The requests are moved to the batch once enqueued, they're left untouched on failure.
+    [[nodiscard]] InFlightBatchPtr enqueueForward(std::vector<Request>& requests, std::size_t slot);
+
+    //! \brief Waits for the forward pass of the batch and adds the responses of its requests.
+    void completeForward(InFlightBatch& batch);
+
+    void addErrorResponses(std::vector<Request> const& requests, std::string const& errorMsg);
+
+    void addResponses(std::vector<EncoderResponse> responses);
+
+    EncoderExecutorConfig mConfig;
+    EncoderBatchPlanner mPlanner;
+    std::unique_ptr<TllmRuntime> mRuntime;
+    BufferManager::CudaStreamPtr mStream;
+    BufferManager mBufferManager;
+    //! Device and pinned host output of each batch in flight
+    std::array<ITensor::SharedPtr, kMAX_IN_FLIGHT> mOutputs;
+    std::array<ITensor::SharedPtr, kMAX_IN_FLIGHT> mHostOutputs;
+    //! Pinned flags of the output rows with non-finite values, of each batch in flight, if the numeric sentinel is on
+    std::array<ITensor::SharedPtr, kMAX_IN_FLIGHT> mNonFiniteRows;
+    //! The batches in flight with their staging vectors and events, reused instead of allocated per batch
+    common::ObjectPool<InFlightBatch> mBatchPool;
+
+    mutable std::mutex mRequestMutex;
+    std::condition_variable mRequestCv;
+    std::deque<Request> mRequests;
+    IdType mNextRequestId{1};
+    bool mShutdown{false};
+
+    std::mutex mResponseMutex;
+    std::condition_variable mResponseCv;
+    std::vector<EncoderResponse> mResponses;
+
+    std::thread mWorker;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -22,6 +22,7 @@
 
 #include <optional>
 #include <utility>
+#include <vector>
 
 namespace tensorrt_llm::runtime
 {
@@ -64,7 +65,9 @@ namespace tensorrt_llm::runtime
 //!    `[2, stopWordsLength]`, as explained below, or `[batchSize, 2,
 //!    stopWordsLength]` when there is a different list for each sequence in the
 //!    batch,
-//!  * `maxNewTokens`, is the maximum number of tokens to generate.
+//!  * `maxNewTokens`, is the maximum number of tokens to generate,
+//!  * `compressKvCache`, selects the sequences whose KV cache is compressed when
+//!    the session has a `kvCompressionConfig`.
 //!
 //! The `badWordsList` and `stopWordsList` tensors have the same shape `[2,
 //! length]`. Let's consider an example with three words to describe the
@@ -118,6 +121,8 @@ public:
     TensorPtr badWordsList;                 // [2, badWordsLength] or [batchSize, 2, badWordsLength], on gpu
     TensorPtr stopWordsList;                // [batchSize, 2, stopWordsLength], on gpu
     std::optional<SizeType32> maxNewTokens; // max number of tokens to generate
+    // [batchSize], whether the kv cache of each sequence is compressed if the session enables it, all if not given
+    std::optional<std::vector<bool>> compressKvCache;
 
     // Ptuning parameters
     PromptTuningParams promptTuningParams; // See promptTuningParams.h for expected shapes
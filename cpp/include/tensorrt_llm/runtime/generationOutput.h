@@ -65,6 +65,12 @@ namespace tensorrt_llm::runtime
 //!    `gather_all_token_logits` parameter enabled.
 //!
 //!    Generation logits can also be obtained through `GenerationOutput.generationLogits` after inference is completed.
+//!  * `promptLogProbs`, is a tensor of floating-point values on the GPU to store the
+//!    log-prob of each prompt token given the tokens before it. Its shape is `[batchSize, maxInputLength]`, with
+//!    zeros at the first token and at the padding. Setting it selects the scoring mode: the session runs the context
+//!    phase only and computes the log-probs from the context logits on the GPU, without a generation step. The `ids`
+//!    then hold the prompt and a single sampled token. The engine must be built with `gather_context_logits`, and
+//!    beam width must be 1.
 //!  * `onTokenGenerated`, is a callback function invoked in the generation loop to
 //!    pass newly generated tokens to the caller while the loop continues to
 //!    execute. An implementation of that callback must accept the output `ids`
@@ -95,6 +101,7 @@ public:
     TensorPtr contextLogits;    // [batch_size, max_input_length, vocab_size_padded], if packed, the shape will be
                                 // [packed_size, vocab_size_padded]
     TensorPtr generationLogits; // [batch_size, beam_width, max_output_length, vocab_size_padded]
+    TensorPtr promptLogProbs;   // [batch_size, max_input_length], must be float*, on gpu
 
     // callbacks
     Callback onTokenGenerated;
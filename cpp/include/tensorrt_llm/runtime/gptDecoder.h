@@ -22,6 +22,7 @@
 #include "tensorrt_llm/runtime/decodingInput.h"
 #include "tensorrt_llm/runtime/decodingOutput.h"
 #include "tensorrt_llm/runtime/modelConfig.h"
+#include "tensorrt_llm/runtime/probsTruncationConfig.h"
 #include "tensorrt_llm/runtime/samplingConfig.h"
 #include "tensorrt_llm/runtime/worldConfig.h"
 #include <curand_kernel.h>
@@ -64,6 +65,11 @@ public:
 
     virtual SamplingConfig const& getSamplingConfig() = 0;
 
+    //! @brief Sets up min-p, typical-p and eta truncation of the batch. Call it after setup(), which resets them.
+    virtual void setupProbsTruncation(ProbsTruncationConfig const& config, size_t batchSize,
+        std::optional<TensorPtr> const& batchSlots = std::nullopt)
+        = 0;
+
     static void acceptDraftTokensByIds(ITensor const& targetTokenIds, ITensor const& draftTokenIds,
         ITensor const& contextLengths, ITensor const& numDraftTokens, ITensor& sequenceLengths,
         ITensor const& finishedVec, ITensor& finishedFinal, ITensor& finishedSum, ITensor const& batchSlots,
@@ -107,6 +113,9 @@ public:
         return mSamplingConfig;
     }
 
+    void setupProbsTruncation(ProbsTruncationConfig const& config, size_t batchSize,
+        std::optional<TensorPtr> const& batchSlots = std::nullopt) override;
+
 private:
     BufferManager mManager;
     std::shared_ptr<tensorrt_llm::layers::DynamicDecodeLayer<T>> mDynamicDecodeLayer;
@@ -29,6 +29,10 @@
 
 namespace tensorrt_llm::runtime
 {
+namespace kernels
+{
+struct DecoderNewRequest;
+} // namespace kernels
 
 //! GPT decoder class with support for in-flight batching
 class GptDecoderBatch : public IGptDecoderBatch
@@ -41,7 +45,10 @@ public:
     GptDecoderBatch(std::size_t vocabSize, std::size_t vocabSizePadded, CudaStreamPtr stream,
         SpeculativeDecodingMode const& speculativeDecodingMode);
 
-    //! Setup the decoder before calling `forward()`
+    ~GptDecoderBatch() override;
+
+    //! Setup the decoder before calling `forward()`. With `fusedDecoder`, one decoder handles all requests, which
+    //! callers should prefer without beam search. Otherwise every request is decoded with a decoder of its own.
     void setup(executor::DecodingMode const& mode, SizeType32 maxBatchSize, SizeType32 maxBeamWidth,
         SizeType32 maxAttentionWindow, SizeType32 sinkTokenLength, SizeType32 maxSequenceLength,
         SizeType32 maxTokensPerStep, bool fusedDecoder, nvinfer1::DataType dtype,
@@ -53,6 +60,11 @@ public:
     void newRequests(std::vector<SizeType32> const& seqSlots, std::vector<decoder_batch::Request> const& requests,
         std::vector<SamplingConfig> const& samplingConfigs) override;
 
+    //! @brief Sets up min-p, typical-p and eta truncation of requests set up by newRequests() with the same slots.
+    //! @details They are not part of SamplingConfig, whose layout is shared with the prebuilt batch manager.
+    void setupProbsTruncation(
+        std::vector<SizeType32> const& seqSlots, std::vector<ProbsTruncationConfig> const& configs);
+
     TokenPtr forwardAsync(decoder_batch::Output& output, decoder_batch::Input const& input) override;
 
     void forwardSync(decoder_batch::Token const& token) override;
@@ -182,6 +194,17 @@ public:
         return mJointDecodingOutput->speculativeDecodingOutputs->pathsOffsets;
     }
 
+    //! @returns [maxBatchSize], number of draft tokens recommended for the next step of each request from its draft
+    //! acceptance rate, on gpu. Updated for Medusa, where it bounds the tree depth, and for external draft tokens
+    //! accepted by ids.
+    //! Null without speculative decoding.
+    [[nodiscard]] TensorPtr getAdaptiveNumDraftTokens() const;
+
+    //! @brief Resets the draft acceptance rate of the request at `batchIdx`. Medusa requests are reset by
+    //! `newRequest`. External draft tokens are passed through `newRequest` at every step, so the caller resets them
+    //! when a new request takes the slot.
+    void resetDraftAcceptance(SizeType32 batchIdx);
+
 private:
     //! @brief Gather final beam search results for request `batchIdx`.
     [[nodiscard]] CudaEvent postProcessRequest(SizeType32 batchIdx) const;
@@ -189,6 +212,14 @@ private:
     //! @brief Initialize the decoder at `batchIdx` with a new `request`.
     void newRequest(SizeType32 batchIdx, decoder_batch::Request const& request, SamplingConfig const& samplingConfig);
 
+    //! @brief Sets up the views of the slot `batchIdx` for a new `request`, and the buffers that aren't shared by
+    //! requests. The joint buffers of the slot are initialized by `initNewRequests` with the returned values.
+    [[nodiscard]] kernels::DecoderNewRequest setupNewRequest(
+        SizeType32 batchIdx, decoder_batch::Request const& request, SamplingConfig const& samplingConfig);
+
+    //! @brief Initializes the joint buffers of the slots of the new requests with one kernel on `stream`.
+    void initNewRequests(std::vector<kernels::DecoderNewRequest> const& slotInits, CudaStreamPtr const& stream);
+
     //! @brief Allocate buffers for speculative decoding.
     void allocateSpeculativeDecodingBuffers();
 
@@ -199,6 +230,10 @@ private:
     void newRequestSpeculativeDecoding(
         SizeType32 batchIdx, decoder_batch::Request const& request, SamplingConfig const& samplingConfig);
 
+    //! @brief Setups decoder internal tensors for a request which does not speculate in a speculative decoder, so
+    //! that it is decoded with draft length 0 in the same batch as the speculative requests
+    void newRequestWithoutSpeculation(SizeType32 batchIdx);
+
     //! @brief Setups decoder internal tensors for new request in Draft model Sps mode
     void newRequestDraftTokensExternal(
         SizeType32 batchIdx, decoder_batch::Request const& request, SamplingConfig const& samplingConfig);
@@ -31,6 +31,7 @@
 #include "tensorrt_llm/runtime/generationInput.h"
 #include "tensorrt_llm/runtime/generationOutput.h"
 #include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/kvCompressionConfig.h"
 #include "tensorrt_llm/runtime/modelConfig.h"
 #include "tensorrt_llm/runtime/samplingConfig.h"
 #include "tensorrt_llm/runtime/worldConfig.h"
@@ -38,8 +39,10 @@
 #include <NvInferRuntime.h>
 
 #include <cstdint>
+#include <filesystem>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -63,6 +66,8 @@ std::vector<uint8_t> loadEngine(std::string const& enginePath);
 
 class AllReduceBuffers;
 class IStatefulGptDecoder;
+class KvCacheCompressor;
+class KvCacheUvmPrefetcher;
 class NcclCommunicator;
 class RuntimeBuffers;
 class TllmRuntime;
@@ -114,6 +119,14 @@ public:
         std::optional<SizeType32> genMicroBatchSize = std::nullopt;
         std::optional<executor::DecodingMode> decodingMode = std::nullopt;
         bool normalizeLogProbs = true;
+        // Whether the host learns about finished sequences one step late, so that the engine launch of the next step
+        // does not wait for the decoder. The extra step on finished sequences is skipped by the decoder.
+        // Only used with `decoderPerRequest == false`, without pipeline parallelism and for beam width 1.
+        bool decoderOverlap{false};
+        // Evicts the least attended tokens from the KV cache of long generations, of the sequences selected by
+        // `GenerationInput::compressKvCache`. Needs a paged KV cache without cyclic window, beam width 1 and no CUDA
+        // graphs.
+        std::optional<KvCompressionConfig> kvCompressionConfig = std::nullopt;
     };
 
     //! @brief Optional profiler class to profile the generation phase of an inference request
@@ -177,6 +190,12 @@ public:
     {
     }
 
+    //! @brief Create a session sharing the engine, and so the weights on the GPU, of another session, e.g. to serve
+    //! different configs of the same engine in one process. The sessions have their own streams, buffers and KV
+    //! caches. The weight streaming budget is the one of the engine owner, sessionConfig.gpuWeightsPercent is ignored.
+    GptSession(Config const& sessionConfig, ModelConfig const& modelConfig, WorldConfig const& worldConfig,
+        GptSession const& engineOwner);
+
     [[nodiscard]] nvinfer1::ILogger& getLogger() const;
 
     [[nodiscard]] BufferManager const& getBufferManager() const;
@@ -233,6 +252,13 @@ public:
     void generate(GenerationOutput& outputs, GenerationInput const& inputs, SamplingConfig const& samplingConfig,
         std::shared_ptr<GenerationProfiler> const generationProfiler = nullptr);
 
+    //! @brief Update weights of the engine in place between calls to generate, without recreating the session, see
+    //! TllmRuntime::refitWeights.
+    void refitWeights(StringPtrMap<ITensor> const& weights);
+
+    //! @brief Update weights of the engine in place from a safetensors file.
+    void refitWeights(std::filesystem::path const& weightsPath);
+
     //! @brief Set LayerProfiler to collect performance per layer.
     void setLayerProfiler();
 
@@ -249,6 +275,8 @@ private:
         std::vector<GenerationInput> const& microBatchesInputs, SamplingConfig const& samplingConfig,
         TokenGeneratedCallback const& onTokenGenerated, std::shared_ptr<GenerationProfiler> const generationProfiler);
 
+    void initialize(Config const& sessionConfig);
+
     void setup(Config const& sessionConfig);
 
     void createContexts();
@@ -272,6 +300,9 @@ private:
     //! @brief Synchronize with the decoder and return the `shouldStop` flag.
     bool shouldStopSync(SizeType32 batchSize, SizeType32 beamWidth, SizeType32 microBatchId);
 
+    //! @brief Return the `shouldStop` flag of the decoder step before the last one, without waiting for the last one.
+    bool shouldStopOverlapped(SizeType32 batchSize, SizeType32 beamWidth, SizeType32 microBatchId, SizeType32 step);
+
     //! @brief Collect final output ids and log probs on last PP rank and send them to first PP rank.
     //! @details Receives are asynchronous on host, so synchronization is required before access.
     void finalize(SizeType32 microBatchId);
@@ -356,6 +387,9 @@ private:
     WorldConfig const mWorldConfig;
     int mDevice{-1};
     std::shared_ptr<NcclCommunicator> mPipelineComm;
+    //! Returns the final outputs from the last to the first rank on the runtime stream, on its own communicator so
+    //! that it isn't serialized with the exchange of the decoder step on mCommStream.
+    std::shared_ptr<NcclCommunicator> mPipelineReturnComm;
     std::shared_ptr<CudaStream> mCommStream;
     CudaEvent mCommEvent{};
 
@@ -368,6 +402,9 @@ private:
     LoggerPtr mLogger;
     std::shared_ptr<TllmRuntime> mRuntime;
     std::shared_ptr<KvCacheManager> mKvCacheManager;
+    std::shared_ptr<KvCacheCompressor> mKvCacheCompressor;
+    // Prefetch and memory advice of the KV cache pool in unified memory, with `KvCacheConfig::useUvm`
+    std::shared_ptr<KvCacheUvmPrefetcher> mKvCacheUvmPrefetcher;
 
     MicroBatchConfig mMicroBatchConfig;
     // for each micro batch
@@ -375,6 +412,10 @@ private:
     std::vector<std::shared_ptr<RuntimeBuffers>> mBuffers;
     std::vector<CudaEvent> mReceivedEvents;
 
+    bool mDecoderOverlap{false};
+    // ping-pong events recorded after each decoder step of each micro batch
+    std::vector<CudaEvent> mDecodedEvents;
+
     bool mCudaGraphMode{false};
     // ping-pong instances
     std::vector<CudaGraphExecutor> mCudaGraphInstances;
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Tensor and pipeline parallelism within a single process, with one thread per rank instead of one MPI process
+//! per rank.
+//! \details Each rank runs on a thread of its own, with the device of the rank current. The NCCL communicators of the
+//! plugins and of the pipeline are created in-process, with the unique ids exchanged through the world instead of MPI.
+//! Host caches can be shared by the ranks (see getShared), e.g. a secondary KV cache pool or the host LoRA cache,
+//! instead of being duplicated per process. The ranks must all be on this node. The custom all reduce needs IPC
+//! memory between processes and is not available, the engines use the NCCL all reduce.
+class InProcessWorld
+{
+public:
+    //! \param deviceIds The device of each rank, devices 0 to tensorParallelism * pipelineParallelism - 1 if not given.
+    InProcessWorld(SizeType32 tensorParallelism, SizeType32 pipelineParallelism,
+        std::optional<std::vector<SizeType32>> const& deviceIds = std::nullopt);
+
+    InProcessWorld(InProcessWorld const&) = delete;
+    InProcessWorld& operator=(InProcessWorld const&) = delete;
+
+    //! \brief Runs fn on one thread per rank with the world config of the rank, and waits for all of them.
+    //! \details The first exception of a rank is rethrown once all threads have returned. It aborts the exchanges of
+    //! the other ranks, so that they don't wait for the failed rank forever.
+    void run(std::function<void(WorldConfig const&)> const& fn);
+
+    [[nodiscard]] SizeType32 getSize() const noexcept
+    {
+        return mTensorParallelism * mPipelineParallelism;
+    }
+
+    [[nodiscard]] WorldConfig getWorldConfig(SizeType32 rank) const;
+
+    //! \brief The world the calling thread is a rank of, null outside of run.
+    [[nodiscard]] static InProcessWorld* current() noexcept;
+
+    //! \brief The rank of the calling thread, which must be a rank of a world.
+    [[nodiscard]] static SizeType32 currentRank();
+
+    //! \brief Hands the bytes created by the root to all ranks of the group, e.g. the unique id of a communicator.
+    //! \details Every rank of the group calls it with the same key, the root creates the bytes. The exchanges of a key
+    //! are matched in call order, so a key can be exchanged repeatedly.
+    //! \param group The ranks of the group, its first rank is the root.
+    [[nodiscard]] std::vector<std::uint8_t> broadcast(std::string const& key, std::set<SizeType32> const& group,
+        std::function<std::vector<std::uint8_t>()> const& create);
+
+    //! \brief broadcast of a trivially copyable value.
+    template <typename T>
+    [[nodiscard]] T broadcastValue(
+        std::string const& key, std::set<SizeType32> const& group, std::function<T()> const& create)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        auto const bytes = broadcast(key, group,
+            [&create]()
+            {
+                auto const value = create();
+                auto const* data = reinterpret_cast<std::uint8_t const*>(&value);
+                return std::vector<std::uint8_t>(data, data + sizeof(T));
+            });
+        T value;
+        std::memcpy(&value, bytes.data(), sizeof(T));
+        return value;
+    }
+
+    //! \brief An object shared by the ranks, created by the first rank asking for the key.
+    template <typename T>
+    [[nodiscard]] std::shared_ptr<T> getShared(
+        std::string const& key, std::function<std::shared_ptr<T>()> const& create)
+    {
+        std::lock_guard<std::mutex> lock(mSharedMutex);
+        auto& shared = mShared[key];
+        if (!shared)
+        {
+            shared = create();
+        }
+        return std::static_pointer_cast<T>(shared);
+    }
+
+private:
+    struct Exchange
+    {
+        std::vector<std::uint8_t> bytes;
+        //! The call of the key that created the bytes
+        std::uint64_t round{0};
+        SizeType32 numPending{0};
+    };
+
+    void abort();
+
+    SizeType32 mTensorParallelism;
+    SizeType32 mPipelineParallelism;
+    std::vector<SizeType32> mDeviceIds;
+
+    std::mutex mExchangeMutex;
+    std::condition_variable mExchangeCv;
+    std::map<std::string, Exchange> mExchanges;
+    //! The calls of each key by each rank
+    std::map<std::string, std::vector<std::uint64_t>> mRounds;
+    bool mAborted{false};
+
+    std::mutex mSharedMutex;
+    std::map<std::string, std::shared_ptr<void>> mShared;
+};
+
+} // namespace tensorrt_llm::runtime
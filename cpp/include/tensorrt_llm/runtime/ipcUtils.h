@@ -23,6 +23,9 @@
 #include "tensorrt_llm/runtime/iTensor.h"
 #include "tensorrt_llm/runtime/worldConfig.h"
 
+#include <cstdint>
+#include <memory>
+
 namespace tensorrt_llm::runtime
 {
 
@@ -43,6 +46,8 @@ public:
     IpcMemory(IpcMemory&&) = default;
     IpcMemory& operator=(IpcMemory&&) = default;
 
+    //! @brief The buffers of the tensor parallel ranks. A group spanning nodes only shares the buffers between the
+    //! ranks of a node, which come first, the other pointers are null.
     [[nodiscard]] std::vector<void*> const& getCommPtrs() const
     {
         return mCommPtrs;
@@ -52,12 +57,57 @@ private:
     void allocateIpcMemory(std::size_t bufferSize, BufferManager const& manager, WorldConfig const& worldConfig);
     void destroyIpcMemory();
 
-    SizeType32 mTpRank;
+    // Index of the own buffer in mCommPtrs
+    SizeType32 mRank;
     std::vector<void*> mCommPtrs;
     BufferPtr mBuffer;
     bool mOpenIpc;
 };
 
+//! @brief The buffer of this rank bound to a multicast object over the buffers of the tensor parallel ranks, for the
+//! NVLS all reduce on NVSwitch systems. Rank 0 creates the multicast object and the other ranks import it through a
+//! file descriptor of rank 0. The construction is collective over the tensor parallel group.
+class IpcNvlsMemory
+{
+public:
+    IpcNvlsMemory(std::size_t bufferSize, WorldConfig const& worldConfig);
+    ~IpcNvlsMemory();
+
+    IpcNvlsMemory(IpcNvlsMemory const&) = delete;
+    IpcNvlsMemory& operator=(IpcNvlsMemory const&) = delete;
+
+    //! @brief Whether the devices of all ranks of the tensor parallel group, on a single node, support multicast
+    //! objects. Collective over the tensor parallel group.
+    [[nodiscard]] static bool isSupported(WorldConfig const& worldConfig);
+
+    [[nodiscard]] void* getUnicastPtr() const noexcept
+    {
+        return mUnicastPtr;
+    }
+
+    [[nodiscard]] void* getMulticastPtr() const noexcept
+    {
+        return mMulticastPtr;
+    }
+
+    //! @brief The size of both buffers, rounded up to the granularity of the multicast object.
+    [[nodiscard]] std::size_t getSize() const noexcept
+    {
+        return mSize;
+    }
+
+private:
+    void destroyNvlsMemory() noexcept;
+
+    SizeType32 mDevice;
+    std::size_t mSize{0};
+    // CUmemGenericAllocationHandle, kept opaque in this header
+    std::uint64_t mUnicastHandle{0};
+    std::uint64_t mMulticastHandle{0};
+    void* mUnicastPtr{nullptr};
+    void* mMulticastPtr{nullptr};
+};
+
 class AllReduceBuffers
 {
 public:
@@ -65,9 +115,16 @@ public:
 
     AllReduceBuffers(SizeType32 maxBatchSize, SizeType32 maxBeamWidth, SizeType32 maxSequenceLength,
         SizeType32 hiddenSize, BufferManager const& manager, WorldConfig const& worldConfig);
+    ~AllReduceBuffers();
+
+    AllReduceBuffers(AllReduceBuffers const&) = delete;
+    AllReduceBuffers& operator=(AllReduceBuffers const&) = delete;
 
     TensorPtr mAllReduceCommPtrs;
     std::vector<runtime::IpcMemory> mIpcMemoryHandles;
+    //! The buffers of the NVLS all reduce, set up on request with TRTLLM_ALLREDUCE_NVLS if the devices support it
+    std::unique_ptr<IpcNvlsMemory> mNvlsMemory;
+    SizeType32 mTensorParallelism;
 };
 
 } // namespace tensorrt_llm::runtime
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/gptJsonConfig.h"
+#include "tensorrt_llm/runtime/modelConfig.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Sizes the KV cache of an engine for a workload, from the engine config and the memory of the device.
+//!
+//! \details The device memory left after loading the weights is split into the TRT activations of the engine, the
+//! workspaces of the plugins and the libraries, the buffers of the decoder, sized for the max batch size of the engine,
+//! the LoRA cache and the KV cache, which takes the rest. The plan reports how many sequences of the workload fit in
+//! the KV cache at once and configures the executor to allocate exactly that cache, instead of a guessed fraction of
+//! the free memory.
+class KvCapacityPlanner
+{
+public:
+    //! \brief The lengths of a class of requests of the workload, weighted by their share of the requests.
+    struct WorkloadSample
+    {
+        SizeType32 inputLen;
+        SizeType32 outputLen;
+        float weight{1.0f};
+    };
+
+    struct MemoryBudget
+    {
+        //! Device memory free once the weights are loaded, see getFreeDeviceMemory
+        std::size_t freeDeviceMemory{0};
+        //! Activations of the engine, see TllmRuntime::getDeviceMemorySize
+        std::size_t activationMemory{0};
+        //! Workspaces of the plugins, cuBLAS and NCCL
+        std::size_t workspaceMemory{0};
+        //! Device memory of the LoRA cache, none if LoRA isn't used
+        std::size_t loraCacheMemory{0};
+        //! Pinned host memory of the secondary KV cache, none if blocks aren't offloaded
+        std::size_t hostCacheMemory{0};
+        //! Share of the free device memory that may be used, the rest is left as headroom for fragmentation
+        float memoryFraction{0.9f};
+    };
+
+    struct Plan
+    {
+        std::size_t kvBytesPerToken{0};
+        std::size_t bytesPerBlock{0};
+        //! Decoder buffers of the max batch size of the engine
+        std::size_t decoderMemory{0};
+        std::size_t kvCacheMemory{0};
+        SizeType32 numBlocks{0};
+        SizeType32 numSecondaryBlocks{0};
+        SizeType32 maxTokens{0};
+        //! KV blocks of a sequence, averaged over the workload and at the quantile
+        double meanBlocksPerSequence{0};
+        SizeType32 quantileBlocksPerSequence{0};
+        //! Sequences in flight at once, bounded by the KV cache and the max batch size of the engine
+        SizeType32 numConcurrentSequences{0};
+        SizeType32 numConcurrentSequencesAtQuantile{0};
+        //! Whether the KV cache rather than the max batch size bounds the sequences in flight
+        bool kvCacheBound{false};
+        //! Share of the device memory free when the LoRA cache is created, after the KV cache
+        float loraDeviceCachePercent{0.0f};
+    };
+
+    KvCapacityPlanner(ModelConfig const& modelConfig, WorldConfig const& worldConfig, SizeType32 maxBeamWidth = 1);
+
+    //! \brief The planner of the engine of the config, for the rank of the world config.
+    static KvCapacityPlanner fromEngineDir(
+        std::filesystem::path const& engineDir, SizeType32 rank = 0, SizeType32 maxBeamWidth = 1);
+
+    //! \brief The device memory free right now, to plan once the weights are loaded.
+    [[nodiscard]] static std::size_t getFreeDeviceMemory();
+
+    //! \brief Bytes of the keys and values of one token over the attention layers of the rank.
+    [[nodiscard]] std::size_t getKvBytesPerToken() const;
+
+    [[nodiscard]] std::size_t getBytesPerBlock() const;
+
+    //! \brief Bytes of the decoder buffers of one sequence: logits, sampling workspace, output ids and log probs.
+    [[nodiscard]] std::size_t getDecoderBytesPerSequence() const;
+
+    //! \brief Blocks held by a sequence at its full length. The context blocks are shared by the beams.
+    [[nodiscard]] SizeType32 getBlocksPerSequence(SizeType32 inputLen, SizeType32 outputLen) const;
+
+    //! \param workload The length distribution of the requests, or empty to plan for sequences of the max length.
+    //! \param quantile Blocks per sequence that the conservative concurrency is reported at, in [0, 1].
+    [[nodiscard]] Plan plan(
+        MemoryBudget const& budget, std::vector<WorkloadSample> const& workload, float quantile = 0.95f) const;
+
+    //! \brief Sets the KV cache of the config to the planned size, and the LoRA cache if the plan reserves one.
+    //! \details The max tokens of the KV cache bound the allocation, the memory fraction of the budget stays as the
+    //! fraction of the KV cache config, to guard against an underestimate of the other buffers.
+    void configure(executor::ExecutorConfig& executorConfig, Plan const& plan, MemoryBudget const& budget) const;
+
+    [[nodiscard]] ModelConfig const& getModelConfig() const noexcept
+    {
+        return mModelConfig;
+    }
+
+private:
+    ModelConfig mModelConfig;
+    WorldConfig mWorldConfig;
+    SizeType32 mMaxBeamWidth;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Importance based eviction of cached tokens during long generations, in the style of H2O and SnapKV.
+//! \details The attention probabilities that each cached token receives during the generation steps are summed over
+//! the heads and the layers. Every slackTokens steps, a cache of more than maxCachedTokens tokens keeps the first
+//! sinkTokens tokens, the last recentTokens tokens and the most attended tokens in between up to maxCachedTokens. The
+//! others are evicted and the kept tokens compacted to the front of the cache. The positions of the tokens don't
+//! change, only the tokens attended to do. The prompt is scored by the generation steps only, it isn't evicted before
+//! slackTokens steps.
+struct KvCompressionConfig
+{
+    explicit KvCompressionConfig(SizeType32 maxCachedTokens, SizeType32 sinkTokens = 4, SizeType32 recentTokens = 256,
+        SizeType32 slackTokens = 256)
+        : maxCachedTokens{maxCachedTokens}
+        , sinkTokens{sinkTokens}
+        , recentTokens{recentTokens}
+        , slackTokens{slackTokens}
+    {
+        TLLM_CHECK_WITH_INFO(sinkTokens >= 0 && recentTokens >= 0 && maxCachedTokens > sinkTokens + recentTokens,
+            "maxCachedTokens (%d) must be larger than sinkTokens (%d) + recentTokens (%d)", maxCachedTokens, sinkTokens,
+            recentTokens);
+        TLLM_CHECK_WITH_INFO(slackTokens > 0, "slackTokens must be positive, got %d", slackTokens);
+    }
+
+    //! Tokens kept in the cache of a sequence by an eviction
+    SizeType32 maxCachedTokens;
+    //! Tokens at the start of a sequence that are never evicted
+    SizeType32 sinkTokens;
+    //! Most recent tokens of a sequence that are never evicted
+    SizeType32 recentTokens;
+    //! Generation steps between two evictions of a sequence, during which the scores of the tokens accumulate and the
+    //! cache grows beyond maxCachedTokens
+    SizeType32 slackTokens;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -27,13 +27,14 @@
 
 #include <NvInferRuntime.h>
 
-#include <deque>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace tensorrt_llm::runtime
 {
@@ -52,11 +53,36 @@ public:
     ~LoraCacheFullException() noexcept override;
 };
 
+/**
+ * Occupancy and fragmentation of the pages of a LoraCachePageManager.
+ */
+struct LoraCachePageStats
+{
+    SizeType32 numPages{0};
+    SizeType32 numFreePages{0};
+    // number of runs of contiguous free pages
+    SizeType32 numFreeRuns{0};
+    SizeType32 largestFreeRun{0};
+
+    /**
+     * \returns -- 0 if all free pages are contiguous, close to 1 if they are scattered
+     */
+    [[nodiscard]] float getFragmentation() const
+    {
+        return numFreePages == 0 ? 0.f : 1.f - static_cast<float>(largestFreeRun) / static_cast<float>(numFreePages);
+    }
+};
+
 /**
  * Holds memory of lora cache pages, and manages allocation and freeing of whole pages.
  * Memory is pre-allocated either on the host or device
  *
- * Note that this class is not thread safe
+ * If the page data type is INT8 or FP8, the cache holds weights of the model data type quantized page by page: a page
+ * holds the quantized weights of its [slots x pageWidth] layout followed by the group scales (see
+ * kernels::getQuantizedBlockSize), and pagePtr returns the flat page.
+ *
+ * Pages are claimed best fit: from the smallest run of contiguous free pages holding all of them, or from the largest
+ * runs first if no run is large enough, so that tasks keep contiguous pages and large runs stay available.
  */
 class LoraCachePageManager
 {
@@ -100,6 +126,14 @@ public:
      */
     [[nodiscard]] ITensor::SharedConstPtr blockPtr(SizeType32 blockIdx) const;
 
+    /**
+     * \brief return pointer to given page block
+     *
+     * \param[in] blockIdx;
+     * \returns -- mutable pointer to page block
+     */
+    [[nodiscard]] ITensor::SharedPtr mutableBlockPtr(SizeType32 blockIdx);
+
     /**
      * \brief return pointer to given page
      *
@@ -116,11 +150,30 @@ public:
      */
     [[nodiscard]] ITensor::SharedPtr mutablePagePtr(std::size_t pageIdx);
 
+    /**
+     * \returns -- occupancy and fragmentation of the pages
+     */
+    [[nodiscard]] LoraCachePageStats getStats() const;
+
+    /**
+     * \brief move all claimed pages to the lowest page ids, so that all free pages are contiguous.
+     * Only the page bookkeeping is updated, the caller moves the contents and updates the users of the pages.
+     *
+     * \returns -- list of (old page id, new page id) moves
+     */
+    [[nodiscard]] std::vector<std::pair<std::size_t, std::size_t>> compact();
+
 private:
     std::vector<TensorPtr> mPageBlocks;
-    std::deque<std::size_t> mFreePageIds;
     std::vector<std::uint8_t> mIsPageFree;
+    SizeType32 mNumFreePages{0};
     LoraCachePageManagerConfig const mConfig;
+    mutable std::mutex mMutex;
+
+    /**
+     * \returns -- (first page id, number of pages) of all runs of contiguous free pages
+     */
+    [[nodiscard]] std::vector<std::pair<std::size_t, std::size_t>> getFreeRuns() const;
 
     void initialize(BufferManager const& bufferManager);
 };
@@ -285,6 +338,19 @@ public:
      */
     [[nodiscard]] SizeType32 getNumPages() const;
 
+    /**
+     * \returns -- occupancy and fragmentation of the cache pages
+     */
+    [[nodiscard]] LoraCachePageStats getPageStats() const;
+
+    /**
+     * \brief move the pages of all tasks to the lowest page ids, so that the free pages are contiguous.
+     * Only done when the cache is idle, ie no task is in progress, since the weights pointers of the tasks change.
+     *
+     * \returns -- number of moved pages
+     */
+    SizeType32 defragment();
+
     /**
      * \param[in] pageId: the page id
      * \returns -- const pointer to page
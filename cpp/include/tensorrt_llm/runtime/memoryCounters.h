@@ -19,19 +19,55 @@
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 
+#include <array>
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 namespace tensorrt_llm::runtime
 {
 
+//! \brief Subsystem an allocation is attributed to, see MemoryCounters::ScopedTag.
+enum class MemoryTag : std::uint8_t
+{
+    kUNTAGGED = 0,
+    kKV_CACHE = 1,
+    kLORA_CACHE = 2,
+    kDECODER = 3,
+    kRUNTIME_BUFFERS = 4,
+    kTRT_ACTIVATIONS = 5, // engine device memory, including the plugin workspaces
+    kCUSTOM_ALL_REDUCE = 6,
+};
+
 class MemoryCounters
 {
 public:
     using SizeType32 = std::size_t;
     using DiffType = std::ptrdiff_t;
 
+    static auto constexpr kNumTags = static_cast<std::size_t>(MemoryTag::kCUSTOM_ALL_REDUCE) + 1;
+
+    //! \brief Attributes the allocations of the current thread to tag while in scope. Each allocation keeps the tag
+    //! it was made with until it is released, wherever that happens.
+    class ScopedTag
+    {
+    public:
+        explicit ScopedTag(MemoryTag tag);
+        ~ScopedTag();
+
+        ScopedTag(ScopedTag const&) = delete;
+        ScopedTag& operator=(ScopedTag const&) = delete;
+
+    private:
+        MemoryTag mPrevious;
+    };
+
+    //! \brief The tag of the allocations of the current thread.
+    static MemoryTag getCurrentTag();
+
     MemoryCounters() = default;
 
     [[nodiscard]] SizeType32 getGpu() const
@@ -74,9 +110,46 @@ public:
         return mUVMDiff;
     }
 
+    //! \brief Bytes of memoryType currently attributed to tag.
+    [[nodiscard]] SizeType32 getTagged(MemoryTag tag, MemoryType memoryType) const
+    {
+        return mTagged[index(tag, memoryType)];
+    }
+
+    //! \brief Highest number of bytes of memoryType attributed to tag since the last resetPeaks.
+    [[nodiscard]] SizeType32 getTaggedPeak(MemoryTag tag, MemoryType memoryType) const
+    {
+        return mTaggedPeak[index(tag, memoryType)];
+    }
+
+    //! \brief Restarts the high-water marks from the current usage, e.g. to measure a phase.
+    void resetPeaks();
+
+    static char const* tagToString(MemoryTag tag);
+
+    //! \brief Count an allocation of ptr under the current tag, which deallocate(ptr, size) releases from.
+    template <MemoryType T>
+    void allocate(void const* ptr, SizeType32 size)
+    {
+        auto const tag = getCurrentTag();
+        if (tag != MemoryTag::kUNTAGGED && ptr != nullptr)
+        {
+            std::lock_guard<std::mutex> lock(mTagsMutex);
+            mTags[ptr] = tag;
+        }
+        allocate<T>(size, tag);
+    }
+
+    template <MemoryType T>
+    void deallocate(void const* ptr, SizeType32 size)
+    {
+        deallocate<T>(size, releaseTag(ptr));
+    }
+
     template <MemoryType T>
-    void allocate(SizeType32 size)
+    void allocate(SizeType32 size, MemoryTag tag = MemoryTag::kUNTAGGED)
     {
+        addTagged(index(tag, T), size);
         auto const sizeDiff = static_cast<DiffType>(size);
         if constexpr (T == MemoryType::kGPU)
         {
@@ -104,11 +177,12 @@ public:
         }
     }
 
-    void allocate(MemoryType memoryType, SizeType32 size);
+    void allocate(MemoryType memoryType, SizeType32 size, MemoryTag tag = MemoryTag::kUNTAGGED);
 
     template <MemoryType T>
-    void deallocate(SizeType32 size)
+    void deallocate(SizeType32 size, MemoryTag tag = MemoryTag::kUNTAGGED)
     {
+        mTagged[index(tag, T)] -= size;
         auto const sizeDiff = -static_cast<DiffType>(size);
         if constexpr (T == MemoryType::kGPU)
         {
@@ -136,7 +210,7 @@ public:
         }
     }
 
-    void deallocate(MemoryType memoryType, SizeType32 size);
+    void deallocate(MemoryType memoryType, SizeType32 size, MemoryTag tag = MemoryTag::kUNTAGGED);
 
     static MemoryCounters& getInstance();
 
@@ -146,9 +220,46 @@ public:
 
     [[nodiscard]] std::string toString() const;
 
+    //! \brief Current and peak GPU memory of each tag that has any.
+    [[nodiscard]] std::string toTaggedString() const;
+
 private:
+    static auto constexpr kNumMemoryTypes = static_cast<std::size_t>(MemoryType::kUVM) + 1;
+
+    static std::size_t index(MemoryTag tag, MemoryType memoryType)
+    {
+        return static_cast<std::size_t>(tag) * kNumMemoryTypes + static_cast<std::size_t>(memoryType);
+    }
+
+    MemoryTag releaseTag(void const* ptr)
+    {
+        std::lock_guard<std::mutex> lock(mTagsMutex);
+        auto const it = mTags.find(ptr);
+        if (it == mTags.end())
+        {
+            return MemoryTag::kUNTAGGED;
+        }
+        auto const tag = it->second;
+        mTags.erase(it);
+        return tag;
+    }
+
+    void addTagged(std::size_t idx, SizeType32 size)
+    {
+        auto const current = mTagged[idx] += size;
+        auto peak = mTaggedPeak[idx].load();
+        while (current > peak && !mTaggedPeak[idx].compare_exchange_weak(peak, current))
+        {
+        }
+    }
+
     std::atomic<SizeType32> mGpu{}, mCpu{}, mPinned{}, mUVM{};
     std::atomic<DiffType> mGpuDiff{}, mCpuDiff{}, mPinnedDiff{}, mUVMDiff{};
+    std::array<std::atomic<SizeType32>, kNumTags * kNumMemoryTypes> mTagged{};
+    std::array<std::atomic<SizeType32>, kNumTags * kNumMemoryTypes> mTaggedPeak{};
+    // Tags of the live tagged allocations, untagged ones are not recorded
+    std::mutex mTagsMutex;
+    std::unordered_map<void const*, MemoryTag> mTags;
 };
 
 } // namespace tensorrt_llm::runtime
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+struct OfflineRunnerConfig
+{
+    //! Tokens per KV cache block of the engine, for grouping the prompts by their first block
+    SizeType32 tokensPerBlock{64};
+    //! Blocks of the KV cache, taken from the iteration stats of the executor if not given
+    std::optional<SizeType32> maxNumBlocks{std::nullopt};
+    //! Requests of the plan considered to fill the leftover blocks, see batch_manager::OfflineBatchPlanner
+    SizeType32 lookahead{64};
+    //! Predicted blocks of the requests in flight per block of the KV cache. The requests rarely reach their predicted
+    //! length together, above 1 keeps the cache fuller at the cost of pausing requests when they do.
+    float overcommit{1.f};
+};
+
+//! \brief Runs a dataset known up front through an executor for throughput, in an order of its own.
+//! \details The requests are ordered and packed by batch_manager::OfflineBatchPlanner, by shared prefix and predicted
+//! total length, and are submitted as the predicted blocks of the requests in flight leave room in the KV cache, so
+//! the batch stays topped up while submission order doesn't decide its composition. Block reuse should be enabled
+//! for the shared prefixes to pay off.
+class OfflineRunner
+{
+public:
+    using IdType = executor::IdType;
+    //! Called with the index of the request in the dataset and its id in the executor once submitted
+    using EnqueuedCallback = std::function<void(std::size_t requestIdx, IdType requestId)>;
+    using ResponseCallback = std::function<void(std::size_t requestIdx, executor::Response const& response)>;
+
+    OfflineRunner(executor::Executor& executor, OfflineRunnerConfig const& config);
+
+    //! \brief Runs the requests to completion.
+    //! \param predictedOutputLengths The predicted output length of each request, its maxNewTokens if not given.
+    //! \returns The final response of each request, in the order of the dataset.
+    std::vector<executor::Response> run(std::vector<executor::Request> requests,
+        std::optional<std::vector<SizeType32>> const& predictedOutputLengths = std::nullopt,
+        EnqueuedCallback const& onEnqueued = {}, ResponseCallback const& onResponse = {});
+
+private:
+    executor::Executor& mExecutor;
+    OfflineRunnerConfig mConfig;
+};
+
+} // namespace tensorrt_llm::runtime
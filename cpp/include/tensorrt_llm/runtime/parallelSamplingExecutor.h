@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/batch_manager/parallelSampling.h"
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief An executor returning several sampled sequences per request, which share a single prefill of the prompt.
+//! \details A request with numReturnSequences > 1 first runs a prefill of its prompt, a copy of the request that
+//! generates one token. Once it completes, the prompt is in the reusable KV cache blocks and the samples are enqueued
+//! as requests of their own with distinct seeds, so they skip the prefill of the cached blocks. The final results of
+//! the samples are merged into a single response with a sequence per sample, see batch_manager::ParallelSampleGroup.
+//! Without block reuse the samples are enqueued at once and each one runs its own prefill.
+class ParallelSamplingExecutor
+{
+public:
+    using IdType = executor::IdType;
+
+    ParallelSamplingExecutor(std::filesystem::path const& modelPath, executor::ModelType modelType,
+        executor::ExecutorConfig const& executorConfig);
+
+    ~ParallelSamplingExecutor();
+
+    ParallelSamplingExecutor(ParallelSamplingExecutor const&) = delete;
+    ParallelSamplingExecutor& operator=(ParallelSamplingExecutor const&) = delete;
+
+    //! \param numReturnSequences The sequences sampled for the request. Requests with more than one sequence need
+    //! beam width 1 and no streaming.
+    [[nodiscard]] IdType enqueueRequest(executor::Request const& request, SizeType32 numReturnSequences = 1);
+
+    [[nodiscard]] std::vector<executor::Response> awaitResponses(
+        std::optional<std::chrono::milliseconds> const& timeout = std::nullopt);
+
+    void cancelRequest(IdType requestId);
+
+    void shutdown();
+
+    //! \returns The prefills that were shared by the samples of a request.
+    [[nodiscard]] std::size_t getNumSharedPrefills() const;
+
+private:
+    static constexpr SizeType32 kPREFILL = -1;
+
+    struct SampledRequest
+    {
+        executor::Request request;
+        batch_manager::ParallelSampleGroup group;
+        //! Executor ids of the prefill or of the samples in flight
+        std::vector<IdType> executorRequestIds;
+        bool cancelled{false};
+    };
+
+    struct Part
+    {
+        IdType requestId;
+        //! Index of the sample, kPREFILL for the prefill
+        SizeType32 sampleIdx;
+    };
+
+    //! \brief Enqueues the samples of the request. Needs mMutex.
+    void enqueueSamplesLocked(IdType requestId, SampledRequest& sampled);
+
+    //! \brief Handles a response of the executor. Needs mMutex.
+    //! \returns The response to the request, if the response completes it.
+    [[nodiscard]] std::optional<executor::Response> handleResponseLocked(executor::Response const& response);
+
+    void collectLoop();
+
+    std::unique_ptr<executor::Executor> mExecutor;
+    bool mSharePrefill;
+
+    mutable std::mutex mMutex;
+    std::unordered_map<IdType, SampledRequest> mSampledRequests;
+    //! The request and the sample of each executor request of a sampled request
+    std::unordered_map<IdType, Part> mParts;
+    //! Requests with a single sequence, by executor id
+    std::unordered_map<IdType, IdType> mSingleRequests;
+    IdType mNextRequestId{1};
+    std::size_t mNumSharedPrefills{0};
+    bool mShutdown{false};
+
+    std::mutex mResponseMutex;
+    std::condition_variable mResponseCv;
+    std::vector<executor::Response> mResponses;
+
+    std::thread mCollector;
+};
+
+} // namespace tensorrt_llm::runtime
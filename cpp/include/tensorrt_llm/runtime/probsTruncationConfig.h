@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/layers/defaultDecodingParams.h"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Min-p, typical-p and eta truncation of the sampled probabilities, applied before topK and topP.
+//! \details Kept apart from SamplingConfig, which LlmRequest holds by value and whose layout is therefore fixed by the
+//! prebuilt batch manager library. Set up on the decoder after the sampling config of the same requests.
+struct ProbsTruncationConfig
+{
+    using FloatType = float;
+    using OptVec = std::optional<std::vector<FloatType>>;
+
+    ProbsTruncationConfig() = default;
+
+    //! \brief Fuses the configs of single requests into the config of their batch.
+    explicit ProbsTruncationConfig(std::vector<ProbsTruncationConfig> const& configs)
+    {
+        minP = fuseValues(configs, &ProbsTruncationConfig::minP, layers::DefaultDecodingParams::getMinP());
+        typicalP = fuseValues(configs, &ProbsTruncationConfig::typicalP, layers::DefaultDecodingParams::getTypicalP());
+        etaCutoff
+            = fuseValues(configs, &ProbsTruncationConfig::etaCutoff, layers::DefaultDecodingParams::getEtaCutoff());
+    }
+
+    [[nodiscard]] bool validate() const
+    {
+        auto constexpr fltEpsilon = std::numeric_limits<float>::epsilon();
+        bool valid{true};
+        valid &= validateVec("minP", minP, -fltEpsilon, 1.f);
+        valid &= validateVec("typicalP", typicalP, 0.f, 1.f);
+        valid &= validateVec("etaCutoff", etaCutoff, -fltEpsilon, 1.f - fltEpsilon);
+        return valid;
+    }
+
+    [[nodiscard]] bool operator==(ProbsTruncationConfig const& other) const
+    {
+        return minP == other.minP && typicalP == other.typicalP && etaCutoff == other.etaCutoff;
+    }
+
+    OptVec minP;      // [1] or [batch_size], must between [0, 1]
+    OptVec typicalP;  // [1] or [batch_size], must between (0, 1]
+    OptVec etaCutoff; // [1] or [batch_size], must between [0, 1)
+
+private:
+    static OptVec fuseValues(std::vector<ProbsTruncationConfig> const& configs, OptVec ProbsTruncationConfig::*member,
+        FloatType defaultValue)
+    {
+        bool const atLeastOneHasValue = std::any_of(
+            configs.begin(), configs.end(), [member](auto const& config) { return (config.*member).has_value(); });
+        if (!atLeastOneHasValue)
+        {
+            return std::nullopt;
+        }
+        std::vector<FloatType> values;
+        values.reserve(configs.size());
+        for (auto const& config : configs)
+        {
+            auto const& configValue = config.*member;
+            TLLM_CHECK(!configValue.has_value() || configValue->size() == 1);
+            values.push_back(configValue.has_value() ? configValue->front() : defaultValue);
+        }
+        return values;
+    }
+
+    static bool validateVec(char const* name, OptVec const& vec, FloatType min, FloatType max)
+    {
+        bool const valid = !vec
+            || std::all_of(vec->begin(), vec->end(), [min, max](FloatType elem) { return min < elem && elem <= max; });
+        if (!valid)
+        {
+            TLLM_LOG_WARNING("Incorrect sampling param. %s is out of range (%f, %f]", name, min, max);
+        }
+        return valid;
+    }
+};
+
+} // namespace tensorrt_llm::runtime
@@ -50,6 +50,11 @@ public:
         return SpeculativeDecodingMode{kExplicitDraftTokens};
     }
 
+    static auto constexpr PromptLookup()
+    {
+        return SpeculativeDecodingMode{kPromptLookup};
+    }
+
     [[nodiscard]] bool constexpr isNone() const
     {
         return anyBitSet(kNone);
@@ -75,6 +80,11 @@ public:
         return anyBitSet(kExplicitDraftTokens);
     }
 
+    [[nodiscard]] bool constexpr isPromptLookup() const
+    {
+        return anyBitSet(kPromptLookup);
+    }
+
     [[nodiscard]] bool constexpr requiresAttentionMask() const
     {
         return anyBitSet(kLookaheadDecoding | kMedusa | kExplicitDraftTokens);
@@ -82,18 +92,18 @@ public:
 
     [[nodiscard]] bool constexpr predictsDraftTokens() const
     {
-        return anyBitSet(kLookaheadDecoding | kMedusa | kExplicitDraftTokens);
+        return anyBitSet(kLookaheadDecoding | kMedusa | kExplicitDraftTokens | kPromptLookup);
     }
 
     [[nodiscard]] bool constexpr needsKVCacheRewind() const
     {
-        return anyBitSet(kLookaheadDecoding | kMedusa | kExplicitDraftTokens);
+        return anyBitSet(kLookaheadDecoding | kMedusa | kExplicitDraftTokens | kPromptLookup);
     }
 
     [[nodiscard]] bool constexpr variableDraftLength() const
     {
         // Add Lookahead, when lookahead supports it.
-        return anyBitSet(kDraftTokensExternal | kExplicitDraftTokens);
+        return anyBitSet(kDraftTokensExternal | kExplicitDraftTokens | kPromptLookup);
     }
 
     [[nodiscard]] bool constexpr hasDraftLogits() const
@@ -120,6 +130,8 @@ private:
     static UnderlyingType constexpr kMedusa{1U << 2U};
     static UnderlyingType constexpr kLookaheadDecoding{1U << 3U};
     static UnderlyingType constexpr kExplicitDraftTokens{1U << 4U};
+    // Draft tokens are copied from the prompt and the output of the request after a match of its last tokens.
+    static UnderlyingType constexpr kPromptLookup{1U << 5U};
 
     [[nodiscard]] bool constexpr anyBitSet(UnderlyingType bits) const
     {
@@ -163,5 +175,14 @@ static_assert(!SpeculativeDecodingMode::ExplicitDraftTokens().isNone());
 static_assert(!SpeculativeDecodingMode::ExplicitDraftTokens().isDraftTokensExternal());
 static_assert(!SpeculativeDecodingMode::ExplicitDraftTokens().isMedusa());
 static_assert(!SpeculativeDecodingMode::ExplicitDraftTokens().isLookaheadDecoding());
+static_assert(!SpeculativeDecodingMode::ExplicitDraftTokens().isPromptLookup());
+
+static_assert(SpeculativeDecodingMode::PromptLookup().isPromptLookup());
+static_assert(!SpeculativeDecodingMode::PromptLookup().isNone());
+static_assert(!SpeculativeDecodingMode::PromptLookup().isDraftTokensExternal());
+static_assert(!SpeculativeDecodingMode::PromptLookup().isMedusa());
+static_assert(!SpeculativeDecodingMode::PromptLookup().isLookaheadDecoding());
+static_assert(!SpeculativeDecodingMode::PromptLookup().isExplicitDraftTokens());
+static_assert(!SpeculativeDecodingMode::PromptLookup().requiresAttentionMask());
 
 } // namespace tensorrt_llm::runtime
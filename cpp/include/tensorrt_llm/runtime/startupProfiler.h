@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Phases of the startup of an executor or session.
+enum class StartupPhase : std::uint8_t
+{
+    kENGINE_DESERIALIZATION = 0,
+    kCONTEXT_CREATION = 1,
+    kKV_CACHE_ALLOCATION = 2,
+    kCUSTOM_ALL_REDUCE_SETUP = 3,
+    kXQA_JIT = 4,
+    kCUDA_GRAPH_CAPTURE = 5,
+};
+
+[[nodiscard]] char const* toString(StartupPhase phase) noexcept;
+
+//! \brief Wall time spent in a startup phase.
+struct StartupPhaseStats
+{
+    //! Number of times the phase ran, e.g. once per execution context or per compiled XQA kernel
+    std::uint32_t count{0};
+    double totalMs{0};
+    //! Time from the creation of the profiler to the end of the last run of the phase
+    double lastEndMs{0};
+};
+
+//! \brief Breaks down the startup time into its phases, to track cold start regressions.
+//! \details The phases are timed where they happen, in the runtime and the kernels, and accumulated process wide. The
+//! phases of different ranks or engines run in the same process add up.
+class StartupProfiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::size_t kNumPhases = 6;
+
+    //! \brief Times a phase from its construction to its destruction.
+    class Scope
+    {
+    public:
+        Scope(StartupProfiler& profiler, StartupPhase phase);
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        ~Scope();
+
+    private:
+        StartupProfiler& mProfiler;
+        StartupPhase mPhase;
+        Clock::time_point mBegin;
+    };
+
+    static StartupProfiler& getInstance();
+
+    StartupProfiler();
+
+    [[nodiscard]] Scope scope(StartupPhase phase)
+    {
+        return Scope{*this, phase};
+    }
+
+    void record(StartupPhase phase, Clock::time_point begin, Clock::time_point end);
+
+    [[nodiscard]] StartupPhaseStats getPhaseStats(StartupPhase phase) const;
+
+    //! \returns The time since the creation of the profiler in milliseconds.
+    [[nodiscard]] double getElapsedMs() const;
+
+    //! \returns A table of the phases, one per line.
+    [[nodiscard]] std::string report() const;
+
+    //! \returns The phases as a json object, with the phase names as keys.
+    [[nodiscard]] std::string toJsonStr() const;
+
+private:
+    Clock::time_point const mCreation;
+    mutable std::mutex mMutex;
+    std::array<StartupPhaseStats, kNumPhases> mPhases{};
+};
+
+} // namespace tensorrt_llm::runtime
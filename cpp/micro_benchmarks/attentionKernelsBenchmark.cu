@@ -0,0 +1,727 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/quantization.h"
+#include "tensorrt_llm/kernels/contextFusedMultiHeadAttention/fmhaRunner.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQAImpl.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQARunner.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/multiBlockHeuristic.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/xqaParams.h"
+#include "tensorrt_llm/kernels/kvCacheIndex.h"
+#include "tensorrt_llm/kernels/kvCacheUtils.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace tensorrt_llm::kernels;
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+static BufferManager::CudaStreamPtr streamPtr;
+static std::unique_ptr<BufferManager> bufferManager;
+
+namespace
+{
+
+//! \brief Type of the KV cache elements, the cache is either in the type of the activations or quantized.
+enum class KvCacheType : std::int64_t
+{
+    kACTIVATION = 0,
+    kINT8 = 1,
+    kFP8 = 2,
+};
+
+//! \brief Shape of a generation step: one new token per beam, which attends to kvLen cached tokens.
+struct GenerationConfig
+{
+    SizeType32 batch;
+    SizeType32 beam;
+    SizeType32 kvLen;
+    SizeType32 heads;
+    SizeType32 kvHeads;
+    SizeType32 headDim;
+    KvCacheType kvType;
+    SizeType32 tokensPerBlock;
+    bool multiBlock;
+
+    [[nodiscard]] SizeType32 batchBeam() const
+    {
+        return batch * beam;
+    }
+};
+
+template <typename T>
+struct AttentionTypes;
+
+template <>
+struct AttentionTypes<half>
+{
+    // MMHA is instantiated for the bit pattern of half
+    using MmhaType = std::uint16_t;
+    static constexpr Data_type kDataType = DATA_TYPE_FP16;
+};
+
+#ifdef ENABLE_BF16
+template <>
+struct AttentionTypes<__nv_bfloat16>
+{
+    using MmhaType = __nv_bfloat16;
+    static constexpr Data_type kDataType = DATA_TYPE_BF16;
+};
+#endif
+
+//! \brief Fixture for the attention kernels of the generation and context phases. The queries and the paged KV cache
+//! are allocated on the GPU once per benchmark, every KV cache block is a distinct block of the pool so that the
+//! kernels read as many bytes from HBM as they would in a real batch. Only the launch is timed, with CUDA events.
+//! Every benchmark reports the achieved bandwidth as bytes_per_second, the Q, K, V and output bytes over the kernel
+//! time, and the achieved FLOPS of the two matmuls of attention.
+class AttentionKernelsBenchmark : public benchmark::Fixture
+{
+public:
+    void SetUp(benchmark::State& state) override
+    {
+        check_cuda_error(cudaDeviceSynchronize());
+        check_cuda_error(cudaEventCreate(&mStartEvent));
+        check_cuda_error(cudaEventCreate(&mEndEvent));
+        mGen.seed(0xA77E);
+    }
+
+    void TearDown(benchmark::State& state) override
+    {
+        check_cuda_error(cudaDeviceSynchronize());
+        mRestores.clear();
+        mBuffers.clear();
+        mHostBlockOffsets.clear();
+        check_cuda_error(cudaEventDestroy(mStartEvent));
+        check_cuda_error(cudaEventDestroy(mEndEvent));
+    }
+
+    template <typename T>
+    void runMmha(benchmark::State& state);
+    template <typename T>
+    void runXqa(benchmark::State& state, DecoderXQAImpl::ImplType implType);
+    template <typename T>
+    void runContextFmha(benchmark::State& state);
+
+private:
+    //! \brief Buffers of a generation step, shared by MMHA and XQA.
+    struct GenerationBuffers
+    {
+        void* qkv;
+        void* out;
+        SizeType32* sequenceLengths;
+        SizeType32* contextLengths;
+        SizeType32 const* cacheIndir;
+        float* kvScaleOrigQuant;
+        float* kvScaleQuantOrig;
+        std::vector<SizeType32> hostPastKvLengths;
+        std::vector<SizeType32> hostContextLengths;
+        KVBlockArray kvCache;
+    };
+
+    static GenerationConfig generationConfig(benchmark::State const& state)
+    {
+        return GenerationConfig{static_cast<SizeType32>(state.range(0)), static_cast<SizeType32>(state.range(1)),
+            static_cast<SizeType32>(state.range(2)), static_cast<SizeType32>(state.range(3)),
+            static_cast<SizeType32>(state.range(4)), static_cast<SizeType32>(state.range(5)),
+            static_cast<KvCacheType>(state.range(6)), static_cast<SizeType32>(state.range(7)), state.range(8) != 0};
+    }
+
+    template <typename T>
+    static std::size_t kvElementSize(KvCacheType kvType)
+    {
+        return kvType == KvCacheType::kACTIVATION ? sizeof(T) : 1;
+    }
+
+    static QuantMode kvCacheQuantMode(KvCacheType kvType)
+    {
+        switch (kvType)
+        {
+        case KvCacheType::kINT8: return QuantMode::int8KvCache();
+        case KvCacheType::kFP8: return QuantMode::fp8KvCache();
+        default: return QuantMode::none();
+        }
+    }
+
+    //! \returns count zeroed elements on the GPU.
+    template <typename T>
+    T* allocate(std::size_t count)
+    {
+        auto buffer = bufferManager->gpu(count * sizeof(T));
+        check_cuda_error(cudaMemset(buffer->data(), 0, buffer->getSizeInBytes()));
+        auto* ptr = static_cast<T*>(buffer->data());
+        mBuffers.push_back(std::move(buffer));
+        return ptr;
+    }
+
+    template <typename T>
+    T* upload(std::vector<T> const& host)
+    {
+        auto* ptr = allocate<T>(host.size());
+        check_cuda_error(cudaMemcpy(ptr, host.data(), host.size() * sizeof(T), cudaMemcpyHostToDevice));
+        return ptr;
+    }
+
+    //! \brief Restores the current content of ptr before every timed launch.
+    template <typename T>
+    void restoreBeforeLaunch(T* ptr, std::size_t count)
+    {
+        auto* initial = allocate<T>(count);
+        check_cuda_error(cudaMemcpy(initial, ptr, count * sizeof(T), cudaMemcpyDeviceToDevice));
+        mRestores.emplace_back(ptr, initial, count * sizeof(T));
+    }
+
+    template <typename T>
+    std::vector<T> randomValues(std::size_t count)
+    {
+        std::uniform_real_distribution<float> dist{-1.F, 1.F};
+        std::vector<T> values(count);
+        for (auto& value : values)
+        {
+            value = static_cast<T>(dist(mGen));
+        }
+        return values;
+    }
+
+    //! \brief Allocates a paged KV cache of numSeqs sequences of kvLen tokens, with distinct blocks for the K and V
+    //! of every sequence. The block offsets are also kept on the host for the paged context FMHA.
+    //! \returns std::nullopt if the pool doesn't fit in the free device memory.
+    std::optional<KVBlockArray> allocateKvCache(SizeType32 numSeqs, SizeType32 kvLen, SizeType32 kvHeads,
+        SizeType32 headDim, std::size_t elementSize, SizeType32 tokensPerBlock)
+    {
+        auto const maxBlocksPerSeq = static_cast<SizeType32>(divUp(kvLen, tokensPerBlock));
+        auto const bytesPerToken = static_cast<SizeType32>(kvHeads * headDim * elementSize);
+        auto const numBlocks = static_cast<std::size_t>(numSeqs) * 2 * maxBlocksPerSeq;
+        auto const poolSize = numBlocks * tokensPerBlock * bytesPerToken;
+
+        std::size_t freeMem{0};
+        std::size_t totalMem{0};
+        check_cuda_error(cudaMemGetInfo(&freeMem, &totalMem));
+        if (poolSize > freeMem / 10 * 9)
+        {
+            return std::nullopt;
+        }
+
+        // [numSeqs, 2 (K and V), maxBlocksPerSeq]
+        mHostBlockOffsets.clear();
+        mHostBlockOffsets.reserve(numBlocks);
+        for (std::size_t i = 0; i < numBlocks; ++i)
+        {
+            mHostBlockOffsets.emplace_back(static_cast<KVCacheIndex::UnderlyingType>(i));
+        }
+        auto* pool = allocate<std::int8_t>(poolSize);
+        auto* offsets = upload(mHostBlockOffsets);
+        return KVBlockArray(
+            numSeqs, maxBlocksPerSeq, tokensPerBlock, bytesPerToken, kvLen, 0, pool, nullptr, offsets);
+    }
+
+    //! \returns std::nullopt, and skips the benchmark, if the KV cache doesn't fit on the device.
+    template <typename T>
+    std::optional<GenerationBuffers> allocateGeneration(benchmark::State& state, GenerationConfig const& config)
+    {
+        auto const batchBeam = config.batchBeam();
+        auto kvCache = allocateKvCache(batchBeam, config.kvLen, config.kvHeads, config.headDim,
+            kvElementSize<T>(config.kvType), config.tokensPerBlock);
+        if (!kvCache)
+        {
+            state.SkipWithMessage("The KV cache doesn't fit in the device memory");
+            return std::nullopt;
+        }
+        auto const qkvSize = static_cast<std::size_t>(batchBeam) * (config.heads + 2 * config.kvHeads) * config.headDim;
+
+        GenerationBuffers buffers{};
+        buffers.qkv = upload(randomValues<T>(qkvSize));
+        buffers.out = allocate<T>(static_cast<std::size_t>(batchBeam) * config.heads * config.headDim);
+        // The new token is the last one of the sequence
+        buffers.sequenceLengths = upload(std::vector<SizeType32>(batchBeam, config.kvLen));
+        buffers.contextLengths = upload(std::vector<SizeType32>(batchBeam, config.kvLen));
+        buffers.hostPastKvLengths.assign(config.batch, config.kvLen - 1);
+        buffers.hostContextLengths.assign(config.batch, config.kvLen);
+        // All the beams read the history of beam 0
+        buffers.cacheIndir = config.beam > 1
+            ? allocate<SizeType32>(static_cast<std::size_t>(batchBeam) * config.kvLen)
+            : nullptr;
+        buffers.kvScaleOrigQuant = upload(std::vector<float>{1.F});
+        buffers.kvScaleQuantOrig = upload(std::vector<float>{1.F});
+        buffers.kvCache = *kvCache;
+        return buffers;
+    }
+
+    template <typename T>
+    static XQAParams xqaParams(GenerationConfig const& config, GenerationBuffers const& buffers, void* workspace)
+    {
+        XQAParams params{};
+        params.data_type = AttentionTypes<T>::kDataType;
+        switch (config.kvType)
+        {
+        case KvCacheType::kINT8: params.kv_cache_data_type = DATA_TYPE_INT8; break;
+        case KvCacheType::kFP8: params.kv_cache_data_type = DATA_TYPE_E4M3; break;
+        default: params.kv_cache_data_type = params.data_type; break;
+        }
+        params.output = buffers.out;
+        params.qkv = buffers.qkv;
+        params.cache_indir = buffers.cacheIndir;
+        params.kv_scale_orig_quant = buffers.kvScaleOrigQuant;
+        params.kv_scale_quant_orig = buffers.kvScaleQuantOrig;
+        params.host_past_key_value_lengths = buffers.hostPastKvLengths.data();
+        params.host_context_lengths = buffers.hostContextLengths.data();
+        params.workspaces = workspace;
+        params.batch_size = config.batch;
+        params.beam_width = config.beam;
+        params.max_attention_window_size = config.kvLen;
+        params.cyclic_attention_window_size = config.kvLen;
+        params.timestep = config.kvLen - 1;
+        params.sequence_lengths = buffers.sequenceLengths;
+        params.context_lengths = buffers.contextLengths;
+        params.generation_input_length = 1;
+        params.num_q_heads = config.heads;
+        params.num_kv_heads = config.kvHeads;
+        params.head_size = config.headDim;
+        params.unidirectional = 1;
+        params.q_scaling = 1.F;
+        params.position_embedding_type = PositionEmbeddingType::kLEARNED_ABSOLUTE;
+        params.mask_type = AttentionMaskType::CAUSAL;
+        params.paged_kv_cache = true;
+        params.tokens_per_block = config.tokensPerBlock;
+        params.max_blocks_per_sequence = buffers.kvCache.mMaxBlocksPerSeq;
+        params.kv_cache_quant_mode = kvCacheQuantMode(config.kvType);
+        params.multi_block_mode = config.multiBlock;
+        params.total_num_input_tokens = config.batchBeam();
+        return params;
+    }
+
+    //! \brief Labels the benchmark with the path the GPT attention plugin takes for this configuration when XQA is
+    //! enabled, XQA or MMHA, and the number of blocks per sequence the multi-block heuristic picks for MMHA.
+    template <typename T>
+    static void labelSelectedPath(
+        benchmark::State& state, GenerationConfig const& config, GenerationBuffers const& buffers)
+    {
+        DecoderXQARunner::Resource resource;
+        DecoderXQARunner runner(
+            &resource, AttentionTypes<T>::kDataType, config.heads, config.kvHeads, config.headDim, config.multiBlock);
+        auto const params = xqaParams<T>(config, buffers, nullptr);
+        std::string label = "selected:";
+        if (runner.template shouldUse<T>(params, /*forConfigurePlugin=*/false))
+        {
+            label += "XQA";
+        }
+        else
+        {
+            auto const smCount = getMultiProcessorCount();
+            auto const decision = MultiBlockHeuristic::getInstance().decide(
+                config.batchBeam(), config.heads, config.kvLen, smCount, divUp(smCount, config.heads));
+            label += "MMHA splits:" + std::to_string(decision.numSplits);
+        }
+        state.SetLabel(label);
+    }
+
+    //! \brief Times launch, with itemsPerLaunch tokens, bytesPerLaunch bytes read or written and flopsPerLaunch
+    //! floating point operations.
+    template <typename Launch>
+    void run(benchmark::State& state, std::int64_t itemsPerLaunch, std::int64_t bytesPerLaunch, double flopsPerLaunch,
+        Launch&& launch)
+    {
+        auto const stream = streamPtr->get();
+        auto const restore = [&]()
+        {
+            for (auto const& [ptr, initial, size] : mRestores)
+            {
+                check_cuda_error(cudaMemcpyAsync(ptr, initial, size, cudaMemcpyDeviceToDevice, stream));
+            }
+        };
+
+        // Warm up
+        restore();
+        launch(stream);
+        check_cuda_error(cudaStreamSynchronize(stream));
+
+        for (auto _ : state)
+        {
+            restore();
+            check_cuda_error(cudaEventRecord(mStartEvent, stream));
+            launch(stream);
+            check_cuda_error(cudaEventRecord(mEndEvent, stream));
+            check_cuda_error(cudaEventSynchronize(mEndEvent));
+            float ms{0.F};
+            check_cuda_error(cudaEventElapsedTime(&ms, mStartEvent, mEndEvent));
+            state.SetIterationTime(ms / 1000.F);
+        }
+        check_cuda_error(cudaGetLastError());
+        state.SetItemsProcessed(state.iterations() * itemsPerLaunch);
+        state.SetBytesProcessed(state.iterations() * bytesPerLaunch);
+        state.counters["FLOPS"] = benchmark::Counter(
+            flopsPerLaunch * static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    }
+
+    //! \brief Bytes read and written by a generation step, every beam reads the whole history of its request.
+    template <typename T>
+    static std::int64_t generationBytes(GenerationConfig const& config)
+    {
+        auto const kvBytes = std::int64_t{2} * config.kvLen * config.kvHeads * config.headDim
+            * static_cast<std::int64_t>(kvElementSize<T>(config.kvType));
+        auto const qkvoBytes = std::int64_t{2} * (config.heads + config.kvHeads) * config.headDim * sizeof(T);
+        return config.batchBeam() * (kvBytes + qkvoBytes);
+    }
+
+    static double generationFlops(GenerationConfig const& config)
+    {
+        // Q * K^T and P * V, 2 FLOPs per multiply-add
+        return 4.0 * config.batchBeam() * config.heads * config.kvLen * config.headDim;
+    }
+
+    struct Restore
+    {
+        Restore(void* ptr, void const* initial, std::size_t size)
+            : ptr{ptr}
+            , initial{initial}
+            , size{size}
+        {
+        }
+
+        void* ptr;
+        void const* initial;
+        std::size_t size;
+    };
+
+    std::vector<IBuffer::UniquePtr> mBuffers;
+    std::vector<Restore> mRestores;
+    std::vector<KVCacheIndex> mHostBlockOffsets;
+    std::mt19937 mGen;
+    cudaEvent_t mStartEvent{};
+    cudaEvent_t mEndEvent{};
+};
+
+template <typename T>
+void AttentionKernelsBenchmark::runMmha(benchmark::State& state)
+{
+    using DataType = typename AttentionTypes<T>::MmhaType;
+    auto const config = generationConfig(state);
+    if (!mmha_supported(config.headDim))
+    {
+        state.SkipWithMessage("MMHA doesn't support the head size");
+        return;
+    }
+#ifndef ENABLE_FP8
+    if (config.kvType == KvCacheType::kFP8)
+    {
+        state.SkipWithMessage("Built without FP8");
+        return;
+    }
+#endif
+    auto buffers = allocateGeneration<T>(state, config);
+    if (!buffers)
+    {
+        return;
+    }
+    labelSelectedPath<T>(state, config, *buffers);
+
+    auto const batchBeam = config.batchBeam();
+    auto const smCount = getMultiProcessorCount();
+    int maxSharedMemoryPerBlockOptin{0};
+    check_cuda_error(cudaDeviceGetAttribute(
+        &maxSharedMemoryPerBlockOptin, cudaDevAttrMaxSharedMemoryPerBlockOptin, getDevice()));
+    // Same as the GPT attention plugin: long sequences need several blocks even without multi-block mode
+    auto const minNumSeqLenTiles
+        = estimate_min_multi_block_count<DataType>(config.kvLen, maxSharedMemoryPerBlockOptin - 2048);
+    auto const decision = MultiBlockHeuristic::getInstance().decide(
+        batchBeam, config.heads, config.kvLen, smCount, divUp(smCount, config.heads));
+    auto const maxNumSeqLenTiles = config.multiBlock
+        ? std::max({static_cast<int>(divUp(smCount, batchBeam * config.heads)), decision.numSplits, minNumSeqLenTiles})
+        : minNumSeqLenTiles;
+    if (config.multiBlock && maxNumSeqLenTiles <= 1)
+    {
+        state.SkipWithMessage("Multi-block mode doesn't split this batch");
+        return;
+    }
+
+    Masked_multihead_attention_params<DataType> params{};
+    auto const* qkv = static_cast<DataType const*>(buffers->qkv);
+    params.q = qkv;
+    params.k = qkv + config.heads * config.headDim;
+    params.v = qkv + (config.heads + config.kvHeads) * config.headDim;
+    params.stride = (config.heads + 2 * config.kvHeads) * config.headDim;
+    params.out = static_cast<DataType*>(buffers->out);
+    params.cache_indir = buffers->cacheIndir;
+    params.batch_size = config.batch;
+    params.beam_width = config.beam;
+    params.max_attention_window_size = config.kvLen;
+    params.cyclic_attention_window_size = config.kvLen;
+    params.length_per_sample = buffers->sequenceLengths;
+    params.input_lengths = buffers->contextLengths;
+    params.timestep = config.kvLen - 1;
+    params.num_heads = config.heads;
+    params.num_kv_heads = config.kvHeads;
+    params.hidden_size_per_head = config.headDim;
+    params.inv_sqrt_dh = 1.F / std::sqrt(static_cast<float>(config.headDim));
+    params.int8_kv_cache = config.kvType == KvCacheType::kINT8;
+    params.fp8_kv_cache = config.kvType == KvCacheType::kFP8;
+    if (config.kvType != KvCacheType::kACTIVATION)
+    {
+        params.kv_scale_orig_quant = buffers->kvScaleOrigQuant;
+        params.kv_scale_quant_orig = buffers->kvScaleQuantOrig;
+    }
+    params.multi_processor_count = smCount;
+    params.multi_block_mode = maxNumSeqLenTiles > 1;
+    if (params.multi_block_mode)
+    {
+        auto const numPartials = static_cast<std::size_t>(batchBeam) * config.heads * maxNumSeqLenTiles;
+        params.min_seq_len_tile = decision.profiled ? maxNumSeqLenTiles : std::max(1, minNumSeqLenTiles);
+        params.max_seq_len_tile = maxNumSeqLenTiles;
+        params.partial_out = allocate<DataType>(numPartials * config.headDim);
+        params.partial_sum = allocate<float>(numPartials);
+        params.partial_max = allocate<float>(numPartials);
+        params.block_counter = allocate<int>(static_cast<std::size_t>(batchBeam) * config.heads);
+        restoreBeforeLaunch(params.block_counter, static_cast<std::size_t>(batchBeam) * config.heads);
+    }
+
+    KVLinearBuffer shiftKCache{};
+    run(state, batchBeam, generationBytes<T>(config), generationFlops(config),
+        [&](cudaStream_t stream) { masked_multihead_attention(params, buffers->kvCache, shiftKCache, stream); });
+}
+
+template <typename T>
+void AttentionKernelsBenchmark::runXqa(benchmark::State& state, DecoderXQAImpl::ImplType implType)
+{
+    auto const config = generationConfig(state);
+    // Same as the GPT attention plugin
+    if (config.multiBlock
+        && (config.kvType == KvCacheType::kINT8 || (config.kvType == KvCacheType::kFP8 && getSMVersion() != kSM_90)))
+    {
+        state.SkipWithMessage("XQA multi-block mode doesn't support the KV cache type");
+        return;
+    }
+    auto buffers = allocateGeneration<T>(state, config);
+    if (!buffers)
+    {
+        return;
+    }
+    labelSelectedPath<T>(state, config, *buffers);
+
+    DecoderXQARunner::Resource resource;
+    DecoderXQARunner runner(
+        &resource, AttentionTypes<T>::kDataType, config.heads, config.kvHeads, config.headDim, config.multiBlock);
+    auto impl = DecoderXQAImpl::create(&runner, implType);
+    auto* workspace = allocate<std::int8_t>(runner.getWorkspaceSize(config.batchBeam(), config.batchBeam()));
+    auto const params = xqaParams<T>(config, *buffers, workspace);
+    // Whether the implementation can run this configuration, not whether the plugin would prefer it
+    if (!impl->shouldUse(params, /*forConfigurePlugin=*/true))
+    {
+        state.SkipWithMessage("The XQA implementation doesn't support the configuration");
+        return;
+    }
+    // Loads or compiles the kernel outside of the timed launches
+    impl->prepare(params);
+
+    run(state, config.batchBeam(), generationBytes<T>(config), generationFlops(config),
+        [&](cudaStream_t stream) { impl->template run<KVBlockArray>(params, buffers->kvCache, stream); });
+}
+
+template <typename T>
+void AttentionKernelsBenchmark::runContextFmha(benchmark::State& state)
+{
+    auto const batch = static_cast<SizeType32>(state.range(0));
+    auto const seqLen = static_cast<SizeType32>(state.range(1));
+    auto const heads = static_cast<SizeType32>(state.range(2));
+    auto const kvHeads = static_cast<SizeType32>(state.range(3));
+    auto const headDim = static_cast<SizeType32>(state.range(4));
+    auto const tokensPerBlock = static_cast<SizeType32>(state.range(5));
+
+    if (!MHARunner::fmha_supported(headDim, getSMVersion()))
+    {
+        state.SkipWithMessage("Context FMHA doesn't support the head size");
+        return;
+    }
+    FusedMHARunnerV2 runner(AttentionTypes<T>::kDataType, /*pagedKVFMHA=*/true, heads, headDim, /*qScaling=*/1.F);
+    if (!runner.fmha_supported())
+    {
+        state.SkipWithMessage("No context FMHA kernel for the configuration");
+        return;
+    }
+    runner.setup_flags(/*force_fp32_acc=*/false, /*is_s_padded=*/false, /*causal_mask=*/true, kvHeads);
+    if (!runner.isValid(seqLen))
+    {
+        state.SkipWithMessage("No context FMHA kernel for the sequence length");
+        return;
+    }
+
+    // The paged context FMHA reads the KV of the prompt from the cache, which the QKV preprocessing has written
+    auto const kvCache = allocateKvCache(batch, seqLen, kvHeads, headDim, sizeof(T), tokensPerBlock);
+    if (!kvCache)
+    {
+        state.SkipWithMessage("The KV cache doesn't fit in the device memory");
+        return;
+    }
+    auto const numTokens = static_cast<std::size_t>(batch) * seqLen;
+    auto const* q = upload(randomValues<T>(numTokens * heads * headDim));
+    auto* out = allocate<T>(numTokens * heads * headDim);
+    std::vector<SizeType32> cuSeqLens(batch + 1);
+    for (SizeType32 i = 0; i <= batch; ++i)
+    {
+        cuSeqLens[i] = i * seqLen;
+    }
+    auto const* cuQSeqLens = upload(cuSeqLens);
+    auto const* cuKvSeqLens = upload(cuSeqLens);
+    // The persistent kernels count the tiles they have taken, the plugin resets the counter before every launch
+    auto* tileCounter = allocate<std::uint32_t>(1);
+    restoreBeforeLaunch(tileCounter, 1);
+
+    runner.setup(batch, seqLen, seqLen, kvCache->mMaxBlocksPerSeq, tokensPerBlock, seqLen, batch * seqLen);
+
+    // Q, K, V and the output, and half of the Q * K^T and P * V FLOPs with the causal mask
+    auto const bytes = static_cast<std::int64_t>(numTokens) * 2 * (heads + kvHeads) * headDim * sizeof(T);
+    auto const flops = 4.0 * batch * heads * headDim * seqLen * (seqLen + 1) / 2;
+    run(state, static_cast<std::int64_t>(numTokens), bytes, flops,
+        [&](cudaStream_t stream)
+        {
+            runner.run(q, mHostBlockOffsets.data(), *kvCache, cuQSeqLens, cuKvSeqLens, tileCounter, nullptr, out,
+                stream);
+        });
+}
+
+/*
+ * Below is all the setup for parameterising the benchmarks
+ */
+
+// Heads and KV heads of MHA, GQA and MQA models
+std::vector<std::pair<std::int64_t, std::int64_t>> const kHeads{{32, 32}, {32, 8}, {64, 8}, {32, 1}};
+
+void generationArgs(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames(
+        {"Batch", "Beam", "KvLen", "Heads", "KvHeads", "HeadDim", "KvType", "TokensPerBlock", "MultiBlock"});
+    for (auto const batch : {1, 8, 64})
+    {
+        for (auto const beam : {1, 4})
+        {
+            for (auto const kvLen : {1024, 8192})
+            {
+                for (auto const& [heads, kvHeads] : kHeads)
+                {
+                    for (auto const headDim : {64, 128})
+                    {
+                        for (auto const kvType : {KvCacheType::kACTIVATION, KvCacheType::kINT8, KvCacheType::kFP8})
+                        {
+                            for (auto const tokensPerBlock : {32, 64, 128})
+                            {
+                                for (auto const multiBlock : {0, 1})
+                                {
+                                    benchmark->Args({batch, beam, kvLen, heads, kvHeads, headDim,
+                                        static_cast<std::int64_t>(kvType), tokensPerBlock, multiBlock});
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void contextArgs(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"Batch", "SeqLen", "Heads", "KvHeads", "HeadDim", "TokensPerBlock"});
+    for (auto const& [heads, kvHeads] : kHeads)
+    {
+        for (auto const batch : {1, 8})
+        {
+            for (auto const seqLen : {512, 2048, 8192})
+            {
+                for (auto const headDim : {64, 128})
+                {
+                    for (auto const tokensPerBlock : {32, 64, 128})
+                    {
+                        benchmark->Args({batch, seqLen, heads, kvHeads, headDim, tokensPerBlock});
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+#define ATTENTION_BENCHMARK(name, call, args)                                                                          \
+    BENCHMARK_DEFINE_F(AttentionKernelsBenchmark, name)(benchmark::State & state)                                     \
+    {                                                                                                                  \
+        call;                                                                                                          \
+    }                                                                                                                  \
+    BENCHMARK_REGISTER_F(AttentionKernelsBenchmark, name)                                                              \
+        ->Apply(args)                                                                                                  \
+        ->UseManualTime()                                                                                              \
+        ->Unit(benchmark::kMicrosecond)
+
+ATTENTION_BENCHMARK(Mmha_half, runMmha<half>(state), generationArgs);
+ATTENTION_BENCHMARK(XqaPrecompiled_half, runXqa<half>(state, DecoderXQAImpl::ImplType::kPrecompiled), generationArgs);
+ATTENTION_BENCHMARK(XqaJit_half, runXqa<half>(state, DecoderXQAImpl::ImplType::kJIT), generationArgs);
+ATTENTION_BENCHMARK(ContextFmha_half, runContextFmha<half>(state), contextArgs);
+#ifdef ENABLE_BF16
+ATTENTION_BENCHMARK(Mmha_bf16, runMmha<__nv_bfloat16>(state), generationArgs);
+ATTENTION_BENCHMARK(
+    XqaPrecompiled_bf16, runXqa<__nv_bfloat16>(state, DecoderXQAImpl::ImplType::kPrecompiled), generationArgs);
+ATTENTION_BENCHMARK(XqaJit_bf16, runXqa<__nv_bfloat16>(state, DecoderXQAImpl::ImplType::kJIT), generationArgs);
+ATTENTION_BENCHMARK(ContextFmha_bf16, runContextFmha<__nv_bfloat16>(state), contextArgs);
+#endif
+
+int main(int argc, char** argv)
+{
+    if (getDeviceCount() <= 0)
+    {
+        std::cerr << "No GPU found, skipping the attention kernel benchmarks" << std::endl;
+        return 0;
+    }
+    streamPtr = std::make_shared<CudaStream>();
+    bufferManager = std::make_unique<BufferManager>(streamPtr);
+
+    int res = 0;
+    try
+    {
+        benchmark::Initialize(&argc, argv);
+        if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        {
+            res = -1;
+        }
+        else
+        {
+            benchmark::RunSpecifiedBenchmarks();
+            benchmark::Shutdown();
+        }
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "Exiting benchmarks with exception: " << e.what() << std::endl;
+        res = -3;
+    }
+
+    bufferManager.reset();
+    streamPtr.reset();
+    return res;
+}
@@ -0,0 +1,59 @@
+import argparse
+import json
+
+# Compares two google-benchmark JSON outputs of mixtureOfExpertsBackendBenchmark, e.g. from two commits:
+#   ./mixtureOfExpertsBackendBenchmark --input_file suite.json --benchmark_out=base.json --benchmark_out_format=json
+
+TIME_UNITS = {"ns": 1e-6, "us": 1e-3, "ms": 1.0, "s": 1e3}
+
+
+def load_results(filename):
+    with open(filename) as f:
+        data = json.load(f)
+    results = {}
+    for bench in data["benchmarks"]:
+        # Skip the mean/median/stddev rows emitted with --benchmark_repetitions
+        if bench.get("run_type", "iteration") != "iteration" or bench.get(
+                "error_occurred", False):
+            continue
+        time_ms = bench["real_time"] * TIME_UNITS[bench.get("time_unit", "ns")]
+        results[bench["name"]] = (time_ms, bench)
+    return results
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('baseline', type=str, help='The baseline results file')
+parser.add_argument('contender', type=str, help='The results file to compare')
+parser.add_argument(
+    '--threshold',
+    type=float,
+    default=0.05,
+    help='Relative change reported as a regression or an improvement')
+args = parser.parse_args()
+
+baseline = load_results(args.baseline)
+contender = load_results(args.contender)
+
+regressions = 0
+print(f"{'benchmark':<100} {'base ms':>10} {'new ms':>10} {'change':>8}")
+for name, (base_ms, _) in baseline.items():
+    if name not in contender:
+        print(f"{name:<100} {base_ms:>10.4f} {'missing':>10}")
+        continue
+    new_ms, bench = contender[name]
+    change = (new_ms - base_ms) / base_ms if base_ms > 0 else 0.0
+    marker = ""
+    if change > args.threshold:
+        marker = " REGRESSION"
+        regressions += 1
+    elif change < -args.threshold:
+        marker = " improved"
+    print(
+        f"{name:<100} {base_ms:>10.4f} {new_ms:>10.4f} {change:>+8.1%}{marker}"
+    )
+
+for name in contender.keys() - baseline.keys():
+    print(f"{name:<100} {'new':>10} {contender[name][0]:>10.4f}")
+
+print(f"{regressions} regressions above {args.threshold:.0%}")
+exit(1 if regressions > 0 else 0)
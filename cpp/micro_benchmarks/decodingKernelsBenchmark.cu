@@ -0,0 +1,639 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/banBadWords.h"
+#include "tensorrt_llm/kernels/beamSearchKernels.h"
+#include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/decodingKernels.h"
+#include "tensorrt_llm/kernels/penaltyKernels.h"
+#include "tensorrt_llm/kernels/samplingTopKKernels.h"
+#include "tensorrt_llm/kernels/samplingTopPKernels.h"
+#include "tensorrt_llm/kernels/stopCriteriaKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace tensorrt_llm::kernels;
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+static BufferManager::CudaStreamPtr streamPtr;
+static std::unique_ptr<BufferManager> bufferManager;
+
+namespace
+{
+
+// Sequence length of the requests for the kernels which write one token per step
+constexpr SizeType32 kSamplingSeqLen = 16;
+constexpr SizeType32 kSamplingMaxSeqLen = 64;
+
+//! \brief Fixture for the kernels of the decode step. Every benchmark allocates its inputs on the GPU, the buffers
+//! which a kernel updates in place are restored before every launch, so that each launch sees the same state, e.g.
+//! the same sequence lengths and no finished requests. Only the launch is timed, with CUDA events.
+class DecodingKernelsBenchmark : public benchmark::Fixture
+{
+public:
+    void SetUp(benchmark::State& state) override
+    {
+        check_cuda_error(cudaDeviceSynchronize());
+        check_cuda_error(cudaEventCreate(&mStartEvent));
+        check_cuda_error(cudaEventCreate(&mEndEvent));
+        mGen.seed(0xDEC0DE);
+    }
+
+    void TearDown(benchmark::State& state) override
+    {
+        check_cuda_error(cudaDeviceSynchronize());
+        mRestores.clear();
+        mBuffers.clear();
+        check_cuda_error(cudaEventDestroy(mStartEvent));
+        check_cuda_error(cudaEventDestroy(mEndEvent));
+    }
+
+    template <typename T>
+    void runTopK(benchmark::State& state);
+    template <typename T>
+    void runTopP(benchmark::State& state, bool air);
+    template <typename T>
+    void runPenalty(benchmark::State& state);
+    template <typename T>
+    void runBanBadWords(benchmark::State& state);
+    void runStopWords(benchmark::State& state);
+    template <typename T>
+    void runBeamSearch(benchmark::State& state);
+    void runGatherTree(benchmark::State& state);
+
+private:
+    //! \returns count zeroed elements on the GPU.
+    template <typename T>
+    T* allocate(std::size_t count)
+    {
+        auto buffer = bufferManager->gpu(count * sizeof(T));
+        check_cuda_error(cudaMemset(buffer->data(), 0, buffer->getSizeInBytes()));
+        auto* ptr = static_cast<T*>(buffer->data());
+        mBuffers.push_back(std::move(buffer));
+        return ptr;
+    }
+
+    template <typename T>
+    T* upload(std::vector<T> const& host)
+    {
+        auto* ptr = allocate<T>(host.size());
+        check_cuda_error(cudaMemcpy(ptr, host.data(), host.size() * sizeof(T), cudaMemcpyHostToDevice));
+        return ptr;
+    }
+
+    //! \brief Restores the current content of ptr before every timed launch.
+    template <typename T>
+    void restoreBeforeLaunch(T* ptr, std::size_t count)
+    {
+        auto* initial = allocate<T>(count);
+        check_cuda_error(cudaMemcpy(initial, ptr, count * sizeof(T), cudaMemcpyDeviceToDevice));
+        mRestores.emplace_back(ptr, initial, count * sizeof(T));
+    }
+
+    //! \returns Pointers to the rows of size rowSize of base.
+    template <typename T>
+    std::vector<T*> rows(T* base, std::size_t numRows, std::size_t rowSize)
+    {
+        std::vector<T*> ptrs(numRows);
+        for (std::size_t i = 0; i < numRows; ++i)
+        {
+            ptrs[i] = base + i * rowSize;
+        }
+        return ptrs;
+    }
+
+    template <typename T>
+    std::vector<T> randomLogits(std::size_t count)
+    {
+        std::normal_distribution<float> dist{0.F, 4.F};
+        std::vector<T> logits(count);
+        for (auto& logit : logits)
+        {
+            logit = static_cast<T>(dist(mGen));
+        }
+        return logits;
+    }
+
+    //! \returns The softmax of random logits, per row of size vocabSize.
+    template <typename T>
+    std::vector<T> randomProbs(std::size_t numRows, std::size_t vocabSize)
+    {
+        auto const logits = randomLogits<float>(numRows * vocabSize);
+        std::vector<T> probs(logits.size());
+        for (std::size_t row = 0; row < numRows; ++row)
+        {
+            auto const* rowLogits = logits.data() + row * vocabSize;
+            auto const maxLogit = *std::max_element(rowLogits, rowLogits + vocabSize);
+            double sum = 0.0;
+            for (std::size_t i = 0; i < vocabSize; ++i)
+            {
+                sum += std::exp(rowLogits[i] - maxLogit);
+            }
+            for (std::size_t i = 0; i < vocabSize; ++i)
+            {
+                probs[row * vocabSize + i] = static_cast<T>(std::exp(rowLogits[i] - maxLogit) / sum);
+            }
+        }
+        return probs;
+    }
+
+    std::vector<TokenIdType> randomTokens(std::size_t count, SizeType32 vocabSize)
+    {
+        std::uniform_int_distribution<TokenIdType> dist{0, vocabSize - 1};
+        std::vector<TokenIdType> tokens(count);
+        for (auto& token : tokens)
+        {
+            token = dist(mGen);
+        }
+        return tokens;
+    }
+
+    //! \returns numRequests word lists in the layout of the stop and bad words: the ids of numWords words of
+    //! wordLen tokens each, followed by the end offsets of the words.
+    std::vector<TokenIdType> randomWordLists(SizeType32 numRequests, SizeType32 numWords, SizeType32 wordLen,
+        SizeType32 vocabSize)
+    {
+        auto const listLen = numWords * wordLen;
+        std::vector<TokenIdType> lists;
+        lists.reserve(numRequests * 2 * listLen);
+        for (SizeType32 r = 0; r < numRequests; ++r)
+        {
+            auto const ids = randomTokens(listLen, vocabSize);
+            lists.insert(lists.end(), ids.begin(), ids.end());
+            for (SizeType32 i = 0; i < listLen; ++i)
+            {
+                lists.push_back(i < numWords ? (i + 1) * wordLen : -1);
+            }
+        }
+        return lists;
+    }
+
+    static std::vector<SizeType32> iota(SizeType32 count)
+    {
+        std::vector<SizeType32> values(count);
+        std::iota(values.begin(), values.end(), 0);
+        return values;
+    }
+
+    //! \brief Times launch, with itemsPerLaunch tokens or requests and bytesPerLaunch bytes of logits read.
+    template <typename Launch>
+    void run(benchmark::State& state, std::int64_t itemsPerLaunch, std::int64_t bytesPerLaunch, Launch&& launch)
+    {
+        auto const stream = streamPtr->get();
+        auto const restore = [&]()
+        {
+            for (auto const& [ptr, initial, size] : mRestores)
+            {
+                check_cuda_error(cudaMemcpyAsync(ptr, initial, size, cudaMemcpyDeviceToDevice, stream));
+            }
+        };
+
+        // Warm up
+        restore();
+        launch(stream);
+        check_cuda_error(cudaStreamSynchronize(stream));
+
+        for (auto _ : state)
+        {
+            restore();
+            check_cuda_error(cudaEventRecord(mStartEvent, stream));
+            launch(stream);
+            check_cuda_error(cudaEventRecord(mEndEvent, stream));
+            check_cuda_error(cudaEventSynchronize(mEndEvent));
+            float ms{0.F};
+            check_cuda_error(cudaEventElapsedTime(&ms, mStartEvent, mEndEvent));
+            state.SetIterationTime(ms / 1000.F);
+        }
+        check_cuda_error(cudaGetLastError());
+        state.SetItemsProcessed(state.iterations() * itemsPerLaunch);
+        if (bytesPerLaunch > 0)
+        {
+            state.SetBytesProcessed(state.iterations() * bytesPerLaunch);
+        }
+    }
+
+    struct Restore
+    {
+        Restore(void* ptr, void const* initial, std::size_t size)
+            : ptr{ptr}
+            , initial{initial}
+            , size{size}
+        {
+        }
+
+        void* ptr;
+        void const* initial;
+        std::size_t size;
+    };
+
+    std::vector<IBuffer::UniquePtr> mBuffers;
+    std::vector<Restore> mRestores;
+    std::mt19937 mGen;
+    cudaEvent_t mStartEvent{};
+    cudaEvent_t mEndEvent{};
+};
+
+template <typename T>
+void DecodingKernelsBenchmark::runTopK(benchmark::State& state)
+{
+    auto const batchSize = static_cast<SizeType32>(state.range(0));
+    auto const vocabSize = static_cast<SizeType32>(state.range(1));
+    auto const topK = static_cast<SizeType32>(state.range(2));
+
+    TopKSamplingKernelParams<T> params;
+    params.logProbs = upload(randomLogits<T>(batchSize * vocabSize));
+    params.outputIds = allocate<TokenIdType>(batchSize * kSamplingMaxSeqLen);
+    params.workspace = allocate<std::int8_t>(getTopKWorkspaceSize<T>(batchSize, 1, topK, vocabSize));
+    params.endIds = upload(std::vector<TokenIdType>(batchSize, vocabSize - 1));
+    params.sequenceLengths = upload(std::vector<SizeType32>(batchSize, kSamplingSeqLen));
+    params.batchSlots = upload(iota(batchSize));
+    params.finishedOutput = allocate<FinishedState>(batchSize);
+    params.randomSeeds = upload(std::vector<std::uint64_t>(batchSize, 42));
+    params.maxTopK = topK;
+    params.batchSize = batchSize;
+    params.maxBatchSize = batchSize;
+    params.vocabSizePadded = vocabSize;
+    params.maxTokensPerStep = 1;
+    params.maxSeqLen = kSamplingMaxSeqLen;
+    restoreBeforeLaunch(params.sequenceLengths, batchSize);
+    restoreBeforeLaunch(params.finishedOutput, batchSize);
+
+    run(state, batchSize, std::int64_t{batchSize} * vocabSize * sizeof(T),
+        [&](cudaStream_t stream) { invokeBatchTopKSampling(params, stream); });
+}
+
+template <typename T>
+void DecodingKernelsBenchmark::runTopP(benchmark::State& state, bool air)
+{
+    auto const batchSize = static_cast<SizeType32>(state.range(0));
+    auto const vocabSize = static_cast<SizeType32>(state.range(1));
+    auto const topP = static_cast<float>(state.range(2)) / 100.F;
+    auto const isDeterministic = air && state.range(3) != 0;
+
+    auto const workspaceSize = air ? getAirTopPWorkspaceSize<T>(batchSize, vocabSize, isDeterministic)
+                                   : getTopPWorkspaceSize<T>(batchSize, vocabSize);
+    auto* outputIds = allocate<TokenIdType>(batchSize * kSamplingMaxSeqLen);
+
+    TopPSamplingKernelParams<T> params;
+    params.probs = upload(randomProbs<T>(batchSize, vocabSize));
+    params.outputIds = upload(rows(outputIds, batchSize, kSamplingMaxSeqLen));
+    params.workspace = allocate<std::int8_t>(workspaceSize);
+    params.topPs = upload(std::vector<float>(batchSize, topP));
+    params.sequenceLength = upload(std::vector<SizeType32>(batchSize, kSamplingSeqLen));
+    params.endIds = upload(std::vector<TokenIdType>(batchSize, vocabSize - 1));
+    params.batchSlots = upload(iota(batchSize));
+    params.finishedOutput = allocate<FinishedState>(batchSize);
+    params.randomSeeds = upload(std::vector<std::uint64_t>(batchSize, 42));
+    params.isDeterministic = isDeterministic;
+    params.batchSize = batchSize;
+    params.maxBatchSize = batchSize;
+    params.vocabSizePadded = vocabSize;
+    if (air)
+    {
+        auto const smCount = getMultiProcessorCount();
+        params.blockNum
+            = static_cast<SizeType32>(calcAirTopPBlockNum<T>(batchSize, vocabSize, smCount, isDeterministic));
+    }
+    restoreBeforeLaunch(params.sequenceLength, batchSize);
+    restoreBeforeLaunch(params.finishedOutput, batchSize);
+
+    run(state, batchSize, std::int64_t{batchSize} * vocabSize * sizeof(T),
+        [&](cudaStream_t stream)
+        {
+            if (air)
+            {
+                invokeBatchAirTopPSampling(params, stream);
+            }
+            else
+            {
+                invokeBatchTopPSampling(params, stream);
+            }
+        });
+}
+
+template <typename T>
+void DecodingKernelsBenchmark::runPenalty(benchmark::State& state)
+{
+    auto const batchSize = static_cast<SizeType32>(state.range(0));
+    auto const vocabSize = static_cast<SizeType32>(state.range(1));
+    auto const seqLen = static_cast<SizeType32>(state.range(2));
+
+    auto* inputLogits = upload(randomLogits<T>(batchSize * vocabSize));
+    auto* outputIds = upload(randomTokens(batchSize * seqLen, vocabSize));
+
+    InvokeBatchApplyPenaltyParams<T> params{};
+    params.inputLogits = upload(rows<T const>(inputLogits, batchSize, vocabSize));
+    params.outputLogits = allocate<T>(batchSize * vocabSize);
+    params.penaltyWorkspace = allocate<TokenIdType>(batchSize * vocabSize);
+    params.temperatures = upload(std::vector<float>(batchSize, 0.8F));
+    params.repetitionPenalties = upload(std::vector<float>(batchSize, 1.2F));
+    params.presencePenalties = upload(std::vector<float>(batchSize, 0.5F));
+    params.frequencyPenalties = upload(std::vector<float>(batchSize, 0.5F));
+    params.batchSize = batchSize;
+    params.beamWidth = 1;
+    params.maxSeqLen = seqLen;
+    params.vocabSize = vocabSize;
+    params.vocabSizePadded = vocabSize;
+    params.outputIdsPtr = upload(rows<TokenIdType const>(outputIds, batchSize, seqLen));
+    params.inputLengths = upload(std::vector<SizeType32>(batchSize, seqLen / 2));
+    params.sequenceLengths = upload(std::vector<SizeType32>(batchSize, seqLen));
+    params.minLengths = upload(std::vector<SizeType32>(batchSize, 1));
+    params.endIds = upload(std::vector<TokenIdType>(batchSize, vocabSize - 1));
+    params.batchSlots = upload(iota(batchSize));
+    params.maxTokensPerStep = 1;
+
+    run(state, batchSize, std::int64_t{batchSize} * vocabSize * sizeof(T),
+        [&](cudaStream_t stream)
+        {
+            params.stream = stream;
+            invokeBatchApplyPenalty(params);
+        });
+}
+
+template <typename T>
+void DecodingKernelsBenchmark::runBanBadWords(benchmark::State& state)
+{
+    auto const batchSize = static_cast<SizeType32>(state.range(0));
+    auto const numWords = static_cast<SizeType32>(state.range(1));
+    auto const wordLen = static_cast<SizeType32>(state.range(2));
+    auto constexpr vocabSize = 32000;
+    auto constexpr seqLen = 1024;
+    auto const listLen = numWords * wordLen;
+
+    auto* logits = upload(randomLogits<T>(batchSize * vocabSize));
+    auto* outputIds = upload(randomTokens(batchSize * seqLen, vocabSize));
+    auto* badWords = upload(randomWordLists(batchSize, numWords, wordLen, vocabSize));
+    auto outputIdsPtrs = upload(rows<TokenIdType const>(outputIds, batchSize, seqLen));
+    auto badWordsPtrs = upload(rows<TokenIdType const>(badWords, batchSize, 2 * listLen));
+    auto const* badWordsLens = upload(std::vector<SizeType32>(batchSize, listLen));
+    auto const* sequenceLengths = upload(std::vector<SizeType32>(batchSize, seqLen));
+    auto const* batchSlots = upload(iota(batchSize));
+
+    run(state, batchSize, 0,
+        [&](cudaStream_t stream)
+        {
+            invokeBanBadWords(logits, outputIdsPtrs, nullptr, batchSlots, batchSize, 1, badWordsPtrs, badWordsLens,
+                listLen, vocabSize, sequenceLengths, seqLen, stream);
+        });
+}
+
+void DecodingKernelsBenchmark::runStopWords(benchmark::State& state)
+{
+    auto const batchSize = static_cast<SizeType32>(state.range(0));
+    auto const numWords = static_cast<SizeType32>(state.range(1));
+    auto const wordLen = static_cast<SizeType32>(state.range(2));
+    auto constexpr vocabSize = 32000;
+    auto constexpr seqLen = 1024;
+    auto const listLen = numWords * wordLen;
+
+    auto* outputIds = upload(randomTokens(batchSize * seqLen, vocabSize));
+    auto* stopWords = upload(randomWordLists(batchSize, numWords, wordLen, vocabSize));
+    auto outputIdsPtrs = upload(rows<TokenIdType const>(outputIds, batchSize, seqLen));
+    auto stopWordsPtrs = upload(rows<TokenIdType const>(stopWords, batchSize, 2 * listLen));
+    auto const* stopWordsLens = upload(std::vector<SizeType32>(batchSize, listLen));
+    auto* sequenceLengths = upload(std::vector<SizeType32>(batchSize, seqLen));
+    auto* finished = allocate<FinishedState>(batchSize);
+    auto const* batchSlots = upload(iota(batchSize));
+    restoreBeforeLaunch(finished, batchSize);
+
+    run(state, batchSize, 0,
+        [&](cudaStream_t stream)
+        {
+            invokeStopWordsCriterion(outputIdsPtrs, nullptr, stopWordsPtrs, finished, sequenceLengths, batchSlots,
+                stopWordsLens, nullptr, listLen, batchSize, 1, seqLen, stream);
+        });
+}
+
+template <typename T>
+void DecodingKernelsBenchmark::runBeamSearch(benchmark::State& state)
+{
+    auto const batchSize = static_cast<SizeType32>(state.range(0));
+    auto const beamWidth = static_cast<SizeType32>(state.range(1));
+    auto const vocabSize = static_cast<SizeType32>(state.range(2));
+    auto const batchBeam = batchSize * beamWidth;
+    auto constexpr maxSeqLen = kSamplingMaxSeqLen;
+
+    auto const* logits = upload(randomLogits<T>(batchBeam * vocabSize));
+    auto* workspace = allocate<float>(getTopkSoftMaxWorkspaceSize(batchSize, beamWidth));
+    auto* outputIds = allocate<TokenIdType>(batchBeam * maxSeqLen);
+    auto* parentIds = allocate<SizeType32>(batchBeam * maxSeqLen);
+
+    BeamHypotheses bh;
+    bh.nMaxBatchSize = batchSize;
+    bh.nBatchSize = batchSize;
+    bh.nBeamWidth = beamWidth;
+    bh.nMaxSeqLen = maxSeqLen;
+    bh.nVocabSize = vocabSize;
+    bh.diversityRates = allocate<float>(batchSize);
+    bh.lengthPenalties = upload(std::vector<float>(batchSize, 1.F));
+    bh.earlyStoppings = upload(std::vector<int>(batchSize, 1));
+    bh.inputLengths = upload(std::vector<SizeType32>(batchBeam, kSamplingSeqLen));
+    bh.endIds = upload(std::vector<TokenIdType>(batchSize, vocabSize - 1));
+    bh.sequenceLengths = upload(std::vector<SizeType32>(batchBeam, kSamplingSeqLen));
+    bh.cumLogProbs = allocate<float>(batchBeam);
+    bh.outputIdsCBA = allocate<TokenIdType>(batchBeam * 2 * maxSeqLen);
+    bh.logProbsCBA = allocate<float>(batchBeam * 2 * maxSeqLen);
+    bh.sequenceLengthsCBA = allocate<SizeType32>(batchBeam * 2);
+    bh.cumLogProbsCBA = allocate<float>(batchBeam * 2);
+    bh.normedScoresCBA = allocate<float>(batchBeam * 2);
+    bh.numBeamsCBA = allocate<int>(batchSize);
+    bh.minNormedScoresCBA = allocate<float>(batchSize);
+    bh.batchDones = allocate<bool>(batchSize);
+    bh.finished = allocate<FinishedState>(batchBeam);
+    bh.outputIdsPtr = upload(rows(outputIds, batchSize, beamWidth * maxSeqLen));
+    bh.parentIdsPtr = upload(rows(parentIds, batchSize, beamWidth * maxSeqLen));
+    restoreBeforeLaunch(bh.sequenceLengths, batchBeam);
+    restoreBeforeLaunch(bh.cumLogProbs, batchBeam);
+    restoreBeforeLaunch(bh.numBeamsCBA, batchSize);
+    restoreBeforeLaunch(bh.minNormedScoresCBA, batchSize);
+    restoreBeforeLaunch(bh.batchDones, batchSize);
+    restoreBeforeLaunch(bh.finished, batchBeam);
+
+    run(state, batchBeam, std::int64_t{batchBeam} * vocabSize * sizeof(T),
+        [&](cudaStream_t stream) { invokeTopkSoftMax<T>(logits, nullptr, workspace, bh, stream); });
+}
+
+void DecodingKernelsBenchmark::runGatherTree(benchmark::State& state)
+{
+    auto const batchSize = static_cast<SizeType32>(state.range(0));
+    auto const beamWidth = static_cast<SizeType32>(state.range(1));
+    auto const seqLen = static_cast<SizeType32>(state.range(2));
+    auto const batchBeam = batchSize * beamWidth;
+    auto constexpr vocabSize = 32000;
+
+    std::uniform_int_distribution<SizeType32> beamDist{0, beamWidth - 1};
+    std::vector<SizeType32> parentIds(seqLen * batchBeam);
+    for (auto& parentId : parentIds)
+    {
+        parentId = beamDist(mGen);
+    }
+    std::uniform_real_distribution<float> logProbDist{-50.F, -1.F};
+    std::vector<float> cumLogProbs(batchBeam);
+    for (auto& cumLogProb : cumLogProbs)
+    {
+        cumLogProb = logProbDist(mGen);
+    }
+
+    gatherTreeParam param;
+    param.beams = allocate<TokenIdType>(batchBeam * seqLen);
+    param.sequenceLengths = upload(std::vector<SizeType32>(batchBeam, seqLen));
+    // The sequence lengths are final, so that the kernel doesn't extend them
+    param.maxSequenceLengthFinalStep = 1;
+    param.inputLengths = upload(std::vector<SizeType32>(batchBeam, seqLen / 4));
+    param.maxSeqLen = seqLen;
+    param.batchSize = batchSize;
+    param.beamWidth = beamWidth;
+    param.stepIds = upload(randomTokens(seqLen * batchBeam, vocabSize));
+    param.parentIds = upload(parentIds);
+    param.endTokens = upload(std::vector<TokenIdType>(batchSize, vocabSize - 1));
+    param.outputIds = allocate<TokenIdType>(batchBeam * seqLen);
+    param.cumLogProbs = upload(cumLogProbs);
+    restoreBeforeLaunch(param.sequenceLengths, batchBeam);
+    restoreBeforeLaunch(param.cumLogProbs, batchBeam);
+
+    run(state, batchBeam, 0,
+        [&](cudaStream_t stream)
+        {
+            param.stream = stream;
+            invokeGatherTree(param);
+        });
+}
+
+/*
+ * Below is all the setup for parameterising the benchmarks
+ */
+
+std::vector<std::int64_t> const kBatchSizes{1, 8, 64, 256};
+std::vector<std::int64_t> const kVocabSizes{32000, 128256};
+
+void topKArgs(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"Batch", "Vocab", "K"});
+    benchmark->ArgsProduct({kBatchSizes, kVocabSizes, {1, 8, 64, 1024}});
+}
+
+void topPArgs(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"Batch", "Vocab", "P%"});
+    benchmark->ArgsProduct({kBatchSizes, kVocabSizes, {50, 90, 100}});
+}
+
+void airTopPArgs(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"Batch", "Vocab", "P%", "Deterministic"});
+    benchmark->ArgsProduct({kBatchSizes, kVocabSizes, {50, 90, 100}, {0, 1}});
+}
+
+void penaltyArgs(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"Batch", "Vocab", "SeqLen"});
+    benchmark->ArgsProduct({kBatchSizes, kVocabSizes, {128, 2048}});
+}
+
+void wordListArgs(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"Batch", "Words", "WordLen"});
+    benchmark->ArgsProduct({kBatchSizes, {1, 8, 32}, {1, 4}});
+}
+
+void beamSearchArgs(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"Batch", "Beam", "Vocab"});
+    benchmark->ArgsProduct({{1, 8, 32}, {2, 4, 8}, kVocabSizes});
+}
+
+void gatherTreeArgs(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"Batch", "Beam", "SeqLen"});
+    benchmark->ArgsProduct({{1, 8, 32}, {1, 4, 8}, {512, 4096}});
+}
+
+} // namespace
+
+#define DECODING_BENCHMARK(name, call, args)                                                                           \
+    BENCHMARK_DEFINE_F(DecodingKernelsBenchmark, name)(benchmark::State & state)                                      \
+    {                                                                                                                  \
+        call;                                                                                                          \
+    }                                                                                                                  \
+    BENCHMARK_REGISTER_F(DecodingKernelsBenchmark, name)                                                               \
+        ->Apply(args)                                                                                                  \
+        ->UseManualTime()                                                                                              \
+        ->Unit(benchmark::kMicrosecond)
+
+DECODING_BENCHMARK(TopK_float, runTopK<float>(state), topKArgs);
+DECODING_BENCHMARK(TopK_half, runTopK<half>(state), topKArgs);
+DECODING_BENCHMARK(TopP_float, runTopP<float>(state, false), topPArgs);
+DECODING_BENCHMARK(TopP_half, runTopP<half>(state, false), topPArgs);
+DECODING_BENCHMARK(AirTopP_float, runTopP<float>(state, true), airTopPArgs);
+DECODING_BENCHMARK(AirTopP_half, runTopP<half>(state, true), airTopPArgs);
+DECODING_BENCHMARK(Penalty_float, runPenalty<float>(state), penaltyArgs);
+DECODING_BENCHMARK(Penalty_half, runPenalty<half>(state), penaltyArgs);
+DECODING_BENCHMARK(BanBadWords_float, runBanBadWords<float>(state), wordListArgs);
+DECODING_BENCHMARK(BanBadWords_half, runBanBadWords<half>(state), wordListArgs);
+DECODING_BENCHMARK(StopWords, runStopWords(state), wordListArgs);
+DECODING_BENCHMARK(BeamSearch_float, runBeamSearch<float>(state), beamSearchArgs);
+DECODING_BENCHMARK(BeamSearch_half, runBeamSearch<half>(state), beamSearchArgs);
+DECODING_BENCHMARK(GatherTree, runGatherTree(state), gatherTreeArgs);
+
+int main(int argc, char** argv)
+{
+    if (getDeviceCount() <= 0)
+    {
+        std::cerr << "No GPU found, skipping the decoding kernel benchmarks" << std::endl;
+        return 0;
+    }
+    streamPtr = std::make_shared<CudaStream>();
+    bufferManager = std::make_unique<BufferManager>(streamPtr);
+
+    int res = 0;
+    try
+    {
+        benchmark::Initialize(&argc, argv);
+        if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        {
+            res = -1;
+        }
+        else
+        {
+            benchmark::RunSpecifiedBenchmarks();
+            benchmark::Shutdown();
+        }
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "Exiting benchmarks with exception: " << e.what() << std::endl;
+        res = -3;
+    }
+
+    bufferManager.reset();
+    streamPtr.reset();
+    return res;
+}
@@ -12,6 +12,7 @@ template = '''{{
   "bias": 0,
   "act_fn": {act_fn},
   "norm_mode": {norm_mode},
+  "cuda_graph": {cuda_graph},
   {dtype_string}
   {routing_string}
   "tactic_id": {tactic_id}
@@ -27,7 +28,9 @@ def make_dtype_string(dtypes=None):
     return f'"dtypes": ["{join_term.join(dtypes)}"],'
 
 
-def make_routing_string(name=None, values=None):
+def make_routing_string(name=None, values=None, zipf_alpha=None):
+    if zipf_alpha is not None:
+        return f'"routing_zipf_alpha": {zipf_alpha},'
     if values is None and name is None:
         return ""
     if values is None:
@@ -59,34 +62,60 @@ routing_string = make_routing_string(
     name="balanced")  # Use the default uniform distribution
 tactic_id = '"auto"'
 
-configs = []
-for num_tokens in [1, 8, 64, 2048, 65536]:
-    configs.append(
-        populate_benchmark_config(
-            num_experts=num_experts,
-            k=k,
-            hidden_size=hidden_size,
-            inter_size=inter_size,
-            tp_size=tp_size,
-            ep_size=ep_size,
-            world_rank=world_rank,
-            num_tokens=num_tokens,
-            act_fn=act_fn,
-            norm_mode=norm_mode,
-            dtype_string=dtype_string,
-            routing_string=routing_string,
-            tactic_id=tactic_id,
-        ))
-
-full_string = "[\n" + ",\n".join(configs) + "\n]"
-
 parser = argparse.ArgumentParser()
 parser.add_argument('filename',
                     type=str,
                     help='The name of the file to generate',
                     nargs='?',
                     default="moe-benchmark-file.json")
+parser.add_argument(
+    '--suite',
+    action='store_true',
+    help='Sweep routing skew, TP vs EP layout, every dtype and CUDA graph vs '
+    'eager launch instead of only the token counts')
 args = parser.parse_args()
 
+routings = [routing_string]
+layouts = [(tp_size, ep_size)]
+dtype_strings = [dtype_string]
+cuda_graphs = [0]
+if args.suite:
+    routings = [
+        routing_string,
+        make_routing_string(zipf_alpha=1.0),
+        make_routing_string(zipf_alpha=2.0)
+    ]
+    layouts = [(4, 1), (1, 4)]
+    dtype_strings = [
+        make_dtype_string(d) for d in ["bfloat16", "half", "int8", "int4", "fp8"]
+    ]
+    cuda_graphs = [0, 1]
+
+configs = []
+for routing in routings:
+    for tp, ep in layouts:
+        for dtypes in dtype_strings:
+            for cuda_graph in cuda_graphs:
+                for num_tokens in [1, 8, 64, 2048, 65536]:
+                    configs.append(
+                        populate_benchmark_config(
+                            num_experts=num_experts,
+                            k=k,
+                            hidden_size=hidden_size,
+                            inter_size=inter_size,
+                            tp_size=tp,
+                            ep_size=ep,
+                            world_rank=world_rank,
+                            num_tokens=num_tokens,
+                            act_fn=act_fn,
+                            norm_mode=norm_mode,
+                            cuda_graph=cuda_graph,
+                            dtype_string=dtypes,
+                            routing_string=routing,
+                            tactic_id=tactic_id,
+                        ))
+
+full_string = "[\n" + ",\n".join(configs) + "\n]"
+
 with open(args.filename, "w+") as f:
     f.write(full_string)
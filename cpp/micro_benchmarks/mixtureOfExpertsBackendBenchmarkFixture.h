@@ -28,7 +28,9 @@
 #include "tensorrt_llm/runtime/cudaStream.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cuda.h>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <random>
@@ -103,6 +105,50 @@ struct VectoredRoutingConfig : public RoutingConfig
     }
 };
 
+// Skewed routing where the popularity of the expert with rank r is proportional to (r + 1)^-alpha
+struct ZipfRoutingConfig : public RoutingConfig
+{
+    double alpha;
+    std::string name;
+    uint64_t seed;
+
+    ZipfRoutingConfig(double alpha, std::string name, uint64_t seed = 0xD00D)
+        : alpha(alpha)
+        , name(name)
+        , seed(seed)
+    {
+    }
+
+    std::string getName() override
+    {
+        return name;
+    }
+
+    void setRouting(float* routing_output, int64_t num_experts, int64_t k, int64_t num_tokens) override
+    {
+        std::mt19937_64 gen(seed);
+        // Shuffle the popularity ranks so the hot experts do not all live on the first EP rank
+        std::vector<int64_t> rank(num_experts);
+        std::iota(rank.begin(), rank.end(), 0);
+        std::shuffle(rank.begin(), rank.end(), gen);
+
+        // Adding Gumbel noise to the log weights makes the top k a sample without replacement
+        std::uniform_real_distribution<double> uniform(std::numeric_limits<double>::min(), 1.0);
+        std::vector<float> logits(num_tokens * num_experts);
+        for (int64_t i = 0; i < num_tokens; i++)
+        {
+            for (int64_t e = 0; e < num_experts; e++)
+            {
+                double const gumbel = -std::log(-std::log(uniform(gen)));
+                logits[i * num_experts + e] = static_cast<float>(-alpha * std::log(rank[e] + 1.0) + gumbel);
+            }
+        }
+        check_cuda_error(cudaMemcpyAsync(routing_output, logits.data(), logits.size() * sizeof(float),
+            cudaMemcpyHostToDevice, streamPtr->get()));
+        check_cuda_error(cudaStreamSynchronize(streamPtr->get()));
+    }
+};
+
 }; // namespace
 
 constexpr int LOAD_BALANCED_ROUTING_CONFIG = 0;
@@ -223,6 +269,10 @@ public:
     int64_t mTotalTokens{};
 
     bool mUseBias = true;
+    bool mUseCudaGraph = false;
+
+    cudaGraph_t mGraph{};
+    cudaGraphExec_t mGraphInstance{};
 
     bool mIsGated = false;
     int mGatedMultiplier = 1;
@@ -312,7 +362,14 @@ public:
     float benchmarkLoop(MOEParallelismConfig parallelism_config)
     {
         check_cuda_error(cudaEventRecord(mStartEvent, streamPtr->get()));
-        runMoEPermute(parallelism_config);
+        if (mGraphInstance)
+        {
+            check_cuda_error(cudaGraphLaunch(mGraphInstance, streamPtr->get()));
+        }
+        else
+        {
+            runMoEPermute(parallelism_config);
+        }
         check_cuda_error(cudaEventRecord(mEndEvent, streamPtr->get()));
         check_cuda_error(cudaStreamSynchronize(streamPtr->get()));
 
@@ -396,6 +453,55 @@ public:
         return tactic_idx;
     }
 
+    // Captures the whole layer once the tactic is fixed, so the timed loop only measures the graph launch
+    void createGraph(MOEParallelismConfig parallelism_config)
+    {
+        if (!mUseCudaGraph)
+        {
+            return;
+        }
+        check_cuda_error(cudaStreamBeginCapture(streamPtr->get(), cudaStreamCaptureModeThreadLocal));
+        runMoEPermute(parallelism_config);
+        check_cuda_error(cudaStreamEndCapture(streamPtr->get(), &mGraph));
+        check_cuda_error(cudaGraphInstantiate(&mGraphInstance, mGraph, nullptr, nullptr, 0));
+    }
+
+    void destroyGraph()
+    {
+        if (mGraphInstance)
+        {
+            check_cuda_error(cudaGraphExecDestroy(mGraphInstance));
+            check_cuda_error(cudaGraphDestroy(mGraph));
+        }
+        mGraphInstance = nullptr;
+        mGraph = nullptr;
+    }
+
+    // Records how the routing spread the rows over the experts of this rank
+    void recordRoutingStats(benchmark::State& state, int64_t num_local_experts)
+    {
+        std::vector<int> selected(mTotalTokens * mK);
+        check_cuda_error(cudaMemcpyAsync(selected.data(), mSelectedExpert, selected.size() * sizeof(int),
+            cudaMemcpyDeviceToHost, streamPtr->get()));
+        check_cuda_error(cudaStreamSynchronize(streamPtr->get()));
+
+        std::vector<int64_t> rows(num_local_experts, 0);
+        for (int expert : selected)
+        {
+            if (expert >= 0 && expert < num_local_experts)
+            {
+                rows[expert]++;
+            }
+        }
+        int64_t const local_rows = std::accumulate(rows.begin(), rows.end(), int64_t{0});
+        int64_t const max_rows = *std::max_element(rows.begin(), rows.end());
+        state.counters["local_rows"] = local_rows;
+        state.counters["max_expert_rows"] = max_rows;
+        // Ratio of the most loaded expert to the mean, 1 for a perfectly balanced rank
+        state.counters["expert_imbalance"]
+            = local_rows > 0 ? static_cast<double>(max_rows) * num_local_experts / local_rows : 0.0;
+    }
+
     void runMoEPermute(MOEParallelismConfig parallelism_config)
     {
         auto stream = streamPtr->get();
@@ -424,6 +530,7 @@ void MixtureOfExpertsBenchmark<TypeTuple_>::runBenchmark(benchmark::State& state
     mNormMode = static_cast<MOEExpertScaleNormalizationMode>(state.range(10));
     int tactic_idx = state.range(11);
     int const routing_config = state.range(12);
+    mUseCudaGraph = state.range(13);
 
     state.counters["num_experts"] = num_experts;
     state.counters["top_k"] = top_k;
@@ -438,19 +545,20 @@ void MixtureOfExpertsBenchmark<TypeTuple_>::runBenchmark(benchmark::State& state
     state.counters["norm_mode"] = (int) mNormMode;
     state.counters["routing_config"] = (int) routing_config;
     state.counters["dtype"] = (int) toDTypeID();
+    state.counters["cuda_graph"] = (int) mUseCudaGraph;
 
     std::stringstream ss;
-    ss << "Experts,K,Hidden,Inter,TP,EP,Rank,Tokens,Bias,Actfn,Norm Mode,Tactic,Routing=";
+    ss << "Experts,K,Hidden,Inter,TP,EP,Rank,Tokens,Bias,Actfn,Norm Mode,Tactic,Graph,Routing=";
     for (auto v : {num_experts, top_k, hidden_size, inter_size, tp_size, ep_size, world_rank, num_tokens,
-             (int) mUseBias, (int) mActType, (int) mNormMode, tactic_idx})
+             (int) mUseBias, (int) mActType, (int) mNormMode, tactic_idx, (int) mUseCudaGraph})
     {
         ss << v << ",";
     }
     ss << routingConfigCache.at(routing_config)->getName();
     // state.SetLabel(ss.str());
 
-    // Always use EP size for moe config until we support TP+EP, we just divide the inter size for TP
-    MOEParallelismConfig parallelism_config = MOEParallelismConfig::ExpertParallelism(ep_size, world_rank / tp_size);
+    // The runner only uses the TP rank to add the FC2 bias once, the inter size is divided for TP here
+    MOEParallelismConfig parallelism_config{tp_size, world_rank % tp_size, ep_size, world_rank / tp_size};
     initBuffersPermute(num_tokens, hidden_size, inter_size / tp_size, num_experts, top_k, routing_config);
 
     // Parse the tactic, does checks for "auto" mode and out of range
@@ -468,6 +576,8 @@ void MixtureOfExpertsBenchmark<TypeTuple_>::runBenchmark(benchmark::State& state
     }
     state.counters["tactic_idx"] = tactic_idx;
 
+    createGraph(parallelism_config);
+
     for (auto _ : state)
     {
         float ms = benchmarkLoop(parallelism_config);
@@ -475,8 +585,10 @@ void MixtureOfExpertsBenchmark<TypeTuple_>::runBenchmark(benchmark::State& state
     }
 
     state.SetItemsProcessed(state.iterations() * num_tokens);
+    recordRoutingStats(state, num_experts / ep_size);
 
     // Cleanup all the benchmark state
+    destroyGraph();
     managed_buffers.clear();
     check_cuda_error(cudaDeviceSynchronize());
 }
@@ -240,6 +240,53 @@ void setNameCacheIdx(std::string const& name, int id)
     name_info_map.at(name).second = id;
 }
 
+// Loads captured router logits, a JSON array of [T * num_experts] floats or of T arrays of num_experts floats
+std::vector<float> loadRoutingTrace(std::string const& filename, int num_experts)
+{
+    std::ifstream file{filename};
+    if (!file)
+    {
+        throw std::invalid_argument("Could not open routing trace " + filename);
+    }
+    auto trace = nlohmann::json::parse(file);
+    std::vector<float> routing_values;
+    for (auto const& v : trace)
+    {
+        if (v.is_array())
+        {
+            if (v.size() != static_cast<size_t>(num_experts))
+            {
+                throw std::invalid_argument("Routing trace " + filename + " has a token with "
+                    + std::to_string(v.size()) + " logits, expected " + std::to_string(num_experts));
+            }
+            for (auto const& logit : v)
+                routing_values.push_back(logit.get<float>());
+        }
+        else
+        {
+            routing_values.push_back(v.get<float>());
+        }
+    }
+    if (routing_values.empty() || routing_values.size() % num_experts != 0)
+    {
+        throw std::invalid_argument("Routing trace " + filename + " must hold a multiple of num_experts values");
+    }
+    return routing_values;
+}
+
+int getZipfRoutingConfig(double alpha)
+{
+    std::string name = "zipf_" + nlohmann::json(alpha).dump();
+    int idx = getNameCacheIdx(name);
+    if (idx < 0)
+    {
+        routingConfigCache.push_back(std::make_shared<ZipfRoutingConfig>(alpha, name));
+        idx = routingConfigCache.size() - 1;
+        name_info_map.emplace(name, std::pair{-1, idx});
+    }
+    return idx;
+}
+
 // This is suboptimal for large benchmark files as we reread it for every data type
 template <class BenchClass>
 void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
@@ -264,6 +311,9 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
      *     "dtypes": [string, ...], (optional)
      *     "routing_values_name": string, (optional)
      *     "routing_values": [float, ...], or string, (optional, length is a multiple of num_experts)
+     *     "routing_values_file": string, (optional)
+     *     "routing_zipf_alpha": float, (optional)
+     *     "cuda_graph": int, (optional)
      *   },
      *   ...
      * ]
@@ -315,6 +365,11 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
      * When defining an array, it must have `T*num_experts` floating point values. Each set of
      * `num_experts` values defines the input for a single token. If `num_tokens` is greater than `T` it will repeat
      * from the beginning
+     * - "routing_values_file" - a JSON file holding routing values captured from a real model, either a flat array as
+     * for "routing_values" or an array of per token arrays. Can be named with "routing_values_name" like an array
+     * - "routing_zipf_alpha" - skewed routing where expert popularity follows a Zipf distribution with this exponent.
+     * Ignored if "routing_values" or "routing_values_file" is set
+     * - "cuda_graph" - 1 to capture the layer in a CUDA graph and time the graph launch, 0 (default) for eager launches
      *
      */
 
@@ -335,10 +390,12 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
 
         // WARNING: Process the routing configuration immediately, so we can guarantee all configs get processed for all
         // data types. We should not skip any test cases as a later test config may depend on this config
+        bool const has_routing_values
+            = run_config.contains("routing_values") || run_config.contains("routing_values_file");
         if (run_config.contains("routing_values_name"))
         {
             run_config["routing_values_name"].get_to(config_name);
-            if (!run_config.contains("routing_values"))
+            if (!has_routing_values)
             {
                 throw std::invalid_argument("Setting routing value configuration name but missing routing values");
             }
@@ -361,9 +418,9 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
 
         int num_experts = run_config.at("num_experts").get<int>();
 
-        if (run_config.contains("routing_values") && !routing_config)
+        if (has_routing_values && !routing_config)
         {
-            if (run_config["routing_values"].is_string())
+            if (run_config.contains("routing_values") && run_config["routing_values"].is_string())
             {
                 routing_config = getNameCacheIdx(run_config["routing_values"].get<std::string>());
                 if (routing_config < 0)
@@ -378,7 +435,11 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
                     throw std::invalid_argument("Explicit routing configurations must specify a name");
                 }
                 std::vector<float> routing_values;
-                run_config["routing_values"].get_to(routing_values);
+                if (run_config.contains("routing_values_file"))
+                    routing_values
+                        = loadRoutingTrace(run_config["routing_values_file"].get<std::string>(), num_experts);
+                else
+                    run_config["routing_values"].get_to(routing_values);
 
                 int shape = routing_values.size() / num_experts;
                 routingConfigCache.push_back(std::make_shared<VectoredRoutingConfig>(
@@ -388,7 +449,10 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
 
             auto conf = routingConfigCache[*routing_config];
             auto conf_vec = std::dynamic_pointer_cast<VectoredRoutingConfig>(conf);
-            if (conf->getName() != "balanced" && (!conf_vec || conf_vec->shape.second != num_experts))
+            // Balanced and Zipf routing are generated for any number of experts
+            bool const is_generated
+                = conf->getName() == "balanced" || std::dynamic_pointer_cast<ZipfRoutingConfig>(conf) != nullptr;
+            if (!is_generated && (!conf_vec || conf_vec->shape.second != num_experts))
             {
                 throw std::invalid_argument("Incompatible config selected. Expected " + std::to_string(num_experts)
                     + " experts in routing configuration. "
@@ -396,6 +460,10 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
                                   : "Found incompatible routing config type"));
             }
         }
+        else if (run_config.contains("routing_zipf_alpha") && !routing_config)
+        {
+            routing_config = getZipfRoutingConfig(run_config["routing_zipf_alpha"].get<double>());
+        }
         // Use the selected config or fall back to balanced
         routing_config = routing_config.value_or(LOAD_BALANCED_ROUTING_CONFIG);
         setNameCacheIdx(config_name, *routing_config);
@@ -462,6 +530,7 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
         int ep_size = get_or("ep_size", 1);
         int world_rank = get_or("world_rank", 0);
         int bias = get_or("bias", 0);
+        int cuda_graph = get_or("cuda_graph", 0);
 
         for (auto tactic_id : tactic_ids)
         {
@@ -475,7 +544,8 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
                 run_config.at("act_fn").get<int>(),      //
                 run_config.at("norm_mode").get<int>(),   //
                 tactic_id,                               //
-                *routing_config});
+                *routing_config,                         //
+                cuda_graph});
         }
     }
 }
@@ -503,7 +573,8 @@ void argGenHardcoded(benchmark::internal::Benchmark* benchmark)
                     (int) tensorrt_llm::ActivationType::Gelu,           // Act fn
                     (int) MOEExpertScaleNormalizationMode::RENORMALIZE, // Norm mode
                     i, // Tactic ID. Index into getTactics() function result, see argGenLoadFile() for examples
-                    LOAD_BALANCED_ROUTING_CONFIG // Routing configuration id
+                    LOAD_BALANCED_ROUTING_CONFIG, // Routing configuration id
+                    0                             // CUDA graph
                 });
 
                 benchmark->Args({
@@ -519,7 +590,8 @@ void argGenHardcoded(benchmark::internal::Benchmark* benchmark)
                     (int) tensorrt_llm::ActivationType::Swiglu,         // Act fn
                     (int) MOEExpertScaleNormalizationMode::RENORMALIZE, // Norm mode
                     i, // Tactic ID. Index into getTactics() function result, see argGenLoadFile() for examples
-                    LOAD_BALANCED_ROUTING_CONFIG // Routing configuration id
+                    LOAD_BALANCED_ROUTING_CONFIG, // Routing configuration id
+                    0                             // CUDA graph
                 });
             }
         }
@@ -554,7 +626,7 @@ void argGenHardcoded(benchmark::internal::Benchmark* benchmark)
                                         for (auto tactic : cutlass_tactic)
                                             for (auto routing : routing_config)
                                                 benchmark->Args({num_expert, k, size, inter_size, 1, 1, 0, tokens, bias,
-                                                    (int) act, (int) norm, tactic, routing});
+                                                    (int) act, (int) norm, tactic, routing, 0});
                     }
 }
 
@@ -577,7 +649,7 @@ void argGen(benchmark::internal::Benchmark* benchmark)
     // Generic setup
     benchmark->UseManualTime();
     benchmark->ArgNames({"Num Experts", "K", "Hidden Size", "Inter Size", "TP Size", "EP Size", "World Rank",
-        "Num Tokens", "Use Bias", "Activation Function", "Norm Mode", "Tactic ID", "Routing ID"});
+        "Num Tokens", "Use Bias", "Activation Function", "Norm Mode", "Tactic ID", "Routing ID", "CUDA Graph"});
 
     if (workloadFile)
         argGenLoadFile<BenchClass>(benchmark);
@@ -625,6 +697,8 @@ void doCleanup()
 void help()
 {
     std::cout << "Usage: mixtureOfExpertsBackendBenchmark [--input_file <file>] [benchmark options]\n";
+    std::cout << "Use --benchmark_out=<file> --benchmark_out_format=json to save results for "
+                 "compare-moe-benchmark-results.py\n";
     std::cout
         << "--input_file\t\tA JSON file describing the benchmark configurations\n\n"
         << "File schema\n"
@@ -645,6 +719,9 @@ void help()
            "    \"dtypes\": [string, ...], (optional)\n"
            "    \"routing_values_name\": string, (optional)\n"
            "    \"routing_values\": [float, ...], or string, (optional, length is a multiple of num_experts)\n"
+           "    \"routing_values_file\": string, (optional)\n"
+           "    \"routing_zipf_alpha\": float, (optional)\n"
+           "    \"cuda_graph\": int, (optional)\n"
            "  },\n"
            "  ...\n"
            "]\n"
@@ -692,7 +769,13 @@ void help()
            "different routing behaviours.\n"
            "When defining an array, it must have `T*num_experts` floating point values. Each set of\n"
            "`num_experts` values defines the input for a single token. If `num_tokens` is greater than `T` it will "
-           "repeat from the beginning\n\n";
+           "repeat from the beginning\n"
+           "- \"routing_values_file\" - a JSON file holding routing values captured from a real model, either a flat "
+           "array as for \"routing_values\" or an array of per token arrays\n"
+           "- \"routing_zipf_alpha\" - skewed routing where expert popularity follows a Zipf distribution with this "
+           "exponent\n"
+           "- \"cuda_graph\" - 1 to capture the layer in a CUDA graph and time the graph launch, 0 (default) for eager "
+           "launches\n\n";
 
     std::cout << "benchmark options:\n";
     benchmark::PrintDefaultHelp();
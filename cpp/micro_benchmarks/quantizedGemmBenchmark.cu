@@ -0,0 +1,633 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/quantization.h"
+#include "tensorrt_llm/kernels/cutlass_kernels/fpA_intB_gemm/fpA_intB_gemm.h"
+#include "tensorrt_llm/kernels/cutlass_kernels/fused_gated_gemm/fused_gated_gemm.h"
+#include "tensorrt_llm/kernels/cutlass_kernels/int8_gemm/int8_gemm.h"
+#include "tensorrt_llm/kernels/weightOnlyBatchedGemv/kernelLauncher.h"
+#include "tensorrt_llm/plugins/api/tllmPlugin.h"
+#include "tensorrt_llm/plugins/gemmSwigluPlugin/gemmSwigluPlugin.h"
+#include "tensorrt_llm/plugins/smoothQuantGemmPlugin/smoothQuantGemmPlugin.h"
+#include "tensorrt_llm/plugins/weightOnlyQuantMatmulPlugin/weightOnlyQuantMatmulPlugin.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/gptJsonConfig.h"
+#include "tensorrt_llm/runtime/tllmLogger.h"
+#include "tensorrt_llm/runtime/utils/sessionUtils.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <NvInferRuntime.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+using namespace tensorrt_llm::plugins;
+using namespace tensorrt_llm::kernels::cutlass_kernels;
+
+using Config = tensorrt_llm::cutlass_extensions::CutlassGemmConfig;
+
+static BufferManager::CudaStreamPtr streamPtr;
+static std::unique_ptr<BufferManager> bufferManager;
+
+namespace
+{
+
+//! \brief The quantized GEMMs of the plugins, with the names of the --gemm option.
+enum class QuantizedGemmType
+{
+    kWEIGHT_ONLY_INT8,
+    kWEIGHT_ONLY_INT4,
+    kSMOOTH_QUANT,
+    kFP8,
+};
+
+std::map<std::string, QuantizedGemmType> const kGemmTypeNames{
+    {"weight_only_int8", QuantizedGemmType::kWEIGHT_ONLY_INT8},
+    {"weight_only_int4", QuantizedGemmType::kWEIGHT_ONLY_INT4},
+    {"smooth_quant", QuantizedGemmType::kSMOOTH_QUANT},
+    {"fp8", QuantizedGemmType::kFP8},
+};
+
+std::string toString(QuantizedGemmType type)
+{
+    for (auto const& [name, gemmType] : kGemmTypeNames)
+    {
+        if (gemmType == type)
+        {
+            return name;
+        }
+    }
+    return "unknown";
+}
+
+std::string toString(Config const& tactic)
+{
+    std::ostringstream os;
+    os << tactic;
+    return os.str();
+}
+
+//! \brief A GEMM of the layers of the engine, on one rank.
+struct GemmShape
+{
+    std::string name;
+    int n;
+    int k;
+};
+
+//! \brief The tactics of a GEMM, as a plugin profiler sees them, and how to run them.
+class QuantizedGemm
+{
+public:
+    virtual ~QuantizedGemm() = default;
+
+    //! \brief Sizes the workspace for all M up to maxM and fills it.
+    virtual void prepare(int maxM, cudaStream_t stream) = 0;
+
+    [[nodiscard]] virtual std::vector<Config> getTactics(int m) const = 0;
+
+    virtual void run(int m, Config const& tactic, cudaStream_t stream) = 0;
+
+    //! \brief The tactic serialized into the engine for m, if the engine was deserialized and has this GEMM.
+    [[nodiscard]] virtual std::optional<Config> getEngineTactic(int m) const = 0;
+
+    //! \brief Bytes moved by the GEMM, i.e. the quantized weights, the activations and the output.
+    [[nodiscard]] virtual double getBytes(int m) const = 0;
+
+    //! \brief N and K of the logical GEMM, for the FLOPs.
+    [[nodiscard]] virtual std::pair<int, int> getLogicalNK() const = 0;
+};
+
+//! \brief Exposes the tactics of a plugin profiler, so that each of them can be timed on its own.
+template <typename Profiler>
+class TacticsProfiler : public Profiler
+{
+public:
+    using Profiler::checkTactic;
+    using Profiler::computeTmpSize;
+    using Profiler::getTactics;
+    using Profiler::initTmpData;
+    using Profiler::runTactic;
+
+    template <typename RunnerPtr>
+    void setRunner(RunnerPtr runner, nvinfer1::DataType type)
+    {
+        this->mRunner = std::move(runner);
+        this->mType = type;
+    }
+};
+
+template <typename Profiler>
+class ProfiledQuantizedGemm : public QuantizedGemm
+{
+public:
+    //! \param shape The N and K of the GEMM ID of the plugin, e.g. N is packed for INT4 weights.
+    ProfiledQuantizedGemm(std::shared_ptr<TacticsProfiler<Profiler>> profiler, GemmShape shape,
+        nvinfer1::DataType idType, double weightBytesPerElement, double activationBytesPerElement,
+        std::pair<int, int> logicalNK)
+        : mProfiler{std::move(profiler)}
+        , mShape{std::move(shape)}
+        , mWeightBytesPerElement{weightBytesPerElement}
+        , mActivationBytesPerElement{activationBytesPerElement}
+        , mLogicalNK{logicalNK}
+        , mEngineTactics{Profiler::getDeserializedTactics(typeid(Profiler), GemmIdCore(mShape.n, mShape.k, idType))}
+    {
+    }
+
+    void prepare(int maxM, cudaStream_t stream) override
+    {
+        mProfiler->computeTmpSize(maxM, mShape.n, mShape.k);
+        auto const size = mProfiler->getTmpWorkspaceSizeInBytes();
+        mWorkspace = bufferManager->gpu(size);
+        bufferManager->setZero(*mWorkspace);
+        mProfiler->initTmpData(maxM, mShape.n, mShape.k, static_cast<char*>(mWorkspace->data()), size, stream);
+    }
+
+    [[nodiscard]] std::vector<Config> getTactics(int m) const override
+    {
+        auto tactics = mProfiler->getTactics(m, mShape.n, mShape.k);
+        tactics.erase(std::remove_if(tactics.begin(), tactics.end(),
+                          [&](Config const& tactic) { return !mProfiler->checkTactic(m, mShape.n, mShape.k, tactic); }),
+            tactics.end());
+        return tactics;
+    }
+
+    void run(int m, Config const& tactic, cudaStream_t stream) override
+    {
+        mProfiler->runTactic(m, mShape.n, mShape.k, tactic, static_cast<char*>(mWorkspace->data()), stream);
+    }
+
+    [[nodiscard]] std::optional<Config> getEngineTactic(int m) const override
+    {
+        auto const iter = mEngineTactics.find(std::min(m, mProfiler->getMaxProfileM()));
+        return iter != mEngineTactics.end() ? iter->second : std::nullopt;
+    }
+
+    [[nodiscard]] double getBytes(int m) const override
+    {
+        auto const [n, k] = mLogicalNK;
+        return static_cast<double>(n) * k * mWeightBytesPerElement
+            + static_cast<double>(m) * (k + n) * mActivationBytesPerElement;
+    }
+
+    [[nodiscard]] std::pair<int, int> getLogicalNK() const override
+    {
+        return mLogicalNK;
+    }
+
+private:
+    std::shared_ptr<TacticsProfiler<Profiler>> mProfiler;
+    GemmShape mShape;
+    double mWeightBytesPerElement;
+    double mActivationBytesPerElement;
+    std::pair<int, int> mLogicalNK;
+    typename Profiler::MProfileMap mEngineTactics;
+    IBuffer::SharedPtr mWorkspace;
+};
+
+std::unique_ptr<QuantizedGemm> createWeightOnlyGemm(
+    GemmShape const& shape, nvinfer1::DataType type, WeightTypeId weightTypeId)
+{
+    using namespace tensorrt_llm::kernels;
+    auto const arch = getSMVersion();
+    auto const isInt8 = weightTypeId == WeightTypeId::INT8;
+    WeightOnlyGemmRunnerPtr runner;
+    weight_only::KernelType kernelType;
+    if (type == nvinfer1::DataType::kHALF)
+    {
+        runner = isInt8 ? WeightOnlyGemmRunnerPtr{std::make_shared<CutlassFpAIntBGemmRunner<half, uint8_t,
+                              cutlass::WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY>>()}
+                        : std::make_shared<CutlassFpAIntBGemmRunner<half, cutlass::uint4b_t,
+                            cutlass::WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY>>();
+        kernelType = isInt8 ? weight_only::KernelType::FP16Int8PerChannel : weight_only::KernelType::FP16Int4PerChannel;
+    }
+#if defined(ENABLE_BF16)
+    else if (type == nvinfer1::DataType::kBF16)
+    {
+        runner = isInt8 ? WeightOnlyGemmRunnerPtr{std::make_shared<CutlassFpAIntBGemmRunner<__nv_bfloat16, uint8_t,
+                              cutlass::WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY>>()}
+                        : std::make_shared<CutlassFpAIntBGemmRunner<__nv_bfloat16, cutlass::uint4b_t,
+                            cutlass::WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY>>();
+        kernelType = isInt8 ? weight_only::KernelType::BF16Int8PerChannel : weight_only::KernelType::BF16Int4PerChannel;
+    }
+#endif
+    else
+    {
+        TLLM_THROW("Weight-only GEMMs need half or bfloat16 activations");
+    }
+
+    auto profiler = std::make_shared<TacticsProfiler<WeightOnlyQuantGemmPluginProfiler>>();
+    profiler->setRunner(std::move(runner), type);
+    profiler->setWeightTypeId(weightTypeId);
+    // The batched GEMV kernels are tactics of the plugin if they support the arch, as in the plugin
+    if (weight_only::is_supported(arch, kernelType))
+    {
+        profiler->setCudaKernelType(kernelType, arch);
+    }
+    auto const multiplier = getWeightTypeMultiplier(weightTypeId);
+    auto const packedShape = GemmShape{shape.name, shape.n / multiplier, shape.k};
+    return std::make_unique<ProfiledQuantizedGemm<WeightOnlyQuantGemmPluginProfiler>>(std::move(profiler),
+        packedShape, type, 1.0 / multiplier, BufferDataType(type).getSize(), std::make_pair(shape.n, shape.k));
+}
+
+std::unique_ptr<QuantizedGemm> createSmoothQuantGemm(
+    GemmShape const& shape, nvinfer1::DataType type, QuantMode quantMode)
+{
+    SqGemmRunnerPtr runner;
+    if (type == nvinfer1::DataType::kHALF)
+    {
+        runner = std::make_shared<CutlassInt8GemmRunner<half>>();
+    }
+    else if (type == nvinfer1::DataType::kFLOAT)
+    {
+        runner = std::make_shared<CutlassInt8GemmRunner<float>>();
+    }
+#ifdef ENABLE_BF16
+    else if (type == nvinfer1::DataType::kBF16)
+    {
+        runner = std::make_shared<CutlassInt8GemmRunner<__nv_bfloat16>>();
+    }
+#endif
+    else
+    {
+        TLLM_THROW("SmoothQuant GEMMs need half, float or bfloat16 outputs");
+    }
+
+    auto profiler = std::make_shared<TacticsProfiler<SmoothQuantGemmPluginProfiler>>();
+    profiler->setRunner(std::move(runner), type);
+    profiler->setQuantMode(quantMode);
+    return std::make_unique<ProfiledQuantizedGemm<SmoothQuantGemmPluginProfiler>>(
+        std::move(profiler), shape, type, 1.0, 1.0, std::make_pair(shape.n, shape.k));
+}
+
+std::unique_ptr<QuantizedGemm> createFp8Gemm(GemmShape const& shape, QuantMode quantMode)
+{
+#ifdef ENABLE_FP8
+    auto profiler = std::make_shared<TacticsProfiler<GemmSwigluPluginProfiler>>();
+    profiler->setRunner(std::make_shared<CutlassFusedGatedGemmRunner<__nv_fp8_e4m3>>(), nvinfer1::DataType::kFP8);
+    profiler->setQuantMode(quantMode);
+    // The gate and the up projections are one GEMM of twice the width, which outputs half of it
+    return std::make_unique<ProfiledQuantizedGemm<GemmSwigluPluginProfiler>>(
+        std::move(profiler), shape, nvinfer1::DataType::kFP8, 1.0, 1.0, std::make_pair(shape.n, shape.k));
+#else
+    TLLM_THROW("FP8 GEMMs need a build with ENABLE_FP8");
+#endif
+}
+
+//! \brief The GEMMs of a layer of the engine on one rank.
+std::vector<GemmShape> getLayerGemms(ModelConfig const& modelConfig, SizeType32 tensorParallelism, bool fusedGatedMlp)
+{
+    auto const hidden = modelConfig.getHiddenSize() * tensorParallelism;
+    auto const sizePerHead = modelConfig.getSizePerHead();
+    auto const attentionWidth = modelConfig.getNbHeads() * sizePerHead;
+    auto const qkvWidth = (modelConfig.getNbHeads() + 2 * modelConfig.getNbKvHeads()) * sizePerHead;
+    auto const mlpHidden = modelConfig.getMlpHiddenSize();
+    if (fusedGatedMlp)
+    {
+        return {{"gate_up", 2 * mlpHidden, hidden}};
+    }
+    return {{"qkv", qkvWidth, hidden}, {"dense", hidden, attentionWidth}, {"fc", mlpHidden, hidden},
+        {"proj", hidden, mlpHidden}};
+}
+
+QuantizedGemmType getGemmType(QuantMode const& quantMode)
+{
+    if (quantMode.hasFp8Qdq())
+    {
+        return QuantizedGemmType::kFP8;
+    }
+    if (quantMode.hasActivations())
+    {
+        return QuantizedGemmType::kSMOOTH_QUANT;
+    }
+    if (quantMode.hasInt4Weights())
+    {
+        return QuantizedGemmType::kWEIGHT_ONLY_INT4;
+    }
+    if (quantMode.hasInt8Weights())
+    {
+        return QuantizedGemmType::kWEIGHT_ONLY_INT8;
+    }
+    TLLM_THROW("The engine doesn't use a quantized GEMM, pick one with --gemm");
+}
+
+//! \brief Deserializes the engine of rank 0 with the plugins, so that their profilers read the tactics of the engine.
+bool loadEngineTactics(std::filesystem::path const& engineDir, GptJsonConfig const& jsonConfig)
+{
+    auto const worldConfig
+        = WorldConfig(jsonConfig.getTensorParallelism(), jsonConfig.getPipelineParallelism(), /*rank*/ 0);
+    auto const enginePath = engineDir / jsonConfig.engineFilename(worldConfig);
+    if (!std::filesystem::exists(enginePath))
+    {
+        std::cerr << "No engine " << enginePath << ", the tactics of the engine are not compared\n";
+        return false;
+    }
+
+    TllmLogger logger{};
+    initTrtLlmPlugins(&logger);
+    auto const engineBuffer = utils::loadEngine(enginePath.string());
+    std::unique_ptr<nvinfer1::IRuntime> runtime{nvinfer1::createInferRuntime(logger)};
+    std::unique_ptr<nvinfer1::ICudaEngine> engine{
+        runtime->deserializeCudaEngine(engineBuffer.data(), engineBuffer.size())};
+    TLLM_CHECK_WITH_INFO(engine != nullptr, "Failed to deserialize the engine %s", enginePath.c_str());
+    return true;
+}
+
+struct TacticResult
+{
+    std::string tactic;
+    double meanUs;
+    bool isEngineTactic;
+};
+
+// Mean time of each tactic by GEMM and M, for the summary
+std::map<std::pair<std::string, int>, std::vector<TacticResult>> tacticResults;
+
+void benchmarkTactic(benchmark::State& state, std::shared_ptr<QuantizedGemm> const& gemm, std::string const& gemmName,
+    int m, Config const& tactic, bool isEngineTactic)
+{
+    auto stream = streamPtr->get();
+    cudaEvent_t start;
+    cudaEvent_t stop;
+    TLLM_CUDA_CHECK(cudaEventCreate(&start));
+    TLLM_CUDA_CHECK(cudaEventCreate(&stop));
+
+    double totalMs = 0;
+    try
+    {
+        // The warmup also checks that the tactic runs for this shape
+        gemm->run(m, tactic, stream);
+        sync_check_cuda_error(stream);
+        for (auto _ : state)
+        {
+            TLLM_CUDA_CHECK(cudaEventRecord(start, stream));
+            gemm->run(m, tactic, stream);
+            TLLM_CUDA_CHECK(cudaEventRecord(stop, stream));
+            TLLM_CUDA_CHECK(cudaEventSynchronize(stop));
+            float ms{};
+            TLLM_CUDA_CHECK(cudaEventElapsedTime(&ms, start, stop));
+            state.SetIterationTime(ms / 1000.f);
+            totalMs += ms;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        state.SkipWithError(e.what());
+    }
+    TLLM_CUDA_CHECK(cudaEventDestroy(start));
+    TLLM_CUDA_CHECK(cudaEventDestroy(stop));
+    if (state.error_occurred() || state.iterations() == 0)
+    {
+        return;
+    }
+
+    auto const [n, k] = gemm->getLogicalNK();
+    auto const iterations = static_cast<double>(state.iterations());
+    state.counters["bytes_per_second"]
+        = benchmark::Counter(gemm->getBytes(m) * iterations, benchmark::Counter::kIsRate);
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * m * n * k * iterations, benchmark::Counter::kIsRate);
+    state.SetLabel(toString(tactic) + (isEngineTactic ? " engine" : ""));
+
+    // google-benchmark calls the function again with more iterations, the last call is the one that counts
+    auto& results = tacticResults[{gemmName, m}];
+    auto const tacticName = toString(tactic);
+    results.erase(std::remove_if(results.begin(), results.end(),
+                      [&](TacticResult const& result) { return result.tactic == tacticName; }),
+        results.end());
+    results.push_back({tacticName, totalMs * 1000.0 / iterations, isEngineTactic});
+}
+
+void printSummary()
+{
+    std::cout << "\nTactics of the engine vs the best tactic:\n";
+    for (auto const& [key, results] : tacticResults)
+    {
+        auto const& [gemmName, m] = key;
+        auto const best = std::min_element(results.begin(), results.end(),
+            [](TacticResult const& a, TacticResult const& b) { return a.meanUs < b.meanUs; });
+        auto const engine = std::find_if(
+            results.begin(), results.end(), [](TacticResult const& result) { return result.isEngineTactic; });
+        std::cout << gemmName << " m=" << m << ": best " << std::fixed << std::setprecision(2) << best->meanUs
+                  << " us (" << best->tactic << ")";
+        if (engine != results.end())
+        {
+            std::cout << ", engine " << engine->meanUs << " us, " << (engine->meanUs / best->meanUs - 1.0) * 100.0
+                      << "% slower";
+        }
+        else
+        {
+            std::cout << ", no engine tactic";
+        }
+        std::cout << "\n";
+    }
+}
+
+std::filesystem::path engineDir;
+std::optional<QuantizedGemmType> gemmTypeOverride;
+int maxM = 8192;
+
+void registerBenchmarks()
+{
+    auto const jsonConfig = GptJsonConfig::parse(engineDir / "config.json");
+    auto const& modelConfig = jsonConfig.getModelConfig();
+    auto const quantMode = modelConfig.getQuantMode();
+    auto const gemmType = gemmTypeOverride.value_or(getGemmType(quantMode));
+    loadEngineTactics(engineDir, jsonConfig);
+
+    auto const type = modelConfig.getDataType();
+    auto const shapes
+        = getLayerGemms(modelConfig, jsonConfig.getTensorParallelism(), gemmType == QuantizedGemmType::kFP8);
+    for (auto const& shape : shapes)
+    {
+        std::shared_ptr<QuantizedGemm> gemm;
+        switch (gemmType)
+        {
+        case QuantizedGemmType::kWEIGHT_ONLY_INT8: gemm = createWeightOnlyGemm(shape, type, WeightTypeId::INT8); break;
+        case QuantizedGemmType::kWEIGHT_ONLY_INT4: gemm = createWeightOnlyGemm(shape, type, WeightTypeId::INT4); break;
+        case QuantizedGemmType::kSMOOTH_QUANT: gemm = createSmoothQuantGemm(shape, type, quantMode); break;
+        case QuantizedGemmType::kFP8: gemm = createFp8Gemm(shape, quantMode); break;
+        }
+        gemm->prepare(maxM, streamPtr->get());
+
+        auto const gemmName = toString(gemmType) + "/" + shape.name;
+        for (int m = 1; m <= maxM; m *= 2)
+        {
+            auto const engineTactic = gemm->getEngineTactic(m);
+            auto const engineTacticName = engineTactic ? std::make_optional(toString(*engineTactic)) : std::nullopt;
+            auto const tactics = gemm->getTactics(m);
+            for (std::size_t i = 0; i < tactics.size(); ++i)
+            {
+                auto const& tactic = tactics[i];
+                auto const isEngineTactic = engineTacticName == toString(tactic);
+                auto const name = gemmName + "/m:" + std::to_string(m) + "/tactic:" + std::to_string(i);
+                benchmark::RegisterBenchmark(name.c_str(),
+                    [=](benchmark::State& state) { benchmarkTactic(state, gemm, gemmName, m, tactic, isEngineTactic); })
+                    ->UseManualTime()
+                    ->Unit(benchmark::kMicrosecond);
+            }
+        }
+    }
+}
+
+void doCleanup()
+{
+    tacticResults.clear();
+    bufferManager.reset();
+    streamPtr.reset();
+}
+
+void help()
+{
+    std::cout << "Usage: quantizedGemmBenchmark --engine_dir <dir> [--gemm <type>] [--max_m <m>] [benchmark options]\n"
+              << "--engine_dir\t\tThe directory of the engine, the GEMMs are the ones of its config.json\n"
+              << "--gemm\t\t\tThe quantized GEMM, one of weight_only_int8, weight_only_int4, smooth_quant and fp8.\n"
+              << "\t\t\tDefaults to the one of the quantization of the engine\n"
+              << "--max_m\t\t\tThe largest M, the benchmarks sweep the powers of two up to it. Defaults to 8192\n\n"
+              << "Every tactic of the plugin profiler is timed for every GEMM of the layer and M. If the engine of\n"
+              << "rank 0 is in the directory, the tactic it selected is labelled \"engine\" and compared to the best\n"
+              << "tactic at the end.\n\n";
+
+    std::cout << "benchmark options:\n";
+    benchmark::PrintDefaultHelp();
+}
+
+void gbenchCustomHelp()
+{
+    help();
+    // google-benchmark calls exit() so we need to cleanup manually
+    doCleanup();
+}
+
+int parseArgsAndRunBench(int argc, char** argv)
+{
+    try
+    {
+        int shift = 0;
+        for (int i = 1; i < argc; i++)
+        {
+            argv[i - shift] = argv[i];
+            auto const isOption = [&](char const* option) { return strcmp(option, argv[i]) == 0; };
+            if (isOption("--engine_dir") || isOption("--gemm") || isOption("--max_m"))
+            {
+                std::string const option = argv[i];
+                i += 1;
+                if (i == argc)
+                {
+                    std::cerr << "Missing value for " << option << "\n";
+                    return -1;
+                }
+                if (option == "--engine_dir")
+                {
+                    engineDir = argv[i];
+                }
+                else if (option == "--gemm")
+                {
+                    auto const iter = kGemmTypeNames.find(argv[i]);
+                    if (iter == kGemmTypeNames.end())
+                    {
+                        std::cerr << "Unknown GEMM " << argv[i] << "\n";
+                        return -2;
+                    }
+                    gemmTypeOverride = iter->second;
+                }
+                else
+                {
+                    maxM = std::stoi(argv[i]);
+                }
+                shift += 2;
+            }
+            else if (isOption("--help") || isOption("-h"))
+            {
+                help();
+                return 0;
+            }
+        }
+        argc -= shift;
+
+        if (engineDir.empty())
+        {
+            help();
+            std::cerr << "\nMissing --engine_dir" << std::endl;
+            return -2;
+        }
+
+        registerBenchmarks();
+
+        benchmark::Initialize(&argc, argv, &gbenchCustomHelp);
+
+        if (argc > 1)
+        {
+            help();
+            std::cout << std::flush; // Force flush
+            // Print the error second, so it's easy to see
+            std::cerr << "\nUnrecognised argument: " << argv[1] << std::endl;
+            return -4;
+        }
+
+        benchmark::RunSpecifiedBenchmarks();
+        benchmark::Shutdown();
+        printSummary();
+
+        return 0;
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "Exiting benchmarks with exception: " << e.what() << std::endl;
+        return -3;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (getDeviceCount() <= 0)
+    {
+        return 0;
+    }
+    streamPtr = std::make_shared<CudaStream>();
+    bufferManager = std::make_unique<BufferManager>(streamPtr);
+
+    int res = -1;
+    try
+    {
+        res = parseArgsAndRunBench(argc, argv);
+    }
+    catch (std::exception const& e)
+    {
+        std::cout << "Benchmark exited with unhandled exception: " << e.what() << std::endl;
+    }
+
+    doCleanup();
+    return res;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/asyncLogWriter.h"
+
+#include "tensorrt_llm/common/stringUtils.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace tensorrt_llm::common
+{
+
+namespace
+{
+//! How long the writer sleeps when there's nothing to write, the producers don't wake it up
+auto constexpr kPOLL_INTERVAL = std::chrono::milliseconds{2};
+//! Records of one write at most, so that a flood of records is still flushed regularly
+std::size_t constexpr kMAX_BATCH = 4096;
+} // namespace
+
+AsyncLogWriter& AsyncLogWriter::getInstance()
+{
+    // Never destroyed, the loggers of static destructors may still write after exit started. Stopped at exit instead,
+    // the later records are written synchronously.
+    static auto* writer = []()
+    {
+        auto* instance = new AsyncLogWriter();
+        std::atexit([]() { getInstance().stop(); });
+        return instance;
+    }();
+    return *writer;
+}
+
+AsyncLogWriter::AsyncLogWriter()
+    : mWriter{[this]() { writerLoop(); }}
+{
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    stop();
+}
+
+void AsyncLogWriter::write(std::string record, bool toStderr)
+{
+    if (mStopped.load(std::memory_order_acquire))
+    {
+        (toStderr ? std::cerr : std::cout) << record << std::flush;
+        return;
+    }
+    if (mRecords.size() >= kMAX_PENDING)
+    {
+        mNumDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    mNumQueued.fetch_add(1, std::memory_order_relaxed);
+    mRecords.push(Record{std::move(record), toStderr});
+}
+
+void AsyncLogWriter::flush()
+{
+    auto const numQueued = mNumQueued.load(std::memory_order_relaxed);
+    while (!mStopped.load(std::memory_order_acquire) && mNumWritten.load(std::memory_order_acquire) < numQueued)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void AsyncLogWriter::stop()
+{
+    if (mStopped.exchange(true, std::memory_order_acq_rel))
+    {
+        return;
+    }
+    if (mWriter.joinable())
+    {
+        mWriter.join();
+    }
+    while (drain())
+    {
+    }
+}
+
+void AsyncLogWriter::writerLoop()
+{
+    while (!mStopped.load(std::memory_order_acquire))
+    {
+        if (!drain())
+        {
+            std::this_thread::sleep_for(kPOLL_INTERVAL);
+        }
+    }
+}
+
+bool AsyncLogWriter::drain()
+{
+    std::string out;
+    std::string err;
+    std::size_t numRecords{0};
+    while (numRecords < kMAX_BATCH)
+    {
+        auto record = mRecords.tryPop();
+        if (!record)
+        {
+            break;
+        }
+        (record->toStderr ? err : out) += record->text;
+        ++numRecords;
+    }
+    auto const numDropped = mNumDropped.load(std::memory_order_relaxed);
+    if (numDropped != mNumDroppedReported)
+    {
+        err += fmtstr("[TensorRT-LLM][WARNING] Dropped %zu log records, the output can't keep up\n",
+            numDropped - mNumDroppedReported);
+        mNumDroppedReported = numDropped;
+    }
+    if (!out.empty())
+    {
+        std::cout << out << std::flush;
+    }
+    if (!err.empty())
+    {
+        std::cerr << err << std::flush;
+    }
+    mNumWritten.fetch_add(numRecords, std::memory_order_release);
+    return numRecords > 0;
+}
+
+} // namespace tensorrt_llm::common
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/mpscQueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+namespace tensorrt_llm::common
+{
+
+//! \brief Writes the formatted log records of all threads from a background thread.
+//! \details Callers only queue their record, without a lock and without waiting on stdout or stderr. The writer
+//! batches the queued records into one write and one flush per stream. Records beyond kMAX_PENDING are dropped and
+//! counted, rather than growing the queue without bound when the output can't keep up. Once stopped, at exit, records
+//! are written synchronously.
+class AsyncLogWriter
+{
+public:
+    static constexpr std::size_t kMAX_PENDING = std::size_t{1} << 16;
+
+    //! \brief Process wide writer, stopped and drained at exit.
+    static AsyncLogWriter& getInstance();
+
+    AsyncLogWriter();
+
+    ~AsyncLogWriter();
+
+    AsyncLogWriter(AsyncLogWriter const&) = delete;
+    AsyncLogWriter& operator=(AsyncLogWriter const&) = delete;
+
+    //! \param record The complete record, including its prefix and the end of line.
+    void write(std::string record, bool toStderr);
+
+    //! \brief Waits until the records queued so far are written.
+    void flush();
+
+    //! \brief Writes the queued records and stops the writer thread.
+    void stop();
+
+    [[nodiscard]] std::size_t getNumDropped() const noexcept
+    {
+        return mNumDropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Record
+    {
+        std::string text;
+        bool toStderr;
+    };
+
+    void writerLoop();
+
+    //! \returns Whether records were written.
+    bool drain();
+
+    MpscQueue<Record> mRecords;
+    std::atomic<std::size_t> mNumQueued{0};
+    std::atomic<std::size_t> mNumWritten{0};
+    std::atomic<std::size_t> mNumDropped{0};
+    std::size_t mNumDroppedReported{0};
+    std::atomic<bool> mStopped{false};
+    std::thread mWriter;
+};
+
+} // namespace tensorrt_llm::common
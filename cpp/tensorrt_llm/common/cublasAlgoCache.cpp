@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/cublasAlgoCache.h"
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/warmStartCache.h"
+
+#include <cstring>
+#include <exception>
+#include <string>
+
+namespace tensorrt_llm::common
+{
+
+static_assert(sizeof(CublasAlgoKey) == 16 * sizeof(std::int32_t) + sizeof(std::uint64_t),
+    "CublasAlgoKey is compared and persisted as bytes and must not have padding");
+
+namespace
+{
+struct SerializedHeader
+{
+    std::int32_t smVersion;
+    std::int32_t numEntries;
+    std::uint64_t cublasLtVersion;
+};
+
+struct SerializedEntry
+{
+    CublasAlgoKey key;
+    std::uint64_t hasAlgo;
+    cublasLtMatmulAlgo_t algo;
+};
+} // namespace
+
+bool CublasAlgoKey::operator==(CublasAlgoKey const& other) const noexcept
+{
+    return std::memcmp(this, &other, sizeof(CublasAlgoKey)) == 0;
+}
+
+std::size_t CublasAlgoKeyHash::operator()(CublasAlgoKey const& key) const noexcept
+{
+    return static_cast<std::size_t>(WarmStartCache::hash(&key, sizeof(key)));
+}
+
+CublasAlgoCache& CublasAlgoCache::getInstance()
+{
+    static CublasAlgoCache cache{getSMVersion(), cublasLtGetVersion(), /* persistent */ true};
+    return cache;
+}
+
+CublasAlgoCache::CublasAlgoCache(std::int32_t smVersion, std::size_t cublasLtVersion, bool persistent)
+    : mSmVersion{smVersion}
+    , mCublasLtVersion{cublasLtVersion}
+    , mEntries{std::make_shared<Map const>()}
+    // The process wide warm start cache is constructed first, so that it outlives the cache which stores into it
+    , mPersistent{persistent && WarmStartCache::getInstance().isEnabled()}
+{
+    if (!mPersistent)
+    {
+        return;
+    }
+    if (auto const cached = WarmStartCache::getInstance().load(getWarmStartKey()))
+    {
+        if (!deserialize(cached->data(), cached->size()))
+        {
+            TLLM_LOG_WARNING("Ignoring the cuBLASLt algos of the warm start cache, they don't match this setup");
+        }
+        mDirty = false;
+    }
+}
+
+CublasAlgoCache::~CublasAlgoCache()
+{
+    try
+    {
+        persist();
+    }
+    catch (std::exception const& e)
+    {
+        TLLM_LOG_WARNING("Failed to store the cuBLASLt algos: %s", e.what());
+    }
+}
+
+std::string CublasAlgoCache::getWarmStartKey() const
+{
+    return "cublaslt_algos_sm" + std::to_string(mSmVersion);
+}
+
+std::optional<CublasAlgoCache::Entry> CublasAlgoCache::find(CublasAlgoKey const& key) const
+{
+    auto const entries = std::atomic_load_explicit(&mEntries, std::memory_order_acquire);
+    if (auto const it = entries->find(key); it != entries->end())
+    {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+void CublasAlgoCache::insert(CublasAlgoKey const& key, Entry const& entry)
+{
+    std::lock_guard<std::mutex> lock(mInsertMutex);
+    auto const entries = std::atomic_load_explicit(&mEntries, std::memory_order_relaxed);
+    if (entries->count(key) != 0)
+    {
+        return;
+    }
+    // Copied on insertion, the readers keep the map they loaded alive
+    auto updated = std::make_shared<Map>(*entries);
+    updated->emplace(key, entry);
+    std::atomic_store_explicit(&mEntries, std::shared_ptr<Map const>{std::move(updated)}, std::memory_order_release);
+    mDirty = true;
+}
+
+std::size_t CublasAlgoCache::size() const
+{
+    return std::atomic_load_explicit(&mEntries, std::memory_order_acquire)->size();
+}
+
+std::vector<std::uint8_t> CublasAlgoCache::serialize() const
+{
+    auto const entries = std::atomic_load_explicit(&mEntries, std::memory_order_acquire);
+    std::vector<std::uint8_t> data(sizeof(SerializedHeader) + entries->size() * sizeof(SerializedEntry), 0);
+    SerializedHeader const header{mSmVersion, static_cast<std::int32_t>(entries->size()), mCublasLtVersion};
+    std::memcpy(data.data(), &header, sizeof(header));
+    auto* dst = data.data() + sizeof(header);
+    for (auto const& [key, entry] : *entries)
+    {
+        SerializedEntry serialized{};
+        serialized.key = key;
+        serialized.hasAlgo = entry.has_value() ? 1 : 0;
+        if (entry)
+        {
+            serialized.algo = *entry;
+        }
+        std::memcpy(dst, &serialized, sizeof(serialized));
+        dst += sizeof(serialized);
+    }
+    return data;
+}
+
+bool CublasAlgoCache::deserialize(void const* data, std::size_t size)
+{
+    if (size < sizeof(SerializedHeader))
+    {
+        return false;
+    }
+    SerializedHeader header{};
+    std::memcpy(&header, data, sizeof(header));
+    if (header.smVersion != mSmVersion || header.cublasLtVersion != mCublasLtVersion || header.numEntries < 0
+        || size != sizeof(header) + static_cast<std::size_t>(header.numEntries) * sizeof(SerializedEntry))
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mInsertMutex);
+    auto updated = std::make_shared<Map>(*std::atomic_load_explicit(&mEntries, std::memory_order_relaxed));
+    auto const* src = static_cast<std::uint8_t const*>(data) + sizeof(header);
+    for (std::int32_t i = 0; i < header.numEntries; ++i)
+    {
+        SerializedEntry serialized{};
+        std::memcpy(&serialized, src, sizeof(serialized));
+        src += sizeof(serialized);
+        updated->emplace(serialized.key, serialized.hasAlgo != 0 ? Entry{serialized.algo} : Entry{});
+    }
+    std::atomic_store_explicit(&mEntries, std::shared_ptr<Map const>{std::move(updated)}, std::memory_order_release);
+    mDirty = true;
+    return true;
+}
+
+void CublasAlgoCache::persist()
+{
+    if (!mPersistent || !mDirty.exchange(false))
+    {
+        return;
+    }
+    auto const data = serialize();
+    WarmStartCache::getInstance().store(getWarmStartKey(), data.data(), data.size());
+}
+
+} // namespace tensorrt_llm::common
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cublasLt.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::common
+{
+
+//! \brief Shape and types of a cuBLASLt matmul, with the algo requested by the caller if any.
+//! \details Plain data so that it's hashed and persisted as bytes: fields are 32 and 64 bits wide, without padding.
+struct CublasAlgoKey
+{
+    std::int32_t transa{0};
+    std::int32_t transb{0};
+    std::int32_t m{0};
+    std::int32_t n{0};
+    std::int32_t k{0};
+    std::int32_t lda{0};
+    std::int32_t ldb{0};
+    std::int32_t ldc{0};
+    std::int32_t aType{0};
+    std::int32_t bType{0};
+    std::int32_t cType{0};
+    std::int32_t computeType{0};
+    std::int32_t scaleType{0};
+    std::int32_t hasWorkspace{0};
+    //! GEMMs of a grouped call, and a mask of the operands they share (bit 0 for A, 1 for B)
+    std::int32_t groupCount{1};
+    std::int32_t sharedOperands{0};
+    //! Hash of the requested algo, 0 when the heuristic chooses
+    std::uint64_t requestedAlgoHash{0};
+
+    [[nodiscard]] bool operator==(CublasAlgoKey const& other) const noexcept;
+};
+
+struct CublasAlgoKeyHash
+{
+    [[nodiscard]] std::size_t operator()(CublasAlgoKey const& key) const noexcept;
+};
+
+//! \brief Process wide cache of the cuBLASLt algos resolved per GEMM shape.
+//! \details The first call of a shape checks the requested algo, or queries the heuristic, and the result is reused by
+//! the following calls. Lookups don't lock: the entries are an immutable map swapped on insertion, which only happens
+//! during the warmup. The entries are persisted in the warm start cache, for the SM and the cuBLASLt version they were
+//! resolved with.
+class CublasAlgoCache
+{
+public:
+    //! The algo to run, nullopt for the default of cuBLASLt
+    using Entry = std::optional<cublasLtMatmulAlgo_t>;
+
+    //! \brief Process wide cache, loaded from the warm start cache on first use and stored back at exit.
+    static CublasAlgoCache& getInstance();
+
+    //! \param persistent Whether the entries are loaded from the warm start cache and stored back on destruction.
+    CublasAlgoCache(std::int32_t smVersion, std::size_t cublasLtVersion, bool persistent = false);
+
+    ~CublasAlgoCache();
+
+    CublasAlgoCache(CublasAlgoCache const&) = delete;
+    CublasAlgoCache& operator=(CublasAlgoCache const&) = delete;
+
+    //! \returns The entry of the key, or nullopt if the shape wasn't resolved yet.
+    [[nodiscard]] std::optional<Entry> find(CublasAlgoKey const& key) const;
+
+    //! \brief Adds an entry, the first entry of a key wins.
+    void insert(CublasAlgoKey const& key, Entry const& entry);
+
+    [[nodiscard]] std::size_t size() const;
+
+    [[nodiscard]] std::vector<std::uint8_t> serialize() const;
+
+    //! \brief Adds the serialized entries.
+    //! \returns False if the data is malformed or was resolved for another SM or cuBLASLt version.
+    bool deserialize(void const* data, std::size_t size);
+
+    //! \brief Stores the entries in the warm start cache if the cache is persistent and entries were added since.
+    void persist();
+
+private:
+    using Map = std::unordered_map<CublasAlgoKey, Entry, CublasAlgoKeyHash>;
+
+    [[nodiscard]] std::string getWarmStartKey() const;
+
+    std::int32_t mSmVersion;
+    std::size_t mCublasLtVersion;
+    //! Read with atomic_load, replaced under mInsertMutex
+    std::shared_ptr<Map const> mEntries;
+    std::mutex mInsertMutex;
+    std::atomic<bool> mDirty{false};
+    bool mPersistent;
+};
+
+} // namespace tensorrt_llm::common
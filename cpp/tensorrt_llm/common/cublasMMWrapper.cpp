@@ -17,7 +17,9 @@
 #include "tensorrt_llm/common/cublasMMWrapper.h"
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/cublasVersionCheck.h"
+#include "tensorrt_llm/common/warmStartCache.h"
 #include <algorithm>
+#include <utility>
 
 #ifndef CUDART_VERSION
 #error CUDART_VERSION Undefined!
@@ -28,6 +30,23 @@ namespace tensorrt_llm
 namespace common
 {
 
+namespace
+{
+// The best algo of the heuristic that fits the workspace, as chosen by cublasLtMatmul without an algo
+CublasAlgoCache::Entry pickHeuristic(
+    std::vector<cublasLtMatmulHeuristicResult_t> const& heuristics, std::size_t const workspaceSize)
+{
+    for (auto const& heuristic : heuristics)
+    {
+        if (heuristic.state == CUBLAS_STATUS_SUCCESS && heuristic.workspaceSize <= workspaceSize)
+        {
+            return heuristic.algo;
+        }
+    }
+    return std::nullopt;
+}
+} // namespace
+
 CublasMMWrapper::CublasMMWrapper(std::shared_ptr<cublasHandle_t> cublasHandle,
     std::shared_ptr<cublasLtHandle_t> cublasltHandle, cudaStream_t stream, void* workspace)
     : mCublasHandle(cublasHandle)
@@ -135,8 +154,6 @@ void CublasMMWrapper::Gemm(cublasOperation_t transa, cublasOperation_t transb, i
     half h_alpha = (half) (f_alpha);
     half h_beta = (half) (f_beta);
 
-    std::lock_guard<std::mutex> lock(*mMutex);
-
     // TODO: default cublas libs
     usingCublasLt = usingCublasLt && (mAType == CUDA_R_16F || mAType == CUDA_R_8F_E4M3);
     bool isFp16ComputeType = mComputeType == CUBLAS_COMPUTE_16F;
@@ -149,18 +166,26 @@ void CublasMMWrapper::Gemm(cublasOperation_t transa, cublasOperation_t transb, i
 
     if (usingCublasLt)
     {
-        if (hasAlgo)
+        // cublasLt handles are thread safe, the algo is resolved once per shape and the matmul doesn't lock
+        auto const algoKey = getAlgoKey(transa, transb, m, n, k, lda, ldb, ldc, hasAlgo ? &algo : nullptr);
+        auto& algoCache = CublasAlgoCache::getInstance();
+        auto cached = algoCache.find(algoKey);
+        if (!cached)
         {
-            hasAlgo = checkTactic(transa, transb, m, n, k, lda, ldb, ldc, algo);
+            cached = resolveAlgo(transa, transb, m, n, k, lda, ldb, ldc, hasAlgo ? &algo : nullptr);
+            algoCache.insert(algoKey, *cached);
         }
+        auto const& resolvedAlgo = *cached;
 
         check_cuda_error(cublasLtMatmul(getCublasLtHandle(), mOperationDesc, alpha, A, mADesc, B, mBDesc, beta, C,
-            mCDesc, C, mCDesc, (hasAlgo ? (&algo) : NULL), mCublasWorkspace, workspaceSize, mStream));
+            mCDesc, C, mCDesc, (resolvedAlgo ? &(*resolvedAlgo) : NULL), mCublasWorkspace, workspaceSize, mStream));
 
         sync_check_cuda_error();
     }
     else
     {
+        // The stream and workspace are set on the cublas handle shared by the copies of the wrapper
+        std::lock_guard<std::mutex> lock(*mMutex);
         check_cuda_error(cublasSetStream(getCublasHandle(), mStream));
         check_cuda_error(cublasSetWorkspace(getCublasHandle(), mCublasWorkspace, workspaceSize));
         // Go with default heuristic to choose tactic as cuBLAS does not allow to choose tactics in Ampere+
@@ -171,6 +196,116 @@ void CublasMMWrapper::Gemm(cublasOperation_t transa, cublasOperation_t transb, i
     }
 }
 
+CublasAlgoKey CublasMMWrapper::getAlgoKey(cublasOperation_t transa, cublasOperation_t transb, int const m, int const n,
+    int const k, int const lda, int const ldb, int const ldc, cublasLtMatmulAlgo_t const* requestedAlgo) const
+{
+    CublasAlgoKey key;
+    key.transa = static_cast<std::int32_t>(transa);
+    key.transb = static_cast<std::int32_t>(transb);
+    key.m = m;
+    key.n = n;
+    key.k = k;
+    key.lda = lda;
+    key.ldb = ldb;
+    key.ldc = ldc;
+    key.aType = static_cast<std::int32_t>(mAType);
+    key.bType = static_cast<std::int32_t>(mBType);
+    key.cType = static_cast<std::int32_t>(mCType);
+    key.computeType = static_cast<std::int32_t>(mComputeType);
+    key.scaleType = static_cast<std::int32_t>(mScaleType);
+    key.hasWorkspace = mCublasWorkspace == NULL ? 0 : 1;
+    key.requestedAlgoHash = requestedAlgo == nullptr ? 0 : WarmStartCache::hash(requestedAlgo, sizeof(*requestedAlgo));
+    return key;
+}
+
+CublasAlgoCache::Entry CublasMMWrapper::resolveAlgo(cublasOperation_t transa, cublasOperation_t transb, int const m,
+    int const n, int const k, int const lda, int const ldb, int const ldc, cublasLtMatmulAlgo_t const* requestedAlgo)
+{
+    if (requestedAlgo != nullptr)
+    {
+        // An algo profiled for another m of its bucket may not support this one
+        if (checkTactic(transa, transb, m, n, k, lda, ldb, ldc, *requestedAlgo))
+        {
+            return *requestedAlgo;
+        }
+        return std::nullopt;
+    }
+    return pickHeuristic(
+        getTactics(transa, transb, m, n, k, lda, ldb, ldc), mCublasWorkspace == NULL ? 0 : CUBLAS_WORKSPACE_SIZE);
+}
+
+void CublasMMWrapper::groupedGemm(cublasOperation_t transa, cublasOperation_t transb, int const m, int const n,
+    int const k, void const* A, int const lda, int64_t const strideA, void const* B, int const ldb,
+    int64_t const strideB, void* C, int const ldc, int64_t const strideC, int const groupCount, float const f_alpha,
+    float const f_beta)
+{
+    half h_alpha = (half) (f_alpha);
+    half h_beta = (half) (f_beta);
+    bool const isFp16ComputeType = mComputeType == CUBLAS_COMPUTE_16F;
+    void const* alpha = isFp16ComputeType ? reinterpret_cast<void*>(&h_alpha) : reinterpret_cast<void const*>(&f_alpha);
+    void const* beta = isFp16ComputeType ? reinterpret_cast<void*>(&h_beta) : reinterpret_cast<void const*>(&f_beta);
+    int const workspaceSize = mCublasWorkspace == NULL ? 0 : CUBLAS_WORKSPACE_SIZE;
+
+    if (mAType != CUDA_R_16F && mAType != CUDA_R_8F_E4M3)
+    {
+        // Types that Gemm runs with cublas rather than cublasLt
+        std::lock_guard<std::mutex> lock(*mMutex);
+        check_cuda_error(cublasSetStream(getCublasHandle(), mStream));
+        check_cuda_error(cublasSetWorkspace(getCublasHandle(), mCublasWorkspace, workspaceSize));
+        check_cuda_error(cublasGemmStridedBatchedEx(getCublasHandle(), transa, transb, m, n, k, alpha, A, mAType, lda,
+            strideA, B, mBType, ldb, strideB, beta, C, mCType, ldc, strideC, groupCount, mComputeType,
+            mAType == CUDA_R_32F ? CUBLAS_GEMM_DEFAULT : CUBLAS_GEMM_DEFAULT_TENSOR_OP));
+        sync_check_cuda_error();
+        return;
+    }
+
+    // Own descriptors, the grouped layouts don't replace the ones created for Gemm
+    cublasLtMatmulDesc_t operationDesc{NULL};
+    cublasLtMatrixLayout_t aDesc{NULL};
+    cublasLtMatrixLayout_t bDesc{NULL};
+    cublasLtMatrixLayout_t cDesc{NULL};
+    check_cuda_error(
+        cublasLtMatrixLayoutCreate(&aDesc, mAType, transa == CUBLAS_OP_N ? m : k, transa == CUBLAS_OP_N ? k : m, lda));
+    check_cuda_error(
+        cublasLtMatrixLayoutCreate(&bDesc, mBType, transb == CUBLAS_OP_N ? k : n, transb == CUBLAS_OP_N ? n : k, ldb));
+    check_cuda_error(cublasLtMatrixLayoutCreate(&cDesc, mCType, m, n, ldc));
+    for (auto const& [desc, stride] : {std::make_pair(aDesc, strideA), std::make_pair(bDesc, strideB),
+             std::make_pair(cDesc, strideC)})
+    {
+        check_cuda_error(cublasLtMatrixLayoutSetAttribute(
+            desc, CUBLASLT_MATRIX_LAYOUT_BATCH_COUNT, &groupCount, sizeof(groupCount)));
+        check_cuda_error(cublasLtMatrixLayoutSetAttribute(
+            desc, CUBLASLT_MATRIX_LAYOUT_STRIDED_BATCH_OFFSET, &stride, sizeof(stride)));
+    }
+    check_cuda_error(cublasLtMatmulDescCreate(&operationDesc, mComputeType, mScaleType));
+    check_cuda_error(cublasLtMatmulDescSetAttribute(
+        operationDesc, CUBLASLT_MATMUL_DESC_TRANSA, &transa, sizeof(cublasOperation_t)));
+    check_cuda_error(cublasLtMatmulDescSetAttribute(
+        operationDesc, CUBLASLT_MATMUL_DESC_TRANSB, &transb, sizeof(cublasOperation_t)));
+
+    auto algoKey = getAlgoKey(transa, transb, m, n, k, lda, ldb, ldc, nullptr);
+    algoKey.groupCount = groupCount;
+    algoKey.sharedOperands = (strideA == 0 ? 1 : 0) | (strideB == 0 ? 2 : 0);
+    auto& algoCache = CublasAlgoCache::getInstance();
+    auto cached = algoCache.find(algoKey);
+    if (!cached)
+    {
+        cached = pickHeuristic(
+            getTactics(getCublasLtHandle(), operationDesc, aDesc, bDesc, cDesc, cDesc), workspaceSize);
+        algoCache.insert(algoKey, *cached);
+    }
+    auto const& resolvedAlgo = *cached;
+
+    check_cuda_error(cublasLtMatmul(getCublasLtHandle(), operationDesc, alpha, A, aDesc, B, bDesc, beta, C, cDesc, C,
+        cDesc, (resolvedAlgo ? &(*resolvedAlgo) : NULL), mCublasWorkspace, workspaceSize, mStream));
+    sync_check_cuda_error();
+
+    check_cuda_error(cublasLtMatmulDescDestroy(operationDesc));
+    check_cuda_error(cublasLtMatrixLayoutDestroy(aDesc));
+    check_cuda_error(cublasLtMatrixLayoutDestroy(bDesc));
+    check_cuda_error(cublasLtMatrixLayoutDestroy(cDesc));
+}
+
 void CublasMMWrapper::stridedBatchedGemm(cublasOperation_t transa, cublasOperation_t transb, int const m, int const n,
     int const k, void const* A, int const lda, const int64_t strideA, void const* B, int const ldb,
     const int64_t strideB, void* C, int const ldc, const int64_t strideC, int const batchCount, float const f_alpha,
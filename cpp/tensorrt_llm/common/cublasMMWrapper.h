@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "tensorrt_llm/common/cublasAlgoCache.h"
 #include "tensorrt_llm/common/cudaUtils.h"
 #include <cublasLt.h>
 #include <cublas_v2.h>
@@ -48,7 +49,7 @@ protected:
     cublasLtMatrixLayout_t mCDesc{NULL};
 
     cudaStream_t mStream;
-    //@fixme: we may not need the mutex if we copy the wrapper instead of sharing in GemmPlugin::clone()
+    //! Serializes the cublas calls, which set the stream and workspace on the shared handle. cublasLt calls don't lock.
     std::shared_ptr<std::mutex> mMutex{std::make_shared<std::mutex>()};
 
     void* mCublasWorkspace = nullptr;
@@ -59,6 +60,13 @@ private:
         return mOperationDesc != NULL && mADesc != NULL && mBDesc != NULL && mCDesc != NULL;
     }
 
+    CublasAlgoKey getAlgoKey(cublasOperation_t transa, cublasOperation_t transb, int const m, int const n, int const k,
+        int const lda, int const ldb, int const ldc, cublasLtMatmulAlgo_t const* requestedAlgo) const;
+
+    //! \brief Checks the requested algo, or queries the heuristic, for the first call of a shape.
+    CublasAlgoCache::Entry resolveAlgo(cublasOperation_t transa, cublasOperation_t transb, int const m, int const n,
+        int const k, int const lda, int const ldb, int const ldc, cublasLtMatmulAlgo_t const* requestedAlgo);
+
 public:
     CublasMMWrapper(std::shared_ptr<cublasHandle_t> cublasHandle, std::shared_ptr<cublasLtHandle_t> cublasLtHandle,
         cudaStream_t stream, void* workspace);
@@ -86,6 +94,13 @@ public:
         int const lda, void const* B, int const ldb, void* C, int const ldc, float f_alpha, float f_beta,
         cublasLtMatmulAlgo_t const& algo, bool hasAlgo, bool usingCublasLt);
 
+    //! \brief Runs groupCount GEMMs of the same shape in one launch, such as the Q/K/V or gate/up projections of an
+    //! activation. A stride of 0 shares the operand between the GEMMs.
+    void groupedGemm(cublasOperation_t transa, cublasOperation_t transb, int const m, int const n, int const k,
+        void const* A, int const lda, int64_t const strideA, void const* B, int const ldb, int64_t const strideB,
+        void* C, int const ldc, int64_t const strideC, int const groupCount, float const f_alpha = 1.0f,
+        float const f_beta = 0.0f);
+
     void stridedBatchedGemm(cublasOperation_t transa, cublasOperation_t transb, int const m, int const n, int const k,
         void const* A, int const lda, const int64_t strideA, void const* B, int const ldb, const int64_t strideB,
         void* C, int const ldc, const int64_t strideC, int const batchCount, float const f_alpha = 1.0f,
@@ -17,6 +17,7 @@
 
 #include "envUtils.h"
 #include "tensorrt_llm/common/logger.h"
+#include <algorithm>
 #include <cstdlib>
 
 namespace tensorrt_llm::common
@@ -74,6 +75,12 @@ bool getEnvEnableXQAJIT()
     return enableXQAJIT;
 }
 
+int32_t getEnvFusedQkvPrologueMaxBatchBeam()
+{
+    static int32_t const maxBatchBeam = std::max(getIntEnv("TRTLLM_FUSED_QKV_PROLOGUE_MAX_BATCH_BEAM").value_or(0), 0);
+    return maxBatchBeam;
+}
+
 // Tune the number of blocks per sequence for accuracy/performance purpose.
 bool getEnvMmhaMultiblockDebug()
 {
@@ -134,4 +141,131 @@ int getEnvMmhaKernelBlockSize()
     return mmhaKernelBlockSize;
 }
 
+std::optional<std::string> getEnvMmhaMultiBlockTable()
+{
+    static std::optional<std::string> const mmhaMultiBlockTable = []() -> std::optional<std::string>
+    {
+        char const* mmhaMultiBlockTableEnv = std::getenv("TRTLLM_MMHA_MULTI_BLOCK_TABLE");
+        if (mmhaMultiBlockTableEnv == nullptr || mmhaMultiBlockTableEnv[0] == '\0')
+        {
+            return std::nullopt;
+        }
+        return std::string{mmhaMultiBlockTableEnv};
+    }();
+    return mmhaMultiBlockTable;
+}
+
+std::optional<std::string> getEnvWarmStartCacheDir()
+{
+    static std::optional<std::string> const warmStartCacheDir = []() -> std::optional<std::string>
+    {
+        char const* warmStartCacheDirEnv = std::getenv("TRTLLM_WARM_START_CACHE_DIR");
+        if (warmStartCacheDirEnv == nullptr || warmStartCacheDirEnv[0] == '\0')
+        {
+            return std::nullopt;
+        }
+        return std::string{warmStartCacheDirEnv};
+    }();
+    return warmStartCacheDir;
+}
+
+bool getEnvGemmRuntimeAutotune()
+{
+    static bool const gemmRuntimeAutotune = (getIntEnv("TRTLLM_GEMM_RUNTIME_AUTOTUNE").value_or(0) != 0);
+    return gemmRuntimeAutotune;
+}
+
+std::optional<std::string> getEnvGemmProfileCacheDir()
+{
+    static std::optional<std::string> const gemmProfileCacheDir = []() -> std::optional<std::string>
+    {
+        char const* gemmProfileCacheDirEnv = std::getenv("TRTLLM_GEMM_PROFILE_CACHE_DIR");
+        if (gemmProfileCacheDirEnv == nullptr || gemmProfileCacheDirEnv[0] == '\0')
+        {
+            return std::nullopt;
+        }
+        return std::string{gemmProfileCacheDirEnv};
+    }();
+    return gemmProfileCacheDir;
+}
+
+int getEnvGemmProfileNumDevices()
+{
+    static int const gemmProfileNumDevices = std::max(getIntEnv("TRTLLM_GEMM_PROFILE_NUM_DEVICES").value_or(1), 0);
+    return gemmProfileNumDevices;
+}
+
+bool getEnvAllReduceAutotune()
+{
+    static bool const allReduceAutotune = (getIntEnv("TRTLLM_ALLREDUCE_AUTOTUNE").value_or(0) != 0);
+    return allReduceAutotune;
+}
+
+bool getEnvAllReduceNvls()
+{
+    static bool const allReduceNvls = (getIntEnv("TRTLLM_ALLREDUCE_NVLS").value_or(0) != 0);
+    return allReduceNvls;
+}
+
+bool getEnvStreamPriorities()
+{
+    static bool const streamPriorities = []()
+    {
+        // getIntEnv doesn't return 0, which disables the priorities
+        char const* streamPrioritiesEnv = std::getenv("TRTLLM_STREAM_PRIORITIES");
+        return streamPrioritiesEnv == nullptr || std::string{streamPrioritiesEnv} != "0";
+    }();
+    return streamPriorities;
+}
+
+std::optional<std::string> getEnvCpuAffinity()
+{
+    static std::optional<std::string> const cpuAffinity = []() -> std::optional<std::string>
+    {
+        char const* cpuAffinityEnv = std::getenv("TRTLLM_CPU_AFFINITY");
+        if (cpuAffinityEnv == nullptr || cpuAffinityEnv[0] == '\0')
+        {
+            return std::nullopt;
+        }
+        return std::string{cpuAffinityEnv};
+    }();
+    return cpuAffinity;
+}
+
+bool getEnvNumaPinnedMemory()
+{
+    static bool const numaPinnedMemory = (getIntEnv("TRTLLM_NUMA_PINNED_MEMORY").value_or(0) != 0);
+    return numaPinnedMemory;
+}
+
+bool getEnvShareDecoderInfo()
+{
+    static bool const shareDecoderInfo = (getIntEnv("TRTLLM_SHARE_DECODER_INFO").value_or(0) != 0);
+    return shareDecoderInfo;
+}
+
+int32_t getEnvPluginTimingInterval()
+{
+    static int32_t const pluginTimingInterval = getIntEnv("TRTLLM_PLUGIN_TIMING_INTERVAL").value_or(0);
+    return pluginTimingInterval;
+}
+
+bool getEnvAsyncLogging()
+{
+    static bool const asyncLogging = (getIntEnv("TLLM_LOG_ASYNC").value_or(0) != 0);
+    return asyncLogging;
+}
+
+bool getEnvNumericSentinel()
+{
+    static bool const numericSentinel = (getIntEnv("TRTLLM_NUMERIC_SENTINEL").value_or(0) != 0);
+    return numericSentinel;
+}
+
+int32_t getEnvNumericSentinelOverflow()
+{
+    static int32_t const numericSentinelOverflow = getIntEnv("TRTLLM_NUMERIC_SENTINEL_OVERFLOW").value_or(0);
+    return numericSentinelOverflow;
+}
+
 } // namespace tensorrt_llm::common
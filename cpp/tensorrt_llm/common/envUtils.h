@@ -18,6 +18,7 @@
 #pragma once
 #include <cstdint>
 #include <optional>
+#include <string>
 
 namespace tensorrt_llm::common
 {
@@ -36,6 +37,10 @@ std::optional<int32_t> envXqaNbCtaPerKVHead();
 // Whether XQA JIT is enabled.
 bool getEnvEnableXQAJIT();
 
+// Largest batch_size * beam_width for which generation uses MMHA instead of XQA, as MMHA does the QKV bias, RoPE, kv
+// cache quantization and update in its prologue while XQA needs a separate preprocessing kernel. 0 (default) disables.
+int32_t getEnvFusedQkvPrologueMaxBatchBeam();
+
 // Tune the number of blocks per sequence for accuracy/performance purpose.
 bool getEnvMmhaMultiblockDebug();
 
@@ -43,4 +48,60 @@ int getEnvMmhaBlocksPerSequence();
 
 int getEnvMmhaKernelBlockSize();
 
+// File with profiled numbers of MMHA blocks per sequence, the built-in multi-block heuristic is used if unset.
+std::optional<std::string> getEnvMmhaMultiBlockTable();
+
+// Directory of the warm-start cache reused across process restarts, disabled if unset.
+std::optional<std::string> getEnvWarmStartCacheDir();
+
+// Whether the quantized GEMM plugins profile their tactics at runtime for the token counts they actually see, instead
+// of using the tactic of the nearest power of two profiled at engine build.
+bool getEnvGemmRuntimeAutotune();
+
+// Directory of the GEMM plugin tactics profiled at engine build, shared by the ranks and the builds on the same GPU
+// model and driver regardless of the engine, disabled if unset.
+std::optional<std::string> getEnvGemmProfileCacheDir();
+
+// Number of visible GPUs of the same model the GEMM plugins profile their tactics on in parallel at engine build, 0 for
+// all of them. Defaults to 1, the current GPU. Only for builds that don't run concurrently on the other GPUs, which
+// would skew the timings.
+int getEnvGemmProfileNumDevices();
+
+// Whether the AUTO all reduce strategy uses crossover points measured at startup instead of fixed thresholds.
+bool getEnvAllReduceAutotune();
+
+// Whether the runtime sets up the multicast buffers of the NVLS all reduce on NVSwitch systems, which the NVLS and AUTO
+// strategies need to use it.
+bool getEnvAllReduceNvls();
+
+// Whether the runtime creates its compute streams at high and its background transfer streams at low priority, on by
+// default.
+bool getEnvStreamPriorities();
+
+// CPUs of the worker threads of a device: "gpu" for the CPUs of the NUMA node of the device, or a list such as
+// "0-15,32-47". Threads are not pinned if unset.
+std::optional<std::string> getEnvCpuAffinity();
+
+// Whether pinned host memory is allocated on the NUMA node of the current device.
+bool getEnvNumaPinnedMemory();
+
+// Whether the context phase of the attention layers builds the sequence offsets and rotary inv_freq once per forward
+// pass and shares them, instead of building them in every layer.
+bool getEnvShareDecoderInfo();
+
+// Every how many engine executions the attention, GEMM, all reduce and MoE plugins are timed with CUDA events, see
+// runtime::PluginTimer. 0 (default) disables the timing.
+int32_t getEnvPluginTimingInterval();
+
+// Whether log records are written by a background thread instead of the threads that log them.
+bool getEnvAsyncLogging();
+
+// Whether the logits, attention, MoE and encoder outputs are checked on the device for NaN and Inf, see
+// runtime::NumericSentinel.
+bool getEnvNumericSentinel();
+
+// Magnitude above which the numeric sentinel also reports a value, e.g. close to the range of FP16 for FP8 models. 0
+// (default) only reports NaN and Inf.
+int32_t getEnvNumericSentinelOverflow();
+
 } // namespace tensorrt_llm::common
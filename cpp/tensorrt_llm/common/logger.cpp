@@ -15,6 +15,8 @@
  */
 
 #include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/asyncLogWriter.h"
+#include "tensorrt_llm/common/envUtils.h"
 #include "tensorrt_llm/common/tllmException.h"
 #include <cuda_runtime.h>
 
@@ -22,6 +24,7 @@ namespace tensorrt_llm::common
 {
 
 Logger::Logger()
+    : mAsync{getEnvAsyncLogging()}
 {
     char* isFirstRankOnlyChar = std::getenv("TLLM_LOG_FIRST_RANK_ONLY");
     bool isFirstRankOnly = (isFirstRankOnlyChar != nullptr && std::string(isFirstRankOnlyChar) == "ON");
@@ -55,6 +58,24 @@ Logger::Logger()
     }
 }
 
+void Logger::write(Logger::Level level, std::string record)
+{
+    auto const toStderr = level_ >= WARNING;
+    if (!mAsync)
+    {
+        (toStderr ? std::cerr : std::cout) << record << std::endl;
+        return;
+    }
+    record += '\n';
+    auto& writer = AsyncLogWriter::getInstance();
+    writer.write(std::move(record), toStderr);
+    if (level >= ERROR)
+    {
+        // Errors are out before the caller goes on, it may be about to abort
+        writer.flush();
+    }
+}
+
 void Logger::log(std::exception const& ex, Logger::Level level)
 {
     log(level, "%s: %s", TllmException::demangle(typeid(ex).name()).c_str(), ex.what());
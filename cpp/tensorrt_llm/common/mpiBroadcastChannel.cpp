@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/mpiBroadcastChannel.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace tensorrt_llm::mpi
+{
+
+namespace
+{
+// A block starts with the size of the message, this size closes the channel
+constexpr std::uint64_t kClosedSize = std::numeric_limits<std::uint64_t>::max();
+constexpr std::size_t kSizeBytes = sizeof(std::uint64_t);
+} // namespace
+
+void MpiBroadcastChannel::Slot::wait()
+{
+    if (blockRequest)
+    {
+        blockRequest->wait();
+        blockRequest.reset();
+    }
+    if (restRequest)
+    {
+        restRequest->wait();
+        restRequest.reset();
+    }
+}
+
+MpiBroadcastChannel::MpiBroadcastChannel(MpiComm const& comm, int root, std::size_t inlineSize)
+    : mComm{comm}
+    , mRoot{root}
+    , mIsRoot{comm.getRank() == root}
+    , mInlineSize{inlineSize}
+{
+    TLLM_CHECK_WITH_INFO(inlineSize > kSizeBytes && inlineSize <= INT_MAX, "Invalid inline size %zu.", inlineSize);
+    for (auto& slot : mSlots)
+    {
+        slot.block.resize(mInlineSize);
+    }
+    if (!mIsRoot)
+    {
+        postBlock(mSlots[0]);
+    }
+}
+
+MpiBroadcastChannel::~MpiBroadcastChannel()
+{
+    try
+    {
+        if (mIsRoot)
+        {
+            close();
+        }
+        else if (!mClosed)
+        {
+            // Collective broadcasts can't be cancelled, this waits for the root to close the channel
+            mSlots[mNext % mSlots.size()].wait();
+        }
+    }
+    catch (std::exception const& e)
+    {
+        TLLM_LOG_EXCEPTION(e);
+    }
+}
+
+void MpiBroadcastChannel::postBlock(Slot& slot)
+{
+    slot.blockRequest = mComm.bcastAsync(slot.block.data(), mInlineSize, MpiType::kBYTE, mRoot);
+}
+
+void MpiBroadcastChannel::send(std::vector<char> message)
+{
+    TLLM_CHECK_WITH_INFO(mIsRoot, "Only the root sends messages.");
+    TLLM_CHECK_WITH_INFO(!mClosed, "The channel is closed.");
+    auto& slot = mSlots[mNext % mSlots.size()];
+    slot.wait();
+    slot.message = std::move(message);
+
+    std::uint64_t const size = slot.message.size();
+    auto const inlineBytes = std::min<std::size_t>(size, mInlineSize - kSizeBytes);
+    TLLM_CHECK_WITH_INFO(size - inlineBytes <= INT_MAX, "Message of %lu bytes is too large.", size);
+    std::memcpy(slot.block.data(), &size, kSizeBytes);
+    std::memcpy(slot.block.data() + kSizeBytes, slot.message.data(), inlineBytes);
+    postBlock(slot);
+    if (size > inlineBytes)
+    {
+        slot.restRequest
+            = mComm.bcastAsync(slot.message.data() + inlineBytes, size - inlineBytes, MpiType::kBYTE, mRoot);
+    }
+    ++mNext;
+}
+
+void MpiBroadcastChannel::close()
+{
+    TLLM_CHECK_WITH_INFO(mIsRoot, "Only the root closes the channel.");
+    if (mClosed)
+    {
+        return;
+    }
+    auto& slot = mSlots[mNext % mSlots.size()];
+    slot.wait();
+    std::memcpy(slot.block.data(), &kClosedSize, kSizeBytes);
+    postBlock(slot);
+    for (auto& s : mSlots)
+    {
+        s.wait();
+    }
+    mClosed = true;
+}
+
+std::optional<std::vector<char>> MpiBroadcastChannel::receive()
+{
+    TLLM_CHECK_WITH_INFO(!mIsRoot, "The root doesn't receive messages.");
+    if (mClosed)
+    {
+        return std::nullopt;
+    }
+    auto& slot = mSlots[mNext % mSlots.size()];
+    slot.wait();
+    std::uint64_t size{0};
+    std::memcpy(&size, slot.block.data(), kSizeBytes);
+    if (size == kClosedSize)
+    {
+        mClosed = true;
+        return std::nullopt;
+    }
+
+    std::vector<char> message(size);
+    auto const inlineBytes = std::min<std::size_t>(size, mInlineSize - kSizeBytes);
+    std::memcpy(message.data(), slot.block.data() + kSizeBytes, inlineBytes);
+    std::shared_ptr<MpiRequest> restRequest;
+    if (size > inlineBytes)
+    {
+        restRequest = mComm.bcastAsync(message.data() + inlineBytes, size - inlineBytes, MpiType::kBYTE, mRoot);
+    }
+    // Same order as the root: the rest of this message, then the block of the next one
+    ++mNext;
+    postBlock(mSlots[mNext % mSlots.size()]);
+    if (restRequest)
+    {
+        restRequest->wait();
+    }
+    return message;
+}
+
+} // namespace tensorrt_llm::mpi
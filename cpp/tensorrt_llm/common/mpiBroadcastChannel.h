@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/mpiUtils.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::mpi
+{
+
+//! \brief Stream of variable size messages broadcast from a root rank with non-blocking broadcasts.
+//! \details The root returns from send as soon as the broadcast is posted, so that it overlaps with the work of the
+//! iteration, and only waits for it when the buffer is reused two messages later. The other ranks post the broadcast
+//! of the next message as soon as they received one. A message goes out in a single broadcast of a fixed size block
+//! when it fits, larger ones take a second broadcast of the rest, so there is no separate broadcast of the size.
+//!
+//! The root closes the channel on destruction, the other ranks must receive until receive returns std::nullopt
+//! before destroying theirs. The communicator must outlive the channel and carry no other collectives in between.
+class MpiBroadcastChannel
+{
+public:
+    static constexpr std::size_t kDefaultInlineSize = 4096;
+
+    MpiBroadcastChannel(MpiComm const& comm, int root, std::size_t inlineSize = kDefaultInlineSize);
+
+    MpiBroadcastChannel(MpiBroadcastChannel const&) = delete;
+    MpiBroadcastChannel& operator=(MpiBroadcastChannel const&) = delete;
+
+    ~MpiBroadcastChannel();
+
+    //! \brief Root only. Posts the broadcast of message.
+    void send(std::vector<char> message);
+
+    //! \brief Root only. Tells the other ranks that there are no more messages and waits for all broadcasts.
+    void close();
+
+    //! \brief Other ranks. Waits for the next message.
+    //! \returns std::nullopt once the root closed the channel.
+    [[nodiscard]] std::optional<std::vector<char>> receive();
+
+private:
+    struct Slot
+    {
+        std::vector<char> block;
+        std::vector<char> message;
+        std::shared_ptr<MpiRequest> blockRequest;
+        std::shared_ptr<MpiRequest> restRequest;
+
+        void wait();
+    };
+
+    void postBlock(Slot& slot);
+
+    MpiComm const& mComm;
+    int mRoot;
+    bool mIsRoot;
+    std::size_t mInlineSize;
+    std::array<Slot, 2> mSlots;
+    std::size_t mNext{0};
+    bool mClosed{false};
+};
+
+} // namespace tensorrt_llm::mpi
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+namespace tensorrt_llm::common
+{
+
+//! \brief Unbounded lock-free queue for any number of producer threads and exactly one consumer thread.
+//! \details An intrusive linked list (Vyukov): a push is one allocation, one exchange and one store, producers never
+//! wait for each other nor for the consumer. A push that hasn't linked its node yet hides the items pushed after it
+//! until it completes, so tryPop may miss items for that short window; the consumer simply polls again.
+template <typename T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+        : mHead{new Node{}}
+        , mTail{mHead.load(std::memory_order_relaxed)}
+    {
+    }
+
+    ~MpscQueue()
+    {
+        while (tryPop())
+        {
+        }
+        delete mTail;
+    }
+
+    MpscQueue(MpscQueue const&) = delete;
+    MpscQueue& operator=(MpscQueue const&) = delete;
+
+    //! \brief Producer side, from any thread.
+    template <typename U>
+    void push(U&& item)
+    {
+        auto* node = new Node{std::forward<U>(item)};
+        // Counted first, so that a concurrent pop never takes the size below zero
+        mSize.fetch_add(1, std::memory_order_relaxed);
+        auto* prev = mHead.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    //! \brief Consumer side. Returns std::nullopt if the queue is empty.
+    [[nodiscard]] std::optional<T> tryPop()
+    {
+        auto* tail = mTail;
+        auto* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            return std::nullopt;
+        }
+        // The next node becomes the stub, its item is moved out
+        std::optional<T> item{std::move(next->item)};
+        next->item.reset();
+        mTail = next;
+        delete tail;
+        mSize.fetch_sub(1, std::memory_order_relaxed);
+        return item;
+    }
+
+    //! \brief Approximate number of queued items.
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return mSize.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Node
+    {
+        Node() = default;
+
+        template <typename U>
+        explicit Node(U&& value)
+            : item{std::forward<U>(value)}
+        {
+        }
+
+        std::optional<T> item;
+        std::atomic<Node*> next{nullptr};
+    };
+
+    static constexpr std::size_t kCacheLineSize = 64;
+
+    // Written by the producers and the consumer respectively, on separate cache lines
+    alignas(kCacheLineSize) std::atomic<Node*> mHead;
+    std::atomic<std::size_t> mSize{0};
+    alignas(kCacheLineSize) Node* mTail;
+};
+
+} // namespace tensorrt_llm::common
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/shmMessageChannel.h"
+
+#include "tensorrt_llm/common/assert.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace tensorrt_llm::common
+{
+
+namespace
+{
+constexpr std::uint64_t kMagic = 0x544c4c4d53484d31; // "TLLMSHM1"
+// Length of the padding message that sends the consumer back to the start of the ring
+constexpr std::uint64_t kWrapMarker = std::numeric_limits<std::uint64_t>::max();
+constexpr std::size_t kLengthSize = sizeof(std::uint64_t);
+
+constexpr std::size_t roundUp(std::size_t value)
+{
+    return (value + kLengthSize - 1) / kLengthSize * kLengthSize;
+}
+
+std::size_t getFrameSize(std::size_t size)
+{
+    return kLengthSize + roundUp(size);
+}
+
+std::string getShmName(std::string const& name)
+{
+    return name.empty() || name.front() != '/' ? "/" + name : name;
+}
+} // namespace
+
+// Positions are byte counts since the creation of the channel, so that a full and an empty ring differ. The head is
+// only written by the consumer and the tail by the producer, on separate cache lines.
+struct ShmMessageChannel::Header
+{
+    std::uint64_t magic;
+    std::uint64_t capacity;
+    alignas(64) std::atomic<std::uint64_t> head;
+    alignas(64) std::atomic<std::uint64_t> tail;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The positions are shared between processes");
+
+ShmMessageChannel ShmMessageChannel::create(std::string const& name, std::size_t capacity)
+{
+    TLLM_CHECK_WITH_INFO(capacity >= 4 * kLengthSize, "The capacity (%zu) of the channel is too small.", capacity);
+    capacity = roundUp(capacity);
+    auto const shmName = getShmName(name);
+    int const fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    TLLM_CHECK_WITH_INFO(fd >= 0, "Failed to create shared memory %s: %s", shmName.c_str(), std::strerror(errno));
+    auto const mappingSize = sizeof(Header) + capacity;
+    void* mapping = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(mappingSize)) == 0)
+    {
+        mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    auto const error = errno;
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        shm_unlink(shmName.c_str());
+        TLLM_THROW("Failed to map shared memory %s: %s", shmName.c_str(), std::strerror(error));
+    }
+
+    auto* header = new (mapping) Header{};
+    header->capacity = capacity;
+    header->head.store(0, std::memory_order_relaxed);
+    header->tail.store(0, std::memory_order_relaxed);
+    // The magic is the last field set, the other process checks it before using the ring
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = kMagic;
+    return ShmMessageChannel{shmName, mapping, mappingSize, true};
+}
+
+ShmMessageChannel ShmMessageChannel::open(std::string const& name)
+{
+    auto const shmName = getShmName(name);
+    int const fd = shm_open(shmName.c_str(), O_RDWR, 0);
+    TLLM_CHECK_WITH_INFO(fd >= 0, "Failed to open shared memory %s: %s", shmName.c_str(), std::strerror(errno));
+    struct stat st = {};
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) > sizeof(Header))
+    {
+        mapping = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    auto const error = errno;
+    close(fd);
+    TLLM_CHECK_WITH_INFO(
+        mapping != MAP_FAILED, "Failed to map shared memory %s: %s", shmName.c_str(), std::strerror(error));
+
+    ShmMessageChannel channel{shmName, mapping, static_cast<std::size_t>(st.st_size), false};
+    auto const& header = channel.header();
+    TLLM_CHECK_WITH_INFO(header.magic == kMagic && sizeof(Header) + header.capacity == channel.mMappingSize,
+        "Shared memory %s is not an initialized message channel.", shmName.c_str());
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return channel;
+}
+
+ShmMessageChannel::ShmMessageChannel(std::string name, void* mapping, std::size_t mappingSize, bool owner)
+    : mName{std::move(name)}
+    , mMapping{mapping}
+    , mMappingSize{mappingSize}
+    , mOwner{owner}
+{
+}
+
+ShmMessageChannel::ShmMessageChannel(ShmMessageChannel&& other) noexcept
+    : mName{std::move(other.mName)}
+    , mMapping{std::exchange(other.mMapping, nullptr)}
+    , mMappingSize{other.mMappingSize}
+    , mOwner{std::exchange(other.mOwner, false)}
+    , mReserveSkip{other.mReserveSkip}
+    , mPeekSkip{other.mPeekSkip}
+{
+}
+
+ShmMessageChannel& ShmMessageChannel::operator=(ShmMessageChannel&& other) noexcept
+{
+    // The mapping of this channel is released by the destructor of other
+    std::swap(mName, other.mName);
+    std::swap(mMapping, other.mMapping);
+    std::swap(mMappingSize, other.mMappingSize);
+    std::swap(mOwner, other.mOwner);
+    std::swap(mReserveSkip, other.mReserveSkip);
+    std::swap(mPeekSkip, other.mPeekSkip);
+    return *this;
+}
+
+ShmMessageChannel::~ShmMessageChannel()
+{
+    if (mMapping == nullptr)
+    {
+        return;
+    }
+    munmap(mMapping, mMappingSize);
+    if (mOwner)
+    {
+        shm_unlink(mName.c_str());
+    }
+}
+
+std::size_t ShmMessageChannel::getMaxMessageSize() const noexcept
+{
+    // A message that doesn't fit before the end of the ring starts over at the beginning, so a message of up to half
+    // of the ring always fits on one side once the consumer caught up
+    return header().capacity / 2 / kLengthSize * kLengthSize - kLengthSize;
+}
+
+char* ShmMessageChannel::tryReserve(std::size_t size)
+{
+    TLLM_CHECK_WITH_INFO(size <= getMaxMessageSize(), "Message of %zu bytes exceeds the channel maximum of %zu bytes.",
+        size, getMaxMessageSize());
+    auto& hdr = header();
+    auto const capacity = hdr.capacity;
+    auto const tail = hdr.tail.load(std::memory_order_relaxed);
+    auto const used = tail - hdr.head.load(std::memory_order_acquire);
+    auto const offset = tail % capacity;
+    auto const contiguous = capacity - offset;
+    auto const frameSize = getFrameSize(size);
+
+    mReserveSkip = frameSize > contiguous ? contiguous : 0;
+    if (used + mReserveSkip + frameSize > capacity)
+    {
+        return nullptr;
+    }
+    if (mReserveSkip > 0)
+    {
+        std::memcpy(ring() + offset, &kWrapMarker, kLengthSize);
+        return ring() + kLengthSize;
+    }
+    return ring() + offset + kLengthSize;
+}
+
+void ShmMessageChannel::commit(std::size_t size)
+{
+    auto& hdr = header();
+    auto const tail = hdr.tail.load(std::memory_order_relaxed);
+    auto const offset = (tail + mReserveSkip) % hdr.capacity;
+    std::uint64_t const length = size;
+    std::memcpy(ring() + offset, &length, kLengthSize);
+    hdr.tail.store(tail + mReserveSkip + getFrameSize(size), std::memory_order_release);
+}
+
+char* ShmMessageChannel::tryPeek(std::size_t& size)
+{
+    auto& hdr = header();
+    auto const capacity = hdr.capacity;
+    auto const head = hdr.head.load(std::memory_order_relaxed);
+    if (head == hdr.tail.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+    auto offset = head % capacity;
+    std::uint64_t length{0};
+    std::memcpy(&length, ring() + offset, kLengthSize);
+    mPeekSkip = 0;
+    // The producer publishes the wrap marker together with the message after it
+    if (length == kWrapMarker)
+    {
+        mPeekSkip = capacity - offset;
+        offset = 0;
+        std::memcpy(&length, ring(), kLengthSize);
+    }
+    size = length;
+    return ring() + offset + kLengthSize;
+}
+
+void ShmMessageChannel::release(std::size_t size)
+{
+    auto& hdr = header();
+    auto const head = hdr.head.load(std::memory_order_relaxed);
+    hdr.head.store(head + mPeekSkip + getFrameSize(size), std::memory_order_release);
+}
+
+void ShmMessageChannel::checkWritten(bool good, std::size_t written, std::size_t size)
+{
+    TLLM_CHECK_WITH_INFO(good, "Serialization overflowed the message of %zu bytes.", size);
+    TLLM_CHECK_WITH_INFO(written == size, "Serialized %zu bytes into a message of %zu bytes.", written, size);
+}
+
+ShmMessageChannel::Header& ShmMessageChannel::header() const noexcept
+{
+    return *static_cast<Header*>(mMapping);
+}
+
+char* ShmMessageChannel::ring() const noexcept
+{
+    return static_cast<char*>(mMapping) + sizeof(Header);
+}
+
+} // namespace tensorrt_llm::common
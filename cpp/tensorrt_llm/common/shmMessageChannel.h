@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace tensorrt_llm::common
+{
+
+//! \brief Stream buffer over a fixed memory range, to serialize into or deserialize from memory in place.
+class SpanStreamBuf : public std::streambuf
+{
+public:
+    SpanStreamBuf(char* data, std::size_t size)
+    {
+        setg(data, data, data + size);
+        setp(data, data + size);
+    }
+
+    //! \returns Bytes written so far.
+    [[nodiscard]] std::size_t written() const noexcept
+    {
+        return static_cast<std::size_t>(pptr() - pbase());
+    }
+};
+
+//! \brief Single producer single consumer channel of variable size messages between two processes of the same host,
+//! through a ring in POSIX shared memory.
+//! \details Messages are serialized directly into the ring and deserialized from it, without intermediate buffers.
+//! Writing and reading never block: the producer retries or batches more items when the ring is full, the consumer
+//! polls. A message can hold any number of items, e.g. all the requests enqueued since the last message, so that the
+//! per-message synchronization is paid once per batch. The creator owns the shared memory and unlinks it on
+//! destruction.
+class ShmMessageChannel
+{
+public:
+    //! \brief Creates the shared memory of the channel.
+    //! \param capacity Bytes of the ring, rounded up to a multiple of 8. Messages are up to about half of it.
+    static ShmMessageChannel create(std::string const& name, std::size_t capacity);
+
+    //! \brief Opens the channel created by the other process.
+    static ShmMessageChannel open(std::string const& name);
+
+    ShmMessageChannel(ShmMessageChannel const&) = delete;
+    ShmMessageChannel& operator=(ShmMessageChannel const&) = delete;
+    ShmMessageChannel(ShmMessageChannel&& other) noexcept;
+    ShmMessageChannel& operator=(ShmMessageChannel&& other) noexcept;
+    ~ShmMessageChannel();
+
+    //! \brief Producer side. Writes a message of exactly size bytes with serialize(std::ostream&).
+    //! \returns False, without calling serialize, if the ring has no room for the message yet.
+    template <typename Serialize>
+    [[nodiscard]] bool tryWrite(std::size_t size, Serialize&& serialize)
+    {
+        auto* data = tryReserve(size);
+        if (data == nullptr)
+        {
+            return false;
+        }
+        SpanStreamBuf buf{data, size};
+        std::ostream os{&buf};
+        serialize(os);
+        checkWritten(os.good(), buf.written(), size);
+        commit(size);
+        return true;
+    }
+
+    //! \brief Consumer side. Reads the next message with deserialize(std::istream&).
+    //! \returns False if there is no message.
+    template <typename Deserialize>
+    [[nodiscard]] bool tryRead(Deserialize&& deserialize)
+    {
+        std::size_t size{0};
+        auto* data = tryPeek(size);
+        if (data == nullptr)
+        {
+            return false;
+        }
+        SpanStreamBuf buf{data, size};
+        std::istream is{&buf};
+        deserialize(is);
+        release(size);
+        return true;
+    }
+
+    //! \returns The largest message the ring can hold.
+    [[nodiscard]] std::size_t getMaxMessageSize() const noexcept;
+
+private:
+    struct Header;
+
+    ShmMessageChannel(std::string name, void* mapping, std::size_t mappingSize, bool owner);
+
+    char* tryReserve(std::size_t size);
+    void commit(std::size_t size);
+    char* tryPeek(std::size_t& size);
+    void release(std::size_t size);
+    static void checkWritten(bool good, std::size_t written, std::size_t size);
+
+    [[nodiscard]] Header& header() const noexcept;
+    [[nodiscard]] char* ring() const noexcept;
+
+    std::string mName;
+    void* mMapping;
+    std::size_t mMappingSize;
+    bool mOwner;
+    // Padding skipped before the reserved and the peeked message when they wrap around the end of the ring
+    std::size_t mReserveSkip{0};
+    std::size_t mPeekSkip{0};
+};
+
+} // namespace tensorrt_llm::common
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace tensorrt_llm::common
+{
+
+//! \brief Bounded lock-free queue for exactly one producer thread and one consumer thread.
+//! \details Slots are allocated once, so pushing and popping never allocate nor block. Meant to hand items such as
+//! streamed responses from the executor thread to a frontend thread without a mutex or a condition variable; the
+//! consumer decides how to wait (spin, poll from its own event loop, ...).
+template <typename T>
+class SpscRingBuffer
+{
+public:
+    //! \param capacity Maximum number of queued items, rounded up to a power of two.
+    explicit SpscRingBuffer(std::size_t capacity)
+        : mCapacity{roundUpToPowerOfTwo(capacity)}
+        , mMask{mCapacity - 1}
+        , mSlots{std::make_unique<std::optional<T>[]>(mCapacity)}
+    {
+        TLLM_CHECK_WITH_INFO(capacity > 0, "SpscRingBuffer capacity must be positive.");
+    }
+
+    SpscRingBuffer(SpscRingBuffer const&) = delete;
+    SpscRingBuffer& operator=(SpscRingBuffer const&) = delete;
+
+    //! \brief Producer side. Returns false, leaving item untouched, if the queue is full.
+    template <typename U>
+    [[nodiscard]] bool tryPush(U&& item)
+    {
+        auto const tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mCachedHead == mCapacity)
+        {
+            mCachedHead = mHead.load(std::memory_order_acquire);
+            if (tail - mCachedHead == mCapacity)
+            {
+                return false;
+            }
+        }
+        mSlots[tail & mMask].emplace(std::forward<U>(item));
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! \brief Consumer side. Returns std::nullopt if the queue is empty.
+    [[nodiscard]] std::optional<T> tryPop()
+    {
+        auto const head = mHead.load(std::memory_order_relaxed);
+        if (head == mCachedTail)
+        {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (head == mCachedTail)
+            {
+                return std::nullopt;
+            }
+        }
+        auto& slot = mSlots[head & mMask];
+        std::optional<T> item{std::move(slot)};
+        slot.reset();
+        mHead.store(head + 1, std::memory_order_release);
+        return item;
+    }
+
+    //! \brief Approximate number of queued items, exact when called from the producer or consumer thread.
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept
+    {
+        return mCapacity;
+    }
+
+private:
+    static constexpr std::size_t kCacheLineSize = 64;
+
+    [[nodiscard]] static std::size_t roundUpToPowerOfTwo(std::size_t value) noexcept
+    {
+        std::size_t result{1};
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    std::size_t const mCapacity;
+    std::size_t const mMask;
+    std::unique_ptr<std::optional<T>[]> mSlots;
+
+    // Head and tail are written by different threads, keep them on separate cache lines together with the copy of
+    // the other index that each side caches to avoid reading the shared one on every call.
+    alignas(kCacheLineSize) std::atomic<std::size_t> mHead{0};
+    std::size_t mCachedTail{0};
+    alignas(kCacheLineSize) std::atomic<std::size_t> mTail{0};
+    std::size_t mCachedHead{0};
+};
+
+} // namespace tensorrt_llm::common
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/warmStartCache.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace tensorrt_llm::common
+{
+
+WarmStartCache& WarmStartCache::getInstance()
+{
+    static WarmStartCache instance{[]() -> std::optional<fs::path>
+        {
+            auto const cacheDir = getEnvWarmStartCacheDir();
+            if (!cacheDir)
+            {
+                return std::nullopt;
+            }
+            return fs::path{*cacheDir};
+        }()};
+    return instance;
+}
+
+WarmStartCache::WarmStartCache(std::optional<fs::path> cacheDir)
+    : mCacheDir{std::move(cacheDir)}
+{
+    if (mCacheDir)
+    {
+        TLLM_LOG_INFO("Using warm-start cache in %s", mCacheDir->c_str());
+    }
+}
+
+void WarmStartCache::setEngineHash(std::uint64_t engineHash)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEngineHash = engineHash;
+}
+
+std::uint64_t WarmStartCache::getEngineHash() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEngineHash;
+}
+
+std::uint64_t WarmStartCache::hash(void const* data, std::size_t size, std::uint64_t seed)
+{
+    auto const* bytes = static_cast<std::uint8_t const*>(data);
+    auto result = seed;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        result ^= bytes[i];
+        result *= 0x100000001b3ULL;
+    }
+    return result;
+}
+
+fs::path WarmStartCache::getEntryPath(KeyType const& key) const
+{
+    char engineDir[17];
+    std::snprintf(engineDir, sizeof(engineDir), "%016" PRIx64, getEngineHash());
+    return *mCacheDir / engineDir / (key + ".bin");
+}
+
+std::optional<WarmStartCache::ValueType> WarmStartCache::load(KeyType const& key) const
+{
+    if (!isEnabled())
+    {
+        return std::nullopt;
+    }
+    auto const path = getEntryPath(key);
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    if (!file)
+    {
+        return std::nullopt;
+    }
+    ValueType value(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(value.data()), static_cast<std::streamsize>(value.size())))
+    {
+        TLLM_LOG_WARNING("Failed to read warm-start cache entry %s", path.c_str());
+        return std::nullopt;
+    }
+    TLLM_LOG_DEBUG("Loaded warm-start cache entry %s", path.c_str());
+    return value;
+}
+
+void WarmStartCache::store(KeyType const& key, void const* data, std::size_t size) const
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    auto const path = getEntryPath(key);
+    std::error_code error;
+    fs::create_directories(path.parent_path(), error);
+    if (error)
+    {
+        TLLM_LOG_WARNING("Failed to create warm-start cache directory %s: %s", path.parent_path().c_str(),
+            error.message().c_str());
+        return;
+    }
+    auto tmpPath = path;
+    tmpPath += ".tmp" + std::to_string(::getpid());
+    {
+        std::ofstream file{tmpPath, std::ios::binary | std::ios::trunc};
+        if (!file.write(static_cast<char const*>(data), static_cast<std::streamsize>(size)))
+        {
+            TLLM_LOG_WARNING("Failed to write warm-start cache entry %s", tmpPath.c_str());
+            fs::remove(tmpPath, error);
+            return;
+        }
+    }
+    fs::rename(tmpPath, path, error);
+    if (error)
+    {
+        TLLM_LOG_WARNING("Failed to store warm-start cache entry %s: %s", path.c_str(), error.message().c_str());
+        fs::remove(tmpPath, error);
+    }
+}
+
+} // namespace tensorrt_llm::common
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm::common
+{
+
+//! \brief On-disk cache of state that is expensive to recompute when a process restarts with the same engine, such as
+//! XQA JIT cubins and GEMM plugin tactics.
+//! \details Entries are files in a directory per engine hash, so a rebuilt engine starts from an empty cache. Entries
+//! are written to a temporary file and renamed, so replicas sharing the directory never read a partial entry. The
+//! cache is best effort: I/O errors are logged and treated as misses.
+class WarmStartCache
+{
+public:
+    using KeyType = std::string;
+    using ValueType = std::vector<std::uint8_t>;
+
+    //! \brief Process wide cache in the directory given by TRTLLM_WARM_START_CACHE_DIR, disabled if unset.
+    static WarmStartCache& getInstance();
+
+    explicit WarmStartCache(std::optional<std::filesystem::path> cacheDir);
+
+    [[nodiscard]] bool isEnabled() const noexcept
+    {
+        return mCacheDir.has_value();
+    }
+
+    //! \brief Select the entries of an engine, set by the runtime before the engine is deserialized.
+    void setEngineHash(std::uint64_t engineHash);
+
+    [[nodiscard]] std::uint64_t getEngineHash() const;
+
+    [[nodiscard]] std::optional<ValueType> load(KeyType const& key) const;
+
+    void store(KeyType const& key, void const* data, std::size_t size) const;
+
+    //! \brief FNV-1a hash, to derive keys and engine hashes from binary data.
+    [[nodiscard]] static std::uint64_t hash(void const* data, std::size_t size, std::uint64_t seed = kHASH_SEED);
+
+    static std::uint64_t constexpr kHASH_SEED = 0xcbf29ce484222325ULL;
+
+private:
+    [[nodiscard]] std::filesystem::path getEntryPath(KeyType const& key) const;
+
+    std::optional<std::filesystem::path> mCacheDir;
+    mutable std::mutex mMutex;
+    std::uint64_t mEngineHash{0};
+};
+
+} // namespace tensorrt_llm::common
@@ -165,12 +165,16 @@ private:
     ScaleTileIterator iterator_alpha_col_;
     OutputTileIterator iterator_C_;
     OutputTileIterator iterator_D_;
+    // Reads back the output written by the previous partition of serial split-K
+    OutputTileIterator iterator_partial_;
 
     AlphaScaleElementType element_alpha_row_ = 1.0f;
     AlphaScaleElementType element_alpha_col_ = 1.0f;
     typename ScaleTileIterator::Fragment fragment_alpha_col_;
     typename OutputTileIterator::Fragment fragment_C_;
     typename OutputTileIterator::Fragment fragment_D_;
+    typename OutputTileIterator::Fragment fragment_partial_;
+    bool accumulate_partial_ = false;
 
     ElementAccumulator beta_;
 
@@ -199,6 +203,7 @@ public:
         , iterator_alpha_col_(params_alpha_col, ptr_alpha_col, problem_size, thread_idx, threadblock_offset)
         , iterator_C_(params_C, ptr_C, problem_size, thread_idx, threadblock_offset)
         , iterator_D_(params_D, ptr_D, problem_size, thread_idx, threadblock_offset)
+        , iterator_partial_(params_D, ptr_D, problem_size, thread_idx, threadblock_offset)
         , extent_real_(problem_size_real)
     {
         beta_ = (params.elementwise.beta_ptr ? *params.elementwise.beta_ptr : params.elementwise.beta);
@@ -224,6 +229,8 @@ public:
     void set_k_partition(int split_k_index, ///< Index of this threadblock within split-K partitioned scheme
         int split_k_slices)
     {                                       ///< Total number of split-K slices
+        // The scales are linear, so every partition scales its own accumulators and adds the previous partial output
+        accumulate_partial_ = split_k_index > 0;
     }
 
     /// Called to set the batch index
@@ -252,6 +259,12 @@ public:
         fragment_D_.clear();
         fragment_C_.clear();
 
+        if (accumulate_partial_)
+        {
+            iterator_partial_.load(fragment_partial_);
+            ++iterator_partial_;
+        }
+
         if (elementwise_.kScale != cutlass::epilogue::thread::ScaleType::OnlyAlphaScaling)
         {
             iterator_C_.load(fragment_C_);
@@ -292,6 +305,18 @@ public:
             result = per_token_scale_accumulator_(result, element_alpha_col_, element_alpha_row_);
         }
 
+        if (accumulate_partial_)
+        {
+            NumericArrayConverter<ElementCompute, ElementOutput, kElementsPerAccess> partial_converter;
+            ComputeFragment const partial
+                = partial_converter(reinterpret_cast<OutputVector const*>(&fragment_partial_)[frag_idx]);
+            CUTLASS_PRAGMA_UNROLL
+            for (int i = 0; i < ComputeFragment::kElements; ++i)
+            {
+                result[i] += partial[i];
+            }
+        }
+
         // Convert to the output
         NumericArrayConverter<ElementOutput, ElementCompute, kElementsPerAccess> output_converter;
         OutputVector& output = reinterpret_cast<OutputVector*>(&fragment_D_)[frag_idx];
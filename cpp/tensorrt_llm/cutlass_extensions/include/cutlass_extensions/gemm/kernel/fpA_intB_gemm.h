@@ -134,6 +134,9 @@ struct GemmFpAIntB
         // Included so we can use Gemm Universal
         int batch_stride_D = 0;
 
+        // Optional per column scale of A [k], applied in the mainloop when Mma::kSupportsActScale
+        ElementA const* ptr_act_scale = nullptr;
+
         //
         // Methods
         //
@@ -192,6 +195,7 @@ struct GemmFpAIntB
         int const* gather_A_indices;
         int const* gather_B_indices;
         int const* scatter_D_indices;
+        ElementA const* ptr_act_scale;
 
         //
         // Methods
@@ -202,6 +206,7 @@ struct GemmFpAIntB
             : swizzle_log_tile(0)
             , semaphore(0)
             , gemm_k_size(0)
+            , ptr_act_scale(nullptr)
         {
         }
 
@@ -229,6 +234,7 @@ struct GemmFpAIntB
             , gather_A_indices(args.gather_A_indices)
             , gather_B_indices(args.gather_B_indices)
             , scatter_D_indices(args.scatter_D_indices)
+            , ptr_act_scale(args.ptr_act_scale)
         {
         }
     };
@@ -322,6 +328,19 @@ struct GemmFpAIntB
             }
         }
 
+        if (args.ptr_act_scale != nullptr)
+        {
+            if (!Mma::kSupportsActScale)
+            {
+                return Status::kErrorNotSupported;
+            }
+            // Pairs of columns are loaded at once
+            if (reinterpret_cast<uintptr_t>(args.ptr_act_scale) % (2 * sizeof(ElementA)))
+            {
+                return Status::kErrorMisalignedOperand;
+            }
+        }
+
         if constexpr (isFinegrained(Mma::QuantOp))
         {
             if (args.group_size != 64 && args.group_size != 128)
@@ -428,6 +447,14 @@ struct GemmFpAIntB
         // Construct thread-scoped matrix multiply
         Mma mma(shared_storage.main_loop, params.group_size, thread_idx, warp_idx, lane_idx);
 
+        if constexpr (Mma::kSupportsActScale)
+        {
+            if (params.ptr_act_scale != nullptr)
+            {
+                mma.set_act_scale(params.ptr_act_scale + tb_offset_A.column(), problem_size_k - tb_offset_A.column());
+            }
+        }
+
         typename Mma::FragmentC accumulators;
 
         accumulators.clear();
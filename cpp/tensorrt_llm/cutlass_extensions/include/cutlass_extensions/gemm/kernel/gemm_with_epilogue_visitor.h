@@ -204,6 +204,8 @@ public:
         GemmUniversalMode mode;
         int batch_count;
         int gemm_k_size;
+        // One lock per output tile, serializing the partitions of serial split-K (kGemm mode with batch_count > 1)
+        int* semaphore;
 
         void* ptr_A;
         void* ptr_B;
@@ -232,6 +234,7 @@ public:
             , params_D(0)
             , batch_count(0)
             , gemm_k_size(0)
+            , semaphore(nullptr)
             , mode(cutlass::gemm::GemmUniversalMode::kGemm)
             , ptr_A(nullptr)
             , ptr_B(nullptr)
@@ -257,6 +260,7 @@ public:
             , mode(args.mode)
             , batch_count(args.batch_count)
             , gemm_k_size(args.problem_size.k())
+            , semaphore(workspace_)
             , ptr_A(args.ref_A.data())
             , ptr_B(args.ref_B.data())
             , quant_option(args.quant_option)
@@ -518,6 +522,9 @@ public:
             params.params_D, params.quant_option, params.ptr_alpha_row, params.ptr_alpha_col, params.ptr_C,
             params.ptr_D, threadblock_offset, blockIdx.y * params.problem_size.m());
 
+        bool const serial_split_k = params.mode == GemmUniversalMode::kGemm && params.grid_tiled_shape.k() > 1;
+        Semaphore semaphore(params.semaphore + block_idx, thread_idx);
+
         if (params.mode == GemmUniversalMode::kGemm)
         {
             // Indicate which position in a serial reduction the output operator is currently updating
@@ -528,11 +535,26 @@ public:
             epilogue_visitor.set_batch_index(threadblock_tile_offset.k());
         }
 
+        if (serial_split_k)
+        {
+            // Wait for the previous partition to finish writing the partial output of this tile
+            semaphore.fetch();
+            semaphore.wait(threadblock_tile_offset.k());
+        }
+
         // Construct the epilogue
         Epilogue epilogue(shared_storage.epilogue.epilogue, thread_idx, warp_idx, lane_idx);
 
         // Execute the epilogue operator to update the destination tensor.
         epilogue(epilogue_visitor, accumulators);
+
+        if (serial_split_k)
+        {
+            // The last partition resets the lock for the next launch
+            int const lock
+                = params.grid_tiled_shape.k() == threadblock_tile_offset.k() + 1 ? 0 : threadblock_tile_offset.k() + 1;
+            semaphore.release(lock);
+        }
     }
 
     template <typename CompilationArch>
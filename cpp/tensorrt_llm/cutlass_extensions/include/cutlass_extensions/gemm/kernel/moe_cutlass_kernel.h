@@ -69,7 +69,8 @@ template <typename Mma_,          ///! Threadblock-scoped matrix multiply-accumu
     typename ThreadblockSwizzle_, ///! Threadblock swizzling function
     typename KernelArch, ///! The Architecture this kernel is compiled for. Used since SIMT kernels lose top-level
                          /// arch.
-    GroupScheduleMode GroupScheduleMode_ ///! Type of scheduling to perform
+    GroupScheduleMode GroupScheduleMode_, ///! Type of scheduling to perform
+    typename GatedActivation_ = void      ///! Gate activation of a gated FC1, void for a plain GEMM
     >
 struct MoeFCGemm
 {
@@ -81,6 +82,12 @@ public:
     static GroupScheduleMode const kGroupScheduleMode = GroupScheduleMode_;
     static bool const kTransposed = false;
 
+    // A gated GEMM reads [gemm_k, 2 * gemm_n] weights, the linear half followed by the gate half, and writes
+    // linear * act(gate) as a [rows, gemm_n] output. Both halves of a tile are computed by the same threadblock, so the
+    // [rows, 2 * gemm_n] intermediate never goes to global memory. The epilogue must not add a bias.
+    using GatedActivation = GatedActivation_;
+    static bool const kGated = !platform::is_same<GatedActivation, void>::value;
+
     // Optional transpose
     using MapArguments = kernel::detail::MapArguments<typename Mma::IteratorA::Element, typename Mma::IteratorA::Layout,
         Mma::kTransformA, Mma::IteratorA::AccessType::kElements, typename Mma::IteratorB::Element,
@@ -152,6 +159,10 @@ public:
         // Only used by device-level operator
         GemmCoord* host_problem_sizes;
 
+        // Range of rows an expert must have to be computed by this launch, see BaseMoeProblemVisitor::Params
+        int64_t min_problem_rows;
+        int64_t max_problem_rows;
+
         //
         // Methods
         //
@@ -170,6 +181,8 @@ public:
             , gemm_n(0)
             , gemm_k(0)
             , host_problem_sizes(nullptr)
+            , min_problem_rows(0)
+            , max_problem_rows(-1)
         {
         }
 
@@ -192,6 +205,8 @@ public:
             , gemm_n(gemm_n)
             , gemm_k(gemm_k)
             , host_problem_sizes(nullptr)
+            , min_problem_rows(0)
+            , max_problem_rows(-1)
         {
             if (platform::is_same<uint8_t, ElementB>::value || platform::is_same<uint4b_t, ElementB>::value)
             {
@@ -236,8 +251,8 @@ public:
 
         CUTLASS_HOST_DEVICE
         Params(Arguments const& args, void* workspace = nullptr, int tile_count = 0)
-            : problem_visitor(
-                args.total_rows_before_expert, args.gemm_n, args.gemm_k, args.problem_count, workspace, tile_count)
+            : problem_visitor(args.total_rows_before_expert, args.gemm_n, args.gemm_k, args.problem_count, workspace,
+                tile_count, args.min_problem_rows, args.max_problem_rows)
             , threadblock_count(args.threadblock_count)
             , group_size(args.group_size)
             , output_op(args.output_op)
@@ -253,8 +268,8 @@ public:
         void update(Arguments const& args, void* workspace = nullptr, int tile_count = 0)
         {
 
-            problem_visitor = typename ProblemVisitor::Params(
-                args.total_rows_before_expert, args.gemm_n, args.gemm_k, args.problem_count, workspace, tile_count);
+            problem_visitor = typename ProblemVisitor::Params(args.total_rows_before_expert, args.gemm_n, args.gemm_k,
+                args.problem_count, workspace, tile_count, args.min_problem_rows, args.max_problem_rows);
             threadblock_count = args.threadblock_count;
             output_op = args.output_op;
             ptr_A = args.ptr_A;
@@ -348,7 +363,9 @@ public:
 
         const int64_t gemm_k = params.problem_visitor.gemm_k;
         const int64_t gemm_n = params.problem_visitor.gemm_n;
-        int64_t bytes_per_expert_matrix = (gemm_k * gemm_n / 8) * cutlass::sizeof_bits<ElementB>::value;
+        // Columns of the weights and scales, both halves of a gated GEMM
+        const int64_t weight_n = kGated ? 2 * gemm_n : gemm_n;
+        int64_t bytes_per_expert_matrix = (gemm_k * weight_n / 8) * cutlass::sizeof_bits<ElementB>::value;
 
         // Outer 'persistent' loop to iterate over tiles
         int loop = 0;
@@ -372,9 +389,8 @@ public:
             typename LayoutA::LongIndex ldm_A = gemm_k;
 
             char* byte_ptr_B = ((char*) params.ptr_B) + problem_idx * bytes_per_expert_matrix;
-            ElementB* ptr_B = reinterpret_cast<ElementB*>(byte_ptr_B);
             typename LayoutB::LongIndex ldm_B
-                = platform::is_same<layout::RowMajor, LayoutB>::value ? gemm_n : gemm_k * kInterleave;
+                = platform::is_same<layout::RowMajor, LayoutB>::value ? weight_n : gemm_k * kInterleave;
 
             // Compute initial location in logical coordinates
             cutlass::MatrixCoord tb_offset_A{
@@ -389,17 +405,6 @@ public:
             // Compute position within threadblock
             int thread_idx = threadIdx.x;
 
-            // Construct iterators to A and B operands
-            typename Mma::IteratorA iterator_A(
-                LayoutA(ldm_A), ptr_A, {problem_size.m(), problem_size.k()}, thread_idx, tb_offset_A);
-
-            typename Mma::IteratorB iterator_B(LayoutB(ldm_B), ptr_B,
-                {problem_size.k() * kInterleave, problem_size.n() / kInterleave}, thread_idx, tb_offset_B);
-
-            typename Mma::FragmentC accumulators;
-
-            accumulators.clear();
-
             // Broadcast the warp_id computed by lane 0 to ensure dependent code
             // is compiled as warp-uniform.
             int warp_idx = __shfl_sync(0xffffffff, threadIdx.x / 32, 0);
@@ -418,28 +423,63 @@ public:
                 else
                     return Mma(shared_storage.main_loop, thread_idx, warp_idx, lane_idx);
             };
-            Mma mma = CreateMMA();
 
             // Compute threadblock-scoped matrix multiply-add
             int gemm_k_iterations = (problem_size.k() + Mma::Shape::kK - 1) / Mma::Shape::kK;
 
-            // Wait for all threads to finish their epilogue phases from the previous tile.
-            __syncthreads();
+            // Computes the tile from the weight columns starting at column_offset
+            auto RunMainloop = [&](typename Mma::FragmentC& accumulators, int64_t column_offset)
+            {
+                // Construct iterators to A and B operands
+                typename Mma::IteratorA iterator_A(
+                    LayoutA(ldm_A), ptr_A, {problem_size.m(), problem_size.k()}, thread_idx, tb_offset_A);
 
-            // Compute threadblock-scoped matrix multiply-add
-            ElementScale* weight_scale_ptr = params.weight_scales + problem_idx * problem_size.n();
+                int64_t const column_offset_elems = platform::is_same<layout::RowMajor, LayoutB>::value
+                    ? column_offset
+                    : (column_offset / kInterleave) * ldm_B;
+                ElementB* ptr_B = reinterpret_cast<ElementB*>(
+                    byte_ptr_B + column_offset_elems * cutlass::sizeof_bits<ElementB>::value / 8);
+                typename Mma::IteratorB iterator_B(LayoutB(ldm_B), ptr_B,
+                    {problem_size.k() * kInterleave, problem_size.n() / kInterleave}, thread_idx, tb_offset_B);
 
-            if constexpr (use_dq_gemm<Mma>::value)
-            {
-                const MatrixCoord scale_extent = {1, problem_size.n()};
-                typename Mma::IteratorScale iterator_scale(Mma::IteratorScale::Layout(scale_extent.column()),
-                    weight_scale_ptr, scale_extent, thread_idx, tb_offset_scale);
+                accumulators.clear();
 
-                mma(gemm_k_iterations, accumulators, iterator_A, iterator_B, iterator_scale, accumulators);
-            }
-            else
+                Mma mma = CreateMMA();
+
+                // Wait for all threads to finish their epilogue or mainloop phases from the previous tile.
+                __syncthreads();
+
+                if constexpr (use_dq_gemm<Mma>::value)
+                {
+                    ElementScale* weight_scale_ptr = params.weight_scales + problem_idx * weight_n + column_offset;
+                    const MatrixCoord scale_extent = {1, problem_size.n()};
+                    typename Mma::IteratorScale iterator_scale(Mma::IteratorScale::Layout(scale_extent.column()),
+                        weight_scale_ptr, scale_extent, thread_idx, tb_offset_scale);
+
+                    mma(gemm_k_iterations, accumulators, iterator_A, iterator_B, iterator_scale, accumulators);
+                }
+                else
+                {
+                    mma(gemm_k_iterations, accumulators, iterator_A, iterator_B, accumulators);
+                }
+            };
+
+            typename Mma::FragmentC accumulators;
+            RunMainloop(accumulators, 0);
+
+            if constexpr (kGated)
             {
-                mma(gemm_k_iterations, accumulators, iterator_A, iterator_B, accumulators);
+                typename Mma::FragmentC gate_accumulators;
+                RunMainloop(gate_accumulators, gemm_n);
+
+                // Both halves share the thread to element mapping, so the activation is applied element-wise
+                GatedActivation act;
+                CUTLASS_PRAGMA_UNROLL
+                for (int i = 0; i < Mma::FragmentC::kElements; ++i)
+                {
+                    accumulators[i] = static_cast<typename Mma::FragmentC::Element>(
+                        static_cast<float>(accumulators[i]) * act(static_cast<float>(gate_accumulators[i])));
+                }
             }
 
             //
@@ -69,6 +69,11 @@ struct BaseMoeProblemVisitor
         int32_t problem_count;
         void const* workspace;
         int32_t tile_count;
+        // Problems whose row count lies outside [min_problem_rows, max_problem_rows] are skipped, a negative
+        // max_problem_rows meaning no upper bound. This lets several launches with different tile shapes split the
+        // experts of one grouped GEMM by load.
+        int64_t min_problem_rows;
+        int64_t max_problem_rows;
 
         //
         // Methods
@@ -83,19 +88,24 @@ struct BaseMoeProblemVisitor
             , problem_count(0)
             , workspace(nullptr)
             , tile_count(0)
+            , min_problem_rows(0)
+            , max_problem_rows(-1)
         {
         }
 
         /// Ctor
         CUTLASS_HOST_DEVICE
         Params(int64_t const* last_row_for_problem, int64_t gemm_n, int64_t gemm_k, int32_t problem_count,
-            void const* workspace = nullptr, int32_t tile_count = 0)
+            void const* workspace = nullptr, int32_t tile_count = 0, int64_t min_problem_rows = 0,
+            int64_t max_problem_rows = -1)
             : last_row_for_problem(last_row_for_problem)
             , gemm_n(gemm_n)
             , gemm_k(gemm_k)
             , problem_count(problem_count)
             , workspace(workspace)
             , tile_count(tile_count)
+            , min_problem_rows(min_problem_rows)
+            , max_problem_rows(max_problem_rows)
         {
         }
     };
@@ -170,7 +180,12 @@ struct BaseMoeProblemVisitor
     {
         const int64_t prev_problem_row = idx == 0 ? 0 : params.last_row_for_problem[idx - 1];
         const int64_t current_problem_row = params.last_row_for_problem[idx];
-        const int64_t gemm_m = current_problem_row - prev_problem_row;
+        int64_t gemm_m = current_problem_row - prev_problem_row;
+        if (gemm_m < params.min_problem_rows || (params.max_problem_rows >= 0 && gemm_m > params.max_problem_rows))
+        {
+            // Owned by another launch, an empty problem has no tiles to visit
+            gemm_m = 0;
+        }
         GemmCoord problem(GemmCoord::Index(gemm_m), GemmCoord::Index(params.gemm_n), GemmCoord::Index(params.gemm_k));
         ProblemSizeHelper::possibly_transpose_problem(problem);
         return problem;
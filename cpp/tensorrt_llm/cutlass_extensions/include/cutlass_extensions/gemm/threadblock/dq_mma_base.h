@@ -137,6 +137,9 @@ public:
     /// Number of stages
     static int const kStages = Stages;
 
+    /// Whether the mainloop can scale the A operand per column, see set_act_scale of the fine grained multistage mma
+    static constexpr bool kSupportsActScale = false;
+
     /// Tensor reference to the A operand
     using TensorRefA = TensorRef<typename Operator::ElementA, typename Operator::LayoutA>;
 
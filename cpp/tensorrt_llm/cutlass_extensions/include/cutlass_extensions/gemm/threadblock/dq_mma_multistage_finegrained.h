@@ -158,6 +158,11 @@ public:
     static_assert(Base::SharedStorage::ShapeScale::kRow == Stages, "");
     static_assert(Base::SharedStorage::ShapeScale::kColumn == Shape::kN, "");
 
+    /// The columns of A held by a thread follow the register layout of the 16-bit mma.sync with K = 16, so a per
+    /// column scale of A (the AWQ pre-quant scale) can be applied to the warp fragments once loaded from shared memory.
+    static constexpr bool kSupportsActScale
+        = sizeof_bits<typename IteratorA::Element>::value == 16 && Operator::Policy::MmaShape::kK == 16;
+
     /// Internal structure exposed for introspection.
     struct Detail
     {
@@ -212,6 +217,17 @@ private:
     /// Iterator to write threadblock-scoped tile of scale and zero operand to shared memory
     SmemIteratorScale smem_iterator_scale_;
 
+    /// Per column scale of A starting at the K offset of the threadblock, or null
+    ElementA const* act_scale_ = nullptr;
+
+    /// Number of valid columns of act_scale_
+    int act_scale_extent_ = 0;
+
+    /// First column of a warp fragment of A held by this thread, relative to the threadblock tile
+    int act_scale_offset_ = 0;
+
+    using ActScaleFragment = Array<ElementA, 4>;
+
 public:
     /// Construct from tensor references
     CUTLASS_DEVICE
@@ -250,6 +266,50 @@ public:
         // Add per-warp offsets in units of warp-level tiles
         this->warp_tile_iterator_A_.add_tile_offset({warp_idx_m, Base::kWarpGemmIterations * warp_idx_k});
         this->warp_tile_iterator_B_.add_tile_offset({Base::kWarpGemmIterationsForB * warp_idx_k, warp_idx_n});
+
+        act_scale_offset_
+            = Base::kWarpGemmIterations * warp_idx_k * Operator::Policy::MmaShape::kK + (lane_idx % 4) * 2;
+    }
+
+    /// Scales the columns of A by act_scale [extent], which starts at the K offset of the threadblock. extent must be
+    /// a multiple of the mma.sync K.
+    CUTLASS_DEVICE
+    void set_act_scale(ElementA const* act_scale, int extent)
+    {
+        static_assert(kSupportsActScale, "The per column scale of A needs 16-bit activations");
+        act_scale_ = act_scale;
+        act_scale_extent_ = extent;
+    }
+
+    /// Loads the scales of the columns k + {0, 1, 8, 9} of the threadblock tile held by this thread, for the warp
+    /// fragment of A starting at column k.
+    CUTLASS_DEVICE
+    void load_act_scale(ActScaleFragment& frag, int k) const
+    {
+        using Pair = Array<ElementA, 2>;
+        int const col = k + act_scale_offset_;
+        if (col < act_scale_extent_)
+        {
+            Pair const* ptr = reinterpret_cast<Pair const*>(act_scale_ + col);
+            reinterpret_cast<Pair*>(&frag)[0] = ptr[0];
+            reinterpret_cast<Pair*>(&frag)[1] = ptr[4];
+        }
+        else
+        {
+            frag.clear();
+        }
+    }
+
+    /// In each mma.sync operand of the fragment, registers {a0, a1} and {a2, a3} hold the first two columns of
+    /// load_act_scale, and {a4, a5} and {a6, a7} the last two.
+    CUTLASS_DEVICE
+    static void apply_act_scale(WarpFragmentA& frag, ActScaleFragment const& scale)
+    {
+        CUTLASS_PRAGMA_UNROLL
+        for (int i = 0; i < WarpFragmentA::kElements; ++i)
+        {
+            frag[i] = frag[i] * scale[(i % 8) / 4 * 2 + i % 2];
+        }
     }
 
     CUTLASS_DEVICE
@@ -545,6 +605,17 @@ public:
         this->warp_tile_iterator_A_.load(warp_frag_A[0]);
         this->warp_tile_iterator_B_.load(warp_frag_B[0]);
 
+        // Scales of the columns of A held in warp_frag_A, and the first column of the tile being read
+        ActScaleFragment warp_frag_act_scale[2];
+        int act_scale_tile_k = 0;
+        if constexpr (kSupportsActScale)
+        {
+            if (act_scale_ != nullptr)
+            {
+                load_act_scale(warp_frag_act_scale[0], 0);
+            }
+        }
+
         warp_dequantizer_.load(warp_frag_scales, warp_frag_zeros);
 
         ++this->warp_tile_iterator_A_;
@@ -582,6 +653,19 @@ public:
                 this->warp_tile_iterator_A_.load(warp_frag_A[(warp_mma_k + 1) % 2]);
                 ++this->warp_tile_iterator_A_;
 
+                if constexpr (kSupportsActScale)
+                {
+                    if (act_scale_ != nullptr)
+                    {
+                        // The last warp fragment of a tile is followed by the first one of the next tile
+                        int const next_k = warp_mma_k + 1 < Base::kWarpGemmIterations
+                            ? act_scale_tile_k + (warp_mma_k + 1) * Operator::Policy::MmaShape::kK
+                            : act_scale_tile_k + Shape::kK;
+                        load_act_scale(warp_frag_act_scale[(warp_mma_k + 1) % 2], next_k);
+                        apply_act_scale(warp_frag_A[warp_mma_k % 2], warp_frag_act_scale[warp_mma_k % 2]);
+                    }
+                }
+
                 int const warp_tileB_k_compute_offset = warp_mma_k % Base::kNumKIterationsPerWarpBLoad;
                 int const warp_tileB_k_load_offset = warp_mma_k / Base::kNumKIterationsPerWarpBLoad;
                 if (warp_tileB_k_compute_offset == Base::kNumKIterationsPerWarpBLoad - 1)
@@ -687,6 +771,8 @@ public:
             warp_dequantizer_.load(warp_frag_scales, warp_frag_zeros);
             // Update internal pointer to set of scales in shared memory.
             warp_dequantizer_.add_pointer_offset(Shape::kN);
+
+            act_scale_tile_k += Shape::kK;
         }
 
         if (SharedMemoryClear == SharedMemoryClearOption::kZfill)
@@ -162,12 +162,161 @@ void invokeBanRepeatNgram(T* logits, TokenIdType const** output_ids_buf, Finishe
     sync_check_cuda_error();
 }
 
+namespace
+{
+//! FNV-1a hash of tokens [0, length)
+__device__ uint32_t hashTokens(TokenIdType const* tokens, SizeType32 length)
+{
+    uint32_t hash{2166136261u};
+    for (SizeType32 idx = 0; idx < length; ++idx)
+    {
+        hash = (hash ^ static_cast<uint32_t>(tokens[idx])) * 16777619u;
+    }
+    return hash;
+}
+
+__device__ bool equalTokens(TokenIdType const* lhs, TokenIdType const* rhs, SizeType32 length)
+{
+    for (SizeType32 idx = 0; idx < length; ++idx)
+    {
+        if (lhs[idx] != rhs[idx])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+__global__ void banRepeatNgramIncremental(T* logits, SizeType32* ngramTables, SizeType32 tableSize,
+    TokenIdType const** outputIds, FinishedState const* finished, SizeType32 const* batchSlots,
+    SizeType32 const* sequenceLengths, SizeType32 const* noRepeatNgramSizes, SizeType32 vocabSizePadded)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = batchSlots != nullptr ? batchSlots[batchIdx] : batchIdx;
+    auto const ngramSize = noRepeatNgramSizes[batchSlot];
+    auto const sequenceLength = sequenceLengths[batchSlot];
+
+    // Same early exits as ban_repeat_ngram, the table catches up on the next step
+    if (ngramSize == 0 || sequenceLength < ngramSize
+        || (finished != nullptr && finished[batchSlot].isFinished()))
+    {
+        return;
+    }
+
+    auto const* tokens = outputIds[batchSlot];
+    auto* requestLogits = logits + static_cast<std::size_t>(batchIdx) * vocabSizePadded;
+    auto const prefixLength = ngramSize - 1;
+    if (prefixLength == 0)
+    {
+        // Every generated token is a banned 1-gram
+        for (auto pos = static_cast<SizeType32>(threadIdx.x); pos < sequenceLength;
+             pos += static_cast<SizeType32>(blockDim.x))
+        {
+            requestLogits[tokens[pos]] = static_cast<T>(-INFINITY);
+        }
+        return;
+    }
+
+    auto* table = ngramTables + static_cast<std::size_t>(batchSlot) * tableSize;
+    auto* entries = table + 1;
+    auto const capacityMask = static_cast<uint32_t>(tableSize - 2);
+    auto const insertedLength = table[0];
+
+    // Insert the n-grams starting at positions [firstStart, sequenceLength - ngramSize]
+    SizeType32 firstStart{0};
+    if (insertedLength < 0 || insertedLength > sequenceLength)
+    {
+        for (auto idx = static_cast<SizeType32>(threadIdx.x); idx < tableSize - 1;
+             idx += static_cast<SizeType32>(blockDim.x))
+        {
+            entries[idx] = -1;
+        }
+        __syncthreads();
+    }
+    else
+    {
+        firstStart = max(insertedLength - ngramSize + 1, 0);
+    }
+    for (auto start = firstStart + static_cast<SizeType32>(threadIdx.x); start <= sequenceLength - ngramSize;
+         start += static_cast<SizeType32>(blockDim.x))
+    {
+        auto bucket = hashTokens(tokens + start, prefixLength) & capacityMask;
+        while (true)
+        {
+            auto const entry = atomicCAS(&entries[bucket], -1, start);
+            // Skip n-grams which are already in the table
+            if (entry == -1 || equalTokens(tokens + entry, tokens + start, ngramSize))
+            {
+                break;
+            }
+            bucket = (bucket + 1) & capacityMask;
+        }
+    }
+    __syncthreads();
+
+    // Ban the next tokens of the n-grams starting with the last ngramSize - 1 tokens
+    if (threadIdx.x == 0)
+    {
+        table[0] = sequenceLength;
+        auto const* lastTokens = tokens + sequenceLength - prefixLength;
+        for (auto bucket = hashTokens(lastTokens, prefixLength) & capacityMask; entries[bucket] >= 0;
+             bucket = (bucket + 1) & capacityMask)
+        {
+            auto const entry = entries[bucket];
+            if (equalTokens(tokens + entry, lastTokens, prefixLength))
+            {
+                requestLogits[tokens[entry + prefixLength]] = static_cast<T>(-INFINITY);
+            }
+        }
+    }
+}
+
+__global__ void resetRepeatNgramTables(
+    SizeType32* ngramTables, SizeType32 tableSize, SizeType32 const* batchSlots, SizeType32 batchSize)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x);
+    if (batchIdx < batchSize)
+    {
+        auto const batchSlot = batchSlots != nullptr ? batchSlots[batchIdx] : batchIdx;
+        ngramTables[static_cast<std::size_t>(batchSlot) * tableSize] = -1;
+    }
+}
+} // namespace
+
+template <typename T>
+void invokeBanRepeatNgramIncremental(T* logits, SizeType32* ngramTables, SizeType32 maxSeqLen,
+    TokenIdType const** outputIds, FinishedState const* finished, SizeType32 const* batchSlots,
+    SizeType32 const* sequenceLengths, SizeType32 batchSize, SizeType32 const* noRepeatNgramSizes,
+    SizeType32 vocabSizePadded, cudaStream_t stream)
+{
+    constexpr SizeType32 blockSize{128};
+    banRepeatNgramIncremental<<<batchSize, blockSize, 0, stream>>>(logits, ngramTables,
+        getRepeatNgramTableSize(maxSeqLen), outputIds, finished, batchSlots, sequenceLengths, noRepeatNgramSizes,
+        vocabSizePadded);
+    sync_check_cuda_error();
+}
+
+void invokeResetRepeatNgramTables(SizeType32* ngramTables, SizeType32 maxSeqLen, SizeType32 const* batchSlots,
+    SizeType32 batchSize, cudaStream_t stream)
+{
+    constexpr SizeType32 blockSize{256};
+    dim3 const grid((batchSize + blockSize - 1) / blockSize);
+    resetRepeatNgramTables<<<grid, blockSize, 0, stream>>>(
+        ngramTables, getRepeatNgramTableSize(maxSeqLen), batchSlots, batchSize);
+    sync_check_cuda_error();
+}
+
 #define INVOKE_BAN_REPEAT_NGRAM(T)                                                                                     \
     template void invokeBanRepeatNgram(T* logits, TokenIdType const** output_ids_buf,                                  \
         const FinishedState* finished_buf, SizeType32 const** parent_ids_buf, SizeType32 const* batch_slot,            \
         SizeType32 const* sequence_lengths, SizeType32 batch_size, SizeType32 beam_width, SizeType32 max_seq_len,      \
         SizeType32 const* no_repeat_ngram_size_buf, SizeType32 vocab_size_padded, SizeType32 max_step,                 \
-        cudaStream_t stream);
+        cudaStream_t stream);                                                                                          \
+    template void invokeBanRepeatNgramIncremental(T* logits, SizeType32* ngramTables, SizeType32 maxSeqLen,            \
+        TokenIdType const** outputIds, FinishedState const* finished, SizeType32 const* batchSlots,                    \
+        SizeType32 const* sequenceLengths, SizeType32 batchSize, SizeType32 const* noRepeatNgramSizes,                 \
+        SizeType32 vocabSizePadded, cudaStream_t stream);
 
 INVOKE_BAN_REPEAT_NGRAM(float)
 INVOKE_BAN_REPEAT_NGRAM(half)
@@ -33,5 +33,38 @@ void invokeBanRepeatNgram(T* logits, runtime::TokenIdType const** output_ids_buf
     runtime::SizeType32 max_seq_len, runtime::SizeType32 const* no_repeat_ngram_size_buf,
     runtime::SizeType32 vocab_size_padded, runtime::SizeType32 max_step, cudaStream_t stream);
 
+//! \brief Number of int32 per batch slot of the n-gram tables of invokeBanRepeatNgramIncremental: the sequence length
+//! up to which n-grams were inserted and an open addressing hash table of n-gram start positions, keyed by the first
+//! ngramSize - 1 tokens of the n-gram.
+[[nodiscard]] constexpr runtime::SizeType32 getRepeatNgramTableSize(runtime::SizeType32 maxSeqLen)
+{
+    // Load factor of at most 0.5
+    runtime::SizeType32 capacity{1};
+    while (capacity < 2 * maxSeqLen)
+    {
+        capacity *= 2;
+    }
+    return 1 + capacity;
+}
+
+//! \brief Same semantics as invokeBanRepeatNgram for beamWidth == 1. The n-grams of every request are kept in a hash
+//! table per batch slot, which is updated with the n-grams ending at the new tokens only. The next tokens of the
+//! n-grams starting with the last ngramSize - 1 tokens are found with a single lookup instead of a scan of the
+//! sequence.
+//!
+//! \param ngramTables input/output buffer [maxBatchSize, getRepeatNgramTableSize(maxSeqLen)]
+//! \param other parameters as in invokeBanRepeatNgram
+template <typename T>
+void invokeBanRepeatNgramIncremental(T* logits, runtime::SizeType32* ngramTables, runtime::SizeType32 maxSeqLen,
+    runtime::TokenIdType const** outputIds, FinishedState const* finished, runtime::SizeType32 const* batchSlots,
+    runtime::SizeType32 const* sequenceLengths, runtime::SizeType32 batchSize,
+    runtime::SizeType32 const* noRepeatNgramSizes, runtime::SizeType32 vocabSizePadded, cudaStream_t stream);
+
+//! \brief Marks the n-gram tables of the given batch slots to be rebuilt from their output ids on the next use.
+//! \param ngramTables [maxBatchSize, getRepeatNgramTableSize(maxSeqLen)]
+//! \param batchSlots [batchSize] on the GPU, optional
+void invokeResetRepeatNgramTables(runtime::SizeType32* ngramTables, runtime::SizeType32 maxSeqLen,
+    runtime::SizeType32 const* batchSlots, runtime::SizeType32 batchSize, cudaStream_t stream);
+
 } // namespace kernels
 } // namespace tensorrt_llm
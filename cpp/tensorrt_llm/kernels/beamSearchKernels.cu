@@ -43,13 +43,17 @@ void invokeTopkSoftMax(T const* logits, T const* bias, void* workspace, BeamHypo
         CASE_K(4)
     case 8:        // 4 < beam_width <= 8
         CASE_K(8)
-#ifndef FAST_BUILD // For fast build, skip case 3, 4, 5
+#ifndef FAST_BUILD // For fast build, skip case 3, 4, 5, 6, 7
     case 16:       // 9 < beam_width <= 16
         CASE_K(16)
     case 32:       // 16 < beam_width <= 32
         CASE_K(32)
     case 64:       // 32 < beam_width <= 64
         CASE_K(64)
+    case 128:      // 64 < beam_width <= 128
+        CASE_K(128)
+    case 256:      // 128 < beam_width <= 256
+        CASE_K(256)
 #endif             // FAST_BUILD
     default:
         throw std::runtime_error(
@@ -21,7 +21,9 @@ namespace tensorrt_llm
 {
 namespace kernels
 {
-static constexpr int nMaxBeamWidth = 64; // max beam width supported now
+static constexpr int nMaxBeamWidth = 256; // max beam width supported now
+// Wider beams select the candidates of the final stage streaming beam by beam instead of in share memory
+static constexpr int nMaxBeamWidthForSmemCandidates = 64;
 static constexpr int nBlockSizeForSmallBeamWidth = 256;
 static constexpr int nMaxVocabPartForStage1FastKernel = 128;
 
@@ -52,6 +54,7 @@ struct BeamHypotheses
     // Pointers from input
     int const* inputLengths{nullptr};   // [BS, BM]         %% context_length
     int const* endIds{nullptr};         // [BS, BM]         %% self.end_ids
+    int const* sequenceLimitLengths{nullptr}; // [BS]   max sequence length per request, optional, MSL if nullptr
 
     // Pointers for output
     int* outputIds{nullptr};            // [BS, BM, MSL]    %% self.output_ids                      only used in gather_tree
@@ -106,6 +109,16 @@ __device__ __forceinline__ T applyLengthPenalty(T const log_prob, int const leng
     return log_prob / static_cast<T>(powf(static_cast<float>(length), length_penalty));
 }
 
+// Count of elements of the workspace of invokeTopkSoftMax, which scales with the used beam width
+__inline__ size_t getTopkSoftMaxWorkspaceSize(int const batchSize, int const beamWidth)
+{
+    int const nPadBeamWidth = padToNextPowerOfTwo(beamWidth);
+    size_t const nTopK = static_cast<size_t>(batchSize) * beamWidth * beamWidth * 2;
+    size_t const nTempBuffer
+        = static_cast<size_t>(batchSize) * beamWidth * nMaxVocabPartForStage1FastKernel * (2 * (nPadBeamWidth * 2) + 2);
+    return (nTopK + 3) / 4 * 4 * 2 + (nTempBuffer + 3) / 4 * 4;
+}
+
 template <typename T>
 void invokeTopkSoftMax(T const* logits, T const* bias, void* workspace, BeamHypotheses& bh, cudaStream_t stream);
 
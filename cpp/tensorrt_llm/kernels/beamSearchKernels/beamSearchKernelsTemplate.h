@@ -42,6 +42,129 @@ namespace kernels
 
 #pragma nv_diag_suppress static_var_with_dynamic_init
 
+// Count of the first n elements of descending sorted `array` whose value is larger than `value` (or equal to it, if
+// `orEqual` is set), used to find the position of an element in the merge of two sorted arrays
+template <typename KVPair, typename T>
+__device__ __forceinline__ int countLarger(KVPair const* array, int const n, T const value, bool const orEqual)
+{
+    int left = 0;
+    int right = n;
+    while (left < right)
+    {
+        int const mid = (left + right) / 2;
+        bool const isLarger = orEqual ? array[mid].value >= value : array[mid].value > value;
+        if (isLarger)
+        {
+            left = mid + 1;
+        }
+        else
+        {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+// Whether `a` goes before `b` in descending order, ties resolved by the smaller key as `cub::ArgMax` does
+template <typename KVPair>
+__device__ __forceinline__ bool isBefore(KVPair const& a, KVPair const& b)
+{
+    return a.value > b.value || (a.value == b.value && a.key < b.key);
+}
+
+// Select the top 2*BM among the BM*BM*2 candidates of a batch without holding all of them in share memory:
+// the 2*BM candidates of each beam are sorted and merged into the running top 2*BM in turn, so the share memory
+// scales with the beam width rather than with its square.
+// Result is written into smemTopKV in descending order, with the same keys and values as the non-streaming path.
+template <typename T, int PAD_2K, int THREADBLOCK_SIZE, typename KVPair>
+__device__ void beamStage3StreamingTopK(T const* __restrict pTempVal, int const nBM, float const diversityRate,
+    bool const bDiversityByBeam, KVPair* smemTopKV)
+{
+    int const tid = threadIdx.x;
+    int const n2BM{2 * nBM};
+    T const MAX_T_VAL = std::is_same_v<T, half> ? HALF_FLT_MAX : FLT_MAX;
+
+    __shared__ KVPair smemBeamKV[PAD_2K];
+    __shared__ KVPair smemMergedKV[PAD_2K];
+
+    for (int beamIdx = 0; beamIdx < nBM; ++beamIdx)
+    {
+        // Load the candidates of this beam, padded to PAD_2K
+        for (int i = tid; i < PAD_2K; i += THREADBLOCK_SIZE)
+        {
+            int const index = beamIdx * n2BM + i;
+            if (i < n2BM)
+            {
+                int const diversityIndex = bDiversityByBeam ? beamIdx : index % nBM;
+                smemBeamKV[i] = {index, pTempVal[index] + static_cast<T>(diversityRate * diversityIndex)};
+            }
+            else
+            {
+                smemBeamKV[i] = {nBM * n2BM - 1, -MAX_T_VAL};
+            }
+        }
+        __syncthreads();
+
+        // Bitonic sort in descending order, ordering ties by key so the result matches the non-streaming path
+        for (int size = 2; size <= PAD_2K; size <<= 1)
+        {
+            for (int stride = size / 2; stride > 0; stride >>= 1)
+            {
+                for (int i = tid; i < PAD_2K; i += THREADBLOCK_SIZE)
+                {
+                    int const j = i ^ stride;
+                    if (j > i)
+                    {
+                        bool const descending = (i & size) == 0;
+                        KVPair const a = smemBeamKV[i];
+                        KVPair const b = smemBeamKV[j];
+                        if (descending ? isBefore(b, a) : isBefore(a, b))
+                        {
+                            smemBeamKV[i] = b;
+                            smemBeamKV[j] = a;
+                        }
+                    }
+                }
+                __syncthreads();
+            }
+        }
+
+        if (beamIdx == 0)
+        {
+            for (int i = tid; i < n2BM; i += THREADBLOCK_SIZE)
+            {
+                smemTopKV[i] = smemBeamKV[i];
+            }
+            __syncthreads();
+            continue;
+        }
+
+        // Merge path: the position of each element in the merged array is its index plus the count of larger
+        // elements in the other array, ties resolved in favor of the running top 2*BM, whose keys are smaller
+        for (int i = tid; i < n2BM; i += THREADBLOCK_SIZE)
+        {
+            KVPair const running = smemTopKV[i];
+            int const runningRank = i + countLarger(smemBeamKV, n2BM, running.value, false);
+            if (runningRank < n2BM)
+            {
+                smemMergedKV[runningRank] = running;
+            }
+            KVPair const candidate = smemBeamKV[i];
+            int const candidateRank = i + countLarger(smemTopKV, n2BM, candidate.value, true);
+            if (candidateRank < n2BM)
+            {
+                smemMergedKV[candidateRank] = candidate;
+            }
+        }
+        __syncthreads();
+        for (int i = tid; i < n2BM; i += THREADBLOCK_SIZE)
+        {
+            smemTopKV[i] = smemMergedKV[i];
+        }
+        __syncthreads();
+    }
+}
+
 template <typename T, int PAD_2K, int THREADBLOCK_SIZE>
 __launch_bounds__(THREADBLOCK_SIZE) __global__
     void beamStage3Kernel(int const* __restrict pTempId, T const* __restrict pTempVal, BeamHypotheses bh)
@@ -97,44 +220,53 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
     pTempVal += bid * nCandidate;
 
     using KVPair = cub::KeyValuePair<int, T>;
-    KVPair topKVPairPartial{nCandidate - 1, -MAX_T_VAL};
-    cub::ArgMax argmax;
-    extern __shared__ char smem[];
-    T* smemVal = reinterpret_cast<T*>(smem);
+    __shared__ KVPair smemTopKV[PAD_2K];
 
-    for (int i = tid; i < nCandidate; i += THREADBLOCK_SIZE)
+    if constexpr (PAD_2K > 2 * nMaxBeamWidthForSmemCandidates)
     {
-        int const index = bh.numBeamsCBA == nullptr ? i % nBM : i / 2 / nBM;
-        T const val = pTempVal[i] + static_cast<T>(diversityRate * index);
-        topKVPairPartial = argmax(topKVPairPartial, {i, val});
-        smemVal[i] = val;
+        beamStage3StreamingTopK<T, PAD_2K, THREADBLOCK_SIZE>(
+            pTempVal, nBM, diversityRate, bh.numBeamsCBA != nullptr, smemTopKV);
     }
-    __syncthreads();
-
-    using BlockReduce = cub::BlockReduce<KVPair, THREADBLOCK_SIZE>;
-    __shared__ typename BlockReduce::TempStorage smemReduceBuffer;
-    __shared__ KVPair smemTopKV[PAD_2K];
-    __shared__ int threadToUpdate;
-
-    for (int i = 0; i < 2 * nBM; ++i)
+    else
     {
-        KVPair topKVPair = BlockReduce(smemReduceBuffer).Reduce(topKVPairPartial, argmax);
-        if (tid == 0)
+        KVPair topKVPairPartial{nCandidate - 1, -MAX_T_VAL};
+        cub::ArgMax argmax;
+        extern __shared__ char smem[];
+        T* smemVal = reinterpret_cast<T*>(smem);
+
+        for (int i = tid; i < nCandidate; i += THREADBLOCK_SIZE)
         {
-            smemTopKV[i] = topKVPair;
-            smemVal[topKVPair.key] = -MAX_T_VAL;
-            threadToUpdate = topKVPair.key % THREADBLOCK_SIZE;
+            int const index = bh.numBeamsCBA == nullptr ? i % nBM : i / 2 / nBM;
+            T const val = pTempVal[i] + static_cast<T>(diversityRate * index);
+            topKVPairPartial = argmax(topKVPairPartial, {i, val});
+            smemVal[i] = val;
         }
         __syncthreads();
-        // Only one thread needs to update the old partial before the next block reduce.
-        // No need to do this in the last iteration.
-        if (tid == threadToUpdate && i < 2 * nBM - 1)
+
+        using BlockReduce = cub::BlockReduce<KVPair, THREADBLOCK_SIZE>;
+        __shared__ typename BlockReduce::TempStorage smemReduceBuffer;
+        __shared__ int threadToUpdate;
+
+        for (int i = 0; i < 2 * nBM; ++i)
         {
-            topKVPairPartial.key = nCandidate - 1;
-            topKVPairPartial.value = -MAX_T_VAL;
-            for (int index = tid; index < nCandidate; index += THREADBLOCK_SIZE)
+            KVPair topKVPair = BlockReduce(smemReduceBuffer).Reduce(topKVPairPartial, argmax);
+            if (tid == 0)
+            {
+                smemTopKV[i] = topKVPair;
+                smemVal[topKVPair.key] = -MAX_T_VAL;
+                threadToUpdate = topKVPair.key % THREADBLOCK_SIZE;
+            }
+            __syncthreads();
+            // Only one thread needs to update the old partial before the next block reduce.
+            // No need to do this in the last iteration.
+            if (tid == threadToUpdate && i < 2 * nBM - 1)
             {
-                topKVPairPartial = argmax(topKVPairPartial, {index, smemVal[index]});
+                topKVPairPartial.key = nCandidate - 1;
+                topKVPairPartial.value = -MAX_T_VAL;
+                for (int index = tid; index < nCandidate; index += THREADBLOCK_SIZE)
+                {
+                    topKVPairPartial = argmax(topKVPairPartial, {index, smemVal[index]});
+                }
             }
         }
     }
@@ -292,7 +424,13 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
             if (earlyStopping != 0 && lengthPenalty > 0.0f)
             {
                 // Specialization for earlyStopping == "never" and lengthPenalty > 0 in HF
-                nSeqLen = bh.nMaxSeqLen - bh.inputLengths[gbid * nBM];
+                // Log probs are not positive, so a live beam scores at most its cum log probs normalized by the
+                // longest length it can still reach. The request stops as soon as this upper bound can not beat the
+                // worst beam in CBA, bounding by the length limit of the request instead of MSL prunes much earlier
+                int const nMaxSeqLen = bh.sequenceLimitLengths != nullptr
+                    ? min(bh.sequenceLimitLengths[gbid], bh.nMaxSeqLen)
+                    : bh.nMaxSeqLen;
+                nSeqLen = nMaxSeqLen - bh.inputLengths[gbid * nBM];
             }
             float const bestAttainableScore = applyLengthPenalty(bestCumLogProbs, nSeqLen, lengthPenalty);
             bh.batchDones[bid] = bh.minNormedScoresCBA[gbid] >= bestAttainableScore;
@@ -870,6 +1008,11 @@ void topKSoftMaxKernelLauncher(T const* logits, T const* bias, void* workspace,
             <<<gridSize, nBlockSize, dyn_smem_size, stream>>>(
                 logits, bias, pTemp, endIds, finished, nBM, nV, nVocabChunk);
     }
+    else if constexpr (PAD_K > nMaxBeamWidthForSmemCandidates)
+    {
+        // The base kernel keeps the top 2K in registers, which does not scale to wide beams
+        TLLM_THROW("Vocab size is too large for split-k TopK beam search with beam width %d.", nBM);
+    }
     else
     {
         // Use stage 1 base kernel, useless branch now
@@ -900,7 +1043,8 @@ void topKSoftMaxKernelLauncher(T const* logits, T const* bias, void* workspace,
     sync_check_cuda_error();
 
     // Keep top 2K candidates in case of k candidates finishes in one iteration
-    size_t const nShareMemory = sizeof(T) * nBM * nBM * 2;
+    // Wide beams select the candidates streaming, without dynamic share memory
+    size_t const nShareMemory = PAD_K > nMaxBeamWidthForSmemCandidates ? 0 : sizeof(T) * nBM * nBM * 2;
     size_t constexpr nBlockSizeStage3 = (PAD_K + 31) / 32 * 32; // can not use `roundUp()`
     if (nShareMemory >= (48 << 10))
     {
@@ -17,6 +17,7 @@
 #include <cuda_runtime_api.h>
 
 #include "buildRelativeAttentionBiasKernel.h"
+#include "tensorrt_llm/kernels/relativeAttentionBucket.cuh"
 
 namespace tensorrt_llm
 {
@@ -29,44 +30,13 @@ template <typename T>
 __global__ void buildRelativeAttentionBias(T* relative_attention_bias, T const* relative_attention_bias_table,
     int const head_num, int const seq_len, int const num_bucket, bool const is_bidirectional, int const max_distance)
 {
-
     int const head_id = blockIdx.x;
+    RelativeAttentionBucketizer const bucketizer(num_bucket, max_distance, is_bidirectional);
     for (int seq_id = threadIdx.x; seq_id < seq_len * seq_len; seq_id += blockDim.x)
     {
-        int row_id = seq_id / seq_len;
-        int col_id = seq_id % seq_len;
-
-        int relative_position = col_id - row_id;
-
-        int relative_buckets = 0;
-        int tmp_num_bucket = num_bucket;
-        if (is_bidirectional)
-        {
-            tmp_num_bucket /= 2;
-            if (relative_position > 0)
-            {
-                relative_buckets += tmp_num_bucket;
-            }
-            else
-            {
-                relative_position *= -1;
-            }
-        }
-        else
-        {
-            relative_position = abs(relative_position);
-        }
-
-        int max_exact = tmp_num_bucket / 2;
-        bool is_small = relative_position < max_exact;
-
-        int relative_position_if_large = max_exact
-            + (int) (logf(relative_position * 1.0f / max_exact) / logf((float) max_distance / max_exact)
-                * (tmp_num_bucket - max_exact));
-
-        relative_position_if_large = min(relative_position_if_large, tmp_num_bucket - 1);
-
-        relative_buckets += is_small ? relative_position : relative_position_if_large;
+        int const row_id = seq_id / seq_len;
+        int const col_id = seq_id % seq_len;
+        int const relative_buckets = bucketizer(col_id - row_id);
 
         relative_attention_bias[head_id * seq_len * seq_len + seq_id]
             = relative_attention_bias_table[head_id * num_bucket + relative_buckets];
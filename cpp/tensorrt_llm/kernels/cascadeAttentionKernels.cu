@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/cascadeAttentionKernels.h"
+
+#include <algorithm>
+#include <cfloat>
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+// Number of (query, head) rows attended by one block.
+constexpr int kRowsPerBlock = 8;
+// Number of KV tokens loaded into shared memory at once.
+constexpr int kTokensPerTile = 8;
+constexpr int kThreadsPerBlock = 128;
+constexpr int kMaxHeadSize = 256;
+
+// Attention of the rows of a block over a range of KV tokens, with the softmax computed online over the tiles of the
+// range. The prefix kernel has one block per group, KV head and tile of rows, each row is a query of the group with a
+// Q head of the KV head, and reads the KV of the group's first request. The suffix kernel has one block per request
+// and KV head, and reads the request's own KV. Writes the normalized output and the log-sum-exp of every row, -inf
+// for an empty range.
+template <typename T, bool PREFIX>
+__global__ void cascadeAttentionPartialKernel(CascadeAttentionParams<T> params, float* out, float* lse)
+{
+    extern __shared__ float smem[];
+    int const headSize = params.head_size;
+    float* sQ = smem;                              // [kRowsPerBlock, headSize]
+    float* sAcc = sQ + kRowsPerBlock * headSize;   // [kRowsPerBlock, headSize]
+    float* sK = sAcc + kRowsPerBlock * headSize;   // [kTokensPerTile, headSize]
+    float* sV = sK + kTokensPerTile * headSize;    // [kTokensPerTile, headSize]
+    float* sP = sV + kTokensPerTile * headSize;    // [kRowsPerBlock, kTokensPerTile]
+    float* sMax = sP + kRowsPerBlock * kTokensPerTile;
+    float* sSum = sMax + kRowsPerBlock;
+    float* sScale = sSum + kRowsPerBlock;
+
+    int const headsPerKvHead = params.num_heads / params.num_kv_heads;
+    int const kvHead = blockIdx.y;
+    int queryBegin, queryEnd, kvBegin, kvEnd;
+    if (PREFIX)
+    {
+        queryBegin = params.group_offsets[blockIdx.x];
+        queryEnd = params.group_offsets[blockIdx.x + 1];
+        kvBegin = 0;
+        kvEnd = queryEnd > queryBegin ? params.prefix_lengths[queryBegin] : 0;
+    }
+    else
+    {
+        queryBegin = blockIdx.x;
+        queryEnd = queryBegin + 1;
+        kvBegin = params.prefix_lengths[queryBegin];
+        kvEnd = params.seq_lengths[queryBegin];
+    }
+    int const rowBegin = blockIdx.z * kRowsPerBlock;
+    int const numRows = min(kRowsPerBlock, (queryEnd - queryBegin) * headsPerKvHead - rowBegin);
+    if (numRows <= 0)
+    {
+        return;
+    }
+    // The prefix blocks of the group are shared, any request of the group can be used to read them.
+    int const cacheSeqIdx = queryBegin;
+
+    auto const rowOffset = [&](int r)
+    {
+        int const row = rowBegin + r;
+        int const query = queryBegin + row / headsPerKvHead;
+        int const head = kvHead * headsPerKvHead + row % headsPerKvHead;
+        return static_cast<size_t>(query) * params.num_heads + head;
+    };
+
+    for (int i = threadIdx.x; i < kRowsPerBlock * headSize; i += blockDim.x)
+    {
+        int const r = i / headSize;
+        sQ[i] = r < numRows ? cuda_cast<float>(params.q[rowOffset(r) * headSize + i % headSize]) * params.qk_scale
+                            : 0.f;
+        sAcc[i] = 0.f;
+    }
+    if (threadIdx.x < kRowsPerBlock)
+    {
+        sMax[threadIdx.x] = -FLT_MAX;
+        sSum[threadIdx.x] = 0.f;
+    }
+    __syncthreads();
+
+    for (int tileBegin = kvBegin; tileBegin < kvEnd; tileBegin += kTokensPerTile)
+    {
+        int const numTokens = min(kTokensPerTile, kvEnd - tileBegin);
+        for (int i = threadIdx.x; i < kTokensPerTile * headSize; i += blockDim.x)
+        {
+            int const t = i / headSize;
+            float k = 0.f;
+            float v = 0.f;
+            if (t < numTokens)
+            {
+                int const tokenIdx = tileBegin + t;
+                int const localIdx = params.kv_cache.getKVLocalIdx(tokenIdx, kvHead, headSize, i % headSize);
+                k = cuda_cast<float>(
+                    reinterpret_cast<T const*>(params.kv_cache.getKBlockPtr(cacheSeqIdx, tokenIdx))[localIdx]);
+                v = cuda_cast<float>(
+                    reinterpret_cast<T const*>(params.kv_cache.getVBlockPtr(cacheSeqIdx, tokenIdx))[localIdx]);
+            }
+            sK[i] = k;
+            sV[i] = v;
+        }
+        __syncthreads();
+
+        for (int i = threadIdx.x; i < kRowsPerBlock * kTokensPerTile; i += blockDim.x)
+        {
+            int const r = i / kTokensPerTile;
+            int const t = i % kTokensPerTile;
+            float qk = -FLT_MAX;
+            if (r < numRows && t < numTokens)
+            {
+                qk = 0.f;
+                for (int d = 0; d < headSize; ++d)
+                {
+                    qk += sQ[r * headSize + d] * sK[t * headSize + d];
+                }
+            }
+            sP[i] = qk;
+        }
+        __syncthreads();
+
+        if (threadIdx.x < kRowsPerBlock)
+        {
+            int const r = threadIdx.x;
+            float tileMax = sMax[r];
+            for (int t = 0; t < numTokens; ++t)
+            {
+                tileMax = fmaxf(tileMax, sP[r * kTokensPerTile + t]);
+            }
+            float const scale = __expf(sMax[r] - tileMax);
+            float sum = sSum[r] * scale;
+            for (int t = 0; t < kTokensPerTile; ++t)
+            {
+                float const p = t < numTokens ? __expf(sP[r * kTokensPerTile + t] - tileMax) : 0.f;
+                sP[r * kTokensPerTile + t] = p;
+                sum += p;
+            }
+            sMax[r] = tileMax;
+            sSum[r] = sum;
+            sScale[r] = scale;
+        }
+        __syncthreads();
+
+        for (int i = threadIdx.x; i < kRowsPerBlock * headSize; i += blockDim.x)
+        {
+            int const r = i / headSize;
+            int const d = i % headSize;
+            float acc = sAcc[i] * sScale[r];
+            for (int t = 0; t < numTokens; ++t)
+            {
+                acc += sP[r * kTokensPerTile + t] * sV[t * headSize + d];
+            }
+            sAcc[i] = acc;
+        }
+        __syncthreads();
+    }
+
+    for (int i = threadIdx.x; i < numRows * headSize; i += blockDim.x)
+    {
+        int const r = i / headSize;
+        out[rowOffset(r) * headSize + i % headSize] = sSum[r] > 0.f ? sAcc[i] / sSum[r] : 0.f;
+    }
+    if (threadIdx.x < numRows)
+    {
+        int const r = threadIdx.x;
+        lse[rowOffset(r)] = sSum[r] > 0.f ? sMax[r] + __logf(sSum[r]) : -INFINITY;
+    }
+}
+
+// Merges the prefix and suffix attention of every (query, head), one block each.
+template <typename T>
+__global__ void cascadeAttentionMergeKernel(T* out, float const* prefixOut, float const* prefixLse,
+    float const* suffixOut, float const* suffixLse, int headSize)
+{
+    size_t const row = blockIdx.x;
+    float const lseA = prefixLse[row];
+    float const lseB = suffixLse[row];
+    float const maxLse = fmaxf(lseA, lseB);
+    float const wA = lseA == -INFINITY ? 0.f : __expf(lseA - maxLse);
+    float const wB = lseB == -INFINITY ? 0.f : __expf(lseB - maxLse);
+    float const norm = wA + wB;
+    for (int d = threadIdx.x; d < headSize; d += blockDim.x)
+    {
+        size_t const idx = row * headSize + d;
+        float const o = norm > 0.f ? (prefixOut[idx] * wA + suffixOut[idx] * wB) / norm : 0.f;
+        out[idx] = cuda_cast<T>(o);
+    }
+}
+} // namespace
+
+size_t getCascadeAttentionWorkspaceSize(int numQueries, int numHeads, int headSize)
+{
+    // Output and log-sum-exp of both the prefix and the suffix attention.
+    return sizeof(float) * 2 * static_cast<size_t>(numQueries) * numHeads * (headSize + 1);
+}
+
+template <typename T>
+void invokeCascadeAttention(CascadeAttentionParams<T> const& params, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(params.num_heads % params.num_kv_heads == 0,
+        "num_heads (%d) must be a multiple of num_kv_heads (%d).", params.num_heads, params.num_kv_heads);
+    TLLM_CHECK_WITH_INFO(params.head_size <= kMaxHeadSize, "Cascade attention supports head sizes up to %d, got %d.",
+        kMaxHeadSize, params.head_size);
+    if (params.num_queries == 0)
+    {
+        return;
+    }
+
+    size_t const numElems = static_cast<size_t>(params.num_queries) * params.num_heads * params.head_size;
+    size_t const numRows = static_cast<size_t>(params.num_queries) * params.num_heads;
+    auto* prefixOut = static_cast<float*>(params.workspace);
+    auto* suffixOut = prefixOut + numElems;
+    auto* prefixLse = suffixOut + numElems;
+    auto* suffixLse = prefixLse + numRows;
+
+    int const headsPerKvHead = params.num_heads / params.num_kv_heads;
+    size_t const smemSize = sizeof(float)
+        * (2 * (kRowsPerBlock + kTokensPerTile) * params.head_size + kRowsPerBlock * kTokensPerTile
+            + 3 * kRowsPerBlock);
+
+    dim3 const prefixGrid(
+        params.num_groups, params.num_kv_heads, divUp(params.max_group_size * headsPerKvHead, kRowsPerBlock));
+    cascadeAttentionPartialKernel<T, true>
+        <<<prefixGrid, kThreadsPerBlock, smemSize, stream>>>(params, prefixOut, prefixLse);
+
+    dim3 const suffixGrid(params.num_queries, params.num_kv_heads, divUp(headsPerKvHead, kRowsPerBlock));
+    cascadeAttentionPartialKernel<T, false>
+        <<<suffixGrid, kThreadsPerBlock, smemSize, stream>>>(params, suffixOut, suffixLse);
+
+    cascadeAttentionMergeKernel<T><<<numRows, std::min(params.head_size, kThreadsPerBlock), 0, stream>>>(
+        params.out, prefixOut, prefixLse, suffixOut, suffixLse, params.head_size);
+    sync_check_cuda_error();
+}
+
+template void invokeCascadeAttention<float>(CascadeAttentionParams<float> const& params, cudaStream_t stream);
+template void invokeCascadeAttention<half>(CascadeAttentionParams<half> const& params, cudaStream_t stream);
+#ifdef ENABLE_BF16
+template void invokeCascadeAttention<__nv_bfloat16>(
+    CascadeAttentionParams<__nv_bfloat16> const& params, cudaStream_t stream);
+#endif
+
+} // namespace kernels
+} // namespace tensorrt_llm
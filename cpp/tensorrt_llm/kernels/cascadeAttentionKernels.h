@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/kernels/kvCacheUtils.h"
+
+#include <cuda_runtime_api.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+// Cascade (shared-prefix) attention for the generation phase of requests that share the leading blocks of their paged
+// KV cache, e.g. a common system prompt obtained through block reuse. The attention over the shared prefix is computed
+// once per group of requests and KV head, for the queries of all requests of the group, so the prefix KV is read once
+// per group instead of once per request. The attention over the remaining tokens of every request (its suffix) is
+// computed separately, and both partial results are merged with their log-sum-exp.
+template <typename T>
+struct CascadeAttentionParams
+{
+    // [num_queries, num_heads, head_size], one token per request with the rotary embedding already applied.
+    T const* q;
+    // [num_queries, num_heads, head_size]
+    T* out;
+    // Paged KV cache of type T, sequence i of the block offsets belongs to query i. The KV of the tokens being
+    // generated must already be written. Cyclic KV caches are not supported.
+    KVBlockArray kv_cache;
+    // [num_groups + 1], the requests [group_offsets[g], group_offsets[g + 1]) share their prefix blocks.
+    int const* group_offsets;
+    // [num_queries], number of KV tokens shared with the other requests of the group, the same within a group.
+    int const* prefix_lengths;
+    // [num_queries], number of KV tokens including the token being generated.
+    int const* seq_lengths;
+    // Partial results, of getCascadeAttentionWorkspaceSize bytes.
+    void* workspace;
+    int num_queries;
+    int num_groups;
+    // Largest number of requests in a group.
+    int max_group_size;
+    int num_heads;
+    int num_kv_heads;
+    int head_size;
+    float qk_scale;
+};
+
+size_t getCascadeAttentionWorkspaceSize(int numQueries, int numHeads, int headSize);
+
+template <typename T>
+void invokeCascadeAttention(CascadeAttentionParams<T> const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
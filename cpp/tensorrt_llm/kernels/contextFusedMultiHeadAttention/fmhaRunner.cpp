@@ -189,7 +189,7 @@ public:
         bool const isSm8x = (sm == kSM_86 || sm == kSM_89);
         bool const isSm80 = (sm == kSM_80);
 
-        // Only warp-specialized FMHA kernels support FP8 on Hopper.
+        // Only warp-specialized FMHA kernels support FP8 on Hopper, Ada runs the FP8 flash attention kernels.
         if (isSm90 && mDataType == DATA_TYPE_E4M3)
         {
             mLaunchParams.flash_attention = true;
@@ -298,7 +298,7 @@ public:
         mLaunchParams.kernel_kv_s = s_kv;
         mLaunchParams.force_unroll = true;
 
-        // only hopper warp-specialized FMHA kernels support FP8.
+        // only hopper warp-specialized FMHA kernels support FP8, Ada runs the ampere-style FP8 flash attention kernels.
         // enable warp-specialization kernels when s > 512, otherwise use ampere-style flash attention kernels.
         if (isSm90 && (mDataType == DATA_TYPE_E4M3 || s_kv > 512))
         {
@@ -322,7 +322,7 @@ public:
                 // can suffer from tile quantization loss therefore use flash attention non-tiled instead
                 mLaunchParams.granular_tiling = false;
             }
-            else if (isSm8x && mParams.d < 256)
+            else if (isSm8x && mHeadSize < 256)
             {
                 // flash attention tiled kernel is faster on Ada and Ampere derivatives when head_size>=256
                 mLaunchParams.granular_tiling = false;
@@ -351,7 +351,8 @@ public:
             mLaunchParams.attention_mask_type = ContextAttentionMaskType::SLIDING_WINDOW_CAUSAL;
         }
 
-        // TODO: add paged kv FP8 FMHA.
+        // FP8 FMHA reads Q and the paged kv cache in fp8, where the kv cache dequantization scales have been applied
+        // to Q (when quantized by the QKV preprocessing) and to the device scale_bmm2 (see scaleBmm2Ptr in run).
         setup_params(
             mPagedKVParams, b, s_q, s_kv, sliding_window_size, total_seqlen, has_alibi, scale_alibi, tp_size, tp_rank);
         mPagedKVParams.q_stride_in_bytes = get_size_in_bytes(mNumHeads * mHeadSize, mDataType);
@@ -658,6 +659,11 @@ public:
         return xmmaKernel->isValid(s);
     }
 
+    bool hasKernels() const
+    {
+        return xmmaKernel->hasKernels();
+    }
+
     int getSFromMaxSeqLen(int const max_seq_len)
     {
         int S = 1024;
@@ -764,6 +770,11 @@ bool FusedMHARunnerV2::isValid(int s) const
     return pimpl->isValid(s);
 }
 
+bool FusedMHARunnerV2::hasKernels() const
+{
+    return pimpl->hasKernels();
+}
+
 // static function to check if fmha is supported when building plugins
 bool MHARunner::fmha_supported(int const headSize, int const sm)
 {
@@ -75,6 +75,9 @@ public:
         = 0;
 
     virtual bool isValid(int s) const = 0;
+
+    // Whether there are kernels for the data type on this GPU, e.g. FP8 kernels are only built for some archs.
+    virtual bool hasKernels() const = 0;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -124,6 +127,8 @@ public:
 
     bool isValid(int s) const override;
 
+    bool hasKernels() const override;
+
 private:
     class mhaImpl;
     std::unique_ptr<mhaImpl> pimpl;
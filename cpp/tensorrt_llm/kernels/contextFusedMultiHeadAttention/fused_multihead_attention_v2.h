@@ -68,6 +68,8 @@ public:
     {
     }
 
+    // Only indexes the kernels of the data type and SM, the cubin of a kernel is loaded on its first launch by
+    // loadFunction. Most of the embedded cubins are for sequence lengths, head sizes and masks an engine never uses.
     void loadXMMAKernels()
     {
         if (!mFunctions.empty())
@@ -80,28 +82,8 @@ public:
             auto const& kernelMeta = mKernelMeta[i];
             if (kernelMeta.mSM == mSM && kernelMeta.mDataType == mDataType)
             {
-                CUmodule hmod{0};
-                auto findModuleIter = mModules.find(kernelMeta.mCubin);
-                if (findModuleIter != mModules.end())
-                {
-                    hmod = findModuleIter->second;
-                }
-                else
-                {
-                    cuErrCheck(mDriver->cuModuleLoadData(&hmod, kernelMeta.mCubin), mDriver);
-                    mModules.insert(std::make_pair(kernelMeta.mCubin, hmod));
-                }
-
                 FusedMultiHeadAttentionKernelInfo funcInfo;
                 funcInfo.mMetaInfoIndex = i;
-                cuErrCheck(
-                    mDriver->cuModuleGetFunction(&funcInfo.mDeviceFunction, hmod, kernelMeta.mFuncName), mDriver);
-                if (kernelMeta.mSharedMemBytes >= 48 * 1024)
-                {
-                    cuErrCheck(mDriver->cuFuncSetAttribute(funcInfo.mDeviceFunction,
-                                   CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, kernelMeta.mSharedMemBytes),
-                        mDriver);
-                }
                 mFunctions.insert(std::make_pair(hashID(kernelMeta), funcInfo));
                 int s = static_cast<int>(kernelMeta.mS);
                 if (mValidSequences.find(s) == mValidSequences.end())
@@ -115,12 +97,18 @@ public:
         return (mValidSequences.find(s) != mValidSequences.end());
     }
 
+    // Whether the build embeds any kernel of the data type and SM
+    bool hasKernels() const
+    {
+        return !mFunctions.empty();
+    }
+
     virtual void run(TKernelParam& params, Launch_params& launch_params, cudaStream_t stream) const
     {
         auto const findIter = mFunctions.find(hashID(params.s, params.d));
 
         auto const& kernelMeta = mKernelMeta[findIter->second.mMetaInfoIndex];
-        const CUfunction func = findIter->second.mDeviceFunction;
+        const CUfunction func = loadFunction(findIter->second);
 
         void* kernelParams[] = {&params, nullptr};
         cuErrCheck(mDriver->cuLaunchKernel(func, params.h, params.b, 1, kernelMeta.mThreadsPerCTA, 1, 1,
@@ -141,21 +129,56 @@ public:
     virtual ~TFusedMultiHeadAttentionXMMAKernel() = default;
 
 protected:
+    struct FusedMultiHeadAttentionKernelInfo
+    {
+        unsigned int mMetaInfoIndex;
+        // Null until the first launch of the kernel
+        CUfunction mDeviceFunction{nullptr};
+    };
+
+    CUfunction loadFunction(FusedMultiHeadAttentionKernelInfo& funcInfo) const
+    {
+        std::lock_guard<std::mutex> lock(mLoadMutex);
+        if (funcInfo.mDeviceFunction != nullptr)
+        {
+            return funcInfo.mDeviceFunction;
+        }
+
+        auto const& kernelMeta = mKernelMeta[funcInfo.mMetaInfoIndex];
+        CUmodule hmod{0};
+        auto findModuleIter = mModules.find(kernelMeta.mCubin);
+        if (findModuleIter != mModules.end())
+        {
+            hmod = findModuleIter->second;
+        }
+        else
+        {
+            cuErrCheck(mDriver->cuModuleLoadData(&hmod, kernelMeta.mCubin), mDriver);
+            mModules.insert(std::make_pair(kernelMeta.mCubin, hmod));
+        }
+
+        CUfunction deviceFunction{nullptr};
+        cuErrCheck(mDriver->cuModuleGetFunction(&deviceFunction, hmod, kernelMeta.mFuncName), mDriver);
+        if (kernelMeta.mSharedMemBytes >= 48 * 1024)
+        {
+            cuErrCheck(mDriver->cuFuncSetAttribute(
+                           deviceFunction, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, kernelMeta.mSharedMemBytes),
+                mDriver);
+        }
+        funcInfo.mDeviceFunction = deviceFunction;
+        return deviceFunction;
+    }
+
     std::shared_ptr<tensorrt_llm::common::CUDADriverWrapper> mDriver;
 
     Data_type mDataType;
     TKernelMeta const* mKernelMeta;
     unsigned int mKernelMetaCount;
     unsigned int mSM;
-    std::unordered_map<unsigned char const*, CUmodule> mModules;
-
-    struct FusedMultiHeadAttentionKernelInfo
-    {
-        unsigned int mMetaInfoIndex;
-        CUfunction mDeviceFunction;
-    };
+    mutable std::unordered_map<unsigned char const*, CUmodule> mModules;
 
-    std::unordered_map<uint64_t, FusedMultiHeadAttentionKernelInfo> mFunctions;
+    mutable std::unordered_map<uint64_t, FusedMultiHeadAttentionKernelInfo> mFunctions;
+    mutable std::mutex mLoadMutex;
     std::set<int> mValidSequences;
 };
 
@@ -261,7 +284,7 @@ public:
             launch_params.paged_kv_input, launch_params.enableQKTanhScale);
 
         auto const& kernelMeta = mKernelMeta[findIter->second.mMetaInfoIndex];
-        const CUfunction func = findIter->second.mDeviceFunction;
+        const CUfunction func = loadFunction(findIter->second);
 
         void* kernelParams[] = {&params, nullptr};
 
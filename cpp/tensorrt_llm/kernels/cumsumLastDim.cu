@@ -27,25 +27,252 @@ namespace kernels
 
 ///////////////
 
+namespace
+{
+
+// Elements of a tile of the single-pass scan
+constexpr int LOOKBACK_THREADS_PER_BLOCK = 256;
+constexpr int LOOKBACK_ITEMS_PER_THREAD = 8;
+constexpr int LOOKBACK_TILE_SIZE = LOOKBACK_THREADS_PER_BLOCK * LOOKBACK_ITEMS_PER_THREAD;
+
+// Rows up to this length are scanned by a warp each
+constexpr int WARP_SCAN_ITEMS_PER_THREAD = 8;
+constexpr int WARP_SCAN_MAX_LENGTH = 32 * WARP_SCAN_ITEMS_PER_THREAD;
+constexpr int WARP_SCAN_WARPS_PER_BLOCK = 4;
+
+// The status of a tile of the single-pass scan packs a flag and the 32-bit value in one word, published atomically
+enum class TileStatus : uint32_t
+{
+    kINVALID = 0,
+    kAGGREGATE = 1,
+    kPREFIX = 2,
+};
+
+// Sums are accumulated in float for the floating point types
 template <typename T>
-size_t invokeComputeCumsumLastDimWorkspaceSize(SizeType32 inputLength)
+struct ScanAccumulator
+{
+    using Type = float;
+};
+
+template <>
+struct ScanAccumulator<int>
+{
+    using Type = int;
+};
+
+__device__ __forceinline__ uint32_t accumulatorBits(float value)
 {
-    T* iodata = nullptr;
-    size_t tempStorageBytes;
-    cub::DeviceScan::InclusiveSum(nullptr, tempStorageBytes, iodata, iodata, inputLength);
-    return tempStorageBytes;
+    return __float_as_uint(value);
 }
 
-#define INSTANTIATE_COMPUTE_CUMSUM_LastDim_WORKSPACE_SIZE_DATA_TYPE(T)                                                 \
-    template size_t invokeComputeCumsumLastDimWorkspaceSize<T>(int inputLength)
+__device__ __forceinline__ uint32_t accumulatorBits(int value)
+{
+    return static_cast<uint32_t>(value);
+}
 
-INSTANTIATE_COMPUTE_CUMSUM_LastDim_WORKSPACE_SIZE_DATA_TYPE(int);
-INSTANTIATE_COMPUTE_CUMSUM_LastDim_WORKSPACE_SIZE_DATA_TYPE(float);
-INSTANTIATE_COMPUTE_CUMSUM_LastDim_WORKSPACE_SIZE_DATA_TYPE(half);
-#ifdef ENABLE_BF16
-INSTANTIATE_COMPUTE_CUMSUM_LastDim_WORKSPACE_SIZE_DATA_TYPE(__nv_bfloat16);
-#endif
-#undef INSTANTIATE_COMPUTE_CUMSUM_LastDim_WORKSPACE_SIZE_DATA_TYPE
+template <typename Acc>
+__device__ __forceinline__ Acc accumulatorFromBits(uint32_t bits);
+
+template <>
+__device__ __forceinline__ float accumulatorFromBits<float>(uint32_t bits)
+{
+    return __uint_as_float(bits);
+}
+
+template <>
+__device__ __forceinline__ int accumulatorFromBits<int>(uint32_t bits)
+{
+    return static_cast<int>(bits);
+}
+
+template <typename Acc>
+__device__ __forceinline__ void publishTileStatus(unsigned long long* status, TileStatus flag, Acc value)
+{
+    atomicExch(status, (static_cast<unsigned long long>(flag) << 32) | accumulatorBits(value));
+}
+
+// Exclusive prefix of the tile, from the statuses of the preceding tiles of the row. Run by a full warp.
+// Each lane watches a predecessor, the window slides back until a tile with its inclusive prefix is found.
+template <typename Acc>
+__device__ Acc lookBack(unsigned long long const* rowStatus, int tileIdx)
+{
+    int const lane = threadIdx.x % 32;
+    Acc exclusive = static_cast<Acc>(0);
+    for (int windowEnd = tileIdx - 1;; windowEnd -= 32)
+    {
+        int const predecessor = windowEnd - lane;
+        // Lanes before the start of the row see a zero prefix
+        unsigned long long word = static_cast<unsigned long long>(TileStatus::kPREFIX) << 32;
+        do
+        {
+            if (predecessor >= 0)
+            {
+                word = *reinterpret_cast<unsigned long long const volatile*>(rowStatus + predecessor);
+            }
+        } while (__any_sync(0xffffffff, static_cast<TileStatus>(word >> 32) == TileStatus::kINVALID));
+        auto const flag = static_cast<TileStatus>(word >> 32);
+        Acc value = accumulatorFromBits<Acc>(static_cast<uint32_t>(word));
+        // The nearest predecessor with its prefix ends the look-back, the lanes beyond it don't contribute
+        unsigned const prefixLanes = __ballot_sync(0xffffffff, flag == TileStatus::kPREFIX);
+        int const lastLane = prefixLanes != 0 ? __ffs(prefixLanes) - 1 : 31;
+        if (lane > lastLane)
+        {
+            value = static_cast<Acc>(0);
+        }
+        for (int offset = 16; offset > 0; offset /= 2)
+        {
+            value += __shfl_xor_sync(0xffffffff, value, offset);
+        }
+        exclusive += value;
+        if (prefixLanes != 0)
+        {
+            return exclusive;
+        }
+    }
+}
+
+} // namespace
+
+size_t getCumsumLastDimWorkspaceSize(SizeType32 batchSize, SizeType32 inputLength)
+{
+    // The status of every tile, then the counter handing out the tiles
+    auto const numTiles = common::divUp(inputLength, LOOKBACK_TILE_SIZE);
+    return (static_cast<size_t>(batchSize) * numTiles + 1) * sizeof(unsigned long long);
+}
+
+///////////////
+
+// Single-pass scan of long rows. A row is split into tiles, one per block, each tile gets its exclusive prefix
+// from the tiles before it by decoupled look-back instead of a separate pass over the row.
+// Blocks take their tile from a counter in the order they start, not from blockIdx: the hardware doesn't schedule
+// blocks in blockIdx order, so a block could otherwise wait for a predecessor that can't become resident.
+template <typename T>
+__global__ void cumsum_last_dim_lookback(
+    T const* d_in, T* d_out, int length, int num_tiles, unsigned long long* tile_status, unsigned int* tile_counter)
+{
+    using Acc = typename ScanAccumulator<T>::Type;
+    typedef cub::BlockLoad<T, LOOKBACK_THREADS_PER_BLOCK, LOOKBACK_ITEMS_PER_THREAD, cub::BLOCK_LOAD_WARP_TRANSPOSE>
+        BlockLoadT;
+    typedef cub::BlockStore<T, LOOKBACK_THREADS_PER_BLOCK, LOOKBACK_ITEMS_PER_THREAD, cub::BLOCK_STORE_WARP_TRANSPOSE>
+        BlockStoreT;
+    typedef cub::BlockScan<Acc, LOOKBACK_THREADS_PER_BLOCK, cub::BLOCK_SCAN_WARP_SCANS> BlockScanT;
+
+    __shared__ union TempStorage
+    {
+        typename BlockLoadT::TempStorage load;
+        typename BlockStoreT::TempStorage store;
+        typename BlockScanT::TempStorage scan;
+    } temp_storage;
+    __shared__ Acc tile_prefix;
+    __shared__ int tile_order;
+
+    if (threadIdx.x == 0)
+    {
+        tile_order = static_cast<int>(atomicAdd(tile_counter, 1U));
+    }
+    __syncthreads();
+    int const tile_idx = tile_order % num_tiles;
+    int const row_idx = tile_order / num_tiles;
+    int const tile_start = tile_idx * LOOKBACK_TILE_SIZE;
+    int const cur_tile_size = min(LOOKBACK_TILE_SIZE, length - tile_start);
+    T const* cur_d_in = d_in + static_cast<size_t>(row_idx) * length + tile_start;
+    T* cur_d_out = d_out + static_cast<size_t>(row_idx) * length + tile_start;
+    unsigned long long* row_status = tile_status + static_cast<size_t>(row_idx) * num_tiles;
+
+    T data[LOOKBACK_ITEMS_PER_THREAD];
+    BlockLoadT(temp_storage.load).Load(cur_d_in, data, cur_tile_size, static_cast<T>(0));
+    Acc acc[LOOKBACK_ITEMS_PER_THREAD];
+#pragma unroll
+    for (int i = 0; i < LOOKBACK_ITEMS_PER_THREAD; ++i)
+    {
+        acc[i] = static_cast<Acc>(data[i]);
+    }
+    __syncthreads();
+
+    Acc aggregate;
+    BlockScanT(temp_storage.scan).InclusiveSum(acc, acc, aggregate);
+
+    if (threadIdx.x < 32)
+    {
+        // The aggregate is published first, so that the successors don't wait for the look-back of this tile
+        if (threadIdx.x == 0)
+        {
+            publishTileStatus(row_status + tile_idx, tile_idx == 0 ? TileStatus::kPREFIX : TileStatus::kAGGREGATE,
+                aggregate);
+        }
+        Acc const exclusive = tile_idx == 0 ? static_cast<Acc>(0) : lookBack<Acc>(row_status, tile_idx);
+        if (threadIdx.x == 0)
+        {
+            if (tile_idx != 0)
+            {
+                publishTileStatus(row_status + tile_idx, TileStatus::kPREFIX, exclusive + aggregate);
+            }
+            tile_prefix = exclusive;
+        }
+    }
+    __syncthreads();
+
+#pragma unroll
+    for (int i = 0; i < LOOKBACK_ITEMS_PER_THREAD; ++i)
+    {
+        data[i] = static_cast<T>(acc[i] + tile_prefix);
+    }
+    BlockStoreT(temp_storage.store).Store(cur_d_out, data, cur_tile_size);
+}
+
+///////////////
+
+// Scan of short rows, a warp per row
+template <typename T, int ITEMS_PER_THREAD>
+__global__ void cumsum_last_dim_warp(T const* d_in, T* d_out, int batch_size, int length)
+{
+    using Acc = typename ScanAccumulator<T>::Type;
+    typedef cub::WarpScan<Acc> WarpScanT;
+
+    __shared__ typename WarpScanT::TempStorage temp_storage[WARP_SCAN_WARPS_PER_BLOCK];
+
+    int const warp_idx = threadIdx.x / 32;
+    int const lane = threadIdx.x % 32;
+    int const row_idx = blockIdx.x * WARP_SCAN_WARPS_PER_BLOCK + warp_idx;
+    if (row_idx >= batch_size)
+    {
+        return;
+    }
+    T const* local_d_in = d_in + static_cast<size_t>(row_idx) * length;
+    T* local_d_out = d_out + static_cast<size_t>(row_idx) * length;
+
+    int constexpr chunk_size = 32 * ITEMS_PER_THREAD;
+    Acc carry = static_cast<Acc>(0);
+    for (int chunk_start = 0; chunk_start < length; chunk_start += chunk_size)
+    {
+        // Each lane scans a run of consecutive items, the warp scans the totals of the runs
+        int const item_start = chunk_start + lane * ITEMS_PER_THREAD;
+        Acc acc[ITEMS_PER_THREAD];
+        Acc running = static_cast<Acc>(0);
+#pragma unroll
+        for (int i = 0; i < ITEMS_PER_THREAD; ++i)
+        {
+            int const idx = item_start + i;
+            running += idx < length ? static_cast<Acc>(local_d_in[idx]) : static_cast<Acc>(0);
+            acc[i] = running;
+        }
+        Acc lane_prefix;
+        Acc chunk_total;
+        WarpScanT(temp_storage[warp_idx]).ExclusiveSum(running, lane_prefix, chunk_total);
+        lane_prefix += carry;
+#pragma unroll
+        for (int i = 0; i < ITEMS_PER_THREAD; ++i)
+        {
+            int const idx = item_start + i;
+            if (idx < length)
+            {
+                local_d_out[idx] = static_cast<T>(acc[i] + lane_prefix);
+            }
+        }
+        carry += chunk_total;
+    }
+}
 
 ///////////////
 
@@ -96,44 +323,38 @@ __global__ void cumsum_last_dim(T const* d_in, T* d_out, int length)
 
 ///////////////
 
-template <typename T>
-void invokeDeviceScan(SizeType32 batchSize, SizeType32 inputLength, void const* __restrict__ input,
-    void* __restrict__ output, void* d_temp_storage, size_t tempStorageBytes, cudaStream_t stream)
-{
-    for (SizeType32 i = 0; i < batchSize; i++)
-    {
-        T const* inputPtr = reinterpret_cast<T const*>(input) + i * inputLength;
-        T* outputPtr = reinterpret_cast<T*>(output) + i * inputLength;
-        cub::DeviceScan::InclusiveSum(d_temp_storage, tempStorageBytes, inputPtr, outputPtr, inputLength, stream);
-    }
-}
-
-///////////////
-
 template <typename T>
 void invokeCumsumLastDim(SizeType32 batchSize, SizeType32 inputLength, void const* __restrict__ input,
-    void* __restrict__ output, void* deviceTempStorage, size_t tempStorageBytes, cudaStream_t stream)
+    void* __restrict__ output, void* workspace, size_t workspaceBytes, cudaStream_t stream)
 {
+    T const* inputPtr = reinterpret_cast<T const*>(input);
+    T* outputPtr = reinterpret_cast<T*>(output);
 
-    if (deviceTempStorage != nullptr) // we need to use DeviceScan
+    if (inputLength <= WARP_SCAN_MAX_LENGTH)
     {
-        invokeDeviceScan<T>(batchSize, inputLength, input, output, deviceTempStorage, tempStorageBytes, stream);
+        int const TPB = 32 * WARP_SCAN_WARPS_PER_BLOCK;
+        int const grid = common::divUp(batchSize, WARP_SCAN_WARPS_PER_BLOCK);
+        cumsum_last_dim_warp<T, WARP_SCAN_ITEMS_PER_THREAD>
+            <<<grid, TPB, 0, stream>>>(inputPtr, outputPtr, batchSize, inputLength);
         return;
     }
 
-    T const* inputPtr = reinterpret_cast<T const*>(input);
-    T* outputPtr = reinterpret_cast<T*>(output);
-
-    // Launch the kernel
-    if (inputLength <= 64)
+    // A block per row leaves most SMs idle when the rows are long and few, their tiles are spread over the SMs then
+    auto const numTiles = common::divUp(inputLength, LOOKBACK_TILE_SIZE);
+    auto const statusBytes = getCumsumLastDimWorkspaceSize(batchSize, inputLength);
+    if (numTiles > 1 && workspace != nullptr && workspaceBytes >= statusBytes
+        && batchSize < common::getMultiProcessorCount())
     {
-        int const ITP = 1;
-        int const TPB = 32;
-        const size_t SHMEM = sizeof(T) * TPB * ITP;
-        const cub::BlockScanAlgorithm ALG = cub::BLOCK_SCAN_WARP_SCANS;
-        cumsum_last_dim<T, TPB, ITP, ALG><<<batchSize, TPB, SHMEM, stream>>>(inputPtr, outputPtr, inputLength);
+        // The statuses and the tile counter are reset by one memset
+        auto* tileStatus = static_cast<unsigned long long*>(workspace);
+        auto* tileCounter = reinterpret_cast<unsigned int*>(tileStatus + static_cast<size_t>(batchSize) * numTiles);
+        TLLM_CUDA_CHECK(cudaMemsetAsync(tileStatus, 0, statusBytes, stream));
+        cumsum_last_dim_lookback<T><<<numTiles * batchSize, LOOKBACK_THREADS_PER_BLOCK, 0, stream>>>(
+            inputPtr, outputPtr, inputLength, numTiles, tileStatus, tileCounter);
+        return;
     }
-    else if (inputLength < 512)
+
+    if (inputLength < 512)
     {
         int const ITP = 2;
         int const TPB = 64;
@@ -141,7 +362,7 @@ void invokeCumsumLastDim(SizeType32 batchSize, SizeType32 inputLength, void cons
         const cub::BlockScanAlgorithm ALG = cub::BLOCK_SCAN_WARP_SCANS;
         cumsum_last_dim<T, TPB, ITP, ALG><<<batchSize, TPB, SHMEM, stream>>>(inputPtr, outputPtr, inputLength);
     }
-    else // if ()
+    else
     {
         int const ITP = 8;
         int const TPB = 256;
@@ -153,7 +374,7 @@ void invokeCumsumLastDim(SizeType32 batchSize, SizeType32 inputLength, void cons
 
 #define INSTANTIATE_CUMSUM_LastDim_DATA_TYPE(T)                                                                        \
     template void invokeCumsumLastDim<T>(SizeType32 batchSize, SizeType32 inputLength, const void* __restrict__ input, \
-        void* __restrict__ output, void* workspace, size_t tempStorageBytes, cudaStream_t stream)
+        void* __restrict__ output, void* workspace, size_t workspaceBytes, cudaStream_t stream)
 
 INSTANTIATE_CUMSUM_LastDim_DATA_TYPE(int);
 INSTANTIATE_CUMSUM_LastDim_DATA_TYPE(float);
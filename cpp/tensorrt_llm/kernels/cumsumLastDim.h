@@ -26,12 +26,17 @@ namespace kernels
 {
 using SizeType32 = tensorrt_llm::runtime::SizeType32;
 
-template <typename T>
-size_t invokeComputeCumsumLastDimWorkspaceSize(SizeType32 inputLength);
+//! \brief Bytes of the workspace for the single-pass scan of batchSize rows of inputLength: the status of each tile
+//! and the counter that hands the tiles out to the blocks in launch order.
+size_t getCumsumLastDimWorkspaceSize(SizeType32 batchSize, SizeType32 inputLength);
 
+//! \brief Inclusive sum of each row of [batchSize, inputLength].
+//! \details Short rows are scanned by a warp each and the other rows by a block each, in a single launch. Long rows
+//! of a small batch are split in tiles scanned in a single pass with decoupled look-back, if the workspace of
+//! getCumsumLastDimWorkspaceSize is given.
 template <typename T>
 void invokeCumsumLastDim(SizeType32 batchSize, SizeType32 inputLength, void const* __restrict__ input,
-    void* __restrict__ output, void* workspace, size_t tempStorageBytes, cudaStream_t stream);
+    void* __restrict__ output, void* workspace, size_t workspaceBytes, cudaStream_t stream);
 
 } // namespace kernels
 } // namespace tensorrt_llm
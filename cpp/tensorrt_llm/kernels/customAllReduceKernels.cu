@@ -17,7 +17,11 @@
 #include "customAllReduceKernels.h"
 #include "tensorrt_llm/common/cudaBf16Fallbacks.cuh"
 #include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/customAllReduceUtils.h"
 #include "tensorrt_llm/common/dataType.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
 #include <tuple>
 #include <type_traits>
 
@@ -252,7 +256,43 @@ inline __device__ int4 rms_norm(float denom, PackedStruct& vec, PackedStruct& we
     return ret.packed;
 }
 
-template <typename T, bool Bias = false, bool Residual = false, bool Affine = false, bool UseSmem = false>
+// Writes the normed values in OutT, the type of the all reduce or a quantized type scaled by quant_scale
+template <typename T, bool Affine, typename OutT, typename PackedStruct>
+inline __device__ void store_rms_norm(
+    OutT* out, float denom, PackedStruct& vec, PackedStruct& weight, float quant_scale)
+{
+    if constexpr (std::is_same_v<OutT, T>)
+    {
+        *reinterpret_cast<int4*>(out) = rms_norm<T, Affine>(denom, vec, weight);
+    }
+    else
+    {
+        static constexpr int kLoopNum = sizeof(PackedStruct) / sizeof(T);
+        struct alignas(kLoopNum * sizeof(OutT)) QuantPacked
+        {
+            OutT unpacked[kLoopNum];
+        } ret;
+#pragma unroll
+        for (int i = 0; i < kLoopNum; ++i)
+        {
+            float v = __fdividef(static_cast<float>(reinterpret_cast<T*>(vec.unpacked)[i]), denom);
+            if constexpr (Affine)
+            {
+                v *= static_cast<float>(reinterpret_cast<T*>(weight.unpacked)[i]);
+            }
+            ret.unpacked[i] = cuda_cast<OutT>(v * quant_scale);
+        }
+        *reinterpret_cast<QuantPacked*>(out) = ret;
+    }
+}
+
+inline __device__ float load_quant_scale(AllReduceParams const& params)
+{
+    return params.fusion_params.quant_scale != nullptr ? *params.fusion_params.quant_scale : 1.f;
+}
+
+template <typename T, bool Bias = false, bool Residual = false, bool Affine = false, bool UseSmem = false,
+    typename OutT = T>
 __global__ void rms_norm_kernel(AllReduceParams params)
 {
     static constexpr int kPackedSize = details::kBytesPerAccess / sizeof(T);
@@ -266,8 +306,9 @@ __global__ void rms_norm_kernel(AllReduceParams params)
     T const* bias_buffer = reinterpret_cast<T const*>(params.fusion_params.bias_buffer);
     T const* residual_buffer = reinterpret_cast<T const*>(params.fusion_params.residual_buffer);
     T const* weight_buffer = reinterpret_cast<T const*>(params.fusion_params.weight_buffer);
-    T* local_final_output_buffer = reinterpret_cast<T*>(params.local_output_buffer_ptr);
+    OutT* local_final_output_buffer = reinterpret_cast<OutT*>(params.local_output_buffer_ptr);
     T* intermediate_buffer = reinterpret_cast<T*>(params.fusion_params.intermediate_buffer);
+    float const quant_scale = load_quant_scale(params);
 
     int block_offset = bid * params.fusion_params.hidden_size;
     int thread_offset = tid * kPackedSize;
@@ -315,12 +356,11 @@ __global__ void rms_norm_kernel(AllReduceParams params)
         {
             weight_vec.packed = *reinterpret_cast<int4 const*>(weight_buffer + offset);
         }
-        inter_vec.packed = rms_norm<T, Affine>(denom, inter_vec, weight_vec);
-        *reinterpret_cast<int4*>(&local_final_output_buffer[offset]) = inter_vec.packed;
+        store_rms_norm<T, Affine>(&local_final_output_buffer[offset], denom, inter_vec, weight_vec, quant_scale);
     }
 }
 
-template <typename T, bool Bias = false, bool Residual = false, bool Affine = false>
+template <typename T, bool Bias = false, bool Residual = false, bool Affine = false, typename OutT = T>
 void rms_norm_kernel_launcher(AllReduceParams params, cudaStream_t stream)
 {
     static constexpr int kPackedSize = details::kBytesPerAccess / sizeof(T);
@@ -340,15 +380,16 @@ void rms_norm_kernel_launcher(AllReduceParams params, cudaStream_t stream)
     if (cta_size * details::kBytesPerAccess / sizeof(T) < params.fusion_params.hidden_size)
     {
         smem_size = params.fusion_params.hidden_size * sizeof(T);
-        rms_norm_kernel<T, Bias, Residual, Affine, true><<<cta_num, cta_size, smem_size, stream>>>(params);
+        rms_norm_kernel<T, Bias, Residual, Affine, true, OutT><<<cta_num, cta_size, smem_size, stream>>>(params);
     }
     else
     {
-        rms_norm_kernel<T, Bias, Residual, Affine, false><<<cta_num, cta_size, smem_size, stream>>>(params);
+        rms_norm_kernel<T, Bias, Residual, Affine, false, OutT><<<cta_num, cta_size, smem_size, stream>>>(params);
     }
 }
 
-template <typename T, int RanksPerNode, bool Bias = false, bool Affine = false, bool UseSmem = false>
+template <typename T, int RanksPerNode, bool Bias = false, bool Affine = false, bool UseSmem = false,
+    typename OutT = T>
 static __global__ void __launch_bounds__(1024, 1) one_shot_all_reduce_norm_kernel(AllReduceParams params)
 {
     static constexpr int kPackedSize = details::kBytesPerAccess / sizeof(T);
@@ -367,8 +408,9 @@ static __global__ void __launch_bounds__(1024, 1) one_shot_all_reduce_norm_kerne
     T const* residual_buffer = reinterpret_cast<T const*>(params.fusion_params.residual_buffer);
     T const* weight_buffer = reinterpret_cast<T const*>(params.fusion_params.weight_buffer);
     T* local_shared_buffer = reinterpret_cast<T*>(params.peer_comm_buffer_ptrs[params.local_rank]);
-    T* local_final_output_buffer = reinterpret_cast<T*>(params.local_output_buffer_ptr);
+    OutT* local_final_output_buffer = reinterpret_cast<OutT*>(params.local_output_buffer_ptr);
     T* intermediate_buffer = reinterpret_cast<T*>(params.fusion_params.intermediate_buffer);
+    float const quant_scale = load_quant_scale(params);
 
     int block_offset = bid * norm_per_block * params.fusion_params.hidden_size;
     int thread_offset = tid * kPackedSize;
@@ -442,13 +484,13 @@ static __global__ void __launch_bounds__(1024, 1) one_shot_all_reduce_norm_kerne
             {
                 weight_vec.packed = *reinterpret_cast<int4 const*>(weight_buffer + offset);
             }
-            sum_vec.packed = rms_norm<T, Affine>(denom, sum_vec, weight_vec);
-            *reinterpret_cast<int4*>(&local_final_output_buffer[norm_offset + offset]) = sum_vec.packed;
+            store_rms_norm<T, Affine>(
+                &local_final_output_buffer[norm_offset + offset], denom, sum_vec, weight_vec, quant_scale);
         }
     }
 }
 
-template <typename T, int RanksPerNode, bool Bias, bool Affine>
+template <typename T, int RanksPerNode, bool Bias, bool Affine, typename OutT = T>
 void one_shot_all_reduce_norm_kernel_launcher(AllReduceParams params, cudaStream_t stream)
 {
     static constexpr int kPackedSize = details::kBytesPerAccess / sizeof(T);
@@ -469,12 +511,12 @@ void one_shot_all_reduce_norm_kernel_launcher(AllReduceParams params, cudaStream
     if (cta_size * kPackedSize < params.fusion_params.hidden_size)
     {
         smem_size = params.fusion_params.hidden_size * sizeof(T);
-        one_shot_all_reduce_norm_kernel<T, RanksPerNode, Bias, Affine, true>
+        one_shot_all_reduce_norm_kernel<T, RanksPerNode, Bias, Affine, true, OutT>
             <<<cta_num, cta_size, smem_size, stream>>>(params);
     }
     else
     {
-        one_shot_all_reduce_norm_kernel<T, RanksPerNode, Bias, Affine, false>
+        one_shot_all_reduce_norm_kernel<T, RanksPerNode, Bias, Affine, false, OutT>
             <<<cta_num, cta_size, smem_size, stream>>>(params);
     }
 }
@@ -797,14 +839,371 @@ static __global__ void twoShotAllReduceKernel(AllReduceParams params)
     }
 }
 
+template <typename T, int RANKS_PER_NODE, bool STANDALONE = false>
+static __global__ void reduceScatterKernel(AllReduceParams params)
+{
+    // First half of twoShotAllReduceKernel, for the hierarchical all reduce:
+    // 1. Each block copies the chunks it is responsible for from local_input to the shareable buffer
+    // 2. The blocks of the same id on the node wait for each other (block_barrier on barrier_ptrs_in)
+    // 3. Each block sums its chunk of the local_rank part of the message over the node, into local_output
+    // A STANDALONE reduce scatter, of the reduce scatter plugin, writes the sum to local_output holding only the part
+    int const bidx = blockIdx.x;
+    int const tidx = threadIdx.x;
+    int const grid_size = gridDim.x;
+
+    static constexpr int PACKED_ELTS = 16 / sizeof(T);
+    using PackedType = typename PackedOn16Bytes<T>::Type;
+
+    T const* local_input_buffer = reinterpret_cast<T const*>(params.local_input_buffer_ptr);
+    T* local_shared_buffer = reinterpret_cast<T*>(params.peer_comm_buffer_ptrs[params.local_rank]);
+    T* local_output_buffer = reinterpret_cast<T*>(params.local_output_buffer_ptr);
+
+    size_t const chunk_start = bidx * params.elts_per_block + tidx * PACKED_ELTS;
+    size_t const chunk_end = min(chunk_start + params.elts_per_block, params.elts_per_rank);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+#pragma unroll
+        for (int ii = 0; ii < RANKS_PER_NODE; ++ii)
+        {
+            size_t const offset_rank = ii * params.elts_per_rank + local_offset;
+            *reinterpret_cast<int4*>(&local_shared_buffer[offset_rank])
+                = *reinterpret_cast<int4 const*>(&local_input_buffer[offset_rank]);
+        }
+    }
+    block_barrier(
+        params.peer_barrier_ptrs_in, params.barrier_flag, params.local_rank, RANKS_PER_NODE, tidx, bidx, grid_size);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+        size_t const responsible_block_offset = local_offset + params.rank_offset;
+
+        PackedType vals[RANKS_PER_NODE];
+#pragma unroll
+        for (int ii = 0; ii < RANKS_PER_NODE; ++ii)
+        {
+            vals[ii].packed = *reinterpret_cast<int4 const*>(
+                &reinterpret_cast<T const*>(params.peer_comm_buffer_ptrs[ii])[responsible_block_offset]);
+        }
+
+        // Always reduce from rank 0 to ensure stable reduce order.
+        PackedType sums;
+        sums.packed = {0, 0, 0, 0};
+#pragma unroll
+        for (int ii = 0; ii < RANKS_PER_NODE; ++ii)
+        {
+            sums.packed = add128b(sums, vals[ii]);
+        }
+        size_t const output_offset = STANDALONE ? local_offset : responsible_block_offset;
+        *reinterpret_cast<int4*>(&local_output_buffer[output_offset]) = sums.packed;
+    }
+}
+
+template <typename T, int RANKS_PER_NODE, bool STANDALONE = false>
+static __global__ void allGatherKernel(AllReduceParams params)
+{
+    // Second half of twoShotAllReduceKernel, for the hierarchical all reduce:
+    // 1. Each block copies its chunk of the local_rank part of local_output to the shareable buffer
+    // 2. The blocks of the same id on the node wait for each other (block_barrier on barrier_ptrs_out)
+    // 3. Each block gathers its chunk of the parts of the other ranks into local_output
+    // A STANDALONE all gather, of the all gather plugin, copies the part from local_input holding only the part, and
+    // gathers the own part into local_output too
+    int const bidx = blockIdx.x;
+    int const tidx = threadIdx.x;
+    int const grid_size = gridDim.x;
+
+    static constexpr int PACKED_ELTS = 16 / sizeof(T);
+
+    T* local_shared_buffer = reinterpret_cast<T*>(params.peer_comm_buffer_ptrs[params.local_rank]);
+    T* local_output_buffer = reinterpret_cast<T*>(params.local_output_buffer_ptr);
+    T const* local_part_buffer = STANDALONE ? reinterpret_cast<T const*>(params.local_input_buffer_ptr)
+                                            : local_output_buffer + params.rank_offset;
+
+    size_t const chunk_start = bidx * params.elts_per_block + tidx * PACKED_ELTS;
+    size_t const chunk_end = min(chunk_start + params.elts_per_block, params.elts_per_rank);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+        size_t const responsible_block_offset = local_offset + params.rank_offset;
+        *reinterpret_cast<int4*>(&local_shared_buffer[responsible_block_offset])
+            = *reinterpret_cast<int4 const*>(&local_part_buffer[local_offset]);
+    }
+    block_barrier(
+        params.peer_barrier_ptrs_out, params.barrier_flag, params.local_rank, RANKS_PER_NODE, tidx, bidx, grid_size);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+#pragma unroll
+        for (int ii = STANDALONE ? 0 : 1; ii < RANKS_PER_NODE; ++ii)
+        {
+            // use round-robin gathering from other ranks
+            int const rank = (params.local_rank + ii) % RANKS_PER_NODE;
+            size_t const offset_rank = rank * params.elts_per_rank + local_offset;
+            *reinterpret_cast<int4*>(&local_output_buffer[offset_rank]) = *reinterpret_cast<int4 const*>(
+                &reinterpret_cast<T const*>(params.peer_comm_buffer_ptrs[rank])[offset_rank]);
+        }
+    }
+}
+
+template <typename T, int RANKS_PER_NODE, typename OutT>
+static __global__ void allGatherNormKernel(AllReduceParams params)
+{
+    // All gather of the fused two shot all reduce, after each rank normed the rows of its part of the message.
+    // Gathers the residual sums of intermediate_buffer and the norm outputs of local_output, through two regions of
+    // the shareable buffer: [elts_total] T then [elts_total] OutT.
+    int const bidx = blockIdx.x;
+    int const tidx = threadIdx.x;
+    int const grid_size = gridDim.x;
+
+    static constexpr int PACKED_ELTS = 16 / sizeof(T);
+
+    struct alignas(PACKED_ELTS * sizeof(OutT)) OutPacked
+    {
+        OutT unpacked[PACKED_ELTS];
+    };
+
+    T* intermediate_buffer = reinterpret_cast<T*>(params.fusion_params.intermediate_buffer);
+    OutT* local_output_buffer = reinterpret_cast<OutT*>(params.local_output_buffer_ptr);
+    T* local_shared_buffer = reinterpret_cast<T*>(params.peer_comm_buffer_ptrs[params.local_rank]);
+    OutT* local_shared_output = reinterpret_cast<OutT*>(local_shared_buffer + params.elts_total);
+
+    size_t const chunk_start = bidx * params.elts_per_block + tidx * PACKED_ELTS;
+    size_t const chunk_end = min(chunk_start + params.elts_per_block, params.elts_per_rank);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+        size_t const responsible_block_offset = local_offset + params.rank_offset;
+        *reinterpret_cast<int4*>(&local_shared_buffer[responsible_block_offset])
+            = *reinterpret_cast<int4 const*>(&intermediate_buffer[responsible_block_offset]);
+        *reinterpret_cast<OutPacked*>(&local_shared_output[responsible_block_offset])
+            = *reinterpret_cast<OutPacked const*>(&local_output_buffer[responsible_block_offset]);
+    }
+    block_barrier(
+        params.peer_barrier_ptrs_out, params.barrier_flag, params.local_rank, RANKS_PER_NODE, tidx, bidx, grid_size);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+#pragma unroll
+        for (int ii = 1; ii < RANKS_PER_NODE; ++ii)
+        {
+            // use round-robin gathering from other ranks
+            int const rank = (params.local_rank + ii) % RANKS_PER_NODE;
+            size_t const offset_rank = rank * params.elts_per_rank + local_offset;
+            T const* peer_buffer = reinterpret_cast<T const*>(params.peer_comm_buffer_ptrs[rank]);
+            OutT const* peer_output = reinterpret_cast<OutT const*>(peer_buffer + params.elts_total);
+            *reinterpret_cast<int4*>(&intermediate_buffer[offset_rank])
+                = *reinterpret_cast<int4 const*>(&peer_buffer[offset_rank]);
+            *reinterpret_cast<OutPacked*>(&local_output_buffer[offset_rank])
+                = *reinterpret_cast<OutPacked const*>(&peer_output[offset_rank]);
+        }
+    }
+}
+
+// Loads 16 bytes through a multicast address, which returns their sum over the buffers bound to the multicast object.
+// Half precision values are accumulated in float by the switch.
+template <typename T>
+static inline __device__ int4 multimem_ld_reduce_add(void const* mc_ptr);
+
+template <>
+inline __device__ int4 multimem_ld_reduce_add<float>(void const* mc_ptr)
+{
+    int4 sum{0, 0, 0, 0};
+#if __CUDA_ARCH__ >= 900
+    asm volatile("multimem.ld_reduce.relaxed.sys.global.add.v4.f32 {%0, %1, %2, %3}, [%4];"
+                 : "=r"(sum.x), "=r"(sum.y), "=r"(sum.z), "=r"(sum.w)
+                 : "l"(mc_ptr)
+                 : "memory");
+#endif
+    return sum;
+}
+
+template <>
+inline __device__ int4 multimem_ld_reduce_add<half>(void const* mc_ptr)
+{
+    int4 sum{0, 0, 0, 0};
+#if __CUDA_ARCH__ >= 900
+    asm volatile("multimem.ld_reduce.relaxed.sys.global.add.acc::f32.v4.f16x2 {%0, %1, %2, %3}, [%4];"
+                 : "=r"(sum.x), "=r"(sum.y), "=r"(sum.z), "=r"(sum.w)
+                 : "l"(mc_ptr)
+                 : "memory");
+#endif
+    return sum;
+}
+
+#ifdef ENABLE_BF16
+template <>
+inline __device__ int4 multimem_ld_reduce_add<__nv_bfloat16>(void const* mc_ptr)
+{
+    int4 sum{0, 0, 0, 0};
+#if __CUDA_ARCH__ >= 900
+    asm volatile("multimem.ld_reduce.relaxed.sys.global.add.acc::f32.v4.bf16x2 {%0, %1, %2, %3}, [%4];"
+                 : "=r"(sum.x), "=r"(sum.y), "=r"(sum.z), "=r"(sum.w)
+                 : "l"(mc_ptr)
+                 : "memory");
+#endif
+    return sum;
+}
+#endif
+
+// Stores 16 bytes through a multicast address, into all the buffers bound to the multicast object
+static inline __device__ void multimem_st(void* mc_ptr, int4 const& val)
+{
+#if __CUDA_ARCH__ >= 900
+    asm volatile("multimem.st.relaxed.sys.global.v4.f32 [%0], {%1, %2, %3, %4};" ::"l"(mc_ptr), "r"(val.x),
+                 "r"(val.y), "r"(val.z), "r"(val.w)
+                 : "memory");
+#endif
+}
+
+template <typename T>
+static __global__ void nvlsAllReduceKernel(AllReduceParams params)
+{
+    // Two shot all reduce with the reduction done by the NVSwitch, each rank loads and stores its part once instead
+    // of reading the part from every peer and gathering the other parts from every peer:
+    // 1. Each block copies the chunks it is responsible for from local_input to the unicast buffer
+    // 2. The blocks of the same id wait for each other (block_barrier on barrier_ptrs_in)
+    // 3. Each block loads its chunk of the local_rank part through the multicast address, which sums it over the
+    //    ranks, and stores the sum through the multicast address, into the unicast buffers of all ranks
+    // 4. The blocks of the same id wait for each other's stores (block_barrier on barrier_ptrs_out)
+    // 5. Each block copies its chunks of all the parts from the unicast buffer to local_output
+    int const bidx = blockIdx.x;
+    int const tidx = threadIdx.x;
+    int const grid_size = gridDim.x;
+    size_t const ranks_per_node = params.ranks_per_node;
+
+    static constexpr int PACKED_ELTS = 16 / sizeof(T);
+
+    T const* local_input_buffer = reinterpret_cast<T const*>(params.local_input_buffer_ptr);
+    T* local_output_buffer = reinterpret_cast<T*>(params.local_output_buffer_ptr);
+    T* unicast_buffer = reinterpret_cast<T*>(params.nvls_unicast_ptr);
+    T* multicast_buffer = reinterpret_cast<T*>(params.nvls_multicast_ptr);
+
+    size_t const chunk_start = bidx * params.elts_per_block + tidx * PACKED_ELTS;
+    size_t const chunk_end = min(chunk_start + params.elts_per_block, params.elts_per_rank);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+        for (size_t ii = 0; ii < ranks_per_node; ++ii)
+        {
+            size_t const offset_rank = ii * params.elts_per_rank + local_offset;
+            *reinterpret_cast<int4*>(&unicast_buffer[offset_rank])
+                = *reinterpret_cast<int4 const*>(&local_input_buffer[offset_rank]);
+        }
+    }
+    __syncthreads();
+    block_barrier(
+        params.peer_barrier_ptrs_in, params.barrier_flag, params.local_rank, ranks_per_node, tidx, bidx, grid_size);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+        size_t const responsible_block_offset = local_offset + params.rank_offset;
+        int4 const sum = multimem_ld_reduce_add<T>(&multicast_buffer[responsible_block_offset]);
+        multimem_st(&multicast_buffer[responsible_block_offset], sum);
+    }
+    // The stores of the block reach the peers before its flags
+    __threadfence_system();
+    __syncthreads();
+    block_barrier(
+        params.peer_barrier_ptrs_out, params.barrier_flag, params.local_rank, ranks_per_node, tidx, bidx, grid_size);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+        for (size_t ii = 0; ii < ranks_per_node; ++ii)
+        {
+            size_t const offset_rank = ii * params.elts_per_rank + local_offset;
+            *reinterpret_cast<int4*>(&local_output_buffer[offset_rank])
+                = *reinterpret_cast<int4 const*>(&unicast_buffer[offset_rank]);
+        }
+    }
+}
+
 bool configurationSupported(AllReduceStrategyType algo, size_t msg_size, size_t n_ranks, nvinfer1::DataType type)
 {
     size_t elts_per_thread = 16 / common::getDTypeSize(type);
-    int const msg_align = (algo == AllReduceStrategyType::TWOSHOT) ? n_ranks * elts_per_thread : elts_per_thread;
-    bool supported_algo = (algo == AllReduceStrategyType::ONESHOT || algo == AllReduceStrategyType::TWOSHOT);
+    // The hierarchical and NVLS all reduces split the message between the n_ranks of a node like the two shot one
+    bool const split_msg = algo == AllReduceStrategyType::TWOSHOT || algo == AllReduceStrategyType::HIERARCHICAL
+        || algo == AllReduceStrategyType::NVLS;
+    int const msg_align = split_msg ? n_ranks * elts_per_thread : elts_per_thread;
+    bool supported_algo = (algo == AllReduceStrategyType::ONESHOT || split_msg);
     return supported_algo && (msg_size % msg_align == 0);
 }
 
+AllReduceStrategyType selectGatherScatterStrategy(
+    AllReduceStrategyType strategy, size_t msg_size, size_t n_ranks, nvinfer1::DataType type)
+{
+    // Beyond this size, NCCL's bandwidth matters more than its latency
+    static constexpr size_t kMaxAutoMessageBytes = 512 * 1024;
+    if (strategy == AllReduceStrategyType::NCCL || (n_ranks != 2 && n_ranks != 4 && n_ranks != 6 && n_ranks != 8))
+    {
+        return AllReduceStrategyType::NCCL;
+    }
+    auto const max_message_bytes = strategy == AllReduceStrategyType::AUTO
+        ? std::min(kMaxAutoMessageBytes, utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(n_ranks))
+        : utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(n_ranks);
+    // The message is split between the ranks like the two shot all reduce
+    bool const supported = msg_size * common::getDTypeSize(type) <= max_message_bytes
+        && configurationSupported(AllReduceStrategyType::TWOSHOT, msg_size, n_ranks, type);
+    return supported ? AllReduceStrategyType::ONESHOT : AllReduceStrategyType::NCCL;
+}
+
+namespace
+{
+std::mutex gStrategyTableMutex;
+std::map<int, std::vector<AllReduceStrategyCrossover>> gStrategyTables;
+std::map<int, NvlsBuffers> gNvlsBuffers;
+} // namespace
+
+void setAllReduceStrategyTable(int n_ranks, std::vector<AllReduceStrategyCrossover> table)
+{
+    TLLM_CHECK_WITH_INFO(std::is_sorted(table.begin(), table.end(),
+                             [](auto const& a, auto const& b) { return a.max_message_bytes < b.max_message_bytes; }),
+        "All reduce crossover table must be sorted by message size");
+    std::lock_guard<std::mutex> lock(gStrategyTableMutex);
+    gStrategyTables[n_ranks] = std::move(table);
+}
+
+std::optional<AllReduceStrategyType> lookupAllReduceStrategy(int n_ranks, size_t message_bytes)
+{
+    std::lock_guard<std::mutex> lock(gStrategyTableMutex);
+    auto const it = gStrategyTables.find(n_ranks);
+    if (it == gStrategyTables.end())
+    {
+        return std::nullopt;
+    }
+    auto const& table = it->second;
+    auto const entry = std::lower_bound(table.begin(), table.end(), message_bytes,
+        [](AllReduceStrategyCrossover const& c, size_t bytes) { return c.max_message_bytes < bytes; });
+    if (entry == table.end())
+    {
+        return std::nullopt;
+    }
+    return entry->strategy;
+}
+
+void setNvlsBuffers(int n_ranks, std::optional<NvlsBuffers> buffers)
+{
+    std::lock_guard<std::mutex> lock(gStrategyTableMutex);
+    if (buffers)
+    {
+        gNvlsBuffers[n_ranks] = *buffers;
+    }
+    else
+    {
+        gNvlsBuffers.erase(n_ranks);
+    }
+}
+
+std::optional<NvlsBuffers> getNvlsBuffers(int n_ranks)
+{
+    std::lock_guard<std::mutex> lock(gStrategyTableMutex);
+    auto const it = gNvlsBuffers.find(n_ranks);
+    if (it == gNvlsBuffers.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
 std::tuple<int, int> kernelLaunchConfig(AllReduceStrategyType algo, AllReduceParams& params, size_t elts_per_thread)
 {
     int blocks_per_grid = 1, threads_per_block = DEFAULT_BLOCK_SIZE;
@@ -859,20 +1258,47 @@ std::tuple<int, int> kernelLaunchConfig(AllReduceStrategyType algo, AllReducePar
 }
 
 template <typename T, int RANKS_PER_NODE, bool PUSH_MODE = false, bool USE_MEMCPY = false, bool Bias = false,
-    bool Affine = false>
+    bool Affine = false, typename OutT = T>
 void AllReduceNormKernelLaunch(AllReduceStrategyType algo, AllReduceStrategyConfig config, AllReduceFusionOp fusionOp,
     AllReduceParams& params, cudaStream_t stream)
 {
-    TLLM_CHECK(fusionOp == AllReduceFusionOp::RESIDUAL_RMS_NORM);
+    TLLM_CHECK(fusionOp != AllReduceFusionOp::NONE);
     if (algo == AllReduceStrategyType::ONESHOT)
     {
-        reduce_fusion::one_shot_all_reduce_norm_kernel_launcher<T, RANKS_PER_NODE, Bias, Affine>(params, stream);
+        reduce_fusion::one_shot_all_reduce_norm_kernel_launcher<T, RANKS_PER_NODE, Bias, Affine, OutT>(
+            params, stream);
     }
     else
     {
         TLLM_CHECK_WITH_INFO(!(USE_MEMCPY && PUSH_MODE), "Memcpy cannot be used with PUSH_MODE.");
         size_t elts_per_thread = 16 / sizeof(T);
         auto [blocks_per_grid, threads_per_block] = kernelLaunchConfig(algo, params, elts_per_thread);
+        if constexpr (!PUSH_MODE && !USE_MEMCPY)
+        {
+            // When the parts of the ranks hold whole rows, each rank norms its part between the reduce scatter and
+            // the all gather, instead of every rank norming the whole message
+            if (params.elts_per_rank % params.fusion_params.hidden_size == 0)
+            {
+                auto scatter_params = params;
+                scatter_params.local_output_buffer_ptr = params.fusion_params.intermediate_buffer;
+                reduceScatterKernel<T, RANKS_PER_NODE>
+                    <<<blocks_per_grid, threads_per_block, 0, stream>>>(scatter_params);
+
+                auto norm_params = params;
+                norm_params.elts_total = params.elts_per_rank;
+                norm_params.local_output_buffer_ptr
+                    = reinterpret_cast<OutT*>(params.local_output_buffer_ptr) + params.rank_offset;
+                norm_params.fusion_params.intermediate_buffer
+                    = reinterpret_cast<T*>(params.fusion_params.intermediate_buffer) + params.rank_offset;
+                norm_params.fusion_params.residual_buffer
+                    = reinterpret_cast<T const*>(params.fusion_params.residual_buffer) + params.rank_offset;
+                reduce_fusion::rms_norm_kernel_launcher<T, Bias, true, Affine, OutT>(norm_params, stream);
+
+                allGatherNormKernel<T, RANKS_PER_NODE, OutT>
+                    <<<blocks_per_grid, threads_per_block, 0, stream>>>(params);
+                return;
+            }
+        }
         if (USE_MEMCPY)
         {
             cudaMemcpyAsync(params.peer_comm_buffer_ptrs[params.local_rank], params.local_input_buffer_ptr,
@@ -883,33 +1309,56 @@ void AllReduceNormKernelLaunch(AllReduceStrategyType algo, AllReduceStrategyConf
         twoShotAllReduceKernel<T, RANKS_PER_NODE, !USE_MEMCPY, PUSH_MODE, Bias, true>
             <<<blocks_per_grid, threads_per_block, 0, stream>>>(params);
         params.local_output_buffer_ptr = output_ptr;
-        reduce_fusion::rms_norm_kernel_launcher<T, false, false, Affine>(params, stream);
+        reduce_fusion::rms_norm_kernel_launcher<T, false, false, Affine, OutT>(params, stream);
     }
 }
 
-template <typename T, int RANKS_PER_NODE, bool PUSH_MODE = false, bool USE_MEMCPY = false>
-void AllReduceNormDispatch(AllReduceStrategyType algo, AllReduceStrategyConfig config, AllReduceFusionOp fusionOp,
-    AllReduceParams& params, cudaStream_t stream)
+template <typename T, int RANKS_PER_NODE, bool PUSH_MODE = false, bool USE_MEMCPY = false, typename OutT = T>
+void AllReduceNormDispatchBias(AllReduceStrategyType algo, AllReduceStrategyConfig config,
+    AllReduceFusionOp fusionOp, AllReduceParams& params, cudaStream_t stream)
 {
     if (params.fusion_params.bias_buffer && params.fusion_params.weight_buffer)
     {
-        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, true, true>(
+        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, true, true, OutT>(
             algo, config, fusionOp, params, stream);
     }
     else if (params.fusion_params.bias_buffer && !params.fusion_params.weight_buffer)
     {
-        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, true, false>(
+        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, true, false, OutT>(
             algo, config, fusionOp, params, stream);
     }
     else if (!params.fusion_params.bias_buffer && params.fusion_params.weight_buffer)
     {
-        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, false, true>(
+        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, false, true, OutT>(
             algo, config, fusionOp, params, stream);
     }
     else
     {
-        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, false, false>(
+        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, false, false, OutT>(
+            algo, config, fusionOp, params, stream);
+    }
+}
+
+template <typename T, int RANKS_PER_NODE, bool PUSH_MODE = false, bool USE_MEMCPY = false>
+void AllReduceNormDispatch(AllReduceStrategyType algo, AllReduceStrategyConfig config, AllReduceFusionOp fusionOp,
+    AllReduceParams& params, cudaStream_t stream)
+{
+    switch (fusionOp)
+    {
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM:
+        AllReduceNormDispatchBias<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY>(algo, config, fusionOp, params, stream);
+        break;
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8:
+        AllReduceNormDispatchBias<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, int8_t>(
+            algo, config, fusionOp, params, stream);
+        break;
+#ifdef ENABLE_FP8
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_FP8:
+        AllReduceNormDispatchBias<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, __nv_fp8_e4m3>(
             algo, config, fusionOp, params, stream);
+        break;
+#endif
+    default: TLLM_THROW("Unsupported fusion op for customAllReduce");
     }
 }
 
@@ -998,6 +1447,13 @@ void AllReduceDispatchType(AllReduceParams& params, AllReduceStrategyType strat,
 
 AllReduceParams AllReduceParams::deserialize(int32_t const* buffer, size_t tpSize, size_t tpRank, uint32_t flag_value)
 {
+    return deserializeNode(buffer, tpSize, tpSize, tpRank, flag_value);
+}
+
+AllReduceParams AllReduceParams::deserializeNode(
+    int32_t const* buffer, size_t tpSize, size_t nodeSize, size_t nodeRank, uint32_t flag_value)
+{
+    TLLM_CHECK(nodeSize <= std::min(tpSize, MAX_RANKS_PER_NODE));
     void* const* buffer_ptrs = reinterpret_cast<void* const*>(buffer);
     AllReduceParams params;
     // Even plugins use ping buffers, odd plugins use pong.
@@ -1005,22 +1461,24 @@ AllReduceParams AllReduceParams::deserialize(int32_t const* buffer, size_t tpSiz
     // before copying input tensor to workspace.
     auto const buffer_offset = (flag_value % 2 == 0) ? 0 : tpSize;
 
-    for (int i = 0; i < tpSize; ++i)
+    for (int i = 0; i < nodeSize; ++i)
     {
         params.peer_comm_buffer_ptrs[i] = buffer_ptrs[buffer_offset + i];
     }
-    for (int i = 0; i < tpSize; ++i)
+    for (int i = 0; i < nodeSize; ++i)
     {
         params.peer_barrier_ptrs_in[i] = reinterpret_cast<uint32_t*>(buffer_ptrs[2 * tpSize + i]);
     }
-    for (int i = 0; i < tpSize; ++i)
+    for (int i = 0; i < nodeSize; ++i)
     {
         params.peer_barrier_ptrs_out[i] = reinterpret_cast<uint32_t*>(buffer_ptrs[3 * tpSize + i]);
     }
+    params.nvls_unicast_ptr = nullptr;
+    params.nvls_multicast_ptr = nullptr;
     params.barrier_flag = flag_value;
-    params.ranks_per_node = tpSize;
-    params.rank = tpRank;
-    params.local_rank = tpRank;
+    params.ranks_per_node = nodeSize;
+    params.rank = nodeRank;
+    params.local_rank = nodeRank;
 
     return params;
 }
@@ -1047,36 +1505,163 @@ void customAllReduce(kernels::AllReduceParams& params, nvinfer1::DataType dataTy
     sync_check_cuda_error();
 }
 
+template <typename T, int RANKS_PER_NODE, bool STANDALONE>
+void hierarchicalStageLaunch(bool reduceScatter, AllReduceParams& params, cudaStream_t stream)
+{
+    size_t elts_per_thread = 16 / sizeof(T);
+    auto [blocks_per_grid, threads_per_block]
+        = kernelLaunchConfig(AllReduceStrategyType::TWOSHOT, params, elts_per_thread);
+    if (reduceScatter)
+    {
+        reduceScatterKernel<T, RANKS_PER_NODE, STANDALONE><<<blocks_per_grid, threads_per_block, 0, stream>>>(params);
+    }
+    else
+    {
+        allGatherKernel<T, RANKS_PER_NODE, STANDALONE><<<blocks_per_grid, threads_per_block, 0, stream>>>(params);
+    }
+}
+
+template <typename T, bool STANDALONE>
+void hierarchicalStageDispatchType(bool reduceScatter, AllReduceParams& params, cudaStream_t stream)
+{
+    switch (params.ranks_per_node)
+    {
+    case 2: hierarchicalStageLaunch<T, 2, STANDALONE>(reduceScatter, params, stream); break;
+    case 4: hierarchicalStageLaunch<T, 4, STANDALONE>(reduceScatter, params, stream); break;
+    case 6: hierarchicalStageLaunch<T, 6, STANDALONE>(reduceScatter, params, stream); break;
+    case 8: hierarchicalStageLaunch<T, 8, STANDALONE>(reduceScatter, params, stream); break;
+    default: TLLM_THROW("Custom all reduce only supported on {2, 4, 6, 8} GPUs per node.");
+    }
+}
+
+template <bool STANDALONE>
+void hierarchicalStage(
+    bool reduceScatter, kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(
+        configurationSupported(AllReduceStrategyType::HIERARCHICAL, params.elts_total, params.ranks_per_node, dataType),
+        "Custom all-reduce configuration unsupported");
+
+    sync_check_cuda_error();
+
+    switch (dataType)
+    {
+    case nvinfer1::DataType::kFLOAT:
+        hierarchicalStageDispatchType<float, STANDALONE>(reduceScatter, params, stream);
+        break;
+    case nvinfer1::DataType::kHALF:
+        hierarchicalStageDispatchType<half, STANDALONE>(reduceScatter, params, stream);
+        break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16:
+        hierarchicalStageDispatchType<__nv_bfloat16, STANDALONE>(reduceScatter, params, stream);
+        break;
+#endif
+    default: TLLM_THROW("Unsupported dataType for customAllReduce");
+    }
+    sync_check_cuda_error();
+}
+
+void customReduceScatter(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream)
+{
+    hierarchicalStage<false>(true, params, dataType, stream);
+}
+
+void customAllGather(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream)
+{
+    hierarchicalStage<false>(false, params, dataType, stream);
+}
+
+void customOneShotReduceScatter(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream)
+{
+    hierarchicalStage<true>(true, params, dataType, stream);
+}
+
+void customOneShotAllGather(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream)
+{
+    hierarchicalStage<true>(false, params, dataType, stream);
+}
+
 template <typename T>
+void nvlsAllReduceLaunch(AllReduceParams& params, cudaStream_t stream)
+{
+    size_t elts_per_thread = 16 / sizeof(T);
+    auto [blocks_per_grid, threads_per_block]
+        = kernelLaunchConfig(AllReduceStrategyType::TWOSHOT, params, elts_per_thread);
+    nvlsAllReduceKernel<T><<<blocks_per_grid, threads_per_block, 0, stream>>>(params);
+}
+
+void customNvlsAllReduce(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(
+        configurationSupported(AllReduceStrategyType::NVLS, params.elts_total, params.ranks_per_node, dataType),
+        "Custom all-reduce configuration unsupported");
+    TLLM_CHECK_WITH_INFO(params.nvls_unicast_ptr != nullptr && params.nvls_multicast_ptr != nullptr,
+        "The NVLS all reduce needs the multicast buffers");
+
+    sync_check_cuda_error();
+
+    switch (dataType)
+    {
+    case nvinfer1::DataType::kFLOAT: nvlsAllReduceLaunch<float>(params, stream); break;
+    case nvinfer1::DataType::kHALF: nvlsAllReduceLaunch<half>(params, stream); break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16: nvlsAllReduceLaunch<__nv_bfloat16>(params, stream); break;
+#endif
+    default: TLLM_THROW("Unsupported dataType for customNvlsAllReduce");
+    }
+    sync_check_cuda_error();
+}
+
+template <typename T, typename OutT = T>
 void launchResidualRmsNormKernel(kernels::AllReduceParams& params, cudaStream_t stream)
 {
     if (params.fusion_params.bias_buffer && params.fusion_params.weight_buffer)
     {
-        reduce_fusion::rms_norm_kernel_launcher<T, true, true, true>(params, stream);
+        reduce_fusion::rms_norm_kernel_launcher<T, true, true, true, OutT>(params, stream);
     }
     else if (params.fusion_params.bias_buffer && !params.fusion_params.weight_buffer)
     {
-        reduce_fusion::rms_norm_kernel_launcher<T, true, true, false>(params, stream);
+        reduce_fusion::rms_norm_kernel_launcher<T, true, true, false, OutT>(params, stream);
     }
     else if (!params.fusion_params.bias_buffer && params.fusion_params.weight_buffer)
     {
-        reduce_fusion::rms_norm_kernel_launcher<T, false, true, true>(params, stream);
+        reduce_fusion::rms_norm_kernel_launcher<T, false, true, true, OutT>(params, stream);
     }
     else
     {
-        reduce_fusion::rms_norm_kernel_launcher<T, false, true, false>(params, stream);
+        reduce_fusion::rms_norm_kernel_launcher<T, false, true, false, OutT>(params, stream);
+    }
+}
+
+template <typename T>
+void launchResidualRmsNormKernel(kernels::AllReduceParams& params, AllReduceFusionOp fusionOp, cudaStream_t stream)
+{
+    switch (fusionOp)
+    {
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM: launchResidualRmsNormKernel<T>(params, stream); break;
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8:
+        launchResidualRmsNormKernel<T, int8_t>(params, stream);
+        break;
+#ifdef ENABLE_FP8
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_FP8:
+        launchResidualRmsNormKernel<T, __nv_fp8_e4m3>(params, stream);
+        break;
+#endif
+    default: TLLM_THROW("Unsupported fusion op for residualRmsNorm");
     }
 }
 
-void residualRmsNorm(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream)
+void residualRmsNorm(
+    kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream, AllReduceFusionOp fusionOp)
 {
     sync_check_cuda_error();
     switch (dataType)
     {
-    case nvinfer1::DataType::kFLOAT: launchResidualRmsNormKernel<float>(params, stream); break;
-    case nvinfer1::DataType::kHALF: launchResidualRmsNormKernel<half>(params, stream); break;
+    case nvinfer1::DataType::kFLOAT: launchResidualRmsNormKernel<float>(params, fusionOp, stream); break;
+    case nvinfer1::DataType::kHALF: launchResidualRmsNormKernel<half>(params, fusionOp, stream); break;
 #ifdef ENABLE_BF16
-    case nvinfer1::DataType::kBF16: launchResidualRmsNormKernel<__nv_bfloat16>(params, stream); break;
+    case nvinfer1::DataType::kBF16: launchResidualRmsNormKernel<__nv_bfloat16>(params, fusionOp, stream); break;
 #endif
     default: TLLM_THROW("Unsupported dataType for customAllReduce");
     }
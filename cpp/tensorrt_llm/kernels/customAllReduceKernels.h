@@ -24,6 +24,9 @@
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/tensor.h"
 
+#include <optional>
+#include <vector>
+
 namespace tensorrt_llm::kernels
 {
 
@@ -40,6 +43,10 @@ enum class AllReduceStrategyType : int8_t
     ONESHOT = 1,
     TWOSHOT = 2,
     AUTO = 3,
+    // Groups spanning nodes: reduce scatter within the node, NCCL across the nodes, all gather within the node
+    HIERARCHICAL = 4,
+    // NVSwitch systems: the switch sums the parts of the message loaded through a multicast address, see NvlsBuffers
+    NVLS = 5,
 };
 
 enum class AllReduceStrategyConfig : int8_t
@@ -52,6 +59,9 @@ enum class AllReduceFusionOp : int8_t
 {
     NONE = 0,
     RESIDUAL_RMS_NORM = 1,
+    // The normed output is quantized with the per tensor fusion_params.quant_scale, as the input of the next GEMM
+    RESIDUAL_RMS_NORM_QUANT_INT8 = 2,
+    RESIDUAL_RMS_NORM_QUANT_FP8 = 3,
 };
 
 struct AllReduceFusionParams
@@ -61,6 +71,7 @@ struct AllReduceFusionParams
         , residual_buffer(nullptr)
         , weight_buffer(nullptr)
         , intermediate_buffer(nullptr)
+        , quant_scale(nullptr)
     {
     }
 
@@ -74,6 +85,8 @@ struct AllReduceFusionParams
     float eps;
     // new residual
     void* intermediate_buffer;
+    // quantized norm output, multiplied by the scale before the conversion
+    float const* quant_scale;
 };
 
 struct AllReduceParams
@@ -89,17 +102,83 @@ struct AllReduceParams
     void* peer_comm_buffer_ptrs[MAX_RANKS_PER_NODE];
     void* local_output_buffer_ptr;
     void const* local_input_buffer_ptr;
+    // The NVLS all reduce stages the message in the unicast buffer of this rank, reduced through the multicast one
+    void* nvls_unicast_ptr;
+    void* nvls_multicast_ptr;
 
     AllReduceFusionParams fusion_params;
 
     static AllReduceParams deserialize(int32_t const* buffer, size_t tpSize, size_t tpRank, uint32_t flag_value);
+
+    // For a group spanning nodes, the buffers of the nodeSize ranks of this node come first in every tpSize pointers
+    static AllReduceParams deserializeNode(
+        int32_t const* buffer, size_t tpSize, size_t nodeSize, size_t nodeRank, uint32_t flag_value);
 };
 
 bool configurationSupported(AllReduceStrategyType algo, size_t msg_size, size_t n_ranks, nvinfer1::DataType type);
 
+// Strategy of the all gather and reduce scatter plugins for a whole message of msg_size elements, given the strategy
+// of the plugin: ONESHOT for the custom kernels, see customOneShotAllGather, or NCCL. AUTO only uses the custom
+// kernels for the small messages, where the latency of NCCL dominates.
+AllReduceStrategyType selectGatherScatterStrategy(
+    AllReduceStrategyType strategy, size_t msg_size, size_t n_ranks, nvinfer1::DataType type);
+
+// Fastest strategy for messages up to max_message_bytes. A table is sorted by message size and covers the messages up
+// to the last entry.
+struct AllReduceStrategyCrossover
+{
+    size_t max_message_bytes;
+    AllReduceStrategyType strategy;
+};
+
+// Sets the crossover table measured on this node for a number of ranks, see runtime::tuneAllReduceStrategies. The
+// AUTO strategy uses it instead of the fixed message size thresholds.
+void setAllReduceStrategyTable(int n_ranks, std::vector<AllReduceStrategyCrossover> table);
+
+// Returns the measured strategy for a message, or nullopt without a table or for messages beyond it
+std::optional<AllReduceStrategyType> lookupAllReduceStrategy(int n_ranks, size_t message_bytes);
+
+// The buffer of this rank bound to a multicast object over the buffers of all ranks of the group. A load through the
+// multicast address returns the sum of the buffers, a store writes to all of them.
+struct NvlsBuffers
+{
+    void* unicast_ptr;
+    void* multicast_ptr;
+    size_t size_bytes;
+};
+
+// Sets the multicast buffers allocated on this node for a number of ranks, see runtime::IpcNvlsMemory, or clears them
+// with nullopt. The NVLS strategy is only available with the buffers.
+void setNvlsBuffers(int n_ranks, std::optional<NvlsBuffers> buffers);
+
+std::optional<NvlsBuffers> getNvlsBuffers(int n_ranks);
+
 void customAllReduce(kernels::AllReduceParams& params, nvinfer1::DataType dataType, AllReduceStrategyType strat,
     AllReduceStrategyConfig config, AllReduceFusionOp fusionOp, cudaStream_t stream);
 
-void residualRmsNorm(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream);
+// Stages of the hierarchical all reduce over the ranks of a node. The reduce scatter writes the sum of the part
+// params.local_rank of the message into the same part of the output. The all gather completes the output with the
+// parts of the other ranks. Both set params.elts_per_rank and params.rank_offset.
+void customReduceScatter(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream);
+
+void customAllGather(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream);
+
+// One shot reduce scatter and all gather through the buffers of the custom all reduce, for the reduce scatter and all
+// gather plugins. params.elts_total is the size of the whole message, which is split between the ranks like the two
+// shot all reduce. The reduce scatter writes the sum of the part of this rank to params.local_output_buffer_ptr, which
+// only holds the part. The all gather gathers the parts, each in params.local_input_buffer_ptr of its rank, into
+// params.local_output_buffer_ptr.
+void customOneShotReduceScatter(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream);
+
+void customOneShotAllGather(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream);
+
+// All reduce of the NVLS strategy, through params.nvls_unicast_ptr and params.nvls_multicast_ptr. It does not fuse the
+// norm, the fusions are applied with residualRmsNorm.
+void customNvlsAllReduce(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream);
+
+// Adds bias and residual to the all reduce output in params.fusion_params.intermediate_buffer and norms it, for the
+// all reduce strategies that do not fuse the norm
+void residualRmsNorm(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream,
+    AllReduceFusionOp fusionOp = AllReduceFusionOp::RESIDUAL_RMS_NORM);
 
 } // namespace tensorrt_llm::kernels
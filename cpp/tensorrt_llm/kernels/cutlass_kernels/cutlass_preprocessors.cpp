@@ -21,6 +21,13 @@
 
 #include "cutlass_extensions/gemm/kernel/mixed_gemm_B_layout.h"
 
+#include <cuda_fp8.h>
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <thread>
+
 using namespace tensorrt_llm::common;
 
 namespace tensorrt_llm
@@ -30,6 +37,63 @@ namespace kernels
 namespace cutlass_kernels
 {
 
+namespace
+{
+// Minimum number of bytes processed by a preprocessing thread, smaller tensors aren't worth spawning threads for.
+constexpr size_t kMinBytesPerThread = size_t(1) << 20;
+
+// Runs fn(begin, end) on contiguous chunks of [0, num_items) on up to hardware_concurrency threads. Every item is
+// processed independently, so the result is the same as the one of fn(0, num_items) whatever the number of threads.
+template <typename Func>
+void parallel_for(size_t num_items, size_t bytes_per_item, Func&& fn)
+{
+    size_t const max_threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t const num_threads
+        = std::min({max_threads, num_items, std::max<size_t>(1, num_items * bytes_per_item / kMinBytesPerThread)});
+    if (num_threads <= 1)
+    {
+        fn(size_t(0), num_items);
+        return;
+    }
+
+    size_t const items_per_thread = (num_items + num_threads - 1) / num_threads;
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(num_threads);
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        size_t const begin = t * items_per_thread;
+        size_t const end = std::min(begin + items_per_thread, num_items);
+        if (begin >= end)
+        {
+            break;
+        }
+        threads.emplace_back(
+            [&fn, &errors, t, begin, end]()
+            {
+                try
+                {
+                    fn(begin, end);
+                }
+                catch (...)
+                {
+                    errors[t] = std::current_exception();
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (auto const& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+} // namespace
+
 struct LayoutDetails
 {
     enum class Layout
@@ -217,29 +281,34 @@ void permute_B_rows_for_mixed_gemm(int8_t* permuted_quantized_tensor, int8_t con
 
     TLLM_CHECK_WITH_INFO(size_t(B_ROWS_PER_MMA) == row_permutation.size(), "Unexpected number of LDSM rows permuted.");
 
-    for (int expert = 0; expert < num_experts; ++expert)
-    {
-        const int64_t matrix_offset = expert * int64_t(num_rows) * int64_t(num_vec_cols);
-        for (int base_row = 0; base_row < num_rows; base_row += B_ROWS_PER_MMA)
+    // Every tile of B_ROWS_PER_MMA rows of every expert is permuted independently.
+    size_t const tiles_per_expert = num_rows / B_ROWS_PER_MMA;
+    parallel_for(num_experts * tiles_per_expert, B_ROWS_PER_MMA * num_vec_cols * sizeof(uint32_t),
+        [&](size_t tile_begin, size_t tile_end)
         {
-            for (int tile_row = 0; tile_row < B_ROWS_PER_MMA; ++tile_row)
+            for (size_t tile = tile_begin; tile < tile_end; ++tile)
             {
-
-                for (int write_col = 0; write_col < num_vec_cols; ++write_col)
+                size_t const expert = tile / tiles_per_expert;
+                int const base_row = (tile % tiles_per_expert) * B_ROWS_PER_MMA;
+                const int64_t matrix_offset = expert * int64_t(num_rows) * int64_t(num_vec_cols);
+                for (int tile_row = 0; tile_row < B_ROWS_PER_MMA; ++tile_row)
                 {
-                    int const write_row = base_row + tile_row;
-                    int const tile_read_row = row_permutation[tile_row];
-                    int const read_row = base_row + tile_read_row;
-                    int const read_col = write_col;
 
-                    const int64_t read_offset = matrix_offset + int64_t(read_row) * num_vec_cols + read_col;
-                    const int64_t write_offset = matrix_offset + int64_t(write_row) * num_vec_cols + write_col;
+                    for (int write_col = 0; write_col < num_vec_cols; ++write_col)
+                    {
+                        int const write_row = base_row + tile_row;
+                        int const tile_read_row = row_permutation[tile_row];
+                        int const read_row = base_row + tile_read_row;
+                        int const read_col = write_col;
+
+                        const int64_t read_offset = matrix_offset + int64_t(read_row) * num_vec_cols + read_col;
+                        const int64_t write_offset = matrix_offset + int64_t(write_row) * num_vec_cols + write_col;
 
-                    output_byte_ptr[write_offset] = input_byte_ptr[read_offset];
+                        output_byte_ptr[write_offset] = input_byte_ptr[read_offset];
+                    }
                 }
             }
-        }
-    }
+        });
 }
 
 // We need to use this transpose to correctly handle packed int4 and int8 data
@@ -269,7 +338,6 @@ void subbyte_transpose_impl(
 
     static constexpr int M_TILE_L1 = 64;
     static constexpr int N_TILE_L1 = M_TILE_L1 / ELTS_PER_BYTE;
-    uint8_t cache_buf[M_TILE_L1][N_TILE_L1];
 
     static constexpr int VECTOR_WIDTH = std::min(32, N_TILE_L1);
 
@@ -284,105 +352,110 @@ void subbyte_transpose_impl(
     int const num_m_tiles = (num_rows + M_TILE_L1 - 1) / M_TILE_L1;
     int const num_n_tiles = (col_bytes + N_TILE_L1 - 1) / N_TILE_L1;
 
-    for (size_t expert = 0; expert < num_experts; ++expert)
-    {
-        const size_t matrix_offset = expert * num_rows * col_bytes;
-        for (size_t row_tile_start = 0; row_tile_start < num_rows; row_tile_start += M_TILE_L1)
+    // Every tile of M_TILE_L1 rows of every expert is transposed independently, each thread has its own cache tile.
+    parallel_for(num_experts * num_m_tiles, M_TILE_L1 * col_bytes,
+        [&](size_t tile_begin, size_t tile_end)
         {
-            for (size_t col_tile_start_byte = 0; col_tile_start_byte < col_bytes; col_tile_start_byte += N_TILE_L1)
+            uint8_t cache_buf[M_TILE_L1][N_TILE_L1];
+            for (size_t tile = tile_begin; tile < tile_end; ++tile)
             {
-
-                int const row_limit = std::min(row_tile_start + M_TILE_L1, num_rows);
-                int const col_limit = std::min(col_tile_start_byte + N_TILE_L1, col_bytes);
-
-                for (int ii = 0; ii < M_TILE_L1; ++ii)
+                const size_t expert = tile / num_m_tiles;
+                const size_t row_tile_start = (tile % num_m_tiles) * M_TILE_L1;
+                const size_t matrix_offset = expert * num_rows * col_bytes;
+                for (size_t col_tile_start_byte = 0; col_tile_start_byte < col_bytes; col_tile_start_byte += N_TILE_L1)
                 {
-                    int const row = row_tile_start + ii;
 
-                    for (int jj = 0; jj < N_TILE_L1; jj += VECTOR_WIDTH)
-                    {
-                        int const col = col_tile_start_byte + jj;
+                    int const row_limit = std::min(row_tile_start + M_TILE_L1, num_rows);
+                    int const col_limit = std::min(col_tile_start_byte + N_TILE_L1, col_bytes);
 
-                        const size_t logical_src_offset = matrix_offset + row * col_bytes + col;
+                    for (int ii = 0; ii < M_TILE_L1; ++ii)
+                    {
+                        int const row = row_tile_start + ii;
 
-                        if (row < row_limit && col < col_limit)
+                        for (int jj = 0; jj < N_TILE_L1; jj += VECTOR_WIDTH)
                         {
-                            for (int v = 0; v < VECTOR_WIDTH; ++v)
+                            int const col = col_tile_start_byte + jj;
+
+                            const size_t logical_src_offset = matrix_offset + row * col_bytes + col;
+
+                            if (row < row_limit && col < col_limit)
                             {
-                                cache_buf[ii][jj + v] = input_byte_ptr[logical_src_offset + v];
+                                for (int v = 0; v < VECTOR_WIDTH; ++v)
+                                {
+                                    cache_buf[ii][jj + v] = input_byte_ptr[logical_src_offset + v];
+                                }
                             }
                         }
                     }
-                }
 
-                if constexpr (bits_per_elt == 8)
-                {
-                    for (int ii = 0; ii < M_TILE_L1; ++ii)
+                    if constexpr (bits_per_elt == 8)
                     {
-                        for (int jj = ii + 1; jj < N_TILE_L1; ++jj)
+                        for (int ii = 0; ii < M_TILE_L1; ++ii)
                         {
-                            std::swap(cache_buf[ii][jj], cache_buf[jj][ii]);
+                            for (int jj = ii + 1; jj < N_TILE_L1; ++jj)
+                            {
+                                std::swap(cache_buf[ii][jj], cache_buf[jj][ii]);
+                            }
                         }
                     }
-                }
-                else if constexpr (bits_per_elt == 4)
-                {
-
-                    for (int ii = 0; ii < M_TILE_L1; ++ii)
+                    else if constexpr (bits_per_elt == 4)
                     {
-                        // Using M_TILE_L1 here is deliberate since we assume that the cache tile
-                        // is square in the number of elements (not necessarily the number of bytes).
-                        for (int jj = ii + 1; jj < M_TILE_L1; ++jj)
+
+                        for (int ii = 0; ii < M_TILE_L1; ++ii)
                         {
-                            int const ii_byte = ii / ELTS_PER_BYTE;
-                            int const ii_bit_offset = ii % ELTS_PER_BYTE;
+                            // Using M_TILE_L1 here is deliberate since we assume that the cache tile
+                            // is square in the number of elements (not necessarily the number of bytes).
+                            for (int jj = ii + 1; jj < M_TILE_L1; ++jj)
+                            {
+                                int const ii_byte = ii / ELTS_PER_BYTE;
+                                int const ii_bit_offset = ii % ELTS_PER_BYTE;
 
-                            int const jj_byte = jj / ELTS_PER_BYTE;
-                            int const jj_bit_offset = jj % ELTS_PER_BYTE;
+                                int const jj_byte = jj / ELTS_PER_BYTE;
+                                int const jj_bit_offset = jj % ELTS_PER_BYTE;
 
-                            uint8_t src_elt = 0xF & (cache_buf[ii][jj_byte] >> (4 * jj_bit_offset));
-                            uint8_t tgt_elt = 0xF & (cache_buf[jj][ii_byte] >> (4 * ii_bit_offset));
+                                uint8_t src_elt = 0xF & (cache_buf[ii][jj_byte] >> (4 * jj_bit_offset));
+                                uint8_t tgt_elt = 0xF & (cache_buf[jj][ii_byte] >> (4 * ii_bit_offset));
 
-                            cache_buf[ii][jj_byte] &= (0xF0 >> (4 * jj_bit_offset));
-                            cache_buf[jj][ii_byte] &= (0xF0 >> (4 * ii_bit_offset));
+                                cache_buf[ii][jj_byte] &= (0xF0 >> (4 * jj_bit_offset));
+                                cache_buf[jj][ii_byte] &= (0xF0 >> (4 * ii_bit_offset));
 
-                            cache_buf[ii][jj_byte] |= (tgt_elt << (4 * jj_bit_offset));
-                            cache_buf[jj][ii_byte] |= (src_elt << (4 * ii_bit_offset));
+                                cache_buf[ii][jj_byte] |= (tgt_elt << (4 * jj_bit_offset));
+                                cache_buf[jj][ii_byte] |= (src_elt << (4 * ii_bit_offset));
+                            }
                         }
                     }
-                }
-                else
-                {
-                    TLLM_CHECK_WITH_INFO(false, "Unsupported quantization type.");
-                }
+                    else
+                    {
+                        TLLM_CHECK_WITH_INFO(false, "Unsupported quantization type.");
+                    }
 
-                const size_t row_tile_start_trans = col_tile_start_byte * ELTS_PER_BYTE;
-                const size_t col_tile_start_byte_trans = row_tile_start / ELTS_PER_BYTE;
+                    const size_t row_tile_start_trans = col_tile_start_byte * ELTS_PER_BYTE;
+                    const size_t col_tile_start_byte_trans = row_tile_start / ELTS_PER_BYTE;
 
-                int const row_limit_trans = std::min(row_tile_start_trans + M_TILE_L1, num_cols);
-                int const col_limit_trans = std::min(col_tile_start_byte_trans + N_TILE_L1, col_bytes_trans);
+                    int const row_limit_trans = std::min(row_tile_start_trans + M_TILE_L1, num_cols);
+                    int const col_limit_trans = std::min(col_tile_start_byte_trans + N_TILE_L1, col_bytes_trans);
 
-                for (int ii = 0; ii < M_TILE_L1; ++ii)
-                {
-                    int const row = row_tile_start_trans + ii;
-                    for (int jj = 0; jj < N_TILE_L1; jj += VECTOR_WIDTH)
+                    for (int ii = 0; ii < M_TILE_L1; ++ii)
                     {
-                        int const col = col_tile_start_byte_trans + jj;
+                        int const row = row_tile_start_trans + ii;
+                        for (int jj = 0; jj < N_TILE_L1; jj += VECTOR_WIDTH)
+                        {
+                            int const col = col_tile_start_byte_trans + jj;
 
-                        const size_t logical_tgt_offset = matrix_offset + row * col_bytes_trans + col;
+                            const size_t logical_tgt_offset = matrix_offset + row * col_bytes_trans + col;
 
-                        if (row < row_limit_trans && col < col_limit_trans)
-                        {
-                            for (int v = 0; v < VECTOR_WIDTH; ++v)
+                            if (row < row_limit_trans && col < col_limit_trans)
                             {
-                                output_byte_ptr[logical_tgt_offset + v] = cache_buf[ii][jj + v];
+                                for (int v = 0; v < VECTOR_WIDTH; ++v)
+                                {
+                                    output_byte_ptr[logical_tgt_offset + v] = cache_buf[ii][jj + v];
+                                }
                             }
                         }
                     }
                 }
             }
-        }
-    }
+        });
 }
 
 void subbyte_transpose(int8_t* transposed_quantized_tensor, int8_t const* quantized_tensor,
@@ -410,10 +483,14 @@ void subbyte_transpose(int8_t* transposed_quantized_tensor, int8_t const* quanti
 
 void add_bias_and_interleave_int8s_inplace(int8_t* int8_tensor, const size_t num_elts)
 {
-    for (int ii = 0; ii < num_elts; ++ii)
-    {
-        int8_tensor[ii] = int8_t(int(int8_tensor[ii]) + 128);
-    }
+    parallel_for(num_elts, sizeof(int8_t),
+        [&](size_t begin, size_t end)
+        {
+            for (size_t ii = begin; ii < end; ++ii)
+            {
+                int8_tensor[ii] = int8_t(int(int8_tensor[ii]) + 128);
+            }
+        });
 
     // Step 2 will transform the layout of a 32-bit register in CUDA in order to match the int4 layout. This has no
     // performance benefit and is purely so that int4 and int8 have the same layout.
@@ -426,10 +503,14 @@ void add_bias_and_interleave_int8s_inplace(int8_t* int8_tensor, const size_t num
     //      [elt_3  elt_1  elt_2  elt_0] (each elt occupies 8 bits)
 
     TLLM_CHECK_WITH_INFO(num_elts % 4 == 0, "Dimensions of int8 tensor must be a multiple of 4 for register relayout");
-    for (size_t base = 0; base < num_elts; base += 4)
-    {
-        std::swap(int8_tensor[base + 1], int8_tensor[base + 2]);
-    }
+    parallel_for(num_elts / 4, 4,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t base = 4 * begin; base < 4 * end; base += 4)
+            {
+                std::swap(int8_tensor[base + 1], int8_tensor[base + 2]);
+            }
+        });
 }
 
 void add_bias_and_interleave_int4s_inplace(int8_t* packed_int4_tensor, const size_t num_elts)
@@ -438,23 +519,27 @@ void add_bias_and_interleave_int4s_inplace(int8_t* packed_int4_tensor, const siz
 
     // Step 1 will be to transform all the int4s to unsigned in order to make the dequantize take as little
     // instructions as possible in the CUDA code.
-    for (size_t ii = 0; ii < num_bytes; ++ii)
-    {
-        int8_t transformed_packed_int4s = 0;
-        int8_t transformed_first_elt
-            = (int8_t(packed_int4_tensor[ii] << 4) >> 4) + 8; // The double shift here is to ensure sign extension
-        int8_t transformed_second_elt = (packed_int4_tensor[ii] >> 4) + 8;
-
-        TLLM_CHECK_WITH_INFO(
-            transformed_first_elt >= 0 && transformed_first_elt <= 15, "Illegal result for int4 transform (first elt)");
-        TLLM_CHECK_WITH_INFO(transformed_second_elt >= 0 && transformed_second_elt <= 15,
-            "Illegal result for int4 transform (second elt)");
-
-        // We don't need to mask in these ops since everything should be in the range 0-15
-        transformed_packed_int4s |= transformed_first_elt;
-        transformed_packed_int4s |= (transformed_second_elt << 4);
-        packed_int4_tensor[ii] = transformed_packed_int4s;
-    }
+    parallel_for(num_bytes, sizeof(int8_t),
+        [&](size_t begin, size_t end)
+        {
+            for (size_t ii = begin; ii < end; ++ii)
+            {
+                int8_t transformed_packed_int4s = 0;
+                int8_t transformed_first_elt = (int8_t(packed_int4_tensor[ii] << 4) >> 4)
+                    + 8; // The double shift here is to ensure sign extension
+                int8_t transformed_second_elt = (packed_int4_tensor[ii] >> 4) + 8;
+
+                TLLM_CHECK_WITH_INFO(transformed_first_elt >= 0 && transformed_first_elt <= 15,
+                    "Illegal result for int4 transform (first elt)");
+                TLLM_CHECK_WITH_INFO(transformed_second_elt >= 0 && transformed_second_elt <= 15,
+                    "Illegal result for int4 transform (second elt)");
+
+                // We don't need to mask in these ops since everything should be in the range 0-15
+                transformed_packed_int4s |= transformed_first_elt;
+                transformed_packed_int4s |= (transformed_second_elt << 4);
+                packed_int4_tensor[ii] = transformed_packed_int4s;
+            }
+        });
 
     // Step 2 will transform the layout of a 32-bit register in CUDA in order to minimize the number of shift & logical
     // instructions That are needed to extract the int4s in the GEMM main loop. Pictorially, the loop below will do the
@@ -469,22 +554,26 @@ void add_bias_and_interleave_int4s_inplace(int8_t* packed_int4_tensor, const siz
     const size_t num_registers = num_bytes / 4;
 
     uint32_t* register_ptr = reinterpret_cast<uint32_t*>(packed_int4_tensor);
-    for (size_t ii = 0; ii < num_registers; ++ii)
-    {
-        const uint32_t current_register = register_ptr[ii];
-        uint32_t transformed_register = 0;
-
-        for (int dest_idx = 0; dest_idx < 8; ++dest_idx)
+    parallel_for(num_registers, sizeof(uint32_t),
+        [&](size_t begin, size_t end)
         {
-            int const src_idx = dest_idx < 4 ? 2 * dest_idx : 2 * (dest_idx - 4) + 1;
-            int const src_shift = 4 * src_idx;
-            int const dest_shift = 4 * dest_idx;
+            for (size_t ii = begin; ii < end; ++ii)
+            {
+                const uint32_t current_register = register_ptr[ii];
+                uint32_t transformed_register = 0;
 
-            const uint32_t src_bits = (current_register >> src_shift) & 0xF;
-            transformed_register |= (src_bits << dest_shift);
-        }
-        register_ptr[ii] = transformed_register;
-    }
+                for (int dest_idx = 0; dest_idx < 8; ++dest_idx)
+                {
+                    int const src_idx = dest_idx < 4 ? 2 * dest_idx : 2 * (dest_idx - 4) + 1;
+                    int const src_shift = 4 * src_idx;
+                    int const dest_shift = 4 * dest_idx;
+
+                    const uint32_t src_bits = (current_register >> src_shift) & 0xF;
+                    transformed_register |= (src_bits << dest_shift);
+                }
+                register_ptr[ii] = transformed_register;
+            }
+        });
 }
 
 void add_bias_and_interleave_quantized_tensor_inplace(int8_t* tensor, const size_t num_elts, QuantType quant_type)
@@ -536,28 +625,32 @@ void interleave_column_major_tensor(int8_t* interleaved_quantized_tensor, int8_t
     int const vec_rows_per_tile = rows_per_tile / elts_in_int32;
     int const interleave = details.columns_interleaved;
 
-    for (int expert = 0; expert < num_experts; ++expert)
-    {
-        const int64_t matrix_offset = expert * int64_t(num_vec_rows) * int64_t(num_cols);
-        for (int read_col = 0; read_col < num_cols; ++read_col)
+    // Every column of every expert is interleaved independently.
+    parallel_for(num_experts * num_cols, num_vec_rows * sizeof(uint32_t),
+        [&](size_t col_begin, size_t col_end)
         {
-            const int64_t write_col = read_col / interleave;
-            for (int base_vec_row = 0; base_vec_row < num_vec_rows; base_vec_row += vec_rows_per_tile)
+            for (size_t col = col_begin; col < col_end; ++col)
             {
-                for (int vec_read_row = base_vec_row;
-                     vec_read_row < std::min(num_vec_rows, base_vec_row + vec_rows_per_tile); ++vec_read_row)
+                const size_t expert = col / num_cols;
+                int const read_col = col % num_cols;
+                const int64_t matrix_offset = expert * int64_t(num_vec_rows) * int64_t(num_cols);
+                const int64_t write_col = read_col / interleave;
+                for (int base_vec_row = 0; base_vec_row < num_vec_rows; base_vec_row += vec_rows_per_tile)
                 {
-                    const int64_t vec_write_row = interleave * base_vec_row
-                        + vec_rows_per_tile * (read_col % interleave) + vec_read_row % vec_rows_per_tile;
+                    for (int vec_read_row = base_vec_row;
+                         vec_read_row < std::min(num_vec_rows, base_vec_row + vec_rows_per_tile); ++vec_read_row)
+                    {
+                        const int64_t vec_write_row = interleave * base_vec_row
+                            + vec_rows_per_tile * (read_col % interleave) + vec_read_row % vec_rows_per_tile;
 
-                    const int64_t read_offset = matrix_offset + int64_t(read_col) * num_vec_rows + vec_read_row;
-                    const int64_t write_offset
-                        = matrix_offset + int64_t(write_col) * num_vec_rows * interleave + vec_write_row;
-                    output_byte_ptr[write_offset] = input_byte_ptr[read_offset];
+                        const int64_t read_offset = matrix_offset + int64_t(read_col) * num_vec_rows + vec_read_row;
+                        const int64_t write_offset
+                            = matrix_offset + int64_t(write_col) * num_vec_rows * interleave + vec_write_row;
+                        output_byte_ptr[write_offset] = input_byte_ptr[read_offset];
+                    }
                 }
             }
-        }
-    }
+        });
 }
 
 void preprocess_weights_for_mixed_gemm(int8_t* preprocessed_quantized_weight, int8_t const* row_major_quantized_weight,
@@ -684,20 +777,24 @@ void symmetric_quantize(int8_t* processed_quantized_weight, int8_t* unprocessed_
         WeightType const* current_weight = input_weight_ptr + expert * input_mat_size;
         int8_t* current_quantized_weight = unprocessed_quantized_weight + expert * quantized_mat_size;
 
-        // First we find the per column max for this expert weight.
-        for (int jj = 0; jj < num_cols; ++jj)
-        {
-            per_col_max[jj] = 0.f;
-        }
-
-        for (int ii = 0; ii < num_rows; ++ii)
-        {
-            WeightType const* current_weight_row = current_weight + ii * num_cols;
-            for (int jj = 0; jj < num_cols; ++jj)
+        // First we find the per column max for this expert weight, every thread reduces a range of columns.
+        parallel_for(num_cols, num_rows * sizeof(WeightType),
+            [&](size_t col_begin, size_t col_end)
             {
-                per_col_max[jj] = std::max(per_col_max[jj], std::abs(float(current_weight_row[jj])));
-            }
-        }
+                for (size_t jj = col_begin; jj < col_end; ++jj)
+                {
+                    per_col_max[jj] = 0.f;
+                }
+
+                for (int ii = 0; ii < num_rows; ++ii)
+                {
+                    WeightType const* current_weight_row = current_weight + ii * num_cols;
+                    for (size_t jj = col_begin; jj < col_end; ++jj)
+                    {
+                        per_col_max[jj] = std::max(per_col_max[jj], std::abs(float(current_weight_row[jj])));
+                    }
+                }
+            });
 
         // Then, we construct the scales
         ComputeType* current_scales = scale_ptr + expert * num_cols;
@@ -707,51 +804,56 @@ void symmetric_quantize(int8_t* processed_quantized_weight, int8_t* unprocessed_
             current_scales[jj] = ComputeType(per_col_max[jj]);
         }
 
-        // Finally, construct the weights.
-        for (int ii = 0; ii < num_rows; ++ii)
-        {
-            int8_t* current_quantized_weight_row = current_quantized_weight + ii * bytes_per_out_col;
-            WeightType const* current_weight_row = current_weight + ii * num_cols;
-            for (int jj = 0; jj < bytes_per_out_col; ++jj)
+        // Finally, construct the weights, the rows are quantized independently.
+        parallel_for(num_rows, num_cols * sizeof(WeightType),
+            [&](size_t row_begin, size_t row_end)
             {
-
-                if (bits_per_weigtht_element == 8)
-                {
-                    float const col_scale = per_col_max[jj];
-                    float const weight_elt = float(current_weight_row[jj]);
-                    float const scaled_weight = (col_scale != 0.0f) ? round(weight_elt / col_scale) : 0.0f;
-                    const int8_t clipped_weight = int8_t(std::max(-128.f, std::min(127.f, scaled_weight)));
-                    current_quantized_weight_row[jj] = clipped_weight;
-                }
-                else if (bits_per_weigtht_element == 4)
+                for (size_t ii = row_begin; ii < row_end; ++ii)
                 {
-
-                    // We will pack two int4 elements per iteration of the inner loop.
-                    int8_t packed_int4s = 0;
-                    for (int packed_idx = 0; packed_idx < 2; ++packed_idx)
+                    int8_t* current_quantized_weight_row = current_quantized_weight + ii * bytes_per_out_col;
+                    WeightType const* current_weight_row = current_weight + ii * num_cols;
+                    for (int jj = 0; jj < bytes_per_out_col; ++jj)
                     {
-                        int const input_idx = 2 * jj + packed_idx;
-                        if (input_idx < num_cols)
+
+                        if (bits_per_weigtht_element == 8)
                         {
-                            float const col_scale = per_col_max[input_idx];
-                            float const weight_elt = float(current_weight_row[input_idx]);
+                            float const col_scale = per_col_max[jj];
+                            float const weight_elt = float(current_weight_row[jj]);
                             float const scaled_weight = (col_scale != 0.0f) ? round(weight_elt / col_scale) : 0.0f;
-                            int int_weight = int(scaled_weight);
-                            const int8_t clipped_weight = std::max(-8, std::min(7, int_weight));
+                            const int8_t clipped_weight = int8_t(std::max(-128.f, std::min(127.f, scaled_weight)));
+                            current_quantized_weight_row[jj] = clipped_weight;
+                        }
+                        else if (bits_per_weigtht_element == 4)
+                        {
 
-                            // Kill the sign extension bits (hence 0x0F mask) then shift to upper bits
-                            // if packing the second int4 and or the bits into the final result.
-                            packed_int4s |= ((clipped_weight & 0x0F) << (4 * packed_idx));
+                            // We will pack two int4 elements per iteration of the inner loop.
+                            int8_t packed_int4s = 0;
+                            for (int packed_idx = 0; packed_idx < 2; ++packed_idx)
+                            {
+                                int const input_idx = 2 * jj + packed_idx;
+                                if (input_idx < num_cols)
+                                {
+                                    float const col_scale = per_col_max[input_idx];
+                                    float const weight_elt = float(current_weight_row[input_idx]);
+                                    float const scaled_weight
+                                        = (col_scale != 0.0f) ? round(weight_elt / col_scale) : 0.0f;
+                                    int int_weight = int(scaled_weight);
+                                    const int8_t clipped_weight = std::max(-8, std::min(7, int_weight));
+
+                                    // Kill the sign extension bits (hence 0x0F mask) then shift to upper bits
+                                    // if packing the second int4 and or the bits into the final result.
+                                    packed_int4s |= ((clipped_weight & 0x0F) << (4 * packed_idx));
+                                }
+                            }
+                            current_quantized_weight_row[jj] = packed_int4s;
+                        }
+                        else
+                        {
+                            TLLM_CHECK_WITH_INFO(false, "Unsupported quantization type");
                         }
                     }
-                    current_quantized_weight_row[jj] = packed_int4s;
                 }
-                else
-                {
-                    TLLM_CHECK_WITH_INFO(false, "Unsupported quantization type");
-                }
-            }
-        }
+            });
     }
 
     preprocess_weights_for_mixed_gemm(
@@ -802,6 +904,136 @@ template void symmetric_quantize<__nv_bfloat16, float>(
     int8_t*, __nv_bfloat16*, float const*, std::vector<size_t> const&, QuantType, bool);
 #endif
 
+namespace
+{
+// Rounds x, already divided by its block scale, to the nearest e2m1 value. Returns the 4-bit code, whose magnitude
+// part indexes {0, 0.5, 1, 1.5, 2, 3, 4, 6}.
+uint8_t float_to_e2m1(float x)
+{
+    static constexpr float kThresholds[] = {0.25f, 0.75f, 1.25f, 1.75f, 2.5f, 3.5f, 5.f};
+    float const mag = std::abs(x);
+    uint8_t code = 0;
+    for (float threshold : kThresholds)
+    {
+        code += mag > threshold ? 1 : 0;
+    }
+    return code | (x < 0.f && code != 0 ? 0x8 : 0);
+}
+
+// Largest e2m1 and e4m3 magnitudes
+constexpr float kE2m1Max = 6.f;
+constexpr float kE4m3Max = 448.f;
+} // namespace
+
+template <typename WeightType>
+void fp4_block_quantize(uint8_t* quantized_weight, uint8_t* block_scales, float* global_scale,
+    WeightType const* input_weight_ptr, std::vector<size_t> const& shape, fp4_gemm::Fp4Format format)
+{
+    TLLM_CHECK_WITH_INFO(quantized_weight, "Quantized tensor is NULL");
+    TLLM_CHECK_WITH_INFO(block_scales, "Block scales pointer is NULL");
+    TLLM_CHECK_WITH_INFO(global_scale, "Global scale pointer is NULL");
+    TLLM_CHECK_WITH_INFO(input_weight_ptr, "Input weight pointer is NULL");
+
+    TLLM_CHECK_WITH_INFO(shape.size() == 2 || shape.size() == 3, "Shape must be 2-D or 3-D");
+    size_t const num_experts = shape.size() == 2 ? 1 : shape[0];
+    size_t const num_rows = shape.size() == 2 ? shape[0] : shape[1];
+    size_t const num_cols = shape.size() == 2 ? shape[1] : shape[2];
+
+    size_t const block_size = fp4_gemm::getFp4BlockSize(format);
+    TLLM_CHECK_WITH_INFO(num_cols % block_size == 0, "Number of columns must be a multiple of %d, got %d",
+        static_cast<int>(block_size), static_cast<int>(num_cols));
+    size_t const blocks_per_row = num_cols / block_size;
+    bool const is_nvfp4 = format == fp4_gemm::Fp4Format::NVFP4;
+
+    std::vector<float> per_row_max(num_rows);
+
+    for (size_t expert = 0; expert < num_experts; ++expert)
+    {
+        WeightType const* current_weight = input_weight_ptr + expert * num_rows * num_cols;
+        uint8_t* current_quantized_weight = quantized_weight + expert * num_rows * num_cols / 2;
+        uint8_t* current_scales = block_scales + expert * num_rows * blocks_per_row;
+
+        // NVFP4 block scales are relative to a per tensor scale that maps the largest weight to the largest product
+        // of an e2m1 and an e4m3 number.
+        float tensor_scale = 1.f;
+        if (is_nvfp4)
+        {
+            parallel_for(num_rows, num_cols * sizeof(WeightType),
+                [&](size_t row_begin, size_t row_end)
+                {
+                    for (size_t ii = row_begin; ii < row_end; ++ii)
+                    {
+                        per_row_max[ii] = 0.f;
+                        for (size_t jj = 0; jj < num_cols; ++jj)
+                        {
+                            per_row_max[ii]
+                                = std::max(per_row_max[ii], std::abs(float(current_weight[ii * num_cols + jj])));
+                        }
+                    }
+                });
+            float const amax = *std::max_element(per_row_max.begin(), per_row_max.end());
+            tensor_scale = amax > 0.f ? amax / (kE2m1Max * kE4m3Max) : 1.f;
+        }
+        global_scale[expert] = tensor_scale;
+
+        parallel_for(num_rows, num_cols * sizeof(WeightType),
+            [&](size_t row_begin, size_t row_end)
+            {
+                for (size_t ii = row_begin; ii < row_end; ++ii)
+                {
+                    WeightType const* current_weight_row = current_weight + ii * num_cols;
+                    for (size_t bb = 0; bb < blocks_per_row; ++bb)
+                    {
+                        WeightType const* block = current_weight_row + bb * block_size;
+                        float block_max = 0.f;
+                        for (size_t jj = 0; jj < block_size; ++jj)
+                        {
+                            block_max = std::max(block_max, std::abs(float(block[jj])));
+                        }
+
+                        float scale;
+                        uint8_t scale_bits;
+                        if (is_nvfp4)
+                        {
+                            __nv_fp8_e4m3 const scale_fp8(block_max / kE2m1Max / tensor_scale);
+                            scale_bits = scale_fp8.__x;
+                            scale = float(scale_fp8) * tensor_scale;
+                        }
+                        else
+                        {
+                            // The smallest power of two that doesn't clip the block, within the normal floats.
+                            int const exponent = block_max > 0.f
+                                ? std::min(127, std::max(-126, int(std::ceil(std::log2(block_max / kE2m1Max)))))
+                                : 0;
+                            scale_bits = static_cast<uint8_t>(exponent + 127);
+                            scale = std::ldexp(1.f, exponent);
+                        }
+                        current_scales[ii * blocks_per_row + bb] = scale_bits;
+
+                        uint8_t* packed = current_quantized_weight + (ii * num_cols + bb * block_size) / 2;
+                        for (size_t jj = 0; jj < block_size; jj += 2)
+                        {
+                            uint8_t const lo = scale != 0.f ? float_to_e2m1(float(block[jj]) / scale) : 0;
+                            uint8_t const hi = scale != 0.f ? float_to_e2m1(float(block[jj + 1]) / scale) : 0;
+                            packed[jj / 2] = lo | (hi << 4);
+                        }
+                    }
+                }
+            });
+    }
+}
+
+template void fp4_block_quantize<float>(
+    uint8_t*, uint8_t*, float*, float const*, std::vector<size_t> const&, fp4_gemm::Fp4Format);
+
+template void fp4_block_quantize<half>(
+    uint8_t*, uint8_t*, float*, half const*, std::vector<size_t> const&, fp4_gemm::Fp4Format);
+
+#ifdef ENABLE_BF16
+template void fp4_block_quantize<__nv_bfloat16>(
+    uint8_t*, uint8_t*, float*, __nv_bfloat16 const*, std::vector<size_t> const&, fp4_gemm::Fp4Format);
+#endif
+
 } // namespace cutlass_kernels
 } // namespace kernels
 } // namespace tensorrt_llm
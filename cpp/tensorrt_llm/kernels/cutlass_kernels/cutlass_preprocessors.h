@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/weightOnlyBatchedGemv/fp4Gemm.h"
 
 namespace tensorrt_llm
 {
@@ -71,6 +72,14 @@ void symmetric_quantize(int8_t* processed_quantized_weight, int8_t* unprocessed_
     ComputeType* scale_ptr, WeightType const* input_weight_ptr, std::vector<size_t> const& shape, QuantType quant_type,
     bool force_interleave);
 
+// Quantizes [num_rows, num_cols] (or [num_experts, num_rows, num_cols]) weights, with num_cols the reduction dimension,
+// to the layout read by fp4_gemm::fp4GemvLauncher: e2m1 values packed two per byte in quantized_weight, and a scale
+// per block of getFp4BlockSize(format) weights along a row in block_scales. global_scale receives the per tensor scale
+// to pass as alpha, one per expert: 1 for MXFP4, amax / (6 * 448) for NVFP4.
+template <typename WeightType>
+void fp4_block_quantize(uint8_t* quantized_weight, uint8_t* block_scales, float* global_scale,
+    WeightType const* input_weight_ptr, std::vector<size_t> const& shape, fp4_gemm::Fp4Format format);
+
 } // namespace cutlass_kernels
 } // namespace kernels
 } // namespace tensorrt_llm
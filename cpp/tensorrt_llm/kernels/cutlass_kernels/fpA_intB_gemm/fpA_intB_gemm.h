@@ -78,6 +78,16 @@ public:
         tkc::CutlassGemmConfig gemmConfig, char* workspace_ptr, const size_t workspace_bytes, cudaStream_t stream)
         = 0;
 
+    // Same as above with the activations scaled per channel by act_scale [k] (the AWQ pre-quant scale) in the
+    // mainloop, which saves a pass over A. Only valid for the configs accepted by supportsFusedActScale.
+    virtual void gemm(void const* A, void const* act_scale, void const* B, void const* weight_scales,
+        void const* weight_zero_points, void const* biases, float const alpha, void* C, int m, int n, int k,
+        int const group_size, tkc::CutlassGemmConfig gemmConfig, char* workspace_ptr, const size_t workspace_bytes,
+        cudaStream_t stream)
+        = 0;
+
+    virtual bool supportsFusedActScale(tkc::CutlassGemmConfig const& gemmConfig) const = 0;
+
     // Returns desired workspace size in bytes.
     virtual size_t getWorkspaceSize(int const m, int const n, int const k) = 0;
 
@@ -114,6 +124,13 @@ public:
         tkc::CutlassGemmConfig gemmConfig, char* workspace_ptr, const size_t workspace_bytes,
         cudaStream_t stream) override;
 
+    void gemm(void const* A, void const* act_scale, void const* B, void const* weight_scales,
+        void const* weight_zero_points, void const* biases, float const alpha, void* C, int m, int n, int k,
+        int const group_size, tkc::CutlassGemmConfig gemmConfig, char* workspace_ptr, const size_t workspace_bytes,
+        cudaStream_t stream) override;
+
+    bool supportsFusedActScale(tkc::CutlassGemmConfig const& gemmConfig) const override;
+
     // Disabled since the fused GEMM, activation kernels will not be used in v1.
 
     // void gemm_bias_act(const T* A, const WeightType* B, const T* weight_scales, const T* biases, T* C, int m, int n,
@@ -130,7 +147,8 @@ private:
     void dispatch_to_arch(ActivationType const* A, WeightType const* B, ScaleZeroType const* weight_scales,
         ScaleZeroType const* weight_zero_points, BiasType const* biases, float const alpha, OutputType* C, int m, int n,
         int k, int const group_size, tkc::CutlassGemmConfig gemm_config, char* workspace_ptr,
-        const size_t workspace_bytes, cudaStream_t stream, int* occupancy = nullptr);
+        const size_t workspace_bytes, cudaStream_t stream, int* occupancy = nullptr,
+        ActivationType const* act_scale = nullptr);
 
 private:
     int sm_;
@@ -57,7 +57,7 @@ template <typename ActivationType, typename WeightType, typename ScaleZeroType,
 void generic_mixed_gemm_kernelLauncher(ActivationType const* A, WeightType const* B, ScaleZeroType const* weight_scales,
     ScaleZeroType const* weight_zero_points, BiasType const* biases, float const alpha, OutputType* C, int m, int n,
     int k, int const group_size, tkc::CutlassGemmConfig gemm_config, char* workspace, size_t workspace_bytes,
-    cudaStream_t stream, int* occupancy = nullptr)
+    cudaStream_t stream, int* occupancy = nullptr, ActivationType const* act_scale = nullptr)
 {
     TLLM_LOG_DEBUG(__PRETTY_FUNCTION__);
 
@@ -184,6 +184,15 @@ void generic_mixed_gemm_kernelLauncher(ActivationType const* A, WeightType const
         {reinterpret_cast<CutlassOutputType*>(C), n}, gemm_config.split_k_factor,
         {ElementAccumulator(alpha), output_op_beta});
 
+    if (act_scale != nullptr)
+    {
+        if constexpr (!GemmKernel::Mma::kSupportsActScale)
+        {
+            throw std::runtime_error("Per channel activation scales can't be fused into the mainloop of this config.");
+        }
+        args.ptr_act_scale = reinterpret_cast<CutlassActivationType const*>(act_scale);
+    }
+
     // This assertion is enabled because because for the column interleaved layout, K MUST be a multiple of
     // threadblockK. The reason for this is that the default pitchlinear iterators are used to handle walking over the
     // interleaved matrix. The way masking in handled in these do not map to the interleaved layout. We need to write
@@ -238,7 +247,7 @@ template <typename ActivationType, typename WeightType, typename ScaleZeroType,
 void filter_and_run_mixed_gemm(ActivationType const* A, WeightType const* B, ScaleZeroType const* weight_scales,
     ScaleZeroType const* weight_zero_points, BiasType const* biases, float const alpha, OutputType* C, int m, int n,
     int k, int const group_size, tkc::CutlassGemmConfig gemm_config, char* workspace, size_t workspace_bytes,
-    cudaStream_t stream, int* occupancy = nullptr)
+    cudaStream_t stream, int* occupancy = nullptr, ActivationType const* act_scale = nullptr)
 {
 
     TLLM_LOG_DEBUG(__PRETTY_FUNCTION__);
@@ -268,7 +277,7 @@ void filter_and_run_mixed_gemm(ActivationType const* A, WeightType const* B, Sca
     {
         generic_mixed_gemm_kernelLauncher<ActivationType, WeightType, ScaleZeroType, BiasType, OutputType, arch,
             QuantOp, EpilogueTag, ThreadblockShape, WarpShape, Stages>(A, B, weight_scales, weight_zero_points, biases,
-            alpha, C, m, n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy);
+            alpha, C, m, n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy, act_scale);
     }
 }
 
@@ -278,7 +287,7 @@ template <typename ActivationType, typename WeightType, typename ScaleZeroType,
 void dispatch_gemm_config(ActivationType const* A, WeightType const* B, ScaleZeroType const* weight_scales,
     ScaleZeroType const* weight_zero_points, BiasType const* biases, float const alpha, OutputType* C, int m, int n,
     int k, int const group_size, tkc::CutlassGemmConfig gemm_config, char* workspace, size_t workspace_bytes,
-    cudaStream_t stream, int* occupancy = nullptr)
+    cudaStream_t stream, int* occupancy = nullptr, ActivationType const* act_scale = nullptr)
 {
 
     TLLM_LOG_DEBUG(__PRETTY_FUNCTION__);
@@ -287,17 +296,17 @@ void dispatch_gemm_config(ActivationType const* A, WeightType const* B, ScaleZer
     case 2:
         filter_and_run_mixed_gemm<ActivationType, WeightType, ScaleZeroType, BiasType, OutputType, arch, QuantOp,
             EpilogueTag, ThreadblockShape, WarpShape, 2>(A, B, weight_scales, weight_zero_points, biases, alpha, C, m,
-            n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy);
+            n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy, act_scale);
         break;
     case 3:
         filter_and_run_mixed_gemm<ActivationType, WeightType, ScaleZeroType, BiasType, OutputType, arch, QuantOp,
             EpilogueTag, ThreadblockShape, WarpShape, 3>(A, B, weight_scales, weight_zero_points, biases, alpha, C, m,
-            n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy);
+            n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy, act_scale);
         break;
     case 4:
         filter_and_run_mixed_gemm<ActivationType, WeightType, ScaleZeroType, BiasType, OutputType, arch, QuantOp,
             EpilogueTag, ThreadblockShape, WarpShape, 4>(A, B, weight_scales, weight_zero_points, biases, alpha, C, m,
-            n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy);
+            n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy, act_scale);
         break;
     default:
         std::string err_msg = "dispatch_gemm_config does not support stages " + std::to_string(gemm_config.stages);
@@ -317,7 +326,7 @@ template <typename ActivationType, typename WeightType, typename ScaleZeroType,
 void dispatch_gemm_to_cutlass(ActivationType const* A, WeightType const* B, ScaleZeroType const* weight_scales,
     ScaleZeroType const* weight_zero_points, BiasType const* biases, float const alpha, OutputType* C, int m, int n,
     int k, int const group_size, char* workspace, size_t workspace_bytes, tkc::CutlassGemmConfig gemm_config,
-    cudaStream_t stream, int* occupancy = nullptr)
+    cudaStream_t stream, int* occupancy = nullptr, ActivationType const* act_scale = nullptr)
 {
 
     TLLM_LOG_DEBUG(__PRETTY_FUNCTION__);
@@ -346,7 +355,8 @@ void dispatch_gemm_to_cutlass(ActivationType const* A, WeightType const* B, Scal
                 dispatch_gemm_config<ActivationType, WeightType, ScaleZeroType, BiasType, OutputType, arch, QuantOp,
                     EpilogueTag, cutlass::gemm::GemmShape<16, 128, tile_shape_k>,
                     cutlass::gemm::GemmShape<16, 32, tile_shape_k>>(A, B, weight_scales, weight_zero_points, biases,
-                    alpha, C, m, n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy);
+                    alpha, C, m, n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy,
+                    act_scale);
             }
             break;
         case tkc::CutlassTileConfig::CtaShape16x256x64_WarpShape16x64x64:
@@ -356,20 +366,21 @@ void dispatch_gemm_to_cutlass(ActivationType const* A, WeightType const* B, Scal
                 dispatch_gemm_config<ActivationType, WeightType, ScaleZeroType, BiasType, OutputType, arch, QuantOp,
                     EpilogueTag, cutlass::gemm::GemmShape<16, 256, tile_shape_k>,
                     cutlass::gemm::GemmShape<16, 64, tile_shape_k>>(A, B, weight_scales, weight_zero_points, biases,
-                    alpha, C, m, n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy);
+                    alpha, C, m, n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy,
+                    act_scale);
             }
             break;
         case tkc::CutlassTileConfig::CtaShape32x128x64_WarpShape32x32x64:
             dispatch_gemm_config<ActivationType, WeightType, ScaleZeroType, BiasType, OutputType, arch, QuantOp,
                 EpilogueTag, cutlass::gemm::GemmShape<32, 128, tile_shape_k>,
                 cutlass::gemm::GemmShape<32, 32, tile_shape_k>>(A, B, weight_scales, weight_zero_points, biases, alpha,
-                C, m, n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy);
+                C, m, n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy, act_scale);
             break;
         case tkc::CutlassTileConfig::CtaShape64x128x64_WarpShape64x32x64:
             dispatch_gemm_config<ActivationType, WeightType, ScaleZeroType, BiasType, OutputType, arch, QuantOp,
                 EpilogueTag, cutlass::gemm::GemmShape<64, 128, tile_shape_k>,
                 cutlass::gemm::GemmShape<64, 32, tile_shape_k>>(A, B, weight_scales, weight_zero_points, biases, alpha,
-                C, m, n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy);
+                C, m, n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy, act_scale);
             break;
         case tkc::CutlassTileConfig::CtaShape128x128x64_WarpShape128x32x64:
             TLLM_CHECK_WITH_INFO(arch::kMinComputeCapability >= 75, "Invalid config on Volta");
@@ -378,7 +389,8 @@ void dispatch_gemm_to_cutlass(ActivationType const* A, WeightType const* B, Scal
                 dispatch_gemm_config<ActivationType, WeightType, ScaleZeroType, BiasType, OutputType, arch, QuantOp,
                     EpilogueTag, cutlass::gemm::GemmShape<128, 128, tile_shape_k>,
                     cutlass::gemm::GemmShape<128, 32, tile_shape_k>>(A, B, weight_scales, weight_zero_points, biases,
-                    alpha, C, m, n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy);
+                    alpha, C, m, n, k, group_size, gemm_config, workspace, workspace_bytes, stream, occupancy,
+                    act_scale);
             }
             break;
         case tkc::CutlassTileConfig::Undefined:
@@ -430,9 +442,12 @@ void CutlassFpAIntBGemmRunner<ActivationType, WeightType, QuantOp, ScaleZeroType
     OutputType>::dispatch_to_arch<EpilogueTag>(ActivationType const* A, WeightType const* B,
     ScaleZeroType const* weight_scales, ScaleZeroType const* weight_zero_points, BiasType const* biases,
     float const alpha, OutputType* C, int m, int n, int k, int const group_size, tkc::CutlassGemmConfig gemm_config,
-    char* workspace_ptr, const size_t workspace_bytes, cudaStream_t stream, int* occupancy)
+    char* workspace_ptr, const size_t workspace_bytes, cudaStream_t stream, int* occupancy,
+    ActivationType const* act_scale)
 {
     TLLM_LOG_DEBUG(__PRETTY_FUNCTION__);
+    TLLM_CHECK_WITH_INFO(act_scale == nullptr || (sm_ >= 80 && sm_ <= 89),
+        "Per channel activation scales are only fused into the SM80 mainloop.");
     if (sm_ >= 70 && sm_ < 75)
     {
         dispatch_gemm_to_cutlass<ActivationType, WeightType, ScaleZeroType, BiasType, OutputType, cutlass::arch::Sm70,
@@ -449,7 +464,7 @@ void CutlassFpAIntBGemmRunner<ActivationType, WeightType, QuantOp, ScaleZeroType
     {
         dispatch_gemm_to_cutlass<ActivationType, WeightType, ScaleZeroType, BiasType, OutputType, cutlass::arch::Sm80,
             QuantOp, EpilogueTag>(A, B, weight_scales, weight_zero_points, biases, alpha, C, m, n, k, group_size,
-            workspace_ptr, workspace_bytes, gemm_config, stream, occupancy);
+            workspace_ptr, workspace_bytes, gemm_config, stream, occupancy, act_scale);
     }
     else if (sm_ == 89)
     {
@@ -463,7 +478,7 @@ void CutlassFpAIntBGemmRunner<ActivationType, WeightType, QuantOp, ScaleZeroType
 #endif
         dispatch_gemm_to_cutlass<ActivationType, WeightType, ScaleZeroType, BiasType, OutputType, cutlass::arch::Sm89,
             QuantOp, EpilogueTag>(A, B, weight_scales, weight_zero_points, biases, alpha, C, m, n, k, group_size,
-            workspace_ptr, workspace_bytes, gemm_config, stream, occupancy);
+            workspace_ptr, workspace_bytes, gemm_config, stream, occupancy, act_scale);
     }
     else if (sm_ == 90)
     {
@@ -501,6 +516,37 @@ void CutlassFpAIntBGemmRunner<ActivationType, WeightType, QuantOp, ScaleZeroType
     }
 }
 
+template <typename ActivationType, typename WeightType, cutlass::WeightOnlyQuantOp QuantOp, typename ScaleZeroType,
+    typename BiasType, typename OutputType>
+void CutlassFpAIntBGemmRunner<ActivationType, WeightType, QuantOp, ScaleZeroType, BiasType, OutputType>::gemm(
+    void const* A, void const* act_scale, void const* B, void const* weight_scales, void const* weight_zero_points,
+    void const* biases, float const alpha, void* C, int m, int n, int k, int const group_size,
+    tkc::CutlassGemmConfig gemmConfig, char* workspace_ptr, const size_t workspace_bytes, cudaStream_t stream)
+{
+    TLLM_LOG_DEBUG(__PRETTY_FUNCTION__);
+    TLLM_CHECK_WITH_INFO(supportsFusedActScale(gemmConfig),
+        "Per channel activation scales can't be fused into the mainloop of this config.");
+    if constexpr ((QuantOp == cutlass::WeightOnlyQuantOp::FINEGRAINED_SCALE_AND_ZEROS)
+        || (QuantOp == cutlass::WeightOnlyQuantOp::FINEGRAINED_SCALE_ONLY))
+    {
+        dispatch_to_arch<tkc::EpilogueOpBias>((ActivationType const*) A, (WeightType const*) B,
+            (ScaleZeroType const*) weight_scales, (ScaleZeroType const*) weight_zero_points, (BiasType const*) biases,
+            alpha, (OutputType*) C, m, n, k, group_size, gemmConfig, workspace_ptr, workspace_bytes, stream, nullptr,
+            (ActivationType const*) act_scale);
+    }
+}
+
+template <typename ActivationType, typename WeightType, cutlass::WeightOnlyQuantOp QuantOp, typename ScaleZeroType,
+    typename BiasType, typename OutputType>
+bool CutlassFpAIntBGemmRunner<ActivationType, WeightType, QuantOp, ScaleZeroType, BiasType,
+    OutputType>::supportsFusedActScale(tkc::CutlassGemmConfig const& gemmConfig) const
+{
+    // Only the multistage fine grained mainloop of SM80 and SM89 scales the 16-bit activations; the two stage configs
+    // use the pipelined mainloop.
+    return cutlass::isFinegrained(QuantOp) && sizeof(ActivationType) == 2 && sm_ >= 80 && sm_ <= 89
+        && gemmConfig.stages > 2;
+}
+
 template <typename ActivationType, typename WeightType, cutlass::WeightOnlyQuantOp QuantOp, typename ScaleZeroType,
     typename BiasType, typename OutputType>
 void CutlassFpAIntBGemmRunner<ActivationType, WeightType, QuantOp, ScaleZeroType, BiasType, OutputType>::gemm(
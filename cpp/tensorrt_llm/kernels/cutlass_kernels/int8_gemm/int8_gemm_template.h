@@ -128,7 +128,10 @@ void genericInt8GemmKernelLauncher(int8_t const* A, int8_t const* B, tk::QuantMo
 
     typename EpilogueOp::Params linearScalingParams; // TODO: right now it's unused (scaling is done in
                                                      // visitor, no activation needed)
-    typename Gemm::Arguments args{cutlass::gemm::GemmUniversalMode::kBatched, {m, n, k}, 1,
+    // Serial split-K: the partitions of K add their scaled partial results to the output one after another, which
+    // fills the SMs for the skinny shapes that have too few output tiles.
+    int const splitK = gemmConfig.split_k_style == tkc::SplitKStyle::SPLIT_K_SERIAL ? gemmConfig.split_k_factor : 1;
+    typename Gemm::Arguments args{cutlass::gemm::GemmUniversalMode::kGemm, {m, n, k}, splitK,
         {reinterpret_cast<ElementInput*>(const_cast<ElementInput*>(A)), k},
         {reinterpret_cast<ElementInput*>(const_cast<ElementInput*>(B)), k}, quantOption,
         {reinterpret_cast<ElementCompute*>(const_cast<float*>(alphaCol)), 0},
@@ -383,7 +386,7 @@ size_t CutlassInt8GemmRunner<T>::getWorkspaceSize(int const m, int const n, int
     TLLM_LOG_DEBUG(__PRETTY_FUNCTION__);
     // These are the min tile sizes for each config, which would launch the maximum number of blocks
     int const maxGridM = cutlass::ceil_div(m, MIN_M_TILE);
-    int const maxGridN = cutlass::ceil_div(m, MIN_N_TILE);
+    int const maxGridN = cutlass::ceil_div(n, MIN_N_TILE);
     // We need 4 bytes per block in the worst case. We launch SPLIT_K_LIMIT in z dim.
     return static_cast<size_t>(maxGridM * maxGridN * SPLIT_K_LIMIT * 4);
 }
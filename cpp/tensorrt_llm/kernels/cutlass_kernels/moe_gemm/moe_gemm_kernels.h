@@ -178,7 +178,8 @@ public:
 
     bool isHopperSpecialised() const;
     bool supportsHopperSpecialisation() const;
-    [[nodiscard]] bool isFusedGatedActivation(bool is_gated_activation, int gemm_n, int gemm_k) const;
+    [[nodiscard]] bool isFusedGatedActivation(
+        bool is_gated_activation, int gemm_n, int gemm_k, bool has_bias) const;
 
     size_t calcMaxWorkspaceSize(int num_experts) const;
 
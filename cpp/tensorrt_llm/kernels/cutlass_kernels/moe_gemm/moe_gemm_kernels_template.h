@@ -68,6 +68,105 @@ namespace kernels::cutlass_kernels
 {
 
 // ============================= Variable batched Gemm things ===========================
+
+// Experts with at most this many rows fill a single row of 16 x N tiles
+constexpr int64_t kMoeLightExpertRows = 16;
+
+// Runs one persistent grouped GEMM over the experts whose row count lies in [min_problem_rows, max_problem_rows], a
+// negative max_problem_rows meaning no upper bound. The CTAs walk the (expert, tile) work items on device, so experts
+// outside the range or without rows cost nothing. A non-void GatedActivation computes a gated FC1 with gemm_n output
+// columns from 2 * gemm_n weight columns, see MoeFCGemm.
+template <typename T, typename WeightType, typename arch, typename EpilogueTag, typename ThreadblockShape,
+    typename WarpShape, int Stages, typename GatedActivation = void>
+void runMoeGroupedGemm(T const* A, WeightType const* B, T const* weight_scales, T const* biases, T* C,
+    int64_t* total_rows_before_expert, int64_t gemm_n, int64_t gemm_k, int num_experts,
+    int const multi_processor_count, cudaStream_t stream, int* kernel_occupancy = nullptr,
+    int64_t min_problem_rows = 0, int64_t max_problem_rows = -1)
+{
+    // The cutlass type for the input elements. This is needed to convert to cutlass::half_t if necessary.
+    using ElementType = typename TllmToCutlassTypeAdapter<T>::type;
+    using CutlassWeightType = typename TllmToCutlassTypeAdapter<WeightType>::type;
+
+    // We need separate config for each architecture since we will target different tensorcore instructions. For
+    // float, we do not target TCs.
+    using MixedGemmArchTraits = cutlass::gemm::kernel::MixedGemmArchTraits<ElementType, CutlassWeightType, arch>;
+    using ElementAccumulator = typename MixedGemmArchTraits::AccType;
+
+    using EpilogueOp = typename tensorrt_llm::cutlass_extensions::Epilogue<ElementType,
+        MixedGemmArchTraits::ElementsPerAccessC, ElementAccumulator, EpilogueTag>::Op;
+
+    // Finally, set up the kernel.
+    using GemmKernel_ = typename cutlass::gemm::kernel::DefaultGemmGrouped<ElementType, cutlass::layout::RowMajor,
+        cutlass::ComplexTransform::kNone, MixedGemmArchTraits::ElementsPerAccessA, CutlassWeightType,
+        typename MixedGemmArchTraits::LayoutB, cutlass::ComplexTransform::kNone,
+        MixedGemmArchTraits::ElementsPerAccessB, ElementType, cutlass::layout::RowMajor, ElementAccumulator,
+        typename MixedGemmArchTraits::OperatorClass, arch, ThreadblockShape, WarpShape,
+        typename MixedGemmArchTraits::InstructionShape, EpilogueOp,
+        cutlass::gemm::threadblock::GemmBatchedIdentityThreadblockSwizzle, Stages,
+        cutlass::gemm::kernel::GroupScheduleMode::kDeviceOnly, typename MixedGemmArchTraits::Operator>::GemmKernel;
+
+    using GemmKernel = cutlass::gemm::kernel::MoeFCGemm<typename GemmKernel_::Mma, typename GemmKernel_::Epilogue,
+        typename GemmKernel_::ThreadblockSwizzle,
+        arch, // Ensure top level arch is used for dispatch
+        GemmKernel_::kGroupScheduleMode, GatedActivation>;
+
+    using GemmGrouped = cutlass::gemm::device::GemmGrouped<GemmKernel>;
+
+    if (kernel_occupancy != nullptr)
+    {
+        *kernel_occupancy = tensorrt_llm::cutlass_extensions::compute_occupancy_for_kernel<GemmKernel>();
+        return;
+    }
+    TLLM_CHECK_WITH_INFO(!GemmKernel::kGated || biases == nullptr, "Gated MoE GEMM does not support bias");
+    int occupancy = std::min(2, GemmGrouped::maximum_active_blocks());
+    TLLM_CHECK_WITH_INFO(occupancy > 0, "GPU lacks the shared memory resources to run GroupedGEMM kernel");
+    int const threadblock_count = multi_processor_count * occupancy;
+
+    typename EpilogueOp::Params epilogue_op(
+        ElementAccumulator(1.f), biases ? ElementAccumulator(1.f) : ElementAccumulator(0.f));
+
+    int const group_size = gemm_k;
+    typename GemmGrouped::Arguments args(num_experts, threadblock_count, group_size, epilogue_op,
+        reinterpret_cast<ElementType const*>(A), reinterpret_cast<CutlassWeightType const*>(B),
+        reinterpret_cast<ElementType const*>(weight_scales), reinterpret_cast<ElementType const*>(biases),
+        reinterpret_cast<ElementType*>(C), total_rows_before_expert, gemm_n, gemm_k);
+    args.min_problem_rows = min_problem_rows;
+    args.max_problem_rows = max_problem_rows;
+
+    GemmGrouped gemm;
+
+    auto can_implement = gemm.can_implement(args);
+    TLLM_CHECK_WITH_INFO(can_implement == cutlass::Status::kSuccess,
+        "MoE FC kernel will fail for params. Error: " + std::string(cutlassGetStatusString(can_implement)));
+
+    auto init_status = gemm.initialize(args);
+    TLLM_CHECK_WITH_INFO(init_status == cutlass::Status::kSuccess,
+        "Failed to initialize cutlass variable batched gemm. Error: "
+            + std::string(cutlassGetStatusString(init_status)));
+
+    auto run_status = gemm.run(stream);
+    TLLM_CHECK_WITH_INFO(run_status == cutlass::Status::kSuccess,
+        "Failed to run cutlass variable batched gemm. Error: " + std::string(cutlassGetStatusString(run_status)));
+}
+
+// With skewed routing most experts of a decode step hold a handful of rows while a few hot experts hold many. A
+// single tile shape then either pads the light experts up to a tall tile or re-reads the weights of the hot experts
+// once per 16 rows. On SM80 and later, when the average expert fills less than half of the chosen tile, the light
+// experts run in a first launch with 16 row tiles and only the remaining experts use the chosen tile.
+template <typename T, typename WeightType, typename arch, typename ThreadblockShape>
+bool shouldSplitMoeGemmByLoad(int64_t num_rows, int num_experts)
+{
+    if constexpr (std::is_same_v<T, float> || arch::kMinComputeCapability < 80
+        || ThreadblockShape::kM <= 2 * kMoeLightExpertRows)
+    {
+        return false;
+    }
+    else
+    {
+        return num_rows > kMoeLightExpertRows && 2 * num_rows < num_experts * int64_t{ThreadblockShape::kM};
+    }
+}
+
 template <typename T, typename WeightType, typename arch, typename EpilogueTag, typename ThreadblockShape,
     typename WarpShape, int Stages>
 void genericMoeGemmKernelLauncher(T const* A, WeightType const* B, T const* weight_scales, T const* biases, T* C,
@@ -97,63 +196,24 @@ void genericMoeGemmKernelLauncher(T const* A, WeightType const* B, T const* weig
     using CutlassWeightType = typename TllmToCutlassTypeAdapter<WeightType>::type;
     if (!use_fused_moe)
     {
-        // We need separate config for each architecture since we will target different tensorcore instructions. For
-        // float, we do not target TCs.
-        using MixedGemmArchTraits = cutlass::gemm::kernel::MixedGemmArchTraits<ElementType, CutlassWeightType, arch>;
-        using ElementAccumulator = typename MixedGemmArchTraits::AccType;
-
-        using EpilogueOp = typename tensorrt_llm::cutlass_extensions::Epilogue<ElementType,
-            MixedGemmArchTraits::ElementsPerAccessC, ElementAccumulator, EpilogueTag>::Op;
-
-        // Finally, set up the kernel.
-        using GemmKernel_ = typename cutlass::gemm::kernel::DefaultGemmGrouped<ElementType, cutlass::layout::RowMajor,
-            cutlass::ComplexTransform::kNone, MixedGemmArchTraits::ElementsPerAccessA, CutlassWeightType,
-            typename MixedGemmArchTraits::LayoutB, cutlass::ComplexTransform::kNone,
-            MixedGemmArchTraits::ElementsPerAccessB, ElementType, cutlass::layout::RowMajor, ElementAccumulator,
-            typename MixedGemmArchTraits::OperatorClass, arch, ThreadblockShape, WarpShape,
-            typename MixedGemmArchTraits::InstructionShape, EpilogueOp,
-            cutlass::gemm::threadblock::GemmBatchedIdentityThreadblockSwizzle, Stages,
-            cutlass::gemm::kernel::GroupScheduleMode::kDeviceOnly, typename MixedGemmArchTraits::Operator>::GemmKernel;
-
-        using GemmKernel = cutlass::gemm::kernel::MoeFCGemm<typename GemmKernel_::Mma, typename GemmKernel_::Epilogue,
-            typename GemmKernel_::ThreadblockSwizzle,
-            arch, // Ensure top level arch is used for dispatch
-            GemmKernel_::kGroupScheduleMode>;
-
-        using GemmGrouped = cutlass::gemm::device::GemmGrouped<GemmKernel>;
-
-        if (kernel_occupancy != nullptr)
+        if constexpr (!std::is_same_v<T, float> && arch::kMinComputeCapability >= 80)
         {
-            *kernel_occupancy = tensorrt_llm::cutlass_extensions::compute_occupancy_for_kernel<GemmKernel>();
-            return;
+            if (kernel_occupancy == nullptr
+                && shouldSplitMoeGemmByLoad<T, WeightType, arch, ThreadblockShape>(num_rows, num_experts))
+            {
+                runMoeGroupedGemm<T, WeightType, arch, EpilogueTag, cutlass::gemm::GemmShape<16, 128, 64>,
+                    cutlass::gemm::GemmShape<16, 32, 64>, Stages>(A, B, weight_scales, biases, C,
+                    total_rows_before_expert, gemm_n, gemm_k, num_experts, multi_processor_count, stream, nullptr, 0,
+                    kMoeLightExpertRows);
+                runMoeGroupedGemm<T, WeightType, arch, EpilogueTag, ThreadblockShape, WarpShape, Stages>(A, B,
+                    weight_scales, biases, C, total_rows_before_expert, gemm_n, gemm_k, num_experts,
+                    multi_processor_count, stream, nullptr, kMoeLightExpertRows + 1);
+                return;
+            }
         }
-        int occupancy = std::min(2, GemmGrouped::maximum_active_blocks());
-        TLLM_CHECK_WITH_INFO(occupancy > 0, "GPU lacks the shared memory resources to run GroupedGEMM kernel");
-        int const threadblock_count = multi_processor_count * occupancy;
-
-        typename EpilogueOp::Params epilogue_op(
-            ElementAccumulator(1.f), biases ? ElementAccumulator(1.f) : ElementAccumulator(0.f));
-
-        int const group_size = gemm_k;
-        typename GemmGrouped::Arguments args(num_experts, threadblock_count, group_size, epilogue_op,
-            reinterpret_cast<ElementType const*>(A), reinterpret_cast<CutlassWeightType const*>(B),
-            reinterpret_cast<ElementType const*>(weight_scales), reinterpret_cast<ElementType const*>(biases),
-            reinterpret_cast<ElementType*>(C), total_rows_before_expert, gemm_n, gemm_k);
-
-        GemmGrouped gemm;
-
-        auto can_implement = gemm.can_implement(args);
-        TLLM_CHECK_WITH_INFO(can_implement == cutlass::Status::kSuccess,
-            "MoE FC kernel will fail for params. Error: " + std::string(cutlassGetStatusString(can_implement)));
-
-        auto init_status = gemm.initialize(args);
-        TLLM_CHECK_WITH_INFO(init_status == cutlass::Status::kSuccess,
-            "Failed to initialize cutlass variable batched gemm. Error: "
-                + std::string(cutlassGetStatusString(init_status)));
-
-        auto run_status = gemm.run(stream);
-        TLLM_CHECK_WITH_INFO(run_status == cutlass::Status::kSuccess,
-            "Failed to run cutlass variable batched gemm. Error: " + std::string(cutlassGetStatusString(run_status)));
+        runMoeGroupedGemm<T, WeightType, arch, EpilogueTag, ThreadblockShape, WarpShape, Stages>(A, B, weight_scales,
+            biases, C, total_rows_before_expert, gemm_n, gemm_k, num_experts, multi_processor_count, stream,
+            kernel_occupancy);
     }
     else if constexpr (sizeof(ElementType) == 2 && sizeof(CutlassWeightType) == 2
         && (std::is_same_v<EpilogueTag, cutlass_extensions::EpilogueOpDefaultSilu>
@@ -167,6 +227,22 @@ void genericMoeGemmKernelLauncher(T const* A, WeightType const* B, T const* weig
             reinterpret_cast<ElementType*>(C), total_rows_before_expert, num_rows, gemm_n, gemm_k, num_experts,
             multi_processor_count, stream, kernel_occupancy);
     }
+    else if constexpr (!std::is_same_v<T, WeightType>
+        && (std::is_same_v<EpilogueTag, cutlass_extensions::EpilogueOpDefaultSilu>
+            || std::is_same_v<EpilogueTag, cutlass_extensions::EpilogueOpDefaultFtGelu>) )
+    {
+        // Weight only quantized FC1, the gate is applied to the accumulators before an identity epilogue
+        using GatedActivation
+            = std::conditional_t<std::is_same_v<EpilogueTag, cutlass_extensions::EpilogueOpDefaultSilu>,
+                cutlass::epilogue::thread::SiLu<float>, cutlass::epilogue::thread::GELU<float>>;
+        runMoeGroupedGemm<T, WeightType, arch, cutlass_extensions::EpilogueOpDefault, ThreadblockShape, WarpShape,
+            Stages, GatedActivation>(A, B, weight_scales, biases, C, total_rows_before_expert, gemm_n, gemm_k,
+            num_experts, multi_processor_count, stream, kernel_occupancy);
+    }
+    else
+    {
+        TLLM_THROW("Fused gated activation is not supported for this MoE GEMM");
+    }
 }
 
 } // namespace kernels::cutlass_kernels
@@ -440,10 +516,12 @@ int MoeGemmRunner<T, WeightType>::getSM() const
 
 // currently support sm80 bf16/fp16 gate ativation, only set predication tensor for m direction
 template <typename T, typename WeightType>
-bool MoeGemmRunner<T, WeightType>::isFusedGatedActivation(bool is_gated_activation, int gemm_n, int gemm_k) const
+bool MoeGemmRunner<T, WeightType>::isFusedGatedActivation(
+    bool is_gated_activation, int gemm_n, int gemm_k, bool has_bias) const
 {
-    return is_gated_activation
-        && std::is_same_v<T, WeightType> && (!std::is_same_v<T, float>) &&(!this->isHopperSpecialised())
+    // Weight only quantized experts run the gated grouped GEMM, which does not add a bias
+    bool const supported_weights = std::is_same_v<T, WeightType> || !has_bias;
+    return is_gated_activation && supported_weights && (!std::is_same_v<T, float>) &&(!this->isHopperSpecialised())
         && this->getSM() >= 80 && (gemm_k % 32 == 0) && (gemm_n % 32 == 0);
 }
 
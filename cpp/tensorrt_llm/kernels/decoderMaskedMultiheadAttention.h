@@ -162,9 +162,10 @@ struct Multihead_attention_params_base
     float const* qkv_scale_quant_orig = nullptr;
     float const* attention_out_scale_orig_quant = nullptr;
 
-    // 8 bits kv cache scales.
+    // 8 bits kv cache scales, of shape [1] or [num_kv_heads] when kv_scale_per_head.
     float const* kv_scale_orig_quant = nullptr;
     float const* kv_scale_quant_orig = nullptr;
+    bool kv_scale_per_head = false;
 
     bool int8_kv_cache = false;
     bool fp8_kv_cache = false;
@@ -192,6 +193,14 @@ struct Multihead_attention_params_base
     int* block_counter = nullptr;
 
     int const* memory_length_per_sample = nullptr;
+
+    // KV compression of the paged self attention, for beam width 1 without cyclic KV cache.
+    // The attention probabilities of the cached tokens are added to their importance, summed over the heads and the
+    // layers. Dimensions B x max_attention_window_size.
+    float* kv_importance_scores = nullptr;
+    // The number of tokens evicted from the KV cache of each sequence. The cache holds length - evicted tokens, the
+    // rotary embedding of the new token keeps its position in the sequence. Dimensions B.
+    int const* kv_evicted_tokens = nullptr;
 };
 
 template <typename T, bool USE_CROSS_ATTENTION = false>
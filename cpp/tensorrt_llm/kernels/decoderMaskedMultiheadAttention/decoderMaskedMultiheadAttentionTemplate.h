@@ -21,6 +21,7 @@
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttentionUtils.h"
 #include "tensorrt_llm/kernels/gptKernels.h"
 #include "tensorrt_llm/kernels/kvCacheUtils.h"
+#include "tensorrt_llm/kernels/relativeAttentionBucket.cuh"
 #include <assert.h>
 #include <float.h>
 #include <type_traits>
@@ -1475,15 +1476,21 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
     // Compute relative attention bias on the fly, with relative attention table [head_num/TP, num_buckets] passed in.
     // num_buckets passed as relative_attention_bias_stride, max_distance passed as params.max_distance
     // this is a common optimization for both self attention and cross attention
-    int relative_attention_bias_stride
-        = params.relative_attention_bias_stride; // num_buckets might be modified below, save it beforehand
-    [[maybe_unused]] int max_distance = params.max_distance;
-
+    int relative_attention_bias_stride = params.relative_attention_bias_stride;
+    // T5 decoder attention only uses the bidirectional=False relative position logic
+    // (ref: tensorrt_llm/layers/attention.py compute_relative_bias())
+    [[maybe_unused]] RelativeAttentionBucketizer const relative_attention_bucketizer(
+        relative_attention_bias_stride, params.max_distance, false);
+
+    // The tokens evicted from the kv cache by the KV compression, which are not cached but count in the positions.
+    int const kv_evicted
+        = (!DO_CROSS_ATTENTION && params.kv_evicted_tokens) ? params.kv_evicted_tokens[batch_beam_idx] : 0;
     // The actual sequence length excluding the paddings.
     // minus 1 because it includes the current timestep while tlength denotes the kv cache length.
     int const tlength = DO_CROSS_ATTENTION
         ? params.memory_length_per_sample[batch_beam_idx] - 1
-        : (params.length_per_sample ? (params.length_per_sample[batch_beam_idx] - 1) : static_cast<int>(timestep));
+        : (params.length_per_sample ? (params.length_per_sample[batch_beam_idx] - 1 - kv_evicted)
+                                    : static_cast<int>(timestep));
     // We will use cyclic kv cache when it exceeds the limit.
     // The length position for storing new key and value.
     int const cyclic_tlength = kvCacheBuffer.getKVTokenIdx(tlength);
@@ -1501,7 +1508,7 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
     int const beam0_context_length
         = HAS_BEAMS && tlength > cyclic_kv_cache_len ? 0 : params.input_lengths[batch_beam_idx];
     // The position of the current timestep, and it is used to apply the position embedding
-    int const current_pos_idx = (!POS_SHIFT || DO_CROSS_ATTENTION) ? tlength : kv_loop_length;
+    int const current_pos_idx = (!POS_SHIFT || DO_CROSS_ATTENTION) ? tlength + kv_evicted : kv_loop_length;
 
     // The offset in the Q and K buffer also accounts for the batch.
     auto const qk_vec_idx = tidx * QK_VEC_SIZE;
@@ -1510,13 +1517,15 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
     bool const load_qkv_quant = params.qkv_scale_quant_orig != nullptr;
     bool const write_attention_quant = params.attention_out_scale_orig_quant != nullptr;
 
-    // Quant/Dequant scales for 8bits kv cache.
+    // Quant/Dequant scales for 8bits kv cache, per tensor or per kv head.
     using T_scale = typename kv_cache_scale_type_t<T, Tcache>::Type;
     T_scale kv_scale_orig_quant, k_scale_quant_orig;
-    float const k_scale_quant_orig_f = (ENABLE_8BITS_K_CACHE ? params.kv_scale_quant_orig[0] : 1.0f);
-    float const kv_scale_quant_orig_f = (ENABLE_8BITS_KV_CACHE ? params.kv_scale_quant_orig[0] : 1.0f);
+    unsigned const kv_scale_idx{params.kv_scale_per_head ? hi_kv : 0u};
+    float const k_scale_quant_orig_f = (ENABLE_8BITS_K_CACHE ? params.kv_scale_quant_orig[kv_scale_idx] : 1.0f);
+    float const kv_scale_quant_orig_f = (ENABLE_8BITS_KV_CACHE ? params.kv_scale_quant_orig[kv_scale_idx] : 1.0f);
     convert_from_float(&k_scale_quant_orig, k_scale_quant_orig_f);
-    convert_from_float(&kv_scale_orig_quant, (ENABLE_8BITS_KV_CACHE ? params.kv_scale_orig_quant[0] : 1.0f));
+    convert_from_float(
+        &kv_scale_orig_quant, (ENABLE_8BITS_KV_CACHE ? params.kv_scale_orig_quant[kv_scale_idx] : 1.0f));
 
     // Up to QK_VECS_PER_Dh_MAX threads load Q and K + the bias values for the current timestep.
     // Trigger the loads from the Q and K buffers.
@@ -1682,7 +1691,7 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
         constexpr int tidx_factor = (QK_VEC_SIZE > 1) ? QK_VEC_SIZE / 2 : 1;
         if (do_rotary)
         {
-            float rotary_embedding_m_scale = tlength <= params.rotary_embedding_original_max_positions
+            float rotary_embedding_m_scale = tlength + kv_evicted <= params.rotary_embedding_original_max_positions
                 ? params.rotary_embedding_short_m_scale
                 : params.rotary_embedding_long_m_scale;
             mmha::vec_from_smem_transpose(q, q_smem_, transpose_idx, smem_pitch);
@@ -1975,23 +1984,8 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
 
             if constexpr (IMPLICIT_REL_ATTN_BIAS)
             {
-                // Compute bias value on the fly (See bert_preprocess_kernels.cu::buildRelativeAttentionBias)
-                int relative_buckets = 0;
-                int relative_position = local_time_now - tlength;
-                int num_buckets = relative_attention_bias_stride;
-                // Special logic in T5 relative attention, both encoder & decoder use this, because
-                // relative_attention_bias is pre-computed once and passed around.
-                // T5 decoder attention now only uses bidirectional=False relative position logic
-                // (ref: tensorrt_llm/layers/attention.py compute_relative_bias())
-                relative_position = relative_position >= 0 ? 0 : -relative_position;
-
-                int max_exact = num_buckets / 2;
-                bool is_small = relative_position < max_exact;
-                int relative_position_if_large = max_exact
-                    + (int) (logf(relative_position * 1.0f / max_exact) / logf((float) max_distance / max_exact)
-                        * (num_buckets - max_exact));
-                relative_position_if_large = min(relative_position_if_large, num_buckets - 1);
-                relative_buckets += is_small ? relative_position : relative_position_if_large;
+                // Compute bias value on the fly from the [head_num, num_buckets] table
+                int const relative_buckets = relative_attention_bucketizer(local_time_now - tlength);
                 relative_attention_bias_ptr
                     = relative_attention_bias_ptr_fixed + (tlength - local_time_now) + relative_buckets;
             }
@@ -2119,23 +2113,8 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
 
             if constexpr (IMPLICIT_REL_ATTN_BIAS)
             {
-                // Compute bias value on the fly (See bert_preprocess_kernels.cu::buildRelativeAttentionBias)
-                int relative_buckets = 0;
-                int relative_position = time_now - tlength;
-                int num_buckets = relative_attention_bias_stride;
-                // Special logic in T5 relative attention, both encoder & decoder use this, because
-                // relative_attention_bias is pre-computed once and passed around.
-                // T5 decoder attention now only uses bidirectional=False relative position logic
-                // (ref: tensorrt_llm/layers/attention.py compute_relative_bias())
-                relative_position = relative_position >= 0 ? 0 : -relative_position;
-
-                int max_exact = num_buckets / 2;
-                bool is_small = relative_position < max_exact;
-                int relative_position_if_large = max_exact
-                    + (int) (logf(relative_position * 1.0f / max_exact) / logf((float) max_distance / max_exact)
-                        * (num_buckets - max_exact));
-                relative_position_if_large = min(relative_position_if_large, num_buckets - 1);
-                relative_buckets += is_small ? relative_position : relative_position_if_large;
+                // Compute bias value on the fly from the [head_num, num_buckets] table
+                int const relative_buckets = relative_attention_bucketizer(time_now - tlength);
                 relative_attention_bias_ptr
                     = relative_attention_bias_ptr_fixed + (tlength - time_now) + relative_buckets;
             }
@@ -2342,6 +2321,21 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
     float inv_sum = __fdividef(logit_scale, sum + 1.e-6f);
 
     int const normlization_loop_end = MULTI_BLOCK_FLAG ? timesteps_per_block : kv_loop_length;
+    // The importance of the cached tokens for the KV compression. In multi-block mode the global softmax isn't known
+    // yet, the probabilities within the tile are weighted by the share of the tile in the sequence.
+    float* kv_importance_row = nullptr;
+    float kv_importance_scale = 0.f;
+    if constexpr (!DO_CROSS_ATTENTION)
+    {
+        if (params.kv_importance_scores != nullptr)
+        {
+            kv_importance_row = params.kv_importance_scores
+                + static_cast<int64_t>(batch_beam_idx) * params.max_attention_window_size;
+            kv_importance_scale = MULTI_BLOCK_FLAG
+                ? __fdividef(static_cast<float>(timesteps_per_block), (sum + 1.e-6f) * (kv_loop_length + 1))
+                : __fdividef(1.f, sum + 1.e-6f);
+        }
+    }
     for (int ti = tidx; ti <= normlization_loop_end; ti += THREADS_PER_BLOCK)
     {
         int const time_now = MULTI_BLOCK_FLAG ? ti + c_tile_times_timesteps_per_block : ti;
@@ -2349,6 +2343,10 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
         if (!MULTI_BLOCK_FLAG)
         {
             convert_from_float(&logits_smem[ti], qk_smem[ti] * inv_sum);
+            if (kv_importance_row != nullptr)
+            {
+                atomicAdd(&kv_importance_row[ti], qk_smem[ti] * kv_importance_scale);
+            }
         }
         else
         {
@@ -2356,10 +2354,18 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
             if (time_now < kv_loop_length && ti != timesteps_per_block)
             {
                 convert_from_float(&logits_smem[ti], qk_smem[ti]);
+                if (kv_importance_row != nullptr)
+                {
+                    atomicAdd(&kv_importance_row[time_now], qk_smem[ti] * kv_importance_scale);
+                }
             }
             else if (time_now == kv_loop_length)
             {
                 convert_from_float(&logits_current_smem[0], qk_current_smem[0]);
+                if (kv_importance_row != nullptr)
+                {
+                    atomicAdd(&kv_importance_row[time_now], qk_current_smem[0] * kv_importance_scale);
+                }
             }
         }
     }
@@ -24,6 +24,7 @@
 #include "tensorrt_llm/kernels/multiHeadAttentionCommon.h"
 #include "xqaParams.h"
 #include <cstddef>
+#include <string>
 #include <utility>
 
 namespace tensorrt_llm
@@ -141,6 +142,18 @@ struct XQAKernelFullHasher
     }
 };
 
+// Key of the cubin in the on-disk warm-start cache, built from the fields since the struct has padding.
+inline std::string toWarmStartKey(XQAKernelFullHashKey const& s)
+{
+    auto const& load = s.load_key;
+    auto const& runtime = s.runtime_key;
+    return "xqa_sm" + std::to_string(load.sm) + "_dt" + std::to_string(load.data_type) + "_kv"
+        + std::to_string(runtime.kv_data_type) + "_hs" + std::to_string(runtime.head_size) + "_bs"
+        + std::to_string(runtime.beam_size) + "_qpkv" + std::to_string(runtime.num_q_heads_per_kv) + "_mt"
+        + std::to_string(runtime.m_tilesize) + "_tpp" + std::to_string(runtime.tokens_per_page) + "_p"
+        + std::to_string(runtime.paged_kv_cache) + "_mq" + std::to_string(runtime.multi_query_tokens);
+}
+
 // NOTE: we use int32_t sequence lengths as gpt attention plugins use int32_t for that.
 // XQA kernels assume all length should use uint32_t.
 // NOTE: Linear KV cache and paged KV cache uses the same structure.
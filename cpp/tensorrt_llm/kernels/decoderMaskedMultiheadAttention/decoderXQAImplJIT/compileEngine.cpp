@@ -20,6 +20,7 @@
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/stringUtils.h"
 #include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/startupProfiler.h"
 #include <string>
 #include <vector>
 
@@ -50,6 +51,8 @@ namespace jit
 
 CubinObj CompileEngine::compile() const
 {
+    auto const startupScope
+        = tensorrt_llm::runtime::StartupProfiler::getInstance().scope(tensorrt_llm::runtime::StartupPhase::kXQA_JIT);
     tllmXqaJitProgram program;
     tllmXqaJitContext context{/*sm=*/mSM,
         /*head_size=*/static_cast<uint32_t>(mXqaParams.head_size),
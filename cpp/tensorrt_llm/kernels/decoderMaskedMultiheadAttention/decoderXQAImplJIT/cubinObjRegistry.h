@@ -18,9 +18,12 @@
 
 #include "compileEngine.h"
 #include "serializationUtils.h"
+#include "tensorrt_llm/common/warmStartCache.h"
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQAImplCommon.h"
 #include <functional>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace tensorrt_llm
 {
@@ -121,7 +124,23 @@ public:
 
         TLLM_CHECK_WITH_INFO(compileEngine != nullptr, "Key not found; compileEngine shouldn't be nullptr.");
 
+        // The key holds the SM and all XQA params the cubin depends on, so cubins compiled by a previous run are valid.
+        // Key types need a toWarmStartKey() overload.
+        auto& warmStartCache = common::WarmStartCache::getInstance();
+        auto const warmStartKey = toWarmStartKey(key);
+        if (auto const cached = warmStartCache.load(warmStartKey))
+        {
+            auto insertResultIter = mMap.insert({key, CubinObj(cached->data(), cached->size())}).first;
+            return &(insertResultIter->second);
+        }
+
         CubinObj obj = compileEngine->compile();
+        if (warmStartCache.isEnabled())
+        {
+            std::vector<uint8_t> buffer(obj.getSerializationSize());
+            obj.serialize(buffer.data(), buffer.size());
+            warmStartCache.store(warmStartKey, buffer.data(), buffer.size());
+        }
         auto insertResultIter = mMap.insert({key, std::move(obj)}).first;
         return &(insertResultIter->second);
     }
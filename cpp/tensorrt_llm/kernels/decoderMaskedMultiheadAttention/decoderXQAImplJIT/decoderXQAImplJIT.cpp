@@ -22,6 +22,9 @@
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQARunner.h"
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/tensorMapUtils.h"
 #include "tensorrt_llm/kernels/unfusedAttentionKernels.h"
+#include <algorithm>
+#include <exception>
+#include <initializer_list>
 
 namespace
 {
@@ -89,7 +92,51 @@ void DecoderXQAImplJIT::initSupportedConfigs()
 
 bool DecoderXQAImplJIT::supportConfig(XQAParams const& xqaParams) const
 {
-    return mSupportedConfigs.find(getRuntimeHashKeyFromXQAParams(xqaParams)) != mSupportedConfigs.end();
+    auto const key = getRuntimeHashKeyFromXQAParams(xqaParams);
+    if (mFailedConfigs.find(key) != mFailedConfigs.end())
+    {
+        return false;
+    }
+    return mSupportedConfigs.find(key) != mSupportedConfigs.end() || isJitCompilable(xqaParams);
+}
+
+bool DecoderXQAImplJIT::isValidatedShape(XQAParams const& xqaParams)
+{
+    // Medusa kernels are compiled from a different CUDA source file, beam search only has the precompiled kernels.
+    if (xqaParams.multi_query_tokens || xqaParams.beam_width != 1)
+    {
+        return false;
+    }
+    if (xqaParams.num_kv_heads <= 0 || xqaParams.num_q_heads % xqaParams.num_kv_heads != 0)
+    {
+        return false;
+    }
+    auto const isOneOf = [](int value, std::initializer_list<int> validated)
+    { return std::find(validated.begin(), validated.end(), value) != validated.end(); };
+    if (!isOneOf(xqaParams.head_size, {64, 80, 96, 128, 160, 256}))
+    {
+        return false;
+    }
+    // All query heads of a KV head go to the M dimension of one CTA.
+    if (!isOneOf(xqaParams.num_q_heads / xqaParams.num_kv_heads, {1, 2, 4, 8, 16}))
+    {
+        return false;
+    }
+    return !xqaParams.paged_kv_cache || isOneOf(xqaParams.tokens_per_block, {16, 32, 64, 128});
+}
+
+bool DecoderXQAImplJIT::isJitCompilable(XQAParams const& xqaParams) const
+{
+    // The HMMA kernels need sm80+, the Hopper kernels are not in the JIT codepath yet.
+    if (mSM < kSM_80 || mSM >= kSM_90 || !isValidatedShape(xqaParams))
+    {
+        return false;
+    }
+    if (xqaParams.kv_cache_data_type == DATA_TYPE_E4M3)
+    {
+        return mSM >= kSM_89;
+    }
+    return xqaParams.kv_cache_data_type == xqaParams.data_type || xqaParams.kv_cache_data_type == DATA_TYPE_INT8;
 }
 
 bool DecoderXQAImplJIT::mayHavePerfGain(XQAParams const& xqaParams) const
@@ -140,8 +187,17 @@ void DecoderXQAImplJIT::prepare(XQAParams const& xqaParams)
 
     jit::CompileEngine compileEngine(mSM, xqaParams);
 
-    // Discard getCubin() result.
-    mCubinObjRegistry->getCubin(key, &compileEngine);
+    // Discard getCubin() result. A configuration that doesn't compile is not used, shouldUse() then returns false and
+    // the generation phase falls back to MMHA.
+    try
+    {
+        mCubinObjRegistry->getCubin(key, &compileEngine);
+    }
+    catch (std::exception const& e)
+    {
+        TLLM_LOG_WARNING("XQA JIT compilation failed, falling back to MMHA: %s", e.what());
+        mFailedConfigs.insert(key.runtime_key);
+    }
 }
 
 void DecoderXQAImplJIT::runWithKVLinearBuffer(
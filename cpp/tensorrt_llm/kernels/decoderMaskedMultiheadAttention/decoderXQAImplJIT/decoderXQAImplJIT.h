@@ -34,6 +34,10 @@ public:
     bool shouldUse(XQAParams const& xqaParams, bool forConfigurePlugin) override;
     void prepare(XQAParams const& xqaParams) override;
 
+    //! Whether the head size, head group size, tokens per block and beam width of xqaParams are among the shapes
+    //! validated for the JIT implementation (see xqaJitShapesTest), on top of the precompiled ones.
+    static bool isValidatedShape(XQAParams const& xqaParams);
+
 protected:
     void runWithKVLinearBuffer(
         XQAParams const& xqaParams, KVLinearBuffer const& kv_linear_buffer, cudaStream_t const& stream) override;
@@ -46,6 +50,8 @@ private:
     void initSupportedConfigs();
     //! Whether DecoderXQAImplJIT supports xqaParams.
     bool supportConfig(XQAParams const& xqaParams) const;
+    //! Whether xqaParams has a validated shape the XQA kernel can be compiled for on this SM.
+    bool isJitCompilable(XQAParams const& xqaParams) const;
     //! Whether DecoderXQAImplJIT has perf gain over the default (non-XQA-optimized) implementation.
     bool mayHavePerfGain(XQAParams const& xqaParams) const;
 
@@ -63,8 +69,10 @@ private:
     jit::CubinObjRegistry* mCubinObjRegistry;
     jit::CubinObjKey getCubinObjKeyFromXQAParams(XQAParams const& xqaParams) const;
 
-    //! The first prototype just takes whatever available from the Precompiled cubins.
+    //! Configurations of the precompiled cubins, the JIT implementation supports them on top of isJitCompilable().
     std::unordered_set<XQAKernelRuntimeHashKey, XQAKernelRuntimeHasher> mSupportedConfigs;
+    //! Configurations whose compilation failed in prepare(), they fall back to MMHA.
+    std::unordered_set<XQAKernelRuntimeHashKey, XQAKernelRuntimeHasher> mFailedConfigs;
 };
 
 } // namespace kernels
@@ -43,6 +43,14 @@ class XQAKernelList
 public:
     using TKernelMeta = XQAKernelMetaInfo;
 
+    struct XQAKernelFuncInfo
+    {
+        unsigned int mMetaInfoIndex;
+        unsigned int mSharedMemBytes;
+        CUfunction mDeviceFunction;
+        XQAKernelType mKernelType;
+    };
+
     XQAKernelList(Data_type type, unsigned int sm)
         : mDriver(tensorrt_llm::common::CUDADriverWrapper::getInstance())
         , mDataType(type)
@@ -53,6 +61,8 @@ public:
         mForceXQA = forceXQAKernels();
     }
 
+    //! Only indexes the kernels of the data type and SM. The cubin of a kernel is loaded on its first launch, so that
+    //! the modules of the head sizes, beam widths and KV cache types the engine doesn't use are never loaded.
     void loadXQAKernels()
     {
         if (!mFunctions.empty())
@@ -69,32 +79,8 @@ public:
             if (kernelMeta.mCubin == nullptr)
                 continue;
 
-            CUmodule hmod{0};
-            auto findModuleIter = mModules.find(kernelMeta.mCubin);
-            if (findModuleIter != mModules.end())
-            {
-                hmod = findModuleIter->second;
-            }
-            else
-            {
-                cuErrCheck(mDriver->cuModuleLoadData(&hmod, kernelMeta.mCubin), mDriver);
-                mModules.insert(std::make_pair(kernelMeta.mCubin, hmod));
-            }
-
             XQAKernelFuncInfo funcInfo{};
             funcInfo.mMetaInfoIndex = i;
-            cuErrCheck(mDriver->cuModuleGetFunction(&funcInfo.mDeviceFunction, hmod, kernelMeta.mFuncName), mDriver);
-            funcInfo.mSharedMemBytes = getGlobalVar<uint32_t>(mDriver, hmod, "smemSize", true).value();
-            funcInfo.mKernelType = getGlobalVar<XQAKernelType>(mDriver, hmod, "kernelType", false)
-                                       .value_or(XQAKernelType::kAMPERE_WARP_SPECIALIZED);
-
-            /* Set 46KB threshold here because we have to take static/driver shared memory into consideration. */
-            if (funcInfo.mSharedMemBytes >= 46 * 1024)
-            {
-                cuErrCheck(mDriver->cuFuncSetAttribute(funcInfo.mDeviceFunction,
-                               CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, funcInfo.mSharedMemBytes),
-                    mDriver);
-            }
             XQAKernelRuntimeHashKey hash_key{kernelMeta.mKVDataType, kernelMeta.mHeadDim, kernelMeta.mBeamWidth,
                 kernelMeta.mNumQHeadsOverKV, kernelMeta.mMTileSize, kernelMeta.mTokensPerPage, kernelMeta.mPagedKVCache,
                 kernelMeta.mMultiQueryTokens};
@@ -124,6 +110,34 @@ public:
         return findIter != mFunctions.end();
     }
 
+    //! Loads the cubins of the kernels a configuration may launch, so that its first launch doesn't, e.g. while a CUDA
+    //! graph is captured.
+    void prepare(XQAParams const& xqaParams) const
+    {
+        unsigned int head_size = xqaParams.head_size;
+        unsigned int beam_width = xqaParams.beam_width;
+        unsigned int num_q_heads_over_kv = xqaParams.num_q_heads / xqaParams.num_kv_heads;
+        unsigned int kernel_num_q_heads_over_kv = xqaParams.multi_query_tokens ? 0 : num_q_heads_over_kv;
+        // MultiQueryToken kernels use a M tile size of 16 or 32 depending on the number of query tokens.
+        for (unsigned int const mTileSize : {16U, 32U})
+        {
+            unsigned int kernel_m_tilesize = xqaParams.multi_query_tokens ? mTileSize : num_q_heads_over_kv;
+            XQAKernelRuntimeHashKey hash_key{xqaParams.kv_cache_data_type, head_size, beam_width,
+                kernel_num_q_heads_over_kv, kernel_m_tilesize,
+                xqaParams.paged_kv_cache ? static_cast<unsigned int>(xqaParams.tokens_per_block) : 0,
+                xqaParams.paged_kv_cache, xqaParams.multi_query_tokens};
+            // mFunctions doesn't change after the indexing, only its entries do.
+            if (mFunctions.count(hash_key) > 0)
+            {
+                getFunction(hash_key);
+            }
+            if (!xqaParams.multi_query_tokens)
+            {
+                break;
+            }
+        }
+    }
+
     bool mayHavePerfGain(XQAParams const& xqaParams, int multiprocessor_count) const
     {
         // NOTE: only XQA supports multi_query_tokens (Medusa mode).
@@ -221,14 +235,12 @@ public:
             kernel_num_q_heads_over_kv, kernel_m_tilesize,
             xqaParams.paged_kv_cache ? static_cast<unsigned int>(xqaParams.tokens_per_block) : 0,
             xqaParams.paged_kv_cache, xqaParams.multi_query_tokens};
-        auto const findIter = mFunctions.find(hash_key);
+        auto const funcInfo = getFunction(hash_key);
 
-        TLLM_CHECK_WITH_INFO(findIter != mFunctions.end(), "XQAKernelFunc not found.");
-
-        auto const& kernelMeta = mKernelMeta[findIter->second.mMetaInfoIndex];
-        const CUfunction func = findIter->second.mDeviceFunction;
-        unsigned int const shared_mem_bytes = findIter->second.mSharedMemBytes;
-        auto const kernelType = findIter->second.mKernelType;
+        auto const& kernelMeta = mKernelMeta[funcInfo.mMetaInfoIndex];
+        const CUfunction func = funcInfo.mDeviceFunction;
+        unsigned int const shared_mem_bytes = funcInfo.mSharedMemBytes;
+        auto const kernelType = funcInfo.mKernelType;
 
         if (xqaParams.multi_query_tokens)
         {
@@ -311,6 +323,49 @@ public:
     }
 
 private:
+    //! \returns The function of a kernel, loading its cubin on the first call.
+    XQAKernelFuncInfo getFunction(XQAKernelRuntimeHashKey const& hash_key) const
+    {
+        std::lock_guard<std::mutex> lock(mLoadMutex);
+        auto const findIter = mFunctions.find(hash_key);
+        TLLM_CHECK_WITH_INFO(findIter != mFunctions.end(), "XQAKernelFunc not found.");
+        auto& funcInfo = findIter->second;
+        if (funcInfo.mDeviceFunction != nullptr)
+        {
+            return funcInfo;
+        }
+
+        auto const& kernelMeta = mKernelMeta[funcInfo.mMetaInfoIndex];
+        CUmodule hmod{0};
+        auto findModuleIter = mModules.find(kernelMeta.mCubin);
+        if (findModuleIter != mModules.end())
+        {
+            hmod = findModuleIter->second;
+        }
+        else
+        {
+            cuErrCheck(mDriver->cuModuleLoadData(&hmod, kernelMeta.mCubin), mDriver);
+            mModules.insert(std::make_pair(kernelMeta.mCubin, hmod));
+        }
+
+        CUfunction deviceFunction{nullptr};
+        cuErrCheck(mDriver->cuModuleGetFunction(&deviceFunction, hmod, kernelMeta.mFuncName), mDriver);
+        funcInfo.mSharedMemBytes = getGlobalVar<uint32_t>(mDriver, hmod, "smemSize", true).value();
+        funcInfo.mKernelType = getGlobalVar<XQAKernelType>(mDriver, hmod, "kernelType", false)
+                                   .value_or(XQAKernelType::kAMPERE_WARP_SPECIALIZED);
+
+        /* Set 46KB threshold here because we have to take static/driver shared memory into consideration. */
+        if (funcInfo.mSharedMemBytes >= 46 * 1024)
+        {
+            cuErrCheck(mDriver->cuFuncSetAttribute(
+                           deviceFunction, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, funcInfo.mSharedMemBytes),
+                mDriver);
+        }
+        // Set last, a function that is set is fully loaded
+        funcInfo.mDeviceFunction = deviceFunction;
+        return funcInfo;
+    }
+
     static uint32_t getElemBytes(CUtensorMapDataType_enum dataType)
     {
         switch (dataType)
@@ -339,19 +394,13 @@ protected:
     TKernelMeta const* mKernelMeta;
     unsigned int mKernelMetaCount;
     unsigned int mSM;
-    std::unordered_map<unsigned long long const*, CUmodule> mModules;
+    mutable std::unordered_map<unsigned long long const*, CUmodule> mModules;
 
     bool mForceXQA = false;
 
-    struct XQAKernelFuncInfo
-    {
-        unsigned int mMetaInfoIndex;
-        unsigned int mSharedMemBytes;
-        CUfunction mDeviceFunction;
-        XQAKernelType mKernelType;
-    };
-
-    std::unordered_map<XQAKernelRuntimeHashKey, XQAKernelFuncInfo, XQAKernelRuntimeHasher> mFunctions;
+    // Only mMetaInfoIndex is set until the first launch of the kernel, see getFunction
+    mutable std::unordered_map<XQAKernelRuntimeHashKey, XQAKernelFuncInfo, XQAKernelRuntimeHasher> mFunctions;
+    mutable std::mutex mLoadMutex;
 };
 
 class XQAKernelLoader
@@ -420,16 +469,20 @@ void DecoderXQAImplPrecompiled::runDispatchBuffer(
 
 #undef XQA_KERNEL_RUN
 
-bool DecoderXQAImplPrecompiled::shouldUse(XQAParams const& xqaParams, bool /*forConfigurePlugin*/)
+bool DecoderXQAImplPrecompiled::shouldUse(XQAParams const& xqaParams, bool forConfigurePlugin)
 {
     XQAKernelList const* xqa_kernel = getXQAKernels(mRunner->mDataType, tensorrt_llm::common::getSMVersion());
-    return xqa_kernel->supportConfig(xqaParams)
-        && xqa_kernel->mayHavePerfGain(xqaParams, mRunner->mMultiProcessorCount);
+    bool const is_config_supported = xqa_kernel->supportConfig(xqaParams);
+    if (forConfigurePlugin)
+    {
+        return is_config_supported;
+    }
+    return is_config_supported && xqa_kernel->mayHavePerfGain(xqaParams, mRunner->mMultiProcessorCount);
 }
 
-void DecoderXQAImplPrecompiled::prepare(XQAParams const&)
+void DecoderXQAImplPrecompiled::prepare(XQAParams const& xqaParams)
 {
-    // Intentionally do nothing.
+    getXQAKernels(mRunner->mDataType, tensorrt_llm::common::getSMVersion())->prepare(xqaParams);
 }
 
 void DecoderXQAImplPrecompiled::runWithKVLinearBuffer(
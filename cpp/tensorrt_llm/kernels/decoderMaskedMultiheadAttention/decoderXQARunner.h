@@ -21,6 +21,7 @@
 
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
 #include "tensorrt_llm/common/quantization.h"
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQAImplJIT/cubinObjRegistry.h"
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQAImplJIT/decoderXQAImplJIT.h"
@@ -71,6 +72,7 @@ struct XQADispatchHelper<__nv_bfloat16, KVBlockArray>
 
 #define SUPPORT_RETURN_FALSE(X)                                                                                        \
     {                                                                                                                  \
+        TLLM_LOG_DEBUG("XQA is not used, unsupported %s.", X);                                                         \
         return false;                                                                                                  \
     }
 
@@ -95,9 +97,17 @@ public:
         {
             SUPPORT_RETURN_FALSE("data type");
         }
+        if (xqaParams.num_kv_heads <= 0 || xqaParams.num_q_heads % xqaParams.num_kv_heads != 0)
+        {
+            SUPPORT_RETURN_FALSE("nbHeads");
+        }
+        // Shapes without a precompiled cubin are only used when TRTLLM_ENABLE_XQA_JIT is set, see
+        // DecoderXQAImplJIT::isValidatedShape.
+        bool const isJITShape
+            = tensorrt_llm::common::getEnvEnableXQAJIT() && DecoderXQAImplJIT::isValidatedShape(xqaParams);
         bool const isGPTJBeam4Kernel = (xqaParams.head_size == 256 && xqaParams.beam_width == 4
             && xqaParams.paged_kv_cache && (xqaParams.tokens_per_block == 64 || xqaParams.tokens_per_block == 128));
-        if (xqaParams.head_size != 128 && xqaParams.head_size != 256 && !isGPTJBeam4Kernel)
+        if (xqaParams.head_size != 128 && xqaParams.head_size != 256 && !isGPTJBeam4Kernel && !isJITShape)
         {
             SUPPORT_RETURN_FALSE("head_size");
         }
@@ -118,7 +128,8 @@ public:
             SUPPORT_RETURN_FALSE("cross_attention");
         }
         // Only support 64/128 tokens per block.
-        if (xqaParams.paged_kv_cache && xqaParams.tokens_per_block != 64 && xqaParams.tokens_per_block != 128)
+        if (xqaParams.paged_kv_cache && xqaParams.tokens_per_block != 64 && xqaParams.tokens_per_block != 128
+            && !isJITShape)
         {
             SUPPORT_RETURN_FALSE("paged_kv_cache");
         }
@@ -147,7 +158,7 @@ public:
         // MultiQueryTokens mode (Medusa mode) can support any nbQHeadsPerKV.
         if (!xqaParams.multi_query_tokens)
         {
-            if (nbQHeadsPerKV != 8 && nbQHeadsPerKV != 1)
+            if (nbQHeadsPerKV != 8 && nbQHeadsPerKV != 1 && !isJITShape)
             {
                 SUPPORT_RETURN_FALSE("nbHeads");
             }
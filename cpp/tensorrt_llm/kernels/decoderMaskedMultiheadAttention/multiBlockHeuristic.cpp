@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/multiBlockHeuristic.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+MultiBlockHeuristic const& MultiBlockHeuristic::getInstance()
+{
+    static MultiBlockHeuristic const instance = []()
+    {
+        MultiBlockHeuristic heuristic;
+        auto const tablePath = common::getEnvMmhaMultiBlockTable();
+        if (tablePath)
+        {
+            std::ifstream table(*tablePath);
+            TLLM_CHECK_WITH_INFO(table.good(), "Can't open the MMHA multi-block table %s.", tablePath->c_str());
+            heuristic.loadProfiledTable(table);
+            TLLM_LOG_INFO("Loaded the MMHA multi-block table %s.", tablePath->c_str());
+        }
+        return heuristic;
+    }();
+    return instance;
+}
+
+MultiBlockHeuristic::Decision MultiBlockHeuristic::decide(
+    int batchBeam, int numHeads, int kvLength, int multiProcessorCount, int maxNumSplits) const
+{
+    Decision decision;
+    if (maxNumSplits <= 1)
+    {
+        return decision;
+    }
+
+    auto const profiled = mProfiledSplits.find(Key{batchBeam, numHeads, multiProcessorCount});
+    if (profiled != mProfiledSplits.end())
+    {
+        // The entry of the longest profiled KV length that is not longer than the current one.
+        auto const entry = profiled->second.upper_bound(kvLength);
+        if (entry != profiled->second.begin())
+        {
+            decision.numSplits = std::clamp(std::prev(entry)->second, 1, maxNumSplits);
+            decision.profiled = true;
+            return decision;
+        }
+    }
+
+    auto const numBlocks = batchBeam * numHeads;
+    if (numBlocks >= multiProcessorCount)
+    {
+        // One wave without multi-block mode already keeps all SMs busy.
+        return decision;
+    }
+    auto const balancedNumSplits = (multiProcessorCount + numBlocks - 1) / numBlocks;
+    auto const maxSplitsForLength = std::max(kvLength / kMinTokensPerSplit, 1);
+    decision.numSplits = std::min({balancedNumSplits, maxSplitsForLength, maxNumSplits});
+    return decision;
+}
+
+void MultiBlockHeuristic::addProfiledEntry(
+    int batchBeam, int numHeads, int multiProcessorCount, int kvLength, int numSplits)
+{
+    TLLM_CHECK_WITH_INFO(batchBeam > 0 && numHeads > 0 && multiProcessorCount > 0 && kvLength >= 0 && numSplits > 0,
+        "Invalid MMHA multi-block table entry (%d, %d, %d, %d, %d).", batchBeam, kvLength, numHeads,
+        multiProcessorCount, numSplits);
+    mProfiledSplits[Key{batchBeam, numHeads, multiProcessorCount}][kvLength] = numSplits;
+}
+
+void MultiBlockHeuristic::loadProfiledTable(std::istream& table)
+{
+    std::string line;
+    while (std::getline(table, line))
+    {
+        auto const first = line.find_first_not_of(" \t");
+        if (first == std::string::npos || line[first] == '#')
+        {
+            continue;
+        }
+        std::istringstream entry(line);
+        int batchBeam, kvLength, numHeads, multiProcessorCount, numSplits;
+        TLLM_CHECK_WITH_INFO(
+            static_cast<bool>(entry >> batchBeam >> kvLength >> numHeads >> multiProcessorCount >> numSplits),
+            "Malformed MMHA multi-block table line: %s", line.c_str());
+        addProfiledEntry(batchBeam, numHeads, multiProcessorCount, kvLength, numSplits);
+    }
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
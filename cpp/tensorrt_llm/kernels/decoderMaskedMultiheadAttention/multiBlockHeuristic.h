@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <istream>
+#include <map>
+#include <string>
+#include <tuple>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+// Decides per generation step how many blocks (splits of the KV sequence) MMHA launches per sequence and head.
+// Multi-block mode pays off when batch * heads doesn't fill the GPU, e.g. few requests with a long context, as long as
+// every split still has enough KV tokens to amortize the final reduction. Profiled numbers of splits, keyed by
+// (batchBeam, numHeads, multiProcessorCount) and the shortest KV length they apply to, take precedence over the
+// built-in rule.
+class MultiBlockHeuristic
+{
+public:
+    struct Decision
+    {
+        // Number of blocks per sequence and head, 1 disables multi-block mode.
+        int numSplits{1};
+        // The number of splits comes from the profiled table and must be used as is.
+        bool profiled{false};
+    };
+
+    // Minimum number of KV tokens processed by one split.
+    static constexpr int kMinTokensPerSplit = 256;
+
+    // Returns the heuristic of the process, loaded once from TRTLLM_MMHA_MULTI_BLOCK_TABLE if set.
+    static MultiBlockHeuristic const& getInstance();
+
+    // maxNumSplits is the largest number of splits the workspace has been sized for.
+    Decision decide(int batchBeam, int numHeads, int kvLength, int multiProcessorCount, int maxNumSplits) const;
+
+    // Adds a profiled number of splits for KV lengths >= kvLength.
+    void addProfiledEntry(int batchBeam, int numHeads, int multiProcessorCount, int kvLength, int numSplits);
+
+    // Reads profiled entries, one per line as "batchBeam kvLength numHeads multiProcessorCount numSplits". Empty lines
+    // and lines starting with '#' are skipped.
+    void loadProfiledTable(std::istream& table);
+
+    bool hasProfiledEntries() const
+    {
+        return !mProfiledSplits.empty();
+    }
+
+private:
+    using Key = std::tuple<int, int, int>;
+
+    // KV length -> number of splits, per (batchBeam, numHeads, multiProcessorCount).
+    std::map<Key, std::map<int, int>> mProfiledSplits;
+};
+
+} // namespace kernels
+} // namespace tensorrt_llm
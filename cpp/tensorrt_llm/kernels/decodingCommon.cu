@@ -200,5 +200,7 @@ template void invokeScatterDecodingParams(
     uint32_t const* src, uint32_t* dst, int const* batchSlots, int batchSize, cudaStream_t stream);
 template void invokeScatterDecodingParams(
     int32_t const* src, int32_t* dst, int const* batchSlots, int batchSize, cudaStream_t stream);
+template void invokeScatterDecodingParams(
+    uint64_t const* src, uint64_t* dst, int const* batchSlots, int batchSize, cudaStream_t stream);
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cutlass/arch/mma_sm89.h"
+#include "cutlass/numeric_conversion.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/fp8BlockScaleGemm.h"
+
+#include <cub/cub.cuh>
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+#include <cuda_fp8.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+namespace fp8_block_scale_gemm
+{
+namespace
+{
+// GEMV for small M, same work split as fp8_gemm::fp8Gemm: every thread reads 16 consecutive values of K, which never
+// straddle two scale blocks.
+template <typename OutputType, SizeType32 TILE_M, SizeType32 TILE_N, SizeType32 BLOCK_SIZE>
+__global__ void fp8BlockScaleGemv(Params params)
+{
+    using VecType = int4;
+    static constexpr SizeType32 kStepK = static_cast<SizeType32>(sizeof(VecType));
+    static constexpr SizeType32 kTileK = kStepK * BLOCK_SIZE;
+    static_assert(kBlockScaleSize % kStepK == 0);
+    using Converter = cutlass::NumericArrayConverter<float, cutlass::float_e4m3_t, 4>;
+    using CvtSrcType = typename Converter::source_type;
+    using CvtResType = typename Converter::result_type;
+    static constexpr SizeType32 kCvtCount = static_cast<SizeType32>(sizeof(VecType) / sizeof(CvtSrcType));
+
+    SizeType32 const n = params.n;
+    SizeType32 const k = params.k;
+    SizeType32 const kBlocks = k / kBlockScaleSize;
+    auto const tileIdM = static_cast<SizeType32>(blockIdx.x * TILE_M);
+    auto const tileIdN = static_cast<SizeType32>(blockIdx.y * TILE_N);
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+    auto const* act = reinterpret_cast<__nv_fp8_e4m3 const*>(params.act) + tileIdM * k;
+    auto const* weight = reinterpret_cast<__nv_fp8_e4m3 const*>(params.weight) + tileIdN * k;
+    float const* actScales = params.act_scales + tileIdM * kBlocks;
+    float const* weightScales[TILE_N];
+#pragma unroll
+    for (SizeType32 j = 0; j < TILE_N; ++j)
+    {
+        weightScales[j] = params.weight_scales + ((tileIdN + j) / kBlockScaleSize) * kBlocks;
+    }
+
+    float tile_a[kStepK], tile_w[TILE_N * kStepK];
+    float acc[TILE_M * TILE_N];
+#pragma unroll
+    for (SizeType32 i = 0; i < TILE_M * TILE_N; ++i)
+    {
+        acc[i] = 0;
+    }
+    for (SizeType32 idxK = tid * kStepK; idxK < k; idxK += kTileK)
+    {
+        SizeType32 const kb = idxK / kBlockScaleSize;
+        float ws[TILE_N];
+#pragma unroll
+        for (SizeType32 j = 0; j < TILE_N; ++j)
+        {
+            ws[j] = weightScales[j][kb];
+            auto tile_w_quantized = reinterpret_cast<VecType const*>(weight + j * k + idxK)[0];
+#pragma unroll
+            for (SizeType32 cvtIdx = 0; cvtIdx < kCvtCount; ++cvtIdx)
+            {
+                reinterpret_cast<CvtResType*>(tile_w)[j * kCvtCount + cvtIdx]
+                    = Converter::convert(reinterpret_cast<CvtSrcType*>(&tile_w_quantized)[cvtIdx]);
+            }
+        }
+#pragma unroll
+        for (SizeType32 i = 0; i < TILE_M; ++i)
+        {
+            float const as = actScales[i * kBlocks + kb];
+            auto tile_a_quantized = reinterpret_cast<VecType const*>(act + i * k + idxK)[0];
+#pragma unroll
+            for (SizeType32 cvtIdx = 0; cvtIdx < kCvtCount; ++cvtIdx)
+            {
+                reinterpret_cast<CvtResType*>(tile_a)[cvtIdx]
+                    = Converter::convert(reinterpret_cast<CvtSrcType*>(&tile_a_quantized)[cvtIdx]);
+            }
+#pragma unroll
+            for (SizeType32 j = 0; j < TILE_N; ++j)
+            {
+                float dot = 0;
+#pragma unroll
+                for (SizeType32 l = 0; l < kStepK; ++l)
+                {
+                    dot = fma(tile_a[l], tile_w[j * kStepK + l], dot);
+                }
+                acc[i * TILE_N + j] = fma(dot, as * ws[j], acc[i * TILE_N + j]);
+            }
+        }
+    }
+
+    typedef cub::WarpReduce<float> WarpReduce;
+
+    static constexpr SizeType32 kWarpSize = 32;
+    static constexpr SizeType32 kWarpNum = BLOCK_SIZE / kWarpSize;
+    SizeType32 warpId = tid / kWarpSize, laneId = tid % kWarpSize;
+    __shared__ float shmem[TILE_M * TILE_N * kWarpNum];
+    __shared__ typename WarpReduce::TempStorage tempStorage[kWarpNum];
+#pragma unroll
+    for (SizeType32 mi = 0; mi < TILE_M; ++mi)
+    {
+#pragma unroll
+        for (SizeType32 ni = 0; ni < TILE_N; ++ni)
+        {
+            float val = WarpReduce(tempStorage[warpId]).Sum(acc[mi * TILE_N + ni]);
+            if (laneId == 0)
+            {
+                shmem[mi * TILE_N + ni + warpId * TILE_M * TILE_N] = val;
+            }
+        }
+    }
+    __syncthreads();
+    auto* output = reinterpret_cast<OutputType*>(params.output) + tileIdM * n + tileIdN;
+#pragma unroll
+    for (SizeType32 ii = tid; ii < TILE_M * TILE_N; ii += BLOCK_SIZE)
+    {
+        SizeType32 mid = ii / TILE_N, nid = ii % TILE_N;
+        float val = 0;
+#pragma unroll
+        for (SizeType32 jj = 0; jj < kWarpNum; ++jj)
+        {
+            val += shmem[jj * TILE_M * TILE_N + ii];
+        }
+        output[mid * n + nid] = static_cast<OutputType>(val);
+    }
+}
+
+template <typename OutputType, SizeType32 TILE_M, SizeType32 TILE_N, SizeType32 BLOCK_SIZE>
+void fp8BlockScaleGemvKernel(Params const& params, cudaStream_t stream)
+{
+    dim3 block(BLOCK_SIZE);
+    dim3 grid(params.m / TILE_M, params.n / TILE_N);
+    fp8BlockScaleGemv<OutputType, TILE_M, TILE_N, BLOCK_SIZE><<<grid, block, 0, stream>>>(params);
+}
+
+// Tensor core kernel: a block computes a kTileM x kTileN tile of the output, kTileK = kBlockScaleSize at a time. The
+// products of every K block are accumulated apart, then scaled by the activation and weight block scales and added to
+// the fp32 result. kTileN is the scale block size, so a block uses a single weight scale per K block.
+constexpr SizeType32 kTileM = 64;
+constexpr SizeType32 kTileN = kBlockScaleSize;
+constexpr SizeType32 kTileK = kBlockScaleSize;
+// 2 x 2 warps of kWarpM x kWarpN
+constexpr SizeType32 kWarpM = 32;
+constexpr SizeType32 kWarpN = 64;
+constexpr SizeType32 kMmaThreads = 128;
+// Padding of the shared memory rows, so the fragment loads of a warp hit distinct banks
+constexpr SizeType32 kSmemPad = 16;
+
+using Mma = cutlass::arch::Mma<cutlass::gemm::GemmShape<16, 8, 32>, 32, cutlass::float_e4m3_t,
+    cutlass::layout::RowMajor, cutlass::float_e4m3_t, cutlass::layout::ColumnMajor, float, cutlass::layout::RowMajor,
+    cutlass::arch::OpMultiplyAdd>;
+constexpr SizeType32 kMmaM = 16;
+constexpr SizeType32 kMmaN = 8;
+constexpr SizeType32 kMmaK = 32;
+constexpr SizeType32 kWarpTilesM = kWarpM / kMmaM;
+constexpr SizeType32 kWarpTilesN = kWarpN / kMmaN;
+
+// Loads rows [rowBegin, rowBegin + ROWS) of a row-major [numRows, k] fp8 matrix, K block kb, zero beyond numRows.
+template <SizeType32 ROWS>
+__device__ __forceinline__ void loadTile(uint8_t (*smem)[kTileK + kSmemPad], uint8_t const* src, SizeType32 rowBegin,
+    SizeType32 numRows, SizeType32 k, SizeType32 kb)
+{
+    static constexpr SizeType32 kVecsPerRow = kTileK / static_cast<SizeType32>(sizeof(int4));
+    for (SizeType32 i = threadIdx.x; i < ROWS * kVecsPerRow; i += kMmaThreads)
+    {
+        SizeType32 const row = i / kVecsPerRow;
+        SizeType32 const col = (i % kVecsPerRow) * static_cast<SizeType32>(sizeof(int4));
+        int4 v = make_int4(0, 0, 0, 0);
+        if (rowBegin + row < numRows)
+        {
+            v = *reinterpret_cast<int4 const*>(src + static_cast<size_t>(rowBegin + row) * k + kb * kTileK + col);
+        }
+        *reinterpret_cast<int4*>(&smem[row][col]) = v;
+    }
+}
+
+template <typename OutputType>
+__global__ void __launch_bounds__(kMmaThreads) fp8BlockScaleGemm(Params params)
+{
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 890
+    __shared__ __align__(16) uint8_t sA[kTileM][kTileK + kSmemPad];
+    __shared__ __align__(16) uint8_t sB[kTileN][kTileK + kSmemPad];
+
+    SizeType32 const m = params.m;
+    SizeType32 const n = params.n;
+    SizeType32 const k = params.k;
+    SizeType32 const kBlocks = k / kBlockScaleSize;
+    SizeType32 const tileM = blockIdx.x * kTileM;
+    SizeType32 const tileN = blockIdx.y * kTileN;
+    SizeType32 const warp = threadIdx.x / 32;
+    SizeType32 const lane = threadIdx.x % 32;
+    // Fragment layouts of mma.m16n8k32: the lane group gives the row of A and C and the column of B, the thread in
+    // the group gives 4 consecutive values of K, or 2 consecutive columns of C.
+    SizeType32 const group = lane / 4;
+    SizeType32 const threadInGroup = lane % 4;
+    SizeType32 const warpM = (warp / 2) * kWarpM;
+    SizeType32 const warpN = (warp % 2) * kWarpN;
+    auto const* act = reinterpret_cast<uint8_t const*>(params.act);
+    auto const* weight = reinterpret_cast<uint8_t const*>(params.weight);
+    float const* weightScales = params.weight_scales + blockIdx.y * kBlocks;
+
+    // Scales of the two rows of C a thread holds in every warp tile
+    SizeType32 actScaleRows[kWarpTilesM][2];
+#pragma unroll
+    for (SizeType32 mi = 0; mi < kWarpTilesM; ++mi)
+    {
+        actScaleRows[mi][0] = tileM + warpM + mi * kMmaM + group;
+        actScaleRows[mi][1] = actScaleRows[mi][0] + 8;
+    }
+
+    Mma::FragmentC acc[kWarpTilesM][kWarpTilesN];
+#pragma unroll
+    for (SizeType32 mi = 0; mi < kWarpTilesM; ++mi)
+    {
+#pragma unroll
+        for (SizeType32 ni = 0; ni < kWarpTilesN; ++ni)
+        {
+            acc[mi][ni].clear();
+        }
+    }
+
+    Mma mma;
+    for (SizeType32 kb = 0; kb < kBlocks; ++kb)
+    {
+        loadTile<kTileM>(sA, act, tileM, m, k, kb);
+        loadTile<kTileN>(sB, weight, tileN, n, k, kb);
+        __syncthreads();
+
+        Mma::FragmentC blockAcc[kWarpTilesM][kWarpTilesN];
+#pragma unroll
+        for (SizeType32 mi = 0; mi < kWarpTilesM; ++mi)
+        {
+#pragma unroll
+            for (SizeType32 ni = 0; ni < kWarpTilesN; ++ni)
+            {
+                blockAcc[mi][ni].clear();
+            }
+        }
+#pragma unroll
+        for (SizeType32 kk = 0; kk < kTileK; kk += kMmaK)
+        {
+            SizeType32 const col = kk + threadInGroup * 4;
+            Mma::FragmentA a[kWarpTilesM];
+            Mma::FragmentB b[kWarpTilesN];
+#pragma unroll
+            for (SizeType32 mi = 0; mi < kWarpTilesM; ++mi)
+            {
+                SizeType32 const row = warpM + mi * kMmaM + group;
+                auto* regs = reinterpret_cast<uint32_t*>(&a[mi]);
+                regs[0] = *reinterpret_cast<uint32_t const*>(&sA[row][col]);
+                regs[1] = *reinterpret_cast<uint32_t const*>(&sA[row + 8][col]);
+                regs[2] = *reinterpret_cast<uint32_t const*>(&sA[row][col + 16]);
+                regs[3] = *reinterpret_cast<uint32_t const*>(&sA[row + 8][col + 16]);
+            }
+#pragma unroll
+            for (SizeType32 ni = 0; ni < kWarpTilesN; ++ni)
+            {
+                SizeType32 const row = warpN + ni * kMmaN + group;
+                auto* regs = reinterpret_cast<uint32_t*>(&b[ni]);
+                regs[0] = *reinterpret_cast<uint32_t const*>(&sB[row][col]);
+                regs[1] = *reinterpret_cast<uint32_t const*>(&sB[row][col + 16]);
+            }
+#pragma unroll
+            for (SizeType32 mi = 0; mi < kWarpTilesM; ++mi)
+            {
+#pragma unroll
+                for (SizeType32 ni = 0; ni < kWarpTilesN; ++ni)
+                {
+                    mma(blockAcc[mi][ni], a[mi], b[ni], blockAcc[mi][ni]);
+                }
+            }
+        }
+
+        float const weightScale = weightScales[kb];
+#pragma unroll
+        for (SizeType32 mi = 0; mi < kWarpTilesM; ++mi)
+        {
+            float scales[2];
+#pragma unroll
+            for (SizeType32 r = 0; r < 2; ++r)
+            {
+                SizeType32 const row = actScaleRows[mi][r];
+                scales[r] = row < m ? params.act_scales[row * kBlocks + kb] * weightScale : 0.f;
+            }
+#pragma unroll
+            for (SizeType32 ni = 0; ni < kWarpTilesN; ++ni)
+            {
+#pragma unroll
+                for (SizeType32 c = 0; c < 4; ++c)
+                {
+                    acc[mi][ni][c] = fma(blockAcc[mi][ni][c], scales[c / 2], acc[mi][ni][c]);
+                }
+            }
+        }
+        __syncthreads();
+    }
+
+    auto* output = reinterpret_cast<OutputType*>(params.output);
+#pragma unroll
+    for (SizeType32 mi = 0; mi < kWarpTilesM; ++mi)
+    {
+#pragma unroll
+        for (SizeType32 ni = 0; ni < kWarpTilesN; ++ni)
+        {
+            SizeType32 const col = tileN + warpN + ni * kMmaN + threadInGroup * 2;
+#pragma unroll
+            for (SizeType32 c = 0; c < 4; ++c)
+            {
+                SizeType32 const row = actScaleRows[mi][c / 2];
+                if (row < m && col + c % 2 < n)
+                {
+                    output[static_cast<size_t>(row) * n + col + c % 2] = static_cast<OutputType>(acc[mi][ni][c]);
+                }
+            }
+        }
+    }
+#endif
+}
+} // namespace
+
+template <typename OutputType>
+void fp8BlockScaleGemmLauncher(Params const& params, int arch, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(params.k % kBlockScaleSize == 0, "K (%d) must be a multiple of the scale block size (%d).",
+        params.k, kBlockScaleSize);
+    if (params.m == 0)
+    {
+        return;
+    }
+    if (params.m <= kMaxGemvM && params.n % 2 == 0)
+    {
+#define DISPATCH(TargetM, TILE_M, TILE_N, BLOCK_SIZE)                                                                  \
+    if (params.m == TargetM)                                                                                           \
+    {                                                                                                                  \
+        fp8BlockScaleGemvKernel<OutputType, TILE_M, TILE_N, BLOCK_SIZE>(params, stream);                               \
+        sync_check_cuda_error();                                                                                       \
+        return;                                                                                                        \
+    }
+        DISPATCH(1, 1, 2, 128);
+        DISPATCH(2, 2, 2, 128);
+        DISPATCH(3, 3, 2, 128);
+        DISPATCH(4, 4, 2, 128);
+#undef DISPATCH
+    }
+    TLLM_CHECK_WITH_INFO(arch >= 89, "The block-scaled FP8 GEMM needs SM89 or newer for M > %d, got SM%d.", kMaxGemvM,
+        arch);
+    dim3 const grid(tensorrt_llm::common::divUp(params.m, kTileM), tensorrt_llm::common::divUp(params.n, kTileN));
+    fp8BlockScaleGemm<OutputType><<<grid, kMmaThreads, 0, stream>>>(params);
+    sync_check_cuda_error();
+}
+
+template void fp8BlockScaleGemmLauncher<float>(Params const& params, int arch, cudaStream_t stream);
+template void fp8BlockScaleGemmLauncher<half>(Params const& params, int arch, cudaStream_t stream);
+#ifdef ENABLE_BF16
+template void fp8BlockScaleGemmLauncher<__nv_bfloat16>(Params const& params, int arch, cudaStream_t stream);
+#endif
+
+} // namespace fp8_block_scale_gemm
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cuda_runtime_api.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+namespace fp8_block_scale_gemm
+{
+using SizeType32 = tensorrt_llm::runtime::SizeType32;
+
+// Size of the blocks sharing a scale: groups of kBlockScaleSize channels of a token for the activations, and
+// kBlockScaleSize x kBlockScaleSize blocks for the weights.
+constexpr SizeType32 kBlockScaleSize = 128;
+// Up to this M, a GEMV reading the weights once is used instead of the tensor core kernel.
+constexpr SizeType32 kMaxGemvM = 4;
+
+// output = act * weight^T with fp8 (e4m3) inputs and block scales, as produced by invokeFp8PerTokenGroupQuantization
+// and invokeFp8BlockQuantization. The partial products of every block of K are accumulated in fp32 and scaled before
+// being added, so the checkpoints run without dequantizing the weights.
+struct Params
+{
+    // [m, k]
+    void const* act;
+    // [m, k / kBlockScaleSize]
+    float const* act_scales;
+    // [n, k]
+    void const* weight;
+    // [ceil(n / kBlockScaleSize), k / kBlockScaleSize]
+    float const* weight_scales;
+    // [m, n]
+    void* output;
+    SizeType32 m, n, k;
+};
+
+// arch is the SM version, the tensor core kernel used for M > kMaxGemvM needs SM89 or newer.
+template <typename OutputType>
+void fp8BlockScaleGemmLauncher(Params const& params, int arch, cudaStream_t stream);
+
+} // namespace fp8_block_scale_gemm
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -71,7 +71,8 @@ __global__ __launch_bounds__(THREADS_PER_BLOCK) void computeSeqAndPaddingOffsets
     int* seqKVOffsets, int const* seqQLengths, int const* seqKVLengths, uint32_t* fmha_tile_counter, int batchSize,
     int maxQSeqLength, bool removePadding, float rotaryEmbeddingScale, float rotaryEmbeddingBase,
     int rotaryEmbeddingDim, RotaryScalingType rotaryScalingType, int rotaryEmbeddingMaxPositions,
-    float* rotaryEmbeddingInvFreq, float2* rotaryEmbeddingCoeffCache)
+    float* rotaryEmbeddingInvFreq, float2* rotaryEmbeddingCoeffCache, float* fmhaBmm2Scale,
+    float const* dequantScaleKv, float const* quantScaleO)
 {
     // Dynamic shared memory for storing seqOffsets.
     extern __shared__ int smemSeqQOffsets[];
@@ -183,6 +184,14 @@ __global__ __launch_bounds__(THREADS_PER_BLOCK) void computeSeqAndPaddingOffsets
     {
         fmha_tile_counter[0] = 0u;
     }
+
+    // Compute the fmha bmm2 scale of paged KV FP8 FMHA.
+    if (threadIdx.x == 0 && blockIdx.x == 0 && fmhaBmm2Scale != nullptr)
+    {
+        float const dequantKv = dequantScaleKv != nullptr ? dequantScaleKv[0] : 1.f;
+        float const quantO = quantScaleO != nullptr ? quantScaleO[0] : 1.f;
+        fmhaBmm2Scale[0] = dequantKv * quantO;
+    }
 }
 
 // This kernel computes the attention mask. We must compute this on-the-fly in the future.
@@ -292,7 +301,8 @@ void invokeBuildDecoderInfo(BuildDecoderInfoParams<T> const& params, cudaStream_
                 params.seqKVOffsets, params.seqQLengths, params.seqKVLengths, params.fmhaTileCounter, params.batchSize,
                 params.maxQSeqLength, params.removePadding, params.rotaryEmbeddingScale, params.rotaryEmbeddingBase,
                 params.rotaryEmbeddingDim, params.rotaryScalingType, params.rotaryEmbeddingMaxPositions,
-                params.rotaryEmbeddingInvFreq, params.rotaryEmbeddingCoeffCache);
+                params.rotaryEmbeddingInvFreq, params.rotaryEmbeddingCoeffCache, params.fmhaBmm2Scale,
+                params.dequantScaleKv, params.quantScaleO);
     }
     else
     {
@@ -301,7 +311,8 @@ void invokeBuildDecoderInfo(BuildDecoderInfoParams<T> const& params, cudaStream_
                 params.seqKVOffsets, params.seqQLengths, params.seqKVLengths, params.fmhaTileCounter, params.batchSize,
                 params.maxQSeqLength, params.removePadding, params.rotaryEmbeddingScale, params.rotaryEmbeddingBase,
                 params.rotaryEmbeddingDim, params.rotaryScalingType, params.rotaryEmbeddingMaxPositions,
-                params.rotaryEmbeddingInvFreq, params.rotaryEmbeddingCoeffCache);
+                params.rotaryEmbeddingInvFreq, params.rotaryEmbeddingCoeffCache, params.fmhaBmm2Scale,
+                params.dequantScaleKv, params.quantScaleO);
     }
 
     // Compute the attention mask, if needed.
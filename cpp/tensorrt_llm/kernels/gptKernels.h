@@ -109,6 +109,14 @@ struct BuildDecoderInfoParams
     // The fmha tile counter ptr (set to 0 before fmha).
     uint32_t* fmhaTileCounter;
 
+    // The fmha bmm2 scale of paged KV FP8 FMHA (dequantScaleKv * quantScaleO), as V is read from the fp8 kv cache.
+    // Not computed when it is nullptr. Shape: [1].
+    float* fmhaBmm2Scale;
+    // The kv cache dequantization scale. Shape: [1].
+    float const* dequantScaleKv;
+    // The attention output quantization scale. Shape: [1].
+    float const* quantScaleO;
+
     // The number of sequences in the batch.
     int batchSize;
     // The maximum query length of a sequence; it includes input and output.
@@ -158,6 +166,9 @@ struct BuildDecoderInfoParams
         ss << "seqQLengths: " << seqQLengths << std::endl;
         ss << "seqKVLengths: " << seqKVLengths << std::endl;
         ss << "fmhaTileCounter: " << fmhaTileCounter << std::endl;
+        ss << "fmhaBmm2Scale: " << fmhaBmm2Scale << std::endl;
+        ss << "dequantScaleKv: " << dequantScaleKv << std::endl;
+        ss << "quantScaleO: " << quantScaleO << std::endl;
         ss << "batchSize: " << batchSize << std::endl;
         ss << "maxQSeqLength: " << maxQSeqLength << std::endl;
         ss << "removePadding: " << std::boolalpha << removePadding << std::endl;
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/kvCacheCompaction.h"
+
+#include <cstdint>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+constexpr int kThreadsPerBlock = 256;
+// Bytes moved by a thread at once.
+constexpr int kBytesPerThread = sizeof(uint4);
+
+// The kept tokens are moved in chunks, all the threads load their token of the chunk before any of them stores. A
+// kept token never moves back, so the destinations of a chunk are before the sources of the following chunks and the
+// compaction is done in place.
+__global__ void compactKvCacheKernel(KvCacheCompactionParams params)
+{
+    auto const headIdx = static_cast<int>(blockIdx.x);
+    auto const layerIdx = static_cast<int>(blockIdx.y) / 2;
+    auto const kvIdx = static_cast<KVIdxType>(blockIdx.y % 2);
+    auto const seqIdx = static_cast<int>(blockIdx.z);
+
+    auto kvCache = params.kv_cache;
+    // The K and V blocks of a layer follow the ones of the previous layers in the pools
+    auto const layerOffset = static_cast<int64_t>(layerIdx) * 2 * kvCache.mBytesPerBlock;
+    kvCache.mPrimaryPoolPtr = static_cast<char*>(kvCache.mPrimaryPoolPtr) + layerOffset;
+    if (kvCache.mSecondaryPoolPtr != nullptr)
+    {
+        kvCache.mSecondaryPoolPtr = static_cast<char*>(kvCache.mSecondaryPoolPtr) + layerOffset;
+    }
+    auto const* offsets = kvCache.getRowPtr(kvIdx, seqIdx);
+    auto const* keptTokens = params.kept_tokens + static_cast<int64_t>(seqIdx) * params.max_kept_tokens;
+    auto const numKept = params.num_kept_tokens != nullptr ? params.num_kept_tokens[seqIdx] : params.max_kept_tokens;
+
+    auto const threadsPerToken = params.bytes_per_head / kBytesPerThread;
+    auto const tokensPerChunk = kThreadsPerBlock / threadsPerToken;
+    auto const chunkTokenIdx = static_cast<int>(threadIdx.x) / threadsPerToken;
+    auto const byteIdx = (static_cast<int>(threadIdx.x) % threadsPerToken) * kBytesPerThread;
+    auto const headOffset = static_cast<int64_t>(headIdx) * kvCache.mTokensPerBlock * params.bytes_per_head;
+
+    auto const tokenPtr = [&](int tokenIdx)
+    {
+        return static_cast<char*>(kvCache.getBlockPtr(offsets, tokenIdx)) + headOffset
+            + static_cast<int64_t>(kvCache.getLocalIdx(tokenIdx)) * params.bytes_per_head + byteIdx;
+    };
+
+    for (int chunkBegin = 0; chunkBegin < numKept; chunkBegin += tokensPerChunk)
+    {
+        auto const dstIdx = chunkBegin + chunkTokenIdx;
+        auto const srcIdx = chunkTokenIdx < tokensPerChunk && dstIdx < numKept ? keptTokens[dstIdx] : dstIdx;
+        bool const move = srcIdx != dstIdx;
+        uint4 data;
+        if (move)
+        {
+            data = *reinterpret_cast<uint4 const*>(tokenPtr(srcIdx));
+        }
+        __syncthreads();
+        if (move)
+        {
+            *reinterpret_cast<uint4*>(tokenPtr(dstIdx)) = data;
+        }
+        __syncthreads();
+    }
+
+    if (params.importance_scores == nullptr || headIdx != 0 || blockIdx.y != 0)
+    {
+        return;
+    }
+    auto* scores = params.importance_scores + static_cast<int64_t>(params.score_rows[seqIdx]) * params.scores_stride;
+    for (int chunkBegin = 0; chunkBegin < numKept; chunkBegin += kThreadsPerBlock)
+    {
+        auto const dstIdx = chunkBegin + static_cast<int>(threadIdx.x);
+        auto const score = dstIdx < numKept ? scores[keptTokens[dstIdx]] : 0.f;
+        __syncthreads();
+        if (dstIdx < numKept)
+        {
+            scores[dstIdx] = score;
+        }
+        __syncthreads();
+    }
+    for (int tokenIdx = numKept + static_cast<int>(threadIdx.x); tokenIdx < params.num_tokens[seqIdx];
+         tokenIdx += kThreadsPerBlock)
+    {
+        scores[tokenIdx] = 0.f;
+    }
+}
+} // namespace
+
+void invokeCompactKvCache(KvCacheCompactionParams const& params, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(params.bytes_per_head % kBytesPerThread == 0
+            && params.bytes_per_head <= kThreadsPerBlock * kBytesPerThread,
+        "The KV cache compaction doesn't support %d bytes per head", params.bytes_per_head);
+    if (params.num_seqs == 0)
+    {
+        return;
+    }
+    dim3 const grid(params.num_kv_heads, params.num_layers * 2, params.num_seqs);
+    compactKvCacheKernel<<<grid, kThreadsPerBlock, 0, stream>>>(params);
+    sync_check_cuda_error();
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
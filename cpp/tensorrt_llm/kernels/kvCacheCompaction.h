@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/kernels/kvCacheUtils.h"
+
+#include <cuda_runtime_api.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+// Compaction of the paged KV cache of sequences after the eviction of some of their tokens. The kept tokens of each
+// sequence are moved to the front of its cache, in their order, in the K and V blocks of all the layers. Their
+// importance scores move with them and the scores past the kept tokens are reset, so that the slots start from zero
+// when they are written again.
+struct KvCacheCompactionParams
+{
+    // The sequences to compact, with the pool pointers of the first layer.
+    KVBlockArray kv_cache;
+    int num_layers;
+    int num_kv_heads;
+    // sizePerHead * the size of an element of the cache, a multiple of 16.
+    int bytes_per_head;
+    // [num_seqs, max_kept_tokens], the indices of the kept tokens of each sequence, ascending.
+    int const* kept_tokens;
+    // Optional, [num_seqs], max_kept_tokens for all the sequences if not given.
+    int const* num_kept_tokens;
+    int max_kept_tokens;
+    // [num_seqs], the tokens cached before the compaction.
+    int const* num_tokens;
+    int num_seqs;
+    // Optional, [*, scores_stride], the importance scores of the tokens, the row of a sequence given by score_rows.
+    float* importance_scores;
+    int const* score_rows;
+    int scores_stride;
+};
+
+void invokeCompactKvCache(KvCacheCompactionParams const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -25,6 +25,19 @@ namespace tensorrt_llm
 namespace kernels
 {
 
+// Largest magnitude of the quantized output, the per-token scale maps the amax of a row to it.
+template <typename QuantT>
+__inline__ __device__ constexpr float quant_type_max()
+{
+#ifdef ENABLE_FP8
+    if constexpr (std::is_same_v<QuantT, __nv_fp8_e4m3>)
+    {
+        return FP8_E4M3_MAX;
+    }
+#endif
+    return 127.f;
+}
+
 template <typename Tf, typename T>
 __inline__ __device__ Tf compute_layernorm(Tf val, float s_mean, float s_variance, T const* gamma, T const* beta, int i)
 {
@@ -36,39 +49,117 @@ __inline__ __device__ Tf compute_layernorm(Tf val, float s_mean, float s_varianc
     return ret;
 }
 
+// VEC packed elements of T, loaded and stored with a single instruction of up to 128 bits.
+template <typename T, int VEC>
+struct alignas(sizeof(T) * VEC) NormVec
+{
+    T data[VEC];
+};
+
+// Running count, mean and sum of squared deviations of the values seen so far (Welford's algorithm).
+struct WelfordState
+{
+    float count;
+    float mean;
+    float m2;
+};
+
+__inline__ __device__ void welford_update(WelfordState& state, float val)
+{
+    state.count += 1.f;
+    float const delta = val - state.mean;
+    state.mean += delta / state.count;
+    state.m2 += delta * (val - state.mean);
+}
+
+__inline__ __device__ void welford_update(WelfordState& state, float2 val)
+{
+    welford_update(state, val.x);
+    welford_update(state, val.y);
+}
+
+// Combines the statistics of two disjoint sets of values (Chan et al.).
+__inline__ __device__ WelfordState welford_merge(WelfordState const& a, WelfordState const& b)
+{
+    float const count = a.count + b.count;
+    if (count == 0.f)
+    {
+        return a;
+    }
+    float const delta = b.mean - a.mean;
+    float const b_weight = b.count / count;
+    return {count, a.mean + delta * b_weight, a.m2 + b.m2 + delta * delta * a.count * b_weight};
+}
+
+// Merges the states of all threads of the block, the result is valid in thread 0.
+__inline__ __device__ WelfordState block_reduce_welford(WelfordState state)
+{
+    __shared__ WelfordState s_warp_states[32];
+    int const lane = threadIdx.x & 31;
+    int const warp = threadIdx.x >> 5;
+#pragma unroll
+    for (int offset = 16; offset > 0; offset >>= 1)
+    {
+        WelfordState other;
+        other.count = __shfl_xor_sync(FINAL_MASK, state.count, offset, 32);
+        other.mean = __shfl_xor_sync(FINAL_MASK, state.mean, offset, 32);
+        other.m2 = __shfl_xor_sync(FINAL_MASK, state.m2, offset, 32);
+        state = welford_merge(state, other);
+    }
+    if (lane == 0)
+    {
+        s_warp_states[warp] = state;
+    }
+    __syncthreads();
+    if (threadIdx.x == 0)
+    {
+        int const num_warps = (blockDim.x + 31) / 32;
+        for (int w = 1; w < num_warps; ++w)
+        {
+            state = welford_merge(state, s_warp_states[w]);
+        }
+    }
+    return state;
+}
+
 /* Computes the layernorm https://pytorch.org/docs/stable/generated/torch.nn.LayerNorm.html
  * normed_output <- ( (input - E[input]) / Sqrt(Var[input] + eps) ) * gamma + beta
  * input is [tokens, hidden_dim]. Mean and Variance are per-row (i.e. per-token)
  *
- * One CTA handles one row.
+ * One CTA handles one row. Every thread loads and stores VEC packed elements at once.
  *
- * with USE_DIFF_OF_SQUARES set to false:
+ * with SINGLE_PASS set to false:
  * First pass (loop) computes the mean.
  * Second computes the variance via Var[x] = E[(x - E[x])²].
  * Third pass computes and writes normed_output
  *
- * with USE_DIFF_OF_SQUARES set to true (may be faster but less accurate):
- * First pass (loop) computes the mean and variance via Var[x] = E[x²] - E[x]²
+ * with SINGLE_PASS set to true:
+ * First pass (loop) computes the mean and variance with Welford's algorithm, which doesn't suffer from the
+ * cancellation of Var[x] = E[x²] - E[x]²
  * Second pass computes and writes normed_output
  *
  * use_shmem controls if we cache input values into shared memory
  *
  * Optional: with dynamic scaling, the last pass doesn't write immediately but finds the
- *           amax per row. A final pass scales to int8 accordingly, and writes output to
+ *           amax per row. A final pass scales to int8 or fp8 (e4m3) accordingly, and writes output to
  *           normed_output_quant.
+ *
+ * Optional: with residual, the norm is applied to input + residual, and the sum is written to residual_out
+ *           (which may alias residual) as the residual of the next layer.
  */
-template <typename T, bool USE_DIFF_OF_SQUARES = false>
+template <typename T, typename QuantT, int VEC, bool SINGLE_PASS = false>
 __global__ void generalLayerNorm(T const* input, T const* gamma, T const* beta, T* normed_output, float const eps,
     int tokens, int hidden_dim, float const* scale_orig_quant_per_tensor, float* scale_orig_quant_per_token,
-    int8_t* normed_output_quant, bool use_shmem)
+    QuantT* normed_output_quant, T const* residual, T* residual_out, bool use_shmem)
 {
     constexpr auto num_elems_T = num_elems<T>::value;
-    using int8_packed_t = typename packed_as<int8_t, num_elems_T>::type;
+    using quant_packed_t = typename packed_as<QuantT, num_elems_T>::type;
     using float_packed_t = typename packed_as<float, num_elems_T>::type;
     using T_scalar = typename packed_as<T, 1>::type;
+    using Vec = NormVec<T, VEC>;
 
-    extern __shared__ __align__(sizeof(float)) char _shmem[];
-    T* shmem = reinterpret_cast<T*>(_shmem);
+    extern __shared__ __align__(16) char _shmem[];
+    Vec* shmem = reinterpret_cast<Vec*>(_shmem);
     __shared__ float s_mean;
     __shared__ float s_variance;
 
@@ -79,30 +170,51 @@ __global__ void generalLayerNorm(T const* input, T const* gamma, T const* beta,
     float variance = 0.0f;
     float local_sum = 0.0f;
     float local_var_sum = 0.0f;
+    WelfordState welford{0.f, 0.f, 0.f};
 
     int const n_elems = hidden_dim / num_elems_T;
-    for (int i = tidx; i < n_elems; i += blockDim.x)
+    int const n_vecs = n_elems / VEC;
+    auto const* input_row = reinterpret_cast<Vec const*>(input + bidx * n_elems);
+    auto* residual_out_row = residual != nullptr ? reinterpret_cast<Vec*>(residual_out + bidx * n_elems) : nullptr;
+    // Each thread reads back only the elements it wrote, so the later passes need no synchronization
+    Vec const* src = residual != nullptr ? residual_out_row : input_row;
+    for (int i = tidx; i < n_vecs; i += blockDim.x)
     {
-        const T val = input[bidx * n_elems + i];
+        Vec val = input_row[i];
+        if (residual != nullptr)
+        {
+            Vec const res = reinterpret_cast<Vec const*>(residual + bidx * n_elems)[i];
+#pragma unroll
+            for (int j = 0; j < VEC; ++j)
+            {
+                val.data[j] = cuda_cast<T>(
+                    cuda_cast<float_packed_t>(val.data[j]) + cuda_cast<float_packed_t>(res.data[j]));
+            }
+            residual_out_row[i] = val;
+        }
         if (use_shmem)
         {
             shmem[i] = val;
         }
 
-        const float_packed_t val_f = cuda_cast<float_packed_t>(val);
-        local_sum += cuda_sum<float>(val_f);
-        if (USE_DIFF_OF_SQUARES)
+#pragma unroll
+        for (int j = 0; j < VEC; ++j)
         {
-            local_var_sum += cuda_sum<float>(val_f * val_f);
+            const float_packed_t val_f = cuda_cast<float_packed_t>(val.data[j]);
+            if (SINGLE_PASS)
+            {
+                welford_update(welford, val_f);
+            }
+            else
+            {
+                local_sum += cuda_sum<float>(val_f);
+            }
         }
     }
 
-    if (USE_DIFF_OF_SQUARES)
+    if (SINGLE_PASS)
     {
-        float packed[2] = {local_sum, local_var_sum};
-        blockReduceSumV2<float, 2>(packed);
-        mean = packed[0];
-        variance = packed[1];
+        welford = block_reduce_welford(welford);
     }
     else
     {
@@ -111,23 +223,30 @@ __global__ void generalLayerNorm(T const* input, T const* gamma, T const* beta,
 
     if (threadIdx.x == 0)
     {
-        mean = mean / hidden_dim;
-        s_mean = mean;
-        if (USE_DIFF_OF_SQUARES)
+        if (SINGLE_PASS)
+        {
+            s_mean = welford.mean;
+            s_variance = rsqrtf(welford.m2 / hidden_dim + eps);
+        }
+        else
         {
-            variance = (variance / hidden_dim) - (mean * mean); // Var[x] = E[x²] - E[x]²
-            s_variance = rsqrtf(variance + eps);
+            mean = mean / hidden_dim;
+            s_mean = mean;
         }
     }
     __syncthreads();
 
-    if (!USE_DIFF_OF_SQUARES)
+    if (!SINGLE_PASS)
     {
-        for (int i = tidx; i < n_elems; i += blockDim.x)
+        for (int i = tidx; i < n_vecs; i += blockDim.x)
         {
-            const T val = use_shmem ? shmem[i] : input[bidx * n_elems + i];
-            float_packed_t diff = cuda_cast<float_packed_t>(val) - s_mean;
-            local_var_sum += cuda_sum<float>(diff * diff);
+            Vec const val = use_shmem ? shmem[i] : src[i];
+#pragma unroll
+            for (int j = 0; j < VEC; ++j)
+            {
+                float_packed_t diff = cuda_cast<float_packed_t>(val.data[j]) - s_mean;
+                local_var_sum += cuda_sum<float>(diff * diff);
+            }
         }
         variance = blockReduceSum(local_var_sum);
 
@@ -143,95 +262,137 @@ __global__ void generalLayerNorm(T const* input, T const* gamma, T const* beta,
     const float_packed_t scale_orig_quant
         = cuda_cast<float_packed_t>(with_per_tensor_scaling ? *scale_orig_quant_per_tensor : 0.0f);
     T_scalar amax = 1e-6f;
+    auto* quant_row = reinterpret_cast<quant_packed_t*>(normed_output_quant) + bidx * n_elems;
 
-    for (int i = tidx; i < n_elems; i += blockDim.x)
+    for (int i = tidx; i < n_vecs; i += blockDim.x)
     {
-        int const index = bidx * n_elems + i;
-        const float_packed_t val_f = cuda_cast<float_packed_t>(use_shmem ? shmem[i] : input[index]);
-        const T val = cuda_cast<T>(compute_layernorm(val_f, s_mean, s_variance, gamma, beta, i));
+        Vec const in = use_shmem ? shmem[i] : src[i];
+        Vec out;
+#pragma unroll
+        for (int j = 0; j < VEC; ++j)
+        {
+            int const elem = i * VEC + j;
+            out.data[j] = cuda_cast<T>(
+                compute_layernorm(cuda_cast<float_packed_t>(in.data[j]), s_mean, s_variance, gamma, beta, elem));
+            if (with_per_token_scaling)
+            {
+                amax = cuda_max(cuda_max<T_scalar, T>(cuda_abs(out.data[j])), amax);
+            }
+            else if (with_per_tensor_scaling)
+            {
+                quant_row[elem] = cuda_cast<quant_packed_t>(cuda_cast<float_packed_t>(out.data[j]) * scale_orig_quant);
+            }
+        }
 
         if (with_per_token_scaling)
         {
-            amax = cuda_max(cuda_max<T_scalar, T>(cuda_abs(val)), amax);
             if (use_shmem)
             {
-                shmem[i] = val;
+                shmem[i] = out;
             }
         }
-        else if (with_per_tensor_scaling)
+        else if (!with_per_tensor_scaling)
         {
-            reinterpret_cast<int8_packed_t*>(normed_output_quant)[index]
-                = cuda_cast<int8_packed_t>(cuda_cast<float_packed_t>(val) * scale_orig_quant);
-        }
-        else
-        {
-            normed_output[index] = val;
+            reinterpret_cast<Vec*>(normed_output + bidx * n_elems)[i] = out;
         }
     }
 
     if (with_per_token_scaling)
     {
         float abs_max_f = blockAllReduceMax(cuda_cast<float>(amax));
-        float const dynamic_per_token_scale = 127.f / abs_max_f;
-        for (int i = tidx; i < n_elems; i += blockDim.x)
+        float const dynamic_per_token_scale = quant_type_max<QuantT>() / abs_max_f;
+        for (int i = tidx; i < n_vecs; i += blockDim.x)
         {
-            int const index = bidx * n_elems + i;
-            float_packed_t val_f = cuda_cast<float_packed_t>(use_shmem ? shmem[i] : input[index]);
-            if (!use_shmem)
+            Vec const in = use_shmem ? shmem[i] : src[i];
+#pragma unroll
+            for (int j = 0; j < VEC; ++j)
             {
-                val_f = compute_layernorm(val_f, s_mean, s_variance, gamma, beta, i);
+                int const elem = i * VEC + j;
+                float_packed_t val_f = cuda_cast<float_packed_t>(in.data[j]);
+                if (!use_shmem)
+                {
+                    val_f = compute_layernorm(val_f, s_mean, s_variance, gamma, beta, elem);
+                }
+                quant_row[elem] = cuda_cast<quant_packed_t>(val_f * cuda_cast<float_packed_t>(dynamic_per_token_scale));
             }
-
-            reinterpret_cast<int8_packed_t*>(normed_output_quant)[index]
-                = cuda_cast<int8_packed_t>(val_f * cuda_cast<float_packed_t>(dynamic_per_token_scale));
         }
         if (tidx == 0)
         {
-            scale_orig_quant_per_token[bidx] = abs_max_f / 127.f;
+            scale_orig_quant_per_token[bidx] = abs_max_f / quant_type_max<QuantT>();
         }
     }
 }
 
-template <bool USE_DIFF_OF_SQUARES, typename T>
+template <bool SINGLE_PASS, int VEC, typename T, typename QuantT>
 void dispatch_layernorm_type_square_method(T const* input, T const* gamma, T const* beta, T* normed_output,
     float const eps, int tokens, int hidden_dim, float const* scale_orig_quant_per_tensor,
-    float* scale_orig_quant_per_token, int8_t* normed_output_quant, const dim3 grid, const dim3 block,
-    const size_t shmem_size, cudaStream_t stream)
+    float* scale_orig_quant_per_token, QuantT* normed_output_quant, T const* residual, T* residual_out,
+    const dim3 grid, const dim3 block, const size_t shmem_size, cudaStream_t stream)
 {
     if (shmem_size >= (48 << 10))
     {
-        cudaError_t ret = cudaFuncSetAttribute(
-            generalLayerNorm<T, USE_DIFF_OF_SQUARES>, cudaFuncAttributeMaxDynamicSharedMemorySize, shmem_size);
+        cudaError_t ret = cudaFuncSetAttribute(generalLayerNorm<T, QuantT, VEC, SINGLE_PASS>,
+            cudaFuncAttributeMaxDynamicSharedMemorySize, shmem_size);
     }
-    generalLayerNorm<T, USE_DIFF_OF_SQUARES><<<grid, block, shmem_size, stream>>>(input, gamma, beta, normed_output,
-        eps, tokens, hidden_dim, scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, true);
+    generalLayerNorm<T, QuantT, VEC, SINGLE_PASS><<<grid, block, shmem_size, stream>>>(input, gamma, beta,
+        normed_output, eps, tokens, hidden_dim, scale_orig_quant_per_tensor, scale_orig_quant_per_token,
+        normed_output_quant, residual, residual_out, true);
 }
 
-template <typename T>
+template <int VEC, typename T, typename QuantT>
+void dispatch_layernorm_type_vec(T const* input, T const* gamma, T const* beta, T* normed_output, float const eps,
+    int tokens, int hidden_dim, float const* scale_orig_quant_per_tensor, float* scale_orig_quant_per_token,
+    QuantT* normed_output_quant, T const* residual, T* residual_out, const dim3 grid, const dim3 block,
+    const size_t shmem_size, cudaStream_t stream, bool single_pass)
+{
+    if (single_pass)
+    {
+        dispatch_layernorm_type_square_method<true, VEC>(input, gamma, beta, normed_output, eps, tokens, hidden_dim,
+            scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, residual, residual_out,
+            grid, block, shmem_size, stream);
+    }
+    else
+    {
+        dispatch_layernorm_type_square_method<false, VEC>(input, gamma, beta, normed_output, eps, tokens, hidden_dim,
+            scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, residual, residual_out,
+            grid, block, shmem_size, stream);
+    }
+}
+
+template <typename T, typename QuantT>
 void dispatch_layernorm_type(T const* input, T const* gamma, T const* beta, T* normed_output, float const eps,
     int tokens, int hidden_dim, float const* scale_orig_quant_per_tensor, float* scale_orig_quant_per_token,
-    int8_t* normed_output_quant, const dim3 grid, const dim3 block, const size_t shmem_size, cudaStream_t stream,
-    bool use_diff_of_squares)
+    QuantT* normed_output_quant, T const* residual, T* residual_out, const dim3 grid, const dim3 block,
+    const size_t shmem_size, cudaStream_t stream, bool single_pass)
 {
-    if (use_diff_of_squares)
+    // 128-bit accesses when the rows and all pointers allow them
+    constexpr int vec = 16 / sizeof(T);
+    auto const aligned = [](void const* ptr) { return reinterpret_cast<uintptr_t>(ptr) % 16 == 0; };
+    bool const use_128_bit = (hidden_dim / num_elems<T>::value) % vec == 0 && aligned(input) && aligned(normed_output)
+        && aligned(residual) && aligned(residual_out);
+    if (use_128_bit)
     {
-        dispatch_layernorm_type_square_method<true>(input, gamma, beta, normed_output, eps, tokens, hidden_dim,
-            scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, grid, block, shmem_size,
-            stream);
+        int const n_vecs = hidden_dim / num_elems<T>::value / vec;
+        dim3 const vec_block(32 * ((min(n_vecs, 1024) + 31) / 32));
+        dispatch_layernorm_type_vec<vec>(input, gamma, beta, normed_output, eps, tokens, hidden_dim,
+            scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, residual, residual_out,
+            grid, vec_block, shmem_size, stream, single_pass);
     }
     else
     {
-        dispatch_layernorm_type_square_method<false>(input, gamma, beta, normed_output, eps, tokens, hidden_dim,
-            scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, grid, block, shmem_size,
-            stream);
+        dispatch_layernorm_type_vec<1>(input, gamma, beta, normed_output, eps, tokens, hidden_dim,
+            scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, residual, residual_out,
+            grid, block, shmem_size, stream, single_pass);
     }
 }
 
-template <typename T>
+template <typename T, typename QuantT>
 void invokeGeneralLayerNorm(T* out, T const* input, T const* gamma, T const* beta, float const eps, int const tokens,
     int const hidden_dim, cudaStream_t stream, bool use_diff_of_squares, float const* scale, float* dynamic_scale,
-    int8_t* normed_output_quant)
+    QuantT* normed_output_quant, T const* residual, T* residual_out)
 {
+    TLLM_CHECK_WITH_INFO((residual == nullptr) == (residual_out == nullptr),
+        "The residual and the updated residual must be given together.");
     dim3 grid(tokens);
     dim3 block(min(hidden_dim, 1024));
     // Make sure block.x is multiple of 32 for warp shuffle to work
@@ -251,25 +412,34 @@ void invokeGeneralLayerNorm(T* out, T const* input, T const* gamma, T const* bet
         using Tp = typename packed_as<T, vec_size>::type;
         dispatch_layernorm_type(reinterpret_cast<Tp const*>(input), reinterpret_cast<Tp const*>(gamma),
             reinterpret_cast<Tp const*>(beta), reinterpret_cast<Tp*>(out), eps, tokens, hidden_dim, scale,
-            dynamic_scale, normed_output_quant, grid, block, shmem_size, stream, use_diff_of_squares);
+            dynamic_scale, normed_output_quant, reinterpret_cast<Tp const*>(residual),
+            reinterpret_cast<Tp*>(residual_out), grid, block, shmem_size, stream, use_diff_of_squares);
     }
     else
     {
         dispatch_layernorm_type(input, gamma, beta, out, eps, tokens, hidden_dim, scale, dynamic_scale,
-            normed_output_quant, grid, block, shmem_size, stream, use_diff_of_squares);
+            normed_output_quant, residual, residual_out, grid, block, shmem_size, stream, use_diff_of_squares);
     }
 }
 
-#define INSTANTIATE_GENERAL_LAYERNORM(T)                                                                               \
+#define INSTANTIATE_GENERAL_LAYERNORM(T, QuantT)                                                                       \
     template void invokeGeneralLayerNorm(T* out, const T* input, const T* gamma, const T* beta, const float eps,       \
         const int tokens, const int hidden_dim, cudaStream_t stream, bool use_diff_of_squares, const float* scale,     \
-        float* dynamic_scale, int8_t* normed_output_quant);
+        float* dynamic_scale, QuantT* normed_output_quant, const T* residual, T* residual_out);
 
-INSTANTIATE_GENERAL_LAYERNORM(float);
-INSTANTIATE_GENERAL_LAYERNORM(half);
+INSTANTIATE_GENERAL_LAYERNORM(float, int8_t);
+INSTANTIATE_GENERAL_LAYERNORM(half, int8_t);
 
 #ifdef ENABLE_BF16
-INSTANTIATE_GENERAL_LAYERNORM(__nv_bfloat16);
+INSTANTIATE_GENERAL_LAYERNORM(__nv_bfloat16, int8_t);
+#endif
+
+#ifdef ENABLE_FP8
+INSTANTIATE_GENERAL_LAYERNORM(float, __nv_fp8_e4m3);
+INSTANTIATE_GENERAL_LAYERNORM(half, __nv_fp8_e4m3);
+#ifdef ENABLE_BF16
+INSTANTIATE_GENERAL_LAYERNORM(__nv_bfloat16, __nv_fp8_e4m3);
+#endif
 #endif
 
 } // namespace kernels
@@ -17,6 +17,8 @@
 #include "tensorrt_llm/common/cudaTypeUtils.cuh"
 #include "tensorrt_llm/kernels/lookupKernels.h"
 
+#include <type_traits>
+
 using namespace tensorrt_llm::common;
 
 namespace tensorrt_llm
@@ -39,44 +41,93 @@ input IDs and get the correct results.
  * If the input ids is out of range it writes zero, otherwise it writes the correct embedding result.
  */
 template <typename Tout, typename Tin, typename Idx>
-__global__ void lookup_kernel(Tout* output, Idx const* input, Tin const* weight, int64_t const token_num,
-    Idx const offset, Idx const size, Idx const n_embed, Tout const* perTokenScales)
+__device__ __forceinline__ Tout load_weight(FusedLookUpParams<Tout, Tin, Idx> const& params, int64_t row, Idx col)
+{
+    if constexpr (std::is_same_v<Tin, int8_t>)
+    {
+        if (params.int4_weight)
+        {
+            int8_t const packed = params.weight[row * (params.n_embed / 2) + col / 2];
+            // Arithmetic shifts sign-extend the nibble
+            int8_t const value = col % 2 == 0 ? static_cast<int8_t>(packed << 4) >> 4 : packed >> 4;
+            return (Tout) value;
+        }
+    }
+    return (Tout) params.weight[row * params.n_embed + col];
+}
+
+template <typename Tout, typename Tin, typename Idx>
+__global__ void lookup_kernel(FusedLookUpParams<Tout, Tin, Idx> const params)
 {
-    for (int64_t index = blockIdx.x * blockDim.x + threadIdx.x; index < token_num * n_embed;
+    int64_t const n_embed = params.n_embed;
+    for (int64_t index = blockIdx.x * blockDim.x + threadIdx.x; index < params.token_num * n_embed;
          index += blockDim.x * gridDim.x)
     {
-        int64_t const word_index = input[index / n_embed] - offset;
+        int64_t const token_index = index / n_embed;
         Idx const col_index = index % n_embed;
-        Tout embedding;
-        if (word_index < 0 || word_index >= size)
+        Idx const id = params.input[token_index];
+        float embedding = 0.f;
+        if (params.prompt_table != nullptr && id >= params.vocab_size)
         {
-            embedding = Tout(0.f);
+            if (params.is_first_shard)
+            {
+                int64_t const row = static_cast<int64_t>(params.prompt_tasks[token_index]) * params.task_vocab_size
+                    + id - params.vocab_size;
+                embedding = cuda_cast<float>(params.prompt_table[row * n_embed + col_index]);
+            }
         }
         else
         {
-            embedding = (Tout) weight[word_index * n_embed + col_index];
-            if (perTokenScales != nullptr)
+            int64_t const word_index = id - params.offset;
+            if (word_index >= 0 && word_index < params.size)
             {
-                embedding *= perTokenScales[word_index];
+                Tout value = load_weight(params, word_index, col_index);
+                if (params.perTokenScales != nullptr)
+                {
+                    value *= params.perTokenScales[word_index];
+                }
+                embedding = cuda_cast<float>(value);
             }
         }
-        output[index] = embedding;
+        embedding *= params.scale;
+        if (params.position_table != nullptr && params.is_first_shard)
+        {
+            int64_t const position = params.position_ids[token_index];
+            embedding += cuda_cast<float>(params.position_table[position * n_embed + col_index]);
+        }
+        params.out[index] = cuda_cast<Tout>(embedding);
     } // end for index
 }
 
 template <typename Tout, typename Tin, typename Idx>
-void invokeLookUp(Tout* out, Idx const* input, Tin const* weight, int64_t const token_num, Idx const offset,
-    Idx const size, Idx const n_embed, Tout const* perTokenScales, cudaStream_t stream)
+void invokeFusedLookUp(FusedLookUpParams<Tout, Tin, Idx> const& params, cudaStream_t stream)
 {
     int64_t constexpr max_block_num = 65536;
     Idx constexpr max_block_size = 512;
-    dim3 grid(min(token_num, max_block_num));
-    dim3 block(min(n_embed, max_block_size));
-    lookup_kernel<Tout, Tin, Idx>
-        <<<grid, block, 0, stream>>>(out, input, weight, token_num, offset, size, n_embed, perTokenScales);
+    dim3 grid(min(params.token_num, max_block_num));
+    dim3 block(min(params.n_embed, max_block_size));
+    lookup_kernel<Tout, Tin, Idx><<<grid, block, 0, stream>>>(params);
+}
+
+template <typename Tout, typename Tin, typename Idx>
+void invokeLookUp(Tout* out, Idx const* input, Tin const* weight, int64_t const token_num, Idx const offset,
+    Idx const size, Idx const n_embed, Tout const* perTokenScales, cudaStream_t stream)
+{
+    FusedLookUpParams<Tout, Tin, Idx> params{};
+    params.out = out;
+    params.input = input;
+    params.token_num = token_num;
+    params.n_embed = n_embed;
+    params.weight = weight;
+    params.offset = offset;
+    params.size = size;
+    params.perTokenScales = perTokenScales;
+    invokeFusedLookUp(params, stream);
 }
 
 #define INSTANTIATE_LOOK_UP(Tout, Tin, Idx)                                                                            \
+    template void invokeFusedLookUp<Tout, Tin, Idx>(                                                                   \
+        FusedLookUpParams<Tout, Tin, Idx> const& params, cudaStream_t stream);                                         \
     template void invokeLookUp<Tout, Tin, Idx>(Tout * out, Idx const* input, Tin const* weight,                        \
         int64_t const token_num, Idx const offset, Idx const size, Idx const n_embed, Tout const* perTokenScales,      \
         cudaStream_t stream)
@@ -25,6 +25,44 @@ namespace tensorrt_llm
 {
 namespace kernels
 {
+//! \brief Embedding of a packed batch of tokens in a single pass: vocab-parallel lookup, prompt-tuning table
+//! substitution, scaling and position embedding add.
+template <typename Tout, typename Tin, typename Idx>
+struct FusedLookUpParams
+{
+    Tout* out;            // [token_num, n_embed]
+    Idx const* input;     // [token_num]
+    int64_t token_num;
+    Idx n_embed;
+
+    // Shard of the vocab of this rank, ids out of [offset, offset + size) give zeros to be all-reduced
+    Tin const* weight;    // [size, n_embed], or [size, n_embed / 2] for int4 weights
+    Idx offset;
+    Idx size;
+    Tout const* perTokenScales{nullptr}; // [size]
+    // Weight-only int4 table, Tin is int8_t and each byte packs two signed values, the even column in the low bits
+    bool int4_weight{false};
+
+    // Prompt tuning, ids >= vocab_size are taken from row task * task_vocab_size + id - vocab_size of the table
+    Tout const* prompt_table{nullptr};   // [num_tasks * task_vocab_size, n_embed]
+    Idx const* prompt_tasks{nullptr};    // [token_num]
+    Idx vocab_size{0};
+    Idx task_vocab_size{0};
+
+    // Multiplies the token embedding, e.g. by sqrt(n_embed)
+    float scale{1.f};
+
+    Tout const* position_table{nullptr}; // [max_position, n_embed]
+    Idx const* position_ids{nullptr};    // [token_num]
+
+    // Whether this rank writes the prompt rows and adds the position embedding, only one rank of a vocab-parallel
+    // lookup may do so since the outputs of the ranks are summed
+    bool is_first_shard{true};
+};
+
+template <typename Tout, typename Tin, typename Idx>
+void invokeFusedLookUp(FusedLookUpParams<Tout, Tin, Idx> const& params, cudaStream_t stream = 0);
+
 template <typename Tout, typename Tin, typename Idx>
 void invokeLookUp(Tout* out, Idx const* input, Tin const* weight, int64_t const token_num, Idx const offset,
     Idx const size, Idx const n_embed, Tout const* perTokenScales, cudaStream_t stream = 0);
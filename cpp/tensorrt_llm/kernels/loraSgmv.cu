@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/reduceKernelUtils.cuh"
+#include "tensorrt_llm/kernels/loraSgmv.h"
+
+#include <algorithm>
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+constexpr int kTOKENS_PER_BLOCK = 8;
+constexpr int kBLOCK_SIZE = 256;
+
+template <typename T>
+__global__ void loraSgmvKernel(LoraSgmvProblem const* problems, int inHiddenSize, int maxLowRank)
+{
+    // [kTOKENS_PER_BLOCK, maxLowRank]
+    extern __shared__ float lowRank[];
+
+    auto const problem = problems[blockIdx.x];
+    auto const tokenBegin = static_cast<int>(blockIdx.y) * kTOKENS_PER_BLOCK;
+    if (problem.rank == 0 || tokenBegin >= problem.numTokens)
+    {
+        return;
+    }
+    auto const numTokens = min(kTOKENS_PER_BLOCK, problem.numTokens - tokenBegin);
+    auto const rank = problem.rank;
+    auto const outHiddenSize = problem.outHiddenSize;
+    auto const* input = static_cast<T const*>(problem.input) + static_cast<int64_t>(tokenBegin) * inHiddenSize;
+    auto const* weightsIn = static_cast<T const*>(problem.weightsIn);
+    auto const* weightsOut = static_cast<T const*>(problem.weightsOut);
+    auto* output = static_cast<T*>(problem.output) + static_cast<int64_t>(tokenBegin) * outHiddenSize;
+
+    // Shrink, one warp per (token, rank) dot product over the hidden size
+    auto const warpIdx = static_cast<int>(threadIdx.x) / 32;
+    auto const laneIdx = static_cast<int>(threadIdx.x) % 32;
+    for (int idx = warpIdx; idx < numTokens * rank; idx += kBLOCK_SIZE / 32)
+    {
+        auto const tokenIdx = idx / rank;
+        auto const rankIdx = idx % rank;
+        auto const* x = input + static_cast<int64_t>(tokenIdx) * inHiddenSize;
+        auto const* a = weightsIn + static_cast<int64_t>(rankIdx) * inHiddenSize;
+        float acc{0.f};
+        for (int k = laneIdx; k < inHiddenSize; k += 32)
+        {
+            acc += cuda_cast<float>(x[k]) * cuda_cast<float>(a[k]);
+        }
+        acc = warpReduceSum(acc);
+        if (laneIdx == 0)
+        {
+            lowRank[tokenIdx * maxLowRank + rankIdx] = acc;
+        }
+    }
+    __syncthreads();
+
+    // Expand, one thread per output element
+    for (int idx = threadIdx.x; idx < numTokens * outHiddenSize; idx += kBLOCK_SIZE)
+    {
+        auto const tokenIdx = idx / outHiddenSize;
+        auto const outIdx = idx % outHiddenSize;
+        auto const* b = weightsOut + static_cast<int64_t>(outIdx) * rank;
+        float acc{0.f};
+        for (int r = 0; r < rank; ++r)
+        {
+            acc += lowRank[tokenIdx * maxLowRank + r] * cuda_cast<float>(b[r]);
+        }
+        output[static_cast<int64_t>(tokenIdx) * outHiddenSize + outIdx] = cuda_cast<T>(acc);
+    }
+}
+} // namespace
+
+int64_t getLoraSgmvWorkSpaceSize(int64_t problemCount)
+{
+    return problemCount * static_cast<int64_t>(sizeof(LoraSgmvProblem));
+}
+
+void invokeLoraSgmv(std::vector<LoraSgmvProblem> const& problems, int inHiddenSize, int maxLowRank,
+    void* workspace, int64_t workspaceSize, nvinfer1::DataType dataType, cudaStream_t stream)
+{
+    if (problems.empty())
+    {
+        return;
+    }
+    auto const problemCount = static_cast<int64_t>(problems.size());
+    TLLM_CHECK(getLoraSgmvWorkSpaceSize(problemCount) <= workspaceSize);
+    auto const smemSize = static_cast<size_t>(kTOKENS_PER_BLOCK) * maxLowRank * sizeof(float);
+    TLLM_CHECK_WITH_INFO(smemSize <= 48 * 1024, "max_low_rank (%d) is too large for the SGMV LoRA kernel", maxLowRank);
+
+    int maxNumTokens{0};
+    for (auto const& problem : problems)
+    {
+        TLLM_CHECK(problem.rank <= maxLowRank);
+        maxNumTokens = std::max(maxNumTokens, problem.numTokens);
+    }
+    if (maxNumTokens == 0)
+    {
+        return;
+    }
+
+    auto* problemsDevice = static_cast<LoraSgmvProblem*>(workspace);
+    TLLM_CUDA_CHECK(cudaMemcpyAsync(problemsDevice, problems.data(), getLoraSgmvWorkSpaceSize(problemCount),
+        cudaMemcpyHostToDevice, stream));
+
+    dim3 const grid(problemCount, divUp(maxNumTokens, kTOKENS_PER_BLOCK));
+    switch (dataType)
+    {
+    case nvinfer1::DataType::kFLOAT:
+        loraSgmvKernel<float><<<grid, kBLOCK_SIZE, smemSize, stream>>>(problemsDevice, inHiddenSize, maxLowRank);
+        break;
+    case nvinfer1::DataType::kHALF:
+        loraSgmvKernel<half><<<grid, kBLOCK_SIZE, smemSize, stream>>>(problemsDevice, inHiddenSize, maxLowRank);
+        break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16:
+        loraSgmvKernel<__nv_bfloat16>
+            <<<grid, kBLOCK_SIZE, smemSize, stream>>>(problemsDevice, inHiddenSize, maxLowRank);
+        break;
+#endif
+    default: TLLM_THROW("Unsupported data type for the SGMV LoRA kernel");
+    }
+    sync_check_cuda_error();
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <NvInferRuntime.h>
+#include <cuda_runtime.h>
+#include <vector>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+//! One segment of contiguous tokens sharing the same LoRA weights, for one LoRA module.
+struct LoraSgmvProblem
+{
+    //! [numTokens, inHiddenSize]
+    void const* input;
+    //! [rank, inHiddenSize], as stored in the LoRA cache pages
+    void const* weightsIn;
+    //! [outHiddenSize, rank], as stored in the LoRA cache pages
+    void const* weightsOut;
+    //! [numTokens, outHiddenSize]
+    void* output;
+    int numTokens;
+    int rank;
+    int outHiddenSize;
+};
+
+//! Segments with more tokens than this are better served by the grouped GEMMs, which use tensor cores.
+constexpr int kLORA_SGMV_MAX_NUM_TOKENS_PER_PROBLEM = 16;
+
+int64_t getLoraSgmvWorkSpaceSize(int64_t problemCount);
+
+//! \brief Segmented gather matrix-vector LoRA: output = (input * weightsIn^T) * weightsOut^T for every segment.
+//!
+//! Both the shrink and the expand GEMMs of all segments and modules run in one launch, reading the weights directly
+//! from the cache pages and keeping the low rank activations in shared memory. The cost is flat in the number of
+//! distinct adapters of the batch, unlike the grouped GEMMs whose problems get tiny when every request uses its own
+//! adapter, so this is used for generation heavy batches.
+//!
+//! Only the layouts of LoraSgmvProblem are supported, callers with a transposed input must use the GEMMs.
+//!
+//! \param problems segments of all modules; problems with rank 0 are skipped
+//! \param workspace device memory of getLoraSgmvWorkSpaceSize(problems.size()) bytes for the problem descriptors
+void invokeLoraSgmv(std::vector<LoraSgmvProblem> const& problems, int inHiddenSize, int maxLowRank,
+    void* workspace, int64_t workspaceSize, nvinfer1::DataType dataType, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -1171,6 +1171,72 @@ __launch_bounds__(64, 8) __global__
     }
 }
 
+template <typename input_t, int DCONV = 4>
+__launch_bounds__(128) __global__ void mamba_conv1d_generation_checkpoint_kernel(MambaConv1dParamsBase params)
+{
+    using tensorrt_llm::common::cuda_cast;
+
+    input_t const* input = reinterpret_cast<input_t const*>(params.in_ptr);
+    input_t const* state_in = reinterpret_cast<input_t const*>(params.state_in_ptr);
+    input_t* checkpoints = reinterpret_cast<input_t*>(params.state_checkpoints_ptr);
+    input_t const* weight = reinterpret_cast<input_t const*>(params.weight_ptr);
+    input_t const* bias = reinterpret_cast<input_t const*>(params.bias_ptr);
+    input_t* output = reinterpret_cast<input_t*>(params.out_ptr);
+
+    int const num_channels = params.dim;
+    int const num_tokens = params.num_spec_tokens;
+    int const channel = blockIdx.x * blockDim.x + threadIdx.x;
+    if (channel >= num_channels)
+    {
+        return;
+    }
+    int const sample = blockIdx.y;
+    int const slot_idx = params.state_slot_mapping_ptr == nullptr ? sample : params.state_slot_mapping_ptr[sample];
+
+    float reg_weight[DCONV];
+    float window[DCONV];
+#pragma unroll
+    for (int row = 0; row < DCONV; ++row)
+    {
+        reg_weight[row] = cuda_cast<float, input_t>(weight[row * num_channels + channel]);
+    }
+    float const reg_bias = cuda_cast<float, input_t>(bias[channel]);
+#pragma unroll
+    for (int i = 0; i < DCONV - 1; ++i)
+    {
+        window[i + 1] = cuda_cast<float, input_t>(state_in[(slot_idx * (DCONV - 1) + i) * num_channels + channel]);
+    }
+
+    for (int t = 0; t < num_tokens; ++t)
+    {
+        int const row = sample * num_tokens + t;
+#pragma unroll
+        for (int i = 0; i < DCONV - 1; ++i)
+        {
+            window[i] = window[i + 1];
+        }
+        window[DCONV - 1] = cuda_cast<float, input_t>(input[row * num_channels + channel]);
+
+        float result = reg_bias;
+#pragma unroll
+        for (int i = 0; i < DCONV; ++i)
+        {
+            result += reg_weight[i] * window[i];
+        }
+        if (params.apply_silu)
+        {
+            result *= result < -20.0 ? 0.0f : 1.0f / (1.0f + __expf(-result));
+        }
+        output[row * num_channels + channel] = cuda_cast<input_t, float>(result);
+
+#pragma unroll
+        for (int i = 0; i < DCONV - 1; ++i)
+        {
+            checkpoints[(row * (DCONV - 1) + i) * num_channels + channel] = cuda_cast<input_t, float>(window[i + 1]);
+        }
+    }
+}
+
 template <typename input_t>
 void invokeMambaConv1dGeneration(MambaConv1dParamsBase& params, cudaStream_t stream)
 {
@@ -1183,6 +1249,14 @@ void invokeMambaConv1dGeneration(MambaConv1dParamsBase& params, cudaStream_t str
     int const channelsPerBlock = threadsPerBlock * channelsPerThread;
     TLLM_CHECK_WITH_INFO(channels % channelsPerThread == 0, "channels should be multiple of channelsPerThread");
     TLLM_CHECK_WITH_INFO(params.dconv == dConv, "only dconv == 4 is supported now.");
+    if (params.state_checkpoints_ptr != nullptr)
+    {
+        TLLM_CHECK(params.num_spec_tokens > 0);
+        int const threads = 128;
+        dim3 grid((channels + threads - 1) / threads, samples);
+        mamba_conv1d_generation_checkpoint_kernel<input_t, dConv><<<grid, threads, 0, stream>>>(params);
+        return;
+    }
     int blockx = (channels + channelsPerBlock - 1) / channelsPerBlock;
     int blocky = (samples + microBatchSize - 1) / microBatchSize;
     dim3 grid(blockx, blocky, 1);
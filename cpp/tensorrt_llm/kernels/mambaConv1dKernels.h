@@ -37,6 +37,9 @@ struct MambaConv1dParamsBase
     void* __restrict__ out_ptr;
     int const* __restrict__ last_token_ids_ptr;
     int const* __restrict__ state_slot_mapping_ptr;
+    // Speculative decoding, see invokeMambaConv1dGeneration. Disabled if state_checkpoints_ptr is null.
+    void* __restrict__ state_checkpoints_ptr;
+    int num_spec_tokens;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -44,6 +47,9 @@ struct MambaConv1dParamsBase
 template <typename input_t>
 void invokeMambaConv1dContext(MambaConv1dParamsBase& params, cudaStream_t stream);
 
+//! \brief Generation step. With params.state_checkpoints_ptr set, every sample has a linear chain of num_spec_tokens
+//! tokens which are convolved starting from the state in state_in_ptr. The conv state after each of them goes to
+//! state_checkpoints_ptr [batch, num_spec_tokens, dconv - 1, dim] instead of state_out_ptr.
 template <typename input_t>
 void invokeMambaConv1dGeneration(MambaConv1dParamsBase& params, cudaStream_t stream);
 
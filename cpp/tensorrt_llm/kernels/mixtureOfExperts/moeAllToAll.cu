@@ -0,0 +1,249 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/mixtureOfExperts/moeAllToAll.h"
+#include <cuda_fp16.h>
+#include <math.h>
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm::kernels
+{
+
+static constexpr int WARP_SIZE = 32;
+static constexpr int LAYOUT_THREADS_PER_BLOCK = 1024;
+static constexpr int LAYOUT_WARPS_PER_BLOCK = LAYOUT_THREADS_PER_BLOCK / WARP_SIZE;
+
+// A single CTA counts the rows of every rank, then walks the rows in chunks of LAYOUT_THREADS_PER_BLOCK. Within a
+// chunk a row lands after the rows of the same rank in earlier chunks, in earlier warps and in lower lanes, so the
+// layout is deterministic and stable.
+__global__ void moeDispatchLayoutKernel(int const* expert_for_source_row, int64_t const num_expanded_rows,
+    int const num_experts, int const experts_per_rank, int const ep_size, int* send_counts,
+    int* send_slot_for_expanded_row, int* send_expanded_row, int* send_local_expert)
+{
+    __shared__ int rank_counts[kMaxMoeAllToAllRanks];
+    __shared__ int rank_next[kMaxMoeAllToAllRanks];
+    __shared__ int warp_counts[LAYOUT_WARPS_PER_BLOCK][kMaxMoeAllToAllRanks];
+
+    int const tid = threadIdx.x;
+    int const warp = tid / WARP_SIZE;
+    int const lane = tid % WARP_SIZE;
+
+    for (int r = tid; r < ep_size; r += blockDim.x)
+    {
+        rank_counts[r] = 0;
+    }
+    __syncthreads();
+
+    for (int64_t row = tid; row < num_expanded_rows; row += blockDim.x)
+    {
+        int const expert = expert_for_source_row[row];
+        if (expert < num_experts)
+        {
+            atomicAdd(&rank_counts[expert / experts_per_rank], 1);
+        }
+    }
+    __syncthreads();
+
+    if (tid == 0)
+    {
+        int offset = 0;
+        for (int r = 0; r < ep_size; ++r)
+        {
+            rank_next[r] = offset;
+            offset += rank_counts[r];
+            send_counts[r] = rank_counts[r];
+        }
+    }
+
+    for (int64_t chunk = 0; chunk < num_expanded_rows; chunk += blockDim.x)
+    {
+        for (int i = tid; i < LAYOUT_WARPS_PER_BLOCK * ep_size; i += blockDim.x)
+        {
+            warp_counts[i / ep_size][i % ep_size] = 0;
+        }
+        __syncthreads();
+
+        int64_t const row = chunk + tid;
+        int const expert = row < num_expanded_rows ? expert_for_source_row[row] : num_experts;
+        int const dest = expert < num_experts ? expert / experts_per_rank : -1;
+
+        unsigned const peers = __match_any_sync(0xffffffff, dest);
+        int const lane_rank = __popc(peers & ((1u << lane) - 1));
+        if (dest >= 0 && lane == __ffs(peers) - 1)
+        {
+            warp_counts[warp][dest] = __popc(peers);
+        }
+        __syncthreads();
+
+        if (dest >= 0)
+        {
+            int pos = rank_next[dest] + lane_rank;
+            for (int w = 0; w < warp; ++w)
+            {
+                pos += warp_counts[w][dest];
+            }
+            send_slot_for_expanded_row[row] = pos;
+            send_expanded_row[pos] = static_cast<int>(row);
+            send_local_expert[pos] = expert - dest * experts_per_rank;
+        }
+        else if (row < num_expanded_rows)
+        {
+            send_slot_for_expanded_row[row] = -1;
+        }
+        __syncthreads();
+
+        for (int r = tid; r < ep_size; r += blockDim.x)
+        {
+            for (int w = 0; w < LAYOUT_WARPS_PER_BLOCK; ++w)
+            {
+                rank_next[r] += warp_counts[w][r];
+            }
+        }
+        __syncthreads();
+    }
+}
+
+void invokeMoeDispatchLayout(int const* expert_for_source_row, int64_t const num_rows, int const k,
+    int const num_experts, int const ep_size, int* send_counts, int* send_slot_for_expanded_row,
+    int* send_expanded_row, int* send_local_expert, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(ep_size <= kMaxMoeAllToAllRanks, "The MoE all-to-all supports up to %d ranks, got %d",
+        kMaxMoeAllToAllRanks, ep_size);
+    TLLM_CHECK_WITH_INFO(
+        num_experts % ep_size == 0, "Number of experts (%d) must be a multiple of ep size (%d)", num_experts, ep_size);
+    moeDispatchLayoutKernel<<<1, LAYOUT_THREADS_PER_BLOCK, 0, stream>>>(expert_for_source_row, num_rows * k,
+        num_experts, num_experts / ep_size, ep_size, send_counts, send_slot_for_expanded_row, send_expanded_row,
+        send_local_expert);
+}
+
+static constexpr int COPY_THREADS_PER_BLOCK = 256;
+
+template <typename T>
+__global__ void moeDispatchGatherKernel(
+    T const* input, T* send_rows, int const* send_expanded_row, int64_t const hidden_size, int const k)
+{
+    int64_t const send_row = blockIdx.x;
+    int64_t const source_row = send_expanded_row[send_row] / k;
+    T const* src = input + source_row * hidden_size;
+    T* dst = send_rows + send_row * hidden_size;
+    for (int64_t i = threadIdx.x; i < hidden_size; i += blockDim.x)
+    {
+        dst[i] = src[i];
+    }
+}
+
+template <typename T>
+void invokeMoeDispatchGather(T const* input, T* send_rows, int const* send_expanded_row, int64_t const num_send_rows,
+    int64_t const hidden_size, int const k, cudaStream_t stream)
+{
+    if (num_send_rows == 0)
+    {
+        return;
+    }
+    moeDispatchGatherKernel<T>
+        <<<num_send_rows, COPY_THREADS_PER_BLOCK, 0, stream>>>(input, send_rows, send_expanded_row, hidden_size, k);
+}
+
+__global__ void moeLocalRoutingKernel(
+    float* logits, int const* local_expert, int64_t const num_elems, int const num_local_experts)
+{
+    for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < num_elems; i += gridDim.x * blockDim.x)
+    {
+        int64_t const row = i / num_local_experts;
+        int const expert = static_cast<int>(i % num_local_experts);
+        // The softmax of a single finite logit is exactly 1
+        logits[i] = expert == local_expert[row] ? 0.f : -INFINITY;
+    }
+}
+
+void invokeMoeLocalRouting(
+    float* logits, int const* local_expert, int64_t const num_rows, int const num_local_experts, cudaStream_t stream)
+{
+    int64_t const num_elems = num_rows * num_local_experts;
+    if (num_elems == 0)
+    {
+        return;
+    }
+    int64_t const blocks = std::min<int64_t>(divUp(num_elems, COPY_THREADS_PER_BLOCK), 65536);
+    moeLocalRoutingKernel<<<blocks, COPY_THREADS_PER_BLOCK, 0, stream>>>(
+        logits, local_expert, num_elems, num_local_experts);
+}
+
+template <typename T>
+__global__ void moeCombineKernel(T const* returned_rows, T* output, float const* expert_scales,
+    int const* send_slot_for_expanded_row, int64_t const hidden_size, int const k, bool const renormalize)
+{
+    int64_t const row = blockIdx.x;
+    float norm = 1.f;
+    if (renormalize)
+    {
+        float sum = 0.f;
+        for (int j = 0; j < k; ++j)
+        {
+            sum += send_slot_for_expanded_row[row * k + j] >= 0 ? expert_scales[row * k + j] : 0.f;
+        }
+        norm = sum > 0.f ? 1.f / sum : 0.f;
+    }
+
+    T* out = output + row * hidden_size;
+    for (int64_t i = threadIdx.x; i < hidden_size; i += blockDim.x)
+    {
+        float acc = 0.f;
+        for (int j = 0; j < k; ++j)
+        {
+            int const slot = send_slot_for_expanded_row[row * k + j];
+            if (slot >= 0)
+            {
+                acc += expert_scales[row * k + j] * norm * static_cast<float>(returned_rows[slot * hidden_size + i]);
+            }
+        }
+        out[i] = static_cast<T>(acc);
+    }
+}
+
+template <typename T>
+void invokeMoeCombine(T const* returned_rows, T* output, float const* expert_scales,
+    int const* send_slot_for_expanded_row, int64_t const num_rows, int64_t const hidden_size, int const k,
+    MOEExpertScaleNormalizationMode normalization_mode, cudaStream_t stream)
+{
+    if (num_rows == 0)
+    {
+        return;
+    }
+    bool const renormalize = normalization_mode == MOEExpertScaleNormalizationMode::RENORMALIZE;
+    moeCombineKernel<T><<<num_rows, COPY_THREADS_PER_BLOCK, 0, stream>>>(
+        returned_rows, output, expert_scales, send_slot_for_expanded_row, hidden_size, k, renormalize);
+}
+
+#define INSTANTIATE_MOE_ALL_TO_ALL(T)                                                                                  \
+    template void invokeMoeDispatchGather<T>(T const* input, T* send_rows, int const* send_expanded_row,              \
+        int64_t const num_send_rows, int64_t const hidden_size, int const k, cudaStream_t stream);                     \
+    template void invokeMoeCombine<T>(T const* returned_rows, T* output, float const* expert_scales,                   \
+        int const* send_slot_for_expanded_row, int64_t const num_rows, int64_t const hidden_size, int const k,         \
+        MOEExpertScaleNormalizationMode normalization_mode, cudaStream_t stream);
+
+INSTANTIATE_MOE_ALL_TO_ALL(float);
+INSTANTIATE_MOE_ALL_TO_ALL(half);
+#ifdef ENABLE_BF16
+INSTANTIATE_MOE_ALL_TO_ALL(__nv_bfloat16);
+#endif
+
+#undef INSTANTIATE_MOE_ALL_TO_ALL
+
+} // namespace tensorrt_llm::kernels
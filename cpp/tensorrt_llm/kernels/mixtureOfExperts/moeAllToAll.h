@@ -0,0 +1,67 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include "tensorrt_llm/kernels/mixtureOfExperts/moe_kernels.h"
+#include <cuda_runtime_api.h>
+
+namespace tensorrt_llm::kernels
+{
+
+/**
+ * Kernels for expert parallelism with an all-to-all token exchange. Each rank routes its own tokens, sends every
+ * (token, expert) pair to the rank owning the expert, runs its local experts on the rows it received and sends the
+ * results back to be combined. The exchange itself is left to the caller (see MixtureOfExpertsPlugin), the kernels
+ * only build and consume contiguous per-rank segments.
+ *
+ * An expanded row is a (token, k index) pair, numbered token * k + k_idx as in expert_for_source_row.
+ */
+
+// Largest expert parallel group handled by invokeMoeDispatchLayout
+constexpr int kMaxMoeAllToAllRanks = 64;
+
+/**
+ * Groups the expanded rows by destination rank, keeping their order within a rank.
+ *
+ * expert_for_source_row holds [num_rows * k] global expert ids, num_experts marking a row not routed anywhere (a
+ * finished token). Outputs:
+ *  * send_counts[ep_size]: number of rows sent to every rank
+ *  * send_slot_for_expanded_row[num_rows * k]: position of the expanded row in the send buffer, -1 if not routed
+ *  * send_expanded_row[num_rows * k]: the expanded row sent at every position of the send buffer
+ *  * send_local_expert[num_rows * k]: the expert of the destination rank for every position of the send buffer
+ */
+void invokeMoeDispatchLayout(int const* expert_for_source_row, int64_t const num_rows, int const k,
+    int const num_experts, int const ep_size, int* send_counts, int* send_slot_for_expanded_row,
+    int* send_expanded_row, int* send_local_expert, cudaStream_t stream);
+
+// Copies the input row of every send position: send_rows[i] = input[send_expanded_row[i] / k]
+template <typename T>
+void invokeMoeDispatchGather(T const* input, T* send_rows, int const* send_expanded_row, int64_t const num_send_rows,
+    int64_t const hidden_size, int const k, cudaStream_t stream);
+
+// Writes [num_rows, num_local_experts] routing logits that send every received row to its expert with a weight of 1
+void invokeMoeLocalRouting(
+    float* logits, int const* local_expert, int64_t const num_rows, int const num_local_experts, cudaStream_t stream);
+
+// output[t] = sum over j of scale[t, j] * returned_rows[send_slot_for_expanded_row[t * k + j]], with the scales
+// renormalized over the k selected experts in RENORMALIZE mode.
+template <typename T>
+void invokeMoeCombine(T const* returned_rows, T* output, float const* expert_scales,
+    int const* send_slot_for_expanded_row, int64_t const num_rows, int64_t const hidden_size, int const k,
+    MOEExpertScaleNormalizationMode normalization_mode, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels
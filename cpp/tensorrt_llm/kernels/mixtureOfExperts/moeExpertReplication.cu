@@ -0,0 +1,183 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/mixtureOfExperts/moeExpertReplication.h"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm::kernels
+{
+
+static constexpr int REPLICA_ROUTING_THREADS_PER_BLOCK = 256;
+
+__global__ void moeReplicaRoutingKernel(int* expert_for_source_row, int64_t const num_expanded_rows, int const k,
+    int const num_experts, int const* node_table)
+{
+    int const* num_replicas = node_table;
+    int const* node_replica = node_table + num_experts;
+    int const* local_slot = node_table + 2 * num_experts;
+    for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < num_expanded_rows; i += gridDim.x * blockDim.x)
+    {
+        int const expert = expert_for_source_row[i];
+        if (expert >= num_experts)
+        {
+            continue;
+        }
+        int64_t const token = i / k;
+        int const replica = node_replica[expert];
+        bool const is_local = replica >= 0 && token % num_replicas[expert] == replica;
+        expert_for_source_row[i] = is_local ? local_slot[expert] : num_experts;
+    }
+}
+
+void invokeMoeReplicaRouting(int* expert_for_source_row, int64_t const num_rows, int const k, int const num_experts,
+    int const* node_table, cudaStream_t stream)
+{
+    int64_t const num_expanded_rows = num_rows * k;
+    if (num_expanded_rows == 0)
+    {
+        return;
+    }
+    int64_t const blocks = std::min<int64_t>(divUp(num_expanded_rows, REPLICA_ROUTING_THREADS_PER_BLOCK), 65536);
+    moeReplicaRoutingKernel<<<blocks, REPLICA_ROUTING_THREADS_PER_BLOCK, 0, stream>>>(
+        expert_for_source_row, num_expanded_rows, k, num_experts, node_table);
+}
+
+MoeReplicationPlan::MoeReplicationPlan(std::vector<int64_t> const& expert_loads, int ep_size, int num_replica_slots)
+    : mNumExperts(static_cast<int>(expert_loads.size()))
+    , mNumReplicaSlots(num_replica_slots)
+    , mExpertLoads(expert_loads)
+{
+    TLLM_CHECK_WITH_INFO(ep_size > 0, "ep size must be positive, got %d", ep_size);
+    TLLM_CHECK_WITH_INFO(num_replica_slots >= 0, "Number of replica slots must not be negative");
+    TLLM_CHECK_WITH_INFO(mNumExperts % ep_size == 0, "Number of experts (%d) must be a multiple of ep size (%d)",
+        mNumExperts, ep_size);
+    mExpertsPerNode = mNumExperts / ep_size;
+    TLLM_CHECK_WITH_INFO(mExpertsPerNode + num_replica_slots <= mNumExperts,
+        "A node cannot hold more than num_experts (%d) experts including its replicas", mNumExperts);
+
+    mReplicaNodes.resize(mNumExperts);
+    for (int e = 0; e < mNumExperts; ++e)
+    {
+        mReplicaNodes[e] = {e / mExpertsPerNode};
+    }
+    mReplicaExperts.assign(ep_size, std::vector<int>(num_replica_slots, -1));
+    std::vector<int> free_slots(ep_size, num_replica_slots);
+
+    std::vector<int> order(mNumExperts);
+    bool placed = true;
+    while (placed)
+    {
+        placed = false;
+        auto node_loads = getNodeLoads();
+        double const max_load = *std::max_element(node_loads.begin(), node_loads.end());
+
+        auto const share = [&](int e) { return static_cast<double>(mExpertLoads[e]) / mReplicaNodes[e].size(); };
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return share(a) > share(b); });
+
+        for (int const e : order)
+        {
+            if (mExpertLoads[e] <= 0)
+            {
+                break;
+            }
+            auto& holders = mReplicaNodes[e];
+            int target = -1;
+            for (int r = 0; r < ep_size; ++r)
+            {
+                bool const eligible
+                    = free_slots[r] > 0 && std::find(holders.begin(), holders.end(), r) == holders.end();
+                if (eligible && (target < 0 || node_loads[r] < node_loads[target]))
+                {
+                    target = r;
+                }
+            }
+            if (target < 0)
+            {
+                continue;
+            }
+
+            double const new_share = static_cast<double>(mExpertLoads[e]) / (holders.size() + 1);
+            double new_max = node_loads[target] + new_share;
+            for (int r = 0; r < ep_size; ++r)
+            {
+                bool const holds = std::find(holders.begin(), holders.end(), r) != holders.end();
+                double const load = holds ? node_loads[r] - share(e) + new_share : node_loads[r];
+                new_max = r == target ? new_max : std::max(new_max, load);
+            }
+            if (new_max > max_load)
+            {
+                continue;
+            }
+
+            mReplicaExperts[target][num_replica_slots - free_slots[target]] = e;
+            --free_slots[target];
+            holders.push_back(target);
+            placed = true;
+            break;
+        }
+    }
+}
+
+std::vector<double> MoeReplicationPlan::getNodeLoads() const
+{
+    std::vector<double> node_loads(mReplicaExperts.size(), 0.0);
+    for (int e = 0; e < mNumExperts; ++e)
+    {
+        double const share = static_cast<double>(mExpertLoads[e]) / mReplicaNodes[e].size();
+        for (int const r : mReplicaNodes[e])
+        {
+            node_loads[r] += share;
+        }
+    }
+    return node_loads;
+}
+
+std::vector<int> MoeReplicationPlan::getNodeTable(int ep_rank) const
+{
+    TLLM_CHECK_WITH_INFO(ep_rank >= 0 && ep_rank < static_cast<int>(mReplicaExperts.size()), "Invalid ep rank %d",
+        ep_rank);
+    std::vector<int> table(3 * mNumExperts);
+    auto const& replica_experts = mReplicaExperts[ep_rank];
+    for (int e = 0; e < mNumExperts; ++e)
+    {
+        auto const& holders = mReplicaNodes[e];
+        auto const it = std::find(holders.begin(), holders.end(), ep_rank);
+        int const replica = it == holders.end() ? -1 : static_cast<int>(it - holders.begin());
+        int slot = -1;
+        if (replica == 0)
+        {
+            slot = e - ep_rank * mExpertsPerNode;
+        }
+        else if (replica > 0)
+        {
+            auto const replicaIt = std::find(replica_experts.begin(), replica_experts.end(), e);
+            slot = mExpertsPerNode + static_cast<int>(replicaIt - replica_experts.begin());
+        }
+        table[e] = static_cast<int>(holders.size());
+        table[mNumExperts + e] = replica;
+        table[2 * mNumExperts + e] = slot;
+    }
+    return table;
+}
+
+} // namespace tensorrt_llm::kernels
@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include "tensorrt_llm/kernels/mixtureOfExperts/moe_kernels.h"
+#include <cuda_runtime_api.h>
+#include <vector>
+
+namespace tensorrt_llm::kernels
+{
+
+/**
+ * Hot expert replication for expert parallelism. With skewed routing the node holding the most popular experts sets
+ * the latency of the layer. A node can hold copies of experts owned by other nodes in extra weight slots, and the rows
+ * of a replicated expert are shared between its replicas: token t goes to replica t % num_replicas. Every node sees
+ * the same tokens, so exactly one node computes every row and the allreduce is unchanged.
+ *
+ * The table of a node holds three [num_experts] arrays:
+ *  * the number of replicas of every expert, 1 for an expert that is not replicated
+ *  * the index of the node's replica of every expert, 0 on the owner, -1 if the node holds none
+ *  * the local slot of that replica, the node's own experts first and the replica slots after them
+ */
+
+// Replaces the global experts selected by topk with the local slot of this node, or num_experts when another node
+// computes the row. expert_for_source_row holds [num_rows * k] global experts, num_experts for finished rows.
+void invokeMoeReplicaRouting(int* expert_for_source_row, int64_t const num_rows, int const k, int const num_experts,
+    int const* node_table, cudaStream_t stream);
+
+/**
+ * Places replicas of the hottest experts given the expected load of every expert, e.g. the counts accumulated by
+ * MoeLoadStatsCollector over previous iterations.
+ *
+ * Greedily gives a new replica to the expert with the highest load per replica, on the least loaded node that has a
+ * free slot and no copy of the expert yet. A replica is only added when it does not raise the load of the most loaded
+ * node, so the plan may leave slots unused.
+ */
+class MoeReplicationPlan
+{
+public:
+    MoeReplicationPlan(std::vector<int64_t> const& expert_loads, int ep_size, int num_replica_slots);
+
+    int getNumReplicas(int expert) const
+    {
+        return static_cast<int>(mReplicaNodes[expert].size());
+    }
+
+    // The global expert held in every replica slot of a node, -1 for an unused slot
+    std::vector<int> const& getReplicaExperts(int ep_rank) const
+    {
+        return mReplicaExperts[ep_rank];
+    }
+
+    // Expected load of every node with the replicas in place
+    std::vector<double> getNodeLoads() const;
+
+    // The [3 * num_experts] table to upload for MOEExpertReplication::node_table
+    std::vector<int> getNodeTable(int ep_rank) const;
+
+private:
+    int mNumExperts;
+    int mExpertsPerNode;
+    int mNumReplicaSlots;
+    std::vector<int64_t> mExpertLoads;
+    // Nodes holding every expert, the owner first
+    std::vector<std::vector<int>> mReplicaNodes;
+    std::vector<std::vector<int>> mReplicaExperts;
+};
+
+} // namespace tensorrt_llm::kernels
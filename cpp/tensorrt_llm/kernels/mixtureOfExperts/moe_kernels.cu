@@ -42,6 +42,7 @@
 
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/kernels/mixtureOfExperts/moe_kernels.h"
+#include "tensorrt_llm/kernels/mixtureOfExperts/moeExpertReplication.h"
 
 #ifndef CUDART_VERSION
 #error CUDART_VERSION Undefined!
@@ -586,6 +587,18 @@ __global__ void computeTotalRowsBeforeExpertKernel(int const* sorted_experts, in
     total_rows_before_expert[expert] = findTotalEltsLeqTarget(sorted_experts, sorted_experts_len, expert);
 }
 
+__global__ void accumulateExpertLoadKernel(
+    int64_t const* total_rows_before_expert, int64_t const num_experts, int64_t* expert_load_counts)
+{
+    int const expert = blockIdx.x * blockDim.x + threadIdx.x;
+    if (expert >= num_experts)
+    {
+        return;
+    }
+    int64_t const rows_before = expert == 0 ? 0 : total_rows_before_expert[expert - 1];
+    expert_load_counts[expert] += total_rows_before_expert[expert] - rows_before;
+}
+
 namespace detail
 {
 // TODO these are copied from CUTLASS because the cutlass version is missing __device__ decorator
@@ -770,6 +783,83 @@ void expandInputRowsKernelLauncher(T const* unpermuted_input, T* permuted_output
         expanded_source_row_to_expanded_dest_row, num_rows, num_valid_tokens_ptr, cols);
 }
 
+// Up to this many expanded rows, the sort, the expert offsets and the expansion run as one kernel
+constexpr static int64_t FUSED_ROUTING_MAX_EXPANDED_ROWS = 1024;
+
+// Replaces the radix sort, computeTotalRowsBeforeExpertKernel and expandInputRowsKernel for small batches. Every block
+// handles one unsorted expanded row and finds its sorted position by counting the rows before it, which gives the same
+// stable order as the sort. Block 0 also writes the expert offsets.
+template <typename T>
+__global__ void fusedRoutingExpandKernel(T const* unpermuted_input, T* permuted_output,
+    int const* expert_for_source_row, int const* source_rows, int* expanded_source_row_to_expanded_dest_row,
+    int64_t* total_rows_before_expert, int64_t const num_rows, int64_t const num_expanded_rows,
+    int const num_experts_per_node, int const num_experts, int64_t const cols)
+{
+    using BlockReduce = cub::BlockReduce<int, EXPAND_THREADS_PER_BLOCK>;
+    __shared__ typename BlockReduce::TempStorage temp_storage;
+    __shared__ int dest_row;
+
+    int64_t const unsorted_row = blockIdx.x;
+    int const expert = expert_for_source_row[unsorted_row];
+
+    int rows_before = 0;
+    for (int64_t i = threadIdx.x; i < num_expanded_rows; i += EXPAND_THREADS_PER_BLOCK)
+    {
+        int const other = expert_for_source_row[i];
+        rows_before += (other < expert || (other == expert && i < unsorted_row)) ? 1 : 0;
+    }
+    rows_before = BlockReduce(temp_storage).Sum(rows_before);
+
+    int const expanded_source_row = source_rows[unsorted_row];
+    if (threadIdx.x == 0)
+    {
+        dest_row = rows_before;
+        expanded_source_row_to_expanded_dest_row[expanded_source_row] = rows_before;
+    }
+
+    if (blockIdx.x == 0)
+    {
+        for (int e = threadIdx.x; e < num_experts_per_node; e += EXPAND_THREADS_PER_BLOCK)
+        {
+            int64_t rows_leq = 0;
+            for (int64_t i = 0; i < num_expanded_rows; ++i)
+            {
+                rows_leq += expert_for_source_row[i] <= e ? 1 : 0;
+            }
+            total_rows_before_expert[e] = rows_leq;
+        }
+    }
+    __syncthreads();
+
+    // Rows not routed to this node are sorted last and never read
+    if (expert < num_experts)
+    {
+        constexpr int64_t ELEM_PER_THREAD = 128 / cutlass::sizeof_bits<T>::value;
+        using DataElem = cutlass::Array<T, ELEM_PER_THREAD>;
+
+        int64_t const source_row = expanded_source_row % num_rows;
+        auto const* source_row_ptr = reinterpret_cast<DataElem const*>(unpermuted_input + source_row * cols);
+        auto* dest_row_ptr = reinterpret_cast<DataElem*>(permuted_output + dest_row * cols);
+        int64_t const num_elems_in_col = cols / ELEM_PER_THREAD;
+        for (int64_t elem_index = threadIdx.x; elem_index < num_elems_in_col; elem_index += EXPAND_THREADS_PER_BLOCK)
+        {
+            dest_row_ptr[elem_index] = source_row_ptr[elem_index];
+        }
+    }
+}
+
+template <typename T>
+void fusedRoutingExpandKernelLauncher(T const* unpermuted_input, T* permuted_output, int const* expert_for_source_row,
+    int const* source_rows, int* expanded_source_row_to_expanded_dest_row, int64_t* total_rows_before_expert,
+    int64_t const num_rows, int const k, int const num_experts_per_node, int const num_experts, int64_t const cols,
+    cudaStream_t stream)
+{
+    int64_t const blocks = num_rows * k;
+    fusedRoutingExpandKernel<T><<<blocks, EXPAND_THREADS_PER_BLOCK, 0, stream>>>(unpermuted_input, permuted_output,
+        expert_for_source_row, source_rows, expanded_source_row_to_expanded_dest_row, total_rows_before_expert,
+        num_rows, blocks, num_experts_per_node, num_experts, cols);
+}
+
 enum class ScaleMode : int
 {
     NO_SCALE = 0,
@@ -1086,8 +1176,9 @@ size_t CutlassMoeFCRunner<T, WeightType, OutputType, Enable>::getWorkspaceSize(i
 {
     int const ep_size = parallelism_config.ep_size;
     TLLM_CHECK_WITH_INFO(num_experts % ep_size == 0, "Number of experts must be a multiple of tp size");
+    int const num_replica_slots = expert_replication.isEnabled() ? expert_replication.num_replica_slots : 0;
     auto workspace = getWorkspaceBufferSizes(
-        num_rows, hidden_size, inter_size, num_experts, num_experts / ep_size, k, activation_type);
+        num_rows, hidden_size, inter_size, num_experts, num_experts / ep_size + num_replica_slots, k, activation_type);
     return tensorrt_llm::common::calculateTotalWorkspaceSize(workspace.data(), workspace.size());
 }
 
@@ -1223,39 +1314,77 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, Enable>::runMoe(void const* i
             fc2_fp8_dequant == nullptr, "Scales are ignored for fp32/fp16/bf16 but received quant scale for FC2");
     }
 
-    int const num_experts_per_node = num_experts / parallelism_config.ep_size;
-    int const start_expert = num_experts_per_node * parallelism_config.ep_rank;
-    int const end_expert = start_expert + num_experts_per_node;
+    bool const use_replication = expert_replication.isEnabled();
+    int const num_owned_experts = num_experts / parallelism_config.ep_size;
+    int const start_expert = num_owned_experts * parallelism_config.ep_rank;
+    int const end_expert = start_expert + num_owned_experts;
+    // The replica slots follow the node's own experts
+    int const num_experts_per_node = num_owned_experts + (use_replication ? expert_replication.num_replica_slots : 0);
+    // num_experts marks the rows computed by another node
+    TLLM_CHECK_WITH_INFO(num_experts_per_node <= num_experts, "A node cannot hold more than num_experts experts");
 
     configureWsPtrs(
         workspace_ptr, num_rows, hidden_size, inter_size, num_experts, num_experts_per_node, k, fc1_activation_type);
-    topkGatingSoftmaxKernelLauncher(gating_output, finished, expert_scales, softmax_out_, expert_for_source_row,
-        source_rows_, num_rows, num_experts, k, start_expert, end_expert, stream);
-
-    sync_check_cuda_error();
-
-    // We need to use the full num_experts because that is the sentinel value used by topk for disabled experts
-    sorter_.updateNumExperts(num_experts);
-    size_t const sorter_ws_size_bytes = pad_to_multiple_of_16(sorter_.getWorkspaceSize(k * num_rows, num_experts));
-    sorter_.run((void*) sorter_ws_, sorter_ws_size_bytes, expert_for_source_row, permuted_experts_, source_rows_,
-        permuted_rows_, k * num_rows, stream);
+    if (use_replication)
+    {
+        topkGatingSoftmaxKernelLauncher(gating_output, finished, expert_scales, softmax_out_, expert_for_source_row,
+            source_rows_, num_rows, num_experts, k, 0, num_experts, stream);
+        invokeMoeReplicaRouting(
+            expert_for_source_row, num_rows, k, num_experts, expert_replication.node_table, stream);
+    }
+    else
+    {
+        topkGatingSoftmaxKernelLauncher(gating_output, finished, expert_scales, softmax_out_, expert_for_source_row,
+            source_rows_, num_rows, num_experts, k, start_expert, end_expert, stream);
+    }
 
     sync_check_cuda_error();
 
     bool const is_gated_activation = isGatedActivation(fc1_activation_type);
-    bool const use_fused_moe = moe_gemm_runner_.isFusedGatedActivation(is_gated_activation, inter_size, hidden_size);
+    bool const use_fused_moe = moe_gemm_runner_.isFusedGatedActivation(
+        is_gated_activation, inter_size, hidden_size, fc1_expert_biases != nullptr);
     size_t const fc1_out_size = ((!use_fused_moe) && is_gated_activation) ? inter_size * 2 : inter_size;
 
     // Upper bound on number of expanded rows
     int64_t const expanded_active_expert_rows = k * active_rows;
-    computeTotalRowsBeforeExpert(
-        permuted_experts_, expanded_active_expert_rows, num_experts_per_node, total_rows_before_expert_, stream);
 
     bool const needs_num_valid = finished || parallelism_config.ep_size > 1;
     int64_t const* num_valid_tokens_ptr
         = needs_num_valid ? total_rows_before_expert_ + num_experts_per_node - 1 : nullptr;
-    expandInputRowsKernelLauncher(input_activations, permuted_data_, permuted_rows_,
-        expanded_source_row_to_expanded_dest_row, num_rows, num_valid_tokens_ptr, hidden_size, k, stream);
+
+    // At decode batch sizes the launches and the radix sort cost as much as the expert GEMMs
+    bool const use_fused_routing = active_rows == num_rows && k * num_rows <= FUSED_ROUTING_MAX_EXPANDED_ROWS;
+    if (use_fused_routing)
+    {
+        fusedRoutingExpandKernelLauncher(input_activations, permuted_data_, expert_for_source_row, source_rows_,
+            expanded_source_row_to_expanded_dest_row, total_rows_before_expert_, num_rows, k, num_experts_per_node,
+            num_experts, hidden_size, stream);
+    }
+    else
+    {
+        // We need to use the full num_experts because that is the sentinel value used by topk for disabled experts
+        sorter_.updateNumExperts(num_experts);
+        size_t const sorter_ws_size_bytes
+            = pad_to_multiple_of_16(sorter_.getWorkspaceSize(k * num_rows, num_experts));
+        sorter_.run((void*) sorter_ws_, sorter_ws_size_bytes, expert_for_source_row, permuted_experts_, source_rows_,
+            permuted_rows_, k * num_rows, stream);
+
+        sync_check_cuda_error();
+
+        computeTotalRowsBeforeExpert(
+            permuted_experts_, expanded_active_expert_rows, num_experts_per_node, total_rows_before_expert_, stream);
+
+        expandInputRowsKernelLauncher(input_activations, permuted_data_, permuted_rows_,
+            expanded_source_row_to_expanded_dest_row, num_rows, num_valid_tokens_ptr, hidden_size, k, stream);
+    }
+
+    if (expert_load_counts)
+    {
+        int const threads = std::min(1024, num_experts_per_node);
+        int const blocks = (num_experts_per_node + threads - 1) / threads;
+        accumulateExpertLoadKernel<<<blocks, threads, 0, stream>>>(
+            total_rows_before_expert_, num_experts_per_node, expert_load_counts);
+    }
 
     sync_check_cuda_error();
 
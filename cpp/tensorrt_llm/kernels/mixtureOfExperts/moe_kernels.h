@@ -59,6 +59,8 @@ enum class MOEParallelismMode : int
                         //!< parallelism
     TENSOR_PARALLELISM, //!< Divide the weight matrices between the nodes. The hidden dimension must be a multiple of
                         //!< parallelism
+    EXPERT_PARALLELISM_ALL_TO_ALL, //!< Divide the experts between each node, and send every token only to the nodes
+                                   //!< holding its experts. Each node passes its own tokens
 };
 
 enum class MOEExpertScaleNormalizationMode : int
@@ -88,6 +90,10 @@ enum class MOEExpertScaleNormalizationMode : int
  * Regardless of parallelism mode:
  *  * The input routing values must be the complete routing for all tokens/experts (required for softmax)
  *  * An allreduce must be run on the result to combine the results from different nodes if parallelism > 1
+ *
+ * The exception is the all-to-all flavour of expert parallelism, see moeAllToAll.h. There every node passes a different
+ * set of tokens, rows are exchanged before and after the expert GEMMs, and the result needs no allreduce. The
+ * CutlassMoeFCRunner only sees the rows a node received, with the node's experts, so it runs without parallelism.
  */
 struct MOEParallelismConfig
 {
@@ -107,6 +113,25 @@ struct MOEParallelismConfig
     int const ep_rank = 0;
 };
 
+/**
+ * \brief Describes the hot experts a node holds on top of its own experts, see moeExpertReplication.h
+ *
+ * With expert parallelism every node holds num_experts / ep_size experts, followed by num_replica_slots copies of
+ * experts owned by other nodes. The rows routed to a replicated expert are shared between its replicas, so only the
+ * weights of the replica slots need to be provided after the node's own experts.
+ */
+struct MOEExpertReplication
+{
+    // [3 * num_experts] table of this node, see MoeReplicationPlan::getNodeTable. nullptr disables replication
+    int const* node_table = nullptr;
+    int num_replica_slots = 0;
+
+    bool isEnabled() const
+    {
+        return node_table != nullptr;
+    }
+};
+
 struct QuantParams
 {
     // Int weight only quantization params
@@ -153,6 +178,12 @@ public:
         = 0;
 
     bool is_profiler = false;
+
+    MOEExpertReplication expert_replication{};
+
+    // Optional device counters, one per expert of the node including the replica slots. runMoe adds the number of
+    // rows routed to every expert, the caller owns and resets them
+    int64_t* expert_load_counts = nullptr;
 };
 
 // Assumes inputs activations are row major. Weights need to be preprocessed by th_op/weight_quantize.cc .
@@ -243,6 +274,13 @@ private:
     HopperGroupedGemmInput hopper_grouped_gemm_input_;
 };
 
+// Softmax over the routing logits and top k selection. Experts outside [start_expert, end_expert) are reported as
+// num_experts in indices, and softmax_temp_output ([num_rows, num_experts]) is only needed for the experts counts
+// without a specialised kernel.
+void topkGatingSoftmaxKernelLauncher(float const* input, bool const* finished, float* output,
+    float* softmax_temp_output, int* indices, int* source_row, int64_t const num_rows, int const num_experts,
+    int const k, int const start_expert, int const end_expert, cudaStream_t stream);
+
 void makeLoadBalancedRoutingConfiguration(
     void* data_void, int num_experts, int num_tokens, int k, nvinfer1::DataType type, cudaStream_t stream);
 
@@ -36,6 +36,80 @@ __device__ bool almostEqual(float a, float b, float epsilon)
     return fabs(a - b) < epsilon;
 }
 
+__device__ bool hasOccurrencePenalty(SizeType32 batchSlot, float const* repetitionPenalties,
+    float const* presencePenalties, float const* frequencyPenalties)
+{
+    bool accumulateVocab{false};
+    if (repetitionPenalties != nullptr)
+    {
+        accumulateVocab |= (!almostEqual(
+            repetitionPenalties[batchSlot], layers::DefaultDecodingParams::getRepetitionPenalty(), 1e-9));
+    }
+    if (presencePenalties != nullptr)
+    {
+        accumulateVocab
+            |= (!almostEqual(presencePenalties[batchSlot], layers::DefaultDecodingParams::getPresencePenalty(), 1e-9));
+    }
+    if (frequencyPenalties != nullptr)
+    {
+        accumulateVocab |= (!almostEqual(
+            frequencyPenalties[batchSlot], layers::DefaultDecodingParams::getFrequencyPenalty(), 1e-9));
+    }
+    return accumulateVocab;
+}
+
+__global__ void updatePenaltyWorkspace(TokenIdType* penaltyWorkspace, SizeType32* penaltyCountedLengths,
+    float const* repetitionPenalties, float const* presencePenalties, float const* frequencyPenalties,
+    SizeType32 vocabSize, TokenIdType const** outputIdsPtr, SizeType32 const* sequenceLengths,
+    SizeType32 const* batchSlots)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = batchSlots == nullptr ? batchIdx : batchSlots[batchIdx];
+    if (!hasOccurrencePenalty(batchSlot, repetitionPenalties, presencePenalties, frequencyPenalties))
+    {
+        return;
+    }
+
+    auto const sequenceLength = sequenceLengths[batchSlot];
+    auto const countedLength = penaltyCountedLengths[batchSlot];
+    penaltyWorkspace += static_cast<std::size_t>(batchSlot) * vocabSize;
+    auto startStep = countedLength;
+    // New request or sequence rewound, count all tokens again
+    if (countedLength < 0 || countedLength > sequenceLength)
+    {
+        for (auto index = static_cast<SizeType32>(threadIdx.x); index < vocabSize;
+             index += static_cast<SizeType32>(blockDim.x))
+        {
+            penaltyWorkspace[index] = 0;
+        }
+        __syncthreads();
+        startStep = 0;
+    }
+    for (auto step = startStep + static_cast<SizeType32>(threadIdx.x); step < sequenceLength;
+         step += static_cast<SizeType32>(blockDim.x))
+    {
+        auto penaltyIndex = outputIdsPtr[batchSlot][step];
+        if (0 <= penaltyIndex && penaltyIndex < vocabSize)
+        {
+            atomicAdd(&penaltyWorkspace[penaltyIndex], 1);
+        }
+    }
+    if (threadIdx.x == 0)
+    {
+        penaltyCountedLengths[batchSlot] = sequenceLength;
+    }
+}
+
+__global__ void resetPenaltyCountedLengths(
+    SizeType32* penaltyCountedLengths, SizeType32 const* batchSlots, SizeType32 batchSize)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x);
+    if (batchIdx < batchSize)
+    {
+        penaltyCountedLengths[batchSlots != nullptr ? batchSlots[batchIdx] : batchIdx] = -1;
+    }
+}
+
 template <typename T>
 __global__ void batchApplyPenalty(T const* const* inputLogits, T* outputLogits, T const* biases,
     TokenIdType* penaltyWorkspace, TokenIdType const* penaltyWorkspacePrev, float const* temperatures,
@@ -43,7 +117,7 @@ __global__ void batchApplyPenalty(T const* const* inputLogits, T* outputLogits,
     SizeType32 maxSeqLen, SizeType32 vocabSize, SizeType32 vocabSizePadded, TokenIdType const** outputIdsPtr,
     SizeType32 const** parentIdsPtr, SizeType32 const* inputLengths, SizeType32 const* sequenceLengths,
     SizeType32 const* minLengths, TokenIdType const* endIds, SizeType32 const* batchSlots,
-    SizeType32 const* tokensPerStep)
+    SizeType32 const* tokensPerStep, bool slotPenaltyWorkspace)
 {
     auto const beamWidth = static_cast<SizeType32>(gridDim.y);
     auto const maxTokensPerStep = static_cast<SizeType32>(gridDim.z);
@@ -99,7 +173,12 @@ __global__ void batchApplyPenalty(T const* const* inputLogits, T* outputLogits,
     }
 
     // Initialize or update the number of occurrences of tokens
-    if (accumulateVocab)
+    if (accumulateVocab && slotPenaltyWorkspace)
+    {
+        // Counted by updatePenaltyWorkspace
+        penaltyWorkspace += batchSlot * vocabSize;
+    }
+    else if (accumulateVocab)
     {
         penaltyWorkspace += batchBeamStepIdx * vocabSize;
         if (currentStep <= inputLen)
@@ -211,17 +290,38 @@ void invokeBatchApplyPenalty(InvokeBatchApplyPenaltyParams<T> const& params)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
     dim3 block(512);
+    bool const slotPenaltyWorkspace = params.penaltyCountedLengths != nullptr
+        && (params.repetitionPenalties != nullptr || params.presencePenalties != nullptr
+            || params.frequencyPenalties != nullptr);
+    if (slotPenaltyWorkspace)
+    {
+        TLLM_CHECK_WITH_INFO(params.beamWidth == 1, "Slot indexed penalty workspace does not support beam search.");
+        TLLM_CHECK(params.sequenceLengths != nullptr);
+        updatePenaltyWorkspace<<<params.batchSize, block, 0, params.stream>>>(params.penaltyWorkspace,
+            params.penaltyCountedLengths, params.repetitionPenalties, params.presencePenalties,
+            params.frequencyPenalties, params.vocabSize, params.outputIdsPtr, params.sequenceLengths,
+            params.batchSlots);
+    }
     dim3 grid(params.batchSize, params.beamWidth, params.maxTokensPerStep);
     batchApplyPenalty<T><<<grid, block, 0, params.stream>>>(params.inputLogits, params.outputLogits, params.biases,
         params.penaltyWorkspace, params.penaltyWorkspacePrev, params.temperatures, params.repetitionPenalties,
         params.presencePenalties, params.frequencyPenalties, params.maxSeqLen, params.vocabSize, params.vocabSizePadded,
         params.outputIdsPtr, params.parentIdsPtr, params.inputLengths, params.sequenceLengths, params.minLengths,
-        params.endIds, params.batchSlots, params.tokensPerStep);
+        params.endIds, params.batchSlots, params.tokensPerStep, slotPenaltyWorkspace);
 }
 
 template void invokeBatchApplyPenalty(InvokeBatchApplyPenaltyParams<float> const& params);
 
 template void invokeBatchApplyPenalty(InvokeBatchApplyPenaltyParams<half> const& params);
 
+void invokeResetPenaltyCountedLengths(
+    SizeType32* penaltyCountedLengths, SizeType32 const* batchSlots, SizeType32 batchSize, cudaStream_t stream)
+{
+    constexpr SizeType32 blockSize{256};
+    dim3 const grid((batchSize + blockSize - 1) / blockSize);
+    resetPenaltyCountedLengths<<<grid, blockSize, 0, stream>>>(penaltyCountedLengths, batchSlots, batchSize);
+    sync_check_cuda_error();
+}
+
 } // namespace kernels
 } // namespace tensorrt_llm
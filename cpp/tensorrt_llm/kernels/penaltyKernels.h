@@ -53,10 +53,22 @@ struct InvokeBatchApplyPenaltyParams
     runtime::SizeType32 maxTokensPerStep;
     runtime::SizeType32 const* tokensPerStep;
     cudaStream_t stream;
+    //! input/output buffer [maxBatchSize], optional, beamWidth == 1 only. Sequence length up to which the
+    //! occurrences of each batch slot are counted, -1 to count them again. If set, penaltyWorkspace is
+    //! [maxBatchSize, vocabSize] indexed by batch slot and updated only with the tokens appended since the last call,
+    //! so that it stays valid when requests join or leave the batch. sequenceLengths is required.
+    runtime::SizeType32* penaltyCountedLengths{nullptr};
 };
 
 template <typename T>
 void invokeBatchApplyPenalty(InvokeBatchApplyPenaltyParams<T> const& params);
 
+//! \brief Marks the occurrences of the given batch slots to be counted again from their output ids on the next
+//! invokeBatchApplyPenalty.
+//! \param penaltyCountedLengths [maxBatchSize]
+//! \param batchSlots [batchSize] on the GPU
+void invokeResetPenaltyCountedLengths(runtime::SizeType32* penaltyCountedLengths,
+    runtime::SizeType32 const* batchSlots, runtime::SizeType32 batchSize, cudaStream_t stream);
+
 } // namespace kernels
 } // namespace tensorrt_llm
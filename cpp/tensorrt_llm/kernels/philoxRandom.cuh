@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <curand_kernel.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+//! \brief Returns a uniformly distributed random number in (0.0; 1.0] from the counter-based Philox4x32-10
+//! generator keyed by the seed of the request. The number only depends on the seed and the step, i.e. the position
+//! of the sampled token in the sequence, so no state has to be kept between the steps and samples do not depend on
+//! the batch slot of the request or on the other requests of the batch.
+//!
+//! \param seed random seed of the request
+//! \param step position of the sampled token in the sequence
+__device__ __forceinline__ float getPhiloxUniform(uint64_t seed, uint64_t step)
+{
+    // Philox picks the subsequence and the offset by setting its counter, no skipahead is computed
+    curandStatePhilox4_32_10_t state;
+    curand_init(seed, step, 0, &state);
+    return curand_uniform(&state);
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -1,5 +1,7 @@
 #include "tensorrt_llm/kernels/preQuantScaleKernel.h"
 
+#include <algorithm>
+
 namespace tensorrt_llm
 {
 namespace kernels
@@ -116,6 +118,53 @@ void apply_per_channel_scale_kernel_launcher(
     }
 }
 
+template <typename T_in, typename T_out>
+__global__ void apply_per_token_scale(T_out* out, T_in const* act, float const* per_token_scale, int rows, int cols)
+{
+    int const row = blockIdx.y;
+    float const scale = per_token_scale[row];
+    for (int col = blockIdx.x * blockDim.x + threadIdx.x; col < cols; col += gridDim.x * blockDim.x)
+    {
+        size_t const idx = static_cast<size_t>(row) * cols + col;
+        out[idx] = static_cast<T_out>(static_cast<float>(act[idx]) * scale);
+    }
+}
+
+template <typename T>
+__global__ void apply_per_token_scale_and_bias(T* out, float const* per_token_scale, T const* bias, int rows, int cols)
+{
+    int const row = blockIdx.y;
+    float const scale = per_token_scale[row];
+    for (int col = blockIdx.x * blockDim.x + threadIdx.x; col < cols; col += gridDim.x * blockDim.x)
+    {
+        size_t const idx = static_cast<size_t>(row) * cols + col;
+        float val = static_cast<float>(out[idx]) * scale;
+        if (bias != nullptr)
+        {
+            val += static_cast<float>(bias[col]);
+        }
+        out[idx] = static_cast<T>(val);
+    }
+}
+
+template <typename T_in, typename T_out>
+void apply_per_token_scale_kernel_launcher(
+    T_out* out, T_in const* act, float const* per_token_scale, int rows, int cols, cudaStream_t stream)
+{
+    dim3 block(128);
+    dim3 grid(std::min((cols + block.x - 1) / block.x, 32u), rows);
+    apply_per_token_scale<T_in, T_out><<<grid, block, 0, stream>>>(out, act, per_token_scale, rows, cols);
+}
+
+template <typename T>
+void apply_per_token_scale_and_bias_kernel_launcher(
+    T* out, float const* per_token_scale, T const* bias, int rows, int cols, cudaStream_t stream)
+{
+    dim3 block(128);
+    dim3 grid(std::min((cols + block.x - 1) / block.x, 32u), rows);
+    apply_per_token_scale_and_bias<T><<<grid, block, 0, stream>>>(out, per_token_scale, bias, rows, cols);
+}
+
 #define INSTANTIATE_PREQUANT_SCALE(T_in, T_out)                                                                        \
     template void apply_per_channel_scale_kernel_launcher<T_in, T_out>(                                                \
         T_out * smoothed_act, const T_in* act, const T_in* per_channel_scale, int rows, int cols, cudaStream_t stream)
@@ -132,5 +181,25 @@ INSTANTIATE_PREQUANT_SCALE(__nv_bfloat16, __nv_fp8_e4m3);
 #endif
 #endif
 
+#define INSTANTIATE_PER_TOKEN_SCALE(T_in, T_out)                                                                       \
+    template void apply_per_token_scale_kernel_launcher<T_in, T_out>(                                                  \
+        T_out * out, const T_in* act, const float* per_token_scale, int rows, int cols, cudaStream_t stream)
+
+#define INSTANTIATE_PER_TOKEN_SCALE_AND_BIAS(T)                                                                        \
+    template void apply_per_token_scale_and_bias_kernel_launcher<T>(                                                   \
+        T * out, const float* per_token_scale, const T* bias, int rows, int cols, cudaStream_t stream)
+
+INSTANTIATE_PER_TOKEN_SCALE_AND_BIAS(half);
+#if defined(ENABLE_FP8)
+INSTANTIATE_PER_TOKEN_SCALE(__nv_fp8_e4m3, half);
+#endif
+
+#if defined(ENABLE_BF16)
+INSTANTIATE_PER_TOKEN_SCALE_AND_BIAS(__nv_bfloat16);
+#if defined(ENABLE_FP8)
+INSTANTIATE_PER_TOKEN_SCALE(__nv_fp8_e4m3, __nv_bfloat16);
+#endif
+#endif
+
 } // namespace kernels
 } // namespace tensorrt_llm
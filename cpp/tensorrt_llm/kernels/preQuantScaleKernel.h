@@ -37,5 +37,16 @@ template <typename T_in, typename T_out = T_in>
 void apply_per_channel_scale_kernel_launcher(
     T_out* smoothed_act, T_in const* act, T_in const* per_channel_scale, int rows, int cols, cudaStream_t stream = 0);
 
+// Dequantizes activations quantized per token (row), out[i][j] = act[i][j] * per_token_scale[i].
+template <typename T_in, typename T_out>
+void apply_per_token_scale_kernel_launcher(
+    T_out* out, T_in const* act, float const* per_token_scale, int rows, int cols, cudaStream_t stream = 0);
+
+// Scales the rows of a GEMM output computed from per-token quantized activations, then adds the optional bias [cols].
+// In place, out[i][j] = out[i][j] * per_token_scale[i] + bias[j].
+template <typename T>
+void apply_per_token_scale_and_bias_kernel_launcher(
+    T* out, float const* per_token_scale, T const* bias, int rows, int cols, cudaStream_t stream = 0);
+
 } // namespace kernels
 } // namespace tensorrt_llm
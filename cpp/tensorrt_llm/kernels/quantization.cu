@@ -171,5 +171,106 @@ INSTANTIATE_INVOKE_PER_TOKEN_QUANTIZATION(half);
 INSTANTIATE_INVOKE_PER_TOKEN_QUANTIZATION(__nv_bfloat16);
 #endif
 
+#ifdef ENABLE_FP8
+// One warp per group of groupSize channels of a token.
+template <typename T>
+__global__ void fp8PerTokenGroupQuantization(
+    __nv_fp8_e4m3* dst, T const* src, const int64_t numGroups, int groupSize, float* scalePtr)
+{
+    int64_t const group = (static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x) / 32;
+    int const lane = threadIdx.x % 32;
+    if (group >= numGroups)
+    {
+        return;
+    }
+    T const* srcGroup = src + group * groupSize;
+    __nv_fp8_e4m3* dstGroup = dst + group * groupSize;
+
+    float localMax = 1e-6f;
+    for (int i = lane; i < groupSize; i += 32)
+    {
+        localMax = fmaxf(localMax, fabsf(cuda_cast<float>(srcGroup[i])));
+    }
+    float const groupMax = warpReduceMax(localMax);
+
+    if (lane == 0)
+    {
+        scalePtr[group] = groupMax / FP8_E4M3_MAX;
+    }
+
+    float const scaleOrigQuant = FP8_E4M3_MAX / groupMax;
+    for (int i = lane; i < groupSize; i += 32)
+    {
+        dstGroup[i] = cuda_cast<__nv_fp8_e4m3>(cuda_cast<float>(srcGroup[i]) * scaleOrigQuant);
+    }
+}
+
+template <typename T>
+void invokeFp8PerTokenGroupQuantization(__nv_fp8_e4m3* dst, T const* src, const int64_t numRows,
+    const int64_t numCols, float* scalePtr, int groupSize, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(numCols % groupSize == 0, "numCols (%ld) must be a multiple of groupSize (%d).", numCols,
+        groupSize);
+    // Groups are contiguous, and numbered like the [numRows, numCols / groupSize] scales
+    int64_t const numGroups = numRows * (numCols / groupSize);
+    const dim3 block(256);
+    const dim3 grid((numGroups * 32 + block.x - 1) / block.x);
+
+    fp8PerTokenGroupQuantization<<<grid, block, 0, stream>>>(dst, src, numGroups, groupSize, scalePtr);
+}
+
+// One block per blockSize x blockSize block of the weight.
+template <typename T>
+__global__ void fp8BlockQuantization(
+    __nv_fp8_e4m3* dst, T const* src, const int64_t numRows, const int64_t numCols, int blockSize, float* scalePtr)
+{
+    int64_t const rowBegin = static_cast<int64_t>(blockIdx.y) * blockSize;
+    int64_t const colBegin = static_cast<int64_t>(blockIdx.x) * blockSize;
+    int const rows = static_cast<int>(min(static_cast<int64_t>(blockSize), numRows - rowBegin));
+    int const cols = static_cast<int>(min(static_cast<int64_t>(blockSize), numCols - colBegin));
+
+    float localMax = 1e-6f;
+    for (int i = threadIdx.x; i < rows * cols; i += blockDim.x)
+    {
+        localMax = fmaxf(localMax, fabsf(cuda_cast<float>(src[(rowBegin + i / cols) * numCols + colBegin + i % cols])));
+    }
+    float const blockMax = blockAllReduceMax(localMax);
+
+    if (threadIdx.x == 0)
+    {
+        scalePtr[blockIdx.y * gridDim.x + blockIdx.x] = blockMax / FP8_E4M3_MAX;
+    }
+
+    float const scaleOrigQuant = FP8_E4M3_MAX / blockMax;
+    for (int i = threadIdx.x; i < rows * cols; i += blockDim.x)
+    {
+        int64_t const idx = (rowBegin + i / cols) * numCols + colBegin + i % cols;
+        dst[idx] = cuda_cast<__nv_fp8_e4m3>(cuda_cast<float>(src[idx]) * scaleOrigQuant);
+    }
+}
+
+template <typename T>
+void invokeFp8BlockQuantization(__nv_fp8_e4m3* dst, T const* src, const int64_t numRows, const int64_t numCols,
+    float* scalePtr, int blockSize, cudaStream_t stream)
+{
+    const dim3 block(256);
+    const dim3 grid((numCols + blockSize - 1) / blockSize, (numRows + blockSize - 1) / blockSize);
+
+    fp8BlockQuantization<<<grid, block, 0, stream>>>(dst, src, numRows, numCols, blockSize, scalePtr);
+}
+
+#define INSTANTIATE_INVOKE_FP8_BLOCK_QUANTIZATION(T)                                                                   \
+    template void invokeFp8PerTokenGroupQuantization(__nv_fp8_e4m3* dst, const T* src, const int64_t numRows,         \
+        const int64_t numCols, float* scalePtr, int groupSize, cudaStream_t stream);                                   \
+    template void invokeFp8BlockQuantization(__nv_fp8_e4m3* dst, const T* src, const int64_t numRows,                 \
+        const int64_t numCols, float* scalePtr, int blockSize, cudaStream_t stream)
+
+INSTANTIATE_INVOKE_FP8_BLOCK_QUANTIZATION(float);
+INSTANTIATE_INVOKE_FP8_BLOCK_QUANTIZATION(half);
+#ifdef ENABLE_BF16
+INSTANTIATE_INVOKE_FP8_BLOCK_QUANTIZATION(__nv_bfloat16);
+#endif
+#endif // ENABLE_FP8
+
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -17,6 +17,9 @@
 
 #include <cuda_fp16.h>
 #include <cuda_runtime.h>
+#ifdef ENABLE_FP8
+#include <cuda_fp8.h>
+#endif
 
 namespace tensorrt_llm
 {
@@ -31,5 +34,20 @@ template <typename T>
 void invokePerTokenQuantization(
     int8_t* dst, T const* src, const int64_t numRows, const int64_t numCols, float* scalePtr, cudaStream_t stream = 0);
 
+#ifdef ENABLE_FP8
+// Quantizes activations to fp8 (e4m3) with one scale per token and group of groupSize channels, the activation
+// format of the block-scaled FP8 GEMM. numCols must be a multiple of groupSize, scalePtr is
+// [numRows, numCols / groupSize].
+template <typename T>
+void invokeFp8PerTokenGroupQuantization(__nv_fp8_e4m3* dst, T const* src, const int64_t numRows,
+    const int64_t numCols, float* scalePtr, int groupSize = 128, cudaStream_t stream = 0);
+
+// Quantizes a [numRows, numCols] weight to fp8 (e4m3) with one scale per blockSize x blockSize block, the weight
+// format of the block-scaled FP8 GEMM. scalePtr is [ceil(numRows / blockSize), ceil(numCols / blockSize)].
+template <typename T>
+void invokeFp8BlockQuantization(__nv_fp8_e4m3* dst, T const* src, const int64_t numRows, const int64_t numCols,
+    float* scalePtr, int blockSize = 128, cudaStream_t stream = 0);
+#endif
+
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+//! \brief Maps the relative positions of T5's relative attention to the buckets of the [head_num, num_buckets] bias
+//! table. Shared by the kernel building the [head_num, seq_len, seq_len] bias and by the attention kernels computing
+//! the bias on the fly from the table, so that both pick the same buckets.
+//!
+//! \details The terms that don't depend on the position, including the log of the bucketed range, are computed once
+//! per thread instead of for each query and key.
+class RelativeAttentionBucketizer
+{
+public:
+    //! \param bidirectional True for the encoder, whose keys after the query get buckets of their own. The decoder
+    //! maps those keys to the bucket of distance 0, as they're masked.
+    __device__ __forceinline__ RelativeAttentionBucketizer(int num_buckets, int max_distance, bool bidirectional)
+        : mBidirectional(bidirectional)
+        , mNumBuckets(bidirectional ? num_buckets / 2 : num_buckets)
+        , mMaxExact(mNumBuckets / 2)
+        , mLogMaxDistance(logf(static_cast<float>(max_distance) / mMaxExact))
+    {
+    }
+
+    //! \param relative_position The position of the key minus the position of the query.
+    __device__ __forceinline__ int operator()(int relative_position) const
+    {
+        int bucket = 0;
+        if (mBidirectional)
+        {
+            bucket += relative_position > 0 ? mNumBuckets : 0;
+            relative_position = abs(relative_position);
+        }
+        else
+        {
+            relative_position = relative_position > 0 ? 0 : -relative_position;
+        }
+        if (relative_position < mMaxExact)
+        {
+            return bucket + relative_position;
+        }
+        // Same order of operations as the reference, so that the positions on the edge of a bucket don't move
+        int const bucket_if_large = mMaxExact
+            + static_cast<int>(
+                logf(relative_position * 1.0f / mMaxExact) / mLogMaxDistance * (mNumBuckets - mMaxExact));
+        return bucket + min(bucket_if_large, mNumBuckets - 1);
+    }
+
+private:
+    bool mBidirectional;
+    //! Buckets of each direction
+    int mNumBuckets;
+    //! Distances below have a bucket each, the farther ones are bucketed logarithmically up to max_distance
+    int mMaxExact;
+    float mLogMaxDistance;
+};
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/ringAttentionKernels.h"
+
+#include <algorithm>
+#include <cfloat>
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+// Number of (query, head) rows attended by one block.
+constexpr int kRowsPerBlock = 8;
+// Number of KV tokens loaded into shared memory at once.
+constexpr int kTokensPerTile = 8;
+constexpr int kThreadsPerBlock = 128;
+constexpr int kMaxHeadSize = 256;
+
+__global__ void ringAttentionInitKernel(float* accOut, float* accLse, size_t numRows, int headSize)
+{
+    size_t const numElems = numRows * headSize;
+    for (size_t i = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < numElems;
+         i += static_cast<size_t>(gridDim.x) * blockDim.x)
+    {
+        accOut[i] = 0.f;
+        if (i < numRows)
+        {
+            accLse[i] = -INFINITY;
+        }
+    }
+}
+
+// Attention of the rows of a block over the KV share of the step, with the softmax computed online over the tiles of
+// the share, merged into the accumulators of the rows. One block per KV head and tile of rows, each row is a query
+// with a Q head of the KV head.
+template <typename T>
+__global__ void ringAttentionStepKernel(RingAttentionStepParams<T> params)
+{
+    extern __shared__ float smem[];
+    int const headSize = params.head_size;
+    float* sQ = smem;                              // [kRowsPerBlock, headSize]
+    float* sAcc = sQ + kRowsPerBlock * headSize;   // [kRowsPerBlock, headSize]
+    float* sK = sAcc + kRowsPerBlock * headSize;   // [kTokensPerTile, headSize]
+    float* sV = sK + kTokensPerTile * headSize;    // [kTokensPerTile, headSize]
+    float* sP = sV + kTokensPerTile * headSize;    // [kRowsPerBlock, kTokensPerTile]
+    float* sMax = sP + kRowsPerBlock * kTokensPerTile;
+    float* sSum = sMax + kRowsPerBlock;
+    float* sScale = sSum + kRowsPerBlock;
+    int* sPositions = reinterpret_cast<int*>(sScale + kRowsPerBlock);
+
+    int const headsPerKvHead = params.num_heads / params.num_kv_heads;
+    int const kvHead = blockIdx.y;
+    int const rowBegin = blockIdx.x * kRowsPerBlock;
+    int const numRows = min(kRowsPerBlock, params.num_q_tokens * headsPerKvHead - rowBegin);
+    if (numRows <= 0)
+    {
+        return;
+    }
+
+    auto const rowOffset = [&](int r)
+    {
+        int const row = rowBegin + r;
+        int const head = kvHead * headsPerKvHead + row % headsPerKvHead;
+        return static_cast<size_t>(row / headsPerKvHead) * params.num_heads + head;
+    };
+
+    for (int i = threadIdx.x; i < kRowsPerBlock * headSize; i += blockDim.x)
+    {
+        int const r = i / headSize;
+        sQ[i] = r < numRows ? cuda_cast<float>(params.q[rowOffset(r) * headSize + i % headSize]) * params.qk_scale
+                            : 0.f;
+        sAcc[i] = 0.f;
+    }
+    if (threadIdx.x < kRowsPerBlock)
+    {
+        int const r = threadIdx.x;
+        sMax[r] = -FLT_MAX;
+        sSum[r] = 0.f;
+        sPositions[r] = r < numRows ? params.q_positions[(rowBegin + r) / headsPerKvHead] : 0;
+    }
+    __syncthreads();
+
+    for (int tileBegin = 0; tileBegin < params.num_kv_tokens; tileBegin += kTokensPerTile)
+    {
+        int const numTokens = min(kTokensPerTile, params.num_kv_tokens - tileBegin);
+        for (int i = threadIdx.x; i < kTokensPerTile * headSize; i += blockDim.x)
+        {
+            int const t = i / headSize;
+            float k = 0.f;
+            float v = 0.f;
+            if (t < numTokens)
+            {
+                size_t const idx
+                    = (static_cast<size_t>(tileBegin + t) * params.num_kv_heads + kvHead) * headSize + i % headSize;
+                k = cuda_cast<float>(params.k[idx]);
+                v = cuda_cast<float>(params.v[idx]);
+            }
+            sK[i] = k;
+            sV[i] = v;
+        }
+        if (threadIdx.x < kTokensPerTile)
+        {
+            int const t = threadIdx.x;
+            sPositions[kRowsPerBlock + t] = t < numTokens ? params.kv_positions[tileBegin + t] : 0;
+        }
+        __syncthreads();
+
+        // Masked scores are -inf and get no weight
+        for (int i = threadIdx.x; i < kRowsPerBlock * kTokensPerTile; i += blockDim.x)
+        {
+            int const r = i / kTokensPerTile;
+            int const t = i % kTokensPerTile;
+            float qk = -INFINITY;
+            if (r < numRows && t < numTokens && (!params.causal || sPositions[kRowsPerBlock + t] <= sPositions[r]))
+            {
+                qk = 0.f;
+                for (int d = 0; d < headSize; ++d)
+                {
+                    qk += sQ[r * headSize + d] * sK[t * headSize + d];
+                }
+            }
+            sP[i] = qk;
+        }
+        __syncthreads();
+
+        if (threadIdx.x < kRowsPerBlock)
+        {
+            int const r = threadIdx.x;
+            float tileMax = sMax[r];
+            for (int t = 0; t < numTokens; ++t)
+            {
+                tileMax = fmaxf(tileMax, sP[r * kTokensPerTile + t]);
+            }
+            float const scale = __expf(sMax[r] - tileMax);
+            float sum = sSum[r] * scale;
+            for (int t = 0; t < kTokensPerTile; ++t)
+            {
+                float const s = sP[r * kTokensPerTile + t];
+                float const p = s == -INFINITY ? 0.f : __expf(s - tileMax);
+                sP[r * kTokensPerTile + t] = p;
+                sum += p;
+            }
+            sMax[r] = tileMax;
+            sSum[r] = sum;
+            sScale[r] = scale;
+        }
+        __syncthreads();
+
+        for (int i = threadIdx.x; i < kRowsPerBlock * headSize; i += blockDim.x)
+        {
+            int const r = i / headSize;
+            int const d = i % headSize;
+            float acc = sAcc[i] * sScale[r];
+            for (int t = 0; t < numTokens; ++t)
+            {
+                acc += sP[r * kTokensPerTile + t] * sV[t * headSize + d];
+            }
+            sAcc[i] = acc;
+        }
+        __syncthreads();
+    }
+
+    // Merges the attention over the share with the accumulated one, each row is merged by a single block. sMax and
+    // sScale take the weights of the accumulated and of the new output.
+    if (threadIdx.x < numRows)
+    {
+        int const r = threadIdx.x;
+        auto const row = rowOffset(r);
+        float const lseAcc = params.acc_lse[row];
+        float const lseStep = sSum[r] > 0.f ? sMax[r] + __logf(sSum[r]) : -INFINITY;
+        float const maxLse = fmaxf(lseAcc, lseStep);
+        float const wAcc = lseAcc == -INFINITY ? 0.f : __expf(lseAcc - maxLse);
+        float const wStep = lseStep == -INFINITY ? 0.f : __expf(lseStep - maxLse);
+        float const norm = wAcc + wStep;
+        sMax[r] = norm > 0.f ? wAcc / norm : 0.f;
+        sScale[r] = wStep > 0.f ? wStep / norm / sSum[r] : 0.f;
+        params.acc_lse[row] = norm > 0.f ? maxLse + __logf(norm) : -INFINITY;
+    }
+    __syncthreads();
+
+    for (int i = threadIdx.x; i < numRows * headSize; i += blockDim.x)
+    {
+        int const r = i / headSize;
+        auto const idx = rowOffset(r) * headSize + i % headSize;
+        params.acc_out[idx] = params.acc_out[idx] * sMax[r] + sAcc[i] * sScale[r];
+    }
+}
+
+template <typename T>
+__global__ void ringAttentionFinalizeKernel(T* out, float const* accOut, size_t numElems)
+{
+    for (size_t i = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < numElems;
+         i += static_cast<size_t>(gridDim.x) * blockDim.x)
+    {
+        out[i] = cuda_cast<T>(accOut[i]);
+    }
+}
+
+int getNumElementwiseBlocks(size_t numElems)
+{
+    return static_cast<int>(std::min<size_t>(divUp(numElems, static_cast<size_t>(kThreadsPerBlock)), 65536));
+}
+} // namespace
+
+void invokeRingAttentionInit(
+    float* accOut, float* accLse, int numQTokens, int numHeads, int headSize, cudaStream_t stream)
+{
+    auto const numRows = static_cast<size_t>(numQTokens) * numHeads;
+    if (numRows == 0)
+    {
+        return;
+    }
+    ringAttentionInitKernel<<<getNumElementwiseBlocks(numRows * headSize), kThreadsPerBlock, 0, stream>>>(
+        accOut, accLse, numRows, headSize);
+    sync_check_cuda_error();
+}
+
+template <typename T>
+void invokeRingAttentionStep(RingAttentionStepParams<T> const& params, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(params.num_heads % params.num_kv_heads == 0,
+        "num_heads (%d) must be a multiple of num_kv_heads (%d).", params.num_heads, params.num_kv_heads);
+    TLLM_CHECK_WITH_INFO(params.head_size <= kMaxHeadSize, "Ring attention supports head sizes up to %d, got %d.",
+        kMaxHeadSize, params.head_size);
+    if (params.num_q_tokens == 0 || params.num_kv_tokens == 0)
+    {
+        return;
+    }
+
+    int const headsPerKvHead = params.num_heads / params.num_kv_heads;
+    size_t const smemSize = sizeof(float)
+            * (2 * (kRowsPerBlock + kTokensPerTile) * params.head_size + kRowsPerBlock * kTokensPerTile
+                + 3 * kRowsPerBlock)
+        + sizeof(int) * (kRowsPerBlock + kTokensPerTile);
+
+    dim3 const grid(divUp(params.num_q_tokens * headsPerKvHead, kRowsPerBlock), params.num_kv_heads);
+    ringAttentionStepKernel<T><<<grid, kThreadsPerBlock, smemSize, stream>>>(params);
+    sync_check_cuda_error();
+}
+
+template <typename T>
+void invokeRingAttentionFinalize(T* out, float const* accOut, size_t numElems, cudaStream_t stream)
+{
+    if (numElems == 0)
+    {
+        return;
+    }
+    ringAttentionFinalizeKernel<T><<<getNumElementwiseBlocks(numElems), kThreadsPerBlock, 0, stream>>>(
+        out, accOut, numElems);
+    sync_check_cuda_error();
+}
+
+template void invokeRingAttentionStep<float>(RingAttentionStepParams<float> const& params, cudaStream_t stream);
+template void invokeRingAttentionStep<half>(RingAttentionStepParams<half> const& params, cudaStream_t stream);
+template void invokeRingAttentionFinalize<float>(
+    float* out, float const* accOut, size_t numElems, cudaStream_t stream);
+template void invokeRingAttentionFinalize<half>(half* out, float const* accOut, size_t numElems, cudaStream_t stream);
+#ifdef ENABLE_BF16
+template void invokeRingAttentionStep<__nv_bfloat16>(
+    RingAttentionStepParams<__nv_bfloat16> const& params, cudaStream_t stream);
+template void invokeRingAttentionFinalize<__nv_bfloat16>(
+    __nv_bfloat16* out, float const* accOut, size_t numElems, cudaStream_t stream);
+#endif
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cuda_runtime_api.h>
+
+#include <cstddef>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+// Context parallel (ring) attention for the prefill of very long prompts. The prompt is split across the CP ranks,
+// each rank holds the queries and the KV of its share of the tokens. The KV shares travel around the ring of ranks,
+// and at every step a rank attends its queries over the share it holds at that step. The partial result of a step is
+// merged online into running accumulators with its log-sum-exp, so no rank ever holds the KV of the whole prompt and
+// the result is the attention over all the tokens. Masking is causal by the absolute positions of the tokens, so the
+// shares don't need to be contiguous.
+template <typename T>
+struct RingAttentionStepParams
+{
+    // [num_q_tokens, num_heads, head_size], with the rotary embedding already applied.
+    T const* q;
+    // [num_q_tokens], the positions of the queries in the prompt.
+    int const* q_positions;
+    // [num_kv_tokens, num_kv_heads, head_size], the K and V of the share held at this step.
+    T const* k;
+    T const* v;
+    // [num_kv_tokens], the positions of the KV tokens in the prompt.
+    int const* kv_positions;
+    // [num_q_tokens, num_heads, head_size], the normalized output accumulated over the previous steps.
+    float* acc_out;
+    // [num_q_tokens, num_heads], the log-sum-exp accumulated over the previous steps, -inf before the first one.
+    float* acc_lse;
+    int num_q_tokens;
+    int num_kv_tokens;
+    int num_heads;
+    int num_kv_heads;
+    int head_size;
+    float qk_scale;
+    // Queries only attend the KV tokens at their position or before.
+    bool causal{true};
+};
+
+// Resets the accumulators before the first step.
+void invokeRingAttentionInit(float* accOut, float* accLse, int numQTokens, int numHeads, int headSize,
+    cudaStream_t stream);
+
+// Attends the queries over the KV share of the step and merges the result into the accumulators.
+template <typename T>
+void invokeRingAttentionStep(RingAttentionStepParams<T> const& params, cudaStream_t stream);
+
+// Writes the accumulated output, [numElems] elements, in the type of the attention.
+template <typename T>
+void invokeRingAttentionFinalize(T* out, float const* accOut, size_t numElems, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -25,6 +25,19 @@ namespace tensorrt_llm
 namespace kernels
 {
 
+// Largest magnitude of the quantized output, the per-token scale maps the amax of a row to it.
+template <typename QuantT>
+__inline__ __device__ constexpr float quant_type_max()
+{
+#ifdef ENABLE_FP8
+    if constexpr (std::is_same_v<QuantT, __nv_fp8_e4m3>)
+    {
+        return FP8_E4M3_MAX;
+    }
+#endif
+    return 127.f;
+}
+
 template <typename Tf, typename T>
 __inline__ __device__ Tf compute_rmsnorm(Tf val, float s_variance, T const* gamma, T const* beta, int i)
 {
@@ -36,31 +49,42 @@ __inline__ __device__ Tf compute_rmsnorm(Tf val, float s_variance, T const* gamm
     return ret;
 }
 
+// VEC packed elements of T, loaded and stored with a single instruction of up to 128 bits.
+template <typename T, int VEC>
+struct alignas(sizeof(T) * VEC) NormVec
+{
+    T data[VEC];
+};
+
 /* Computes the rmsnorm https://pytorch.org/docs/stable/generated/torch.nn.rmsnorm.html
  * normed_output <- ( input / Sqrt(E[input²] + eps) ) * gamma + beta
  * input is [tokens, hidden_dim]. Mean and Variance are per-row (i.e. per-token)
  *
- * One CTA handles one row.
+ * One CTA handles one row. Every thread loads and stores VEC packed elements at once.
  *
  *
  * use_shmem controls if we cache input values into shared memory
  *
  * Optional: with dynamic scaling, the last pass doesn't write immediately but finds the
- *           amax per row. A final pass scales to int8 accordingly, and writes output to
+ *           amax per row. A final pass scales to int8 or fp8 (e4m3) accordingly, and writes output to
  *           normed_output_quant.
+ *
+ * Optional: with residual, the norm is applied to input + residual, and the sum is written to residual_out
+ *           (which may alias residual) as the residual of the next layer.
  */
-template <typename T>
+template <typename T, typename QuantT, int VEC>
 __global__ void generalRmsNorm(T const* input, T const* gamma, T const* beta, T* normed_output, float const eps,
     int tokens, int hidden_dim, float const* scale_orig_quant_per_tensor, float* scale_orig_quant_per_token,
-    int8_t* normed_output_quant, bool use_shmem)
+    QuantT* normed_output_quant, T const* residual, T* residual_out, bool use_shmem)
 {
     constexpr auto num_elems_T = num_elems<T>::value;
-    using int8_packed_t = typename packed_as<int8_t, num_elems_T>::type;
+    using quant_packed_t = typename packed_as<QuantT, num_elems_T>::type;
     using float_packed_t = typename packed_as<float, num_elems_T>::type;
     using T_scalar = typename packed_as<T, 1>::type;
+    using Vec = NormVec<T, VEC>;
 
-    extern __shared__ __align__(sizeof(float)) char _shmem[];
-    T* shmem = reinterpret_cast<T*>(_shmem);
+    extern __shared__ __align__(16) char _shmem[];
+    Vec* shmem = reinterpret_cast<Vec*>(_shmem);
 
     __shared__ float s_variance;
 
@@ -71,17 +95,36 @@ __global__ void generalRmsNorm(T const* input, T const* gamma, T const* beta, T*
     float local_var_sum = 0.0f;
 
     int const n_elems = hidden_dim / num_elems_T;
-    for (int i = tidx; i < n_elems; i += blockDim.x)
+    int const n_vecs = n_elems / VEC;
+    auto const* input_row = reinterpret_cast<Vec const*>(input + bidx * n_elems);
+    auto* residual_out_row = residual != nullptr ? reinterpret_cast<Vec*>(residual_out + bidx * n_elems) : nullptr;
+    // Each thread reads back only the elements it wrote, so the later passes need no synchronization
+    Vec const* src = residual != nullptr ? residual_out_row : input_row;
+    for (int i = tidx; i < n_vecs; i += blockDim.x)
     {
-        const T val = input[bidx * n_elems + i];
+        Vec val = input_row[i];
+        if (residual != nullptr)
+        {
+            Vec const res = reinterpret_cast<Vec const*>(residual + bidx * n_elems)[i];
+#pragma unroll
+            for (int j = 0; j < VEC; ++j)
+            {
+                val.data[j] = cuda_cast<T>(
+                    cuda_cast<float_packed_t>(val.data[j]) + cuda_cast<float_packed_t>(res.data[j]));
+            }
+            residual_out_row[i] = val;
+        }
         if (use_shmem)
         {
             shmem[i] = val;
         }
 
-        const float_packed_t val_f = cuda_cast<float_packed_t>(val);
-
-        local_var_sum += cuda_sum<float>(val_f * val_f);
+#pragma unroll
+        for (int j = 0; j < VEC; ++j)
+        {
+            const float_packed_t val_f = cuda_cast<float_packed_t>(val.data[j]);
+            local_var_sum += cuda_sum<float>(val_f * val_f);
+        }
     }
 
     float packed[1] = {local_var_sum};
@@ -100,83 +143,117 @@ __global__ void generalRmsNorm(T const* input, T const* gamma, T const* beta, T*
     const float_packed_t scale_orig_quant
         = cuda_cast<float_packed_t>(with_per_tensor_scaling ? *scale_orig_quant_per_tensor : 0.0f);
     T_scalar amax = 1e-6f;
+    auto* quant_row = reinterpret_cast<quant_packed_t*>(normed_output_quant) + bidx * n_elems;
 
-    for (int i = tidx; i < n_elems; i += blockDim.x)
+    for (int i = tidx; i < n_vecs; i += blockDim.x)
     {
-        int const index = bidx * n_elems + i;
-        const float_packed_t val_f = cuda_cast<float_packed_t>(use_shmem ? shmem[i] : input[index]);
-        const T val = cuda_cast<T>(compute_rmsnorm(val_f, s_variance, gamma, beta, i));
+        Vec const in = use_shmem ? shmem[i] : src[i];
+        Vec out;
+#pragma unroll
+        for (int j = 0; j < VEC; ++j)
+        {
+            int const elem = i * VEC + j;
+            out.data[j] = cuda_cast<T>(
+                compute_rmsnorm(cuda_cast<float_packed_t>(in.data[j]), s_variance, gamma, beta, elem));
+            if (with_per_token_scaling)
+            {
+                amax = cuda_max(cuda_max<T_scalar, T>(cuda_abs(out.data[j])), amax);
+            }
+            else if (with_per_tensor_scaling)
+            {
+                quant_row[elem] = cuda_cast<quant_packed_t>(cuda_cast<float_packed_t>(out.data[j]) * scale_orig_quant);
+            }
+        }
 
         if (with_per_token_scaling)
         {
-            amax = cuda_max(cuda_max<T_scalar, T>(cuda_abs(val)), amax);
             if (use_shmem)
             {
-                shmem[i] = val;
+                shmem[i] = out;
             }
         }
-        else if (with_per_tensor_scaling)
+        else if (!with_per_tensor_scaling)
         {
-            reinterpret_cast<int8_packed_t*>(normed_output_quant)[index]
-                = cuda_cast<int8_packed_t>(cuda_cast<float_packed_t>(val) * scale_orig_quant);
-        }
-        else
-        {
-            normed_output[index] = val;
+            reinterpret_cast<Vec*>(normed_output + bidx * n_elems)[i] = out;
         }
     }
 
     if (with_per_token_scaling)
     {
         float abs_max_f = blockAllReduceMax(cuda_cast<float>(amax));
-        float const dynamic_per_token_scale = 127.f / abs_max_f;
-        for (int i = tidx; i < n_elems; i += blockDim.x)
+        float const dynamic_per_token_scale = quant_type_max<QuantT>() / abs_max_f;
+        for (int i = tidx; i < n_vecs; i += blockDim.x)
         {
-            int const index = bidx * n_elems + i;
-            float_packed_t val_f = cuda_cast<float_packed_t>(use_shmem ? shmem[i] : input[index]);
-            if (!use_shmem)
+            Vec const in = use_shmem ? shmem[i] : src[i];
+#pragma unroll
+            for (int j = 0; j < VEC; ++j)
             {
-                val_f = compute_rmsnorm(val_f, s_variance, gamma, beta, i);
+                int const elem = i * VEC + j;
+                float_packed_t val_f = cuda_cast<float_packed_t>(in.data[j]);
+                if (!use_shmem)
+                {
+                    val_f = compute_rmsnorm(val_f, s_variance, gamma, beta, elem);
+                }
+                quant_row[elem] = cuda_cast<quant_packed_t>(val_f * cuda_cast<float_packed_t>(dynamic_per_token_scale));
             }
-
-            reinterpret_cast<int8_packed_t*>(normed_output_quant)[index]
-                = cuda_cast<int8_packed_t>(val_f * cuda_cast<float_packed_t>(dynamic_per_token_scale));
         }
         if (tidx == 0)
         {
-            scale_orig_quant_per_token[bidx] = abs_max_f / 127.f;
+            scale_orig_quant_per_token[bidx] = abs_max_f / quant_type_max<QuantT>();
         }
     }
 }
 
-template <typename T>
+template <int VEC, typename T, typename QuantT>
 void dispatch_rmsnorm_type_square_method(T const* input, T const* gamma, T const* beta, T* normed_output,
     float const eps, int tokens, int hidden_dim, float const* scale_orig_quant_per_tensor,
-    float* scale_orig_quant_per_token, int8_t* normed_output_quant, const dim3 grid, const dim3 block,
-    const size_t shmem_size, cudaStream_t stream)
+    float* scale_orig_quant_per_token, QuantT* normed_output_quant, T const* residual, T* residual_out,
+    const dim3 grid, const dim3 block, const size_t shmem_size, cudaStream_t stream)
 {
     if (shmem_size >= (48 << 10))
     {
-        cudaError_t ret
-            = cudaFuncSetAttribute(generalRmsNorm<T>, cudaFuncAttributeMaxDynamicSharedMemorySize, shmem_size);
+        cudaError_t ret = cudaFuncSetAttribute(
+            generalRmsNorm<T, QuantT, VEC>, cudaFuncAttributeMaxDynamicSharedMemorySize, shmem_size);
     }
-    generalRmsNorm<T><<<grid, block, shmem_size, stream>>>(input, gamma, beta, normed_output, eps, tokens, hidden_dim,
-        scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, true);
+    generalRmsNorm<T, QuantT, VEC><<<grid, block, shmem_size, stream>>>(input, gamma, beta, normed_output, eps,
+        tokens, hidden_dim, scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, residual,
+        residual_out, true);
 }
 
-template <typename T>
+template <typename T, typename QuantT>
 void dispatch_rmsnorm_type(T const* input, T const* gamma, T const* beta, T* normed_output, float const eps, int tokens,
     int hidden_dim, float const* scale_orig_quant_per_tensor, float* scale_orig_quant_per_token,
-    int8_t* normed_output_quant, const dim3 grid, const dim3 block, const size_t shmem_size, cudaStream_t stream)
+    QuantT* normed_output_quant, T const* residual, T* residual_out, const dim3 grid, const dim3 block,
+    const size_t shmem_size, cudaStream_t stream)
 {
-    dispatch_rmsnorm_type_square_method(input, gamma, beta, normed_output, eps, tokens, hidden_dim,
-        scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, grid, block, shmem_size, stream);
+    // 128-bit accesses when the rows and all pointers allow them
+    constexpr int vec = 16 / sizeof(T);
+    auto const aligned = [](void const* ptr) { return reinterpret_cast<uintptr_t>(ptr) % 16 == 0; };
+    bool const use_128_bit = (hidden_dim / num_elems<T>::value) % vec == 0 && aligned(input) && aligned(normed_output)
+        && aligned(residual) && aligned(residual_out);
+    if (use_128_bit)
+    {
+        int const n_vecs = hidden_dim / num_elems<T>::value / vec;
+        dim3 const vec_block(32 * ((min(n_vecs, 1024) + 31) / 32));
+        dispatch_rmsnorm_type_square_method<vec>(input, gamma, beta, normed_output, eps, tokens, hidden_dim,
+            scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, residual, residual_out,
+            grid, vec_block, shmem_size, stream);
+    }
+    else
+    {
+        dispatch_rmsnorm_type_square_method<1>(input, gamma, beta, normed_output, eps, tokens, hidden_dim,
+            scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, residual, residual_out,
+            grid, block, shmem_size, stream);
+    }
 }
 
-template <typename T>
+template <typename T, typename QuantT>
 void invokeGeneralRmsNorm(T* out, T const* input, T const* gamma, T const* beta, float const eps, int const tokens,
-    int const hidden_dim, cudaStream_t stream, float const* scale, float* dynamic_scale, int8_t* normed_output_quant)
+    int const hidden_dim, cudaStream_t stream, float const* scale, float* dynamic_scale, QuantT* normed_output_quant,
+    T const* residual, T* residual_out)
 {
+    TLLM_CHECK_WITH_INFO((residual == nullptr) == (residual_out == nullptr),
+        "The residual and the updated residual must be given together.");
     dim3 grid(tokens);
     dim3 block(min(hidden_dim, 1024));
     // Make sure block.x is multiple of 32 for warp shuffle to work
@@ -196,25 +273,34 @@ void invokeGeneralRmsNorm(T* out, T const* input, T const* gamma, T const* beta,
         using Tp = typename packed_as<T, vec_size>::type;
         dispatch_rmsnorm_type(reinterpret_cast<Tp const*>(input), reinterpret_cast<Tp const*>(gamma),
             reinterpret_cast<Tp const*>(beta), reinterpret_cast<Tp*>(out), eps, tokens, hidden_dim, scale,
-            dynamic_scale, normed_output_quant, grid, block, shmem_size, stream);
+            dynamic_scale, normed_output_quant, reinterpret_cast<Tp const*>(residual),
+            reinterpret_cast<Tp*>(residual_out), grid, block, shmem_size, stream);
     }
     else
     {
         dispatch_rmsnorm_type(input, gamma, beta, out, eps, tokens, hidden_dim, scale, dynamic_scale,
-            normed_output_quant, grid, block, shmem_size, stream);
+            normed_output_quant, residual, residual_out, grid, block, shmem_size, stream);
     }
 }
 
-#define INSTANTIATE_GENERAL_RMSNORM(T)                                                                                 \
+#define INSTANTIATE_GENERAL_RMSNORM(T, QuantT)                                                                         \
     template void invokeGeneralRmsNorm(T* out, const T* input, const T* gamma, const T* beta, const float eps,         \
         const int tokens, const int hidden_dim, cudaStream_t stream, const float* scale, float* dynamic_scale,         \
-        int8_t* normed_output_quant);
+        QuantT* normed_output_quant, const T* residual, T* residual_out);
 
-INSTANTIATE_GENERAL_RMSNORM(float);
-INSTANTIATE_GENERAL_RMSNORM(half);
+INSTANTIATE_GENERAL_RMSNORM(float, int8_t);
+INSTANTIATE_GENERAL_RMSNORM(half, int8_t);
 
 #ifdef ENABLE_BF16
-INSTANTIATE_GENERAL_RMSNORM(__nv_bfloat16);
+INSTANTIATE_GENERAL_RMSNORM(__nv_bfloat16, int8_t);
+#endif
+
+#ifdef ENABLE_FP8
+INSTANTIATE_GENERAL_RMSNORM(float, __nv_fp8_e4m3);
+INSTANTIATE_GENERAL_RMSNORM(half, __nv_fp8_e4m3);
+#ifdef ENABLE_BF16
+INSTANTIATE_GENERAL_RMSNORM(__nv_bfloat16, __nv_fp8_e4m3);
+#endif
 #endif
 
 } // namespace kernels
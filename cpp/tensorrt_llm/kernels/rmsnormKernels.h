@@ -26,10 +26,14 @@ namespace tensorrt_llm
 namespace kernels
 {
 
-template <typename T>
+// out_quant, when given, receives the normed output quantized to int8 or, with ENABLE_FP8, to fp8 (e4m3), either
+// with the per-tensor scale or with per-token scales written to dynamic_scale.
+// residual, when given, is added to input before the norm and the sum is written to residual_out, which may alias
+// residual. This folds the residual add that follows a GEMM into the norm of the next layer.
+template <typename T, typename QuantT = int8_t>
 void invokeGeneralRmsNorm(T* out, T const* input, T const* gamma, T const* beta, float const eps, int const tokens,
     int const hidden_dim, cudaStream_t stream = 0, float const* scale = nullptr, float* dynamic_scale = nullptr,
-    int8_t* out_quant = nullptr);
+    QuantT* out_quant = nullptr, T const* residual = nullptr, T* residual_out = nullptr);
 
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -24,6 +24,7 @@
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/memoryUtils.h"
+#include "tensorrt_llm/kernels/philoxRandom.cuh"
 #include "tensorrt_llm/kernels/samplingTopPKernels.h"
 #include <cuda/atomic>
 
@@ -1218,8 +1219,8 @@ __global__ void airTopPSampling(Counter<T, IdxT, AccT>* counters, HisT* histogra
  */
 template <typename T, typename IdxT, typename AccT, typename HisT, int BitsPerPass, int BlockSize>
 __global__ void airTopPInitialize(Counter<T, IdxT, AccT>* counters, int const batchSize, int const len, T const* in,
-    IdxT const* inIdx, float const* topPs, curandState_t* curandstate, HisT* histograms, IdxT* countHistograms,
-    int32_t const* batchSlots)
+    IdxT const* inIdx, float const* topPs, curandState_t* curandstate, uint64_t const* randomSeeds,
+    int32_t const* sequenceLengths, HisT* histograms, IdxT* countHistograms, int32_t const* batchSlots)
 {
     auto const batchIdx = blockIdx.x;
     auto const batchSlot = batchSlots == nullptr ? batchIdx : batchSlots[batchIdx];
@@ -1240,7 +1241,10 @@ __global__ void airTopPInitialize(Counter<T, IdxT, AccT>* counters, int const ba
         counter->previousLen = len;
 
         float const probThreshold = topPs[batchSlot];
-        float const randP = curand_uniform(curandstate + batchSlot) * probThreshold;
+        float const uniform = randomSeeds != nullptr
+            ? getPhiloxUniform(randomSeeds[batchSlot], sequenceLengths[batchSlot])
+            : curand_uniform(curandstate + batchSlot);
+        float const randP = uniform * probThreshold;
         counter->p = randP;
         counter->sum = 0;
 
@@ -1397,7 +1401,8 @@ void invokeAirTopPSamplingWithDeterministicPara(TopPSamplingKernelParams<T> cons
 
     airTopPInitialize<T, IdxT, AccT, HisT, BitsPerPass, THREADS_PER_CTA_TOP_P_INIT>
         <<<params.batchSize, THREADS_PER_CTA_TOP_P_INIT, 0, stream>>>(counters, params.batchSize, vocabSize,
-            params.probs, nullptr, params.topPs, params.curandState, histograms, countHistograms, params.batchSlots);
+            params.probs, nullptr, params.topPs, params.curandState, params.randomSeeds, params.sequenceLength,
+            histograms, countHistograms, params.batchSlots);
 
     dim3 grid(params.blockNum, params.batchSize);
     // Sample with Top P given sorted tokens
@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CUDART_VERSION
+#error CUDART_VERSION Undefined!
+#elif (CUDART_VERSION >= 11050)
+#include <cub/cub.cuh>
+#else
+#include "3rdparty/cub/cub.cuh"
+#endif
+
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/memoryUtils.h"
+#include "tensorrt_llm/common/reduceKernelUtils.cuh"
+#include "tensorrt_llm/kernels/samplingFusedPenaltyTopKKernels.h"
+#include "tensorrt_llm/layers/defaultDecodingParams.h"
+
+#include <float.h>
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+struct RequestPenalties
+{
+    float invTemperature;
+    float repetitionPenalty;
+    float presencePenalty;
+    float frequencyPenalty;
+    SizeType32 minLength;
+    bool hasTemperature;
+    bool accumulateVocab;
+};
+
+__device__ bool isDefault(float value, float defaultValue)
+{
+    return fabs(value - defaultValue) < 1e-9f;
+}
+
+__device__ RequestPenalties getRequestPenalties(float const* temperatures, float const* repetitionPenalties,
+    float const* presencePenalties, float const* frequencyPenalties, SizeType32 const* minLengths,
+    SizeType32 batchSlot)
+{
+    using layers::DefaultDecodingParams;
+    RequestPenalties penalties{1.0f, DefaultDecodingParams::getRepetitionPenalty(),
+        DefaultDecodingParams::getPresencePenalty(), DefaultDecodingParams::getFrequencyPenalty(),
+        DefaultDecodingParams::getMinLength(), false, false};
+    if (temperatures != nullptr)
+    {
+        auto const temperature = temperatures[batchSlot];
+        penalties.invTemperature = 1.0f / (temperature + 1e-6f);
+        penalties.hasTemperature = !isDefault(temperature, DefaultDecodingParams::getTemperature());
+    }
+    if (repetitionPenalties != nullptr)
+    {
+        penalties.repetitionPenalty = repetitionPenalties[batchSlot];
+        penalties.accumulateVocab
+            |= !isDefault(penalties.repetitionPenalty, DefaultDecodingParams::getRepetitionPenalty());
+    }
+    if (presencePenalties != nullptr)
+    {
+        penalties.presencePenalty = presencePenalties[batchSlot];
+        penalties.accumulateVocab |= !isDefault(penalties.presencePenalty, DefaultDecodingParams::getPresencePenalty());
+    }
+    if (frequencyPenalties != nullptr)
+    {
+        penalties.frequencyPenalty = frequencyPenalties[batchSlot];
+        penalties.accumulateVocab
+            |= !isDefault(penalties.frequencyPenalty, DefaultDecodingParams::getFrequencyPenalty());
+    }
+    if (minLengths != nullptr)
+    {
+        penalties.minLength = minLengths[batchSlot];
+    }
+    return penalties;
+}
+
+__device__ bool skipRequest(bool const* skipDecode, FinishedState const* finished, SizeType32 batchSlot)
+{
+    FinishedState const finishState = finished != nullptr ? finished[batchSlot] : FinishedState::empty();
+    return (skipDecode != nullptr && skipDecode[batchSlot]) || finishState.isSkipDecoding();
+}
+
+//! Updates the occurrence counts exactly like batchApplyPenalty does for beam width 1.
+template <typename T>
+__global__ void updatePenaltyCounts(FusedPenaltyTopKSamplingParams<T> const params)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = params.batchSlots == nullptr ? batchIdx : params.batchSlots[batchIdx];
+    if (skipRequest(params.skipDecode, params.finishedInput, batchSlot))
+    {
+        return;
+    }
+    auto const penalties = getRequestPenalties(params.temperatures, params.repetitionPenalties,
+        params.presencePenalties, params.frequencyPenalties, params.minLengths, batchSlot);
+    if (!penalties.accumulateVocab)
+    {
+        return;
+    }
+
+    auto const inputLen = params.inputLengths == nullptr ? SizeType32{0} : params.inputLengths[batchSlot];
+    auto const currentStep = params.sequenceLengths[batchSlot];
+    auto* penaltyWorkspace = params.penaltyWorkspace + batchIdx * params.vocabSize;
+    auto const* outputIds = params.outputIdsPtrs[batchSlot];
+    if (currentStep <= inputLen)
+    { // Context phase
+        for (auto index = static_cast<SizeType32>(threadIdx.x); index < params.vocabSize;
+             index += static_cast<SizeType32>(blockDim.x))
+        {
+            penaltyWorkspace[index] = 0;
+        }
+        __syncthreads();
+        for (auto step = static_cast<SizeType32>(threadIdx.x); step < inputLen;
+             step += static_cast<SizeType32>(blockDim.x))
+        {
+            auto const penaltyIndex = outputIds[step];
+            if (penaltyIndex < params.vocabSize)
+            {
+                atomicAdd(&penaltyWorkspace[penaltyIndex], 1);
+            }
+        }
+    }
+    else if (threadIdx.x == 0)
+    { // Generation phase
+        auto const penaltyIndex = outputIds[currentStep - 1];
+        if (penaltyIndex < params.vocabSize)
+        {
+            penaltyWorkspace[penaltyIndex] += 1;
+        }
+    }
+}
+
+//! Applies the penalties to one chunk of the vocab of one request in shared memory and selects its top K.
+template <typename T, SizeType32 BLOCK_SIZE>
+__global__ void fusedPenaltyTopKStage1(
+    FusedPenaltyTopKSamplingParams<T> const params, SizeType32* topKTmpIdBuf, float* topKTmpValBuf)
+{
+    typedef cub::BlockReduce<TopK_2<float>, BLOCK_SIZE> BlockReduce;
+    __shared__ typename BlockReduce::TempStorage tempStorage;
+    __shared__ float sLogits[FUSED_PENALTY_TOP_K_CHUNK_SIZE];
+
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+    auto const chunkIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const numChunks = static_cast<SizeType32>(gridDim.x);
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.y);
+    auto const batchSlot = params.batchSlots == nullptr ? batchIdx : params.batchSlots[batchIdx];
+    if (skipRequest(params.skipDecode, params.finishedInput, batchSlot))
+    {
+        return;
+    }
+
+    auto const penalties = getRequestPenalties(params.temperatures, params.repetitionPenalties,
+        params.presencePenalties, params.frequencyPenalties, params.minLengths, batchSlot);
+    auto const inputLen = params.inputLengths == nullptr ? SizeType32{0} : params.inputLengths[batchSlot];
+    auto const currentStep = params.sequenceLengths[batchSlot];
+    auto const maskedEndId = currentStep - inputLen < penalties.minLength ? params.endIds[batchSlot] : -1;
+    auto const k = params.topKs != nullptr ? params.topKs[batchSlot] : params.maxTopK;
+
+    auto const chunkBegin = chunkIdx * FUSED_PENALTY_TOP_K_CHUNK_SIZE;
+    auto const chunkSize = min(FUSED_PENALTY_TOP_K_CHUNK_SIZE, params.vocabSize - chunkBegin);
+    auto const* logits = params.logitsPtrs[batchIdx];
+    auto const* biases = params.biases == nullptr ? nullptr : params.biases + batchSlot * params.vocabSizePadded;
+    auto const* penaltyCounts
+        = penalties.accumulateVocab ? params.penaltyWorkspace + batchIdx * params.vocabSize : nullptr;
+
+    for (auto localIdx = tid; localIdx < chunkSize; localIdx += BLOCK_SIZE)
+    {
+        auto const index = chunkBegin + localIdx;
+        auto logit = static_cast<float>(logits[index]);
+        if (biases != nullptr)
+        {
+            logit += static_cast<float>(biases[index]);
+        }
+        if (penalties.hasTemperature)
+        {
+            logit *= penalties.invTemperature;
+        }
+        if (penaltyCounts != nullptr)
+        {
+            auto const numOccurences = penaltyCounts[index];
+            if (numOccurences > 0)
+            {
+                if (params.repetitionPenalties != nullptr)
+                {
+                    logit = logit < 0.0f ? logit * penalties.repetitionPenalty : logit / penalties.repetitionPenalty;
+                }
+                if (params.presencePenalties != nullptr)
+                {
+                    logit -= penalties.presencePenalty;
+                }
+                if (params.frequencyPenalties != nullptr)
+                {
+                    logit -= penalties.frequencyPenalty * numOccurences;
+                }
+            }
+        }
+        sLogits[localIdx] = index == maskedEndId ? -FLT_MAX : logit;
+    }
+    __syncthreads();
+
+    auto const tmpTopKBufIndex = (batchIdx * numChunks + chunkIdx) * params.maxTopK;
+    for (SizeType32 ite = 0; ite < k; ite++)
+    {
+        TopK_2<float> partial;
+        for (auto localIdx = tid; localIdx < chunkSize; localIdx += BLOCK_SIZE)
+        {
+            partial.insert(sLogits[localIdx], localIdx);
+        }
+
+        TopK_2<float> total = BlockReduce(tempStorage).Reduce(partial, reduce_topk_op_2<float>);
+
+        if (tid == 0)
+        {
+            topKTmpIdBuf[tmpTopKBufIndex + ite] = total.p >= 0 ? chunkBegin + total.p : -1;
+            topKTmpValBuf[tmpTopKBufIndex + ite] = total.u;
+            if (total.p >= 0)
+            {
+                sLogits[total.p] = -FLT_MAX;
+            }
+        }
+        __syncthreads();
+    }
+}
+
+//! Samples from the top K of the candidates of all chunks, like topKStage2Sampling.
+template <typename T, SizeType32 BLOCK_SIZE>
+__global__ void fusedPenaltyTopKStage2Sampling(FusedPenaltyTopKSamplingParams<T> const params,
+    SizeType32 const* __restrict topKTmpIdBuf, float* topKTmpValBuf, SizeType32 numChunks)
+{
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = params.batchSlots == nullptr ? batchIdx : params.batchSlots[batchIdx];
+    if (skipRequest(params.skipDecode, params.finishedInput, batchSlot))
+    {
+        return;
+    }
+    FinishedState const finishState
+        = params.finishedInput != nullptr ? params.finishedInput[batchSlot] : FinishedState::empty();
+    if (finishState.isFinished())
+    {
+        if (tid == 0 && params.finishedOutput != nullptr)
+        {
+            params.finishedOutput[batchSlot] = finishState;
+        }
+        return;
+    }
+
+    auto const k = params.topKs != nullptr ? params.topKs[batchSlot] : params.maxTopK;
+    auto const probThreshold = params.topPs != nullptr ? params.topPs[batchSlot] : params.maxTopP;
+    auto const stride = params.maxTopK;
+
+    typedef cub::BlockReduce<TopK_2<float>, BLOCK_SIZE> BlockReduce;
+    __shared__ typename BlockReduce::TempStorage tempStorage;
+    extern __shared__ char array[];
+    __shared__ float sSum;
+    __shared__ float sMaxLogit;
+    auto* sId = reinterpret_cast<SizeType32*>(array);
+    auto* sVal = reinterpret_cast<float*>(sId + k);
+    float* candidates = topKTmpValBuf + batchIdx * numChunks * stride;
+    SizeType32 const* candidateIds = topKTmpIdBuf + batchIdx * numChunks * stride;
+    if (tid == 0)
+    {
+        sSum = 0.0f;
+    }
+
+    for (SizeType32 ite = 0; ite < k; ite++)
+    {
+        TopK_2<float> partial;
+        for (SizeType32 i = tid; i < numChunks * k; i += BLOCK_SIZE)
+        {
+            auto const candidateIdx = (i / k) * stride + i % k;
+            partial.insert(candidates[candidateIdx], candidateIdx);
+        }
+
+        TopK_2<float> total = BlockReduce(tempStorage).Reduce(partial, reduce_topk_op_2<float>);
+
+        if (tid == 0)
+        {
+            if (ite == 0)
+            {
+                sMaxLogit = total.u;
+            }
+            sId[ite] = total.p >= 0 ? candidateIds[total.p] : -1;
+            if (total.p >= 0)
+            {
+                candidates[total.p] = -FLT_MAX;
+            }
+            auto const expLogit = total.p >= 0 ? __expf(total.u - sMaxLogit) : 0.0f;
+            sVal[ite] = expLogit;
+            sSum += expLogit;
+        }
+        __syncthreads();
+    }
+
+    if (tid == 0)
+    {
+        auto randNum = static_cast<float>(curand_uniform(params.curandState + batchSlot) * probThreshold * sSum);
+        auto* outputIdsRequestPtr = params.outputIdsPtrs[batchSlot];
+        auto const curSeqLen = params.sequenceLengths[batchSlot];
+        for (SizeType32 ki = 0; ki < k; ki++)
+        {
+            auto const expLogit = sVal[ki];
+            randNum = randNum - expLogit;
+            if (randNum <= 0.0f || ki == k - 1)
+            {
+                // If the id is -1 here we force output token to the last from vocabulary to get vivid indicator of
+                // smth going wrong for the debug
+                auto const outputId = sId[ki] != -1 ? sId[ki] : params.vocabSize - 1;
+                outputIdsRequestPtr[curSeqLen] = outputId;
+                if (params.cumLogProbs != nullptr || params.outputLogProbs != nullptr)
+                {
+                    auto const logProb = logf(expLogit);
+                    if (params.cumLogProbs != nullptr)
+                    {
+                        params.cumLogProbs[batchSlot] += logProb;
+                    }
+                    if (params.outputLogProbs != nullptr)
+                    {
+                        params.outputLogProbs[curSeqLen * params.maxBatchSize + batchSlot]
+                            = params.normalizeLogProbs ? logProb - logf(sSum) : logProb;
+                    }
+                }
+                break;
+            }
+        }
+        if (params.finishedOutput != nullptr)
+        {
+            if (outputIdsRequestPtr[curSeqLen] == params.endIds[batchSlot])
+            {
+                params.finishedOutput[batchSlot].setFinishedEOS();
+                // Do not increase seq len when EOS is generated. Seq len should always contain only tokens to be
+                // outputted
+            }
+            else
+            {
+                params.sequenceLengths[batchSlot] += 1;
+            }
+        }
+    }
+}
+
+std::vector<size_t> getFusedPenaltyTopKWorkspaceSizes(SizeType32 batchSize, SizeType32 maxTopK, SizeType32 vocabSize)
+{
+    auto const numChunks = divUp(vocabSize, FUSED_PENALTY_TOP_K_CHUNK_SIZE);
+    auto const numCandidates = static_cast<size_t>(batchSize) * numChunks * maxTopK;
+    return {sizeof(SizeType32) * numCandidates, sizeof(float) * numCandidates};
+}
+
+} // namespace
+
+size_t getFusedPenaltyTopKWorkspaceSize(SizeType32 batchSize, SizeType32 maxTopK, SizeType32 vocabSize)
+{
+    return calcAlignedSize(getFusedPenaltyTopKWorkspaceSizes(batchSize, maxTopK, vocabSize), 256);
+}
+
+template <typename T>
+void invokeBatchFusedPenaltyTopKSampling(FusedPenaltyTopKSamplingParams<T> const& params, cudaStream_t stream)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    params.checkParams();
+
+    auto const workspaceSizes = getFusedPenaltyTopKWorkspaceSizes(params.batchSize, params.maxTopK, params.vocabSize);
+    std::vector<void*> alignedPointers;
+    calcAlignedPointers(alignedPointers, params.workspace, workspaceSizes);
+    auto topKTmpIdBuf = static_cast<SizeType32*>(alignedPointers[0]);
+    auto topKTmpValBuf = static_cast<float*>(alignedPointers[1]);
+
+    if (params.penaltyWorkspace != nullptr)
+    {
+        updatePenaltyCounts<T><<<params.batchSize, 512, 0, stream>>>(params);
+    }
+
+    SizeType32 constexpr kStage1BlockSize = 256;
+    SizeType32 constexpr kStage2BlockSize = 256;
+    auto const numChunks = divUp(params.vocabSize, FUSED_PENALTY_TOP_K_CHUNK_SIZE);
+    dim3 const grid(numChunks, params.batchSize);
+    fusedPenaltyTopKStage1<T, kStage1BlockSize><<<grid, kStage1BlockSize, 0, stream>>>(
+        params, topKTmpIdBuf, topKTmpValBuf);
+    auto const smemSize = params.maxTopK * (sizeof(SizeType32) + sizeof(float));
+    fusedPenaltyTopKStage2Sampling<T, kStage2BlockSize><<<params.batchSize, kStage2BlockSize, smemSize, stream>>>(
+        params, topKTmpIdBuf, topKTmpValBuf, numChunks);
+    sync_check_cuda_error();
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template void invokeBatchFusedPenaltyTopKSampling(
+    FusedPenaltyTopKSamplingParams<float> const& params, cudaStream_t stream);
+template void invokeBatchFusedPenaltyTopKSampling(
+    FusedPenaltyTopKSamplingParams<half> const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/samplingTopKKernels.h"
+#include "tensorrt_llm/runtime/common.h"
+#include <curand_kernel.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+//! Number of vocab entries handled by one block of the first pass.
+static constexpr runtime::SizeType32 FUSED_PENALTY_TOP_K_CHUNK_SIZE = 4096;
+
+template <typename T>
+struct FusedPenaltyTopKSamplingParams
+{
+    //! input buffer [batchSize][vocabSizePadded] array of pointers to the raw logits of each request.
+    T const* const* logitsPtrs{nullptr};
+    //! input buffer [maxBatchSize, vocabSizePadded], optional. Embedding bias per request.
+    T const* biases{nullptr};
+
+    //! input/output buffer [batchSize, vocabSize], required when any occurrence based penalty is set.
+    //! Number of occurrences of each token, updated like invokeBatchApplyPenalty does.
+    runtime::TokenIdType* penaltyWorkspace{nullptr};
+    //! input buffers [maxBatchSize], optional. Same semantics as in InvokeBatchApplyPenaltyParams.
+    float const* temperatures{nullptr};
+    float const* repetitionPenalties{nullptr};
+    float const* presencePenalties{nullptr};
+    float const* frequencyPenalties{nullptr};
+    runtime::SizeType32 const* minLengths{nullptr};
+    //! input buffer [maxBatchSize], optional. Prompt length of each request.
+    runtime::SizeType32 const* inputLengths{nullptr};
+
+    //! input/output buffer [maxBatchSize][maxSeqLen]. Pointers to rows with the tokens of each request, read for the
+    //! penalties and written with the sampled token.
+    runtime::TokenIdType** outputIdsPtrs{nullptr};
+    //! input/output buffer [maxBatchSize]. Current sequence length of each request.
+    runtime::SizeType32* sequenceLengths{nullptr};
+    //! input buffer [maxBatchSize]. EOS token ids per request.
+    runtime::TokenIdType const* endIds{nullptr};
+    //! input buffer [batchSize], optional. Indices of rows of data in memory pool.
+    runtime::SizeType32 const* batchSlots{nullptr};
+
+    //! input buffer [maxBatchSize], optional.
+    FinishedState const* finishedInput{nullptr};
+    //! output buffer [maxBatchSize], optional.
+    FinishedState* finishedOutput{nullptr};
+    //! input buffer [maxBatchSize], optional. Flags whether to skip decoding per request.
+    bool const* skipDecode{nullptr};
+
+    //! input/output buffer [maxBatchSize], optional. Same semantics as in TopKSamplingKernelParams.
+    float* cumLogProbs{nullptr};
+    //! output buffer [maxSeqLen, maxBatchSize], optional. Same semantics as in TopKSamplingKernelParams.
+    float* outputLogProbs{nullptr};
+    //! input buffer [maxBatchSize]. Initialized curand states.
+    curandState_t* curandState{nullptr};
+
+    //! input buffer [maxBatchSize], optional. K per request in range [1; maxTopK]. maxTopK is used if nullptr.
+    runtime::SizeType32 const* topKs{nullptr};
+    //! input buffer [maxBatchSize], optional. P per request, applied to the top K tokens. maxTopP is used if nullptr.
+    float const* topPs{nullptr};
+    runtime::SizeType32 maxTopK{0};
+    float maxTopP{1.0f};
+
+    //! Required. Pointer to the workspace of size returned by getFusedPenaltyTopKWorkspaceSize.
+    void* workspace{nullptr};
+
+    runtime::SizeType32 batchSize{-1};
+    runtime::SizeType32 maxBatchSize{-1};
+    runtime::SizeType32 maxSeqLen{-1};
+    runtime::SizeType32 vocabSize{-1};
+    runtime::SizeType32 vocabSizePadded{-1};
+
+    bool normalizeLogProbs{false};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(batchSize > 0);
+        TLLM_CHECK(maxBatchSize >= batchSize);
+        TLLM_CHECK(maxSeqLen > 0);
+        TLLM_CHECK(0 < vocabSize && vocabSize <= vocabSizePadded);
+        TLLM_CHECK(logitsPtrs);
+        TLLM_CHECK(outputIdsPtrs);
+        TLLM_CHECK(sequenceLengths);
+        TLLM_CHECK(endIds);
+        TLLM_CHECK(curandState);
+        TLLM_CHECK(workspace);
+        TLLM_CHECK(penaltyWorkspace || (!repetitionPenalties && !presencePenalties && !frequencyPenalties));
+        TLLM_CHECK(((finishedOutput == nullptr) ^ (finishedInput == nullptr)) == 0);
+        TLLM_CHECK(0 < maxTopP && maxTopP <= 1.f);
+        TLLM_CHECK(0 < maxTopK && maxTopK <= TOP_K_MAX);
+    }
+};
+
+//! \brief Returns workspace size in bytes needed by invokeBatchFusedPenaltyTopKSampling.
+[[nodiscard]] size_t getFusedPenaltyTopKWorkspaceSize(
+    runtime::SizeType32 batchSize, runtime::SizeType32 maxTopK, runtime::SizeType32 vocabSize);
+
+// clang-format off
+//! \brief Applies bias, temperature, repetition, presence and frequency penalties and min length to the logits and
+//! samples from the top K (and top P among them) tokens, with the semantics of invokeBatchApplyPenalty followed by
+//! invokeBatchTopKSampling for beam width 1 and one token per step. The logits are read once: every block applies
+//! the penalties to a chunk of the vocab in shared memory and selects the top K of the chunk there, and a second
+//! kernel samples from the top K of all chunks. The penalized logits are not written out, so other logits
+//! processing (e.g. bad words) has to use the unfused path.
+// clang-format on
+template <typename T>
+void invokeBatchFusedPenaltyTopKSampling(FusedPenaltyTopKSamplingParams<T> const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
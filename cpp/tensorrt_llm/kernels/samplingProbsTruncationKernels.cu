@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CUDART_VERSION
+#error CUDART_VERSION Undefined!
+#elif (CUDART_VERSION >= 11050)
+#include <cub/cub.cuh>
+#else
+#include "3rdparty/cub/cub.cuh"
+#endif
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/samplingProbsTruncationKernels.h"
+#include "tensorrt_llm/layers/defaultDecodingParams.h"
+
+#include <float.h>
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+//! Number of bisection steps on the deviation from the entropy used to find the typical set.
+SizeType32 constexpr kTYPICAL_BISECTION_STEPS = 24;
+
+template <SizeType32 BLOCK_SIZE, typename ReductionOp>
+__device__ float blockReduce(float value, ReductionOp op)
+{
+    typedef cub::BlockReduce<float, BLOCK_SIZE> BlockReduce;
+    __shared__ typename BlockReduce::TempStorage tempStorage;
+    __shared__ float result;
+
+    auto const total = BlockReduce(tempStorage).Reduce(value, op);
+    if (threadIdx.x == 0)
+    {
+        result = total;
+    }
+    __syncthreads();
+    auto const broadcast = result;
+    __syncthreads();
+    return broadcast;
+}
+
+__device__ float getDeviation(float prob, float entropy)
+{
+    return fabsf(-__logf(prob) - entropy);
+}
+
+template <typename T, SizeType32 BLOCK_SIZE>
+__global__ void truncateProbs(ProbsTruncationKernelParams<T> params)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = params.batchSlots != nullptr ? params.batchSlots[batchIdx] : batchIdx;
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+
+    if (params.finishedInput != nullptr && params.finishedInput[batchSlot].isSkipDecoding())
+    {
+        return;
+    }
+
+    auto const minP = params.minPs != nullptr ? params.minPs[batchSlot] : layers::DefaultDecodingParams::getMinP();
+    auto const typicalP
+        = params.typicalPs != nullptr ? params.typicalPs[batchSlot] : layers::DefaultDecodingParams::getTypicalP();
+    auto const eta
+        = params.etaCutoffs != nullptr ? params.etaCutoffs[batchSlot] : layers::DefaultDecodingParams::getEtaCutoff();
+    auto const useTypical = typicalP < 1.f;
+    if (minP <= 0.f && !useTypical && eta <= 0.f)
+    {
+        return;
+    }
+
+    auto* probs = params.probs + static_cast<std::size_t>(batchIdx) * params.vocabSizePadded;
+
+    float localMax{0.f};
+    float localEntropy{0.f};
+    for (SizeType32 vi = tid; vi < params.vocabSize; vi += BLOCK_SIZE)
+    {
+        auto const prob = static_cast<float>(probs[vi]);
+        localMax = fmaxf(localMax, prob);
+        if (prob > 0.f)
+        {
+            localEntropy -= prob * __logf(prob);
+        }
+    }
+    auto const maxProb = blockReduce<BLOCK_SIZE>(localMax, cub::Max());
+    auto const entropy = blockReduce<BLOCK_SIZE>(localEntropy, cub::Sum());
+
+    // Min-p and eta keep the tokens above a probability threshold, the most probable token is always kept
+    auto probThreshold = minP * maxProb;
+    if (eta > 0.f)
+    {
+        probThreshold = fmaxf(probThreshold, fminf(eta, sqrtf(eta) * __expf(-entropy)));
+    }
+    probThreshold = fminf(probThreshold, maxProb);
+
+    // Typical-p keeps the tokens with a deviation from the entropy up to the smallest threshold reaching typicalP
+    auto devThreshold = FLT_MAX;
+    if (useTypical)
+    {
+        float localMaxDev{0.f};
+        for (SizeType32 vi = tid; vi < params.vocabSize; vi += BLOCK_SIZE)
+        {
+            auto const prob = static_cast<float>(probs[vi]);
+            if (prob > 0.f)
+            {
+                localMaxDev = fmaxf(localMaxDev, getDeviation(prob, entropy));
+            }
+        }
+        auto low = 0.f;
+        auto high = blockReduce<BLOCK_SIZE>(localMaxDev, cub::Max());
+        for (SizeType32 step = 0; step < kTYPICAL_BISECTION_STEPS; ++step)
+        {
+            auto const mid = 0.5f * (low + high);
+            float localMass{0.f};
+            for (SizeType32 vi = tid; vi < params.vocabSize; vi += BLOCK_SIZE)
+            {
+                auto const prob = static_cast<float>(probs[vi]);
+                if (prob > 0.f && getDeviation(prob, entropy) <= mid)
+                {
+                    localMass += prob;
+                }
+            }
+            auto const mass = blockReduce<BLOCK_SIZE>(localMass, cub::Sum());
+            if (mass >= typicalP)
+            {
+                high = mid;
+            }
+            else
+            {
+                low = mid;
+            }
+        }
+        devThreshold = high;
+    }
+
+    auto const isKept = [&](float prob, bool withTypical)
+    { return prob > 0.f && prob >= probThreshold && (!withTypical || getDeviation(prob, entropy) <= devThreshold); };
+
+    float localKeptMass{0.f};
+    for (SizeType32 vi = tid; vi < params.vocabSize; vi += BLOCK_SIZE)
+    {
+        auto const prob = static_cast<float>(probs[vi]);
+        localKeptMass += isKept(prob, useTypical) ? prob : 0.f;
+    }
+    auto keptMass = blockReduce<BLOCK_SIZE>(localKeptMass, cub::Sum());
+    // The typical set might not contain any token above the probability threshold, drop the typical constraint then
+    auto const withTypical = useTypical && keptMass > 0.f;
+    if (!withTypical && useTypical)
+    {
+        localKeptMass = 0.f;
+        for (SizeType32 vi = tid; vi < params.vocabSize; vi += BLOCK_SIZE)
+        {
+            auto const prob = static_cast<float>(probs[vi]);
+            localKeptMass += isKept(prob, false) ? prob : 0.f;
+        }
+        keptMass = blockReduce<BLOCK_SIZE>(localKeptMass, cub::Sum());
+    }
+
+    auto const invKeptMass = 1.f / keptMass;
+    for (SizeType32 vi = tid; vi < params.vocabSize; vi += BLOCK_SIZE)
+    {
+        auto const prob = static_cast<float>(probs[vi]);
+        probs[vi] = static_cast<T>(isKept(prob, withTypical) ? prob * invKeptMass : 0.f);
+    }
+}
+} // namespace
+
+template <typename T>
+void invokeTruncateProbs(ProbsTruncationKernelParams<T> const& params, cudaStream_t stream)
+{
+    params.checkParams();
+
+    SizeType32 constexpr kBLOCK_SIZE{512};
+    truncateProbs<T, kBLOCK_SIZE><<<params.batchSize, kBLOCK_SIZE, 0, stream>>>(params);
+    sync_check_cuda_error();
+}
+
+template void invokeTruncateProbs(ProbsTruncationKernelParams<float> const& params, cudaStream_t stream);
+template void invokeTruncateProbs(ProbsTruncationKernelParams<half> const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/runtime/common.h"
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+template <typename T>
+struct ProbsTruncationKernelParams
+{
+    //! input/output buffer [batchSize, vocabSizePadded], required. Probabilities of each token in the vocab.
+    //! Truncated tokens are set to 0 and the remaining ones are renormalized.
+    T* probs{nullptr};
+
+    //! input buffer [maxBatchSize], optional. Min-p per request in range [0.0; 1.0]. Tokens less probable than
+    //! minP times the probability of the most probable token are truncated. 0 disables it.
+    float const* minPs{nullptr};
+    //! input buffer [maxBatchSize], optional. Typical-p per request in range (0.0; 1.0]. Only the tokens whose
+    //! information content is closest to the entropy of the distribution, with a total probability of at least
+    //! typicalP, are kept (https://arxiv.org/abs/2202.00666). 1 disables it.
+    float const* typicalPs{nullptr};
+    //! input buffer [maxBatchSize], optional. Eta per request in range [0.0; 1.0). Tokens less probable than
+    //! min(eta, sqrt(eta) * exp(-entropy)) are truncated (https://arxiv.org/abs/2210.15191). 0 disables it.
+    float const* etaCutoffs{nullptr};
+
+    //! input buffer[batchSize], optional. Indices of rows of data in memory pool.
+    runtime::SizeType32 const* batchSlots{nullptr};
+    //! input buffer [maxBatchSize], optional. Finished requests are skipped.
+    FinishedState const* finishedInput{nullptr};
+
+    runtime::SizeType32 batchSize{-1};
+    runtime::SizeType32 vocabSize{-1};
+    runtime::SizeType32 vocabSizePadded{-1};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(batchSize > 0);
+        TLLM_CHECK(vocabSize > 0);
+        TLLM_CHECK(vocabSizePadded >= vocabSize);
+        TLLM_CHECK(probs);
+        TLLM_CHECK(minPs || typicalPs || etaCutoffs);
+    }
+};
+
+//! \brief Truncates the probabilities of each request with min-p, typical-p and eta sampling and renormalizes them,
+//! so that the top-K and top-P sampling kernels sample from the truncated distribution. All requests of the batch
+//! are handled by one launch, requests without truncation are left untouched.
+template <typename T>
+void invokeTruncateProbs(ProbsTruncationKernelParams<T> const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
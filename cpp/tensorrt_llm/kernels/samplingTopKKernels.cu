@@ -28,6 +28,7 @@
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/common/reduceKernelUtils.cuh"
 #include "tensorrt_llm/common/stringUtils.h"
+#include "tensorrt_llm/kernels/philoxRandom.cuh"
 #include "tensorrt_llm/kernels/samplingTopKKernels.h"
 
 using namespace tensorrt_llm::common;
@@ -38,14 +39,40 @@ namespace tensorrt_llm
 namespace kernels
 {
 
+namespace
+{
+//! Running max and sum of exp(logit - max) of a set of logits, the log-sum-exp being max + log(sum)
+struct LogSumExp
+{
+    float max;
+    float sum;
+};
+
+__device__ __forceinline__ LogSumExp reduceLogSumExpOp(LogSumExp const& a, LogSumExp const& b)
+{
+    auto const max = fmaxf(a.max, b.max);
+    return {max, a.sum * __expf(a.max - max) + b.sum * __expf(b.max - max)};
+}
+
+//! Number of candidates selected per request. It covers the alternatives returned with their log probs, while
+//! sampling only happens among the top k of them.
+__device__ __forceinline__ SizeType32 getNumCandidates(SizeType32 k, SizeType32 numTopLogProbs)
+{
+    return max(k, numTopLogProbs);
+}
+} // namespace
+
 template <typename T, int32_t BLOCK_SIZE_, int32_t BLOCKS_PER_BEAM_>
 __global__ void topKStage1(T const* __restrict logProbs, T const* const* __restrict logProbsPtrs, T* tmpLogProbs,
-    SizeType32* topKTmpIdBuf, T* topKTmpValBuf, FinishedState const* finished, SizeType32 maxTopK,
-    SizeType32 const* topKs, SizeType32 vocabSize, TokenIdType const* endIds, bool const* skipDecode,
-    SizeType32 const* batchSlots, SizeType32 const* tokensPerStep, SizeType32 maxTokensPerStep)
+    SizeType32* topKTmpIdBuf, T* topKTmpValBuf, float* logSumExpBuf, FinishedState const* finished,
+    SizeType32 maxTopK, SizeType32 const* topKs, SizeType32 numTopLogProbs, SizeType32 vocabSize,
+    TokenIdType const* endIds, bool const* skipDecode, SizeType32 const* batchSlots, SizeType32 const* tokensPerStep,
+    SizeType32 maxTokensPerStep)
 {
     typedef cub::BlockReduce<TopK_2<T>, BLOCK_SIZE_> BlockReduce;
     __shared__ typename BlockReduce::TempStorage tempStorage;
+    typedef cub::BlockReduce<LogSumExp, BLOCK_SIZE_> BlockReduceLogSumExp;
+    __shared__ typename BlockReduceLogSumExp::TempStorage tempStorageLogSumExp;
 
     auto const tid = static_cast<SizeType32>(threadIdx.x);
     auto const bid = static_cast<SizeType32>(blockIdx.x);
@@ -68,8 +95,8 @@ __global__ void topKStage1(T const* __restrict logProbs, T const* const* __restr
     auto logProbsSlot
         = logProbsPtrs == nullptr ? logProbs + logBufIndex : logProbsPtrs[batchId * maxTokensPerStep + tokenIdx];
 
-    auto const blockLane = bid % BLOCKS_PER_BEAM_;                  // block id for a beam
-    auto const k = (topKs != nullptr) ? topKs[batchSlot] : maxTopK; // batchId = batch index
+    auto const blockLane = bid % BLOCKS_PER_BEAM_; // block id for a beam
+    auto const k = getNumCandidates((topKs != nullptr) ? topKs[batchSlot] : maxTopK, numTopLogProbs);
 
     auto const tmpLogBufIndex = batchId * maxTokensPerStep * vocabSize + tokenIdx * vocabSize;
     auto const tmpTopKBufIndex = batchId * maxTokensPerStep * BLOCKS_PER_BEAM_ * maxTopK
@@ -99,10 +126,29 @@ __global__ void topKStage1(T const* __restrict logProbs, T const* const* __restr
         return;
     }
 
+    LogSumExp threadLogSumExp{-FLT_MAX, 0.f};
     for (auto elemId = tid + blockLane * BLOCK_SIZE_; elemId < vocabSize; elemId += BLOCK_SIZE_ * BLOCKS_PER_BEAM_)
     {
         auto localIndex = elemId + tmpLogBufIndex;
-        tmpLogProbs[localIndex] = logProbsSlot[elemId];
+        auto const logit = logProbsSlot[elemId];
+        tmpLogProbs[localIndex] = logit;
+        if (logSumExpBuf != nullptr)
+        {
+            // Online softmax, rescale the running sum whenever the running max grows
+            threadLogSumExp = reduceLogSumExpOp(threadLogSumExp, {static_cast<float>(logit), 1.f});
+        }
+    }
+
+    if (logSumExpBuf != nullptr)
+    {
+        auto const blockLogSumExp
+            = BlockReduceLogSumExp(tempStorageLogSumExp).Reduce(threadLogSumExp, reduceLogSumExpOp);
+        if (tid == 0)
+        {
+            auto const index = ((batchId * maxTokensPerStep + tokenIdx) * BLOCKS_PER_BEAM_ + blockLane) * 2;
+            logSumExpBuf[index] = blockLogSumExp.max;
+            logSumExpBuf[index + 1] = blockLogSumExp.sum;
+        }
     }
 
     for (SizeType32 ite = 0; ite < k; ite++)
@@ -132,13 +178,14 @@ __global__ void topKStage1(T const* __restrict logProbs, T const* const* __restr
 }
 
 template <typename T, int BLOCK_SIZE_, int BLOCKS_PER_BEAM_>
-__global__ void topKStage2Sampling(SizeType32 const* __restrict topKTmpIdBuf, T* topKTmpValBuf, TokenIdType** idsPtrs,
-    TokenIdType* ids, SizeType32* sequenceLengths, FinishedState const* finishedInput, FinishedState* finishedOutput,
-    float* cumLogProbs, float* outputLogProbs, SizeType32 maxTopK, SizeType32 const* topKs, float topP,
-    float const* topPs, curandState_t* curandState, TokenIdType const* endIds, SizeType32 vocabSize,
-    bool const* skipDecode, SizeType32 const* batchSlots, SizeType32 maxBatchSize, bool normalizeLogProbs,
-    bool logitHasProbs, SizeType32 const* tokensPerStep, SizeType32 maxTokensPerStep, SizeType32 maxSeqLen,
-    bool returnAllTopK)
+__global__ void topKStage2Sampling(SizeType32 const* __restrict topKTmpIdBuf, T* topKTmpValBuf,
+    float const* logSumExpBuf, TokenIdType** idsPtrs, TokenIdType* ids, SizeType32* sequenceLengths,
+    FinishedState const* finishedInput, FinishedState* finishedOutput, float* cumLogProbs, float* outputLogProbs,
+    float* outputTopLogProbs, TokenIdType* outputTopLogProbIds, SizeType32 numTopLogProbs, SizeType32 maxTopK,
+    SizeType32 const* topKs, float topP, float const* topPs, curandState_t* curandState, uint64_t const* randomSeeds,
+    TokenIdType const* endIds, SizeType32 vocabSize, bool const* skipDecode, SizeType32 const* batchSlots,
+    SizeType32 maxBatchSize, bool normalizeLogProbs, bool logitHasProbs, SizeType32 const* tokensPerStep,
+    SizeType32 maxTokensPerStep, SizeType32 maxSeqLen, bool returnAllTopK)
 {
     bool const IS_FP16 = std::is_same<T, half>::value;
     T const MAX_T_VAL = (IS_FP16) ? HALF_FLT_MAX : FLT_MAX;
@@ -158,8 +205,9 @@ __global__ void topKStage2Sampling(SizeType32 const* __restrict topKTmpIdBuf, T*
     }
 
     auto const k = (topKs != nullptr) ? topKs[batchSlot] : maxTopK;
+    auto const numCandidates = getNumCandidates(k, numTopLogProbs);
     auto const probThreshold = (topPs != nullptr) ? topPs[batchSlot] : topP;
-    auto const size = k * BLOCKS_PER_BEAM_;
+    auto const size = numCandidates * BLOCKS_PER_BEAM_;
     auto const stride = maxTopK * BLOCKS_PER_BEAM_;
 
     typedef cub::BlockReduce<TopK_2<float>, BLOCK_SIZE_> BlockReduce;
@@ -183,9 +231,23 @@ __global__ void topKStage2Sampling(SizeType32 const* __restrict topKTmpIdBuf, T*
         return;
     }
 
+    auto const outputIdx = (sequenceLengths == nullptr ? 0 : sequenceLengths[batchSlot]) * maxBatchSize + batchSlot;
+    // log P(i | i is in vocab) = logit - logSumExp, combined from the max and sum of the blocks of the first stage
+    float logSumExp{0.f};
+    if (logSumExpBuf != nullptr && tid == 0)
+    {
+        auto const* requestLogSumExp = logSumExpBuf + (batchIdx * maxTokensPerStep + tokenIdx) * BLOCKS_PER_BEAM_ * 2;
+        LogSumExp total{-FLT_MAX, 0.f};
+        for (SizeType32 bi = 0; bi < BLOCKS_PER_BEAM_; ++bi)
+        {
+            total = reduceLogSumExpOp(total, {requestLogSumExp[2 * bi], requestLogSumExp[2 * bi + 1]});
+        }
+        logSumExp = total.max + __logf(total.sum);
+    }
+
     auto sVal2 = reinterpret_cast<float*>(sId + k);
     float maxLogit;
-    for (SizeType32 ite = 0; ite < k; ite++)
+    for (SizeType32 ite = 0; ite < numCandidates; ite++)
     {
         partial.init();
 #pragma unroll
@@ -202,24 +264,40 @@ __global__ void topKStage2Sampling(SizeType32 const* __restrict topKTmpIdBuf, T*
             {
                 maxLogit = total.u;
             }
-            sId[ite] = total.p;
             sVal[total.p] = -MAX_T_VAL;
 
+            if (outputTopLogProbs != nullptr && ite < numTopLogProbs)
+            {
+                auto const index = outputIdx * numTopLogProbs + ite;
+                outputTopLogProbs[index] = logitHasProbs ? logf(total.u) : total.u - logSumExp;
+                outputTopLogProbIds[index] = total.p != -1
+                    ? topKTmpIdBuf[(batchIdx * maxTokensPerStep + tokenIdx) * stride + total.p] % vocabSize
+                    : vocabSize - 1;
+            }
+
             // when cumLogProbs are computed, topKTmpValBuf (logits_buf_) are
             // already pre-processed by softmax_kernel
             if (!logitHasProbs)
             {
                 total.u = __expf(total.u - maxLogit);
             }
-            sVal2[ite] = total.u;
-            sSum += total.u;
+            // Only the top k candidates are sampled from
+            if (ite < k)
+            {
+                sId[ite] = total.p;
+                sVal2[ite] = total.u;
+                sSum += total.u;
+            }
         }
         __syncthreads();
     }
 
     if (tid == 0)
     {
-        auto randNum = static_cast<float>(curand_uniform(curandState + batchSlot) * probThreshold * sSum);
+        auto const step = (sequenceLengths == nullptr ? 0 : sequenceLengths[batchSlot]) + tokenIdx;
+        auto const uniform = randomSeeds != nullptr ? getPhiloxUniform(randomSeeds[batchSlot], step)
+                                                    : curand_uniform(curandState + batchSlot);
+        auto randNum = static_cast<float>(uniform * probThreshold * sSum);
         auto* outputIdsRequestPtr = idsPtrs == nullptr ? ids + batchSlot * maxSeqLen : idsPtrs[batchSlot];
         for (SizeType32 ki = 0; ki < k; ki++)
         {
@@ -241,7 +319,10 @@ __global__ void topKStage2Sampling(SizeType32 const* __restrict topKTmpIdBuf, T*
                 {
                     if (cumLogProbs != nullptr || outputLogProbs != nullptr)
                     {
-                        auto logProb = logf(expLogit);
+                        auto const logExpLogit = logf(expLogit);
+                        // Without probs the log-sum-exp of the first stage turns the logit into a log prob
+                        auto const logProb
+                            = logSumExpBuf != nullptr ? logExpLogit + maxLogit - logSumExp : logExpLogit;
                         if (cumLogProbs != nullptr)
                         {
                             cumLogProbs[batchSlot] += logProb;
@@ -254,7 +335,7 @@ __global__ void topKStage2Sampling(SizeType32 const* __restrict topKTmpIdBuf, T*
                             // normalized:
                             // log_prob = log P(i | i is in top-k) = log(expLogit / sum)
                             outputLogProbs[curSeqLen * maxBatchSize + batchSlot]
-                                = normalizeLogProbs ? logProb - logf(sSum) : logProb;
+                                = normalizeLogProbs ? logExpLogit - logf(sSum) : logProb;
                         }
                     }
                     break;
@@ -287,19 +368,20 @@ __global__ void topKStage2Sampling(SizeType32 const* __restrict topKTmpIdBuf, T*
             dim3 grid(params.batchSize* BLOCKS_PER_BEAM_, params.maxTokensPerStep);                                    \
             dim3 block(BLOCK_SIZE_1_);                                                                                 \
             topKStage1<T, BLOCK_SIZE_1_, BLOCKS_PER_BEAM_><<<grid, block, 0, stream>>>(params.logProbs,                \
-                params.logProbsPtrs, tempLogProbs, topKTmpIdBuf, topKTmpValBuf, params.finishedInput, params.maxTopK,  \
-                params.topKs, params.vocabSizePadded, params.endIds, params.skipDecode, params.batchSlots,             \
-                params.tokensPerStep, params.maxTokensPerStep);                                                        \
+                params.logProbsPtrs, tempLogProbs, topKTmpIdBuf, topKTmpValBuf, logSumExpBuf, params.finishedInput,    \
+                params.maxTopK, params.topKs, numTopLogProbs, params.vocabSizePadded, params.endIds,                   \
+                params.skipDecode, params.batchSlots, params.tokensPerStep, params.maxTokensPerStep);                  \
         }                                                                                                              \
         {                                                                                                              \
             dim3 grid(params.batchSize, params.maxTokensPerStep);                                                      \
             dim3 block(BLOCK_SIZE_2_);                                                                                 \
             topKStage2Sampling<T, BLOCK_SIZE_2_, BLOCKS_PER_BEAM_>                                                     \
                 <<<grid, block, K_MAX * sizeof(SizeType32) + K_MAX * sizeof(float), stream>>>(topKTmpIdBuf,            \
-                    topKTmpValBuf, params.outputIdsPtrs, params.outputIds, params.sequenceLengths,                     \
+                    topKTmpValBuf, logSumExpBuf, params.outputIdsPtrs, params.outputIds, params.sequenceLengths,       \
                     params.finishedInput, params.finishedOutput, params.cumLogProbs, params.outputLogProbs,            \
-                    params.maxTopK, params.topKs, params.maxTopP, params.topPs, params.curandState, params.endIds,     \
-                    params.vocabSizePadded, params.skipDecode, params.batchSlots, params.maxBatchSize,                 \
+                    params.outputTopLogProbs, params.outputTopLogProbIds, numTopLogProbs, params.maxTopK,              \
+                    params.topKs, params.maxTopP, params.topPs, params.curandState, params.randomSeeds,                \
+                    params.endIds, params.vocabSizePadded, params.skipDecode, params.batchSlots, params.maxBatchSize,  \
                     params.normalizeLogProbs, params.logitsHasProbs, params.tokensPerStep, params.maxTokensPerStep,    \
                     params.maxSeqLen, params.returnAllTopK);                                                           \
         }                                                                                                              \
@@ -327,6 +409,11 @@ void invokeBatchTopKSampling(TopKSamplingKernelParams<T> const& params, cudaStre
     auto tempLogProbs = static_cast<T*>(alignedPointers[0]);
     auto topKTmpIdBuf = static_cast<SizeType32*>(alignedPointers[1]);
     auto topKTmpValBuf = static_cast<T*>(alignedPointers[2]);
+    // Log probs need the log-sum-exp of the logits when they are not already probabilities
+    auto const returnLogProbs = params.cumLogProbs != nullptr || params.outputLogProbs != nullptr
+        || params.outputTopLogProbs != nullptr;
+    auto logSumExpBuf = returnLogProbs && !params.logitsHasProbs ? static_cast<float*>(alignedPointers[3]) : nullptr;
+    auto const numTopLogProbs = params.outputTopLogProbs != nullptr ? params.numTopLogProbs : 0;
 
     SizeType32 logMaxTopK{0};
     SizeType32 recursor{params.maxTopK - 1};
@@ -86,9 +86,19 @@ struct TopKSamplingKernelParams
     //! i.e., log_prob = log P(i | i is in top-k) = log(expLogit / s_sum).
     //! Ignored if nullptr.
     float* outputLogProbs{nullptr};
-
-    //! input buffer [maxBatchSize]. Initialized curand states
+    //! output buffer [maxSeqLen, maxBatchSize, numTopLogProbs], optional. Log probabilities log P(i | i is in vocab)
+    //! of the numTopLogProbs most probable tokens at each step, in decreasing order. Ignored if nullptr.
+    float* outputTopLogProbs{nullptr};
+    //! output buffer [maxSeqLen, maxBatchSize, numTopLogProbs], optional. Ids of the tokens of outputTopLogProbs.
+    runtime::TokenIdType* outputTopLogProbIds{nullptr};
+    //! number of alternatives returned in outputTopLogProbs, must not exceed maxTopK
+    runtime::SizeType32 numTopLogProbs{0};
+
+    //! input buffer [maxBatchSize], optional. Initialized curand states. Ignored if randomSeeds is set
     curandState_t* curandState{nullptr};
+    //! input buffer [maxBatchSize], optional. Random seeds per request. If set, random numbers are drawn from the
+    //! counter-based Philox generator keyed by the seed and the sequence length, and no curand states are needed
+    uint64_t const* randomSeeds{nullptr};
     //! input buffer [maxBatchSize]. K for topK sampling per request.
     //! Supported K is in range [1; 1024]. Where K=1 is greedy search.
     //! If nullptr maxTopK is used for all requests.
@@ -109,7 +119,9 @@ struct TopKSamplingKernelParams
 
     //! when set to True outputLogProbs are normalized to TopK
     bool normalizeLogProbs{false};
-    //! flag to highlight that logProbs contains probabilities
+    //! flag to highlight that logProbs contains probabilities.
+    //! If false, log probs are computed from the logits with a log-sum-exp fused into the top-K selection,
+    //! so that the full vocab softmax does not have to be computed beforehand
     bool logitsHasProbs{false};
     //! flag to return all selectedTopK results
     bool returnAllTopK{false};
@@ -136,14 +148,19 @@ struct TopKSamplingKernelParams
         }
 
         TLLM_CHECK(workspace);
-        TLLM_CHECK(curandState);
+        TLLM_CHECK(curandState || randomSeeds);
 
         TLLM_CHECK(maxTokensPerStep != 1 || returnAllTopK || sequenceLengths);
         TLLM_CHECK(maxTokensPerStep != 1 || returnAllTopK || endIds);
-        if (cumLogProbs != nullptr || outputLogProbs != nullptr)
+        if (cumLogProbs != nullptr || outputLogProbs != nullptr || outputTopLogProbs != nullptr)
         {
             TLLM_CHECK(maxTokensPerStep == 1 && !returnAllTopK);
         }
+        if (outputTopLogProbs != nullptr)
+        {
+            TLLM_CHECK(outputTopLogProbIds);
+            TLLM_CHECK(0 < numTopLogProbs && numTopLogProbs <= maxTopK);
+        }
         TLLM_CHECK(((finishedOutput == nullptr) ^ (endIds == nullptr)) == 0);
 
         TLLM_CHECK(0 < maxTopP && maxTopP <= 1.f);
@@ -170,8 +187,10 @@ template <typename T>
     auto const topKTmpIdsBufSize
         = sizeof(runtime::SizeType32) * batchSize * maxTokensPerStep * maxTopK * maxBlockPerBeam;        // type int
     auto const topKTmpValBufSize = sizeof(T) * batchSize * maxTokensPerStep * maxTopK * maxBlockPerBeam; // type T
+    // max and sum of exp of the logits per block
+    auto const logSumExpBufSize = sizeof(float) * batchSize * maxTokensPerStep * maxBlockPerBeam * 2;    // type float
 
-    return {tempLogProbsBufSize, topKTmpIdsBufSize, topKTmpValBufSize};
+    return {tempLogProbsBufSize, topKTmpIdsBufSize, topKTmpValBufSize, logSumExpBufSize};
 }
 
 //! \brief Returns workspace size in bytes needed for sampling TopK computation
@@ -0,0 +1,474 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CUDART_VERSION
+#error CUDART_VERSION Undefined!
+#elif (CUDART_VERSION >= 11050)
+#include <cub/cub.cuh>
+#else
+#include "3rdparty/cub/cub.cuh"
+#endif
+
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/memoryUtils.h"
+#include "tensorrt_llm/common/reduceKernelUtils.cuh"
+#include "tensorrt_llm/kernels/samplingVocabParallelKernels.h"
+
+#include <float.h>
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+//! Number of vocab entries of the shard handled by one block of the first pass.
+SizeType32 constexpr kVOCAB_SHARD_CHUNK_SIZE = 4096;
+
+__device__ bool skipRequest(bool const* skipDecode, FinishedState const* finished, SizeType32 batchSlot)
+{
+    FinishedState const finishState = finished != nullptr ? finished[batchSlot] : FinishedState::empty();
+    return (skipDecode != nullptr && skipDecode[batchSlot]) || finishState.isSkipDecoding();
+}
+
+//! Selects the top k of numGroups groups of k candidates each, the groups being stride apart. The selected
+//! candidates are overwritten with -FLT_MAX in vals.
+template <SizeType32 BLOCK_SIZE>
+__device__ void selectTopKCandidates(float* vals, SizeType32 const* ids, SizeType32 numGroups, SizeType32 stride,
+    SizeType32 k, float* outVals, SizeType32* outIds)
+{
+    typedef cub::BlockReduce<TopK_2<float>, BLOCK_SIZE> BlockReduce;
+    __shared__ typename BlockReduce::TempStorage tempStorage;
+
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+    for (SizeType32 ite = 0; ite < k; ite++)
+    {
+        TopK_2<float> partial;
+        for (SizeType32 i = tid; i < numGroups * k; i += BLOCK_SIZE)
+        {
+            auto const candidateIdx = (i / k) * stride + i % k;
+            partial.insert(vals[candidateIdx], candidateIdx);
+        }
+
+        TopK_2<float> total = BlockReduce(tempStorage).Reduce(partial, reduce_topk_op_2<float>);
+
+        if (tid == 0)
+        {
+            outIds[ite] = total.p >= 0 ? ids[total.p] : -1;
+            outVals[ite] = total.u;
+            if (total.p >= 0)
+            {
+                vals[total.p] = -FLT_MAX;
+            }
+        }
+        __syncthreads();
+    }
+}
+
+//! Selects the top K of the chunk logits in sLogits and computes max and sum of exp of the chunk. The logits are
+//! overwritten.
+template <SizeType32 BLOCK_SIZE>
+__device__ void chunkTopK(float* sLogits, SizeType32 chunkSize, SizeType32 k, SizeType32 maxTopK, SizeType32 idOffset,
+    SizeType32 chunkIdx, SizeType32 numChunks, SizeType32* topKTmpIdBuf, float* topKTmpValBuf, float* chunkMaxBuf,
+    float* chunkSumBuf)
+{
+    typedef cub::BlockReduce<TopK_2<float>, BLOCK_SIZE> BlockReduce;
+    __shared__ typename BlockReduce::TempStorage tempStorage;
+    __shared__ float sMaxLogit;
+
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.y);
+
+    float localMax = -FLT_MAX;
+    for (auto localIdx = tid; localIdx < chunkSize; localIdx += BLOCK_SIZE)
+    {
+        localMax = max(localMax, sLogits[localIdx]);
+    }
+    localMax = blockReduceMax<float>(localMax);
+    if (tid == 0)
+    {
+        sMaxLogit = localMax;
+    }
+    __syncthreads();
+
+    float localSum = 0.0f;
+    for (auto localIdx = tid; localIdx < chunkSize; localIdx += BLOCK_SIZE)
+    {
+        localSum += __expf(sLogits[localIdx] - sMaxLogit);
+    }
+    localSum = blockReduceSum<float>(localSum);
+    if (tid == 0)
+    {
+        chunkMaxBuf[batchIdx * numChunks + chunkIdx] = sMaxLogit;
+        chunkSumBuf[batchIdx * numChunks + chunkIdx] = localSum;
+    }
+
+    auto const tmpTopKBufIndex = (batchIdx * numChunks + chunkIdx) * maxTopK;
+    for (SizeType32 ite = 0; ite < k; ite++)
+    {
+        TopK_2<float> partial;
+        for (auto localIdx = tid; localIdx < chunkSize; localIdx += BLOCK_SIZE)
+        {
+            partial.insert(sLogits[localIdx], localIdx);
+        }
+
+        TopK_2<float> total = BlockReduce(tempStorage).Reduce(partial, reduce_topk_op_2<float>);
+
+        if (tid == 0)
+        {
+            topKTmpIdBuf[tmpTopKBufIndex + ite] = total.p >= 0 ? idOffset + total.p : -1;
+            topKTmpValBuf[tmpTopKBufIndex + ite] = total.u;
+            if (total.p >= 0)
+            {
+                sLogits[total.p] = -FLT_MAX;
+            }
+        }
+        __syncthreads();
+    }
+}
+
+//! Selects the top K of one chunk of the shard of one request and computes max and sum of exp of the chunk.
+template <typename T, SizeType32 BLOCK_SIZE>
+__global__ void vocabShardChunkTopK(VocabParallelSamplingParams<T> const params, SizeType32* topKTmpIdBuf,
+    float* topKTmpValBuf, float* chunkMaxBuf, float* chunkSumBuf)
+{
+    __shared__ float sLogits[kVOCAB_SHARD_CHUNK_SIZE];
+
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+    auto const chunkIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const numChunks = static_cast<SizeType32>(gridDim.x);
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.y);
+    auto const batchSlot = params.batchSlots == nullptr ? batchIdx : params.batchSlots[batchIdx];
+    if (skipRequest(params.skipDecode, params.finishedInput, batchSlot))
+    {
+        return;
+    }
+    auto const k = params.topKs != nullptr ? params.topKs[batchSlot] : params.maxTopK;
+
+    auto const chunkBegin = chunkIdx * kVOCAB_SHARD_CHUNK_SIZE;
+    auto const chunkSize = min(kVOCAB_SHARD_CHUNK_SIZE, params.shardVocabSize - chunkBegin);
+    auto const* logits = params.logitsShard + batchIdx * params.shardVocabSizePadded + chunkBegin;
+
+    for (auto localIdx = tid; localIdx < chunkSize; localIdx += BLOCK_SIZE)
+    {
+        sLogits[localIdx] = static_cast<float>(logits[localIdx]);
+    }
+    __syncthreads();
+
+    chunkTopK<BLOCK_SIZE>(sLogits, chunkSize, k, params.maxTopK, params.shardVocabOffset + chunkBegin, chunkIdx,
+        numChunks, topKTmpIdBuf, topKTmpValBuf, chunkMaxBuf, chunkSumBuf);
+}
+
+//! Computes the logits of one chunk of the shard of one request with the LM head, without writing them to global
+//! memory, then selects their top K like vocabShardChunkTopK. Every warp computes the dot products of its rows of
+//! the LM head weight with the hidden state of the request.
+template <typename T, SizeType32 BLOCK_SIZE>
+__global__ void lmHeadChunkTopK(VocabParallelSamplingParams<T> const params, SizeType32* topKTmpIdBuf,
+    float* topKTmpValBuf, float* chunkMaxBuf, float* chunkSumBuf)
+{
+    __shared__ float sLogits[kVOCAB_SHARD_CHUNK_SIZE];
+
+    auto const chunkIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const numChunks = static_cast<SizeType32>(gridDim.x);
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.y);
+    auto const batchSlot = params.batchSlots == nullptr ? batchIdx : params.batchSlots[batchIdx];
+    if (skipRequest(params.skipDecode, params.finishedInput, batchSlot))
+    {
+        return;
+    }
+    auto const k = params.topKs != nullptr ? params.topKs[batchSlot] : params.maxTopK;
+
+    auto const chunkBegin = chunkIdx * kVOCAB_SHARD_CHUNK_SIZE;
+    auto const chunkSize = min(kVOCAB_SHARD_CHUNK_SIZE, params.shardVocabSize - chunkBegin);
+    auto const hiddenSize = params.hiddenSize;
+    auto const* hidden = params.hiddenStates + static_cast<std::int64_t>(batchIdx) * hiddenSize;
+    auto const* weight = params.lmHeadWeight + static_cast<std::int64_t>(chunkBegin) * hiddenSize;
+
+    SizeType32 constexpr kNumWarps = BLOCK_SIZE / 32;
+    auto const warpIdx = static_cast<SizeType32>(threadIdx.x) / 32;
+    auto const laneIdx = static_cast<SizeType32>(threadIdx.x) % 32;
+    for (auto localIdx = warpIdx; localIdx < chunkSize; localIdx += kNumWarps)
+    {
+        auto const* weightRow = weight + static_cast<std::int64_t>(localIdx) * hiddenSize;
+        float acc = 0.0f;
+        for (auto h = laneIdx; h < hiddenSize; h += 32)
+        {
+            acc += static_cast<float>(weightRow[h]) * static_cast<float>(hidden[h]);
+        }
+        acc = warpReduceSum(acc);
+        if (laneIdx == 0)
+        {
+            sLogits[localIdx] = acc;
+        }
+    }
+    __syncthreads();
+
+    chunkTopK<BLOCK_SIZE>(sLogits, chunkSize, k, params.maxTopK, params.shardVocabOffset + chunkBegin, chunkIdx,
+        numChunks, topKTmpIdBuf, topKTmpValBuf, chunkMaxBuf, chunkSumBuf);
+}
+
+//! Merges the top K and the softmax statistics of all chunks of the shard of one request into its summary.
+template <typename T, SizeType32 BLOCK_SIZE>
+__global__ void vocabShardSummary(VocabParallelSamplingParams<T> const params, SizeType32 const* topKTmpIdBuf,
+    float* topKTmpValBuf, float const* chunkMaxBuf, float const* chunkSumBuf, SizeType32 numChunks)
+{
+    __shared__ float sMaxLogit;
+
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = params.batchSlots == nullptr ? batchIdx : params.batchSlots[batchIdx];
+    if (skipRequest(params.skipDecode, params.finishedInput, batchSlot))
+    {
+        return;
+    }
+    auto const k = params.topKs != nullptr ? params.topKs[batchSlot] : params.maxTopK;
+    auto* summary = params.shardSummary + batchIdx * getVocabShardSummarySize(params.maxTopK);
+
+    float localMax = -FLT_MAX;
+    for (auto chunkIdx = tid; chunkIdx < numChunks; chunkIdx += BLOCK_SIZE)
+    {
+        localMax = max(localMax, chunkMaxBuf[batchIdx * numChunks + chunkIdx]);
+    }
+    localMax = blockReduceMax<float>(localMax);
+    if (tid == 0)
+    {
+        sMaxLogit = localMax;
+    }
+    __syncthreads();
+
+    float localSum = 0.0f;
+    for (auto chunkIdx = tid; chunkIdx < numChunks; chunkIdx += BLOCK_SIZE)
+    {
+        auto const index = batchIdx * numChunks + chunkIdx;
+        localSum += chunkSumBuf[index] * __expf(chunkMaxBuf[index] - sMaxLogit);
+    }
+    localSum = blockReduceSum<float>(localSum);
+    if (tid == 0)
+    {
+        summary[2 * params.maxTopK] = sMaxLogit;
+        summary[2 * params.maxTopK + 1] = localSum;
+    }
+
+    auto const offset = batchIdx * numChunks * params.maxTopK;
+    selectTopKCandidates<BLOCK_SIZE>(topKTmpValBuf + offset, topKTmpIdBuf + offset, numChunks, params.maxTopK, k,
+        summary, reinterpret_cast<SizeType32*>(summary + params.maxTopK));
+}
+
+//! Samples from the top K of the summaries of all ranks, like topKStage2Sampling.
+template <typename T, SizeType32 BLOCK_SIZE>
+__global__ void vocabParallelSampling(VocabParallelSamplingParams<T> const params)
+{
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = params.batchSlots == nullptr ? batchIdx : params.batchSlots[batchIdx];
+    if (skipRequest(params.skipDecode, params.finishedInput, batchSlot))
+    {
+        return;
+    }
+    FinishedState const finishState
+        = params.finishedInput != nullptr ? params.finishedInput[batchSlot] : FinishedState::empty();
+    if (finishState.isFinished())
+    {
+        if (tid == 0 && params.finishedOutput != nullptr)
+        {
+            params.finishedOutput[batchSlot] = finishState;
+        }
+        return;
+    }
+
+    auto const k = params.topKs != nullptr ? params.topKs[batchSlot] : params.maxTopK;
+    auto const probThreshold = params.topPs != nullptr ? params.topPs[batchSlot] : params.maxTopP;
+    auto const summarySize = getVocabShardSummarySize(params.maxTopK);
+    auto const rankStride = params.batchSize * summarySize;
+    auto* summaries = params.gatheredSummaries + batchIdx * summarySize;
+
+    extern __shared__ char array[];
+    auto* sId = reinterpret_cast<SizeType32*>(array);
+    auto* sVal = reinterpret_cast<float*>(sId + k);
+
+    selectTopKCandidates<BLOCK_SIZE>(summaries, reinterpret_cast<SizeType32 const*>(summaries + params.maxTopK),
+        params.tpSize, rankStride, k, sVal, sId);
+
+    if (tid == 0)
+    {
+        // Softmax statistics of the full vocab from the statistics of the shards.
+        float maxLogit = -FLT_MAX;
+        for (SizeType32 rank = 0; rank < params.tpSize; ++rank)
+        {
+            maxLogit = max(maxLogit, summaries[rank * rankStride + 2 * params.maxTopK]);
+        }
+        float sumExp = 0.0f;
+        for (SizeType32 rank = 0; rank < params.tpSize; ++rank)
+        {
+            auto const* rankStats = summaries + rank * rankStride + 2 * params.maxTopK;
+            sumExp += rankStats[1] * __expf(rankStats[0] - maxLogit);
+        }
+        auto const logSumExp = maxLogit + logf(sumExp);
+
+        float sSum = 0.0f;
+        for (SizeType32 ki = 0; ki < k; ki++)
+        {
+            sSum += sId[ki] >= 0 ? __expf(sVal[ki] - sVal[0]) : 0.0f;
+        }
+
+        auto randNum = static_cast<float>(curand_uniform(params.curandState + batchSlot) * probThreshold * sSum);
+        auto* outputIdsRequestPtr = params.outputIdsPtrs[batchSlot];
+        auto const curSeqLen = params.sequenceLengths[batchSlot];
+        for (SizeType32 ki = 0; ki < k; ki++)
+        {
+            auto const expLogit = sId[ki] >= 0 ? __expf(sVal[ki] - sVal[0]) : 0.0f;
+            randNum = randNum - expLogit;
+            if (randNum <= 0.0f || ki == k - 1)
+            {
+                // If the id is -1 here we force output token to the last from vocabulary to get vivid indicator of
+                // smth going wrong for the debug
+                auto const outputId = sId[ki] != -1 ? sId[ki] : params.tpSize * params.shardVocabSize - 1;
+                outputIdsRequestPtr[curSeqLen] = outputId;
+                if (params.cumLogProbs != nullptr || params.outputLogProbs != nullptr)
+                {
+                    auto const logProb = params.normalizeLogProbs ? logf(expLogit) - logf(sSum) : sVal[ki] - logSumExp;
+                    if (params.cumLogProbs != nullptr)
+                    {
+                        params.cumLogProbs[batchSlot] += logProb;
+                    }
+                    if (params.outputLogProbs != nullptr)
+                    {
+                        params.outputLogProbs[curSeqLen * params.maxBatchSize + batchSlot] = logProb;
+                    }
+                }
+                break;
+            }
+        }
+        if (params.finishedOutput != nullptr)
+        {
+            if (outputIdsRequestPtr[curSeqLen] == params.endIds[batchSlot])
+            {
+                params.finishedOutput[batchSlot].setFinishedEOS();
+                // Do not increase seq len when EOS is generated. Seq len should always contain only tokens to be
+                // outputted
+            }
+            else
+            {
+                params.sequenceLengths[batchSlot] += 1;
+            }
+        }
+    }
+}
+
+std::vector<size_t> getVocabShardSummaryWorkspaceSizes(
+    SizeType32 batchSize, SizeType32 maxTopK, SizeType32 shardVocabSize)
+{
+    auto const numChunks = divUp(shardVocabSize, kVOCAB_SHARD_CHUNK_SIZE);
+    auto const numCandidates = static_cast<size_t>(batchSize) * numChunks * maxTopK;
+    auto const numChunkStats = static_cast<size_t>(batchSize) * numChunks;
+    return {sizeof(SizeType32) * numCandidates, sizeof(float) * numCandidates, sizeof(float) * numChunkStats,
+        sizeof(float) * numChunkStats};
+}
+
+SizeType32 constexpr kSUMMARY_BLOCK_SIZE = 256;
+
+template <typename T>
+using ChunkTopKKernel = void (*)(VocabParallelSamplingParams<T> const, SizeType32*, float*, float*, float*);
+
+//! Runs chunkKernel over all chunks of the shard and merges the chunks into the summaries.
+template <typename T>
+void launchVocabShardSummary(
+    VocabParallelSamplingParams<T> const& params, ChunkTopKKernel<T> chunkKernel, cudaStream_t stream)
+{
+    TLLM_CHECK(params.shardSummary);
+    TLLM_CHECK(params.workspace);
+    TLLM_CHECK(0 < params.shardVocabSize && params.shardVocabSize <= params.shardVocabSizePadded);
+
+    auto const workspaceSizes
+        = getVocabShardSummaryWorkspaceSizes(params.batchSize, params.maxTopK, params.shardVocabSize);
+    std::vector<void*> alignedPointers;
+    calcAlignedPointers(alignedPointers, params.workspace, workspaceSizes);
+    auto topKTmpIdBuf = static_cast<SizeType32*>(alignedPointers[0]);
+    auto topKTmpValBuf = static_cast<float*>(alignedPointers[1]);
+    auto chunkMaxBuf = static_cast<float*>(alignedPointers[2]);
+    auto chunkSumBuf = static_cast<float*>(alignedPointers[3]);
+
+    auto const numChunks = divUp(params.shardVocabSize, kVOCAB_SHARD_CHUNK_SIZE);
+    dim3 const grid(numChunks, params.batchSize);
+    chunkKernel<<<grid, kSUMMARY_BLOCK_SIZE, 0, stream>>>(
+        params, topKTmpIdBuf, topKTmpValBuf, chunkMaxBuf, chunkSumBuf);
+    vocabShardSummary<T, kSUMMARY_BLOCK_SIZE><<<params.batchSize, kSUMMARY_BLOCK_SIZE, 0, stream>>>(
+        params, topKTmpIdBuf, topKTmpValBuf, chunkMaxBuf, chunkSumBuf, numChunks);
+    sync_check_cuda_error();
+}
+
+} // namespace
+
+size_t getVocabShardSummaryWorkspaceSize(SizeType32 batchSize, SizeType32 maxTopK, SizeType32 shardVocabSize)
+{
+    return calcAlignedSize(getVocabShardSummaryWorkspaceSizes(batchSize, maxTopK, shardVocabSize), 256);
+}
+
+template <typename T>
+void invokeVocabShardSummary(VocabParallelSamplingParams<T> const& params, cudaStream_t stream)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    params.checkParams();
+    TLLM_CHECK(params.logitsShard);
+    launchVocabShardSummary<T>(params, vocabShardChunkTopK<T, kSUMMARY_BLOCK_SIZE>, stream);
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template void invokeVocabShardSummary(VocabParallelSamplingParams<float> const& params, cudaStream_t stream);
+template void invokeVocabShardSummary(VocabParallelSamplingParams<half> const& params, cudaStream_t stream);
+
+template <typename T>
+void invokeLmHeadShardSummary(VocabParallelSamplingParams<T> const& params, cudaStream_t stream)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    params.checkParams();
+    TLLM_CHECK(params.hiddenStates);
+    TLLM_CHECK(params.lmHeadWeight);
+    TLLM_CHECK(params.hiddenSize > 0);
+    launchVocabShardSummary<T>(params, lmHeadChunkTopK<T, kSUMMARY_BLOCK_SIZE>, stream);
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template void invokeLmHeadShardSummary(VocabParallelSamplingParams<float> const& params, cudaStream_t stream);
+template void invokeLmHeadShardSummary(VocabParallelSamplingParams<half> const& params, cudaStream_t stream);
+
+template <typename T>
+void invokeVocabParallelSampling(VocabParallelSamplingParams<T> const& params, cudaStream_t stream)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    params.checkParams();
+    TLLM_CHECK(params.gatheredSummaries);
+    TLLM_CHECK(params.outputIdsPtrs);
+    TLLM_CHECK(params.sequenceLengths);
+    TLLM_CHECK(params.curandState);
+
+    SizeType32 constexpr kBlockSize = 256;
+    auto const smemSize = params.maxTopK * (sizeof(SizeType32) + sizeof(float));
+    vocabParallelSampling<T, kBlockSize><<<params.batchSize, kBlockSize, smemSize, stream>>>(params);
+    sync_check_cuda_error();
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template void invokeVocabParallelSampling(VocabParallelSamplingParams<float> const& params, cudaStream_t stream);
+template void invokeVocabParallelSampling(VocabParallelSamplingParams<half> const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/samplingTopKKernels.h"
+#include "tensorrt_llm/runtime/common.h"
+#include <curand_kernel.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+//! \brief Number of floats of the summary of the vocab shard of one request: the top maxTopK logits, their token ids
+//! (stored as the bits of int32), and the max and sum of exp(logit - max) of the shard.
+[[nodiscard]] constexpr runtime::SizeType32 getVocabShardSummarySize(runtime::SizeType32 maxTopK)
+{
+    return 2 * maxTopK + 2;
+}
+
+template <typename T>
+struct VocabParallelSamplingParams
+{
+    //! input buffer [batchSize, shardVocabSizePadded]. Logits of the vocab shard of this rank. Logits processing such
+    //! as penalties is elementwise over the vocab and has to be applied to the shards beforehand.
+    T const* logitsShard{nullptr};
+    //! input buffer [batchSize, hiddenSize]. Final hidden states, used instead of logitsShard by
+    //! invokeLmHeadShardSummary.
+    T const* hiddenStates{nullptr};
+    //! input buffer [shardVocabSize, hiddenSize]. Rows of the LM head weight of the vocab shard of this rank.
+    T const* lmHeadWeight{nullptr};
+    runtime::SizeType32 hiddenSize{0};
+    //! Id of the first token of the shard and number of tokens in the shard.
+    runtime::SizeType32 shardVocabOffset{0};
+    runtime::SizeType32 shardVocabSize{-1};
+    runtime::SizeType32 shardVocabSizePadded{-1};
+
+    //! output buffer [batchSize, getVocabShardSummarySize(maxTopK)]. Summary of the shard of this rank, to be
+    //! all-gathered over the tensor parallel ranks.
+    float* shardSummary{nullptr};
+    //! input buffer [tpSize, batchSize, getVocabShardSummarySize(maxTopK)]. All-gathered summaries of all ranks,
+    //! overwritten by invokeVocabParallelSampling.
+    float* gatheredSummaries{nullptr};
+    runtime::SizeType32 tpSize{1};
+
+    //! Required by invokeVocabShardSummary, workspace of size returned by getVocabShardSummaryWorkspaceSize.
+    void* workspace{nullptr};
+
+    //! output buffer [maxBatchSize][maxSeqLen]. Pointers to rows with the tokens of each request.
+    runtime::TokenIdType** outputIdsPtrs{nullptr};
+    //! input/output buffer [maxBatchSize]. Current sequence length of each request.
+    runtime::SizeType32* sequenceLengths{nullptr};
+    //! input buffer [maxBatchSize], optional. EOS token ids per request.
+    runtime::TokenIdType const* endIds{nullptr};
+    //! input buffer [batchSize], optional. Indices of rows of data in memory pool.
+    runtime::SizeType32 const* batchSlots{nullptr};
+    //! input buffer [maxBatchSize], optional.
+    FinishedState const* finishedInput{nullptr};
+    //! output buffer [maxBatchSize], optional.
+    FinishedState* finishedOutput{nullptr};
+    //! input buffer [maxBatchSize], optional. Flags whether to skip decoding per request.
+    bool const* skipDecode{nullptr};
+
+    //! input/output buffer [maxBatchSize], optional. Cumulative log probability of selected tokens.
+    float* cumLogProbs{nullptr};
+    //! output buffer [maxSeqLen, maxBatchSize], optional. Log probability of the selected token, over the full vocab,
+    //! or over the top K tokens if normalizeLogProbs is set.
+    float* outputLogProbs{nullptr};
+    //! input buffer [maxBatchSize]. Curand states, initialized with the same seeds on all ranks, so that all ranks
+    //! select the same token without another exchange.
+    curandState_t* curandState{nullptr};
+
+    //! input buffer [maxBatchSize], optional. K per request in range [1; maxTopK]. maxTopK is used if nullptr.
+    runtime::SizeType32 const* topKs{nullptr};
+    //! input buffer [maxBatchSize], optional. P per request, applied to the top K tokens. maxTopP is used if nullptr.
+    float const* topPs{nullptr};
+    runtime::SizeType32 maxTopK{0};
+    float maxTopP{1.0f};
+
+    runtime::SizeType32 batchSize{-1};
+    runtime::SizeType32 maxBatchSize{-1};
+    runtime::SizeType32 maxSeqLen{-1};
+
+    bool normalizeLogProbs{false};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(batchSize > 0);
+        TLLM_CHECK(maxBatchSize >= batchSize);
+        TLLM_CHECK(tpSize > 0);
+        TLLM_CHECK(0 < maxTopK && maxTopK <= TOP_K_MAX);
+        TLLM_CHECK(0 < maxTopP && maxTopP <= 1.f);
+        TLLM_CHECK(((finishedOutput == nullptr) ^ (endIds == nullptr)) == 0);
+    }
+};
+
+//! \brief Returns workspace size in bytes needed by invokeVocabShardSummary.
+[[nodiscard]] size_t getVocabShardSummaryWorkspaceSize(
+    runtime::SizeType32 batchSize, runtime::SizeType32 maxTopK, runtime::SizeType32 shardVocabSize);
+
+// clang-format off
+//! \brief Summarizes the vocab shard of this rank for vocab parallel sampling: its top K logits with their global
+//! token ids and its softmax statistics. Instead of all-gathering the [batchSize, vocabSize] logits, the ranks
+//! all-gather these summaries of getVocabShardSummarySize(maxTopK) floats per request, e.g. with
+//! NcclCommunicator::allGather, and call invokeVocabParallelSampling.
+// clang-format on
+template <typename T>
+void invokeVocabShardSummary(VocabParallelSamplingParams<T> const& params, cudaStream_t stream);
+
+// clang-format off
+//! \brief Same as invokeVocabShardSummary, but computes the logits of the shard from hiddenStates and lmHeadWeight
+//! chunk by chunk in shared memory, so that the [batchSize, shardVocabSize] logits are never written to global
+//! memory. With tpSize 1 the summary is the input of invokeVocabParallelSampling, and maxTopK 1 gives greedy search.
+//! No logits processing, e.g. penalties or bad words, can be applied in between.
+// clang-format on
+template <typename T>
+void invokeLmHeadShardSummary(VocabParallelSamplingParams<T> const& params, cudaStream_t stream);
+
+// clang-format off
+//! \brief Samples from the top K (and top P among them) tokens of the merged summaries of all ranks with the
+//! semantics of invokeBatchTopKSampling, and computes log probs over the full vocab from the softmax statistics.
+//! Computes sequenceLength, finished state and cumLogProbs inplace.
+// clang-format on
+template <typename T>
+void invokeVocabParallelSampling(VocabParallelSamplingParams<T> const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -313,6 +313,192 @@ __launch_bounds__(256, 1) __global__ void selective_scan_loop_kernel(SSMParamsBa
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Chunked context scan. The recurrence h_t = exp(A * dt_t) * h_{t-1} + dt_t * B_t * x_t is linear in h, so a chunk
+// of tokens maps its incoming state h to exp(A * sum(dt)) * h + h_local, where h_local is the state of the chunk when
+// it starts from zero. The scan runs in three passes:
+//   1. every chunk computes h_local and sum(dt) in parallel,
+//   2. one pass per channel walks the chunks in order and turns them into the incoming state of every chunk,
+//   3. every chunk scans its tokens again from its incoming state and writes the outputs, in parallel.
+// This does twice the work of the sequential scan but spreads a long sequence over many blocks.
+
+__device__ inline void getSampleTokens(SSMParamsBase const& params, int sample, int& startToken, int& numTokens)
+{
+    if (params.remove_padding)
+    {
+        startToken = sample == 0 ? 0 : params.last_token_ids_ptr[sample - 1];
+        numTokens = params.last_token_ids_ptr[sample] - startToken;
+    }
+    else
+    {
+        startToken = sample * params.max_seqlen;
+        numTokens = params.last_token_ids_ptr[sample];
+    }
+}
+
+__device__ inline int getFirstChunkIdx(int sample, int startToken)
+{
+    return (startToken + kSelectiveScanChunkSize - 1) / kSelectiveScanChunkSize + sample;
+}
+
+// Scans tokens [begin, end) of a sequence starting at row startToken for one channel, from state.
+// Returns the sum of the time steps. Writes the outputs if WRITE_OUTPUT.
+template <typename input_t, typename weight_t, int DSTATE, bool WRITE_OUTPUT>
+__device__ float scanChunkTokens(SSMParamsBase const& params, int channel, int startToken, int begin, int end,
+    float const (&A)[DSTATE], float (&state)[DSTATE])
+{
+    auto const* x = reinterpret_cast<input_t const*>(params.u_ptr);
+    auto const* dt = reinterpret_cast<input_t const*>(params.delta_ptr);
+    auto const* BC = reinterpret_cast<input_t const*>(params.BC_ptr);
+    auto const* D = reinterpret_cast<weight_t const*>(params.D_ptr);
+    auto const* z = reinterpret_cast<input_t const*>(params.z_ptr);
+    auto const* dtBias = reinterpret_cast<weight_t const*>(params.delta_bias_ptr);
+    auto* output = reinterpret_cast<input_t*>(params.out_ptr);
+    int const numChannels = params.dim;
+    int const bcCols = DSTATE * 2 + params.dt_rank;
+
+    float const dtBiasReg = dtBias ? toFloat(dtBias[channel]) : 0.f;
+    float const DReg = D ? toFloat(D[channel]) : 0.f;
+    float dtSum = 0.f;
+    for (int token = begin; token < end; ++token)
+    {
+        auto const row = static_cast<size_t>(startToken + token);
+        float const dtB = toFloat(dt[row * numChannels + channel]) + dtBiasReg;
+        float const dtSp = params.delta_softplus && dtB <= 20.f ? __logf(1.f + __expf(dtB)) : dtB;
+        float const myX = toFloat(x[row * numChannels + channel]);
+        float const dtx = dtSp * myX;
+        dtSum += dtSp;
+        input_t const* myB = &BC[row * bcCols + params.dt_rank];
+        input_t const* myC = myB + DSTATE;
+        float out = myX * DReg;
+#pragma unroll
+        for (int i = 0; i < DSTATE; ++i)
+        {
+            state[i] = state[i] * __expf(A[i] * dtSp) + toFloat(myB[i]) * dtx;
+            if constexpr (WRITE_OUTPUT)
+            {
+                out += state[i] * toFloat(myC[i]);
+            }
+        }
+        if constexpr (WRITE_OUTPUT)
+        {
+            if (z)
+            {
+                float const myZ = toFloat(z[row * numChannels + channel]);
+                out *= myZ * __fdividef(1.f, 1.f + __expf(-myZ));
+            }
+            convertAndStore(&output[row * numChannels + channel], out);
+        }
+    }
+    return dtSum;
+}
+
+// grid (channel blocks, max chunks, samples)
+template <typename input_t, typename weight_t, int DSTATE, bool WRITE_OUTPUT>
+__launch_bounds__(128) __global__ void selective_scan_chunk_kernel(SSMParamsBase params)
+{
+    int const channel = blockIdx.x * blockDim.x + threadIdx.x;
+    int const chunk = blockIdx.y;
+    int const sample = blockIdx.z;
+    int const numChannels = params.dim;
+    int startToken;
+    int numTokens;
+    getSampleTokens(params, sample, startToken, numTokens);
+    int const begin = chunk * kSelectiveScanChunkSize;
+    if (channel >= numChannels || begin >= numTokens)
+    {
+        return;
+    }
+    int const end = min(begin + kSelectiveScanChunkSize, numTokens);
+
+    auto const* A = reinterpret_cast<weight_t const*>(params.A_ptr);
+    auto* chunkState = reinterpret_cast<float*>(params.chunk_states_ptr)
+        + static_cast<size_t>(getFirstChunkIdx(sample, startToken) + chunk) * (DSTATE + 1) * numChannels;
+    float AReg[DSTATE];
+    float state[DSTATE];
+#pragma unroll
+    for (int i = 0; i < DSTATE; ++i)
+    {
+        AReg[i] = toFloat(A[i * numChannels + channel]);
+        // The output pass starts from the incoming state, the local pass from zero
+        state[i] = WRITE_OUTPUT ? chunkState[i * numChannels + channel] : 0.f;
+    }
+    float const dtSum = scanChunkTokens<input_t, weight_t, DSTATE, WRITE_OUTPUT>(
+        params, channel, startToken, begin, end, AReg, state);
+    if constexpr (!WRITE_OUTPUT)
+    {
+#pragma unroll
+        for (int i = 0; i < DSTATE; ++i)
+        {
+            chunkState[i * numChannels + channel] = state[i];
+        }
+        chunkState[DSTATE * numChannels + channel] = dtSum;
+    }
+}
+
+// grid (channel blocks, samples). Replaces the local state of every chunk with its incoming state and writes the
+// final state to the state cache.
+template <typename input_t, typename weight_t, int DSTATE>
+__launch_bounds__(128) __global__ void selective_scan_chunk_pass_kernel(SSMParamsBase params)
+{
+    int const channel = blockIdx.x * blockDim.x + threadIdx.x;
+    int const sample = blockIdx.y;
+    int const numChannels = params.dim;
+    if (channel >= numChannels)
+    {
+        return;
+    }
+    int startToken;
+    int numTokens;
+    getSampleTokens(params, sample, startToken, numTokens);
+    int const numChunks = (numTokens + kSelectiveScanChunkSize - 1) / kSelectiveScanChunkSize;
+
+    auto const* A = reinterpret_cast<weight_t const*>(params.A_ptr);
+    auto* chunkStates = reinterpret_cast<float*>(params.chunk_states_ptr)
+        + static_cast<size_t>(getFirstChunkIdx(sample, startToken)) * (DSTATE + 1) * numChannels;
+    float AReg[DSTATE];
+    float state[DSTATE];
+#pragma unroll
+    for (int i = 0; i < DSTATE; ++i)
+    {
+        AReg[i] = toFloat(A[i * numChannels + channel]);
+        state[i] = 0.f;
+    }
+    for (int chunk = 0; chunk < numChunks; ++chunk)
+    {
+        auto* chunkState = chunkStates + static_cast<size_t>(chunk) * (DSTATE + 1) * numChannels;
+        float const dtSum = chunkState[DSTATE * numChannels + channel];
+#pragma unroll
+        for (int i = 0; i < DSTATE; ++i)
+        {
+            float const local = chunkState[i * numChannels + channel];
+            chunkState[i * numChannels + channel] = state[i];
+            state[i] = state[i] * __expf(AReg[i] * dtSum) + local;
+        }
+    }
+
+    int const slotIdx = params.slot_mapping_ptr == nullptr ? sample : params.slot_mapping_ptr[sample];
+    auto* cache = reinterpret_cast<input_t*>(params.x_ptr) + static_cast<size_t>(slotIdx) * numChannels * DSTATE;
+#pragma unroll
+    for (int i = 0; i < DSTATE; ++i)
+    {
+        convertAndStore(&cache[i * numChannels + channel], state[i]);
+    }
+}
+
+template <typename input_t, typename weight_t>
+void invokeSelectiveScanChunked(SSMParamsBase& params, cudaStream_t stream)
+{
+    int constexpr DSTATE = 16;
+    int const threads = 128;
+    int const blocks = (params.dim + threads - 1) / threads;
+    dim3 const chunkGrid(blocks, params.max_chunks, params.batch);
+    selective_scan_chunk_kernel<input_t, weight_t, DSTATE, false><<<chunkGrid, threads, 0, stream>>>(params);
+    selective_scan_chunk_pass_kernel<input_t, weight_t, DSTATE>
+        <<<dim3(blocks, params.batch), threads, 0, stream>>>(params);
+    selective_scan_chunk_kernel<input_t, weight_t, DSTATE, true><<<chunkGrid, threads, 0, stream>>>(params);
+}
+
 template <typename input_t, typename weight_t>
 void invokeSelectiveScan(SSMParamsBase& params, cudaStream_t stream)
 {
@@ -328,6 +514,14 @@ void invokeSelectiveScan(SSMParamsBase& params, cudaStream_t stream)
     dim3 block(threads, 2);
     dim3 grid(blocks, samples);
     TLLM_CHECK((channels % block.x) == 0);
+
+    // The sequential scan has one block per channel block and sample, split long sequences when that leaves SMs idle
+    static int const multiProcessorCount = tensorrt_llm::common::getMultiProcessorCount();
+    if (params.chunk_states_ptr != nullptr && params.max_chunks > 1 && blocks * samples < multiProcessorCount)
+    {
+        invokeSelectiveScanChunked<input_t, weight_t>(params, stream);
+        return;
+    }
     selective_scan_loop_kernel<input_t, weight_t><<<grid, block, 0, stream>>>(params);
 }
 
@@ -343,13 +537,13 @@ INSTANTIATE_SELECTIVE_SCAN_DATA_TYPE(__nv_bfloat16, float);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-template <typename input_t, typename weight_t, int DSTATE = 16, int CHANNELS_PER_BLOCK = 128>
-__launch_bounds__(128, 2) __global__ void selective_scan_update_kernel(SSMParamsBase params)
+// Single-token SSM state update of one channel of one sample, given its input x. Writes the new state and the output.
+template <typename input_t, typename weight_t, int DSTATE>
+__device__ __forceinline__ void selectiveScanUpdateChannel(
+    SSMParamsBase const& params, int const sample, int const channel, float const my_x)
 {
-
     input_t* output = reinterpret_cast<input_t*>(params.out_ptr);
     input_t* state = reinterpret_cast<input_t*>(params.x_ptr);
-    input_t* x = reinterpret_cast<input_t*>(params.u_ptr);
     input_t* dt = reinterpret_cast<input_t*>(params.delta_ptr);
     weight_t* A = reinterpret_cast<weight_t*>(params.A_ptr);
     input_t* B = reinterpret_cast<input_t*>(params.BC_ptr);
@@ -360,10 +554,6 @@ __launch_bounds__(128, 2) __global__ void selective_scan_update_kernel(SSMParams
     bool dt_softplus = params.delta_softplus;
     int num_channels = params.dim;
 
-    int const channel = blockIdx.x * blockDim.x + threadIdx.x;
-    if (channel >= num_channels)
-        return;
-    int const sample = blockIdx.y;
     int const slot_idx = params.slot_mapping_ptr == nullptr ? sample : params.slot_mapping_ptr[sample];
     int const bc_cols = DSTATE * 2 + params.dt_rank;
     int const b_offset = params.dt_rank;
@@ -387,8 +577,7 @@ __launch_bounds__(128, 2) __global__ void selective_scan_update_kernel(SSMParams
         rState[i] = toFloat(my_state[i * num_channels + channel]);
     }
 
-    float my_x, my_dt, my_z, my_dt_bias, my_D;
-    my_x = toFloat(x[sample * num_channels + channel]);
+    float my_dt, my_z, my_dt_bias, my_D;
     my_dt = toFloat(dt[sample * num_channels + channel]);
     my_z = z ? toFloat(z[sample * num_channels + channel]) : 0.f;
     my_dt_bias = dt_bias ? toFloat(dt_bias[channel]) : 0.f;
@@ -428,6 +617,138 @@ __launch_bounds__(128, 2) __global__ void selective_scan_update_kernel(SSMParams
     convertAndStore(&my_output[channel], out);
 }
 
+template <typename input_t, typename weight_t, int DSTATE = 16, int CHANNELS_PER_BLOCK = 128>
+__launch_bounds__(128, 2) __global__ void selective_scan_update_kernel(SSMParamsBase params)
+{
+    int const channel = blockIdx.x * blockDim.x + threadIdx.x;
+    if (channel >= params.dim)
+        return;
+    int const sample = blockIdx.y;
+    input_t* x = reinterpret_cast<input_t*>(params.u_ptr);
+    selectiveScanUpdateChannel<input_t, weight_t, DSTATE>(
+        params, sample, channel, toFloat(x[sample * params.dim + channel]));
+}
+
+// Generation step over a chain of speculative tokens per sample, writing the state after every token.
+template <typename input_t, typename weight_t, int DSTATE = 16>
+__launch_bounds__(128, 2) __global__ void selective_scan_update_checkpoint_kernel(SSMParamsBase params)
+{
+    input_t* output = reinterpret_cast<input_t*>(params.out_ptr);
+    input_t const* state = reinterpret_cast<input_t const*>(params.x_ptr);
+    input_t* checkpoints = reinterpret_cast<input_t*>(params.state_checkpoints_ptr);
+    input_t const* x = reinterpret_cast<input_t const*>(params.u_ptr);
+    input_t const* dt = reinterpret_cast<input_t const*>(params.delta_ptr);
+    weight_t const* A = reinterpret_cast<weight_t const*>(params.A_ptr);
+    input_t const* BC = reinterpret_cast<input_t const*>(params.BC_ptr);
+    weight_t const* D = reinterpret_cast<weight_t const*>(params.D_ptr);
+    input_t const* z = reinterpret_cast<input_t const*>(params.z_ptr);
+    weight_t const* dt_bias = reinterpret_cast<weight_t const*>(params.delta_bias_ptr);
+    int const num_channels = params.dim;
+    int const num_tokens = params.num_spec_tokens;
+
+    int const channel = blockIdx.x * blockDim.x + threadIdx.x;
+    if (channel >= num_channels)
+        return;
+    int const sample = blockIdx.y;
+    int const slot_idx = params.slot_mapping_ptr == nullptr ? sample : params.slot_mapping_ptr[sample];
+    int const bc_cols = DSTATE * 2 + params.dt_rank;
+
+    float rA[DSTATE];
+    float rState[DSTATE];
+#pragma unroll
+    for (int i = 0; i < DSTATE; i++)
+    {
+        rA[i] = toFloat(A[i * num_channels + channel]);
+        rState[i] = toFloat(state[(slot_idx * DSTATE + i) * num_channels + channel]);
+    }
+    float const my_dt_bias = dt_bias ? toFloat(dt_bias[channel]) : 0.f;
+    float const my_D = D ? toFloat(D[channel]) : 0.f;
+
+    for (int t = 0; t < num_tokens; t++)
+    {
+        int const row = sample * num_tokens + t;
+        float const my_x = toFloat(x[row * num_channels + channel]);
+        float dt_b = toFloat(dt[row * num_channels + channel]) + my_dt_bias;
+        if (params.delta_softplus)
+        {
+            dt_b = dt_b <= 20.f ? __logf(1.f + __expf(dt_b)) : dt_b; // softplus
+        }
+
+        float out = D ? my_D * my_x : 0.f;
+        input_t* my_checkpoint = &checkpoints[row * DSTATE * num_channels];
+#pragma unroll
+        for (int i = 0; i < DSTATE; i++)
+        {
+            float const B = toFloat(BC[row * bc_cols + params.dt_rank + i]);
+            float const C = toFloat(BC[row * bc_cols + params.dt_rank + DSTATE + i]);
+            rState[i] = rState[i] * __expf(rA[i] * dt_b) + B * dt_b * my_x;
+            convertAndStore(&my_checkpoint[i * num_channels + channel], rState[i]);
+            out += rState[i] * C;
+        }
+
+        if (z)
+        {
+            float const my_z = toFloat(z[row * num_channels + channel]);
+            out *= my_z * __fdividef(1.f, (1.f + __expf(0.f - my_z)));
+        }
+        convertAndStore(&output[row * num_channels + channel], out);
+    }
+}
+
+// Conv1d generation step followed by the SSM update of the same token, the conv output stays in a register.
+template <typename input_t, typename weight_t, int DSTATE = 16, int DCONV = 4>
+__launch_bounds__(128, 2) __global__
+    void mamba_conv1d_selective_scan_update_kernel(MambaConv1dParamsBase convParams, SSMParamsBase params)
+{
+    int const channel = blockIdx.x * blockDim.x + threadIdx.x;
+    if (channel >= params.dim)
+        return;
+    int const sample = blockIdx.y;
+    int const num_channels = params.dim;
+    int const slot_idx
+        = convParams.state_slot_mapping_ptr == nullptr ? sample : convParams.state_slot_mapping_ptr[sample];
+
+    input_t const* input = reinterpret_cast<input_t const*>(convParams.in_ptr);
+    input_t const* state_in = reinterpret_cast<input_t const*>(convParams.state_in_ptr);
+    input_t* state_out = reinterpret_cast<input_t*>(convParams.state_out_ptr);
+    input_t const* weight = reinterpret_cast<input_t const*>(convParams.weight_ptr);
+    input_t const* bias = reinterpret_cast<input_t const*>(convParams.bias_ptr);
+    input_t* conv_out = reinterpret_cast<input_t*>(convParams.out_ptr);
+
+    int const state_offset = slot_idx * (DCONV - 1) * num_channels + channel;
+    float window[DCONV];
+#pragma unroll
+    for (int i = 0; i < DCONV - 1; ++i)
+    {
+        window[i] = toFloat(state_in[state_offset + i * num_channels]);
+    }
+    window[DCONV - 1] = toFloat(input[sample * num_channels + channel]);
+
+    float my_x = toFloat(bias[channel]);
+#pragma unroll
+    for (int row = 0; row < DCONV; ++row)
+    {
+        my_x += toFloat(weight[row * num_channels + channel]) * window[row];
+    }
+    if (convParams.apply_silu)
+    {
+        my_x *= my_x < -20.f ? 0.f : __fdividef(1.f, 1.f + __expf(-my_x));
+    }
+
+    // Shift the conv state, the state may be updated in place
+#pragma unroll
+    for (int i = 0; i < DCONV - 1; ++i)
+    {
+        convertAndStore(&state_out[state_offset + i * num_channels], window[i + 1]);
+    }
+    if (conv_out != nullptr)
+    {
+        convertAndStore(&conv_out[sample * num_channels + channel], my_x);
+    }
+
+    selectiveScanUpdateChannel<input_t, weight_t, DSTATE>(params, sample, channel, my_x);
+}
+
 template <typename input_t, typename weight_t>
 void invokeSelectiveScanUpdate(SSMParamsBase& params, cudaStream_t stream)
 {
@@ -442,6 +763,12 @@ void invokeSelectiveScanUpdate(SSMParamsBase& params, cudaStream_t stream)
     TLLM_CHECK(params.is_variable_B);
     TLLM_CHECK(params.is_variable_C);
     TLLM_CHECK(params.dstate == 16);
+    if (params.state_checkpoints_ptr != nullptr)
+    {
+        TLLM_CHECK(params.num_spec_tokens > 0);
+        selective_scan_update_checkpoint_kernel<input_t, weight_t><<<grid, block, 0, stream>>>(params);
+        return;
+    }
     selective_scan_update_kernel<input_t, weight_t><<<grid, block, 0, stream>>>(params);
 }
 
@@ -455,5 +782,37 @@ INSTANTIATE_SELECTIVE_SCAN_UPDATE_DATA_TYPE(__nv_bfloat16, float);
 #endif
 #undef INSTANTIATE_SELECTIVE_SCAN_UPDATE_DATA_TYPE
 
+template <typename input_t, typename weight_t>
+void invokeMambaConv1dSelectiveScanUpdate(
+    MambaConv1dParamsBase& convParams, SSMParamsBase& params, cudaStream_t stream)
+{
+    int samples = params.batch;
+    int channels = params.dim;
+
+    int const threads = 128;
+    int const blocks = (channels + threads - 1) / threads;
+    dim3 block(threads, 1);
+    dim3 grid(blocks, samples);
+
+    TLLM_CHECK(params.is_variable_B);
+    TLLM_CHECK(params.is_variable_C);
+    TLLM_CHECK(params.dstate == 16);
+    TLLM_CHECK_WITH_INFO(convParams.dconv == 4, "only dconv == 4 is supported now.");
+    TLLM_CHECK_WITH_INFO(convParams.dim == params.dim && convParams.batch == params.batch,
+        "conv1d and selective scan must have the same dim and batch.");
+    mamba_conv1d_selective_scan_update_kernel<input_t, weight_t><<<grid, block, 0, stream>>>(convParams, params);
+}
+
+#define INSTANTIATE_MAMBA_CONV1D_SELECTIVE_SCAN_UPDATE_DATA_TYPE(input_t, weight_t)                                    \
+    template void invokeMambaConv1dSelectiveScanUpdate<input_t, weight_t>(                                             \
+        MambaConv1dParamsBase & convParams, SSMParamsBase & params, cudaStream_t stream)
+
+INSTANTIATE_MAMBA_CONV1D_SELECTIVE_SCAN_UPDATE_DATA_TYPE(float, float);
+INSTANTIATE_MAMBA_CONV1D_SELECTIVE_SCAN_UPDATE_DATA_TYPE(half, float);
+#ifdef ENABLE_BF16
+INSTANTIATE_MAMBA_CONV1D_SELECTIVE_SCAN_UPDATE_DATA_TYPE(__nv_bfloat16, float);
+#endif
+#undef INSTANTIATE_MAMBA_CONV1D_SELECTIVE_SCAN_UPDATE_DATA_TYPE
+
 } // namespace kernels
 } // namespace tensorrt_llm
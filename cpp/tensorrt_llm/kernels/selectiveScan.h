@@ -32,6 +32,7 @@
 
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/mambaConv1dKernels.h"
 
 namespace tensorrt_llm
 {
@@ -60,14 +61,45 @@ struct SSMParamsBase
     void* __restrict__ z_ptr;
     int const* __restrict__ last_token_ids_ptr;
     int const* __restrict__ slot_mapping_ptr;
+
+    // Chunked context scan, see getSelectiveScanWorkspaceSize. Disabled if chunk_states_ptr is null.
+    void* __restrict__ chunk_states_ptr;
+    int max_chunks; // upper bound of the number of chunks of one sequence
+
+    // Speculative decoding, see invokeSelectiveScanUpdate. Disabled if state_checkpoints_ptr is null.
+    void* __restrict__ state_checkpoints_ptr;
+    int num_spec_tokens;
 };
 
+// Tokens per chunk of the chunked context scan, which parallelizes long sequences over chunks.
+constexpr int kSelectiveScanChunkSize = 256;
+
+//! \brief Bytes of the chunk states of the chunked context scan: for every chunk, its local state and the sum of its
+//! time steps per channel, in float. Chunks are numbered ceil(first_token / chunk_size) + sample, which bounds them
+//! by ceil(num_tokens / chunk_size) + batch for both padded and packed (remove_padding) inputs.
+inline size_t getSelectiveScanWorkspaceSize(int batch, int numTokens, int dim, int dstate)
+{
+    auto const numChunks = (numTokens + kSelectiveScanChunkSize - 1) / kSelectiveScanChunkSize + batch;
+    return static_cast<size_t>(numChunks) * (dstate + 1) * dim * sizeof(float);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 template <typename input_t, typename weight_t>
 void invokeSelectiveScan(SSMParamsBase& params, cudaStream_t stream);
 
+//! \brief Generation step. With params.state_checkpoints_ptr set, every sample has a linear chain of num_spec_tokens
+//! tokens, e.g. the new token and its draft tokens, which are scanned from the cached state. The state after each of
+//! them goes to state_checkpoints_ptr [batch, num_spec_tokens, dstate, dim], the cache is left unchanged so that the
+//! state of the accepted tokens can be selected after verification.
 template <typename input_t, typename weight_t>
 void invokeSelectiveScanUpdate(SSMParamsBase& params, cudaStream_t stream);
+
+//! \brief Fused generation step of a Mamba block: the conv1d state shift, conv and SiLU of convParams, then the SSM
+//! state update of params on the conv output, in a single kernel. params.u_ptr is not read, convParams.out_ptr is only
+//! written if set. Only valid when the dt, B and C inputs of params don't depend on the conv output.
+template <typename input_t, typename weight_t>
+void invokeMambaConv1dSelectiveScanUpdate(
+    MambaConv1dParamsBase& convParams, SSMParamsBase& params, cudaStream_t stream);
 } // namespace kernels
 } // namespace tensorrt_llm
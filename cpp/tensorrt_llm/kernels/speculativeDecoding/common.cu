@@ -94,4 +94,57 @@ void invokePackAcceptedPaths(SizeType32* acceptedLengthsCumSum, SizeType32* path
     packAcceptedPaths<BLOCK_SIZE><<<1, BLOCK_SIZE, 0, stream>>>(acceptedLengthsCumSum, pathsOffsets, acceptedLengths,
         bestPathIds, paths, batchSlots, batchSize, numPaths, maxPathLen, isPathsLinearBatchIdx);
 }
+
+namespace
+{
+__global__ void updateDraftAcceptance(DraftAcceptanceParams params)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x);
+    if (batchIdx >= params.batchSize)
+    {
+        return;
+    }
+    auto const batchSlot = params.batchSlots[batchIdx];
+    auto const acceptedLen = params.acceptedLengths != nullptr
+        ? params.acceptedLengths[batchSlot]
+        : params.sequenceLengths[batchSlot] - params.contextLengths[batchSlot];
+    auto const numDraftTokens
+        = params.numDraftTokens != nullptr ? params.numDraftTokens[batchSlot] : params.maxDraftLen;
+    auto const numAccepted = min(max(acceptedLen - 1, 0), numDraftTokens);
+
+    // Accepted tokens are successes, the first rejected token is the only observed failure
+    auto const numTrials = numAccepted + (numAccepted < numDraftTokens ? 1 : 0);
+    auto rate = params.acceptanceRates[batchSlot];
+    if (numTrials > 0)
+    {
+        auto const stepRate = static_cast<float>(numAccepted) / static_cast<float>(numTrials);
+        rate = (1.f - params.emaDecay) * rate + params.emaDecay * stepRate;
+        params.acceptanceRates[batchSlot] = rate;
+    }
+
+    auto nextDraftLen = params.minDraftLen;
+    float expectedAccepted{0.f};
+    float rateK{1.f};
+    for (SizeType32 di = 1; di <= params.maxDraftLen; ++di)
+    {
+        rateK *= rate;
+        expectedAccepted += rateK;
+        if (di >= params.minDraftLen && static_cast<float>(di) - expectedAccepted <= params.maxRejectedTokens)
+        {
+            nextDraftLen = di;
+        }
+    }
+    params.nextNumDraftTokens[batchSlot] = nextDraftLen;
+}
+} // namespace
+
+void invokeUpdateDraftAcceptance(DraftAcceptanceParams const& params, cudaStream_t stream)
+{
+    params.checkParams();
+
+    SizeType32 constexpr BLOCK_SIZE = 256;
+    auto const grid = (params.batchSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    updateDraftAcceptance<<<grid, BLOCK_SIZE, 0, stream>>>(params);
+    sync_check_cuda_error();
+}
 } // namespace tensorrt_llm::kernels::speculative_decoding
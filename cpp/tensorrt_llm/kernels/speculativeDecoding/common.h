@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/runtime/common.h"
 #include <cuda_fp16.h>
 #include <cuda_runtime.h>
@@ -42,4 +43,47 @@ void invokePackAcceptedPaths(runtime::SizeType32* acceptedLengthsCumSum, runtime
     runtime::SizeType32 const* paths, runtime::SizeType32 const* batchSlots, runtime::SizeType32 batchSize,
     runtime::SizeType32 numPaths, runtime::SizeType32 maxPathLen, bool isPathsLinearBatchIdx, cudaStream_t stream);
 
+struct DraftAcceptanceParams
+{
+    //! input buffer [maxBatchSize], optional. Tokens accepted per request in this step, including the token of the
+    //! target model. If not set, it is computed as sequenceLengths - contextLengths.
+    runtime::SizeType32 const* acceptedLengths{nullptr};
+    //! input buffers [maxBatchSize], optional. Sequence lengths after and before the acceptance step.
+    runtime::SizeType32 const* sequenceLengths{nullptr};
+    runtime::SizeType32 const* contextLengths{nullptr};
+    //! input buffer [maxBatchSize], optional. Draft tokens verified per request in this step. maxDraftLen if not set.
+    runtime::SizeType32 const* numDraftTokens{nullptr};
+    //! input/output buffer [maxBatchSize]. Exponential moving average of the probability that a draft token is
+    //! accepted given that its predecessor was accepted. Initialize it with 1 for new requests.
+    float* acceptanceRates{nullptr};
+    //! output buffer [maxBatchSize]. Number of draft tokens recommended for the next step of each request.
+    runtime::SizeType32* nextNumDraftTokens{nullptr};
+    //! input buffer [batchSize]. Address map from local index to global index [0, batchSize] -> [0, maxBatchSize]
+    runtime::SizeType32 const* batchSlots{nullptr};
+
+    runtime::SizeType32 batchSize{0};
+    runtime::SizeType32 minDraftLen{1};
+    runtime::SizeType32 maxDraftLen{0};
+    //! weight of the current step in the moving average
+    float emaDecay{0.1f};
+    //! maximum expected number of rejected draft tokens per step
+    float maxRejectedTokens{1.f};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(acceptedLengths || (sequenceLengths && contextLengths));
+        TLLM_CHECK(acceptanceRates && nextNumDraftTokens && batchSlots);
+        TLLM_CHECK(batchSize > 0);
+        TLLM_CHECK(0 < minDraftLen && minDraftLen <= maxDraftLen);
+        TLLM_CHECK(0.f < emaDecay && emaDecay <= 1.f);
+        TLLM_CHECK(maxRejectedTokens >= 0.f);
+    }
+};
+
+//! \brief Tracks the draft acceptance rate per request after the acceptance step and picks the draft length of the
+//! next step. Draft tokens are modelled as accepted one after another with probability acceptanceRate, so that
+//! L - sum_{k=1..L} acceptanceRate^k draft tokens are expected to be rejected with L draft tokens. The longest draft
+//! length within [minDraftLen, maxDraftLen] that keeps this below maxRejectedTokens is chosen.
+void invokeUpdateDraftAcceptance(DraftAcceptanceParams const& params, cudaStream_t stream);
+
 } // namespace tensorrt_llm::kernels::speculative_decoding
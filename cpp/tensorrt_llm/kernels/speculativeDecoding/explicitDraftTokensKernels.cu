@@ -202,12 +202,38 @@ void invokeConvertSpecDecodingMaskToPackedMask(SizeType32 batchSize,
 
 namespace
 {
-template <typename T>
+//! Copies the draft probs of request bid to its batch slot. All blocks of the request take part, each with a stride
+//! of the whole row.
+template <typename T, typename VecT>
+__device__ void copyDraftProbs(ExtractExplicitDraftTokensParams<T> const& params, SizeType32 bid, SizeType32 batchSlot)
+{
+    auto constexpr VEC_ELTS = static_cast<SizeType32>(sizeof(VecT));
+    auto const rowSizeInBytes
+        = static_cast<std::size_t>(params.numPaths) * (params.maxPathLength - 1) * params.vocabSize * sizeof(T);
+    auto const* srcData = reinterpret_cast<uint8_t const*>(params.nextDraftProbs) + bid * rowSizeInBytes;
+    auto* dstData = reinterpret_cast<uint8_t*>(params.outputDraftProbs) + batchSlot * rowSizeInBytes;
+    auto const stride = static_cast<std::size_t>(blockDim.x) * gridDim.x * VEC_ELTS;
+    for (auto idx = (static_cast<std::size_t>(blockIdx.x) * blockDim.x + threadIdx.x) * VEC_ELTS; idx < rowSizeInBytes;
+         idx += stride)
+    {
+        *reinterpret_cast<VecT*>(&dstData[idx]) = *reinterpret_cast<VecT const*>(&srcData[idx]);
+    }
+}
+
+template <typename T, typename VecT>
 __global__ void extractExplicitDraftTokens(ExtractExplicitDraftTokensParams<T> params)
 {
-    auto const bid = static_cast<SizeType32>(blockIdx.x);
+    auto const bid = static_cast<SizeType32>(blockIdx.y);
     auto const batchSlot = params.batchSlots ? params.batchSlots[bid] : bid;
 
+    copyDraftProbs<T, VecT>(params, bid, batchSlot);
+
+    // Only the first block of the request updates the sequence.
+    if (blockIdx.x != 0)
+    {
+        return;
+    }
+
     // Get accepted path len.
     // This tensor comes directly from engine and has linear batch index.
     auto const bestPathLength = params.bestPathLengths[bid];
@@ -315,8 +341,30 @@ __global__ void extractExplicitDraftTokens(ExtractExplicitDraftTokensParams<T> p
 template <typename T>
 void invokeExtractExplicitDraftTokens(ExtractExplicitDraftTokensParams<T> const& params, cudaStream_t stream)
 {
+    auto const copyRowSizeInBytes = params.numPaths * (params.maxPathLength - 1) * params.vocabSize * sizeof(T);
+    auto kernel = extractExplicitDraftTokens<T, uint8_t>;
+    if (copyRowSizeInBytes % 16 == 0)
+    {
+        kernel = extractExplicitDraftTokens<T, uint4>;
+    }
+    else if (copyRowSizeInBytes % 8 == 0)
+    {
+        kernel = extractExplicitDraftTokens<T, uint2>;
+    }
+    else if (copyRowSizeInBytes % 4 == 0)
+    {
+        kernel = extractExplicitDraftTokens<T, uint32_t>;
+    }
+    else if (copyRowSizeInBytes % 2 == 0)
+    {
+        kernel = extractExplicitDraftTokens<T, uint16_t>;
+    }
+
+    // The first block of each request extracts the accepted tokens, all blocks copy the draft probs.
     SizeType32 constexpr BLOCK_SIZE = 128;
-    extractExplicitDraftTokens<<<params.batchSize, BLOCK_SIZE, 0, stream>>>(params);
+    SizeType32 constexpr BLOCKS_PER_ROW{32};
+    dim3 const gridSize{BLOCKS_PER_ROW, static_cast<uint32_t>(params.batchSize)};
+    kernel<<<gridSize, BLOCK_SIZE, 0, stream>>>(params);
 }
 
 template void invokeExtractExplicitDraftTokens(
@@ -378,20 +426,6 @@ void invokeCopyProbs(uint8_t const* srcDataPtr, uint8_t* dstDataPtr, SizeType32
         srcDataPtr, dstDataPtr, inputBatchSlots, outputBatchSlots, copyRowSizeInBytes);
 }
 
-template <typename T>
-void invokeCopyProbs(ExtractExplicitDraftTokensParams<T> const& params, cudaStream_t stream)
-{
-    auto srcDataPtr = reinterpret_cast<uint8_t const*>(params.nextDraftProbs);
-    auto dstDataPtr = reinterpret_cast<uint8_t*>(params.outputDraftProbs);
-    auto const numCopyElems = params.numPaths * (params.maxPathLength - 1) * params.vocabSize;
-    auto const copyRowSizeInBytes = numCopyElems * sizeof(T);
-
-    invokeCopyProbs(srcDataPtr, dstDataPtr, nullptr, params.batchSlots, params.batchSize, copyRowSizeInBytes, stream);
-}
-
-template void invokeCopyProbs(ExtractExplicitDraftTokensParams<float> const& params, cudaStream_t stream);
-template void invokeCopyProbs(ExtractExplicitDraftTokensParams<half> const& params, cudaStream_t stream);
-
 namespace
 {
 template <typename T>
@@ -92,15 +92,11 @@ struct ExtractExplicitDraftTokensParams
 //! `bestPathLengths`. Sets new draft tokens `outputNextDraftTokens` and their lengths `nextDraftLengths`. Splits input
 //! tensors mapped lienarly from ExplicitDraftTokens network into respective outputs at batch slots. `nextDraftTokens`
 //! -> `unpackedNextDraftTokens` `inputUnpackedNextDraftIndices` -> `unpackedNextDraftIndices` `packedPositionIds` ->
-//! `outputPositionIds` Generates random data for `randDataSample` and `randDataVerification`.
+//! `outputPositionIds` Generates random data for `randDataSample` and `randDataVerification`. Copies linear draft probs
+//! `nextDraftProbs` to `outputDraftProbs` at batch slots in the same launch.
 template <typename T>
 void invokeExtractExplicitDraftTokens(ExtractExplicitDraftTokensParams<T> const& params, cudaStream_t stream);
 
-//! @brief Copies linear draft probs from linear batch index at `nextDraftProbs` to `outputDraftProbs` at `batchSlot`
-//! batch indices.
-template <typename T>
-void invokeCopyProbs(ExtractExplicitDraftTokensParams<T> const& params, cudaStream_t stream);
-
 template <typename T>
 struct PackExplicitDraftTokensParams
 {
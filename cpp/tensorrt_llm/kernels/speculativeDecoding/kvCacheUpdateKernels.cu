@@ -29,8 +29,36 @@ static constexpr int kUpdateKVCacheKernelShmSize = 16384;
 
 namespace
 {
-template <typename KVCacheBuffer, int MaxLayerCount, typename MoveEltType>
-__global__ void updateKVCacheDraftTokenLocationBatchedKernel(std::array<KVCacheBuffer, MaxLayerCount> kvCacheBuffers,
+//! KV cache buffers of up to MaxLayerCount layers passed by value to the kernel.
+template <typename KVCacheBuffer, int MaxLayerCount>
+struct KVCacheBufferList
+{
+    std::array<KVCacheBuffer, MaxLayerCount> buffers;
+
+    __device__ KVCacheBuffer const& getLayer(int layerIdx) const
+    {
+        return buffers[layerIdx];
+    }
+};
+
+//! Block KV cache of all layers. The layers share the block offsets and their pools are interleaved at a fixed
+//! stride, so one buffer describes all of them regardless of the number of layers.
+struct KVBlockArrayLayers
+{
+    KVBlockArray firstLayer;
+    int64_t layerStrideInBytes;
+
+    __device__ KVBlockArray getLayer(int layerIdx) const
+    {
+        auto layer = firstLayer;
+        layer.mPrimaryPoolPtr = static_cast<char*>(layer.mPrimaryPoolPtr) + layerIdx * layerStrideInBytes;
+        layer.mSecondaryPoolPtr = static_cast<char*>(layer.mSecondaryPoolPtr) + layerIdx * layerStrideInBytes;
+        return layer;
+    }
+};
+
+template <typename KVCacheLayers, typename MoveEltType>
+__global__ void updateKVCacheDraftTokenLocationBatchedKernel(KVCacheLayers kvCacheLayers,
     int const* seqAcceptedDraftTokenOffsets, IndexType const* packedAcceptedDraftTokensIndices,
     int32_t const* pastKeyValueLengths, int rewindDraftTokenCommonCount, int const* rewindDraftTokenSeparateAdjustments,
     int const* seqSlotRemapping, int eltCountPerHead)
@@ -44,14 +72,27 @@ __global__ void updateKVCacheDraftTokenLocationBatchedKernel(std::array<KVCacheB
     int seqDraftTokenStart = seqAcceptedDraftTokenOffsets[seqIdx];
     int seqDraftTokenEnd = seqAcceptedDraftTokenOffsets[seqIdx + 1];
     auto const seqSlot = seqSlotRemapping == nullptr ? seqIdx : seqSlotRemapping[seqIdx];
+    // Accepted tokens are sorted by position. The leading ones which already are at their final position, e.g. all
+    // accepted tokens of a linear draft, are not moved.
+    int inPlaceCount = 0;
+    while (seqDraftTokenStart + inPlaceCount < seqDraftTokenEnd
+        && packedAcceptedDraftTokensIndices[seqDraftTokenStart + inPlaceCount] == inPlaceCount)
+    {
+        ++inPlaceCount;
+    }
+    seqDraftTokenStart += inPlaceCount;
     int seqDraftCount = seqDraftTokenEnd - seqDraftTokenStart;
+    if (seqDraftCount == 0)
+    {
+        return;
+    }
     int maxEltCountPerMove = kUpdateKVCacheKernelShmSize / sizeof(MoveEltType) / seqDraftCount;
     int eltCountPerMove = min(maxEltCountPerMove, eltCountPerHead);
-    if (seqDraftCount == 0 || eltCountPerMove == 0)
+    if (eltCountPerMove == 0)
     {
         return;
     }
-    KVCacheBuffer& kvCacheBuffer = kvCacheBuffers[layerIdx];
+    auto const& kvCacheBuffer = kvCacheLayers.getLayer(layerIdx);
     int tokenStartIdx = pastKeyValueLengths[seqSlot] - rewindDraftTokenCommonCount;
     if (rewindDraftTokenSeparateAdjustments != nullptr)
     {
@@ -80,7 +121,7 @@ __global__ void updateKVCacheDraftTokenLocationBatchedKernel(std::array<KVCacheB
         // store K
         for (int tokenIdx = warpIdx; tokenIdx < seqDraftCount; tokenIdx += warpCount)
         {
-            int tokenPos = tokenIdx;
+            int tokenPos = inPlaceCount + tokenIdx;
             auto* tokenSmemBuffer = eltLoadSmemBuffer + tokenIdx * eltCountCurrentMove;
             int tokenKVPosition = tokenStartIdx + tokenPos;
             auto* kPtr = reinterpret_cast<MoveEltType*>(kvCacheBuffer.getKBlockPtr(seqSlot, tokenKVPosition));
@@ -110,8 +151,8 @@ __global__ void updateKVCacheDraftTokenLocationBatchedKernel(std::array<KVCacheB
         // store V
         for (int tokenIdx = warpIdx; tokenIdx < seqDraftCount; tokenIdx += warpCount)
         {
-            int tokenPos = tokenIdx;
-            auto* tokenSmemBuffer = eltLoadSmemBuffer + tokenPos * eltCountCurrentMove;
+            int tokenPos = inPlaceCount + tokenIdx;
+            auto* tokenSmemBuffer = eltLoadSmemBuffer + tokenIdx * eltCountCurrentMove;
             int tokenKVPosition = tokenStartIdx + tokenPos;
             auto* vPtr = reinterpret_cast<MoveEltType*>(kvCacheBuffer.getVBlockPtr(seqSlot, tokenKVPosition));
             for (int loadChannelIdx = laneIdx; loadChannelIdx < eltCountCurrentMove; loadChannelIdx += 32)
@@ -126,15 +167,14 @@ __global__ void updateKVCacheDraftTokenLocationBatchedKernel(std::array<KVCacheB
 }
 } // namespace
 
-template <typename KVCacheBuffer, int MaxLayerCount>
-void updateKVCacheDraftTokenLocationBatched(KVCacheBuffer const* kvCacheBuffers,
-    int const* seqAcceptedDraftTokenOffsets, IndexType const* packedAcceptedDraftTokensIndices,
-    int32_t const* pastKeyValueLengths, int layerCount, int seqCount, int numKVHeads, int sizeInBytesPerKVHead,
-    int rewindDraftTokenCommonCount, int* rewindDraftTokenSeparateAdjustments, int const* seqSlotRemapping,
-    cudaStream_t stream)
+template <typename KVCacheLayers>
+void updateKVCacheDraftTokenLocationBatched(KVCacheLayers const& kvCacheLayers, int const* seqAcceptedDraftTokenOffsets,
+    IndexType const* packedAcceptedDraftTokensIndices, int32_t const* pastKeyValueLengths, int layerCount, int seqCount,
+    int numKVHeads, int sizeInBytesPerKVHead, int rewindDraftTokenCommonCount, int* rewindDraftTokenSeparateAdjustments,
+    int const* seqSlotRemapping, cudaStream_t stream)
 {
     // make sure launch buffer is enough
-    static_assert(MaxLayerCount * sizeof(KVCacheBuffer) <= 3072);
+    static_assert(sizeof(KVCacheLayers) <= 3072);
     if (seqCount == 0 || layerCount == 0)
     {
         return;
@@ -148,44 +188,38 @@ void updateKVCacheDraftTokenLocationBatched(KVCacheBuffer const* kvCacheBuffers,
     int eltCountPerHead = sizeInBytesPerKVHead / alignedBytes;
     dim3 grid(seqCount, numKVHeads, layerCount);
     dim3 block(128, 1, 1);
-    std::array<KVCacheBuffer, MaxLayerCount> kvCacheBufferArray;
-    for (int i = 0; i < layerCount; i++)
-    {
-        kvCacheBufferArray[i] = kvCacheBuffers[i];
-    }
-    void (*pKernelFunc)(std::array<KVCacheBuffer, MaxLayerCount>, int const*, IndexType const*, int32_t const*, int,
-        int const*, int const*, int)
+    void (*pKernelFunc)(KVCacheLayers, int const*, IndexType const*, int32_t const*, int, int const*, int const*, int)
         = nullptr;
     switch (alignedBytes)
     {
     case 16:
     {
-        pKernelFunc = &updateKVCacheDraftTokenLocationBatchedKernel<KVCacheBuffer, MaxLayerCount, int4>;
+        pKernelFunc = &updateKVCacheDraftTokenLocationBatchedKernel<KVCacheLayers, int4>;
         break;
     }
     case 8:
     {
-        pKernelFunc = &updateKVCacheDraftTokenLocationBatchedKernel<KVCacheBuffer, MaxLayerCount, int64_t>;
+        pKernelFunc = &updateKVCacheDraftTokenLocationBatchedKernel<KVCacheLayers, int64_t>;
         break;
     }
     case 4:
     {
-        pKernelFunc = &updateKVCacheDraftTokenLocationBatchedKernel<KVCacheBuffer, MaxLayerCount, int32_t>;
+        pKernelFunc = &updateKVCacheDraftTokenLocationBatchedKernel<KVCacheLayers, int32_t>;
         break;
     }
     case 2:
     {
-        pKernelFunc = &updateKVCacheDraftTokenLocationBatchedKernel<KVCacheBuffer, MaxLayerCount, int16_t>;
+        pKernelFunc = &updateKVCacheDraftTokenLocationBatchedKernel<KVCacheLayers, int16_t>;
         break;
     }
     default:
     {
         TLLM_CHECK_WITH_INFO(alignedBytes == 1, "Strange alignedBytes");
-        pKernelFunc = &updateKVCacheDraftTokenLocationBatchedKernel<KVCacheBuffer, MaxLayerCount, int8_t>;
+        pKernelFunc = &updateKVCacheDraftTokenLocationBatchedKernel<KVCacheLayers, int8_t>;
         break;
     }
     }
-    pKernelFunc<<<grid, block, 0, stream>>>(kvCacheBufferArray, seqAcceptedDraftTokenOffsets,
+    pKernelFunc<<<grid, block, 0, stream>>>(kvCacheLayers, seqAcceptedDraftTokenOffsets,
         packedAcceptedDraftTokensIndices, pastKeyValueLengths, rewindDraftTokenCommonCount,
         rewindDraftTokenSeparateAdjustments, seqSlotRemapping, eltCountPerHead);
     TLLM_CUDA_CHECK(cudaGetLastError());
@@ -219,10 +253,15 @@ void updateKVCacheDraftTokenLocation(KVCacheBuffer const* kvCacheBuffers, int co
     while (startLayer < layerCount)
     {
         int microBatchLayerCount = std::min(layerCount - startLayer, kMaxLayersPerIter);
-        updateKVCacheDraftTokenLocationBatched<KVCacheBuffer, kMaxLayersPerIter>(kvCacheBuffers + startLayer,
-            seqAcceptedDraftTokenOffsets, packedAcceptedDraftTokensIndices, pastKeyValueLengths, microBatchLayerCount,
-            seqCount, numKVHeads, sizeInBytesPerKVHead, rewindDraftTokenCommonCount,
-            rewindDraftTokenSeparateAdjustments, seqSlotRemapping, stream);
+        KVCacheBufferList<KVCacheBuffer, kMaxLayersPerIter> kvCacheBufferList;
+        for (int i = 0; i < microBatchLayerCount; i++)
+        {
+            kvCacheBufferList.buffers[i] = kvCacheBuffers[startLayer + i];
+        }
+        updateKVCacheDraftTokenLocationBatched(kvCacheBufferList, seqAcceptedDraftTokenOffsets,
+            packedAcceptedDraftTokensIndices, pastKeyValueLengths, microBatchLayerCount, seqCount, numKVHeads,
+            sizeInBytesPerKVHead, rewindDraftTokenCommonCount, rewindDraftTokenSeparateAdjustments, seqSlotRemapping,
+            stream);
         startLayer += microBatchLayerCount;
     }
 }
@@ -252,22 +291,13 @@ void updateKVBlockArrayDraftTokenLocation(int const* seqAcceptedDraftTokenOffset
     int rewindDraftTokenCommonCount, int* rewindDraftTokenSeparateAdjustments, int const* seqSlotRemapping,
     int maxKVCacheLen, int maxBlocksPerSeq, int tokensPerBlock, cudaStream_t stream)
 {
-    std::vector<KVBlockArray> kvBlockArrays;
-    kvBlockArrays.reserve(layerCount);
+    // All layers are updated in one launch, the pools of the layers are interleaved in the primary and secondary pools
     auto const bytesPerToken = numKVHeads * sizeInBytesPerKVHead;
     auto const bytesPerBlock = tokensPerBlock * bytesPerToken;
-    for (int layerIdx = 0; layerIdx < layerCount; layerIdx++)
-    {
-        auto const layerOffset = layerIdx * 2 * bytesPerBlock;
-        auto* const primaryPoolPointer
-            = reinterpret_cast<void*>(reinterpret_cast<char*>(pointerArray[0]) + layerOffset);
-        auto* const secondaryPoolPointer
-            = reinterpret_cast<void*>(reinterpret_cast<char*>(pointerArray[1]) + layerOffset);
-
-        kvBlockArrays.emplace_back(seqCount, maxBlocksPerSeq, tokensPerBlock, bytesPerToken, maxKVCacheLen, 0,
-            primaryPoolPointer, secondaryPoolPointer, offsetArray);
-    }
-    updateKVCacheDraftTokenLocation(kvBlockArrays.data(), seqAcceptedDraftTokenOffsets,
+    KVBlockArrayLayers kvBlockArrayLayers{KVBlockArray(seqCount, maxBlocksPerSeq, tokensPerBlock, bytesPerToken,
+                                              maxKVCacheLen, 0, pointerArray[0], pointerArray[1], offsetArray),
+        2 * static_cast<int64_t>(bytesPerBlock)};
+    updateKVCacheDraftTokenLocationBatched(kvBlockArrayLayers, seqAcceptedDraftTokenOffsets,
         packedAcceptedDraftTokensIndices, pastKeyValueLengths, layerCount, seqCount, numKVHeads, sizeInBytesPerKVHead,
         rewindDraftTokenCommonCount, rewindDraftTokenSeparateAdjustments, seqSlotRemapping, stream);
 }
@@ -166,6 +166,8 @@ void updateLinearKVCacheDraftTokenLocation(int const* seqAcceptedDraftTokenOffse
  * Update Block KV cache using both common rewind and separate rewind count for each sequence. The common
  * rewindDraftTokenCommonCount and rewind count of each sequence in rewindDraftTokenSeparateAdjustments will be added
  * together for the final rewind count. It can save one add if both of them need to be used.
+ * All layers are updated in a single launch. Accepted tokens already at their final position, like the accepted prefix
+ * of a linear draft, are not moved.
  * @param seqAcceptedDraftTokenOffsets : Array of length seqCount + 1, like [0, 3, 5]
  * @param packedAcceptedDraftTokensIndices : Array of length seqAcceptedDraftTokenOffsets[seqCount], each value is in
  * range [0, maxDraftTokenCount - 1]
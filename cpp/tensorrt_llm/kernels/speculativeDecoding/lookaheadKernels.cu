@@ -0,0 +1,432 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/philoxRandom.cuh"
+#include "tensorrt_llm/kernels/speculativeDecoding/lookaheadKernels.h"
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+namespace tensorrt_llm::kernels::speculative_decoding
+{
+namespace
+{
+
+TokenIdType constexpr kEMPTY_KEY{-1};
+
+//! N-gram pool of one request. Buckets are found by linear probing and are never removed until the next setup.
+struct NgramPool
+{
+    TokenIdType* keys;
+    SizeType32* sizes;
+    TokenIdType* ngrams;
+    SizeType32 numBuckets;
+    SizeType32 bucketStride;
+    SizeType32 ngramStride;
+
+    __device__ NgramPool(LookaheadDecodingState const& state, SizeType32 batchSlot)
+        : keys(state.poolKeys + batchSlot * state.numPoolBuckets)
+        , sizes(state.poolSizes + batchSlot * state.numPoolBuckets)
+        , numBuckets(state.numPoolBuckets)
+        , bucketStride(state.maxG * (state.maxN - 1))
+        , ngramStride(state.maxN - 1)
+    {
+        ngrams = state.poolNgrams + static_cast<size_t>(batchSlot) * numBuckets * bucketStride;
+    }
+
+    //! @return the bucket of the key, a new bucket if insert is set, or -1
+    __device__ SizeType32 find(TokenIdType key, bool insert)
+    {
+        auto const hash = static_cast<SizeType32>((static_cast<uint32_t>(key) * 2654435761u) & (numBuckets - 1));
+        for (SizeType32 probe = 0; probe < numBuckets; ++probe)
+        {
+            auto const bucket = (hash + probe) & (numBuckets - 1);
+            if (keys[bucket] == key)
+            {
+                return bucket;
+            }
+            if (keys[bucket] == kEMPTY_KEY)
+            {
+                if (!insert)
+                {
+                    return -1;
+                }
+                keys[bucket] = key;
+                sizes[bucket] = 0;
+                return bucket;
+            }
+        }
+        return -1;
+    }
+
+    __device__ TokenIdType* getNgram(SizeType32 bucket, SizeType32 idx)
+    {
+        return ngrams + bucket * bucketStride + idx * ngramStride;
+    }
+
+    //! Same as LookaheadPoolManager::insertOne, moves the n-gram to the back and keeps the g most recent ones.
+    __device__ void insert(TokenIdType key, TokenIdType const* ngram, SizeType32 ngramLen, SizeType32 guessSetSize)
+    {
+        if (key < 0)
+        {
+            return;
+        }
+        auto const bucket = find(key, true);
+        if (bucket < 0)
+        {
+            return;
+        }
+        SizeType32 size{0};
+        for (SizeType32 ii = 0; ii < sizes[bucket]; ++ii)
+        {
+            auto const* item = getNgram(bucket, ii);
+            bool equal{true};
+            for (SizeType32 ti = 0; ti < ngramLen; ++ti)
+            {
+                equal &= item[ti] == ngram[ti];
+            }
+            if (equal)
+            {
+                continue;
+            }
+            auto* dst = getNgram(bucket, size++);
+            for (SizeType32 ti = 0; ti < ngramLen; ++ti)
+            {
+                dst[ti] = item[ti];
+            }
+        }
+        if (size >= guessSetSize)
+        {
+            for (SizeType32 ii = 1; ii < size; ++ii)
+            {
+                auto const* src = getNgram(bucket, ii);
+                auto* dst = getNgram(bucket, ii - 1);
+                for (SizeType32 ti = 0; ti < ngramLen; ++ti)
+                {
+                    dst[ti] = src[ti];
+                }
+            }
+            --size;
+        }
+        auto* dst = getNgram(bucket, size++);
+        for (SizeType32 ti = 0; ti < ngramLen; ++ti)
+        {
+            dst[ti] = ngram[ti];
+        }
+        sizes[bucket] = size;
+    }
+
+    //! Inserts all n-grams of tokens, keyed by their preceding token.
+    __device__ void accept(TokenIdType const* tokens, SizeType32 length, SizeType32 n, SizeType32 guessSetSize)
+    {
+        for (SizeType32 ti = 0; ti + n - 1 < length; ++ti)
+        {
+            insert(tokens[ti], tokens + ti + 1, n - 1, guessSetSize);
+        }
+    }
+};
+
+__global__ void lookaheadSetup(LookaheadDecodingState state, LookaheadSetupParams params)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = params.batchSlots[batchIdx];
+
+    for (SizeType32 bi = threadIdx.x; bi < state.numPoolBuckets; bi += blockDim.x)
+    {
+        state.poolKeys[batchSlot * state.numPoolBuckets + bi] = kEMPTY_KEY;
+        state.poolSizes[batchSlot * state.numPoolBuckets + bi] = 0;
+    }
+    __syncthreads();
+
+    if (threadIdx.x != 0)
+    {
+        return;
+    }
+
+    auto const w = params.windowSizes[batchIdx];
+    auto const n = params.ngramSizes[batchIdx];
+    auto const g = params.guessSetSizes[batchIdx];
+    auto const* prompt = params.prompts + batchIdx * params.maxPromptLen;
+    auto const promptLen = params.promptLengths[batchIdx];
+    auto const seed = params.randomSeeds != nullptr ? params.randomSeeds[batchIdx] : 0;
+
+    state.windowSizes[batchSlot] = w;
+    state.ngramSizes[batchSlot] = n;
+    state.guessSetSizes[batchSlot] = g;
+
+    NgramPool pool(state, batchSlot);
+    pool.accept(prompt, promptLen, n, g);
+
+    auto const randToken = [&](SizeType32 step)
+    {
+        auto const idx = static_cast<SizeType32>(getPhiloxUniform(seed, step) * promptLen);
+        return prompt[min(idx, promptLen - 1)];
+    };
+    auto* prefills = state.prefills + batchSlot * (state.maxN - 2);
+    for (SizeType32 pi = 0; pi < n - 2; ++pi)
+    {
+        prefills[pi] = randToken(pi);
+    }
+    auto* past = state.pastTokens + batchSlot * state.maxW * (state.maxN - 1);
+    for (SizeType32 wi = 0; wi < w; ++wi)
+    {
+        past[wi * (state.maxN - 1)] = randToken(n - 2 + wi);
+        for (SizeType32 ni = 1; ni < n - 1; ++ni)
+        {
+            past[wi * (state.maxN - 1) + ni] = -1;
+        }
+    }
+    auto* golden = state.goldenTokens + batchSlot * (2 * state.maxN - 1);
+    for (SizeType32 ni = 0; ni < n - 1; ++ni)
+    {
+        golden[ni] = prompt[promptLen - (n - 1) + ni];
+    }
+    state.fillings[batchSlot] = 1;
+    state.guessSizes[batchSlot] = 0;
+}
+
+__global__ void lookaheadPrepare(LookaheadDecodingState state, LookaheadPrepareParams params)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x);
+    if (batchIdx >= params.batchSize)
+    {
+        return;
+    }
+    auto const batchSlot = params.batchSlots[batchIdx];
+    auto const w = state.windowSizes[batchSlot];
+    auto const n = state.ngramSizes[batchSlot];
+    auto const filling = state.fillings[batchSlot];
+    auto const offset = params.positionOffsets[batchIdx];
+    auto const pastStride = state.maxN - 1;
+    auto const* prefills = state.prefills + batchSlot * (state.maxN - 2);
+    auto const* past = state.pastTokens + batchSlot * state.maxW * pastStride;
+    auto* draftTokens = params.draftTokens + batchIdx * params.maxDraftLen;
+    auto* positionIds = params.positionIds + batchIdx * params.maxDraftLen;
+    auto* samplingMask = params.samplingMask + batchIdx * params.maxDraftLen;
+
+    // Lookahead branch, same layout as LookaheadAlgorithm::lookahead
+    auto const prefill = n - 2 - filling;
+    auto const len = prefill + filling * w;
+    for (SizeType32 ti = 0; ti < len; ++ti)
+    {
+        samplingMask[ti] = false;
+    }
+    if (prefill >= 0)
+    {
+        for (SizeType32 pi = 0; pi < prefill; ++pi)
+        {
+            draftTokens[pi] = prefills[filling + pi];
+            positionIds[pi] = offset + pi;
+        }
+        for (SizeType32 wi = 0; wi < w; ++wi)
+        {
+            for (SizeType32 fi = 0; fi < filling; ++fi)
+            {
+                draftTokens[prefill + wi * filling + fi] = past[wi * pastStride + fi];
+                positionIds[prefill + wi * filling + fi] = offset + prefill + wi + fi;
+            }
+            samplingMask[prefill + wi * filling + filling - 1] = true;
+        }
+    }
+    else
+    {
+        // The window is full with filling == n - 1, the first token is the golden token itself
+        for (SizeType32 ti = 0; ti < len; ++ti)
+        {
+            auto const flat = ti + 1;
+            draftTokens[ti] = past[(flat / filling) * pastStride + flat % filling];
+        }
+        for (SizeType32 fi = 0; fi < filling - 1; ++fi)
+        {
+            positionIds[fi] = offset + fi;
+        }
+        for (SizeType32 wi = 1; wi < w; ++wi)
+        {
+            for (SizeType32 fi = 0; fi < filling; ++fi)
+            {
+                positionIds[wi * filling - 1 + fi] = offset - 1 + wi + fi;
+            }
+            samplingMask[wi * filling + filling - 2] = true;
+        }
+    }
+
+    // Verification branch, the most recent n-grams following the last golden token
+    auto const lastToken = state.goldenTokens[batchSlot * (2 * state.maxN - 1) + n - 2];
+    NgramPool pool(state, batchSlot);
+    auto const bucket = pool.find(lastToken, false);
+    auto const poolSize = bucket >= 0 ? pool.sizes[bucket] : 0;
+    auto const numGuesses = min(poolSize, w);
+    auto* guessTokens = state.guessTokens + batchSlot * state.maxG * pastStride;
+    for (SizeType32 gi = 0; gi < numGuesses; ++gi)
+    {
+        auto const* ngram = pool.getNgram(bucket, poolSize - numGuesses + gi);
+        for (SizeType32 ni = 0; ni < n - 1; ++ni)
+        {
+            auto const idx = len + gi * (n - 1) + ni;
+            draftTokens[idx] = ngram[ni];
+            positionIds[idx] = offset + ni;
+            samplingMask[idx] = true;
+            guessTokens[gi * pastStride + ni] = ngram[ni];
+        }
+    }
+    state.guessSizes[batchSlot] = numGuesses;
+    params.draftLengths[batchIdx] = len + numGuesses * (n - 1);
+}
+
+__global__ void lookaheadUpdate(LookaheadDecodingState state, LookaheadUpdateParams params)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x);
+    if (batchIdx >= params.batchSize)
+    {
+        return;
+    }
+    auto const batchSlot = params.batchSlots[batchIdx];
+    auto const w = state.windowSizes[batchSlot];
+    auto const n = state.ngramSizes[batchSlot];
+    auto const g = state.guessSetSizes[batchSlot];
+    auto const filling = state.fillings[batchSlot];
+    auto const pastStride = state.maxN - 1;
+    auto const* sampled = params.sampledTokens + batchIdx * (params.maxDraftLen + 1);
+    auto* past = state.pastTokens + batchSlot * state.maxW * pastStride;
+    auto* golden = state.goldenTokens + batchSlot * (2 * state.maxN - 1);
+    NgramPool pool(state, batchSlot);
+
+    auto const newLastToken = sampled[0];
+    auto const prefill = n - 2 - filling;
+    auto const lookSize = 1 + prefill + filling * w;
+
+    // Advance the Jacobi window, each row of a full window yields an n-gram keyed by the token shifted out of it
+    for (SizeType32 wi = 0; wi < w; ++wi)
+    {
+        auto const sampledKey = sampled[prefill + wi * filling + filling];
+        auto* row = past + wi * pastStride;
+        if (filling < n - 1)
+        {
+            row[filling] = sampledKey;
+        }
+        else
+        {
+            auto const key = wi == 0 ? newLastToken : row[0];
+            for (SizeType32 ni = 1; ni < n - 1; ++ni)
+            {
+                row[ni - 1] = row[ni];
+            }
+            row[n - 2] = sampledKey;
+            pool.insert(key, row, n - 1, g);
+        }
+    }
+
+    // Verify the guesses against the model outputs and take the longest hit
+    auto const* guessTokens = state.guessTokens + batchSlot * state.maxG * pastStride;
+    auto const* goldens = sampled + lookSize;
+    auto const endId = params.endIds[batchSlot];
+    SizeType32 maxHit{0};
+    SizeType32 hitIdx{0};
+    for (SizeType32 gi = 0; gi < state.guessSizes[batchSlot]; ++gi)
+    {
+        SizeType32 hit{0};
+        for (SizeType32 ni = 0; ni < n - 1; ++ni)
+        {
+            auto const guess = guessTokens[gi * pastStride + ni];
+            auto const idx = gi * (n - 1) + ni;
+            auto const ok = ni == 0 ? newLastToken == guess : goldens[idx - 1] == guess;
+            if (!ok || guess == endId)
+            {
+                break;
+            }
+            ++hit;
+        }
+        if (hit > maxHit)
+        {
+            maxHit = hit;
+            hitIdx = gi;
+        }
+    }
+
+    auto* accepted = params.acceptedTokens + batchIdx * state.maxN;
+    auto* acceptedOffsets = params.acceptedOffsets + batchIdx * state.maxN;
+    accepted[0] = newLastToken;
+    acceptedOffsets[0] = 0;
+    for (SizeType32 hi = 0; hi < maxHit; ++hi)
+    {
+        accepted[1 + hi] = goldens[hitIdx * (n - 1) + hi];
+        acceptedOffsets[1 + hi] = lookSize + hitIdx * (n - 1) + hi;
+    }
+    auto const acceptedLen = maxHit + 1;
+    params.acceptedLengths[batchIdx] = acceptedLen;
+
+    // Append the accepted tokens to the golden tokens, add their n-grams to the pool and keep the last n - 1
+    for (SizeType32 ai = 0; ai < acceptedLen; ++ai)
+    {
+        golden[n - 1 + ai] = accepted[ai];
+    }
+    pool.accept(golden, n - 1 + acceptedLen, n, g);
+    for (SizeType32 ni = 0; ni < n - 1; ++ni)
+    {
+        golden[ni] = golden[ni + acceptedLen];
+    }
+
+    if (filling < n - 1)
+    {
+        state.fillings[batchSlot] = filling + 1;
+    }
+}
+
+} // namespace
+
+void invokeLookaheadSetup(LookaheadDecodingState const& state, LookaheadSetupParams const& params, cudaStream_t stream)
+{
+    state.checkParams();
+    params.checkParams();
+
+    SizeType32 constexpr BLOCK_SIZE = 256;
+    lookaheadSetup<<<params.batchSize, BLOCK_SIZE, 0, stream>>>(state, params);
+    sync_check_cuda_error();
+}
+
+void invokeLookaheadPrepare(
+    LookaheadDecodingState const& state, LookaheadPrepareParams const& params, cudaStream_t stream)
+{
+    state.checkParams();
+    params.checkParams();
+    TLLM_CHECK_WITH_INFO(params.maxDraftLen >= getLookaheadMaxDraftLen(state.maxW, state.maxN, state.maxG),
+        "maxDraftLen (%d) is too small for lookahead with w=%d, n=%d, g=%d", params.maxDraftLen, state.maxW,
+        state.maxN, state.maxG);
+
+    // The pool of a request is updated sequentially, one thread handles one request
+    SizeType32 constexpr BLOCK_SIZE = 32;
+    auto const grid = (params.batchSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    lookaheadPrepare<<<grid, BLOCK_SIZE, 0, stream>>>(state, params);
+    sync_check_cuda_error();
+}
+
+void invokeLookaheadUpdate(
+    LookaheadDecodingState const& state, LookaheadUpdateParams const& params, cudaStream_t stream)
+{
+    state.checkParams();
+    params.checkParams();
+    TLLM_CHECK_WITH_INFO(params.maxDraftLen >= getLookaheadMaxDraftLen(state.maxW, state.maxN, state.maxG),
+        "maxDraftLen (%d) is too small for lookahead with w=%d, n=%d, g=%d", params.maxDraftLen, state.maxW,
+        state.maxN, state.maxG);
+
+    SizeType32 constexpr BLOCK_SIZE = 32;
+    auto const grid = (params.batchSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    lookaheadUpdate<<<grid, BLOCK_SIZE, 0, stream>>>(state, params);
+    sync_check_cuda_error();
+}
+
+} // namespace tensorrt_llm::kernels::speculative_decoding
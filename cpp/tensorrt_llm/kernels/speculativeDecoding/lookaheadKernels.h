@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm::kernels::speculative_decoding
+{
+
+//! Device state of lookahead decoding of all requests, the GPU counterpart of layers::LookaheadAlgorithm and
+//! layers::LookaheadPoolManager. Each request owns an open-addressing hash table mapping a key token to its most
+//! recent n-grams. All buffers are indexed by batch slot and are kept on the device between the steps.
+struct LookaheadDecodingState
+{
+    //! [maxBatchSize, numPoolBuckets], key token of each bucket of the n-gram pool, -1 if empty
+    runtime::TokenIdType* poolKeys{nullptr};
+    //! [maxBatchSize, numPoolBuckets], number of n-grams stored in each bucket
+    runtime::SizeType32* poolSizes{nullptr};
+    //! [maxBatchSize, numPoolBuckets, maxG, maxN - 1], n-grams following each key token, oldest first
+    runtime::TokenIdType* poolNgrams{nullptr};
+    //! [maxBatchSize, maxN - 2], random tokens to prefill the lookahead branch
+    runtime::TokenIdType* prefills{nullptr};
+    //! [maxBatchSize, maxW, maxN - 1], Jacobi window of the lookahead branch
+    runtime::TokenIdType* pastTokens{nullptr};
+    //! [maxBatchSize, 2 * maxN - 1], tail of the accepted tokens
+    runtime::TokenIdType* goldenTokens{nullptr};
+    //! [maxBatchSize, maxG, maxN - 1], n-grams of the verification branch of the last prepare
+    runtime::TokenIdType* guessTokens{nullptr};
+    //! [maxBatchSize], number of n-grams in guessTokens
+    runtime::SizeType32* guessSizes{nullptr};
+    //! [maxBatchSize], number of filled columns of the Jacobi window, the window is filled when it reaches n - 1
+    runtime::SizeType32* fillings{nullptr};
+    //! [maxBatchSize], runtime window size w, n-gram size n and guess set size g per request
+    runtime::SizeType32* windowSizes{nullptr};
+    runtime::SizeType32* ngramSizes{nullptr};
+    runtime::SizeType32* guessSetSizes{nullptr};
+
+    //! Number of buckets of the n-gram pool of a request, a power of 2. Keys which do not fit are dropped.
+    runtime::SizeType32 numPoolBuckets{0};
+    runtime::SizeType32 maxW{0};
+    runtime::SizeType32 maxN{0};
+    runtime::SizeType32 maxG{0};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(poolKeys && poolSizes && poolNgrams);
+        TLLM_CHECK(prefills && pastTokens && goldenTokens && guessTokens && guessSizes && fillings);
+        TLLM_CHECK(windowSizes && ngramSizes && guessSetSizes);
+        TLLM_CHECK_WITH_INFO(numPoolBuckets > 0 && (numPoolBuckets & (numPoolBuckets - 1)) == 0,
+            "numPoolBuckets (%d) must be a power of 2", numPoolBuckets);
+        TLLM_CHECK(maxW > 0 && maxN > 2 && maxG > 0);
+    }
+};
+
+//! @brief Returns the maximum number of draft tokens prepared per request, excluding the golden token.
+[[nodiscard]] inline runtime::SizeType32 getLookaheadMaxDraftLen(
+    runtime::SizeType32 maxW, runtime::SizeType32 maxN, runtime::SizeType32 maxG)
+{
+    return (maxW + maxG) * (maxN - 1) - 1;
+}
+
+struct LookaheadSetupParams
+{
+    //! [batchSize, maxPromptLen], prompt of each request including the first generated token
+    runtime::TokenIdType const* prompts{nullptr};
+    //! [batchSize], at least n - 1 tokens
+    runtime::SizeType32 const* promptLengths{nullptr};
+    //! [batchSize], runtime w, n and g of each request, not exceeding maxW, maxN and maxG
+    runtime::SizeType32 const* windowSizes{nullptr};
+    runtime::SizeType32 const* ngramSizes{nullptr};
+    runtime::SizeType32 const* guessSetSizes{nullptr};
+    //! [batchSize], optional. Seeds of the random tokens drawn from the prompt to initialize the Jacobi window
+    uint64_t const* randomSeeds{nullptr};
+    //! [batchSize]
+    runtime::SizeType32 const* batchSlots{nullptr};
+    runtime::SizeType32 batchSize{0};
+    runtime::SizeType32 maxPromptLen{0};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(prompts && promptLengths && windowSizes && ngramSizes && guessSetSizes && batchSlots);
+        TLLM_CHECK(batchSize > 0 && maxPromptLen > 0);
+    }
+};
+
+struct LookaheadPrepareParams
+{
+    //! [batchSize], position id of the first draft token of each request, i.e. the sequence length
+    runtime::SizeType32 const* positionOffsets{nullptr};
+    //! [batchSize, maxDraftLen], output. Lookahead branch followed by the verification branch
+    runtime::TokenIdType* draftTokens{nullptr};
+    //! [batchSize, maxDraftLen], output
+    runtime::SizeType32* positionIds{nullptr};
+    //! [batchSize, maxDraftLen], output. Set for the draft tokens whose prediction is used by the update
+    bool* samplingMask{nullptr};
+    //! [batchSize], output. Number of draft tokens of each request
+    runtime::SizeType32* draftLengths{nullptr};
+    //! [batchSize]
+    runtime::SizeType32 const* batchSlots{nullptr};
+    runtime::SizeType32 batchSize{0};
+    //! at least getLookaheadMaxDraftLen(maxW, maxN, maxG)
+    runtime::SizeType32 maxDraftLen{0};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(positionOffsets && draftTokens && positionIds && samplingMask && draftLengths && batchSlots);
+        TLLM_CHECK(batchSize > 0 && maxDraftLen > 0);
+    }
+};
+
+struct LookaheadUpdateParams
+{
+    //! [batchSize, maxDraftLen + 1], tokens predicted by the model for the golden token and the draft tokens.
+    //! Only the positions set in the sampling mask are read.
+    runtime::TokenIdType const* sampledTokens{nullptr};
+    //! [maxBatchSize], EOS ids per request
+    runtime::TokenIdType const* endIds{nullptr};
+    //! [batchSize, maxN], output. Accepted tokens, starting with the new golden token
+    runtime::TokenIdType* acceptedTokens{nullptr};
+    //! [batchSize, maxN], output. Indices of the accepted tokens in sampledTokens
+    runtime::SizeType32* acceptedOffsets{nullptr};
+    //! [batchSize], output
+    runtime::SizeType32* acceptedLengths{nullptr};
+    //! [batchSize]
+    runtime::SizeType32 const* batchSlots{nullptr};
+    runtime::SizeType32 batchSize{0};
+    runtime::SizeType32 maxDraftLen{0};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(sampledTokens && endIds && acceptedTokens && acceptedOffsets && acceptedLengths && batchSlots);
+        TLLM_CHECK(batchSize > 0 && maxDraftLen > 0);
+    }
+};
+
+//! @brief Initializes the lookahead state of the requests at their batch slots from their prompts.
+//! Clears the n-gram pools and fills them with all n-grams of the prompts, draws the prefill and the first column
+//! of the Jacobi window from the prompt tokens and copies the tail of the prompts to the golden tokens.
+void invokeLookaheadSetup(LookaheadDecodingState const& state, LookaheadSetupParams const& params, cudaStream_t stream);
+
+//! @brief Prepares the draft tokens of all lookahead requests for the next step: the lookahead branch from the
+//! Jacobi window and the verification branch from the n-grams of the pool following the last golden token.
+//! The n-grams of the verification branch are kept in the state for the update.
+void invokeLookaheadPrepare(
+    LookaheadDecodingState const& state, LookaheadPrepareParams const& params, cudaStream_t stream);
+
+//! @brief Updates the lookahead state of all requests from the tokens predicted by the model in one launch.
+//! Shifts the Jacobi window and inserts its n-grams into the pool, verifies the verification branch and returns the
+//! longest accepted n-gram. The accepted tokens are appended to the golden tokens and their n-grams are inserted.
+void invokeLookaheadUpdate(
+    LookaheadDecodingState const& state, LookaheadUpdateParams const& params, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels::speculative_decoding
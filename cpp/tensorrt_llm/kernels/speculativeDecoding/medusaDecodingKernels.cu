@@ -226,4 +226,154 @@ void scatterMedusaDraftTokens(TokenIdType* treeDraftIds, TokenIdType const* sour
     scatterMedusaDraftTokens<<<batchSize, BLOCK_SIZE, 0, stream>>>(
         treeDraftIds, sourceDraftIds, treeIds, tokensPerStep, batchSlots, maxDecodingTokens);
 }
+namespace
+{
+__global__ void pruneMedusaTree(MedusaTreePruningParams params)
+{
+    extern __shared__ char smem[];
+    auto const maxDecodingTokens = params.maxDecodingTokens;
+    auto* pathProbs = reinterpret_cast<float*>(smem);
+    auto* newIds = reinterpret_cast<SizeType32*>(pathProbs + maxDecodingTokens);
+    auto* hasChild = reinterpret_cast<bool*>(newIds + maxDecodingTokens);
+    __shared__ SizeType32 numNodes;
+    __shared__ SizeType32 numLeaves;
+
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = params.batchSlots[batchIdx];
+    auto const ni = static_cast<SizeType32>(threadIdx.x);
+    auto const maxNumNodes = params.maxNumNodes ? params.maxNumNodes[batchSlot] : maxDecodingTokens;
+    auto const minPathProb = params.minPathProbs ? params.minPathProbs[batchSlot] : 0.f;
+    auto const pathWidth = params.maxDraftPathLen + 1;
+    auto const* parents = params.treeParents + batchSlot * maxDecodingTokens;
+
+    // Nodes which are not part of the full tree are the ones without a parent after the root
+    auto const inTree = ni < maxDecodingTokens && (ni == 0 || parents[ni] >= 0);
+    SizeType32 depth{0};
+    if (ni < maxDecodingTokens)
+    {
+        float pathProb{1.f};
+        for (auto node = ni; inTree && node > 0; node = parents[node])
+        {
+            pathProb *= params.nodeProbs[batchIdx * maxDecodingTokens + node];
+            ++depth;
+        }
+        pathProbs[ni] = inTree ? pathProb : -1.f;
+        hasChild[ni] = false;
+        for (SizeType32 mi = 0; mi < params.numPackedMasks; ++mi)
+        {
+            params.packedMasks[(batchSlot * maxDecodingTokens + ni) * params.numPackedMasks + mi] = 0;
+        }
+        for (SizeType32 di = 0; di < pathWidth; ++di)
+        {
+            params.paths[(batchSlot * maxDecodingTokens + ni) * pathWidth + di] = -1;
+        }
+    }
+    if (ni == 0)
+    {
+        numNodes = 0;
+        numLeaves = 0;
+    }
+    __syncthreads();
+
+    // Rank of the node by path probability, ties go to the node coming first to rank parents before their children
+    bool keep{false};
+    if (inTree)
+    {
+        SizeType32 rank{0};
+        auto const pathProb = pathProbs[ni];
+        for (SizeType32 mi = 0; mi < maxDecodingTokens; ++mi)
+        {
+            rank += pathProbs[mi] > pathProb || (pathProbs[mi] == pathProb && mi < ni) ? 1 : 0;
+        }
+        keep = ni == 0 || (rank < maxNumNodes && pathProb >= minPathProb);
+    }
+    __syncthreads();
+    if (ni < maxDecodingTokens)
+    {
+        // Reuse the probabilities as the keep flags to get the compacted index of the node
+        pathProbs[ni] = keep ? 1.f : 0.f;
+    }
+    __syncthreads();
+    if (keep)
+    {
+        SizeType32 newId{0};
+        for (SizeType32 mi = 0; mi < ni; ++mi)
+        {
+            newId += pathProbs[mi] > 0.f ? 1 : 0;
+        }
+        newIds[ni] = newId;
+        if (ni > 0)
+        {
+            hasChild[parents[ni]] = true;
+        }
+        atomicAdd(&numNodes, 1);
+    }
+    __syncthreads();
+
+    if (keep)
+    {
+        auto const newId = newIds[ni];
+        params.prunedNodeIds[batchSlot * maxDecodingTokens + newId] = ni;
+        params.positionOffsets[batchSlot * maxDecodingTokens + newId] = depth;
+        if (newId > 0)
+        {
+            params.prunedDraftIds[batchSlot * (maxDecodingTokens - 1) + newId - 1]
+                = params.treeDraftIds[batchSlot * (maxDecodingTokens - 1) + ni - 1];
+        }
+
+        // The mask row of a node is only written by its own thread, it has been cleared by the thread of the same
+        // index since the compacted index is never larger than the original one
+        auto* mask = params.packedMasks + (batchSlot * maxDecodingTokens + newId) * params.numPackedMasks;
+        for (auto node = ni;; node = parents[node])
+        {
+            auto const ancestorId = newIds[node];
+            mask[ancestorId / 32] |= 1 << (ancestorId % 32);
+            if (node == 0)
+            {
+                break;
+            }
+        }
+
+        if (!hasChild[ni])
+        {
+            auto const pathIdx = atomicAdd(&numLeaves, 1);
+            auto* path = params.paths + (batchSlot * maxDecodingTokens + pathIdx) * pathWidth;
+            auto di = depth;
+            for (auto node = ni;; node = parents[node], --di)
+            {
+                path[di] = newIds[node];
+                if (node == 0)
+                {
+                    break;
+                }
+            }
+        }
+    }
+    __syncthreads();
+
+    if (ni == 0)
+    {
+        params.generationLengths[batchSlot] = numNodes;
+    }
+    else if (ni < maxDecodingTokens)
+    {
+        // Remaining rows of the pruned tree are not used
+        if (ni >= numNodes)
+        {
+            params.prunedNodeIds[batchSlot * maxDecodingTokens + ni] = -1;
+            params.positionOffsets[batchSlot * maxDecodingTokens + ni] = -1;
+            params.prunedDraftIds[batchSlot * (maxDecodingTokens - 1) + ni - 1] = -1;
+        }
+    }
+}
+} // namespace
+
+void invokePruneMedusaTree(MedusaTreePruningParams const& params, cudaStream_t stream)
+{
+    params.checkParams();
+    auto const blockSize = divUp(params.maxDecodingTokens, 32) * 32;
+    auto const smemSize = params.maxDecodingTokens * (sizeof(float) + sizeof(SizeType32) + sizeof(bool));
+    pruneMedusaTree<<<params.batchSize, blockSize, smemSize, stream>>>(params);
+    sync_check_cuda_error();
+}
 } // namespace tensorrt_llm::kernels::speculative_decoding
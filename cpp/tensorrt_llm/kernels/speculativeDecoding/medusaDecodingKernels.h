@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/kernels/decodingCommon.h"
 #include "tensorrt_llm/kernels/speculativeDecoding/common.h"
 #include "tensorrt_llm/runtime/common.h"
@@ -86,4 +87,60 @@ void scatterMedusaDraftTokens(runtime::TokenIdType* treeDraftIds, runtime::Token
     runtime::SizeType32 const* treeIds, runtime::SizeType32 const* tokensPerStep, runtime::SizeType32 const* batchSlots,
     runtime::SizeType32 maxDecodingTokens, runtime::SizeType32 batchSize, cudaStream_t stream);
 
+struct MedusaTreePruningParams
+{
+    //! [maxBatchSize, maxDecodingTokens], parent of each node of the full tree of the request, -1 for the root.
+    //! Nodes are in the linear order of the tree, a parent comes before its children.
+    runtime::SizeType32 const* treeParents{nullptr};
+    //! [batchSize, maxDecodingTokens], probability of the token of each node given by its Medusa head.
+    //! The value of the root is not read.
+    float const* nodeProbs{nullptr};
+    //! [maxBatchSize, maxDecodingTokens - 1], draft tokens of the full tree, output of scatterMedusaDraftTokens
+    runtime::TokenIdType const* treeDraftIds{nullptr};
+    //! [maxBatchSize], optional. Maximum number of decoding tokens of each request including the root
+    runtime::SizeType32 const* maxNumNodes{nullptr};
+    //! [maxBatchSize], optional. Nodes whose path probability is below it are pruned
+    float const* minPathProbs{nullptr};
+
+    //! [maxBatchSize, maxDecodingTokens - 1], output. Draft tokens of the pruned tree
+    runtime::TokenIdType* prunedDraftIds{nullptr};
+    //! [maxBatchSize, maxDecodingTokens], output. Index of each node of the pruned tree in the full tree
+    runtime::SizeType32* prunedNodeIds{nullptr};
+    //! [maxBatchSize], output. Number of nodes of the pruned tree, i.e. the generation length of the next step
+    runtime::SizeType32* generationLengths{nullptr};
+    //! [maxBatchSize, maxDecodingTokens], output. Depth of each node
+    runtime::SizeType32* positionOffsets{nullptr};
+    //! [maxBatchSize, maxDecodingTokens, numPackedMasks], output. Bit j of row i is set if node j is node i
+    //! or one of its ancestors
+    runtime::SizeType32* packedMasks{nullptr};
+    //! [maxBatchSize, maxDecodingTokens, maxDraftPathLen + 1], output. Root-to-leaf paths of the pruned tree,
+    //! the layout read by acceptDraftTokensByIdsWithPaths
+    runtime::SizeType32* paths{nullptr};
+
+    //! [batchSize]
+    runtime::SizeType32 const* batchSlots{nullptr};
+    runtime::SizeType32 batchSize{0};
+    runtime::SizeType32 maxDecodingTokens{0};
+    runtime::SizeType32 maxDraftPathLen{0};
+    runtime::SizeType32 numPackedMasks{0};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(treeParents && nodeProbs && treeDraftIds && batchSlots);
+        TLLM_CHECK(prunedDraftIds && prunedNodeIds && generationLengths && positionOffsets && packedMasks && paths);
+        TLLM_CHECK(batchSize > 0 && maxDraftPathLen > 0);
+        TLLM_CHECK_WITH_INFO(maxDecodingTokens > 1 && maxDecodingTokens <= 1024,
+            "maxDecodingTokens (%d) must be in [2, 1024]", maxDecodingTokens);
+        TLLM_CHECK(numPackedMasks * 32 >= maxDecodingTokens);
+    }
+};
+
+//! \brief Prunes the Medusa tree of each request to the nodes with the most probable paths and builds the packed
+//! attention masks, position offsets and paths of the pruned tree on the device. The path probability of a node is
+//! the product of the probabilities of the nodes from the root to it. A request keeps its maxNumNodes most probable
+//! nodes above minPathProbs, which is always a subtree since no node is more probable than its parent. Confident
+//! requests thus extend their deepest paths while uncertain ones spend the tokens on wider or shallower trees.
+//! The pruned tree keeps the linear order of the full tree.
+void invokePruneMedusaTree(MedusaTreePruningParams const& params, cudaStream_t stream);
+
 } // namespace tensorrt_llm::kernels::speculative_decoding
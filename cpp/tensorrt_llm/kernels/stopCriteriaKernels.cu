@@ -188,6 +188,32 @@ void invokeLengthCriterion(FinishedState* finished, SizeType32* finishedSum, Siz
     sync_check_cuda_error();
 }
 
+__global__ void allFinishedCriterion(bool* allFinished, SizeType32 const* finishedSum, SizeType32 const* batchSlots,
+    SizeType32 batchSize, SizeType32 numToFinish)
+{
+    SizeType32 threadFinishedCount = 0;
+    for (auto batchIdx = static_cast<SizeType32>(threadIdx.x); batchIdx < batchSize;
+         batchIdx += static_cast<SizeType32>(blockDim.x))
+    {
+        auto const batchSlot = batchSlots != nullptr ? batchSlots[batchIdx] : batchIdx;
+        threadFinishedCount += finishedSum[batchSlot];
+    }
+    auto const blockFinishedCount = blockReduceSum(threadFinishedCount);
+    if (threadIdx.x == 0)
+    {
+        *allFinished = blockFinishedCount == numToFinish;
+    }
+}
+
+void invokeAllFinished(bool* allFinished, SizeType32 const* finishedSum, SizeType32 const* batchSlots,
+    SizeType32 batchSize, SizeType32 numToFinish, cudaStream_t stream)
+{
+    // A single block, the batch is small and the result is read by the next step only
+    SizeType32 constexpr blockSize{256};
+    allFinishedCriterion<<<1, blockSize, 0, stream>>>(allFinished, finishedSum, batchSlots, batchSize, numToFinish);
+    sync_check_cuda_error();
+}
+
 __global__ void explicitEOSCriterion(TokenIdType const** outputIds, TokenIdType const* endIds, FinishedState* finished,
     SizeType32* sequenceLengths, SizeType32 const* tokensPerStep, SizeType32 const* batchSlots, SizeType32 batchSize,
     SizeType32 maxTokensPerStep)
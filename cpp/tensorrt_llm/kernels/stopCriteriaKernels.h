@@ -71,6 +71,18 @@ void invokeLengthCriterion(FinishedState* finished, runtime::SizeType32* finishe
     runtime::SizeType32 const* batchSlots, runtime::SizeType32 batchSize, runtime::SizeType32 beamWidth,
     cudaStream_t stream);
 
+//! \brief Sets whether all the sequences of the batch are finished, on the device, so that the decoding loop can be
+//! captured in a CUDA graph without reading the finished sums back to the host.
+//!
+//! \param allFinished output buffer [1]. True if the sum of finishedSum equals numToFinish
+//! \param finishedSum input buffer [maxBatchSize]. Number of finished beams per request, set by invokeLengthCriterion
+//! \param batchSlots input buffer[batchSize], optional. Indices of rows of data in memory pool
+//! \param batchSize batch size
+//! \param numToFinish number of beams of the batch
+//! \param stream stream
+void invokeAllFinished(bool* allFinished, runtime::SizeType32 const* finishedSum, runtime::SizeType32 const* batchSlots,
+    runtime::SizeType32 batchSize, runtime::SizeType32 numToFinish, cudaStream_t stream);
+
 //! \brief Sets finished states based on the endIds and ajusts sequence length to length before the first EOS token.
 //! Does not support beamWidth > 1 for now.
 //!
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/tokenMaskAutomaton.h"
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+template <typename T>
+__global__ void applyTokenMaskAutomaton(T* logits, SizeType32 const* const* automatonPtrs, SizeType32* states,
+    SizeType32* consumedLengths, TokenIdType const* const* outputIdsPtr, SizeType32 const* sequenceLengths,
+    TokenIdType const* endIds, SizeType32 const* batchSlots, SizeType32 vocabSize, SizeType32 vocabSizePadded)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = batchSlots != nullptr ? batchSlots[batchIdx] : batchIdx;
+    auto const* transitions = automatonPtrs[batchSlot];
+    if (transitions == nullptr)
+    {
+        return;
+    }
+
+    __shared__ SizeType32 state;
+    if (threadIdx.x == 0)
+    {
+        auto currentState = states[batchSlot];
+        auto const consumedLength = consumedLengths[batchSlot];
+        auto const sequenceLength = sequenceLengths[batchSlot];
+        // After a reset the prompt is not fed to the automaton
+        if (consumedLength >= 0)
+        {
+            for (auto pos = consumedLength; pos < sequenceLength && currentState >= 0; ++pos)
+            {
+                auto const token = outputIdsPtr[batchSlot][pos];
+                currentState = (0 <= token && token < vocabSize)
+                    ? transitions[static_cast<std::size_t>(currentState) * vocabSize + token]
+                    : -1;
+            }
+        }
+        states[batchSlot] = currentState;
+        consumedLengths[batchSlot] = sequenceLength;
+        state = currentState;
+    }
+    __syncthreads();
+
+    auto const endId = endIds[batchSlot];
+    auto* batchLogits = logits + static_cast<std::size_t>(batchIdx) * vocabSizePadded;
+    auto const* stateTransitions = state >= 0 ? transitions + static_cast<std::size_t>(state) * vocabSize : nullptr;
+    for (auto tokenIdx = static_cast<SizeType32>(threadIdx.x); tokenIdx < vocabSizePadded; tokenIdx += blockDim.x)
+    {
+        bool const allowed = stateTransitions != nullptr
+            ? tokenIdx < vocabSize && stateTransitions[tokenIdx] >= 0
+            : tokenIdx == endId;
+        if (!allowed)
+        {
+            batchLogits[tokenIdx] = static_cast<T>(-INFINITY);
+        }
+    }
+}
+
+template <typename T>
+void invokeApplyTokenMaskAutomaton(T* logits, SizeType32 const* const* automatonPtrs, SizeType32* states,
+    SizeType32* consumedLengths, TokenIdType const* const* outputIdsPtr, SizeType32 const* sequenceLengths,
+    TokenIdType const* endIds, SizeType32 const* batchSlots, SizeType32 batchSize, SizeType32 vocabSize,
+    SizeType32 vocabSizePadded, cudaStream_t stream)
+{
+    dim3 const block(min(((vocabSizePadded + 31) / 32) * 32, 1024));
+    dim3 const grid(batchSize);
+    applyTokenMaskAutomaton<<<grid, block, 0, stream>>>(logits, automatonPtrs, states, consumedLengths, outputIdsPtr,
+        sequenceLengths, endIds, batchSlots, vocabSize, vocabSizePadded);
+    sync_check_cuda_error();
+}
+
+template void invokeApplyTokenMaskAutomaton(float* logits, SizeType32 const* const* automatonPtrs, SizeType32* states,
+    SizeType32* consumedLengths, TokenIdType const* const* outputIdsPtr, SizeType32 const* sequenceLengths,
+    TokenIdType const* endIds, SizeType32 const* batchSlots, SizeType32 batchSize, SizeType32 vocabSize,
+    SizeType32 vocabSizePadded, cudaStream_t stream);
+
+template void invokeApplyTokenMaskAutomaton(half* logits, SizeType32 const* const* automatonPtrs, SizeType32* states,
+    SizeType32* consumedLengths, TokenIdType const* const* outputIdsPtr, SizeType32 const* sequenceLengths,
+    TokenIdType const* endIds, SizeType32 const* batchSlots, SizeType32 batchSize, SizeType32 vocabSize,
+    SizeType32 vocabSizePadded, cudaStream_t stream);
+
+__global__ void resetTokenMaskAutomaton(
+    SizeType32* states, SizeType32* consumedLengths, SizeType32 const* batchSlots, SizeType32 batchSize)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x);
+    if (batchIdx < batchSize)
+    {
+        auto const batchSlot = batchSlots[batchIdx];
+        states[batchSlot] = 0;
+        consumedLengths[batchSlot] = -1;
+    }
+}
+
+void invokeResetTokenMaskAutomaton(SizeType32* states, SizeType32* consumedLengths, SizeType32 const* batchSlots,
+    SizeType32 batchSize, cudaStream_t stream)
+{
+    SizeType32 constexpr blockSize{256};
+    auto const gridSize = (batchSize + blockSize - 1) / blockSize;
+    resetTokenMaskAutomaton<<<gridSize, blockSize, 0, stream>>>(states, consumedLengths, batchSlots, batchSize);
+    sync_check_cuda_error();
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
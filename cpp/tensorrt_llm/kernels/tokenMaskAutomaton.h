@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include <cuda_fp16.h>
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+//! \brief Constrain generation with token level automata (e.g. compiled from a JSON schema or a regex).
+//!
+//! The automaton of a request is a dense transition table [numStates, vocabSize] on the GPU holding the next state
+//! for every token, or -1 if the token is not allowed in that state. State 0 is the initial state, the end id must
+//! only be allowed in accepting states. Requests without automaton have a nullptr table.
+//!
+//! Before masking, the state of a request is advanced on the device over the tokens generated since the last call,
+//! read from outputIdsPtr, so no host round trip happens between sampling and the next step. Then every token not
+//! allowed in the current state gets -inf logits. If the automaton was left (a token was forced outside of it), only
+//! endId is allowed.
+//!
+//! \param logits [batchSize, vocabSizePadded], modified in place
+//! \param automatonPtrs [maxBatchSize] transition tables, indexed by batch slot
+//! \param states [maxBatchSize] current automaton state of each request
+//! \param consumedLengths [maxBatchSize] sequence length the state corresponds to, -1 after a reset
+//! \param outputIdsPtr [maxBatchSize][maxSeqLen] output ids
+//! \param sequenceLengths [maxBatchSize] current sequence lengths
+//! \param endIds [maxBatchSize]
+//! \param batchSlots [batchSize], nullptr if batch slots are 0..batchSize-1
+template <typename T>
+void invokeApplyTokenMaskAutomaton(T* logits, runtime::SizeType32 const* const* automatonPtrs,
+    runtime::SizeType32* states, runtime::SizeType32* consumedLengths, runtime::TokenIdType const* const* outputIdsPtr,
+    runtime::SizeType32 const* sequenceLengths, runtime::TokenIdType const* endIds,
+    runtime::SizeType32 const* batchSlots, runtime::SizeType32 batchSize, runtime::SizeType32 vocabSize,
+    runtime::SizeType32 vocabSizePadded, cudaStream_t stream);
+
+//! \brief Put the automata of the given batch slots back into their initial state.
+//! \param batchSlots [batchSize] on the GPU
+void invokeResetTokenMaskAutomaton(runtime::SizeType32* states, runtime::SizeType32* consumedLengths,
+    runtime::SizeType32 const* batchSlots, runtime::SizeType32 batchSize, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
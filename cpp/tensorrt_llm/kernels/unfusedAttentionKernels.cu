@@ -22,6 +22,7 @@
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttentionUtils.h"
 #include "tensorrt_llm/kernels/gptKernels.h"
 #include "tensorrt_llm/kernels/kvCacheUtils.h"
+#include "tensorrt_llm/kernels/relativeAttentionBucket.cuh"
 #include "tensorrt_llm/kernels/unfusedAttentionKernels.h"
 
 using namespace tensorrt_llm::common;
@@ -1618,7 +1619,7 @@ INSTANTIATE_TRANSPOSE_4D(half);
 template <typename T, typename T_cache, typename KVCacheBuffer>
 __global__ void transpose4dBatchMajorKVCache(T const* kSrc, T const* vSrc, KVCacheBuffer kvCacheBuffer,
     int const headNum, int const sizePerHead, int const seqLen, int const attentionWindowSize,
-    float const* kvScaleOrigQuant, int const* sequence_lengths)
+    float const* kvScaleOrigQuant, bool const kvScalePerHead, int const* sequence_lengths)
 {
     // We allow only fp32/fp16/bf16 as input types
     static_assert(sizeof(T) == 4 || sizeof(T) == 2, "");
@@ -1678,7 +1679,7 @@ __global__ void transpose4dBatchMajorKVCache(T const* kSrc, T const* vSrc, KVCac
         // Cast float scale to dst data type.
         using T_scale = typename mmha::kv_cache_scale_type_t<T, T_cache>::Type;
         T_scale scaleOrigQuant;
-        mmha::convert_from_float(&scaleOrigQuant, kvScaleOrigQuant[0]);
+        mmha::convert_from_float(&scaleOrigQuant, kvScaleOrigQuant[kvScalePerHead ? headIdx : 0]);
         // Store 8bits kv cache.
         mmha::store_8bits_kv_cache_vec(valDst, val, inBlockIdx, scaleOrigQuant);
     }
@@ -1691,7 +1692,8 @@ __global__ void transpose4dBatchMajorKVCache(T const* kSrc, T const* vSrc, KVCac
 template <typename T, typename KVCacheBuffer>
 void invokeTranspose4dBatchMajor(T const* kSrc, T const* vSrc, KVCacheBuffer& kvTable, int const localBatchSize,
     int const seqLen, int const attentionWindowSize, int const sizePerHead, int const localHeadNum,
-    const KvCacheDataType cache_type, float const* kvScaleOrigQuant, int const* sequence_lengths, cudaStream_t stream)
+    const KvCacheDataType cache_type, float const* kvScaleOrigQuant, bool const kvScalePerHead,
+    int const* sequence_lengths, cudaStream_t stream)
 {
     // Block handles both K and V tile.
     dim3 blockSz(128, 2);
@@ -1703,19 +1705,20 @@ void invokeTranspose4dBatchMajor(T const* kSrc, T const* vSrc, KVCacheBuffer& kv
     if (cache_type == KvCacheDataType::INT8)
     {
         transpose4dBatchMajorKVCache<T, int8_t, KVCacheBuffer><<<gridSz, blockSz, 0, stream>>>(kSrc, vSrc, kvTable,
-            localHeadNum, sizePerHead, seqLen, attentionWindowSize, kvScaleOrigQuant, sequence_lengths);
+            localHeadNum, sizePerHead, seqLen, attentionWindowSize, kvScaleOrigQuant, kvScalePerHead, sequence_lengths);
     }
 #ifdef ENABLE_FP8
     else if (cache_type == KvCacheDataType::FP8)
     {
         transpose4dBatchMajorKVCache<T, __nv_fp8_e4m3, KVCacheBuffer><<<gridSz, blockSz, 0, stream>>>(kSrc, vSrc,
-            kvTable, localHeadNum, sizePerHead, seqLen, attentionWindowSize, kvScaleOrigQuant, sequence_lengths);
+            kvTable, localHeadNum, sizePerHead, seqLen, attentionWindowSize, kvScaleOrigQuant, kvScalePerHead,
+            sequence_lengths);
     }
 #endif // ENABLE_FP8
     else
     {
         transpose4dBatchMajorKVCache<T, T, KVCacheBuffer><<<gridSz, blockSz, 0, stream>>>(kSrc, vSrc, kvTable,
-            localHeadNum, sizePerHead, seqLen, attentionWindowSize, kvScaleOrigQuant, sequence_lengths);
+            localHeadNum, sizePerHead, seqLen, attentionWindowSize, kvScaleOrigQuant, kvScalePerHead, sequence_lengths);
     }
 }
 
@@ -1723,7 +1726,7 @@ void invokeTranspose4dBatchMajor(T const* kSrc, T const* vSrc, KVCacheBuffer& kv
     template void invokeTranspose4dBatchMajor(const T* kSrc, const T* vSrc, KVCacheBuffer& kvTable,                    \
         const int localBatchSize, const int seqLen, const int attentionWindowSize, const int sizePerHead,              \
         const int localHeadNum, const KvCacheDataType cache_type, const float* kvScaleOrigQuant,                       \
-        const int* sequence_lengths, cudaStream_t stream)
+        const bool kvScalePerHead, const int* sequence_lengths, cudaStream_t stream)
 
 #define INSTANTIATE_TRANSPOSE_4D_BATCH_MAJOR(T)                                                                        \
     INSTANTIATE_TRANSPOSE_4D_BATCH_MAJOR_KV_CACHE_TYPE(T, KVBlockArray);                                               \
@@ -1746,7 +1749,7 @@ __global__ void addRelativeAttentionBiasUnaligned(T* qk_buf, const BT* relative_
     int const seq_i = blockIdx.x;
     int const batch_id = blockIdx.y / head_num;
     int const head_id = blockIdx.y % head_num;
-    int const rel_attn_table_stride = num_buckets; // num_buckets could be modified below, save it beforehand
+    RelativeAttentionBucketizer const bucketizer(num_buckets, max_distance, bidirectional);
 
     for (int seq_j = threadIdx.x; seq_j < seq_len; seq_j += blockDim.x)
     {
@@ -1756,30 +1759,9 @@ __global__ void addRelativeAttentionBiasUnaligned(T* qk_buf, const BT* relative_
 
         if (implicit)
         {
-            // compute bias value on the fly (see bert_preprocess_kernels.cu::buildRelativeAttentionBias)
-            int relative_buckets = 0;
-            int relative_position = seq_j - seq_i;
-
-            // special logic in T5 relative attention. bidirectional=true for encoder, false for decoder
-            if (bidirectional)
-            {
-                num_buckets /= 2;
-                relative_buckets += relative_position > 0 ? num_buckets : 0;
-                relative_position = abs(relative_position);
-            }
-            else
-            {
-                relative_position = relative_position > 0 ? 0 : -relative_position;
-            }
-
-            int max_exact = num_buckets / 2;
-            bool is_small = relative_position < max_exact;
-            int relative_position_if_large = max_exact
-                + (int) (logf(relative_position * 1.0f / max_exact) / logf((float) max_distance / max_exact)
-                    * (num_buckets - max_exact));
-            relative_position_if_large = min(relative_position_if_large, num_buckets - 1);
-            relative_buckets += is_small ? relative_position : relative_position_if_large;
-            BT rel_attn_bias = relative_attention_bias[head_id * rel_attn_table_stride + relative_buckets];
+            // compute bias value on the fly from the [head_num, num_buckets] table
+            int const relative_buckets = bucketizer(seq_j - seq_i);
+            BT rel_attn_bias = relative_attention_bias[head_id * num_buckets + relative_buckets];
             qk_buf[qk_index] = (T) add((T) rel_attn_bias, qk_buf[qk_index]);
         }
         else
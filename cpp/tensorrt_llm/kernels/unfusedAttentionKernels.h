@@ -95,6 +95,8 @@ struct QKVPreprocessingParams
     // shape is {rotary_embedding_max_positions, rotary_embedding_dim}. eg (2048, 128)
     float2 const* rotary_coef_cache_buffer{nullptr};
     float const* kvScaleOrigQuant{nullptr};
+    // Paged KV FP8 FMHA reads K from the fp8 kv cache, so its dequantization scale is applied to the quantized Q.
+    float const* kvScaleQuantOrig{nullptr};
     int const* spec_decoding_position_offsets{nullptr};
 
     // Scalars.
@@ -119,6 +121,8 @@ struct QKVPreprocessingParams
     KvCacheDataType cache_type{};
     bool enable_paged_kv_fmha{false};
     bool quantized_fp8_output{false};
+    // The kv cache scales have one value per kv head instead of one per tensor.
+    bool kv_scale_per_head{false};
     int multi_processor_count{0};
     int rotary_vision_start{0};
     int rotary_vision_length{0};
@@ -160,6 +164,7 @@ struct QKVPreprocessingParams
                   runtime::ITensor::makeShape({batch_size, rotary_embedding_dim / 2})));
         ss << "rotary_coef_cache_buffer: " << rotary_coef_cache_buffer << std::endl;
         ss << "kvScaleOrigQuant: " << kvScaleOrigQuant << std::endl;
+        ss << "kvScaleQuantOrig: " << kvScaleQuantOrig << std::endl;
         ss << "spec_decoding_position_offsets: " << spec_decoding_position_offsets << std::endl;
         ss << "batch_size: " << batch_size << std::endl;
         ss << "max_input_seq_len: " << max_input_seq_len << std::endl;
@@ -181,6 +186,7 @@ struct QKVPreprocessingParams
         ss << "cache_type: " << static_cast<int>(cache_type) << std::endl;
         ss << "enable_paged_kv_fmha: " << std::boolalpha << enable_paged_kv_fmha << std::endl;
         ss << "quantized_fp8_output: " << quantized_fp8_output << std::endl;
+        ss << "kv_scale_per_head: " << kv_scale_per_head << std::endl;
         ss << "multi_processor_count: " << multi_processor_count << std::endl;
 
         return ss.str();
@@ -237,7 +243,8 @@ void invokeAddFusedQKVBiasTranspose(T* q_buf, T* k_buf, T* v_buf, T* QKV, int co
 template <typename T, typename KVCacheBuffer>
 void invokeTranspose4dBatchMajor(T const* k_src, T const* v_src, KVCacheBuffer& kvTable, int const local_batch_size,
     int const seq_len, int const max_attention_window_size, int const size_per_head, int const local_head_num,
-    const KvCacheDataType cache_type, float const* kvScaleOrigQuant, int const* sequence_lengths, cudaStream_t stream);
+    const KvCacheDataType cache_type, float const* kvScaleOrigQuant, bool const kvScalePerHead,
+    int const* sequence_lengths, cudaStream_t stream);
 
 template <typename T, typename T_cache, typename KVCacheBuffer>
 void invokeApplyBiasRopeUpdateKVCacheDispatch(QKVPreprocessingParams<T, KVCacheBuffer> params, cudaStream_t stream);
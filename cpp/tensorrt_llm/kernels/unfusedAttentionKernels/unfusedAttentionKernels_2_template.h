@@ -358,6 +358,8 @@ __global__ void applyBiasRopeUpdateKVCache(QKVPreprocessingParams<T, KVCacheBuff
 
     int const hidden_idx = head_idx * params.size_per_head + head_dim_idx;
     int const kv_head_idx = head_idx / params.qheads_per_kv_head;
+    // The index of the 8bits kv cache scales.
+    [[maybe_unused]] int const kv_scale_idx = params.kv_scale_per_head ? kv_head_idx : 0;
     int const hidden_idx_kv = kv_head_idx * params.size_per_head + head_dim_idx;
     int const hidden_size = params.hidden_size;
     int const src_k_offset = params.q_hidden_size;
@@ -514,8 +516,19 @@ __global__ void applyBiasRopeUpdateKVCache(QKVPreprocessingParams<T, KVCacheBuff
 
                 if (params.quantized_fp8_output)
                 {
-                    // use 1.0f scale currently for qkv input of FP8 FMHA.
-                    mmha::convert_to_fp8(quantized_q_ptr, q);
+                    if constexpr (!STORE_QKV && ENABLE_8BITS_CACHE && !std::is_same_v<TCache, int8_t>)
+                    {
+                        // Paged KV FP8 FMHA: apply the dequantization scale of the fp8 K cache to Q.
+                        using TScale = typename mmha::kv_cache_scale_type_t<T, TCache>::Type;
+                        TScale scaleQuantOrig;
+                        mmha::convert_from_float(&scaleQuantOrig, params.kvScaleQuantOrig[kv_scale_idx]);
+                        mmha::convert_to_fp8(quantized_q_ptr, mmha::mul<VecType>(scaleQuantOrig, q));
+                    }
+                    else
+                    {
+                        // use 1.0f scale currently for qkv input of FP8 FMHA.
+                        mmha::convert_to_fp8(quantized_q_ptr, q);
+                    }
                 }
                 else
                 {
@@ -551,7 +564,7 @@ __global__ void applyBiasRopeUpdateKVCache(QKVPreprocessingParams<T, KVCacheBuff
                             // Cast float scale to dst data type.
                             using TScale = typename mmha::kv_cache_scale_type_t<T, TCache>::Type;
                             TScale scaleOrigQuant;
-                            mmha::convert_from_float(&scaleOrigQuant, params.kvScaleOrigQuant[0]);
+                            mmha::convert_from_float(&scaleOrigQuant, params.kvScaleOrigQuant[kv_scale_idx]);
                             // Store 8bits kv cache.
                             mmha::store_8bits_kv_cache_vec(kDst, k_to_cache, inBlockIdx, scaleOrigQuant);
                             mmha::store_8bits_kv_cache_vec(vDst, v, inBlockIdx, scaleOrigQuant);
@@ -674,6 +687,8 @@ __global__ void applyBiasRopeUpdateKVCacheV2(QKVPreprocessingParams<T, KVCacheBu
     float2 const masked_rotary_cos_sin = make_float2(1.0f, 0.0f);
     int const hidden_idx = head_idx * params.size_per_head + head_dim_idx;
     int const kv_head_idx = head_idx / params.qheads_per_kv_head;
+    // The index of the 8bits kv cache scales.
+    [[maybe_unused]] int const kv_scale_idx = params.kv_scale_per_head ? kv_head_idx : 0;
     int const hidden_idx_kv = kv_head_idx * params.size_per_head + head_dim_idx;
     int const src_k_offset = params.q_hidden_size;
     int const src_v_offset = src_k_offset + params.kv_hidden_size;
@@ -810,8 +825,19 @@ __global__ void applyBiasRopeUpdateKVCacheV2(QKVPreprocessingParams<T, KVCacheBu
 
             if (params.quantized_fp8_output)
             {
-                // use 1.0f scale currently for qkv input of FP8 FMHA.
-                mmha::convert_to_fp8(quantized_q_ptr, q);
+                if constexpr (!STORE_QKV && ENABLE_8BITS_CACHE && !std::is_same_v<TCache, int8_t>)
+                {
+                    // Paged KV FP8 FMHA: apply the dequantization scale of the fp8 K cache to Q.
+                    using TScale = typename mmha::kv_cache_scale_type_t<T, TCache>::Type;
+                    TScale scaleQuantOrig;
+                    mmha::convert_from_float(&scaleQuantOrig, params.kvScaleQuantOrig[kv_scale_idx]);
+                    mmha::convert_to_fp8(quantized_q_ptr, mmha::mul<VecT>(scaleQuantOrig, q));
+                }
+                else
+                {
+                    // use 1.0f scale currently for qkv input of FP8 FMHA.
+                    mmha::convert_to_fp8(quantized_q_ptr, q);
+                }
             }
             else
             {
@@ -849,7 +875,7 @@ __global__ void applyBiasRopeUpdateKVCacheV2(QKVPreprocessingParams<T, KVCacheBu
                         // Cast float scale to dst data type.
                         using TScale = typename mmha::kv_cache_scale_type_t<T, TCache>::Type;
                         TScale scaleOrigQuant;
-                        mmha::convert_from_float(&scaleOrigQuant, params.kvScaleOrigQuant[0]);
+                        mmha::convert_from_float(&scaleOrigQuant, params.kvScaleOrigQuant[kv_scale_idx]);
                         // Store 8bits kv cache.
                         mmha::store_8bits_kv_cache_vec(kDst, k, inBlockIdx, scaleOrigQuant);
                         mmha::store_8bits_kv_cache_vec(vDst, v, inBlockIdx, scaleOrigQuant);
@@ -1042,6 +1068,9 @@ void invokeApplyBiasRopeUpdateKVCacheDispatch(QKVPreprocessingParams<T, KVCacheB
         !(params.quantized_fp8_output && !params.enable_paged_kv_fmha && params.QuantizedQKV == nullptr)
             && !(params.quantized_fp8_output && params.enable_paged_kv_fmha && params.Q == nullptr),
         "Separate quantized buffer is not provided!");
+    TLLM_CHECK_WITH_INFO(!(params.quantized_fp8_output && params.enable_paged_kv_fmha && sizeof(TCache) == 1
+                             && params.kvScaleQuantOrig == nullptr),
+        "Paged KV FP8 FMHA needs the kv cache dequantization scale!");
 
     // Long-sequence-length that exceeds the max_position_size needs to compute the cos/sin on-the-fly.
     bool const long_seq_rotary_support = params.rotary_scale_type == RotaryScalingType::kDYNAMIC
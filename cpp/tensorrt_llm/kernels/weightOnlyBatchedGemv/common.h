@@ -57,6 +57,9 @@ KERNEL_TYPE_TRAITS_REGISTRY(KernelType::FP16Int4PerChannel, false, true);
 KERNEL_TYPE_TRAITS_REGISTRY(KernelType::BF16Int4PerChannel, false, true);
 #undef KERNEL_TYPE_TRAITS_REGISTRY
 
+// Largest M handled by the batched GEMV kernels, M up to 4 is a single tile and larger M is tiled by 4.
+constexpr int kMaxBatchedGemvM = 16;
+
 struct Params
 {
     using Pointer = void*;
@@ -75,6 +78,10 @@ struct Params
     int groupsize;
     KernelType type;
     bool apply_alpha_in_advance;
+    // Number of splits of K, run over gridDim.z and added to the output. Split-K needs SM80+ for BF16.
+    int split_k = 1;
+    // Gated MLP: the weight holds [x, gate] as 2 * n columns and out = x * silu(gate) is [m, n]. Needs split_k == 1.
+    bool gated = false;
 
     Params(ConstPointer _act, ConstPointer _act_scale, ConstPointer _weight, ConstPointer _scales, ConstPointer _zeros,
         ConstPointer _bias, Pointer _out, float _alpha, int _m, int _n, int _k, int _groupsize, KernelType _type,
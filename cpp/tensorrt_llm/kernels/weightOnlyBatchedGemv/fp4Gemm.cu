@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/kernels/weightOnlyBatchedGemv/fp4Gemm.h"
+#include <cub/cub.cuh>
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+#include <cuda_fp8.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+namespace fp4_gemm
+{
+namespace
+{
+// Weights handled by a thread per step, one 16 byte load per column
+constexpr SizeType32 kStepK = 32;
+constexpr SizeType32 kTileN = 2;
+
+// Moves the sign, exponent and mantissa of the e2m1 nibbles 0 and 1 of v to the top bits of two fp16 numbers. The
+// results are 2^-14 times the e2m1 values, the e2m1 subnormal 0.5 becoming an fp16 subnormal.
+__device__ __forceinline__ half2 fp4x2ToHalf2(uint32_t v)
+{
+    uint32_t const bits = ((v & 0x8) << 12) | ((v & 0x7) << 9) | ((v & 0x80) << 24) | ((v & 0x70) << 21);
+    return reinterpret_cast<half2 const&>(bits);
+}
+
+// Makes up for the 2^-14 of fp4x2ToHalf2
+constexpr float kFp4ToHalfScale = 16384.f;
+
+template <Fp4Format Format>
+__device__ __forceinline__ float blockScale(uint8_t scale)
+{
+    if constexpr (Format == Fp4Format::MXFP4)
+    {
+        // 2^(scale - 127)
+        return __uint_as_float(static_cast<uint32_t>(scale) << 23);
+    }
+    else
+    {
+        return static_cast<float>(reinterpret_cast<__nv_fp8_e4m3 const&>(scale));
+    }
+}
+
+template <typename T, Fp4Format Format, SizeType32 TILE_M, SizeType32 BLOCK_SIZE>
+__global__ void fp4Gemv(T const* __restrict__ act, uint8_t const* __restrict__ weight,
+    uint8_t const* __restrict__ blockScales, T const* __restrict__ bias, float alpha, T* __restrict__ output,
+    SizeType32 m, SizeType32 n, SizeType32 k)
+{
+    static constexpr SizeType32 kTileK = kStepK * BLOCK_SIZE;
+    static constexpr SizeType32 kBlockSize = getFp4BlockSize(Format);
+    static constexpr SizeType32 kScalesPerStep = kStepK / kBlockSize;
+    static constexpr SizeType32 kElemsPerAccessA = sizeof(float4) / sizeof(T);
+    auto const tileIdM = static_cast<SizeType32>(blockIdx.x * TILE_M);
+    auto const tileIdN = static_cast<SizeType32>(blockIdx.y * kTileN);
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+    SizeType32 const scalesPerRow = k / kBlockSize;
+    float tileA[kStepK], tileW[kTileN * kStepK];
+    float acc[TILE_M * kTileN];
+
+#pragma unroll
+    for (SizeType32 i = 0; i < TILE_M * kTileN; ++i)
+    {
+        acc[i] = 0;
+    }
+    act += tileIdM * k;
+    weight += tileIdN * k / 2;
+    blockScales += tileIdN * scalesPerRow;
+    output += tileIdM * n + tileIdN;
+    for (SizeType32 idxK = tid * kStepK; idxK < k; idxK += kTileK)
+    {
+#pragma unroll
+        for (SizeType32 i = 0; i < kTileN; ++i)
+        {
+            float scales[kScalesPerStep];
+#pragma unroll
+            for (SizeType32 s = 0; s < kScalesPerStep; ++s)
+            {
+                scales[s] = blockScale<Format>(blockScales[i * scalesPerRow + idxK / kBlockSize + s]) * kFp4ToHalfScale;
+            }
+            auto const packed = reinterpret_cast<int4 const*>(weight + (i * k + idxK) / 2)[0];
+            auto const* words = reinterpret_cast<uint32_t const*>(&packed);
+#pragma unroll
+            for (SizeType32 w = 0; w < 4; ++w)
+            {
+#pragma unroll
+                for (SizeType32 b = 0; b < 4; ++b)
+                {
+                    SizeType32 const e = w * 8 + b * 2;
+                    float2 const v = __half22float2(fp4x2ToHalf2(words[w] >> (8 * b)));
+                    tileW[i * kStepK + e] = v.x * scales[e / kBlockSize];
+                    tileW[i * kStepK + e + 1] = v.y * scales[e / kBlockSize];
+                }
+            }
+        }
+#pragma unroll
+        for (SizeType32 i = 0; i < TILE_M; ++i)
+        {
+#pragma unroll
+            for (SizeType32 v = 0; v < kStepK / kElemsPerAccessA; ++v)
+            {
+                auto const raw = reinterpret_cast<float4 const*>(act + i * k + idxK)[v];
+                auto const* elems = reinterpret_cast<T const*>(&raw);
+#pragma unroll
+                for (SizeType32 e = 0; e < kElemsPerAccessA; ++e)
+                {
+                    tileA[v * kElemsPerAccessA + e] = static_cast<float>(elems[e]);
+                }
+            }
+#pragma unroll
+            for (SizeType32 j = 0; j < kTileN; ++j)
+            {
+#pragma unroll
+                for (SizeType32 l = 0; l < kStepK; ++l)
+                {
+                    acc[i * kTileN + j] = fma(tileA[l], tileW[j * kStepK + l], acc[i * kTileN + j]);
+                }
+            }
+        }
+    }
+
+    typedef cub::WarpReduce<float> WarpReduce;
+
+    static constexpr SizeType32 kWarpSize = 32;
+    static constexpr SizeType32 kWarpNum = BLOCK_SIZE / kWarpSize;
+    SizeType32 warpId = tid / kWarpSize, laneId = tid % kWarpSize;
+    __shared__ float shmem[TILE_M * kTileN * kWarpNum];
+    __shared__ typename WarpReduce::TempStorage tempStorage[kWarpNum];
+#pragma unroll
+    for (SizeType32 mi = 0; mi < TILE_M; ++mi)
+    {
+#pragma unroll
+        for (SizeType32 ni = 0; ni < kTileN; ++ni)
+        {
+            float val = WarpReduce(tempStorage[warpId]).Sum(acc[mi * kTileN + ni]);
+            if (laneId == 0)
+            {
+                shmem[mi * kTileN + ni + warpId * TILE_M * kTileN] = val;
+            }
+        }
+    }
+    __syncthreads();
+#pragma unroll
+    for (SizeType32 ii = tid; ii < TILE_M * kTileN; ii += BLOCK_SIZE)
+    {
+        SizeType32 mid = ii / kTileN, nid = ii % kTileN;
+        float val = 0;
+#pragma unroll
+        for (SizeType32 jj = 0; jj < kWarpNum; ++jj)
+        {
+            val += shmem[jj * TILE_M * kTileN + ii];
+        }
+        val *= alpha;
+        if (bias != nullptr)
+        {
+            val += static_cast<float>(bias[tileIdN + nid]);
+        }
+        output[mid * n + nid] = static_cast<T>(val);
+    }
+}
+
+template <typename T, Fp4Format Format, SizeType32 TILE_M, SizeType32 BLOCK_SIZE>
+void fp4GemvKernel(Params const& params, cudaStream_t stream)
+{
+    dim3 block(BLOCK_SIZE);
+    dim3 grid(params.m / TILE_M, params.n / kTileN);
+    fp4Gemv<T, Format, TILE_M, BLOCK_SIZE><<<grid, block, 0, stream>>>(reinterpret_cast<T const*>(params.act),
+        reinterpret_cast<uint8_t const*>(params.weight), reinterpret_cast<uint8_t const*>(params.block_scales),
+        reinterpret_cast<T const*>(params.bias), params.alpha, reinterpret_cast<T*>(params.output), params.m, params.n,
+        params.k);
+}
+
+template <typename T, Fp4Format Format>
+void fp4GemvDispatchM(Params const& params, cudaStream_t stream)
+{
+#define DISPATCH(TargetM, BLOCK_SIZE)                                                                                  \
+    if (params.m == TargetM)                                                                                           \
+    {                                                                                                                  \
+        fp4GemvKernel<T, Format, TargetM, BLOCK_SIZE>(params, stream);                                                 \
+        return;                                                                                                        \
+    }
+    DISPATCH(1, 128);
+    DISPATCH(2, 128);
+    DISPATCH(3, 128);
+    DISPATCH(4, 128);
+#undef DISPATCH
+}
+} // namespace
+
+template <typename T>
+void fp4GemvLauncher(Params const& params, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(params.m >= 1 && params.m <= kMaxFp4GemvM, "The FP4 GEMV handles m up to %d, got %d",
+        kMaxFp4GemvM, params.m);
+    TLLM_CHECK_WITH_INFO(params.n % kTileN == 0 && params.k % kStepK == 0,
+        "The FP4 GEMV needs n even and k a multiple of %d, got n %d and k %d", kStepK, params.n, params.k);
+    if (params.format == Fp4Format::MXFP4)
+    {
+        fp4GemvDispatchM<T, Fp4Format::MXFP4>(params, stream);
+    }
+    else
+    {
+        fp4GemvDispatchM<T, Fp4Format::NVFP4>(params, stream);
+    }
+}
+
+template void fp4GemvLauncher<half>(Params const& params, cudaStream_t stream);
+template void fp4GemvLauncher<__nv_bfloat16>(Params const& params, cudaStream_t stream);
+} // namespace fp4_gemm
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include "tensorrt_llm/runtime/common.h"
+#include <cuda_runtime_api.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+namespace fp4_gemm
+{
+using SizeType32 = tensorrt_llm::runtime::SizeType32;
+
+// 4-bit floating point (e2m1) weights sharing a scale per block of channels along K.
+enum class Fp4Format
+{
+    // OCP microscaling: a power of two scale (E8M0) per 32 weights.
+    MXFP4,
+    // An FP8 (e4m3) scale per 16 weights, relative to a per tensor FP32 scale passed as alpha.
+    NVFP4
+};
+
+constexpr SizeType32 getFp4BlockSize(Fp4Format format)
+{
+    return format == Fp4Format::MXFP4 ? 32 : 16;
+}
+
+// The GEMV reads the weights once for up to this many rows of activations.
+constexpr SizeType32 kMaxFp4GemvM = 4;
+
+// output = alpha * act * weight^T + bias, dequantizing the weights on the fly.
+struct Params
+{
+    // [m, k], half or bfloat16
+    void const* act;
+    // [n, k / 2], element 2i in the low nibble of byte i
+    void const* weight;
+    // [n, k / getFp4BlockSize(format)], E8M0 or e4m3
+    void const* block_scales;
+    // [n] or nullptr
+    void const* bias;
+    // [m, n]
+    void* output;
+    float alpha;
+    SizeType32 m, n, k;
+    Fp4Format format;
+};
+
+// m must be at most kMaxFp4GemvM, n even and k a multiple of 32.
+template <typename T>
+void fp4GemvLauncher(Params const& params, cudaStream_t stream);
+
+} // namespace fp4_gemm
+} // namespace kernels
+} // namespace tensorrt_llm
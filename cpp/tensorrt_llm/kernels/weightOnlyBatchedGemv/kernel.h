@@ -18,6 +18,7 @@
 #include "tensorrt_llm/kernels/weightOnlyBatchedGemv/common.h"
 #include "tensorrt_llm/kernels/weightOnlyBatchedGemv/converter.h"
 #include "tensorrt_llm/kernels/weightOnlyBatchedGemv/details.h"
+#include "tensorrt_llm/kernels/weightOnlyBatchedGemv/kernelSm90.h"
 #include "tensorrt_llm/kernels/weightOnlyBatchedGemv/utility.h"
 
 namespace tensorrt_llm
@@ -27,7 +28,7 @@ namespace kernels
 namespace weight_only
 {
 template <typename Details, int CtaM, int CtaN, int Threads, int GroupSize, bool EnableActScale, bool EnableZero,
-    bool EnableBias, bool ApplyAlphaInAdvance, typename TypeA = typename Details::TypeDetailsA::Type>
+    bool EnableBias, bool ApplyAlphaInAdvance, bool Gated, typename TypeA = typename Details::TypeDetailsA::Type>
 __global__ void kernel(TypeA* act, TypeA* act_scale, uint8_t* weight, TypeA* scales, TypeA* zeros, TypeA* bias,
     TypeA* out, float alpha, int m, int n, int k)
 {
@@ -41,6 +42,9 @@ __global__ void kernel(TypeA* act, TypeA* act_scale, uint8_t* weight, TypeA* sca
     // input            zeros            fp16/bf16              [k / GroupSize, n] or [1, n]    RowMajor
     // input            bias             fp16/bf16              [1, n]                          RowMajor
     // output           out              fp16/bf16              [m, n]                          RowMajor
+    //
+    // With Gated, weight, scales, zeros and bias have 2 * n columns: the first n project to x and the last n to
+    // the gate, and out = x * silu(gate) is written without materializing the [m, 2 * n] product.
     // clang-format on
     using AccessTypeA = typename Details::AccessTypeA;
     using AccessTypeW = typename Details::AccessTypeW;
@@ -55,9 +59,17 @@ __global__ void kernel(TypeA* act, TypeA* act_scale, uint8_t* weight, TypeA* sca
     }
 
     int const origin_k = k, interleaved_k = k * Details::kInterleave;
+    // Row stride of the scales and zeros, and offset of the gate columns
+    int const weight_n = Gated ? 2 * n : n;
 
     int const tile_id_m = blockIdx.x, tile_id_n = blockIdx.y, tid = threadIdx.x;
     int const offset_m = tile_id_m * CtaM, interleaved_offset_n = tile_id_n * CtaN;
+    // The last tile of M may be partial
+    int const valid_m = min(CtaM, m - offset_m);
+    // K is split over gridDim.z, each split handles a contiguous range of CtaK iterations
+    int const iters_per_split = ((interleaved_k + CtaK - 1) / CtaK + gridDim.z - 1) / gridDim.z;
+    int const iter_begin = blockIdx.z * iters_per_split;
+    int const split_end_k = min(interleaved_k, (iter_begin + iters_per_split) * CtaK);
     int const real_offset_n = interleaved_offset_n * Details::kInterleave
         + ((tid * StepK / Details::LayoutDetails::kTileSize) % Details::kInterleave);
     int const real_offset_k
@@ -72,11 +84,21 @@ __global__ void kernel(TypeA* act, TypeA* act_scale, uint8_t* weight, TypeA* sca
         (interleaved_offset_n * interleaved_k + tid * StepK) / Details::kElemsPerByteW, CtaK / Details::kElemsPerByteW,
         interleaved_k / Details::kElemsPerByteW);
     GMemIterator<Mandatory, TypeA, CtaN, 1, TypeA> scales_iterator(scales,
-        (GroupSize != 0 ? real_offset_k / GroupSize * n : 0) + real_offset_n,
-        (GroupSize != 0 ? CtaK / Details::kInterleave / GroupSize * n : 0), Details::kInterleave);
+        (GroupSize != 0 ? real_offset_k / GroupSize * weight_n : 0) + real_offset_n,
+        (GroupSize != 0 ? CtaK / Details::kInterleave / GroupSize * weight_n : 0), Details::kInterleave);
     GMemIterator<EnableZero, TypeA, CtaN, 1, TypeA> zeros_iterator(zeros,
-        (GroupSize != 0 ? real_offset_k / GroupSize * n : 0) + real_offset_n,
-        (GroupSize != 0 ? CtaK / Details::kInterleave / GroupSize * n : 0), Details::kInterleave);
+        (GroupSize != 0 ? real_offset_k / GroupSize * weight_n : 0) + real_offset_n,
+        (GroupSize != 0 ? CtaK / Details::kInterleave / GroupSize * weight_n : 0), Details::kInterleave);
+    // The gate columns start n columns, i.e. n * k weights, after the x columns
+    GMemIterator<Gated, AccessTypeW, CtaN, Details::kAccessNumW, uint8_t> gate_weight_iterator(weight,
+        (n * k + interleaved_offset_n * interleaved_k + tid * StepK) / Details::kElemsPerByteW,
+        CtaK / Details::kElemsPerByteW, interleaved_k / Details::kElemsPerByteW);
+    GMemIterator<Gated, TypeA, CtaN, 1, TypeA> gate_scales_iterator(scales,
+        (GroupSize != 0 ? real_offset_k / GroupSize * weight_n : 0) + real_offset_n + n,
+        (GroupSize != 0 ? CtaK / Details::kInterleave / GroupSize * weight_n : 0), Details::kInterleave);
+    GMemIterator<Gated && EnableZero, TypeA, CtaN, 1, TypeA> gate_zeros_iterator(zeros,
+        (GroupSize != 0 ? real_offset_k / GroupSize * weight_n : 0) + real_offset_n + n,
+        (GroupSize != 0 ? CtaK / Details::kInterleave / GroupSize * weight_n : 0), Details::kInterleave);
 
     out += offset_m * n + tile_id_n * CtaN * Details::kInterleave;
     if constexpr (EnableBias)
@@ -86,8 +108,13 @@ __global__ void kernel(TypeA* act, TypeA* act_scale, uint8_t* weight, TypeA* sca
 
     TypeA tile_acc[CtaM * CtaN];
     fill<CtaM * CtaN>(tile_acc, static_cast<TypeA>(0.f));
+    [[maybe_unused]] TypeA tile_acc_gate[Gated ? CtaM * CtaN : 1];
+    if constexpr (Gated)
+    {
+        fill<CtaM * CtaN>(tile_acc_gate, static_cast<TypeA>(0.f));
+    }
 
-    for (int idx_k = tid * StepK, iter = 0; idx_k < interleaved_k; idx_k += CtaK, ++iter)
+    for (int idx_k = tid * StepK + iter_begin * CtaK, iter = iter_begin; idx_k < split_end_k; idx_k += CtaK, ++iter)
     {
         TypeA vec_act_scale[StepK];
         TypeA vec_scale[CtaN], vec_zero[CtaN];
@@ -108,30 +135,67 @@ __global__ void kernel(TypeA* act, TypeA* act_scale, uint8_t* weight, TypeA* sca
                 tile_w, tile_w_quantized, vec_scale + i, vec_zero + i, alpha);
             pack_to_vec2<Details, StepK>(tile_w_pack2, tile_w, i);
         }
+        [[maybe_unused]] TypeA tile_w_gate_pack2[Gated ? CtaN * StepK : 1];
+        if constexpr (Gated)
+        {
+#pragma unroll
+            for (int i = 0; i < CtaN; ++i)
+            {
+                gate_scales_iterator.load(vec_scale + i, iter, i);
+                gate_zeros_iterator.load(vec_zero + i, iter, i);
+                gate_weight_iterator.load(tile_w_quantized, iter, i);
+                dequantize<Details, 1, StepK, EnableZero, ApplyAlphaInAdvance>(
+                    tile_w, tile_w_quantized, vec_scale + i, vec_zero + i, alpha);
+                pack_to_vec2<Details, StepK>(tile_w_gate_pack2, tile_w, i);
+            }
+        }
 #pragma unroll
         for (int i = 0; i < CtaM; ++i)
         {
-            act_iterator.load(tile_a, iter, i);
-            apply_scale<Details, 1, StepK, EnableActScale>(tile_a, vec_act_scale);
-            mma<Details, 1, CtaN, StepK>(tile_acc + i * CtaN, tile_w_pack2, tile_a);
+            if (i < valid_m)
+            {
+                act_iterator.load(tile_a, iter, i);
+                apply_scale<Details, 1, StepK, EnableActScale>(tile_a, vec_act_scale);
+                mma<Details, 1, CtaN, StepK>(tile_acc + i * CtaN, tile_w_pack2, tile_a);
+                if constexpr (Gated)
+                {
+                    mma<Details, 1, CtaN, StepK>(tile_acc_gate + i * CtaN, tile_w_gate_pack2, tile_a);
+                }
+            }
         }
     }
-    epilogue<Details, CtaM, CtaN, Threads, EnableBias, ApplyAlphaInAdvance>(out, n, tile_acc, bias, alpha);
+    epilogue<Details, CtaM, CtaN, Threads, EnableBias, ApplyAlphaInAdvance, Gated>(
+        out, n, tile_acc, tile_acc_gate, bias, alpha, valid_m);
 }
 
 template <typename Details, int CtaM, int CtaN, int Threads, int GroupSize, bool EnableActScale, bool EnableZero,
-    bool EnableBias, bool ApplyAlphaInAdvance>
+    bool EnableBias, bool ApplyAlphaInAdvance, bool Gated>
 void exec_kernel(Params& params, cudaStream_t s)
 {
     using T = typename Details::TypeDetailsA::Type;
-    if (params.m % CtaM || params.n % (CtaN * Details::kInterleave))
+    // The gated activation is not linear, so the splits of K can't be added to the output
+    if (params.n % (CtaN * Details::kInterleave) || params.split_k < 1 || (Gated && params.split_k > 1))
     {
         throw std::runtime_error("launch failed");
     }
-    dim3 grid(params.m / CtaM, params.n / (CtaN * Details::kInterleave));
+    if (params.split_k > 1)
+    {
+        // The splits of K add their partial results to the output
+        cudaMemsetAsync(params.out, 0, sizeof(T) * params.m * params.n, s);
+    }
+    if constexpr (kIsSm90Details<Details> && !Gated)
+    {
+        if (can_use_sm90_kernel<Details>(params))
+        {
+            exec_kernel_sm90<Details, CtaM, CtaN, Threads, GroupSize, EnableActScale, EnableZero, EnableBias,
+                ApplyAlphaInAdvance>(params, s);
+            return;
+        }
+    }
+    dim3 grid((params.m + CtaM - 1) / CtaM, params.n / (CtaN * Details::kInterleave), params.split_k);
     dim3 block(Threads);
     // clang-format off
-    kernel<Details, CtaM, CtaN, Threads, GroupSize, EnableActScale, EnableZero, EnableBias, ApplyAlphaInAdvance><<<grid, block, 0, s>>>(
+    kernel<Details, CtaM, CtaN, Threads, GroupSize, EnableActScale, EnableZero, EnableBias, ApplyAlphaInAdvance, Gated><<<grid, block, 0, s>>>(
         reinterpret_cast<T*>(params.act),
         reinterpret_cast<T*>(params.act_scale),
         reinterpret_cast<uint8_t*>(params.weight),
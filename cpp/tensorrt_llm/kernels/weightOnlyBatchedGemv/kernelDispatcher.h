@@ -28,7 +28,7 @@ namespace weight_only
 // Using a mechanism similar to the gemm config profiler, dynamically search for the optimal configuration during the
 // build engine process.
 template <typename Details, int GroupSize, bool EnableActScale, bool EnableZero, bool EnableBias,
-    bool ApplyAlphaInAdvance>
+    bool ApplyAlphaInAdvance, bool Gated>
 void dispatcher(Params& params, cudaStream_t s)
 {
 #define DISPATCHER_FOR_M(target_m, CtaM, CtaN, Threads)                                                                \
@@ -37,7 +37,7 @@ void dispatcher(Params& params, cudaStream_t s)
         if (params.m == target_m)                                                                                      \
         {                                                                                                              \
             exec_kernel<Details, CtaM, CtaN, Threads, GroupSize, EnableActScale, EnableZero, EnableBias,               \
-                ApplyAlphaInAdvance>(params, s);                                                                       \
+                ApplyAlphaInAdvance, Gated>(params, s);                                                                \
             return;                                                                                                    \
         }                                                                                                              \
     } while (0);
@@ -49,6 +49,12 @@ void dispatcher(Params& params, cudaStream_t s)
         DISPATCHER_FOR_M(3, 3, 4, 128);
         DISPATCHER_FOR_M(4, 4, 4, 128);
         // clang-format on
+        if (params.m <= kMaxBatchedGemvM)
+        {
+            exec_kernel<Details, 4, 4, 128, GroupSize, EnableActScale, EnableZero, EnableBias, ApplyAlphaInAdvance,
+                Gated>(params, s);
+            return;
+        }
     }
     else
     {
@@ -58,21 +64,41 @@ void dispatcher(Params& params, cudaStream_t s)
         DISPATCHER_FOR_M(3, 3, 8, 128);
         DISPATCHER_FOR_M(4, 4, 8, 128);
         // clang-format on
+        if (params.m <= kMaxBatchedGemvM)
+        {
+            exec_kernel<Details, 4, 8, 128, GroupSize, EnableActScale, EnableZero, EnableBias, ApplyAlphaInAdvance,
+                Gated>(params, s);
+            return;
+        }
     }
     throw std::runtime_error("unsupported m");
 #undef DISPATCHER_FOR_M
 }
 
+template <typename Details, int GroupSize, bool EnableActScale, bool EnableZero, bool EnableBias,
+    bool ApplyAlphaInAdvance>
+void check_gated(Params& params, cudaStream_t s)
+{
+    if (params.gated)
+    {
+        dispatcher<Details, GroupSize, EnableActScale, EnableZero, EnableBias, ApplyAlphaInAdvance, true>(params, s);
+    }
+    else
+    {
+        dispatcher<Details, GroupSize, EnableActScale, EnableZero, EnableBias, ApplyAlphaInAdvance, false>(params, s);
+    }
+}
+
 template <typename Details, int GroupSize, bool EnableActScale, bool EnableZero, bool EnableBias>
 void check_alpha(Params& params, cudaStream_t s)
 {
     if (params.apply_alpha_in_advance && params.alpha != 1.f)
     {
-        dispatcher<Details, GroupSize, EnableActScale, EnableZero, EnableBias, true>(params, s);
+        check_gated<Details, GroupSize, EnableActScale, EnableZero, EnableBias, true>(params, s);
     }
     else
     {
-        dispatcher<Details, GroupSize, EnableActScale, EnableZero, EnableBias, false>(params, s);
+        check_gated<Details, GroupSize, EnableActScale, EnableZero, EnableBias, false>(params, s);
     }
 }
 
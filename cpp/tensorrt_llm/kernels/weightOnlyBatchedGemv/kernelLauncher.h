@@ -70,6 +70,7 @@ inline void kernel_launcher(int arch, Params& params, cudaStream_t s)
     }
     else if (arch >= 90)
     {
+        // The column major weights are staged by TMA bulk copies in a multi-stage pipeline, see kernel_sm90
         EXEC(KernelType::FP16Int4Groupwise, FP16DetailsA, Int4DetailsW, ColumnMajor, false);
         EXEC(KernelType::BF16Int4Groupwise, BF16DetailsA, Int4DetailsW, ColumnMajor, false);
         EXEC(KernelType::FP16Int8PerChannel, FP16DetailsA, Int8DetailsW, ColumnMajor, false);
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include "tensorrt_llm/kernels/weightOnlyBatchedGemv/common.h"
+#include "tensorrt_llm/kernels/weightOnlyBatchedGemv/converter.h"
+#include "tensorrt_llm/kernels/weightOnlyBatchedGemv/details.h"
+#include "tensorrt_llm/kernels/weightOnlyBatchedGemv/utility.h"
+
+#include <type_traits>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+namespace weight_only
+{
+// The Hopper kernels are the ones of the plain column major layout without the interleaved converter, which
+// kernel_launcher only selects for SM90+
+template <typename Details>
+constexpr bool kIsSm90Details = std::is_same_v<typename Details::LayoutDetails,
+                                    ColumnMajor<typename Details::TypeDetailsA, typename Details::TypeDetailsW,
+                                        Details::LayoutDetails::kTileSize>>
+    && !Details::kUseInterleavedConverter;
+
+// Stages of weight tiles in flight per CTA
+constexpr int kSm90Stages = 4;
+
+namespace sm90
+{
+__device__ __forceinline__ uint32_t smem_addr(void const* ptr)
+{
+    return static_cast<uint32_t>(__cvta_generic_to_shared(ptr));
+}
+
+__device__ __forceinline__ void mbarrier_init(uint64_t* bar, uint32_t count)
+{
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 900
+    asm volatile("mbarrier.init.shared::cta.b64 [%0], %1;" ::"r"(smem_addr(bar)), "r"(count) : "memory");
+#endif
+}
+
+// Makes the initialized barriers visible to the bulk copies, which run in the async proxy
+__device__ __forceinline__ void fence_barrier_init()
+{
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 900
+    asm volatile("fence.proxy.async.shared::cta;" ::: "memory");
+#endif
+}
+
+__device__ __forceinline__ void mbarrier_arrive_expect_tx(uint64_t* bar, uint32_t bytes)
+{
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 900
+    asm volatile("mbarrier.arrive.expect_tx.shared::cta.b64 _, [%0], %1;" ::"r"(smem_addr(bar)), "r"(bytes)
+                 : "memory");
+#endif
+}
+
+__device__ __forceinline__ void mbarrier_wait(uint64_t* bar, uint32_t phase)
+{
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 900
+    uint32_t done{0};
+    while (!done)
+    {
+        asm volatile(
+            "{\n"
+            ".reg .pred p;\n"
+            "mbarrier.try_wait.parity.shared::cta.b64 p, [%1], %2;\n"
+            "selp.u32 %0, 1, 0, p;\n"
+            "}\n"
+            : "=r"(done)
+            : "r"(smem_addr(bar)), "r"(phase)
+            : "memory");
+    }
+#endif
+}
+
+// TMA bulk copy of bytes from global to shared memory, both 16 bytes aligned and bytes a multiple of 16, completing
+// on the transaction count of bar. The weights are read once, so they're hinted to be evicted first from L2.
+__device__ __forceinline__ void bulk_copy_g2s(void* dst, void const* src, uint32_t bytes, uint64_t* bar)
+{
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 900
+    asm volatile(
+        "{\n"
+        ".reg .b64 policy;\n"
+        "createpolicy.fractional.L2::evict_first.b64 policy, 1.0;\n"
+        "cp.async.bulk.shared::cluster.global.mbarrier::complete_tx::bytes.L2::cache_hint [%0], [%1], %2, [%3], "
+        "policy;\n"
+        "}\n" ::"r"(smem_addr(dst)),
+        "l"(src), "r"(bytes), "r"(smem_addr(bar))
+        : "memory");
+#endif
+}
+} // namespace sm90
+
+// Same math as kernel, for the column major weights of SM90+: the weights of the CtaN columns of a CtaK iteration
+// are contiguous per column, and are brought to shared memory by TMA bulk copies kSm90Stages iterations ahead,
+// instead of 4 or 8 bytes per thread and column from global memory. Scales, zeros and activations are small and
+// shared by the CTAs, they are read through the caches as in kernel. Gated is not supported.
+template <typename Details, int CtaM, int CtaN, int Threads, int GroupSize, bool EnableActScale, bool EnableZero,
+    bool EnableBias, bool ApplyAlphaInAdvance, typename TypeA = typename Details::TypeDetailsA::Type>
+__global__ void __launch_bounds__(Threads) kernel_sm90(TypeA* act, TypeA* act_scale, uint8_t* weight, TypeA* scales,
+    TypeA* zeros, TypeA* bias, TypeA* out, float alpha, int m, int n, int k)
+{
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 900
+    using AccessTypeA = typename Details::AccessTypeA;
+    using AccessTypeW = typename Details::AccessTypeW;
+
+    static constexpr bool Mandatory = true;
+    static constexpr int StepK = Details::kStepK;
+    static constexpr int CtaK = StepK * Threads;
+    static constexpr int Stages = kSm90Stages;
+    static constexpr int StageColBytes = CtaK / Details::kElemsPerByteW;
+    static constexpr int StageBytes = CtaN * StageColBytes;
+    static_assert(Details::kInterleave == 1 && CtaN % 2 == 0 && StageColBytes % 16 == 0);
+    if constexpr (GroupSize != 0)
+    {
+        static_assert(CtaK % GroupSize == 0);
+    }
+
+    // Stages of [CtaN, StageColBytes] weights, then the barriers of the stages
+    extern __shared__ __align__(128) uint8_t smem_weight[];
+    uint64_t* full = reinterpret_cast<uint64_t*>(smem_weight + Stages * StageBytes);
+
+    int const tile_id_m = blockIdx.x, tile_id_n = blockIdx.y, tid = threadIdx.x;
+    int const offset_m = tile_id_m * CtaM, offset_n = tile_id_n * CtaN;
+    int const valid_m = min(CtaM, m - offset_m);
+    int const num_iters = (k + CtaK - 1) / CtaK;
+    int const iters_per_split = (num_iters + gridDim.z - 1) / gridDim.z;
+    int const iter_begin = blockIdx.z * iters_per_split;
+    int const iter_end = min(num_iters, iter_begin + iters_per_split);
+    int const split_end_k = min(k, iter_end * CtaK);
+    int const offset_k = tid * StepK;
+
+    GMemIterator<Mandatory, AccessTypeA, CtaM, Details::kAccessNumA, TypeA> act_iterator(
+        act, offset_m * k + offset_k, CtaK, k);
+    GMemIterator<EnableActScale, AccessTypeA, 1, Details::kAccessNumA, TypeA> act_scale_iterator(
+        act_scale, offset_k, CtaK, 0);
+    GMemIterator<Mandatory, TypeA, CtaN, 1, TypeA> scales_iterator(scales,
+        (GroupSize != 0 ? offset_k / GroupSize * n : 0) + offset_n, (GroupSize != 0 ? CtaK / GroupSize * n : 0), 1);
+    GMemIterator<EnableZero, TypeA, CtaN, 1, TypeA> zeros_iterator(zeros,
+        (GroupSize != 0 ? offset_k / GroupSize * n : 0) + offset_n, (GroupSize != 0 ? CtaK / GroupSize * n : 0), 1);
+    // The column of the weight is contiguous along K
+    uint8_t const* weight_cols = weight + static_cast<int64_t>(offset_n) * k / Details::kElemsPerByteW;
+    int64_t const col_bytes = k / Details::kElemsPerByteW;
+
+    out += offset_m * n + offset_n;
+    if constexpr (EnableBias)
+    {
+        bias += offset_n;
+    }
+
+    auto const load_stage = [&](int stage, int iter)
+    {
+        int const bytes = min(CtaK, k - iter * CtaK) / Details::kElemsPerByteW;
+        sm90::mbarrier_arrive_expect_tx(full + stage, bytes * CtaN);
+#pragma unroll
+        for (int i = 0; i < CtaN; ++i)
+        {
+            sm90::bulk_copy_g2s(smem_weight + stage * StageBytes + i * StageColBytes,
+                weight_cols + i * col_bytes + iter * StageColBytes, bytes, full + stage);
+        }
+    };
+
+    if (tid == 0)
+    {
+#pragma unroll
+        for (int stage = 0; stage < Stages; ++stage)
+        {
+            sm90::mbarrier_init(full + stage, 1);
+        }
+        sm90::fence_barrier_init();
+    }
+    __syncthreads();
+    if (tid == 0)
+    {
+        for (int stage = 0; stage < Stages && iter_begin + stage < iter_end; ++stage)
+        {
+            load_stage(stage, iter_begin + stage);
+        }
+    }
+
+    TypeA tile_acc[CtaM * CtaN];
+    fill<CtaM * CtaN>(tile_acc, static_cast<TypeA>(0.f));
+
+    for (int iter = iter_begin, i = 0; iter < iter_end; ++iter, ++i)
+    {
+        int const stage = i % Stages;
+        sm90::mbarrier_wait(full + stage, (i / Stages) & 1);
+        if (iter * CtaK + offset_k < split_end_k)
+        {
+            TypeA vec_act_scale[StepK];
+            TypeA vec_scale[CtaN], vec_zero[CtaN];
+            TypeA tile_a[StepK], tile_w[StepK], tile_w_pack2[CtaN * StepK];
+            uint8_t tile_w_quantized[StepK / Details::kElemsPerByteW];
+#pragma unroll
+            for (int ii = 0; ii < CtaN; ++ii)
+            {
+                scales_iterator.load(vec_scale + ii, iter, ii);
+                zeros_iterator.load(vec_zero + ii, iter, ii);
+            }
+            act_scale_iterator.load(vec_act_scale, iter);
+#pragma unroll
+            for (int ii = 0; ii < CtaN; ++ii)
+            {
+                auto const* stage_w = reinterpret_cast<AccessTypeW const*>(smem_weight + stage * StageBytes
+                    + ii * StageColBytes + offset_k / Details::kElemsPerByteW);
+#pragma unroll
+                for (int jj = 0; jj < Details::kAccessNumW; ++jj)
+                {
+                    reinterpret_cast<AccessTypeW*>(tile_w_quantized)[jj] = stage_w[jj];
+                }
+                dequantize<Details, 1, StepK, EnableZero, ApplyAlphaInAdvance>(
+                    tile_w, tile_w_quantized, vec_scale + ii, vec_zero + ii, alpha);
+                pack_to_vec2<Details, StepK>(tile_w_pack2, tile_w, ii);
+            }
+#pragma unroll
+            for (int ii = 0; ii < CtaM; ++ii)
+            {
+                if (ii < valid_m)
+                {
+                    act_iterator.load(tile_a, iter, ii);
+                    apply_scale<Details, 1, StepK, EnableActScale>(tile_a, vec_act_scale);
+                    mma<Details, 1, CtaN, StepK>(tile_acc + ii * CtaN, tile_w_pack2, tile_a);
+                }
+            }
+        }
+        // The stage is refilled once all the threads have read it
+        __syncthreads();
+        if (tid == 0 && iter + Stages < iter_end)
+        {
+            load_stage(stage, iter + Stages);
+        }
+    }
+    epilogue<Details, CtaM, CtaN, Threads, EnableBias, ApplyAlphaInAdvance, false>(
+        out, n, tile_acc, tile_acc, bias, alpha, valid_m);
+#endif
+}
+
+// The bulk copies need the columns of the weight 16 bytes aligned
+template <typename Details>
+bool can_use_sm90_kernel(Params const& params)
+{
+    return !params.gated && reinterpret_cast<uintptr_t>(params.weight) % 16 == 0
+        && (params.k / Details::kElemsPerByteW) % 16 == 0 && params.k % Details::kElemsPerByteW == 0;
+}
+
+template <typename Details, int CtaM, int CtaN, int Threads, int GroupSize, bool EnableActScale, bool EnableZero,
+    bool EnableBias, bool ApplyAlphaInAdvance>
+void exec_kernel_sm90(Params& params, cudaStream_t s)
+{
+    using T = typename Details::TypeDetailsA::Type;
+    static constexpr int StageBytes = CtaN * Details::kStepK * Threads / Details::kElemsPerByteW;
+    static constexpr int SmemBytes = kSm90Stages * (StageBytes + sizeof(uint64_t));
+    static_assert(SmemBytes <= 48 * 1024, "The stages of the weights exceed the default shared memory");
+    dim3 grid((params.m + CtaM - 1) / CtaM, params.n / CtaN, params.split_k);
+    dim3 block(Threads);
+    // clang-format off
+    kernel_sm90<Details, CtaM, CtaN, Threads, GroupSize, EnableActScale, EnableZero, EnableBias, ApplyAlphaInAdvance><<<grid, block, SmemBytes, s>>>(
+        reinterpret_cast<T*>(params.act),
+        reinterpret_cast<T*>(params.act_scale),
+        reinterpret_cast<uint8_t*>(params.weight),
+        reinterpret_cast<T*>(params.scales),
+        reinterpret_cast<T*>(params.zeros),
+        reinterpret_cast<T*>(params.bias),
+        reinterpret_cast<T*>(params.out),
+        params.alpha,
+        params.m, params.n, params.k
+    );
+    // clang-format on
+}
+
+} // namespace weight_only
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -58,6 +58,13 @@ struct MathWrapper<FP16DetailsA>
     {
         return __hmul2(a, b);
     }
+
+    __device__ __forceinline__ static void atomic_add(Type* address, Type const& v)
+    {
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 700))
+        atomicAdd(address, v);
+#endif
+    }
 };
 
 template <>
@@ -93,6 +100,13 @@ struct MathWrapper<BF16DetailsA>
         return __hmul2(a, b);
 #else
         return to_vec2(static_cast<Type>(0.f));
+#endif
+    }
+
+    __device__ __forceinline__ static void atomic_add(Type* address, Type const& v)
+    {
+#if ((defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 800)) && defined(ENABLE_BF16))
+        atomicAdd(address, v);
 #endif
     }
 };
@@ -214,56 +228,90 @@ __device__ __forceinline__ T warp_reduce_sum(T& val)
     return val;
 }
 
-template <typename Details, int CtaM, int CtaN, int Threads, bool EnableBias, bool ApplyAlphaInAdvance>
-__device__ __forceinline__ void epilogue(void* out, int stride, void* tile_acc, void* bias, float alpha)
+// Only the first valid_m rows of the tile are written. With K split over gridDim.z, the partial results are added to
+// the zero-initialized output and the bias is added by the first split. With Gated, tile_acc_gate holds the gate
+// columns, whose bias starts n = stride columns after the bias of tile_acc, and x * silu(gate) is written.
+template <typename Details, int CtaM, int CtaN, int Threads, bool EnableBias, bool ApplyAlphaInAdvance, bool Gated>
+__device__ __forceinline__ void epilogue(
+    void* out, int stride, void* tile_acc, void* tile_acc_gate, void* bias, float alpha, int valid_m)
 {
     using Type = typename MathWrapper<typename Details::TypeDetailsA>::Type;
     static constexpr int Interleave = Details::kInterleave;
     static constexpr int ThreadsPerInterleavedTile = Details::kThreadsPerInterleavedTile;
     static constexpr int WarpSize = Details::kWarpSize;
     static constexpr int WarpNum = Threads / WarpSize;
+    static constexpr int Tiles = Gated ? 2 : 1;
+    static constexpr int TileSize = CtaM * CtaN * Interleave;
     static_assert(Threads % WarpSize == 0);
-    __shared__ float shmem[CtaM * CtaN * Interleave * WarpNum];
+    __shared__ float shmem[Tiles * TileSize * WarpNum];
     int tid = threadIdx.x;
     int warp_id = tid / WarpSize, lane_id = tid % WarpSize;
 #pragma unroll
-    for (int m = 0; m < CtaM; ++m)
+    for (int t = 0; t < Tiles; ++t)
     {
+        Type* acc = reinterpret_cast<Type*>(t == 0 ? tile_acc : tile_acc_gate);
 #pragma unroll
-        for (int n = 0; n < CtaN; ++n)
+        for (int m = 0; m < CtaM; ++m)
         {
-            float v = static_cast<float>(reinterpret_cast<Type*>(tile_acc)[m * CtaN + n]);
-            v = warp_reduce_sum<Interleave, ThreadsPerInterleavedTile>(v);
-            if (lane_id < Interleave * ThreadsPerInterleavedTile && lane_id % ThreadsPerInterleavedTile == 0)
+#pragma unroll
+            for (int n = 0; n < CtaN; ++n)
             {
-                shmem[warp_id * CtaM * CtaN * Interleave + m * CtaN * Interleave + n * Interleave
-                    + lane_id / ThreadsPerInterleavedTile]
-                    = v;
+                float v = static_cast<float>(acc[m * CtaN + n]);
+                v = warp_reduce_sum<Interleave, ThreadsPerInterleavedTile>(v);
+                if (lane_id < Interleave * ThreadsPerInterleavedTile && lane_id % ThreadsPerInterleavedTile == 0)
+                {
+                    shmem[(t * WarpNum + warp_id) * TileSize + m * CtaN * Interleave + n * Interleave
+                        + lane_id / ThreadsPerInterleavedTile]
+                        = v;
+                }
             }
         }
     }
     __syncthreads();
 #pragma unroll
-    for (int ii = tid; ii < CtaM * CtaN * Interleave; ii += Threads)
+    for (int ii = tid; ii < TileSize; ii += Threads)
     {
         int m = ii / (CtaN * Interleave), n = ii % (CtaN * Interleave);
-        float val = 0.f, v_bias = 0.f;
-        if constexpr (EnableBias)
+        if (m >= valid_m)
         {
-            v_bias = static_cast<float>(reinterpret_cast<Type*>(bias)[n]);
+            continue;
         }
+        float vals[Tiles];
 #pragma unroll
-        for (int jj = 0; jj < WarpNum; ++jj)
+        for (int t = 0; t < Tiles; ++t)
         {
-            val += shmem[jj * CtaM * CtaN * Interleave + ii];
+            float val = 0.f, v_bias = 0.f;
+            if constexpr (EnableBias)
+            {
+                if (blockIdx.z == 0)
+                {
+                    v_bias = static_cast<float>(reinterpret_cast<Type*>(bias)[t * stride + n]);
+                }
+            }
+#pragma unroll
+            for (int jj = 0; jj < WarpNum; ++jj)
+            {
+                val += shmem[(t * WarpNum + jj) * TileSize + ii];
+            }
+            if constexpr (!ApplyAlphaInAdvance)
+            {
+                val *= alpha;
+            }
+            vals[t] = val + v_bias;
         }
-        if constexpr (ApplyAlphaInAdvance)
+        float val = vals[0];
+        if constexpr (Gated)
+        {
+            val *= vals[1] / (1.f + __expf(-vals[1]));
+        }
+        if (gridDim.z == 1)
         {
-            reinterpret_cast<Type*>(out)[m * stride + n] = static_cast<Type>(val + v_bias);
+            reinterpret_cast<Type*>(out)[m * stride + n] = static_cast<Type>(val);
         }
         else
         {
-            reinterpret_cast<Type*>(out)[m * stride + n] = static_cast<Type>(alpha * val + v_bias);
+            MathWrapper<typename Details::TypeDetailsA>::atomic_add(
+                reinterpret_cast<Type*>(out) + m * stride + n, static_cast<Type>(val));
         }
     }
 }
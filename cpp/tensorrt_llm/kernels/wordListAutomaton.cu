@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/wordListAutomaton.h"
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+__global__ void resetWordListAutomata(
+    SizeType32* automata, SizeType32 automatonSize, SizeType32 const* batchSlots, SizeType32 batchSize)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x);
+    if (batchIdx < batchSize)
+    {
+        auto const batchSlot = batchSlots != nullptr ? batchSlots[batchIdx] : batchIdx;
+        automata[static_cast<std::size_t>(batchSlot) * automatonSize + WordListAutomatonLayout::kNUM_STATES] = 0;
+    }
+}
+
+__device__ WordListAutomaton getAutomaton(SizeType32* automata, SizeType32 maxWordsLen, SizeType32 batchSlot,
+    TokenIdType const* words, SizeType32 wordsLen)
+{
+    WordListAutomaton automaton{
+        automata + static_cast<std::size_t>(batchSlot) * getWordListAutomatonSize(maxWordsLen), maxWordsLen};
+    if (!automaton.isCompiled())
+    {
+        automaton.compile(words, wordsLen);
+    }
+    return automaton;
+}
+
+__global__ void stopWordsAutomatonCriterion(SizeType32* automata, SizeType32 maxWordsLen,
+    TokenIdType const** outputIds, TokenIdType const** stopWords, FinishedState* finished, SizeType32* sequenceLengths,
+    SizeType32 const* batchSlots, SizeType32 const* stopWordsLens, SizeType32* numNewTokens, SizeType32 batchSize)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x);
+    if (batchIdx >= batchSize)
+    {
+        return;
+    }
+    auto const batchSlot = batchSlots != nullptr ? batchSlots[batchIdx] : batchIdx;
+    auto const stopWordsLen = stopWordsLens[batchSlot];
+    if (stopWordsLen <= 0)
+    {
+        return;
+    }
+
+    auto const automaton = getAutomaton(automata, maxWordsLen, batchSlot, stopWords[batchSlot], stopWordsLen);
+    auto const* tokens = outputIds[batchSlot];
+    auto const newTokens = numNewTokens ? numNewTokens[batchSlot] : 1;
+    // sequenceLengths already includes the new tokens at this point
+    auto const sequenceLength = sequenceLengths[batchSlot];
+    auto const firstNewPos = sequenceLength - newTokens;
+
+    auto state = automaton.sync(tokens, firstNewPos);
+    for (SizeType32 step = 0; step < newTokens; ++step)
+    {
+        state = automaton.next(state, tokens[firstNewPos + step]);
+        if (automaton.isMatch(state))
+        {
+            finished[batchSlot].setFinishedStopWords();
+            // When more than 1 token is predicted per step, stop at the first match with the stop word
+            if (newTokens > 1)
+            {
+                numNewTokens[batchSlot] = step + 1;
+                sequenceLengths[batchSlot] = firstNewPos + step + 1;
+            }
+            automaton.store(state, firstNewPos + step + 1);
+            return;
+        }
+    }
+    automaton.store(state, sequenceLength);
+}
+
+template <typename T>
+__global__ void banBadWordsAutomaton(T* logits, SizeType32* automata, SizeType32 maxWordsLen,
+    TokenIdType const** outputIds, TokenIdType const** badWords, SizeType32 const* badWordsLens,
+    SizeType32 const* sequenceLengths, SizeType32 const* batchSlots, SizeType32 vocabSizePadded)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = batchSlots != nullptr ? batchSlots[batchIdx] : batchIdx;
+    auto const badWordsLen = badWordsLens[batchSlot];
+    if (badWordsLen <= 0)
+    {
+        return;
+    }
+
+    WordListAutomaton const automaton{
+        automata + static_cast<std::size_t>(batchSlot) * getWordListAutomatonSize(maxWordsLen), maxWordsLen};
+    __shared__ SizeType32 state;
+    if (threadIdx.x == 0)
+    {
+        getAutomaton(automata, maxWordsLen, batchSlot, badWords[batchSlot], badWordsLen);
+        auto const sequenceLength = sequenceLengths[batchSlot];
+        state = automaton.sync(outputIds[batchSlot], sequenceLength);
+        automaton.store(state, sequenceLength);
+    }
+    __syncthreads();
+
+    // Every suffix of the sequence which is a prefix of a bad word is on the failure chain of the state. A token is
+    // banned if it leads from one of them to the end of a bad word.
+    auto* batchLogits = logits + static_cast<std::size_t>(batchIdx) * vocabSizePadded;
+    for (auto suffix = state;; suffix = automaton.getFail(suffix))
+    {
+        auto const firstEdge = automaton.getFirstEdge(suffix);
+        auto const numEdges = automaton.getNumEdges(suffix);
+        for (auto edge = firstEdge + static_cast<SizeType32>(threadIdx.x); edge < firstEdge + numEdges;
+             edge += static_cast<SizeType32>(blockDim.x))
+        {
+            auto const token = automaton.getEdgeToken(edge);
+            if (automaton.isMatch(automaton.getEdgeTarget(edge)) && 0 <= token && token < vocabSizePadded)
+            {
+                batchLogits[token] = static_cast<T>(-INFINITY);
+            }
+        }
+        if (suffix == WordListAutomaton::kROOT)
+        {
+            break;
+        }
+    }
+}
+} // namespace
+
+void invokeResetWordListAutomata(SizeType32* automata, SizeType32 maxWordsLen, SizeType32 const* batchSlots,
+    SizeType32 batchSize, cudaStream_t stream)
+{
+    constexpr SizeType32 blockSize{256};
+    dim3 const grid((batchSize + blockSize - 1) / blockSize);
+    resetWordListAutomata<<<grid, blockSize, 0, stream>>>(
+        automata, getWordListAutomatonSize(maxWordsLen), batchSlots, batchSize);
+    sync_check_cuda_error();
+}
+
+void invokeStopWordsAutomatonCriterion(SizeType32* automata, SizeType32 maxWordsLen, TokenIdType const** outputIds,
+    TokenIdType const** stopWords, FinishedState* finished, SizeType32* sequenceLengths, SizeType32 const* batchSlots,
+    SizeType32 const* stopWordsLen, SizeType32* numNewTokens, SizeType32 batchSize, cudaStream_t stream)
+{
+    // One thread per request, the automaton makes the work per new token independent of the number of stop words
+    constexpr SizeType32 blockSize{64};
+    dim3 const grid((batchSize + blockSize - 1) / blockSize);
+    stopWordsAutomatonCriterion<<<grid, blockSize, 0, stream>>>(automata, maxWordsLen, outputIds, stopWords, finished,
+        sequenceLengths, batchSlots, stopWordsLen, numNewTokens, batchSize);
+    sync_check_cuda_error();
+}
+
+template <typename T>
+void invokeBanBadWordsAutomaton(T* logits, SizeType32* automata, SizeType32 maxWordsLen, TokenIdType const** outputIds,
+    TokenIdType const** badWords, SizeType32 const* badWordsLen, SizeType32 const* sequenceLengths,
+    SizeType32 const* batchSlots, SizeType32 batchSize, SizeType32 vocabSizePadded, cudaStream_t stream)
+{
+    constexpr SizeType32 blockSize{32};
+    banBadWordsAutomaton<<<batchSize, blockSize, 0, stream>>>(logits, automata, maxWordsLen, outputIds, badWords,
+        badWordsLen, sequenceLengths, batchSlots, vocabSizePadded);
+    sync_check_cuda_error();
+}
+
+#define INSTANTIATE_BAN_BAD_WORDS_AUTOMATON(T)                                                                         \
+    template void invokeBanBadWordsAutomaton(T* logits, SizeType32* automata, SizeType32 maxWordsLen,                  \
+        TokenIdType const** outputIds, TokenIdType const** badWords, SizeType32 const* badWordsLen,                    \
+        SizeType32 const* sequenceLengths, SizeType32 const* batchSlots, SizeType32 batchSize,                         \
+        SizeType32 vocabSizePadded, cudaStream_t stream)
+
+INSTANTIATE_BAN_BAD_WORDS_AUTOMATON(float);
+INSTANTIATE_BAN_BAD_WORDS_AUTOMATON(half);
+#ifdef ENABLE_BF16
+INSTANTIATE_BAN_BAD_WORDS_AUTOMATON(__nv_bfloat16);
+#endif
+
+#undef INSTANTIATE_BAN_BAD_WORDS_AUTOMATON
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/runtime/common.h"
+#include <cuda_fp16.h>
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+//! \brief Aho-Corasick automata over the stop words or bad words lists of the requests.
+//!
+//! The automaton of a request is compiled on the GPU from its word list in the [2, wordsLen] format of
+//! invokeStopWordsCriterion the first time the request is seen after invokeResetWordListAutomata, so the word lists
+//! never go through the host. Each step the automaton state is advanced by the new tokens only, instead of comparing
+//! every word against the tail of the sequence. The state is the longest suffix of the sequence that is a prefix of
+//! a word, so it is recomputed from the last maxWordLen tokens whenever the sequence length does not continue from
+//! the last call (after a reset or after rejected draft tokens).
+//!
+//! The automata of all slots live in one buffer [maxBatchSize, getWordListAutomatonSize(maxWordsLen)] of int32.
+//! Only beamWidth == 1 is supported, beam search has to use the brute force kernels.
+struct WordListAutomatonLayout
+{
+    // Header
+    static constexpr runtime::SizeType32 kNUM_STATES = 0; // 0 if the automaton has not been compiled yet
+    static constexpr runtime::SizeType32 kMAX_WORD_LEN = 1;
+    static constexpr runtime::SizeType32 kSTATE = 2;           // Current state
+    static constexpr runtime::SizeType32 kCONSUMED_LENGTH = 3; // Sequence length the state corresponds to
+    static constexpr runtime::SizeType32 kHEADER_SIZE = 4;
+
+    // Arrays of capacity elements each, capacity being the maximum number of states
+    static constexpr runtime::SizeType32 kFIRST_EDGE = 0;  // Edges of a state are sorted by token
+    static constexpr runtime::SizeType32 kNUM_EDGES = 1;
+    static constexpr runtime::SizeType32 kEDGE_TOKEN = 2;
+    static constexpr runtime::SizeType32 kEDGE_TARGET = 3;
+    static constexpr runtime::SizeType32 kFAIL = 4;         // Longest proper suffix which is a state
+    static constexpr runtime::SizeType32 kMATCH = 5;        // Whether a word ends at this state
+    static constexpr runtime::SizeType32 kNODE_TOKEN = 6;   // Compilation only
+    static constexpr runtime::SizeType32 kFIRST_CHILD = 7;  // Compilation only
+    static constexpr runtime::SizeType32 kNEXT_SIBLING = 8; // Compilation only
+    static constexpr runtime::SizeType32 kQUEUE = 9;        // Compilation only
+    static constexpr runtime::SizeType32 kNUM_ARRAYS = 10;
+};
+
+//! \brief Number of int32 reserved per request for word lists of at most maxWordsLen tokens.
+[[nodiscard]] constexpr runtime::SizeType32 getWordListAutomatonSize(runtime::SizeType32 maxWordsLen)
+{
+    return WordListAutomatonLayout::kHEADER_SIZE + WordListAutomatonLayout::kNUM_ARRAYS * (maxWordsLen + 1);
+}
+
+//! \brief View on the automaton of one request.
+class WordListAutomaton
+{
+public:
+    using SizeType32 = runtime::SizeType32;
+    using TokenIdType = runtime::TokenIdType;
+    using Layout = WordListAutomatonLayout;
+
+    static constexpr SizeType32 kROOT = 0;
+
+    __host__ __device__ WordListAutomaton(SizeType32* data, SizeType32 maxWordsLen)
+        : mData{data}
+        , mCapacity{maxWordsLen + 1}
+    {
+    }
+
+    __host__ __device__ SizeType32& header(SizeType32 field) const
+    {
+        return mData[field];
+    }
+
+    [[nodiscard]] __host__ __device__ bool isCompiled() const
+    {
+        return header(Layout::kNUM_STATES) > 0;
+    }
+
+    [[nodiscard]] __host__ __device__ SizeType32 getMaxWordLen() const
+    {
+        return header(Layout::kMAX_WORD_LEN);
+    }
+
+    [[nodiscard]] __host__ __device__ bool isMatch(SizeType32 state) const
+    {
+        return array(Layout::kMATCH)[state] != 0;
+    }
+
+    [[nodiscard]] __host__ __device__ SizeType32 getFail(SizeType32 state) const
+    {
+        return array(Layout::kFAIL)[state];
+    }
+
+    [[nodiscard]] __host__ __device__ SizeType32 getFirstEdge(SizeType32 state) const
+    {
+        return array(Layout::kFIRST_EDGE)[state];
+    }
+
+    [[nodiscard]] __host__ __device__ SizeType32 getNumEdges(SizeType32 state) const
+    {
+        return array(Layout::kNUM_EDGES)[state];
+    }
+
+    [[nodiscard]] __host__ __device__ TokenIdType getEdgeToken(SizeType32 edge) const
+    {
+        return array(Layout::kEDGE_TOKEN)[edge];
+    }
+
+    [[nodiscard]] __host__ __device__ SizeType32 getEdgeTarget(SizeType32 edge) const
+    {
+        return array(Layout::kEDGE_TARGET)[edge];
+    }
+
+    //! \brief Trie child of state for token, -1 if none.
+    [[nodiscard]] __host__ __device__ SizeType32 getChild(SizeType32 state, TokenIdType token) const
+    {
+        auto left = getFirstEdge(state);
+        auto right = left + getNumEdges(state);
+        while (left < right)
+        {
+            auto const mid = (left + right) / 2;
+            auto const midToken = getEdgeToken(mid);
+            if (midToken == token)
+            {
+                return getEdgeTarget(mid);
+            }
+            if (midToken < token)
+            {
+                left = mid + 1;
+            }
+            else
+            {
+                right = mid;
+            }
+        }
+        return -1;
+    }
+
+    //! \brief State after reading token in state, following failure links. Amortized O(1) per token.
+    [[nodiscard]] __host__ __device__ SizeType32 next(SizeType32 state, TokenIdType token) const
+    {
+        while (true)
+        {
+            auto const child = getChild(state, token);
+            if (child >= 0)
+            {
+                return child;
+            }
+            if (state == kROOT)
+            {
+                return kROOT;
+            }
+            state = getFail(state);
+        }
+    }
+
+    //! \brief Compiles the word list [2, wordsLen] of a request. Runs single threaded, wordsLen <= maxWordsLen.
+    __host__ __device__ void compile(TokenIdType const* words, SizeType32 wordsLen)
+    {
+        auto* firstEdge = array(Layout::kFIRST_EDGE);
+        auto* numEdges = array(Layout::kNUM_EDGES);
+        auto* edgeToken = array(Layout::kEDGE_TOKEN);
+        auto* edgeTarget = array(Layout::kEDGE_TARGET);
+        auto* fail = array(Layout::kFAIL);
+        auto* match = array(Layout::kMATCH);
+        auto* nodeToken = array(Layout::kNODE_TOKEN);
+        auto* firstChild = array(Layout::kFIRST_CHILD);
+        auto* nextSibling = array(Layout::kNEXT_SIBLING);
+        auto* queue = array(Layout::kQUEUE);
+
+        auto const initNode = [&](SizeType32 node, TokenIdType token)
+        {
+            nodeToken[node] = token;
+            firstChild[node] = -1;
+            nextSibling[node] = -1;
+            match[node] = 0;
+            fail[node] = kROOT;
+        };
+
+        // Build the trie, with the children of each node sorted by token
+        SizeType32 numStates = 1;
+        SizeType32 maxWordLen = 0;
+        initNode(kROOT, -1);
+        auto const* offsets = words + wordsLen;
+        for (SizeType32 wordIdx = 0; wordIdx < wordsLen && offsets[wordIdx] >= 0; ++wordIdx)
+        {
+            auto const wordEnd = offsets[wordIdx];
+            auto const wordStart = wordIdx > 0 ? offsets[wordIdx - 1] : 0;
+            if (wordEnd <= wordStart || wordEnd > wordsLen)
+            {
+                continue;
+            }
+            auto node = kROOT;
+            for (auto pos = wordStart; pos < wordEnd; ++pos)
+            {
+                auto const token = words[pos];
+                auto* link = &firstChild[node];
+                while (*link >= 0 && nodeToken[*link] < token)
+                {
+                    link = &nextSibling[*link];
+                }
+                if (*link < 0 || nodeToken[*link] != token)
+                {
+                    auto const child = numStates++;
+                    initNode(child, token);
+                    nextSibling[child] = *link;
+                    *link = child;
+                }
+                node = *link;
+            }
+            match[node] = 1;
+            maxWordLen = wordEnd - wordStart > maxWordLen ? wordEnd - wordStart : maxWordLen;
+        }
+
+        // Lay out the edges and compute failure links in BFS order, so that all states of lower depth, which failure
+        // links point to, are complete when a state is visited
+        SizeType32 head = 0;
+        SizeType32 tail = 0;
+        SizeType32 edge = 0;
+        queue[tail++] = kROOT;
+        while (head < tail)
+        {
+            auto const node = queue[head++];
+            firstEdge[node] = edge;
+            numEdges[node] = 0;
+            for (auto child = firstChild[node]; child >= 0; child = nextSibling[child])
+            {
+                auto const token = nodeToken[child];
+                edgeToken[edge] = token;
+                edgeTarget[edge] = child;
+                ++edge;
+                ++numEdges[node];
+                if (node != kROOT)
+                {
+                    auto suffix = fail[node];
+                    auto target = getChild(suffix, token);
+                    while (target < 0 && suffix != kROOT)
+                    {
+                        suffix = fail[suffix];
+                        target = getChild(suffix, token);
+                    }
+                    fail[child] = target >= 0 ? target : kROOT;
+                }
+                match[child] |= match[fail[child]];
+                queue[tail++] = child;
+            }
+        }
+
+        header(Layout::kMAX_WORD_LEN) = maxWordLen;
+        header(Layout::kSTATE) = kROOT;
+        header(Layout::kCONSUMED_LENGTH) = -1;
+        header(Layout::kNUM_STATES) = numStates;
+    }
+
+    //! \brief Brings the state to sequence position endPos, either by continuing from the last consumed position or
+    //! by recomputing it from the last maxWordLen tokens.
+    [[nodiscard]] __host__ __device__ SizeType32 sync(TokenIdType const* tokens, SizeType32 endPos) const
+    {
+        auto state = header(Layout::kSTATE);
+        auto const consumedLength = header(Layout::kCONSUMED_LENGTH);
+        auto pos = consumedLength;
+        if (consumedLength < 0 || consumedLength > endPos || endPos - consumedLength > getMaxWordLen())
+        {
+            state = kROOT;
+            pos = endPos - getMaxWordLen() > 0 ? endPos - getMaxWordLen() : 0;
+        }
+        for (; pos < endPos; ++pos)
+        {
+            state = next(state, tokens[pos]);
+        }
+        return state;
+    }
+
+    __host__ __device__ void store(SizeType32 state, SizeType32 consumedLength) const
+    {
+        header(Layout::kSTATE) = state;
+        header(Layout::kCONSUMED_LENGTH) = consumedLength;
+    }
+
+private:
+    [[nodiscard]] __host__ __device__ SizeType32* array(SizeType32 index) const
+    {
+        return mData + Layout::kHEADER_SIZE + index * mCapacity;
+    }
+
+    SizeType32* mData;
+    SizeType32 mCapacity;
+};
+
+//! \brief Marks the automata of the given batch slots to be compiled again from their word lists on the next use.
+//! \param automata [maxBatchSize, getWordListAutomatonSize(maxWordsLen)]
+//! \param batchSlots [batchSize] on the GPU
+void invokeResetWordListAutomata(runtime::SizeType32* automata, runtime::SizeType32 maxWordsLen,
+    runtime::SizeType32 const* batchSlots, runtime::SizeType32 batchSize, cudaStream_t stream);
+
+//! \brief Same semantics as invokeStopWordsCriterion for beamWidth == 1, advancing the Aho-Corasick automaton of
+//! every request by its new tokens.
+//!
+//! \param automata input/output buffer [maxBatchSize, getWordListAutomatonSize(maxWordsLen)]
+//! \param maxWordsLen capacity of the automata, at least the stopWordsLen of every request
+//! \param other parameters as in invokeStopWordsCriterion
+void invokeStopWordsAutomatonCriterion(runtime::SizeType32* automata, runtime::SizeType32 maxWordsLen,
+    runtime::TokenIdType const** outputIds, runtime::TokenIdType const** stopWords, FinishedState* finished,
+    runtime::SizeType32* sequenceLengths, runtime::SizeType32 const* batchSlots,
+    runtime::SizeType32 const* stopWordsLen, runtime::SizeType32* numNewTokens, runtime::SizeType32 batchSize,
+    cudaStream_t stream);
+
+//! \brief Same semantics as invokeBanBadWords for beamWidth == 1: bans every token which completes a bad word after
+//! the current Aho-Corasick automaton state of the request.
+//!
+//! \param automata input/output buffer [maxBatchSize, getWordListAutomatonSize(maxWordsLen)]
+//! \param maxWordsLen capacity of the automata, at least the badWordsLen of every request
+//! \param other parameters as in invokeBanBadWords
+template <typename T>
+void invokeBanBadWordsAutomaton(T* logits, runtime::SizeType32* automata, runtime::SizeType32 maxWordsLen,
+    runtime::TokenIdType const** outputIds, runtime::TokenIdType const** badWords,
+    runtime::SizeType32 const* badWordsLen, runtime::SizeType32 const* sequenceLengths,
+    runtime::SizeType32 const* batchSlots, runtime::SizeType32 batchSize, runtime::SizeType32 vocabSizePadded,
+    cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
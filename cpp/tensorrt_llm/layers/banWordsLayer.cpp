@@ -20,6 +20,8 @@
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/kernels/banBadWords.h"
 #include "tensorrt_llm/kernels/banRepeatNgram.h"
+#include "tensorrt_llm/kernels/tokenMaskAutomaton.h"
+#include "tensorrt_llm/kernels/wordListAutomaton.h"
 #include "tensorrt_llm/layers/defaultDecodingParams.h"
 #include "tensorrt_llm/layers/layerUtils.h"
 
@@ -78,6 +80,17 @@ void BanWordsLayer<T>::allocateBuffer()
         mNoRepeatNgramSizeDevice
             = mAllocator->reMalloc(mNoRepeatNgramSizeDevice, sizeof(SizeType32) * mDecoderDomain.getBatchSize(), false);
     }
+    if (mDecodingMode.isUseBanWords())
+    {
+        auto const size = sizeof(SizeType32) * mDecoderDomain.getBatchSize();
+        mTokenMaskStatesDevice = mAllocator->reMalloc(mTokenMaskStatesDevice, size, false);
+        mTokenMaskConsumedLengthsDevice = mAllocator->reMalloc(mTokenMaskConsumedLengthsDevice, size, false);
+    }
+    if (mDecodingMode.isUseBanWords() || mDecodingMode.isUseNoRepeatNgramSize())
+    {
+        mSetupBatchSlotsDevice
+            = mAllocator->reMalloc(mSetupBatchSlotsDevice, sizeof(SizeType32) * mDecoderDomain.getBatchSize(), false);
+    }
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -91,6 +104,25 @@ void BanWordsLayer<T>::freeBuffer()
     {
         mAllocator->free((void**) (&mNoRepeatNgramSizeDevice));
     }
+    if (mDecodingMode.isUseBanWords())
+    {
+        mAllocator->free((void**) (&mTokenMaskStatesDevice));
+        mAllocator->free((void**) (&mTokenMaskConsumedLengthsDevice));
+    }
+    if (mDecodingMode.isUseBanWords() || mDecodingMode.isUseNoRepeatNgramSize())
+    {
+        mAllocator->free((void**) (&mSetupBatchSlotsDevice));
+    }
+    if (mRepeatNgramTablesDevice != nullptr)
+    {
+        mAllocator->free((void**) (&mRepeatNgramTablesDevice));
+        mRepeatNgramTablesMaxSeqLen = 0;
+    }
+    if (mBadWordsAutomataDevice != nullptr)
+    {
+        mAllocator->free((void**) (&mBadWordsAutomataDevice));
+        mBadWordsAutomataMaxWordsLen = 0;
+    }
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -115,6 +147,25 @@ void BanWordsLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, SizeTyp
             mNoRepeatNgramSizeDevice, batchSlotsHost, std::make_pair(0.f, std::numeric_limits<float>::max()),
             "no_repeat_ngram_size");
     }
+    if (mDecodingMode.isUseBanWords() || mDecodingMode.isUseNoRepeatNgramSize())
+    {
+        cudaAutoCpy(mSetupBatchSlotsDevice, batchSlotsHost, batchSize, mStream);
+    }
+    if (mRepeatNgramTablesDevice != nullptr)
+    {
+        invokeResetRepeatNgramTables(
+            mRepeatNgramTablesDevice, mRepeatNgramTablesMaxSeqLen, mSetupBatchSlotsDevice, batchSize, mStream);
+    }
+    if (mDecodingMode.isUseBanWords())
+    {
+        invokeResetTokenMaskAutomaton(
+            mTokenMaskStatesDevice, mTokenMaskConsumedLengthsDevice, mSetupBatchSlotsDevice, batchSize, mStream);
+        if (mBadWordsAutomataDevice != nullptr)
+        {
+            invokeResetWordListAutomata(
+                mBadWordsAutomataDevice, mBadWordsAutomataMaxWordsLen, mSetupBatchSlotsDevice, batchSize, mStream);
+        }
+    }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -127,7 +178,25 @@ void BanWordsLayer<T>::banRepeatNGrams(Tensor& logits, std::shared_ptr<DynamicDe
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
     // auto const maxStep = inputs->step; // TODO (bhsueh) Should we use step? but current inputs->step is always 0.
     auto const maxStep = maxSeqLen;
-    if (useNoRepeatNgramSize)
+    if (useNoRepeatNgramSize && decoderDomain.getBeamWidth() == 1)
+    {
+        if (maxSeqLen > mRepeatNgramTablesMaxSeqLen)
+        {
+            // Tables of all slots are rebuilt with the new layout
+            mRepeatNgramTablesDevice = mAllocator->reMalloc(mRepeatNgramTablesDevice,
+                sizeof(SizeType32) * mDecoderDomain.getBatchSize() * getRepeatNgramTableSize(maxSeqLen), false);
+            mRepeatNgramTablesMaxSeqLen = maxSeqLen;
+            invokeResetRepeatNgramTables(
+                mRepeatNgramTablesDevice, mRepeatNgramTablesMaxSeqLen, nullptr, mDecoderDomain.getBatchSize(), stream);
+        }
+        invokeBanRepeatNgramIncremental(logits.template getPtr<T>(), mRepeatNgramTablesDevice,
+            mRepeatNgramTablesMaxSeqLen, outputs->output_ids_ptr.template getPtr<TokenIdType const*>(),
+            reinterpret_cast<FinishedState*>(
+                inputs->finished.value_or(Tensor{}).template getPtr<FinishedState::UnderlyingType>()),
+            batchSlots, outputs->sequence_length->template getPtr<SizeType32>(), decoderDomain.getBatchSize(),
+            noRepeatNgramSizeDevice, decoderDomain.getVocabSizePadded(), stream);
+    }
+    else if (useNoRepeatNgramSize)
     {
         invokeBanRepeatNgram(logits.template getPtr<T>(), outputs->output_ids_ptr.template getPtr<TokenIdType const*>(),
             reinterpret_cast<FinishedState*>(
@@ -152,12 +221,50 @@ void BanWordsLayer<T>::banBadWords(Tensor& logits, std::shared_ptr<DynamicDecode
         auto const** badWordsPtr = inputs->bad_words_ptr->template getPtr<TokenIdType const*>();
         auto const* badWordsLens = inputs->bad_words_lengths->template getPtr<SizeType32>();
 
-        invokeBanBadWords((T*) logits.template getPtr<T>(),
-            outputs->output_ids_ptr.template getPtr<TokenIdType const*>(),
-            decoderDomain.getBeamWidth() > 1 ? outputs->parent_ids_ptr.template getPtr<SizeType32 const*>() : nullptr,
-            batchSlots, decoderDomain.getBatchSize(), decoderDomain.getBeamWidth(), badWordsPtr, badWordsLens,
-            maxBadWordsLength, decoderDomain.getVocabSizePadded(),
-            outputs->sequence_length->template getPtr<SizeType32>(), maxSeqLen, stream);
+        // Automata are reset in setup, which requires the ban words mode
+        if (mDecodingMode.isUseBanWords() && decoderDomain.getBeamWidth() == 1)
+        {
+            if (maxBadWordsLength > mBadWordsAutomataMaxWordsLen)
+            {
+                // Zeroed automata of all slots are compiled again with the new layout
+                mBadWordsAutomataDevice = mAllocator->reMalloc(mBadWordsAutomataDevice,
+                    sizeof(SizeType32) * mDecoderDomain.getBatchSize() * getWordListAutomatonSize(maxBadWordsLength),
+                    true);
+                mBadWordsAutomataMaxWordsLen = maxBadWordsLength;
+            }
+            invokeBanBadWordsAutomaton(logits.template getPtr<T>(), mBadWordsAutomataDevice,
+                mBadWordsAutomataMaxWordsLen, outputs->output_ids_ptr.template getPtr<TokenIdType const*>(),
+                badWordsPtr, badWordsLens, outputs->sequence_length->template getPtr<SizeType32>(), batchSlots,
+                decoderDomain.getBatchSize(), decoderDomain.getVocabSizePadded(), stream);
+        }
+        else
+        {
+            invokeBanBadWords((T*) logits.template getPtr<T>(),
+                outputs->output_ids_ptr.template getPtr<TokenIdType const*>(),
+                outputs->parent_ids_ptr.template getPtr<SizeType32 const*>(), batchSlots, decoderDomain.getBatchSize(),
+                decoderDomain.getBeamWidth(), badWordsPtr, badWordsLens, maxBadWordsLength,
+                decoderDomain.getVocabSizePadded(), outputs->sequence_length->template getPtr<SizeType32>(), maxSeqLen,
+                stream);
+        }
+    }
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template <typename T>
+void BanWordsLayer<T>::applyTokenMaskAutomaton(Tensor& logits,
+    std::shared_ptr<DynamicDecodeOutputParams> const& outputs, std::shared_ptr<DynamicDecodeInputParams> const& inputs,
+    SizeType32 const* batchSlots, DecoderDomain const& decoderDomain)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    if (inputs->token_mask_automaton_ptr)
+    {
+        TLLM_CHECK_WITH_INFO(decoderDomain.getBeamWidth() == 1, "Token mask automata don't support beam search.");
+        invokeApplyTokenMaskAutomaton(logits.template getPtr<T>(),
+            inputs->token_mask_automaton_ptr->template getPtr<SizeType32 const*>(), mTokenMaskStatesDevice,
+            mTokenMaskConsumedLengthsDevice, outputs->output_ids_ptr.template getPtr<TokenIdType const*>(),
+            outputs->sequence_length->template getPtr<SizeType32>(),
+            inputs->end_ids.template getPtr<TokenIdType const>(), batchSlots, decoderDomain.getBatchSize(),
+            mDecoderDomain.getVocabSize(), decoderDomain.getVocabSizePadded(), mStream);
     }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -178,6 +285,7 @@ void BanWordsLayer<T>::forwardAsync(
     banRepeatNGrams(inputs->logits.value(), outputs, inputs, batchSlots, mNoRepeatNgramSizeDevice, localDecoderDomain,
         maxSeqLen, mUseNoRepeatNgramSize, mStream);
     banBadWords(inputs->logits.value(), outputs, inputs, batchSlots, localDecoderDomain, maxSeqLen, mStream);
+    applyTokenMaskAutomaton(inputs->logits.value(), outputs, inputs, batchSlots, localDecoderDomain);
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
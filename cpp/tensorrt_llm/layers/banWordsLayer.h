@@ -32,8 +32,12 @@ namespace layers
 
 //! \brief Layer to ban specific words from being sampled.
 //! Supports banning bad words and repeating N grams.
-//! Set badWordsPtr, maxBadWordsLen and badWordsLengths to ban bad words.
-//! Set noRepeatNgramSize in input params to ban repeat Ngrams.
+//! Set badWordsPtr, maxBadWordsLen and badWordsLengths to ban bad words. Without beam search the bad words of a
+//! request are compiled into an automaton on its first step, see invokeBanBadWordsAutomaton.
+//! Set noRepeatNgramSize in input params to ban repeat Ngrams. Without beam search the Ngrams of a request are kept in
+//! a hash table which is updated with the new tokens of each step, see invokeBanRepeatNgramIncremental.
+//! Set token_mask_automaton_ptr to constrain generation with per-request token automata, see
+//! invokeApplyTokenMaskAutomaton. Automata are reset to their initial state when their batch slot is set up.
 //! Layer modifies logits in-place.
 template <typename T>
 class BanWordsLayer : public BaseLayer
@@ -54,13 +58,16 @@ private:
     void initialize();
     void allocateBuffer();
     void freeBuffer();
-    static void banBadWords(tc::Tensor& logits, std::shared_ptr<DynamicDecodeOutputParams> const& outputs,
+    void banBadWords(tc::Tensor& logits, std::shared_ptr<DynamicDecodeOutputParams> const& outputs,
         std::shared_ptr<DynamicDecodeInputParams> const& params, runtime::SizeType32 const* batchSlots,
         DecoderDomain const& decoderDomain, runtime::SizeType32 maxSeqLen, cudaStream_t stream);
-    static void banRepeatNGrams(tc::Tensor& logits, std::shared_ptr<DynamicDecodeOutputParams> const& outputs,
+    void banRepeatNGrams(tc::Tensor& logits, std::shared_ptr<DynamicDecodeOutputParams> const& outputs,
         std::shared_ptr<DynamicDecodeInputParams> const& inputs, runtime::SizeType32 const* batchSlots,
         runtime::SizeType32 const* noRepeatNgramSizeDevice, DecoderDomain const& decoderDomain,
         runtime::SizeType32 maxSeqLen, bool useNoRepeatNgramSize, cudaStream_t stream);
+    void applyTokenMaskAutomaton(tc::Tensor& logits, std::shared_ptr<DynamicDecodeOutputParams> const& outputs,
+        std::shared_ptr<DynamicDecodeInputParams> const& inputs, runtime::SizeType32 const* batchSlots,
+        DecoderDomain const& decoderDomain);
 
 private:
     using BaseLayer::mWorkspaceSize;
@@ -74,6 +81,20 @@ private:
     runtime::SizeType32* mNoRepeatNgramSizeDevice{nullptr};
     std::vector<SizeType32> mNoRepeatNgramSize;
     bool mUseNoRepeatNgramSize{false};
+    // Ngram tables, indexed by batch slot, allocated on first use for sequences of at most
+    // mRepeatNgramTablesMaxSeqLen tokens
+    runtime::SizeType32* mRepeatNgramTablesDevice{nullptr};
+    runtime::SizeType32 mRepeatNgramTablesMaxSeqLen{0};
+
+    // Token mask automata state, indexed by batch slot
+    runtime::SizeType32* mTokenMaskStatesDevice{nullptr};
+    runtime::SizeType32* mTokenMaskConsumedLengthsDevice{nullptr};
+    runtime::SizeType32* mSetupBatchSlotsDevice{nullptr};
+
+    // Bad words automata, indexed by batch slot, allocated on first use for words lists of at most
+    // mBadWordsAutomataMaxWordsLen tokens
+    runtime::SizeType32* mBadWordsAutomataDevice{nullptr};
+    runtime::SizeType32 mBadWordsAutomataMaxWordsLen{0};
 };
 
 } // namespace layers
@@ -49,8 +49,8 @@ public:
         return mStream;
     }
 
-    //! @brief set stream to the layer
-    void setStream(cudaStream_t stream) noexcept
+    //! @brief set stream to the layer, and to the layers it contains
+    virtual void setStream(cudaStream_t stream) noexcept
     {
         mStream = stream;
     }
@@ -50,8 +50,8 @@ void BeamSearchLayer<T>::setup(runtime::SizeType32 const batchSize, runtime::Siz
     runtime::SizeType32 const* batchSlots, std::shared_ptr<BaseSetupParams> baseSetupParams)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
-    TLLM_CHECK_WITH_INFO(
-        beamWidth <= nMaxBeamWidth, std::string("Beam width is larger than the maximum supported (64)."));
+    TLLM_CHECK_WITH_INFO(beamWidth <= nMaxBeamWidth, "Beam width (%d) is larger than the maximum supported (%d).",
+        beamWidth, nMaxBeamWidth);
 
     auto setupParams = std::dynamic_pointer_cast<BeamSearchSetupParams>(baseSetupParams);
 
@@ -137,6 +137,8 @@ void BeamSearchLayer<T>::forwardAsyncSingleRequest(
     bh.earlyStoppings = mEarlyStoppingDevice;
     bh.inputLengths = ip->input_lengths->template getPtr<int const>();
     bh.endIds = ip->end_ids.template getPtr<int const>();
+    bh.sequenceLimitLengths
+        = ip->sequence_limit_length ? ip->sequence_limit_length->template getPtr<int const>() : nullptr;
     bh.logProbsTiled = (op->output_log_probs) ? op->output_log_probs->template getPtr<float>() : nullptr;
     bh.sequenceLengths = op->sequence_length->template getPtr<int>();
     bh.cumLogProbs = op->cum_log_probs->template getPtr<float>();
@@ -219,6 +221,11 @@ void BeamSearchLayer<T>::forwardAsync(
             forwardParams->input_lengths = params->input_lengths->slice(
                 {dynamic_decode_batch_size * localDecoderDomain.getBeamWidth()}, dynamic_id_offset);
         }
+        if (params->sequence_limit_length)
+        {
+            forwardParams->sequence_limit_length = params->sequence_limit_length->slice(
+                {dynamic_decode_batch_size}, dynamic_ite * dynamic_decode_batch_size);
+        }
 
         auto outputParams = std::make_shared<BeamSearchOutputParams>(
             outputs->output_ids, outputs->parent_ids.value(), outputs->tgt_cache_indirection.value());
@@ -244,11 +251,8 @@ template <typename T>
 void BeamSearchLayer<T>::allocateBuffer(runtime::SizeType32 const batchSize, runtime::SizeType32 const beamWidth)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
-    int const nPadBeamWidth = padToNextPowerOfTwo(beamWidth);
     // Unit of mWorkspaceSize is number of elements (not Byte), align to 4 for further optimization
-    size_t nTopK = batchSize * nPadBeamWidth * nPadBeamWidth * 2;
-    size_t nTempBuffer = batchSize * nPadBeamWidth * nMaxVocabPartForStage1FastKernel * (2 * (nPadBeamWidth * 2) + 2);
-    mWorkspaceSize = roundUp(nTopK, 4) * 2 + roundUp(nTempBuffer, 4);
+    mWorkspaceSize = getTopkSoftMaxWorkspaceSize(batchSize, beamWidth);
     mWorkspace = mAllocator->reMalloc(mWorkspace, sizeof(float) * mWorkspaceSize, true);
     mDiversityRateDevice = mAllocator->reMalloc(mDiversityRateDevice, sizeof(float) * batchSize, false);
     mLengthPenaltyDevice = mAllocator->reMalloc(mLengthPenaltyDevice, sizeof(float) * batchSize, false);
@@ -65,7 +65,8 @@ public:
     runtime::SizeType32 sink_token_length;
     runtime::SizeType32 max_seq_len;
     tc::Tensor src_cache_indirection;        // [BS, BM, mSL]
-    std::optional<tc::Tensor> input_lengths; // [BS, BM]
+    std::optional<tc::Tensor> input_lengths;         // [BS, BM]
+    std::optional<tc::Tensor> sequence_limit_length; // [BS]
 };
 
 class BeamSearchOutputParams : public BaseOutputParams
@@ -266,6 +266,8 @@ std::tuple<std::shared_ptr<BaseOutputParams>, std::shared_ptr<BaseInputParams>>
             decodeOutputs->output_log_probs
                 = output_log_probs.slice({1, localBatchSize * localDecoderDomain.getBeamWidth()}, 0);
         }
+        decodeOutputs->output_top_log_probs = outputs->output_top_log_probs;
+        decodeOutputs->output_top_log_prob_ids = outputs->output_top_log_prob_ids;
 
         preparedInputs = decodeInputs;
         preparedOutputs = decodeOutputs;
@@ -308,6 +310,15 @@ std::tuple<std::shared_ptr<BaseOutputParams>, std::shared_ptr<BaseInputParams>>
     return {preparedOutputs, preparedInputs};
 }
 
+template <typename T>
+void DecodingLayer<T>::setupProbsTruncation(
+    SizeType32 batchSize, SizeType32 const* batchSlots, SamplingSetupParams const& params)
+{
+    auto* samplingLayer = dynamic_cast<SamplingLayer<T>*>(mDecodingLayer.get());
+    TLLM_CHECK_WITH_INFO(samplingLayer != nullptr, "Probs truncation is only supported with TopK or TopP decoding.");
+    samplingLayer->setupProbsTruncation(batchSize, batchSlots, params);
+}
+
 template class DecodingLayer<float>;
 template class DecodingLayer<half>;
 
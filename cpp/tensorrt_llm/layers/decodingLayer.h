@@ -53,9 +53,22 @@ public:
     //! Modifies outputs->logits in-place.
     void forwardAsync(std::shared_ptr<BaseOutputParams> outputs, std::shared_ptr<BaseInputParams> inputs) override;
 
+    void setStream(cudaStream_t stream) noexcept override
+    {
+        BaseLayer::setStream(stream);
+        if (mDecodingLayer)
+        {
+            mDecodingLayer->setStream(stream);
+        }
+    }
+
     //! \brief Calls forwardSync of configired decoding layer.
     void forwardSync(std::shared_ptr<BaseOutputParams> outputs, std::shared_ptr<BaseInputParams> inputs) override;
 
+    //! \brief Calls SamplingLayer::setupProbsTruncation. Only supported when sampling.
+    void setupProbsTruncation(
+        runtime::SizeType32 batchSize, runtime::SizeType32 const* batchSlots, SamplingSetupParams const& params);
+
 private:
     std::tuple<std::shared_ptr<BaseOutputParams>, std::shared_ptr<BaseInputParams>> prepareParams(
         std::shared_ptr<BaseOutputParams> outputs, std::shared_ptr<BaseInputParams> inputs) const;
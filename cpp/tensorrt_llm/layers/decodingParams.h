@@ -221,6 +221,9 @@ public:
     std::optional<tc::Tensor> stop_words_ptr;        // [maxBatchSize][2, stop_words_length], on gpu
     std::optional<tc::Tensor> stop_words_lengths;    // [maxBatchSize], on gpu
 
+    // [maxBatchSize][numStates, vocabSize] next state per token or -1 if banned, nullptr if unconstrained, on gpu
+    std::optional<tc::Tensor> token_mask_automaton_ptr;
+
     // Medusa inputs
     class MedusaInputs
     {
@@ -265,6 +268,8 @@ public:
     std::optional<tc::Tensor> cum_log_probs;    // [maxBatchSize * maxBeamWidth], necessary in beam search
     std::optional<tc::Tensor> output_log_probs; // [maxBatchSize, maxBeamWidth, maxSeqLen], must be float*, optional
     std::optional<tc::Tensor> parent_ids;       // [maxBatchSize, maxBeamWidth, maxSeqLen], necessary in beam search
+    std::optional<tc::Tensor> output_top_log_probs;    // [maxSeqLen, maxBatchSize, numTopLogProbs], float*, optional
+    std::optional<tc::Tensor> output_top_log_prob_ids; // [maxSeqLen, maxBatchSize, numTopLogProbs], optional
 
     tc::Tensor output_ids_ptr; // [maxBatchSize] int* (2-d array), each int* has [maxBeamWidth, maxSeqLen]
 
@@ -334,7 +339,7 @@ public:
     // mandatory parameters
     tc::Tensor newTokens; // [maxBatchSize, maxBeamWidth]
     // optional parameters
-    std::optional<tc::Tensor> finished_sum;           // [1] in pinned host memory
+    std::optional<tc::Tensor> finished_sum;           // [batchSize] in pinned host memory or on the device
     std::optional<tc::Tensor> output_log_probs_tiled; // [maxSeqLen, maxBatchSize, maxBeamWidth], must be float*
     std::optional<tc::Tensor>
         tgt_cache_indirection; // [forwardBatchSize, maxBeamWidth, maxSeqLen], the k/v cache index for beam search
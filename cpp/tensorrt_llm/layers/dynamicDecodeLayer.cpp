@@ -287,6 +287,23 @@ void DynamicDecodeLayer<T>::prepareOutputData(std::shared_ptr<DynamicDecodeOutpu
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+template <typename T>
+void DynamicDecodeLayer<T>::setupProbsTruncation(
+    SizeType32 batchSize, SizeType32 const* batchSlots, SamplingSetupParams const& params)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    for (auto& layer : mLayers)
+    {
+        if (auto* decodingLayer = dynamic_cast<DecodingLayer<T>*>(layer.get()))
+        {
+            decodingLayer->setupProbsTruncation(batchSize, batchSlots, params);
+        }
+    }
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 template class DynamicDecodeLayer<float>;
 template class DynamicDecodeLayer<half>;
 
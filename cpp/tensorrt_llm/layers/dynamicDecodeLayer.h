@@ -65,6 +65,19 @@ public:
 
     void forwardSync(std::shared_ptr<BaseOutputParams> outputs, std::shared_ptr<BaseInputParams> inputs) override;
 
+    //! \brief Sets up min-p, typical-p and eta truncation of the slots of the batch, after setup().
+    void setupProbsTruncation(
+        runtime::SizeType32 batchSize, runtime::SizeType32 const* batchSlots, SamplingSetupParams const& params);
+
+    void setStream(cudaStream_t stream) noexcept override
+    {
+        Base::setStream(stream);
+        for (auto& layer : mLayers)
+        {
+            layer->setStream(stream);
+        }
+    }
+
     // Function is only used by test.
     // It is guaranteed by LayersFactory that the first layer is the Penalty layer.
     T* getRuntimeLogitsDevice()
@@ -229,7 +229,6 @@ void ExplicitDraftTokensLayer<T>::splitInputDataToBatchSlots(
     params.generationLengthInclusiveSum = mGenerationLengthInclusiveSum;
     params.inputTemperatures = mTemperatureDevice;
     params.curandState = mCurandStatesDevice;
-    params.curandState = mCurandStatesDevice;
     params.batchSize = batchSize;
     params.numPaths = mDecoderDomain.getSpeculativeDecodingModule()->getMaxNumPaths();
     params.maxPathLength = mDecoderDomain.getSpeculativeDecodingModule()->getMaxPathLen();
@@ -238,8 +237,6 @@ void ExplicitDraftTokensLayer<T>::splitInputDataToBatchSlots(
 
     invokeExtractExplicitDraftTokens(params, mStream);
 
-    invokeCopyProbs(params, mStream);
-
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
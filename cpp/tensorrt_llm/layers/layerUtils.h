@@ -46,6 +46,7 @@ struct FillBuffers
     {
         using tensorrt_llm::common::cudaAutoCpy;
 
+        bool changed = false;
         for (size_t bi = 0; bi < batchSize; ++bi)
         {
             auto value = defaultValue;
@@ -65,9 +66,14 @@ struct FillBuffers
             TLLM_CHECK_WITH_INFO(limits.first < static_cast<float>(value) && static_cast<float>(value) <= limits.second,
                 "%s param (%f) is out of limits (%f, %f]", name.c_str(), static_cast<float>(value), limits.first,
                 limits.second);
+            changed |= hostBuffer[batchSlot] != value;
             hostBuffer[batchSlot] = value;
         }
 
+        if (skipUnchanged && !changed)
+        {
+            return;
+        }
         if (batchSlots)
         {
             cudaAutoCpy(deviceBuffer, hostBuffer.data(), maxBatchSize, stream);
@@ -81,6 +87,9 @@ struct FillBuffers
     runtime::SizeType32 batchSize;
     runtime::SizeType32 maxBatchSize;
     cudaStream_t stream;
+    //! Skips the copy if the values of the batch are in the host buffer already. Only valid if the device buffer
+    //! mirrors the host buffer, e.g. both were initialized to the defaults.
+    bool skipUnchanged{false};
 };
 
 template <typename T>
@@ -143,7 +143,7 @@ runtime::SizeType32 LookaheadAlgorithm::guess(TensorPtr const& guessTokens, Tens
     auto guesses = mPoolManager.guess(lastToken, mW);
 
     SizeType32 len = 0;
-    std::for_each(guesses.begin(), guesses.end(), [&len](auto& a) { len += ITensor::volume(a->getShape()); });
+    std::for_each(guesses.begin(), guesses.end(), [&len](auto const& a) { len += a.size(); });
     TLLM_CHECK(len <= ITensor::volume(guessTokens->getShape()));
     TLLM_CHECK(len <= ITensor::volume(guessIds->getShape()));
     TLLM_CHECK(len <= ITensor::volume(samplingMask->getShape()));
@@ -152,14 +152,13 @@ runtime::SizeType32 LookaheadAlgorithm::guess(TensorPtr const& guessTokens, Tens
     BufferRange<bool> samplingMaskRange(*samplingMask);
 
     SizeType32 cur = 0;
-    for (auto guess : guesses)
+    for (auto const& guessRange : guesses)
     {
-        BufferRange<TokenIdType const> guessRange(*guess);
         std::copy(guessRange.begin(), guessRange.end(), guessTokensRange.begin() + cur);
         SizeType32 tmp = offset;
         std::for_each(
             guessIdsRange.begin() + cur, guessIdsRange.begin() + cur + mN - 1, [&tmp](auto& v) { v = tmp++; });
-        cur += ITensor::volume(guess->getShape());
+        cur += guessRange.size();
     }
 
     std::for_each(samplingMaskRange.begin(), samplingMaskRange.begin() + len, [](auto& a) { a = true; });
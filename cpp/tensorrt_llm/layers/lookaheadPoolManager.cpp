@@ -17,6 +17,8 @@
 #include "tensorrt_llm/layers/lookaheadPoolManager.h"
 #include "tensorrt_llm/layers/lookaheadDecodingUtils.h"
 
+#include <algorithm>
+
 namespace tensorrt_llm::layers
 {
 
@@ -27,30 +29,76 @@ void LookaheadPoolManager::setup(SizeType32 guessSetSize)
     TLLM_CHECK(guessSetSize > 0 && guessSetSize <= mGuessSetSizeMax);
     mGuessSetSize = guessSetSize;
     mTokenMap.clear();
+    // Keep the arena of the previous request, all of its nodes become available again
+    mFreeNodes.clear();
+    mNumNodes = 0;
+    mNgramLen = 0;
+}
+
+SizeType32 LookaheadPoolManager::allocateNode()
+{
+    if (!mFreeNodes.empty())
+    {
+        auto const node = mFreeNodes.back();
+        mFreeNodes.pop_back();
+        return node;
+    }
+    auto const node = mNumNodes++;
+    if (node >= static_cast<SizeType32>(mPrev.size()))
+    {
+        mPrev.push_back(-1);
+        mNext.push_back(-1);
+    }
+    auto const arenaSize = static_cast<std::size_t>(mNumNodes) * mNgramLen;
+    if (mArena.size() < arenaSize)
+    {
+        mArena.resize(std::max(arenaSize, 2 * mArena.size()));
+    }
+    return node;
 }
 
-void LookaheadPoolManager::insertOne(Key key, TensorConstPtr const& ngram)
+void LookaheadPoolManager::removeNode(NgramList& list, SizeType32 node)
 {
-    auto search = mTokenMap.find(key);
-    if (search != mTokenMap.end())
+    auto const prev = mPrev[node];
+    auto const next = mNext[node];
+    (prev >= 0 ? mNext[prev] : list.head) = next;
+    (next >= 0 ? mPrev[next] : list.tail) = prev;
+    list.size--;
+    mFreeNodes.push_back(node);
+}
+
+void LookaheadPoolManager::insertOne(Key key, Key const* ngram, SizeType32 ngramLen)
+{
+    if (mNgramLen == 0)
     {
-        search->second.remove_if(
-            [&ngram](TensorConstPtr const& item)
-            {
-                BufferRange<TokenIdType const> ngramRange(*ngram);
-                BufferRange<TokenIdType const> itemRange(*item);
-                return std::equal(ngramRange.begin(), ngramRange.end(), itemRange.begin());
-            });
-        if (mGuessSetSize >= 0 && search->second.size() >= mGuessSetSize)
+        mNgramLen = ngramLen;
+    }
+    TLLM_CHECK_WITH_INFO(ngramLen == mNgramLen, "all n-grams of a request must have the same length (%d != %d)",
+        ngramLen, mNgramLen);
+
+    auto& list = mTokenMap[key];
+    for (auto node = list.head; node >= 0;)
+    {
+        auto const next = mNext[node];
+        auto const item = getNgram(node);
+        if (std::equal(item.begin(), item.end(), ngram))
         {
-            search->second.pop_front();
+            removeNode(list, node);
         }
-        search->second.push_back(ngram);
+        node = next;
     }
-    else
+    if (mGuessSetSize >= 0 && list.size >= mGuessSetSize)
     {
-        mTokenMap.insert({key, std::list<TensorConstPtr>({ngram})});
+        removeNode(list, list.head);
     }
+
+    auto const node = allocateNode();
+    std::copy(ngram, ngram + ngramLen, mArena.begin() + static_cast<std::size_t>(node) * mNgramLen);
+    mPrev[node] = list.tail;
+    mNext[node] = -1;
+    (list.tail >= 0 ? mNext[list.tail] : list.head) = node;
+    list.tail = node;
+    list.size++;
 }
 
 void LookaheadPoolManager::accept(TensorConstPtr const& prompt, SizeType32 level)
@@ -59,54 +107,63 @@ void LookaheadPoolManager::accept(TensorConstPtr const& prompt, SizeType32 level
     BufferRange<Key const> promptRange(*prompt);
     for (SizeType32 ti = 0; ti + level - 1 < length; ti++)
     {
-        auto key = promptRange[ti];
-        TensorPtr ngram = BufferManager::cpu(ITensor::makeShape({level - 1}), nvinfer1::DataType::kINT32);
-        BufferRange<TokenIdType const> sourceRange(*ITensor::slice(prompt, ti + 1, level - 1));
-        BufferRange<TokenIdType> ngramRange(*ngram);
-        std::copy(sourceRange.begin(), sourceRange.end(), ngramRange.begin());
-
-        insertOne(key, ngram);
+        insertOne(promptRange[ti], promptRange.begin() + ti + 1, level - 1);
     }
 }
 
-std::list<LookaheadPoolManager::TensorConstPtr> LookaheadPoolManager::guess(Key lastToken, SizeType32 guessSize) const
+std::vector<LookaheadPoolManager::NgramView> LookaheadPoolManager::collect(
+    NgramList const& list, SizeType32 count) const
 {
-    auto search = mTokenMap.find(lastToken);
-    if (search != mTokenMap.end())
+    std::vector<NgramView> ngrams;
+    ngrams.reserve(count);
+    auto node = list.tail;
+    for (SizeType32 i = 1; i < count; i++)
     {
-        auto ngrams = search->second;
-        if (ngrams.size() > guessSize)
-        {
-            auto it = std::prev(ngrams.end(), guessSize);
-            return std::list<TensorConstPtr>(it, ngrams.end());
-        }
-        else
-        {
-            return ngrams;
-        }
+        node = mPrev[node];
     }
-    else
+    for (; node >= 0; node = mNext[node])
     {
-        return std::list<TensorConstPtr>();
+        ngrams.push_back(getNgram(node));
     }
+    return ngrams;
+}
+
+std::vector<LookaheadPoolManager::NgramView> LookaheadPoolManager::guess(Key lastToken, SizeType32 guessSize) const
+{
+    auto search = mTokenMap.find(lastToken);
+    if (search == mTokenMap.end() || search->second.size == 0)
+    {
+        return {};
+    }
+    return collect(search->second, std::min(search->second.size, guessSize));
 }
 
 void LookaheadPoolManager::update(TensorConstPtr const& keyTokens, TensorConstPtr const& ngramTokens)
 {
     TLLM_CHECK(keyTokens->getShape().d[0] == ngramTokens->getShape().d[0]);
     BufferRange<Key const> keyRange(*keyTokens);
+    BufferRange<Key const> ngramRange(*ngramTokens);
     auto window = ngramTokens->getShape().d[0];
+    auto ngramLen = static_cast<SizeType32>(ngramTokens->getShape().d[1]);
 
     for (SizeType32 wi = 0; wi < window; wi++)
     {
-        TensorConstPtr source = ITensor::at(ngramTokens, {wi});
-        TensorPtr ngram = BufferManager::cpu(source->getShape(), nvinfer1::DataType::kINT32);
-        BufferRange<TokenIdType const> sourceRange(*source);
-        BufferRange<TokenIdType> ngramRange(*ngram);
-        std::copy(sourceRange.begin(), sourceRange.end(), ngramRange.begin());
+        insertOne(keyRange[wi], ngramRange.begin() + wi * ngramLen, ngramLen);
+    }
+}
 
-        insertOne(keyRange[wi], ngram);
+std::unordered_map<LookaheadPoolManager::Key, std::vector<LookaheadPoolManager::NgramView>>
+LookaheadPoolManager::getMap() const
+{
+    std::unordered_map<Key, std::vector<NgramView>> map;
+    for (auto const& [key, list] : mTokenMap)
+    {
+        if (list.size > 0)
+        {
+            map.emplace(key, collect(list, list.size));
+        }
     }
+    return map;
 }
 
 } // namespace tensorrt_llm::layers
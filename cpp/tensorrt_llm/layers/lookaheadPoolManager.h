@@ -16,8 +16,8 @@
 
 #pragma once
 
-#include <list>
 #include <unordered_map>
+#include <vector>
 
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/iTensor.h"
@@ -26,12 +26,16 @@ namespace tensorrt_llm::layers
 {
 
 //! @brief A helper class for managing key-ngram pool.
+//! The n-grams are stored in a flat arena of token ids and linked per key by node indices, so inserting an n-gram
+//! does not allocate once the arena has grown to the working set. The arena is recycled by `setup`.
 class LookaheadPoolManager
 {
 public:
     using TensorPtr = runtime::ITensor::SharedPtr;
     using TensorConstPtr = runtime::ITensor::SharedConstPtr;
     using Key = runtime::TokenIdType;
+    //! @brief view of one n-gram in the arena, valid until the pool is modified
+    using NgramView = runtime::BufferRange<Key const>;
 
     LookaheadPoolManager(runtime::SizeType32 maxG)
         : mGuessSetSizeMax(maxG)
@@ -50,25 +54,52 @@ public:
     //! @brief  get a list of guess tokens
     //! @param lastToken the newest golden token
     //! @param guessSize at most guessSize candidates returned
-    //! @return the list guess tokens, with list size <= guessSize
-    std::list<TensorConstPtr> guess(Key lastToken, runtime::SizeType32 guessSize) const;
+    //! @return views of the guess tokens from the oldest to the newest, with size <= guessSize
+    std::vector<NgramView> guess(Key lastToken, runtime::SizeType32 guessSize) const;
 
     //! @brief update token map with new generated tokens
     //! @param keyTokens the new shifted out tokens from each window, as the key, [window] on cpu
     //! @param ngramTokens the new shifted lookahead window, as the ngrams, [window, ngramLen] on cpu
     void update(TensorConstPtr const& keyTokens, TensorConstPtr const& ngramTokens);
 
-    std::unordered_map<Key, std::list<TensorConstPtr>> const& getMap() const
+    //! @return all n-grams per key, for debugging
+    std::unordered_map<Key, std::vector<NgramView>> getMap() const;
+
+private:
+    //! @brief n-grams of one key as a doubly linked list of arena nodes, oldest first
+    struct NgramList
     {
-        return mTokenMap;
+        runtime::SizeType32 head{-1};
+        runtime::SizeType32 tail{-1};
+        runtime::SizeType32 size{0};
+    };
+
+    void insertOne(Key key, Key const* ngram, runtime::SizeType32 ngramLen);
+
+    runtime::SizeType32 allocateNode();
+    void removeNode(NgramList& list, runtime::SizeType32 node);
+
+    NgramView getNgram(runtime::SizeType32 node) const
+    {
+        return NgramView(mArena.data() + static_cast<std::size_t>(node) * mNgramLen, mNgramLen);
     }
 
-private:
-    void insertOne(Key key, TensorConstPtr const& ngram);
+    std::vector<NgramView> collect(NgramList const& list, runtime::SizeType32 count) const;
 
 private:
     //! @brief the token map with token as key and list of n-gram as value
-    std::unordered_map<Key, std::list<TensorConstPtr>> mTokenMap;
+    std::unordered_map<Key, NgramList> mTokenMap;
+    //! @brief token ids of the n-grams, [numNodes, mNgramLen]
+    std::vector<Key> mArena;
+    //! @brief links of the nodes within their list, -1 at the ends
+    std::vector<runtime::SizeType32> mPrev;
+    std::vector<runtime::SizeType32> mNext;
+    //! @brief nodes released by eviction, reused before new nodes are taken
+    std::vector<runtime::SizeType32> mFreeNodes;
+    //! @brief number of nodes taken from the arena since the last setup
+    runtime::SizeType32 mNumNodes{0};
+    //! @brief length of the n-grams in the pool, set by the first insertion after setup
+    runtime::SizeType32 mNgramLen{0};
     //! @brief guess set size, -1 for infinite size
     runtime::SizeType32 const mGuessSetSizeMax;
     runtime::SizeType32 mGuessSetSize;
@@ -68,11 +68,33 @@ void PenaltyLayer<T>::initialize()
     mRuntimeMaxSeqLen = 0;
     mConfiguredBeamWidth = -1;
 
-    mTemperature.resize(mDecoderDomain.getBatchSize());
-    mRepetitionPenalty.resize(mDecoderDomain.getBatchSize());
-    mPresencePenalty.resize(mDecoderDomain.getBatchSize());
-    mFrequencyPenalty.resize(mDecoderDomain.getBatchSize());
-    mMinLength.resize(mDecoderDomain.getBatchSize());
+    // The device buffers start as copies of the host ones, so the setup of default requests joining slots that hold
+    // the defaults already copies nothing
+    mTemperature.resize(mDecoderDomain.getBatchSize(), DefaultDecodingParams::getTemperature());
+    mRepetitionPenalty.resize(mDecoderDomain.getBatchSize(), DefaultDecodingParams::getRepetitionPenalty());
+    mPresencePenalty.resize(mDecoderDomain.getBatchSize(), DefaultDecodingParams::getPresencePenalty());
+    mFrequencyPenalty.resize(mDecoderDomain.getBatchSize(), DefaultDecodingParams::getFrequencyPenalty());
+    mMinLength.resize(mDecoderDomain.getBatchSize(), DefaultDecodingParams::getMinLength());
+    if (mDecodingMode.isUseTemperature())
+    {
+        cudaAutoCpy(mTemperatureDevice, mTemperature.data(), mTemperature.size(), mStream);
+    }
+    if (mDecodingMode.isUseRepetitionPenalty())
+    {
+        cudaAutoCpy(mRepetitionPenaltyDevice, mRepetitionPenalty.data(), mRepetitionPenalty.size(), mStream);
+    }
+    if (mDecodingMode.isUsePresencePenalty())
+    {
+        cudaAutoCpy(mPresencePenaltyDevice, mPresencePenalty.data(), mPresencePenalty.size(), mStream);
+    }
+    if (mDecodingMode.isUseFrequencyPenalty())
+    {
+        cudaAutoCpy(mFrequencyPenaltyDevice, mFrequencyPenalty.data(), mFrequencyPenalty.size(), mStream);
+    }
+    if (mDecodingMode.isUseMinLength())
+    {
+        cudaAutoCpy(mMinLengthDevice, mMinLength.data(), mMinLength.size(), mStream);
+    }
 
     if (!mDecodingMode.isAuto())
     {
@@ -99,6 +121,14 @@ void PenaltyLayer<T>::allocateWorkspace()
         {
             mPenaltyWorkspacePrevDevice = mAllocator->reMalloc(mPenaltyWorkspacePrevDevice, workspaceSize, false);
         }
+        else
+        {
+            auto const slotsSize = sizeof(SizeType32) * mDecoderDomain.getBatchSize();
+            mPenaltyCountedLengthsDevice = mAllocator->reMalloc(mPenaltyCountedLengthsDevice, slotsSize, false);
+            mSetupBatchSlotsDevice = mAllocator->reMalloc(mSetupBatchSlotsDevice, slotsSize, false);
+            invokeResetPenaltyCountedLengths(
+                mPenaltyCountedLengthsDevice, nullptr, mDecoderDomain.getBatchSize(), mStream);
+        }
     }
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
@@ -156,6 +186,11 @@ void PenaltyLayer<T>::freeBuffer()
     {
         mAllocator->free((void**) &mPenaltyWorkspacePrevDevice);
     }
+    if (mPenaltyCountedLengthsDevice != nullptr)
+    {
+        mAllocator->free((void**) &mPenaltyCountedLengthsDevice);
+        mAllocator->free((void**) &mSetupBatchSlotsDevice);
+    }
     if (mDecodingMode.isUseTemperature())
     {
         mAllocator->free((void**) (&mTemperatureDevice));
@@ -204,7 +239,7 @@ void PenaltyLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, SizeType
     auto batchSlotsHost = batchSlots ? batchSlots : batchSlotsVec.data();
 
     // Setup penalties.
-    FillBuffers const fillBuffers{batchSize, mDecoderDomain.getBatchSize(), mStream};
+    FillBuffers const fillBuffers{batchSize, mDecoderDomain.getBatchSize(), mStream, /* skipUnchanged */ true};
 
     auto const& penaltyParams = setupParams->penaltyParams;
 
@@ -252,6 +287,12 @@ void PenaltyLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, SizeType
         fillBuffers(penaltyParams.minLength, DefaultDecodingParams::getMinLength(), mMinLength, mMinLengthDevice,
             batchSlotsHost, getLimitsPenalty(DecodingPenaltyType::MinLength), "min length");
     }
+    if (mPenaltyCountedLengthsDevice != nullptr)
+    {
+        // Occurrences of new requests are counted from their output ids on their first step
+        cudaAutoCpy(mSetupBatchSlotsDevice, batchSlotsHost, batchSize, mStream);
+        invokeResetPenaltyCountedLengths(mPenaltyCountedLengthsDevice, mSetupBatchSlotsDevice, batchSize, mStream);
+    }
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -353,6 +394,7 @@ void PenaltyLayer<T>::forwardAsync(
     penaltyParams.maxTokensPerStep = mDecoderDomain.getMaxDecodingTokens();
     penaltyParams.tokensPerStep = tokensPerStep;
     penaltyParams.stream = mStream;
+    penaltyParams.penaltyCountedLengths = mPenaltyCountedLengthsDevice;
     invokeBatchApplyPenalty(penaltyParams);
     sync_check_cuda_error();
 
@@ -100,6 +100,10 @@ private:
 
     runtime::TokenIdType* mPenaltyWorkspaceDevice{nullptr};
     runtime::TokenIdType* mPenaltyWorkspacePrevDevice{nullptr};
+    // Without beam search occurrences are counted incrementally per batch slot, see penaltyCountedLengths in
+    // InvokeBatchApplyPenaltyParams
+    runtime::SizeType32* mPenaltyCountedLengthsDevice{nullptr};
+    runtime::SizeType32* mSetupBatchSlotsDevice{nullptr};
     runtime::ITensor::SharedPtr mLogitsPtrsHost;
 };
 
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/layers/promptLookupAlgorithm.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::layers
+{
+
+using namespace tensorrt_llm::runtime;
+
+void PromptLookupAlgorithm::setup(TensorConstPtr const& prompt, SizeType32 draftLen, SizeType32 matchLen)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_CHECK_WITH_INFO(draftLen > 0 && draftLen <= mMaxDraftLen,
+        "prompt lookup requires setup draftLen (%d) in [1, max_draft_len (%d)]", draftLen, mMaxDraftLen);
+    TLLM_CHECK_WITH_INFO(matchLen > 0 && matchLen <= mMaxMatchLen,
+        "prompt lookup requires setup matchLen (%d) in [1, max_match_len (%d)]", matchLen, mMaxMatchLen);
+    mDraftLen = draftLen;
+    mMatchLen = matchLen;
+    mPoolManager.setup(mMaxCandidates);
+    mTokens.clear();
+    mNumIndexed = 0;
+    mDraftTokens = ITensor::slice(mDraftTokensMax, 0, 0);
+    accept(prompt);
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+void PromptLookupAlgorithm::index()
+{
+    auto const ngramLen = mMatchLen - 1 + mDraftLen;
+    auto const numTokens = static_cast<SizeType32>(mTokens.size());
+    while (mNumIndexed + mDraftLen < numTokens)
+    {
+        auto const count = std::min(numTokens - mDraftLen - mNumIndexed, mMaxDraftLen + 1);
+        auto keyTokens = ITensor::slice(mKeyTokensMax, 0, count);
+        auto ngramTokens = ITensor::slice(mNgramTokensMax, 0, count * ngramLen);
+        ngramTokens->reshape(ITensor::makeShape({count, ngramLen}));
+        BufferRange<TokenIdType> keyRange(*keyTokens);
+        BufferRange<TokenIdType> ngramRange(*ngramTokens);
+        for (SizeType32 ci = 0; ci < count; ci++)
+        {
+            auto const pos = mNumIndexed + ci;
+            keyRange[ci] = mTokens[pos];
+            auto* ngram = ngramRange.begin() + ci * ngramLen;
+            // The tokens before the position, -1 before the beginning of the request
+            for (SizeType32 mi = 0; mi < mMatchLen - 1; mi++)
+            {
+                auto const prev = pos - (mMatchLen - 1) + mi;
+                ngram[mi] = prev >= 0 ? mTokens[prev] : -1;
+            }
+            std::copy(mTokens.begin() + pos + 1, mTokens.begin() + pos + 1 + mDraftLen, ngram + mMatchLen - 1);
+        }
+        mPoolManager.update(keyTokens, ngramTokens);
+        mNumIndexed += count;
+    }
+}
+
+void PromptLookupAlgorithm::accept(TensorConstPtr const& generatedTokens)
+{
+    BufferRange<TokenIdType const> generatedRange(*generatedTokens);
+    mTokens.insert(mTokens.end(), generatedRange.begin(), generatedRange.end());
+    index();
+}
+
+void PromptLookupAlgorithm::prepare(TensorPtr const& draftTokens, TensorPtr const& length)
+{
+    TLLM_CHECK(ITensor::volume(draftTokens->getShape()) >= mDraftLen);
+    SizeType32 draftLen = 0;
+    if (!mTokens.empty())
+    {
+        auto const numTokens = static_cast<SizeType32>(mTokens.size());
+        auto const candidates = mPoolManager.guess(mTokens.back(), mMaxCandidates);
+        SizeType32 bestMatchLen = -1;
+        LookaheadPoolManager::NgramView const* best = nullptr;
+        // From the newest to the oldest candidate, an older one has to match more tokens to be chosen
+        for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+        {
+            SizeType32 matchLen = 0;
+            while (matchLen < mMatchLen - 1 && numTokens - 2 - matchLen >= 0
+                && (*it)[mMatchLen - 2 - matchLen] == mTokens[numTokens - 2 - matchLen])
+            {
+                matchLen++;
+            }
+            if (matchLen > bestMatchLen)
+            {
+                bestMatchLen = matchLen;
+                best = &*it;
+            }
+        }
+        if (best != nullptr)
+        {
+            std::copy(best->begin() + mMatchLen - 1, best->end(), BufferRange<TokenIdType>(*mDraftTokensMax).begin());
+            draftLen = mDraftLen;
+        }
+    }
+    mDraftTokens = ITensor::slice(mDraftTokensMax, 0, draftLen);
+    BufferRange<TokenIdType const> draftRange(*mDraftTokens);
+    std::copy(draftRange.begin(), draftRange.end(), BufferRange<TokenIdType>(*draftTokens).begin());
+    BufferRange<SizeType32>(*length)[0] = draftLen;
+}
+
+void PromptLookupAlgorithm::update(TensorPtr const& acceptedTokens, TensorPtr const& acceptedLength,
+    TensorConstPtr const& sampledTokens, TensorConstPtr const& endToken)
+{
+    BufferRange<TokenIdType const> sampledRange(*sampledTokens);
+    BufferRange<TokenIdType const> draftRange(*mDraftTokens);
+    BufferRange<TokenIdType> acceptedRange(*acceptedTokens);
+    auto const end = BufferRange<TokenIdType const>(*endToken)[0];
+    auto const draftLen = static_cast<SizeType32>(draftRange.size());
+    TLLM_CHECK(static_cast<SizeType32>(sampledRange.size()) >= draftLen + 1);
+
+    SizeType32 length = 0;
+    acceptedRange[length++] = sampledRange[0];
+    for (SizeType32 di = 0; di < draftLen && sampledRange[di] != end && draftRange[di] == sampledRange[di]; di++)
+    {
+        acceptedRange[length++] = sampledRange[di + 1];
+    }
+    BufferRange<SizeType32>(*acceptedLength)[0] = length;
+    accept(ITensor::slice(acceptedTokens, 0, length));
+    mDraftTokens = ITensor::slice(mDraftTokensMax, 0, 0);
+}
+
+} // namespace tensorrt_llm::layers
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/layers/lookaheadPoolManager.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <vector>
+
+namespace tensorrt_llm::layers
+{
+
+//! @brief A CPU implementation of prompt lookup decoding with ITensor.
+//! The draft tokens are the tokens following an earlier occurrence of the last tokens of the request in its prompt
+//! and output. Every position of the request is indexed in a LookaheadPoolManager by its token, the n-gram stored
+//! with it is the matchLen - 1 tokens before the position followed by the draftLen tokens after it. The candidate of
+//! the last token matching most of the tokens before it gives the draft, the newest one on ties.
+class PromptLookupAlgorithm
+{
+public:
+    using TensorPtr = runtime::ITensor::SharedPtr;
+    using TensorConstPtr = runtime::ITensor::SharedConstPtr;
+
+    //! @param maxDraftLen, maxMatchLen maximum number of draft tokens and matched tokens of a request.
+    //! @param maxCandidates number of the most recent occurrences kept per token.
+    PromptLookupAlgorithm(
+        runtime::SizeType32 maxDraftLen, runtime::SizeType32 maxMatchLen, runtime::SizeType32 maxCandidates)
+        : mMaxDraftLen(maxDraftLen)
+        , mMaxMatchLen(maxMatchLen)
+        , mPoolManager(maxCandidates)
+        , mMaxCandidates(maxCandidates)
+        , mKeyTokensMax(
+              runtime::BufferManager::cpu(runtime::ITensor::makeShape({maxDraftLen + 1}), nvinfer1::DataType::kINT32))
+        , mNgramTokensMax(runtime::BufferManager::cpu(
+              runtime::ITensor::makeShape({(maxDraftLen + 1) * (maxMatchLen - 1 + maxDraftLen)}),
+              nvinfer1::DataType::kINT32))
+        , mDraftTokensMax(
+              runtime::BufferManager::cpu(runtime::ITensor::makeShape({maxDraftLen}), nvinfer1::DataType::kINT32))
+    {
+    }
+
+    //! @brief setup per request, index the tokens of @param prompt.
+    //! @param draftLen, matchLen the number of draft tokens and the maximum number of matched tokens of the request.
+    void setup(TensorConstPtr const& prompt, runtime::SizeType32 draftLen, runtime::SizeType32 matchLen);
+
+    //! @brief append the new generated tokens of the request and index them.
+    void accept(TensorConstPtr const& generatedTokens);
+
+    //! @brief look up the draft tokens following the last tokens.
+    //! output @param draftTokens, [maxDraftLen] and @param length the number of draft tokens, 0 without a match.
+    void prepare(TensorPtr const& draftTokens, TensorPtr const& length);
+
+    //! @brief verify the prepared draft tokens and accept the longest matching prefix.
+    //! input @param sampledTokens the tokens predicted for the last golden token and the draft tokens.
+    //! input @param endToken is the end token for `verify` early quit.
+    //! output @param acceptedTokens, [maxDraftLen + 1] and @param acceptedLength.
+    void update(TensorPtr const& acceptedTokens, TensorPtr const& acceptedLength, TensorConstPtr const& sampledTokens,
+        TensorConstPtr const& endToken);
+
+private:
+    //! @brief insert the positions of mTokens which are followed by draftLen tokens into the pool.
+    void index();
+
+private:
+    runtime::SizeType32 const mMaxDraftLen{0};
+    runtime::SizeType32 const mMaxMatchLen{0};
+    LookaheadPoolManager mPoolManager;
+    runtime::SizeType32 const mMaxCandidates{0};
+    //! the key tokens and n-grams of one insertion into the pool
+    TensorPtr mKeyTokensMax;   // shape [mMaxDraftLen + 1]
+    TensorPtr mNgramTokensMax; // shape [(mMaxDraftLen + 1) * (mMaxMatchLen - 1 + mMaxDraftLen)]
+    //! the draft tokens of the last `prepare` for `update`
+    TensorPtr mDraftTokensMax; // shape [mMaxDraftLen]
+    TensorPtr mDraftTokens;    // shape [number of draft tokens]
+
+    //! the prompt and all accepted tokens of the request
+    std::vector<runtime::TokenIdType> mTokens;
+    //! number of positions of mTokens inserted into the pool
+    runtime::SizeType32 mNumIndexed{0};
+    runtime::SizeType32 mDraftLen{0};
+    runtime::SizeType32 mMatchLen{0};
+};
+
+} // namespace tensorrt_llm::layers
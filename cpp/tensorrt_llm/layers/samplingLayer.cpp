@@ -19,7 +19,9 @@
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/samplingProbsTruncationKernels.h"
 #include "tensorrt_llm/kernels/samplingTopKKernels.h"
+#include "tensorrt_llm/layers/defaultDecodingParams.h"
 
 #include <algorithm>
 
@@ -68,16 +70,23 @@ void SamplingLayer<T>::allocateBuffer(SizeType32 batchSize)
         mWorkspaceSize = std::max(mWorkspaceSize, layer->getWorkspaceSize());
     }
 
-    std::array<size_t, 4> deviceBufferSizes;
-    deviceBufferSizes[0] = sizeof(curandState_t) * batchSize;
-    deviceBufferSizes[1] = sizeof(uint64_t) * batchSize;
-    deviceBufferSizes[2] = sizeof(bool) * batchSize;
-    deviceBufferSizes[3] = mWorkspaceSize;
-
-    mCurandStatesDevice = mAllocator->reMalloc(mCurandStatesDevice, deviceBufferSizes[0], false);
-    mRandomSeedsDevice = mAllocator->reMalloc(mRandomSeedsDevice, deviceBufferSizes[1], false);
-    mSkipDecodeDevice = mAllocator->reMalloc(mSkipDecodeDevice, deviceBufferSizes[2], false);
-    mSamplingWorkspaceDevice = mAllocator->reMalloc(mSamplingWorkspaceDevice, deviceBufferSizes[3], false);
+    std::array<size_t, 7> deviceBufferSizes;
+    deviceBufferSizes[0] = sizeof(uint64_t) * batchSize;
+    deviceBufferSizes[1] = sizeof(bool) * batchSize;
+    deviceBufferSizes[2] = mWorkspaceSize;
+    deviceBufferSizes[3] = sizeof(float) * batchSize;
+    deviceBufferSizes[4] = sizeof(float) * batchSize;
+    deviceBufferSizes[5] = sizeof(float) * batchSize;
+    // Setup workspace holds either the probs truncation values or the random seeds
+    deviceBufferSizes[6] = std::max(sizeof(float), sizeof(uint64_t)) * batchSize;
+
+    mRandomSeedsDevice = mAllocator->reMalloc(mRandomSeedsDevice, deviceBufferSizes[0], false);
+    mSkipDecodeDevice = mAllocator->reMalloc(mSkipDecodeDevice, deviceBufferSizes[1], false);
+    mSamplingWorkspaceDevice = mAllocator->reMalloc(mSamplingWorkspaceDevice, deviceBufferSizes[2], false);
+    mMinPDevice = mAllocator->reMalloc(mMinPDevice, deviceBufferSizes[3], false);
+    mTypicalPDevice = mAllocator->reMalloc(mTypicalPDevice, deviceBufferSizes[4], false);
+    mEtaCutoffDevice = mAllocator->reMalloc(mEtaCutoffDevice, deviceBufferSizes[5], false);
+    mSetupWorkspaceDevice = mAllocator->reMalloc(mSetupWorkspaceDevice, deviceBufferSizes[6], false);
 
     auto const bytesAllocated = std::accumulate(deviceBufferSizes.begin(), deviceBufferSizes.end(), size_t{0});
     TLLM_LOG_DEBUG("SamplingLayer allocated %d bytes on GPU", bytesAllocated);
@@ -91,6 +100,7 @@ void SamplingLayer<T>::allocateBuffer(SizeType32 batchSize)
     // host buffers.
     mSkipDecodeHost = (bool*) std::realloc(mSkipDecodeHost, sizeof(bool) * batchSize);
     TLLM_CHECK(mSkipDecodeHost != nullptr);
+    mUseProbsTruncation.assign(batchSize, false);
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -100,10 +110,13 @@ void SamplingLayer<T>::freeBuffer()
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
 
-    mAllocator->free((void**) (&mCurandStatesDevice));
     mAllocator->free((void**) (&mRandomSeedsDevice));
     mAllocator->free((void**) (&mSkipDecodeDevice));
     mAllocator->free((void**) (&mSamplingWorkspaceDevice));
+    mAllocator->free((void**) (&mMinPDevice));
+    mAllocator->free((void**) (&mTypicalPDevice));
+    mAllocator->free((void**) (&mEtaCutoffDevice));
+    mAllocator->free((void**) (&mSetupWorkspaceDevice));
     std::free(mSkipDecodeHost);
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
@@ -117,32 +130,20 @@ void SamplingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, SizeTyp
 
     auto setupParams = std::dynamic_pointer_cast<SamplingSetupParams>(baseSetupParams);
 
-    // If runtime argument has single random seed, using this random seed to
-    // initialize the random table of all sentences. If the argument has
-    // [batchSize] random seeds, initializing the random table by different
-    // random seeds respectively. If no random seed, initialize the random table
-    // of all sentences by 0 directly.
-    if (setupParams->randomSeed)
-    {
-        if (setupParams->randomSeed->size() == 1)
-        {
-            invokeCurandInitialize(
-                mCurandStatesDevice, batchSlots, batchSize, setupParams->randomSeed->front(), mStream);
-            sync_check_cuda_error();
-        }
-        else
-        {
-            TLLM_CHECK_WITH_INFO(setupParams->randomSeed->size() == batchSize, "Random seed vector size mismatch.");
-            cudaAutoCpy(mRandomSeedsDevice, setupParams->randomSeed->data(), batchSize, mStream);
-            invokeCurandBatchInitialize(mCurandStatesDevice, batchSlots, batchSize, mRandomSeedsDevice, mStream);
-            sync_check_cuda_error();
-        }
-    }
-    else
+    // Sampling kernels draw their random numbers from the counter-based Philox generator keyed by the seed of the
+    // request and the step, so only the seeds are stored per slot and no generator state has to be initialized.
+    // If runtime argument has single random seed, it is used for all sentences. If no random seed, seed 0 is used.
+    auto randomSeeds = setupParams->randomSeed.value_or(std::vector<uint64_t>{0});
+    TLLM_CHECK_WITH_INFO(randomSeeds.size() == 1 || randomSeeds.size() == static_cast<size_t>(batchSize),
+        "Random seed vector size mismatch.");
+    if (randomSeeds.size() == 1)
     {
-        // Initialize curand states using the default seed 0.
-        invokeCurandInitialize(mCurandStatesDevice, batchSlots, batchSize, 0, mStream);
+        randomSeeds.resize(batchSize, randomSeeds.front());
     }
+    auto* randomSeedsWorkspace = reinterpret_cast<uint64_t*>(mSetupWorkspaceDevice);
+    cudaAutoCpy(randomSeedsWorkspace, randomSeeds.data(), batchSize, mStream);
+    invokeScatterDecodingParams(randomSeedsWorkspace, mRandomSeedsDevice, batchSlots, batchSize, mStream);
+    sync_check_cuda_error();
 
     if (setupParams->outputLogProbs)
     {
@@ -158,6 +159,8 @@ void SamplingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, SizeTyp
             [this](bool cumLogProbs) { return this->mCumLogProbs | cumLogProbs; });
     }
 
+    setupProbsTruncation(batchSize, batchSlots, *setupParams);
+
     for (auto&& layer : mSamplingLayers)
     {
         layer->setup(batchSize, beamWidth, batchSlots, setupParams);
@@ -166,6 +169,56 @@ void SamplingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, SizeTyp
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+template <typename T>
+void SamplingLayer<T>::setupProbsTruncation(
+    SizeType32 batchSize, SizeType32 const* batchSlots, SamplingSetupParams const& params)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        mUseProbsTruncation[batchSlots ? batchSlots[bi] : bi] = false;
+    }
+    setupProbsTruncationValues(batchSize, batchSlots, params.min_p, DefaultDecodingParams::getMinP(), mMinPDevice);
+    setupProbsTruncationValues(
+        batchSize, batchSlots, params.typical_p, DefaultDecodingParams::getTypicalP(), mTypicalPDevice);
+    setupProbsTruncationValues(
+        batchSize, batchSlots, params.eta_cutoff, DefaultDecodingParams::getEtaCutoff(), mEtaCutoffDevice);
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template <typename T>
+void SamplingLayer<T>::setupProbsTruncationValues(SizeType32 batchSize, SizeType32 const* batchSlots,
+    std::optional<std::vector<float>> const& values, float defaultValue, float* valuesDevice)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    // Slots of the batch are always written, so that a request without truncation does not inherit the values of a
+    // previous request in the same slot
+    auto batchValues = values.value_or(std::vector<float>{defaultValue});
+    TLLM_CHECK_WITH_INFO(batchValues.size() == 1 || batchValues.size() == static_cast<size_t>(batchSize),
+        fmtstr("Probs truncation values size (%lu) must be 1 or batchSize (%d)", batchValues.size(), batchSize));
+    if (batchValues.size() == 1)
+    {
+        batchValues.resize(batchSize, batchValues.front());
+    }
+
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        if (batchValues[bi] != defaultValue)
+        {
+            mUseProbsTruncation[batchSlots ? batchSlots[bi] : bi] = true;
+        }
+    }
+
+    cudaAutoCpy(mSetupWorkspaceDevice, batchValues.data(), batchSize, mStream);
+    invokeScatterDecodingParams(mSetupWorkspaceDevice, valuesDevice, batchSlots, batchSize, mStream);
+    sync_check_cuda_error();
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 template <typename T>
 void SamplingLayer<T>::forwardAsync(
     std::shared_ptr<BaseOutputParams> baseOutputs, std::shared_ptr<BaseInputParams> baseInputs)
@@ -189,10 +242,18 @@ void SamplingLayer<T>::forwardAsync(
 
     auto const skipTopP = !mDecodingMode.isTopP();
 
-    // Compute probabilities either for TopP or if cumLogProbs or outputLogProbs are specified
-    bool const skipSoftMax = skipTopP && !mOutputLogProbs && !mCumLogProbs;
+    // Truncate only if a request of this step uses it, the batch slots are in pinned memory
+    bool useProbsTruncation{false};
+    for (SizeType32 bi = 0; bi < static_cast<SizeType32>(batchSize) && !useProbsTruncation; ++bi)
+    {
+        useProbsTruncation = mUseProbsTruncation[batchSlots ? batchSlots[bi] : bi];
+    }
+
+    // Compute probabilities either for TopP or for probs truncation. Log probs of TopK are computed from the logits
+    // by the sampling kernel itself, without materializing the softmax of the whole vocab
+    bool const skipSoftMax = skipTopP && !useProbsTruncation;
 
-    inputs->curand_states = mCurandStatesDevice;
+    inputs->random_seeds = mRandomSeedsDevice;
     inputs->sampling_workspace = mSamplingWorkspaceDevice;
     inputs->probs_computed = !skipSoftMax;
     if (!skipSoftMax)
@@ -203,6 +264,22 @@ void SamplingLayer<T>::forwardAsync(
         sync_check_cuda_error();
     }
 
+    if (useProbsTruncation)
+    {
+        // One launch truncates the probs of all requests, which are then sampled together by topK and topP
+        ProbsTruncationKernelParams<T> params;
+        params.probs = logits;
+        params.minPs = mMinPDevice;
+        params.typicalPs = mTypicalPDevice;
+        params.etaCutoffs = mEtaCutoffDevice;
+        params.batchSlots = batchSlots;
+        params.finishedInput = finishedInput;
+        params.batchSize = batchSize;
+        params.vocabSize = mDecoderDomain.getVocabSize();
+        params.vocabSizePadded = mDecoderDomain.getVocabSizePadded();
+        invokeTruncateProbs(params, mStream);
+    }
+
     for (auto&& layer : mSamplingLayers)
     {
         layer->forwardAsync(baseOutputs, baseInputs);
@@ -35,7 +35,8 @@ namespace layers
 {
 
 //! \brief Top class for sampling layers.
-//! It sets up and executes TopKSamplingLayer and TopPSamplingLayer samplings
+//! It sets up and executes TopKSamplingLayer and TopPSamplingLayer samplings.
+//! Min-p, typical-p and eta truncation of the probabilities are applied to the whole batch before them
 template <typename T>
 class SamplingLayer : public BaseLayer
 {
@@ -52,6 +53,20 @@ public:
 
     void forwardAsync(std::shared_ptr<BaseOutputParams> outputs, std::shared_ptr<BaseInputParams> inputs) override;
 
+    //! \brief Sets up min-p, typical-p and eta truncation of the slots of the batch from params.min_p, typical_p and
+    //! eta_cutoff. setup() resets the slots to no truncation.
+    void setupProbsTruncation(
+        runtime::SizeType32 batchSize, runtime::SizeType32 const* batchSlots, SamplingSetupParams const& params);
+
+    void setStream(cudaStream_t stream) noexcept override
+    {
+        Base::setStream(stream);
+        for (auto& layer : mSamplingLayers)
+        {
+            layer->setStream(stream);
+        }
+    }
+
 private:
     using Base::mWorkspaceSize;
     using Base::mAllocatedSize;
@@ -64,7 +79,6 @@ private:
     executor::DecodingMode mDecodingMode;
 
     void* mSamplingWorkspaceDevice{nullptr};
-    curandState_t* mCurandStatesDevice{nullptr};
     uint64_t* mRandomSeedsDevice{nullptr};
 
     bool* mSkipDecodeDevice{nullptr};
@@ -75,11 +89,20 @@ private:
     bool mOutputLogProbs{false};
     bool mCumLogProbs{false};
 
+    float* mMinPDevice{nullptr};
+    float* mTypicalPDevice{nullptr};
+    float* mEtaCutoffDevice{nullptr};
+    float* mSetupWorkspaceDevice{nullptr};
+    // Whether min-p, typical-p or eta truncation is set for the request in each batch slot
+    std::vector<bool> mUseProbsTruncation;
+
     std::vector<std::unique_ptr<BaseLayer>> mSamplingLayers;
 
 private:
     void allocateBuffer(runtime::SizeType32 batchSize);
     void freeBuffer();
+    void setupProbsTruncationValues(runtime::SizeType32 batchSize, runtime::SizeType32 const* batchSlots,
+        std::optional<std::vector<float>> const& values, float defaultValue, float* valuesDevice);
 };
 
 } // namespace layers
@@ -36,6 +36,9 @@ public:
     std::optional<std::vector<float>> top_p_decay;                    // [batchSize], must between [0, 1]
     std::optional<std::vector<float>> top_p_min;                      // [batchSize], must between [0, 1]
     std::optional<std::vector<runtime::TokenIdType>> top_p_reset_ids; // [batchSize]
+    std::optional<std::vector<float>> min_p;                          // [1] or [batchSize] on cpu
+    std::optional<std::vector<float>> typical_p;                      // [1] or [batchSize] on cpu
+    std::optional<std::vector<float>> eta_cutoff;                     // [1] or [batchSize] on cpu
     std::optional<std::vector<bool>> outputLogProbs;                  // [batchSize]
     std::optional<std::vector<bool>> cumLogProbs;                     // [batchSize]
     std::optional<bool> normalize_log_probs;
@@ -58,7 +61,7 @@ public:
 
     // optional parameters
     std::optional<tc::Tensor> input_lengths; // [localBatchSize]
-    curandState_t* curand_states;            // [localBatchSize]
+    uint64_t const* random_seeds;            // [maxBatchSize], seeds of the counter-based sampling RNG per slot
     // Pointer to the workspace for sampling computation
     void* sampling_workspace;
     // Flag to mark that logits tensor contains probabilities
@@ -19,9 +19,11 @@
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/kernels/stopCriteriaKernels.h"
+#include "tensorrt_llm/kernels/wordListAutomaton.h"
 #include "tensorrt_llm/layers/layerUtils.h"
 
 #include <algorithm>
+#include <numeric>
 
 using namespace tensorrt_llm::common;
 using namespace tensorrt_llm::kernels;
@@ -42,11 +44,46 @@ StopCriteriaLayer<T>::StopCriteriaLayer(executor::DecodingMode const& mode, Deco
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+template <typename T>
+StopCriteriaLayer<T>::~StopCriteriaLayer()
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    freeBuffer();
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template <typename T>
+void StopCriteriaLayer<T>::freeBuffer()
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    if (mStopWordsAutomataDevice != nullptr)
+    {
+        mAllocator->free((void**) (&mStopWordsAutomataDevice));
+        mAllocator->free((void**) (&mSetupBatchSlotsDevice));
+        mStopWordsAutomataMaxWordsLen = 0;
+    }
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 template <typename T>
 void StopCriteriaLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, SizeType32 const* batchSlots,
     std::shared_ptr<BaseSetupParams> setupParams)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    // New requests compile their stop words on their first step
+    if (mStopWordsAutomataDevice != nullptr)
+    {
+        std::vector<SizeType32> batchSlotsVec(batchSize);
+        std::iota(batchSlotsVec.begin(), batchSlotsVec.end(), 0);
+        auto batchSlotsHost = batchSlots ? batchSlots : batchSlotsVec.data();
+        cudaAutoCpy(mSetupBatchSlotsDevice, batchSlotsHost, batchSize, mStream);
+        invokeResetWordListAutomata(
+            mStopWordsAutomataDevice, mStopWordsAutomataMaxWordsLen, mSetupBatchSlotsDevice, batchSize, mStream);
+    }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -91,13 +128,34 @@ void StopCriteriaLayer<T>::checkStopWordsStopCriteria(std::shared_ptr<DynamicDec
         auto numNewTokens = outputs->speculativeDecodingOutputs
             ? outputs->speculativeDecodingOutputs->acceptedLengths.template getPtr<SizeType32>()
             : nullptr;
-        invokeStopWordsCriterion(outputs->output_ids_ptr.template getPtr<TokenIdType const*>(),
-            outputs->parent_ids_ptr.template getPtr<SizeType32 const*>(),
-            inputs->stop_words_ptr->template getPtr<TokenIdType const*>(),
-            reinterpret_cast<FinishedState*>(outputs->finished->template getPtr<FinishedState::UnderlyingType>()),
-            outputs->sequence_length->template getPtr<SizeType32>(), batchSlots,
-            inputs->stop_words_lengths->template getPtr<SizeType32 const>(), numNewTokens, maxStopWordsLength,
-            decoderDomain.getBatchSize(), decoderDomain.getBeamWidth(), maxSeqLen, stream);
+        auto const** stopWordsPtr = inputs->stop_words_ptr->template getPtr<TokenIdType const*>();
+        auto* finished
+            = reinterpret_cast<FinishedState*>(outputs->finished->template getPtr<FinishedState::UnderlyingType>());
+        auto const* stopWordsLens = inputs->stop_words_lengths->template getPtr<SizeType32 const>();
+        if (decoderDomain.getBeamWidth() == 1)
+        {
+            if (maxStopWordsLength > mStopWordsAutomataMaxWordsLen)
+            {
+                // Zeroed automata of all slots are compiled again with the new layout
+                mStopWordsAutomataDevice = mAllocator->reMalloc(mStopWordsAutomataDevice,
+                    sizeof(SizeType32) * mDecoderDomain.getBatchSize() * getWordListAutomatonSize(maxStopWordsLength),
+                    true);
+                mSetupBatchSlotsDevice = mAllocator->reMalloc(
+                    mSetupBatchSlotsDevice, sizeof(SizeType32) * mDecoderDomain.getBatchSize(), false);
+                mStopWordsAutomataMaxWordsLen = maxStopWordsLength;
+            }
+            invokeStopWordsAutomatonCriterion(mStopWordsAutomataDevice, mStopWordsAutomataMaxWordsLen,
+                outputs->output_ids_ptr.template getPtr<TokenIdType const*>(), stopWordsPtr, finished,
+                outputs->sequence_length->template getPtr<SizeType32>(), batchSlots, stopWordsLens, numNewTokens,
+                decoderDomain.getBatchSize(), stream);
+        }
+        else
+        {
+            invokeStopWordsCriterion(outputs->output_ids_ptr.template getPtr<TokenIdType const*>(),
+                outputs->parent_ids_ptr.template getPtr<SizeType32 const*>(), stopWordsPtr, finished,
+                outputs->sequence_length->template getPtr<SizeType32>(), batchSlots, stopWordsLens, numNewTokens,
+                maxStopWordsLength, decoderDomain.getBatchSize(), decoderDomain.getBeamWidth(), maxSeqLen, stream);
+        }
     }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
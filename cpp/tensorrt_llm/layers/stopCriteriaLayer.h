@@ -31,7 +31,8 @@ namespace layers
 {
 
 //! \brief Layer to process stop criteria. Supports:
-//! 1. Stop words criteria
+//! 1. Stop words criteria. Without beam search the stop words of a request are compiled into an automaton on its
+//! first step, see invokeStopWordsAutomatonCriterion.
 //! 2. Maximum length criteria
 template <typename T>
 class StopCriteriaLayer : public BaseLayer
@@ -40,7 +41,7 @@ public:
     StopCriteriaLayer(executor::DecodingMode const& mode, DecoderDomain const& /* decoderDomain */, cudaStream_t stream,
         std::shared_ptr<tensorrt_llm::common::IAllocator> allocator);
 
-    ~StopCriteriaLayer() override = default;
+    ~StopCriteriaLayer() override;
 
     void setup(runtime::SizeType32 batchSize, runtime::SizeType32 beamWidth, runtime::SizeType32 const* batchSlots,
         std::shared_ptr<BaseSetupParams> setupParams) override;
@@ -51,7 +52,8 @@ private:
     static void checkMaxLengthStopCriteria(std::shared_ptr<DynamicDecodeOutputParams>& outputs,
         std::shared_ptr<DynamicDecodeInputParams> const& inputs, runtime::SizeType32 const* batchSlots,
         DecoderDomain const& decoderDomain, runtime::SizeType32 maxSeqLen, cudaStream_t stream);
-    static void checkStopWordsStopCriteria(std::shared_ptr<DynamicDecodeOutputParams>& outputs,
+    void freeBuffer();
+    void checkStopWordsStopCriteria(std::shared_ptr<DynamicDecodeOutputParams>& outputs,
         std::shared_ptr<DynamicDecodeInputParams> const& inputs, runtime::SizeType32 const* batchSlots,
         DecoderDomain const& decoderDomain, runtime::SizeType32 maxSeqLen, cudaStream_t stream);
     static void checkEosToken(std::shared_ptr<DynamicDecodeOutputParams>& outputs,
@@ -68,6 +70,12 @@ private:
     using BaseLayer::mDecoderDomain;
 
     executor::DecodingMode mDecodingMode;
+
+    // Stop words automata, indexed by batch slot, allocated on first use for words lists of at most
+    // mStopWordsAutomataMaxWordsLen tokens
+    runtime::SizeType32* mStopWordsAutomataDevice{nullptr};
+    runtime::SizeType32 mStopWordsAutomataMaxWordsLen{0};
+    runtime::SizeType32* mSetupBatchSlotsDevice{nullptr};
 };
 
 } // namespace layers
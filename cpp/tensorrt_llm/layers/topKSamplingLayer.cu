@@ -37,6 +37,27 @@ namespace tensorrt_llm
 namespace layers
 {
 
+//! \brief Resolves the topK and topP a slot samples with. Shared by the setup kernel and its mirror on the host.
+__host__ __device__ inline void resolveTopKTopP(SizeType32& k, float& p)
+{
+    if (k == 0 && p == 0.0f)
+    {
+        // TensorRT-LLM's topp implementation does not support topp = 0.0f, but it
+        // equivalent to greedy search. So, we set the topk = 1 as an alternative
+        // solution.
+        k = 1;
+    }
+    if (k > 0 && p == 0.0f)
+    {
+        // This case corresponds to the old topk sampling, which is equivalent to
+        // the old topk_topp sampling with topp=1.0f. TopKSamplingLayer and
+        // TopKTopPSamplingLayer are now merged by TopKSamplingLayer. Thus, we
+        // replace the case topk>0 and topp=0.0f by topk>0 and topp=1.0f for the
+        // compatibility.
+        p = 1.0f;
+    }
+}
+
 template <int32_t TOP_K_MAX>
 __global__ void setupTopKRuntimeArgs(SizeType32 batchSize, SizeType32 topK, SizeType32* topKs, SizeType32 topKsSize,
     float topP, float* topPs, SizeType32 topPsSize, bool* skipDecode, SizeType32 const* batchSlots)
@@ -47,22 +68,7 @@ __global__ void setupTopKRuntimeArgs(SizeType32 batchSize, SizeType32 topK, Size
         auto const batchSlot = batchSlots != nullptr ? batchSlots[bi] : bi;
         auto k = topKsSize > 1 ? topKs[batchSlot] : topK;
         auto p = topPsSize > 1 ? topPs[batchSlot] : topP;
-        if (k == 0 && p == 0.0f)
-        {
-            // TensorRT-LLM's topp implementation does not support topp = 0.0f, but it
-            // equivalent to greedy search. So, we set the topk = 1 as an alternative
-            // solution.
-            k = 1;
-        }
-        if (k > 0 && p == 0.0f)
-        {
-            // This case corresponds to the old topk sampling, which is equivalent to
-            // the old topk_topp sampling with topp=1.0f. TopKSamplingLayer and
-            // TopKTopPSamplingLayer are now merged by TopKSamplingLayer. Thus, we
-            // replace the case topk>0 and topp=0.0f by topk>0 and topp=1.0f for the
-            // compatibility.
-            p = 1.0f;
-        }
+        resolveTopKTopP(k, p);
         // Clip k value. A topk sampling kernel supports up to TOP_K_MAX.
         topKs[batchSlot] = k;
         // Clip p value if it is out of range. range = [0.0, 1.0].
@@ -112,6 +118,7 @@ void TopKSamplingLayer<T>::allocateBuffer(SizeType32 const batchSize)
     mSetupWorkspaceDevice = mAllocator->reMalloc(mSetupWorkspaceDevice, deviceBufferSizes[3], false);
 
     mSkipDecodeHost = static_cast<bool*>(std::realloc(mSkipDecodeHost, sizeof(bool) * batchSize));
+    mSlotHoldsDefaults.assign(batchSize, false);
 
     mAllocatedSize = std::accumulate(deviceBufferSizes.begin(), deviceBufferSizes.end(), size_t{0});
     TLLM_LOG_DEBUG("topKSamplingLayer allocated %lu bytes on GPU", mAllocatedSize);
@@ -141,13 +148,33 @@ void TopKSamplingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, Siz
 
     auto setupParams = std::dynamic_pointer_cast<SamplingSetupParams>(baseSetupParams);
 
+    mNormalizeLogProbs = setupParams->normalize_log_probs.has_value() && setupParams->normalize_log_probs.value();
+
+    auto const getBatchSlot = [batchSlots](SizeType32 bi) { return batchSlots != nullptr ? batchSlots[bi] : bi; };
+
+    // Default requests joining slots that hold the defaults already, e.g. freed by other default requests, need neither
+    // copies nor a kernel
+    bool const useDefaults = !setupParams->runtime_top_k.has_value() && !setupParams->runtime_top_p.has_value();
+    if (useDefaults)
+    {
+        bool holdDefaults = true;
+        for (SizeType32 bi = 0; bi < batchSize && holdDefaults; ++bi)
+        {
+            holdDefaults = mSlotHoldsDefaults[getBatchSlot(bi)];
+        }
+        if (holdDefaults)
+        {
+            TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+            return;
+        }
+    }
+
     auto const defaultTopK = DefaultDecodingParams::getTopK();
-    auto runtimeTopK = setupParams->runtime_top_k.value_or(std::vector<SizeType32>(batchSize, defaultTopK));
+    auto runtimeTopK = setupParams->runtime_top_k.value_or(std::vector<SizeType32>{defaultTopK});
     auto runtimeTopP = setupParams->runtime_top_p.value_or(std::vector<float>{});
 
     auto const runtimeTopKSize = runtimeTopK.size();
     auto const runtimeTopPSize = runtimeTopP.size();
-    mNormalizeLogProbs = setupParams->normalize_log_probs.has_value() && setupParams->normalize_log_probs.value();
 
     for (auto& topP : runtimeTopP)
     {
@@ -196,19 +223,21 @@ void TopKSamplingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, Siz
             runtimeTopKSize, topP, mRuntimeTopPDevice, runtimeTopPSize, mSkipDecodeDevice, batchSlots);
     }
 
-    cudaAutoCpy(mSkipDecodeHost, mSkipDecodeDevice, mDecoderDomain.getBatchSize(), mStream);
-    std::vector<SizeType32> runtimeTopKs(mDecoderDomain.getBatchSize());
-    cudaAutoCpy(runtimeTopKs.data(), mRuntimeTopKDevice, mDecoderDomain.getBatchSize(), mStream);
+    // The kernel's results are known on the host, resolved here instead of read back from the device
+    auto defaultK = defaultTopK;
+    auto defaultP = DefaultDecodingParams::getTopP();
+    resolveTopKTopP(defaultK, defaultP);
     {
         runtime::SizeType32 maxTopK = 0;
         for (SizeType32 bi = 0; bi < batchSize; ++bi)
         {
-            auto bid = bi;
-            if (batchSlots)
-            {
-                bid = batchSlots[bi];
-            }
-            maxTopK = std::max(maxTopK, runtimeTopKs[bid]);
+            auto const bid = getBatchSlot(bi);
+            auto k = runtimeTopKSize > 1 ? runtimeTopK[bi] : topK;
+            auto p = runtimeTopPSize > 1 ? runtimeTopP[bi] : topP;
+            resolveTopKTopP(k, p);
+            mSkipDecodeHost[bid] = k == 0;
+            mSlotHoldsDefaults[bid] = k == defaultK && p == defaultP;
+            maxTopK = std::max(maxTopK, k);
         }
         mRuntimeMaxTopK = std::max(mRuntimeMaxTopK, maxTopK);
     }
@@ -230,7 +259,7 @@ void TopKSamplingLayer<T>::forwardAsync(
     auto logits = inputs->logits.template getPtr<T>();
     auto endIds = inputs->end_ids.template getPtr<TokenIdType const>();
     auto batchSlots = inputs->batch_slots ? inputs->batch_slots->template getPtr<SizeType32 const>() : nullptr;
-    auto curandStatesDevice = inputs->curand_states;
+    auto randomSeedsDevice = inputs->random_seeds;
     auto samplingWorkspaceDevice = inputs->sampling_workspace;
     auto const probsComputed = inputs->probs_computed;
 
@@ -244,7 +273,7 @@ void TopKSamplingLayer<T>::forwardAsync(
         return;
     }
 
-    TLLM_CHECK_WITH_INFO(curandStatesDevice, "No curand states provided");
+    TLLM_CHECK_WITH_INFO(randomSeedsDevice, "No random seeds provided");
     TLLM_CHECK_WITH_INFO(samplingWorkspaceDevice, "No sampling workspace provided");
 
     FinishedState* finishedInput = (inputs->finished)
@@ -275,7 +304,19 @@ void TopKSamplingLayer<T>::forwardAsync(
     params.skipDecode = mSkipDecodeDevice;
     params.cumLogProbs = cumLogProbs;
     params.outputLogProbs = outputLogProbs;
-    params.curandState = curandStatesDevice;
+    if (outputs->output_top_log_probs)
+    {
+        TLLM_CHECK_WITH_INFO(outputs->output_top_log_prob_ids, "Top log probs require their ids output tensor");
+        auto const numTopLogProbs = static_cast<SizeType32>(outputs->output_top_log_probs->shape[2]);
+        TLLM_CHECK_WITH_INFO(numTopLogProbs <= TOP_K_MAX, "At most %d top log probs are supported, got %d",
+            TOP_K_MAX, numTopLogProbs);
+        params.outputTopLogProbs = outputs->output_top_log_probs->template getPtr<float>();
+        params.outputTopLogProbIds = outputs->output_top_log_prob_ids->template getPtr<TokenIdType>();
+        params.numTopLogProbs = numTopLogProbs;
+        // The alternatives are selected with the sampling candidates
+        params.maxTopK = std::max(params.maxTopK, numTopLogProbs);
+    }
+    params.randomSeeds = randomSeedsDevice;
     params.batchSize = batchSize;
     params.maxBatchSize = mDecoderDomain.getBatchSize();
     params.maxTokensPerStep = 1;
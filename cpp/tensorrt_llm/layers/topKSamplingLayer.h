@@ -24,6 +24,8 @@
 #include "tensorrt_llm/layers/samplingParams.h"
 #include "tensorrt_llm/runtime/common.h"
 
+#include <vector>
+
 namespace tensorrt_llm
 {
 namespace layers
@@ -59,6 +61,9 @@ protected:
     void* mSetupWorkspaceDevice{nullptr};
     bool* mSkipDecodeDevice{nullptr};
     bool* mSkipDecodeHost{nullptr};
+    //! Slots whose topK, topP and skip flag hold what the default params resolve to, so the setup of a default request
+    //! joining one of them is a no-op
+    std::vector<bool> mSlotHoldsDefaults;
 
     using Base::mDecoderDomain;
     using Base::mWorkspaceSize;
@@ -125,6 +125,7 @@ void TopPSamplingLayer<T>::allocateBuffer(SizeType32 batchSize)
 
     mSkipDecodeHost = static_cast<bool*>(std::realloc(mSkipDecodeHost, sizeof(bool) * batchSize));
     std::fill(mSkipDecodeHost, mSkipDecodeHost + batchSize, true);
+    cudaAutoCpy(mSkipDecodeDevice, mSkipDecodeHost, batchSize, mStream);
 
     mAllocatedSize = std::accumulate(deviceBufferSizes.begin(), deviceBufferSizes.end(), 0);
     TLLM_LOG_DEBUG("topPSamplingLayer allocated %lu bytes on GPU", mAllocatedSize);
@@ -177,6 +178,8 @@ void TopPSamplingLayer<T>::setup(SizeType32 const batchSize, SizeType32 const be
 
     if (runtimeTopPSize == 0)
     {
+        // The host flags mirror the device ones, which are only copied if a slot of the batch wasn't skipped yet
+        bool skipChanged = false;
         for (SizeType32 bi = 0; bi < batchSize; ++bi)
         {
             auto bid = bi;
@@ -184,9 +187,14 @@ void TopPSamplingLayer<T>::setup(SizeType32 const batchSize, SizeType32 const be
             {
                 bid = batchSlots[bi];
             }
+            skipChanged |= !mSkipDecodeHost[bid];
             mSkipDecodeHost[bid] = true;
         }
-        cudaAutoCpy(mSkipDecodeDevice, mSkipDecodeHost, mDecoderDomain.getBatchSize(), mStream);
+        if (skipChanged)
+        {
+            cudaAutoCpy(mSkipDecodeDevice, mSkipDecodeHost, mDecoderDomain.getBatchSize(), mStream);
+        }
+        TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
         return;
     }
 
@@ -319,10 +327,10 @@ void TopPSamplingLayer<T>::forwardAsync(
     auto probs = inputs->logits.template getPtr<T>();
     auto endIds = inputs->end_ids.template getPtr<TokenIdType const>();
     auto batchSlots = inputs->batch_slots ? inputs->batch_slots->template getPtr<SizeType32 const>() : nullptr;
-    auto curandStatesDevice = inputs->curand_states;
+    auto randomSeedsDevice = inputs->random_seeds;
     auto samplingWorkspaceDevice = inputs->sampling_workspace;
 
-    TLLM_CHECK_WITH_INFO(curandStatesDevice, "No curand states provided");
+    TLLM_CHECK_WITH_INFO(randomSeedsDevice, "No random seeds provided");
     TLLM_CHECK_WITH_INFO(samplingWorkspaceDevice, "No sampling workspace provided");
 
     FinishedState* finishedInput = (inputs->finished)
@@ -350,7 +358,7 @@ void TopPSamplingLayer<T>::forwardAsync(
     params.skipDecode = mSkipDecodeDevice;
     params.cumLogProbs = cumLogProbs;
     params.outputLogProbs = outputLogProbs;
-    params.curandState = curandStatesDevice;
+    params.randomSeeds = randomSeedsDevice;
     params.batchSize = batchSize;
     params.maxBatchSize = mDecoderDomain.getBatchSize();
     params.vocabSizePadded = mDecoderDomain.getVocabSizePadded();
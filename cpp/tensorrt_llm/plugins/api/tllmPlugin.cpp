@@ -33,6 +33,7 @@
 #if ENABLE_MULTI_DEVICE
 #include "tensorrt_llm/plugins/ncclPlugin/allgatherPlugin.h"
 #include "tensorrt_llm/plugins/ncclPlugin/allreducePlugin.h"
+#include "tensorrt_llm/plugins/ncclPlugin/gemmAllReducePlugin.h"
 #include "tensorrt_llm/plugins/ncclPlugin/recvPlugin.h"
 #include "tensorrt_llm/plugins/ncclPlugin/reduceScatterPlugin.h"
 #include "tensorrt_llm/plugins/ncclPlugin/sendPlugin.h"
@@ -182,6 +183,7 @@ extern "C"
         static tensorrt_llm::plugins::AllreducePluginCreator allreducePluginCreator;
         static tensorrt_llm::plugins::AllgatherPluginCreator allgatherPluginCreator;
         static tensorrt_llm::plugins::ReduceScatterPluginCreator reduceScatterPluginCreator;
+        static tensorrt_llm::plugins::GemmAllReducePluginCreator gemmAllReducePluginCreator;
 #endif // ENABLE_MULTI_DEVICE
         static tensorrt_llm::plugins::SmoothQuantGemmPluginCreator smoothQuantGemmPluginCreator;
         static tensorrt_llm::plugins::LayernormQuantizationPluginCreator layernormQuantizationPluginCreator;
@@ -211,6 +213,7 @@ extern "C"
                   creatorPtr(allreducePluginCreator),
                   creatorPtr(allgatherPluginCreator),
                   creatorPtr(reduceScatterPluginCreator),
+                  creatorPtr(gemmAllReducePluginCreator),
 #endif // ENABLE_MULTI_DEVICE
                   creatorPtr(smoothQuantGemmPluginCreator),
                   creatorPtr(layernormQuantizationPluginCreator),
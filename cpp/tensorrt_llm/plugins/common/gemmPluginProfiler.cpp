@@ -17,14 +17,146 @@
 
 #include "tensorrt_llm/plugins/common/gemmPluginProfiler.h"
 #include "tensorrt_llm/common/cublasMMWrapper.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/warmStartCache.h"
 #include "tensorrt_llm/kernels/cutlass_kernels/fpA_intB_gemm/fpA_intB_gemm.h"
 #include "tensorrt_llm/kernels/cutlass_kernels/fused_gated_gemm/fused_gated_gemm.h"
 #include "tensorrt_llm/kernels/cutlass_kernels/int8_gemm/int8_gemm.h"
 #include "tensorrt_llm/plugins/mixtureOfExperts/mixtureOfExpertsPlugin.h"
 
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
 namespace tensorrt_llm::plugins
 {
 
+namespace
+{
+// Tactics depend on the GPU, the profiler and the GEMM shape, the key is hashed since GEMM ids print as free text
+template <typename Config, typename GemmIdType>
+common::WarmStartCache::KeyType getWarmStartKey(GemmIdType const& gemmId, nvinfer1::DataType type)
+{
+    std::ostringstream id;
+    id << typeid(Config).name() << ' ' << gemmId << ' ' << static_cast<int>(type);
+    auto const idStr = id.str();
+    return "gemm_tactics_sm" + std::to_string(common::getSMVersion()) + "_"
+        + std::to_string(common::WarmStartCache::hash(idStr.data(), idStr.size()));
+}
+
+// Runtime tactics of all the profilers of the process, by warm-start key
+template <typename Config>
+struct RuntimeProfiles
+{
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<std::unordered_map<int, std::optional<Config>>>> profileMaps;
+};
+
+template <typename Config>
+RuntimeProfiles<Config>& getRuntimeProfiles()
+{
+    static RuntimeProfiles<Config> runtimeProfiles;
+    return runtimeProfiles;
+}
+
+// Tactics deserialized from engines by all the profilers of the process, by profiler type and GEMM ID
+template <typename Config>
+struct DeserializedProfiles
+{
+    std::mutex mutex;
+    std::unordered_map<std::string, std::unordered_map<int, std::optional<Config>>> profileMaps;
+};
+
+template <typename Config>
+DeserializedProfiles<Config>& getDeserializedProfiles()
+{
+    static DeserializedProfiles<Config> deserializedProfiles;
+    return deserializedProfiles;
+}
+
+template <typename GemmIdType>
+std::string getDeserializedProfilesKey(std::type_info const& profilerType, GemmIdType const& gemmId)
+{
+    std::ostringstream key;
+    key << profilerType.name() << ' ' << gemmId;
+    return key.str();
+}
+
+// Tactics profiled at engine build, shared across engines, so the entries are all under the default engine hash
+common::WarmStartCache const& getProfileCache()
+{
+    static common::WarmStartCache const profileCache{[]() -> std::optional<std::filesystem::path>
+        {
+            auto const cacheDir = common::getEnvGemmProfileCacheDir();
+            if (!cacheDir)
+            {
+                return std::nullopt;
+            }
+            return std::filesystem::path{*cacheDir};
+        }()};
+    return profileCache;
+}
+
+// Tactics depend on the GPU model and the driver besides the profiler and the GEMM, the M is added per entry
+template <typename Config, typename GemmIdType>
+std::string getProfileCacheId(std::type_info const& profilerType, std::string const& tacticsId,
+    GemmIdType const& gemmId, nvinfer1::DataType type)
+{
+    int driverVersion{0};
+    common::check_cuda_error(cudaDriverGetVersion(&driverVersion));
+    std::ostringstream id;
+    id << typeid(Config).name() << ' ' << profilerType.name() << ' ' << tacticsId << ' ' << gemmId << ' '
+       << static_cast<int>(type);
+    auto const idStr = id.str();
+    return "gemm_profile_sm" + std::to_string(common::getSMVersion()) + "_"
+        + std::to_string(common::getMultiProcessorCount()) + "sms_driver" + std::to_string(driverVersion) + "_"
+        + std::to_string(common::WarmStartCache::hash(idStr.data(), idStr.size()));
+}
+
+std::string getProfileCacheKey(std::string const& profileCacheId, int m)
+{
+    return profileCacheId + "_m" + std::to_string(m);
+}
+
+// The current GPU first, then the other visible GPUs of the same model up to TRTLLM_GEMM_PROFILE_NUM_DEVICES
+std::vector<int> getProfileDevices()
+{
+    auto const maxNumDevices = static_cast<std::size_t>(common::getEnvGemmProfileNumDevices());
+    auto const currentDevice = common::getDevice();
+    std::vector<int> devices{currentDevice};
+    if (maxNumDevices == 1)
+    {
+        return devices;
+    }
+    cudaDeviceProp currentProp;
+    common::check_cuda_error(cudaGetDeviceProperties(&currentProp, currentDevice));
+    int numDevices{0};
+    common::check_cuda_error(cudaGetDeviceCount(&numDevices));
+    for (int device = 0; device < numDevices && (maxNumDevices == 0 || devices.size() < maxNumDevices); ++device)
+    {
+        if (device == currentDevice)
+        {
+            continue;
+        }
+        cudaDeviceProp prop;
+        common::check_cuda_error(cudaGetDeviceProperties(&prop, device));
+        if (prop.major == currentProp.major && prop.minor == currentProp.minor
+            && prop.multiProcessorCount == currentProp.multiProcessorCount)
+        {
+            devices.push_back(device);
+        }
+    }
+    return devices;
+}
+} // namespace
+
 template <typename Config, typename RunnerPtr, typename GemmIdType, typename GemmIdHashType>
 GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::GemmPluginProfiler()
 {
@@ -82,6 +214,21 @@ void GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::deserial
         read(data, config);
         profileMap->insert(config);
     }
+
+    auto& deserializedProfiles = getDeserializedProfiles<Config>();
+    std::lock_guard<std::mutex> deserializedLock(deserializedProfiles.mutex);
+    deserializedProfiles.profileMaps[getDeserializedProfilesKey(typeid(*this), gemmId)] = *profileMap;
+}
+
+template <typename Config, typename RunnerPtr, typename GemmIdType, typename GemmIdHashType>
+typename GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::MProfileMap
+GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::getDeserializedTactics(
+    std::type_info const& profilerType, GemmIdType const& gemmId)
+{
+    auto& deserializedProfiles = getDeserializedProfiles<Config>();
+    std::lock_guard<std::mutex> lock(deserializedProfiles.mutex);
+    auto const iter = deserializedProfiles.profileMaps.find(getDeserializedProfilesKey(profilerType, gemmId));
+    return iter != deserializedProfiles.profileMaps.end() ? iter->second : MProfileMap{};
 }
 
 template <typename Config, typename RunnerPtr, typename GemmIdType, typename GemmIdHashType>
@@ -136,41 +283,141 @@ void GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::profileT
     }
 
     auto mProfileMap = mMNKProfileMap->getMProfileMap(gemmId);
-    bool isAllocated{false};
 
-    auto profileTactics = [&mProfileMap, &isAllocated, this](int m, int n, int k)
+    // Tactics profiled by a previous run with the same engine are reused
+    using ProfileType = std::pair<int, std::optional<Config>>;
+    auto& warmStartCache = common::WarmStartCache::getInstance();
+    auto const warmStartKey = getWarmStartKey<Config>(gemmId, type);
+    if (auto const cached = warmStartCache.load(warmStartKey))
     {
-        if (mProfileMap->count(m) == 0)
+        char const* data = reinterpret_cast<char const*>(cached->data());
+        int cachedMapSize{0};
+        read(data, cachedMapSize);
+        if (cached->size() == sizeof(int) + cachedMapSize * sizeof(ProfileType))
         {
-            if (!isAllocated)
+            for (int ii = 0; ii < cachedMapSize; ++ii)
             {
-                // Allocate tmp data to run GEMMs
-                allocateTmpData();
-                isAllocated = true;
+                ProfileType config;
+                read(data, config);
+                mProfileMap->insert(config);
             }
-            initTmpData(m, n, k, mWorkspaceTmp, mTmpWorkspaceSizeInBytes, mStream);
-            const auto tactics = this->getTactics(m, n, k);
-            // Profile different tactics for particular m and insert best config to the map
-            mProfileMap->insert({m, this->profileTacticsForProblem(m, n, k, tactics)});
         }
-    };
+    }
+    auto const numCachedProfiles = mProfileMap->size();
 
-    common::check_cuda_error(cudaStreamCreate(&mStream));
+    // Ms of the powers of two from minM up to maxM, tactics of other builds on the same GPU model are reused
+    std::vector<int> ms;
+    for (int m = nextPowerOfTwo(dims.minM); m < maxM; m *= 2)
+    {
+        ms.push_back(m);
+    }
+    ms.push_back(maxM);
+    auto const& profileCache = getProfileCache();
+    auto const profileCacheId = getProfileCacheId<Config>(typeid(*this), getRuntimeTacticsId(), gemmId, type);
+    std::vector<int> msToProfile;
+    for (auto const m : ms)
+    {
+        if (mProfileMap->count(m) != 0)
+        {
+            continue;
+        }
+        if (auto const cached = profileCache.load(getProfileCacheKey(profileCacheId, m));
+            cached && cached->size() == sizeof(std::optional<Config>))
+        {
+            std::optional<Config> config;
+            char const* data = reinterpret_cast<char const*>(cached->data());
+            read(data, config);
+            mProfileMap->insert({m, config});
+            continue;
+        }
+        msToProfile.push_back(m);
+    }
 
-    int const startMinMRounded = nextPowerOfTwo(dims.minM);
-    for (int m = startMinMRounded; m < maxM; m *= 2)
+    if (!msToProfile.empty())
     {
-        profileTactics(m, dims.n, dims.k);
+        auto const configs = profileTacticsForProblems(msToProfile, dims.n, dims.k);
+        for (std::size_t ii = 0; ii < msToProfile.size(); ++ii)
+        {
+            mProfileMap->insert({msToProfile[ii], configs[ii]});
+            std::vector<char> buffer(sizeof(std::optional<Config>));
+            char* data = buffer.data();
+            write(data, configs[ii]);
+            profileCache.store(getProfileCacheKey(profileCacheId, msToProfile[ii]), buffer.data(), buffer.size());
+        }
     }
 
-    profileTactics(maxM, dims.n, dims.k);
+    if (warmStartCache.isEnabled() && mProfileMap->size() > numCachedProfiles)
+    {
+        std::vector<char> buffer(sizeof(int) + mProfileMap->size() * sizeof(ProfileType));
+        char* data = buffer.data();
+        write(data, static_cast<int>(mProfileMap->size()));
+        for (auto const& pair : *mProfileMap)
+        {
+            write(data, pair);
+        }
+        warmStartCache.store(warmStartKey, buffer.data(), buffer.size());
+    }
+}
 
-    if (isAllocated)
+template <typename Config, typename RunnerPtr, typename GemmIdType, typename GemmIdHashType>
+std::vector<std::optional<Config>>
+GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::profileTacticsForProblems(
+    std::vector<int> const& ms, int n, int k)
+{
+    std::vector<std::optional<Config>> configs(ms.size());
+    auto const devices = supportsMultiDeviceProfiling() && ms.size() > 1 ? getProfileDevices() : std::vector<int>{};
+    if (devices.size() <= 1)
     {
-        // Free tmp data
+        allocateTmpData();
+        common::check_cuda_error(cudaStreamCreate(&mStream));
+        for (std::size_t ii = 0; ii < ms.size(); ++ii)
+        {
+            initTmpData(ms[ii], n, k, mWorkspaceTmp, mTmpWorkspaceSizeInBytes, mStream);
+            auto const tactics = this->getTactics(ms[ii], n, k);
+            // Profile different tactics for particular m
+            configs[ii] = profileTacticsForProblem(ms[ii], n, k, tactics, mWorkspaceTmp, mStream);
+        }
+        common::check_cuda_error(cudaStreamDestroy(mStream));
         freeTmpData();
+        return configs;
     }
-    common::check_cuda_error(cudaStreamDestroy(mStream));
+
+    TLLM_LOG_DEBUG("Profiling GEMM tactics of %zu Ms for n=%d, k=%d on %zu GPUs", ms.size(), n, k, devices.size());
+    // The GPUs take the Ms from a shared counter, the largest first since they take the longest to profile
+    std::vector<std::size_t> order(ms.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&ms](auto lhs, auto rhs) { return ms[lhs] > ms[rhs]; });
+    std::atomic<std::size_t> next{0};
+    auto profileOnDevice = [&, this](int device)
+    {
+        common::check_cuda_error(cudaSetDevice(device));
+        char* workspace{nullptr};
+        cudaStream_t stream;
+        TLLM_CHECK_WITH_INFO(cudaMalloc(&workspace, mTmpWorkspaceSizeInBytes) == cudaSuccess,
+            "Can't allocate tmp workspace for GEMM tactics profiling on GPU %d.", device);
+        common::check_cuda_error(cudaStreamCreate(&stream));
+        for (auto idx = next++; idx < order.size(); idx = next++)
+        {
+            auto const ii = order[idx];
+            initTmpData(ms[ii], n, k, workspace, mTmpWorkspaceSizeInBytes, stream);
+            auto const tactics = this->getTactics(ms[ii], n, k);
+            configs[ii] = profileTacticsForProblem(ms[ii], n, k, tactics, workspace, stream);
+        }
+        common::check_cuda_error(cudaStreamDestroy(stream));
+        common::check_cuda_error(cudaFree(workspace));
+    };
+    std::vector<std::future<void>> profiles;
+    for (std::size_t ii = 1; ii < devices.size(); ++ii)
+    {
+        profiles.push_back(std::async(std::launch::async, profileOnDevice, devices[ii]));
+    }
+    // The first device is the current one, which the calling thread keeps
+    profileOnDevice(devices.front());
+    for (auto& profile : profiles)
+    {
+        profile.get();
+    }
+    return configs;
 }
 
 template <typename Config, typename RunnerPtr, typename GemmIdType, typename GemmIdHashType>
@@ -189,6 +436,111 @@ std::optional<Config> GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHa
     return mMNKProfileMap->getMProfileMap(gemmId)->at(mRounded);
 }
 
+template <typename Config, typename RunnerPtr, typename GemmIdType, typename GemmIdHashType>
+typename GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::MProfileMapPtr
+GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::getRuntimeProfileMap(GemmIdType const& gemmId)
+{
+    // The caller holds the lock of the runtime profiles
+    auto iter = mRuntimeProfileMaps.find(gemmId);
+    if (iter != mRuntimeProfileMaps.end())
+    {
+        return iter->second.second;
+    }
+
+    // Profilers of different types may share a GEMM ID and config type, the key includes the profiler type
+    std::ostringstream id;
+    id << typeid(*this).name() << ' ' << getRuntimeTacticsId();
+    auto const idStr = id.str();
+    auto const key = getWarmStartKey<Config>(gemmId, mType) + "_runtime_"
+        + std::to_string(common::WarmStartCache::hash(idStr.data(), idStr.size()));
+
+    auto& profileMap = getRuntimeProfiles<Config>().profileMaps[key];
+    if (!profileMap)
+    {
+        profileMap = std::make_shared<MProfileMap>();
+        using ProfileType = std::pair<int, std::optional<Config>>;
+        if (auto const cached = common::WarmStartCache::getInstance().load(key))
+        {
+            char const* data = reinterpret_cast<char const*>(cached->data());
+            int cachedMapSize{0};
+            read(data, cachedMapSize);
+            if (cached->size() == sizeof(int) + cachedMapSize * sizeof(ProfileType))
+            {
+                for (int ii = 0; ii < cachedMapSize; ++ii)
+                {
+                    ProfileType config;
+                    read(data, config);
+                    profileMap->insert(config);
+                }
+            }
+        }
+    }
+    mRuntimeProfileMaps.emplace(gemmId, std::make_pair(key, profileMap));
+    return profileMap;
+}
+
+template <typename Config, typename RunnerPtr, typename GemmIdType, typename GemmIdHashType>
+std::optional<Config> GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::getBestRuntimeConfig(
+    int m, GemmIdType const& gemmId, cudaStream_t stream)
+{
+    // Runtime profiling needs the runner and the workspace size set by profileTactics for a deserialized engine
+    if (!common::getEnvGemmRuntimeAutotune() || mSkip || !mRunner || !mDims.isInitialized()
+        || mTmpWorkspaceSizeInBytes == 0 || m > std::min<int>(mDims.maxM, getMaxProfileM()))
+    {
+        return getBestConfig(m, gemmId);
+    }
+
+    cudaStreamCaptureStatus captureStatus;
+    common::check_cuda_error(cudaStreamIsCapturing(stream, &captureStatus));
+    if (captureStatus != cudaStreamCaptureStatusNone)
+    {
+        return getBestConfig(m, gemmId);
+    }
+
+    int const profileM = getRuntimeProfileM(m);
+    std::optional<Config> bestConfig;
+    {
+        auto& runtimeProfiles = getRuntimeProfiles<Config>();
+        std::lock_guard<std::mutex> lock(runtimeProfiles.mutex);
+
+        auto profileMap = getRuntimeProfileMap(gemmId);
+        auto const iter = profileMap->find(profileM);
+        if (iter != profileMap->end())
+        {
+            bestConfig = iter->second;
+        }
+        else
+        {
+            TLLM_LOG_DEBUG("Profiling GEMM tactics at runtime for m=%d, n=%ld, k=%ld", profileM, mDims.n, mDims.k);
+            allocateTmpData();
+            common::check_cuda_error(cudaStreamCreate(&mStream));
+            initTmpData(profileM, mDims.n, mDims.k, mWorkspaceTmp, mTmpWorkspaceSizeInBytes, mStream);
+            auto const tactics = this->getTactics(profileM, mDims.n, mDims.k);
+            bestConfig = profileTacticsForProblem(profileM, mDims.n, mDims.k, tactics, mWorkspaceTmp, mStream);
+            common::check_cuda_error(cudaStreamDestroy(mStream));
+            freeTmpData();
+            profileMap->insert({profileM, bestConfig});
+
+            auto& warmStartCache = common::WarmStartCache::getInstance();
+            if (warmStartCache.isEnabled())
+            {
+                using ProfileType = std::pair<int, std::optional<Config>>;
+                std::vector<char> buffer(sizeof(int) + profileMap->size() * sizeof(ProfileType));
+                char* data = buffer.data();
+                write(data, static_cast<int>(profileMap->size()));
+                for (auto const& pair : *profileMap)
+                {
+                    write(data, pair);
+                }
+                warmStartCache.store(mRuntimeProfileMaps.at(gemmId).first, buffer.data(), buffer.size());
+            }
+        }
+    }
+
+    // No tactic could run for the bucket, keep the one profiled at engine build
+    return bestConfig ? bestConfig : getBestConfig(m, gemmId);
+}
+
 template <typename Config, typename RunnerPtr, typename GemmIdType, typename GemmIdHashType>
 void GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::allocateTmpData()
 {
@@ -206,7 +558,7 @@ void GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::freeTmpD
 
 template <typename Config, typename RunnerPtr, typename GemmIdType, typename GemmIdHashType>
 std::optional<Config> GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::profileTacticsForProblem(
-    int m, int n, int k, std::vector<Config> const& tactics)
+    int m, int n, int k, std::vector<Config> const& tactics, char* workspace, cudaStream_t stream)
 {
     TLLM_LOG_DEBUG(__PRETTY_FUNCTION__);
 
@@ -226,7 +578,7 @@ std::optional<Config> GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHa
                 continue;
             }
             // Profile particualar tactic for given M, N and K
-            time = profileTacticForProblem(m, n, k, candidateConfig);
+            time = profileTacticForProblem(m, n, k, candidateConfig, workspace, stream);
             foundOne = true;
         }
         catch (std::exception const& e)
@@ -261,17 +613,15 @@ std::optional<Config> GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHa
 
 template <typename Config, typename RunnerPtr, typename GemmIdType, typename GemmIdHashType>
 float GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::profileTacticForProblem(
-    int m, int n, int k, Config const& tactic)
+    int m, int n, int k, Config const& tactic, char* workspace, cudaStream_t stream)
 {
     constexpr int warmup = 5;
     constexpr int runs = 10;
 
-    cudaStream_t stream = mStream;
-
     // Warmup the execution
     for (int i = 0; i < warmup; ++i)
     {
-        runTactic(m, n, k, tactic, mWorkspaceTmp, stream);
+        runTactic(m, n, k, tactic, workspace, stream);
     }
 
     cudaEvent_t start;
@@ -284,7 +634,7 @@ float GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::profile
     // Profile GEMM
     for (int i = 0; i < runs; ++i)
     {
-        runTactic(m, n, k, tactic, mWorkspaceTmp, stream);
+        runTactic(m, n, k, tactic, workspace, stream);
     }
 
     common::check_cuda_error(cudaEventRecord(stop, stream));
@@ -21,6 +21,7 @@
 
 #include <cuda_runtime.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
@@ -28,6 +29,8 @@
 #include <optional>
 #include <shared_mutex>
 #include <sstream>
+#include <string>
+#include <typeinfo>
 #include <unordered_map>
 #include <vector>
 
@@ -242,6 +245,21 @@ public:
 
     std::optional<Config> getBestConfig(int m, GemmIdType const& gemmId) const;
 
+    // Same as getBestConfig, but when TRTLLM_GEMM_RUNTIME_AUTOTUNE is set the tactics of a deserialized engine are
+    // profiled the first time a runtime bucket of M is seen (see getRuntimeProfileM). The results are shared by the
+    // profilers of the same type and GEMM in the process and persisted in the warm-start cache. Falls back to
+    // getBestConfig while stream is captured into a CUDA graph.
+    std::optional<Config> getBestRuntimeConfig(int m, GemmIdType const& gemmId, cudaStream_t stream);
+
+    // Tactics of gemmId read by deserialize from the engines of the process, by profilers of type profilerType, e.g.
+    // to benchmark the tactics serialized into an engine against the others. Empty if no such GEMM was deserialized.
+    static MProfileMap getDeserializedTactics(std::type_info const& profilerType, GemmIdType const& gemmId);
+
+    [[nodiscard]] size_t getTmpWorkspaceSizeInBytes() const
+    {
+        return mTmpWorkspaceSizeInBytes;
+    }
+
     virtual int getMaxProfileM() const;
 
 protected:
@@ -258,14 +276,40 @@ protected:
 
     virtual void initTmpData(int m, int n, int k, char* workspace, size_t size, cudaStream_t stream);
 
+    // Distinguishes GEMMs with the same ID whose tactics differ, e.g. by weight type, in the runtime tactics.
+    virtual std::string getRuntimeTacticsId() const
+    {
+        return {};
+    }
+
+    // Whether runTactic and initTmpData may run concurrently on several GPUs of the same model, each with its own
+    // workspace and stream, see TRTLLM_GEMM_PROFILE_NUM_DEVICES. The runner must not hold per-device state.
+    virtual bool supportsMultiDeviceProfiling() const
+    {
+        return false;
+    }
+
 private:
     void allocateTmpData();
 
     void freeTmpData();
 
-    std::optional<Config> profileTacticsForProblem(int m, int n, int k, std::vector<Config> const& tactics);
+    // Best tactics of the Ms, profiled in parallel on the GPUs of getProfileDevices if the profiler supports it.
+    std::vector<std::optional<Config>> profileTacticsForProblems(std::vector<int> const& ms, int n, int k);
+
+    std::optional<Config> profileTacticsForProblem(
+        int m, int n, int k, std::vector<Config> const& tactics, char* workspace, cudaStream_t stream);
+
+    float profileTacticForProblem(int m, int n, int k, Config const& tactic, char* workspace, cudaStream_t stream);
 
-    float profileTacticForProblem(int m, int n, int k, Config const& tactic);
+    // Runtime buckets of M are 4 per power of two, e.g. 40, 48, 56 and 64 for M in (32, 64].
+    int getRuntimeProfileM(int m) const
+    {
+        int const granularity = std::max(nextPowerOfTwo(m) / 4, 1);
+        return (m + granularity - 1) / granularity * granularity;
+    }
+
+    MProfileMapPtr getRuntimeProfileMap(GemmIdType const& gemmId);
 
     int nextPowerOfTwo(int v) const
     {
@@ -295,6 +339,9 @@ private:
     GemmDims mDims{};
 
     bool mSkip{false};
+
+    // Runtime tactics of the GEMMs of this profiler, shared with the other profilers of the process
+    std::unordered_map<GemmIdType, std::pair<std::string, MProfileMapPtr>, GemmIdHashType> mRuntimeProfileMaps;
 };
 
 template <typename GemmPluginProfilerType>
@@ -17,6 +17,7 @@
 #include "tensorrt_llm/plugins/common/plugin.h"
 
 #include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/runtime/inProcessWorld.h"
 
 #include "checkMacrosPlugin.h"
 #include "cuda.h"
@@ -26,6 +27,7 @@
 #include <cuda_fp8.h>
 #include <functional>
 #include <mutex>
+#include <string>
 
 #ifdef _MSC_VER
 #define FN_NAME __FUNCTION__
@@ -44,7 +46,18 @@ std::unordered_map<nvinfer1::DataType, ncclDataType_t>* getDtypeMap()
 std::map<std::set<int>, ncclComm_t>* getCommMap()
 {
     static std::map<std::set<int>, ncclComm_t> commMap;
-    return &commMap;
+    // The ranks of an in-process world share the process, each has communicators of its own
+    thread_local std::map<std::set<int>, ncclComm_t> rankCommMap;
+    return tensorrt_llm::runtime::InProcessWorld::current() != nullptr ? &rankCommMap : &commMap;
+}
+
+int getCommSessionRank()
+{
+    if (tensorrt_llm::runtime::InProcessWorld::current() != nullptr)
+    {
+        return tensorrt_llm::runtime::InProcessWorld::currentRank();
+    }
+    return COMM_SESSION.getRank();
 }
 
 void initCommMap(std::set<int> const& group)
@@ -55,8 +68,7 @@ void initCommMap(std::set<int> const& group)
     {
         return;
     }
-    auto& comm = COMM_SESSION;
-    auto const myRank = comm.getRank();
+    auto const myRank = getCommSessionRank();
 
     int groupRank = 0;
     for (int it : group)
@@ -69,23 +81,92 @@ void initCommMap(std::set<int> const& group)
     }
 
     ncclUniqueId id;
-    if (myRank == *group.begin())
+    if (auto* world = tensorrt_llm::runtime::InProcessWorld::current())
+    {
+        std::string key{"nccl_group"};
+        for (int rank : group)
+        {
+            key += "_" + std::to_string(rank);
+        }
+        id = world->broadcastValue<ncclUniqueId>(key, group,
+            []()
+            {
+                ncclUniqueId uniqueId;
+                ncclGetUniqueId(&uniqueId);
+                return uniqueId;
+            });
+    }
+    else if (myRank == *group.begin())
     {
         ncclGetUniqueId(&id);
         for (auto it = std::next(std::begin(group), 1); it != group.end(); ++it)
         {
-            comm.sendValue(id, *it, 0);
+            COMM_SESSION.sendValue(id, *it, 0);
         }
     }
     else
     {
-        comm.recvValue(id, *group.begin(), 0);
+        COMM_SESSION.recvValue(id, *group.begin(), 0);
     }
 
     commMap[group] = nullptr;
     NCCLCHECK(ncclCommInitRank(&commMap[group], group.size(), id, groupRank));
 }
 
+namespace
+{
+// Registered ranges of each communicator, by start address
+std::map<ncclComm_t, std::map<void*, std::pair<size_t, void*>>>& getNcclBufferRegistry()
+{
+    static std::map<ncclComm_t, std::map<void*, std::pair<size_t, void*>>> registry;
+    return registry;
+}
+} // namespace
+
+void registerNcclBuffer(ncclComm_t comm, void* ptr, size_t size, cudaStream_t stream)
+{
+#if NCCL_VERSION_CODE >= NCCL_VERSION(2, 19, 0)
+    cudaStreamCaptureStatus captureStatus;
+    TLLM_CUDA_CHECK(cudaStreamIsCapturing(stream, &captureStatus));
+    if (captureStatus != cudaStreamCaptureStatusNone)
+    {
+        return;
+    }
+    auto& buffers = getNcclBufferRegistry()[comm];
+    auto it = buffers.find(ptr);
+    if (it != buffers.end())
+    {
+        if (it->second.first >= size)
+        {
+            return;
+        }
+        // The engine reuses the address for a larger shape, the registration must cover the whole transfer
+        NCCLCHECK(ncclCommDeregister(comm, it->second.second));
+        buffers.erase(it);
+    }
+    void* handle = nullptr;
+    NCCLCHECK(ncclCommRegister(comm, ptr, size, &handle));
+    buffers.emplace(ptr, std::make_pair(size, handle));
+#endif
+}
+
+void deregisterNcclBuffers(ncclComm_t comm)
+{
+#if NCCL_VERSION_CODE >= NCCL_VERSION(2, 19, 0)
+    auto& registry = getNcclBufferRegistry();
+    auto it = registry.find(comm);
+    if (it == registry.end())
+    {
+        return;
+    }
+    for (auto const& [ptr, buffer] : it->second)
+    {
+        NCCLCHECK(ncclCommDeregister(comm, buffer.second));
+    }
+    registry.erase(it);
+#endif
+}
+
 void* tensorrt_llm::plugins::getCommSessionHandle()
 {
 #if ENABLE_MULTI_DEVICE
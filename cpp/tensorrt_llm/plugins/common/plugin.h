@@ -175,6 +175,17 @@ std::map<std::set<int>, ncclComm_t>* getCommMap();
 
 void initCommMap(std::set<int> const& group);
 
+//! The rank of the calling thread in an in-process world, otherwise the rank of the MPI session.
+int getCommSessionRank();
+
+//! Registers [ptr, ptr + size) with comm once, so that NCCL transfers it without staging copies when the transport
+//! supports user buffers. A no-op before NCCL 2.19, if the range is already registered or while stream is captured
+//! into a CUDA graph, where registration isn't allowed.
+void registerNcclBuffer(ncclComm_t comm, void* ptr, size_t size, cudaStream_t stream);
+
+//! Releases the buffers registered with comm, before it is destroyed.
+void deregisterNcclBuffers(ncclComm_t comm);
+
 #endif // ENABLE_MULTI_DEVICE
 
 //! To save GPU memory, all the plugins share the same cublas and cublasLt handle globally.
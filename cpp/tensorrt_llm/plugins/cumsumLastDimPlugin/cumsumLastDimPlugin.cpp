@@ -29,11 +29,8 @@ static char const* CUMSUM_LAST_DIM_PLUGIN_NAME{"CumsumLastDim"};
 PluginFieldCollection CumsumLastDimPluginCreator::mFC{};
 std::vector<nvinfer1::PluginField> CumsumLastDimPluginCreator::mPluginAttributes;
 
-static constexpr SizeType32 LENGTH_LIMIT_FOR_BLOCKSCAN = 4096;
-
-CumsumLastDimPlugin::CumsumLastDimPlugin(SizeType32 inputLength, nvinfer1::DataType type, size_t temp_storage_bytes)
+CumsumLastDimPlugin::CumsumLastDimPlugin(SizeType32 inputLength, nvinfer1::DataType type)
     : mInputLength(inputLength)
-    , mTempStorageBytes(temp_storage_bytes)
     , mType(type)
 {
     TLLM_CHECK_WITH_INFO((getSMVersion() >= 80) || (mType != DataType::kBF16),
@@ -41,10 +38,6 @@ CumsumLastDimPlugin::CumsumLastDimPlugin(SizeType32 inputLength, nvinfer1::DataT
     TLLM_CHECK_WITH_INFO((mType == DataType::kBF16) || (mType == DataType::kFLOAT) || (mType == DataType::kHALF)
             || (mType == DataType::kINT32),
         "Only support int, float, half, and bfloat16.");
-    if (mTempStorageBytes == 0)
-    {
-        mTempStorageBytes = getWorkspaceSizeNeeded(inputLength, type);
-    }
 }
 
 // Parameterized constructor
@@ -52,7 +45,9 @@ CumsumLastDimPlugin::CumsumLastDimPlugin(void const* data, size_t length)
 {
     char const *d = reinterpret_cast<char const*>(data), *a = d;
     read(d, mInputLength);
-    read(d, mTempStorageBytes);
+    // Size of the CUB temp storage of former versions, kept so that their engines still deserialize
+    size_t tempStorageBytes{};
+    read(d, tempStorageBytes);
     read(d, mType);
     TLLM_CHECK(d == a + length);
     TLLM_CHECK_WITH_INFO((getSMVersion() >= 80) || (mType != DataType::kBF16), "Unsupported data type");
@@ -64,7 +59,7 @@ CumsumLastDimPlugin::CumsumLastDimPlugin(void const* data, size_t length)
 // IPluginV2DynamicExt Methods
 nvinfer1::IPluginV2DynamicExt* CumsumLastDimPlugin::clone() const noexcept
 {
-    auto* plugin = new CumsumLastDimPlugin(mInputLength, mType, mTempStorageBytes);
+    auto* plugin = new CumsumLastDimPlugin(mInputLength, mType);
     plugin->setPluginNamespace(mNamespace.c_str());
     return plugin;
 }
@@ -89,38 +84,12 @@ void CumsumLastDimPlugin::configurePlugin(nvinfer1::DynamicPluginTensorDesc cons
 {
 }
 
-size_t CumsumLastDimPlugin::getWorkspaceSizeNeeded(SizeType32 inputLength, nvinfer1::DataType type)
-{
-    size_t tempStorageBytes;
-    if (inputLength < LENGTH_LIMIT_FOR_BLOCKSCAN) // last dim unknown or small, use BlockScan
-    {
-        tempStorageBytes = 0;
-    }
-    else if (type == DataType::kINT32)
-    {
-        tempStorageBytes = invokeComputeCumsumLastDimWorkspaceSize<int>(inputLength);
-    }
-    else if (type == DataType::kHALF)
-    {
-        tempStorageBytes = invokeComputeCumsumLastDimWorkspaceSize<half>(inputLength);
-    }
-    else if (type == DataType::kFLOAT)
-    {
-        tempStorageBytes = invokeComputeCumsumLastDimWorkspaceSize<float>(inputLength);
-    }
-#ifdef ENABLE_BF16
-    else if (type == DataType::kBF16)
-    {
-        tempStorageBytes = invokeComputeCumsumLastDimWorkspaceSize<__nv_bfloat16>(inputLength);
-    }
-#endif
-    return tempStorageBytes;
-}
-
 size_t CumsumLastDimPlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc const* inputs, int nbInputs,
     nvinfer1::PluginTensorDesc const* outputs, int nbOutputs) const noexcept
 {
-    return mTempStorageBytes;
+    // The statuses of the tiles of the single-pass scan, for the largest shape
+    auto const& dims = inputs[getInputTensorIdx()].dims;
+    return getCumsumLastDimWorkspaceSize(dims.d[0], dims.d[1]);
 }
 
 template <typename T>
@@ -134,14 +103,8 @@ int CumsumLastDimPlugin::enqueueImpl(nvinfer1::PluginTensorDesc const* inputDesc
     //     0.  output_tensor [batch_size, inputLength]
     auto const batchSize = inputDesc[getInputTensorIdx()].dims.d[0];
     auto const inputLength = inputDesc[getInputTensorIdx()].dims.d[1];
-    /*
-        Two cases where we should use BlockScan:
-            1. inputLength is small
-            2. batchSize is large (since DeviceScan causes kernel launch per row)
-    */
-    void* wp = inputLength < LENGTH_LIMIT_FOR_BLOCKSCAN || batchSize > 2 ? nullptr : workspace;
-    invokeCumsumLastDim<T>(
-        batchSize, inputLength, inputs[getInputTensorIdx()], outputs[0], wp, mTempStorageBytes, stream);
+    invokeCumsumLastDim<T>(batchSize, inputLength, inputs[getInputTensorIdx()], outputs[0], workspace,
+        getCumsumLastDimWorkspaceSize(batchSize, inputLength), stream);
 
     return 0;
 }
@@ -205,14 +168,15 @@ void CumsumLastDimPlugin::terminate() noexcept {}
 
 size_t CumsumLastDimPlugin::getSerializationSize() const noexcept
 {
-    return sizeof(mInputLength) + sizeof(mTempStorageBytes) + sizeof(mType);
+    return sizeof(mInputLength) + sizeof(size_t) + sizeof(mType);
 }
 
 void CumsumLastDimPlugin::serialize(void* buffer) const noexcept
 {
     char *d = static_cast<char*>(buffer), *a = d;
     write(d, mInputLength);
-    write(d, mTempStorageBytes);
+    // Former size of the CUB temp storage, unused
+    write(d, size_t{0});
     write(d, mType);
     assert(d == a + getSerializationSize());
 }
@@ -22,6 +22,7 @@
 #include "pluginUtils.h"
 #include "tensorrt_llm/kernels/weightOnlyBatchedGemv/fp8Gemm.h"
 #include "tensorrt_llm/runtime/utils/debugUtils.h"
+#include "tensorrt_llm/runtime/pluginTimer.h"
 
 #include <NvInferRuntime.h>
 
@@ -36,6 +37,8 @@ using tensorrt_llm::plugins::CublasLtGemmPluginProfiler;
 using tensorrt_llm::plugins::CublasGemmWrapperPtr;
 using tensorrt_llm::plugins::read;
 using tensorrt_llm::plugins::write;
+using tensorrt_llm::runtime::PluginKind;
+using tensorrt_llm::runtime::PluginTimer;
 
 static char const* GEMM_PLUGIN_VERSION{"1"};
 static char const* GEMM_PLUGIN_NAME{"Gemm"};
@@ -76,6 +79,28 @@ void runGemm(int const M, int const N, int const K, bool const transA, bool cons
     cublasWrapperPtr->destroyDescriptors();
 }
 
+void runGroupedGemm(int const M, int const N, int const K, int const numGroups, bool const transA, bool const transB,
+    int const padLda, int const padLdb, CublasGemmWrapperPtr const& cublasWrapperPtr, void const* act,
+    void const* weights, float const alpha, void* output, void* workspace, cudaStream_t stream)
+{
+    if (M == 0 || N == 0 || K == 0)
+        return;
+
+    cublasWrapperPtr->setStream(stream);
+    cublasWrapperPtr->setWorkspace(workspace);
+
+    cublasOperation_t transa, transb;
+    int m, n, k;
+    int lda, ldb, ldc;
+    getProblemParams(transa, transb, m, n, k, lda, ldb, ldc, transA, transB, M, N, K, padLda, padLdb);
+
+    // The weights and outputs of the groups are stacked, the activation is shared
+    auto const weightStride = static_cast<int64_t>(lda) * (transB ? N : K);
+    auto const outputStride = static_cast<int64_t>(ldc) * M;
+    cublasWrapperPtr->groupedGemm(transa, transb, m, n, k, weights, lda, weightStride, act, ldb, /* strideB */ 0,
+        output, ldc, outputStride, numGroups, alpha, 0.0f);
+}
+
 void CublasLtGemmPluginProfiler::runTactic(
     int m, int n, int k, CublasLtGemmPluginProfiler::Config const& tactic, char* workspace, cudaStream_t const& stream)
 {
@@ -142,7 +167,7 @@ std::vector<CublasLtGemmPluginProfiler::Config> CublasLtGemmPluginProfiler::getT
 }
 
 GemmPlugin::GemmPlugin(int transA, int transB, int padLda, int padLdb, nvinfer1::DataType type, bool useFp8,
-    float alpha, GemmPlugin::PluginProfilerPtr const& pluginProfiler)
+    float alpha, GemmPlugin::PluginProfilerPtr const& pluginProfiler, int numGroups)
     : mTransA(transA)
     , mTransB(transB)
     , mPadLda(padLda)
@@ -150,9 +175,12 @@ GemmPlugin::GemmPlugin(int transA, int transB, int padLda, int padLdb, nvinfer1:
     , mType(type)
     , mUseFp8(useFp8)
     , mAlpha(alpha)
+    , mNumGroups(numGroups)
     , mPluginProfiler(pluginProfiler)
     , mOutputType(type)
 {
+    TLLM_CHECK_WITH_INFO(mNumGroups >= 1, "The number of GEMM groups must be positive, got %d", mNumGroups);
+    TLLM_CHECK_WITH_INFO(mNumGroups == 1 || !mTransA, "Grouped GEMMs don't support a transposed activation");
     init();
 }
 
@@ -170,6 +198,7 @@ GemmPlugin::GemmPlugin(void const* data, size_t length, GemmPlugin::PluginProfil
     read(d, mAlpha);
     read(d, mDims);
     read(d, mOutputType);
+    read(d, mNumGroups);
 
     init();
 
@@ -195,6 +224,21 @@ void GemmPlugin::init()
     mGemmId = GemmIdCublas(mDims.n, mDims.k, mType, mTransA, mTransB, mOutputType);
 }
 
+nvinfer1::Dims GemmPlugin::getGroupWeightDims(nvinfer1::Dims const& weightDims) const
+{
+    if (mNumGroups == 1)
+    {
+        return weightDims;
+    }
+    nvinfer1::Dims groupDims;
+    groupDims.nbDims = weightDims.nbDims - 1;
+    for (int i = 1; i < weightDims.nbDims; ++i)
+    {
+        groupDims.d[i - 1] = weightDims.d[i];
+    }
+    return groupDims;
+}
+
 void GemmPlugin::setGemmConfig()
 {
     if (mType == nvinfer1::DataType::kHALF)
@@ -246,8 +290,11 @@ nvinfer1::DimsExprs GemmPlugin::getOutputDimensions(
     {
         TLLM_CHECK(nbInputs == 2);
         TLLM_CHECK(outputIndex == 0);
+        // Grouped GEMMs output [numGroups, ...] for weights [numGroups, ...]
+        int const groupDims = mNumGroups > 1 ? 1 : 0;
         int const nbDimsA = inputs[0].nbDims;
-        int const nbDimsB = inputs[1].nbDims;
+        int const nbDimsB = inputs[1].nbDims - groupDims;
+        DimsExprs const& weight = inputs[1];
         DimsExprs ret;
         ret.nbDims = nbDimsA + nbDimsB - 2;
 
@@ -269,16 +316,25 @@ nvinfer1::DimsExprs GemmPlugin::getOutputDimensions(
         {
             for (int i = 0; i < nbDimsB - 1; ++i)
             {
-                ret.d[nbDimsA - 1 + i] = inputs[1].d[i];
+                ret.d[nbDimsA - 1 + i] = weight.d[groupDims + i];
             }
         }
         else
         {
             for (int i = 1; i < nbDimsB; ++i)
             {
-                ret.d[nbDimsA - 2 + i] = inputs[1].d[i];
+                ret.d[nbDimsA - 2 + i] = weight.d[groupDims + i];
             }
         }
+        if (groupDims != 0)
+        {
+            for (int i = ret.nbDims; i > 0; --i)
+            {
+                ret.d[i] = ret.d[i - 1];
+            }
+            ret.d[0] = weight.d[0];
+            ++ret.nbDims;
+        }
         return ret;
     }
     catch (std::exception const& e)
@@ -320,7 +376,7 @@ void GemmPlugin::configurePlugin(nvinfer1::DynamicPluginTensorDesc const* in, in
 
     auto const minM = utils::computeMDimension(mTransA, in[0].min);
     auto const maxM = utils::computeMDimension(mTransA, in[0].max);
-    auto const N = utils::computeNDimension(mTransB, in[1].max);
+    auto const N = utils::computeNDimension(mTransB, getGroupWeightDims(in[1].max));
     auto const K = static_cast<utils::DimType64>(mTransA ? in[0].max.d[0] : in[0].max.d[nbDimsA - 1]);
 
     if (!mDims.isInitialized())
@@ -342,6 +398,7 @@ size_t GemmPlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc const* inputs, in
 int GemmPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::PluginTensorDesc const* outputDesc,
     void const* const* inputs, void* const* outputs, void* workspace, cudaStream_t stream) noexcept
 {
+    auto const timingScope = PluginTimer::getInstance().scope(PluginKind::kGEMM, stream);
     // inputs
     //     mat1 [M, K] (mTransA = False)
     //     mat2 [K, N] (mTransB = False)
@@ -355,7 +412,7 @@ int GemmPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::P
     int const padN = mTransB ? 0 : mPadLdb;
     int const padK = mTransA ? 0 : mPadLda;
     auto const M = utils::computeMDimension(mTransA, inputDesc[0].dims) - padM;
-    auto const N = utils::computeNDimension(mTransB, inputDesc[1].dims) - padN;
+    auto const N = utils::computeNDimension(mTransB, getGroupWeightDims(inputDesc[1].dims)) - padN;
     int const K = static_cast<utils::DimType64>(
         mTransA ? inputDesc[0].dims.d[0] - padK : inputDesc[0].dims.d[nbDimsA - 1] - padK);
 
@@ -367,8 +424,13 @@ int GemmPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::P
             "Found NaN in " + activationStr);
     }
 
+    if (mNumGroups > 1)
+    {
+        runGroupedGemm(M, N, K, mNumGroups, mTransA, mTransB, mPadLda, mPadLdb, mCublasWrapper, inputs[0], inputs[1],
+            mAlpha, outputs[0], workspace, stream);
+    }
     // TODO: sub tensor matmul is not supported in fp8 gemm cuda kernel
-    if (M <= 4 && mUseFp8 && padM == 0 && padN == 0 && padK == 0)
+    else if (M <= 4 && mUseFp8 && padM == 0 && padN == 0 && padK == 0)
     {
         tensorrt_llm::common::QuantMode quantMode = tensorrt_llm::common::QuantMode::fromQuantAlgo("FP8");
         tensorrt_llm::kernels::fp8_gemm::Params params(reinterpret_cast<void const*>(inputs[0]),
@@ -400,8 +462,9 @@ int GemmPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::P
 
     {
         std::string const outputStr = "GEMM layer's output after GEMM with " + mnkStr;
+        auto const outputRows = M * mNumGroups;
         TLLM_CHECK_DEBUG_WITH_INFO(
-            tensorrt_llm::runtime::utils::tensorHasNan(M, N, mType, outputs[0], stream, outputStr) == false,
+            tensorrt_llm::runtime::utils::tensorHasNan(outputRows, N, mType, outputs[0], stream, outputStr) == false,
             "Found NaN in " + outputStr);
     }
     return 0;
@@ -447,7 +510,7 @@ size_t GemmPlugin::getSerializationSize() const noexcept
 {
     return sizeof(mTransA) + sizeof(mTransB) + sizeof(mPadLda) + sizeof(mPadLdb) + sizeof(mType) + sizeof(mDims)
         + sizeof(mUseFp8) + sizeof(mAlpha) + mPluginProfiler->getSerializationSize(mGemmId)
-        + sizeof(mOutputType); // selected tactics container size
+        + sizeof(mOutputType) + sizeof(mNumGroups); // selected tactics container size
 }
 
 void GemmPlugin::serialize(void* buffer) const noexcept
@@ -462,6 +525,7 @@ void GemmPlugin::serialize(void* buffer) const noexcept
     write(d, mAlpha);
     write(d, mDims);
     write(d, mOutputType);
+    write(d, mNumGroups);
     mPluginProfiler->serialize(d, mGemmId);
 
     assert(d == a + getSerializationSize());
@@ -481,6 +545,7 @@ GemmPluginCreator::GemmPluginCreator()
     mPluginAttributes.emplace_back(PluginField("padLdb", nullptr, PluginFieldType::kINT32, 0));
     mPluginAttributes.emplace_back(PluginField("type_id", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("use_fp8", nullptr, PluginFieldType::kINT32, 0));
+    mPluginAttributes.emplace_back(PluginField("num_groups", nullptr, PluginFieldType::kINT32, 1));
     mFC.nbFields = mPluginAttributes.size();
     mFC.fields = mPluginAttributes.data();
 }
@@ -507,6 +572,7 @@ IPluginV2* GemmPluginCreator::createPlugin(char const* name, PluginFieldCollecti
     nvinfer1::DataType type;
     int useFp8;
     float alpha = 1.f;
+    int numGroups = 1;
     // Read configurations from each fields
     for (int i = 0; i < fc->nbFields; ++i)
     {
@@ -546,6 +612,11 @@ IPluginV2* GemmPluginCreator::createPlugin(char const* name, PluginFieldCollecti
             TLLM_CHECK(fields[i].type == PluginFieldType::kFLOAT32);
             alpha = static_cast<float>(*(static_cast<float const*>(fields[i].data)));
         }
+        else if (!strcmp(attrName, "num_groups"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            numGroups = static_cast<int>(*(static_cast<int const*>(fields[i].data)));
+        }
     }
     try
     {
@@ -553,7 +624,7 @@ IPluginV2* GemmPluginCreator::createPlugin(char const* name, PluginFieldCollecti
         // Create plugin profiler with shared tactics map
         // FIXME enable tactic profiler
         auto pluginProfiler = gemmPluginProfileManager.createGemmPluginProfiler(/* inference */ false, /* skip */ true);
-        auto* obj = new GemmPlugin(transA, transB, padLda, padLdb, type, useFp8, alpha, pluginProfiler);
+        auto* obj = new GemmPlugin(transA, transB, padLda, padLdb, type, useFp8, alpha, pluginProfiler, numGroups);
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
@@ -79,8 +79,10 @@ public:
 
     GemmPlugin() = delete;
 
+    //! \param numGroups GEMMs of the same activation whose weights are stacked on a leading dimension, such as non
+    //! fused Q/K/V or gate/up projections. They run in one launch, the outputs are stacked the same way.
     GemmPlugin(int transA, int transB, int padLda, int padLdb, nvinfer1::DataType type, bool useFp8, float alpha,
-        PluginProfilerPtr const& profiler);
+        PluginProfilerPtr const& profiler, int numGroups = 1);
 
     GemmPlugin(void const* data, size_t length, PluginProfilerPtr const& profiler);
 
@@ -118,6 +120,9 @@ private:
     void configGemm();
     void setGemmConfig();
 
+    //! \brief The dimensions of the weight of a group.
+    [[nodiscard]] nvinfer1::Dims getGroupWeightDims(nvinfer1::Dims const& weightDims) const;
+
 private:
     const std::string mLayerName;
 
@@ -136,6 +141,7 @@ private:
     GemmIdCublas mGemmId{};
     bool mUseFp8{false};
     float mAlpha{1.f};
+    int mNumGroups{1};
 
     PluginProfilerPtr mPluginProfiler;
 };
@@ -17,6 +17,7 @@
 
 #include "gemmSwigluPlugin.h"
 #include "cutlass_extensions/gemm_configs.h"
+#include "tensorrt_llm/runtime/pluginTimer.h"
 
 #include <NvInferRuntimeBase.h>
 #include <numeric>
@@ -29,6 +30,8 @@ using tensorrt_llm::plugins::GemmSwigluPlugin;
 using tensorrt_llm::plugins::GemmSwigluPluginProfiler;
 using tensorrt_llm::plugins::read;
 using tensorrt_llm::plugins::write;
+using tensorrt_llm::runtime::PluginKind;
+using tensorrt_llm::runtime::PluginTimer;
 
 static char const* GEMM_SWIGLU_PLUGIN_VERSION{"1"};
 static char const* GEMM_SWIGLU_PLUGIN_NAME{"GemmSwiglu"};
@@ -247,6 +250,7 @@ size_t GemmSwigluPlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc const* inpu
 int GemmSwigluPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::PluginTensorDesc const* outputDesc,
     void const* const* inputs, void* const* outputs, void* workspace, cudaStream_t stream) noexcept
 {
+    auto const timingScope = PluginTimer::getInstance().scope(PluginKind::kGEMM, stream);
     // inputs
     //     mat1           [M(*), K]
     //     mat2           [K, N]
@@ -53,6 +53,11 @@ protected:
 
     void initTmpData(int m, int n, int k, char* workspace, size_t size, cudaStream_t stream) override;
 
+    bool supportsMultiDeviceProfiling() const override
+    {
+        return true;
+    }
+
 private:
     size_t getBytePerElement(nvinfer1::DataType type);
 
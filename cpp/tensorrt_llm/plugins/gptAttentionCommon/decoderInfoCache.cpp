@@ -0,0 +1,146 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "decoderInfoCache.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/memoryUtils.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::plugins
+{
+
+namespace tk = tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+bool DecoderInfoCache::Key::operator==(Key const& other) const
+{
+    return device == other.device && stream == other.stream && seqQLengths == other.seqQLengths
+        && seqKVLengths == other.seqKVLengths && batchSize == other.batchSize && maxQSeqLength == other.maxQSeqLength
+        && numTokens == other.numTokens && removePadding == other.removePadding
+        && rotaryEmbeddingScale == other.rotaryEmbeddingScale && rotaryEmbeddingBase == other.rotaryEmbeddingBase
+        && rotaryEmbeddingDim == other.rotaryEmbeddingDim && rotaryScalingType == other.rotaryScalingType
+        && rotaryEmbeddingMaxPositions == other.rotaryEmbeddingMaxPositions;
+}
+
+DecoderInfoCache& DecoderInfoCache::getInstance()
+{
+    // Leaked on purpose, the buffers can't be freed once the CUDA context is gone at exit
+    static auto* cache = new DecoderInfoCache();
+    return *cache;
+}
+
+DecoderInfoCache::~DecoderInfoCache() = default;
+
+template <typename T>
+std::optional<DecoderInfoCache::Buffers> DecoderInfoCache::get(
+    tk::BuildDecoderInfoParams<T> const& params, int layerIdx, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(params.paddingOffsets == nullptr && params.attentionMask == nullptr
+            && params.fmhaBmm2Scale == nullptr,
+        "Only the sequence offsets, rotary inv_freq and FMHA tile counter are shared.");
+    if (layerIdx < 0 || layerIdx >= kMaxNumLayers)
+    {
+        return std::nullopt;
+    }
+    // A captured graph would keep the buffers, which later passes free or reallocate.
+    cudaStreamCaptureStatus captureStatus;
+    TLLM_CUDA_CHECK(cudaStreamIsCapturing(stream, &captureStatus));
+    if (captureStatus != cudaStreamCaptureStatusNone)
+    {
+        return std::nullopt;
+    }
+
+    Key const key{tc::getDevice(), stream, params.seqQLengths, params.seqKVLengths, params.batchSize,
+        params.maxQSeqLength, params.numTokens, params.removePadding, params.rotaryEmbeddingScale,
+        params.rotaryEmbeddingBase, params.rotaryEmbeddingDim, params.rotaryScalingType,
+        params.rotaryEmbeddingMaxPositions};
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto entry = std::find_if(mEntries.begin(), mEntries.end(), [&key](Entry const& e) { return e.key == key; });
+    if (entry != mEntries.end() && layerIdx > entry->lastLayerIdx)
+    {
+        entry->lastLayerIdx = layerIdx;
+        entry->lastUse = ++mNumUses;
+        return entry->buffers;
+    }
+
+    // A new pass, build the info
+    std::vector<std::size_t> const sizes{sizeof(int) * (params.batchSize + 1), sizeof(int) * (params.batchSize + 1),
+        sizeof(float) * params.batchSize * params.rotaryEmbeddingDim / 2, sizeof(uint32_t) * kMaxNumLayers};
+    auto const size = tc::calcAlignedSize(sizes);
+    if (entry == mEntries.end())
+    {
+        if (mEntries.size() < kMaxNumEntries)
+        {
+            entry = mEntries.emplace(mEntries.end());
+        }
+        else
+        {
+            entry = std::min_element(mEntries.begin(), mEntries.end(),
+                [](Entry const& lhs, Entry const& rhs) { return lhs.lastUse < rhs.lastUse; });
+        }
+    }
+    if (entry->data != nullptr && (entry->key.stream != stream || entry->key.device != key.device))
+    {
+        // The buffers may still be read by the layers of the evicted pass
+        TLLM_CUDA_CHECK(cudaSetDevice(entry->key.device));
+        TLLM_CUDA_CHECK(cudaFreeAsync(entry->data, entry->key.stream));
+        TLLM_CUDA_CHECK(cudaSetDevice(key.device));
+        entry->data = nullptr;
+        entry->capacity = 0;
+    }
+    if (entry->capacity < size)
+    {
+        if (entry->data != nullptr)
+        {
+            TLLM_CUDA_CHECK(cudaFreeAsync(entry->data, stream));
+        }
+        TLLM_CUDA_CHECK(cudaMallocAsync(&entry->data, size, stream));
+        entry->capacity = size;
+    }
+    entry->key = key;
+    entry->lastLayerIdx = layerIdx;
+    entry->lastUse = ++mNumUses;
+
+    std::vector<void*> pointers;
+    tc::calcAlignedPointers(pointers, entry->data, sizes);
+    entry->buffers = Buffers{static_cast<int*>(pointers[0]), static_cast<int*>(pointers[1]),
+        static_cast<float*>(pointers[2]), static_cast<uint32_t*>(pointers[3])};
+
+    auto buildParams = params;
+    buildParams.seqQOffsets = entry->buffers.seqQOffsets;
+    buildParams.seqKVOffsets = entry->buffers.seqKVOffsets;
+    buildParams.rotaryEmbeddingInvFreq = entry->buffers.rotaryEmbeddingInvFreq;
+    buildParams.fmhaTileCounter = nullptr;
+    tk::invokeBuildDecoderInfo(buildParams, stream);
+    TLLM_CUDA_CHECK(cudaMemsetAsync(entry->buffers.fmhaTileCounter, 0, sizes[3], stream));
+    return entry->buffers;
+}
+
+template std::optional<DecoderInfoCache::Buffers> DecoderInfoCache::get(
+    tk::BuildDecoderInfoParams<float> const&, int, cudaStream_t);
+template std::optional<DecoderInfoCache::Buffers> DecoderInfoCache::get(
+    tk::BuildDecoderInfoParams<half> const&, int, cudaStream_t);
+#ifdef ENABLE_BF16
+template std::optional<DecoderInfoCache::Buffers> DecoderInfoCache::get(
+    tk::BuildDecoderInfoParams<__nv_bfloat16> const&, int, cudaStream_t);
+#endif
+
+} // namespace tensorrt_llm::plugins
@@ -0,0 +1,101 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "tensorrt_llm/kernels/gptKernels.h"
+
+#include <cstdint>
+#include <cuda_runtime.h>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::plugins
+{
+
+//! \brief Sequence offsets, rotary inv_freq and FMHA tile counters built once per forward pass and shared by the
+//! attention layers of the pass.
+//! \details The layers of a pass see the same sequence length buffers on the same stream and are enqueued in
+//! increasing layer order. The first layer builds the info into buffers owned by the cache, the following ones reuse
+//! it without a launch. A layer whose index is not larger than the one of the previous user of the info starts a new
+//! pass and rebuilds it. Every layer gets its own FMHA tile counter, all of them are reset by the build. The buffers
+//! are not in the TensorRT workspace, which is reused by the layers in between.
+class DecoderInfoCache
+{
+public:
+    //! Layers with a larger index don't use the cache.
+    static constexpr int kMaxNumLayers = 1024;
+
+    struct Buffers
+    {
+        int* seqQOffsets;
+        int* seqKVOffsets;
+        float* rotaryEmbeddingInvFreq;
+        uint32_t* fmhaTileCounter;
+    };
+
+    static DecoderInfoCache& getInstance();
+
+    //! \brief Returns the decoder info of params for layerIdx, built by invokeBuildDecoderInfo if the pass is new.
+    //! \details Only the sequence offsets, rotary inv_freq and FMHA tile counter are shared, params must not request
+    //! padding offsets, an attention mask or the FMHA bmm2 scale.
+    //! \returns std::nullopt during CUDA graph capture or for layers beyond kMaxNumLayers, so that the caller builds
+    //! the info itself. Graphs never capture the cache buffers, which are freed and reallocated as passes change.
+    template <typename T>
+    std::optional<Buffers> get(kernels::BuildDecoderInfoParams<T> const& params, int layerIdx, cudaStream_t stream);
+
+private:
+    struct Key
+    {
+        int device;
+        cudaStream_t stream;
+        int const* seqQLengths;
+        int const* seqKVLengths;
+        int batchSize;
+        int maxQSeqLength;
+        int numTokens;
+        bool removePadding;
+        float rotaryEmbeddingScale;
+        float rotaryEmbeddingBase;
+        int rotaryEmbeddingDim;
+        kernels::RotaryScalingType rotaryScalingType;
+        int rotaryEmbeddingMaxPositions;
+
+        bool operator==(Key const& other) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        int lastLayerIdx{-1};
+        void* data{nullptr};
+        std::size_t capacity{0};
+        std::uint64_t lastUse{0};
+        Buffers buffers{};
+    };
+
+    static constexpr std::size_t kMaxNumEntries = 8;
+
+    DecoderInfoCache() = default;
+    ~DecoderInfoCache();
+
+    std::mutex mMutex;
+    std::vector<Entry> mEntries;
+    std::uint64_t mNumUses{0};
+};
+
+} // namespace tensorrt_llm::plugins
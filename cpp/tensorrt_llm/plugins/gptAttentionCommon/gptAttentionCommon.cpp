@@ -15,11 +15,13 @@
  * limitations under the License.
  */
 #include "gptAttentionCommon.h"
+#include "decoderInfoCache.h"
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/envUtils.h"
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention.h"
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQARunner.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/multiBlockHeuristic.h"
 #include "tensorrt_llm/kernels/gptKernels.h"
 #include "tensorrt_llm/kernels/kvCacheUtils.h"
 #include "tensorrt_llm/kernels/unfusedAttentionKernels.h"
@@ -29,6 +31,7 @@
 #include <NvInferRuntimePlugin.h>
 #include <algorithm>
 #include <cstdint>
+#include <optional>
 #include <type_traits>
 
 using namespace nvinfer1;
@@ -37,6 +40,29 @@ namespace tc = tensorrt_llm::common;
 using tensorrt_llm::plugins::GPTAttentionPluginCreatorCommon;
 using tensorrt_llm::plugins::GPTAttentionPluginCommon;
 
+namespace
+{
+// The ragged BMMs of the unfused context attention launch one GEMM per sequence, and per KV head for GQA / MQA. They
+// only pay off when they skip most of the padded work with few launches.
+double constexpr kRaggedBmmMaxWorkRatio = 0.5;
+int constexpr kRaggedBmmMaxGemms = 64;
+
+bool useRaggedBmm(int32_t const* hostContextLengths, int batchSize, int paddedSeqLen, int numGemmsPerSeq)
+{
+    if (hostContextLengths == nullptr || batchSize * numGemmsPerSeq > kRaggedBmmMaxGemms)
+    {
+        return false;
+    }
+    int64_t raggedWork{0};
+    for (int bi = 0; bi < batchSize; ++bi)
+    {
+        raggedWork += static_cast<int64_t>(hostContextLengths[bi]) * hostContextLengths[bi];
+    }
+    auto const paddedWork = static_cast<int64_t>(batchSize) * paddedSeqLen * paddedSeqLen;
+    return static_cast<double>(raggedWork) <= kRaggedBmmMaxWorkRatio * static_cast<double>(paddedWork);
+}
+} // namespace
+
 template <typename T>
 struct SATypeConverter
 {
@@ -104,6 +130,7 @@ struct FusedQKVMaskedAttentionDispatchParams
     int* block_counter;
     float const* kv_scale_orig_quant;
     float const* kv_scale_quant_orig;
+    bool kv_scale_per_head;
     tc::QuantMode kv_cache_quant_mode;
     int multi_processor_count;
     KVCacheBuffer kv_block_array;
@@ -113,6 +140,8 @@ struct FusedQKVMaskedAttentionDispatchParams
     int max_distance = 0;
     bool block_sparse_attention = false;
     BlockSparseParams block_sparse_params;
+    float* kv_importance_scores = nullptr;
+    int const* kv_evicted_tokens = nullptr;
 };
 
 template <typename T, typename KVCacheBuffer>
@@ -161,6 +190,11 @@ bool GPTAttentionPluginCommon::convertMMHAParamsToXQAParams(tensorrt_llm::kernel
     {
         return false;
     }
+    // XQA kernels only read one kv cache scale per tensor.
+    if (generationsParams.kv_scale_per_head)
+    {
+        return false;
+    }
     memset(&xqaParams, 0, sizeof(XQAParams));
     xqaParams.data_type = ConvertMMHAToXQAParamsHelper<T, KVCacheBuffer>::data_type;
 
@@ -286,6 +320,7 @@ void fusedQKV_masked_attention_dispatch(Multihead_attention_params<T_MMHA, CROSS
     {
         params.kv_scale_orig_quant = input_params.kv_scale_orig_quant;
         params.kv_scale_quant_orig = input_params.kv_scale_quant_orig;
+        params.kv_scale_per_head = input_params.kv_scale_per_head;
     }
 
     params.stride = hidden_units + 2 * hidden_units_kv;
@@ -326,6 +361,8 @@ void fusedQKV_masked_attention_dispatch(Multihead_attention_params<T_MMHA, CROSS
     params.max_distance = input_params.max_distance;
     params.block_sparse_attention = input_params.block_sparse_attention;
     params.block_sparse_params = input_params.block_sparse_params;
+    params.kv_importance_scores = input_params.kv_importance_scores;
+    params.kv_evicted_tokens = input_params.kv_evicted_tokens;
 
     // The slope of linear position bias per head, e.g., ALiBi.
     if (input_params.linear_bias_slopes != nullptr)
@@ -445,6 +482,8 @@ GPTAttentionPluginCommon::GPTAttentionPluginCommon(int layer_idx, int num_heads,
     , mIsSpecDecodingEnabled(is_spec_decoding_enabled)
     , mDriver(CUDADriverWrapper::getInstance())
 {
+    TLLM_CHECK_WITH_INFO(!mKVCacheQuantMode.hasInt4KvCache(), "INT4 kv cache is not supported by GPTAttention yet.");
+
     // Pre-check whether FMHA is supported in order to save memory allocation.
     if (mEnableContextFMHA)
     {
@@ -480,7 +519,7 @@ GPTAttentionPluginCommon::GPTAttentionPluginCommon(int layer_idx, int num_heads,
     if (mFP8ContextFMHA)
     {
         TLLM_CHECK_WITH_INFO(mEnableContextFMHA, "FP8 FMHA cannot be enabled because Context FMHA is not supported.");
-        TLLM_CHECK_WITH_INFO(mSM == 90, "FP8 FMHA cannot be enabled on Pre-Hopper Arch.");
+        TLLM_CHECK_WITH_INFO(mSM == 89 || mSM == 90, "FP8 FMHA can only be enabled on Ada and Hopper.");
     }
 
     TLLM_CHECK(isRoPE() == (rotary_embedding_dim != 0));
@@ -614,8 +653,9 @@ size_t GPTAttentionPluginCommon::getWorkspaceSizeForContext(nvinfer1::DataType t
         : 0;
     size_t const padding_offset_size = mEnableContextFMHA ? 0 : sizeof(int) * max_num_tokens;
     size_t const fmha_scheduler_counter = mEnableContextFMHA ? sizeof(uint32_t) : 0;
+    size_t const fmha_bmm2_scale_size = mFP8ContextFMHA && chunked_context_support ? sizeof(float) : 0;
 
-    int const NUM_BUFFERS = 14;
+    int const NUM_BUFFERS = 15;
     size_t workspaces[NUM_BUFFERS];
     workspaces[0] = CUBLAS_WORKSPACE_SIZE;
     workspaces[1] = attention_mask_size;
@@ -631,6 +671,7 @@ size_t GPTAttentionPluginCommon::getWorkspaceSizeForContext(nvinfer1::DataType t
     workspaces[11] = fp8_qkv_buffer_size;
     workspaces[12] = padding_offset_size;
     workspaces[13] = fmha_scheduler_counter;
+    workspaces[14] = fmha_bmm2_scale_size;
     context_workspace_size = tc::calculateTotalWorkspaceSize(workspaces, NUM_BUFFERS);
 
     return context_workspace_size;
@@ -791,6 +832,7 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
         ? 0
         : sizeof(int) * params.batch_size * (isCrossAttention() ? params.cross_qkv_length : params.input_seq_length);
     size_t const fmha_scheduler_counter = mEnableContextFMHA ? sizeof(uint32_t) : 0;
+    size_t const fmha_bmm2_scale_size = mFP8ContextFMHA && chunked_context_support ? sizeof(float) : 0;
 
     bool const is_qk_buf_float_ = true;
 
@@ -816,6 +858,8 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
         : reinterpret_cast<int*>(nextWorkspacePtr(workspace_byte_ptr, offset, padding_offset_size));
     uint32_t* fmha_tile_counter_ptr
         = reinterpret_cast<uint32_t*>(nextWorkspacePtr(workspace_byte_ptr, offset, fmha_scheduler_counter));
+    float* fmha_bmm2_scale_ptr
+        = reinterpret_cast<float*>(nextWorkspacePtr(workspace_byte_ptr, offset, fmha_bmm2_scale_size));
 
     // build attention_mask, cu_seqlens, and padding_offset tensors
     // Note: self attn and cross attn should use different params
@@ -839,6 +883,13 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
     decoder_params.attentionMaskType = mMaskType;
     decoder_params.blockSparseParams = mBlockSparseParams;
     decoder_params.fmhaTileCounter = fmha_tile_counter_ptr;
+    // Paged KV FP8 FMHA reads V from the quantized kv cache, which needs to be dequantized in the output scale.
+    if (fmha_bmm2_scale_ptr != nullptr)
+    {
+        decoder_params.fmhaBmm2Scale = fmha_bmm2_scale_ptr;
+        decoder_params.dequantScaleKv = params.kv_scale_quant_orig;
+        decoder_params.quantScaleO = params.attention_output_orig_quant;
+    }
     // Rotary embedding inv_freq buffer.
     decoder_params.rotaryEmbeddingScale = mRotaryEmbeddingScale;
     decoder_params.rotaryEmbeddingBase = mRotaryEmbeddingBase;
@@ -846,7 +897,24 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
     decoder_params.rotaryScalingType = mRotaryEmbeddingScaleType;
     decoder_params.rotaryEmbeddingInvFreq = rotary_inv_freq_buf;
     decoder_params.rotaryEmbeddingMaxPositions = mRotaryEmbeddingMaxPositions;
-    invokeBuildDecoderInfo(decoder_params, stream);
+    // With context FMHA, the info only depends on the sequence lengths, which are the same for all layers of the pass.
+    std::optional<DecoderInfoCache::Buffers> shared_decoder_info;
+    if (tc::getEnvShareDecoderInfo() && !isCrossAttention() && mEnableContextFMHA && padding_offset == nullptr
+        && fmha_bmm2_scale_ptr == nullptr)
+    {
+        shared_decoder_info = DecoderInfoCache::getInstance().get(decoder_params, mLayerIdx, stream);
+    }
+    if (shared_decoder_info)
+    {
+        cu_q_seqlens = shared_decoder_info->seqQOffsets;
+        cu_kv_seqlens = shared_decoder_info->seqKVOffsets;
+        rotary_inv_freq_buf = shared_decoder_info->rotaryEmbeddingInvFreq;
+        fmha_tile_counter_ptr = shared_decoder_info->fmhaTileCounter + mLayerIdx;
+    }
+    else
+    {
+        invokeBuildDecoderInfo(decoder_params, stream);
+    }
     sync_check_cuda_error();
 
     // In cross attention context phase, the attention mask should be a matrix of all ones.
@@ -905,6 +973,10 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
         TLLM_CHECK_WITH_INFO(
             !(mKVCacheQuantMode.hasFp8KvCache() && !mKVCacheQuantMode.hasFp8Qdq() && enablePagedKVContextFMHA),
             "FP8 Paged Context FMHA only works with fp8 quantization workflow currently.");
+        TLLM_CHECK_WITH_INFO(!(mFP8ContextFMHA && !mKVCacheQuantMode.hasFp8KvCache() && enablePagedKVContextFMHA),
+            "FP8 Paged Context FMHA reads K and V from the kv cache, which needs to be fp8 as well.");
+        TLLM_CHECK_WITH_INFO(!(mFP8ContextFMHA && params.kv_scale_per_head && enablePagedKVContextFMHA),
+            "FP8 Paged Context FMHA doesn't support per kv head kv cache scales.");
         TLLM_CHECK_WITH_INFO(!(params.sink_token_length > 0 && enablePagedKVContextFMHA),
             "Cannot support StreamingLLM now when enabling paged KV context FMHA.");
 
@@ -921,6 +993,8 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
         preprocessingParams.rotary_embedding_inv_freq = rotary_inv_freq_buf;
         preprocessingParams.rotary_coef_cache_buffer = params.rotary_cos_sin;
         preprocessingParams.kvScaleOrigQuant = params.kv_scale_orig_quant;
+        preprocessingParams.kvScaleQuantOrig = params.kv_scale_quant_orig;
+        preprocessingParams.kv_scale_per_head = params.kv_scale_per_head;
         preprocessingParams.spec_decoding_position_offsets = nullptr;
 
         // Scalars
@@ -990,9 +1064,11 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
         mFMHARunner->setup(params.batch_size, params.input_seq_length, params.max_past_kv_len,
             params.max_blocks_per_sequence, mTokensPerBlock, attention_window_size, params.num_tokens, isALiBi(),
             isAliBiWithScale(), mTpSize, mTpRank);
+        // Paged KV FP8 FMHA uses the output scale combined with the kv cache dequantization scale.
+        float const* fmha_bmm2_scale
+            = fmha_bmm2_scale_ptr != nullptr ? fmha_bmm2_scale_ptr : params.attention_output_orig_quant;
         mFMHARunner->run(fmha_input_tensor, hostKvCacheBlockOffsets, reinterpret_cast<KVBlockArray&>(kv_cache_buffer),
-            cu_q_seqlens, cu_kv_seqlens, fmha_tile_counter_ptr, params.attention_output_orig_quant, params.context_buf,
-            stream);
+            cu_q_seqlens, cu_kv_seqlens, fmha_tile_counter_ptr, fmha_bmm2_scale, params.context_buf, stream);
 
         sync_check_cuda_error();
     }
@@ -1039,7 +1115,7 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
             invokeTranspose4dBatchMajor(k_buf_2_, v_buf_2_, kv_cache_buffer, params.batch_size,
                 isCrossAttention() ? params.cross_qkv_length : params.input_seq_length,
                 isCrossAttention() ? params.cross_qkv_length : params.cyclic_attention_window_size, getHeadSize(),
-                mNumKVHeads, cache_type, params.kv_scale_orig_quant,
+                mNumKVHeads, cache_type, params.kv_scale_orig_quant, params.kv_scale_per_head,
                 isCrossAttention() ? params.encoder_input_lengths : params.q_seq_lengths, stream);
         }
         sync_check_cuda_error();
@@ -1050,7 +1126,54 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
         int const max_distance = mMaxDistance;
         cudaDataType_t gemm_out_data_type = is_qk_buf_float_ ? CUDA_R_32F : gemm_data_type;
         void* gemm_out_buf_ = is_qk_buf_float_ ? static_cast<void*>(qk_buf_float_) : static_cast<void*>(qk_buf_);
-        if (mNumKVHeads == 1) // MQA
+        size_t const qk_elem_size = is_qk_buf_float_ ? sizeof(float) : sizeof(T);
+
+        // With padding removed, the BMMs of a batch of mixed lengths only cover the tokens of each sequence instead of
+        // the padded [batch, seq_len, seq_len] (ragged BMMs). The Q heads sharing a KV head are batched in one GEMM
+        // with a zero stride on K/V. Rows and columns of other tokens are zeroed for the softmax, whose results on
+        // them are masked or dropped with the padding. Used only when that saves enough work, see useRaggedBmm.
+        int const ragged_num_gemms_per_seq = mNumKVHeads == mNumHeads ? 1 : mNumKVHeads;
+        bool const ragged_bmm = !isCrossAttention()
+            && useRaggedBmm(
+                params.host_context_lengths, params.batch_size, attention_seq_len_1, ragged_num_gemms_per_seq);
+        int const ragged_heads_per_gemm = mNumHeads / ragged_num_gemms_per_seq;
+        int64_t const ragged_kv_head_stride = mNumKVHeads == mNumHeads ? attention_seq_len_2 * getHeadSize() : 0;
+
+        if (ragged_bmm)
+        {
+            TLLM_CUDA_CHECK(cudaMemsetAsync(gemm_out_buf_, 0,
+                qk_elem_size * params.batch_size * mNumHeads * attention_seq_len_1 * attention_seq_len_2, stream));
+            for (int bi = 0; bi < params.batch_size; ++bi)
+            {
+                int const seq_len = params.host_context_lengths[bi];
+                for (int gi = 0; seq_len > 0 && gi < ragged_num_gemms_per_seq; ++gi)
+                {
+                    // Attn_weight[h, s, s] = Q[h, s, d] * K'[h_kv, d, s] for the heads h of the GEMM
+                    size_t const qhead = static_cast<size_t>(bi) * mNumHeads + gi * ragged_heads_per_gemm;
+                    size_t const kvhead = static_cast<size_t>(bi) * mNumKVHeads + (mNumKVHeads == mNumHeads ? 0 : gi);
+                    T const* qptr = q_buf_2_ + qhead * attention_seq_len_1 * getHeadSize();
+                    T const* kptr = k_buf_2_ + kvhead * attention_seq_len_2 * getHeadSize();
+                    void* qkptr = static_cast<int8_t*>(gemm_out_buf_)
+                        + qk_elem_size * qhead * attention_seq_len_1 * attention_seq_len_2;
+                    mCublasWrapper->stridedBatchedGemm(CUBLAS_OP_T, CUBLAS_OP_N,
+                        seq_len,                                   // n
+                        seq_len,                                   // m
+                        getHeadSize(),                             // k
+                        qk_scale_gemm, kptr, gemm_data_type,
+                        getHeadSize(),                             // k
+                        ragged_kv_head_stride,                     // n * k or 0
+                        qptr, gemm_data_type,
+                        getHeadSize(),                             // k
+                        attention_seq_len_1 * getHeadSize(),       // m * k
+                        0.0f, qkptr, gemm_out_data_type,
+                        attention_seq_len_2,                       // n
+                        attention_seq_len_1 * attention_seq_len_2, // m * n
+                        ragged_heads_per_gemm,                     // heads of the GEMM
+                        CUDA_R_32F);
+                }
+            }
+        }
+        else if (mNumKVHeads == 1) // MQA
         {
             // Attn_weight[b, h*s_q, s_k] = Q[b, h*s_q, d] * K'[b, d, s_k]
             // Attn_weight'[b, s_k, h*s_q] = K[b, s_k, d] * Q'[b, d, h*s_q]
@@ -1189,7 +1312,38 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
             invokeMaskedSoftmax(param, stream);
         }
 
-        if (mNumKVHeads == 1)
+        if (ragged_bmm)
+        {
+            for (int bi = 0; bi < params.batch_size; ++bi)
+            {
+                int const seq_len = params.host_context_lengths[bi];
+                for (int gi = 0; seq_len > 0 && gi < ragged_num_gemms_per_seq; ++gi)
+                {
+                    // O[h, s, d] = Attn_weight[h, s, s] * V[h_kv, s, d] for the heads h of the GEMM
+                    size_t const qhead = static_cast<size_t>(bi) * mNumHeads + gi * ragged_heads_per_gemm;
+                    size_t const kvhead = static_cast<size_t>(bi) * mNumKVHeads + (mNumKVHeads == mNumHeads ? 0 : gi);
+                    T const* qkptr = qk_buf_ + qhead * attention_seq_len_1 * attention_seq_len_2;
+                    T const* vptr = v_buf_2_ + kvhead * attention_seq_len_2 * getHeadSize();
+                    T* qkvptr = qkv_buf_2_ + qhead * attention_seq_len_1 * getHeadSize();
+                    mCublasWrapper->stridedBatchedGemm(CUBLAS_OP_N, CUBLAS_OP_N,
+                        getHeadSize(),                             // n
+                        seq_len,                                   // m
+                        seq_len,                                   // k
+                        vptr,
+                        getHeadSize(),                             // n
+                        ragged_kv_head_stride,                     // n * k or 0
+                        qkptr,
+                        attention_seq_len_2,                       // k
+                        attention_seq_len_1 * attention_seq_len_2, // m * k
+                        qkvptr,
+                        getHeadSize(),                             // n
+                        attention_seq_len_1 * getHeadSize(),       // n * m
+                        ragged_heads_per_gemm                      // heads of the GEMM
+                    );
+                }
+            }
+        }
+        else if (mNumKVHeads == 1)
         {
             // Attn_weight[b, h*s_q, s_k]
             // O[b, h*s_q, d] = Attn_weight[b, h*s_q, s_k] * V[b, s_k, d]
@@ -1342,15 +1496,41 @@ int GPTAttentionPluginCommon::enqueueGeneration(
     debugCheckSemaphores(stream);
 #endif
 
+    int timestep = params.max_past_kv_length;
+    int const max_timesteps = mCrossAttention ? params.cyclic_attention_window_size
+                                              : std::min(timestep, params.cyclic_attention_window_size);
+
+    // Decide per step whether MMHA splits the KV sequence across blocks. The workspace is sized for at least
+    // divUp(multiProcessorCount, numHeads) blocks per sequence. With TRTLLM_ENABLE_MMHA_MULTI_BLOCK_DEBUG the number of
+    // blocks is set by the user.
+    MultiBlockHeuristic::Decision multi_block_decision;
+    if (!tc::getEnvMmhaMultiblockDebug())
+    {
+        multi_block_decision = MultiBlockHeuristic::getInstance().decide(batch_beam, mNumHeads, max_timesteps,
+            mMultiProcessorCount, tc::divUp(mMultiProcessorCount, mNumHeads));
+    }
+
     // Try XQA optimization first.
     {
         // NOTE: input_seq_length = num_medusa_tokens + 1 (new generated one from the original LM head)
         // self attn
+        // The importance scores of a compressed kv cache are only accumulated by MMHA.
         XQAParams xqaParams{};
-        if (tensorrt_llm::kernels::XQADispatchHelper<T, KVCacheBuffer>::CanSupport && mDecoderXQARunner.get() != nullptr
+        bool const use_xqa = tensorrt_llm::kernels::XQADispatchHelper<T, KVCacheBuffer>::CanSupport
+            && mDecoderXQARunner.get() != nullptr && params.kv_importance_scores == nullptr
+            && params.kv_evicted_tokens == nullptr
             && this->template convertMMHAParamsToXQAParams<T, KVCacheBuffer>(
                 xqaParams, params, /*forConfigurePlugin=*/false)
-            && mDecoderXQARunner->template shouldUse<T>(xqaParams, /*forConfigurePlugin=*/false))
+            && mDecoderXQARunner->template shouldUse<T>(xqaParams, /*forConfigurePlugin=*/false);
+        // Without multi-block support XQA launches a single block per KV head and sequence. Prefer MMHA split across
+        // blocks when that leaves most SMs idle, e.g. few requests with a long context.
+        bool const prefer_mmha_multi_block
+            = use_xqa && !mIsSpecDecodingEnabled && !xqaParams.multi_block_mode && multi_block_decision.numSplits > 1;
+        // At small batch the separate QKV preprocessing launch of XQA and the round trip of QKV through global memory
+        // can outweigh its faster attention. MMHA fuses the preprocessing into its prologue.
+        bool const prefer_mmha_fused_prologue
+            = use_xqa && !mIsSpecDecodingEnabled && batch_beam <= tc::getEnvFusedQkvPrologueMaxBatchBeam();
+        if (use_xqa && !prefer_mmha_multi_block && !prefer_mmha_fused_prologue)
         {
             TLLM_LOG_DEBUG("XQA kernels are selected in the generation phase.");
             mDecoderXQARunner->template dispatch<KVCacheBuffer>(xqaParams, kv_cache_buffer, stream);
@@ -1362,9 +1542,6 @@ int GPTAttentionPluginCommon::enqueueGeneration(
         }
     }
 
-    int timestep = params.max_past_kv_length;
-    int const max_timesteps = mCrossAttention ? params.cyclic_attention_window_size
-                                              : std::min(timestep, params.cyclic_attention_window_size);
     int estimated_min_multi_block_count
         = estimate_min_multi_block_count<T>(max_timesteps, mMaxSharedMemoryPerBlockOptin - 2048);
 
@@ -1380,10 +1557,19 @@ int GPTAttentionPluginCommon::enqueueGeneration(
     size_t offset = 0;
     // estimate min block count to satisfy shared memory requirement to run kernel.
     // Runtime check to see the actual number of blocks per sequence we need.
-    int32_t const max_num_seq_len_tiles = std::max(getMaxNumSeqLenTile(batch_beam), estimated_min_multi_block_count);
-    int32_t const min_num_seq_len_tiles = std::max(1, estimated_min_multi_block_count);
+    int32_t max_num_seq_len_tiles = std::max(getMaxNumSeqLenTile(batch_beam), estimated_min_multi_block_count);
+    int32_t min_num_seq_len_tiles = std::max(1, estimated_min_multi_block_count);
+    if (multi_block_decision.numSplits > 1)
+    {
+        max_num_seq_len_tiles = std::max(multi_block_decision.numSplits, estimated_min_multi_block_count);
+        if (multi_block_decision.profiled)
+        {
+            min_num_seq_len_tiles = max_num_seq_len_tiles;
+        }
+    }
     bool const enable_multi_block
-        = (mMultiBlockMode && max_num_seq_len_tiles > 1) || estimated_min_multi_block_count > 1;
+        = ((mMultiBlockMode || multi_block_decision.numSplits > 1) && max_num_seq_len_tiles > 1)
+        || estimated_min_multi_block_count > 1;
     size_t const partial_out_size
         = enable_multi_block ? sizeof(T) * batch_beam * mNumHeads * mHeadSize * max_num_seq_len_tiles : 0;
     size_t const partial_sum_size
@@ -1464,6 +1650,7 @@ int GPTAttentionPluginCommon::enqueueGeneration(
     dispatch_params.kv_cache_quant_mode = mKVCacheQuantMode;
     dispatch_params.kv_scale_orig_quant = params.kv_scale_orig_quant;
     dispatch_params.kv_scale_quant_orig = params.kv_scale_quant_orig;
+    dispatch_params.kv_scale_per_head = params.kv_scale_per_head;
     dispatch_params.kv_block_array = kv_cache_buffer;
     dispatch_params.shift_k_cache_buffer = shift_k_cache_buffer;
     dispatch_params.multi_processor_count = mMultiProcessorCount;
@@ -1482,6 +1669,8 @@ int GPTAttentionPluginCommon::enqueueGeneration(
     dispatch_params.memory_length_per_sample = params.encoder_input_lengths;
     dispatch_params.block_sparse_attention = mMaskType == AttentionMaskType::BLOCKSPARSE;
     dispatch_params.block_sparse_params = mBlockSparseParams;
+    dispatch_params.kv_importance_scores = params.kv_importance_scores;
+    dispatch_params.kv_evicted_tokens = params.kv_evicted_tokens;
 
     using DataType = typename SATypeConverter<T>::Type;
     if (!mCrossAttention)
@@ -1595,6 +1784,9 @@ int GPTAttentionPluginCommon::initialize() noexcept
         // Load kernels for contiguous cache and paged kv cache at the same time.
         mFMHARunner.reset(
             new FusedMHARunnerV2(data_type, pagedKVFMHA, mNumHeads, getHeadSize(false), mQScaling, mQKTanhScale));
+        // The attention output is FP8 with FP8 context FMHA, there's no fallback to unfused MHA.
+        TLLM_CHECK_WITH_INFO(!mFP8ContextFMHA || mFMHARunner->hasKernels(),
+            "FP8 context FMHA kernels are not available for sm_%d in this build.", mSM);
         // Set flags: force_fp32_acc, is_s_padded, causal_mask, num_kv_heads.
         mFMHARunner->setup_flags(mFMHAForceFP32Acc, !mRemovePadding, true, mNumKVHeads);
     }
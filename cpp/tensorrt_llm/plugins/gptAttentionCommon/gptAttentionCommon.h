@@ -129,6 +129,10 @@ protected:
         int32_t cross_qkv_length = 0;
         int32_t const* encoder_input_lengths = nullptr;
         int32_t num_encoder_tokens = 0;
+        // optional when the kv cache scales have one value per kv head.
+        bool kv_scale_per_head = false;
+        // optional host copy of q_seq_lengths, lets the unfused attention skip the padding of shorter sequences.
+        int32_t const* host_context_lengths = nullptr;
 
         std::string enqueueContextParamsToString() const
         {
@@ -172,6 +176,8 @@ protected:
             ss << "cross_qkv_length: " << cross_qkv_length << std::endl;
             ss << "encoder_input_lengths: " << encoder_input_lengths << std::endl;
             ss << "num_encoder_tokens: " << num_encoder_tokens << std::endl;
+            ss << "kv_scale_per_head: " << std::boolalpha << kv_scale_per_head << std::endl;
+            ss << "host_context_lengths: " << host_context_lengths << std::endl;
             return ss.str();
         }
     };
@@ -225,6 +231,11 @@ protected:
         int32_t const* spec_decoding_position_offsets = nullptr;
         int32_t const* spec_decoding_generation_lengths = nullptr;
         int32_t total_num_input_tokens;
+        // optional when the kv cache scales have one value per kv head.
+        bool kv_scale_per_head = false;
+        // optional when the kv cache is compressed, see Multihead_attention_params_base.
+        float* kv_importance_scores = nullptr;
+        int32_t const* kv_evicted_tokens = nullptr;
     };
 
     template <typename T, typename KVCacheBuffer>
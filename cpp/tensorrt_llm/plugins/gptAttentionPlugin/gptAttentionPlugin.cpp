@@ -25,7 +25,10 @@
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 #include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/kvCompressionContext.h"
 #include "tensorrt_llm/runtime/utils/debugUtils.h"
+#include "tensorrt_llm/runtime/numericSentinel.h"
+#include "tensorrt_llm/runtime/pluginTimer.h"
 #include <algorithm>
 #include <cstdint>
 #include <functional>
@@ -36,6 +39,11 @@ using namespace tensorrt_llm::kernels;
 using namespace tensorrt_llm::common;
 using tensorrt_llm::plugins::GPTAttentionPluginCreator;
 using tensorrt_llm::plugins::GPTAttentionPlugin;
+using tensorrt_llm::runtime::KvCompressionContext;
+using tensorrt_llm::runtime::NumericSentinel;
+using tensorrt_llm::runtime::PluginKind;
+using tensorrt_llm::runtime::PluginTimer;
+using tensorrt_llm::runtime::SentinelSite;
 
 static char const* GPT_ATTENTION_PLUGIN_VERSION{"1"};
 static char const* GPT_ATTENTION_PLUGIN_NAME{"GPTAttention"};
@@ -572,12 +580,23 @@ int GPTAttentionPlugin::enqueueSome(int32_t seqIdxBeg, int32_t localNbSeq, int32
 
     float const* kv_scale_orig_quant = nullptr;
     float const* kv_scale_quant_orig = nullptr;
+    // The kv cache scales are either per tensor [1] or per kv head [num_kv_heads].
+    bool kv_scale_per_head = false;
     if (useKVCache() && mKVCacheQuantMode.hasKvCacheQuant())
     {
         assert(inputDesc[getIdx(IdxEntry::KV_CACHE_QUANTIZATION_SCALE)].type == nvinfer1::DataType::kFLOAT);
         assert(inputDesc[getIdx(IdxEntry::KV_CACHE_DEQUANTIZATION_SCALE)].type == nvinfer1::DataType::kFLOAT);
         kv_scale_orig_quant = reinterpret_cast<float const*>(inputs[getIdx(IdxEntry::KV_CACHE_QUANTIZATION_SCALE)]);
         kv_scale_quant_orig = reinterpret_cast<float const*>(inputs[getIdx(IdxEntry::KV_CACHE_DEQUANTIZATION_SCALE)]);
+        using tensorrt_llm::runtime::ITensor;
+        auto const numKvScales = ITensor::volume(inputDesc[getIdx(IdxEntry::KV_CACHE_QUANTIZATION_SCALE)].dims);
+        TLLM_CHECK_WITH_INFO(numKvScales == 1 || numKvScales == mNumKVHeads,
+            "The kv cache scales should have 1 or num_kv_heads (%d) values, got %ld.", mNumKVHeads,
+            static_cast<long>(numKvScales));
+        TLLM_CHECK_WITH_INFO(
+            ITensor::volume(inputDesc[getIdx(IdxEntry::KV_CACHE_DEQUANTIZATION_SCALE)].dims) == numKvScales,
+            "The kv cache quantization and dequantization scales should have the same shape.");
+        kv_scale_per_head = numKvScales > 1;
     }
 
     float const* attention_output_orig_quant = nullptr;
@@ -706,6 +725,12 @@ int GPTAttentionPlugin::enqueueSome(int32_t seqIdxBeg, int32_t localNbSeq, int32
             enqueue_params.relative_attention_bias_stride
                 = inputDesc[getIdx(IdxEntry::RELATIVE_ATTENTION_BIAS)].dims.d[1]; // max_seq_len or num_buckets
         }
+        enqueue_params.kv_scale_per_head = kv_scale_per_head;
+        if (mRemovePadding)
+        {
+            enqueue_params.host_context_lengths
+                = static_cast<int32_t const*>(inputs[getIdx(IdxEntry::HOST_CONTEXT_LENGTH)]) + seqIdxBeg;
+        }
         if (isCrossAttention())
         {
             enqueue_params.cross_qkv = static_cast<T const*>(inputs[getIdx(IdxEntry::CROSS_QKV)]);
@@ -755,6 +780,7 @@ int GPTAttentionPlugin::enqueueSome(int32_t seqIdxBeg, int32_t localNbSeq, int32
             max_attention_window_size, cyclic_attention_window_size, sink_token_length, num_requests,
             max_blocks_per_sequence, cache_indir, mMultiBlockSemaphores.get(), workspace, max_context_kv_len_list};
         enqueue_params.host_context_lengths = host_context_lengths;
+        enqueue_params.kv_scale_per_head = kv_scale_per_head;
         if (isRelativePosition())
         {
             enqueue_params.relative_attention_bias
@@ -773,6 +799,19 @@ int GPTAttentionPlugin::enqueueSome(int32_t seqIdxBeg, int32_t localNbSeq, int32
             enqueue_params.spec_decoding_position_offsets = spec_decoding_position_offsets;
             enqueue_params.spec_decoding_generation_lengths = spec_decoding_generation_lengths;
         }
+        if (auto const* kvCompression = KvCompressionContext::getActive();
+            kvCompression != nullptr && !isCrossAttention())
+        {
+            TLLM_CHECK_WITH_INFO(mPagedKVCache && beamWidth == 1 && !mIsSpecDecodingEnabled && !isALiBi()
+                    && !isRelativePosition(),
+                "KV compression needs a paged KV cache, beam width 1 and rotary or learned positions.");
+            TLLM_CHECK_WITH_INFO(kvCompression->maxAttentionWindow == max_attention_window_size,
+                "KV compression buffers are sized for a window of %d tokens, the layer has %d.",
+                kvCompression->maxAttentionWindow, max_attention_window_size);
+            enqueue_params.kv_importance_scores
+                = kvCompression->importanceScores + static_cast<std::size_t>(seqIdxBeg) * max_attention_window_size;
+            enqueue_params.kv_evicted_tokens = kvCompression->evictedTokens + seqIdxBeg;
+        }
         enqueue_params.total_num_input_tokens = localNbTokens;
 
         enqueueGeneration<T, KVCacheBuffer>(enqueue_params, stream);
@@ -814,6 +853,10 @@ int GPTAttentionPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
     {
         return 0;
     }
+    // Declared first so that the check is enqueued after the attention and outside of its timing
+    auto const sentinelScope
+        = NumericSentinel::getInstance().scope(SentinelSite::kATTENTION_OUTPUT, outputDesc[0], outputs[0], stream);
+    auto const timingScope = PluginTimer::getInstance().scope(PluginKind::kATTENTION, stream);
     if (mType == nvinfer1::DataType::kHALF)
     {
         return enqueueDispatchKVCacheType<half>(inputDesc, outputDesc, inputs, outputs, workspace, stream);
@@ -29,13 +29,36 @@ static char const* LAYERNORM_QUANTIZATION_PLUGIN_NAME{"LayernormQuantization"};
 PluginFieldCollection LayernormQuantizationPluginCreator::mFC{};
 std::vector<nvinfer1::PluginField> LayernormQuantizationPluginCreator::mPluginAttributes;
 
-LayernormQuantizationPlugin::LayernormQuantizationPlugin(
-    float eps, bool useDiffOfSquares, bool dynamicActivationScaling, nvinfer1::DataType type)
+namespace
+{
+template <typename T>
+void invokeLayernormQuantization(nvinfer1::DataType outputType, void* output, T const* input, T const* weight,
+    T const* bias, float eps, int m, int n, bool useDiffOfSquares, float const* scale, float* dynamicScale,
+    cudaStream_t stream)
+{
+#ifdef ENABLE_FP8
+    if (outputType == DataType::kFP8)
+    {
+        invokeGeneralLayerNorm((T*) nullptr, input, weight, bias, eps, m, n, stream, useDiffOfSquares, scale,
+            dynamicScale, reinterpret_cast<__nv_fp8_e4m3*>(output));
+        return;
+    }
+#endif
+    invokeGeneralLayerNorm((T*) nullptr, input, weight, bias, eps, m, n, stream, useDiffOfSquares, scale, dynamicScale,
+        reinterpret_cast<int8_t*>(output));
+}
+} // namespace
+
+LayernormQuantizationPlugin::LayernormQuantizationPlugin(float eps, bool useDiffOfSquares,
+    bool dynamicActivationScaling, nvinfer1::DataType type, nvinfer1::DataType outputType)
     : mEps(eps)
     , mUseDiffOfSquares(useDiffOfSquares)
     , mDynActScaling(dynamicActivationScaling)
     , mType(type)
+    , mOutputType(outputType)
 {
+    TLLM_CHECK_WITH_INFO(mOutputType == DataType::kINT8 || mOutputType == DataType::kFP8,
+        "LayernormQuantization only supports INT8 and FP8 outputs.");
 }
 
 // Parameterized constructor
@@ -46,6 +69,7 @@ LayernormQuantizationPlugin::LayernormQuantizationPlugin(void const* data, size_
     read(d, mUseDiffOfSquares);
     read(d, mDynActScaling);
     read(d, mType);
+    read(d, mOutputType);
     TLLM_CHECK_WITH_INFO(d == a + length,
         "Expected length (%d) != real length (%d). This is often "
         "caused by using different TensorRT-LLM version to build "
@@ -56,7 +80,7 @@ LayernormQuantizationPlugin::LayernormQuantizationPlugin(void const* data, size_
 // IPluginV2DynamicExt Methods
 nvinfer1::IPluginV2DynamicExt* LayernormQuantizationPlugin::clone() const noexcept
 {
-    auto* plugin = new LayernormQuantizationPlugin(mEps, mUseDiffOfSquares, mDynActScaling, mType);
+    auto* plugin = new LayernormQuantizationPlugin(mEps, mUseDiffOfSquares, mDynActScaling, mType, mOutputType);
     plugin->setPluginNamespace(mNamespace.c_str());
     return plugin;
 }
@@ -109,7 +133,7 @@ bool LayernormQuantizationPlugin::supportsFormatCombination(
     if (pos == 4)
     {
         // Quantized output
-        return (inOut[pos].type == nvinfer1::DataType::kINT8) && (inOut[pos].format == TensorFormat::kLINEAR);
+        return (inOut[pos].type == mOutputType) && (inOut[pos].format == TensorFormat::kLINEAR);
     }
     // Dynamic scaling if enabled
     return (inOut[pos].type == nvinfer1::DataType::kFLOAT) && (inOut[pos].format == TensorFormat::kLINEAR);
@@ -148,7 +172,7 @@ int LayernormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
     int const n = TLLM_INT32_CAST(inputDesc[1].dims.d[0]);
 
     float const* scale = reinterpret_cast<float const*>(inputs[3]);
-    int8_t* output = reinterpret_cast<int8_t*>(outputs[0]);
+    void* output = outputs[0];
     float* dynamic_scale = mDynActScaling ? reinterpret_cast<float*>(outputs[1]) : nullptr;
 
     if (mType == DataType::kHALF)
@@ -156,16 +180,16 @@ int LayernormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
         half const* input = reinterpret_cast<half const*>(inputs[0]);
         half const* weight = reinterpret_cast<half const*>(inputs[1]);
         half const* bias = reinterpret_cast<half const*>(inputs[2]);
-        invokeGeneralLayerNorm(
-            (half*) nullptr, input, weight, bias, mEps, m, n, stream, mUseDiffOfSquares, scale, dynamic_scale, output);
+        invokeLayernormQuantization(
+            mOutputType, output, input, weight, bias, mEps, m, n, mUseDiffOfSquares, scale, dynamic_scale, stream);
     }
     else if (mType == DataType::kFLOAT)
     {
         float const* input = reinterpret_cast<float const*>(inputs[0]);
         float const* weight = reinterpret_cast<float const*>(inputs[1]);
         float const* bias = reinterpret_cast<float const*>(inputs[2]);
-        invokeGeneralLayerNorm(
-            (float*) nullptr, input, weight, bias, mEps, m, n, stream, mUseDiffOfSquares, scale, dynamic_scale, output);
+        invokeLayernormQuantization(
+            mOutputType, output, input, weight, bias, mEps, m, n, mUseDiffOfSquares, scale, dynamic_scale, stream);
     }
 #ifdef ENABLE_BF16
     else if (mType == DataType::kBF16)
@@ -173,8 +197,8 @@ int LayernormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
         __nv_bfloat16 const* input = reinterpret_cast<__nv_bfloat16 const*>(inputs[0]);
         __nv_bfloat16 const* weight = reinterpret_cast<__nv_bfloat16 const*>(inputs[1]);
         __nv_bfloat16 const* bias = reinterpret_cast<__nv_bfloat16 const*>(inputs[2]);
-        invokeGeneralLayerNorm((__nv_bfloat16*) nullptr, input, weight, bias, mEps, m, n, stream, mUseDiffOfSquares,
-            scale, dynamic_scale, output);
+        invokeLayernormQuantization(
+            mOutputType, output, input, weight, bias, mEps, m, n, mUseDiffOfSquares, scale, dynamic_scale, stream);
     }
 #endif
 
@@ -189,7 +213,7 @@ nvinfer1::DataType LayernormQuantizationPlugin::getOutputDataType(
     if (index == 0)
     {
         // Output 0 quantized output of layer norm
-        return nvinfer1::DataType::kINT8;
+        return mOutputType;
     }
     // Output 1 dynamic act scaling
     return nvinfer1::DataType::kFLOAT;
@@ -221,7 +245,7 @@ void LayernormQuantizationPlugin::terminate() noexcept {}
 
 size_t LayernormQuantizationPlugin::getSerializationSize() const noexcept
 {
-    return sizeof(mEps) + sizeof(mUseDiffOfSquares) + sizeof(mDynActScaling) + sizeof(mType);
+    return sizeof(mEps) + sizeof(mUseDiffOfSquares) + sizeof(mDynActScaling) + sizeof(mType) + sizeof(mOutputType);
 }
 
 void LayernormQuantizationPlugin::serialize(void* buffer) const noexcept
@@ -231,6 +255,7 @@ void LayernormQuantizationPlugin::serialize(void* buffer) const noexcept
     write(d, mUseDiffOfSquares);
     write(d, mDynActScaling);
     write(d, mType);
+    write(d, mOutputType);
     assert(d == a + getSerializationSize());
 }
 
@@ -250,6 +275,7 @@ LayernormQuantizationPluginCreator::LayernormQuantizationPluginCreator()
     mPluginAttributes.emplace_back(PluginField("use_diff_of_squares", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("dyn_act_scaling", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("type_id", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("out_type_id", nullptr, PluginFieldType::kINT32, 1));
     mFC.nbFields = mPluginAttributes.size();
     mFC.fields = mPluginAttributes.data();
 }
@@ -274,6 +300,7 @@ IPluginV2* LayernormQuantizationPluginCreator::createPlugin(char const* name, Pl
     PluginField const* fields = fc->fields;
     float eps;
     nvinfer1::DataType type;
+    nvinfer1::DataType outputType = nvinfer1::DataType::kINT8;
     bool useDiffOfSquares;
     bool dynamicActivationScaling;
     // Read configurations from each fields
@@ -290,6 +317,11 @@ IPluginV2* LayernormQuantizationPluginCreator::createPlugin(char const* name, Pl
             TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
             type = static_cast<nvinfer1::DataType>(*(static_cast<nvinfer1::DataType const*>(fields[i].data)));
         }
+        else if (!strcmp(attrName, "out_type_id"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            outputType = static_cast<nvinfer1::DataType>(*(static_cast<nvinfer1::DataType const*>(fields[i].data)));
+        }
         else if (!strcmp(attrName, "dyn_act_scaling"))
         {
             TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
@@ -303,7 +335,7 @@ IPluginV2* LayernormQuantizationPluginCreator::createPlugin(char const* name, Pl
     }
     try
     {
-        auto* obj = new LayernormQuantizationPlugin(eps, useDiffOfSquares, dynamicActivationScaling, type);
+        auto* obj = new LayernormQuantizationPlugin(eps, useDiffOfSquares, dynamicActivationScaling, type, outputType);
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
@@ -28,8 +28,9 @@ namespace tensorrt_llm::plugins
 class LayernormQuantizationPlugin : public BasePlugin
 {
 public:
-    LayernormQuantizationPlugin(
-        float eps, bool useDiffOfSquares, bool dynamicActivationScaling, nvinfer1::DataType type);
+    // outputType is kINT8 or, for the W4A8 (FP8 activation) GEMMs, kFP8.
+    LayernormQuantizationPlugin(float eps, bool useDiffOfSquares, bool dynamicActivationScaling,
+        nvinfer1::DataType type, nvinfer1::DataType outputType = nvinfer1::DataType::kINT8);
 
     LayernormQuantizationPlugin(void const* data, size_t length);
 
@@ -67,6 +68,7 @@ private:
     bool mUseDiffOfSquares;
     bool mDynActScaling;
     nvinfer1::DataType mType;
+    nvinfer1::DataType mOutputType;
 
     const std::string mLayerName;
 };
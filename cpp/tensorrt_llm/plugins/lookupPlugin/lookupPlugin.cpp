@@ -32,9 +32,10 @@ static char const* LOOKUP_PLUGIN_NAME{"Lookup"};
 PluginFieldCollection LookupPluginCreator::mFC{};
 std::vector<nvinfer1::PluginField> LookupPluginCreator::mPluginAttributes;
 
-LookupPlugin::LookupPlugin(nvinfer1::DataType type, int rank)
+LookupPlugin::LookupPlugin(nvinfer1::DataType type, int rank, bool int4Weight)
     : mType(type)
     , mRank(rank)
+    , mInt4Weight(int4Weight)
 {
     mArch = tensorrt_llm::common::getSMVersion();
 }
@@ -46,6 +47,7 @@ LookupPlugin::LookupPlugin(void const* data, size_t length)
     char const *d = reinterpret_cast<char const*>(data), *a = d;
     read(d, mType);
     read(d, mRank);
+    read(d, mInt4Weight);
     TLLM_CHECK_WITH_INFO(d == a + length,
         "Expected length (%d) != real length (%d). This is often "
         "caused by using different TensorRT-LLM version to build "
@@ -78,7 +80,10 @@ nvinfer1::DimsExprs LookupPlugin::getOutputDimensions(
         {
             ret.d[i] = inputs[0].d[i];
         }
-        ret.d[nbDimsInput] = inputs[1].d[nbDimsWeight - 1];
+        // An int4 table packs two values of the hidden dimension per element
+        ret.d[nbDimsInput] = mInt4Weight
+            ? exprBuilder.operation(DimensionOperation::kPROD, *inputs[1].d[nbDimsWeight - 1], *exprBuilder.constant(2))
+            : inputs[1].d[nbDimsWeight - 1];
 
         return ret;
     }
@@ -106,7 +111,6 @@ bool LookupPlugin::supportsFormatCombination(
     }
     else
     {
-        TLLM_CHECK_WITH_INFO(mArch == 90, "int8 weight only lookupPlugin is only supported in SM 90 now.");
         switch (pos)
         {
         case 0: res = ((inOut[0].type == DataType::kINT32) && (inOut[0].format == TensorFormat::kLINEAR)); break;
@@ -152,34 +156,27 @@ int LookupPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1:
     }
 
     int const localVocabSize = inputDesc[1].dims.d[0];
-    int const hidden = inputDesc[1].dims.d[inputDesc[1].dims.nbDims - 1];
+    int const hidden = inputDesc[1].dims.d[inputDesc[1].dims.nbDims - 1] * (mInt4Weight ? 2 : 1);
     int const* input = reinterpret_cast<int const*>(inputs[0]);
 
     int offset = mRank * localVocabSize;
 
     if (mNbInputs == 3)
     {
-        int8_t const* weight = reinterpret_cast<int8_t const*>(inputs[1]);
         if (mType == DataType::kHALF)
         {
-            half const* per_token_scales = reinterpret_cast<half const*>(inputs[2]);
-            half* output = reinterpret_cast<half*>(outputs[0]);
-            invokeLookUp<half, int8_t, int>(
-                output, input, weight, tokenNum, offset, localVocabSize, hidden, per_token_scales, stream);
+            enqueueQuantized<half>(
+                input, inputs[1], inputs[2], outputs[0], tokenNum, offset, localVocabSize, hidden, stream);
         }
         else if (mType == DataType::kFLOAT)
         {
-            float const* per_token_scales = reinterpret_cast<float const*>(inputs[2]);
-            float* output = reinterpret_cast<float*>(outputs[0]);
-            invokeLookUp<float, int8_t, int>(
-                output, input, weight, tokenNum, offset, localVocabSize, hidden, per_token_scales, stream);
+            enqueueQuantized<float>(
+                input, inputs[1], inputs[2], outputs[0], tokenNum, offset, localVocabSize, hidden, stream);
         }
         else if (mType == DataType::kBF16)
         {
-            __nv_bfloat16 const* per_token_scales = reinterpret_cast<__nv_bfloat16 const*>(inputs[2]);
-            __nv_bfloat16* output = reinterpret_cast<__nv_bfloat16*>(outputs[0]);
-            invokeLookUp<__nv_bfloat16, int8_t, int>(
-                output, input, weight, tokenNum, offset, localVocabSize, hidden, per_token_scales, stream);
+            enqueueQuantized<__nv_bfloat16>(
+                input, inputs[1], inputs[2], outputs[0], tokenNum, offset, localVocabSize, hidden, stream);
         }
     }
     else
@@ -211,6 +208,23 @@ int LookupPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1:
     return 0;
 }
 
+template <typename T>
+void LookupPlugin::enqueueQuantized(int const* input, void const* weight, void const* perTokenScales, void* output,
+    int64_t tokenNum, int offset, int localVocabSize, int hidden, cudaStream_t stream) const
+{
+    FusedLookUpParams<T, int8_t, int> params{};
+    params.out = reinterpret_cast<T*>(output);
+    params.input = input;
+    params.token_num = tokenNum;
+    params.n_embed = hidden;
+    params.weight = reinterpret_cast<int8_t const*>(weight);
+    params.offset = offset;
+    params.size = localVocabSize;
+    params.perTokenScales = reinterpret_cast<T const*>(perTokenScales);
+    params.int4_weight = mInt4Weight;
+    invokeFusedLookUp(params, stream);
+}
+
 // IPluginV2Ext Methods
 nvinfer1::DataType LookupPlugin::getOutputDataType(
     int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept
@@ -248,7 +262,7 @@ void LookupPlugin::destroy() noexcept
 
 size_t LookupPlugin::getSerializationSize() const noexcept
 {
-    return sizeof(mType) + sizeof(mRank);
+    return sizeof(mType) + sizeof(mRank) + sizeof(mInt4Weight);
 }
 
 void LookupPlugin::serialize(void* buffer) const noexcept
@@ -256,6 +270,7 @@ void LookupPlugin::serialize(void* buffer) const noexcept
     char *d = static_cast<char*>(buffer), *a = d;
     write(d, mType);
     write(d, mRank);
+    write(d, mInt4Weight);
 
     assert(d == a + getSerializationSize());
 }
@@ -270,6 +285,7 @@ LookupPluginCreator::LookupPluginCreator()
     mPluginAttributes.clear();
     mPluginAttributes.emplace_back(PluginField("type_id", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("rank", nullptr, PluginFieldType::kINT32, 0));
+    mPluginAttributes.emplace_back(PluginField("int4_weight", nullptr, PluginFieldType::kINT8, 0));
     mFC.nbFields = mPluginAttributes.size();
     mFC.fields = mPluginAttributes.data();
 }
@@ -294,6 +310,7 @@ IPluginV2* LookupPluginCreator::createPlugin(char const* name, PluginFieldCollec
     PluginField const* fields = fc->fields;
     nvinfer1::DataType type;
     int rank;
+    bool int4Weight{false};
     // Read configurations from each fields
     for (int i = 0; i < fc->nbFields; ++i)
     {
@@ -308,10 +325,15 @@ IPluginV2* LookupPluginCreator::createPlugin(char const* name, PluginFieldCollec
             TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
             rank = static_cast<int>(*(static_cast<int const*>(fields[i].data)));
         }
+        else if (!strcmp(attrName, "int4_weight"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT8);
+            int4Weight = static_cast<bool>(*(static_cast<int8_t const*>(fields[i].data)));
+        }
     }
     try
     {
-        auto* obj = new LookupPlugin(type, rank);
+        auto* obj = new LookupPlugin(type, rank, int4Weight);
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
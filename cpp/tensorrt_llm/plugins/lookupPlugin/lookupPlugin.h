@@ -30,7 +30,8 @@ class LookupPlugin : public BasePlugin
 public:
     LookupPlugin() = delete;
 
-    LookupPlugin(nvinfer1::DataType type, int rank);
+    //! \param int4Weight Whether the weight-only quantized table packs two int4 values per int8, else one int8 value.
+    LookupPlugin(nvinfer1::DataType type, int rank, bool int4Weight = false);
 
     LookupPlugin(void const* data, size_t length);
 
@@ -64,10 +65,15 @@ public:
     void destroy() noexcept override;
 
 private:
+    template <typename T>
+    void enqueueQuantized(int const* input, void const* weight, void const* perTokenScales, void* output,
+        int64_t tokenNum, int offset, int localVocabSize, int hidden, cudaStream_t stream) const;
+
     const std::string mLayerName;
 
     nvinfer1::DataType mType;
     int mRank;
+    bool mInt4Weight;
     int mNbInputs = 0;
     int mArch;
 };
@@ -22,6 +22,7 @@
 #include "tensorrt_llm/common/cublasMMWrapper.h"
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/kernels/groupGemm.h"
+#include "tensorrt_llm/kernels/loraSgmv.h"
 #include "tensorrt_llm/kernels/splitkGroupGemm.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 
@@ -446,6 +447,10 @@ int LoraPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::P
         std::vector<void*> ptrD_2;
         ptrD_2.reserve(batch_size * mNumLoraModules);
 
+        std::vector<tk::LoraSgmvProblem> sgmvProblems;
+        sgmvProblems.reserve(batch_size * mNumLoraModules);
+        size_t maxProblemM = 0;
+
         std::vector<int64_t> splitkBufferOffsets;
         splitkBufferOffsets.push_back(0);
         for (int loraModuleIdx = 0; loraModuleIdx < mNumLoraModules; loraModuleIdx++)
@@ -511,13 +516,27 @@ int LoraPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::P
                         static_cast<char*>(outputs[loraModuleIdx]) + handled_token_num * N2 * typeSize));
                     ptrD_2.push_back(static_cast<void*>(
                         static_cast<char*>(outputs[loraModuleIdx]) + handled_token_num * N2 * typeSize));
+
+                    sgmvProblems.push_back(tk::LoraSgmvProblem{ptrA.back(), ptrB.back(), ptrB_2.back(),
+                        ptrD_2.back(), static_cast<int>(M), N, static_cast<int>(N2)});
+                    maxProblemM = std::max(maxProblemM, M);
                 }
                 handled_token_num += M;
                 batchIdx += count;
                 splitkBufferOffsets.push_back(splitkBufferOffsets.at(splitkBufferOffsets.size() - 1) + M * N);
             }
         }
-        if (problem_sizes.size() > 0)
+        // With many distinct adapters the grouped GEMM problems are mostly single tokens, one fused launch over all
+        // segments is faster then. The SGMV kernel reads the input as [tokens, K] and the weights as stored in the
+        // cache pages ([N, K], transB), other layouts take the grouped GEMMs.
+        bool const useSgmv = !mTransA && mTransB && maxProblemM <= tk::kLORA_SGMV_MAX_NUM_TOKENS_PER_PROBLEM;
+        if (problem_sizes.size() > 0 && useSgmv)
+        {
+            auto const K = inputDesc[0].dims.d[nbDimsA - 1];
+            tk::invokeLoraSgmv(sgmvProblems, K, mMaxLowRank, groupGemmParamsWorkSpace, groupGemmParamsWorkSpaceSize,
+                mType, stream);
+        }
+        else if (problem_sizes.size() > 0)
         {
             tk::splitkGroupedGemm(problem_sizes, ptrA, ptrB, ptrC, ptrD, groupGemmParamsWorkSpace,
                 groupGemmParamsWorkSpaceSize, gemmWorkSpace, GemmWorkSpaceSize, splitkBufferOffsets, true, mType,
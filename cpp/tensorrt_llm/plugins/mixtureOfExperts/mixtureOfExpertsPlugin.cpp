@@ -17,7 +17,11 @@
 #include "tensorrt_llm/plugins/mixtureOfExperts/mixtureOfExpertsPlugin.h"
 #include "tensorrt_llm/common/cudaBf16Wrapper.h"
 #include "tensorrt_llm/common/dataType.h"
+#include "tensorrt_llm/common/mpiUtils.h"
 #include "tensorrt_llm/common/quantization.h"
+#include "tensorrt_llm/kernels/mixtureOfExperts/moeAllToAll.h"
+#include "tensorrt_llm/runtime/numericSentinel.h"
+#include "tensorrt_llm/runtime/pluginTimer.h"
 #include <numeric>
 
 using namespace nvinfer1;
@@ -30,6 +34,10 @@ using tensorrt_llm::plugins::MixtureOfExpertsPluginCreator;
 using tensorrt_llm::plugins::MixtureOfExpertsPlugin;
 using tensorrt_llm::plugins::read;
 using tensorrt_llm::plugins::write;
+using tensorrt_llm::runtime::NumericSentinel;
+using tensorrt_llm::runtime::PluginKind;
+using tensorrt_llm::runtime::PluginTimer;
+using tensorrt_llm::runtime::SentinelSite;
 
 static char const* MIXTURE_OF_EXPERTS_PLUGIN_VERSION{"1"};
 static char const* MIXTURE_OF_EXPERTS_PLUGIN_NAME{"MixtureOfExperts"};
@@ -226,6 +234,14 @@ void MixtureOfExpertsPlugin::init()
             static_cast<int>(mType), static_cast<int>(mWeightType));
     }
 
+    if (useAllToAll())
+    {
+        TLLM_CHECK_WITH_INFO(mType == DataType::kFLOAT || mType == DataType::kHALF || mType == DataType::kBF16,
+            "The MOE all-to-all only supports fp32/fp16/bf16 activations");
+        TLLM_CHECK_WITH_INFO(mTPSize <= kMaxMoeAllToAllRanks, "The MOE all-to-all supports up to %d ranks",
+            kMaxMoeAllToAllRanks);
+    }
+
     mGemmId = GemmIDMoe{mNumExperts, mK, mExpertHiddenSize, mExpertInterSize, mActivationType, mType, mWeightType,
         mQuantMode, mParallelismMode};
 }
@@ -336,11 +352,57 @@ auto MixtureOfExpertsPlugin::setupWorkspace(void* base_ptr, int64_t num_tokens)
     // Selected expert map
     size_t selected_expert_size = mK * num_tokens * sizeof(int);
 
+    // With the all-to-all the runner sees the received rows, each routed to one of the local experts. The profiler
+    // still runs the runner on the local tokens, so the buffers fit both.
+    size_t routing_softmax_size = 0;
+    size_t routed_size = 0;
+    size_t routed_scales_size = 0;
+    size_t exchange_counts_size = 0;
+    size_t recv_local_expert_size = 0;
+    size_t local_routing_size = 0;
+    size_t send_rows_size = 0;
+    size_t recv_rows_size = 0;
+    if (useAllToAll())
+    {
+        int64_t const capacity = getAllToAllCapacity(num_tokens);
+        int const experts_per_node = mNumExperts / mTPSize;
+        moe_workspace_size = std::max(moe_workspace_size,
+            mMOERunner->getWorkspaceSize(
+                capacity, mExpertHiddenSize, mExpertInterSize, experts_per_node, 1, mActivationType, {}));
+        scale_probabilities_size = std::max(scale_probabilities_size, capacity * sizeof(float));
+        src_to_dest_map_size = capacity * sizeof(int);
+        selected_expert_size = capacity * sizeof(int);
+
+        routing_softmax_size = num_tokens * mNumExperts * sizeof(float);
+        routed_size = mK * num_tokens * sizeof(int);
+        routed_scales_size = mK * num_tokens * sizeof(float);
+        // Send counts followed by receive counts
+        exchange_counts_size = 2 * mTPSize * sizeof(int);
+        recv_local_expert_size = capacity * sizeof(int);
+        local_routing_size = capacity * experts_per_node * sizeof(float);
+        // The send rows are reused for the rows sent back
+        send_rows_size = mK * num_tokens * mExpertHiddenSize * dtype_size;
+        recv_rows_size = capacity * mExpertHiddenSize * dtype_size;
+    }
+
     std::vector<size_t> workspaces{
         moe_workspace_size,
         scale_probabilities_size,
         src_to_dest_map_size,
         selected_expert_size,
+        routing_softmax_size,
+        routed_size,
+        routed_size,
+        routed_scales_size,
+        exchange_counts_size,
+        routed_size,
+        routed_size,
+        routed_size,
+        recv_local_expert_size,
+        local_routing_size,
+        send_rows_size,
+        recv_rows_size,
+        recv_rows_size,
     };
 
     WorkspaceInfo info{};
@@ -348,10 +410,29 @@ auto MixtureOfExpertsPlugin::setupWorkspace(void* base_ptr, int64_t num_tokens)
 
     if (base_ptr)
     {
-        info.workspace = base_ptr;
-        info.scale_probs = nextWorkspacePtr((int8_t*) info.workspace, moe_workspace_size);
-        info.src_to_dest_map = nextWorkspacePtr((int8_t*) info.scale_probs, scale_probabilities_size);
-        info.selected_experts = nextWorkspacePtr((int8_t*) info.src_to_dest_map, src_to_dest_map_size);
+        std::vector<int8_t*> ws_sliced{static_cast<int8_t*>(base_ptr)};
+        for (auto size : workspaces)
+        {
+            ws_sliced.push_back(nextWorkspacePtr(ws_sliced.back(), size));
+        }
+
+        info.workspace = ws_sliced[0];
+        info.scale_probs = ws_sliced[1];
+        info.src_to_dest_map = ws_sliced[2];
+        info.selected_experts = ws_sliced[3];
+        info.routing_softmax = ws_sliced[4];
+        info.routed_experts = ws_sliced[5];
+        info.routed_source_rows = ws_sliced[6];
+        info.routed_scales = ws_sliced[7];
+        info.exchange_counts = ws_sliced[8];
+        info.send_slot_for_expanded_row = ws_sliced[9];
+        info.send_expanded_row = ws_sliced[10];
+        info.send_local_expert = ws_sliced[11];
+        info.recv_local_expert = ws_sliced[12];
+        info.local_routing = ws_sliced[13];
+        info.send_rows = ws_sliced[14];
+        info.recv_rows = ws_sliced[15];
+        info.expert_output = ws_sliced[16];
     }
 
     return info;
@@ -386,6 +467,7 @@ MOEParallelismConfig MixtureOfExpertsPlugin::getParallelismConfig() const
     {
     case kernels::MOEParallelismMode::NONE: return {};
     case kernels::MOEParallelismMode::EXPERT_PARALLELISM:
+    case kernels::MOEParallelismMode::EXPERT_PARALLELISM_ALL_TO_ALL:
         return MOEParallelismConfig::ExpertParallelism(mTPSize, mTPRank);
     case kernels::MOEParallelismMode::TENSOR_PARALLELISM:
         return MOEParallelismConfig::TensorParallelism(mTPSize, mTPRank);
@@ -416,6 +498,10 @@ int MixtureOfExpertsPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
     nvinfer1::PluginTensorDesc const* outputDesc, void const* const* inputs, void* const* outputs, void* workspace_ptr,
     cudaStream_t stream) noexcept
 {
+    // Declared first so that the check is enqueued after the experts and outside of their timing
+    auto const sentinelScope = NumericSentinel::getInstance().scope(
+        SentinelSite::kMOE_OUTPUT, outputDesc[getOutputTensorIndex()], outputs[getOutputTensorIndex()], stream);
+    auto const timingScope = PluginTimer::getInstance().scope(PluginKind::kMOE, stream);
     int64_t const num_tokens = getNumTokens(inputDesc);
     int64_t const num_not_finished = num_tokens; // TODO Take this as an input
     auto parallelism_config = getParallelismConfig();
@@ -460,6 +546,16 @@ int MixtureOfExpertsPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
             hasExpertFp8FinalQuantScales() ? inputs[getExpertFP8QuantFinalIndex()] : nullptr);
     }
 
+    if (useAllToAll())
+    {
+        enqueueAllToAll(inputs[getInputTensorIndex()], static_cast<float const*>(inputs[getRoutingTensorIndex()]),
+            inputs[getExpertWeights1Index()], hasBias() ? inputs[getExpertBias1Index()] : nullptr,
+            inputs[getExpertWeights2Index()], hasBias() ? inputs[getExpertBias2Index()] : nullptr, quant_params,
+            hasFinishedTensor() ? static_cast<bool const*>(inputs[getFinishedTensorIndex()]) : nullptr,
+            outputs[getOutputTensorIndex()], num_tokens, workspace, stream);
+        return 0;
+    }
+
     mMOERunner->setTactic(mPluginProfiler->getBestConfig(num_tokens, mGemmId));
     mMOERunner->runMoe(inputs[getInputTensorIndex()], static_cast<float const*>(inputs[getRoutingTensorIndex()]),
         inputs[getExpertWeights1Index()], hasBias() ? inputs[getExpertBias1Index()] : nullptr, mActivationType,
@@ -494,13 +590,181 @@ char const* MixtureOfExpertsPlugin::getPluginVersion() const noexcept
     return MIXTURE_OF_EXPERTS_PLUGIN_VERSION;
 }
 
+void MixtureOfExpertsPlugin::enqueueAllToAll(void const* input, float const* routing, void const* fc1_weights,
+    void const* fc1_bias, void const* fc2_weights, void const* fc2_bias, QuantParams quant_params,
+    bool const* finished, void* output, int64_t num_tokens, WorkspaceInfo const& workspace, cudaStream_t stream)
+{
+#if ENABLE_MULTI_DEVICE
+    int const ep_size = mTPSize;
+    int const experts_per_node = mNumExperts / ep_size;
+    size_t const row_bytes = mExpertHiddenSize * tensorrt_llm::common::getDTypeSize(mType);
+    auto const nccl_type = (*getDtypeMap())[mType];
+    auto comm = (*getCommMap())[mGroup];
+    auto* send_rows = static_cast<int8_t*>(workspace.send_rows);
+    auto* recv_rows = static_cast<int8_t*>(workspace.recv_rows);
+    auto* expert_output = static_cast<int8_t*>(workspace.expert_output);
+    auto* send_local_expert = static_cast<int*>(workspace.send_local_expert);
+    auto* recv_local_expert = static_cast<int*>(workspace.recv_local_expert);
+    auto* send_counts_device = static_cast<int*>(workspace.exchange_counts);
+    auto* recv_counts_device = send_counts_device + ep_size;
+
+    // Route the local tokens over all the experts, and group the (token, expert) pairs by owning rank
+    topkGatingSoftmaxKernelLauncher(routing, finished, static_cast<float*>(workspace.routed_scales),
+        static_cast<float*>(workspace.routing_softmax), static_cast<int*>(workspace.routed_experts),
+        static_cast<int*>(workspace.routed_source_rows), num_tokens, mNumExperts, mK, 0, mNumExperts, stream);
+    invokeMoeDispatchLayout(static_cast<int const*>(workspace.routed_experts), num_tokens, mK, mNumExperts, ep_size,
+        send_counts_device, static_cast<int*>(workspace.send_slot_for_expanded_row),
+        static_cast<int*>(workspace.send_expanded_row), send_local_expert, stream);
+
+    NCCLCHECK(ncclGroupStart());
+    for (int peer = 0; peer < ep_size; ++peer)
+    {
+        NCCLCHECK(ncclSend(send_counts_device + peer, 1, ncclInt32, peer, comm, stream));
+        NCCLCHECK(ncclRecv(recv_counts_device + peer, 1, ncclInt32, peer, comm, stream));
+    }
+    NCCLCHECK(ncclGroupEnd());
+
+    // The row counts size the exchanges, so they are needed on the host
+    std::vector<int> counts(2 * ep_size);
+    tensorrt_llm::common::check_cuda_error(cudaMemcpyAsync(
+        counts.data(), send_counts_device, counts.size() * sizeof(int), cudaMemcpyDeviceToHost, stream));
+    tensorrt_llm::common::check_cuda_error(cudaStreamSynchronize(stream));
+    std::vector<int64_t> send_offsets(ep_size + 1, 0);
+    std::vector<int64_t> recv_offsets(ep_size + 1, 0);
+    for (int peer = 0; peer < ep_size; ++peer)
+    {
+        send_offsets[peer + 1] = send_offsets[peer] + counts[peer];
+        recv_offsets[peer + 1] = recv_offsets[peer] + counts[ep_size + peer];
+    }
+    int64_t const num_send = send_offsets[ep_size];
+    int64_t const num_recv = recv_offsets[ep_size];
+    TLLM_CHECK_WITH_INFO(num_recv <= getAllToAllCapacity(num_tokens),
+        "MOE all-to-all received %ld rows for a capacity of %ld, all ranks must pass the same number of tokens",
+        num_recv, getAllToAllCapacity(num_tokens));
+
+    switch (mType)
+    {
+    case DataType::kFLOAT:
+        invokeMoeDispatchGather(static_cast<float const*>(input), reinterpret_cast<float*>(send_rows),
+            static_cast<int const*>(workspace.send_expanded_row), num_send, mExpertHiddenSize, mK, stream);
+        break;
+    case DataType::kHALF:
+        invokeMoeDispatchGather(static_cast<half const*>(input), reinterpret_cast<half*>(send_rows),
+            static_cast<int const*>(workspace.send_expanded_row), num_send, mExpertHiddenSize, mK, stream);
+        break;
+#ifdef ENABLE_BF16
+    case DataType::kBF16:
+        invokeMoeDispatchGather(static_cast<__nv_bfloat16 const*>(input), reinterpret_cast<__nv_bfloat16*>(send_rows),
+            static_cast<int const*>(workspace.send_expanded_row), num_send, mExpertHiddenSize, mK, stream);
+        break;
+#endif
+    default: TLLM_THROW("Unsupported MOE all-to-all type");
+    }
+
+    NCCLCHECK(ncclGroupStart());
+    for (int peer = 0; peer < ep_size; ++peer)
+    {
+        int64_t const send_count = send_offsets[peer + 1] - send_offsets[peer];
+        int64_t const recv_count = recv_offsets[peer + 1] - recv_offsets[peer];
+        NCCLCHECK(ncclSend(send_rows + send_offsets[peer] * row_bytes, send_count * mExpertHiddenSize, nccl_type, peer,
+            comm, stream));
+        NCCLCHECK(ncclSend(send_local_expert + send_offsets[peer], send_count, ncclInt32, peer, comm, stream));
+        NCCLCHECK(ncclRecv(recv_rows + recv_offsets[peer] * row_bytes, recv_count * mExpertHiddenSize, nccl_type, peer,
+            comm, stream));
+        NCCLCHECK(ncclRecv(recv_local_expert + recv_offsets[peer], recv_count, ncclInt32, peer, comm, stream));
+    }
+    NCCLCHECK(ncclGroupEnd());
+
+    // Every received row goes to exactly one local expert with a weight of 1, the routing scales are applied when
+    // the results come back
+    if (num_recv > 0)
+    {
+        invokeMoeLocalRouting(
+            static_cast<float*>(workspace.local_routing), recv_local_expert, num_recv, experts_per_node, stream);
+        mMOERunner->setTactic(mPluginProfiler->getBestConfig(num_recv, mGemmId));
+        mMOERunner->runMoe(recv_rows, static_cast<float const*>(workspace.local_routing), fc1_weights, fc1_bias,
+            mActivationType, fc2_weights, fc2_bias, quant_params, num_recv, mExpertHiddenSize, mExpertInterSize,
+            experts_per_node, 1, static_cast<char*>(workspace.workspace),
+            // Outputs
+            expert_output, nullptr, num_recv, workspace.scale_probs, static_cast<int*>(workspace.src_to_dest_map),
+            static_cast<int*>(workspace.selected_experts), {}, MOEExpertScaleNormalizationMode::NONE, stream);
+    }
+
+    // Send the results back in the order they came, landing where the rows were sent from
+    NCCLCHECK(ncclGroupStart());
+    for (int peer = 0; peer < ep_size; ++peer)
+    {
+        int64_t const send_count = send_offsets[peer + 1] - send_offsets[peer];
+        int64_t const recv_count = recv_offsets[peer + 1] - recv_offsets[peer];
+        NCCLCHECK(ncclSend(expert_output + recv_offsets[peer] * row_bytes, recv_count * mExpertHiddenSize, nccl_type,
+            peer, comm, stream));
+        NCCLCHECK(ncclRecv(send_rows + send_offsets[peer] * row_bytes, send_count * mExpertHiddenSize, nccl_type, peer,
+            comm, stream));
+    }
+    NCCLCHECK(ncclGroupEnd());
+
+    auto const* scales = static_cast<float const*>(workspace.routed_scales);
+    auto const* slots = static_cast<int const*>(workspace.send_slot_for_expanded_row);
+    switch (mType)
+    {
+    case DataType::kFLOAT:
+        invokeMoeCombine(reinterpret_cast<float const*>(send_rows), static_cast<float*>(output), scales, slots,
+            num_tokens, mExpertHiddenSize, mK, mNormalizationMode, stream);
+        break;
+    case DataType::kHALF:
+        invokeMoeCombine(reinterpret_cast<half const*>(send_rows), static_cast<half*>(output), scales, slots,
+            num_tokens, mExpertHiddenSize, mK, mNormalizationMode, stream);
+        break;
+#ifdef ENABLE_BF16
+    case DataType::kBF16:
+        invokeMoeCombine(reinterpret_cast<__nv_bfloat16 const*>(send_rows), static_cast<__nv_bfloat16*>(output),
+            scales, slots, num_tokens, mExpertHiddenSize, mK, mNormalizationMode, stream);
+        break;
+#endif
+    default: TLLM_THROW("Unsupported MOE all-to-all type");
+    }
+    sync_check_cuda_error();
+#else
+    TLLM_THROW("The MOE all-to-all needs a build with ENABLE_MULTI_DEVICE");
+#endif // ENABLE_MULTI_DEVICE
+}
+
 int MixtureOfExpertsPlugin::initialize() noexcept
 {
     mPluginProfiler->profileTactics(this, mType, mDims, mGemmId);
+#if ENABLE_MULTI_DEVICE
+    if (useAllToAll())
+    {
+        // The expert parallel group is the tensor parallel group, whose ranks are consecutive
+        int const first_rank = getCommSessionRank() - mTPRank;
+        mGroup.clear();
+        for (int rank = first_rank; rank < first_rank + mTPSize; ++rank)
+        {
+            mGroup.insert(rank);
+        }
+        initCommMap(mGroup);
+    }
+#endif // ENABLE_MULTI_DEVICE
     return 0;
 }
 
-void MixtureOfExpertsPlugin::terminate() noexcept {}
+void MixtureOfExpertsPlugin::terminate() noexcept
+{
+#if ENABLE_MULTI_DEVICE
+    if (!useAllToAll())
+    {
+        return;
+    }
+    auto* commMap = getCommMap();
+    // [] operator inserts T() if it does not exist
+    if (isBuilding() || (*commMap)[mGroup] == nullptr)
+    {
+        return;
+    }
+    NCCLCHECK(ncclCommDestroy((*commMap)[mGroup]));
+    (*commMap)[mGroup] = nullptr;
+#endif // ENABLE_MULTI_DEVICE
+}
 
 void MixtureOfExpertsPlugin::destroy() noexcept
 {
@@ -157,6 +157,9 @@ private:
 
     MixtureOfExpertsPluginProfilerPtr mPluginProfiler;
 
+    // World ranks of the expert parallel group, used by the all-to-all
+    std::set<int> mGroup;
+
     const std::string mLayerName{};
     std::string mNamespace{};
 
@@ -167,12 +170,43 @@ private:
         void* fc2_output{};
         void* src_to_dest_map{};
         void* selected_experts{};
+
+        // Only used by the all-to-all expert parallelism
+        void* routing_softmax{};
+        void* routed_experts{};
+        void* routed_source_rows{};
+        void* routed_scales{};
+        void* exchange_counts{};
+        void* send_slot_for_expanded_row{};
+        void* send_expanded_row{};
+        void* send_local_expert{};
+        void* recv_local_expert{};
+        void* local_routing{};
+        void* send_rows{};
+        void* recv_rows{};
+        void* expert_output{};
         size_t size{};
     };
 
     int64_t getNumTokens(nvinfer1::PluginTensorDesc const* input_tensor) const;
     WorkspaceInfo setupWorkspace(void* base_ptr, int64_t num_tokens) const;
 
+    bool useAllToAll() const
+    {
+        return mParallelismMode == MOEParallelismMode::EXPERT_PARALLELISM_ALL_TO_ALL;
+    }
+
+    // Rows a rank may receive in the all-to-all: all k expanded rows of all tokens of all ranks, assuming every rank
+    // passes the same number of tokens
+    int64_t getAllToAllCapacity(int64_t num_tokens) const
+    {
+        return num_tokens * mK * mTPSize;
+    }
+
+    void enqueueAllToAll(void const* input, float const* routing, void const* fc1_weights, void const* fc1_bias,
+        void const* fc2_weights, void const* fc2_bias, kernels::QuantParams quant_params, bool const* finished,
+        void* output, int64_t num_tokens, WorkspaceInfo const& workspace, cudaStream_t stream);
+
     kernels::MOEParallelismConfig getParallelismConfig() const;
     kernels::QuantParams getQuantParams(
         void const* scale_1, void const* scale_2, void const* scale_3 = nullptr, void const* scale_4 = nullptr) const;
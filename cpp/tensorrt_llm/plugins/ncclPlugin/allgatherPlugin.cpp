@@ -16,21 +16,36 @@
  */
 #include "allgatherPlugin.h"
 
+#include "tensorrt_llm/common/customAllReduceUtils.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+#include <algorithm>
 #include <nccl.h>
 
 using namespace nvinfer1;
 using tensorrt_llm::plugins::AllgatherPluginCreator;
 using tensorrt_llm::plugins::AllgatherPlugin;
+using tensorrt_llm::kernels::AllReduceStrategyType;
+using tensorrt_llm::kernels::AllReduceParams;
 
 static char const* ALLGATHER_PLUGIN_VERSION{"1"};
 static char const* ALLGATHER_PLUGIN_NAME{"AllGather"};
 PluginFieldCollection AllgatherPluginCreator::mFC{};
 std::vector<nvinfer1::PluginField> AllgatherPluginCreator::mPluginAttributes;
 
-AllgatherPlugin::AllgatherPlugin(std::set<int> group, nvinfer1::DataType type)
+AllgatherPlugin::AllgatherPlugin(
+    std::set<int> group, nvinfer1::DataType type, AllReduceStrategyType strategy, int32_t counter)
     : mGroup(std::move(group))
     , mType(type)
+    , mStrategy(strategy)
+    , mCounter(counter)
 {
+    TLLM_CHECK_WITH_INFO(mStrategy == AllReduceStrategyType::NCCL || mStrategy == AllReduceStrategyType::ONESHOT
+            || mStrategy == AllReduceStrategyType::AUTO,
+        "AllGather supports the NCCL, ONESHOT and AUTO strategies.");
+    if (std::getenv("FORCE_NCCL_ALL_REDUCE_STRATEGY") != nullptr)
+    {
+        mStrategy = AllReduceStrategyType::NCCL;
+    }
 }
 
 // Parameterized constructor
@@ -38,6 +53,12 @@ AllgatherPlugin::AllgatherPlugin(void const* data, size_t length)
 {
     char const *d = reinterpret_cast<char const*>(data), *a = d;
     read(d, mType);
+    read(d, mStrategy);
+    if (std::getenv("FORCE_NCCL_ALL_REDUCE_STRATEGY") != nullptr)
+    {
+        mStrategy = AllReduceStrategyType::NCCL;
+    }
+    read(d, mCounter);
     mGroup.clear();
     int groupItem = 0;
     while (d != a + length)
@@ -72,7 +93,19 @@ nvinfer1::DimsExprs AllgatherPlugin::getOutputDimensions(
 bool AllgatherPlugin::supportsFormatCombination(
     int pos, nvinfer1::PluginTensorDesc const* inOut, int nbInputs, int nbOutputs) noexcept
 {
+    if (mStrategy == AllReduceStrategyType::NCCL)
+    {
+        TLLM_CHECK_WITH_INFO(nbInputs == 1, "NCCL strategy only accepts one input.");
+    }
+    else
+    {
+        TLLM_CHECK_WITH_INFO(nbInputs == 2, "Non-NCCL strategies require a workspace tensor.");
+    }
 
+    if (mStrategy != AllReduceStrategyType::NCCL && pos == 1)
+    {
+        return (inOut[pos].type == nvinfer1::DataType::kINT64) && (inOut[pos].format == TensorFormat::kLINEAR);
+    }
     return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
 }
 
@@ -87,6 +120,24 @@ size_t AllgatherPlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc const* input
     return 0;
 }
 
+AllReduceStrategyType AllgatherPlugin::selectStrategy(size_t messageSize, void const* const* inputs) const noexcept
+{
+    auto const nRanks = mGroup.size();
+    if (mStrategy == AllReduceStrategyType::NCCL || nRanks > kernels::MAX_RANKS_PER_NODE)
+    {
+        return AllReduceStrategyType::NCCL;
+    }
+    // The custom kernels need the buffers of all ranks, which are only mapped for the ranks of a node
+    auto const* ptrs = static_cast<int64_t const*>(inputs[1]);
+    bool const isMapped = std::all_of(ptrs, ptrs + nRanks * utils::customAllReduceUtils::NUM_POINTERS_PER_RANK,
+        [](int64_t ptr) { return ptr != 0; });
+    if (!isMapped)
+    {
+        return AllReduceStrategyType::NCCL;
+    }
+    return kernels::selectGatherScatterStrategy(mStrategy, messageSize, nRanks, mType);
+}
+
 int AllgatherPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::PluginTensorDesc const* outputDesc,
     void const* const* inputs, void* const* outputs, void* workspace, cudaStream_t stream) noexcept
 {
@@ -100,6 +151,18 @@ int AllgatherPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfe
         size *= inputDesc[0].dims.d[i];
     }
 
+    auto const nRanks = mGroup.size();
+    if (selectStrategy(size * nRanks, inputs) == AllReduceStrategyType::ONESHOT)
+    {
+        auto params = AllReduceParams::deserialize(
+            reinterpret_cast<int32_t const*>(inputs[1]), nRanks, getCommSessionRank() % nRanks, mCounter);
+        params.local_input_buffer_ptr = inputs[0];
+        params.local_output_buffer_ptr = outputs[0];
+        params.elts_total = size * nRanks;
+        kernels::customOneShotAllGather(params, mType, stream);
+        return 0;
+    }
+
     NCCLCHECK(ncclAllGather(
         inputs[0], outputs[0], size, (*getDtypeMap())[inputDesc[0].type], (*getCommMap())[mGroup], stream));
 
@@ -151,13 +214,15 @@ void AllgatherPlugin::terminate() noexcept
 
 size_t AllgatherPlugin::getSerializationSize() const noexcept
 {
-    return sizeof(int) * mGroup.size() + sizeof(mType);
+    return sizeof(int) * mGroup.size() + sizeof(mType) + sizeof(mStrategy) + sizeof(mCounter);
 }
 
 void AllgatherPlugin::serialize(void* buffer) const noexcept
 {
     char *d = static_cast<char*>(buffer), *a = d;
     write(d, mType);
+    write(d, mStrategy);
+    write(d, mCounter);
     for (auto it = mGroup.begin(); it != mGroup.end(); ++it)
     {
         write(d, *it);
@@ -179,6 +244,8 @@ AllgatherPluginCreator::AllgatherPluginCreator()
     mPluginAttributes.clear();
     mPluginAttributes.emplace_back(PluginField("group", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("type_id", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("strategy", nullptr, PluginFieldType::kINT8, 1));
+    mPluginAttributes.emplace_back(PluginField("counter", nullptr, PluginFieldType::kINT32, 1));
     mFC.nbFields = mPluginAttributes.size();
     mFC.fields = mPluginAttributes.data();
 }
@@ -203,6 +270,9 @@ IPluginV2* AllgatherPluginCreator::createPlugin(char const* name, PluginFieldCol
     PluginField const* fields = fc->fields;
     std::set<int> group;
     nvinfer1::DataType type;
+    // The strategy and counter are only given for the custom kernels
+    auto strategy = AllReduceStrategyType::NCCL;
+    int32_t counter{0};
     // Read configurations from each fields
     for (int i = 0; i < fc->nbFields; ++i)
     {
@@ -222,11 +292,21 @@ IPluginV2* AllgatherPluginCreator::createPlugin(char const* name, PluginFieldCol
             TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
             type = static_cast<nvinfer1::DataType>(*(static_cast<nvinfer1::DataType const*>(fields[i].data)));
         }
+        else if (!strcmp(attrName, "strategy"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT8);
+            strategy = static_cast<AllReduceStrategyType>(*static_cast<int8_t const*>(fields[i].data));
+        }
+        else if (!strcmp(attrName, "counter"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            counter = *static_cast<int32_t const*>(fields[i].data);
+        }
     }
 
     try
     {
-        auto* obj = new AllgatherPlugin(group, type);
+        auto* obj = new AllgatherPlugin(group, type, strategy, counter);
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
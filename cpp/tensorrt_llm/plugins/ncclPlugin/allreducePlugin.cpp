@@ -21,6 +21,10 @@
 #include "tensorrt_llm/common/mpiUtils.h"
 #include "tensorrt_llm/common/tensor.h"
 #include "tensorrt_llm/kernels/customAllReduceKernels.h"
+#include "tensorrt_llm/runtime/inProcessWorld.h"
+#include "tensorrt_llm/runtime/pluginTimer.h"
+#include <algorithm>
+#include <array>
 #include <nccl.h>
 #include <unordered_set>
 
@@ -30,12 +34,53 @@ using tensorrt_llm::plugins::AllreducePlugin;
 using tensorrt_llm::kernels::AllReduceFusionOp;
 using tensorrt_llm::kernels::AllReduceStrategyType;
 using tensorrt_llm::kernels::AllReduceStrategyConfig;
+using tensorrt_llm::kernels::AllReduceParams;
+using tensorrt_llm::runtime::PluginKind;
+using tensorrt_llm::runtime::PluginTimer;
 
 static char const* ALLREDUCE_PLUGIN_VERSION{"1"};
 static char const* ALLREDUCE_PLUGIN_NAME{"AllReduce"};
 PluginFieldCollection AllreducePluginCreator::mFC{};
 std::vector<nvinfer1::PluginField> AllreducePluginCreator::mPluginAttributes;
 
+namespace
+{
+// The hierarchical all reduce pipelines its stages over up to kMaxHierarchicalChunks chunks of the message
+constexpr size_t kMaxHierarchicalChunks = 4;
+constexpr size_t kMinHierarchicalChunkBytes = 256 * 1024;
+
+// Side stream of the inter-node all reduce and the events between the stages, shared by the plugins of a group
+struct HierarchicalStreams
+{
+    cudaStream_t stream;
+    std::array<cudaEvent_t, kMaxHierarchicalChunks> scattered;
+    std::array<cudaEvent_t, kMaxHierarchicalChunks> reduced;
+};
+
+std::map<std::set<int>, HierarchicalStreams>& getHierarchicalStreams()
+{
+    static std::map<std::set<int>, HierarchicalStreams> streams;
+    return streams;
+}
+
+bool isQuantizedFusion(AllReduceFusionOp op)
+{
+    return op == AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8
+        || op == AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_FP8;
+}
+
+// Type of the normed output, which feeds the next GEMM directly when quantized
+nvinfer1::DataType getNormOutputType(AllReduceFusionOp op, nvinfer1::DataType type)
+{
+    switch (op)
+    {
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8: return nvinfer1::DataType::kINT8;
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_FP8: return nvinfer1::DataType::kFP8;
+    default: return type;
+    }
+}
+} // namespace
+
 AllreducePlugin::AllreducePlugin(std::set<int> group, nvinfer1::DataType type, AllReduceStrategyType strategy,
     AllReduceStrategyConfig config, AllReduceFusionOp op, int32_t counter, float eps, int8_t affine, int8_t bias)
     : mGroup(std::move(group))
@@ -102,7 +147,7 @@ bool AllreducePlugin::supportsFormatCombination(
     int pos, nvinfer1::PluginTensorDesc const* inOut, int nbInputs, int nbOutputs) noexcept
 {
     int fusion_op_extra_inputs = 0;
-    if (mOp == AllReduceFusionOp::RESIDUAL_RMS_NORM)
+    if (mOp != AllReduceFusionOp::NONE)
     {
         ++fusion_op_extra_inputs;
         if (mAffine)
@@ -113,6 +158,10 @@ bool AllreducePlugin::supportsFormatCombination(
         {
             ++fusion_op_extra_inputs;
         }
+        if (isQuantizedFusion(mOp))
+        {
+            ++fusion_op_extra_inputs;
+        }
     }
     if (mStrategy == AllReduceStrategyType::NCCL)
     {
@@ -128,6 +177,15 @@ bool AllreducePlugin::supportsFormatCombination(
     {
         return (inOut[pos].type == nvinfer1::DataType::kINT64) && (inOut[pos].format == TensorFormat::kLINEAR);
     }
+    else if (isQuantizedFusion(mOp) && pos == nbInputs - 1)
+    {
+        // Per tensor quantization scale of the normed output
+        return (inOut[pos].type == nvinfer1::DataType::kFLOAT) && (inOut[pos].format == TensorFormat::kLINEAR);
+    }
+    else if (pos == nbInputs)
+    {
+        return (inOut[pos].type == getNormOutputType(mOp, mType)) && (inOut[pos].format == TensorFormat::kLINEAR);
+    }
     else
     {
         return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
@@ -150,17 +208,29 @@ AllReduceStrategyType AllreducePlugin::selectImplementation(
 {
     bool const isAuto = (mStrategy == AllReduceStrategyType::AUTO);
 
-    if (!mIsP2PSupported)
+    if (!mNodeGroup.empty())
     {
+        auto const nodeSize = static_cast<int>(mNodeGroup.size());
+        auto const maxWorkspaceSize = utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(nodeSize);
+        if ((isAuto || mStrategy == AllReduceStrategyType::HIERARCHICAL)
+            && messageSize * common::getDTypeSize(type) <= maxWorkspaceSize
+            && kernels::configurationSupported(AllReduceStrategyType::HIERARCHICAL, messageSize, nodeSize, type))
+        {
+            return AllReduceStrategyType::HIERARCHICAL;
+        }
         if (!isAuto)
         {
-            TLLM_LOG_WARNING("Since Peer to Peer not supported, fallback to AllReduceStrategy: NCCL");
+            TLLM_LOG_WARNING("Since the TP group spans nodes, fallback to AllReduceStrategy: NCCL");
         }
         return AllReduceStrategyType::NCCL;
     }
 
-    if (isAuto && !mIsNVLINKSupported)
+    if (!mIsP2PSupported)
     {
+        if (!isAuto)
+        {
+            TLLM_LOG_WARNING("Since Peer to Peer not supported, fallback to AllReduceStrategy: NCCL");
+        }
         return AllReduceStrategyType::NCCL;
     }
 
@@ -169,11 +239,45 @@ AllReduceStrategyType AllreducePlugin::selectImplementation(
     AllReduceStrategyType strat = AllReduceStrategyType::NCCL;
     auto const messageSizeBytes = messageSize * common::getDTypeSize(type);
 
+    // The switch reduces the messages that fit the multicast buffers, which the runtime sets up on request
+    auto const nvlsBuffers = kernels::getNvlsBuffers(worldSize);
+    bool const isNvlsSupported = nvlsBuffers && messageSizeBytes <= nvlsBuffers->size_bytes
+        && kernels::configurationSupported(AllReduceStrategyType::NVLS, messageSize, worldSize, type);
+    if (mStrategy == AllReduceStrategyType::NVLS && isNvlsSupported)
+    {
+        return AllReduceStrategyType::NVLS;
+    }
+
+    // Crossover points measured on this node at startup, also without NVLink
+    if (isAuto && messageSizeBytes <= maxWorkspaceSize)
+    {
+        if (auto const tuned = kernels::lookupAllReduceStrategy(worldSize, messageSizeBytes))
+        {
+            bool const supported = *tuned == AllReduceStrategyType::NCCL
+                || (*tuned == AllReduceStrategyType::NVLS
+                        ? isNvlsSupported
+                        : kernels::configurationSupported(*tuned, messageSize, worldSize, type));
+            return supported ? *tuned : AllReduceStrategyType::NCCL;
+        }
+    }
+
+    if (isAuto && !mIsNVLINKSupported)
+    {
+        return AllReduceStrategyType::NCCL;
+    }
+
     if (messageSizeBytes <= maxWorkspaceSize)
     {
         if (!isAuto)
         {
-            strat = mStrategy;
+            if (mStrategy == AllReduceStrategyType::NVLS)
+            {
+                TLLM_LOG_WARNING("Since the NVLS buffers are missing or small, fallback to AllReduceStrategy: TWOSHOT");
+            }
+            // Within a node, the hierarchical all reduce is the two shot one, as is the NVLS one without its buffers
+            bool const isTwoShot = mStrategy == AllReduceStrategyType::HIERARCHICAL
+                || mStrategy == AllReduceStrategyType::NVLS;
+            strat = isTwoShot ? AllReduceStrategyType::TWOSHOT : mStrategy;
         }
         else if (worldSize <= 2)
         {
@@ -202,6 +306,12 @@ AllReduceStrategyType AllreducePlugin::selectImplementation(
             }
         }
 
+        // The switch halves the traffic of the two shot all reduce, with the same barriers
+        if (isAuto && strat == AllReduceStrategyType::TWOSHOT && isNvlsSupported)
+        {
+            strat = AllReduceStrategyType::NVLS;
+        }
+
         if (!kernels::configurationSupported(strat, messageSize, worldSize, type))
         {
             if (!isAuto)
@@ -230,6 +340,7 @@ int AllreducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfe
     {
         return 0;
     }
+    auto const timingScope = PluginTimer::getInstance().scope(PluginKind::kALL_REDUCE, stream);
     size_t size = 1;
     for (int i = 0; i < inputDesc[0].dims.nbDims; ++i)
     {
@@ -266,15 +377,54 @@ int AllreducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfe
         TLLM_LOG_DEBUG("AllReducePlugin strategy: AllReduceStrategyType::TWOSHOT");
         break;
     }
+    case AllReduceStrategyType::HIERARCHICAL:
+    {
+        TLLM_LOG_DEBUG("AllReducePlugin strategy: AllReduceStrategyType::HIERARCHICAL");
+        break;
+    }
+    case AllReduceStrategyType::NVLS:
+    {
+        TLLM_LOG_DEBUG("AllReducePlugin strategy: AllReduceStrategyType::NVLS");
+        break;
+    }
     default: break;
     }
 
-    if (runtimeStrategy == AllReduceStrategyType::NCCL)
+    // The strategies that do not fuse the norm all reduce into the second output and norm it with residualRmsNorm
+    if (runtimeStrategy == AllReduceStrategyType::NCCL || runtimeStrategy == AllReduceStrategyType::HIERARCHICAL
+        || runtimeStrategy == AllReduceStrategyType::NVLS)
     {
-        if (mOp == AllReduceFusionOp::RESIDUAL_RMS_NORM)
+        auto const allReduce = [&](void* output)
+        {
+            if (runtimeStrategy == AllReduceStrategyType::HIERARCHICAL)
+            {
+                int const nRanks = inputDesc[1].dims.d[0] / utils::customAllReduceUtils::NUM_POINTERS_PER_RANK;
+                hierarchicalAllReduce(
+                    inputs[0], output, size, reinterpret_cast<int32_t const*>(inputs[1]), nRanks, stream);
+            }
+            else if (runtimeStrategy == AllReduceStrategyType::NVLS)
+            {
+                int const nRanks = inputDesc[1].dims.d[0] / utils::customAllReduceUtils::NUM_POINTERS_PER_RANK;
+                // The barrier flags of the workspace order the stages between the ranks
+                auto params = AllReduceParams::deserialize(
+                    reinterpret_cast<int32_t const*>(inputs[1]), nRanks, getCommSessionRank() % nRanks, mCounter);
+                auto const nvlsBuffers = kernels::getNvlsBuffers(nRanks);
+                params.local_input_buffer_ptr = inputs[0];
+                params.local_output_buffer_ptr = output;
+                params.elts_total = size;
+                params.nvls_unicast_ptr = nvlsBuffers->unicast_ptr;
+                params.nvls_multicast_ptr = nvlsBuffers->multicast_ptr;
+                kernels::customNvlsAllReduce(params, mType, stream);
+            }
+            else
+            {
+                NCCLCHECK(ncclAllReduce(
+                    inputs[0], output, size, (*getDtypeMap())[mType], ncclSum, (*getCommMap())[mGroup], stream));
+            }
+        };
+        if (mOp != AllReduceFusionOp::NONE)
         {
-            NCCLCHECK(ncclAllReduce(
-                inputs[0], outputs[1], size, (*getDtypeMap())[mType], ncclSum, (*getCommMap())[mGroup], stream));
+            allReduce(outputs[1]);
             tensorrt_llm::kernels::AllReduceParams params;
             int fusion_ptr_idx = 0;
             if (mStrategy == AllReduceStrategyType::NCCL)
@@ -288,22 +438,23 @@ int AllreducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfe
             params.fusion_params.bias_buffer = mBias ? inputs[fusion_ptr_idx++] : nullptr;
             params.fusion_params.residual_buffer = inputs[fusion_ptr_idx++];
             params.fusion_params.weight_buffer = mAffine ? inputs[fusion_ptr_idx++] : nullptr;
+            params.fusion_params.quant_scale
+                = isQuantizedFusion(mOp) ? static_cast<float const*>(inputs[fusion_ptr_idx++]) : nullptr;
             params.local_output_buffer_ptr = outputs[0];
             params.elts_total = size;
             params.fusion_params.hidden_size = inputDesc[0].dims.d[inputDesc[0].dims.nbDims - 1];
             params.fusion_params.eps = mEps;
             params.fusion_params.intermediate_buffer = outputs[1];
-            tensorrt_llm::kernels::residualRmsNorm(params, mType, stream);
+            tensorrt_llm::kernels::residualRmsNorm(params, mType, stream, mOp);
         }
         else
         {
-            NCCLCHECK(ncclAllReduce(
-                inputs[0], outputs[0], size, (*getDtypeMap())[mType], ncclSum, (*getCommMap())[mGroup], stream));
+            allReduce(outputs[0]);
         }
     }
     else
     {
-        auto myRank = COMM_SESSION.getRank();
+        auto myRank = getCommSessionRank();
         int nRanks = inputDesc[1].dims.d[0] / utils::customAllReduceUtils::NUM_POINTERS_PER_RANK;
         // FIXME: pass world config here
         myRank = myRank % nRanks;
@@ -314,12 +465,14 @@ int AllreducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfe
         params.local_output_buffer_ptr = outputs[0];
         params.local_input_buffer_ptr = inputs[0];
         params.elts_total = size;
-        if (mOp == AllReduceFusionOp::RESIDUAL_RMS_NORM)
+        if (mOp != AllReduceFusionOp::NONE)
         {
             int fusion_ptr_idx = 2;
             params.fusion_params.bias_buffer = mBias ? inputs[fusion_ptr_idx++] : nullptr;
             params.fusion_params.residual_buffer = inputs[fusion_ptr_idx++];
             params.fusion_params.weight_buffer = mAffine ? inputs[fusion_ptr_idx++] : nullptr;
+            params.fusion_params.quant_scale
+                = isQuantizedFusion(mOp) ? static_cast<float const*>(inputs[fusion_ptr_idx++]) : nullptr;
             params.fusion_params.hidden_size = inputDesc[0].dims.d[inputDesc[0].dims.nbDims - 1];
             params.fusion_params.eps = mEps;
             params.fusion_params.intermediate_buffer = outputs[1];
@@ -330,13 +483,73 @@ int AllreducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfe
     return 0;
 }
 
+void AllreducePlugin::hierarchicalAllReduce(
+    void const* input, void* output, size_t size, int32_t const* commPtrs, int nRanks, cudaStream_t stream)
+{
+    auto const nodeSize = mNodeGroup.size();
+    auto const nodeRank = std::distance(mNodeGroup.begin(), mNodeGroup.find(getCommSessionRank()));
+    auto const eltSize = common::getDTypeSize(mType);
+    auto const& streams = getHierarchicalStreams().at(mGroup);
+    auto* interNodeComm = (*getCommMap())[mInterNodeGroup];
+
+    // Each chunk is reduced within the node, across the nodes on the side stream, then gathered within the node,
+    // using its own part of the shareable buffers
+    auto numChunks = std::clamp<size_t>(size * eltSize / kMinHierarchicalChunkBytes, 1, kMaxHierarchicalChunks);
+    while (size % (numChunks * nodeSize * (16 / eltSize)) != 0)
+    {
+        --numChunks;
+    }
+    auto const chunkSize = size / numChunks;
+
+    // The stages use the barriers one after the other, their flags must differ from each other and from the
+    // counters used as flags by the other plugins
+    uint32_t const flagBase = static_cast<uint32_t>(mCounter + 1) << 16;
+    auto const nodeParams = AllReduceParams::deserializeNode(commPtrs, nRanks, nodeSize, nodeRank, mCounter);
+    std::array<AllReduceParams, kMaxHierarchicalChunks> chunkParams;
+    auto const allGather = [&](size_t chunk)
+    {
+        TLLM_CUDA_CHECK(cudaStreamWaitEvent(stream, streams.reduced[chunk]));
+        kernels::customAllGather(chunkParams[chunk], mType, stream);
+    };
+
+    for (size_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+        auto const offset = chunk * chunkSize * eltSize;
+        auto& params = chunkParams[chunk];
+        params = nodeParams;
+        for (size_t i = 0; i < nodeSize; ++i)
+        {
+            params.peer_comm_buffer_ptrs[i] = static_cast<char*>(nodeParams.peer_comm_buffer_ptrs[i]) + offset;
+        }
+        params.local_input_buffer_ptr = static_cast<char const*>(input) + offset;
+        params.local_output_buffer_ptr = static_cast<char*>(output) + offset;
+        params.elts_total = chunkSize;
+        params.barrier_flag = flagBase + chunk;
+        kernels::customReduceScatter(params, mType, stream);
+
+        TLLM_CUDA_CHECK(cudaEventRecord(streams.scattered[chunk], stream));
+        TLLM_CUDA_CHECK(cudaStreamWaitEvent(streams.stream, streams.scattered[chunk]));
+        auto* shard = static_cast<char*>(params.local_output_buffer_ptr) + params.rank_offset * eltSize;
+        NCCLCHECK(ncclAllReduce(shard, shard, params.elts_per_rank, (*getDtypeMap())[mType], ncclSum, interNodeComm,
+            streams.stream));
+        TLLM_CUDA_CHECK(cudaEventRecord(streams.reduced[chunk], streams.stream));
+
+        // The all gather of the previous chunk overlaps the inter-node all reduce of this one
+        if (chunk > 0)
+        {
+            allGather(chunk - 1);
+        }
+    }
+    allGather(numChunks - 1);
+}
+
 // IPluginV2Ext Methods
 nvinfer1::DataType AllreducePlugin::getOutputDataType(
     int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept
 {
-    int fusion_op_extra_output = (mOp == AllReduceFusionOp::RESIDUAL_RMS_NORM ? 1 : 0);
+    int fusion_op_extra_output = (mOp != AllReduceFusionOp::NONE ? 1 : 0);
     assert(index <= fusion_op_extra_output);
-    return inputTypes[0];
+    return index == 0 ? getNormOutputType(mOp, inputTypes[0]) : inputTypes[0];
 }
 
 // IPluginV2 Methods
@@ -353,7 +566,7 @@ char const* AllreducePlugin::getPluginVersion() const noexcept
 
 int AllreducePlugin::getNbOutputs() const noexcept
 {
-    return (mOp == AllReduceFusionOp::RESIDUAL_RMS_NORM ? 2 : 1);
+    return (mOp != AllReduceFusionOp::NONE ? 2 : 1);
 }
 
 bool AllreducePlugin::isCustomAllReduceSupported(int ranks_per_node) const noexcept
@@ -383,9 +596,25 @@ public:
     }
 };
 
-std::set<int> getLocalGroup(std::set<int> const& group)
+// Returns the devices of the ranks of the group on this node, and their ranks in nodeGroup if not null
+std::set<int> getLocalGroup(std::set<int> const& group, std::set<int>* nodeGroup = nullptr)
 {
-    auto const myRank = COMM_SESSION.getRank();
+    if (auto const* world = tensorrt_llm::runtime::InProcessWorld::current())
+    {
+        // All ranks of the world are on this node
+        std::set<int> localGroup;
+        for (auto const rank : group)
+        {
+            localGroup.insert(world->getWorldConfig(rank).getDevice());
+        }
+        if (nodeGroup != nullptr)
+        {
+            *nodeGroup = group;
+        }
+        return localGroup;
+    }
+
+    auto const myRank = getCommSessionRank();
     auto const myLocalRank = LOCAL_COMM_SESSION.getRank();
     auto const localSize = LOCAL_COMM_SESSION.getSize();
 
@@ -443,6 +672,10 @@ std::set<int> getLocalGroup(std::set<int> const& group)
         if (group.find(rank) != group.end())
         {
             localGroup.insert(localRanks[i]);
+            if (nodeGroup != nullptr)
+            {
+                nodeGroup->insert(rank);
+            }
         }
     }
     return localGroup;
@@ -450,28 +683,32 @@ std::set<int> getLocalGroup(std::set<int> const& group)
 
 void AllreducePlugin::initGroupTopology() noexcept
 {
-    static std::map<std::set<int>, std::tuple<bool, bool>> cache;
+    static std::map<std::set<int>, std::tuple<bool, bool, std::set<int>, std::set<int>>> cache;
     if (cache.find(mGroup) != cache.end())
     {
-        auto [isNVLINKSupported, isP2PSupported] = cache[mGroup];
+        auto [isNVLINKSupported, isP2PSupported, nodeGroup, interNodeGroup] = cache[mGroup];
         mIsNVLINKSupported = isNVLINKSupported;
         mIsP2PSupported = isP2PSupported;
+        mNodeGroup = nodeGroup;
+        mInterNodeGroup = interNodeGroup;
         return;
     }
     setGroupTopology();
-    cache[mGroup] = {mIsNVLINKSupported, mIsP2PSupported};
+    cache[mGroup] = {mIsNVLINKSupported, mIsP2PSupported, mNodeGroup, mInterNodeGroup};
 }
 
 void AllreducePlugin::setGroupTopology() noexcept
 {
-    auto const rank = COMM_SESSION.getRank();
+    auto const rank = getCommSessionRank();
     TLLM_LOG_INFO("Detecting local TP group for rank %d", rank);
-    std::set<int> localGroup = getLocalGroup(mGroup);
+    std::set<int> nodeGroup;
+    std::set<int> localGroup = getLocalGroup(mGroup, &nodeGroup);
     if (mGroup.size() != localGroup.size())
     {
         mIsP2PSupported = false;
         mIsNVLINKSupported = false;
         TLLM_LOG_INFO("Found inter-node TP group for rank %d", rank);
+        initHierarchicalTopology(nodeGroup, localGroup);
         return;
     }
     TLLM_LOG_INFO("TP group is intra-node for rank %d", rank);
@@ -571,6 +808,49 @@ void AllreducePlugin::setGroupTopology() noexcept
     }
 }
 
+void AllreducePlugin::initHierarchicalTopology(std::set<int> const& nodeGroup, std::set<int> const& localGroup) noexcept
+{
+    // The hierarchical all reduce pairs the ranks at the same place of consecutive, equally sized blocks of the
+    // group, one block per node, as the runtime places the TP ranks. All nodes are expected to be alike.
+    mNodeGroup.clear();
+    mInterNodeGroup.clear();
+    auto const nodeSize = static_cast<int>(nodeGroup.size());
+    if (!isCustomAllReduceSupported(nodeSize) || mGroup.size() % nodeSize != 0)
+    {
+        return;
+    }
+    std::vector<int> const ranks(mGroup.begin(), mGroup.end());
+    auto const nodeStart = std::find(ranks.begin(), ranks.end(), *nodeGroup.begin()) - ranks.begin();
+    if (nodeStart % nodeSize != 0 || !std::equal(nodeGroup.begin(), nodeGroup.end(), ranks.begin() + nodeStart))
+    {
+        return;
+    }
+    for (int firstDeviceId : localGroup)
+    {
+        for (int secondDeviceId : localGroup)
+        {
+            int canAccessPeer = 1;
+            if (firstDeviceId != secondDeviceId)
+            {
+                TLLM_CUDA_CHECK(cudaDeviceCanAccessPeer(&canAccessPeer, firstDeviceId, secondDeviceId));
+            }
+            if (!canAccessPeer)
+            {
+                return;
+            }
+        }
+    }
+
+    auto const nodeRank = std::distance(nodeGroup.begin(), nodeGroup.find(getCommSessionRank()));
+    for (size_t i = nodeRank; i < ranks.size(); i += nodeSize)
+    {
+        mInterNodeGroup.insert(ranks[i]);
+    }
+    mNodeGroup = nodeGroup;
+    TLLM_LOG_INFO("Hierarchical all reduce over %d nodes of %d ranks for rank %d",
+        static_cast<int>(mInterNodeGroup.size()), nodeSize, getCommSessionRank());
+}
+
 int AllreducePlugin::initialize() noexcept
 {
     if (isBuilding())
@@ -583,13 +863,50 @@ int AllreducePlugin::initialize() noexcept
     {
         initGroupTopology();
     }
+    if (!mInterNodeGroup.empty())
+    {
+        initCommMap(mInterNodeGroup);
+        auto& streams = getHierarchicalStreams();
+        if (streams.find(mGroup) == streams.end())
+        {
+            HierarchicalStreams groupStreams;
+            TLLM_CUDA_CHECK(cudaStreamCreateWithFlags(&groupStreams.stream, cudaStreamNonBlocking));
+            for (size_t chunk = 0; chunk < kMaxHierarchicalChunks; ++chunk)
+            {
+                TLLM_CUDA_CHECK(cudaEventCreateWithFlags(&groupStreams.scattered[chunk], cudaEventDisableTiming));
+                TLLM_CUDA_CHECK(cudaEventCreateWithFlags(&groupStreams.reduced[chunk], cudaEventDisableTiming));
+            }
+            streams[mGroup] = groupStreams;
+        }
+    }
 
     return 0;
 }
 
 void AllreducePlugin::terminate() noexcept
 {
-    if (mStrategy == AllReduceStrategyType::NCCL || mStrategy == AllReduceStrategyType::AUTO)
+    if (!mInterNodeGroup.empty() && !isBuilding())
+    {
+        auto* commMap = getCommMap();
+        if ((*commMap)[mInterNodeGroup] != nullptr)
+        {
+            NCCLCHECK(ncclCommDestroy((*commMap)[mInterNodeGroup]));
+            (*commMap)[mInterNodeGroup] = nullptr;
+        }
+        auto& streams = getHierarchicalStreams();
+        if (auto it = streams.find(mGroup); it != streams.end())
+        {
+            for (size_t chunk = 0; chunk < kMaxHierarchicalChunks; ++chunk)
+            {
+                TLLM_CUDA_CHECK(cudaEventDestroy(it->second.scattered[chunk]));
+                TLLM_CUDA_CHECK(cudaEventDestroy(it->second.reduced[chunk]));
+            }
+            TLLM_CUDA_CHECK(cudaStreamDestroy(it->second.stream));
+            streams.erase(it);
+        }
+    }
+    if (mStrategy == AllReduceStrategyType::NCCL || mStrategy == AllReduceStrategyType::AUTO
+        || mStrategy == AllReduceStrategyType::HIERARCHICAL || mStrategy == AllReduceStrategyType::NVLS)
     {
         auto* commMap = getCommMap();
         // [] operator inserts T() if it does not exist
@@ -71,14 +71,21 @@ private:
     bool isCustomAllReduceSupported(int ranks_per_node) const noexcept;
     void initGroupTopology() noexcept;
     void setGroupTopology() noexcept;
+    void initHierarchicalTopology(std::set<int> const& nodeGroup, std::set<int> const& localGroup) noexcept;
     kernels::AllReduceStrategyType selectImplementation(
         size_t messageSize, int worldSize, nvinfer1::DataType type) noexcept;
+    void hierarchicalAllReduce(void const* input, void* output, size_t size, int32_t const* commPtrs, int nRanks,
+        cudaStream_t stream);
 
 private:
     std::string const mLayerName;
     std::set<int> mGroup;
     bool mIsNVLINKSupported;
     bool mIsP2PSupported;
+    // Ranks of the group on this node and on the other nodes at the same place, when the group spans nodes and
+    // supports the hierarchical all reduce
+    std::set<int> mNodeGroup;
+    std::set<int> mInterNodeGroup;
     nvinfer1::DataType mType;
     kernels::AllReduceStrategyType mStrategy;
     kernels::AllReduceStrategyConfig mConfig;
@@ -0,0 +1,533 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2022 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "gemmAllReducePlugin.h"
+
+#include "tensorrt_llm/common/customAllReduceUtils.h"
+#include "tensorrt_llm/common/dataType.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/plugins/common/pluginUtils.h"
+#include <algorithm>
+#include <array>
+#include <nccl.h>
+
+using namespace nvinfer1;
+using tensorrt_llm::plugins::GemmAllReducePluginCreator;
+using tensorrt_llm::plugins::GemmAllReducePlugin;
+using tensorrt_llm::kernels::AllReduceFusionOp;
+using tensorrt_llm::kernels::AllReduceStrategyType;
+using tensorrt_llm::kernels::AllReduceStrategyConfig;
+using tensorrt_llm::kernels::AllReduceParams;
+
+static char const* GEMM_ALLREDUCE_PLUGIN_VERSION{"1"};
+static char const* GEMM_ALLREDUCE_PLUGIN_NAME{"GemmAllReduce"};
+PluginFieldCollection GemmAllReducePluginCreator::mFC{};
+std::vector<nvinfer1::PluginField> GemmAllReducePluginCreator::mPluginAttributes;
+
+namespace
+{
+// The output rows are split in up to kMaxChunks chunks of at least kMinChunkBytes
+constexpr size_t kMaxChunks = 4;
+constexpr size_t kMinChunkBytes = 256 * 1024;
+
+// Side stream of the all reduces and the events between the GEMM and the all reduce of every chunk, shared by the
+// plugins of a group
+struct OverlapStreams
+{
+    cudaStream_t stream;
+    std::array<cudaEvent_t, kMaxChunks> computed;
+    cudaEvent_t reduced;
+};
+
+std::map<std::set<int>, OverlapStreams>& getOverlapStreams()
+{
+    static std::map<std::set<int>, OverlapStreams> streams;
+    return streams;
+}
+} // namespace
+
+GemmAllReducePlugin::GemmAllReducePlugin(std::set<int> group, nvinfer1::DataType type, int transB,
+    AllReduceStrategyType strategy, int32_t counter, int32_t numChunks)
+    : mGroup(std::move(group))
+    , mType(type)
+    , mTransB(transB)
+    , mStrategy(strategy)
+    , mCounter(counter)
+    , mNumChunks(numChunks)
+{
+    TLLM_CHECK_WITH_INFO(mNumChunks >= 0 && mNumChunks <= static_cast<int32_t>(kMaxChunks),
+        "GemmAllReduce supports up to %d chunks, got %d.", static_cast<int>(kMaxChunks), mNumChunks);
+    TLLM_CHECK_WITH_INFO(mStrategy == AllReduceStrategyType::NCCL || mStrategy == AllReduceStrategyType::ONESHOT
+            || mStrategy == AllReduceStrategyType::TWOSHOT || mStrategy == AllReduceStrategyType::AUTO,
+        "GemmAllReduce supports the NCCL, ONESHOT, TWOSHOT and AUTO strategies.");
+    if (std::getenv("FORCE_NCCL_ALL_REDUCE_STRATEGY") != nullptr)
+    {
+        mStrategy = AllReduceStrategyType::NCCL;
+    }
+}
+
+// Parameterized constructor
+GemmAllReducePlugin::GemmAllReducePlugin(void const* data, size_t length)
+{
+    char const *d = reinterpret_cast<char const*>(data), *a = d;
+    read(d, mType);
+    read(d, mTransB);
+    read(d, mStrategy);
+    if (std::getenv("FORCE_NCCL_ALL_REDUCE_STRATEGY") != nullptr)
+    {
+        mStrategy = AllReduceStrategyType::NCCL;
+    }
+    read(d, mCounter);
+    read(d, mNumChunks);
+    mGroup.clear();
+    int groupItem = 0;
+    while (d != a + length)
+    {
+        read(d, groupItem);
+        mGroup.insert(groupItem);
+    }
+    TLLM_CHECK_WITH_INFO(d == a + length,
+        "Expected length (%d) != real length (%d). This is often "
+        "caused by using different TensorRT-LLM version to build "
+        "engine and run engine.",
+        (int) length, (int) (d - a));
+}
+
+// IPluginV2DynamicExt Methods
+nvinfer1::IPluginV2DynamicExt* GemmAllReducePlugin::clone() const noexcept
+{
+    auto* plugin = new GemmAllReducePlugin(*this);
+    plugin->setPluginNamespace(mNamespace.c_str());
+    return plugin;
+}
+
+nvinfer1::DimsExprs GemmAllReducePlugin::getOutputDimensions(
+    int outputIndex, nvinfer1::DimsExprs const* inputs, int nbInputs, nvinfer1::IExprBuilder& exprBuilder) noexcept
+{
+    try
+    {
+        TLLM_CHECK(outputIndex == 0);
+        TLLM_CHECK(inputs[1].nbDims == 2);
+        DimsExprs ret = inputs[0];
+        ret.d[ret.nbDims - 1] = mTransB ? inputs[1].d[0] : inputs[1].d[1];
+        return ret;
+    }
+    catch (std::exception const& e)
+    {
+        caughtError(e);
+    }
+    return DimsExprs{};
+}
+
+bool GemmAllReducePlugin::supportsFormatCombination(
+    int pos, nvinfer1::PluginTensorDesc const* inOut, int nbInputs, int nbOutputs) noexcept
+{
+    if (mStrategy == AllReduceStrategyType::NCCL)
+    {
+        TLLM_CHECK_WITH_INFO(nbInputs == 2, "NCCL strategy only accepts the activation and the weight.");
+    }
+    else
+    {
+        TLLM_CHECK_WITH_INFO(nbInputs == 3, "Non-NCCL strategies require a workspace tensor.");
+    }
+
+    if (mStrategy != AllReduceStrategyType::NCCL && pos == 2)
+    {
+        return (inOut[pos].type == nvinfer1::DataType::kINT64) && (inOut[pos].format == TensorFormat::kLINEAR);
+    }
+    return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
+}
+
+void GemmAllReducePlugin::configurePlugin(nvinfer1::DynamicPluginTensorDesc const* in, int nbInputs,
+    nvinfer1::DynamicPluginTensorDesc const* out, int nbOutputs) noexcept
+{
+}
+
+size_t GemmAllReducePlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc const* inputs, int nbInputs,
+    nvinfer1::PluginTensorDesc const* outputs, int nbOutputs) const noexcept
+{
+    return CUBLAS_WORKSPACE_SIZE;
+}
+
+void GemmAllReducePlugin::setGemmConfig()
+{
+    if (mType == nvinfer1::DataType::kHALF)
+    {
+        mCublasWrapper->setFP16GemmConfig();
+    }
+    else if (mType == nvinfer1::DataType::kFLOAT)
+    {
+        mCublasWrapper->setFP32GemmConfig();
+    }
+#ifdef ENABLE_BF16
+    else if (mType == nvinfer1::DataType::kBF16)
+    {
+        mCublasWrapper->setBF16GemmConfig();
+    }
+#endif
+}
+
+size_t GemmAllReducePlugin::getNumChunks(int64_t m, size_t rowBytes) const noexcept
+{
+    auto numChunks = mNumChunks > 0 ? static_cast<size_t>(mNumChunks)
+                                    : std::clamp<size_t>(m * rowBytes / kMinChunkBytes, 1, kMaxChunks);
+    return std::min<size_t>(numChunks, std::max<int64_t>(m, 1));
+}
+
+AllReduceStrategyType GemmAllReducePlugin::selectChunkStrategy(size_t chunkSize, bool customSupported) const noexcept
+{
+    auto const worldSize = mGroup.size();
+    auto const messageSizeBytes = chunkSize * common::getDTypeSize(mType);
+    if (!customSupported || mStrategy == AllReduceStrategyType::NCCL
+        || messageSizeBytes > utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(worldSize))
+    {
+        return AllReduceStrategyType::NCCL;
+    }
+
+    auto strat = mStrategy;
+    if (mStrategy == AllReduceStrategyType::AUTO)
+    {
+        if (auto const tuned = kernels::lookupAllReduceStrategy(worldSize, messageSizeBytes))
+        {
+            // The chunks are reduced in the IPC buffers, the nearest to the NVLS all reduce is the two shot one
+            strat = *tuned == AllReduceStrategyType::NVLS ? AllReduceStrategyType::TWOSHOT : *tuned;
+        }
+        else if (worldSize <= 2 || messageSizeBytes < (worldSize <= 4 ? 1000 * 1000 : 500 * 1000))
+        {
+            strat = AllReduceStrategyType::ONESHOT;
+        }
+        else
+        {
+            strat = AllReduceStrategyType::TWOSHOT;
+        }
+    }
+    if (strat != AllReduceStrategyType::NCCL && !kernels::configurationSupported(strat, chunkSize, worldSize, mType))
+    {
+        return AllReduceStrategyType::NCCL;
+    }
+    return strat;
+}
+
+int GemmAllReducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
+    nvinfer1::PluginTensorDesc const* outputDesc, void const* const* inputs, void* const* outputs, void* workspace,
+    cudaStream_t stream) noexcept
+{
+    if (isBuilding())
+    {
+        return 0;
+    }
+    auto const m = utils::computeMDimension(false, inputDesc[0].dims);
+    auto const k = static_cast<int>(inputDesc[0].dims.d[inputDesc[0].dims.nbDims - 1]);
+    auto const n = static_cast<int>(mTransB ? inputDesc[1].dims.d[0] : inputDesc[1].dims.d[1]);
+    if (m == 0 || n == 0)
+    {
+        return 0;
+    }
+    auto const eltSize = common::getDTypeSize(mType);
+    auto const nRanks = mGroup.size();
+    auto const& streams = getOverlapStreams().at(mGroup);
+
+    // The custom all reduce needs the buffers of all ranks, they are only mapped for the ranks of this node. The
+    // chunks use disjoint parts of the buffers, so that a rank never overwrites a chunk still read by its peers.
+    bool customSupported = false;
+    AllReduceParams groupParams;
+    if (mStrategy != AllReduceStrategyType::NCCL && nRanks <= kernels::MAX_RANKS_PER_NODE
+        && m * n * eltSize <= utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(nRanks))
+    {
+        auto const* commPtrs = reinterpret_cast<int32_t const*>(inputs[2]);
+        auto const* ptrs = reinterpret_cast<int64_t const*>(commPtrs);
+        customSupported = std::all_of(ptrs, ptrs + nRanks * utils::customAllReduceUtils::NUM_POINTERS_PER_RANK,
+            [](int64_t ptr) { return ptr != 0; });
+        if (customSupported)
+        {
+            auto const myRank = getCommSessionRank() % nRanks;
+            groupParams = AllReduceParams::deserialize(commPtrs, nRanks, myRank, mCounter);
+        }
+    }
+
+    mCublasWrapper->setStream(stream);
+    mCublasWrapper->setWorkspace(workspace);
+    setGemmConfig();
+    auto const transa = mTransB ? CUBLAS_OP_T : CUBLAS_OP_N;
+    auto const lda = mTransB ? k : n;
+
+    auto const numChunks = getNumChunks(m, n * eltSize);
+    auto const chunkRows = (m + numChunks - 1) / numChunks;
+    // Every chunk uses its own barrier flags, they must differ from the counters used as flags by the other plugins
+    uint32_t const flagBase = static_cast<uint32_t>(mCounter + 1) << 16;
+    for (size_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+        auto const rowBegin = static_cast<int64_t>(chunk) * chunkRows;
+        auto const rows = static_cast<int>(std::min<int64_t>(chunkRows, m - rowBegin));
+        if (rows <= 0)
+        {
+            break;
+        }
+        auto const* act = static_cast<char const*>(inputs[0]) + rowBegin * k * eltSize;
+        auto* output = static_cast<char*>(outputs[0]) + rowBegin * n * eltSize;
+
+        mCublasWrapper->createDescriptors(transa, CUBLAS_OP_N, n, rows, k, lda, k, n);
+        mCublasWrapper->Gemm(transa, CUBLAS_OP_N, n, rows, k, inputs[1], lda, act, k, output, n);
+        mCublasWrapper->destroyDescriptors();
+
+        // The all reduce of this chunk overlaps the GEMM of the next one
+        TLLM_CUDA_CHECK(cudaEventRecord(streams.computed[chunk], stream));
+        TLLM_CUDA_CHECK(cudaStreamWaitEvent(streams.stream, streams.computed[chunk]));
+        size_t const chunkSize = static_cast<size_t>(rows) * n;
+        auto const strategy = selectChunkStrategy(chunkSize, customSupported);
+        if (strategy == AllReduceStrategyType::NCCL)
+        {
+            NCCLCHECK(ncclAllReduce(output, output, chunkSize, (*getDtypeMap())[mType], ncclSum,
+                (*getCommMap())[mGroup], streams.stream));
+        }
+        else
+        {
+            auto params = groupParams;
+            auto const offset = rowBegin * n * eltSize;
+            for (size_t i = 0; i < nRanks; ++i)
+            {
+                params.peer_comm_buffer_ptrs[i] = static_cast<char*>(groupParams.peer_comm_buffer_ptrs[i]) + offset;
+            }
+            params.local_input_buffer_ptr = output;
+            params.local_output_buffer_ptr = output;
+            params.elts_total = chunkSize;
+            params.barrier_flag = flagBase + chunk;
+            kernels::customAllReduce(params, mType, strategy, static_cast<AllReduceStrategyConfig>(0),
+                AllReduceFusionOp::NONE, streams.stream);
+        }
+    }
+    TLLM_CUDA_CHECK(cudaEventRecord(streams.reduced, streams.stream));
+    TLLM_CUDA_CHECK(cudaStreamWaitEvent(stream, streams.reduced));
+
+    return 0;
+}
+
+// IPluginV2Ext Methods
+nvinfer1::DataType GemmAllReducePlugin::getOutputDataType(
+    int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept
+{
+    assert(index == 0);
+    return inputTypes[0];
+}
+
+// IPluginV2 Methods
+
+char const* GemmAllReducePlugin::getPluginType() const noexcept
+{
+    return GEMM_ALLREDUCE_PLUGIN_NAME;
+}
+
+char const* GemmAllReducePlugin::getPluginVersion() const noexcept
+{
+    return GEMM_ALLREDUCE_PLUGIN_VERSION;
+}
+
+int GemmAllReducePlugin::getNbOutputs() const noexcept
+{
+    return 1;
+}
+
+int GemmAllReducePlugin::initialize() noexcept
+{
+    if (isBuilding())
+    {
+        return 0;
+    }
+
+    mCublasWrapper
+        = std::make_shared<common::CublasMMWrapper>(getCublasHandle(), getCublasLtHandle(), nullptr, nullptr);
+    initCommMap(mGroup);
+    auto& streams = getOverlapStreams();
+    if (streams.find(mGroup) == streams.end())
+    {
+        OverlapStreams groupStreams;
+        TLLM_CUDA_CHECK(cudaStreamCreateWithFlags(&groupStreams.stream, cudaStreamNonBlocking));
+        for (size_t chunk = 0; chunk < kMaxChunks; ++chunk)
+        {
+            TLLM_CUDA_CHECK(cudaEventCreateWithFlags(&groupStreams.computed[chunk], cudaEventDisableTiming));
+        }
+        TLLM_CUDA_CHECK(cudaEventCreateWithFlags(&groupStreams.reduced, cudaEventDisableTiming));
+        streams[mGroup] = groupStreams;
+    }
+
+    return 0;
+}
+
+void GemmAllReducePlugin::terminate() noexcept
+{
+    if (isBuilding())
+    {
+        return;
+    }
+    auto& streams = getOverlapStreams();
+    if (auto it = streams.find(mGroup); it != streams.end())
+    {
+        for (size_t chunk = 0; chunk < kMaxChunks; ++chunk)
+        {
+            TLLM_CUDA_CHECK(cudaEventDestroy(it->second.computed[chunk]));
+        }
+        TLLM_CUDA_CHECK(cudaEventDestroy(it->second.reduced));
+        TLLM_CUDA_CHECK(cudaStreamDestroy(it->second.stream));
+        streams.erase(it);
+    }
+    auto* commMap = getCommMap();
+    // [] operator inserts T() if it does not exist
+    if ((*commMap)[mGroup] == nullptr)
+    {
+        return;
+    }
+    NCCLCHECK(ncclCommDestroy((*commMap)[mGroup]));
+    (*commMap)[mGroup] = nullptr;
+}
+
+size_t GemmAllReducePlugin::getSerializationSize() const noexcept
+{
+    return sizeof(int) * mGroup.size() + sizeof(mType) + sizeof(mTransB) + sizeof(mStrategy) + sizeof(mCounter)
+        + sizeof(mNumChunks);
+}
+
+void GemmAllReducePlugin::serialize(void* buffer) const noexcept
+{
+    char *d = static_cast<char*>(buffer), *a = d;
+    write(d, mType);
+    write(d, mTransB);
+    write(d, mStrategy);
+    write(d, mCounter);
+    write(d, mNumChunks);
+    for (auto it = mGroup.begin(); it != mGroup.end(); ++it)
+    {
+        write(d, *it);
+    }
+    assert(d == a + getSerializationSize());
+}
+
+void GemmAllReducePlugin::destroy() noexcept
+{
+    // This gets called when the network containing plugin is destroyed
+    delete this;
+}
+
+///////////////
+
+GemmAllReducePluginCreator::GemmAllReducePluginCreator()
+{
+    // Fill PluginFieldCollection with PluginField arguments metadata
+    mPluginAttributes.clear();
+    mPluginAttributes.emplace_back(PluginField("group", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("type_id", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("transb", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("strategy", nullptr, PluginFieldType::kINT8, 1));
+    mPluginAttributes.emplace_back(PluginField("counter", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("num_chunks", nullptr, PluginFieldType::kINT32, 1));
+    mFC.nbFields = mPluginAttributes.size();
+    mFC.fields = mPluginAttributes.data();
+}
+
+char const* GemmAllReducePluginCreator::getPluginName() const noexcept
+{
+    return GEMM_ALLREDUCE_PLUGIN_NAME;
+}
+
+char const* GemmAllReducePluginCreator::getPluginVersion() const noexcept
+{
+    return GEMM_ALLREDUCE_PLUGIN_VERSION;
+}
+
+PluginFieldCollection const* GemmAllReducePluginCreator::getFieldNames() noexcept
+{
+    return &mFC;
+}
+
+IPluginV2* GemmAllReducePluginCreator::createPlugin(char const* name, PluginFieldCollection const* fc) noexcept
+{
+    PluginField const* fields = fc->fields;
+    std::set<int> group;
+    nvinfer1::DataType type;
+    int transB{1};
+    AllReduceStrategyType strategy{AllReduceStrategyType::AUTO};
+    int32_t counter{0};
+    int32_t numChunks{0};
+    // Read configurations from each fields
+    for (int i = 0; i < fc->nbFields; ++i)
+    {
+        char const* attrName = fields[i].name;
+        if (!strcmp(attrName, "group"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            auto const* r = static_cast<int const*>(fields[i].data);
+            for (int j = 0; j < fields[i].length; ++j)
+            {
+                group.insert(*r);
+                ++r;
+            }
+        }
+        else if (!strcmp(attrName, "type_id"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            type = static_cast<nvinfer1::DataType>(*(static_cast<nvinfer1::DataType const*>(fields[i].data)));
+        }
+        else if (!strcmp(attrName, "transb"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            transB = *static_cast<int const*>(fields[i].data);
+        }
+        else if (!strcmp(attrName, "strategy"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT8);
+            strategy = static_cast<AllReduceStrategyType>(*static_cast<int8_t const*>(fields[i].data));
+        }
+        else if (!strcmp(attrName, "counter"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            counter = *static_cast<int32_t const*>(fields[i].data);
+        }
+        else if (!strcmp(attrName, "num_chunks"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            numChunks = *static_cast<int32_t const*>(fields[i].data);
+        }
+    }
+
+    try
+    {
+        auto* obj = new GemmAllReducePlugin(group, type, transB, strategy, counter, numChunks);
+        obj->setPluginNamespace(mNamespace.c_str());
+        return obj;
+    }
+    catch (std::exception const& e)
+    {
+        caughtError(e);
+    }
+    return nullptr;
+}
+
+IPluginV2* GemmAllReducePluginCreator::deserializePlugin(
+    char const* name, void const* serialData, size_t serialLength) noexcept
+{
+    // This object will be deleted when the network is destroyed, which will
+    // call GemmAllReducePlugin::destroy()
+    try
+    {
+        auto* obj = new GemmAllReducePlugin(serialData, serialLength);
+        obj->setPluginNamespace(mNamespace.c_str());
+        return obj;
+    }
+    catch (std::exception const& e)
+    {
+        caughtError(e);
+    }
+    return nullptr;
+}
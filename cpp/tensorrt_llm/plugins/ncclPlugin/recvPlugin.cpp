@@ -16,6 +16,7 @@
  */
 #include "recvPlugin.h"
 
+#include "tensorrt_llm/common/dataType.h"
 #include "tensorrt_llm/common/mpiUtils.h"
 
 #include <nccl.h>
@@ -91,6 +92,9 @@ int RecvPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::P
     {
         size *= inputDesc[0].dims.d[i];
     }
+    // The activations of the engine live at the same addresses across enqueues, they are registered on first use
+    auto const bytes = size * tensorrt_llm::common::getDTypeSize(inputDesc[0].type);
+    registerNcclBuffer(mComm, outputs[0], bytes, stream);
     NCCLCHECK(ncclRecv(outputs[0], size, (*getDtypeMap())[inputDesc[0].type], 0, mComm, stream));
 
     return 0;
@@ -139,6 +143,7 @@ void RecvPlugin::terminate() noexcept
     {
         return;
     }
+    deregisterNcclBuffers(mComm);
     NCCLCHECK(ncclCommDestroy(mComm));
 }
 
@@ -16,6 +16,7 @@
  */
 #pragma once
 
+#include "tensorrt_llm/kernels/customAllReduceKernels.h"
 #include "tensorrt_llm/plugins/common/plugin.h"
 #include <set>
 #include <string>
@@ -27,7 +28,8 @@ namespace tensorrt_llm::plugins
 class ReduceScatterPlugin : public BasePlugin
 {
 public:
-    ReduceScatterPlugin(std::set<int> group, nvinfer1::DataType type);
+    ReduceScatterPlugin(std::set<int> group, nvinfer1::DataType type,
+        kernels::AllReduceStrategyType strategy = kernels::AllReduceStrategyType::NCCL, int32_t counter = 0);
 
     ReduceScatterPlugin(void const* data, size_t length);
 
@@ -61,9 +63,16 @@ public:
     void destroy() noexcept override;
 
 private:
+    //! @brief ONESHOT if the custom kernels apply to the whole message of messageSize elements, NCCL otherwise.
+    kernels::AllReduceStrategyType selectStrategy(size_t messageSize, void const* const* inputs) const noexcept;
+
     const std::string mLayerName;
     std::set<int> mGroup;
     nvinfer1::DataType mType;
+    // NCCL, ONESHOT or AUTO, the custom kernels need the workspace of the custom all reduce as second input
+    kernels::AllReduceStrategyType mStrategy;
+    // Barrier flag of the custom kernels, numbered with the counters of the all reduce plugins
+    int32_t mCounter;
 };
 
 class ReduceScatterPluginCreator : public BaseCreator
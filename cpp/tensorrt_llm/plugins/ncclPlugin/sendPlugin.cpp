@@ -16,6 +16,7 @@
  */
 #include "sendPlugin.h"
 
+#include "tensorrt_llm/common/dataType.h"
 #include "tensorrt_llm/common/mpiUtils.h"
 
 #include <cassert>
@@ -93,6 +94,9 @@ int SendPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::P
         size *= inputDesc[0].dims.d[i];
     }
 
+    // The activations of the engine live at the same addresses across enqueues, they are registered on first use
+    auto const bytes = size * tensorrt_llm::common::getDTypeSize(inputDesc[0].type);
+    registerNcclBuffer(mComm, const_cast<void*>(inputs[0]), bytes, stream);
     NCCLCHECK(ncclSend(inputs[0], size, (*getDtypeMap())[inputDesc[0].type], 1, mComm, stream));
     return 0;
 }
@@ -142,6 +146,7 @@ void SendPlugin::terminate() noexcept
     {
         return;
     }
+    deregisterNcclBuffers(mComm);
     NCCLCHECK(ncclCommDestroy(mComm));
 }
 
@@ -29,11 +29,37 @@ static char const* RMSNORM_QUANTIZATION_PLUGIN_NAME{"RmsnormQuantization"};
 PluginFieldCollection RmsnormQuantizationPluginCreator::mFC{};
 std::vector<nvinfer1::PluginField> RmsnormQuantizationPluginCreator::mPluginAttributes;
 
-RmsnormQuantizationPlugin::RmsnormQuantizationPlugin(float eps, bool dynamicActivationScaling, nvinfer1::DataType type)
+namespace
+{
+template <typename T>
+void invokeRmsnormQuantization(nvinfer1::DataType outputType, void* output, T const* input, T const* weight,
+    T const* bias, float eps, int m, int n, float const* scale, float* dynamicScale, void const* residual,
+    void* residualOut, cudaStream_t stream)
+{
+#ifdef ENABLE_FP8
+    if (outputType == DataType::kFP8)
+    {
+        invokeGeneralRmsNorm((T*) nullptr, input, weight, bias, eps, m, n, stream, scale, dynamicScale,
+            reinterpret_cast<__nv_fp8_e4m3*>(output), reinterpret_cast<T const*>(residual),
+            reinterpret_cast<T*>(residualOut));
+        return;
+    }
+#endif
+    invokeGeneralRmsNorm((T*) nullptr, input, weight, bias, eps, m, n, stream, scale, dynamicScale,
+        reinterpret_cast<int8_t*>(output), reinterpret_cast<T const*>(residual), reinterpret_cast<T*>(residualOut));
+}
+} // namespace
+
+RmsnormQuantizationPlugin::RmsnormQuantizationPlugin(float eps, bool dynamicActivationScaling,
+    nvinfer1::DataType type, nvinfer1::DataType outputType, bool fuseResidual)
     : mEps(eps)
     , mDynActScaling(dynamicActivationScaling)
     , mType(type)
+    , mOutputType(outputType)
+    , mFuseResidual(fuseResidual)
 {
+    TLLM_CHECK_WITH_INFO(mOutputType == DataType::kINT8 || mOutputType == DataType::kFP8,
+        "RmsnormQuantization only supports INT8 and FP8 outputs.");
 }
 
 // Parameterized constructor
@@ -43,6 +69,8 @@ RmsnormQuantizationPlugin::RmsnormQuantizationPlugin(void const* data, size_t le
     read(d, mEps);
     read(d, mDynActScaling);
     read(d, mType);
+    read(d, mOutputType);
+    read(d, mFuseResidual);
     TLLM_CHECK_WITH_INFO(d == a + length,
         "Expected length (%d) != real length (%d). This is often "
         "caused by using different TensorRT-LLM version to build "
@@ -53,7 +81,7 @@ RmsnormQuantizationPlugin::RmsnormQuantizationPlugin(void const* data, size_t le
 // IPluginV2DynamicExt Methods
 nvinfer1::IPluginV2DynamicExt* RmsnormQuantizationPlugin::clone() const noexcept
 {
-    auto* plugin = new RmsnormQuantizationPlugin(mEps, mDynActScaling, mType);
+    auto* plugin = new RmsnormQuantizationPlugin(mEps, mDynActScaling, mType, mOutputType, mFuseResidual);
     plugin->setPluginNamespace(mNamespace.c_str());
     return plugin;
 }
@@ -66,6 +94,11 @@ nvinfer1::DimsExprs RmsnormQuantizationPlugin::getOutputDimensions(
         // Quantized output
         return inputs[outputIndex];
     }
+    if (mFuseResidual && outputIndex == getNbOutputs() - 1)
+    {
+        // Updated residual
+        return inputs[0];
+    }
 
     // Dynamic scaling output if enabled
     try
@@ -90,9 +123,9 @@ nvinfer1::DimsExprs RmsnormQuantizationPlugin::getOutputDimensions(
 bool RmsnormQuantizationPlugin::supportsFormatCombination(
     int pos, nvinfer1::PluginTensorDesc const* inOut, int nbInputs, int nbOutputs) noexcept
 {
-    int const totalPoses = 6 + static_cast<int>(mDynActScaling);
+    int const totalPoses = 6 + static_cast<int>(mDynActScaling) + 2 * static_cast<int>(mFuseResidual);
     TLLM_CHECK(0 <= pos && pos < totalPoses);
-    TLLM_CHECK(nbInputs == 4);
+    TLLM_CHECK(nbInputs == 4 + static_cast<int>(mFuseResidual));
     if (pos < nbInputs)
     {
         switch (pos)
@@ -101,12 +134,19 @@ bool RmsnormQuantizationPlugin::supportsFormatCombination(
         case 1:
         case 2: return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
         case 3: return (inOut[pos].type == nvinfer1::DataType::kFLOAT) && (inOut[pos].format == TensorFormat::kLINEAR);
+        // Residual
+        case 4: return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
         }
     }
-    if (pos == 4)
+    if (pos == nbInputs)
     {
         // Quantized output
-        return (inOut[pos].type == nvinfer1::DataType::kINT8) && (inOut[pos].format == TensorFormat::kLINEAR);
+        return (inOut[pos].type == mOutputType) && (inOut[pos].format == TensorFormat::kLINEAR);
+    }
+    if (mFuseResidual && pos == totalPoses - 1)
+    {
+        // Updated residual
+        return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
     }
     // Dynamic scaling if enabled
     return (inOut[pos].type == nvinfer1::DataType::kFLOAT) && (inOut[pos].format == TensorFormat::kLINEAR);
@@ -132,9 +172,11 @@ int RmsnormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDe
     //     weight [N, ]
     //     bias [N, ]
     //     scale_to_int [1]
+    //     residual [M(*), N] (optional input)
     // outputs
     //     output [M(*), N]
     //     dynamic_scaling [M(*), 1] (optional output)
+    //     residual_out [M(*), N] (optional output, input + residual)
 
     int64_t m64 = 1;
     for (int i = 0; i < inputDesc[0].dims.nbDims - 1; ++i)
@@ -145,22 +187,26 @@ int RmsnormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDe
     int const n = TLLM_INT32_CAST(inputDesc[1].dims.d[0]);
 
     float const* scale = reinterpret_cast<float const*>(inputs[3]);
-    int8_t* output = reinterpret_cast<int8_t*>(outputs[0]);
+    void* output = outputs[0];
     float* dynamic_scale = mDynActScaling ? reinterpret_cast<float*>(outputs[1]) : nullptr;
+    void const* residual = mFuseResidual ? inputs[4] : nullptr;
+    void* residual_out = mFuseResidual ? outputs[getNbOutputs() - 1] : nullptr;
 
     if (mType == DataType::kHALF)
     {
         half const* input = reinterpret_cast<half const*>(inputs[0]);
         half const* weight = reinterpret_cast<half const*>(inputs[1]);
         half const* bias = reinterpret_cast<half const*>(inputs[2]);
-        invokeGeneralRmsNorm((half*) nullptr, input, weight, bias, mEps, m, n, stream, scale, dynamic_scale, output);
+        invokeRmsnormQuantization(mOutputType, output, input, weight, bias, mEps, m, n, scale, dynamic_scale,
+            residual, residual_out, stream);
     }
     else if (mType == DataType::kFLOAT)
     {
         float const* input = reinterpret_cast<float const*>(inputs[0]);
         float const* weight = reinterpret_cast<float const*>(inputs[1]);
         float const* bias = reinterpret_cast<float const*>(inputs[2]);
-        invokeGeneralRmsNorm((float*) nullptr, input, weight, bias, mEps, m, n, stream, scale, dynamic_scale, output);
+        invokeRmsnormQuantization(mOutputType, output, input, weight, bias, mEps, m, n, scale, dynamic_scale,
+            residual, residual_out, stream);
     }
 #ifdef ENABLE_BF16
     else if (mType == DataType::kBF16)
@@ -168,8 +214,8 @@ int RmsnormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDe
         __nv_bfloat16 const* input = reinterpret_cast<__nv_bfloat16 const*>(inputs[0]);
         __nv_bfloat16 const* weight = reinterpret_cast<__nv_bfloat16 const*>(inputs[1]);
         __nv_bfloat16 const* bias = reinterpret_cast<__nv_bfloat16 const*>(inputs[2]);
-        invokeGeneralRmsNorm(
-            (__nv_bfloat16*) nullptr, input, weight, bias, mEps, m, n, stream, scale, dynamic_scale, output);
+        invokeRmsnormQuantization(mOutputType, output, input, weight, bias, mEps, m, n, scale, dynamic_scale,
+            residual, residual_out, stream);
     }
 #endif
 
@@ -180,11 +226,16 @@ int RmsnormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDe
 nvinfer1::DataType RmsnormQuantizationPlugin::getOutputDataType(
     int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept
 {
-    assert((mDynActScaling && index < 2) || (!mDynActScaling && index == 0));
+    assert(index < getNbOutputs());
     if (index == 0)
     {
         // Output 0 quantized output of layer norm
-        return nvinfer1::DataType::kINT8;
+        return mOutputType;
+    }
+    if (mFuseResidual && index == getNbOutputs() - 1)
+    {
+        // Last output updated residual
+        return mType;
     }
     // Output 1 dynamic act scaling
     return nvinfer1::DataType::kFLOAT;
@@ -204,7 +255,7 @@ char const* RmsnormQuantizationPlugin::getPluginVersion() const noexcept
 
 int RmsnormQuantizationPlugin::getNbOutputs() const noexcept
 {
-    return 1 + static_cast<int>(mDynActScaling);
+    return 1 + static_cast<int>(mDynActScaling) + static_cast<int>(mFuseResidual);
 }
 
 int RmsnormQuantizationPlugin::initialize() noexcept
@@ -216,7 +267,7 @@ void RmsnormQuantizationPlugin::terminate() noexcept {}
 
 size_t RmsnormQuantizationPlugin::getSerializationSize() const noexcept
 {
-    return sizeof(mEps) + sizeof(mDynActScaling) + sizeof(mType);
+    return sizeof(mEps) + sizeof(mDynActScaling) + sizeof(mType) + sizeof(mOutputType) + sizeof(mFuseResidual);
 }
 
 void RmsnormQuantizationPlugin::serialize(void* buffer) const noexcept
@@ -225,6 +276,8 @@ void RmsnormQuantizationPlugin::serialize(void* buffer) const noexcept
     write(d, mEps);
     write(d, mDynActScaling);
     write(d, mType);
+    write(d, mOutputType);
+    write(d, mFuseResidual);
     assert(d == a + getSerializationSize());
 }
 
@@ -243,6 +296,8 @@ RmsnormQuantizationPluginCreator::RmsnormQuantizationPluginCreator()
     mPluginAttributes.emplace_back(PluginField("eps", nullptr, PluginFieldType::kFLOAT32, 1e-5f));
     mPluginAttributes.emplace_back(PluginField("dyn_act_scaling", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("type_id", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("out_type_id", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("fuse_residual", nullptr, PluginFieldType::kINT32, 1));
     mFC.nbFields = mPluginAttributes.size();
     mFC.fields = mPluginAttributes.data();
 }
@@ -267,7 +322,9 @@ IPluginV2* RmsnormQuantizationPluginCreator::createPlugin(char const* name, Plug
     PluginField const* fields = fc->fields;
     float eps;
     nvinfer1::DataType type;
+    nvinfer1::DataType outputType = nvinfer1::DataType::kINT8;
     bool dynamicActivationScaling;
+    bool fuseResidual = false;
     // Read configurations from each fields
     for (int i = 0; i < fc->nbFields; ++i)
     {
@@ -282,15 +339,25 @@ IPluginV2* RmsnormQuantizationPluginCreator::createPlugin(char const* name, Plug
             TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
             type = static_cast<nvinfer1::DataType>(*(static_cast<nvinfer1::DataType const*>(fields[i].data)));
         }
+        else if (!strcmp(attrName, "out_type_id"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            outputType = static_cast<nvinfer1::DataType>(*(static_cast<nvinfer1::DataType const*>(fields[i].data)));
+        }
         else if (!strcmp(attrName, "dyn_act_scaling"))
         {
             TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
             dynamicActivationScaling = static_cast<bool>(*(static_cast<bool const*>(fields[i].data)));
         }
+        else if (!strcmp(attrName, "fuse_residual"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            fuseResidual = static_cast<bool>(*(static_cast<int const*>(fields[i].data)));
+        }
     }
     try
     {
-        auto* obj = new RmsnormQuantizationPlugin(eps, dynamicActivationScaling, type);
+        auto* obj = new RmsnormQuantizationPlugin(eps, dynamicActivationScaling, type, outputType, fuseResidual);
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
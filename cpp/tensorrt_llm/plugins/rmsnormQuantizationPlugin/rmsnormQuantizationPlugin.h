@@ -28,7 +28,11 @@ namespace tensorrt_llm::plugins
 class RmsnormQuantizationPlugin : public BasePlugin
 {
 public:
-    RmsnormQuantizationPlugin(float eps, bool dynamicActivationScaling, nvinfer1::DataType type);
+    // outputType is kINT8 or, for the W4A8 (FP8 activation) GEMMs, kFP8.
+    // With fuseResidual, the residual is an extra input added before the norm, and the sum is an extra output, so
+    // the residual add after the previous GEMM doesn't need its own kernel.
+    RmsnormQuantizationPlugin(float eps, bool dynamicActivationScaling, nvinfer1::DataType type,
+        nvinfer1::DataType outputType = nvinfer1::DataType::kINT8, bool fuseResidual = false);
 
     RmsnormQuantizationPlugin(void const* data, size_t length);
 
@@ -65,6 +69,8 @@ private:
     float mEps;
     bool mDynActScaling;
     nvinfer1::DataType mType;
+    nvinfer1::DataType mOutputType;
+    bool mFuseResidual;
 
     const std::string mLayerName;
 };
@@ -117,7 +117,11 @@ void SelectiveScanPlugin::configurePlugin(nvinfer1::DynamicPluginTensorDesc cons
 size_t SelectiveScanPlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc const* inputs, int nbInputs,
     nvinfer1::PluginTensorDesc const* outputs, int nbOutputs) const noexcept
 {
-    return 0;
+    // Chunk states of the chunked scan of long context sequences
+    auto const batchSize = inputs[getHostRequestTypesIdx()].dims.d[0];
+    auto const& inputDims = inputs[getInputTensorIdx()].dims;
+    auto const numTokens = mRemovePadding ? inputDims.d[0] : inputDims.d[0] * inputDims.d[1];
+    return getSelectiveScanWorkspaceSize(batchSize, numTokens, mDim, mDState);
 }
 
 void SelectiveScanPlugin::setSSMParams(SSMParamsBase& params, const size_t batch, const size_t dim,
@@ -202,6 +206,10 @@ int SelectiveScanPlugin::enqueueImpl(nvinfer1::PluginTensorDesc const* inputDesc
 
     if (reqTypes[0] == RequestType::kCONTEXT)
     {
+        // A packed sequence can have all the tokens
+        auto const maxSeqLen = mRemovePadding ? inputDesc[getInputTensorIdx()].dims.d[0] : max_seq_len;
+        ssm_params.chunk_states_ptr = workspace;
+        ssm_params.max_chunks = (maxSeqLen + kSelectiveScanChunkSize - 1) / kSelectiveScanChunkSize;
         invokeSelectiveScan<T, float>(ssm_params, stream);
     }
     else if (reqTypes[0] == RequestType::kGENERATION)
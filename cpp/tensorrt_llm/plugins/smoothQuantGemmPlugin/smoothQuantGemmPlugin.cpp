@@ -16,6 +16,7 @@
  */
 #include "smoothQuantGemmPlugin.h"
 #include "tensorrt_llm/kernels/weightOnlyBatchedGemv/int8SQ.h"
+#include "tensorrt_llm/runtime/pluginTimer.h"
 #include <numeric>
 
 using namespace nvinfer1;
@@ -26,6 +27,8 @@ using tensorrt_llm::plugins::SmoothQuantGemmPlugin;
 using tensorrt_llm::plugins::SmoothQuantGemmPluginProfiler;
 using tensorrt_llm::plugins::read;
 using tensorrt_llm::plugins::write;
+using tensorrt_llm::runtime::PluginKind;
+using tensorrt_llm::runtime::PluginTimer;
 
 static char const* SQ_GEMM_PLUGIN_VERSION{"1"};
 static char const* SQ_GEMM_PLUGIN_NAME{"SmoothQuantGemm"};
@@ -223,6 +226,7 @@ int SmoothQuantGemmPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
     nvinfer1::PluginTensorDesc const* outputDesc, void const* const* inputs, void* const* outputs, void* workspace,
     cudaStream_t stream) noexcept
 {
+    auto const timingScope = PluginTimer::getInstance().scope(PluginKind::kGEMM, stream);
     // inputs
     //     mat1           [M(*), K]
     //     mat2           [N, K]
@@ -265,7 +269,7 @@ int SmoothQuantGemmPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
     }
     else
     {
-        auto const& bestTactic = mPluginProfiler->getBestConfig(m, mGemmId);
+        auto const& bestTactic = mPluginProfiler->getBestRuntimeConfig(m, mGemmId, stream);
         TLLM_CHECK_WITH_INFO(bestTactic, "No valid SQ GEMM tactic");
         m_sqGemmRunner->gemm(reinterpret_cast<int8_t const*>(inputs[0]), reinterpret_cast<int8_t const*>(inputs[1]),
             mQuantMode, reinterpret_cast<float const*>(inputs[3]), reinterpret_cast<float const*>(inputs[2]),
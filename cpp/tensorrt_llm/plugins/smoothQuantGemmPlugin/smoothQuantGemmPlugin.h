@@ -50,6 +50,16 @@ protected:
 
     std::vector<Config> getTactics(int m, int n, int k) const override;
 
+    std::string getRuntimeTacticsId() const override
+    {
+        return std::to_string(mQuantMode.value());
+    }
+
+    bool supportsMultiDeviceProfiling() const override
+    {
+        return true;
+    }
+
 private:
     tensorrt_llm::common::QuantMode mQuantMode;
 };
@@ -15,6 +15,7 @@
  * limitations under the License.
  */
 #include "weightOnlyGroupwiseQuantMatmulPlugin.h"
+#include "tensorrt_llm/runtime/pluginTimer.h"
 
 #include <numeric>
 
@@ -24,6 +25,8 @@ using namespace tensorrt_llm::kernels::cutlass_kernels;
 using tensorrt_llm::plugins::WeightOnlyGroupwiseQuantMatmulPluginCreator;
 using tensorrt_llm::plugins::WeightOnlyGroupwiseQuantMatmulPlugin;
 using tensorrt_llm::plugins::WeightOnlyGroupwiseQuantGemmPluginProfiler;
+using tensorrt_llm::runtime::PluginKind;
+using tensorrt_llm::runtime::PluginTimer;
 
 // Flags for indicating whether the corresponding inputs are applied in mQuantAlgo
 // mQuantAlgo = pre_quant_scale * PRE_QUANT_SCALE + zero * ZERO + bias * BIAS
@@ -32,6 +35,8 @@ static constexpr int BIAS = int(1) << 0;
 static constexpr int ZERO = int(1) << 1;
 static constexpr int PRE_QUANT_SCALE = int(1) << 2;
 static constexpr int FP8_ALPHA = int(1) << 3;
+// FP8 activations quantized per token, e.g. by the preceding RmsnormQuantization, with their scales as extra input
+static constexpr int PER_TOKEN_FP8_ACT = int(1) << 4;
 using tensorrt_llm::plugins::read;
 using tensorrt_llm::plugins::write;
 
@@ -68,6 +73,15 @@ void WeightOnlyGroupwiseQuantGemmPluginProfiler::runTactic(int m, int n, int k,
         biasesPtr = nullptr;
     }
 
+    if (isBatchedGemvConfig(tactic))
+    {
+        tensorrt_llm::kernels::weight_only::Params params{actPtr, nullptr, weightPtr, inputScalesPtr, zerosPtr, nullptr,
+            outputPtr, 1.f, m, originalN, k, mGroupSize, *mCudaKernelType, static_cast<bool>(mQuantAlgo & FP8_ALPHA)};
+        params.split_k = tactic.split_k_factor;
+        tensorrt_llm::kernels::weight_only::kernel_launcher(mArch, params, stream);
+        return;
+    }
+
     int const wsSize = mRunner->getWorkspaceSize(m, n, k);
 
     mRunner->gemm(actPtr, weightPtr, inputScalesPtr, zerosPtr, biasesPtr, outputPtr, m, originalN, k, mGroupSize,
@@ -94,7 +108,19 @@ void WeightOnlyGroupwiseQuantGemmPluginProfiler::computeTmpSize(int maxM, int n,
 std::vector<WeightOnlyGroupwiseQuantGemmPluginProfiler::Config> WeightOnlyGroupwiseQuantGemmPluginProfiler::getTactics(
     int m, int n, int k) const
 {
-    return mRunner->getConfigs();
+    auto tactics = mRunner->getConfigs();
+    if (mCudaKernelType && m <= tensorrt_llm::kernels::weight_only::kMaxBatchedGemvM)
+    {
+        for (auto const splitK : BATCHED_GEMV_SPLIT_K)
+        {
+            // BF16 split-K accumulates with atomics available from SM80
+            if (splitK == 1 || mType != nvinfer1::DataType::kBF16 || mArch >= 80)
+            {
+                tactics.push_back(getBatchedGemvConfig(splitK));
+            }
+        }
+    }
+    return tactics;
 }
 
 WeightOnlyGroupwiseQuantMatmulPlugin::WeightOnlyGroupwiseQuantMatmulPlugin(nvinfer1::DataType type, int quant_algo,
@@ -136,13 +162,17 @@ void WeightOnlyGroupwiseQuantMatmulPlugin::init(nvinfer1::DataType type, int qua
     mQuantAlgo = quant_algo;
     mGroupSize = group_size;
 
-    // quant_algo = fp8_alpha * 8 + pre_quant_scale * 4 + zero * 2 + bias
+    // quant_algo = per_token_fp8_act * 16 + fp8_alpha * 8 + pre_quant_scale * 4 + zero * 2 + bias
+    TLLM_CHECK_WITH_INFO(
+        !(quant_algo & PER_TOKEN_FP8_ACT) || ((quant_algo & FP8_ALPHA) && !(quant_algo & PRE_QUANT_SCALE)),
+        "Per-token FP8 activations need FP8_ALPHA, and the pre-quant scales must be folded into the preceding norm.");
     mPreQuantScaleInputIdx = (quant_algo & PRE_QUANT_SCALE) ? 1 : 0;
     mWeightInputIdx = mPreQuantScaleInputIdx + 1;
     mScalesInputIdx = mWeightInputIdx + 1;
     mZerosInputIdx = (quant_algo & ZERO) ? mScalesInputIdx + 1 : mScalesInputIdx;
     mBiasesInputIdx = (quant_algo & BIAS) ? mZerosInputIdx + 1 : mZerosInputIdx;
     mAlphaInputIdx = (quant_algo & FP8_ALPHA) ? mBiasesInputIdx + 1 : mBiasesInputIdx;
+    mActTokenScalesInputIdx = (quant_algo & PER_TOKEN_FP8_ACT) ? mAlphaInputIdx + 1 : mAlphaInputIdx;
 
     if (mType == nvinfer1::DataType::kHALF)
     {
@@ -229,6 +259,10 @@ void WeightOnlyGroupwiseQuantMatmulPlugin::init(nvinfer1::DataType type, int qua
     }
     mPluginProfiler->setQuantAlgo(mQuantAlgo);
     mPluginProfiler->setGroupSize(mGroupSize);
+    if (mCudaKernelEnabled)
+    {
+        mPluginProfiler->setCudaKernelType(mCudaKernelType, mArch);
+    }
 
     mGemmId = GemmIdCore(mDims.n, mDims.k, mType);
 }
@@ -257,10 +291,11 @@ nvinfer1::DimsExprs WeightOnlyGroupwiseQuantMatmulPlugin::getOutputDimensions(
     //   4 zeros            [K // group_size, N] (optional)
     //   5 biases           [M] (optional)
     //   6 alpha            [1] (optional)
+    //   7 act token scales [M, 1] (optional)
 
     try
     {
-        TLLM_CHECK(nbInputs == mAlphaInputIdx + 1);
+        TLLM_CHECK(nbInputs == mActTokenScalesInputIdx + 1);
         TLLM_CHECK(outputIndex == 0);
         int const nbDimsA = inputs[0].nbDims;
         int const nbDimsB = inputs[mWeightInputIdx].nbDims;
@@ -288,14 +323,19 @@ nvinfer1::DimsExprs WeightOnlyGroupwiseQuantMatmulPlugin::getOutputDimensions(
 bool WeightOnlyGroupwiseQuantMatmulPlugin::supportsFormatCombination(
     int pos, nvinfer1::PluginTensorDesc const* inOut, int nbInputs, int nbOutputs) noexcept
 {
-    if (pos < mAlphaInputIdx + 2)
+    if (pos < mActTokenScalesInputIdx + 2)
     {
-        if (pos == mWeightInputIdx)
+        if (pos == 0 && (mQuantAlgo & PER_TOKEN_FP8_ACT))
+        {
+            return inOut[pos].type == nvinfer1::DataType::kFP8 && inOut[pos].format == TensorFormat::kLINEAR;
+        }
+        else if (pos == mWeightInputIdx)
         {
             // weights
             return inOut[mWeightInputIdx].type == mType && inOut[mWeightInputIdx].format == TensorFormat::kLINEAR;
         }
-        else if ((mQuantAlgo & FP8_ALPHA) && pos == mAlphaInputIdx)
+        else if (((mQuantAlgo & FP8_ALPHA) && pos == mAlphaInputIdx)
+            || ((mQuantAlgo & PER_TOKEN_FP8_ACT) && pos == mActTokenScalesInputIdx))
         {
             return inOut[pos].type == nvinfer1::DataType::kFLOAT && inOut[pos].format == TensorFormat::kLINEAR;
         }
@@ -347,6 +387,7 @@ int WeightOnlyGroupwiseQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc con
     nvinfer1::PluginTensorDesc const* outputDesc, void const* const* inputs, void* const* outputs, void* workspace,
     cudaStream_t stream) noexcept
 {
+    auto const timingScope = PluginTimer::getInstance().scope(PluginKind::kGEMM, stream);
     // inputs
     //   0 activations      [M, K]
     //   1 pre-quant scales [K]
@@ -355,6 +396,7 @@ int WeightOnlyGroupwiseQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc con
     //   4 zeros            [K // group_size, N]
     //   5 biases           [M]
     //   6 alpha            [1]
+    //   7 act token scales [M, 1]
     // outputs
     //   mat                [M, N]
 
@@ -368,7 +410,24 @@ int WeightOnlyGroupwiseQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc con
     int const k = TLLM_INT32_CAST(inputDesc[0].dims.d[inputDesc[0].dims.nbDims - 1]);
 
     bool use_cuda_kernel = m < SMALL_M_FAST_PATH && mCudaKernelEnabled;
+    int cuda_kernel_split_k = 1;
+    std::optional<WeightOnlyGroupwiseQuantGemmPluginProfiler::Config> bestTactic;
+    if (!use_cuda_kernel)
+    {
+        // Up to kMaxBatchedGemvM, the profiler may have found the batched GEMV faster than CUTLASS
+        bestTactic = mPluginProfiler->getBestRuntimeConfig(m, mGemmId, stream);
+        if (bestTactic && isBatchedGemvConfig(*bestTactic))
+        {
+            TLLM_CHECK_WITH_INFO(mCudaKernelEnabled && m <= tensorrt_llm::kernels::weight_only::kMaxBatchedGemvM,
+                "Batched GEMV tactic selected for m=%d but the kernel can't run it.", m);
+            use_cuda_kernel = true;
+            cuda_kernel_split_k = bestTactic->split_k_factor;
+        }
+    }
     bool use_pre_quant_scale = mQuantAlgo & PRE_QUANT_SCALE;
+    float const* act_token_scales_ptr = (mQuantAlgo & PER_TOKEN_FP8_ACT)
+        ? reinterpret_cast<float const*>(inputs[mActTokenScalesInputIdx])
+        : nullptr;
 
     half const* zeros_ptr = (mQuantAlgo & ZERO) ? reinterpret_cast<half const*>(inputs[mZerosInputIdx]) : nullptr;
     half const* biases_ptr = (mQuantAlgo & BIAS) ? reinterpret_cast<half const*>(inputs[mBiasesInputIdx]) : nullptr;
@@ -379,7 +438,10 @@ int WeightOnlyGroupwiseQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc con
         cudaMemcpy(&alpha, const_cast<void*>(inputs[mAlphaInputIdx]), sizeof(float), cudaMemcpyDeviceToHost);
     }
 
-    if (use_pre_quant_scale && !use_cuda_kernel)
+    // The fine grained CUTLASS mainloop can scale the 16-bit activations itself, which saves a pass over them
+    bool const fuse_pre_quant_scale = use_pre_quant_scale && !use_cuda_kernel && bestTactic
+        && m_weightOnlyGroupwiseGemmRunner->supportsFusedActScale(*bestTactic);
+    if (use_pre_quant_scale && !use_cuda_kernel && !fuse_pre_quant_scale)
     {
         // Apply pre-quant per channel scale on activations
         act_ptr = reinterpret_cast<half const*>(workspace);
@@ -438,10 +500,19 @@ int WeightOnlyGroupwiseQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc con
         void const* cuda_kernel_zeros_ptr = zeros_ptr;
         void const* cuda_kernel_bias_ptr = biases_ptr;
         void* cuda_kernel_out_ptr = outputs[0];
+        if (act_token_scales_ptr)
+        {
+            // The batched GEMV reads 16-bit activations, dequantize the few FP8 rows into the workspace
+            cuda_kernel_act_ptr = workspace;
+            tensorrt_llm::kernels::apply_per_token_scale_kernel_launcher<__nv_fp8_e4m3, half>(
+                reinterpret_cast<half*>(workspace), reinterpret_cast<__nv_fp8_e4m3 const*>(inputs[0]),
+                act_token_scales_ptr, m, k, stream);
+        }
         tensorrt_llm::kernels::weight_only::Params params{cuda_kernel_act_ptr, cuda_kernel_act_scale_ptr,
             cuda_kernel_weight_ptr, cuda_kernel_scales_ptr, cuda_kernel_zeros_ptr, cuda_kernel_bias_ptr,
             cuda_kernel_out_ptr, alpha, m, real_n, k, mGroupSize, mCudaKernelType,
             static_cast<bool>(mQuantAlgo & FP8_ALPHA)};
+        params.split_k = cuda_kernel_split_k;
         tensorrt_llm::kernels::weight_only::kernel_launcher(mArch, params, stream);
     }
     else
@@ -450,16 +521,30 @@ int WeightOnlyGroupwiseQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc con
 
         int32_t* weight_ptr = const_cast<int32_t*>(reinterpret_cast<int32_t const*>(inputs[mWeightInputIdx]));
 
-        auto const& bestTactic = mPluginProfiler->getBestConfig(m, mGemmId);
         TLLM_CHECK_WITH_INFO(bestTactic,
             "No valid weight only groupwise GEMM tactic(It is usually caused by the failure to execute all "
             "candidate "
             "configurations of the CUTLASS kernel, please pay attention to the warning information when building "
             "the "
             "engine.)");
-        m_weightOnlyGroupwiseGemmRunner->gemm(act_ptr, weight_ptr, inputs[mScalesInputIdx], zeros_ptr, biases_ptr,
-            alpha, outputs[0], m, real_n, k, mGroupSize, *bestTactic,
-            reinterpret_cast<char*>(workspace) + m * k * sizeof(half), ws_bytes, stream);
+        if (fuse_pre_quant_scale)
+        {
+            m_weightOnlyGroupwiseGemmRunner->gemm(act_ptr, inputs[mPreQuantScaleInputIdx], weight_ptr,
+                inputs[mScalesInputIdx], zeros_ptr, biases_ptr, alpha, outputs[0], m, real_n, k, mGroupSize,
+                *bestTactic, reinterpret_cast<char*>(workspace) + m * k * sizeof(half), ws_bytes, stream);
+        }
+        else
+        {
+            // With per-token activation scales, the bias is added after scaling the rows of the output
+            m_weightOnlyGroupwiseGemmRunner->gemm(act_ptr, weight_ptr, inputs[mScalesInputIdx], zeros_ptr,
+                act_token_scales_ptr ? nullptr : biases_ptr, alpha, outputs[0], m, real_n, k, mGroupSize, *bestTactic,
+                reinterpret_cast<char*>(workspace) + m * k * sizeof(half), ws_bytes, stream);
+        }
+        if (act_token_scales_ptr)
+        {
+            tensorrt_llm::kernels::apply_per_token_scale_and_bias_kernel_launcher<half>(
+                reinterpret_cast<half*>(outputs[0]), act_token_scales_ptr, biases_ptr, m, real_n, stream);
+        }
     }
     return 0;
 }
@@ -29,6 +29,7 @@
 #include <cassert>
 #include <cuda_runtime.h>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -60,6 +61,13 @@ public:
         mGroupSize = groupSize;
     }
 
+    // Profile the batched GEMV kernels for small M
+    void setCudaKernelType(tensorrt_llm::kernels::weight_only::KernelType cudaKernelType, int arch)
+    {
+        mCudaKernelType = cudaKernelType;
+        mArch = arch;
+    }
+
 protected:
     void runTactic(int m, int n, int k, Config const& tactic, char* workspace, cudaStream_t const& stream) override;
 
@@ -67,9 +75,21 @@ protected:
 
     std::vector<Config> getTactics(int m, int n, int k) const override;
 
+    std::string getRuntimeTacticsId() const override
+    {
+        return std::to_string(mQuantAlgo) + "_" + std::to_string(mGroupSize);
+    }
+
+    bool supportsMultiDeviceProfiling() const override
+    {
+        return true;
+    }
+
 private:
     int mQuantAlgo;
     int mGroupSize;
+    std::optional<tensorrt_llm::kernels::weight_only::KernelType> mCudaKernelType;
+    int mArch{0};
 };
 
 class WeightOnlyGroupwiseQuantMatmulPlugin : public BasePlugin
@@ -143,6 +163,7 @@ private:
     int mZerosInputIdx;
     int mBiasesInputIdx;
     int mAlphaInputIdx;
+    int mActTokenScalesInputIdx;
 
     GemmDims mDims{};
     GemmIdCore mGemmId{};
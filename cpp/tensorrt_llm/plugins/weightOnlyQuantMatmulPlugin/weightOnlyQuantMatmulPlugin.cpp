@@ -15,6 +15,7 @@
  * limitations under the License.
  */
 #include "weightOnlyQuantMatmulPlugin.h"
+#include "tensorrt_llm/runtime/pluginTimer.h"
 
 #include <numeric>
 
@@ -26,6 +27,8 @@ using tensorrt_llm::plugins::WeightOnlyQuantMatmulPlugin;
 using tensorrt_llm::plugins::WeightOnlyQuantGemmPluginProfiler;
 using tensorrt_llm::plugins::read;
 using tensorrt_llm::plugins::write;
+using tensorrt_llm::runtime::PluginKind;
+using tensorrt_llm::runtime::PluginTimer;
 
 static char const* WOQ_MATMUL_PLUGIN_VERSION{"1"};
 static char const* WOQ_MATMUL_PLUGIN_NAME{"WeightOnlyQuantMatmul"};
@@ -46,6 +49,15 @@ void WeightOnlyQuantGemmPluginProfiler::runTactic(int m, int n, int k,
     char* workspacePtr
         = reinterpret_cast<char*>(nextWorkspacePtr(reinterpret_cast<int8_t*>(outputPtr), m * originalN * sizeof(half)));
 
+    if (isBatchedGemvConfig(tactic))
+    {
+        tensorrt_llm::kernels::weight_only::Params params(actPtr, nullptr, weightPtr, scalesPtr, nullptr, nullptr,
+            outputPtr, 1.f, m, originalN, k, 0, *mCudaKernelType);
+        params.split_k = tactic.split_k_factor;
+        tensorrt_llm::kernels::weight_only::kernel_launcher(mArch, params, stream);
+        return;
+    }
+
     int const wsSize = mRunner->getWorkspaceSize(m, n, k);
 
     if (mWeightTypeId == WeightTypeId::INT8)
@@ -76,7 +88,19 @@ void WeightOnlyQuantGemmPluginProfiler::computeTmpSize(int maxM, int n, int k)
 std::vector<WeightOnlyQuantGemmPluginProfiler::Config> WeightOnlyQuantGemmPluginProfiler::getTactics(
     int m, int n, int k) const
 {
-    return mRunner->getConfigs();
+    auto tactics = mRunner->getConfigs();
+    if (mCudaKernelType && m <= tensorrt_llm::kernels::weight_only::kMaxBatchedGemvM)
+    {
+        for (auto const splitK : BATCHED_GEMV_SPLIT_K)
+        {
+            // BF16 split-K accumulates with atomics available from SM80
+            if (splitK == 1 || mType != nvinfer1::DataType::kBF16 || mArch >= 80)
+            {
+                tactics.push_back(getBatchedGemvConfig(splitK));
+            }
+        }
+    }
+    return tactics;
 }
 
 WeightOnlyQuantMatmulPlugin::WeightOnlyQuantMatmulPlugin(nvinfer1::DataType type, WeightTypeId weightTypeId,
@@ -171,6 +195,10 @@ void WeightOnlyQuantMatmulPlugin::init(nvinfer1::DataType type, WeightTypeId wei
     }
 
     mPluginProfiler->setWeightTypeId(mWeightTypeId);
+    if (mCudaKernelEnabled)
+    {
+        mPluginProfiler->setCudaKernelType(mCudaKernelType, mArch);
+    }
 
     mGemmId = GemmIdCore(mDims.n, mDims.k, mType);
 }
@@ -284,6 +312,7 @@ int WeightOnlyQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
     nvinfer1::PluginTensorDesc const* outputDesc, void const* const* inputs, void* const* outputs, void* workspace,
     cudaStream_t stream) noexcept
 {
+    auto const timingScope = PluginTimer::getInstance().scope(PluginKind::kGEMM, stream);
     // inputs
     //     mat1           [M1, M2,..., K]
     //     mat2           [K, N] for int8, [K, N/2] for int4
@@ -300,7 +329,21 @@ int WeightOnlyQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
     int const n = TLLM_INT32_CAST(inputDesc[1].dims.d[1]);
     int const k = TLLM_INT32_CAST(inputDesc[0].dims.d[inputDesc[0].dims.nbDims - 1]);
 
-    bool const use_cuda_kernel = m < SMALL_M_FAST_PATH && mCudaKernelEnabled;
+    bool use_cuda_kernel = m < SMALL_M_FAST_PATH && mCudaKernelEnabled;
+    int cuda_kernel_split_k = 1;
+    std::optional<WeightOnlyQuantGemmPluginProfiler::Config> bestTactic;
+    if (!use_cuda_kernel)
+    {
+        // Up to kMaxBatchedGemvM, the profiler may have found the batched GEMV faster than CUTLASS
+        bestTactic = mPluginProfiler->getBestRuntimeConfig(m, mGemmId, stream);
+        if (bestTactic && isBatchedGemvConfig(*bestTactic))
+        {
+            TLLM_CHECK_WITH_INFO(mCudaKernelEnabled && m <= tensorrt_llm::kernels::weight_only::kMaxBatchedGemvM,
+                "Batched GEMV tactic selected for m=%d but the kernel can't run it.", m);
+            use_cuda_kernel = true;
+            cuda_kernel_split_k = bestTactic->split_k_factor;
+        }
+    }
 #if defined(ENABLE_BF16)
     TLLM_CHECK_WITH_INFO(mType == nvinfer1::DataType::kHALF || mType == nvinfer1::DataType::kBF16,
         "No valid weightOnlyQuantMatmul configuration");
@@ -316,13 +359,13 @@ int WeightOnlyQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
         void* cuda_kernel_out_ptr = outputs[0];
         tensorrt_llm::kernels::weight_only::Params params(cuda_kernel_act_ptr, nullptr, cuda_kernel_weight_ptr,
             cuda_kernel_scales_ptr, nullptr, nullptr, cuda_kernel_out_ptr, 1.f, m, real_n, k, 0, mCudaKernelType);
+        params.split_k = cuda_kernel_split_k;
         tensorrt_llm::kernels::weight_only::kernel_launcher(mArch, params, stream);
     }
     else
     {
         int const ws_size = m_weightOnlyGemmRunner->getWorkspaceSize(m, real_n, k);
 
-        auto const& bestTactic = mPluginProfiler->getBestConfig(m, mGemmId);
         TLLM_CHECK_WITH_INFO(bestTactic,
             "No valid weight only per-channel GEMM tactic(It is usually caused by the failure to execute all candidate "
             "configurations of the CUTLASS kernel, please pay attention to the warning information when building the "
@@ -25,6 +25,7 @@
 #include <cassert>
 #include <cutlass/numeric_types.h>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -55,6 +56,23 @@ inline int32_t getWeightTypeMultiplier(WeightTypeId weightTypeId)
 using WeightOnlyGemmRunner = tensorrt_llm::kernels::cutlass_kernels::CutlassFpAIntBGemmRunnerInterface;
 using WeightOnlyGemmRunnerPtr = std::shared_ptr<WeightOnlyGemmRunner>;
 
+// Split-K factors of the batched GEMV kernels profiled against the CUTLASS tactics
+constexpr int32_t BATCHED_GEMV_SPLIT_K[] = {1, 2, 4};
+
+// For M up to weight_only::kMaxBatchedGemvM, the batched GEMV kernels are profiled as tactics of their own, so the
+// crossover with CUTLASS is found per GEMM and GPU. They are stored in the profiles as a config with an undefined
+// tile, whose split-K factor is the one of the GEMV.
+inline tensorrt_llm::cutlass_extensions::CutlassGemmConfig getBatchedGemvConfig(int splitK)
+{
+    using namespace tensorrt_llm::cutlass_extensions;
+    return CutlassGemmConfig(CutlassTileConfig::Undefined, SplitKStyle::NO_SPLIT_K, splitK, -1);
+}
+
+inline bool isBatchedGemvConfig(tensorrt_llm::cutlass_extensions::CutlassGemmConfig const& config)
+{
+    return !config.is_sm90 && config.tile_config == tensorrt_llm::cutlass_extensions::CutlassTileConfig::Undefined;
+}
+
 class WeightOnlyQuantGemmPluginProfiler : public GemmPluginProfiler<tensorrt_llm::cutlass_extensions::CutlassGemmConfig,
                                               WeightOnlyGemmRunnerPtr, GemmIdCore, GemmIdCoreHash>
 {
@@ -66,6 +84,13 @@ public:
         mWeightTypeId = weightId;
     }
 
+    // Profile the batched GEMV kernels for small M
+    void setCudaKernelType(tensorrt_llm::kernels::weight_only::KernelType cudaKernelType, int arch)
+    {
+        mCudaKernelType = cudaKernelType;
+        mArch = arch;
+    }
+
 protected:
     void runTactic(int m, int n, int k, Config const& tactic, char* workspace, cudaStream_t const& stream) override;
 
@@ -73,8 +98,20 @@ protected:
 
     std::vector<Config> getTactics(int m, int n, int k) const override;
 
+    std::string getRuntimeTacticsId() const override
+    {
+        return std::to_string(static_cast<int>(mWeightTypeId));
+    }
+
+    bool supportsMultiDeviceProfiling() const override
+    {
+        return true;
+    }
+
 private:
     WeightTypeId mWeightTypeId;
+    std::optional<tensorrt_llm::kernels::weight_only::KernelType> mCudaKernelType;
+    int mArch{0};
 };
 
 class WeightOnlyQuantMatmulPlugin : public BasePlugin
@@ -129,6 +129,7 @@ PYBIND11_MODULE(TRTLLM_PYBIND_MODULE, m)
         .def_readwrite("gpu_weights_percent", &tr::GptSession::Config::gpuWeightsPercent)
         .def_readwrite("decoder_per_request", &tr::GptSession::Config::decoderPerRequest)
         .def_readwrite("cuda_graph_mode", &tr::GptSession::Config::cudaGraphMode)
+        .def_readwrite("decoder_overlap", &tr::GptSession::Config::decoderOverlap)
         .def_readwrite("ctx_micro_batch_size", &tr::GptSession::Config::ctxMicroBatchSize)
         .def_readwrite("gen_micro_batch_size", &tr::GptSession::Config::genMicroBatchSize)
         .def_readwrite("kv_cache_config", &tr::GptSession::Config::kvCacheConfig);
@@ -162,6 +163,9 @@ PYBIND11_MODULE(TRTLLM_PYBIND_MODULE, m)
         .def_static("int8_kv_cache", &tc::QuantMode::int8KvCache)
         .def_static("fp8_kv_cache", &tc::QuantMode::fp8KvCache)
         .def_static("fp8_qdq", &tc::QuantMode::fp8Qdq)
+        .def_static("int4_kv_cache", &tc::QuantMode::int4KvCache)
+        .def_static("mxfp4_weights", &tc::QuantMode::mxfp4Weights)
+        .def_static("nvfp4_weights", &tc::QuantMode::nvfp4Weights)
         .def_property_readonly("value", &tc::QuantMode::value)
         .def("is_set", &tc::QuantMode::isSet, py::arg("mode"))
         .def_property_readonly("has_int4_weights", &tc::QuantMode::hasInt4Weights)
@@ -174,6 +178,10 @@ PYBIND11_MODULE(TRTLLM_PYBIND_MODULE, m)
         .def_property_readonly("has_int8_kv_cache", &tc::QuantMode::hasInt8KvCache)
         .def_property_readonly("has_fp8_kv_cache", &tc::QuantMode::hasFp8KvCache)
         .def_property_readonly("has_fp8_qdq", &tc::QuantMode::hasFp8Qdq)
+        .def_property_readonly("has_int4_kv_cache", &tc::QuantMode::hasInt4KvCache)
+        .def_property_readonly("has_mxfp4_weights", &tc::QuantMode::hasMxfp4Weights)
+        .def_property_readonly("has_nvfp4_weights", &tc::QuantMode::hasNvfp4Weights)
+        .def_property_readonly("has_fp4_weights", &tc::QuantMode::hasFp4Weights)
         .def_property_readonly("has_kv_cache_quant", &tc::QuantMode::hasKvCacheQuant)
         .def_static("from_description", &tc::QuantMode::fromDescription, py::arg("quantize_weights") = false,
             py::arg("quantize_activations") = false, py::arg("per_token") = false, py::arg("per_channel") = false,
@@ -17,6 +17,7 @@
 
 #include <pybind11/cast.h>
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 #include <pybind11/operators.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
@@ -27,6 +28,7 @@
 #include "streamCaster.h"
 #include "tensorCaster.h"
 
+#include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/executor/executor.h"
 #include "tensorrt_llm/executor/tensor.h"
 #include "tensorrt_llm/executor/types.h"
@@ -37,11 +39,57 @@ using Tensor = tle::Tensor;
 using SizeType32 = tle::SizeType32;
 using FloatType = tle::FloatType;
 using VecTokens = tle::VecTokens;
+using TokenIdType = tle::TokenIdType;
 using IdType = tle::IdType;
 
 namespace tensorrt_llm::pybind::executor
 {
 
+namespace
+{
+
+//! \brief Token ids from a list, or in one pass over the data from a torch tensor, a numpy array or another buffer,
+//! instead of converting their elements one at a time.
+VecTokens toVecTokens(py::handle tokens)
+{
+    if (THPVariable_Check(tokens.ptr()))
+    {
+        auto const t = THPVariable_Unpack(tokens.ptr()).to(at::kCPU, at::kInt).contiguous();
+        TLLM_CHECK_WITH_INFO(t.dim() == 1, "Token ids must be a 1D tensor, got %ld dims", static_cast<long>(t.dim()));
+        auto const* data = t.data_ptr<TokenIdType>();
+        return VecTokens(data, data + t.numel());
+    }
+    if (py::isinstance<py::buffer>(tokens))
+    {
+        auto const array = py::array_t<TokenIdType, py::array::c_style | py::array::forcecast>::ensure(tokens);
+        TLLM_CHECK_WITH_INFO(array && array.ndim() == 1, "Token ids must be a 1D array of integers");
+        return VecTokens(array.data(), array.data() + array.size());
+    }
+    return tokens.cast<VecTokens>();
+}
+
+//! \brief Read-only numpy views of the values of a result, valid as long as the result which owns them.
+template <typename T>
+py::array view(std::vector<T> const& values, py::handle owner)
+{
+    py::array_t<T> array(static_cast<py::ssize_t>(values.size()), values.data(), owner);
+    py::detail::array_proxy(array.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    return array;
+}
+
+template <typename T>
+py::list views(std::vector<std::vector<T>> const& beams, py::handle owner)
+{
+    py::list list;
+    for (auto const& beam : beams)
+    {
+        list.append(view(beam, owner));
+    }
+    return list;
+}
+
+} // namespace
+
 void InitBindings(pybind11::module_& m)
 {
     py::enum_<tle::ModelType>(m, "ModelType")
@@ -109,6 +157,37 @@ void InitBindings(pybind11::module_& m)
         .def_readwrite("micro_batch_id", &tle::InflightBatchingStats::microBatchId)
         .def_readwrite("avg_num_decoded_tokens_per_iter", &tle::InflightBatchingStats::avgNumDecodedTokensPerIter);
 
+    py::class_<tle::SpecDecodingStats>(m, "SpecDecodingStats")
+        .def(py::init<>())
+        .def_readwrite("num_draft_tokens", &tle::SpecDecodingStats::numDraftTokens)
+        .def_readwrite("num_accepted_tokens", &tle::SpecDecodingStats::numAcceptedTokens)
+        .def_readwrite("num_requests_with_draft_tokens", &tle::SpecDecodingStats::numRequestsWithDraftTokens)
+        .def_readwrite("acceptance_length_histogram", &tle::SpecDecodingStats::acceptanceLengthHistogram)
+        .def_readwrite("draft_time_ms", &tle::SpecDecodingStats::draftTimeMs)
+        .def_readwrite("verification_time_ms", &tle::SpecDecodingStats::verificationTimeMs)
+        .def_property_readonly("acceptance_rate", &tle::SpecDecodingStats::getAcceptanceRate)
+        .def_property_readonly("avg_acceptance_length", &tle::SpecDecodingStats::getAvgAcceptanceLength);
+
+    py::class_<tle::MoeLoadStats>(m, "MoeLoadStats")
+        .def(py::init<>())
+        .def_readwrite("expert_token_counts", &tle::MoeLoadStats::expertTokenCounts)
+        .def("get_max_rank_imbalance", &tle::MoeLoadStats::getMaxRankImbalance, py::arg("ep_size"));
+
+    py::class_<tle::KvCacheReuseStats>(m, "KvCacheReuseStats")
+        .def(py::init<>())
+        .def_readwrite("num_allocated_blocks", &tle::KvCacheReuseStats::numAllocatedBlocks)
+        .def_readwrite("num_reused_blocks", &tle::KvCacheReuseStats::numReusedBlocks)
+        .def_readwrite("num_reused_tokens", &tle::KvCacheReuseStats::numReusedTokens)
+        .def_readwrite("num_onboarded_blocks", &tle::KvCacheReuseStats::numOnboardedBlocks)
+        .def_readwrite("num_offloaded_blocks", &tle::KvCacheReuseStats::numOffloadedBlocks)
+        .def_readwrite("num_used_secondary_blocks", &tle::KvCacheReuseStats::numUsedSecondaryBlocks)
+        .def_readwrite("num_secondary_blocks", &tle::KvCacheReuseStats::numSecondaryBlocks)
+        .def_readwrite("free_block_age_histogram", &tle::KvCacheReuseStats::freeBlockAgeHistogram)
+        .def_property_readonly("reuse_hit_rate", &tle::KvCacheReuseStats::getReuseHitRate)
+        .def_property_readonly("secondary_occupancy", &tle::KvCacheReuseStats::getSecondaryOccupancy)
+        .def("to_json_str",
+            [](tle::KvCacheReuseStats const& reuseStats) { return tle::JsonSerialization::toJsonStr(reuseStats); });
+
     py::class_<tle::IterationStats>(m, "IterationStats")
         .def(py::init<>())
         .def_readwrite("timestamp", &tle::IterationStats::timestamp)
@@ -144,6 +223,24 @@ void InitBindings(pybind11::module_& m)
         .def("to_json_str",
             [](tle::RequestStats const& iterationStats) { return tle::JsonSerialization::toJsonStr(iterationStats); });
 
+    py::class_<tle::RequestLatencyStats>(m, "RequestLatencyStats")
+        .def(py::init<>())
+        .def_readwrite("id", &tle::RequestLatencyStats::id)
+        .def_readwrite("queue_time_ms", &tle::RequestLatencyStats::queueTimeMs)
+        .def_readwrite("kv_capacity_wait_time_ms", &tle::RequestLatencyStats::kvCapacityWaitTimeMs)
+        .def_readwrite("lora_load_wait_time_ms", &tle::RequestLatencyStats::loraLoadWaitTimeMs)
+        .def_readwrite("kv_onboard_wait_time_ms", &tle::RequestLatencyStats::kvOnboardWaitTimeMs)
+        .def_readwrite("context_chunk_times_ms", &tle::RequestLatencyStats::contextChunkTimesMs)
+        .def_readwrite("generation_time_ms", &tle::RequestLatencyStats::generationTimeMs)
+        .def_readwrite("num_generation_steps", &tle::RequestLatencyStats::numGenerationSteps)
+        .def_readwrite("response_serialization_time_ms", &tle::RequestLatencyStats::responseSerializationTimeMs)
+        .def_readwrite("time_to_first_token_ms", &tle::RequestLatencyStats::timeToFirstTokenMs)
+        .def_readwrite("end_to_end_time_ms", &tle::RequestLatencyStats::endToEndTimeMs)
+        .def_property_readonly("context_time_ms", &tle::RequestLatencyStats::getContextTimeMs)
+        .def("to_json_str",
+            [](tle::RequestLatencyStats const& latencyStats)
+            { return tle::JsonSerialization::toJsonStr(latencyStats); });
+
     py::class_<tle::RequestStatsPerIteration>(m, "RequestStatsPerIteration")
         .def(py::init<>())
         .def_readwrite("iter", &tle::RequestStatsPerIteration::iter)
@@ -217,13 +314,26 @@ void InitBindings(pybind11::module_& m)
         .def_property_readonly("weights", &tle::LoraConfig::getWeights)
         .def_property_readonly("config", &tle::LoraConfig::getConfig);
 
+    // The token ids are taken as objects, so that arrays and tensors are converted in one pass
+    auto requestInit = [](py::handle inputTokenIds, SizeType32 maxNewTokens, bool streaming,
+                           tle::SamplingConfig const& samplingConfig, tle::OutputConfig const& outputConfig,
+                           std::optional<SizeType32> const& endId, std::optional<SizeType32> const& padId,
+                           std::optional<std::list<VecTokens>> badWords, std::optional<std::list<VecTokens>> stopWords,
+                           std::optional<Tensor> embeddingBias,
+                           std::optional<tle::ExternalDraftTokensConfig> externalDraftTokensConfig,
+                           std::optional<tle::PromptTuningConfig> pTuningConfig,
+                           std::optional<tle::LoraConfig> loraConfig,
+                           std::optional<std::string> logitsPostProcessorName, py::handle encoderInputTokenIds)
+    {
+        return std::make_unique<tle::Request>(toVecTokens(inputTokenIds), maxNewTokens, streaming, samplingConfig,
+            outputConfig, endId, padId, std::move(badWords), std::move(stopWords), std::move(embeddingBias),
+            std::move(externalDraftTokensConfig), std::move(pTuningConfig), std::move(loraConfig),
+            std::move(logitsPostProcessorName),
+            encoderInputTokenIds.is_none() ? std::nullopt : std::optional{toVecTokens(encoderInputTokenIds)});
+    };
+
     py::class_<tle::Request>(m, "Request")
-        .def(py::init<VecTokens, SizeType32, bool, tle::SamplingConfig const&, tle::OutputConfig const&,
-                 std::optional<SizeType32> const&, std::optional<SizeType32> const&,
-                 std::optional<std::list<VecTokens>>, std::optional<std::list<VecTokens>>, std::optional<Tensor>,
-                 std::optional<tle::ExternalDraftTokensConfig>, std::optional<tle::PromptTuningConfig>,
-                 std::optional<tle::LoraConfig>, std::optional<std::string>, std::optional<VecTokens>>(),
-            py::arg("input_token_ids"), py::arg("max_new_tokens"), py::arg("streaming") = false,
+        .def(py::init(requestInit), py::arg("input_token_ids"), py::arg("max_new_tokens"), py::arg("streaming") = false,
             py::arg_v("sampling_config", tle::SamplingConfig(), "SamplingConfig()"),
             py::arg_v("output_config", tle::OutputConfig(), "OutputConfig()"), py::arg("end_id") = py::none(),
             py::arg("pad_id") = py::none(), py::arg("bad_words") = py::none(), py::arg("stop_words") = py::none(),
@@ -258,7 +368,21 @@ void InitBindings(pybind11::module_& m)
         .def_readwrite("log_probs", &tle::Result::logProbs)
         .def_readwrite("context_logits", &tle::Result::contextLogits)
         .def_readwrite("generation_logits", &tle::Result::generationLogits)
-        .def_readwrite("encoder_output", &tle::Result::encoderOutput);
+        .def_readwrite("encoder_output", &tle::Result::encoderOutput)
+        .def_property_readonly("output_token_ids_view",
+            [](py::object const& self) { return views(self.cast<tle::Result const&>().outputTokenIds, self); })
+        .def_property_readonly("cum_log_probs_view",
+            [](py::object const& self) -> std::optional<py::array>
+            {
+                auto const& cumLogProbs = self.cast<tle::Result const&>().cumLogProbs;
+                return cumLogProbs ? std::optional{view(*cumLogProbs, self)} : std::nullopt;
+            })
+        .def_property_readonly("log_probs_view",
+            [](py::object const& self) -> std::optional<py::list>
+            {
+                auto const& logProbs = self.cast<tle::Result const&>().logProbs;
+                return logProbs ? std::optional{views(*logProbs, self)} : std::nullopt;
+            });
 
     py::class_<tle::Response>(m, "Response")
         .def(py::init<IdType, std::string>(), py::arg("request_id"), py::arg("error_msg"))
@@ -17,11 +17,13 @@
 
 #pragma once
 
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 
 #include "tensorrt_llm/executor/tensor.h"
 #include "tensorrt_llm/runtime/torch.h"
 #include "tensorrt_llm/runtime/torchView.h"
+#include <torch/csrc/utils/tensor_numpy.h>
 #include <torch/extension.h>
 
 namespace PYBIND11_NAMESPACE
@@ -35,15 +37,23 @@ struct type_caster<tensorrt_llm::executor::Tensor>
 public:
     PYBIND11_TYPE_CASTER(tensorrt_llm::executor::Tensor, _("torch.Tensor"));
 
-    // Convert PyObject(torch.Tensor) -> tensorrt_llm::executor::Tensor
+    // Convert PyObject(torch.Tensor, numpy.ndarray or any object implementing __dlpack__)
+    // -> tensorrt_llm::executor::Tensor. None of them is copied, the tensor shares their memory and keeps them alive.
     bool load(handle src, bool)
     {
         PyObject* obj = src.ptr();
         if (THPVariable_Check(obj))
         {
-            at::Tensor const& t = THPVariable_Unpack(obj);
-            value = tensorrt_llm::executor::detail::ofITensor(tensorrt_llm::runtime::TorchView::of(t));
-            return true;
+            return loadTorch(THPVariable_Unpack(obj));
+        }
+        if (isinstance<array>(src))
+        {
+            return loadTorch(torch::utils::tensor_from_numpy(obj, /* warn_if_not_writeable */ false));
+        }
+        if (hasattr(src, "__dlpack__"))
+        {
+            auto const tensor = module_::import("torch.utils.dlpack").attr("from_dlpack")(src);
+            return loadTorch(THPVariable_Unpack(tensor.ptr()));
         }
         return false;
     }
@@ -53,6 +63,13 @@ public:
     {
         return THPVariable_Wrap(tensorrt_llm::runtime::Torch::tensor(tensorrt_llm::executor::detail::toITensor(src)));
     }
+
+private:
+    bool loadTorch(at::Tensor const& t)
+    {
+        value = tensorrt_llm::executor::detail::ofITensor(tensorrt_llm::runtime::TorchView::of(t));
+        return true;
+    }
 };
 
 } // namespace detail
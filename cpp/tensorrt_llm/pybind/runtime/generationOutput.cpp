@@ -48,6 +48,10 @@ std::shared_ptr<tr::GenerationOutput> GenerationOutput::toTrtLlm() const
     {
         output->generationLogits = tr::TorchView::of(generationLogits.value());
     }
+    if (promptLogProbs)
+    {
+        output->promptLogProbs = tr::TorchView::of(promptLogProbs.value());
+    }
 
     if (onTokenGenerated)
     {
@@ -68,5 +72,6 @@ void GenerationOutput::initBindings(py::module_& m)
         .def_readwrite("log_probs", &GenerationOutput::logProbs)
         .def_readwrite("context_logits", &GenerationOutput::contextLogits)
         .def_readwrite("generation_logits", &GenerationOutput::generationLogits)
+        .def_readwrite("prompt_log_probs", &GenerationOutput::promptLogProbs)
         .def_readwrite("on_token_generated", &GenerationOutput::onTokenGenerated);
 }
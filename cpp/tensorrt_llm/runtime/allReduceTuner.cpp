@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/allReduceTuner.h"
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/dataType.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/common/warmStartCache.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/ncclCommunicator.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+using kernels::AllReduceStrategyType;
+
+std::size_t constexpr kMinTuningMessageBytes = 4 * 1024;
+int constexpr kWarmupIterations = 3;
+int constexpr kTimedIterations = 10;
+std::array<AllReduceStrategyType, 4> constexpr kStrategies{AllReduceStrategyType::NCCL, AllReduceStrategyType::ONESHOT,
+    AllReduceStrategyType::TWOSHOT, AllReduceStrategyType::NVLS};
+
+bool isPeerAccessSupported(WorldConfig const& worldConfig)
+{
+    auto const srcDevice = worldConfig.getDevice();
+    for (SizeType32 rank : worldConfig.getTensorParallelGroup())
+    {
+        auto const destDevice = worldConfig.getDeviceOf(rank);
+        if (worldConfig.getNodeRankOf(rank) != worldConfig.getNodeRank())
+        {
+            return false;
+        }
+        if (destDevice == srcDevice)
+        {
+            continue;
+        }
+        int canAccessPeer{0};
+        TLLM_CUDA_CHECK(cudaDeviceCanAccessPeer(&canAccessPeer, srcDevice, destDevice));
+        if (!canAccessPeer)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+std::string getAllReduceStrategyCacheKey(SizeType32 tensorParallelism)
+{
+    return "allreduce_strategies_tp" + std::to_string(tensorParallelism);
+}
+
+std::vector<kernels::AllReduceStrategyCrossover> tuneAllReduceStrategies(AllReduceBuffers const& buffers,
+    std::size_t maxMessageBytes, BufferManager const& manager, WorldConfig const& worldConfig)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    auto const tpSize = worldConfig.getTensorParallelism();
+    auto const tpRank = worldConfig.getTensorParallelRank();
+    auto const comm = COMM_SESSION.split(worldConfig.getPipelineParallelRank(), tpRank);
+    NcclCommunicator const nccl{tpSize, tpRank, comm};
+    auto const& stream = manager.getStream();
+
+    auto const dataType = nvinfer1::DataType::kHALF;
+    auto const dataTypeSize = common::getDTypeSize(dataType);
+    IBuffer::SharedPtr input = manager.gpu(maxMessageBytes / dataTypeSize, dataType);
+    IBuffer::SharedPtr output = manager.gpu(maxMessageBytes / dataTypeSize, dataType);
+    manager.setZero(*input);
+
+    auto const* commPtrs = reinterpret_cast<int32_t const*>(buffers.mAllReduceCommPtrs->data());
+    // The flag must change between launches, starting above the zeroed flags
+    uint32_t flag = 0;
+
+    CudaEvent start{cudaEventDefault};
+    CudaEvent stop{cudaEventDefault};
+    std::vector<kernels::AllReduceStrategyCrossover> table;
+    for (auto messageBytes = kMinTuningMessageBytes; messageBytes <= maxMessageBytes; messageBytes *= 2)
+    {
+        auto const elts = messageBytes / dataTypeSize;
+        auto inputView = IBuffer::slice(input, 0, elts);
+        auto outputView = IBuffer::slice(output, 0, elts);
+
+        std::array<float, kStrategies.size()> times{};
+        for (std::size_t i = 0; i < kStrategies.size(); ++i)
+        {
+            auto const strategy = kStrategies[i];
+            // The buffers of the NVLS all reduce are set up on all ranks or on none
+            bool const nvlsMissing = strategy == AllReduceStrategyType::NVLS
+                && (!buffers.mNvlsMemory || messageBytes > buffers.mNvlsMemory->getSize());
+            if (nvlsMissing
+                || (strategy != AllReduceStrategyType::NCCL
+                    && !kernels::configurationSupported(strategy, elts, tpSize, dataType)))
+            {
+                times[i] = std::numeric_limits<float>::infinity();
+                continue;
+            }
+            auto const launch = [&]()
+            {
+                if (strategy == AllReduceStrategyType::NCCL)
+                {
+                    nccl.allReduce(*inputView, *outputView, stream);
+                    return;
+                }
+                auto params = kernels::AllReduceParams::deserialize(commPtrs, tpSize, tpRank, ++flag);
+                params.local_input_buffer_ptr = inputView->data();
+                params.local_output_buffer_ptr = outputView->data();
+                params.elts_total = elts;
+                if (strategy == AllReduceStrategyType::NVLS)
+                {
+                    params.nvls_unicast_ptr = buffers.mNvlsMemory->getUnicastPtr();
+                    params.nvls_multicast_ptr = buffers.mNvlsMemory->getMulticastPtr();
+                    kernels::customNvlsAllReduce(params, dataType, stream.get());
+                    return;
+                }
+                kernels::customAllReduce(params, dataType, strategy,
+                    static_cast<kernels::AllReduceStrategyConfig>(0), kernels::AllReduceFusionOp::NONE, stream.get());
+            };
+
+            for (int iter = 0; iter < kWarmupIterations; ++iter)
+            {
+                launch();
+            }
+            stream.record(start);
+            for (int iter = 0; iter < kTimedIterations; ++iter)
+            {
+                launch();
+            }
+            stream.record(stop);
+            stop.synchronize();
+            TLLM_CUDA_CHECK(cudaEventElapsedTime(&times[i], start.get(), stop.get()));
+        }
+
+        // Decide on the slowest rank's times, every rank must pick the same strategy
+        auto const localTimes = times;
+        comm.allreduce(
+            localTimes.data(), times.data(), static_cast<int>(times.size()), mpi::MpiType::kFLOAT, mpi::MpiOp::MAX);
+        auto const best = kStrategies[std::min_element(times.begin(), times.end()) - times.begin()];
+        TLLM_LOG_DEBUG("All reduce of %zu bytes: NCCL %f ms, ONESHOT %f ms, TWOSHOT %f ms, NVLS %f ms", messageBytes,
+            times[0] / kTimedIterations, times[1] / kTimedIterations, times[2] / kTimedIterations,
+            times[3] / kTimedIterations);
+
+        if (!table.empty() && table.back().strategy == best)
+        {
+            table.back().max_message_bytes = messageBytes;
+        }
+        else
+        {
+            table.push_back({messageBytes, best});
+        }
+    }
+
+    // Reset the barrier flags once every rank is done, the plugins count their flags from the zeroed state
+    stream.synchronize();
+    comm.barrier();
+    auto const flagsSize = IpcMemory::FLAGS_SIZE * tpSize * 2;
+    // The comm buffers are followed by the barrier flags in and out
+    for (std::size_t memIdx = 2; memIdx < buffers.mIpcMemoryHandles.size(); ++memIdx)
+    {
+        TLLM_CUDA_CHECK(cudaMemsetAsync(
+            buffers.mIpcMemoryHandles[memIdx].getCommPtrs().at(tpRank), 0, flagsSize, stream.get()));
+    }
+    stream.synchronize();
+    comm.barrier();
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+    return table;
+}
+
+void setupAllReduceStrategyTable(AllReduceBuffers const& buffers, std::size_t maxMessageBytes,
+    BufferManager const& manager, WorldConfig const& worldConfig)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    auto const tpSize = worldConfig.getTensorParallelism();
+    auto const tpRank = worldConfig.getTensorParallelRank();
+    auto const comm = COMM_SESSION.split(worldConfig.getPipelineParallelRank(), tpRank);
+
+    // The custom all reduce needs peer access between all ranks of the group
+    int const localPeerAccess = isPeerAccessSupported(worldConfig) ? 1 : 0;
+    int peerAccess{0};
+    comm.allreduce(&localPeerAccess, &peerAccess, 1, mpi::MpiType::kINT32, mpi::MpiOp::MIN);
+    if (!peerAccess)
+    {
+        TLLM_LOG_INFO("Skipping all reduce tuning, peer access is not supported between all ranks");
+        return;
+    }
+
+    // Rank 0 decides whether the cached table is used, so that all ranks tune or none does
+    auto const& cache = common::WarmStartCache::getInstance();
+    auto const key = getAllReduceStrategyCacheKey(tpSize);
+    std::vector<kernels::AllReduceStrategyCrossover> table;
+    if (tpRank == 0 && cache.isEnabled())
+    {
+        if (auto const entry = cache.load(key);
+            entry && entry->size() % sizeof(kernels::AllReduceStrategyCrossover) == 0)
+        {
+            table.resize(entry->size() / sizeof(kernels::AllReduceStrategyCrossover));
+            std::memcpy(table.data(), entry->data(), entry->size());
+        }
+    }
+    comm.bcast(table, 0);
+
+    if (table.empty())
+    {
+        table = tuneAllReduceStrategies(buffers, maxMessageBytes, manager, worldConfig);
+        if (tpRank == 0 && cache.isEnabled())
+        {
+            cache.store(key, table.data(), table.size() * sizeof(kernels::AllReduceStrategyCrossover));
+        }
+    }
+
+    for (auto const& entry : table)
+    {
+        TLLM_LOG_INFO("All reduce over %d ranks up to %zu bytes: strategy %d", tpSize, entry.max_message_bytes,
+            static_cast<int>(entry.strategy));
+    }
+    kernels::setAllReduceStrategyTable(tpSize, std::move(table));
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+} // namespace tensorrt_llm::runtime
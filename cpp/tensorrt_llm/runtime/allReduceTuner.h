@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/kernels/customAllReduceKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/ipcUtils.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! @brief Measures NCCL, the one shot and two shot custom all reduce, and the NVLS all reduce if its buffers are set
+//! up, over the tensor parallel group for power of two message sizes up to maxMessageBytes, and returns the crossover
+//! table of the fastest strategy.
+//! @details Collective over the tensor parallel group. Every rank uses the time of the slowest rank, so all ranks
+//! build the same table. The barrier flags of the buffers are cleared afterwards, as the plugins expect.
+std::vector<kernels::AllReduceStrategyCrossover> tuneAllReduceStrategies(AllReduceBuffers const& buffers,
+    std::size_t maxMessageBytes, BufferManager const& manager, WorldConfig const& worldConfig);
+
+//! @brief Key of the crossover table of a tensor parallel group in the warm-start cache, where
+//! setupAllReduceStrategyTable looks for it before tuning, e.g. to provide a table measured offline.
+std::string getAllReduceStrategyCacheKey(SizeType32 tensorParallelism);
+
+//! @brief Sets the crossover table of the AUTO all reduce strategy, from the warm-start cache or by running
+//! tuneAllReduceStrategies. Collective over the tensor parallel group.
+void setupAllReduceStrategyTable(AllReduceBuffers const& buffers, std::size_t maxMessageBytes,
+    BufferManager const& manager, WorldConfig const& worldConfig);
+
+} // namespace tensorrt_llm::runtime
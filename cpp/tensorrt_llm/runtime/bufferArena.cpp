@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/bufferArena.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <cstdint>
+#include <optional>
+
+using namespace tensorrt_llm::runtime;
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+// Alignment of each tensor in the arena, as for separate allocations
+constexpr std::size_t kAlignment = 256;
+} // namespace
+
+BufferArena::BufferArena(std::vector<TensorPtr*> const& tensors, BufferManager const& manager)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    std::vector<TensorPtr*> arenaTensors;
+    std::vector<std::size_t> offsets;
+    std::optional<MemoryType> memoryType;
+    std::size_t size{0};
+    for (auto* tensor : tensors)
+    {
+        if (*tensor == nullptr)
+        {
+            continue;
+        }
+        auto const tensorMemoryType = (*tensor)->getMemoryType();
+        TLLM_CHECK_WITH_INFO(!memoryType || *memoryType == tensorMemoryType,
+            "All the tensors of an arena must have the same memory type.");
+        memoryType = tensorMemoryType;
+        auto const capacityInBytes = (*tensor)->getCapacity() * BufferDataType((*tensor)->getDataType()).getSize();
+        offsets.push_back(size);
+        size += tc::ceilDiv(capacityInBytes, kAlignment) * kAlignment;
+        arenaTensors.push_back(tensor);
+    }
+    if (size == 0)
+    {
+        return;
+    }
+
+    mBuffer = manager.allocate(*memoryType, size);
+    auto* base = static_cast<std::uint8_t*>(mBuffer->data());
+    for (std::size_t i = 0; i < arenaTensors.size(); ++i)
+    {
+        auto& tensor = *arenaTensors[i];
+        TensorPtr view
+            = ITensor::wrap(base + offsets[i], tensor->getDataType(), tensor->getShape(), tensor->getCapacity());
+        if (tensor->getSize() > 0)
+        {
+            manager.copy(*tensor, *view);
+        }
+        tensor = std::move(view);
+    }
+    TLLM_LOG_DEBUG("Arena of %zu bytes for %zu tensors", size, arenaTensors.size());
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Single allocation backing a set of tensors that are reshaped with the batch.
+//! \details The tensors are first reshaped to their largest shape, then the arena allocates their total capacity at
+//! once and replaces each of them by a view of its own part of the allocation, with the same shape, capacity and
+//! content. Reshapes up to that capacity only change the shape and never reach the allocator, a reshape beyond it
+//! throws std::bad_alloc. Views taken from the tensors before they were replaced still refer to the old memory.
+class BufferArena
+{
+public:
+    using TensorPtr = ITensor::SharedPtr;
+
+    //! \param tensors Tensors of the same memory type, null ones are skipped.
+    BufferArena(std::vector<TensorPtr*> const& tensors, BufferManager const& manager);
+
+    [[nodiscard]] std::size_t getSizeInBytes() const
+    {
+        return mBuffer ? mBuffer->getSizeInBytes() : 0;
+    }
+
+private:
+    IBuffer::SharedPtr mBuffer;
+};
+
+} // namespace tensorrt_llm::runtime
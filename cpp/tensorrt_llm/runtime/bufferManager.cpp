@@ -15,6 +15,7 @@
  */
 #include "bufferManager.h"
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/pinnedStagingRing.h"
 #include "tllmBuffers.h"
 
 #include <cstring>
@@ -32,8 +33,9 @@ BufferManager::BufferManager(CudaStreamPtr stream, bool trimPool)
     , mTrimPool{trimPool}
 {
     TLLM_CHECK_WITH_INFO(static_cast<bool>(mStream), "Undefined CUDA stream");
-    thread_local static std::unordered_set<int> initializedDevices(8);
     auto const device = mStream->getDevice();
+    mStaging = &PinnedStagingRing::getInstance(device);
+    thread_local static std::unordered_set<int> initializedDevices(8);
     if (initializedDevices.find(device) == initializedDevices.end())
     {
         initializedDevices.insert(device);
@@ -126,6 +128,10 @@ void BufferManager::copy(void const* src, IBuffer& dst, MemoryType srcType) cons
         {
             std::memcpy(dst.data(), src, dst.getSizeInBytes());
         }
+        else if (srcType == MemoryType::kCPU)
+        {
+            copyToDevice(dst.data(), src, dst.getSizeInBytes());
+        }
         else
         {
             TLLM_CUDA_CHECK(cudaMemcpyAsync(dst.data(), src, dst.getSizeInBytes(), cudaMemcpyDefault, mStream->get()));
@@ -141,6 +147,10 @@ void BufferManager::copy(IBuffer const& src, void* dst, MemoryType dstType) cons
         {
             std::memcpy(dst, src.data(), src.getSizeInBytes());
         }
+        else if (src.getMemoryType() == MemoryType::kCPU)
+        {
+            copyToDevice(dst, src.data(), src.getSizeInBytes());
+        }
         else
         {
             TLLM_CUDA_CHECK(cudaMemcpyAsync(dst, src.data(), src.getSizeInBytes(), cudaMemcpyDefault, mStream->get()));
@@ -148,6 +158,14 @@ void BufferManager::copy(IBuffer const& src, void* dst, MemoryType dstType) cons
     }
 }
 
+void BufferManager::copyToDevice(void* dst, void const* src, std::size_t size) const
+{
+    if (!mStaging->copyToDevice(dst, src, size, *mStream))
+    {
+        TLLM_CUDA_CHECK(cudaMemcpyAsync(dst, src, size, cudaMemcpyDefault, mStream->get()));
+    }
+}
+
 void BufferManager::copy(IBuffer const& src, IBuffer& dst) const
 {
     TLLM_CHECK_WITH_INFO(src.getDataType() == dst.getDataType(),
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cudaGraphBucketExecutor.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/startupProfiler.h"
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+//! Captures a stream until end() is called. The capture is aborted if it isn't ended, e.g. when the captured work
+//! throws, so that the stream can be used again.
+class StreamCapture
+{
+public:
+    using GraphPtr = std::unique_ptr<std::remove_pointer_t<cudaGraph_t>, decltype(&cudaGraphDestroy)>;
+
+    explicit StreamCapture(cudaStream_t stream)
+        : mStream{stream}
+    {
+        TLLM_CUDA_CHECK(cudaStreamBeginCapture(mStream, cudaStreamCaptureModeThreadLocal));
+        mCapturing = true;
+    }
+
+    ~StreamCapture()
+    {
+        if (mCapturing)
+        {
+            cudaGraph_t graph{nullptr};
+            if (cudaStreamEndCapture(mStream, &graph) == cudaSuccess && graph != nullptr)
+            {
+                cudaGraphDestroy(graph);
+            }
+            // Clear the error of the invalidated capture
+            cudaGetLastError();
+        }
+    }
+
+    StreamCapture(StreamCapture const&) = delete;
+    StreamCapture& operator=(StreamCapture const&) = delete;
+
+    GraphPtr end()
+    {
+        mCapturing = false;
+        cudaGraph_t graph{nullptr};
+        TLLM_CUDA_CHECK(cudaStreamEndCapture(mStream, &graph));
+        return GraphPtr{graph, &cudaGraphDestroy};
+    }
+
+private:
+    cudaStream_t mStream;
+    bool mCapturing{false};
+};
+
+} // namespace
+
+CudaGraphBucketExecutor::CudaGraphBucketExecutor(SizeType32 maxBatchSize)
+    : mBuckets{makeBuckets(maxBatchSize)}
+{
+}
+
+CudaGraphBucketExecutor::~CudaGraphBucketExecutor()
+{
+    try
+    {
+        clear();
+    }
+    catch (std::exception& e)
+    {
+        TLLM_LOG_EXCEPTION(e);
+    }
+}
+
+std::vector<SizeType32> CudaGraphBucketExecutor::makeBuckets(SizeType32 maxBatchSize)
+{
+    TLLM_CHECK_WITH_INFO(maxBatchSize > 0, "maxBatchSize must be positive.");
+    std::vector<SizeType32> buckets;
+    for (SizeType32 bucket = 1; bucket < maxBatchSize; bucket *= 2)
+    {
+        buckets.push_back(bucket);
+    }
+    buckets.push_back(maxBatchSize);
+    return buckets;
+}
+
+SizeType32 CudaGraphBucketExecutor::getBucket(SizeType32 batchSize) const
+{
+    TLLM_CHECK_WITH_INFO(0 < batchSize && batchSize <= mBuckets.back(), "Batch size %d is not in [1, %d].",
+        batchSize, mBuckets.back());
+    return *std::lower_bound(mBuckets.begin(), mBuckets.end(), batchSize);
+}
+
+void CudaGraphBucketExecutor::checkBucket(SizeType32 bucket) const
+{
+    TLLM_CHECK_WITH_INFO(std::binary_search(mBuckets.begin(), mBuckets.end(), bucket), "%d is not a bucket.", bucket);
+}
+
+void CudaGraphBucketExecutor::prepare(SizeType32 bucket, TllmRuntime const& runtime, SizeType32 contextIndex)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    checkBucket(bucket);
+    auto const startupScope = StartupProfiler::getInstance().scope(StartupPhase::kCUDA_GRAPH_CAPTURE);
+    auto& stream = runtime.getStream();
+
+    StreamCapture capture{stream.get()};
+    TLLM_CHECK_WITH_INFO(runtime.executeContext(contextIndex),
+        "Executing TRT engine for the CUDA graph of bucket %d failed!", bucket);
+    auto const graph = capture.end();
+
+    auto it = mInstances.find(bucket);
+    if (it != mInstances.end() && cudaGraphExecUpdate(it->second, graph.get(), nullptr) == cudaSuccess)
+    {
+        ++mStats.numUpdates;
+    }
+    else
+    {
+        if (it != mInstances.end())
+        {
+            // Clear the error of the failed update
+            cudaGetLastError();
+            TLLM_CUDA_CHECK(cudaGraphExecDestroy(it->second));
+            mInstances.erase(it);
+        }
+        cudaGraphExec_t instance;
+        TLLM_CUDA_CHECK(cudaGraphInstantiate(&instance, graph.get(), nullptr, nullptr, 0));
+        it = mInstances.emplace(bucket, instance).first;
+        ++mStats.numInstantiations;
+    }
+
+    TLLM_CUDA_CHECK(cudaGraphUpload(it->second, stream.get()));
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+void CudaGraphBucketExecutor::launch(SizeType32 bucket, CudaStream const& stream)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    auto const it = mInstances.find(bucket);
+    TLLM_CHECK_WITH_INFO(it != mInstances.end(), "No graph was prepared for bucket %d.", bucket);
+    TLLM_CUDA_CHECK(cudaGraphLaunch(it->second, stream.get()));
+    ++mStats.numLaunches;
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+void CudaGraphBucketExecutor::clear()
+{
+    for (auto const& [bucket, instance] : mInstances)
+    {
+        TLLM_CUDA_CHECK(cudaGraphExecDestroy(instance));
+    }
+    mInstances.clear();
+}
+
+} // namespace tensorrt_llm::runtime
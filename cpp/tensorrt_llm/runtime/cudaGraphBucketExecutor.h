@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tllmRuntime.h"
+
+#include <cuda_runtime_api.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+/**
+ * \brief CUDA graphs of generation steps, one per batch size bucket.
+ * \details Buckets are the powers of two up to the max batch size, plus the max batch size itself. A generation step
+ * of batch size n runs the graph of the smallest bucket holding n, with its inputs padded to the bucket size, so the
+ * launch overhead of a step is a single graph launch while only a handful of graphs are captured. Each bucket needs
+ * its own execution context, since a graph captures the shapes and addresses bound to the context it was captured
+ * from. Graphs are captured again when the context is enqueued differently, and updated in place when the topology
+ * is unchanged.
+ */
+class CudaGraphBucketExecutor
+{
+public:
+    struct Stats
+    {
+        //! Graphs instantiated, including the ones whose update failed.
+        std::int64_t numInstantiations{0};
+        //! Captures applied to an existing graph instance.
+        std::int64_t numUpdates{0};
+        std::int64_t numLaunches{0};
+    };
+
+    explicit CudaGraphBucketExecutor(SizeType32 maxBatchSize);
+
+    ~CudaGraphBucketExecutor();
+
+    CudaGraphBucketExecutor(CudaGraphBucketExecutor const&) = delete;
+    CudaGraphBucketExecutor& operator=(CudaGraphBucketExecutor const&) = delete;
+
+    [[nodiscard]] static std::vector<SizeType32> makeBuckets(SizeType32 maxBatchSize);
+
+    [[nodiscard]] std::vector<SizeType32> const& getBuckets() const noexcept
+    {
+        return mBuckets;
+    }
+
+    /**
+     * \brief The smallest bucket holding a batch.
+     */
+    [[nodiscard]] SizeType32 getBucket(SizeType32 batchSize) const;
+
+    /**
+     * \brief Number of dummy requests to add to a batch to fill its bucket.
+     */
+    [[nodiscard]] SizeType32 getNumPaddingSlots(SizeType32 batchSize) const
+    {
+        return getBucket(batchSize) - batchSize;
+    }
+
+    [[nodiscard]] bool hasGraph(SizeType32 bucket) const
+    {
+        return mInstances.count(bucket) > 0;
+    }
+
+    /**
+     * \brief Capture the execution of a context whose inputs were set for the bucket size, and instantiate or update
+     * the graph of the bucket. Throws if the execution fails, after aborting the capture.
+     */
+    void prepare(SizeType32 bucket, TllmRuntime const& runtime, SizeType32 contextIndex);
+
+    void launch(SizeType32 bucket, CudaStream const& stream);
+
+    void clear();
+
+    [[nodiscard]] Stats const& getStats() const noexcept
+    {
+        return mStats;
+    }
+
+private:
+    void checkBucket(SizeType32 bucket) const;
+
+    std::vector<SizeType32> mBuckets;
+    std::unordered_map<SizeType32, cudaGraphExec_t> mInstances;
+    Stats mStats;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include "tensorrt_llm/common/envUtils.h"
+
+namespace tensorrt_llm::runtime
+{
+
+int CudaStream::getCudaPriority(StreamPriority priority)
+{
+    if (priority == StreamPriority::kNORMAL || !common::getEnvStreamPriorities())
+    {
+        return 0;
+    }
+    // Lower numbers are higher priorities
+    int leastPriority{0};
+    int greatestPriority{0};
+    TLLM_CUDA_CHECK(::cudaDeviceGetStreamPriorityRange(&leastPriority, &greatestPriority));
+    return priority == StreamPriority::kHIGH ? greatestPriority : leastPriority;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/dataParallelExecutor.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <iterator>
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+//! Timeout of the waits of the collectors, which bounds the latency of shutdown
+auto constexpr kCOLLECT_TIMEOUT = std::chrono::milliseconds{10};
+} // namespace
+
+DataParallelExecutor::DataParallelExecutor(std::filesystem::path const& modelPath, executor::ModelType modelType,
+    executor::ExecutorConfig const& executorConfig, DataParallelConfig const& config)
+    : mRouter{static_cast<SizeType32>(config.deviceIds.size()), config.tokensPerBlock, config.prefixWeight}
+    , mGlobalIds(config.deviceIds.size())
+{
+    TLLM_CHECK_WITH_INFO(executorConfig.getIterStatsMaxIterations() > 0,
+        "The replicas are routed by their KV cache stats, iterStatsMaxIterations must be positive.");
+    for (auto const deviceId : config.deviceIds)
+    {
+        auto replicaConfig = executorConfig;
+        replicaConfig.setParallelConfig(executor::ParallelConfig{executor::CommunicationType::kMPI,
+            executor::CommunicationMode::kLEADER, std::vector<SizeType32>{deviceId}});
+        mReplicas.push_back(std::make_unique<executor::Executor>(modelPath, modelType, replicaConfig));
+    }
+    for (SizeType32 replica = 0; replica < getNumReplicas(); ++replica)
+    {
+        mCollectors.emplace_back(&DataParallelExecutor::collectLoop, this, replica);
+    }
+    TLLM_LOG_INFO("Serving %d data parallel replicas", getNumReplicas());
+}
+
+DataParallelExecutor::~DataParallelExecutor()
+{
+    shutdown();
+}
+
+DataParallelExecutor::IdType DataParallelExecutor::enqueueRequest(executor::Request const& request)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    TLLM_CHECK_WITH_INFO(!mShutdown, "Can't enqueue requests after shutdown.");
+    refreshStatsLocked();
+    auto const decision = mRouter.route(request.getInputTokenIds());
+    // The collector of the replica maps the responses under the lock, so it can't see them before the mapping
+    auto const replicaRequestId = mReplicas[decision.replica]->enqueueRequest(request);
+    auto const requestId = mNextRequestId++;
+    mRequests.emplace(requestId, InFlightRequest{decision.replica, replicaRequestId, decision.numReservedBlocks});
+    mGlobalIds[decision.replica].emplace(replicaRequestId, requestId);
+    TLLM_LOG_DEBUG("Routed request %lu to replica %d, %d cached blocks", requestId, decision.replica,
+        decision.numMatchedBlocks);
+    return requestId;
+}
+
+std::vector<executor::Response> DataParallelExecutor::awaitResponses(
+    std::optional<std::chrono::milliseconds> const& timeout)
+{
+    std::unique_lock<std::mutex> lock(mResponseMutex);
+    auto const ready = [this] { return !mResponses.empty(); };
+    if (timeout)
+    {
+        mResponseCv.wait_for(lock, *timeout, ready);
+    }
+    else
+    {
+        mResponseCv.wait(lock, ready);
+    }
+    return std::exchange(mResponses, {});
+}
+
+void DataParallelExecutor::cancelRequest(IdType requestId)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (auto const it = mRequests.find(requestId); it != mRequests.end())
+    {
+        mReplicas[it->second.replica]->cancelRequest(it->second.replicaRequestId);
+    }
+}
+
+void DataParallelExecutor::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mShutdown)
+        {
+            return;
+        }
+        mShutdown = true;
+    }
+    for (auto& collector : mCollectors)
+    {
+        collector.join();
+    }
+    for (auto& replica : mReplicas)
+    {
+        replica->shutdown();
+    }
+}
+
+std::optional<SizeType32> DataParallelExecutor::getReplica(IdType requestId) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (auto const it = mRequests.find(requestId); it != mRequests.end())
+    {
+        return it->second.replica;
+    }
+    return std::nullopt;
+}
+
+void DataParallelExecutor::refreshStatsLocked()
+{
+    for (SizeType32 replica = 0; replica < getNumReplicas(); ++replica)
+    {
+        auto const stats = mReplicas[replica]->getLatestIterationStats();
+        if (!stats.empty() && stats.back().kvCacheStats)
+        {
+            auto const& kvCacheStats = *stats.back().kvCacheStats;
+            mRouter.updateStats(replica, kvCacheStats.freeNumBlocks, kvCacheStats.maxNumBlocks);
+        }
+    }
+}
+
+void DataParallelExecutor::collectLoop(SizeType32 replica)
+{
+    auto& executor = *mReplicas[replica];
+    while (true)
+    {
+        auto responses = executor.awaitResponses(kCOLLECT_TIMEOUT);
+        std::vector<executor::Response> translated;
+        bool shutdown{false};
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (auto const& response : responses)
+            {
+                auto const globalIt = mGlobalIds[replica].find(response.getRequestId());
+                if (globalIt == mGlobalIds[replica].end())
+                {
+                    TLLM_LOG_WARNING("Dropping a response of replica %d to unknown request %lu", replica,
+                        response.getRequestId());
+                    continue;
+                }
+                auto const requestId = globalIt->second;
+                auto& request = mRequests.at(requestId);
+                // The stats of the replica count the blocks of a request once it is scheduled
+                mRouter.release(replica, std::exchange(request.numReservedBlocks, 0));
+                auto const isFinal = response.hasError() || response.getResult().isFinal;
+                if (isFinal)
+                {
+                    mGlobalIds[replica].erase(globalIt);
+                    mRequests.erase(requestId);
+                }
+                translated.push_back(response.hasError() ? executor::Response{requestId, response.getErrorMsg()}
+                                                         : executor::Response{requestId, response.getResult()});
+            }
+            shutdown = mShutdown;
+        }
+        if (!translated.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mResponseMutex);
+                mResponses.insert(mResponses.end(), std::make_move_iterator(translated.begin()),
+                    std::make_move_iterator(translated.end()));
+            }
+            mResponseCv.notify_all();
+        }
+        if (shutdown)
+        {
+            break;
+        }
+    }
+}
+
+} // namespace tensorrt_llm::runtime
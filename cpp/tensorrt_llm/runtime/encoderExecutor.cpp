@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/encoderExecutor.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/numericSentinel.h"
+#include "tensorrt_llm/runtime/tllmRuntime.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+auto constexpr kINPUT_IDS = "input_ids";
+auto constexpr kINPUT_LENGTHS = "input_lengths";
+auto constexpr kTOKEN_TYPE_IDS = "token_type_ids";
+auto constexpr kPOSITION_IDS = "position_ids";
+auto constexpr kMAX_INPUT_LENGTH = "max_input_length";
+
+bool hasInput(nvinfer1::ICudaEngine const& engine, char const* name)
+{
+    return engine.getTensorIOMode(name) == nvinfer1::TensorIOMode::kINPUT;
+}
+
+template <typename T>
+void appendRows(ITensor const& hostTensor, std::size_t beginRow, std::size_t endRow, std::size_t rowSize,
+    std::vector<float>& output)
+{
+    auto const* data = bufferCast<T>(hostTensor);
+    for (auto i = beginRow * rowSize; i < endRow * rowSize; ++i)
+    {
+        output.push_back(static_cast<float>(data[i]));
+    }
+}
+
+void appendRows(ITensor const& hostTensor, std::size_t beginRow, std::size_t endRow, std::size_t rowSize,
+    std::vector<float>& output)
+{
+    switch (hostTensor.getDataType())
+    {
+    case nvinfer1::DataType::kFLOAT: appendRows<float>(hostTensor, beginRow, endRow, rowSize, output); break;
+    case nvinfer1::DataType::kHALF: appendRows<half>(hostTensor, beginRow, endRow, rowSize, output); break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16: appendRows<__nv_bfloat16>(hostTensor, beginRow, endRow, rowSize, output); break;
+#endif
+    default:
+        TLLM_THROW("Unsupported encoder output type %d", static_cast<std::int32_t>(hostTensor.getDataType()));
+    }
+}
+} // namespace
+
+EncoderExecutor::EncoderExecutor(
+    std::filesystem::path const& enginePath, EncoderExecutorConfig const& config, nvinfer1::ILogger& logger)
+    : mConfig{config}
+    , mPlanner{config.maxBatchSize, config.maxNumTokens}
+    , mRuntime{std::make_unique<TllmRuntime>(enginePath, config.gpuWeightsPercent, logger)}
+    , mStream{std::make_shared<CudaStream>(config.streamPriority)}
+    , mBufferManager{mStream}
+    , mBatchPool{kMAX_IN_FLIGHT, [](InFlightBatch& batch) { batch.reset(); }}
+{
+    auto const& engine = mRuntime->getEngine();
+    auto const* outputName = mConfig.outputTensorName.c_str();
+    TLLM_CHECK_WITH_INFO(engine.getTensorIOMode(outputName) == nvinfer1::TensorIOMode::kOUTPUT,
+        "The encoder engine has no output named %s", outputName);
+    TLLM_CHECK_WITH_INFO(hasInput(engine, kINPUT_IDS) && engine.getTensorShape(kINPUT_IDS).nbDims == 1,
+        "In-flight batching of an encoder requires an engine built with remove_input_padding");
+    mRuntime->addContext(0);
+
+    // Sized for the largest batch, the output has a row per token or per request
+    auto const outputShape = engine.getTensorShape(outputName);
+    auto const outputType = engine.getTensorDataType(outputName);
+    auto rowShape = outputShape;
+    rowShape.nbDims = outputShape.nbDims - 1;
+    for (SizeType32 d = 1; d < outputShape.nbDims; ++d)
+    {
+        TLLM_CHECK_WITH_INFO(outputShape.d[d] > 0, "The rows of %s must have a static shape", outputName);
+        rowShape.d[d - 1] = outputShape.d[d];
+    }
+    auto const maxNumRows = std::max(mConfig.maxNumTokens, mConfig.maxBatchSize);
+    auto const maxOutputShape = ITensor::makeShape({maxNumRows, static_cast<SizeType32>(ITensor::volume(rowShape))});
+    for (std::size_t slot = 0; slot < kMAX_IN_FLIGHT; ++slot)
+    {
+        mOutputs[slot] = mBufferManager.gpu(maxOutputShape, outputType);
+        mHostOutputs[slot] = BufferManager::pinned(maxOutputShape, outputType);
+        if (NumericSentinel::getInstance().isEnabled())
+        {
+            mNonFiniteRows[slot] = BufferManager::pinned(ITensor::makeShape({maxNumRows}), nvinfer1::DataType::kINT32);
+        }
+    }
+    mWorker = std::thread(&EncoderExecutor::workerLoop, this);
+}
+
+EncoderExecutor::~EncoderExecutor()
+{
+    shutdown();
+}
+
+EncoderExecutor::IdType EncoderExecutor::enqueueRequest(
+    std::vector<TokenIdType> inputTokenIds, std::optional<std::vector<TokenIdType>> tokenTypeIds)
+{
+    TLLM_CHECK_WITH_INFO(!tokenTypeIds || tokenTypeIds->size() == inputTokenIds.size(),
+        "Expected %zu token type ids, got %zu", inputTokenIds.size(), tokenTypeIds ? tokenTypeIds->size() : 0);
+    auto const length = static_cast<SizeType32>(inputTokenIds.size());
+
+    IdType id{0};
+    {
+        std::lock_guard<std::mutex> lock(mRequestMutex);
+        TLLM_CHECK_WITH_INFO(!mShutdown, "The encoder executor is shut down");
+        id = mNextRequestId++;
+        if (mPlanner.fits(length))
+        {
+            // Without token type ids, the zeros are written when the batch is packed
+            mRequests.push_back(
+                {id, std::move(inputTokenIds), tokenTypeIds ? std::move(*tokenTypeIds) : std::vector<TokenIdType>{}});
+            mRequestCv.notify_one();
+            return id;
+        }
+    }
+    // Never schedulable, completed right away like the executor does for invalid requests
+    EncoderResponse response;
+    response.requestId = id;
+    response.errorMsg = "Request of " + std::to_string(length) + " tokens, expected 1 to "
+        + std::to_string(mPlanner.getMaxNumTokens());
+    addResponses({std::move(response)});
+    return id;
+}
+
+std::vector<EncoderResponse> EncoderExecutor::awaitResponses(std::optional<std::chrono::milliseconds> const& timeout)
+{
+    std::unique_lock<std::mutex> lock(mResponseMutex);
+    auto const hasResponses = [this]() { return !mResponses.empty(); };
+    if (timeout)
+    {
+        mResponseCv.wait_for(lock, *timeout, hasResponses);
+    }
+    else
+    {
+        mResponseCv.wait(lock, hasResponses);
+    }
+    std::vector<EncoderResponse> responses;
+    responses.swap(mResponses);
+    return responses;
+}
+
+SizeType32 EncoderExecutor::getNumQueuedRequests() const
+{
+    std::lock_guard<std::mutex> lock(mRequestMutex);
+    return static_cast<SizeType32>(mRequests.size());
+}
+
+void EncoderExecutor::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mRequestMutex);
+        mShutdown = true;
+    }
+    mRequestCv.notify_all();
+    if (mWorker.joinable())
+    {
+        mWorker.join();
+    }
+}
+
+struct EncoderExecutor::InFlightBatch
+{
+    std::vector<Request> requests;
+    std::vector<SizeType32> lengths;
+    //! Packed inputs staged on the host, they keep their capacity across the batches
+    std::vector<TokenIdType> inputIds;
+    std::vector<TokenIdType> tokenTypeIds;
+    std::vector<SizeType32> positionIds;
+    //! Kept alive until the pass completes
+    TllmRuntime::TensorMap inputs;
+    ITensor::SharedPtr hostOutput;
+    //! Set for the output rows with non-finite values, if checked
+    ITensor::SharedPtr nonFiniteRows;
+    CudaEvent done;
+
+    //! \brief Clears the batch for reuse, keeping the capacity of its vectors and its event.
+    void reset()
+    {
+        requests.clear();
+        lengths.clear();
+        inputIds.clear();
+        tokenTypeIds.clear();
+        positionIds.clear();
+        inputs.clear();
+        hostOutput.reset();
+        nonFiniteRows.reset();
+    }
+};
+
+void EncoderExecutor::workerLoop()
+{
+    // Completed in order, the output slot of a batch is free once the batch before it completed
+    std::deque<InFlightBatchPtr> inFlight;
+    std::size_t nextSlot{0};
+    while (true)
+    {
+        std::vector<Request> requests;
+        {
+            std::unique_lock<std::mutex> lock(mRequestMutex);
+            if (inFlight.empty())
+            {
+                mRequestCv.wait(lock, [this]() { return mShutdown || !mRequests.empty(); });
+                if (mRequests.empty())
+                {
+                    return;
+                }
+            }
+            if (inFlight.size() < kMAX_IN_FLIGHT)
+            {
+                requests = takeBatch();
+            }
+        }
+
+        bool const tookRequests = !requests.empty();
+        if (tookRequests)
+        {
+            try
+            {
+                inFlight.push_back(enqueueForward(requests, nextSlot));
+                nextSlot = (nextSlot + 1) % kMAX_IN_FLIGHT;
+            }
+            catch (std::exception const& e)
+            {
+                TLLM_LOG_ERROR("Encoder forward pass failed: %s", e.what());
+                addErrorResponses(requests, e.what());
+            }
+        }
+
+        // The oldest batch completes once the pipeline is full or there's nothing to enqueue behind it
+        if (!inFlight.empty() && (!tookRequests || inFlight.size() == kMAX_IN_FLIGHT))
+        {
+            auto batch = std::move(inFlight.front());
+            inFlight.pop_front();
+            try
+            {
+                completeForward(*batch);
+            }
+            catch (std::exception const& e)
+            {
+                TLLM_LOG_ERROR("Encoder forward pass of %zu requests failed: %s", batch->requests.size(), e.what());
+                addErrorResponses(batch->requests, e.what());
+            }
+        }
+    }
+}
+
+std::vector<EncoderExecutor::Request> EncoderExecutor::takeBatch()
+{
+    std::vector<SizeType32> lengths;
+    auto const numCandidates = std::min(mRequests.size(), static_cast<std::size_t>(mPlanner.getMaxBatchSize()));
+    lengths.reserve(numCandidates);
+    for (std::size_t i = 0; i < numCandidates; ++i)
+    {
+        lengths.push_back(static_cast<SizeType32>(mRequests[i].inputTokenIds.size()));
+    }
+    auto const numRequests = mPlanner.plan(lengths);
+    std::vector<Request> requests;
+    requests.reserve(numRequests);
+    for (SizeType32 i = 0; i < numRequests; ++i)
+    {
+        requests.push_back(std::move(mRequests.front()));
+        mRequests.pop_front();
+    }
+    return requests;
+}
+
+EncoderExecutor::InFlightBatchPtr EncoderExecutor::enqueueForward(std::vector<Request>& requests, std::size_t slot)
+{
+    auto batch = mBatchPool.acquire();
+    auto const batchSize = static_cast<SizeType32>(requests.size());
+    auto& lengths = batch->lengths;
+    auto& inputIds = batch->inputIds;
+    auto& tokenTypeIds = batch->tokenTypeIds;
+    auto& positionIds = batch->positionIds;
+    lengths.reserve(batchSize);
+    for (auto const& request : requests)
+    {
+        auto const length = static_cast<SizeType32>(request.inputTokenIds.size());
+        lengths.push_back(length);
+        inputIds.insert(inputIds.end(), request.inputTokenIds.begin(), request.inputTokenIds.end());
+        if (request.tokenTypeIds.empty())
+        {
+            tokenTypeIds.insert(tokenTypeIds.end(), length, 0);
+        }
+        else
+        {
+            tokenTypeIds.insert(tokenTypeIds.end(), request.tokenTypeIds.begin(), request.tokenTypeIds.end());
+        }
+        for (SizeType32 position = 0; position < length; ++position)
+        {
+            positionIds.push_back(position);
+        }
+    }
+    auto const numTokens = static_cast<SizeType32>(inputIds.size());
+    auto const maxLength = *std::max_element(lengths.begin(), lengths.end());
+
+    // Packed without padding: the tokens of all the requests on one dimension, delimited by their lengths
+    auto const& engine = mRuntime->getEngine();
+    auto& inputs = batch->inputs;
+    inputs.emplace(kINPUT_IDS, mBufferManager.copyFrom(inputIds, ITensor::makeShape({numTokens}), MemoryType::kGPU));
+    inputs.emplace(
+        kINPUT_LENGTHS, mBufferManager.copyFrom(lengths, ITensor::makeShape({batchSize}), MemoryType::kGPU));
+    if (hasInput(engine, kTOKEN_TYPE_IDS))
+    {
+        inputs.emplace(kTOKEN_TYPE_IDS,
+            mBufferManager.copyFrom(tokenTypeIds, ITensor::makeShape({numTokens}), MemoryType::kGPU));
+    }
+    if (hasInput(engine, kPOSITION_IDS))
+    {
+        inputs.emplace(
+            kPOSITION_IDS, mBufferManager.copyFrom(positionIds, ITensor::makeShape({numTokens}), MemoryType::kGPU));
+    }
+    if (hasInput(engine, kMAX_INPUT_LENGTH))
+    {
+        // Only the shape is read, it gives the longest request to the attention plugin
+        inputs.emplace(
+            kMAX_INPUT_LENGTH, mBufferManager.gpu(ITensor::makeShape({maxLength}), nvinfer1::DataType::kINT32));
+    }
+
+    // Enqueued after the previous batch on the same stream, so the shared activation memory is never used by both
+    TllmRuntime::TensorMap outputs{{mConfig.outputTensorName, mOutputs[slot]}};
+    mRuntime->setInputTensors(0, inputs);
+    mRuntime->setOutputTensors(0, outputs);
+    TLLM_CHECK_WITH_INFO(mRuntime->executeContext(0, *mStream), "Executing the encoder engine failed");
+
+    auto const& output = *mOutputs[slot];
+    if (auto const& nonFiniteRows = mNonFiniteRows[slot])
+    {
+        // The slot is free, the checks of the batch that used it before completed
+        auto const numRows = static_cast<std::size_t>(output.getShape().d[0]);
+        auto* rowFlags = bufferCast<std::int32_t>(*nonFiniteRows);
+        std::fill_n(rowFlags, numRows, 0);
+        NumericSentinel::getInstance().check(SentinelSite::kENCODER_OUTPUT, output.data(), output.getDataType(),
+            numRows, numRows == 0 ? 0 : output.getSize() / numRows, mStream->get(), rowFlags);
+        batch->nonFiniteRows = nonFiniteRows;
+    }
+    batch->hostOutput = mHostOutputs[slot];
+    batch->hostOutput->reshape(output.getShape());
+    mBufferManager.copy(output, *batch->hostOutput);
+    mStream->record(batch->done);
+    batch->requests = std::move(requests);
+    return batch;
+}
+
+void EncoderExecutor::completeForward(InFlightBatch& batch)
+{
+    batch.done.synchronize();
+
+    // Outputs per token are split by the lengths of the requests, outputs per request by rows
+    auto const& hostOutput = *batch.hostOutput;
+    auto const& lengths = batch.lengths;
+    auto const batchSize = static_cast<SizeType32>(batch.requests.size());
+    auto const numTokens = std::accumulate(lengths.begin(), lengths.end(), SizeType32{0});
+    auto const shape = hostOutput.getShape();
+    auto const numRows = static_cast<SizeType32>(shape.d[0]);
+    TLLM_CHECK_WITH_INFO(numRows == numTokens || numRows == batchSize, "Expected %d or %d rows in %s, got %d",
+        numTokens, batchSize, mConfig.outputTensorName.c_str(), numRows);
+    auto const perToken = numRows == numTokens;
+    auto const rowSize = numRows == 0 ? 0 : hostOutput.getSize() / numRows;
+    std::vector<SizeType32> rowShape;
+    for (SizeType32 d = 1; d < shape.nbDims; ++d)
+    {
+        rowShape.push_back(static_cast<SizeType32>(shape.d[d]));
+    }
+
+    std::vector<EncoderResponse> responses(batchSize);
+    std::size_t beginRow{0};
+    for (SizeType32 i = 0; i < batchSize; ++i)
+    {
+        auto const numRequestRows = perToken ? static_cast<std::size_t>(lengths[i]) : 1;
+        auto& response = responses[i];
+        response.requestId = batch.requests[i].id;
+        if (batch.nonFiniteRows)
+        {
+            auto const* rowFlags = bufferCast<std::int32_t>(*batch.nonFiniteRows);
+            if (std::any_of(rowFlags + beginRow, rowFlags + beginRow + numRequestRows, [](auto flag) { return flag; }))
+            {
+                response.errorMsg = "Non-finite or overflowing values in " + mConfig.outputTensorName;
+                beginRow += numRequestRows;
+                continue;
+            }
+        }
+        response.output.reserve(numRequestRows * rowSize);
+        appendRows(hostOutput, beginRow, beginRow + numRequestRows, rowSize, response.output);
+        if (perToken)
+        {
+            response.outputShape.push_back(lengths[i]);
+        }
+        response.outputShape.insert(response.outputShape.end(), rowShape.begin(), rowShape.end());
+        beginRow += numRequestRows;
+    }
+    addResponses(std::move(responses));
+}
+
+void EncoderExecutor::addErrorResponses(std::vector<Request> const& requests, std::string const& errorMsg)
+{
+    std::vector<EncoderResponse> responses(requests.size());
+    for (std::size_t i = 0; i < requests.size(); ++i)
+    {
+        responses[i].requestId = requests[i].id;
+        responses[i].errorMsg = errorMsg;
+    }
+    addResponses(std::move(responses));
+}
+
+void EncoderExecutor::addResponses(std::vector<EncoderResponse> responses)
+{
+    {
+        std::lock_guard<std::mutex> lock(mResponseMutex);
+        std::move(responses.begin(), responses.end(), std::back_inserter(mResponses));
+    }
+    mResponseCv.notify_all();
+}
+
+} // namespace tensorrt_llm::runtime
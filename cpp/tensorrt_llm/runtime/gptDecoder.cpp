@@ -98,6 +98,21 @@ void GptDecoder<T>::setup(
     mDynamicDecodeLayer->setup(batchSize, mSamplingConfig.beamWidth, batchSlotsPtr, setupParams);
 }
 
+template <typename T>
+void GptDecoder<T>::setupProbsTruncation(
+    ProbsTruncationConfig const& config, size_t batchSize, std::optional<TensorPtr> const& batchSlots)
+{
+    TLLM_CHECK_WITH_INFO(config.validate(), "Probs truncation config is invalid");
+
+    layers::SamplingSetupParams samplingParams;
+    samplingParams.min_p = config.minP;
+    samplingParams.typical_p = config.typicalP;
+    samplingParams.eta_cutoff = config.etaCutoff;
+
+    auto const batchSlotsPtr = batchSlots.has_value() ? bufferCast<SizeType32>(*(batchSlots.value())) : nullptr;
+    mDynamicDecodeLayer->setupProbsTruncation(batchSize, batchSlotsPtr, samplingParams);
+}
+
 namespace
 {
 void safeInsert(tc::TensorMap& map, std::string const& key, DecodingOutput::TensorPtr const& tensor)
@@ -304,6 +319,13 @@ std::shared_ptr<tl::DynamicDecodeOutputParams> prepareOutputs(
         outputParams->output_log_probs_tiled = tcc::toTllmTensor(*logProbsTiled);
     }
 
+    if (output.topLogProbs)
+    {
+        TLLM_CHECK_WITH_INFO(output.topLogProbIds, "topLogProbs require topLogProbIds");
+        outputParams->output_top_log_probs = tcc::toTllmTensor(*output.topLogProbs);
+        outputParams->output_top_log_prob_ids = tcc::toTllmTensor(*output.topLogProbIds);
+    }
+
     outputParams->beamHypotheses = std::make_unique<tensorrt_llm::kernels::BeamHypotheses>();
     if (output.beamHypotheses.outputIdsCBA)
     {
@@ -17,21 +17,63 @@
 
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/speculativeDecoding/common.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/numericSentinel.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
 
 #include <algorithm>
 #include <cassert>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <unordered_map>
 
 using namespace tensorrt_llm::runtime;
 
 namespace tc = tensorrt_llm::common;
 namespace tk = tensorrt_llm::kernels;
+namespace tksd = tensorrt_llm::kernels::speculative_decoding;
 
 namespace
 {
+//! \brief Draft acceptance rates and recommended draft lengths of the requests of a decoder, see
+//! GptDecoderBatch::getAdaptiveNumDraftTokens. They are kept beside GptDecoderBatch, whose layout is fixed by the
+//! prebuilt batch manager library, and created by setup() for speculative decoding only.
+struct DraftAcceptance
+{
+    ITensor::SharedPtr acceptanceRates; // [maxBatchSize], float, moving average of the draft acceptance rate, on gpu
+    ITensor::SharedPtr numDraftTokens;  // [maxBatchSize], recommended number of draft tokens per request, on gpu
+    // Upper bound of numDraftTokens, max draft path length for Medusa and maxDecodingEngineTokens - 1 for external
+    // draft tokens.
+    SizeType32 maxDraftLen{};
+};
+
+std::mutex draftAcceptancesMutex;
+std::unordered_map<GptDecoderBatch const*, std::shared_ptr<DraftAcceptance>> draftAcceptances;
+
+std::shared_ptr<DraftAcceptance> findDraftAcceptance(GptDecoderBatch const* decoder)
+{
+    std::lock_guard<std::mutex> lock(draftAcceptancesMutex);
+    auto const it = draftAcceptances.find(decoder);
+    return it != draftAcceptances.end() ? it->second : nullptr;
+}
+
+//! \brief Replace the draft acceptance of a decoder, null removes it.
+void setDraftAcceptance(GptDecoderBatch const* decoder, std::shared_ptr<DraftAcceptance> draftAcceptance)
+{
+    std::lock_guard<std::mutex> lock(draftAcceptancesMutex);
+    if (draftAcceptance)
+    {
+        draftAcceptances[decoder] = std::move(draftAcceptance);
+    }
+    else
+    {
+        draftAcceptances.erase(decoder);
+    }
+}
+
 SamplingConfig extractSamplingConfig(SamplingConfig const& batchSamplingConfig, SizeType32 batchIdx)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
@@ -293,8 +335,22 @@ void GptDecoderBatch::setup(executor::DecodingMode const& mode, SizeType32 maxBa
     {
         mMaxDecodingDecoderTokens = 1;
     }
+    auto const maxAdaptiveDraftLen = mSpeculativeDecodingMode.isMedusa()
+        ? modelConfig.getSpeculativeDecodingModulePtr()->getMaxDraftPathLen()
+        : maxTokensPerEngineStep - 1;
+    std::shared_ptr<DraftAcceptance> draftAcceptance;
+    if (maxAdaptiveDraftLen > 0)
+    {
+        draftAcceptance = std::make_shared<DraftAcceptance>();
+        draftAcceptance->acceptanceRates = mBufferManager.gpu(maxBatchSizeShape, nvinfer1::DataType::kFLOAT);
+        draftAcceptance->numDraftTokens = mBufferManager.gpu(maxBatchSizeShape, TRTDataType<SizeType32>::value);
+        draftAcceptance->maxDraftLen = maxAdaptiveDraftLen;
+        kernels::invokeFill(*draftAcceptance->acceptanceRates, 1.f, *mStream);
+        kernels::invokeFill(*draftAcceptance->numDraftTokens, maxAdaptiveDraftLen, *mStream);
+    }
+    setDraftAcceptance(this, std::move(draftAcceptance));
 
-    auto const numOfDecoders = fusedDecoder ? 1 : maxBatchSize;
+    auto const numOfDecoders = mFusedDecoder ? 1 : maxBatchSize;
 
     mStreams.resize(maxBatchSize);
     mDecoders.resize(numOfDecoders);
@@ -307,11 +363,11 @@ void GptDecoderBatch::setup(executor::DecodingMode const& mode, SizeType32 maxBa
     auto const device = mStream->getDevice();
     for (SizeType32 i = 0; i < maxBatchSize; ++i)
     {
-        mStreams[i] = std::make_shared<CudaStream>();
+        mStreams[i] = std::make_shared<CudaStream>(StreamPriority::kHIGH);
         TLLM_CHECK(mStreams[i]->getDevice() == device);
         if (i < numOfDecoders)
         {
-            auto maxBatchSizePerDecoder = fusedDecoder ? maxBatchSize : 1;
+            auto maxBatchSizePerDecoder = mFusedDecoder ? maxBatchSize : 1;
             mDecoders[i] = IGptDecoder::create(mode, dtype, maxBatchSizePerDecoder, maxBeamWidth, mVocabSize,
                 mVocabSizePadded, mMaxSequenceLength, mStreams[i], speculativeDecodingModulePtr);
         }
@@ -377,6 +433,21 @@ void GptDecoderBatch::setupSpeculativeDecoding(ModelConfig const& modelConfig)
 
 void GptDecoderBatch::newRequest(
     SizeType32 batchIdx, decoder_batch::Request const& request, SamplingConfig const& samplingConfig)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    auto const slotInit = setupNewRequest(batchIdx, request, samplingConfig);
+    auto const decoderIdx = mFusedDecoder ? 0 : batchIdx;
+    initNewRequests({slotInit}, mStreams[decoderIdx]);
+    if (!mFusedDecoder)
+    {
+        auto constexpr localBatchSize = 1;
+        mDecoders[decoderIdx]->setup(samplingConfig, localBatchSize);
+    }
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+kernels::DecoderNewRequest GptDecoderBatch::setupNewRequest(
+    SizeType32 batchIdx, decoder_batch::Request const& request, SamplingConfig const& samplingConfig)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
     TLLM_CHECK(batchIdx >= 0);
@@ -413,7 +484,6 @@ void GptDecoderBatch::newRequest(
     auto& dInput = mDecodingInputs.at(batchIdx);
 
     TensorPtr endIdTensorPtr{ITensor::slice(constPointerCast(dJointInput.endIds), batchIdx, localBatchSize)};
-    kernels::invokeFill(*endIdTensorPtr, endId, *stream);
     dInput = std::make_unique<DecodingInput>(
         inputLength, mMaxAttentionWindow, mSinkTokenLength, localBatchSize, dJointInput.logits, endIdTensorPtr);
 
@@ -430,10 +500,6 @@ void GptDecoderBatch::newRequest(
         manager.copy(*request.embeddingBias, *embeddingBiasSlice);
         dInput->embeddingBias = embeddingBiasSlice;
     }
-    else
-    {
-        manager.setZero(*embeddingBiasSlice);
-    }
 
     auto setupWords = [fusedDecoder = mFusedDecoder](SharedConstPtr& inputWordsList, TensorPtr const& requestWordsList,
                           SharedConstPtr& jointWordsPtrs, SharedConstPtr& jointWordsLens, SharedConstPtr& wordsPtrs,
@@ -476,10 +542,8 @@ void GptDecoderBatch::newRequest(
 
     TensorPtr sequenceLimitLength{
         ITensor::slice(constPointerCast(dJointInput.sequenceLimitLength), batchIdx, localBatchSize)};
-    kernels::invokeFill(*sequenceLimitLength, inputLength + maxNewTokens, *stream);
     dInput->sequenceLimitLength = std::move(sequenceLimitLength);
     TensorPtr inputLengths{ITensor::slice(constPointerCast(dJointInput.lengths), batchIdx, localBatchSize)};
-    kernels::invokeFill(*inputLengths, inputLength, *stream);
     dInput->lengths = inputLengths;
 
     // output
@@ -492,7 +556,6 @@ void GptDecoderBatch::newRequest(
     dOutput = std::make_unique<DecodingOutput>(outputIds);
 
     dOutput->finishedSum = ITensor::slice(dJointOutput.finishedSum, batchIdx, localBatchSize);
-    manager.setZero(*dOutput->finishedSum);
 
     dOutput->newTokensVec.resize(mMaxDecodingEngineTokens);
     for (SizeType32 ti = 0; ti < mMaxDecodingEngineTokens; ++ti)
@@ -500,16 +563,6 @@ void GptDecoderBatch::newRequest(
         TensorPtr newTokensStepView = ITensor::slice(dJointOutput.newTokensSteps, ti, 1);
         newTokensStepView->squeeze(0);
         dOutput->newTokensVec[ti] = ITensor::slice(newTokensStepView, batchIdx, localBatchSize);
-        manager.setZero(*dOutput->newTokensVec[ti]);
-    }
-
-    // FIXME(nkorobov): we call setZero mMaxDecodingEngineTokens times for only 1 element
-    for (SizeType32 ti = 0; ti < mMaxDecodingEngineTokens; ++ti)
-    {
-        TensorPtr finishedStepsView = std::move(ITensor::slice(mFinishedSteps, ti, 1));
-        finishedStepsView->squeeze(0);
-        TensorPtr finishedSteps = std::move(ITensor::slice(finishedStepsView, batchIdx, localBatchSize));
-        manager.setZero(*finishedSteps);
     }
 
     // cumLogProb is mandatory for beamWidth > 1
@@ -517,23 +570,18 @@ void GptDecoderBatch::newRequest(
     if ((samplingConfig.cumLogProbs.has_value() && samplingConfig.cumLogProbs->at(0)) || beamWidth > 1)
     {
         dOutput->cumLogProbs = ITensor::slice(dJointOutput.cumLogProbs, batchIdx, localBatchSize);
-        manager.setZero(*dOutput->cumLogProbs);
     }
 
     dOutput->logProbs = nullptr;
     if (samplingConfig.outputLogProbs.has_value() && samplingConfig.outputLogProbs->at(0))
     {
         dOutput->logProbs = ITensor::slice(dJointOutput.logProbs, batchIdx, localBatchSize);
-        manager.setZero(*dOutput->logProbs);
     }
 
     if (beamWidth > 1)
     {
-        kernels::invokeFill(
-            *IBuffer::slice(dOutput->cumLogProbs, 1, beamWidth - 1), DecodingOutput::kNegativeInfinity, *stream);
         dOutput->parentIds = ITensor::slice(dJointOutput.parentIds, batchIdx, localBatchSize);
         dOutput->parentIds->reshape(outputIdsShape);
-        manager.setZero(*dOutput->parentIds);
         dOutput->beamHypotheses = dJointOutput.beamHypotheses.slice(batchIdx, localBatchSize);
         dOutput->beamHypotheses.init(manager, endId);
     }
@@ -544,12 +592,11 @@ void GptDecoderBatch::newRequest(
         TLLM_CHECK(beamWidth == 1);
         newRequestSpeculativeDecoding(batchIdx, request, samplingConfig);
     }
-
-    // remaining
-    if (!mFusedDecoder)
+    else if (!mSpeculativeDecodingMode.isNone())
     {
-        mDecoders[decoderIdx]->setup(samplingConfig, localBatchSize);
+        newRequestWithoutSpeculation(batchIdx);
     }
+
     TLLM_CHECK_WITH_INFO(!mFusedDecoder || beamWidth == 1, "Fused decoder is not supported for beam search yet.");
     mBeamWidths[batchIdx] = beamWidth;
     mNbSteps[batchIdx] = 0;
@@ -557,12 +604,56 @@ void GptDecoderBatch::newRequest(
     mMaxNewTokens[batchIdx] = maxNewTokens;
     mNumDecodingEngineTokens[batchIdx] = numDecodingEngineTokens;
 
-    // copy the request ids into outputIds
-    auto const requestIdsShape = requestIds->getShape();
-    auto inputIdsView = ITensor::view(requestIds, ITensor::makeShape({localBatchSize, requestIdsShape.d[0]}));
-    auto outputIdsView = ITensor::view(outputIds, ITensor::makeShape({beamWidth, mMaxSequenceLength}));
-    kernels::invokeFill(*outputIdsView, endId, *stream);
-    kernels::tileTensor(*outputIdsView, *inputIdsView, beamWidth, *stream);
+    // The fills of the slot and the copy of the request ids into outputIds are left to initNewRequests
+    kernels::DecoderNewRequest slotInit{};
+    slotInit.inputIds = bufferCast<TokenIdType>(*requestIds);
+    slotInit.inputIdsLength = static_cast<SizeType32>(requestIds->getShape().d[0]);
+    slotInit.slot = batchIdx;
+    slotInit.inputLength = inputLength;
+    slotInit.sequenceLimitLength = inputLength + maxNewTokens;
+    slotInit.beamWidth = beamWidth;
+    slotInit.endId = endId;
+    slotInit.zeroEmbeddingBias = !request.embeddingBias;
+    slotInit.initCumLogProbs = dOutput->cumLogProbs != nullptr;
+    slotInit.zeroLogProbs = dOutput->logProbs != nullptr;
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+    return slotInit;
+}
+
+void GptDecoderBatch::initNewRequests(
+    std::vector<kernels::DecoderNewRequest> const& slotInits, CudaStreamPtr const& stream)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    BufferManager manager{stream};
+    // Staged through pinned memory, the upload doesn't wait for the work already queued on the stream
+    auto deviceSlotInits = manager.gpu(slotInits.size() * sizeof(kernels::DecoderNewRequest));
+    manager.copy(slotInits.data(), *deviceSlotInits, MemoryType::kCPU);
+
+    auto& dJointInput = *mJointDecodingInput;
+    auto& dJointOutput = *mJointDecodingOutput;
+    auto const& jointOutputIdsShape = dJointOutput.ids->getShape();
+    kernels::DecoderSlotBuffers buffers{};
+    buffers.endIds = bufferCast<TokenIdType>(*constPointerCast(dJointInput.endIds));
+    buffers.sequenceLimitLength = bufferCast<SizeType32>(*constPointerCast(dJointInput.sequenceLimitLength));
+    buffers.lengths = bufferCast<SizeType32>(*constPointerCast(dJointInput.lengths));
+    buffers.embeddingBias = bufferCast<float>(*constPointerCast(dJointInput.embeddingBias));
+    buffers.outputIds = bufferCast<TokenIdType>(*dJointOutput.ids);
+    buffers.parentIds = bufferCast<TokenIdType>(*dJointOutput.parentIds);
+    // Pinned, written by the kernel through its device mapping
+    buffers.finishedSum = bufferCast<SizeType32>(*dJointOutput.finishedSum);
+    buffers.newTokensSteps = bufferCast<TokenIdType>(*dJointOutput.newTokensSteps);
+    buffers.finishedSteps = bufferCast<tk::FinishedState::UnderlyingType>(*mFinishedSteps);
+    buffers.cumLogProbs = bufferCast<float>(*dJointOutput.cumLogProbs);
+    buffers.logProbs = bufferCast<float>(*dJointOutput.logProbs);
+    buffers.maxBatchSize = static_cast<SizeType32>(jointOutputIdsShape.d[0]);
+    buffers.maxBeamWidth = static_cast<SizeType32>(jointOutputIdsShape.d[1]);
+    buffers.maxSequenceLength = mMaxSequenceLength;
+    buffers.maxTokensPerStep = mMaxDecodingEngineTokens;
+    buffers.vocabSizePadded = static_cast<SizeType32>(mVocabSizePadded);
+    buffers.negativeInfinity = DecodingOutput::kNegativeInfinity;
+
+    kernels::invokeInitNewRequests(reinterpret_cast<kernels::DecoderNewRequest const*>(deviceSlotInits->data()),
+        static_cast<SizeType32>(slotInits.size()), buffers, *stream);
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -606,6 +697,54 @@ void GptDecoderBatch::newRequestSpeculativeDecoding(
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+void GptDecoderBatch::newRequestWithoutSpeculation(SizeType32 batchIdx)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    // The slot may hold the speculative state of the previous request or, for external draft tokens, of the previous
+    // step. Reset it to a single path without draft tokens, so that only the token of the target model is accepted.
+    mAcceptByLogits[batchIdx] = false;
+
+    auto constexpr decoderIdx = 0;
+    auto& stream = mStreams[decoderIdx];
+    BufferManager manager{stream};
+    auto constexpr localBatchSize = 1;
+
+    if (mSpeculativeDecodingMode.predictsDraftTokens())
+    {
+        auto const& speculativeDecodingOutputs = *mJointDecodingOutput->speculativeDecodingOutputs;
+        manager.setZero(*ITensor::slice(speculativeDecodingOutputs.nextDraftTokens, batchIdx, localBatchSize));
+        if (speculativeDecodingOutputs.nextDraftTokensLen)
+        {
+            manager.setZero(*ITensor::slice(speculativeDecodingOutputs.nextDraftTokensLen, batchIdx, localBatchSize));
+        }
+    }
+
+    if (mSpeculativeDecodingMode.isDraftTokensExternal())
+    {
+        auto numDraftTokensView = ITensor::slice(mNumDraftTokens, batchIdx, localBatchSize);
+        kernels::invokeFill(*numDraftTokensView, 0, *stream);
+    }
+    else if (mSpeculativeDecodingMode.isMedusa())
+    {
+        auto& dJointInput = *mJointDecodingInput;
+        for (auto const& tokensPerStep :
+            {dJointInput.medusaInputs->medusaCurTokensPerStep, dJointInput.medusaInputs->medusaTargetTokensPerStep})
+        {
+            auto tokensPerStepSlice = ITensor::slice(constPointerCast(tokensPerStep), batchIdx, localBatchSize);
+            kernels::invokeFill(*tokensPerStepSlice, 1, *stream);
+        }
+        // The only path is the root
+        TensorPtr pathsSlice
+            = ITensor::slice(constPointerCast(dJointInput.medusaInputs->medusaPaths), batchIdx, localBatchSize);
+        kernels::invokeFill(*pathsSlice, -1, *stream);
+        manager.setZero(*IBuffer::slice(pathsSlice, 0, 1));
+        TensorPtr treeIdsSlice
+            = ITensor::slice(constPointerCast(dJointInput.medusaInputs->medusaTreeIds), batchIdx, localBatchSize);
+        manager.setZero(*treeIdsSlice);
+    }
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 void GptDecoderBatch::newRequestDraftTokensExternal(
     SizeType32 batchIdx, decoder_batch::Request const& request, SamplingConfig const& samplingConfig)
 {
@@ -686,6 +825,36 @@ void GptDecoderBatch::newRequestMedusa(SizeType32 batchIdx, decoder_batch::Reque
         = ITensor::slice(constPointerCast(dJointInput.medusaInputs->medusaTreeIds), batchIdx, localBatchSize);
     manager.copy(*request.medusaTreeIds, *treeIdsSlice);
 
+    resetDraftAcceptance(batchIdx);
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+GptDecoderBatch::~GptDecoderBatch()
+{
+    setDraftAcceptance(this, nullptr);
+}
+
+ITensor::SharedPtr GptDecoderBatch::getAdaptiveNumDraftTokens() const
+{
+    auto const draftAcceptance = findDraftAcceptance(this);
+    return draftAcceptance ? draftAcceptance->numDraftTokens : nullptr;
+}
+
+void GptDecoderBatch::resetDraftAcceptance(SizeType32 batchIdx)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    auto const draftAcceptance = findDraftAcceptance(this);
+    TLLM_CHECK_WITH_INFO(draftAcceptance, "The draft acceptance is only tracked for speculative decoding.");
+    auto constexpr decoderIdx = 0;
+    auto& stream = mStreams[decoderIdx];
+    auto constexpr localBatchSize = 1;
+
+    // New requests start with the full draft length until their acceptance rate is known
+    auto acceptanceRateSlice = ITensor::slice(draftAcceptance->acceptanceRates, batchIdx, localBatchSize);
+    kernels::invokeFill(*acceptanceRateSlice, 1.f, *stream);
+    auto numDraftTokensSlice = ITensor::slice(draftAcceptance->numDraftTokens, batchIdx, localBatchSize);
+    kernels::invokeFill(*numDraftTokensSlice, draftAcceptance->maxDraftLen, *stream);
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -715,18 +884,27 @@ void GptDecoderBatch::newRequests(std::vector<SizeType32> const& seqSlots,
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
 
-    auto batchSlotsPtr = bufferCast<SizeType32>(*mBatchSlotsSetup);
     SizeType32 const localBatchSize = seqSlots.size();
-    for (SizeType32 bi = 0; bi < localBatchSize; ++bi)
+    if (!mFusedDecoder)
     {
-        newRequest(seqSlots[bi], requests[bi], samplingConfigs[bi]);
-        if (mFusedDecoder)
+        for (SizeType32 bi = 0; bi < localBatchSize; ++bi)
         {
-            batchSlotsPtr[bi] = seqSlots[bi];
+            newRequest(seqSlots[bi], requests[bi], samplingConfigs[bi]);
         }
     }
-    if (mFusedDecoder)
+    else
     {
+        // The slots of all the requests are initialized by one upload and one kernel on the stream of the decoder
+        auto batchSlotsPtr = bufferCast<SizeType32>(*mBatchSlotsSetup);
+        std::vector<kernels::DecoderNewRequest> slotInits;
+        slotInits.reserve(localBatchSize);
+        for (SizeType32 bi = 0; bi < localBatchSize; ++bi)
+        {
+            slotInits.push_back(setupNewRequest(seqSlots[bi], requests[bi], samplingConfigs[bi]));
+            batchSlotsPtr[bi] = seqSlots[bi];
+        }
+        initNewRequests(slotInits, mStreams[0]);
+
         TensorPtr batchSlotsView = std::move(ITensor::slice(mBatchSlotsSetup, 0, localBatchSize));
         auto fusedSamplingConfig = SamplingConfig(samplingConfigs);
         mDecoders[0]->setup(fusedSamplingConfig, localBatchSize, {batchSlotsView});
@@ -735,6 +913,37 @@ void GptDecoderBatch::newRequests(std::vector<SizeType32> const& seqSlots,
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+void GptDecoderBatch::setupProbsTruncation(
+    std::vector<SizeType32> const& seqSlots, std::vector<ProbsTruncationConfig> const& configs)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    TLLM_CHECK(seqSlots.size() == configs.size());
+    SizeType32 const localBatchSize = seqSlots.size();
+    if (!mFusedDecoder)
+    {
+        for (SizeType32 bi = 0; bi < localBatchSize; ++bi)
+        {
+            mDecoders[seqSlots[bi]]->setupProbsTruncation(configs[bi], 1);
+        }
+    }
+    else
+    {
+        // The setup of newRequests may still read the slots on the stream of the decoder
+        mStreams[0]->synchronize();
+        auto batchSlotsPtr = bufferCast<SizeType32>(*mBatchSlotsSetup);
+        for (SizeType32 bi = 0; bi < localBatchSize; ++bi)
+        {
+            batchSlotsPtr[bi] = seqSlots[bi];
+        }
+
+        TensorPtr batchSlotsView = std::move(ITensor::slice(mBatchSlotsSetup, 0, localBatchSize));
+        mDecoders[0]->setupProbsTruncation(ProbsTruncationConfig(configs), localBatchSize, {batchSlotsView});
+    }
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 void GptDecoderBatch::forwardDispatch(
     decoder_batch::Output& output, decoder_batch::Input const& input, std::optional<CudaEvent> const& eventStart)
 {
@@ -762,6 +971,21 @@ GptDecoderBatch::TokenPtr GptDecoderBatch::forwardAsync(
     std::optional<CudaEvent> eventStart = CudaEvent{};
     mStream->record(eventStart.value());
 
+    auto& sentinel = NumericSentinel::getInstance();
+    if (sentinel.isEnabled())
+    {
+        // Checked on the decoder stream after the engine wrote them, the slots are reported with the next execution
+        for (std::size_t bi = 0; bi < input.logits.size(); ++bi)
+        {
+            if (input.active[bi] && input.logits[bi])
+            {
+                auto const& logits = *input.logits[bi];
+                sentinel.checkSlot(SentinelSite::kLOGITS, static_cast<SizeType32>(bi), logits.data(),
+                    logits.getDataType(), logits.getSize(), mStream->get());
+            }
+        }
+    }
+
     forwardDispatch(output, input, eventStart);
 
     CudaEvent eventStop{};
@@ -1011,6 +1235,19 @@ void GptDecoderBatch::forwardFusedDecoder(SizeType32 step, decoder_batch::Output
         }
     }
 
+    auto const draftAcceptance = findDraftAcceptance(this);
+    if (async && localBatchDecoderIdx > 0 && mSpeculativeDecodingMode.isMedusa() && draftAcceptance)
+    {
+        tksd::DraftAcceptanceParams params;
+        params.acceptedLengths = bufferCast<SizeType32>(*dOutput.speculativeDecodingOutputs->acceptedTokensLen);
+        params.acceptanceRates = bufferCast<float>(*draftAcceptance->acceptanceRates);
+        params.nextNumDraftTokens = bufferCast<SizeType32>(*draftAcceptance->numDraftTokens);
+        params.batchSlots = bufferCast<SizeType32>(*batchSlotsDecoderSlice);
+        params.batchSize = localBatchDecoderIdx;
+        params.maxDraftLen = draftAcceptance->maxDraftLen;
+        tksd::invokeUpdateDraftAcceptance(params, stream->get());
+    }
+
     for (SizeType32 bi = 0; bi < mActualBatchSize; ++bi)
     {
         if (mFinished[bi] || !input.active.at(bi) || step >= mNumDecodingEngineTokens[bi])
@@ -1039,6 +1276,20 @@ void GptDecoderBatch::forwardFusedDecoder(SizeType32 step, decoder_batch::Output
             /* [maxBatchSize] */ *finishedFinal,
             /* [maxBatchSize] */ *dOutput.finishedSum,
             /* [bs] */ *batchSlotsAcceptTokensSlice, stream);
+
+        if (draftAcceptance)
+        {
+            tksd::DraftAcceptanceParams params;
+            params.sequenceLengths = bufferCast<SizeType32>(*dOutput.lengths);
+            params.contextLengths = bufferCast<SizeType32>(*dInput.lengths);
+            params.numDraftTokens = bufferCast<SizeType32>(*mNumDraftTokens);
+            params.acceptanceRates = bufferCast<float>(*draftAcceptance->acceptanceRates);
+            params.nextNumDraftTokens = bufferCast<SizeType32>(*draftAcceptance->numDraftTokens);
+            params.batchSlots = bufferCast<SizeType32>(*batchSlotsAcceptTokensSlice);
+            params.batchSize = localBatchAcceptTokensIdx;
+            params.maxDraftLen = draftAcceptance->maxDraftLen;
+            tksd::invokeUpdateDraftAcceptance(params, stream->get());
+        }
     }
 
     // If last iteration
@@ -1139,6 +1390,12 @@ void GptDecoderBatch::newBatch(
     auto inputLengthsHost = mBufferManager.copyFrom(*inputLengths, MemoryType::kCPU);
     auto inputLengthsPtr = bufferCast<SizeType32>(*inputLengthsHost);
     auto inputOffset = 0;
+    std::vector<SizeType32> seqSlots(mActualBatchSize);
+    std::iota(seqSlots.begin(), seqSlots.end(), 0);
+    std::vector<decoder_batch::Request> requests;
+    std::vector<SamplingConfig> requestSamplingConfigs;
+    requests.reserve(mActualBatchSize);
+    requestSamplingConfigs.reserve(mActualBatchSize);
     for (auto batchIdx = 0; batchIdx < mActualBatchSize; ++batchIdx)
     {
         mNumDecodingEngineTokens[batchIdx] = 1;
@@ -1186,8 +1443,11 @@ void GptDecoderBatch::newBatch(
         auto requestSamplingConfig = extractSamplingConfig(samplingConfig, batchIdx);
         requestSamplingConfig.cumLogProbs = {{outputs.cumLogProbs != nullptr}};
         requestSamplingConfig.outputLogProbs = {{outputs.logProbs != nullptr}};
-        newRequest(batchIdx, request, requestSamplingConfig);
+        requests.push_back(std::move(request));
+        requestSamplingConfigs.push_back(std::move(requestSamplingConfig));
     }
+    // Set up together, so that the fused decoder is set up once for the batch
+    newRequests(seqSlots, requests, requestSamplingConfigs);
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
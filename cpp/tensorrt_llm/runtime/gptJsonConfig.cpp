@@ -393,6 +393,14 @@ GptJsonConfig parseJson(InputType&& input)
                 TLLM_CHECK_WITH_INFO(
                     maxDraftLen, "max_draft_len has to be larger than 0 for decoding with external draft tokens");
             }
+            else if (modelConfig.getSpeculativeDecodingMode().isPromptLookup())
+            {
+                TLLM_CHECK_WITH_INFO(
+                    maxDraftLen > 0, "max_draft_len has to be larger than 0 for prompt lookup decoding");
+                // The draft tokens of a request form a single path
+                auto promptLookupModule = std::make_shared<SpeculativeDecodingModule>(maxDraftLen, maxDraftLen, 1);
+                modelConfig.setSpeculativeDecodingModule(promptLookupModule);
+            }
         }
         modelConfig.setMaxDraftLen(maxDraftLen);
     }
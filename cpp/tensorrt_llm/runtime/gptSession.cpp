@@ -26,9 +26,14 @@
 #include "tensorrt_llm/common/stringUtils.h"
 #include "tensorrt_llm/runtime/gptDecoderBatch.h"
 #include "tensorrt_llm/runtime/ipcUtils.h"
+#include "tensorrt_llm/runtime/kvCacheCompressor.h"
+#include "tensorrt_llm/runtime/kvCacheUvmPrefetcher.h"
+#include "tensorrt_llm/runtime/kvCompressionContext.h"
+#include "tensorrt_llm/runtime/memoryCounters.h"
 #include "tensorrt_llm/runtime/ncclCommunicator.h"
 #include "tensorrt_llm/runtime/runtimeBuffers.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
+#include "tensorrt_llm/runtime/startupProfiler.h"
 #include "tensorrt_llm/runtime/statefulGptDecoder.h"
 #include "tensorrt_llm/runtime/tllmLogger.h"
 #include "tensorrt_llm/runtime/tllmRuntime.h"
@@ -80,6 +85,23 @@ GptSession::GptSession(Config const& sessionConfig, ModelConfig const& modelConf
     , mDevice{utils::initDevice(worldConfig)}
     , mLogger{logger ? std::move(logger) : std::make_shared<TllmLogger>()}
     , mRuntime{std::make_shared<TllmRuntime>(engineBuffer, engineSize, sessionConfig.gpuWeightsPercent, *mLogger)}
+{
+    initialize(sessionConfig);
+}
+
+GptSession::GptSession(Config const& sessionConfig, ModelConfig const& modelConfig, WorldConfig const& worldConfig,
+    GptSession const& engineOwner)
+    : mModelConfig{modelConfig}
+    , mWorldConfig{worldConfig}
+    , mDevice{utils::initDevice(worldConfig)}
+    , mLogger{engineOwner.mLogger}
+    , mRuntime{engineOwner.mRuntime->shareEngine()}
+{
+    TLLM_CHECK_WITH_INFO(mDevice == engineOwner.mDevice, "Sessions can only share an engine on the same device.");
+    initialize(sessionConfig);
+}
+
+void GptSession::initialize(Config const& sessionConfig)
 {
     TLLM_LOG_WARNING(
         "GptSession is deprecated and will be removed in a future release."
@@ -88,7 +110,8 @@ GptSession::GptSession(Config const& sessionConfig, ModelConfig const& modelConf
     if (mWorldConfig.isPipelineParallel())
     {
         mPipelineComm = std::make_shared<NcclCommunicator>(mWorldConfig);
-        mCommStream = std::make_shared<CudaStream>();
+        mPipelineReturnComm = std::make_shared<NcclCommunicator>(mWorldConfig);
+        mCommStream = std::make_shared<CudaStream>(StreamPriority::kHIGH);
     }
 
     TLLM_CHECK_WITH_INFO(!(mModelConfig.usePromptTuning() && !mModelConfig.useGptAttentionPlugin()),
@@ -146,6 +169,7 @@ void GptSession::createBuffers(SizeType32 numMicroBatches)
 
     for (SizeType32 i = 0; i < numMicroBatches; ++i)
     {
+        MemoryCounters::ScopedTag const tag{MemoryTag::kRUNTIME_BUFFERS};
         mBuffers.emplace_back(std::make_shared<RuntimeBuffers>());
         mBuffers.back()->create(*mRuntime, mModelConfig, mWorldConfig);
     }
@@ -157,6 +181,7 @@ void GptSession::createDecoders(SizeType32 batchSize, SizeType32 beamWidth, Size
     SizeType32 numMicroBatches, executor::DecodingMode const& decodingMode)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    MemoryCounters::ScopedTag const tag{MemoryTag::kDECODER};
     auto const vocabSize = mModelConfig.getVocabSize();
     auto const vocabSizePadded = mModelConfig.getVocabSizePadded(mWorldConfig.getSize());
     auto const& stream = mRuntime->getStreamPtr();
@@ -186,6 +211,7 @@ void GptSession::createKvCacheManager(SizeType32 maxBatchSize, SizeType32 maxBea
     SizeType32 sinkTokenLength, SizeType32 maxSequenceLength, KvCacheConfig const& kvCacheConfig)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    MemoryCounters::ScopedTag const tag{MemoryTag::kKV_CACHE};
     auto const tokensPerBlock = mModelConfig.getTokensPerBlock();
 
     auto const kvDtype = mModelConfig.getKvDataType();
@@ -214,7 +240,15 @@ void GptSession::createKvCacheManager(SizeType32 maxBatchSize, SizeType32 maxBea
         buffers->transformerBuffers->reshapeKvTensors(maxBatchSize, maxBeamWidth, maxBlocksPerSeq, *mRuntime);
     }
 
-    mKvCacheManager->allocatePools(kvDtype, kvCacheConfig.useUvm);
+    {
+        auto const startupScope = StartupProfiler::getInstance().scope(StartupPhase::kKV_CACHE_ALLOCATION);
+        mKvCacheManager->allocatePools(kvDtype, kvCacheConfig.useUvm);
+    }
+    mKvCacheUvmPrefetcher.reset();
+    if (kvCacheConfig.useUvm)
+    {
+        mKvCacheUvmPrefetcher = std::make_shared<KvCacheUvmPrefetcher>(*mKvCacheManager);
+    }
 
     for (auto& buffers : mBuffers)
     {
@@ -229,6 +263,7 @@ void GptSession::createCustomAllReduceWorkspace(
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
 
+    MemoryCounters::ScopedTag const tag{MemoryTag::kCUSTOM_ALL_REDUCE};
     auto& manager = mRuntime->getBufferManager();
     auto const hiddenSize = mModelConfig.getHiddenSize();
 
@@ -312,6 +347,21 @@ void GptSession::setup(Config const& sessionConfig)
             decodingMode);
     }
 
+    mDecoderOverlap
+        = sessionConfig.decoderOverlap && !sessionConfig.decoderPerRequest && !mWorldConfig.isPipelineParallel();
+    if (sessionConfig.decoderOverlap && !mDecoderOverlap)
+    {
+        TLLM_LOG_WARNING("decoderOverlap is not supported with decoderPerRequest or pipeline parallelism, ignored.");
+    }
+    mDecodedEvents.clear();
+    if (mDecoderOverlap)
+    {
+        for (SizeType32 i = 0; i < 2 * mMicroBatchConfig.numGenBatches; ++i)
+        {
+            mDecodedEvents.emplace_back();
+        }
+    }
+
     if (mWorldConfig.isPipelineParallel() || mMicroBatchConfig.numGenBatches > 1)
     {
         mReceivedEvents.clear();
@@ -328,10 +378,12 @@ void GptSession::setup(Config const& sessionConfig)
 
     for (auto& buffers : mBuffers)
     {
+        MemoryCounters::ScopedTag const tag{MemoryTag::kRUNTIME_BUFFERS};
         // we don't know maxInputLength yet and ignore it for pre-allocation
         buffers->generationConfig = GenerationConfig{
             mMicroBatchConfig.genBatchSize, maxBeamWidth, 0, maxAttentionWindow, sinkTokenLength, maxSequenceLength};
         buffers->reshape(mModelConfig, mWorldConfig);
+        buffers->reserve(mRuntime->getBufferManager(), mModelConfig);
     }
 
     if (mModelConfig.isTransformerBased() && mModelConfig.usePagedKvCache())
@@ -340,6 +392,23 @@ void GptSession::setup(Config const& sessionConfig)
             sessionConfig.kvCacheConfig);
     }
 
+    mKvCacheCompressor.reset();
+    if (sessionConfig.kvCompressionConfig)
+    {
+        TLLM_CHECK_WITH_INFO(mKvCacheManager, "KV compression needs a paged KV cache.");
+        TLLM_CHECK_WITH_INFO(maxBeamWidth == 1 && !sessionConfig.cudaGraphMode,
+            "KV compression needs beam width 1 and no CUDA graphs.");
+        TLLM_CHECK_WITH_INFO(maxAttentionWindow == maxSequenceLength && sinkTokenLength == 0,
+            "KV compression doesn't support a cyclic KV cache.");
+        MemoryCounters::ScopedTag const tag{MemoryTag::kKV_CACHE};
+        auto const bytesPerHead = static_cast<SizeType32>(
+            mModelConfig.getSizePerHead() * BufferDataType(mModelConfig.getKvDataType()).getSize());
+        mKvCacheCompressor = std::make_shared<KvCacheCompressor>(*sessionConfig.kvCompressionConfig, maxBatchSize,
+            maxAttentionWindow, mModelConfig.getNbAttentionLayers(mWorldConfig.getPipelineParallelism()),
+            mModelConfig.getNbKvHeads(), bytesPerHead, mRuntime->getBufferManager());
+    }
+
+    TLLM_LOG_DEBUG(MemoryCounters::getInstance().toTaggedString());
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -504,6 +573,11 @@ std::vector<GenerationInput> splitInputs(GenerationInput const& inputs, SizeType
         {
             batch.maxNewTokens = inputs.maxNewTokens;
         }
+        if (inputs.compressKvCache)
+        {
+            batch.compressKvCache = std::vector<bool>(
+                inputs.compressKvCache->begin() + offset, inputs.compressKvCache->begin() + offset + batchSize);
+        }
 
         if (inputs.promptTuningParams.embeddingTable)
         {
@@ -552,6 +626,10 @@ std::vector<GenerationOutput> splitOutputs(
         {
             outputBatches.back().generationLogits = ITensor::slice(outputs.generationLogits, batchOffset, batchSize);
         }
+        if (outputs.promptLogProbs)
+        {
+            outputBatches.back().promptLogProbs = ITensor::slice(outputs.promptLogProbs, batchOffset, batchSize);
+        }
     }
 
     return outputBatches;
@@ -585,6 +663,14 @@ void GptSession::generate(GenerationOutput& outputs, GenerationInput const& inpu
     auto const batchSize = static_cast<SizeType32>(inputLengths->getSize());
 
     auto const beamWidth = samplingConfig.beamWidth;
+    if (outputs.promptLogProbs)
+    {
+        TLLM_CHECK_WITH_INFO(mModelConfig.computeContextLogits(),
+            "Scoring prompts needs an engine built with gather_context_logits.");
+        TLLM_CHECK_WITH_INFO(beamWidth == 1, "Scoring prompts needs beam width 1.");
+        TLLM_CHECK_WITH_INFO(
+            !mWorldConfig.isPipelineParallel(), "Scoring prompts doesn't support pipeline parallelism.");
+    }
     outputs.ids->reshape(ITensor::makeShape({batchSize, beamWidth, mDecoderMaxSequenceLength}));
     outputs.lengths->reshape(ITensor::makeShape({batchSize, beamWidth}));
     if (mWorldConfig.isLastPipelineParallelRank())
@@ -615,6 +701,10 @@ void GptSession::generate(GenerationOutput& outputs, GenerationInput const& inpu
                     outputs.contextLogits = manager.emptyTensor(MemoryType::kGPU, getLogitDataType());
                 }
                 outputs.contextLogits->reshape(ITensor::makeShape({batchSize, maxInputLength, vocabSizePadded}));
+                if (outputs.promptLogProbs)
+                {
+                    outputs.promptLogProbs->reshape(ITensor::makeShape({batchSize, maxInputLength}));
+                }
             }
 
             // Initialize the output generation logits buffer
@@ -720,6 +810,30 @@ void GptSession::generateBatched(std::vector<GenerationOutput>& microBatchesOutp
         microBatchOffsets.emplace_back(microBatchOffsets.back() + generationConfig.batchSize);
     }
 
+    if (mKvCacheCompressor)
+    {
+        TLLM_CHECK_WITH_INFO(beamWidth == 1, "KV compression needs beam width 1.");
+        std::vector<bool> compressKvCache;
+        compressKvCache.reserve(microBatchOffsets.back());
+        for (auto microBatchId = 0; microBatchId < numMicroBatches; ++microBatchId)
+        {
+            auto const& microBatchInputs = microBatchesInputs.at(microBatchId);
+            auto const batchSize = microBatchOffsets.at(microBatchId + 1) - microBatchOffsets.at(microBatchId);
+            if (microBatchInputs.compressKvCache)
+            {
+                TLLM_CHECK_WITH_INFO(static_cast<SizeType32>(microBatchInputs.compressKvCache->size()) == batchSize,
+                    "compressKvCache must have a value per sequence.");
+                compressKvCache.insert(compressKvCache.end(), microBatchInputs.compressKvCache->begin(),
+                    microBatchInputs.compressKvCache->end());
+            }
+            else
+            {
+                compressKvCache.insert(compressKvCache.end(), batchSize, true);
+            }
+        }
+        mKvCacheCompressor->reset(compressKvCache);
+    }
+
     for (auto microBatchId = 0; microBatchId < numMicroBatches; ++microBatchId)
     {
         auto& buffers = *mBuffers.at(microBatchId);
@@ -770,8 +884,22 @@ void GptSession::generateBatched(std::vector<GenerationOutput>& microBatchesOutp
     if (profileContext)
         cudaProfilerStop();
 
-    std::vector<bool> microBatchesFinished(numMicroBatches, false);
-    SizeType32 numBatchesFinished{0};
+    // In scoring mode the prompts are scored from the context logits and no generation step runs
+    auto const scorePrompts = static_cast<bool>(microBatchesOutputs.front().promptLogProbs);
+    if (scorePrompts)
+    {
+        for (auto microBatchId = 0; microBatchId < numMicroBatches; ++microBatchId)
+        {
+            auto const& microBatchInputs = microBatchesInputs.at(microBatchId);
+            auto& microBatchOutputs = microBatchesOutputs.at(microBatchId);
+            kernels::gatherPromptLogProbs(*microBatchOutputs.promptLogProbs, *microBatchOutputs.contextLogits,
+                *microBatchInputs.ids, *microBatchInputs.lengths, mModelConfig.getVocabSize(), microBatchInputs.packed,
+                mRuntime->getStream());
+        }
+    }
+
+    std::vector<bool> microBatchesFinished(numMicroBatches, scorePrompts);
+    SizeType32 numBatchesFinished{scorePrompts ? numMicroBatches : 0};
     SizeType32 step{0};
 
     if (generationProfiler)
@@ -812,6 +940,10 @@ void GptSession::generateBatched(std::vector<GenerationOutput>& microBatchesOutp
         {
             for (auto batchIdx = firstBatchIdx; batchIdx < firstBatchIdx + microBatchSize; ++batchIdx)
             {
+                if (mKvCacheUvmPrefetcher)
+                {
+                    mKvCacheUvmPrefetcher->release(*kvCacheManager, batchIdx, beamWidth);
+                }
                 kvCacheManager->removeSequence(batchIdx);
             }
         }
@@ -891,6 +1023,11 @@ void GptSession::executeContextStep(std::vector<GenerationInput> const& generati
 
             buffers.prepareContextStep(inputIds.at(contextBatchId), generationBatchInputs.padId, manager,
                 kvCacheManager, batchOffset, mModelConfig, mWorldConfig);
+            if (mKvCacheUvmPrefetcher)
+            {
+                mKvCacheUvmPrefetcher->prefetch(*kvCacheManager, batchOffset, buffers.generationConfig.batchSize,
+                    buffers.generationConfig.beamWidth, mRuntime->getStream());
+            }
             buffers.getRuntimeBuffers(inputBuffer, outputBuffer, step, inputIds.at(contextBatchId), allReduceCommPtrs,
                 mModelConfig, mWorldConfig);
             mRuntime->setInputTensors(contextId, inputBuffer);
@@ -917,6 +1054,10 @@ void GptSession::executeContextStep(std::vector<GenerationInput> const& generati
         auto const decoderStep = generationBuffers.generationConfig.maxInputLength + step;
 
         decoderStepAsync(decoderStep, generationBatchId);
+        if (mDecoderOverlap)
+        {
+            mRuntime->getStream().record(mDecodedEvents.at(2 * generationBatchId).get());
+        }
 
         if (mWorldConfig.isLastPipelineParallelRank() && mModelConfig.computeGenerationLogits())
         {
@@ -959,8 +1100,19 @@ SizeType32 GptSession::executeGenerationStep(SizeType32 step, std::vector<Genera
         auto& inputBuffer = buffers.inputBuffers[flipFlopId];
         auto& outputBuffer = buffers.outputBuffers[flipFlopId];
 
+        if (mKvCacheCompressor)
+        {
+            // Before the token of the step is added, so that its slot follows the kept tokens
+            mKvCacheCompressor->compress(
+                *kvCacheManager, microBatchOffsets.at(generationBatchId), generationConfig.batchSize);
+        }
         auto nextInputIds = buffers.prepareNextStep(
             step - 1, manager, kvCacheManager, microBatchOffsets.at(generationBatchId), mModelConfig, mWorldConfig);
+        if (mKvCacheUvmPrefetcher)
+        {
+            mKvCacheUvmPrefetcher->prefetch(*kvCacheManager, microBatchOffsets.at(generationBatchId),
+                generationConfig.batchSize, generationConfig.beamWidth, mRuntime->getStream());
+        }
         buffers.getRuntimeBuffers(
             inputBuffer, outputBuffer, step, nextInputIds, allReduceCommPtrs, mModelConfig, mWorldConfig);
         mRuntime->setInputTensors(contextId, inputBuffer);
@@ -984,8 +1136,16 @@ SizeType32 GptSession::executeGenerationStep(SizeType32 step, std::vector<Genera
             }
         }
 
-        // check decoder result of previous iteration
-        if (shouldStopSync(generationConfig.batchSize, generationConfig.beamWidth, generationBatchId))
+        // check decoder result of previous iteration, or of the one before in overlap mode.
+        // The last step allowed by the buffers is always checked synchronously.
+        auto const& microBatchInputs = microBatchesInputs.at(generationBatchId);
+        auto const maxNewTokens
+            = microBatchInputs.maxNewTokens.value_or(generationConfig.maxSeqLength - generationConfig.maxInputLength);
+        auto const overlapStep = mDecoderOverlap && generationConfig.beamWidth == 1 && step > 1 && step < maxNewTokens;
+        auto const shouldStop = overlapStep
+            ? shouldStopOverlapped(generationConfig.batchSize, generationConfig.beamWidth, generationBatchId, step)
+            : shouldStopSync(generationConfig.batchSize, generationConfig.beamWidth, generationBatchId);
+        if (shouldStop)
         {
             mLogger->log(nvinfer1::ILogger::Severity::kVERBOSE,
                 tc::fmtstr("GPT decoding finished for step %d and microBatchId %d", step, generationBatchId).c_str());
@@ -1006,6 +1166,13 @@ SizeType32 GptSession::executeGenerationStep(SizeType32 step, std::vector<Genera
             auto& cudaGraphInstance = mCudaGraphInstances.at(graphId);
             cudaGraphInstance.launch(mRuntime->getStream());
         }
+        else if (mKvCacheCompressor)
+        {
+            auto const kvCompressionBuffers = mKvCacheCompressor->getBuffers(microBatchOffsets.at(generationBatchId));
+            KvCompressionContext::Scope const kvCompressionScope{kvCompressionBuffers};
+            TLLM_CHECK_WITH_INFO(
+                mRuntime->executeContext(contextId), tc::fmtstr("Executing TRT engine in step %d failed!", step));
+        }
         else
         {
             TLLM_CHECK_WITH_INFO(
@@ -1025,6 +1192,10 @@ SizeType32 GptSession::executeGenerationStep(SizeType32 step, std::vector<Genera
         auto const decoderStep = generationConfig.maxInputLength + step;
 
         decoderStepAsync(decoderStep, generationBatchId);
+        if (mDecoderOverlap)
+        {
+            mRuntime->getStream().record(mDecodedEvents.at(2 * generationBatchId + flipFlopId).get());
+        }
 
         if (mWorldConfig.isLastPipelineParallelRank() && mModelConfig.computeGenerationLogits()
             && buffers.allGenerationLogits->getShape().d[0] > step + 1)
@@ -1141,6 +1312,29 @@ bool GptSession::shouldStopSync(SizeType32 batchSize, SizeType32 beamWidth, Size
     return nbFinished == batchSize * beamWidth;
 }
 
+bool GptSession::shouldStopOverlapped(
+    SizeType32 batchSize, SizeType32 beamWidth, SizeType32 microBatchId, SizeType32 step)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_CHECK(mDecoderOverlap && mWorldConfig.isLastPipelineParallelRank());
+
+    // The event of this flip-flop slot was recorded after decoder step `step - 2`, the decoder of step `step - 1` is
+    // still in flight. It can only increase the count of finished sequences, so reading it early is conservative
+    // and at most one wasted step on finished sequences is launched.
+    mDecodedEvents.at(2 * microBatchId + step % 2).synchronize();
+    auto const nbFinished = *bufferCast<SizeType32>(*mDecoders.at(microBatchId)->getNbFinished());
+
+    if (mMicroBatchConfig.numGenBatches > 1)
+    {
+        // ensure outputIds have been updated, on the stream so that the host doesn't wait for the last decoder step
+        mRuntime->getStream().wait(mReceivedEvents.at(microBatchId).get());
+    }
+
+    sync_check_cuda_error();
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+    return nbFinished == batchSize * beamWidth;
+}
+
 void GptSession::finalize(SizeType32 microBatchId)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
@@ -1163,35 +1357,35 @@ void GptSession::finalize(SizeType32 microBatchId)
             auto finalOutputIds = decoder->getOutputIds();
 
             auto const peer = pipelineGroup.front();
-            mPipelineComm->send(*finalOutputIds, peer, stream);
-            mPipelineComm->send(*sequenceLengths, peer, stream);
+            mPipelineReturnComm->send(*finalOutputIds, peer, stream);
+            mPipelineReturnComm->send(*sequenceLengths, peer, stream);
             manager.copy(*finalOutputIds, *outputIds);
 
             if (cumLogProbs)
             {
                 auto finalCumLogProbs = decoder->getCumLogProbs();
-                mPipelineComm->send(*finalCumLogProbs, peer, stream);
+                mPipelineReturnComm->send(*finalCumLogProbs, peer, stream);
                 manager.copy(*finalCumLogProbs, *cumLogProbs);
             }
             if (logProbs)
             {
                 auto finalLogProbs = decoder->getLogProbs();
-                mPipelineComm->send(*finalLogProbs, peer, stream);
+                mPipelineReturnComm->send(*finalLogProbs, peer, stream);
                 manager.copy(*finalLogProbs, *logProbs);
             }
         }
         else if (mWorldConfig.isFirstPipelineParallelRank())
         { // receive ids from last on first
             auto const peer = pipelineGroup.back();
-            mPipelineComm->receive(*outputIds, peer, stream);
-            mPipelineComm->receive(*sequenceLengths, peer, stream);
+            mPipelineReturnComm->receive(*outputIds, peer, stream);
+            mPipelineReturnComm->receive(*sequenceLengths, peer, stream);
             if (cumLogProbs)
             {
-                mPipelineComm->receive(*cumLogProbs, peer, stream);
+                mPipelineReturnComm->receive(*cumLogProbs, peer, stream);
             }
             if (logProbs)
             {
-                mPipelineComm->receive(*logProbs, peer, stream);
+                mPipelineReturnComm->receive(*logProbs, peer, stream);
             }
         }
     }
@@ -1218,6 +1412,19 @@ void GptSession::finalize(SizeType32 microBatchId)
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+void GptSession::refitWeights(StringPtrMap<ITensor> const& weights)
+{
+    TLLM_CHECK(mRuntime);
+    // The CUDA graphs are captured again by the next call to generate, and the KV cache isn't reused across calls
+    mRuntime->refitWeights(weights);
+}
+
+void GptSession::refitWeights(std::filesystem::path const& weightsPath)
+{
+    TLLM_CHECK(mRuntime);
+    mRuntime->refitWeights(weightsPath);
+}
+
 void GptSession::setLayerProfiler()
 {
     TLLM_CHECK(mRuntime);
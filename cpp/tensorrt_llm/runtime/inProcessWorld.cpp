@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/inProcessWorld.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+
+#include <algorithm>
+#include <exception>
+#include <numeric>
+#include <thread>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+thread_local InProcessWorld* tWorld{nullptr};
+thread_local SizeType32 tRank{-1};
+} // namespace
+
+InProcessWorld::InProcessWorld(SizeType32 tensorParallelism, SizeType32 pipelineParallelism,
+    std::optional<std::vector<SizeType32>> const& deviceIds)
+    : mTensorParallelism{tensorParallelism}
+    , mPipelineParallelism{pipelineParallelism}
+{
+    TLLM_CHECK_WITH_INFO(mTensorParallelism > 0 && mPipelineParallelism > 0,
+        "The parallelism must be positive, got TP %d and PP %d.", mTensorParallelism, mPipelineParallelism);
+    if (deviceIds)
+    {
+        mDeviceIds = *deviceIds;
+    }
+    else
+    {
+        mDeviceIds.resize(getSize());
+        std::iota(mDeviceIds.begin(), mDeviceIds.end(), 0);
+    }
+    TLLM_CHECK_WITH_INFO(static_cast<SizeType32>(mDeviceIds.size()) == getSize(), "Got %zu devices for %d ranks.",
+        mDeviceIds.size(), getSize());
+}
+
+WorldConfig InProcessWorld::getWorldConfig(SizeType32 rank) const
+{
+    TLLM_CHECK_WITH_INFO(rank >= 0 && rank < getSize(), "Rank %d is out of range.", rank);
+    // All ranks are on this node, each has the device at its index
+    auto const gpusPerNode = std::max(getSize(), *std::max_element(mDeviceIds.begin(), mDeviceIds.end()) + 1);
+    return WorldConfig{mTensorParallelism, mPipelineParallelism, rank, gpusPerNode, mDeviceIds};
+}
+
+void InProcessWorld::run(std::function<void(WorldConfig const&)> const& fn)
+{
+    TLLM_CHECK_WITH_INFO(tWorld == nullptr, "A rank of a world can't run another world.");
+    {
+        std::lock_guard<std::mutex> lock(mExchangeMutex);
+        mAborted = false;
+        mExchanges.clear();
+        mRounds.clear();
+    }
+
+    std::vector<std::exception_ptr> errors(getSize());
+    std::vector<std::thread> threads;
+    threads.reserve(getSize());
+    for (SizeType32 rank = 0; rank < getSize(); ++rank)
+    {
+        threads.emplace_back(
+            [this, &fn, &errors, rank]()
+            {
+                tWorld = this;
+                tRank = rank;
+                try
+                {
+                    auto const worldConfig = getWorldConfig(rank);
+                    TLLM_CUDA_CHECK(cudaSetDevice(worldConfig.getDevice()));
+                    fn(worldConfig);
+                }
+                catch (...)
+                {
+                    errors[rank] = std::current_exception();
+                    abort();
+                }
+                tWorld = nullptr;
+                tRank = -1;
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (auto const& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+InProcessWorld* InProcessWorld::current() noexcept
+{
+    return tWorld;
+}
+
+SizeType32 InProcessWorld::currentRank()
+{
+    TLLM_CHECK_WITH_INFO(tWorld != nullptr, "The thread is not a rank of an in-process world.");
+    return tRank;
+}
+
+std::vector<std::uint8_t> InProcessWorld::broadcast(std::string const& key, std::set<SizeType32> const& group,
+    std::function<std::vector<std::uint8_t>()> const& create)
+{
+    TLLM_CHECK_WITH_INFO(tWorld == this, "The thread is not a rank of this world.");
+    auto const rank = tRank;
+    TLLM_CHECK_WITH_INFO(group.count(rank) != 0, "Rank %d is not in the group of %s.", rank, key.c_str());
+    auto const root = *group.begin();
+
+    std::unique_lock<std::mutex> lock(mExchangeMutex);
+    auto& rounds = mRounds[key];
+    rounds.resize(getSize(), 0);
+    auto const round = rounds[rank]++;
+
+    if (rank == root)
+    {
+        // The bytes of the previous round are replaced once all ranks have taken them
+        mExchangeCv.wait(lock, [this, &key]() { return mAborted || mExchanges.count(key) == 0; });
+        TLLM_CHECK_WITH_INFO(!mAborted, "The exchange of %s was aborted by a failed rank.", key.c_str());
+        lock.unlock();
+        auto bytes = create();
+        lock.lock();
+        if (group.size() > 1)
+        {
+            mExchanges[key] = Exchange{bytes, round, static_cast<SizeType32>(group.size()) - 1};
+            mExchangeCv.notify_all();
+        }
+        return bytes;
+    }
+
+    mExchangeCv.wait(lock,
+        [this, &key, round]()
+        {
+            auto const it = mExchanges.find(key);
+            return mAborted || (it != mExchanges.end() && it->second.round == round);
+        });
+    TLLM_CHECK_WITH_INFO(!mAborted, "The exchange of %s was aborted by a failed rank.", key.c_str());
+    auto const it = mExchanges.find(key);
+    auto bytes = it->second.bytes;
+    if (--it->second.numPending == 0)
+    {
+        mExchanges.erase(it);
+        mExchangeCv.notify_all();
+    }
+    return bytes;
+}
+
+void InProcessWorld::abort()
+{
+    std::lock_guard<std::mutex> lock(mExchangeMutex);
+    mAborted = true;
+    mExchangeCv.notify_all();
+}
+
+} // namespace tensorrt_llm::runtime
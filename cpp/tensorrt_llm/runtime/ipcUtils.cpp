@@ -16,14 +16,26 @@
 
 #include "tensorrt_llm/runtime/ipcUtils.h"
 
+#include "tensorrt_llm/common/cudaDriverWrapper.h"
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/customAllReduceUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
 #include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/runtime/allReduceTuner.h"
+#include "tensorrt_llm/runtime/inProcessWorld.h"
+#include "tensorrt_llm/runtime/startupProfiler.h"
 
 #include <NvInferRuntimeBase.h>
+#include <array>
 #include <cstddef>
+#include <cuda.h>
 #include <unordered_set>
 
+#if !defined(_WIN32)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace tensorrt_llm::runtime
 {
 
@@ -61,13 +73,75 @@ void setPeerAccess(WorldConfig const& worldConfig, bool enable)
     }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
+
+void checkDriverCall(CUresult result, char const* call)
+{
+    if (result != CUDA_SUCCESS)
+    {
+        char const* name = nullptr;
+        common::CUDADriverWrapper::getInstance()->cuGetErrorName(result, &name);
+        TLLM_THROW("%s failed: %s", call, name != nullptr ? name : "unknown error");
+    }
+}
+
+#define TLLM_CU_CHECK(call) checkDriverCall((call), #call)
+
+// The ranks of the tensor parallel group, ordered by tensor parallel rank
+mpi::MpiComm splitTensorParallelGroup(WorldConfig const& worldConfig)
+{
+    return COMM_SESSION.split(worldConfig.getPipelineParallelRank(), worldConfig.getTensorParallelRank());
+}
+
+// Duplicates a file descriptor of another process, which needs Linux 5.6 and ptrace access to the process.
+// Returns -1 on failure.
+int getPeerFileDescriptor(int pid, int peerFd)
+{
+#if !defined(_WIN32) && defined(SYS_pidfd_open) && defined(SYS_pidfd_getfd)
+    auto const pidFd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+    if (pidFd < 0)
+    {
+        return -1;
+    }
+    auto const fd = static_cast<int>(syscall(SYS_pidfd_getfd, pidFd, peerFd, 0));
+    close(pidFd);
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+// Reserves an address range for the allocation and maps it with read and write access from the device
+void* mapAllocation(CUmemGenericAllocationHandle handle, std::size_t size, std::size_t alignment, SizeType32 device)
+{
+    auto const driver = common::CUDADriverWrapper::getInstance();
+    CUdeviceptr ptr{0};
+    TLLM_CU_CHECK(driver->cuMemAddressReserve(&ptr, size, alignment, 0, 0));
+    TLLM_CU_CHECK(driver->cuMemMap(ptr, size, 0, handle, 0));
+    CUmemAccessDesc accessDesc{};
+    accessDesc.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    accessDesc.location.id = device;
+    accessDesc.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+    TLLM_CU_CHECK(driver->cuMemSetAccess(ptr, size, &accessDesc, 1));
+    return reinterpret_cast<void*>(ptr);
+}
+
+void unmapAllocation(void* ptr, std::size_t size)
+{
+    auto const driver = common::CUDADriverWrapper::getInstance();
+    auto const devicePtr = reinterpret_cast<CUdeviceptr>(ptr);
+    cuErrCheck(driver->cuMemUnmap(devicePtr, size), driver);
+    cuErrCheck(driver->cuMemAddressFree(devicePtr, size), driver);
+}
 } // namespace
 
 IpcMemory::IpcMemory(std::size_t bufferSize, BufferManager const& manager, WorldConfig const& worldConfig)
-    : mTpRank(worldConfig.getTensorParallelRank())
+    : mRank(worldConfig.getTensorParallelRank())
     , mCommPtrs(worldConfig.getTensorParallelism())
 {
-    mOpenIpc = worldConfig.getTensorParallelism() <= worldConfig.getGpusPerNode();
+    // A group spanning nodes opens the buffers within the nodes for the hierarchical all reduce
+    auto const tpSize = worldConfig.getTensorParallelism();
+    auto const gpusPerNode = worldConfig.getGpusPerNode();
+    mOpenIpc = tpSize <= gpusPerNode || tpSize % gpusPerNode == 0;
     if (mOpenIpc)
     {
         allocateIpcMemory(bufferSize, manager, worldConfig);
@@ -77,6 +151,8 @@ IpcMemory::IpcMemory(std::size_t bufferSize, BufferManager const& manager, World
 void IpcMemory::allocateIpcMemory(std::size_t bufferSize, BufferManager const& manager, WorldConfig const& worldConfig)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_CHECK_WITH_INFO(InProcessWorld::current() == nullptr,
+        "The custom all reduce needs a process per rank, the engines of an in-process world must use NCCL.");
 
     // cudaIpcGetMemHandle only works with allocation created with cudaMalloc
     mBuffer = BufferManager::gpuSync(bufferSize, nvinfer1::DataType::kUINT8);
@@ -87,11 +163,16 @@ void IpcMemory::allocateIpcMemory(std::size_t bufferSize, BufferManager const& m
     TLLM_CUDA_CHECK(cudaIpcGetMemHandle(&localHandle, bufferPtr));
 
     auto const ppRank = worldConfig.getPipelineParallelRank();
-    auto const comm = COMM_SESSION.split(ppRank, mTpRank);
-    std::vector<char> serialHandles(CUDA_IPC_HANDLE_SIZE * worldConfig.getTensorParallelism(), 0);
+    auto const tpRank = worldConfig.getTensorParallelRank();
+    auto const isMultiNode = worldConfig.getTensorParallelism() > worldConfig.getGpusPerNode();
+    // The ranks of a node are ordered by tensor parallel rank, as the nodes hold consecutive ranks
+    auto const color = isMultiNode ? ppRank * worldConfig.getSize() + worldConfig.getNodeRank() : ppRank;
+    auto const comm = COMM_SESSION.split(color, tpRank);
+    mRank = comm.getRank();
+    std::vector<char> serialHandles(CUDA_IPC_HANDLE_SIZE * comm.getSize(), 0);
     comm.allgather(&localHandle.reserved, serialHandles.data(), CUDA_IPC_HANDLE_SIZE, mpi::MpiType::kBYTE);
 
-    std::vector<cudaIpcMemHandle_t> handles(worldConfig.getTensorParallelism());
+    std::vector<cudaIpcMemHandle_t> handles(comm.getSize());
     for (size_t i = 0; i < handles.size(); ++i)
     {
         memcpy(handles[i].reserved, &serialHandles[i * CUDA_IPC_HANDLE_SIZE], CUDA_IPC_HANDLE_SIZE);
@@ -99,7 +180,7 @@ void IpcMemory::allocateIpcMemory(std::size_t bufferSize, BufferManager const& m
 
     for (std::size_t nodeId = 0; nodeId < handles.size(); nodeId++)
     {
-        if (nodeId == static_cast<std::size_t>(mTpRank))
+        if (nodeId == static_cast<std::size_t>(mRank))
         {
             mCommPtrs.at(nodeId) = bufferPtr;
         }
@@ -128,7 +209,7 @@ void IpcMemory::destroyIpcMemory()
 
     for (std::size_t nodeId = 0; nodeId < mCommPtrs.size(); ++nodeId)
     {
-        if (nodeId != static_cast<std::size_t>(mTpRank))
+        if (nodeId != static_cast<std::size_t>(mRank) && mCommPtrs.at(nodeId) != nullptr)
         {
             TLLM_CUDA_CHECK(cudaIpcCloseMemHandle(mCommPtrs.at(nodeId)));
         }
@@ -136,10 +217,157 @@ void IpcMemory::destroyIpcMemory()
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+bool IpcNvlsMemory::isSupported(WorldConfig const& worldConfig)
+{
+#if defined(_WIN32)
+    return false;
+#else
+    auto const tpSize = worldConfig.getTensorParallelism();
+    if (tpSize <= 1 || tpSize > worldConfig.getGpusPerNode() || InProcessWorld::current() != nullptr)
+    {
+        return false;
+    }
+    auto const driver = common::CUDADriverWrapper::getInstance();
+    int multicast{0};
+    auto const result
+        = driver->cuDeviceGetAttribute(&multicast, CU_DEVICE_ATTRIBUTE_MULTICAST_SUPPORTED, worldConfig.getDevice());
+    int const localSupported = (result == CUDA_SUCCESS && multicast != 0) ? 1 : 0;
+    int supported{0};
+    splitTensorParallelGroup(worldConfig).allreduce(
+        &localSupported, &supported, 1, mpi::MpiType::kINT32, mpi::MpiOp::MIN);
+    return supported != 0;
+#endif
+}
+
+IpcNvlsMemory::IpcNvlsMemory(std::size_t bufferSize, WorldConfig const& worldConfig)
+    : mDevice(worldConfig.getDevice())
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+#if defined(_WIN32)
+    TLLM_THROW("The NVLS all reduce needs POSIX file descriptors to share the multicast object");
+#else
+    auto const driver = common::CUDADriverWrapper::getInstance();
+    auto const comm = splitTensorParallelGroup(worldConfig);
+
+    CUmulticastObjectProp multicastProp{};
+    multicastProp.numDevices = comm.getSize();
+    multicastProp.handleTypes = CU_MEM_HANDLE_TYPE_POSIX_FILE_DESCRIPTOR;
+    std::size_t multicastGranularity{0};
+    TLLM_CU_CHECK(driver->cuMulticastGetGranularity(
+        &multicastGranularity, &multicastProp, CU_MULTICAST_GRANULARITY_RECOMMENDED));
+
+    CUmemAllocationProp unicastProp{};
+    unicastProp.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+    unicastProp.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    unicastProp.location.id = mDevice;
+    unicastProp.requestedHandleTypes = CU_MEM_HANDLE_TYPE_POSIX_FILE_DESCRIPTOR;
+    std::size_t unicastGranularity{0};
+    TLLM_CU_CHECK(driver->cuMemGetAllocationGranularity(
+        &unicastGranularity, &unicastProp, CU_MEM_ALLOC_GRANULARITY_RECOMMENDED));
+
+    auto const granularity = std::max(multicastGranularity, unicastGranularity);
+    mSize = common::roundUp(bufferSize, granularity);
+    multicastProp.size = mSize;
+
+    // Rank 0 shares its process id and the file descriptor of the multicast object, which the other ranks duplicate
+    CUmemGenericAllocationHandle multicastHandle{0};
+    std::array<int, 2> pidAndFd{0, -1};
+    if (comm.getRank() == 0)
+    {
+        TLLM_CU_CHECK(driver->cuMulticastCreate(&multicastHandle, &multicastProp));
+        TLLM_CU_CHECK(driver->cuMemExportToShareableHandle(
+            &pidAndFd[1], multicastHandle, CU_MEM_HANDLE_TYPE_POSIX_FILE_DESCRIPTOR, 0));
+        pidAndFd[0] = static_cast<int>(getpid());
+    }
+    comm.bcast(pidAndFd.data(), pidAndFd.size(), mpi::MpiType::kINT32, 0);
+
+    int localImported{1};
+    if (comm.getRank() != 0)
+    {
+        auto const fd = getPeerFileDescriptor(pidAndFd[0], pidAndFd[1]);
+        localImported = 0;
+        if (fd >= 0)
+        {
+            auto const result = driver->cuMemImportFromShareableHandle(&multicastHandle,
+                reinterpret_cast<void*>(static_cast<std::uintptr_t>(fd)), CU_MEM_HANDLE_TYPE_POSIX_FILE_DESCRIPTOR);
+            localImported = result == CUDA_SUCCESS ? 1 : 0;
+            close(fd);
+        }
+    }
+    // All ranks fail together, e.g. without ptrace access between the processes of the ranks
+    int imported{0};
+    comm.allreduce(&localImported, &imported, 1, mpi::MpiType::kINT32, mpi::MpiOp::MIN);
+    if (comm.getRank() == 0)
+    {
+        close(pidAndFd[1]);
+    }
+    if (!imported)
+    {
+        if (multicastHandle != 0)
+        {
+            cuErrCheck(driver->cuMemRelease(multicastHandle), driver);
+        }
+        TLLM_THROW("The multicast object of the NVLS all reduce could not be shared between the ranks");
+    }
+    mMulticastHandle = multicastHandle;
+    TLLM_CU_CHECK(driver->cuMulticastAddDevice(multicastHandle, mDevice));
+
+    CUmemGenericAllocationHandle unicastHandle{0};
+    TLLM_CU_CHECK(driver->cuMemCreate(&unicastHandle, mSize, &unicastProp, 0));
+    mUnicastHandle = unicastHandle;
+
+    // The memory can be bound once the devices of all ranks are added to the multicast object
+    comm.barrier();
+    TLLM_CU_CHECK(driver->cuMulticastBindMem(multicastHandle, 0, unicastHandle, 0, mSize, 0));
+
+    mUnicastPtr = mapAllocation(unicastHandle, mSize, granularity, mDevice);
+    mMulticastPtr = mapAllocation(multicastHandle, mSize, granularity, mDevice);
+    TLLM_CUDA_CHECK(cudaMemset(mUnicastPtr, 0, mSize));
+    TLLM_CUDA_CHECK(cudaDeviceSynchronize());
+    comm.barrier();
+    TLLM_LOG_INFO("NVLS all reduce buffers of %zu bytes over %d ranks", mSize, comm.getSize());
+#endif
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+IpcNvlsMemory::~IpcNvlsMemory()
+{
+    destroyNvlsMemory();
+}
+
+void IpcNvlsMemory::destroyNvlsMemory() noexcept
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    auto const driver = common::CUDADriverWrapper::getInstance();
+    if (mMulticastPtr != nullptr)
+    {
+        unmapAllocation(mMulticastPtr, mSize);
+    }
+    if (mUnicastPtr != nullptr)
+    {
+        unmapAllocation(mUnicastPtr, mSize);
+    }
+    if (mMulticastHandle != 0 && mUnicastHandle != 0)
+    {
+        cuErrCheck(driver->cuMulticastUnbind(mMulticastHandle, mDevice, 0, mSize), driver);
+    }
+    if (mUnicastHandle != 0)
+    {
+        cuErrCheck(driver->cuMemRelease(mUnicastHandle), driver);
+    }
+    if (mMulticastHandle != 0)
+    {
+        cuErrCheck(driver->cuMemRelease(mMulticastHandle), driver);
+    }
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 AllReduceBuffers::AllReduceBuffers(SizeType32 maxBatchSize, SizeType32 maxBeamWidth, SizeType32 maxSequenceLength,
     SizeType32 hiddenSize, BufferManager const& manager, WorldConfig const& worldConfig)
+    : mTensorParallelism(worldConfig.getTensorParallelism())
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    auto const startupScope = StartupProfiler::getInstance().scope(StartupPhase::kCUSTOM_ALL_REDUCE_SETUP);
     setPeerAccess(worldConfig, true);
 
     auto const tpSize = worldConfig.getTensorParallelism();
@@ -164,7 +392,37 @@ AllReduceBuffers::AllReduceBuffers(SizeType32 maxBatchSize, SizeType32 maxBeamWi
         TLLM_CHECK(memCommPtrs.size() == static_cast<std::size_t>(tpSize));
         std::copy(memCommPtrs.begin(), memCommPtrs.end(), commPtrs.begin() + memIdx * tpSize);
     }
+
+    // The NVLS all reduce stages the message in a single buffer, which takes the size of a message
+    if (common::getEnvAllReduceNvls() && IpcNvlsMemory::isSupported(worldConfig))
+    {
+        try
+        {
+            mNvlsMemory = std::make_unique<IpcNvlsMemory>(bufferSize / tpSize, worldConfig);
+            kernels::setNvlsBuffers(tpSize,
+                kernels::NvlsBuffers{
+                    mNvlsMemory->getUnicastPtr(), mNvlsMemory->getMulticastPtr(), mNvlsMemory->getSize()});
+        }
+        catch (common::TllmException const& e)
+        {
+            TLLM_LOG_WARNING("NVLS all reduce disabled: %s", e.what());
+        }
+    }
+
+    bool const isIpcOpen = tpSize > 1 && tpSize <= worldConfig.getGpusPerNode();
+    if (common::getEnvAllReduceAutotune() && isIpcOpen)
+    {
+        setupAllReduceStrategyTable(*this, bufferSize / tpSize, manager, worldConfig);
+    }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+AllReduceBuffers::~AllReduceBuffers()
+{
+    if (mNvlsMemory)
+    {
+        kernels::setNvlsBuffers(mTensorParallelism, std::nullopt);
+    }
+}
+
 } // namespace tensorrt_llm::runtime
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheBlockTransceiver.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+KVCacheBlockTransceiver::KVCacheBlockTransceiver(
+    TensorPtr pool, std::shared_ptr<NcclCommunicator> comm, CudaStreamPtr stream, SizeType32 maxBlocksPerChunk)
+    : mPool{std::move(pool)}
+    , mComm{std::move(comm)}
+    , mStream{std::move(stream)}
+    , mMaxBlocksPerChunk{maxBlocksPerChunk}
+{
+    TLLM_CHECK(mPool && mComm && mStream);
+    TLLM_CHECK_WITH_INFO(mMaxBlocksPerChunk > 0, "maxBlocksPerChunk must be positive.");
+    TLLM_CHECK_WITH_INFO(
+        mPool->getMemoryType() == MemoryType::kGPU, "KV cache blocks can only be sent from GPU pools.");
+    auto const numBlocks = mPool->getShape().d[0];
+    TLLM_CHECK(numBlocks > 0);
+    auto const eltsPerBlock = static_cast<SizeType32>(mPool->getSize() / numBlocks);
+
+    BufferManager manager{mStream};
+    mStaging = manager.gpu(ITensor::makeShape({mMaxBlocksPerChunk, eltsPerBlock}), mPool->getDataType());
+    mPairs = BufferManager::pinned(0, nvinfer1::DataType::kINT32);
+}
+
+void KVCacheBlockTransceiver::preparePairs(std::vector<SizeType32> const& blockIndices, bool toStaging)
+{
+    if (mPairsInUse)
+    {
+        mPairsFreeEvent.synchronize();
+    }
+    mPairs->resize(2 * blockIndices.size());
+    auto* pairs = bufferCast<SizeType32>(*mPairs);
+    auto const numBlocks = static_cast<SizeType32>(mPool->getShape().d[0]);
+    for (std::size_t i = 0; i < blockIndices.size(); ++i)
+    {
+        auto const blockIdx = blockIndices[i];
+        TLLM_CHECK_WITH_INFO(
+            blockIdx >= 0 && blockIdx < numBlocks, "Block index %d out of range [0, %d).", blockIdx, numBlocks);
+        // Position within the chunk in the staging buffer
+        auto const stagingIdx = static_cast<SizeType32>(i % mMaxBlocksPerChunk);
+        pairs[2 * i] = toStaging ? blockIdx : stagingIdx;
+        pairs[2 * i + 1] = toStaging ? stagingIdx : blockIdx;
+    }
+    mPairsInUse = true;
+}
+
+void KVCacheBlockTransceiver::sendBlocks(std::vector<SizeType32> const& blockIndices, int peer)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    NVTX3_SCOPED_RANGE(kvCacheSendBlocks);
+    preparePairs(blockIndices, true);
+    auto const numBlocks = static_cast<SizeType32>(blockIndices.size());
+    TLLM_LOG_DEBUG("Sending %d KV cache blocks to rank %d", numBlocks, peer);
+    for (SizeType32 offset = 0; offset < numBlocks; offset += mMaxBlocksPerChunk)
+    {
+        auto const chunkSize = std::min(mMaxBlocksPerChunk, numBlocks - offset);
+        auto const chunkPairs = IBuffer::slice(mPairs, 2 * offset, 2 * chunkSize);
+        kernels::invokeCopyBlocks(*mPool, *mStaging, *chunkPairs, chunkSize, *mStream);
+        auto const chunk = ITensor::slice(mStaging, 0, chunkSize);
+        mComm->send(*chunk, peer, *mStream);
+    }
+    mStream->record(mPairsFreeEvent);
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+void KVCacheBlockTransceiver::receiveBlocks(std::vector<SizeType32> const& blockIndices, int peer)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    NVTX3_SCOPED_RANGE(kvCacheReceiveBlocks);
+    preparePairs(blockIndices, false);
+    auto const numBlocks = static_cast<SizeType32>(blockIndices.size());
+    TLLM_LOG_DEBUG("Receiving %d KV cache blocks from rank %d", numBlocks, peer);
+    for (SizeType32 offset = 0; offset < numBlocks; offset += mMaxBlocksPerChunk)
+    {
+        auto const chunkSize = std::min(mMaxBlocksPerChunk, numBlocks - offset);
+        auto chunk = ITensor::slice(mStaging, 0, chunkSize);
+        mComm->receive(*chunk, peer, *mStream);
+        auto const chunkPairs = IBuffer::slice(mPairs, 2 * offset, 2 * chunkSize);
+        kernels::invokeCopyBlocks(*mStaging, *mPool, *chunkPairs, chunkSize, *mStream);
+    }
+    mStream->record(mPairsFreeEvent);
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/ncclCommunicator.h"
+
+#include <memory>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+/**
+ * \brief Streams KV cache blocks between the primary pools of two executors, e.g. from a context (prefill) instance
+ * to a generation (decode) instance.
+ * \details The sender exports the pool block indices of a finished context (KVCacheIndex::get() of its primary
+ * blocks, in sequence order) with sendBlocks(). The receiver allocates the same number of blocks in its own pool and
+ * adopts the content with receiveBlocks(), passing its block indices in the same order. Blocks are gathered into a
+ * contiguous staging buffer and sent in chunks of maxBlocksPerChunk blocks with NCCL, so the transfer doesn't depend
+ * on the pool layout of either side, only on both pools having the same block size and data type.
+ *
+ * All work is enqueued on the given stream, callers must order the first use of received blocks after it.
+ */
+class KVCacheBlockTransceiver
+{
+public:
+    using SizeType32 = runtime::SizeType32;
+    using TensorPtr = ITensor::SharedPtr;
+    using CudaStreamPtr = std::shared_ptr<CudaStream>;
+
+    KVCacheBlockTransceiver(TensorPtr pool, std::shared_ptr<NcclCommunicator> comm, CudaStreamPtr stream,
+        SizeType32 maxBlocksPerChunk = kDefaultMaxBlocksPerChunk);
+
+    //! \brief Send the given pool blocks to peer. The peer must receive the same number of blocks.
+    void sendBlocks(std::vector<SizeType32> const& blockIndices, int peer);
+
+    //! \brief Receive blocks from peer into the given pool blocks.
+    void receiveBlocks(std::vector<SizeType32> const& blockIndices, int peer);
+
+    [[nodiscard]] CudaStream const& getStream() const noexcept
+    {
+        return *mStream;
+    }
+
+    static SizeType32 constexpr kDefaultMaxBlocksPerChunk = 64;
+
+private:
+    //! \brief Fill the pinned block pairs for a transfer of blockIndices, (pool, staging) or (staging, pool).
+    void preparePairs(std::vector<SizeType32> const& blockIndices, bool toStaging);
+
+    TensorPtr mPool;
+    std::shared_ptr<NcclCommunicator> mComm;
+    CudaStreamPtr mStream;
+    SizeType32 mMaxBlocksPerChunk;
+
+    // Blocks are (un)packed through this device buffer, [maxBlocksPerChunk, eltsPerBlock]
+    TensorPtr mStaging;
+    // Pinned (src, dst) pairs of the last transfer, read by the copy kernels
+    IBuffer::SharedPtr mPairs;
+    CudaEvent mPairsFreeEvent;
+    bool mPairsInUse{false};
+};
+
+} // namespace tensorrt_llm::runtime
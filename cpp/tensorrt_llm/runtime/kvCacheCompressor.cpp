@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheCompressor.h"
+
+#include "tensorrt_llm/batch_manager/kvCacheManager.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/kernels/kvCacheCompaction.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace tk = tensorrt_llm::kernels;
+
+namespace tensorrt_llm::runtime
+{
+
+KvCacheCompressor::KvCacheCompressor(KvCompressionConfig const& config, SizeType32 maxBatchSize,
+    SizeType32 maxAttentionWindow, SizeType32 numLayers, SizeType32 numKvHeads, SizeType32 bytesPerHead,
+    BufferManager const& manager)
+    : mConfig{config}
+    , mMaxBatchSize{maxBatchSize}
+    , mMaxAttentionWindow{maxAttentionWindow}
+    , mNumLayers{numLayers}
+    , mNumKvHeads{numKvHeads}
+    , mBytesPerHead{bytesPerHead}
+    , mManager{manager}
+    , mEnabled(maxBatchSize, false)
+    , mEvictedHost(maxBatchSize, 0)
+    , mStepsSinceEviction(maxBatchSize, 0)
+{
+    TLLM_CHECK_WITH_INFO(mConfig.maxCachedTokens < mMaxAttentionWindow,
+        "maxCachedTokens (%d) must be smaller than the attention window (%d)", mConfig.maxCachedTokens,
+        mMaxAttentionWindow);
+    TLLM_CHECK_WITH_INFO(mBytesPerHead % 16 == 0, "KV compression needs heads of a multiple of 16 bytes, got %d",
+        mBytesPerHead);
+
+    auto constexpr kINT32 = nvinfer1::DataType::kINT32;
+    auto constexpr kFLOAT = nvinfer1::DataType::kFLOAT;
+    auto const scoresShape = ITensor::makeShape({mMaxBatchSize, mMaxAttentionWindow});
+    mScores = mManager.gpu(scoresShape, kFLOAT);
+    mScoresHost = BufferManager::pinned(scoresShape, kFLOAT);
+    mEvicted = mManager.gpu(ITensor::makeShape({mMaxBatchSize}), kINT32);
+    mEvictedPinned = BufferManager::pinned(ITensor::makeShape({mMaxBatchSize}), kINT32);
+    auto const keptShape = ITensor::makeShape({mMaxBatchSize, mConfig.maxCachedTokens});
+    mKeptTokensHost = BufferManager::pinned(keptShape, kINT32);
+    mKeptTokens = mManager.gpu(keptShape, kINT32);
+    mNumTokensHost = BufferManager::pinned(ITensor::makeShape({mMaxBatchSize}), kINT32);
+    mNumTokens = mManager.gpu(ITensor::makeShape({mMaxBatchSize}), kINT32);
+    mScoreRowsHost = BufferManager::pinned(ITensor::makeShape({mMaxBatchSize}), kINT32);
+    mScoreRows = mManager.gpu(ITensor::makeShape({mMaxBatchSize}), kINT32);
+    mBlockOffsetsHost = BufferManager::pinned(ITensor::makeShape({0}), kINT32);
+    mBlockOffsets = mManager.gpu(ITensor::makeShape({0}), kINT32);
+
+    mManager.setZero(*mScores);
+    mManager.setZero(*mEvicted);
+}
+
+void KvCacheCompressor::reset(std::vector<bool> const& enabled)
+{
+    TLLM_CHECK_WITH_INFO(static_cast<SizeType32>(enabled.size()) <= mMaxBatchSize,
+        "KV compression of %zu sequences, at most %d", enabled.size(), mMaxBatchSize);
+    std::fill(mEnabled.begin(), mEnabled.end(), false);
+    std::copy(enabled.begin(), enabled.end(), mEnabled.begin());
+    std::fill(mEvictedHost.begin(), mEvictedHost.end(), 0);
+    std::fill(mStepsSinceEviction.begin(), mStepsSinceEviction.end(), 0);
+    mManager.setZero(*mScores);
+    mManager.setZero(*mEvicted);
+}
+
+KvCompressionBuffers KvCacheCompressor::getBuffers(SizeType32 batchOffset) const
+{
+    TLLM_CHECK(0 <= batchOffset && batchOffset < mMaxBatchSize);
+    auto* const scores = bufferCast<float>(*mScores) + static_cast<std::size_t>(batchOffset) * mMaxAttentionWindow;
+    return KvCompressionBuffers{scores, bufferCast<std::int32_t>(*mEvicted) + batchOffset, mMaxAttentionWindow};
+}
+
+std::vector<SizeType32> KvCacheCompressor::selectTokens(
+    float const* scores, SizeType32 numTokens, KvCompressionConfig const& config)
+{
+    std::vector<SizeType32> kept(numTokens);
+    std::iota(kept.begin(), kept.end(), 0);
+    if (numTokens <= config.maxCachedTokens)
+    {
+        return kept;
+    }
+    // The middle tokens compete for the budget left by the sink and the recent tokens
+    auto const middleBegin = kept.begin() + config.sinkTokens;
+    auto const middleEnd = kept.end() - config.recentTokens;
+    auto const numMiddleKept = config.maxCachedTokens - config.sinkTokens - config.recentTokens;
+    std::nth_element(middleBegin, middleBegin + numMiddleKept, middleEnd,
+        [scores](SizeType32 lhs, SizeType32 rhs)
+        { return scores[lhs] > scores[rhs] || (scores[lhs] == scores[rhs] && lhs > rhs); });
+    std::sort(middleBegin, middleBegin + numMiddleKept);
+    std::copy(middleEnd, kept.end(), middleBegin + numMiddleKept);
+    kept.resize(config.maxCachedTokens);
+    return kept;
+}
+
+SizeType32 KvCacheCompressor::compress(KvCacheManager& kvCacheManager, SizeType32 batchOffset, SizeType32 batchSize)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_CHECK(0 <= batchOffset && batchOffset + batchSize <= mMaxBatchSize);
+
+    std::vector<SizeType32> batchIndices;
+    std::vector<SizeType32> numTokens;
+    for (auto batchIdx = batchOffset; batchIdx < batchOffset + batchSize; ++batchIdx)
+    {
+        if (!mEnabled[batchIdx])
+        {
+            continue;
+        }
+        auto const cachedTokens = kvCacheManager.getNumTokens(batchIdx);
+        if (++mStepsSinceEviction[batchIdx] >= mConfig.slackTokens && cachedTokens > mConfig.maxCachedTokens)
+        {
+            batchIndices.push_back(batchIdx);
+            numTokens.push_back(cachedTokens);
+        }
+    }
+    auto const numSeqs = static_cast<SizeType32>(batchIndices.size());
+    if (numSeqs == 0)
+    {
+        return 0;
+    }
+
+    for (SizeType32 i = 0; i < numSeqs; ++i)
+    {
+        mManager.copy(*ITensor::slice(mScores, batchIndices[i], 1), *ITensor::slice(mScoresHost, i, 1));
+    }
+    // Also completes the uploads of the previous compression, the staging buffers are rewritten below
+    mManager.getStream().synchronize();
+
+    auto const maxBlocksPerSeq = kvCacheManager.getMaxBlocksPerSeq();
+    auto const blockOffsetsShape = ITensor::makeShape({numSeqs, 2, maxBlocksPerSeq});
+    mBlockOffsetsHost->reshape(blockOffsetsShape);
+    mBlockOffsets->reshape(blockOffsetsShape);
+
+    auto* const scoresHost = bufferCast<float>(*mScoresHost);
+    auto* const keptTokensHost = bufferCast<std::int32_t>(*mKeptTokensHost);
+    auto* const numTokensHost = bufferCast<std::int32_t>(*mNumTokensHost);
+    auto* const scoreRowsHost = bufferCast<std::int32_t>(*mScoreRowsHost);
+    for (SizeType32 i = 0; i < numSeqs; ++i)
+    {
+        auto const kept = selectTokens(
+            scoresHost + static_cast<std::size_t>(i) * mMaxAttentionWindow, numTokens[i], mConfig);
+        std::copy(kept.begin(), kept.end(), keptTokensHost + static_cast<std::size_t>(i) * mConfig.maxCachedTokens);
+        numTokensHost[i] = numTokens[i];
+        scoreRowsHost[i] = batchIndices[i];
+        kvCacheManager.copyBlockOffsets(*mBlockOffsetsHost, i, batchIndices[i], /* beamWidth */ 1);
+    }
+    mManager.copy(*ITensor::slice(mKeptTokensHost, 0, numSeqs), *ITensor::slice(mKeptTokens, 0, numSeqs));
+    mManager.copy(*ITensor::slice(mNumTokensHost, 0, numSeqs), *ITensor::slice(mNumTokens, 0, numSeqs));
+    mManager.copy(*ITensor::slice(mScoreRowsHost, 0, numSeqs), *ITensor::slice(mScoreRows, 0, numSeqs));
+    mManager.copy(*mBlockOffsetsHost, *mBlockOffsets);
+
+    auto const poolPointers = kvCacheManager.getBlockPoolPointers();
+    auto const* const pools = static_cast<char* const*>(poolPointers->data());
+    tk::KvCacheCompactionParams params{};
+    params.kv_cache = tk::KVBlockArray(numSeqs, maxBlocksPerSeq, kvCacheManager.getTokensPerBlock(),
+        mNumKvHeads * mBytesPerHead, mMaxAttentionWindow, /* sinkTokenLen */ 0, pools[0], pools[1],
+        bufferCast<tk::KVBlockArray::DataType>(*mBlockOffsets));
+    params.num_layers = mNumLayers;
+    params.num_kv_heads = mNumKvHeads;
+    params.bytes_per_head = mBytesPerHead;
+    params.kept_tokens = bufferCast<std::int32_t>(*mKeptTokens);
+    // All the compressed sequences keep the budget
+    params.num_kept_tokens = nullptr;
+    params.max_kept_tokens = mConfig.maxCachedTokens;
+    params.num_tokens = bufferCast<std::int32_t>(*mNumTokens);
+    params.num_seqs = numSeqs;
+    params.importance_scores = bufferCast<float>(*mScores);
+    params.score_rows = bufferCast<std::int32_t>(*mScoreRows);
+    params.scores_stride = mMaxAttentionWindow;
+    tk::invokeCompactKvCache(params, mManager.getStream().get());
+
+    for (SizeType32 i = 0; i < numSeqs; ++i)
+    {
+        auto const batchIdx = batchIndices[i];
+        auto const numEvicted = numTokens[i] - mConfig.maxCachedTokens;
+        kvCacheManager.rewindKVCache(batchIdx, numEvicted);
+        mEvictedHost[batchIdx] += numEvicted;
+        mStepsSinceEviction[batchIdx] = 0;
+    }
+    auto* const evictedPinned = bufferCast<std::int32_t>(*mEvictedPinned);
+    std::copy(mEvictedHost.begin() + batchOffset, mEvictedHost.begin() + batchOffset + batchSize,
+        evictedPinned + batchOffset);
+    mManager.copy(
+        *ITensor::slice(mEvictedPinned, batchOffset, batchSize), *ITensor::slice(mEvicted, batchOffset, batchSize));
+
+    TLLM_LOG_DEBUG("Evicted the KV cache tokens of %d sequences", numSeqs);
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+    return numSeqs;
+}
+
+} // namespace tensorrt_llm::runtime
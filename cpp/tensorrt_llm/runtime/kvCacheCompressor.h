@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/kvCompressionConfig.h"
+#include "tensorrt_llm/runtime/kvCompressionContext.h"
+
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+class KVCacheManager;
+}
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Evicts the least attended tokens from the paged KV cache of long generations, see KvCompressionConfig.
+//! \details The sequences are indexed by their batch index, which is also their slot in the KV cache manager. The
+//! importance scores are accumulated by the attention plugins during the engine executions within a
+//! KvCompressionContext::Scope of the buffers, only in the generation phase. Requires beam width 1 and a cache without
+//! cyclic window or block reuse.
+class KvCacheCompressor
+{
+public:
+    using KvCacheManager = batch_manager::kv_cache_manager::KVCacheManager;
+    using TensorPtr = ITensor::SharedPtr;
+
+    //! \param bytesPerHead sizePerHead * the size of an element of the cache.
+    KvCacheCompressor(KvCompressionConfig const& config, SizeType32 maxBatchSize, SizeType32 maxAttentionWindow,
+        SizeType32 numLayers, SizeType32 numKvHeads, SizeType32 bytesPerHead, BufferManager const& manager);
+
+    //! \brief Starts the generation of a batch, clears the scores and the evictions of all the sequences.
+    //! \param enabled Whether the cache of each sequence of the batch is compressed.
+    void reset(std::vector<bool> const& enabled);
+
+    //! \returns The buffers of the sequences from batchOffset on, for the engine execution of a micro batch.
+    [[nodiscard]] KvCompressionBuffers getBuffers(SizeType32 batchOffset) const;
+
+    //! \brief Evicts tokens from the caches of the sequences of a micro batch that outgrew the budget, once the
+    //! generation step completed and before the next one adds its token. Synchronizes the stream when it evicts.
+    //! \returns The number of compressed sequences.
+    SizeType32 compress(KvCacheManager& kvCacheManager, SizeType32 batchOffset, SizeType32 batchSize);
+
+    //! \returns The tokens evicted from the cache of the sequence since the last reset.
+    [[nodiscard]] SizeType32 getNumEvictedTokens(SizeType32 batchIdx) const
+    {
+        return mEvictedHost.at(batchIdx);
+    }
+
+    //! \brief The tokens kept by an eviction: the sink tokens, the recent tokens and the highest scores in between.
+    //! \param scores The importance of the numTokens cached tokens.
+    //! \returns The indices of the kept tokens, ascending.
+    [[nodiscard]] static std::vector<SizeType32> selectTokens(
+        float const* scores, SizeType32 numTokens, KvCompressionConfig const& config);
+
+private:
+    KvCompressionConfig mConfig;
+    SizeType32 mMaxBatchSize;
+    SizeType32 mMaxAttentionWindow;
+    SizeType32 mNumLayers;
+    SizeType32 mNumKvHeads;
+    SizeType32 mBytesPerHead;
+    BufferManager mManager;
+
+    //! [maxBatchSize, maxAttentionWindow], on gpu
+    TensorPtr mScores;
+    //! [maxBatchSize], on gpu
+    TensorPtr mEvicted;
+    //! Pinned staging of the scores, the kept tokens and the block offsets of the compressed sequences
+    TensorPtr mScoresHost;
+    TensorPtr mKeptTokensHost;
+    TensorPtr mKeptTokens;
+    TensorPtr mNumTokensHost;
+    TensorPtr mNumTokens;
+    TensorPtr mScoreRowsHost;
+    TensorPtr mScoreRows;
+    TensorPtr mBlockOffsetsHost;
+    TensorPtr mBlockOffsets;
+    TensorPtr mEvictedPinned;
+
+    std::vector<bool> mEnabled;
+    std::vector<SizeType32> mEvictedHost;
+    //! Generation steps of each sequence since its last eviction
+    std::vector<SizeType32> mStepsSinceEviction;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheDiskTier.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif // !defined(_WIN32)
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+std::size_t roundUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+KVCacheDiskTier::KVCacheDiskTier(
+    std::filesystem::path const& filePath, std::size_t bytesPerBlock, SizeType32 maxNumBlocks, bool useDirectIo)
+    : mFilePath{filePath}
+    , mBytesPerBlock{bytesPerBlock}
+    , mSlotStride{roundUp(bytesPerBlock, kDirectIoAlignment)}
+    , mMaxNumBlocks{maxNumBlocks}
+    , mUseDirectIo{useDirectIo}
+{
+#if defined(_WIN32)
+    TLLM_THROW("The KV cache disk tier is not supported on Windows.");
+#else
+    TLLM_CHECK_WITH_INFO(bytesPerBlock > 0, "bytesPerBlock must be positive.");
+    TLLM_CHECK_WITH_INFO(maxNumBlocks > 0, "maxNumBlocks must be positive.");
+    if (mUseDirectIo && bytesPerBlock % kDirectIoAlignment != 0)
+    {
+        TLLM_LOG_WARNING("KV cache block size %lu is not a multiple of %lu bytes, disabling direct I/O.",
+            bytesPerBlock, kDirectIoAlignment);
+        mUseDirectIo = false;
+    }
+
+    int flags = O_RDWR | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+    if (mUseDirectIo)
+    {
+        flags |= O_DIRECT;
+    }
+#else
+    mUseDirectIo = false;
+#endif
+    mFd = ::open(mFilePath.c_str(), flags, 0600);
+    TLLM_CHECK_WITH_INFO(
+        mFd >= 0, "Failed to open KV cache disk tier file %s: %s", mFilePath.c_str(), std::strerror(errno));
+
+    auto const fileSize = slotOffset(mMaxNumBlocks);
+    if (::posix_fallocate(mFd, 0, fileSize) != 0)
+    {
+        ::close(mFd);
+        TLLM_THROW("Failed to reserve %ld bytes for KV cache disk tier file %s", fileSize, mFilePath.c_str());
+    }
+
+    mSlots.resize(mMaxNumBlocks);
+    mFreeSlots.reserve(mMaxNumBlocks);
+    for (SizeType32 slot = mMaxNumBlocks - 1; slot >= 0; --slot)
+    {
+        mFreeSlots.push_back(slot);
+    }
+    TLLM_LOG_INFO("Allocated KV cache disk tier with %d blocks (%ld bytes) in %s", mMaxNumBlocks, fileSize,
+        mFilePath.c_str());
+#endif // defined(_WIN32)
+}
+
+KVCacheDiskTier::~KVCacheDiskTier()
+{
+#if !defined(_WIN32)
+    if (mFd >= 0)
+    {
+        ::close(mFd);
+        std::error_code ec;
+        std::filesystem::remove(mFilePath, ec);
+    }
+#endif // !defined(_WIN32)
+}
+
+void KVCacheDiskTier::checkAlignment(void const* data) const
+{
+    TLLM_CHECK_WITH_INFO(!mUseDirectIo || reinterpret_cast<std::uintptr_t>(data) % kDirectIoAlignment == 0,
+        "Direct I/O requires buffers aligned to %lu bytes.", kDirectIoAlignment);
+}
+
+SizeType32 KVCacheDiskTier::acquireSlot(std::unique_lock<std::mutex>& lock)
+{
+    while (mFreeSlots.empty())
+    {
+        if (!mLru.empty())
+        {
+            // The victim's slot becomes free once in-flight loads of it have finished.
+            eraseEntry(mEntries.find(mLru.back()));
+            ++mStats.numEvicted;
+        }
+        else
+        {
+            mSlotCv.wait(lock);
+        }
+    }
+    auto const slot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+    return slot;
+}
+
+void KVCacheDiskTier::releaseIfIdle(SizeType32 slot)
+{
+    auto const& state = mSlots[slot];
+    if (!state.inUse && !state.writing && state.numReaders == 0)
+    {
+        mFreeSlots.push_back(slot);
+        mSlotCv.notify_all();
+    }
+}
+
+void KVCacheDiskTier::eraseEntry(std::unordered_map<KeyType, Entry>::iterator it)
+{
+    auto const slot = it->second.slot;
+    mLru.erase(it->second.lruIt);
+    mEntries.erase(it);
+    mSlots[slot].inUse = false;
+    releaseIfIdle(slot);
+}
+
+void KVCacheDiskTier::store(KeyType key, void const* data)
+{
+#if !defined(_WIN32)
+    checkAlignment(data);
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (auto it = mEntries.find(key); it != mEntries.end())
+    {
+        mLru.splice(mLru.begin(), mLru, it->second.lruIt);
+        return;
+    }
+
+    auto const slot = acquireSlot(lock);
+    // Publish the entry before writing so that concurrent stores of the key return early and loads wait for the data.
+    mSlots[slot].inUse = true;
+    mSlots[slot].writing = true;
+    mLru.push_front(key);
+    mEntries.emplace(key, Entry{slot, mLru.begin()});
+    lock.unlock();
+
+    auto const written = ::pwrite(mFd, data, mBytesPerBlock, slotOffset(slot));
+    auto const error = errno;
+
+    lock.lock();
+    mSlots[slot].writing = false;
+    bool const success = written == static_cast<ssize_t>(mBytesPerBlock);
+    if (success)
+    {
+        ++mStats.numStored;
+    }
+    if (auto it = mEntries.find(key); !success && it != mEntries.end() && it->second.slot == slot)
+    {
+        eraseEntry(it);
+    }
+    else
+    {
+        // The entry may have been erased or evicted while it was written.
+        releaseIfIdle(slot);
+    }
+    mSlotCv.notify_all();
+    lock.unlock();
+    TLLM_CHECK_WITH_INFO(
+        success, "Failed to write KV cache block to %s: %s", mFilePath.c_str(), std::strerror(error));
+#endif // !defined(_WIN32)
+}
+
+bool KVCacheDiskTier::load(KeyType key, void* data)
+{
+#if !defined(_WIN32)
+    checkAlignment(data);
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto it = mEntries.find(key);
+    // Wait for a pending store of the key, which may also fail or be evicted meanwhile.
+    while (it != mEntries.end() && mSlots[it->second.slot].writing)
+    {
+        mSlotCv.wait(lock);
+        it = mEntries.find(key);
+    }
+    if (it == mEntries.end())
+    {
+        ++mStats.numMisses;
+        return false;
+    }
+    auto const slot = it->second.slot;
+    ++mSlots[slot].numReaders;
+    mLru.splice(mLru.begin(), mLru, it->second.lruIt);
+    lock.unlock();
+
+    auto const read = ::pread(mFd, data, mBytesPerBlock, slotOffset(slot));
+    auto const error = errno;
+
+    lock.lock();
+    --mSlots[slot].numReaders;
+    releaseIfIdle(slot);
+    bool const success = read == static_cast<ssize_t>(mBytesPerBlock);
+    if (success)
+    {
+        ++mStats.numHits;
+    }
+    lock.unlock();
+    TLLM_CHECK_WITH_INFO(
+        success, "Failed to read KV cache block from %s: %s", mFilePath.c_str(), std::strerror(error));
+    return true;
+#else
+    return false;
+#endif // !defined(_WIN32)
+}
+
+bool KVCacheDiskTier::contains(KeyType key) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.find(key) != mEntries.end();
+}
+
+bool KVCacheDiskTier::erase(KeyType key)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mEntries.find(key);
+    if (it == mEntries.end())
+    {
+        return false;
+    }
+    eraseEntry(it);
+    return true;
+}
+
+SizeType32 KVCacheDiskTier::getNumBlocks() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return static_cast<SizeType32>(mEntries.size());
+}
+
+KVCacheDiskTier::Stats KVCacheDiskTier::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+} // namespace tensorrt_llm::runtime
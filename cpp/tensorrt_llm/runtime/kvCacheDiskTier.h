@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+/**
+ * \brief Third tier for reusable KV cache blocks, backed by a file on local storage.
+ * \details Blocks evicted from the host pool can be stored here and loaded back when their token prefix is requested
+ * again. Blocks are keyed by the rolling block hash of the KV cache prefix index, which identifies a block together
+ * with its whole prefix, so no token ids need to be stored on disk.
+ *
+ * The file is preallocated with maxNumBlocks fixed size slots. When all slots are used, the least recently used block
+ * is overwritten. With useDirectIo, the file is opened with O_DIRECT to bypass the page cache; in that case the block
+ * size and the host buffers passed to store() / load() must be aligned to kDirectIoAlignment (pinned buffers from
+ * cudaHostAlloc are page aligned).
+ *
+ * All methods are thread safe. I/O is synchronous, callers are expected to run it on worker threads. The mutex only
+ * guards the bookkeeping: pwrite / pread run unlocked, and per-slot state keeps a slot from being reused while it is
+ * read and keeps loads of a block from starting before its write has finished.
+ */
+class KVCacheDiskTier
+{
+public:
+    using KeyType = std::uint64_t;
+
+    struct Stats
+    {
+        std::size_t numStored{0};
+        std::size_t numHits{0};
+        std::size_t numMisses{0};
+        std::size_t numEvicted{0};
+    };
+
+    KVCacheDiskTier(std::filesystem::path const& filePath, std::size_t bytesPerBlock, SizeType32 maxNumBlocks,
+        bool useDirectIo = false);
+
+    ~KVCacheDiskTier();
+
+    KVCacheDiskTier(KVCacheDiskTier const&) = delete;
+    KVCacheDiskTier& operator=(KVCacheDiskTier const&) = delete;
+
+    //! \brief Store a block, replacing the least recently used block if the tier is full.
+    //! \details Storing a key that is already present, or still being written, only refreshes its recency. Waits for
+    //! a slot if every slot is still being read or written.
+    void store(KeyType key, void const* data);
+
+    //! \brief Copy a stored block into data.
+    //! \details Waits for the block if it is still being written.
+    //! \return false if the block is not in the tier.
+    [[nodiscard]] bool load(KeyType key, void* data);
+
+    [[nodiscard]] bool contains(KeyType key) const;
+
+    //! \brief Drop a block from the tier.
+    //! \return false if the block is not in the tier.
+    bool erase(KeyType key);
+
+    [[nodiscard]] SizeType32 getNumBlocks() const;
+
+    [[nodiscard]] SizeType32 getMaxNumBlocks() const noexcept
+    {
+        return mMaxNumBlocks;
+    }
+
+    [[nodiscard]] std::size_t getBytesPerBlock() const noexcept
+    {
+        return mBytesPerBlock;
+    }
+
+    [[nodiscard]] Stats getStats() const;
+
+    static std::size_t constexpr kDirectIoAlignment = 4096;
+
+private:
+    struct Entry
+    {
+        SizeType32 slot;
+        std::list<KeyType>::iterator lruIt;
+    };
+
+    struct Slot
+    {
+        // An entry refers to the slot
+        bool inUse{false};
+        bool writing{false};
+        SizeType32 numReaders{0};
+    };
+
+    [[nodiscard]] std::int64_t slotOffset(SizeType32 slot) const noexcept
+    {
+        return static_cast<std::int64_t>(slot) * static_cast<std::int64_t>(mSlotStride);
+    }
+
+    void checkAlignment(void const* data) const;
+
+    //! \brief Take a free slot, evicting least recently used blocks and waiting for their I/O as needed.
+    SizeType32 acquireSlot(std::unique_lock<std::mutex>& lock);
+
+    //! \brief Return the slot to the free list once no entry refers to it and no I/O uses it.
+    void releaseIfIdle(SizeType32 slot);
+
+    void eraseEntry(std::unordered_map<KeyType, Entry>::iterator it);
+
+    std::filesystem::path mFilePath;
+    std::size_t mBytesPerBlock;
+    std::size_t mSlotStride;
+    SizeType32 mMaxNumBlocks;
+    bool mUseDirectIo;
+    int mFd{-1};
+
+    mutable std::mutex mMutex;
+    std::condition_variable mSlotCv;
+    std::vector<Slot> mSlots;
+    std::unordered_map<KeyType, Entry> mEntries;
+    // Most recently used key at the front
+    std::list<KeyType> mLru;
+    std::vector<SizeType32> mFreeSlots;
+    Stats mStats;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheTransferManager.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+KVCacheTransferManager::KVCacheTransferManager(TensorPtr primaryPool, TensorPtr secondaryPool,
+    CudaStreamPtr mainStream, SizeType32 maxCopiesPerLaunch, std::optional<nvinfer1::DataType> secondaryQuantType)
+    : mPrimaryPool{std::move(primaryPool)}
+    , mSecondaryPool{std::move(secondaryPool)}
+    , mMainStream{std::move(mainStream)}
+    , mMaxCopiesPerLaunch{maxCopiesPerLaunch}
+    , mSecondaryQuantType{secondaryQuantType}
+{
+    TLLM_CHECK(mPrimaryPool && mSecondaryPool && mMainStream);
+    TLLM_CHECK_WITH_INFO(mMaxCopiesPerLaunch > 0, "maxCopiesPerLaunch must be positive.");
+    TLLM_CHECK_WITH_INFO(mSecondaryPool->getMemoryType() == MemoryType::kPINNED
+            || mSecondaryPool->getMemoryType() == MemoryType::kUVM,
+        "Secondary pool must be device accessible host memory.");
+    auto const numPrimaryBlocks = mPrimaryPool->getShape().d[0];
+    auto const numSecondaryBlocks = mSecondaryPool->getShape().d[0];
+    TLLM_CHECK(numPrimaryBlocks > 0 && numSecondaryBlocks > 0);
+    auto const secondaryBlockSize = getSecondaryBlockSize(
+        mPrimaryPool->getSize() / numPrimaryBlocks, mPrimaryPool->getDataType(), mSecondaryQuantType);
+    TLLM_CHECK_WITH_INFO(mSecondaryPool->getSizeInBytes() / numSecondaryBlocks == secondaryBlockSize,
+        "Secondary pool must have a block size of %lu bytes.", secondaryBlockSize);
+
+    // Lowest priority so that block moves yield to the forward pass when both are runnable.
+    mCopyStream = std::make_shared<CudaStream>(StreamPriority::kLOW);
+
+    for (auto& buffer : mStagingBuffers)
+    {
+        buffer = BufferManager::pinned(2 * mMaxCopiesPerLaunch, nvinfer1::DataType::kINT32);
+    }
+}
+
+void KVCacheTransferManager::offload(SizeType32 primaryBlockIdx, SizeType32 secondaryBlockIdx)
+{
+    mPendingOffloads.push_back(primaryBlockIdx);
+    mPendingOffloads.push_back(secondaryBlockIdx);
+}
+
+void KVCacheTransferManager::onboard(SizeType32 secondaryBlockIdx, SizeType32 primaryBlockIdx)
+{
+    mPendingOnboards.push_back(secondaryBlockIdx);
+    mPendingOnboards.push_back(primaryBlockIdx);
+}
+
+std::size_t KVCacheTransferManager::getSecondaryBlockSize(std::size_t numEltsPerBlock, nvinfer1::DataType primaryType,
+    std::optional<nvinfer1::DataType> secondaryQuantType)
+{
+    return secondaryQuantType ? kernels::getQuantizedBlockSize(numEltsPerBlock, secondaryQuantType.value())
+                              : numEltsPerBlock * BufferDataType(primaryType).getSize();
+}
+
+IBuffer& KVCacheTransferManager::nextStagingBuffer()
+{
+    auto const idx = mNextStagingBuffer;
+    mNextStagingBuffer = (mNextStagingBuffer + 1) % kNumStagingBuffers;
+    if (mStagingInFlight[idx])
+    {
+        // The kernel reading this buffer was submitted kNumStagingBuffers launches ago, normally long done.
+        mStagingEvents[idx].synchronize();
+    }
+    mStagingInFlight[idx] = true;
+    return *mStagingBuffers[idx];
+}
+
+void KVCacheTransferManager::launch(std::vector<SizeType32>& pendingPairs, bool isOffload)
+{
+    auto const& srcPool = isOffload ? *mPrimaryPool : *mSecondaryPool;
+    auto& dstPool = isOffload ? *mSecondaryPool : *mPrimaryPool;
+    auto const numCopies = static_cast<SizeType32>(pendingPairs.size() / 2);
+    for (SizeType32 offset = 0; offset < numCopies; offset += mMaxCopiesPerLaunch)
+    {
+        auto const chunkSize = std::min(mMaxCopiesPerLaunch, numCopies - offset);
+        auto const stagingIdx = mNextStagingBuffer;
+        auto& staging = nextStagingBuffer();
+        auto* pairs = bufferCast<SizeType32>(staging);
+        std::copy_n(pendingPairs.begin() + 2 * offset, 2 * chunkSize, pairs);
+        if (!mSecondaryQuantType)
+        {
+            kernels::invokeCopyBlocks(srcPool, dstPool, staging, chunkSize, *mCopyStream);
+        }
+        else if (isOffload)
+        {
+            kernels::invokeQuantizeBlocks(
+                srcPool, dstPool, mSecondaryQuantType.value(), staging, chunkSize, *mCopyStream);
+        }
+        else
+        {
+            kernels::invokeDequantizeBlocks(
+                srcPool, dstPool, mSecondaryQuantType.value(), staging, chunkSize, *mCopyStream);
+        }
+        mCopyStream->record(mStagingEvents[stagingIdx]);
+    }
+    pendingPairs.clear();
+}
+
+void KVCacheTransferManager::submit()
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    if (mPendingOffloads.empty() && mPendingOnboards.empty())
+    {
+        return;
+    }
+    NVTX3_SCOPED_RANGE(kvCacheTransferSubmit);
+    TLLM_LOG_DEBUG("Submitting %d KV cache block offloads and %d onboards", getNumPendingOffloads(),
+        getNumPendingOnboards());
+
+    // Offloaded blocks are read after the main stream is done writing them, and onboarded blocks are overwritten after
+    // the main stream is done reading their previous contents. Offloads go first so that a block that is offloaded
+    // and reused for an onboard in the same submission is saved before being overwritten.
+    mMainStream->record(mMainStreamEvent);
+    mCopyStream->wait(mMainStreamEvent);
+    launch(mPendingOffloads, true);
+    launch(mPendingOnboards, false);
+
+    mCopyStream->record(mCopyDoneEvent);
+    mHasSubmitted = true;
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+void KVCacheTransferManager::syncMainStream()
+{
+    if (mHasSubmitted)
+    {
+        mMainStream->wait(mCopyDoneEvent);
+        mHasSubmitted = false;
+    }
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+/**
+ * \brief Moves KV cache blocks between the primary (GPU) and secondary (host) pools on a dedicated copy stream.
+ * \details Block moves are queued with offload() / onboard() and submitted in bulk with submit(), which issues one
+ * gather kernel per direction instead of one memcpy per block and layer. All moves are ordered after the work already
+ * enqueued on the main stream: offloads read block contents that the forward pass has finished writing, and onboards
+ * overwrite blocks that it has finished reading. Moves run concurrently with the work enqueued on the main stream
+ * after submit() until syncMainStream() is called, which lets the caller prefetch blocks for requests that are about
+ * to be scheduled while the next iteration is launched.
+ *
+ * Both pools are expected to be indexed by block along their first dimension, with the same bytes per block unless
+ * blocks are quantized. The secondary pool must be pinned host memory so that the device can access it directly.
+ *
+ * With secondaryQuantType, blocks are quantized to INT8 or FP8 as they are offloaded and dequantized as they are
+ * onboarded, fused into the transfer kernels. The secondary pool then holds getSecondaryBlockSize() bytes per block,
+ * which fits about twice as many FP16 blocks in the same host memory and halves the PCIe traffic.
+ */
+class KVCacheTransferManager
+{
+public:
+    using SizeType32 = runtime::SizeType32;
+    using TensorPtr = ITensor::SharedPtr;
+    using CudaStreamPtr = std::shared_ptr<CudaStream>;
+
+    //! \param maxCopiesPerLaunch Maximum number of block moves per direction gathered into a single kernel launch.
+    //! \param secondaryQuantType Data type blocks are quantized to in the secondary pool, kINT8 or kFP8.
+    KVCacheTransferManager(TensorPtr primaryPool, TensorPtr secondaryPool, CudaStreamPtr mainStream,
+        SizeType32 maxCopiesPerLaunch = kDefaultMaxCopiesPerLaunch,
+        std::optional<nvinfer1::DataType> secondaryQuantType = std::nullopt);
+
+    //! \brief Bytes per block in the secondary pool for primary blocks of numEltsPerBlock elements.
+    [[nodiscard]] static std::size_t getSecondaryBlockSize(std::size_t numEltsPerBlock, nvinfer1::DataType primaryType,
+        std::optional<nvinfer1::DataType> secondaryQuantType);
+
+    //! \brief Queue a copy of a primary block into a secondary block.
+    void offload(SizeType32 primaryBlockIdx, SizeType32 secondaryBlockIdx);
+
+    //! \brief Queue a copy of a secondary block into a primary block.
+    void onboard(SizeType32 secondaryBlockIdx, SizeType32 primaryBlockIdx);
+
+    //! \brief Submit all queued moves to the copy stream. Does not block the host.
+    void submit();
+
+    //! \brief Make the main stream wait until all submitted moves have completed.
+    //! \details Must be called before the main stream reads onboarded blocks or overwrites offloaded blocks.
+    void syncMainStream();
+
+    [[nodiscard]] SizeType32 getNumPendingOffloads() const noexcept
+    {
+        return static_cast<SizeType32>(mPendingOffloads.size() / 2);
+    }
+
+    [[nodiscard]] SizeType32 getNumPendingOnboards() const noexcept
+    {
+        return static_cast<SizeType32>(mPendingOnboards.size() / 2);
+    }
+
+    [[nodiscard]] CudaStream const& getCopyStream() const noexcept
+    {
+        return *mCopyStream;
+    }
+
+    static SizeType32 constexpr kDefaultMaxCopiesPerLaunch = 1024;
+
+private:
+    //! \brief Launch the queued (src, dst) pairs, chunked by mMaxCopiesPerLaunch.
+    void launch(std::vector<SizeType32>& pendingPairs, bool isOffload);
+
+    //! \brief Get a staging buffer for the next launch, waiting for its previous use to complete.
+    [[nodiscard]] IBuffer& nextStagingBuffer();
+
+    static std::size_t constexpr kNumStagingBuffers = 4;
+
+    TensorPtr mPrimaryPool;
+    TensorPtr mSecondaryPool;
+    CudaStreamPtr mMainStream;
+    CudaStreamPtr mCopyStream;
+    SizeType32 mMaxCopiesPerLaunch;
+    std::optional<nvinfer1::DataType> mSecondaryQuantType;
+
+    // Flattened (src, dst) block index pairs waiting for submit()
+    std::vector<SizeType32> mPendingOffloads;
+    std::vector<SizeType32> mPendingOnboards;
+
+    // Pinned buffers holding the pairs read by the copy kernel, reused round robin
+    std::array<IBuffer::SharedPtr, kNumStagingBuffers> mStagingBuffers;
+    std::array<CudaEvent, kNumStagingBuffers> mStagingEvents;
+    std::array<bool, kNumStagingBuffers> mStagingInFlight{};
+    std::size_t mNextStagingBuffer{0};
+
+    // Recorded on the main stream before each submission, and on the copy stream after the last one
+    CudaEvent mMainStreamEvent;
+    CudaEvent mCopyDoneEvent;
+    bool mHasSubmitted{false};
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheUvmPrefetcher.h"
+
+#include "tensorrt_llm/batch_manager/kvCacheManager.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/kernels/kvCacheIndex.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+
+namespace tk = tensorrt_llm::kernels;
+
+namespace tensorrt_llm::runtime
+{
+
+KvCacheUvmPrefetcher::KvCacheUvmPrefetcher(TensorPtr pool)
+    : mPool{std::move(pool)}
+    , mDevice{common::getDevice()}
+{
+    TLLM_CHECK_WITH_INFO(mPool && mPool->getMemoryType() == MemoryType::kUVM,
+        "The KV cache prefetcher needs a pool in unified memory.");
+    auto const numBlocks = static_cast<SizeType32>(mPool->getShape().d[0]);
+    TLLM_CHECK(numBlocks > 0);
+    mBytesPerBlock = mPool->getSizeInBytes() / numBlocks;
+    mReleased.assign(numBlocks, false);
+
+    int concurrentManagedAccess{0};
+    TLLM_CUDA_CHECK(cudaDeviceGetAttribute(&concurrentManagedAccess, cudaDevAttrConcurrentManagedAccess, mDevice));
+    mEnabled = concurrentManagedAccess != 0;
+    if (!mEnabled)
+    {
+        TLLM_LOG_WARNING(
+            "Device %d doesn't support the prefetch of unified memory, the KV cache pages migrate on faults", mDevice);
+        return;
+    }
+    // The prefetch of the next engine execution is on its critical path
+    mStream = std::make_unique<CudaStream>(StreamPriority::kHIGH);
+    auto const whole = BlockRange{0, numBlocks};
+    advise(whole, cudaMemAdviseSetPreferredLocation, mDevice);
+    advise(whole, cudaMemAdviseSetAccessedBy, mDevice);
+}
+
+KvCacheUvmPrefetcher::KvCacheUvmPrefetcher(KvCacheManager const& kvCacheManager)
+    : KvCacheUvmPrefetcher{kvCacheManager.getBlockManager().getPrimaryPool()}
+{
+}
+
+void KvCacheUvmPrefetcher::advise(BlockRange const& range, cudaMemoryAdvise advice, int device) const
+{
+    auto* const begin = static_cast<std::uint8_t*>(mPool->data()) + range.first * mBytesPerBlock;
+    TLLM_CUDA_CHECK(cudaMemAdvise(begin, range.second * mBytesPerBlock, advice, device));
+}
+
+std::vector<KvCacheUvmPrefetcher::BlockRange> KvCacheUvmPrefetcher::coalesce(std::vector<SizeType32> blocks)
+{
+    std::sort(blocks.begin(), blocks.end());
+    blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+    std::vector<BlockRange> ranges;
+    for (auto const block : blocks)
+    {
+        if (!ranges.empty() && ranges.back().first + ranges.back().second == block)
+        {
+            ++ranges.back().second;
+        }
+        else
+        {
+            ranges.emplace_back(block, 1);
+        }
+    }
+    return ranges;
+}
+
+void KvCacheUvmPrefetcher::prefetch(std::vector<SizeType32> blocks, CudaStream const& stream)
+{
+    if (!mEnabled || blocks.empty())
+    {
+        return;
+    }
+    // Blocks released to the host are advised back to the device for the sequences scheduled with them
+    std::vector<SizeType32> scheduledReleased;
+    for (auto const block : blocks)
+    {
+        if (mReleased[block])
+        {
+            scheduledReleased.push_back(block);
+            mReleased[block] = false;
+        }
+    }
+    for (auto const& range : coalesce(std::move(scheduledReleased)))
+    {
+        advise(range, cudaMemAdviseSetPreferredLocation, mDevice);
+    }
+
+    // Ordered after the work already enqueued, which may still use the blocks
+    stream.record(mEnqueued);
+    mStream->wait(mEnqueued);
+    for (auto const& range : coalesce(std::move(blocks)))
+    {
+        auto* const begin = static_cast<std::uint8_t*>(mPool->data()) + range.first * mBytesPerBlock;
+        TLLM_CUDA_CHECK(cudaMemPrefetchAsync(begin, range.second * mBytesPerBlock, mDevice, mStream->get()));
+        mNumPrefetchedBlocks += range.second;
+    }
+    mStream->record(mPrefetched);
+    stream.wait(mPrefetched);
+}
+
+void KvCacheUvmPrefetcher::prefetch(KvCacheManager const& kvCacheManager, SizeType32 firstSlot, SizeType32 numSlots,
+    SizeType32 beamWidth, CudaStream const& stream)
+{
+    if (!mEnabled)
+    {
+        return;
+    }
+    std::vector<SizeType32> blocks;
+    for (auto slot = firstSlot; slot < firstSlot + numSlots; ++slot)
+    {
+        auto const slotBlocks = getPrimaryBlocks(kvCacheManager, slot, beamWidth);
+        blocks.insert(blocks.end(), slotBlocks.begin(), slotBlocks.end());
+    }
+    prefetch(std::move(blocks), stream);
+}
+
+void KvCacheUvmPrefetcher::release(std::vector<SizeType32> blocks)
+{
+    if (!mEnabled)
+    {
+        return;
+    }
+    for (auto const& range : coalesce(std::move(blocks)))
+    {
+        advise(range, cudaMemAdviseSetPreferredLocation, cudaCpuDeviceId);
+        std::fill_n(mReleased.begin() + range.first, range.second, true);
+        mNumReleasedBlocks += range.second;
+    }
+}
+
+void KvCacheUvmPrefetcher::release(KvCacheManager const& kvCacheManager, SizeType32 slot, SizeType32 beamWidth)
+{
+    if (!mEnabled)
+    {
+        return;
+    }
+    release(getPrimaryBlocks(kvCacheManager, slot, beamWidth));
+}
+
+std::vector<SizeType32> KvCacheUvmPrefetcher::getPrimaryBlocks(
+    KvCacheManager const& kvCacheManager, SizeType32 slot, SizeType32 beamWidth)
+{
+    auto const& blockManager = kvCacheManager.getBlockManager();
+    auto const& pool = blockManager.getPrimaryPool();
+    auto const bytesPerBlock = pool->getSizeInBytes() / pool->getShape().d[0];
+    // The K or V block of a layer, the unit of the indices of the block offsets
+    auto const bytesPerField = blockManager.getBlockSize() * BufferDataType(pool->getDataType()).getSize();
+    auto const fieldsPerBlock = static_cast<SizeType32>(bytesPerBlock / bytesPerField);
+
+    auto const maxBlocksPerSeq = kvCacheManager.getMaxBlocksPerSeq();
+    auto const offsets = BufferManager::cpu(
+        ITensor::makeShape({beamWidth, 2, maxBlocksPerSeq}), TRTDataType<tk::KVCacheIndex>::value);
+    auto const numBlocks = kvCacheManager.copyBlockOffsets(*offsets, 0, slot, beamWidth);
+    auto const* const offsetsPtr = bufferCast<tk::KVCacheIndex>(*offsets);
+
+    std::vector<SizeType32> blocks;
+    blocks.reserve(beamWidth * numBlocks);
+    for (SizeType32 beam = 0; beam < beamWidth; ++beam)
+    {
+        // The K offsets are enough, the V block of a layer follows its K block
+        auto const* const keyOffsets = offsetsPtr + beam * 2 * maxBlocksPerSeq;
+        for (SizeType32 i = 0; i < numBlocks; ++i)
+        {
+            if (keyOffsets[i].isPrimary())
+            {
+                blocks.push_back(keyOffsets[i].get() / fieldsPerBlock);
+            }
+        }
+    }
+    return blocks;
+}
+
+} // namespace tensorrt_llm::runtime
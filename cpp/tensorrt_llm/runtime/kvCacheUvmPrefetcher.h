@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+class KVCacheManager;
+}
+
+namespace tensorrt_llm::runtime
+{
+
+/**
+ * \brief Prefetch and memory advice for a KV cache pool in unified memory, so that it can oversubscribe the device.
+ * \details Without hints, the pages of the pool migrate on the faults of the attention kernels, one fault group at a
+ * time. The pool is advised to live on the device and to stay mapped there, so that pages evicted to the host are
+ * read over the bus instead of faulting. Before each engine execution, the blocks of the scheduled sequences are
+ * prefetched to the device in bulk on a dedicated stream, coalesced into contiguous ranges. The blocks of completed
+ * sequences are advised to live on the host, so that the driver evicts them before the blocks in use, until they are
+ * scheduled again.
+ *
+ * The pool is indexed by block along its first dimension, a block holds the K and V of all the layers.
+ */
+class KvCacheUvmPrefetcher
+{
+public:
+    using KvCacheManager = batch_manager::kv_cache_manager::KVCacheManager;
+    using TensorPtr = ITensor::SharedPtr;
+    //! Contiguous blocks of the pool, [first, first + count)
+    using BlockRange = std::pair<SizeType32, SizeType32>;
+
+    //! \param pool The primary pool of the KV cache, in unified memory.
+    explicit KvCacheUvmPrefetcher(TensorPtr pool);
+
+    //! \brief Advises the pool of a KV cache manager, see the class description.
+    explicit KvCacheUvmPrefetcher(KvCacheManager const& kvCacheManager);
+
+    //! \returns Whether the device supports prefetch and advice, without them the pool is left to the faults.
+    [[nodiscard]] bool isEnabled() const noexcept
+    {
+        return mEnabled;
+    }
+
+    //! \brief Enqueues the migration of the blocks to the device. The stream waits for it before its next work.
+    void prefetch(std::vector<SizeType32> blocks, CudaStream const& stream);
+
+    //! \brief Prefetches the blocks held by the sequences of the slots [firstSlot, firstSlot + numSlots).
+    void prefetch(KvCacheManager const& kvCacheManager, SizeType32 firstSlot, SizeType32 numSlots,
+        SizeType32 beamWidth, CudaStream const& stream);
+
+    //! \brief Marks the blocks as first to evict, e.g. as they are released to the free queue.
+    void release(std::vector<SizeType32> blocks);
+
+    //! \brief Marks the blocks held by the sequence of the slot as first to evict, before it is removed.
+    void release(KvCacheManager const& kvCacheManager, SizeType32 slot, SizeType32 beamWidth);
+
+    //! \returns The blocks of the primary pool held by the sequence of the slot, for all the beams.
+    [[nodiscard]] static std::vector<SizeType32> getPrimaryBlocks(
+        KvCacheManager const& kvCacheManager, SizeType32 slot, SizeType32 beamWidth);
+
+    //! \returns The blocks as ascending ranges of contiguous blocks, without duplicates.
+    [[nodiscard]] static std::vector<BlockRange> coalesce(std::vector<SizeType32> blocks);
+
+    [[nodiscard]] std::uint64_t getNumPrefetchedBlocks() const noexcept
+    {
+        return mNumPrefetchedBlocks;
+    }
+
+    [[nodiscard]] std::uint64_t getNumReleasedBlocks() const noexcept
+    {
+        return mNumReleasedBlocks;
+    }
+
+private:
+    void advise(BlockRange const& range, cudaMemoryAdvise advice, int device) const;
+
+    TensorPtr mPool;
+    std::size_t mBytesPerBlock{0};
+    int mDevice{0};
+    bool mEnabled{false};
+    std::unique_ptr<CudaStream> mStream;
+    CudaEvent mEnqueued;
+    CudaEvent mPrefetched;
+    //! Whether each block of the pool is advised to live on the host
+    std::vector<bool> mReleased;
+    std::uint64_t mNumPrefetchedBlocks{0};
+    std::uint64_t mNumReleasedBlocks{0};
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCapacityPlanner.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+KvCapacityPlanner::KvCapacityPlanner(
+    ModelConfig const& modelConfig, WorldConfig const& worldConfig, SizeType32 maxBeamWidth)
+    : mModelConfig{modelConfig}
+    , mWorldConfig{worldConfig}
+    , mMaxBeamWidth{maxBeamWidth}
+{
+    TLLM_CHECK_WITH_INFO(mModelConfig.getTokensPerBlock() > 0, "The engine must have a paged KV cache.");
+    TLLM_CHECK_WITH_INFO(mMaxBeamWidth > 0 && mMaxBeamWidth <= mModelConfig.getMaxBeamWidth(),
+        "maxBeamWidth %d isn't supported by the engine, its max beam width is %d", mMaxBeamWidth,
+        mModelConfig.getMaxBeamWidth());
+}
+
+KvCapacityPlanner KvCapacityPlanner::fromEngineDir(
+    std::filesystem::path const& engineDir, SizeType32 rank, SizeType32 maxBeamWidth)
+{
+    auto const json = GptJsonConfig::parse(engineDir / "config.json");
+    WorldConfig const worldConfig{
+        json.getTensorParallelism(), json.getPipelineParallelism(), rank, json.getGpusPerNode()};
+    return KvCapacityPlanner{json.getModelConfig(), worldConfig, maxBeamWidth};
+}
+
+std::size_t KvCapacityPlanner::getFreeDeviceMemory()
+{
+    return std::get<0>(common::getDeviceMemoryInfo(false));
+}
+
+std::size_t KvCapacityPlanner::getKvBytesPerToken() const
+{
+    auto const numLayers = mModelConfig.getNbAttentionLayers(mWorldConfig.getPipelineParallelism());
+    auto const elementSize = BufferDataType(mModelConfig.getKvDataType()).getSize();
+    // Keys and values
+    return 2 * static_cast<std::size_t>(numLayers) * mModelConfig.getNbKvHeads() * mModelConfig.getSizePerHead()
+        * elementSize;
+}
+
+std::size_t KvCapacityPlanner::getBytesPerBlock() const
+{
+    return getKvBytesPerToken() * mModelConfig.getTokensPerBlock();
+}
+
+std::size_t KvCapacityPlanner::getDecoderBytesPerSequence() const
+{
+    auto const beamWidth = static_cast<std::size_t>(mMaxBeamWidth);
+    auto const maxSequenceLen = static_cast<std::size_t>(mModelConfig.getMaxSequenceLen());
+    // Ids and parent ids of the beams, and their log probs
+    auto bytes = beamWidth * maxSequenceLen * (2 * sizeof(TokenIdType) + sizeof(float));
+    if (mWorldConfig.isLastPipelineParallelRank())
+    {
+        auto const vocabSize = static_cast<std::size_t>(mModelConfig.getVocabSizePadded(mWorldConfig.getSize()));
+        // Logits of the step and the probs of the sampling workspace, in float
+        bytes += beamWidth * vocabSize * 2 * sizeof(float);
+        if (mModelConfig.computeContextLogits())
+        {
+            bytes += static_cast<std::size_t>(mModelConfig.getMaxInputLen()) * vocabSize * sizeof(float);
+        }
+    }
+    return bytes;
+}
+
+SizeType32 KvCapacityPlanner::getBlocksPerSequence(SizeType32 inputLen, SizeType32 outputLen) const
+{
+    auto const tokensPerBlock = mModelConfig.getTokensPerBlock();
+    auto const sequenceLen = std::min(inputLen + outputLen, mModelConfig.getMaxSequenceLen());
+    auto const numSharedBlocks = std::min(inputLen, sequenceLen) / tokensPerBlock;
+    auto const numBlocks = common::ceilDiv(sequenceLen, tokensPerBlock);
+    return numSharedBlocks + mMaxBeamWidth * (numBlocks - numSharedBlocks);
+}
+
+KvCapacityPlanner::Plan KvCapacityPlanner::plan(
+    MemoryBudget const& budget, std::vector<WorkloadSample> const& workload, float quantile) const
+{
+    TLLM_CHECK_WITH_INFO(budget.memoryFraction > 0.0f && budget.memoryFraction <= 1.0f,
+        "memoryFraction must be in (0, 1], got %f", budget.memoryFraction);
+    TLLM_CHECK_WITH_INFO(quantile >= 0.0f && quantile <= 1.0f, "quantile must be in [0, 1], got %f", quantile);
+
+    Plan plan;
+    plan.kvBytesPerToken = getKvBytesPerToken();
+    plan.bytesPerBlock = getBytesPerBlock();
+    plan.decoderMemory = getDecoderBytesPerSequence() * mModelConfig.getMaxBatchSize();
+
+    auto const usable = static_cast<std::size_t>(static_cast<double>(budget.freeDeviceMemory) * budget.memoryFraction);
+    auto const reserved
+        = budget.activationMemory + budget.workspaceMemory + budget.loraCacheMemory + plan.decoderMemory;
+    TLLM_CHECK_WITH_INFO(reserved + plan.bytesPerBlock <= usable,
+        "No KV cache fits: %zu bytes of the device are usable, %zu bytes are taken by the activations (%zu), the "
+        "workspaces (%zu), the LoRA cache (%zu) and the decoder (%zu)",
+        usable, reserved, budget.activationMemory, budget.workspaceMemory, budget.loraCacheMemory,
+        plan.decoderMemory);
+
+    auto const maxNumBlocks
+        = static_cast<std::size_t>(std::numeric_limits<SizeType32>::max() / mModelConfig.getTokensPerBlock());
+    plan.numBlocks = static_cast<SizeType32>(std::min((usable - reserved) / plan.bytesPerBlock, maxNumBlocks));
+    plan.kvCacheMemory = plan.numBlocks * plan.bytesPerBlock;
+    plan.maxTokens = plan.numBlocks * mModelConfig.getTokensPerBlock();
+    plan.numSecondaryBlocks
+        = static_cast<SizeType32>(std::min(budget.hostCacheMemory / plan.bytesPerBlock, maxNumBlocks));
+
+    // Blocks per sequence of the samples, sorted for the quantile
+    std::vector<std::pair<SizeType32, double>> samples;
+    if (workload.empty())
+    {
+        samples.emplace_back(getBlocksPerSequence(mModelConfig.getMaxInputLen(),
+                                 mModelConfig.getMaxSequenceLen() - mModelConfig.getMaxInputLen()),
+            1.0);
+    }
+    for (auto const& sample : workload)
+    {
+        TLLM_CHECK_WITH_INFO(sample.inputLen > 0 && sample.outputLen >= 0 && sample.weight >= 0.0f,
+            "Invalid workload sample: input length %d, output length %d, weight %f", sample.inputLen,
+            sample.outputLen, sample.weight);
+        samples.emplace_back(getBlocksPerSequence(sample.inputLen, sample.outputLen), sample.weight);
+    }
+    std::sort(samples.begin(), samples.end());
+    auto const totalWeight = std::accumulate(
+        samples.begin(), samples.end(), 0.0, [](double sum, auto const& sample) { return sum + sample.second; });
+    TLLM_CHECK_WITH_INFO(totalWeight > 0.0, "The workload has no weight.");
+
+    double weightedBlocks{0};
+    double cumulativeWeight{0};
+    for (auto const& [numBlocks, weight] : samples)
+    {
+        weightedBlocks += numBlocks * weight;
+        cumulativeWeight += weight;
+        if (plan.quantileBlocksPerSequence == 0 && cumulativeWeight >= quantile * totalWeight)
+        {
+            plan.quantileBlocksPerSequence = numBlocks;
+        }
+    }
+    plan.meanBlocksPerSequence = weightedBlocks / totalWeight;
+    if (plan.quantileBlocksPerSequence == 0)
+    {
+        plan.quantileBlocksPerSequence = samples.back().first;
+    }
+
+    auto const maxBatchSize = mModelConfig.getMaxBatchSize();
+    auto const kvBoundMean = static_cast<SizeType32>(
+        std::min<double>(std::floor(plan.numBlocks / plan.meanBlocksPerSequence), maxNumBlocks));
+    auto const kvBoundQuantile = plan.numBlocks / std::max(plan.quantileBlocksPerSequence, 1);
+    plan.numConcurrentSequences = std::min(kvBoundMean, maxBatchSize);
+    plan.numConcurrentSequencesAtQuantile = std::min(kvBoundQuantile, maxBatchSize);
+    plan.kvCacheBound = kvBoundMean < maxBatchSize;
+
+    if (budget.loraCacheMemory > 0)
+    {
+        // The LoRA cache takes its share of the memory left once the KV cache is allocated
+        auto const freeAtLora = budget.freeDeviceMemory - budget.activationMemory - budget.workspaceMemory
+            - plan.decoderMemory - plan.kvCacheMemory;
+        plan.loraDeviceCachePercent
+            = std::min(1.0f, static_cast<float>(budget.loraCacheMemory) / static_cast<float>(freeAtLora));
+    }
+
+    TLLM_LOG_INFO(
+        "KV cache plan: %d blocks of %zu bytes, %d secondary blocks, %d concurrent sequences (%d at quantile %.2f)%s",
+        plan.numBlocks, plan.bytesPerBlock, plan.numSecondaryBlocks, plan.numConcurrentSequences,
+        plan.numConcurrentSequencesAtQuantile, quantile,
+        plan.kvCacheBound ? ", bound by the KV cache" : ", bound by the max batch size");
+    return plan;
+}
+
+void KvCapacityPlanner::configure(
+    executor::ExecutorConfig& executorConfig, Plan const& plan, MemoryBudget const& budget) const
+{
+    TLLM_CHECK_WITH_INFO(executorConfig.getMaxBeamWidth() <= mMaxBeamWidth,
+        "The executor runs beams of width %d, the plan is for %d", executorConfig.getMaxBeamWidth(), mMaxBeamWidth);
+    auto const current = executorConfig.getKvCacheConfig();
+    auto const hostCacheSize = plan.numSecondaryBlocks > 0
+        ? std::optional<std::size_t>{static_cast<std::size_t>(plan.numSecondaryBlocks) * plan.bytesPerBlock}
+        : current.getHostCacheSize();
+    executorConfig.setKvCacheConfig(executor::KvCacheConfig{current.getEnableBlockReuse(), plan.maxTokens,
+        current.getMaxAttentionWindow(), current.getSinkTokenLength(), budget.memoryFraction, hostCacheSize,
+        current.getOnboardBlocks()});
+
+    if (plan.loraDeviceCachePercent > 0.0f)
+    {
+        auto const peft = executorConfig.getPeftCacheConfig().value_or(executor::PeftCacheConfig{});
+        executorConfig.setPeftCacheConfig(executor::PeftCacheConfig{peft.getNumHostModuleLayer(),
+            peft.getNumDeviceModuleLayer(), peft.getOptimalAdapterSize(), peft.getMaxAdapterSize(),
+            peft.getNumPutWorkers(), peft.getNumEnsureWorkers(), peft.getNumCopyStreams(),
+            peft.getMaxPagesPerBlockHost(), peft.getMaxPagesPerBlockDevice(), plan.loraDeviceCachePercent,
+            peft.getHostCacheSize()});
+    }
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCompressionContext.h"
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+thread_local KvCompressionBuffers const* activeBuffers{nullptr};
+} // namespace
+
+KvCompressionContext::Scope::Scope(KvCompressionBuffers const& buffers) noexcept
+    : mPrevious{activeBuffers}
+{
+    activeBuffers = &buffers;
+}
+
+KvCompressionContext::Scope::~Scope() noexcept
+{
+    activeBuffers = mPrevious;
+}
+
+KvCompressionBuffers const* KvCompressionContext::getActive() noexcept
+{
+    return activeBuffers;
+}
+
+} // namespace tensorrt_llm::runtime
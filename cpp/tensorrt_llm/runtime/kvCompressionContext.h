@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief The buffers of the KV compression of the sequences of an engine execution, see KvCacheCompressor.
+struct KvCompressionBuffers
+{
+    //! Importance of the cached tokens of each sequence, [batchSize, maxAttentionWindow], on gpu
+    float* importanceScores{nullptr};
+    //! Tokens evicted from the KV cache of each sequence, [batchSize], on gpu
+    std::int32_t const* evictedTokens{nullptr};
+    SizeType32 maxAttentionWindow{0};
+};
+
+//! \brief Hands the KV compression buffers of an engine execution to the attention plugins it enqueues.
+//! \details The plugins are enqueued on the thread that executes the engine, so the buffers are set for that thread
+//! during the lifetime of a scope around the execution.
+class KvCompressionContext
+{
+public:
+    class Scope
+    {
+    public:
+        explicit Scope(KvCompressionBuffers const& buffers) noexcept;
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        ~Scope() noexcept;
+
+    private:
+        KvCompressionBuffers const* mPrevious;
+    };
+
+    //! \returns The buffers of the innermost scope of the calling thread, nullptr outside of any scope.
+    [[nodiscard]] static KvCompressionBuffers const* getActive() noexcept;
+};
+
+} // namespace tensorrt_llm::runtime
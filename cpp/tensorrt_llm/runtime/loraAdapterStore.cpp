@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/loraAdapterStore.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/utils/numpyUtils.h"
+
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+auto constexpr kWEIGHTS_FILE_NAME = "model.lora_weights.npy";
+auto constexpr kCONFIG_FILE_NAME = "model.lora_config.npy";
+} // namespace
+
+LoraAdapterStore::LoraAdapterStore(
+    fs::path adapterDir, std::shared_ptr<LoraCache> hostCache, std::size_t numWorkers, int device)
+    : mAdapterDir{std::move(adapterDir)}
+    , mHostCache{std::move(hostCache)}
+    , mWorkerPool{numWorkers, device}
+{
+    TLLM_CHECK_WITH_INFO(fs::is_directory(mAdapterDir), "LoRA adapter dir %s does not exist",
+        mAdapterDir.string().c_str());
+    TLLM_CHECK(mHostCache);
+}
+
+fs::path LoraAdapterStore::getTaskDir(TaskIdType taskId) const
+{
+    return mAdapterDir / std::to_string(taskId);
+}
+
+bool LoraAdapterStore::contains(TaskIdType taskId) const
+{
+    auto const taskDir = getTaskDir(taskId);
+    return fs::exists(taskDir / kWEIGHTS_FILE_NAME) && fs::exists(taskDir / kCONFIG_FILE_NAME);
+}
+
+std::shared_future<void> LoraAdapterStore::prefetch(TaskIdType taskId)
+{
+    std::lock_guard<std::mutex> lk(mMutex);
+    if (auto const it = mPendingLoads.find(taskId); it != mPendingLoads.end())
+    {
+        return it->second;
+    }
+    if (mHostCache->has(taskId))
+    {
+        std::promise<void> loaded;
+        loaded.set_value();
+        return loaded.get_future().share();
+    }
+    // The lock is held until the load is recorded, so that loadTask can't complete before that
+    auto load = mWorkerPool.enqueue([this, taskId]() { loadTask(taskId); }).share();
+    mPendingLoads.emplace(taskId, load);
+    return load;
+}
+
+void LoraAdapterStore::prefetch(std::vector<TaskIdType> const& taskIds)
+{
+    for (auto const taskId : taskIds)
+    {
+        prefetch(taskId);
+    }
+}
+
+void LoraAdapterStore::load(TaskIdType taskId)
+{
+    prefetch(taskId).get();
+}
+
+std::size_t LoraAdapterStore::getNumPendingLoads() const
+{
+    std::lock_guard<std::mutex> lk(mMutex);
+    return mPendingLoads.size();
+}
+
+void LoraAdapterStore::loadTask(TaskIdType taskId)
+{
+    TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
+    auto const removePendingLoad = [this, taskId]()
+    {
+        std::lock_guard<std::mutex> lk(mMutex);
+        mPendingLoads.erase(taskId);
+    };
+    try
+    {
+        if (mHostCache->has(taskId))
+        {
+            // Put in the meantime by the peft cache manager, which owns its in progress state
+            removePendingLoad();
+            return;
+        }
+        auto const taskDir = getTaskDir(taskId);
+        TLLM_CHECK_WITH_INFO(contains(taskId), "LoRA adapter of task %lu not found in %s", taskId,
+            mAdapterDir.string().c_str());
+        // Mapped rather than read, the host cache copies the weights into its pages straight from the page cache
+        LoraCache::TensorPtr weights = utils::mapNpy((taskDir / kWEIGHTS_FILE_NAME).string());
+        LoraCache::TensorPtr config = utils::mapNpy((taskDir / kCONFIG_FILE_NAME).string());
+        mHostCache->put(taskId, weights, config);
+        // A prefetched adapter is not used yet and may be evicted, the requests using it bump it in progress again
+        mHostCache->markTaskDone(taskId);
+    }
+    catch (...)
+    {
+        removePendingLoad();
+        throw;
+    }
+    removePendingLoad();
+    TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
+}
+
+} // namespace tensorrt_llm::runtime
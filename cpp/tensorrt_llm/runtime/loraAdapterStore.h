@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/loraCache.h"
+#include "tensorrt_llm/runtime/workerPool.h"
+
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+/**
+ * \brief Loads LoRA adapters from disk into a host LoraCache in the background.
+ * \details Adapters are stored in one directory per task, named after the task id and containing
+ * model.lora_weights.npy and model.lora_config.npy, the same layout as the gptManagerBenchmark lora dir. prefetch
+ * enqueues the load of an adapter on a worker pool and returns immediately, so that the adapters of queued requests
+ * are in the host cache by the time the requests are scheduled, instead of being read on the request path.
+ */
+class LoraAdapterStore
+{
+public:
+    using TaskIdType = LoraCache::TaskIdType;
+
+    /**
+     * \param[in] adapterDir: directory containing one subdirectory per task
+     * \param[in] hostCache: the host LoraCache adapters are put in
+     * \param[in] numWorkers: number of adapters loaded concurrently
+     * \param[in] device: device of the worker threads, see WorkerPool
+     */
+    LoraAdapterStore(std::filesystem::path adapterDir, std::shared_ptr<LoraCache> hostCache,
+        std::size_t numWorkers = 1, int device = -1);
+
+    /**
+     * \returns -- true if the adapter of taskId is available on disk
+     */
+    [[nodiscard]] bool contains(TaskIdType taskId) const;
+
+    /**
+     * \brief Load the adapter of taskId into the host cache unless it is already there or being loaded.
+     * \returns -- a future that is ready once the adapter is in the host cache. It rethrows load errors, including
+     * LoraCacheFullException.
+     */
+    std::shared_future<void> prefetch(TaskIdType taskId);
+
+    /**
+     * \brief prefetch the adapters of all given tasks, e.g. of the queued requests.
+     */
+    void prefetch(std::vector<TaskIdType> const& taskIds);
+
+    /**
+     * \brief Block until the adapter of taskId is in the host cache, loading it if it has not been prefetched.
+     */
+    void load(TaskIdType taskId);
+
+    /**
+     * \returns -- number of adapter loads enqueued and not yet completed
+     */
+    [[nodiscard]] std::size_t getNumPendingLoads() const;
+
+private:
+    [[nodiscard]] std::filesystem::path getTaskDir(TaskIdType taskId) const;
+
+    void loadTask(TaskIdType taskId);
+
+    std::filesystem::path const mAdapterDir;
+    std::shared_ptr<LoraCache> mHostCache;
+
+    mutable std::mutex mMutex;
+    std::unordered_map<TaskIdType, std::shared_future<void>> mPendingLoads;
+
+    // Declared last so that the workers are joined before the state they use is destroyed
+    WorkerPool mWorkerPool;
+};
+
+} // namespace tensorrt_llm::runtime
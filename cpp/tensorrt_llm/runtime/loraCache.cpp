@@ -24,12 +24,20 @@
 #include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/runtime/loraUtils.h"
+#include "tensorrt_llm/runtime/memoryCounters.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
 
 namespace tensorrt_llm::runtime
@@ -49,6 +57,84 @@ LoraCacheFullException::LoraCacheFullException(std::string const& msg)
 
 LoraCacheFullException::~LoraCacheFullException() noexcept = default;
 
+namespace
+{
+SizeType32 constexpr kMAX_COPY_TO_PAGES_THREADS = 8;
+SizeType32 constexpr kMIN_ROWS_PER_COPY_TO_PAGES_THREAD = 16;
+
+// Pages of a quantized data type hold the weights of the model data type quantized in groups, see getQuantizedBlockSize
+bool isQuantizedPageType(nvinfer1::DataType dataType)
+{
+    return dataType == nvinfer1::DataType::kINT8 || dataType == nvinfer1::DataType::kFP8;
+}
+
+std::size_t getNumPageElts(LoraCachePageManagerConfig const& config)
+{
+    return static_cast<std::size_t>(config.getSlotsPerPage()) * static_cast<std::size_t>(config.getPageWidth());
+}
+
+template <typename T, typename TQuant>
+void quantizePageCpuInner(ITensor const& page, ITensor& quantPage, float quantMax)
+{
+    auto const numElts = page.getSize();
+    auto const* src = bufferCast<T>(page);
+    auto* quantData = static_cast<std::uint8_t*>(quantPage.data());
+    auto* dst = reinterpret_cast<TQuant*>(quantData);
+    auto* scales = reinterpret_cast<float*>(quantData + numElts * sizeof(TQuant));
+    for (std::size_t groupOffset = 0; groupOffset < numElts; groupOffset += kernels::kBlockQuantGroupSize)
+    {
+        auto const groupEnd = std::min(groupOffset + kernels::kBlockQuantGroupSize, numElts);
+        float amax = 0.f;
+        for (auto i = groupOffset; i < groupEnd; ++i)
+        {
+            amax = std::max(amax, std::abs(static_cast<float>(src[i])));
+        }
+        float const scale = amax > 0.f ? amax / quantMax : 1.f;
+        for (auto i = groupOffset; i < groupEnd; ++i)
+        {
+            auto const value = static_cast<float>(src[i]) / scale;
+            if constexpr (std::is_same_v<TQuant, std::int8_t>)
+            {
+                dst[i] = static_cast<std::int8_t>(std::clamp(std::nearbyint(value), -128.f, 127.f));
+            }
+            else
+            {
+                dst[i] = static_cast<TQuant>(value);
+            }
+        }
+        scales[groupOffset / kernels::kBlockQuantGroupSize] = scale;
+    }
+}
+
+template <typename T>
+void quantizePageCpu(ITensor const& page, ITensor& quantPage, nvinfer1::DataType quantType)
+{
+    switch (quantType)
+    {
+    case nvinfer1::DataType::kINT8: quantizePageCpuInner<T, std::int8_t>(page, quantPage, 127.f); break;
+#ifdef ENABLE_FP8
+    case nvinfer1::DataType::kFP8: quantizePageCpuInner<T, __nv_fp8_e4m3>(page, quantPage, 448.f); break;
+#endif // ENABLE_FP8
+    default: TLLM_THROW("Unsupported LoRA cache quantization type");
+    }
+}
+
+//! \brief Same format as kernels::invokeQuantizeBlocks, with the page as a single block.
+void quantizePage(ITensor const& page, ITensor& quantPage, nvinfer1::DataType quantType)
+{
+    TLLM_CHECK(quantPage.getSizeInBytes() == kernels::getQuantizedBlockSize(page.getSize(), quantType));
+    switch (page.getDataType())
+    {
+    case nvinfer1::DataType::kFLOAT: quantizePageCpu<float>(page, quantPage, quantType); break;
+    case nvinfer1::DataType::kHALF: quantizePageCpu<half>(page, quantPage, quantType); break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16: quantizePageCpu<__nv_bfloat16>(page, quantPage, quantType); break;
+#endif // ENABLE_BF16
+    default: TLLM_THROW("Unsupported data type for LoRA cache quantization");
+    }
+}
+} // namespace
+
 LoraCachePageManager::LoraCachePageManager(LoraCachePageManagerConfig const& config, BufferManager const& bufferManager)
     : mConfig(config)
 {
@@ -58,56 +144,116 @@ LoraCachePageManager::LoraCachePageManager(LoraCachePageManagerConfig const& con
 void LoraCachePageManager::initialize(BufferManager const& bufferManager)
 {
     TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
+    MemoryCounters::ScopedTag const tag{MemoryTag::kLORA_CACHE};
 
     TLLM_LOG_DEBUG("pageConfig: " + to_string(mConfig));
 
+    auto const isQuantized = isQuantizedPageType(mConfig.getDataType());
+    if (isQuantized)
+    {
+        TLLM_CHECK_WITH_INFO(getNumPageElts(mConfig) % kernels::kBlockQuantGroupSize == 0,
+            "Quantized lora cache pages must hold a multiple of %d weights", kernels::kBlockQuantGroupSize);
+    }
+
     std::size_t pageIdx = 0;
     while (pageIdx < static_cast<size_t>(mConfig.getTotalNumPages()))
     {
         auto const numLocalPages = std::min<SizeType32>(
             mConfig.getTotalNumPages() - static_cast<SizeType32>(pageIdx), mConfig.getMaxPagesPerBlock());
-        auto const blockShape = ITensor::makeShape({numLocalPages, mConfig.getSlotsPerPage(), mConfig.getPageWidth()});
+        auto const quantBytesPerPage = isQuantized
+            ? static_cast<SizeType32>(kernels::getQuantizedBlockSize(getNumPageElts(mConfig), mConfig.getDataType()))
+            : 0;
+        auto const blockShape = isQuantized
+            ? ITensor::makeShape({numLocalPages, quantBytesPerPage})
+            : ITensor::makeShape({numLocalPages, mConfig.getSlotsPerPage(), mConfig.getPageWidth()});
         TensorPtr block = bufferManager.allocate(mConfig.getMemoryType(), blockShape, mConfig.getDataType());
         mPageBlocks.push_back(block);
-        for (SizeType32 i = 0; i < numLocalPages; ++i)
-        {
-            mFreePageIds.push_back(pageIdx);
-            ++pageIdx;
-        }
+        pageIdx += numLocalPages;
     }
     mIsPageFree.assign(pageIdx, 1);
+    mNumFreePages = static_cast<SizeType32>(pageIdx);
 
     TLLM_LOG_DEBUG("%s allocated %d blocks and %d pages", __PRETTY_FUNCTION__, mPageBlocks.size(), pageIdx);
     TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
 }
 
+std::vector<std::pair<std::size_t, std::size_t>> LoraCachePageManager::getFreeRuns() const
+{
+    std::vector<std::pair<std::size_t, std::size_t>> runs;
+    for (std::size_t pageId = 0; pageId < mIsPageFree.size(); ++pageId)
+    {
+        if (!mIsPageFree[pageId])
+        {
+            continue;
+        }
+        if (!runs.empty() && runs.back().first + runs.back().second == pageId)
+        {
+            ++runs.back().second;
+        }
+        else
+        {
+            runs.emplace_back(pageId, 1);
+        }
+    }
+    return runs;
+}
+
 std::optional<std::vector<std::size_t>> LoraCachePageManager::claimPages(SizeType32 numPages)
 {
     TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
-    if (numPages <= static_cast<SizeType32>(mFreePageIds.size()))
+    std::lock_guard<std::mutex> lk(mMutex);
+    if (numPages > mNumFreePages)
+    {
+        TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
+        return std::nullopt;
+    }
+
+    auto runs = getFreeRuns();
+    auto const numPagesNeeded = static_cast<std::size_t>(numPages);
+    auto bestFit = runs.end();
+    for (auto it = runs.begin(); it != runs.end(); ++it)
     {
-        std::vector<std::size_t> outputPages{};
-        outputPages.reserve(numPages);
-        for (auto it = mFreePageIds.begin();
-             outputPages.size() < static_cast<std::size_t>(numPages) && it != mFreePageIds.end();
-             it = mFreePageIds.erase(it))
+        if (it->second >= numPagesNeeded && (bestFit == runs.end() || it->second < bestFit->second))
         {
-            mIsPageFree.at(*it) = 0;
-            outputPages.push_back(*it);
+            bestFit = it;
         }
-        return std::make_optional(std::move(outputPages));
     }
+    if (bestFit != runs.end())
+    {
+        runs = {*bestFit};
+    }
+    else
+    {
+        // No run is large enough, take the largest ones to split the task over as few runs as possible
+        std::stable_sort(
+            runs.begin(), runs.end(), [](auto const& lhs, auto const& rhs) { return lhs.second > rhs.second; });
+    }
+
+    std::vector<std::size_t> outputPages{};
+    outputPages.reserve(numPages);
+    for (auto const& [firstPageId, runLength] : runs)
+    {
+        for (std::size_t pageId = firstPageId;
+             pageId < firstPageId + runLength && outputPages.size() < numPagesNeeded; ++pageId)
+        {
+            mIsPageFree.at(pageId) = 0;
+            outputPages.push_back(pageId);
+        }
+    }
+    mNumFreePages -= numPages;
     TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
-    return std::nullopt;
+    return std::make_optional(std::move(outputPages));
 }
 
 SizeType32 LoraCachePageManager::numAvailablePages() const
 {
-    return static_cast<SizeType32>(mFreePageIds.size());
+    std::lock_guard<std::mutex> lk(mMutex);
+    return mNumFreePages;
 }
 
 void LoraCachePageManager::releasePages(std::vector<std::size_t> const& pageIds)
 {
+    std::lock_guard<std::mutex> lk(mMutex);
     for (auto pageId : pageIds)
     {
         if (pageId >= mIsPageFree.size() || mIsPageFree[pageId])
@@ -116,10 +262,55 @@ void LoraCachePageManager::releasePages(std::vector<std::size_t> const& pageIds)
         }
         else
         {
-            mFreePageIds.push_front(pageId);
             mIsPageFree.at(pageId) = 1;
+            ++mNumFreePages;
+        }
+    }
+}
+
+LoraCachePageStats LoraCachePageManager::getStats() const
+{
+    std::lock_guard<std::mutex> lk(mMutex);
+    LoraCachePageStats stats;
+    stats.numPages = static_cast<SizeType32>(mIsPageFree.size());
+    stats.numFreePages = mNumFreePages;
+    for (auto const& [firstPageId, runLength] : getFreeRuns())
+    {
+        ++stats.numFreeRuns;
+        stats.largestFreeRun = std::max(stats.largestFreeRun, static_cast<SizeType32>(runLength));
+    }
+    return stats;
+}
+
+std::vector<std::pair<std::size_t, std::size_t>> LoraCachePageManager::compact()
+{
+    std::lock_guard<std::mutex> lk(mMutex);
+    std::vector<std::pair<std::size_t, std::size_t>> moves;
+    if (mIsPageFree.empty())
+    {
+        return moves;
+    }
+    std::size_t low = 0;
+    std::size_t high = mIsPageFree.size() - 1;
+    while (true)
+    {
+        while (low < high && !mIsPageFree[low])
+        {
+            ++low;
         }
+        while (low < high && mIsPageFree[high])
+        {
+            --high;
+        }
+        if (low >= high)
+        {
+            break;
+        }
+        moves.emplace_back(high, low);
+        mIsPageFree[low] = 0;
+        mIsPageFree[high] = 1;
     }
+    return moves;
 }
 
 ITensor::SharedConstPtr LoraCachePageManager::blockPtr(SizeType32 blockIdx) const
@@ -127,13 +318,14 @@ ITensor::SharedConstPtr LoraCachePageManager::blockPtr(SizeType32 blockIdx) cons
     return mPageBlocks.at(blockIdx);
 }
 
-ITensor::SharedConstPtr LoraCachePageManager::pagePtr(std::size_t pageIdx) const
+ITensor::SharedPtr LoraCachePageManager::mutableBlockPtr(SizeType32 blockIdx)
 {
-    auto blockIdx = pageIdx / mConfig.getMaxPagesPerBlock();
-    auto blockPageIdx = pageIdx % mConfig.getMaxPagesPerBlock();
+    return mPageBlocks.at(blockIdx);
+}
 
-    return ITensor::view(ITensor::slice(mPageBlocks.at(blockIdx), blockPageIdx, 1),
-        ITensor::makeShape({mConfig.getSlotsPerPage(), mConfig.getPageWidth()}));
+ITensor::SharedConstPtr LoraCachePageManager::pagePtr(std::size_t pageIdx) const
+{
+    return const_cast<LoraCachePageManager*>(this)->mutablePagePtr(pageIdx);
 }
 
 ITensor::SharedPtr LoraCachePageManager::mutablePagePtr(std::size_t pageIdx)
@@ -141,8 +333,11 @@ ITensor::SharedPtr LoraCachePageManager::mutablePagePtr(std::size_t pageIdx)
     auto blockIdx = pageIdx / mConfig.getMaxPagesPerBlock();
     auto blockPageIdx = pageIdx % mConfig.getMaxPagesPerBlock();
 
-    return ITensor::view(ITensor::slice(mPageBlocks.at(blockIdx), blockPageIdx, 1),
-        ITensor::makeShape({mConfig.getSlotsPerPage(), mConfig.getPageWidth()}));
+    auto const& block = mPageBlocks.at(blockIdx);
+    auto const pageShape = isQuantizedPageType(mConfig.getDataType())
+        ? ITensor::makeShape({block->getShape().d[1]})
+        : ITensor::makeShape({mConfig.getSlotsPerPage(), mConfig.getPageWidth()});
+    return ITensor::view(ITensor::slice(block, blockPageIdx, 1), pageShape);
 }
 
 void LoraCache::put(TaskIdType taskId, TensorPtr sourceWeights, TensorPtr sourceConfig, bool load)
@@ -281,8 +476,45 @@ void LoraCache::loadWeights(TaskValue& taskValue, TensorPtr weights, TensorPtr c
         pagePtrs.push_back(mCachePageManager->mutablePagePtr(id));
     }
 
-    taskValue.configs = std::make_shared<std::vector<TaskLayerModuleConfig>>(copyToPages(
-        weights, config, mModelConfig, mWorldConfig, mModuleIdToModule, *mBufferManager, pagePtrs, taskValue.pageIds));
+    auto const quantType = mPageManagerConfig.getDataType();
+    if (!isQuantizedPageType(quantType))
+    {
+        taskValue.configs = std::make_shared<std::vector<TaskLayerModuleConfig>>(copyToPages(weights, config,
+            mModelConfig, mWorldConfig, mModuleIdToModule, *mBufferManager, pagePtrs, taskValue.pageIds));
+    }
+    else
+    {
+        // Lay the weights out in pages of the model data type, then quantize the pages as a whole
+        std::vector<TensorPtr> tmpPages{};
+        tmpPages.reserve(pagePtrs.size());
+        for (std::size_t i = 0; i < pagePtrs.size(); ++i)
+        {
+            tmpPages.push_back(mBufferManager->cpu(
+                ITensor::makeShape({mPageManagerConfig.getSlotsPerPage(), mPageManagerConfig.getPageWidth()}),
+                weights->getDataType()));
+            // Unused slots share quantization groups with weights
+            std::memset(tmpPages.back()->data(), 0, tmpPages.back()->getSizeInBytes());
+        }
+        auto configs = copyToPages(weights, config, mModelConfig, mWorldConfig, mModuleIdToModule, *mBufferManager,
+            tmpPages, taskValue.pageIds);
+        std::unordered_map<std::size_t, std::size_t> pageIdToIdx;
+        for (std::size_t i = 0; i < pagePtrs.size(); ++i)
+        {
+            quantizePage(*tmpPages[i], *pagePtrs[i], quantType);
+            pageIdToIdx.emplace(taskValue.pageIds[i], i);
+        }
+        // Point to the quantized weights, which have one byte per weight
+        auto const eltSize = static_cast<std::int64_t>(BufferDataType(weights->getDataType()).getSize());
+        for (auto& moduleConfig : configs)
+        {
+            auto const pageIdx = pageIdToIdx.at(moduleConfig.pageId);
+            auto const tmpBase = reinterpret_cast<std::int64_t>(tmpPages[pageIdx]->data());
+            auto const quantBase = reinterpret_cast<std::int64_t>(pagePtrs[pageIdx]->data());
+            moduleConfig.weightsInPointer = quantBase + (moduleConfig.weightsInPointer - tmpBase) / eltSize;
+            moduleConfig.weightsOutPointer = quantBase + (moduleConfig.weightsOutPointer - tmpBase) / eltSize;
+        }
+        taskValue.configs = std::make_shared<std::vector<TaskLayerModuleConfig>>(std::move(configs));
+    }
     {
         std::lock_guard<std::mutex> lk(mCacheMutex);
         taskValue.loadInProgress = false;
@@ -308,7 +540,6 @@ std::vector<std::size_t> LoraCache::claimPagesWithEvict(SizeType32 numPages)
     std::vector<size_t> pageIdsToEvict;
     std::vector<uint64_t> taskIdsToEvict;
     auto neededPages = numPages - availablePages;
-    auto it = mDoneTasks.rbegin();
     for (auto it = mDoneTasks.rbegin(); it != mDoneTasks.rend() && neededPages > 0; it = std::next(it))
     {
         auto const taskId = *it;
@@ -317,9 +548,9 @@ std::vector<std::size_t> LoraCache::claimPagesWithEvict(SizeType32 numPages)
         pageIdsToEvict.insert(pageIdsToEvict.end(), taskValue.pageIds.begin(), taskValue.pageIds.end());
         neededPages -= taskValue.pageIds.size();
     }
-    if (it == mDoneTasks.rend())
+    if (neededPages > 0)
     {
-        throw LoraCacheFullException("Cache is full. There are no done tasks to evict");
+        throw LoraCacheFullException("Cache is full. There are not enough done tasks to evict");
     }
 
     TLLM_LOG_DEBUG("evicting " + std::to_string(taskIdsToEvict.size()));
@@ -494,11 +725,13 @@ LoraCache::LoraCache(LoraCachePageManagerConfig const& pageManagerConfig, ModelC
         mModuleIdToModule[m.value()] = m;
     }
 
-    mBufferManager = std::make_unique<BufferManager>(std::make_shared<CudaStream>());
+    // LoRA uploads are background transfers that must not delay the forward pass
+    mBufferManager = std::make_unique<BufferManager>(std::make_shared<CudaStream>(StreamPriority::kLOW));
 
     for (size_t i = 0; i < static_cast<size_t>(mPageManagerConfig.getNumCopyStreams()); ++i)
     {
-        mDeviceBufferManagers.push_back(std::make_unique<BufferManager>(std::make_shared<CudaStream>()));
+        mDeviceBufferManagers.push_back(
+            std::make_unique<BufferManager>(std::make_shared<CudaStream>(StreamPriority::kLOW)));
     }
 }
 
@@ -512,14 +745,12 @@ void LoraCache::splitTransposeCpuInner(ITensor& output, ITensor const& input, Si
     auto outputPtr = bufferCast<T>(output);
     auto const inputPtr = bufferCast<T>(input);
 
+    // The split of each adapter row is contiguous in both tensors
     for (SizeType32 adapterIdx = 0; adapterIdx < adapterSize; ++adapterIdx)
     {
-        for (SizeType32 hiddenIdx = 0; hiddenIdx < splitHiddenSize; ++hiddenIdx)
-        {
-            auto outputIdx = common::flat_index2(adapterIdx, hiddenIdx, splitHiddenSize);
-            auto inputIdx = common::flat_index2(adapterIdx, hiddenIdx + tpRank * splitHiddenSize, hiddenSize);
-            outputPtr[outputIdx] = inputPtr[inputIdx];
-        }
+        auto outputIdx = common::flat_index2(adapterIdx, 0, splitHiddenSize);
+        auto inputIdx = common::flat_index2(adapterIdx, tpRank * splitHiddenSize, hiddenSize);
+        std::memcpy(outputPtr + outputIdx, inputPtr + inputIdx, splitHiddenSize * sizeof(T));
     }
 }
 
@@ -610,10 +841,9 @@ std::vector<LoraCache::TaskLayerModuleConfig> LoraCache::copyToPages(TensorPtr s
     }
 
     std::vector<LoraCache::TaskLayerModuleConfig> pageLocations(rowIndices.size());
-    for (SizeType32 i = 0; i < static_cast<SizeType32>(rowIndices.size()); ++i)
     {
-        auto copyFn = [i = i, &rowIndices, &rowPage, &rowSlot, &pageLocations, weights, config, &pages,
-                          &moduleIdToModule, &manager, pageWidth, tpSize, tpRank, pageIds]()
+        auto copyFn = [&rowIndices, &rowPage, &rowSlot, &pageLocations, weights, config, &pages, &moduleIdToModule,
+                          &manager, pageWidth, tpSize, tpRank, &pageIds](SizeType32 i)
         {
             auto const row = rowIndices[i];
             auto const currPage = rowPage[i];
@@ -684,7 +914,28 @@ std::vector<LoraCache::TaskLayerModuleConfig> LoraCache::copyToPages(TensorPtr s
                 reinterpret_cast<std::int64_t>(targetWeightsIn->data()),
                 reinterpret_cast<std::int64_t>(targetWeightsOut->data())};
         };
-        copyFn();
+
+        // Rows are copied to disjoint slots, large adapters are split over several threads
+        auto const numRowsToCopy = static_cast<SizeType32>(rowIndices.size());
+        auto const numThreads = std::min({static_cast<SizeType32>(std::max(std::thread::hardware_concurrency(), 1U)),
+            kMAX_COPY_TO_PAGES_THREADS, common::ceilDiv(numRowsToCopy, kMIN_ROWS_PER_COPY_TO_PAGES_THREAD)});
+        auto const copyRows = [&copyFn, numRowsToCopy, numThreads](SizeType32 firstRow)
+        {
+            for (SizeType32 i = firstRow; i < numRowsToCopy; i += numThreads)
+            {
+                copyFn(i);
+            }
+        };
+        std::vector<std::future<void>> copies;
+        for (SizeType32 t = 1; t < numThreads; ++t)
+        {
+            copies.push_back(std::async(std::launch::async, copyRows, t));
+        }
+        copyRows(0);
+        for (auto& copy : copies)
+        {
+            copy.get();
+        }
     }
 
     TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
@@ -809,24 +1060,62 @@ void LoraCache::copyTask(TaskIdType taskId, LoraCache& deviceCache, bool markDon
     auto const flatPageShape
         = ITensor::makeShape({mPageManagerConfig.getPageWidth() * mPageManagerConfig.getSlotsPerPage()});
     size_t bufferManagerOffset = taskId % deviceCache.mDeviceBufferManagers.size();
-    std::vector<CudaEvent> copyEvents(otherTaskValue->pageIds.size());
+    auto const quantType = mPageManagerConfig.getDataType();
+    auto const isQuantized = isQuantizedPageType(quantType);
+    TLLM_CHECK_WITH_INFO(!isQuantizedPageType(deviceCache.mPageManagerConfig.getDataType()),
+        "The deviceCache must hold weights of the model data type");
+    std::vector<CudaEvent> copyEvents(isQuantized ? 1 : otherTaskValue->pageIds.size());
     size_t eventIdx = 0;
-    for (auto const& [oldPageId, newPagePair] : oldToNewPageIds)
-    {
-        auto const newPageId = newPagePair.first;
-        auto const copySize = newPagePair.second * mPageManagerConfig.getPageWidth();
-        auto const copyShape = ITensor::makeShape({copySize});
-        TLLM_LOG_DEBUG("copy page (task " + std::to_string(taskId) + ") " + std::to_string(oldPageId) + " -> "
-            + std::to_string(newPageId) + " size: " + std::to_string(copySize));
-        TensorPtr oldPagePtr = mCachePageManager->mutablePagePtr(oldPageId);
-        TensorPtr newPagePtr = deviceCache.mCachePageManager->mutablePagePtr(newPageId);
-        TensorPtr source
-            = ITensor::view(ITensor::slice(ITensor::view(oldPagePtr, flatPageShape), 0, copySize), copyShape);
-        TensorPtr dest
-            = ITensor::view(ITensor::slice(ITensor::view(newPagePtr, flatPageShape), 0, copySize), copyShape);
-        deviceCache.mDeviceBufferManagers[bufferManagerOffset]->copy(*source, *dest);
-        deviceCache.mDeviceBufferManagers[bufferManagerOffset]->getStream().record(copyEvents[eventIdx++]);
-        bufferManagerOffset = (bufferManagerOffset + 1) % deviceCache.mDeviceBufferManagers.size();
+    if (isQuantized)
+    {
+        // Upload the quantized pages, half or less of the bytes of the weights, and dequantize them on the device
+        auto const& manager = *deviceCache.mDeviceBufferManagers[bufferManagerOffset];
+        auto const quantBytesPerPage
+            = static_cast<SizeType32>(kernels::getQuantizedBlockSize(getNumPageElts(mPageManagerConfig), quantType));
+        auto const numPages = static_cast<SizeType32>(oldToNewPageIds.size());
+        TensorPtr stagingPages
+            = manager.gpu(ITensor::makeShape({numPages, quantBytesPerPage}), nvinfer1::DataType::kINT8);
+        // (staging page, page in device block) pairs per device block
+        std::map<SizeType32, std::vector<std::int32_t>> blockPairs;
+        auto const maxPagesPerBlock = static_cast<std::size_t>(deviceCache.mPageManagerConfig.getMaxPagesPerBlock());
+        SizeType32 stagingIdx = 0;
+        for (auto const& [oldPageId, newPagePair] : oldToNewPageIds)
+        {
+            TensorPtr dest = ITensor::view(
+                ITensor::slice(stagingPages, stagingIdx, 1), ITensor::makeShape({quantBytesPerPage}));
+            manager.copy(*mCachePageManager->pagePtr(oldPageId), *dest);
+            auto& pairs = blockPairs[static_cast<SizeType32>(newPagePair.first / maxPagesPerBlock)];
+            pairs.push_back(stagingIdx);
+            pairs.push_back(static_cast<std::int32_t>(newPagePair.first % maxPagesPerBlock));
+            ++stagingIdx;
+        }
+        for (auto const& [blockIdx, pairs] : blockPairs)
+        {
+            auto pairsDevice = manager.copyFrom(pairs, MemoryType::kGPU);
+            kernels::invokeDequantizeBlocks(*stagingPages, *deviceCache.mCachePageManager->mutableBlockPtr(blockIdx),
+                quantType, *pairsDevice, static_cast<SizeType32>(pairs.size() / 2), manager.getStream());
+        }
+        manager.getStream().record(copyEvents[eventIdx++]);
+    }
+    else
+    {
+        for (auto const& [oldPageId, newPagePair] : oldToNewPageIds)
+        {
+            auto const newPageId = newPagePair.first;
+            auto const copySize = newPagePair.second * mPageManagerConfig.getPageWidth();
+            auto const copyShape = ITensor::makeShape({copySize});
+            TLLM_LOG_DEBUG("copy page (task " + std::to_string(taskId) + ") " + std::to_string(oldPageId) + " -> "
+                + std::to_string(newPageId) + " size: " + std::to_string(copySize));
+            TensorPtr oldPagePtr = mCachePageManager->mutablePagePtr(oldPageId);
+            TensorPtr newPagePtr = deviceCache.mCachePageManager->mutablePagePtr(newPageId);
+            TensorPtr source
+                = ITensor::view(ITensor::slice(ITensor::view(oldPagePtr, flatPageShape), 0, copySize), copyShape);
+            TensorPtr dest
+                = ITensor::view(ITensor::slice(ITensor::view(newPagePtr, flatPageShape), 0, copySize), copyShape);
+            deviceCache.mDeviceBufferManagers[bufferManagerOffset]->copy(*source, *dest);
+            deviceCache.mDeviceBufferManagers[bufferManagerOffset]->getStream().record(copyEvents[eventIdx++]);
+            bufferManagerOffset = (bufferManagerOffset + 1) % deviceCache.mDeviceBufferManagers.size();
+        }
     }
     for (auto const& event : copyEvents)
     {
@@ -868,6 +1157,72 @@ SizeType32 LoraCache::getNumPages() const
     return mPageManagerConfig.getTotalNumPages();
 }
 
+LoraCachePageStats LoraCache::getPageStats() const
+{
+    return mCachePageManager->getStats();
+}
+
+SizeType32 LoraCache::defragment()
+{
+    TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
+    std::lock_guard<std::mutex> pageLock(mPagesMutex);
+    std::lock_guard<std::mutex> cacheLock(mCacheMutex);
+    if (!mInProgressTasks.empty())
+    {
+        TLLM_LOG_DEBUG("%s skipped, %zu tasks in progress", __PRETTY_FUNCTION__, mInProgressTasks.size());
+        return 0;
+    }
+
+    auto const moves = mCachePageManager->compact();
+    if (moves.empty())
+    {
+        return 0;
+    }
+    std::unordered_map<std::size_t, std::size_t> oldToNewPageIds;
+    for (auto const& [oldPageId, newPageId] : moves)
+    {
+        mBufferManager->copy(*mCachePageManager->pagePtr(oldPageId), *mCachePageManager->mutablePagePtr(newPageId));
+        oldToNewPageIds.emplace(oldPageId, newPageId);
+    }
+    mBufferManager->getStream().synchronize();
+
+    auto const pageBase = [this](std::size_t pageId)
+    { return reinterpret_cast<std::int64_t>(mCachePageManager->pagePtr(pageId)->data()); };
+    for (auto& [taskId, taskValue] : mCacheMap)
+    {
+        bool moved{false};
+        for (auto& pageId : taskValue->pageIds)
+        {
+            if (auto const it = oldToNewPageIds.find(pageId); it != oldToNewPageIds.end())
+            {
+                pageId = it->second;
+                moved = true;
+            }
+        }
+        if (!moved || !taskValue->configs)
+        {
+            continue;
+        }
+        // Configs handed out by get() keep pointing to the old pages, so update a copy
+        auto configs = std::make_shared<std::vector<TaskLayerModuleConfig>>(*taskValue->configs);
+        for (auto& config : *configs)
+        {
+            auto const it = oldToNewPageIds.find(config.pageId);
+            if (it == oldToNewPageIds.end())
+            {
+                continue;
+            }
+            auto const offset = pageBase(it->second) - pageBase(config.pageId);
+            config.pageId = it->second;
+            config.weightsInPointer += offset;
+            config.weightsOutPointer += offset;
+        }
+        taskValue->configs = std::move(configs);
+    }
+    TLLM_LOG_DEBUG("%s moved %zu pages", __PRETTY_FUNCTION__, moves.size());
+    return static_cast<SizeType32>(moves.size());
+}
+
 bool LoraCache::fits(TensorPtr config) const
 {
     auto const neededPages = determineNumPages(config);
@@ -876,7 +1231,7 @@ bool LoraCache::fits(TensorPtr config) const
         std::lock_guard<std::mutex> lk(mPagesMutex);
         availablePages = mCachePageManager->numAvailablePages();
     }
-    return neededPages < availablePages;
+    return neededPages <= availablePages;
 }
 
 std::string to_string(LoraCache::TaskLayerModuleConfig const& v)
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+/**
+ * \brief Tracks the LoRA adapters that take most of the traffic.
+ * \details The tokens of each adapter are counted per step and decayed exponentially across steps, the adapters with
+ * the highest counts are hot. Adapters that stop receiving traffic decay until they are dropped, so the hot set
+ * follows shifts of the traffic within a few steps. Not thread safe.
+ */
+class LoraHotAdapters
+{
+public:
+    using TaskIdType = std::int64_t;
+
+    /**
+     * \param[in] maxNumHot: number of hot adapters at most
+     * \param[in] decay: weight of the counts of past steps, in [0, 1)
+     * \param[in] minShare: share of the decayed tokens of all adapters an adapter needs to be hot
+     */
+    explicit LoraHotAdapters(SizeType32 maxNumHot, float decay = 0.9f, float minShare = 0.1f)
+        : mMaxNumHot{maxNumHot}
+        , mDecay{decay}
+        , mMinShare{minShare}
+    {
+        TLLM_CHECK_WITH_INFO(mMaxNumHot >= 0, "maxNumHot must not be negative, got %d", mMaxNumHot);
+        TLLM_CHECK_WITH_INFO(mDecay >= 0.f && mDecay < 1.f, "decay must be in [0, 1), got %f", mDecay);
+        TLLM_CHECK_WITH_INFO(mMinShare >= 0.f && mMinShare <= 1.f, "minShare must be in [0, 1], got %f", mMinShare);
+    }
+
+    /**
+     * \brief Counts the tokens of a request of the adapter in the current step.
+     */
+    void record(TaskIdType taskId, SizeType32 numTokens)
+    {
+        mCounts[taskId] += static_cast<float>(numTokens);
+    }
+
+    /**
+     * \brief Ends the current step and updates the hot adapters.
+     * \returns -- the hot adapters, hottest first
+     */
+    std::vector<TaskIdType> const& step()
+    {
+        for (auto& [taskId, score] : mScores)
+        {
+            score *= mDecay;
+        }
+        for (auto const& [taskId, count] : mCounts)
+        {
+            mScores[taskId] += count * (1.f - mDecay);
+        }
+        mCounts.clear();
+
+        float total{0.f};
+        std::vector<std::pair<float, TaskIdType>> candidates;
+        for (auto it = mScores.begin(); it != mScores.end();)
+        {
+            if (it->second < kMIN_SCORE)
+            {
+                it = mScores.erase(it);
+                continue;
+            }
+            total += it->second;
+            candidates.emplace_back(it->second, it->first);
+            ++it;
+        }
+        // Hottest first, ties broken by task id so that the hot set doesn't depend on the order of the map
+        std::sort(candidates.begin(), candidates.end(),
+            [](auto const& lhs, auto const& rhs)
+            { return lhs.first != rhs.first ? lhs.first > rhs.first : lhs.second < rhs.second; });
+        mHot.clear();
+        for (auto const& [score, taskId] : candidates)
+        {
+            if (static_cast<SizeType32>(mHot.size()) == mMaxNumHot || score < mMinShare * total)
+            {
+                break;
+            }
+            mHot.push_back(taskId);
+        }
+        return mHot;
+    }
+
+    /**
+     * \returns -- true if the adapter is hot
+     */
+    [[nodiscard]] bool isHot(TaskIdType taskId) const
+    {
+        return std::find(mHot.begin(), mHot.end(), taskId) != mHot.end();
+    }
+
+    [[nodiscard]] std::vector<TaskIdType> const& getHot() const noexcept
+    {
+        return mHot;
+    }
+
+    /**
+     * \param[in] taskIds: the adapters of the requests of a batch, none for a request without adapter
+     * \returns -- the adapter if all requests of the batch use the same one, none otherwise
+     */
+    template <typename TaskIds>
+    [[nodiscard]] static std::optional<TaskIdType> getSingleAdapter(TaskIds const& taskIds)
+    {
+        std::optional<TaskIdType> single;
+        for (std::optional<TaskIdType> const taskId : taskIds)
+        {
+            if (!taskId || (single && *single != *taskId))
+            {
+                return std::nullopt;
+            }
+            single = taskId;
+        }
+        return single;
+    }
+
+private:
+    //! Decayed counts below which an adapter is forgotten
+    static constexpr float kMIN_SCORE = 1e-3f;
+
+    SizeType32 mMaxNumHot;
+    float mDecay;
+    float mMinShare;
+    //! Tokens of the current step
+    std::unordered_map<TaskIdType, float> mCounts;
+    //! Decayed tokens of the past steps
+    std::unordered_map<TaskIdType, float> mScores;
+    std::vector<TaskIdType> mHot;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/loraMergedWeights.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+LoraMergedWeights::LoraMergedWeights(TensorMap baseWeights, nvinfer1::DataType loraDataType,
+    ModelConfig const& modelConfig, WorldConfig const& worldConfig, BufferManager::CudaStreamPtr stream,
+    MergeTargetFn mergeTarget)
+    : mBaseWeights{std::move(baseWeights)}
+    , mLoraDataType{loraDataType}
+    , mTpSize{worldConfig.getTensorParallelism()}
+    , mManager{std::move(stream)}
+    , mMergeTarget{std::move(mergeTarget)}
+{
+    auto const& modules = modelConfig.getLoraModules();
+    for (auto const& module : modules)
+    {
+        mModuleIdToModule[module.value()] = module;
+    }
+    if (!mMergeTarget)
+    {
+        mMergeTarget = [modules, tpSize = mTpSize](LoraModule const& module, SizeType32 layerId)
+        { return getDefaultMergeTarget(module, layerId, modules, tpSize); };
+    }
+}
+
+bool LoraMergedWeights::merge(TaskIdType taskId, std::vector<LoraCache::TaskLayerModuleConfig> const& configs)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    // Resolve all modules first, an adapter is merged completely or not at all
+    std::vector<std::pair<LoraCache::TaskLayerModuleConfig const*, MergeTarget>> targets;
+    targets.reserve(configs.size());
+    for (auto const& config : configs)
+    {
+        auto const& module = mModuleIdToModule.at(config.moduleId);
+        auto target = mMergeTarget(module, config.layerId);
+        if (!target || mBaseWeights.count(target->weightName) == 0)
+        {
+            TLLM_LOG_DEBUG("Task %ld not merged, no weight for module %s of layer %d", taskId,
+                std::string(module.name()).c_str(), config.layerId);
+            return false;
+        }
+        auto const& base = *mBaseWeights.at(target->weightName);
+        TLLM_CHECK_WITH_INFO(base.getDataType() == mLoraDataType,
+            "The LoRA weights of task %ld can't be merged into %s of another data type", taskId,
+            target->weightName.c_str());
+        TLLM_CHECK_WITH_INFO(base.getShape().nbDims == 2 && base.getShape().d[1] == module.localInDim(mTpSize),
+            "%s must have %d columns to merge module %s", target->weightName.c_str(), module.localInDim(mTpSize),
+            std::string(module.name()).c_str());
+        targets.emplace_back(&config, std::move(*target));
+    }
+
+    TensorMap merged;
+    for (auto const& [config, target] : targets)
+    {
+        auto it = merged.find(target.weightName);
+        if (it == merged.end())
+        {
+            auto copy = mManager.copyFrom(*mBaseWeights.at(target.weightName), MemoryType::kGPU);
+            it = merged.emplace(target.weightName, std::move(copy)).first;
+        }
+        auto const& module = mModuleIdToModule.at(config->moduleId);
+        kernels::invokeAddLoraDelta(*it->second, reinterpret_cast<void const*>(config->weightsInPointer),
+            reinterpret_cast<void const*>(config->weightsOutPointer), module.localOutDim(mTpSize),
+            config->adapterSize, target.rowOffset, mManager.getStream());
+    }
+    // The pages of the task may be evicted once merged
+    mManager.getStream().synchronize();
+    mMerged.insert_or_assign(taskId, std::move(merged));
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+    return true;
+}
+
+void LoraMergedWeights::update(std::vector<TaskIdType> const& hotTaskIds, LoraCache& deviceCache)
+{
+    for (auto it = mMerged.begin(); it != mMerged.end();)
+    {
+        if (std::find(hotTaskIds.begin(), hotTaskIds.end(), it->first) == hotTaskIds.end())
+        {
+            it = mMerged.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    for (auto const taskId : hotTaskIds)
+    {
+        if (isMerged(taskId) || !deviceCache.isLoaded(taskId))
+        {
+            continue;
+        }
+        if (!merge(taskId, *deviceCache.get(taskId)))
+        {
+            TLLM_LOG_WARNING("Hot LoRA task %ld can't be merged, its requests keep using the lora plugin", taskId);
+        }
+    }
+}
+
+bool LoraMergedWeights::erase(TaskIdType taskId)
+{
+    return mMerged.erase(taskId) != 0;
+}
+
+LoraMergedWeights::TensorMap LoraMergedWeights::getRefitWeights(
+    std::optional<TaskIdType> fromTaskId, std::optional<TaskIdType> toTaskId) const
+{
+    TensorMap weights;
+    if (fromTaskId == toTaskId)
+    {
+        return weights;
+    }
+    if (fromTaskId)
+    {
+        for (auto const& [name, tensor] : mMerged.at(*fromTaskId))
+        {
+            weights.insert_or_assign(name, mBaseWeights.at(name));
+        }
+    }
+    if (toTaskId)
+    {
+        for (auto const& [name, tensor] : mMerged.at(*toTaskId))
+        {
+            weights.insert_or_assign(name, tensor);
+        }
+    }
+    return weights;
+}
+
+std::size_t LoraMergedWeights::getMergedBytes() const
+{
+    std::size_t bytes{0};
+    for (auto const& [taskId, weights] : mMerged)
+    {
+        for (auto const& [name, tensor] : weights)
+        {
+            bytes += tensor->getSizeInBytes();
+        }
+    }
+    return bytes;
+}
+
+std::optional<LoraMergedWeights::MergeTarget> LoraMergedWeights::getDefaultMergeTarget(
+    LoraModule const& module, SizeType32 layerId, std::vector<LoraModule> const& modules, SizeType32 tpSize)
+{
+    using ModuleType = LoraModule::ModuleType;
+    auto const localOutDim = [&modules, tpSize](ModuleType type)
+    {
+        auto const it = std::find_if(modules.begin(), modules.end(),
+            [type](LoraModule const& m) { return m.value() == static_cast<SizeType32>(type); });
+        TLLM_CHECK_WITH_INFO(
+            it != modules.end(), "Module %s is missing", std::string(LoraModule::toModuleName(type)).c_str());
+        return it->localOutDim(tpSize);
+    };
+    auto const layerPrefix = "transformer.layers." + std::to_string(layerId) + ".";
+    switch (static_cast<ModuleType>(module.value()))
+    {
+    case ModuleType::kATTN_QKV:
+    case ModuleType::kATTN_Q: return MergeTarget{layerPrefix + "attention.qkv.weight", 0};
+    case ModuleType::kATTN_K:
+        return MergeTarget{layerPrefix + "attention.qkv.weight", localOutDim(ModuleType::kATTN_Q)};
+    case ModuleType::kATTN_V:
+        return MergeTarget{layerPrefix + "attention.qkv.weight",
+            localOutDim(ModuleType::kATTN_Q) + localOutDim(ModuleType::kATTN_K)};
+    case ModuleType::kATTN_DENSE: return MergeTarget{layerPrefix + "attention.dense.weight", 0};
+    case ModuleType::kMLP_H_TO_4H: return MergeTarget{layerPrefix + "mlp.fc.weight", 0};
+    case ModuleType::kMLP_4H_TO_H: return MergeTarget{layerPrefix + "mlp.proj.weight", 0};
+    case ModuleType::kMLP_GATE: return MergeTarget{layerPrefix + "mlp.gate.weight", 0};
+    default: return std::nullopt;
+    }
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/loraCache.h"
+#include "tensorrt_llm/runtime/loraHotAdapters.h"
+#include "tensorrt_llm/runtime/loraModule.h"
+#include "tensorrt_llm/runtime/modelConfig.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+/**
+ * \brief Keeps copies of the base weights with the LoRA weights of hot adapters merged in, W + B * A.
+ * \details A batch whose requests all use one merged adapter can run the engine with the merged weights refitted
+ * and without the LoRA GEMMs, at the speed of the base model, see selectMerged and getRefitWeights. Batches mixing
+ * adapters keep using the LoraCache pages through the lora plugin. Only the weights of the modules an adapter
+ * targets are copied, in the data type of the model. The engine must be refittable, see TllmRuntime::isRefittable.
+ */
+class LoraMergedWeights
+{
+public:
+    using TaskIdType = LoraCache::TaskIdType;
+    using TensorPtr = ITensor::SharedPtr;
+    using TensorMap = StringPtrMap<ITensor>;
+
+    //! \brief The weight the LoRA weights of a module are merged into, and the first row of the module in it.
+    struct MergeTarget
+    {
+        std::string weightName;
+        SizeType32 rowOffset{0};
+    };
+
+    using MergeTargetFn = std::function<std::optional<MergeTarget>(LoraModule const& module, SizeType32 layerId)>;
+
+    /**
+     * \param[in] baseWeights: the weights of the modules that may be merged, [localOutDim, localInDim] of the local
+     *                         rank, named as in the engine
+     * \param[in] loraDataType: the data type of the LoraCache pages, which must be the data type of the weights
+     * \param[in] modelConfig: a ModelConfig
+     * \param[in] worldConfig: a WorldConfig
+     * \param[in] stream: the stream the merges run on
+     * \param[in] mergeTarget: the weights of the modules, getDefaultMergeTarget if not given
+     */
+    LoraMergedWeights(TensorMap baseWeights, nvinfer1::DataType loraDataType, ModelConfig const& modelConfig,
+        WorldConfig const& worldConfig, BufferManager::CudaStreamPtr stream, MergeTargetFn mergeTarget = {});
+
+    /**
+     * \brief Merge the weights of an adapter into copies of the base weights.
+     * \param[in] taskId: the task id
+     * \param[in] configs: the modules of the task, with pointers to the weights in device memory, as returned by
+     *                     LoraCache::get. The weights are read before returning, the pages may be evicted afterwards.
+     * \returns -- false if a module of the task has no weight to be merged into, nothing is kept then
+     */
+    bool merge(TaskIdType taskId, std::vector<LoraCache::TaskLayerModuleConfig> const& configs);
+
+    /**
+     * \brief Merge the hot adapters loaded in the device cache and drop the adapters that are no longer hot.
+     * \details Call between steps, while the pages of the hot adapters can't be evicted.
+     */
+    void update(std::vector<TaskIdType> const& hotTaskIds, LoraCache& deviceCache);
+
+    /**
+     * \brief Drop the merged weights of a task.
+     * \returns -- true if the task was merged
+     */
+    bool erase(TaskIdType taskId);
+
+    [[nodiscard]] bool isMerged(TaskIdType taskId) const
+    {
+        return mMerged.count(taskId) != 0;
+    }
+
+    /**
+     * \param[in] batchTaskIds: the tasks of the requests of a batch, none for a request without adapter
+     * \returns -- the task if all requests of the batch use the same merged task, none if the batch has to use the
+     * lora plugin
+     */
+    template <typename TaskIds>
+    [[nodiscard]] std::optional<TaskIdType> selectMerged(TaskIds const& batchTaskIds) const
+    {
+        auto const taskId = LoraHotAdapters::getSingleAdapter(batchTaskIds);
+        return taskId && isMerged(*taskId) ? taskId : std::optional<TaskIdType>{};
+    }
+
+    /**
+     * \brief The weights to refit the engine with, to switch from the weights of one task to the ones of another.
+     * \param[in] fromTaskId: the merged task the engine runs with, none for the base weights
+     * \param[in] toTaskId: the merged task to run with, none to restore the base weights
+     * \returns -- the merged weights of toTaskId, and the base weights of the modules only fromTaskId targets
+     */
+    [[nodiscard]] TensorMap getRefitWeights(
+        std::optional<TaskIdType> fromTaskId, std::optional<TaskIdType> toTaskId) const;
+
+    /**
+     * \returns -- bytes of device memory held by the merged weights
+     */
+    [[nodiscard]] std::size_t getMergedBytes() const;
+
+    /**
+     * \brief The weights of the modules in TensorRT-LLM models, e.g. transformer.layers.0.attention.qkv.weight for
+     * attn_qkv of layer 0. The Q, K and V modules are rows of the fused qkv weight. None for the other modules.
+     */
+    [[nodiscard]] static std::optional<MergeTarget> getDefaultMergeTarget(
+        LoraModule const& module, SizeType32 layerId, std::vector<LoraModule> const& modules, SizeType32 tpSize);
+
+private:
+    TensorMap mBaseWeights;
+    nvinfer1::DataType mLoraDataType;
+    SizeType32 mTpSize;
+    std::unordered_map<SizeType32, LoraModule> mModuleIdToModule;
+    BufferManager mManager;
+    MergeTargetFn mMergeTarget;
+    std::unordered_map<TaskIdType, TensorMap> mMerged;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -55,30 +55,99 @@ std::string MemoryCounters::bytesToString(DiffType bytes, int precision)
     return doubleBytesToString(static_cast<double>(bytes), precision);
 }
 
+namespace
+{
+MemoryTag& currentTag()
+{
+    thread_local MemoryTag tag{MemoryTag::kUNTAGGED};
+    return tag;
+}
+} // namespace
+
+MemoryCounters::ScopedTag::ScopedTag(MemoryTag tag)
+    : mPrevious{currentTag()}
+{
+    currentTag() = tag;
+}
+
+MemoryCounters::ScopedTag::~ScopedTag()
+{
+    currentTag() = mPrevious;
+}
+
+MemoryTag MemoryCounters::getCurrentTag()
+{
+    return currentTag();
+}
+
+char const* MemoryCounters::tagToString(MemoryTag tag)
+{
+    switch (tag)
+    {
+    case MemoryTag::kUNTAGGED: return "untagged";
+    case MemoryTag::kKV_CACHE: return "KV cache";
+    case MemoryTag::kLORA_CACHE: return "LoRA cache";
+    case MemoryTag::kDECODER: return "decoder";
+    case MemoryTag::kRUNTIME_BUFFERS: return "runtime buffers";
+    case MemoryTag::kTRT_ACTIVATIONS: return "TRT activations";
+    case MemoryTag::kCUSTOM_ALL_REDUCE: return "custom all-reduce";
+    }
+    return "unknown";
+}
+
+void MemoryCounters::resetPeaks()
+{
+    for (std::size_t i = 0; i < mTagged.size(); ++i)
+    {
+        mTaggedPeak[i] = mTagged[i].load();
+    }
+}
+
+std::string MemoryCounters::toTaggedString() const
+{
+    std::string result{"[MemUsage] GPU by tag (current / peak):"};
+    for (std::size_t i = 0; i < kNumTags; ++i)
+    {
+        auto const tag = static_cast<MemoryTag>(i);
+        auto const peak = getTaggedPeak(tag, MemoryType::kGPU);
+        if (peak > 0)
+        {
+            auto const current = getTagged(tag, MemoryType::kGPU);
+            result += tensorrt_llm::common::fmtstr(" %s %s / %s,", tagToString(tag), bytesToString(current).c_str(),
+                bytesToString(peak).c_str());
+        }
+    }
+    if (result.back() == ',')
+    {
+        result.pop_back();
+    }
+    return result;
+}
+
 std::string MemoryCounters::toString() const
 {
     return tensorrt_llm::common::fmtstr("[MemUsage] GPU %s, CPU %s, Pinned %s", bytesToString(this->getGpu()).c_str(),
         bytesToString(this->getCpu()).c_str(), bytesToString(this->getPinned()).c_str());
 }
 
-void MemoryCounters::allocate(MemoryType memoryType, MemoryCounters::SizeType32 size)
+void MemoryCounters::allocate(MemoryType memoryType, MemoryCounters::SizeType32 size, MemoryTag tag)
 {
     switch (memoryType)
     {
-    case MemoryType::kGPU: allocate<MemoryType::kGPU>(size); break;
-    case MemoryType::kCPU: allocate<MemoryType::kCPU>(size); break;
-    case MemoryType::kPINNED: allocate<MemoryType::kPINNED>(size); break;
+    case MemoryType::kGPU: allocate<MemoryType::kGPU>(size, tag); break;
+    case MemoryType::kCPU: allocate<MemoryType::kCPU>(size, tag); break;
+    case MemoryType::kPINNED: allocate<MemoryType::kPINNED>(size, tag); break;
     default: TLLM_THROW("Unknown memory type");
     }
 }
 
-void MemoryCounters::deallocate(MemoryType memoryType, MemoryCounters::SizeType32 size)
+void MemoryCounters::deallocate(MemoryType memoryType, MemoryCounters::SizeType32 size, MemoryTag tag)
 {
     switch (memoryType)
     {
-    case MemoryType::kGPU: deallocate<MemoryType::kGPU>(size); break;
-    case MemoryType::kCPU: deallocate<MemoryType::kCPU>(size); break;
-    case MemoryType::kPINNED: deallocate<MemoryType::kPINNED>(size); break;
+    case MemoryType::kGPU: deallocate<MemoryType::kGPU>(size, tag); break;
+    case MemoryType::kCPU: deallocate<MemoryType::kCPU>(size, tag); break;
+    case MemoryType::kPINNED: deallocate<MemoryType::kPINNED>(size, tag); break;
     default: TLLM_THROW("Unknown memory type");
     }
 }
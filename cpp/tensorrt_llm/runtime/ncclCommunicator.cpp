@@ -17,8 +17,11 @@
 #include "tensorrt_llm/runtime/ncclCommunicator.h"
 
 #include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/inProcessWorld.h"
 #include "tensorrt_llm/runtime/utils/multiDeviceUtils.h"
 
+#include <set>
+
 #if ENABLE_MULTI_DEVICE
 #include <nccl.h>
 #endif // ENABLE_MULTI_DEVICE
@@ -69,16 +72,67 @@ void NcclCommunicator::receive(
 #endif // ENABLE_MULTI_DEVICE
 }
 
+void NcclCommunicator::sendReceive(void const* sendbuff, int sendPeer, void* recvbuff, int recvPeer, size_t count,
+    nvinfer1::DataType dataType, CudaStream const& stream) const
+{
+#if ENABLE_MULTI_DEVICE
+    TLLM_NCCL_CHECK(ncclGroupStart());
+    TLLM_NCCL_CHECK(ncclSend(sendbuff, count, toNcclType(dataType), sendPeer, mComm, stream.get()));
+    TLLM_NCCL_CHECK(ncclRecv(recvbuff, count, toNcclType(dataType), recvPeer, mComm, stream.get()));
+    TLLM_NCCL_CHECK(ncclGroupEnd());
+#else
+    TLLM_THROW("Multi device support is disabled.");
+#endif // ENABLE_MULTI_DEVICE
+}
+
+void NcclCommunicator::allGather(void const* sendbuff, void* recvbuff, size_t sendCount, nvinfer1::DataType dataType,
+    CudaStream const& stream) const
+{
+#if ENABLE_MULTI_DEVICE
+    TLLM_NCCL_CHECK(ncclAllGather(sendbuff, recvbuff, sendCount, toNcclType(dataType), mComm, stream.get()));
+#else
+    TLLM_THROW("Multi device support is disabled.");
+#endif // ENABLE_MULTI_DEVICE
+}
+
+void NcclCommunicator::allReduce(void const* sendbuff, void* recvbuff, size_t count, nvinfer1::DataType dataType,
+    CudaStream const& stream) const
+{
+#if ENABLE_MULTI_DEVICE
+    TLLM_NCCL_CHECK(ncclAllReduce(sendbuff, recvbuff, count, toNcclType(dataType), ncclSum, mComm, stream.get()));
+#else
+    TLLM_THROW("Multi device support is disabled.");
+#endif // ENABLE_MULTI_DEVICE
+}
+
 ncclComm_t NcclCommunicator::createComm(int worldSize, int rank, mpi::MpiComm const& mpiComm)
 {
 #if ENABLE_MULTI_DEVICE
 
     ncclUniqueId id;
-    if (rank == 0)
+    if (auto* world = InProcessWorld::current())
+    {
+        std::set<SizeType32> group;
+        for (SizeType32 peer = 0; peer < worldSize; ++peer)
+        {
+            group.insert(peer);
+        }
+        id = world->broadcastValue<ncclUniqueId>("nccl_communicator", group,
+            []()
+            {
+                ncclUniqueId uniqueId;
+                ncclGetUniqueId(&uniqueId);
+                return uniqueId;
+            });
+    }
+    else
     {
-        ncclGetUniqueId(&id);
+        if (rank == 0)
+        {
+            ncclGetUniqueId(&id);
+        }
+        mpiComm.bcastValue(id, 0);
     }
-    mpiComm.bcastValue(id, 0);
     ncclComm_t comm;
     TLLM_NCCL_CHECK(ncclCommInitRank(&comm, worldSize, id, rank));
     return comm;
@@ -55,12 +55,49 @@ public:
         receive(buf.data(), buf.getSize(), buf.getDataType(), peer, stream);
     }
 
+    //! @brief Sends sendBuf to sendPeer while receiving recvBuf from recvPeer, e.g. to pass buffers around a ring of
+    //! ranks, where separate sends and receives would deadlock.
+    void sendReceive(
+        IBuffer const& sendBuf, int sendPeer, IBuffer& recvBuf, int recvPeer, CudaStream const& stream) const
+    {
+        TLLM_CHECK(sendBuf.getDataType() == recvBuf.getDataType());
+        TLLM_CHECK(sendBuf.getSize() == recvBuf.getSize());
+        sendReceive(sendBuf.data(), sendPeer, recvBuf.data(), recvPeer, sendBuf.getSize(), sendBuf.getDataType(),
+            stream);
+    }
+
+    //! @brief Gathers sendBuf of all ranks into recvBuf, ordered by rank. recvBuf must hold worldSize times the
+    //! elements of sendBuf.
+    void allGather(IBuffer const& sendBuf, IBuffer& recvBuf, CudaStream const& stream) const
+    {
+        TLLM_CHECK(sendBuf.getDataType() == recvBuf.getDataType());
+        TLLM_CHECK(recvBuf.getSize() % sendBuf.getSize() == 0);
+        allGather(sendBuf.data(), recvBuf.data(), sendBuf.getSize(), sendBuf.getDataType(), stream);
+    }
+
+    //! @brief Sums sendBuf over all ranks into recvBuf.
+    void allReduce(IBuffer const& sendBuf, IBuffer& recvBuf, CudaStream const& stream) const
+    {
+        TLLM_CHECK(sendBuf.getDataType() == recvBuf.getDataType());
+        TLLM_CHECK(recvBuf.getSize() == sendBuf.getSize());
+        allReduce(sendBuf.data(), recvBuf.data(), sendBuf.getSize(), sendBuf.getDataType(), stream);
+    }
+
 private:
     void send(
         void const* sendbuff, size_t count, nvinfer1::DataType dataType, int peer, CudaStream const& stream) const;
 
     void receive(void* sendbuff, size_t count, nvinfer1::DataType dataType, int peer, CudaStream const& stream) const;
 
+    void sendReceive(void const* sendbuff, int sendPeer, void* recvbuff, int recvPeer, size_t count,
+        nvinfer1::DataType dataType, CudaStream const& stream) const;
+
+    void allGather(void const* sendbuff, void* recvbuff, size_t sendCount, nvinfer1::DataType dataType,
+        CudaStream const& stream) const;
+
+    void allReduce(void const* sendbuff, void* recvbuff, size_t count, nvinfer1::DataType dataType,
+        CudaStream const& stream) const;
+
     static ncclComm_t createComm(int worldSize, int rank, mpi::MpiComm const& mpiComm);
 
     ncclComm_t mComm;
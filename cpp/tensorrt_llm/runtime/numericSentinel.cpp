@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/numericSentinel.h"
+
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+
+#include <algorithm>
+#include <new>
+#include <string>
+
+namespace tensorrt_llm::runtime
+{
+
+char const* toString(SentinelSite site) noexcept
+{
+    switch (site)
+    {
+    case SentinelSite::kLOGITS: return "logits";
+    case SentinelSite::kATTENTION_OUTPUT: return "attention_output";
+    case SentinelSite::kMOE_OUTPUT: return "moe_output";
+    case SentinelSite::kENCODER_OUTPUT: return "encoder_output";
+    }
+    return "unknown";
+}
+
+NumericSentinel::Scope::Scope(NumericSentinel& sentinel, SentinelSite site, nvinfer1::PluginTensorDesc const& desc,
+    void const* data, cudaStream_t stream) noexcept
+    : mSentinel{sentinel}
+    , mSite{site}
+    , mType{desc.type}
+    , mData{data}
+    , mStream{stream}
+{
+    if (!mSentinel.isEnabled() || desc.dims.nbDims <= 0)
+    {
+        return;
+    }
+    // Rows of the last dimension, a row with a reported value flags the whole tensor either way
+    auto const dimSize
+        = [&desc](std::int32_t i) { return desc.dims.d[i] > 0 ? static_cast<std::size_t>(desc.dims.d[i]) : 0; };
+    mRowSize = dimSize(desc.dims.nbDims - 1);
+    mNumRows = 1;
+    for (std::int32_t i = 0; i < desc.dims.nbDims - 1; ++i)
+    {
+        mNumRows *= dimSize(i);
+    }
+}
+
+NumericSentinel::Scope::~Scope() noexcept
+{
+    if (mNumRows != 0 && mRowSize != 0)
+    {
+        mSentinel.check(mSite, mData, mType, mNumRows, mRowSize, mStream);
+    }
+}
+
+NumericSentinel& NumericSentinel::getInstance()
+{
+    static NumericSentinel sentinel{
+        common::getEnvNumericSentinel(), static_cast<float>(common::getEnvNumericSentinelOverflow())};
+    return sentinel;
+}
+
+NumericSentinel::NumericSentinel(bool enabled, float overflowThreshold)
+    : mOverflowThreshold{overflowThreshold}
+{
+    if (!enabled)
+    {
+        return;
+    }
+    // The flags and the slot flags share one pinned allocation, a failed allocation disables the sentinel
+    void* memory{nullptr};
+    auto const size = sizeof(std::atomic<std::uint32_t>) + kMaxSlots * sizeof(std::int32_t);
+    if (cudaMallocHost(&memory, size) != cudaSuccess)
+    {
+        TLLM_LOG_WARNING("Failed to allocate the flags of the numeric sentinel, it's disabled");
+        return;
+    }
+    mFlags = new (memory) std::atomic<std::uint32_t>{0};
+    mSlotFlags = reinterpret_cast<std::int32_t*>(static_cast<std::uint8_t*>(memory) + sizeof(*mFlags));
+    std::fill_n(mSlotFlags, kMaxSlots, 0);
+    TLLM_LOG_INFO("Numeric sentinel enabled, overflow threshold %f", mOverflowThreshold);
+}
+
+NumericSentinel::~NumericSentinel()
+{
+    if (mFlags != nullptr)
+    {
+        // Unchecked, the CUDA runtime may already be unloaded when the process wide sentinel is destroyed
+        cudaFreeHost(mFlags);
+    }
+}
+
+void NumericSentinel::check(SentinelSite site, void const* data, nvinfer1::DataType type, std::size_t numRows,
+    std::size_t rowSize, cudaStream_t stream, std::int32_t* rowFlags) noexcept
+{
+    if (!isEnabled() || data == nullptr)
+    {
+        return;
+    }
+    // The atomic is lock free and has the layout of its value, the device ors into it directly
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+    kernels::invokeCheckNonFinite(data, type, numRows, rowSize, mOverflowThreshold,
+        reinterpret_cast<std::uint32_t*>(mFlags), 1u << static_cast<std::uint32_t>(site), rowFlags, stream);
+}
+
+void NumericSentinel::checkSlot(SentinelSite site, SizeType32 slot, void const* data, nvinfer1::DataType type,
+    std::size_t size, cudaStream_t stream) noexcept
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    // All the values of the slot make one row, flagged in the slot flags
+    auto* slotFlags = slot >= 0 && static_cast<std::size_t>(slot) < kMaxSlots ? mSlotFlags + slot : nullptr;
+    check(site, data, type, 1, size, stream, slotFlags);
+}
+
+std::uint32_t NumericSentinel::poll()
+{
+    if (!isEnabled())
+    {
+        return 0;
+    }
+    auto const flags = mFlags->exchange(0, std::memory_order_acq_rel);
+    if (flags == 0)
+    {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mPollMutex);
+    std::string sites;
+    for (std::size_t site = 0; site < kNumSites; ++site)
+    {
+        if ((flags & (1u << site)) != 0)
+        {
+            mNumDetections[site].fetch_add(1, std::memory_order_relaxed);
+            sites += sites.empty() ? "" : ", ";
+            sites += toString(static_cast<SentinelSite>(site));
+        }
+    }
+    std::string slots;
+    if ((flags & (1u << static_cast<std::uint32_t>(SentinelSite::kLOGITS))) != 0)
+    {
+        mLastFlaggedSlots.clear();
+        for (std::size_t slot = 0; slot < kMaxSlots; ++slot)
+        {
+            auto volatile& slotFlag = mSlotFlags[slot];
+            if (slotFlag != 0)
+            {
+                slotFlag = 0;
+                mLastFlaggedSlots.push_back(static_cast<SizeType32>(slot));
+                slots += slots.empty() ? "" : " ";
+                slots += std::to_string(slot);
+            }
+        }
+    }
+    TLLM_LOG_EVERY_MS(common::Logger::WARNING, 1000, "Non-finite or overflowing values in the %s%s%s", sites.c_str(),
+        slots.empty() ? "" : ", batch slots ", slots.c_str());
+    return flags;
+}
+
+std::vector<SizeType32> NumericSentinel::getLastFlaggedSlots() const
+{
+    std::lock_guard<std::mutex> lock(mPollMutex);
+    return mLastFlaggedSlots;
+}
+
+} // namespace tensorrt_llm::runtime
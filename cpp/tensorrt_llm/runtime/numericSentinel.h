@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <NvInferRuntime.h>
+#include <cuda_runtime_api.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Outputs checked by the NumericSentinel.
+enum class SentinelSite : std::uint8_t
+{
+    kLOGITS = 0,
+    kATTENTION_OUTPUT = 1,
+    kMOE_OUTPUT = 2,
+    kENCODER_OUTPUT = 3,
+};
+
+[[nodiscard]] char const* toString(SentinelSite site) noexcept;
+
+//! \brief On-device checks of outputs for NaN, Inf and overflowing values, cheap enough to stay on with live traffic.
+//! \details A reduction kernel is enqueued after the checked outputs and sets a flag in pinned host memory if it finds
+//! such a value, nothing is copied back or synchronized. The flags are polled when the next engine execution starts,
+//! so a detection is reported with a delay of about one step, with the batch slots of the logits that had one. Values
+//! above TRTLLM_NUMERIC_SENTINEL_OVERFLOW are also reported, e.g. to catch FP8 scales drifting before they overflow.
+class NumericSentinel
+{
+public:
+    static constexpr std::size_t kNumSites = 4;
+    //! Batch slots whose logits are tracked separately, the slots beyond are only reported as a site
+    static constexpr std::size_t kMaxSlots = 1024;
+
+    //! \brief Checks the output tensor of a plugin once the launches of its enqueue, during the scope's lifetime, are.
+    class Scope
+    {
+    public:
+        Scope(NumericSentinel& sentinel, SentinelSite site, nvinfer1::PluginTensorDesc const& desc, void const* data,
+            cudaStream_t stream) noexcept;
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        ~Scope() noexcept;
+
+    private:
+        NumericSentinel& mSentinel;
+        SentinelSite mSite;
+        nvinfer1::DataType mType;
+        std::size_t mNumRows{0};
+        std::size_t mRowSize{0};
+        void const* mData;
+        cudaStream_t mStream;
+    };
+
+    //! \brief Process wide sentinel enabled by TRTLLM_NUMERIC_SENTINEL, shared by all the engines.
+    static NumericSentinel& getInstance();
+
+    //! \param overflowThreshold Magnitude above which a value is reported, 0 only reports NaN and Inf.
+    NumericSentinel(bool enabled, float overflowThreshold);
+
+    ~NumericSentinel();
+
+    NumericSentinel(NumericSentinel const&) = delete;
+    NumericSentinel& operator=(NumericSentinel const&) = delete;
+
+    [[nodiscard]] bool isEnabled() const noexcept
+    {
+        return mFlags != nullptr;
+    }
+
+    //! \brief Enqueues the check of numRows rows of rowSize values on stream.
+    //! \param rowFlags Set to 1 for the rows with a reported value, device accessible, e.g. pinned. Optional.
+    void check(SentinelSite site, void const* data, nvinfer1::DataType type, std::size_t numRows, std::size_t rowSize,
+        cudaStream_t stream, std::int32_t* rowFlags = nullptr) noexcept;
+
+    //! \brief Enqueues the check of the values of a batch slot, reported with the slot.
+    void checkSlot(SentinelSite site, SizeType32 slot, void const* data, nvinfer1::DataType type, std::size_t size,
+        cudaStream_t stream) noexcept;
+
+    [[nodiscard]] Scope scope(SentinelSite site, nvinfer1::PluginTensorDesc const& desc, void const* data,
+        cudaStream_t stream) noexcept
+    {
+        return Scope{*this, site, desc, data, stream};
+    }
+
+    //! \brief Reports the detections of the completed checks since the last poll and clears them.
+    //! \returns The bits of the sites with a detection, 1 << site.
+    std::uint32_t poll();
+
+    //! \brief The batch slots reported by the last poll that found a detection in the logits.
+    [[nodiscard]] std::vector<SizeType32> getLastFlaggedSlots() const;
+
+    //! \returns The number of polls that found a detection at the site.
+    [[nodiscard]] std::uint64_t getNumDetections(SentinelSite site) const noexcept
+    {
+        return mNumDetections[static_cast<std::size_t>(site)].load(std::memory_order_relaxed);
+    }
+
+private:
+    float mOverflowThreshold;
+    //! Pinned host memory, written by the checks on the device
+    std::atomic<std::uint32_t>* mFlags{nullptr};
+    std::int32_t* mSlotFlags{nullptr};
+
+    std::array<std::atomic<std::uint64_t>, kNumSites> mNumDetections{};
+    mutable std::mutex mPollMutex;
+    std::vector<SizeType32> mLastFlaggedSlots;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/offlineRunner.h"
+
+#include "tensorrt_llm/batch_manager/offlineBatchPlanner.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <chrono>
+#include <unordered_map>
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+//! Timeout of the waits for responses, which bounds the delay of the submissions when no response arrives
+auto constexpr kAWAIT_TIMEOUT = std::chrono::milliseconds{10};
+} // namespace
+
+OfflineRunner::OfflineRunner(executor::Executor& executor, OfflineRunnerConfig const& config)
+    : mExecutor{executor}
+    , mConfig{config}
+{
+    TLLM_CHECK_WITH_INFO(mConfig.overcommit > 0.f, "overcommit must be positive, got %f", mConfig.overcommit);
+}
+
+std::vector<executor::Response> OfflineRunner::run(std::vector<executor::Request> requests,
+    std::optional<std::vector<SizeType32>> const& predictedOutputLengths, EnqueuedCallback const& onEnqueued,
+    ResponseCallback const& onResponse)
+{
+    auto const numRequests = requests.size();
+    std::vector<batch_manager::OfflineBatchPlanner::VecTokens> prompts;
+    std::vector<SizeType32> outputLengths;
+    prompts.reserve(numRequests);
+    outputLengths.reserve(numRequests);
+    for (auto const& request : requests)
+    {
+        prompts.push_back(request.getInputTokenIds());
+        outputLengths.push_back(request.getMaxNewTokens());
+    }
+    if (predictedOutputLengths)
+    {
+        TLLM_CHECK_WITH_INFO(predictedOutputLengths->size() == numRequests,
+            "Every request needs a predicted output length.");
+        outputLengths = predictedOutputLengths.value();
+    }
+
+    batch_manager::OfflineBatchPlanner planner{mConfig.tokensPerBlock, mConfig.lookahead};
+    planner.plan(prompts, outputLengths);
+    prompts.clear();
+    auto const setMaxNumBlocks = [this, &planner](SizeType32 maxNumBlocks)
+    { planner.setMaxNumBlocks(std::max(1, static_cast<SizeType32>(maxNumBlocks * mConfig.overcommit))); };
+    auto maxNumBlocksKnown = mConfig.maxNumBlocks.has_value();
+    if (maxNumBlocksKnown)
+    {
+        setMaxNumBlocks(mConfig.maxNumBlocks.value());
+    }
+
+    std::vector<std::optional<executor::Response>> finalResponses(numRequests);
+    std::unordered_map<IdType, std::size_t> requestIndices;
+    while (!planner.isDone())
+    {
+        if (!maxNumBlocksKnown)
+        {
+            auto const stats = mExecutor.getLatestIterationStats();
+            if (!stats.empty() && stats.back().kvCacheStats)
+            {
+                setMaxNumBlocks(stats.back().kvCacheStats->maxNumBlocks);
+                maxNumBlocksKnown = true;
+                TLLM_LOG_INFO("Packing the offline requests into %d KV cache blocks",
+                    stats.back().kvCacheStats->maxNumBlocks);
+            }
+        }
+
+        auto const released = planner.next();
+        if (!released.empty())
+        {
+            std::vector<executor::Request> batch;
+            batch.reserve(released.size());
+            for (auto const idx : released)
+            {
+                batch.push_back(std::move(requests[idx]));
+            }
+            auto const requestIds = mExecutor.enqueueRequests(std::move(batch));
+            for (std::size_t i = 0; i < released.size(); ++i)
+            {
+                requestIndices.emplace(requestIds[i], released[i]);
+                if (onEnqueued)
+                {
+                    onEnqueued(released[i], requestIds[i]);
+                }
+            }
+        }
+
+        for (auto& response : mExecutor.awaitResponses(kAWAIT_TIMEOUT))
+        {
+            auto const it = requestIndices.find(response.getRequestId());
+            if (it == requestIndices.end())
+            {
+                TLLM_LOG_WARNING("Dropping a response to unknown request %lu", response.getRequestId());
+                continue;
+            }
+            auto const idx = it->second;
+            if (onResponse)
+            {
+                onResponse(idx, response);
+            }
+            if (response.hasError() || response.getResult().isFinal)
+            {
+                planner.complete(idx);
+                requestIndices.erase(it);
+                finalResponses[idx] = std::move(response);
+            }
+        }
+    }
+
+    std::vector<executor::Response> responses;
+    responses.reserve(numRequests);
+    for (auto& response : finalResponses)
+    {
+        responses.push_back(std::move(response.value()));
+    }
+    return responses;
+}
+
+} // namespace tensorrt_llm::runtime
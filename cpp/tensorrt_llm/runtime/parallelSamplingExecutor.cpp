@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/parallelSamplingExecutor.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <iterator>
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+//! Timeout of the waits of the collector, which bounds the latency of shutdown
+auto constexpr kCOLLECT_TIMEOUT = std::chrono::milliseconds{10};
+
+//! \brief A copy of the request that fills the KV cache with its prompt and generates a single token.
+//! \details The prompt tuning and LoRA configs are kept, the reuse of the cached blocks depends on them.
+executor::Request makePrefillRequest(executor::Request const& request)
+{
+    executor::Request prefill{request.getInputTokenIds(), 1, false, request.getSamplingConfig()};
+    if (auto const endId = request.getEndId())
+    {
+        prefill.setEndId(*endId);
+    }
+    if (auto const padId = request.getPadId())
+    {
+        prefill.setPadId(*padId);
+    }
+    if (auto const pTuningConfig = request.getPromptTuningConfig())
+    {
+        prefill.setPromptTuningConfig(*pTuningConfig);
+    }
+    if (auto const loraConfig = request.getLoraConfig())
+    {
+        prefill.setLoraConfig(*loraConfig);
+    }
+    if (auto const encoderInputTokenIds = request.getEncoderInputTokenIds())
+    {
+        prefill.setEncoderInputTokenIds(*encoderInputTokenIds);
+    }
+    return prefill;
+}
+} // namespace
+
+ParallelSamplingExecutor::ParallelSamplingExecutor(std::filesystem::path const& modelPath,
+    executor::ModelType modelType, executor::ExecutorConfig const& executorConfig)
+    : mExecutor{std::make_unique<executor::Executor>(modelPath, modelType, executorConfig)}
+    , mSharePrefill{executorConfig.getKvCacheConfig().getEnableBlockReuse()}
+{
+    if (!mSharePrefill)
+    {
+        TLLM_LOG_WARNING(
+            "KV cache block reuse is disabled, the samples of a request won't share the prefill of its prompt.");
+    }
+    mCollector = std::thread(&ParallelSamplingExecutor::collectLoop, this);
+}
+
+ParallelSamplingExecutor::~ParallelSamplingExecutor()
+{
+    shutdown();
+}
+
+ParallelSamplingExecutor::IdType ParallelSamplingExecutor::enqueueRequest(
+    executor::Request const& request, SizeType32 numReturnSequences)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    TLLM_CHECK_WITH_INFO(!mShutdown, "Can't enqueue requests after shutdown.");
+    auto const requestId = mNextRequestId++;
+    if (numReturnSequences == 1)
+    {
+        mSingleRequests.emplace(mExecutor->enqueueRequest(request), requestId);
+        return requestId;
+    }
+    TLLM_CHECK_WITH_INFO(request.getSamplingConfig().getBeamWidth() == 1,
+        "Requests with several return sequences sample them with beam width 1.");
+    TLLM_CHECK_WITH_INFO(!request.getStreaming(), "Requests with several return sequences can't be streamed.");
+
+    auto& sampled = mSampledRequests
+                        .emplace(requestId,
+                            SampledRequest{request, batch_manager::ParallelSampleGroup{numReturnSequences}, {}})
+                        .first->second;
+    if (mSharePrefill && request.getMaxNewTokens() > 1)
+    {
+        auto const prefillId = mExecutor->enqueueRequest(makePrefillRequest(request));
+        sampled.executorRequestIds.push_back(prefillId);
+        mParts.emplace(prefillId, Part{requestId, kPREFILL});
+    }
+    else
+    {
+        enqueueSamplesLocked(requestId, sampled);
+    }
+    return requestId;
+}
+
+std::vector<executor::Response> ParallelSamplingExecutor::awaitResponses(
+    std::optional<std::chrono::milliseconds> const& timeout)
+{
+    std::unique_lock<std::mutex> lock(mResponseMutex);
+    auto const ready = [this] { return !mResponses.empty(); };
+    if (timeout)
+    {
+        mResponseCv.wait_for(lock, *timeout, ready);
+    }
+    else
+    {
+        mResponseCv.wait(lock, ready);
+    }
+    return std::exchange(mResponses, {});
+}
+
+void ParallelSamplingExecutor::cancelRequest(IdType requestId)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (auto const it = mSampledRequests.find(requestId); it != mSampledRequests.end())
+    {
+        it->second.cancelled = true;
+        for (auto const executorRequestId : it->second.executorRequestIds)
+        {
+            mExecutor->cancelRequest(executorRequestId);
+        }
+        return;
+    }
+    for (auto const& [executorRequestId, singleRequestId] : mSingleRequests)
+    {
+        if (singleRequestId == requestId)
+        {
+            mExecutor->cancelRequest(executorRequestId);
+            return;
+        }
+    }
+}
+
+void ParallelSamplingExecutor::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mShutdown)
+        {
+            return;
+        }
+        mShutdown = true;
+    }
+    mCollector.join();
+    mExecutor->shutdown();
+}
+
+std::size_t ParallelSamplingExecutor::getNumSharedPrefills() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNumSharedPrefills;
+}
+
+void ParallelSamplingExecutor::enqueueSamplesLocked(IdType requestId, SampledRequest& sampled)
+{
+    auto const seed = sampled.request.getSamplingConfig().getRandomSeed();
+    sampled.executorRequestIds.clear();
+    for (SizeType32 sampleIdx = 0; sampleIdx < sampled.group.getNumSamples(); ++sampleIdx)
+    {
+        auto sample = sampled.request;
+        auto samplingConfig = sample.getSamplingConfig();
+        samplingConfig.setRandomSeed(batch_manager::ParallelSampleGroup::getSampleSeed(seed, requestId, sampleIdx));
+        sample.setSamplingConfig(samplingConfig);
+        auto const sampleId = mExecutor->enqueueRequest(sample);
+        sampled.executorRequestIds.push_back(sampleId);
+        mParts.emplace(sampleId, Part{requestId, sampleIdx});
+    }
+}
+
+std::optional<executor::Response> ParallelSamplingExecutor::handleResponseLocked(executor::Response const& response)
+{
+    if (auto const singleIt = mSingleRequests.find(response.getRequestId()); singleIt != mSingleRequests.end())
+    {
+        auto const requestId = singleIt->second;
+        if (response.hasError() || response.getResult().isFinal)
+        {
+            mSingleRequests.erase(singleIt);
+        }
+        return response.hasError() ? executor::Response{requestId, response.getErrorMsg()}
+                                   : executor::Response{requestId, response.getResult()};
+    }
+    auto const partIt = mParts.find(response.getRequestId());
+    if (partIt == mParts.end())
+    {
+        TLLM_LOG_WARNING("Dropping a response to unknown request %lu", response.getRequestId());
+        return std::nullopt;
+    }
+    auto const [requestId, sampleIdx] = partIt->second;
+    if (!response.hasError() && !response.getResult().isFinal)
+    {
+        return std::nullopt;
+    }
+    mParts.erase(partIt);
+    auto const sampledIt = mSampledRequests.find(requestId);
+    if (sampledIt == mSampledRequests.end())
+    {
+        // A part of a request that already failed
+        return std::nullopt;
+    }
+    auto& sampled = sampledIt->second;
+
+    std::optional<executor::Response> completed;
+    if (response.hasError())
+    {
+        completed = executor::Response{requestId, response.getErrorMsg()};
+    }
+    else if (sampleIdx == kPREFILL)
+    {
+        if (sampled.cancelled)
+        {
+            completed = executor::Response{requestId, std::string{"Request cancelled during its prefill."}};
+        }
+        else
+        {
+            ++mNumSharedPrefills;
+            enqueueSamplesLocked(requestId, sampled);
+        }
+    }
+    else if (sampled.group.addResult(sampleIdx, response.getResult()))
+    {
+        completed = executor::Response{requestId, sampled.group.merge()};
+    }
+
+    if (completed)
+    {
+        if (completed->hasError())
+        {
+            // The remaining samples are of no use
+            for (auto const executorRequestId : sampled.executorRequestIds)
+            {
+                if (mParts.erase(executorRequestId) != 0)
+                {
+                    mExecutor->cancelRequest(executorRequestId);
+                }
+            }
+        }
+        mSampledRequests.erase(sampledIt);
+    }
+    return completed;
+}
+
+void ParallelSamplingExecutor::collectLoop()
+{
+    while (true)
+    {
+        auto responses = mExecutor->awaitResponses(kCOLLECT_TIMEOUT);
+        std::vector<executor::Response> translated;
+        bool shutdown{false};
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (auto const& response : responses)
+            {
+                if (auto completed = handleResponseLocked(response))
+                {
+                    translated.push_back(std::move(*completed));
+                }
+            }
+            shutdown = mShutdown;
+        }
+        if (!translated.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mResponseMutex);
+                mResponses.insert(mResponses.end(), std::make_move_iterator(translated.begin()),
+                    std::make_move_iterator(translated.end()));
+            }
+            mResponseCv.notify_all();
+        }
+        if (shutdown)
+        {
+            break;
+        }
+    }
+}
+
+} // namespace tensorrt_llm::runtime
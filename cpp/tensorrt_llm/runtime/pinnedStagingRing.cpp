@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/pinnedStagingRing.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <cstring>
+#include <map>
+#include <memory>
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+// Alignment of each copy in the ring
+constexpr std::size_t kAlignment = 64;
+} // namespace
+
+PinnedStagingRing& PinnedStagingRing::getInstance(int device)
+{
+    static std::mutex mutex;
+    // Never destroyed, the CUDA runtime may be gone when static objects are destroyed at exit
+    static auto* rings = new std::map<int, std::unique_ptr<PinnedStagingRing>>();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& ring = (*rings)[device];
+    if (!ring)
+    {
+        ring = std::make_unique<PinnedStagingRing>();
+    }
+    return *ring;
+}
+
+PinnedStagingRing::PinnedStagingRing(std::size_t capacity)
+    : mCapacity{(capacity + kAlignment - 1) / kAlignment * kAlignment}
+{
+    TLLM_CHECK_WITH_INFO(capacity >= kMaxCopySize, "The staging ring must hold at least one copy.");
+}
+
+PinnedStagingRing::~PinnedStagingRing()
+{
+    // The pinned memory is released only after the copies that read it
+    try
+    {
+        for (auto const& staged : mInFlight)
+        {
+            staged.event.synchronize();
+        }
+    }
+    catch (std::exception const& e)
+    {
+        TLLM_LOG_EXCEPTION(e);
+    }
+}
+
+void PinnedStagingRing::retire()
+{
+    while (!mInFlight.empty())
+    {
+        auto const status = cudaEventQuery(mInFlight.front().event.get());
+        if (status == cudaErrorNotReady)
+        {
+            break;
+        }
+        TLLM_CUDA_CHECK(status);
+        mTail = mInFlight.front().end;
+        mFreeEvents.push_back(std::move(mInFlight.front().event));
+        mInFlight.pop_front();
+    }
+}
+
+bool PinnedStagingRing::copyToDevice(void* dst, void const* src, std::size_t size, CudaStream const& stream)
+{
+    // The events are created on the current device and must be recorded on a stream of the same device
+    if (size == 0 || size > kMaxCopySize || stream.getDevice() != tensorrt_llm::common::getDevice())
+    {
+        return false;
+    }
+    // A captured copy would read the ring at replay, after its space was reused
+    cudaStreamCaptureStatus captureStatus;
+    TLLM_CUDA_CHECK(cudaStreamIsCapturing(stream.get(), &captureStatus));
+    if (captureStatus != cudaStreamCaptureStatusNone)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mBuffer)
+    {
+        mBuffer = BufferManager::pinned(mCapacity);
+    }
+    retire();
+
+    // A copy that doesn't fit before the end of the ring starts over at the beginning
+    auto const alignedSize = (size + kAlignment - 1) / kAlignment * kAlignment;
+    auto const offset = mHead % mCapacity;
+    auto const skip = offset + alignedSize > mCapacity ? mCapacity - offset : 0;
+    if (mHead - mTail + skip + alignedSize > mCapacity)
+    {
+        return false;
+    }
+    auto* staging = static_cast<std::uint8_t*>(mBuffer->data()) + (offset + skip) % mCapacity;
+    std::memcpy(staging, src, size);
+    TLLM_CUDA_CHECK(cudaMemcpyAsync(dst, staging, size, cudaMemcpyHostToDevice, stream.get()));
+
+    mHead += skip + alignedSize;
+    auto event = [this]()
+    {
+        if (mFreeEvents.empty())
+        {
+            return CudaEvent{};
+        }
+        auto reused = std::move(mFreeEvents.back());
+        mFreeEvents.pop_back();
+        return reused;
+    }();
+    stream.record(event);
+    mInFlight.push_back(StagedCopy{mHead, std::move(event)});
+    return true;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Ring of pinned host memory to upload small pageable host buffers asynchronously.
+//! \details A copy from pageable memory to the device waits for the work already queued on the stream before it
+//! starts. A staged copy only memcpys the source into the ring and queues the upload from there, so the caller can
+//! reuse the source right away without the stream being drained. The space of a copy is reused once the event
+//! recorded after it completed. There is one ring per device, shared by all streams: the space is reclaimed in the
+//! order of the copies, so a copy on a slow stream only delays the reuse of the space after it.
+class PinnedStagingRing
+{
+public:
+    //! \brief The ring of device, created on first use.
+    static PinnedStagingRing& getInstance(int device);
+
+    static std::size_t constexpr kDefaultCapacity{std::size_t{1} << 20};
+    //! Larger copies are rare and amortize the synchronization, they aren't staged
+    static std::size_t constexpr kMaxCopySize{std::size_t{64} << 10};
+
+    //! \param capacity Bytes of pinned memory, allocated on the first staged copy.
+    explicit PinnedStagingRing(std::size_t capacity = kDefaultCapacity);
+
+    PinnedStagingRing(PinnedStagingRing const&) = delete;
+    PinnedStagingRing& operator=(PinnedStagingRing const&) = delete;
+
+    ~PinnedStagingRing();
+
+    //! \brief Queues the copy of size bytes from pageable src to the device memory dst on stream.
+    //! \returns False, without copying, if the copy is too large, stream isn't on the current device or is captured
+    //! into a CUDA graph, or the ring is full of copies in flight.
+    [[nodiscard]] bool copyToDevice(void* dst, void const* src, std::size_t size, CudaStream const& stream);
+
+private:
+    struct StagedCopy
+    {
+        std::uint64_t end;
+        CudaEvent event;
+    };
+
+    //! \brief Releases the space of the completed copies.
+    void retire();
+
+    std::size_t mCapacity;
+    IBuffer::UniquePtr mBuffer;
+    // Positions are byte counts since the creation of the ring, so that a full and an empty ring differ
+    std::uint64_t mHead{0};
+    std::uint64_t mTail{0};
+    std::deque<StagedCopy> mInFlight;
+    std::vector<CudaEvent> mFreeEvents;
+    std::mutex mMutex;
+};
+
+} // namespace tensorrt_llm::runtime
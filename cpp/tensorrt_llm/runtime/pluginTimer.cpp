@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/pluginTimer.h"
+
+#include "tensorrt_llm/common/envUtils.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+char const* toString(PluginKind kind) noexcept
+{
+    switch (kind)
+    {
+    case PluginKind::kATTENTION: return "attention";
+    case PluginKind::kGEMM: return "gemm";
+    case PluginKind::kALL_REDUCE: return "all_reduce";
+    case PluginKind::kMOE: return "moe";
+    }
+    return "unknown";
+}
+
+PluginTimer::Scope::Scope(PluginTimer& timer, PluginKind kind, cudaStream_t stream) noexcept
+    : mTimer{timer}
+    , mKind{kind}
+    , mStream{stream}
+{
+    if (!mTimer.isSampling())
+    {
+        return;
+    }
+    // Not throwing either, the plugins enqueue from noexcept functions. A launch that can't be timed is skipped.
+    cudaStreamCaptureStatus captureStatus{cudaStreamCaptureStatusNone};
+    if (cudaStreamIsCapturing(mStream, &captureStatus) != cudaSuccess
+        || captureStatus != cudaStreamCaptureStatusNone)
+    {
+        return;
+    }
+    mStart = mTimer.acquireEvent();
+    if (mStart != nullptr && cudaEventRecord(mStart, mStream) != cudaSuccess)
+    {
+        mTimer.releaseEvent(mStart);
+        mStart = nullptr;
+    }
+}
+
+PluginTimer::Scope::~Scope() noexcept
+{
+    if (mStart == nullptr)
+    {
+        return;
+    }
+    // A launch without a stop event isn't counted
+    auto* stop = mTimer.acquireEvent();
+    if (stop != nullptr && cudaEventRecord(stop, mStream) != cudaSuccess)
+    {
+        mTimer.releaseEvent(stop);
+        stop = nullptr;
+    }
+    mTimer.addPending(mKind, mStart, stop);
+}
+
+PluginTimer& PluginTimer::getInstance()
+{
+    static PluginTimer timer{common::getEnvPluginTimingInterval()};
+    return timer;
+}
+
+PluginTimer::PluginTimer(SizeType32 interval)
+    : mInterval{std::max(interval, 0)}
+{
+}
+
+PluginTimer::~PluginTimer()
+{
+    // Unchecked, the CUDA runtime may already be unloaded when the process wide timer is destroyed
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto const& launch : mPending)
+    {
+        cudaEventSynchronize(launch.start);
+        mFreeEvents.push_back(launch.start);
+        if (launch.stop != nullptr)
+        {
+            cudaEventSynchronize(launch.stop);
+            mFreeEvents.push_back(launch.stop);
+        }
+    }
+    for (auto* event : mFreeEvents)
+    {
+        cudaEventDestroy(event);
+    }
+}
+
+void PluginTimer::beginExecution()
+{
+    if (mInterval == 0)
+    {
+        return;
+    }
+    auto const execution = mNumExecutions.fetch_add(1, std::memory_order_relaxed);
+    auto const sampling = execution % mInterval == 0;
+    mSampling.store(sampling, std::memory_order_relaxed);
+    if (sampling)
+    {
+        mNumSampled.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mMutex);
+        collectCompleted();
+    }
+}
+
+PluginTimer::Stats PluginTimer::getStats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    collectCompleted();
+    return mStats;
+}
+
+cudaEvent_t PluginTimer::acquireEvent()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mFreeEvents.empty())
+    {
+        auto* event = mFreeEvents.back();
+        mFreeEvents.pop_back();
+        return event;
+    }
+    if (mNumEvents >= 2 * kMaxPending)
+    {
+        return nullptr;
+    }
+    cudaEvent_t event{nullptr};
+    if (cudaEventCreate(&event) != cudaSuccess)
+    {
+        return nullptr;
+    }
+    ++mNumEvents;
+    return event;
+}
+
+void PluginTimer::releaseEvent(cudaEvent_t event)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFreeEvents.push_back(event);
+}
+
+void PluginTimer::addPending(PluginKind kind, cudaEvent_t start, cudaEvent_t stop)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPending.push_back({kind, start, stop});
+}
+
+void PluginTimer::collectCompleted()
+{
+    while (!mPending.empty())
+    {
+        auto const& launch = mPending.front();
+        if (launch.stop != nullptr)
+        {
+            // Collected in order of the launches, the first incomplete one ends the collection
+            auto const status = cudaEventQuery(launch.stop);
+            if (status == cudaErrorNotReady)
+            {
+                break;
+            }
+            float ms{0.f};
+            if (status == cudaSuccess && cudaEventElapsedTime(&ms, launch.start, launch.stop) == cudaSuccess)
+            {
+                auto& stats = mStats[static_cast<std::size_t>(launch.kind)];
+                ++stats.numLaunches;
+                stats.totalMs += ms;
+                stats.maxMs = std::max(stats.maxMs, static_cast<double>(ms));
+            }
+            mFreeEvents.push_back(launch.stop);
+        }
+        else if (cudaEventQuery(launch.start) == cudaErrorNotReady)
+        {
+            break;
+        }
+        mFreeEvents.push_back(launch.start);
+        mPending.pop_front();
+    }
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cuda_runtime_api.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Kinds of plugins timed by the PluginTimer.
+enum class PluginKind : std::uint8_t
+{
+    kATTENTION = 0,
+    kGEMM = 1,
+    kALL_REDUCE = 2,
+    kMOE = 3,
+};
+
+[[nodiscard]] char const* toString(PluginKind kind) noexcept;
+
+//! \brief GPU time of the plugins of a kind, over the sampled engine executions.
+struct PluginTimingStats
+{
+    std::uint64_t numLaunches{0};
+    double totalMs{0};
+    double maxMs{0};
+};
+
+//! \brief Sampled GPU timing of the plugins, cheap enough to stay on with live traffic.
+//! \details Unlike the LayerProfiler, which relies on the synchronous IProfiler of TensorRT, every Nth engine execution
+//! is sampled and the enqueue of the attention, GEMM, all reduce and MoE plugins of the sampled executions is bracketed
+//! with CUDA events. Nothing synchronizes: the events are read once they completed, when the next execution starts or
+//! the stats are read. Other executions only pay an atomic load per plugin. Launches captured into a CUDA graph are not
+//! timed, as events can't be timed inside of a graph.
+class PluginTimer
+{
+public:
+    static constexpr std::size_t kNumKinds = 4;
+    //! Events in flight at most, further launches are not timed until they complete
+    static constexpr std::size_t kMaxPending = 4096;
+
+    using Stats = std::array<PluginTimingStats, kNumKinds>;
+
+    //! \brief Times the plugin launches enqueued on stream during its lifetime, if the execution is sampled.
+    class Scope
+    {
+    public:
+        Scope(PluginTimer& timer, PluginKind kind, cudaStream_t stream) noexcept;
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        ~Scope() noexcept;
+
+    private:
+        PluginTimer& mTimer;
+        PluginKind mKind;
+        cudaStream_t mStream;
+        cudaEvent_t mStart{nullptr};
+    };
+
+    //! \brief Process wide timer with the interval of TRTLLM_PLUGIN_TIMING_INTERVAL, shared by all the engines.
+    static PluginTimer& getInstance();
+
+    //! \param interval Every how many executions are timed, 0 disables the timing.
+    explicit PluginTimer(SizeType32 interval);
+
+    ~PluginTimer();
+
+    PluginTimer(PluginTimer const&) = delete;
+    PluginTimer& operator=(PluginTimer const&) = delete;
+
+    //! \brief Called before an engine execution is enqueued, decides whether it's sampled.
+    void beginExecution();
+
+    [[nodiscard]] bool isSampling() const noexcept
+    {
+        return mSampling.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] Scope scope(PluginKind kind, cudaStream_t stream) noexcept
+    {
+        return Scope{*this, kind, stream};
+    }
+
+    //! \brief The stats of the completed launches since the construction. Doesn't wait for the launches in flight.
+    [[nodiscard]] Stats getStats();
+
+    //! \returns The number of sampled executions, to get the time per execution from the stats.
+    [[nodiscard]] std::uint64_t getNumSampledExecutions() const noexcept
+    {
+        return mNumSampled.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct PendingLaunch
+    {
+        PluginKind kind;
+        cudaEvent_t start;
+        cudaEvent_t stop;
+    };
+
+    //! \returns An event from the pool, or nullptr if too many launches are in flight or the creation failed.
+    cudaEvent_t acquireEvent();
+
+    void releaseEvent(cudaEvent_t event);
+
+    void addPending(PluginKind kind, cudaEvent_t start, cudaEvent_t stop);
+
+    //! \brief Accumulates the launches whose events completed, in order. Needs mMutex.
+    void collectCompleted();
+
+    SizeType32 mInterval;
+    std::atomic<std::uint64_t> mNumExecutions{0};
+    std::atomic<std::uint64_t> mNumSampled{0};
+    std::atomic<bool> mSampling{false};
+
+    std::mutex mMutex;
+    std::deque<PendingLaunch> mPending;
+    std::vector<cudaEvent_t> mFreeEvents;
+    std::size_t mNumEvents{0};
+    Stats mStats{};
+};
+
+} // namespace tensorrt_llm::runtime
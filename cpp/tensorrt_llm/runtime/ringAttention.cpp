@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/ringAttention.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/kernels/ringAttentionKernels.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+template <typename T>
+void invokeStep(ITensor const& q, IBuffer const& kv, SizeType32 const* qPositions, SizeType32 const* kvPositions,
+    SizeType32 numKvTokens, std::size_t vOffset, float* accOut, float* accLse, SizeType32 numHeads,
+    SizeType32 numKvHeads, SizeType32 headSize, float qkScale, cudaStream_t stream)
+{
+    tk::RingAttentionStepParams<T> params{};
+    params.q = bufferCast<T>(q);
+    params.q_positions = qPositions;
+    params.k = bufferCast<T>(kv);
+    params.v = bufferCast<T>(kv) + vOffset;
+    params.kv_positions = kvPositions;
+    params.acc_out = accOut;
+    params.acc_lse = accLse;
+    params.num_q_tokens = static_cast<int>(q.getShape().d[0]);
+    params.num_kv_tokens = numKvTokens;
+    params.num_heads = numHeads;
+    params.num_kv_heads = numKvHeads;
+    params.head_size = headSize;
+    params.qk_scale = qkScale;
+    params.causal = true;
+    tk::invokeRingAttentionStep(params, stream);
+}
+} // namespace
+
+RingAttention::RingAttention(std::shared_ptr<NcclCommunicator> comm, SizeType32 cpRank, ContextParallelPlan const& plan,
+    SizeType32 numHeads, SizeType32 numKvHeads, SizeType32 headSize, nvinfer1::DataType dataType,
+    BufferManager const& manager)
+    : mComm{std::move(comm)}
+    , mCpRank{cpRank}
+    , mPlan{plan}
+    , mNumHeads{numHeads}
+    , mNumKvHeads{numKvHeads}
+    , mHeadSize{headSize}
+    , mDataType{dataType}
+    , mManager{manager}
+    , mMaxNumTokens{plan.getMaxNumTokens()}
+{
+    TLLM_CHECK_WITH_INFO(mComm != nullptr || mPlan.getCpSize() == 1, "Ring attention needs a communicator.");
+    TLLM_CHECK_WITH_INFO(mDataType == nvinfer1::DataType::kFLOAT || mDataType == nvinfer1::DataType::kHALF
+            || mDataType == nvinfer1::DataType::kBF16,
+        "Ring attention supports float, half and bfloat16.");
+
+    auto const kvSize = 2 * static_cast<std::size_t>(mMaxNumTokens) * mNumKvHeads * mHeadSize;
+    for (auto& kv : mKv)
+    {
+        kv = mManager.gpu(kvSize, mDataType);
+    }
+
+    auto const cpSize = mPlan.getCpSize();
+    std::vector<SizeType32> positions(static_cast<std::size_t>(cpSize) * mMaxNumTokens, 0);
+    for (SizeType32 rank = 0; rank < cpSize; ++rank)
+    {
+        auto const rankPositions = mPlan.getPositions(rank);
+        std::copy(rankPositions.begin(), rankPositions.end(), positions.begin() + rank * mMaxNumTokens);
+    }
+    mPositions = mManager.copyFrom(positions, ITensor::makeShape({cpSize, mMaxNumTokens}), MemoryType::kGPU);
+
+    auto const numTokens = mPlan.getNumTokens(mCpRank);
+    mAccOut = mManager.gpu(static_cast<std::size_t>(numTokens) * mNumHeads * mHeadSize, nvinfer1::DataType::kFLOAT);
+    mAccLse = mManager.gpu(static_cast<std::size_t>(numTokens) * mNumHeads, nvinfer1::DataType::kFLOAT);
+}
+
+void RingAttention::forward(ITensor const& q, ITensor const& k, ITensor const& v, ITensor& out, float qkScale)
+{
+    auto const numTokens = mPlan.getNumTokens(mCpRank);
+    auto const kvSize = static_cast<std::size_t>(numTokens) * mNumKvHeads * mHeadSize;
+    TLLM_CHECK_WITH_INFO(q.getSize() == mAccOut->getSize() && out.getSize() == mAccOut->getSize(),
+        "The queries and the output must hold the %d tokens of rank %d.", numTokens, mCpRank);
+    TLLM_CHECK_WITH_INFO(k.getSize() == kvSize && v.getSize() == kvSize,
+        "K and V must hold the %d tokens of rank %d.", numTokens, mCpRank);
+    TLLM_CHECK(q.getDataType() == mDataType && k.getDataType() == mDataType && v.getDataType() == mDataType
+        && out.getDataType() == mDataType);
+
+    auto const& stream = mManager.getStream();
+    auto const vOffset = static_cast<std::size_t>(mMaxNumTokens) * mNumKvHeads * mHeadSize;
+    mManager.copy(k, *IBuffer::slice(mKv[0], 0, kvSize));
+    mManager.copy(v, *IBuffer::slice(mKv[0], vOffset, kvSize));
+    tk::invokeRingAttentionInit(
+        bufferCast<float>(*mAccOut), bufferCast<float>(*mAccLse), numTokens, mNumHeads, mHeadSize, stream.get());
+
+    auto const cpSize = mPlan.getCpSize();
+    for (SizeType32 step = 0; step < cpSize; ++step)
+    {
+        auto const& held = *mKv[step % 2];
+        auto& next = *mKv[(step + 1) % 2];
+        auto const exchange = step + 1 < cpSize;
+        if (exchange)
+        {
+            // The share held is complete and the attention over the other buffer, at the previous step, is enqueued
+            stream.record(mReadyEvent);
+            mCommStream.wait(mReadyEvent);
+            mComm->sendReceive(held, mPlan.getNextRank(mCpRank), next, mPlan.getPrevRank(mCpRank), mCommStream);
+            mCommStream.record(mReceivedEvent);
+        }
+        enqueueStep(q, held, mPlan.getSourceRank(mCpRank, step), qkScale);
+        if (exchange)
+        {
+            stream.wait(mReceivedEvent);
+        }
+    }
+
+    auto const* accOut = bufferCast<float>(*mAccOut);
+    switch (mDataType)
+    {
+    case nvinfer1::DataType::kFLOAT:
+        tk::invokeRingAttentionFinalize(bufferCast<float>(out), accOut, out.getSize(), stream.get());
+        break;
+    case nvinfer1::DataType::kHALF:
+        tk::invokeRingAttentionFinalize(bufferCast<half>(out), accOut, out.getSize(), stream.get());
+        break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16:
+        tk::invokeRingAttentionFinalize(bufferCast<__nv_bfloat16>(out), accOut, out.getSize(), stream.get());
+        break;
+#endif
+    default: TLLM_THROW("Unsupported data type for ring attention");
+    }
+}
+
+void RingAttention::enqueueStep(ITensor const& q, IBuffer const& kv, SizeType32 sourceRank, float qkScale)
+{
+    auto const* positions = bufferCast<SizeType32>(*mPositions);
+    auto const* qPositions = positions + static_cast<std::size_t>(mCpRank) * mMaxNumTokens;
+    auto const* kvPositions = positions + static_cast<std::size_t>(sourceRank) * mMaxNumTokens;
+    auto const numKvTokens = mPlan.getNumTokens(sourceRank);
+    auto const vOffset = static_cast<std::size_t>(mMaxNumTokens) * mNumKvHeads * mHeadSize;
+    auto* accOut = bufferCast<float>(*mAccOut);
+    auto* accLse = bufferCast<float>(*mAccLse);
+    auto const stream = mManager.getStream().get();
+
+    switch (mDataType)
+    {
+    case nvinfer1::DataType::kFLOAT:
+        invokeStep<float>(q, kv, qPositions, kvPositions, numKvTokens, vOffset, accOut, accLse, mNumHeads, mNumKvHeads,
+            mHeadSize, qkScale, stream);
+        break;
+    case nvinfer1::DataType::kHALF:
+        invokeStep<half>(q, kv, qPositions, kvPositions, numKvTokens, vOffset, accOut, accLse, mNumHeads, mNumKvHeads,
+            mHeadSize, qkScale, stream);
+        break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16:
+        invokeStep<__nv_bfloat16>(q, kv, qPositions, kvPositions, numKvTokens, vOffset, accOut, accLse, mNumHeads,
+            mNumKvHeads, mHeadSize, qkScale, stream);
+        break;
+#endif
+    default: TLLM_THROW("Unsupported data type for ring attention");
+    }
+}
+
+} // namespace tensorrt_llm::runtime
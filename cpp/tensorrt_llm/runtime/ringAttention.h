@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/contextParallelPlan.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/ncclCommunicator.h"
+
+#include <array>
+#include <memory>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Context parallel attention of the prefill of one long prompt, split across the ranks of the communicator
+//! as planned by ContextParallelPlan.
+//! \details Every rank holds the queries and the KV of its share of the prompt. The KV shares are passed around the
+//! ring on a stream of their own while each rank attends its queries over the share received at the previous step,
+//! so the exchange is hidden behind the attention. The partial results are merged online with their log-sum-exp.
+//! The KV of a share stays with its rank, e.g. to be stored in the paged KV cache of the rank.
+class RingAttention
+{
+public:
+    using TensorPtr = ITensor::SharedPtr;
+
+    RingAttention(std::shared_ptr<NcclCommunicator> comm, SizeType32 cpRank, ContextParallelPlan const& plan,
+        SizeType32 numHeads, SizeType32 numKvHeads, SizeType32 headSize, nvinfer1::DataType dataType,
+        BufferManager const& manager);
+
+    //! \brief Causal attention of the queries of this rank over the whole prompt, enqueued on the stream of the
+    //! manager.
+    //! \param q [numTokens, numHeads, headSize], the share of this rank with the rotary embedding applied.
+    //! \param k [numTokens, numKvHeads, headSize]
+    //! \param v [numTokens, numKvHeads, headSize]
+    //! \param out [numTokens, numHeads, headSize]
+    void forward(ITensor const& q, ITensor const& k, ITensor const& v, ITensor& out, float qkScale);
+
+    [[nodiscard]] ContextParallelPlan const& getPlan() const noexcept
+    {
+        return mPlan;
+    }
+
+private:
+    void enqueueStep(ITensor const& q, IBuffer const& kv, SizeType32 sourceRank, float qkScale);
+
+    std::shared_ptr<NcclCommunicator> mComm;
+    SizeType32 mCpRank;
+    ContextParallelPlan mPlan;
+    SizeType32 mNumHeads;
+    SizeType32 mNumKvHeads;
+    SizeType32 mHeadSize;
+    nvinfer1::DataType mDataType;
+    BufferManager mManager;
+
+    SizeType32 mMaxNumTokens;
+    //! The K and V of the share held at a step and of the share received for the next one, [2, maxNumTokens,
+    //! numKvHeads, headSize] each
+    std::array<IBuffer::SharedPtr, 2> mKv;
+    //! [cpSize, maxNumTokens], the positions of the tokens of each rank
+    TensorPtr mPositions;
+    //! [numTokens, numHeads, headSize] and [numTokens, numHeads]
+    IBuffer::SharedPtr mAccOut;
+    IBuffer::SharedPtr mAccLse;
+
+    CudaStream mCommStream;
+    CudaEvent mReadyEvent;
+    CudaEvent mReceivedEvent;
+};
+
+} // namespace tensorrt_llm::runtime
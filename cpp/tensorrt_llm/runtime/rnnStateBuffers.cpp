@@ -30,6 +30,8 @@ RnnStateBuffers::RnnStateBuffers()
     slotMappingDevice = nullptr;
     rnnStatePtrs = nullptr;
     convStatePtrs = nullptr;
+    rnnStateCheckpoints = nullptr;
+    convStateCheckpoints = nullptr;
 }
 
 RnnStateBuffers::RnnStateBuffers(
@@ -72,6 +74,21 @@ RnnStateBuffers::RnnStateBuffers(
     convStates = bufferManager.gpu(convStatesShape, dType);
     convStatesAlt = bufferManager.gpu(convStatesShape, dType);
 
+    // Only the Mamba conv1d and selective scan plugins write checkpoints
+    if (modelConfig.hasSpeculativeDecodingModule() && mUseMambaConv1dPlugin && !isRecurrentGemma)
+    {
+        mMaxPathLen = modelConfig.getSpeculativeDecodingModule().getMaxPathLen();
+        rnnStateCheckpoints = bufferManager.gpu(
+            ITensor::makeShape({localNbLayers * maxBatchBeam, mMaxPathLen, mStateSize, mRnnHiddenSize}), stateDType);
+        convStateCheckpoints = bufferManager.gpu(
+            ITensor::makeShape({localNbLayers * maxBatchBeam, mMaxPathLen, mConvKernel - 1, mRnnHiddenSize}), dType);
+    }
+    else
+    {
+        rnnStateCheckpoints = nullptr;
+        convStateCheckpoints = nullptr;
+    }
+
     if (modelConfig.usePagedState())
     {
         auto slotMappingShape = ITensor::makeShape({maxBatchSize});
@@ -124,6 +141,20 @@ void RnnStateBuffers::reshape(SizeType32 batchSize)
         convState[i] = tensorrt_llm::runtime::ITensor::slice(convStates, offset, batchSize * mMaxBeamWidth);
         convStateAlt[i] = tensorrt_llm::runtime::ITensor::slice(convStatesAlt, offset, batchSize * mMaxBeamWidth);
     }
+    if (rnnStateCheckpoints != nullptr)
+    {
+        auto const numRows = mLocalNbLayers * batchSize * mMaxBeamWidth;
+        rnnStateCheckpoints->reshape(ITensor::makeShape({numRows, mMaxPathLen, mStateSize, mRnnHiddenSize}));
+        convStateCheckpoints->reshape(ITensor::makeShape({numRows, mMaxPathLen, mConvKernel - 1, mRnnHiddenSize}));
+        rnnStateCheckpoint.resize(mLocalNbLayers);
+        convStateCheckpoint.resize(mLocalNbLayers);
+        for (int i = 0; i < mLocalNbLayers; i++)
+        {
+            size_t offset = batchSize * mMaxBeamWidth * i;
+            rnnStateCheckpoint[i] = ITensor::slice(rnnStateCheckpoints, offset, batchSize * mMaxBeamWidth);
+            convStateCheckpoint[i] = ITensor::slice(convStateCheckpoints, offset, batchSize * mMaxBeamWidth);
+        }
+    }
     if (slotMappingDevice != nullptr)
     {
         TLLM_CHECK(slotMappingHost != nullptr);
@@ -343,3 +374,25 @@ void RnnStateBuffers::getRuntimeBuffers(RuntimeBuffers const* runtimeBuffers, Te
     inputBuffers.insert_or_assign("host_context_lengths", runtimeBuffers->contextLengthsHost);
     TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
 }
+
+void RnnStateBuffers::acceptDraftTokens(std::vector<SizeType32> const& numAcceptedTokens, BufferManager const& manager)
+{
+    TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
+    TLLM_CHECK_WITH_INFO(hasStateCheckpoints(), "RnnStateBuffers have no state checkpoints.");
+    auto const batchBeam = static_cast<SizeType32>(rnnState.front()->getShape().d[0]);
+    TLLM_CHECK(static_cast<SizeType32>(numAcceptedTokens.size()) == batchBeam);
+    for (int layer = 0; layer < mLocalNbLayers; layer++)
+    {
+        for (SizeType32 b = 0; b < batchBeam; b++)
+        {
+            auto const numAccepted = numAcceptedTokens[b];
+            TLLM_CHECK_WITH_INFO(numAccepted > 0 && numAccepted <= mMaxPathLen,
+                "Number of accepted tokens %d out of [1, %d].", numAccepted, mMaxPathLen);
+            manager.copy(*ITensor::slice(rnnStateCheckpoint[layer], {b, numAccepted - 1}, 1),
+                *ITensor::slice(rnnState[layer], b, 1));
+            manager.copy(*ITensor::slice(convStateCheckpoint[layer], {b, numAccepted - 1}, 1),
+                *ITensor::slice(convState[layer], b, 1));
+        }
+    }
+    TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
+}
@@ -51,6 +51,13 @@ public:
     std::vector<TensorPtr> rnnStatePtr;  // [1]
     std::vector<TensorPtr> convStatePtr; // [1]
 
+    // Speculative decoding, states after each token of the generation step
+    TensorPtr rnnStateCheckpoints;               // [layer_count * batch_beam, max_path_len, state_size, hidden]
+    TensorPtr convStateCheckpoints;              // [layer_count * batch_beam, max_path_len, conv_kernel - 1, hidden]
+
+    std::vector<TensorPtr> rnnStateCheckpoint;   // [batch_beam, max_path_len, state_size, rnn_hidden_size]
+    std::vector<TensorPtr> convStateCheckpoint;  // [batch_beam, max_path_len, conv_kernel - 1, rnn_hidden_size]
+
     RnnStateBuffers();
 
     RnnStateBuffers(
@@ -73,6 +80,18 @@ public:
         SizeType32 const step, TensorPtr const& inputIds, ModelConfig const& modelConfig,
         WorldConfig const& worldConfig) const;
 
+    //! \brief Speculative decoding. SSM states can't be rewound like the KV cache, so the generation step leaves the
+    //! states unchanged and writes the state after each of its tokens, the new token and its linear chain of draft
+    //! tokens, to the checkpoints. This copies the checkpoint of the last accepted token into the states.
+    //! \param numAcceptedTokens Per sequence, number of accepted tokens of the step including the new token, in
+    //! [1, max_path_len].
+    void acceptDraftTokens(std::vector<SizeType32> const& numAcceptedTokens, BufferManager const& manager);
+
+    [[nodiscard]] bool hasStateCheckpoints() const noexcept
+    {
+        return rnnStateCheckpoints != nullptr;
+    }
+
 protected:
     void tile(RuntimeBuffers* runtimeBuffers, BufferManager& manager, ModelConfig const& modelConfig,
         WorldConfig const& worldConfig);
@@ -86,6 +105,7 @@ private:
 
     int mLocalNbLayers = 0;
     int mMaxBeamWidth = 0;
+    SizeType32 mMaxPathLen = 0;
 
     bool mUseMambaConv1dPlugin = true;
 
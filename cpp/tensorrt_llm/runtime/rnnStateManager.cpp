@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/rnnStateManager.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/utils/sessionUtils.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+RnnStateManager::RnnStateManager(SizeType32 maxNumSlots, ModelConfig const& modelConfig,
+    WorldConfig const& worldConfig, BufferManager::CudaStreamPtr stream)
+    : mMaxNumSlots{maxNumSlots}
+    , mLocalNbLayers{modelConfig.getNbRnnLayers(worldConfig.getPipelineParallelism())}
+    , mBufferManager{std::move(stream)}
+{
+    TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
+    TLLM_CHECK(modelConfig.isRnnBased());
+    TLLM_CHECK_WITH_INFO(modelConfig.usePagedState(), "The state manager requires the paged state plugins.");
+    auto const rnnConfig = modelConfig.getRnnConfig();
+    TLLM_CHECK_WITH_INFO(rnnConfig.has_value(), "RnnStateManager should be used with rnnConfig.");
+    TLLM_CHECK_WITH_INFO(maxNumSlots > 0, "The state manager needs at least one slot.");
+
+    auto const numRows = mLocalNbLayers * mMaxNumSlots;
+    auto const dType = modelConfig.getDataType();
+    auto const isRecurrentGemma = modelConfig.getModelVariant() == ModelConfig::ModelVariant::kRecurrentGemma;
+    auto const stateDType = isRecurrentGemma ? nvinfer1::DataType::kFLOAT : dType;
+    mRnnStates = mBufferManager.gpu(
+        ITensor::makeShape({numRows, rnnConfig->stateSize, rnnConfig->rnnHiddenSize}), stateDType);
+    // Same size with either layout of the conv plugin
+    mConvStates = mBufferManager.gpu(
+        ITensor::makeShape({numRows, rnnConfig->convKernel - 1, rnnConfig->rnnHiddenSize}), dType);
+
+    auto const statePtrsShape = ITensor::makeShape({mLocalNbLayers});
+    mRnnStatePtrs = BufferManager::cpu(statePtrsShape, nvinfer1::DataType::kINT64);
+    mConvStatePtrs = BufferManager::cpu(statePtrsShape, nvinfer1::DataType::kINT64);
+    auto* rnnStatePtrArray = static_cast<void**>(mRnnStatePtrs->data());
+    auto* convStatePtrArray = static_cast<void**>(mConvStatePtrs->data());
+    for (SizeType32 layer = 0; layer < mLocalNbLayers; ++layer)
+    {
+        rnnStatePtrArray[layer] = slotView(mRnnStates, layer, 0)->data();
+        convStatePtrArray[layer] = slotView(mConvStates, layer, 0)->data();
+        mRnnStatePtr.push_back(ITensor::slice(mRnnStatePtrs, layer, 1));
+        mConvStatePtr.push_back(ITensor::slice(mConvStatePtrs, layer, 1));
+    }
+
+    // Lowest slots are handed out first
+    mFreeSlots.resize(mMaxNumSlots);
+    for (SizeType32 slot = 0; slot < mMaxNumSlots; ++slot)
+    {
+        mFreeSlots[slot] = mMaxNumSlots - 1 - slot;
+    }
+    TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
+}
+
+SizeType32 RnnStateManager::addRequest(RequestIdType requestId)
+{
+    TLLM_CHECK_WITH_INFO(mRequestSlots.find(requestId) == mRequestSlots.end() && !isOffloaded(requestId),
+        "Request %lu already has a state.", requestId);
+    auto const slot = claimSlot();
+    zeroSlot(slot);
+    mRequestSlots.emplace(requestId, slot);
+    return slot;
+}
+
+void RnnStateManager::removeRequest(RequestIdType requestId)
+{
+    if (auto const it = mRequestSlots.find(requestId); it != mRequestSlots.end())
+    {
+        releaseSlot(it->second);
+        mRequestSlots.erase(it);
+        return;
+    }
+    TLLM_CHECK_WITH_INFO(mOffloaded.erase(requestId) > 0, "Request %lu has no state.", requestId);
+}
+
+std::optional<SizeType32> RnnStateManager::getSlot(RequestIdType requestId) const
+{
+    auto const it = mRequestSlots.find(requestId);
+    return it == mRequestSlots.end() ? std::nullopt : std::make_optional(it->second);
+}
+
+void RnnStateManager::offloadRequest(RequestIdType requestId)
+{
+    auto const slot = getSlotOrThrow(requestId);
+    auto const rnnShape = mRnnStates->getShape();
+    auto const convShape = mConvStates->getShape();
+    HostStates host{
+        BufferManager::pinned(
+            ITensor::makeShape({mLocalNbLayers, rnnShape.d[1], rnnShape.d[2]}), mRnnStates->getDataType()),
+        BufferManager::pinned(
+            ITensor::makeShape({mLocalNbLayers, convShape.d[1], convShape.d[2]}), mConvStates->getDataType())};
+    copySlotToHost(slot, host);
+    // The slot can be reused by copies enqueued after the offload on the same stream
+    releaseSlot(slot);
+    mRequestSlots.erase(requestId);
+    mOffloaded.emplace(requestId, std::move(host));
+}
+
+SizeType32 RnnStateManager::onboardRequest(RequestIdType requestId)
+{
+    auto const it = mOffloaded.find(requestId);
+    TLLM_CHECK_WITH_INFO(it != mOffloaded.end(), "Request %lu is not offloaded.", requestId);
+    auto const slot = claimSlot();
+    copyHostToSlot(it->second, slot);
+    // The pinned copy is released once the copy to the slot is done
+    mBufferManager.getStream().synchronize();
+    mOffloaded.erase(it);
+    mRequestSlots.emplace(requestId, slot);
+    return slot;
+}
+
+bool RnnStateManager::isOffloaded(RequestIdType requestId) const
+{
+    return mOffloaded.find(requestId) != mOffloaded.end();
+}
+
+void RnnStateManager::saveSnapshot(SnapshotKeyType key, RequestIdType requestId)
+{
+    auto const requestSlot = getSlotOrThrow(requestId);
+    SizeType32 snapshotSlot{0};
+    if (auto const it = mSnapshots.find(key); it != mSnapshots.end())
+    {
+        snapshotSlot = it->second->second;
+        mSnapshotLru.erase(it->second);
+        mSnapshots.erase(it);
+    }
+    else
+    {
+        snapshotSlot = claimSlot();
+    }
+    copySlot(requestSlot, snapshotSlot);
+    mSnapshotLru.emplace_front(key, snapshotSlot);
+    mSnapshots.emplace(key, mSnapshotLru.begin());
+}
+
+bool RnnStateManager::restoreSnapshot(SnapshotKeyType key, RequestIdType requestId)
+{
+    auto const requestSlot = getSlotOrThrow(requestId);
+    auto const it = mSnapshots.find(key);
+    if (it == mSnapshots.end())
+    {
+        return false;
+    }
+    mSnapshotLru.splice(mSnapshotLru.begin(), mSnapshotLru, it->second);
+    copySlot(it->second->second, requestSlot);
+    return true;
+}
+
+bool RnnStateManager::dropSnapshot(SnapshotKeyType key)
+{
+    auto const it = mSnapshots.find(key);
+    if (it == mSnapshots.end())
+    {
+        return false;
+    }
+    releaseSlot(it->second->second);
+    mSnapshotLru.erase(it->second);
+    mSnapshots.erase(it);
+    return true;
+}
+
+bool RnnStateManager::hasSnapshot(SnapshotKeyType key) const
+{
+    return mSnapshots.find(key) != mSnapshots.end();
+}
+
+void RnnStateManager::fillSlotMapping(ITensor& slotMapping, std::vector<RequestIdType> const& requestIds) const
+{
+    TLLM_CHECK(slotMapping.getDataType() == nvinfer1::DataType::kINT32);
+    TLLM_CHECK_WITH_INFO(slotMapping.getSize() == requestIds.size(), "Slot mapping of size %zu for %zu requests.",
+        slotMapping.getSize(), requestIds.size());
+    auto* slots = bufferCast<std::int32_t>(slotMapping);
+    for (std::size_t i = 0; i < requestIds.size(); ++i)
+    {
+        slots[i] = getSlotOrThrow(requestIds[i]);
+    }
+}
+
+void RnnStateManager::getPtrBuffers(
+    TensorMap& inputBuffers, ModelConfig const& modelConfig, WorldConfig const& worldConfig) const
+{
+    auto const firstLayerId = worldConfig.getPipelineParallelRank() * mLocalNbLayers;
+    auto const& layerTypes = modelConfig.getLayerTypes();
+    utils::insertTensorVector(inputBuffers, "conv_state_ptr_", mConvStatePtr, firstLayerId, layerTypes,
+        ModelConfig::LayerType::kRECURRENT);
+    utils::insertTensorVector(
+        inputBuffers, "rnn_state_ptr_", mRnnStatePtr, firstLayerId, layerTypes, ModelConfig::LayerType::kRECURRENT);
+}
+
+SizeType32 RnnStateManager::claimSlot()
+{
+    if (mFreeSlots.empty() && !mSnapshotLru.empty())
+    {
+        auto const [key, slot] = mSnapshotLru.back();
+        TLLM_LOG_DEBUG("Evicting the state snapshot %lu to free slot %d.", key, slot);
+        mSnapshots.erase(key);
+        mSnapshotLru.pop_back();
+        return slot;
+    }
+    TLLM_CHECK_WITH_INFO(!mFreeSlots.empty(), "All %d state slots are in use.", mMaxNumSlots);
+    auto const slot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+    return slot;
+}
+
+void RnnStateManager::releaseSlot(SizeType32 slot)
+{
+    mFreeSlots.push_back(slot);
+}
+
+SizeType32 RnnStateManager::getSlotOrThrow(RequestIdType requestId) const
+{
+    auto const it = mRequestSlots.find(requestId);
+    TLLM_CHECK_WITH_INFO(it != mRequestSlots.end(), "Request %lu has no state slot.", requestId);
+    return it->second;
+}
+
+ITensor::SharedPtr RnnStateManager::slotView(TensorPtr const& pool, SizeType32 layer, SizeType32 slot) const
+{
+    return ITensor::slice(pool, layer * mMaxNumSlots + slot, 1);
+}
+
+void RnnStateManager::zeroSlot(SizeType32 slot) const
+{
+    for (SizeType32 layer = 0; layer < mLocalNbLayers; ++layer)
+    {
+        mBufferManager.setZero(*slotView(mRnnStates, layer, slot));
+        mBufferManager.setZero(*slotView(mConvStates, layer, slot));
+    }
+}
+
+void RnnStateManager::copySlot(SizeType32 srcSlot, SizeType32 dstSlot) const
+{
+    for (SizeType32 layer = 0; layer < mLocalNbLayers; ++layer)
+    {
+        mBufferManager.copy(*slotView(mRnnStates, layer, srcSlot), *slotView(mRnnStates, layer, dstSlot));
+        mBufferManager.copy(*slotView(mConvStates, layer, srcSlot), *slotView(mConvStates, layer, dstSlot));
+    }
+}
+
+void RnnStateManager::copySlotToHost(SizeType32 slot, HostStates const& host) const
+{
+    for (SizeType32 layer = 0; layer < mLocalNbLayers; ++layer)
+    {
+        mBufferManager.copy(*slotView(mRnnStates, layer, slot), *ITensor::slice(host.rnnStates, layer, 1));
+        mBufferManager.copy(*slotView(mConvStates, layer, slot), *ITensor::slice(host.convStates, layer, 1));
+    }
+}
+
+void RnnStateManager::copyHostToSlot(HostStates const& host, SizeType32 slot) const
+{
+    for (SizeType32 layer = 0; layer < mLocalNbLayers; ++layer)
+    {
+        mBufferManager.copy(*ITensor::slice(host.rnnStates, layer, 1), *slotView(mRnnStates, layer, slot));
+        mBufferManager.copy(*ITensor::slice(host.convStates, layer, 1), *slotView(mConvStates, layer, slot));
+    }
+}
+
+} // namespace tensorrt_llm::runtime
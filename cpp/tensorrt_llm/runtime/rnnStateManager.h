@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/modelConfig.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+/**
+ * \brief Pool of SSM and conv state slots for Mamba and RecurrentGemma with in-flight batching, the recurrent
+ * counterpart of the KV cache manager.
+ * \details The states of all local recurrent layers live in two device pools of maxNumSlots slots per layer, laid out
+ * as [layer_count * max_num_slots, ...] so that the per-layer pointers and the slot_mapping input of the paged state
+ * plugins index into them directly. Requests get a slot when they are added and return it when they finish, instead
+ * of owning a row of a tensor sized to the maximum batch.
+ *
+ * Idle requests can be offloaded to pinned host memory to free their slot and onboarded again later. The state after
+ * a shared prefix, e.g. a common system prompt, can be kept as a snapshot in a slot of its own and copied into the
+ * slot of a new request, which then only scans the rest of its prompt. The caller has to take the snapshot when the
+ * request is exactly at the end of the prefix, e.g. after a context chunk that ends there. Snapshots are evicted least
+ * recently used first when a request needs a slot.
+ *
+ * All copies are enqueued on the stream of the manager.
+ */
+class RnnStateManager
+{
+public:
+    using TensorPtr = ITensor::SharedPtr;
+    using TensorMap = StringPtrMap<ITensor>;
+    using RequestIdType = std::uint64_t;
+    using SnapshotKeyType = std::uint64_t;
+
+    RnnStateManager(SizeType32 maxNumSlots, ModelConfig const& modelConfig, WorldConfig const& worldConfig,
+        BufferManager::CudaStreamPtr stream);
+
+    //! \brief Assigns a zeroed slot to a new request, evicting a snapshot if none is free.
+    //! \returns The slot of the request.
+    SizeType32 addRequest(RequestIdType requestId);
+
+    //! \brief Returns the slot, or the host copy, of a finished request.
+    void removeRequest(RequestIdType requestId);
+
+    //! \returns The slot of the request, std::nullopt if it has none or is offloaded.
+    [[nodiscard]] std::optional<SizeType32> getSlot(RequestIdType requestId) const;
+
+    //! \brief Copies the states of the request to host and frees its slot.
+    void offloadRequest(RequestIdType requestId);
+
+    //! \brief Copies the states of an offloaded request back into a slot.
+    //! \returns The new slot of the request.
+    SizeType32 onboardRequest(RequestIdType requestId);
+
+    [[nodiscard]] bool isOffloaded(RequestIdType requestId) const;
+
+    //! \brief Keeps a copy of the current states of the request under key, replacing a previous snapshot of key.
+    void saveSnapshot(SnapshotKeyType key, RequestIdType requestId);
+
+    //! \brief Copies the snapshot of key into the slot of the request.
+    //! \returns False if there is no snapshot of key.
+    bool restoreSnapshot(SnapshotKeyType key, RequestIdType requestId);
+
+    //! \returns False if there is no snapshot of key.
+    bool dropSnapshot(SnapshotKeyType key);
+
+    [[nodiscard]] bool hasSnapshot(SnapshotKeyType key) const;
+
+    //! \brief Writes the slots of requestIds, in batch order, to the host slot_mapping tensor of shape [batch_size].
+    void fillSlotMapping(ITensor& slotMapping, std::vector<RequestIdType> const& requestIds) const;
+
+    //! \brief Inserts the per-layer state pointer inputs of the paged state plugins.
+    void getPtrBuffers(TensorMap& inputBuffers, ModelConfig const& modelConfig, WorldConfig const& worldConfig) const;
+
+    [[nodiscard]] SizeType32 getMaxNumSlots() const noexcept
+    {
+        return mMaxNumSlots;
+    }
+
+    [[nodiscard]] SizeType32 getNumFreeSlots() const noexcept
+    {
+        return static_cast<SizeType32>(mFreeSlots.size());
+    }
+
+    [[nodiscard]] SizeType32 getNumSnapshots() const noexcept
+    {
+        return static_cast<SizeType32>(mSnapshots.size());
+    }
+
+    //! \returns The device pool of the SSM states.
+    [[nodiscard]] TensorPtr getRnnStates() const
+    {
+        return mRnnStates;
+    }
+
+    //! \returns The device pool of the conv states.
+    [[nodiscard]] TensorPtr getConvStates() const
+    {
+        return mConvStates;
+    }
+
+private:
+    struct HostStates
+    {
+        TensorPtr rnnStates;  // [layer_count, state_size, rnn_hidden_size]
+        TensorPtr convStates; // [layer_count, conv_kernel - 1, rnn_hidden_size]
+    };
+
+    using SnapshotList = std::list<std::pair<SnapshotKeyType, SizeType32>>;
+
+    SizeType32 claimSlot();
+    void releaseSlot(SizeType32 slot);
+    [[nodiscard]] SizeType32 getSlotOrThrow(RequestIdType requestId) const;
+
+    void zeroSlot(SizeType32 slot) const;
+    void copySlot(SizeType32 srcSlot, SizeType32 dstSlot) const;
+    void copySlotToHost(SizeType32 slot, HostStates const& host) const;
+    void copyHostToSlot(HostStates const& host, SizeType32 slot) const;
+
+    //! \returns The view of layer of slot in pool.
+    [[nodiscard]] TensorPtr slotView(TensorPtr const& pool, SizeType32 layer, SizeType32 slot) const;
+
+    SizeType32 mMaxNumSlots;
+    SizeType32 mLocalNbLayers;
+    BufferManager mBufferManager;
+
+    TensorPtr mRnnStates;                 // [layer_count * max_num_slots, state_size, rnn_hidden_size]
+    TensorPtr mConvStates;                // [layer_count * max_num_slots, conv_kernel - 1, rnn_hidden_size]
+    TensorPtr mRnnStatePtrs;              // [layer_count]
+    TensorPtr mConvStatePtrs;             // [layer_count]
+    std::vector<TensorPtr> mRnnStatePtr;  // [1]
+    std::vector<TensorPtr> mConvStatePtr; // [1]
+
+    std::vector<SizeType32> mFreeSlots;
+    std::unordered_map<RequestIdType, SizeType32> mRequestSlots;
+    std::unordered_map<RequestIdType, HostStates> mOffloaded;
+    // Most recently used first
+    SnapshotList mSnapshotLru;
+    std::unordered_map<SnapshotKeyType, SnapshotList::iterator> mSnapshots;
+};
+
+} // namespace tensorrt_llm::runtime
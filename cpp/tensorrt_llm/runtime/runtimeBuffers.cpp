@@ -46,6 +46,7 @@ void RuntimeBuffers::clear()
 
     hiddenStates = nullptr;
 
+    arena = nullptr;
     allocated = false;
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -207,6 +208,27 @@ void RuntimeBuffers::reshape(ModelConfig const& modelConfig, WorldConfig const&
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+void RuntimeBuffers::reserve(BufferManager const& manager, ModelConfig const& modelConfig)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_CHECK_WITH_INFO(allocated, "Buffers must be reshaped before they are reserved.");
+
+    auto const batchSize = generationConfig.batchSize;
+    auto const beamWidth = generationConfig.beamWidth;
+    // lastTokenIds is tiled for beam search after the context step
+    lastTokenIds->reshape(ITensor::makeShape({batchSize * beamWidth}));
+    std::vector<TensorPtr*> tensors{&lastTokenIds, &cacheIndirectionDecoderInput, &cacheIndirectionDecoderOutput};
+    if (transformerBuffers)
+    {
+        transformerBuffers->reserve(generationConfig, modelConfig);
+        tensors.push_back(&transformerBuffers->positionIds);
+    }
+    arena = std::make_shared<BufferArena>(tensors, manager);
+    lastTokenIds->reshape(ITensor::makeShape({batchSize}));
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 void RuntimeBuffers::reset(BufferManager& manager)
 {
     clearTensorMaps();
@@ -307,7 +329,8 @@ void RuntimeBuffers::gatherLastTokenLogits(
         auto const vocabSizePadded = modelConfig.getVocabSizePadded(worldConfig.getSize());
         TensorPtr tiledTensor = ITensor::slice(allGenerationLogits, 0, 1);
         tiledTensor->squeeze(0);
-        kernels::gatherLastTokenLogits(*tiledTensor, *logits, *lastTokenIds, manager.getStream());
+        kernels::gatherLastTokenLogits(
+            *tiledTensor, *logits, *lastTokenIds, modelConfig.usePackedInput(), manager.getStream());
         manager.getStream().synchronize();
 
         std::swap(logits, tiledTensor);
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "tensorrt_llm/runtime/bufferArena.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/generationConfig.h"
 #include "tensorrt_llm/runtime/iTensor.h"
@@ -104,6 +105,9 @@ public:
     TensorPtr
         cacheGenerationFragmentPointerHost;   // host pointer array, used in merge generation logits fragments kernel
 
+    // backs the small device tensors that are reshaped with the batch, see reserve
+    std::shared_ptr<BufferArena> arena;
+
     bool allocated{false};
 
 public:
@@ -119,6 +123,10 @@ public:
     //! \brief Reshape buffers based on current GenerationConfig
     void reshape(ModelConfig const& modelConfig, WorldConfig const& worldConfig);
 
+    //! \brief Moves the small device tensors that are reshaped with the batch into an arena sized for the current
+    //! GenerationConfig, which must be the largest one of the session. Later reshapes don't allocate them anymore.
+    void reserve(BufferManager const& manager, ModelConfig const& modelConfig);
+
     void reset(BufferManager& manager);
 
     std::vector<RuntimeBuffers> split(
@@ -15,12 +15,14 @@
  * limitations under the License.
  */
 
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/common/reduceKernelUtils.cuh"
 #include "tensorrt_llm/kernels/speculativeDecoding/kvCacheUpdateKernels.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
 
+#include <cfloat>
 #include <cub/cub.cuh>
 #include <cuda_fp16.h>
 #include <cuda_runtime.h>
@@ -178,6 +180,304 @@ void invokeCopyBatch(IBuffer const& srcBuffer, IBuffer& dstBuffer, IBuffer const
         srcDataPtr, dstDataPtr, srcOffsetsPtr, dstOffsetsPtr, sizesPtr, static_cast<int32_t>(dataTypeSize));
 }
 
+namespace
+{
+template <typename VecT>
+__global__ void copyBlocks(uint8_t const* srcData, uint8_t* dstData, std::int32_t const* blockPairs,
+    SizeType32 const numCopies, std::size_t const bytesPerBlock)
+{
+    auto const numVecs = bytesPerBlock / sizeof(VecT);
+    auto const tidx = static_cast<std::size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    auto const stride = static_cast<std::size_t>(blockDim.x) * gridDim.x;
+
+    // blockPairs is [numCopies, 2] with (srcBlockIdx, dstBlockIdx) per copy
+    for (SizeType32 copyIdx = blockIdx.y; copyIdx < numCopies; copyIdx += gridDim.y)
+    {
+        auto const srcBlockIdx = static_cast<std::size_t>(blockPairs[2 * copyIdx]);
+        auto const dstBlockIdx = static_cast<std::size_t>(blockPairs[2 * copyIdx + 1]);
+        auto const* src = reinterpret_cast<VecT const*>(srcData + srcBlockIdx * bytesPerBlock);
+        auto* dst = reinterpret_cast<VecT*>(dstData + dstBlockIdx * bytesPerBlock);
+
+        for (auto idx = tidx; idx < numVecs; idx += stride)
+        {
+            dst[idx] = src[idx];
+        }
+    }
+}
+
+//! Copies beyond the grid y limit are handled by the CTAs in a grid-stride loop.
+std::uint32_t getCopiesGridDimY(SizeType32 numCopies)
+{
+    return static_cast<std::uint32_t>(std::min<SizeType32>(numCopies, 65535));
+}
+} // namespace
+
+void invokeCopyBlocks(ITensor const& srcPool, ITensor& dstPool, IBuffer const& blockPairs, SizeType32 numCopies,
+    CudaStream const& stream)
+{
+    if (numCopies == 0)
+    {
+        return;
+    }
+    TLLM_CHECK_WITH_INFO(srcPool.getDataType() == dstPool.getDataType(), "Pools must have the same data type.");
+    TLLM_CHECK_WITH_INFO(blockPairs.getSize() >= static_cast<std::size_t>(2 * numCopies),
+        "blockPairs must hold %d (src, dst) pairs.", numCopies);
+    auto const numSrcBlocks = srcPool.getShape().d[0];
+    auto const numDstBlocks = dstPool.getShape().d[0];
+    TLLM_CHECK(numSrcBlocks > 0 && numDstBlocks > 0);
+    auto const bytesPerBlock = srcPool.getSizeInBytes() / numSrcBlocks;
+    TLLM_CHECK_WITH_INFO(
+        bytesPerBlock == dstPool.getSizeInBytes() / numDstBlocks, "Pools must have the same block size.");
+
+    auto const* srcDataPtr = reinterpret_cast<uint8_t const*>(srcPool.data());
+    auto* dstDataPtr = reinterpret_cast<uint8_t*>(dstPool.data());
+    auto const* blockPairsPtr = bufferCast<std::int32_t>(blockPairs);
+
+    auto copyBlocksInvocation = copyBlocks<uint8_t>;
+    std::size_t vectorSize = 1;
+    if (bytesPerBlock % 16 == 0)
+    {
+        vectorSize = 16;
+        copyBlocksInvocation = copyBlocks<uint4>;
+    }
+    else if (bytesPerBlock % 8 == 0)
+    {
+        vectorSize = 8;
+        copyBlocksInvocation = copyBlocks<uint2>;
+    }
+    else if (bytesPerBlock % 4 == 0)
+    {
+        vectorSize = 4;
+        copyBlocksInvocation = copyBlocks<uint32_t>;
+    }
+
+    // Cap the number of CTAs per block, the grid y dimension already provides parallelism across copies.
+    dim3 const blockSize{256};
+    std::size_t const gridx{std::min<std::size_t>(tc::ceilDiv(bytesPerBlock / vectorSize, blockSize.x), 64)};
+    dim3 const gridSize{static_cast<std::uint32_t>(gridx), getCopiesGridDimY(numCopies)};
+    copyBlocksInvocation<<<gridSize, blockSize, 0, stream.get()>>>(
+        srcDataPtr, dstDataPtr, blockPairsPtr, numCopies, bytesPerBlock);
+}
+
+namespace
+{
+auto constexpr kQuantEltsPerLane = kBlockQuantGroupSize / 32;
+
+template <typename TQuant>
+__device__ inline float quantTypeMax();
+
+template <>
+__device__ inline float quantTypeMax<std::int8_t>()
+{
+    return 127.f;
+}
+
+#ifdef ENABLE_FP8
+template <>
+__device__ inline float quantTypeMax<__nv_fp8_e4m3>()
+{
+    return 448.f;
+}
+#endif // ENABLE_FP8
+
+// Each warp handles one group of kBlockQuantGroupSize elements at a time, lanes access elements with a stride of 32
+// so that loads and stores are coalesced.
+template <typename T, typename TQuant>
+__global__ void quantizeBlocks(T const* srcData, uint8_t* dstData, std::int32_t const* blockPairs,
+    SizeType32 const numCopies, std::size_t const eltsPerBlock, std::size_t const dstBytesPerBlock)
+{
+    auto const numGroups = eltsPerBlock / kBlockQuantGroupSize;
+    auto const lane = threadIdx.x % 32;
+    auto const warpsPerCta = blockDim.x / 32;
+    for (SizeType32 copyIdx = blockIdx.y; copyIdx < numCopies; copyIdx += gridDim.y)
+    {
+        auto const srcBlockIdx = static_cast<std::size_t>(blockPairs[2 * copyIdx]);
+        auto const dstBlockIdx = static_cast<std::size_t>(blockPairs[2 * copyIdx + 1]);
+        auto const* src = srcData + srcBlockIdx * eltsPerBlock;
+        auto* dstBlock = dstData + dstBlockIdx * dstBytesPerBlock;
+        auto* dst = reinterpret_cast<TQuant*>(dstBlock);
+        auto* scales = reinterpret_cast<float*>(dstBlock + eltsPerBlock * sizeof(TQuant));
+
+        for (auto group = static_cast<std::size_t>(blockIdx.x) * warpsPerCta + threadIdx.x / 32; group < numGroups;
+             group += static_cast<std::size_t>(gridDim.x) * warpsPerCta)
+        {
+            auto const groupOffset = group * kBlockQuantGroupSize + lane;
+            float values[kQuantEltsPerLane];
+            float amax = 0.f;
+#pragma unroll
+            for (int i = 0; i < kQuantEltsPerLane; ++i)
+            {
+                values[i] = tc::cuda_cast<float>(src[groupOffset + i * 32]);
+                amax = fmaxf(amax, fabsf(values[i]));
+            }
+            amax = tc::warpReduceMax(amax);
+            float const scale = amax > 0.f ? amax / quantTypeMax<TQuant>() : 1.f;
+            float const invScale = 1.f / scale;
+#pragma unroll
+            for (int i = 0; i < kQuantEltsPerLane; ++i)
+            {
+                dst[groupOffset + i * 32] = tc::cuda_cast<TQuant>(values[i] * invScale);
+            }
+            if (lane == 0)
+            {
+                scales[group] = scale;
+            }
+        }
+    }
+}
+
+template <typename T, typename TQuant>
+__global__ void dequantizeBlocks(uint8_t const* srcData, T* dstData, std::int32_t const* blockPairs,
+    SizeType32 const numCopies, std::size_t const eltsPerBlock, std::size_t const srcBytesPerBlock)
+{
+    auto const numGroups = eltsPerBlock / kBlockQuantGroupSize;
+    auto const lane = threadIdx.x % 32;
+    auto const warpsPerCta = blockDim.x / 32;
+    for (SizeType32 copyIdx = blockIdx.y; copyIdx < numCopies; copyIdx += gridDim.y)
+    {
+        auto const srcBlockIdx = static_cast<std::size_t>(blockPairs[2 * copyIdx]);
+        auto const dstBlockIdx = static_cast<std::size_t>(blockPairs[2 * copyIdx + 1]);
+        auto const* srcBlock = srcData + srcBlockIdx * srcBytesPerBlock;
+        auto const* src = reinterpret_cast<TQuant const*>(srcBlock);
+        auto const* scales = reinterpret_cast<float const*>(srcBlock + eltsPerBlock * sizeof(TQuant));
+        auto* dst = dstData + dstBlockIdx * eltsPerBlock;
+
+        for (auto group = static_cast<std::size_t>(blockIdx.x) * warpsPerCta + threadIdx.x / 32; group < numGroups;
+             group += static_cast<std::size_t>(gridDim.x) * warpsPerCta)
+        {
+            auto const groupOffset = group * kBlockQuantGroupSize + lane;
+            float const scale = scales[group];
+#pragma unroll
+            for (int i = 0; i < kQuantEltsPerLane; ++i)
+            {
+                dst[groupOffset + i * 32] = tc::cuda_cast<T>(tc::cuda_cast<float>(src[groupOffset + i * 32]) * scale);
+            }
+        }
+    }
+}
+
+struct BlockQuantParams
+{
+    std::size_t eltsPerBlock;
+    std::size_t quantBytesPerBlock;
+    SizeType32 numCopies;
+    dim3 gridSize;
+    dim3 blockSize;
+};
+
+BlockQuantParams getBlockQuantParams(
+    ITensor const& pool, ITensor const& quantPool, nvinfer1::DataType quantType, SizeType32 numCopies)
+{
+    auto const numBlocks = pool.getShape().d[0];
+    auto const numQuantBlocks = quantPool.getShape().d[0];
+    TLLM_CHECK(numBlocks > 0 && numQuantBlocks > 0);
+    auto const eltsPerBlock = pool.getSize() / numBlocks;
+    TLLM_CHECK_WITH_INFO(eltsPerBlock % kBlockQuantGroupSize == 0,
+        "Block size (%lu elements) must be a multiple of %d to be quantized.", eltsPerBlock, kBlockQuantGroupSize);
+    auto const quantBytesPerBlock = getQuantizedBlockSize(eltsPerBlock, quantType);
+    TLLM_CHECK_WITH_INFO(quantPool.getSizeInBytes() / numQuantBlocks == quantBytesPerBlock,
+        "Quantized pool must have a block size of %lu bytes.", quantBytesPerBlock);
+
+    dim3 const blockSize{256};
+    auto const groupsPerCta = blockSize.x / 32;
+    std::size_t const gridx{std::min<std::size_t>(tc::ceilDiv(eltsPerBlock / kBlockQuantGroupSize, groupsPerCta), 64)};
+    dim3 const gridSize{static_cast<std::uint32_t>(gridx), getCopiesGridDimY(numCopies)};
+    return BlockQuantParams{eltsPerBlock, quantBytesPerBlock, numCopies, gridSize, blockSize};
+}
+
+template <typename T, typename TQuant>
+void invokeQuantizeBlocksTyped(ITensor const& srcPool, ITensor& dstPool, BlockQuantParams const& params,
+    IBuffer const& blockPairs, CudaStream const& stream)
+{
+    quantizeBlocks<T, TQuant><<<params.gridSize, params.blockSize, 0, stream.get()>>>(bufferCast<T>(srcPool),
+        reinterpret_cast<uint8_t*>(dstPool.data()), bufferCast<std::int32_t>(blockPairs), params.numCopies,
+        params.eltsPerBlock, params.quantBytesPerBlock);
+}
+
+template <typename T, typename TQuant>
+void invokeDequantizeBlocksTyped(ITensor const& srcPool, ITensor& dstPool, BlockQuantParams const& params,
+    IBuffer const& blockPairs, CudaStream const& stream)
+{
+    dequantizeBlocks<T, TQuant><<<params.gridSize, params.blockSize, 0, stream.get()>>>(
+        reinterpret_cast<uint8_t const*>(srcPool.data()), bufferCast<T>(dstPool),
+        bufferCast<std::int32_t>(blockPairs), params.numCopies, params.eltsPerBlock, params.quantBytesPerBlock);
+}
+
+template <typename TQuant, bool kQuantize>
+void invokeBlockQuantForType(ITensor const& srcPool, ITensor& dstPool, BlockQuantParams const& params,
+    IBuffer const& blockPairs, CudaStream const& stream)
+{
+    auto const dataType = kQuantize ? srcPool.getDataType() : dstPool.getDataType();
+    auto const invoke = [&](auto tag)
+    {
+        using T = decltype(tag);
+        if constexpr (kQuantize)
+        {
+            invokeQuantizeBlocksTyped<T, TQuant>(srcPool, dstPool, params, blockPairs, stream);
+        }
+        else
+        {
+            invokeDequantizeBlocksTyped<T, TQuant>(srcPool, dstPool, params, blockPairs, stream);
+        }
+    };
+    switch (dataType)
+    {
+    case nvinfer1::DataType::kFLOAT: invoke(float{}); break;
+    case nvinfer1::DataType::kHALF: invoke(half{}); break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16: invoke(__nv_bfloat16{}); break;
+#endif // ENABLE_BF16
+    default: TLLM_THROW("Unsupported data type for block quantization");
+    }
+}
+
+template <bool kQuantize>
+void invokeBlockQuant(ITensor const& srcPool, ITensor& dstPool, nvinfer1::DataType quantType,
+    IBuffer const& blockPairs, SizeType32 numCopies, CudaStream const& stream)
+{
+    if (numCopies == 0)
+    {
+        return;
+    }
+    TLLM_CHECK_WITH_INFO(blockPairs.getSize() >= static_cast<std::size_t>(2 * numCopies),
+        "blockPairs must hold %d (src, dst) pairs.", numCopies);
+    auto const params = kQuantize ? getBlockQuantParams(srcPool, dstPool, quantType, numCopies)
+                                  : getBlockQuantParams(dstPool, srcPool, quantType, numCopies);
+    switch (quantType)
+    {
+    case nvinfer1::DataType::kINT8:
+        invokeBlockQuantForType<std::int8_t, kQuantize>(srcPool, dstPool, params, blockPairs, stream);
+        break;
+#ifdef ENABLE_FP8
+    case nvinfer1::DataType::kFP8:
+        invokeBlockQuantForType<__nv_fp8_e4m3, kQuantize>(srcPool, dstPool, params, blockPairs, stream);
+        break;
+#endif // ENABLE_FP8
+    default: TLLM_THROW("Unsupported block quantization type");
+    }
+}
+} // namespace
+
+std::size_t getQuantizedBlockSize(std::size_t numEltsPerBlock, nvinfer1::DataType quantType)
+{
+    TLLM_CHECK_WITH_INFO(quantType == nvinfer1::DataType::kINT8 || quantType == nvinfer1::DataType::kFP8,
+        "Blocks can only be quantized to INT8 or FP8.");
+    auto const numGroups = tc::ceilDiv(numEltsPerBlock, static_cast<std::size_t>(kBlockQuantGroupSize));
+    return numEltsPerBlock + numGroups * sizeof(float);
+}
+
+void invokeQuantizeBlocks(ITensor const& srcPool, ITensor& dstPool, nvinfer1::DataType quantType,
+    IBuffer const& blockPairs, SizeType32 numCopies, CudaStream const& stream)
+{
+    invokeBlockQuant<true>(srcPool, dstPool, quantType, blockPairs, numCopies, stream);
+}
+
+void invokeDequantizeBlocks(ITensor const& srcPool, ITensor& dstPool, nvinfer1::DataType quantType,
+    IBuffer const& blockPairs, SizeType32 numCopies, CudaStream const& stream)
+{
+    invokeBlockQuant<false>(srcPool, dstPool, quantType, blockPairs, numCopies, stream);
+}
+
 namespace
 {
 template <typename T>
@@ -210,6 +510,80 @@ template void invokeAdd(IBuffer&, std::int32_t, CudaStream const&);
 template void invokeAdd(IBuffer&, std::int8_t, CudaStream const&);
 template void invokeAdd(IBuffer&, float, CudaStream const&);
 
+namespace
+{
+template <typename T>
+__global__ void addLoraDelta(T* weight, T const* inWeights, T const* outWeights, SizeType32 inDim,
+    SizeType32 adapterSize)
+{
+    // One row of the weight per block, the row of outWeights is staged in shared memory and the rows of inWeights are
+    // read coalesced along inDim
+    extern __shared__ float outRow[];
+    auto const row = static_cast<std::size_t>(blockIdx.x);
+    for (auto r = static_cast<SizeType32>(threadIdx.x); r < adapterSize; r += blockDim.x)
+    {
+        outRow[r] = static_cast<float>(outWeights[row * adapterSize + r]);
+    }
+    __syncthreads();
+
+    auto* weightRow = weight + row * inDim;
+    for (auto i = static_cast<SizeType32>(threadIdx.x); i < inDim; i += blockDim.x)
+    {
+        float acc = static_cast<float>(weightRow[i]);
+        for (SizeType32 r = 0; r < adapterSize; ++r)
+        {
+            acc += outRow[r] * static_cast<float>(inWeights[static_cast<std::size_t>(r) * inDim + i]);
+        }
+        weightRow[i] = static_cast<T>(acc);
+    }
+}
+
+template <typename T>
+void invokeAddLoraDeltaTyped(T* weight, void const* inWeights, void const* outWeights, SizeType32 outDim,
+    SizeType32 inDim, SizeType32 adapterSize, cudaStream_t stream)
+{
+    dim3 const blockSize{256};
+    dim3 const gridSize{static_cast<std::uint32_t>(outDim)};
+    auto const sharedMemSize = static_cast<std::size_t>(adapterSize) * sizeof(float);
+    addLoraDelta<<<gridSize, blockSize, sharedMemSize, stream>>>(weight, static_cast<T const*>(inWeights),
+        static_cast<T const*>(outWeights), inDim, adapterSize);
+}
+} // namespace
+
+void invokeAddLoraDelta(ITensor& weight, void const* inWeights, void const* outWeights, SizeType32 outDim,
+    SizeType32 adapterSize, SizeType32 outOffset, CudaStream const& stream)
+{
+    auto const& shape = weight.getShape();
+    TLLM_CHECK_WITH_INFO(shape.nbDims == 2, "The weight must be 2D, got %d dims", shape.nbDims);
+    auto const numRows = static_cast<SizeType32>(shape.d[0]);
+    auto const inDim = static_cast<SizeType32>(shape.d[1]);
+    TLLM_CHECK_WITH_INFO(outOffset >= 0 && outOffset + outDim <= numRows,
+        "Rows [%d, %d) of the LoRA delta exceed the %d rows of the weight", outOffset, outOffset + outDim, numRows);
+    if (outDim == 0 || adapterSize == 0)
+    {
+        return;
+    }
+    auto const offset = static_cast<std::size_t>(outOffset) * inDim;
+    switch (weight.getDataType())
+    {
+    case nvinfer1::DataType::kFLOAT:
+        invokeAddLoraDeltaTyped(bufferCast<float>(weight) + offset, inWeights, outWeights, outDim, inDim, adapterSize,
+            stream.get());
+        break;
+    case nvinfer1::DataType::kHALF:
+        invokeAddLoraDeltaTyped(bufferCast<half>(weight) + offset, inWeights, outWeights, outDim, inDim, adapterSize,
+            stream.get());
+        break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16:
+        invokeAddLoraDeltaTyped(bufferCast<__nv_bfloat16>(weight) + offset, inWeights, outWeights, outDim, inDim,
+            adapterSize, stream.get());
+        break;
+#endif // ENABLE_BF16
+    default: TLLM_THROW("LoRA weights can only be merged into float, half or bfloat16 weights");
+    }
+}
+
 namespace
 {
 template <typename T>
@@ -1045,40 +1419,41 @@ void tileTensorInplace(ITensor& tensor, SizeType32 beamWidth, CudaStream const&
 
 // In the following kernel, we launch a grid with batchSize blocks of threads. Each thread block
 // copies the logits from the "logits" tensor to the "lastTokenLogits" tensor for the last token
-// of each sequence.
-//
-// TODO: Enable vector copies for higher BW utilization.
+// of each sequence. With packed input, lastTokenIds holds the inclusive sum of the context lengths and
+// the logits are [numTokens, vocabSizePadded], otherwise it holds the context lengths and the logits are
+// [batchSize, maxInputLength, vocabSizePadded]. The rows are copied in vectors of VecT.
 
-template <typename T>
-__global__ void gatherLastTokenLogitsKernel(T* lastTokenLogits, T const* logits, int const* lastTokenIds,
-    int maxInputLength, int beamWidth, int vocabSizePadded)
+template <typename VecT>
+__global__ void gatherLastTokenLogitsKernel(VecT* lastTokenLogits, VecT const* logits, int const* lastTokenIds,
+    int maxInputLength, int beamWidth, int vocabSizeVecs, bool packed)
 {
     // This sequence.
-    int seqIdx = blockIdx.x;
+    int const seqIdx = blockIdx.x;
     // Find the index of the last token in that sequence.
     // Since lastTokenIds is the accumulated length instead of real ids, so we need to minus 1.
     // For length [11, 23], we hope to get the results of id 10 and 22, in fact.
-    int lastTokenIdx = lastTokenIds[seqIdx] - 1;
+    auto const lastTokenIdx = static_cast<std::int64_t>(lastTokenIds[seqIdx] - 1)
+        + (packed ? 0 : static_cast<std::int64_t>(seqIdx) * maxInputLength);
 
     // The output pointer.
-    T* lastTokenLogitsPtr = &lastTokenLogits[seqIdx * beamWidth * vocabSizePadded];
+    VecT* lastTokenLogitsPtr = &lastTokenLogits[static_cast<std::int64_t>(seqIdx) * beamWidth * vocabSizeVecs];
     // The input pointer.
-    T const* logitsPtr = &logits[lastTokenIdx * vocabSizePadded];
+    VecT const* logitsPtr = &logits[lastTokenIdx * vocabSizeVecs];
 
     // The threads in the block collaborate to copy the logits.
-    for (int idx = threadIdx.x; idx < vocabSizePadded; idx += blockDim.x)
+    for (int idx = threadIdx.x; idx < vocabSizeVecs; idx += blockDim.x)
     {
-        T value = logitsPtr[idx];
+        VecT const value = logitsPtr[idx];
         for (int beamIdx = 0; beamIdx < beamWidth; ++beamIdx)
         {
-            lastTokenLogitsPtr[beamIdx * vocabSizePadded + idx] = value;
+            lastTokenLogitsPtr[beamIdx * vocabSizeVecs + idx] = value;
         }
     }
 }
 
 template <typename T>
 void invokeGatherLastTokenLogits(
-    ITensor& output, ITensor const& input, ITensor const& lastTokenIds, CudaStream const& stream)
+    ITensor& output, ITensor const& input, ITensor const& lastTokenIds, bool packed, CudaStream const& stream)
 {
     auto const& outputShape = output.getShape();
     auto const batchSize = static_cast<std::uint32_t>(outputShape.d[0]);
@@ -1086,38 +1461,193 @@ void invokeGatherLastTokenLogits(
     auto const vocabSizePadded = static_cast<std::uint32_t>(outputShape.d[2]);
 
     auto const& inputShape = input.getShape();
-    auto const maxInputLength = static_cast<std::uint32_t>(inputShape.d[1]);
-
-    TLLM_CHECK_WITH_INFO(inputShape.d[0] == batchSize, "Invalid input shape: dim[0]");
-    TLLM_CHECK_WITH_INFO(inputShape.d[2] == vocabSizePadded, "Invalid input shape: dim[2]");
+    TLLM_CHECK_WITH_INFO(inputShape.d[inputShape.nbDims - 1] == vocabSizePadded, "Invalid input shape: vocab dim");
+    std::uint32_t maxInputLength{0};
+    if (!packed)
+    {
+        TLLM_CHECK_WITH_INFO(inputShape.nbDims == 3, "Invalid input shape: expected [batch, maxInputLength, vocab]");
+        TLLM_CHECK_WITH_INFO(inputShape.d[0] == batchSize, "Invalid input shape: dim[0]");
+        maxInputLength = static_cast<std::uint32_t>(inputShape.d[1]);
+    }
+    TLLM_CHECK_WITH_INFO(lastTokenIds.getSize() >= batchSize, "Invalid lastTokenIds size");
 
     dim3 const blockSize{256, 1};
     dim3 const gridSize{static_cast<std::uint32_t>(batchSize), 1};
-    gatherLastTokenLogitsKernel<<<gridSize, blockSize, 0, stream.get()>>>(bufferCast<T>(output), bufferCast<T>(input),
-        bufferCast<int32_t>(lastTokenIds), static_cast<std::uint32_t>(maxInputLength),
-        static_cast<std::uint32_t>(beamWidth), vocabSizePadded);
+    auto* outputPtr = bufferCast<T>(output);
+    auto const* inputPtr = bufferCast<T>(input);
+    auto const* lastTokenIdsPtr = bufferCast<int32_t>(lastTokenIds);
+
+    using VecT = uint4;
+    constexpr auto kVecSize = sizeof(VecT) / sizeof(T);
+    bool const vectorize = vocabSizePadded % kVecSize == 0
+        && reinterpret_cast<std::uintptr_t>(outputPtr) % sizeof(VecT) == 0
+        && reinterpret_cast<std::uintptr_t>(inputPtr) % sizeof(VecT) == 0;
+    if (vectorize)
+    {
+        gatherLastTokenLogitsKernel<<<gridSize, blockSize, 0, stream.get()>>>(reinterpret_cast<VecT*>(outputPtr),
+            reinterpret_cast<VecT const*>(inputPtr), lastTokenIdsPtr, static_cast<int>(maxInputLength),
+            static_cast<int>(beamWidth), static_cast<int>(vocabSizePadded / kVecSize), packed);
+    }
+    else
+    {
+        gatherLastTokenLogitsKernel<<<gridSize, blockSize, 0, stream.get()>>>(outputPtr, inputPtr, lastTokenIdsPtr,
+            static_cast<int>(maxInputLength), static_cast<int>(beamWidth), static_cast<int>(vocabSizePadded), packed);
+    }
 }
 
-void gatherLastTokenLogits(ITensor& output, ITensor const& input, ITensor const& lastTokenIds, CudaStream const& stream)
+void gatherLastTokenLogits(
+    ITensor& output, ITensor const& input, ITensor const& lastTokenIds, bool packed, CudaStream const& stream)
 {
     switch (input.getDataType())
     {
-    case nvinfer1::DataType::kFLOAT: invokeGatherLastTokenLogits<float>(output, input, lastTokenIds, stream); break;
-    case nvinfer1::DataType::kHALF: invokeGatherLastTokenLogits<half>(output, input, lastTokenIds, stream); break;
+    case nvinfer1::DataType::kFLOAT:
+        invokeGatherLastTokenLogits<float>(output, input, lastTokenIds, packed, stream);
+        break;
+    case nvinfer1::DataType::kHALF:
+        invokeGatherLastTokenLogits<half>(output, input, lastTokenIds, packed, stream);
+        break;
 #ifdef ENABLE_BF16
     case nvinfer1::DataType::kBF16:
-        invokeGatherLastTokenLogits<__nv_bfloat16>(output, input, lastTokenIds, stream);
+        invokeGatherLastTokenLogits<__nv_bfloat16>(output, input, lastTokenIds, packed, stream);
         break;
 #endif // ENABLE_BF16
 #ifdef ENABLE_FP8
     case nvinfer1::DataType::kFP8:
-        invokeGatherLastTokenLogits<__nv_fp8_e4m3>(output, input, lastTokenIds, stream);
+        invokeGatherLastTokenLogits<__nv_fp8_e4m3>(output, input, lastTokenIds, packed, stream);
         break;
 #endif // ENABLE_FP8
     default: TLLM_CHECK_WITH_INFO(false, "data type not supported");
     }
 }
 
+namespace
+{
+template <typename T>
+__global__ void gatherPromptLogProbsKernel(float* logProbs, T const* logits, TokenIdType const* inputIds,
+    SizeType32 const* contextLengths, SizeType32 maxInputLength, SizeType32 logitsMaxInputLength,
+    SizeType32 idsMaxInputLength, SizeType32 vocabSize, SizeType32 vocabSizePadded, bool packed)
+{
+    __shared__ float sMaxVal;
+
+    auto const seqIdx = static_cast<SizeType32>(blockIdx.y);
+    auto const tokenIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const contextLength = contextLengths[seqIdx];
+    auto const outputIdx = static_cast<std::int64_t>(seqIdx) * maxInputLength + tokenIdx;
+    // The first token has no prediction and the padding no token
+    if (tokenIdx == 0 || tokenIdx >= contextLength)
+    {
+        if (threadIdx.x == 0)
+        {
+            logProbs[outputIdx] = 0.f;
+        }
+        return;
+    }
+
+    std::int64_t logitsOffset{0};
+    std::int64_t idsOffset{0};
+    if (packed)
+    {
+        for (SizeType32 i = 0; i < seqIdx; ++i)
+        {
+            logitsOffset += contextLengths[i];
+        }
+        idsOffset = logitsOffset;
+    }
+    else
+    {
+        logitsOffset = static_cast<std::int64_t>(seqIdx) * logitsMaxInputLength;
+        idsOffset = static_cast<std::int64_t>(seqIdx) * idsMaxInputLength;
+    }
+    // The logits of the previous position predict the token
+    T const* logitsPtr = logits + (logitsOffset + tokenIdx - 1) * vocabSizePadded;
+    auto const targetId = inputIds[idsOffset + tokenIdx];
+
+    float maxVal = -FLT_MAX;
+    for (SizeType32 idx = threadIdx.x; idx < vocabSize; idx += blockDim.x)
+    {
+        maxVal = fmaxf(maxVal, static_cast<float>(logitsPtr[idx]));
+    }
+    maxVal = tc::blockReduceMax<float>(maxVal);
+    if (threadIdx.x == 0)
+    {
+        sMaxVal = maxVal;
+    }
+    __syncthreads();
+
+    float sumVal = 0.f;
+    for (SizeType32 idx = threadIdx.x; idx < vocabSize; idx += blockDim.x)
+    {
+        sumVal += __expf(static_cast<float>(logitsPtr[idx]) - sMaxVal);
+    }
+    sumVal = tc::blockReduceSum<float>(sumVal);
+    if (threadIdx.x == 0)
+    {
+        auto const logSumExp = sMaxVal + __logf(sumVal);
+        logProbs[outputIdx]
+            = 0 <= targetId && targetId < vocabSize ? static_cast<float>(logitsPtr[targetId]) - logSumExp : -FLT_MAX;
+    }
+}
+
+template <typename T>
+void invokeGatherPromptLogProbs(ITensor& logProbs, ITensor const& logits, ITensor const& inputIds,
+    ITensor const& contextLengths, SizeType32 vocabSize, bool packed, CudaStream const& stream)
+{
+    auto const& outputShape = logProbs.getShape();
+    TLLM_CHECK_WITH_INFO(outputShape.nbDims == 2, "Invalid output shape: expected [batchSize, maxInputLength]");
+    auto const batchSize = static_cast<SizeType32>(outputShape.d[0]);
+    auto const maxInputLength = static_cast<SizeType32>(outputShape.d[1]);
+
+    auto const& inputShape = logits.getShape();
+    auto const vocabSizePadded = static_cast<SizeType32>(inputShape.d[inputShape.nbDims - 1]);
+    TLLM_CHECK_WITH_INFO(vocabSize <= vocabSizePadded, "Invalid logits shape: vocab dim");
+    SizeType32 logitsMaxInputLength{0};
+    SizeType32 idsMaxInputLength{0};
+    if (!packed)
+    {
+        TLLM_CHECK_WITH_INFO(inputShape.nbDims == 3 && inputShape.d[0] == batchSize,
+            "Invalid logits shape: expected [batchSize, maxInputLength, vocabSizePadded]");
+        auto const& idsShape = inputIds.getShape();
+        TLLM_CHECK_WITH_INFO(idsShape.nbDims == 2 && idsShape.d[0] == batchSize,
+            "Invalid input ids shape: expected [batchSize, maxInputLength]");
+        logitsMaxInputLength = static_cast<SizeType32>(inputShape.d[1]);
+        idsMaxInputLength = static_cast<SizeType32>(idsShape.d[1]);
+    }
+    TLLM_CHECK_WITH_INFO(
+        static_cast<SizeType32>(contextLengths.getSize()) == batchSize, "Invalid context lengths size");
+    if (batchSize == 0 || maxInputLength == 0)
+    {
+        return;
+    }
+
+    dim3 const blockSize{256};
+    dim3 const gridSize{static_cast<std::uint32_t>(maxInputLength), static_cast<std::uint32_t>(batchSize)};
+    gatherPromptLogProbsKernel<<<gridSize, blockSize, 0, stream.get()>>>(bufferCast<float>(logProbs),
+        bufferCast<T>(logits), bufferCast<TokenIdType>(inputIds), bufferCast<SizeType32>(contextLengths),
+        maxInputLength, logitsMaxInputLength, idsMaxInputLength, vocabSize, vocabSizePadded, packed);
+}
+} // namespace
+
+void gatherPromptLogProbs(ITensor& logProbs, ITensor const& logits, ITensor const& inputIds,
+    ITensor const& contextLengths, SizeType32 vocabSize, bool packed, CudaStream const& stream)
+{
+    switch (logits.getDataType())
+    {
+    case nvinfer1::DataType::kFLOAT:
+        invokeGatherPromptLogProbs<float>(logProbs, logits, inputIds, contextLengths, vocabSize, packed, stream);
+        break;
+    case nvinfer1::DataType::kHALF:
+        invokeGatherPromptLogProbs<half>(logProbs, logits, inputIds, contextLengths, vocabSize, packed, stream);
+        break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16:
+        invokeGatherPromptLogProbs<__nv_bfloat16>(
+            logProbs, logits, inputIds, contextLengths, vocabSize, packed, stream);
+        break;
+#endif // ENABLE_BF16
+    default: TLLM_CHECK_WITH_INFO(false, "data type not supported");
+    }
+}
+
 // In the following kernel, we launch a grid with (microBatchSize * beamWidth, outputLen) blocks of threads. Each thread
 // block copies a `vocabSizePadded` length logits tensor from the "inputLogits (microBatchSize, beamWidth,
 // vocabSizePadded)" to the "outputGenerationLogits (batchSize, beamWidth, outputLen, vocabSizePadded)"
@@ -1232,4 +1762,155 @@ void invokeUpdateKVBlockArrayDraftTokenLocation(ITensor const& seqAcceptedDraftT
         bufferCast<SizeType32>(seqSlotRemapping), maxKVCacheLen, maxBlocksPerSeq, tokensPerBlock, stream);
 }
 
+namespace
+{
+__global__ void initNewRequests(DecoderNewRequest const* requests, DecoderSlotBuffers const buffers)
+{
+    // One request per blockIdx.x, its buffers are spread over blockIdx.y
+    auto const& request = requests[blockIdx.x];
+    auto const tid = static_cast<std::size_t>(blockIdx.y) * blockDim.x + threadIdx.x;
+    auto const stride = static_cast<std::size_t>(gridDim.y) * blockDim.x;
+    auto const slot = static_cast<std::size_t>(request.slot);
+    auto const maxBeamWidth = static_cast<std::size_t>(buffers.maxBeamWidth);
+    auto const maxSequenceLength = static_cast<std::size_t>(buffers.maxSequenceLength);
+
+    if (tid == 0)
+    {
+        buffers.sequenceLimitLength[slot] = request.sequenceLimitLength;
+        buffers.finishedSum[slot] = 0;
+    }
+    for (auto beam = tid; beam < maxBeamWidth; beam += stride)
+    {
+        auto const idx = slot * maxBeamWidth + beam;
+        buffers.endIds[idx] = request.endId;
+        buffers.lengths[idx] = request.inputLength;
+        if (request.initCumLogProbs)
+        {
+            auto const otherBeam = beam > 0 && beam < static_cast<std::size_t>(request.beamWidth);
+            buffers.cumLogProbs[idx] = otherBeam ? buffers.negativeInfinity : 0.f;
+        }
+    }
+    auto const numStepBeams = static_cast<std::size_t>(buffers.maxTokensPerStep) * maxBeamWidth;
+    for (auto i = tid; i < numStepBeams; i += stride)
+    {
+        auto const step = i / maxBeamWidth;
+        auto const idx = (step * buffers.maxBatchSize + slot) * maxBeamWidth + i % maxBeamWidth;
+        buffers.newTokensSteps[idx] = 0;
+        buffers.finishedSteps[idx] = 0;
+    }
+    if (request.zeroEmbeddingBias)
+    {
+        auto const vocabSizePadded = static_cast<std::size_t>(buffers.vocabSizePadded);
+        for (auto i = tid; i < vocabSizePadded; i += stride)
+        {
+            buffers.embeddingBias[slot * vocabSizePadded + i] = 0.f;
+        }
+    }
+    // The input ids start every beam, the rest is endId
+    auto const slotOffset = slot * maxBeamWidth * maxSequenceLength;
+    auto const numBeamTokens = static_cast<std::size_t>(request.beamWidth) * maxSequenceLength;
+    auto const inputIdsLength = static_cast<std::size_t>(request.inputIdsLength);
+    for (auto i = tid; i < numBeamTokens; i += stride)
+    {
+        auto const pos = i % maxSequenceLength;
+        buffers.outputIds[slotOffset + i] = pos < inputIdsLength ? request.inputIds[pos] : request.endId;
+        if (request.beamWidth > 1)
+        {
+            buffers.parentIds[slotOffset + i] = 0;
+        }
+    }
+    if (request.zeroLogProbs)
+    {
+        for (auto i = tid; i < maxBeamWidth * maxSequenceLength; i += stride)
+        {
+            buffers.logProbs[slotOffset + i] = 0.f;
+        }
+    }
+}
+} // namespace
+
+void invokeInitNewRequests(DecoderNewRequest const* requests, SizeType32 numRequests,
+    DecoderSlotBuffers const& buffers, CudaStream const& stream)
+{
+    if (numRequests == 0)
+    {
+        return;
+    }
+    // Enough blocks per request to spread the output ids of a long sequence, which dominate the work
+    dim3 const blockSize{256};
+    auto const maxWork = static_cast<std::size_t>(buffers.maxBeamWidth) * buffers.maxSequenceLength;
+    std::size_t const blocksPerRequest{std::min<std::size_t>(tc::ceilDiv(maxWork, blockSize.x * 4), 32)};
+    dim3 const gridSize{static_cast<std::uint32_t>(numRequests), static_cast<std::uint32_t>(blocksPerRequest)};
+    initNewRequests<<<gridSize, blockSize, 0, stream.get()>>>(requests, buffers);
+}
+
+namespace
+{
+template <typename T>
+__global__ void checkNonFinite(T const* data, std::size_t numRows, std::size_t rowSize, float overflowThreshold,
+    std::uint32_t* flags, std::uint32_t flagBits, std::int32_t* rowFlags)
+{
+    for (auto row = static_cast<std::size_t>(blockIdx.x); row < numRows; row += gridDim.x)
+    {
+        auto const* rowData = data + row * rowSize;
+        bool found{false};
+        for (auto idx = static_cast<std::size_t>(threadIdx.x); idx < rowSize && !found; idx += blockDim.x)
+        {
+            auto const value = static_cast<float>(rowData[idx]);
+            found = !isfinite(value) || (overflowThreshold > 0.f && fabsf(value) > overflowThreshold);
+        }
+        // The rows are uniform across the block, all of its threads reach the barrier
+        if (__syncthreads_or(found) && threadIdx.x == 0)
+        {
+            // The row is flagged before the site, a reader that sees the site also sees its rows
+            if (rowFlags != nullptr)
+            {
+                rowFlags[row] = 1;
+                __threadfence_system();
+            }
+            atomicOr_system(flags, flagBits);
+        }
+    }
+}
+
+template <typename T>
+void invokeCheckNonFinite(T const* data, std::size_t numRows, std::size_t rowSize, float overflowThreshold,
+    std::uint32_t* flags, std::uint32_t flagBits, std::int32_t* rowFlags, cudaStream_t stream)
+{
+    std::uint32_t constexpr kMaxBlocks = 4096;
+    dim3 const blockSize{256};
+    dim3 const gridSize{static_cast<std::uint32_t>(std::min<std::size_t>(numRows, kMaxBlocks))};
+    checkNonFinite<<<gridSize, blockSize, 0, stream>>>(
+        data, numRows, rowSize, overflowThreshold, flags, flagBits, rowFlags);
+}
+} // namespace
+
+void invokeCheckNonFinite(void const* data, nvinfer1::DataType type, std::size_t numRows, std::size_t rowSize,
+    float overflowThreshold, std::uint32_t* flags, std::uint32_t flagBits, std::int32_t* rowFlags,
+    cudaStream_t stream)
+{
+    if (numRows == 0 || rowSize == 0)
+    {
+        return;
+    }
+    switch (type)
+    {
+    case nvinfer1::DataType::kFLOAT:
+        invokeCheckNonFinite(static_cast<float const*>(data), numRows, rowSize, overflowThreshold, flags, flagBits,
+            rowFlags, stream);
+        break;
+    case nvinfer1::DataType::kHALF:
+        invokeCheckNonFinite(static_cast<half const*>(data), numRows, rowSize, overflowThreshold, flags, flagBits,
+            rowFlags, stream);
+        break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16:
+        invokeCheckNonFinite(static_cast<__nv_bfloat16 const*>(data), numRows, rowSize, overflowThreshold, flags,
+            flagBits, rowFlags, stream);
+        break;
+#endif
+    default: break;
+    }
+}
+
 } // namespace tensorrt_llm::runtime::kernels
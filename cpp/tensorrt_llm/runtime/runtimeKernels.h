@@ -37,9 +37,44 @@ void invokeFillBatch(
 void invokeCopyBatch(IBuffer const& srcBuffer, IBuffer& dstBuffer, IBuffer const& srcOffsets, IBuffer const& dstOffsets,
     IBuffer const& sizes, std::size_t maxStride, CudaStream const& stream);
 
+//! \brief Copy whole blocks between two pools in a single launch.
+//! \details Pools are indexed by block along their first dimension and must have the same block size. Either pool can
+//! be in (pinned) host memory, in which case the copy goes over PCIe.
+//! \param blockPairs [numCopies, 2] of (srcBlockIdx, dstBlockIdx), readable from the device.
+void invokeCopyBlocks(ITensor const& srcPool, ITensor& dstPool, IBuffer const& blockPairs, SizeType32 numCopies,
+    CudaStream const& stream);
+
+//! \brief Number of consecutive elements of a block sharing one scale in a quantized block.
+SizeType32 constexpr kBlockQuantGroupSize = 128;
+
+//! \brief Size in bytes of a block of numEltsPerBlock elements quantized to quantType (kINT8 or kFP8).
+//! \details A quantized block holds the quantized elements followed by one float scale per kBlockQuantGroupSize
+//! elements.
+std::size_t getQuantizedBlockSize(std::size_t numEltsPerBlock, nvinfer1::DataType quantType);
+
+//! \brief Copy whole blocks from srcPool into quantized blocks of dstPool in a single launch.
+//! \details Each group of kBlockQuantGroupSize elements is scaled by its absolute maximum. dstPool must have a block
+//! size of getQuantizedBlockSize(), its data type only serves to compute the block size.
+//! \param blockPairs [numCopies, 2] of (srcBlockIdx, dstBlockIdx), readable from the device.
+void invokeQuantizeBlocks(ITensor const& srcPool, ITensor& dstPool, nvinfer1::DataType quantType,
+    IBuffer const& blockPairs, SizeType32 numCopies, CudaStream const& stream);
+
+//! \brief Inverse of invokeQuantizeBlocks, restores blocks of dstPool from quantized blocks of srcPool.
+void invokeDequantizeBlocks(ITensor const& srcPool, ITensor& dstPool, nvinfer1::DataType quantType,
+    IBuffer const& blockPairs, SizeType32 numCopies, CudaStream const& stream);
+
 template <typename T>
 void invokeAdd(IBuffer& buffer, T value, CudaStream const& stream);
 
+//! \brief Adds the product of the LoRA weights of a module to its base weight, weight[outOffset + o, i] +=
+//! sum_r outWeights[o, r] * inWeights[r, i], accumulated in float.
+//! \param weight [numRows, inDim], the base weight of the linear layer, rows [outOffset, outOffset + outDim) are
+//! updated.
+//! \param inWeights [adapterSize, inDim] of the data type of weight, readable from the device.
+//! \param outWeights [outDim, adapterSize] of the data type of weight, readable from the device.
+void invokeAddLoraDelta(ITensor& weight, void const* inWeights, void const* outWeights, SizeType32 outDim,
+    SizeType32 adapterSize, SizeType32 outOffset, CudaStream const& stream);
+
 void reduce(IBuffer& output, IBuffer const& input, CudaStream const& stream);
 
 void invokeTranspose(ITensor& output, ITensor const& input, CudaStream const& stream);
@@ -85,8 +120,20 @@ void tileTensor(ITensor& output, ITensor const& input, SizeType32 beamWidth, Cud
 
 void tileTensorInplace(ITensor& tensor, SizeType32 beamWidth, CudaStream const& stream);
 
+//! \brief Copies the logits of the last token of every sequence to output [batchSize, beamWidth, vocabSizePadded].
+//! \param input [numTokens, vocabSizePadded] or [1, numTokens, vocabSizePadded] if packed, with lastTokenIds the
+//! inclusive sum of the context lengths, otherwise [batchSize, maxInputLength, vocabSizePadded] with lastTokenIds the
+//! context lengths.
 void gatherLastTokenLogits(
-    ITensor& output, ITensor const& input, ITensor const& lastTokenIds, CudaStream const& stream);
+    ITensor& output, ITensor const& input, ITensor const& lastTokenIds, bool packed, CudaStream const& stream);
+
+//! \brief Log-probabilities of the prompt tokens, the log-softmax of the context logits at the next token of each
+//! position, without materializing the probabilities.
+//! \param logProbs [batchSize, maxInputLength] float, zero at the first token and at the padding.
+//! \param logits [numTokens, vocabSizePadded] if packed, otherwise [batchSize, maxInputLength, vocabSizePadded].
+//! \param inputIds [numTokens] if packed, otherwise [batchSize, maxInputLength].
+void gatherPromptLogProbs(ITensor& logProbs, ITensor const& logits, ITensor const& inputIds,
+    ITensor const& contextLengths, SizeType32 vocabSize, bool packed, CudaStream const& stream);
 
 void copyLatestTokenLogitsInGeneration(ITensor& output, ITensor const& input, SizeType32 step,
     SizeType32 firstBatchSlotIdx, SizeType32 microBatchSize, SizeType32 beamWidth, CudaStream const& stream);
@@ -101,4 +148,59 @@ void invokeUpdateKVBlockArrayDraftTokenLocation(ITensor const& seqAcceptedDraftT
     SizeType32 numKVHeads, SizeType32 sizeInBytesPerKVHead, SizeType32 rewindDraftTokenCommonCount,
     int* rewindDraftTokenSeparateAdjustments, ITensor const& seqSlotRemapping, SizeType32 maxKVCacheLen,
     SizeType32 maxBlocksPerSeq, SizeType32 tokensPerBlock, cudaStream_t stream);
+
+//! \brief Values of a new decoder request, the per request part of invokeInitNewRequests.
+struct DecoderNewRequest
+{
+    //! [inputIdsLength] on the GPU, copied into the output ids of every beam
+    TokenIdType const* inputIds;
+    SizeType32 inputIdsLength;
+    SizeType32 slot;
+    SizeType32 inputLength;
+    SizeType32 sequenceLimitLength;
+    SizeType32 beamWidth;
+    TokenIdType endId;
+    //! Whether the embedding bias of the slot is cleared, it's copied separately otherwise
+    bool zeroEmbeddingBias;
+    bool initCumLogProbs;
+    bool zeroLogProbs;
+};
+
+//! \brief The joint decoder buffers indexed by slot in invokeInitNewRequests.
+struct DecoderSlotBuffers
+{
+    TokenIdType* endIds;                //!< [maxBatchSize, maxBeamWidth]
+    SizeType32* sequenceLimitLength;    //!< [maxBatchSize]
+    SizeType32* lengths;                //!< [maxBatchSize, maxBeamWidth]
+    float* embeddingBias;               //!< [maxBatchSize, vocabSizePadded]
+    TokenIdType* outputIds;             //!< [maxBatchSize, maxBeamWidth, maxSequenceLength]
+    TokenIdType* parentIds;             //!< [maxBatchSize, maxBeamWidth, maxSequenceLength]
+    SizeType32* finishedSum;            //!< [maxBatchSize], pinned
+    TokenIdType* newTokensSteps;        //!< [maxTokensPerStep, maxBatchSize, maxBeamWidth]
+    std::uint8_t* finishedSteps;        //!< [maxTokensPerStep, maxBatchSize, maxBeamWidth]
+    float* cumLogProbs;                 //!< [maxBatchSize, maxBeamWidth]
+    float* logProbs;                    //!< [maxBatchSize, maxBeamWidth, maxSequenceLength]
+    SizeType32 maxBatchSize;
+    SizeType32 maxBeamWidth;
+    SizeType32 maxSequenceLength;
+    SizeType32 maxTokensPerStep;
+    SizeType32 vocabSizePadded;
+    //! Initial cumulative log prob of the beams but the first
+    float negativeInfinity;
+};
+
+//! \brief Initializes the slots of new decoder requests with one launch, instead of a fill or copy per buffer and
+//! request.
+//! \param requests [numRequests] on the GPU.
+void invokeInitNewRequests(DecoderNewRequest const* requests, SizeType32 numRequests,
+    DecoderSlotBuffers const& buffers, CudaStream const& stream);
+
+//! \brief Checks rows of values for NaN, Inf and, if overflowThreshold is positive, magnitudes above it.
+//! \details Sets flagBits in flags with a system scope atomic, and rowFlags[row] to 1 if given, for the rows with such
+//! a value. Nothing is written otherwise, so flags may live in host memory mapped to the device. Only kFLOAT, kHALF
+//! and kBF16 are checked.
+void invokeCheckNonFinite(void const* data, nvinfer1::DataType type, std::size_t numRows, std::size_t rowSize,
+    float overflowThreshold, std::uint32_t* flags, std::uint32_t flagBits, std::int32_t* rowFlags,
+    cudaStream_t stream);
+
 } // namespace tensorrt_llm::runtime::kernels
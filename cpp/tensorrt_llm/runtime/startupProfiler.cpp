@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/startupProfiler.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace tensorrt_llm::runtime
+{
+
+char const* toString(StartupPhase phase) noexcept
+{
+    switch (phase)
+    {
+    case StartupPhase::kENGINE_DESERIALIZATION: return "engine_deserialization";
+    case StartupPhase::kCONTEXT_CREATION: return "context_creation";
+    case StartupPhase::kKV_CACHE_ALLOCATION: return "kv_cache_allocation";
+    case StartupPhase::kCUSTOM_ALL_REDUCE_SETUP: return "custom_all_reduce_setup";
+    case StartupPhase::kXQA_JIT: return "xqa_jit";
+    case StartupPhase::kCUDA_GRAPH_CAPTURE: return "cuda_graph_capture";
+    }
+    return "unknown";
+}
+
+StartupProfiler::Scope::Scope(StartupProfiler& profiler, StartupPhase phase)
+    : mProfiler{profiler}
+    , mPhase{phase}
+    , mBegin{Clock::now()}
+{
+}
+
+StartupProfiler::Scope::~Scope()
+{
+    mProfiler.record(mPhase, mBegin, Clock::now());
+}
+
+StartupProfiler& StartupProfiler::getInstance()
+{
+    static StartupProfiler profiler;
+    return profiler;
+}
+
+StartupProfiler::StartupProfiler()
+    : mCreation{Clock::now()}
+{
+}
+
+void StartupProfiler::record(StartupPhase phase, Clock::time_point begin, Clock::time_point end)
+{
+    auto const toMs
+        = [](Clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& stats = mPhases[static_cast<std::size_t>(phase)];
+    ++stats.count;
+    stats.totalMs += toMs(end - begin);
+    stats.lastEndMs = std::max(stats.lastEndMs, toMs(end - mCreation));
+}
+
+StartupPhaseStats StartupProfiler::getPhaseStats(StartupPhase phase) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPhases[static_cast<std::size_t>(phase)];
+}
+
+double StartupProfiler::getElapsedMs() const
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - mCreation).count();
+}
+
+std::string StartupProfiler::report() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << std::left << std::setw(26) << "phase" << std::right << std::setw(8) << "count" << std::setw(14)
+        << "total(ms)" << std::setw(14) << "end(ms)" << "\n";
+    for (std::size_t i = 0; i < kNumPhases; ++i)
+    {
+        auto const& stats = mPhases[i];
+        out << std::left << std::setw(26) << toString(static_cast<StartupPhase>(i)) << std::right << std::setw(8)
+            << stats.count << std::setw(14) << stats.totalMs << std::setw(14) << stats.lastEndMs << "\n";
+    }
+    return out.str();
+}
+
+std::string StartupProfiler::toJsonStr() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    nlohmann::json json;
+    for (std::size_t i = 0; i < kNumPhases; ++i)
+    {
+        auto const& stats = mPhases[i];
+        json[toString(static_cast<StartupPhase>(i))]
+            = {{"count", stats.count}, {"totalMs", stats.totalMs}, {"lastEndMs", stats.lastEndMs}};
+    }
+    return json.dump();
+}
+
+} // namespace tensorrt_llm::runtime
@@ -16,9 +16,62 @@
 
 #include "tensorrt_llm/runtime/tllmBuffers.h"
 
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/runtime/utils/numaUtils.h"
+
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
 namespace tensorrt_llm::runtime
 {
 
+namespace
+{
+std::size_t roundUpToPage(std::size_t n)
+{
+    static auto const pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return (n + pageSize - 1) / pageSize * pageSize;
+}
+} // namespace
+
+bool PinnedAllocator::allocateOnDeviceNode(PointerType* ptr, std::size_t n)
+{
+    if (!common::getEnvNumaPinnedMemory())
+    {
+        return false;
+    }
+    auto const size = roundUpToPage(std::max<std::size_t>(n, 1));
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+    // The policy has to be set before cudaHostRegister touches the pages
+    int device{0};
+    TLLM_CUDA_CHECK(cudaGetDevice(&device));
+    utils::bindMemoryToNode(mapping, size, utils::getDeviceNumaNode(device));
+    auto const status = ::cudaHostRegister(mapping, size, cudaHostRegisterDefault);
+    if (status != cudaSuccess)
+    {
+        munmap(mapping, size);
+        TLLM_CUDA_CHECK(status);
+    }
+    *ptr = mapping;
+    return true;
+}
+
+bool PinnedAllocator::deallocateOnDeviceNode(PointerType ptr, std::size_t n)
+{
+    if (!common::getEnvNumaPinnedMemory())
+    {
+        return false;
+    }
+    TLLM_CUDA_CHECK_FREE_RESOURCE(::cudaHostUnregister(ptr));
+    munmap(ptr, roundUpToPage(std::max<std::size_t>(n, 1)));
+    return true;
+}
+
 template <typename TAllocator>
 typename PoolAllocator<TAllocator>::PoolType& PoolAllocator<TAllocator>::getPool()
 {
@@ -53,7 +53,7 @@ public:
         PointerType ptr{};
         static_cast<TDerived*>(this)->allocateImpl(&ptr, n);
         if constexpr (count)
-            MemoryCounters::getInstance().allocate<memoryType>(n);
+            MemoryCounters::getInstance().allocate<memoryType>(ptr, n);
         return ptr;
     }
 
@@ -63,7 +63,7 @@ public:
         {
             static_cast<TDerived*>(this)->deallocateImpl(ptr, n);
             if constexpr (count)
-                MemoryCounters::getInstance().deallocate<memoryType>(n);
+                MemoryCounters::getInstance().deallocate<memoryType>(ptr, n);
         }
     }
 
@@ -159,14 +159,27 @@ public:
 protected:
     void allocateImpl(PointerType* ptr, std::size_t n) // NOLINT(readability-convert-member-functions-to-static)
     {
-        TLLM_CUDA_CHECK(::cudaHostAlloc(ptr, n, cudaHostAllocDefault));
+        if (!allocateOnDeviceNode(ptr, n))
+        {
+            TLLM_CUDA_CHECK(::cudaHostAlloc(ptr, n, cudaHostAllocDefault));
+        }
     }
 
     void deallocateImpl( // NOLINT(readability-convert-member-functions-to-static)
         PointerType ptr, [[maybe_unused]] std::size_t n)
     {
-        TLLM_CUDA_CHECK_FREE_RESOURCE(::cudaFreeHost(ptr));
+        if (!deallocateOnDeviceNode(ptr, n))
+        {
+            TLLM_CUDA_CHECK_FREE_RESOURCE(::cudaFreeHost(ptr));
+        }
     }
+
+private:
+    //! \brief With TRTLLM_NUMA_PINNED_MEMORY, pins pages placed on the NUMA node of the current device instead of
+    //! letting cudaHostAlloc place them on the node of the calling thread.
+    //! \returns False if disabled.
+    static bool allocateOnDeviceNode(PointerType* ptr, std::size_t n);
+    static bool deallocateOnDeviceNode(PointerType ptr, std::size_t n);
 };
 
 class HostAllocator : public BaseAllocator<HostAllocator, MemoryType::kCPU>
@@ -350,6 +363,7 @@ private:
     std::list<MemorySegment> mMemorySegments = {};
     std::vector<std::tuple<PointerType, std::size_t>> mAllocatedChunks = {};
 
+    // A chunk is attributed to the tag of the allocation that grows the pool until the pool is destroyed.
     void allocateChunk()
     {
         TLLM_LOG_DEBUG("MemoryPool: Allocating %zu B", mChunkSize);
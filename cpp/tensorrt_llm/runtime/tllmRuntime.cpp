@@ -17,10 +17,27 @@
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/common/nvtxUtils.h"
+#include "tensorrt_llm/common/warmStartCache.h"
+#include "tensorrt_llm/runtime/bufferView.h"
+#include "tensorrt_llm/runtime/memoryCounters.h"
+#include "tensorrt_llm/runtime/numericSentinel.h"
+#include "tensorrt_llm/runtime/pluginTimer.h"
+#include "tensorrt_llm/runtime/startupProfiler.h"
 #include "tllmLogger.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
 #include <limits>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <type_traits>
+#include <unistd.h>
+#include <unordered_map>
 
 using namespace tensorrt_llm::runtime;
 
@@ -57,15 +74,315 @@ std::vector<std::size_t> dimsToShape(nvinfer1::Dims const& dims)
 
 tensorrt_llm::runtime::TllmLogger defaultLogger{};
 
+//! \brief Select the warm-start cache entries of the engine. Hashing the whole engine would cost about as much as
+//! reading it, so only its size and both ends, which hold the engine header and the serialized plugins, are hashed.
+void setWarmStartEngineHash(void const* engineData, std::size_t engineSize)
+{
+    auto& warmStartCache = tensorrt_llm::common::WarmStartCache::getInstance();
+    if (!warmStartCache.isEnabled())
+    {
+        return;
+    }
+    using tensorrt_llm::common::WarmStartCache;
+    std::size_t constexpr kHashedSize = std::size_t{1} << 20;
+    auto const* bytes = static_cast<std::uint8_t const*>(engineData);
+    auto const headSize = std::min(engineSize, kHashedSize);
+    auto const tailSize = std::min(engineSize - headSize, kHashedSize);
+    auto engineHash = WarmStartCache::hash(&engineSize, sizeof(engineSize));
+    engineHash = WarmStartCache::hash(bytes, headSize, engineHash);
+    engineHash = WarmStartCache::hash(bytes + engineSize - tailSize, tailSize, engineHash);
+    warmStartCache.setEngineHash(engineHash);
+}
+
+std::unique_ptr<nvinfer1::ICudaEngine> deserializeEngine(
+    nvinfer1::IRuntime& runtime, void const* engineData, std::size_t engineSize)
+{
+    auto const startupScope = StartupProfiler::getInstance().scope(StartupPhase::kENGINE_DESERIALIZATION);
+    setWarmStartEngineHash(engineData, engineSize);
+    return std::unique_ptr<nvinfer1::ICudaEngine>{runtime.deserializeCudaEngine(engineData, engineSize)};
+}
+
+//! Read-only private mapping of a whole file, backed by the page cache instead of anonymous host memory.
+class MappedFile
+{
+public:
+    explicit MappedFile(std::filesystem::path const& path)
+    {
+        mFd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        TLLM_CHECK_WITH_INFO(mFd >= 0, "Failed to open engine file %s: %s", path.c_str(), std::strerror(errno));
+        struct stat fileStat
+        {
+        };
+        if (::fstat(mFd, &fileStat) != 0 || fileStat.st_size <= 0)
+        {
+            ::close(mFd);
+            TLLM_THROW("Failed to get the size of engine file %s", path.c_str());
+        }
+        mSize = static_cast<std::size_t>(fileStat.st_size);
+        mData = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFd, 0);
+        if (mData == MAP_FAILED)
+        {
+            ::close(mFd);
+            TLLM_THROW("Failed to map engine file %s: %s", path.c_str(), std::strerror(errno));
+        }
+        ::madvise(mData, mSize, MADV_SEQUENTIAL);
+    }
+
+    ~MappedFile()
+    {
+        ::munmap(mData, mSize);
+        ::close(mFd);
+    }
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    [[nodiscard]] std::uint8_t const* data() const noexcept
+    {
+        return static_cast<std::uint8_t const*>(mData);
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return mSize;
+    }
+
+    //! \brief Hint the kernel to read ahead a range, the read runs in parallel with the consumer of the mapping.
+    void prefetch(std::size_t offset, std::size_t size) const noexcept
+    {
+        advise(offset, size, MADV_WILLNEED);
+    }
+
+    //! \brief Drop a consumed range from the mapping, so that the resident size doesn't grow with the file.
+    void release(std::size_t offset, std::size_t size) const noexcept
+    {
+        advise(offset, size, MADV_DONTNEED);
+    }
+
+private:
+    void advise(std::size_t offset, std::size_t size, int advice) const noexcept
+    {
+        // madvise needs page aligned ranges, only whole pages inside the range are advised
+        static auto const pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        auto const begin = (offset + pageSize - 1) / pageSize * pageSize;
+        auto const end = std::min(offset + size, mSize) / pageSize * pageSize;
+        if (begin < end)
+        {
+            ::madvise(static_cast<std::uint8_t*>(mData) + begin, end - begin, advice);
+        }
+    }
+
+    int mFd{-1};
+    void* mData{nullptr};
+    std::size_t mSize{0};
+};
+
+#if NV_TENSORRT_MAJOR >= 10
+//! TensorRT pulls the engine through the reader, mostly in weight sized reads that it copies to the GPU.
+class MappedFileStreamReader : public nvinfer1::IStreamReader
+{
+public:
+    explicit MappedFileStreamReader(MappedFile const& file)
+        : mFile{file}
+    {
+        mFile.prefetch(0, kREAD_AHEAD_SIZE);
+    }
+
+    int64_t read(void* destination, int64_t nbBytes) noexcept override
+    {
+        auto const numBytes = std::min(static_cast<std::size_t>(std::max<int64_t>(nbBytes, 0)), mFile.size() - mOffset);
+        // Keep the kernel reading the next window while this one is consumed
+        mFile.prefetch(mOffset + numBytes, kREAD_AHEAD_SIZE);
+        std::memcpy(destination, mFile.data() + mOffset, numBytes);
+        mFile.release(mOffset, numBytes);
+        mOffset += numBytes;
+        return static_cast<int64_t>(numBytes);
+    }
+
+private:
+    static std::size_t constexpr kREAD_AHEAD_SIZE = std::size_t{256} << 20;
+
+    MappedFile const& mFile;
+    std::size_t mOffset{0};
+};
+#endif // NV_TENSORRT_MAJOR >= 10
+
+std::unique_ptr<nvinfer1::ICudaEngine> deserializeEngineFile(
+    nvinfer1::IRuntime& runtime, std::filesystem::path const& enginePath)
+{
+    NVTX3_SCOPED_RANGE(deserializeEngineFile);
+    auto const startupScope = StartupProfiler::getInstance().scope(StartupPhase::kENGINE_DESERIALIZATION);
+    MappedFile const file{enginePath};
+    TLLM_LOG_INFO("Deserializing engine %s of %.2f MiB.", enginePath.c_str(),
+        static_cast<double>(file.size()) / 1048576.0);
+#if NV_TENSORRT_MAJOR >= 10
+    setWarmStartEngineHash(file.data(), file.size());
+    MappedFileStreamReader reader{file};
+    return std::unique_ptr<nvinfer1::ICudaEngine>{runtime.deserializeCudaEngine(reader)};
+#else
+    return deserializeEngine(runtime, file.data(), file.size());
+#endif // NV_TENSORRT_MAJOR >= 10
+}
+
+//! \brief Share an engine, which keeps the runtime that deserialized it alive, as the runtime must outlive it.
+//! Number of runtimes holding each engine shared with TllmRuntime::shareEngine(). They all hold the engine and its
+//! IRuntime in the same unique_ptrs as a runtime owning them alone, so that sharing doesn't change the layout of
+//! TllmRuntime, and all but the last one release them instead of deleting them.
+std::mutex sharedEnginesMutex;
+std::unordered_map<nvinfer1::ICudaEngine const*, SizeType32> sharedEngines;
+
+void acquireSharedEngine(nvinfer1::ICudaEngine const* engine)
+{
+    std::lock_guard<std::mutex> lock(sharedEnginesMutex);
+    // The runtime that deserialized the engine is the first holder
+    auto const [it, inserted] = sharedEngines.try_emplace(engine, 1);
+    ++it->second;
+}
+
+//! \returns Whether the caller was the last holder of the engine and has to delete it.
+bool releaseSharedEngine(nvinfer1::ICudaEngine const* engine)
+{
+    std::lock_guard<std::mutex> lock(sharedEnginesMutex);
+    auto const it = sharedEngines.find(engine);
+    if (it == sharedEngines.end())
+    {
+        return true;
+    }
+    if (--it->second > 0)
+    {
+        return false;
+    }
+    sharedEngines.erase(it);
+    return true;
+}
+
+nvinfer1::DataType safetensorsDataType(std::string const& dtype)
+{
+    static std::unordered_map<std::string, nvinfer1::DataType> const dataTypes{{"F32", nvinfer1::DataType::kFLOAT},
+        {"F16", nvinfer1::DataType::kHALF}, {"BF16", nvinfer1::DataType::kBF16}, {"I8", nvinfer1::DataType::kINT8},
+        {"U8", nvinfer1::DataType::kUINT8}, {"I32", nvinfer1::DataType::kINT32}, {"I64", nvinfer1::DataType::kINT64},
+        {"F8_E4M3", nvinfer1::DataType::kFP8}, {"BOOL", nvinfer1::DataType::kBOOL}};
+    auto const it = dataTypes.find(dtype);
+    TLLM_CHECK_WITH_INFO(it != dataTypes.end(), "Unsupported safetensors data type %s", dtype.c_str());
+    return it->second;
+}
+
+//! \brief Wrap the tensors of a mapped safetensors file, an 8 byte header size, a JSON header and the data.
+TllmRuntime::TensorMap wrapSafetensors(MappedFile const& file)
+{
+    std::uint64_t headerSize{0};
+    TLLM_CHECK_WITH_INFO(file.size() >= sizeof(headerSize), "Truncated safetensors file");
+    std::memcpy(&headerSize, file.data(), sizeof(headerSize));
+    TLLM_CHECK_WITH_INFO(headerSize <= file.size() - sizeof(headerSize), "Truncated safetensors header");
+    auto const* dataBegin = file.data() + sizeof(headerSize) + headerSize;
+    auto const dataSize = file.size() - sizeof(headerSize) - headerSize;
+    auto const header = nlohmann::json::parse(file.data() + sizeof(headerSize), dataBegin);
+
+    TllmRuntime::TensorMap tensors;
+    for (auto const& [name, entry] : header.items())
+    {
+        if (name == "__metadata__")
+        {
+            continue;
+        }
+        auto const shape = entry.at("shape").get<std::vector<std::int64_t>>();
+        auto const offsets = entry.at("data_offsets").get<std::vector<std::size_t>>();
+        TLLM_CHECK_WITH_INFO(offsets.size() == 2 && offsets[0] <= offsets[1] && offsets[1] <= dataSize,
+            "Invalid data offsets of tensor %s", name.c_str());
+        auto const dataType = safetensorsDataType(entry.at("dtype").get<std::string>());
+        nvinfer1::Dims dims{};
+        TLLM_CHECK(shape.size() <= nvinfer1::Dims::MAX_DIMS);
+        dims.nbDims = static_cast<std::int32_t>(shape.size());
+        std::copy(shape.begin(), shape.end(), dims.d);
+        // The mapping is read-only, which is fine as TensorRT only reads the weights
+        auto* data = const_cast<std::uint8_t*>(dataBegin + offsets[0]);
+        auto tensor = ITensor::wrap(data, dataType, dims);
+        TLLM_CHECK_WITH_INFO(tensor->getSizeInBytes() == offsets[1] - offsets[0],
+            "Size of tensor %s doesn't match its shape", name.c_str());
+        tensors.emplace(name, std::move(tensor));
+    }
+    return tensors;
+}
+
 } // namespace
 
 TllmRuntime::TllmRuntime(
     void const* engineData, std::size_t engineSize, float const gpuWeightsPercent, nvinfer1::ILogger& logger)
-    : mStream(std::make_shared<CudaStream>())
+    : mStream(std::make_shared<CudaStream>(StreamPriority::kHIGH))
+    , mBufferManager{mStream, true} // Ensure to trim the memory pool on destruction.
+    , mRuntime{nvinfer1::createInferRuntime(logger)}
+    , mEngine{deserializeEngine(*mRuntime, engineData, engineSize)}
+    , mEngineInspector{mEngine ? mEngine->createEngineInspector() : nullptr}
+{
+    initialize(gpuWeightsPercent);
+}
+
+TllmRuntime::TllmRuntime(void const* engineData, std::size_t engineSize, float const gpuWeightsPercent = 1.0F)
+    : TllmRuntime{engineData, engineSize, gpuWeightsPercent, defaultLogger}
+{
+}
+
+TllmRuntime::TllmRuntime(
+    std::filesystem::path const& enginePath, float const gpuWeightsPercent, nvinfer1::ILogger& logger)
+    : mStream(std::make_shared<CudaStream>(StreamPriority::kHIGH))
     , mBufferManager{mStream, true} // Ensure to trim the memory pool on destruction.
     , mRuntime{nvinfer1::createInferRuntime(logger)}
-    , mEngine{mRuntime->deserializeCudaEngine(engineData, engineSize)}
+    , mEngine{deserializeEngineFile(*mRuntime, enginePath)}
+    , mEngineInspector{mEngine ? mEngine->createEngineInspector() : nullptr}
+{
+    initialize(gpuWeightsPercent);
+}
+
+TllmRuntime::TllmRuntime(std::filesystem::path const& enginePath, float const gpuWeightsPercent)
+    : TllmRuntime{enginePath, gpuWeightsPercent, defaultLogger}
+{
+}
+
+TllmRuntime::TllmRuntime(nvinfer1::IRuntime* runtime, nvinfer1::ICudaEngine* engine)
+    : mStream(std::make_shared<CudaStream>(StreamPriority::kHIGH))
+    , mBufferManager{mStream, true} // Ensure to trim the memory pool on destruction.
+    , mRuntime{runtime}
+    , mEngine{engine}
     , mEngineInspector{mEngine->createEngineInspector()}
+{
+    try
+    {
+        // The weight streaming budget belongs to the engine, it was set by the runtime that deserialized it
+        initialize(1.0F);
+    }
+    catch (...)
+    {
+        // The destructor doesn't run, so the members must not delete the engine of the other runtimes
+        mEngineInspector.reset();
+        if (!releaseSharedEngine(mEngine.get()))
+        {
+            static_cast<void>(mEngine.release());
+            static_cast<void>(mRuntime.release());
+        }
+        throw;
+    }
+}
+
+std::unique_ptr<TllmRuntime> TllmRuntime::shareEngine() const
+{
+    TLLM_LOG_INFO("Sharing the engine and its weights with a new runtime.");
+    acquireSharedEngine(mEngine.get());
+    return std::unique_ptr<TllmRuntime>{new TllmRuntime{mRuntime.get(), mEngine.get()}};
+}
+
+TllmRuntime::~TllmRuntime()
+{
+    // Another runtime may delete the shared engine as soon as it is released, so everything created from it goes first
+    mEngineInspector.reset();
+    clearContexts();
+    if (!releaseSharedEngine(mEngine.get()))
+    {
+        static_cast<void>(mEngine.release());
+        static_cast<void>(mRuntime.release());
+    }
+}
+
+void TllmRuntime::initialize(float gpuWeightsPercent)
 {
     TLLM_CHECK_WITH_INFO(mEngine != nullptr, "Failed to deserialize cuda engine");
     if (gpuWeightsPercent < 1)
@@ -82,22 +399,81 @@ TllmRuntime::TllmRuntime(
 #endif // NV_TENSORRT_MAJOR >= 10
     }
     auto const devMemorySize = mEngine->getDeviceMemorySize();
-    mEngineBuffer = mBufferManager.gpu(devMemorySize);
+    {
+        MemoryCounters::ScopedTag const tag{MemoryTag::kTRT_ACTIVATIONS};
+        mEngineBuffer = mBufferManager.gpu(devMemorySize);
+    }
 
     // Print context memory size for CI/CD to track.
     TLLM_LOG_INFO("[MemUsageChange] Allocated %.2f MiB for execution context memory.",
         static_cast<double>(devMemorySize) / 1048576.0);
 }
 
-TllmRuntime::TllmRuntime(void const* engineData, std::size_t engineSize, float const gpuWeightsPercent = 1.0F)
-    : TllmRuntime{engineData, engineSize, gpuWeightsPercent, defaultLogger}
+double TllmRuntime::measureHostToDeviceBandwidth(std::size_t copySize, SizeType32 numIterations) const
+{
+    TLLM_CHECK(copySize > 0 && numIterations > 0);
+    auto const hostBuffer = mBufferManager.pinned(copySize, nvinfer1::DataType::kINT8);
+    auto const deviceBuffer = mBufferManager.gpu(copySize, nvinfer1::DataType::kINT8);
+    // The first copy warms up the driver
+    mBufferManager.copy(*hostBuffer, *deviceBuffer);
+    CudaEvent const start{cudaEventDefault};
+    CudaEvent const end{cudaEventDefault};
+    mStream->record(start);
+    for (SizeType32 i = 0; i < numIterations; ++i)
+    {
+        mBufferManager.copy(*hostBuffer, *deviceBuffer);
+    }
+    mStream->record(end);
+    end.synchronize();
+    float elapsedMs{0};
+    TLLM_CUDA_CHECK(::cudaEventElapsedTime(&elapsedMs, start.get(), end.get()));
+    auto const bandwidth = static_cast<double>(copySize) * numIterations / (std::max(elapsedMs, 1e-3F) * 1e-3);
+    TLLM_LOG_INFO("Measured host to device bandwidth of %.2f GB/s.", bandwidth * 1e-9);
+    return bandwidth;
+}
+
+std::int64_t TllmRuntime::setWeightStreamingBudgetForStreamingTime(float maxStreamingTimeMs)
 {
+#if NV_TENSORRT_MAJOR >= 10
+    TLLM_CHECK_WITH_INFO(mContexts.empty(), "The weight streaming budget must be set before adding contexts.");
+    TLLM_CHECK(maxStreamingTimeMs >= 0);
+    auto const min = mEngine->getMinimumWeightStreamingBudget();
+    auto const max = mEngine->getStreamableWeightsSize();
+    auto const streamedSize = static_cast<std::int64_t>(measureHostToDeviceBandwidth() * maxStreamingTimeMs * 1e-3);
+    auto const budget = std::clamp(max - streamedSize, min, max);
+    TLLM_LOG_INFO("Set weight streaming budget to %lld bytes for at most %.2f ms of streaming per forward pass. "
+                  "Valid range: %lld bytes - %lld bytes.",
+        budget, maxStreamingTimeMs, min, max);
+    mEngine->setWeightStreamingBudget(budget);
+    // The activation memory may depend on the budget. The buffer is resized in place, so that a buffer set with
+    // setEngineBuffer stays shared: it is a view, which can't grow beyond the buffer of the caller.
+    auto const devMemorySize = mEngine->getDeviceMemorySize();
+    if (mEngineBuffer->getSizeInBytes() < devMemorySize)
+    {
+        auto const isView = dynamic_cast<BufferView const*>(mEngineBuffer.get()) != nullptr;
+        TLLM_CHECK_WITH_INFO(!isView || mEngineBuffer->getCapacity() >= devMemorySize,
+            "The engine buffer set with setEngineBuffer is too small for the weight streaming budget, %zu bytes are "
+            "needed.",
+            devMemorySize);
+        MemoryCounters::ScopedTag const tag{MemoryTag::kTRT_ACTIVATIONS};
+        mEngineBuffer->resize(devMemorySize);
+    }
+    return budget;
+#else
+    TLLM_THROW("Weight streaming is only supported with TensorRT 10.0 or later.");
+#endif // NV_TENSORRT_MAJOR >= 10
 }
 
 nvinfer1::IExecutionContext& TllmRuntime::addContext(std::int32_t profileIndex)
 {
     TLLM_CHECK(0 <= profileIndex && profileIndex < mEngine->getNbOptimizationProfiles());
-    mContexts.emplace_back(mEngine->createExecutionContextWithoutDeviceMemory());
+    auto const startupScope = StartupProfiler::getInstance().scope(StartupPhase::kCONTEXT_CREATION);
+    {
+        // Runtimes sharing the engine may create contexts from several threads
+        static std::mutex contextCreationMutex;
+        std::lock_guard<std::mutex> lock(contextCreationMutex);
+        mContexts.emplace_back(mEngine->createExecutionContextWithoutDeviceMemory());
+    }
     if (!mContexts.back())
     {
 #if NV_TENSORRT_MAJOR >= 10
@@ -123,6 +499,37 @@ nvinfer1::IExecutionContext& TllmRuntime::addContext(std::int32_t profileIndex)
     return context;
 }
 
+std::size_t TllmRuntime::getDeviceMemorySize() const
+{
+    return mEngine->getDeviceMemorySize();
+}
+
+void TllmRuntime::setEngineBuffer(IBuffer::SharedPtr engineBuffer)
+{
+    TLLM_CHECK(engineBuffer);
+    TLLM_CHECK_WITH_INFO(engineBuffer->getMemoryType() == MemoryType::kGPU, "Engine buffer must be on the GPU.");
+    auto const devMemorySize = getDeviceMemorySize();
+    TLLM_CHECK_WITH_INFO(engineBuffer->getSizeInBytes() >= devMemorySize,
+        "Engine buffer of %zu bytes is too small, %zu bytes are needed.", engineBuffer->getSizeInBytes(),
+        devMemorySize);
+    if (mEngineBuffer->data() == engineBuffer->data())
+    {
+        return;
+    }
+    // Pending work of the contexts may still use the current buffer
+    mStream->synchronize();
+    mEngineBuffer = IBuffer::view(std::move(engineBuffer));
+    for (auto& context : mContexts)
+    {
+        if (context)
+        {
+            context->setDeviceMemory(mEngineBuffer->data());
+        }
+    }
+    TLLM_LOG_INFO("[MemUsageChange] Using a shared buffer of %.2f MiB for execution context memory.",
+        static_cast<double>(mEngineBuffer->getSizeInBytes()) / 1048576.0);
+}
+
 void TllmRuntime::clearContexts()
 {
     for (auto& context : mContexts)
@@ -136,9 +543,20 @@ bool TllmRuntime::executeContext(SizeType32 contextIndex) const
 {
     NVTX3_FUNC_RANGE();
     auto& context = getContext(contextIndex);
+    PluginTimer::getInstance().beginExecution();
+    NumericSentinel::getInstance().poll();
     return context.enqueueV3(mStream->get());
 }
 
+bool TllmRuntime::executeContext(SizeType32 contextIndex, CudaStream const& stream) const
+{
+    NVTX3_FUNC_RANGE();
+    auto& context = getContext(contextIndex);
+    PluginTimer::getInstance().beginExecution();
+    NumericSentinel::getInstance().poll();
+    return context.enqueueV3(stream.get());
+}
+
 void TllmRuntime::setInputTensors(SizeType32 contextIndex, TensorMap const& tensorMap)
 {
     NVTX3_FUNC_RANGE();
@@ -259,6 +677,62 @@ bool TllmRuntime::hasLayerProfiler(SizeType32 contextId) const
     return mContexts[contextId]->getProfiler() != nullptr;
 }
 
+bool TllmRuntime::isRefittable() const
+{
+    return mEngine->isRefittable();
+}
+
+void TllmRuntime::refitWeights(TensorMap const& weights)
+{
+    NVTX3_FUNC_RANGE();
+    TLLM_CHECK_WITH_INFO(isRefittable(), "The engine must be built refittable to update its weights in place.");
+    auto const start = std::chrono::steady_clock::now();
+    std::unique_ptr<nvinfer1::IRefitter> refitter{nvinfer1::createInferRefitter(*mEngine, *mRuntime->getLogger())};
+    TLLM_CHECK_WITH_INFO(refitter != nullptr, "Failed to create a refitter for the engine.");
+    std::size_t numBytes{0};
+    for (auto const& [name, tensor] : weights)
+    {
+        TLLM_CHECK_WITH_INFO(tensor != nullptr, "Weights %s are null", name.c_str());
+        nvinfer1::Weights const values{
+            tensor->getDataType(), tensor->data(), static_cast<std::int64_t>(tensor->getSize())};
+        auto const onDevice = tensor->getMemoryType() == MemoryType::kGPU;
+#if NV_TENSORRT_MAJOR >= 10
+        auto const isSet = refitter->setNamedWeights(
+            name.c_str(), values, onDevice ? nvinfer1::TensorLocation::kDEVICE : nvinfer1::TensorLocation::kHOST);
+#else
+        TLLM_CHECK_WITH_INFO(!onDevice, "Refitting with weights on the GPU needs TensorRT 10 or later.");
+        auto const isSet = refitter->setNamedWeights(name.c_str(), values);
+#endif // NV_TENSORRT_MAJOR >= 10
+        TLLM_CHECK_WITH_INFO(isSet, "The engine has no refittable weights %s of this type and size.", name.c_str());
+        numBytes += tensor->getSizeInBytes();
+    }
+    if (auto const numMissing = refitter->getMissingWeights(0, nullptr); numMissing > 0)
+    {
+        std::vector<char const*> missing(numMissing);
+        refitter->getMissingWeights(numMissing, missing.data());
+        TLLM_THROW("The refit is missing %d weights, the first one is %s", numMissing, missing.front());
+    }
+    // The contexts may still be executing with the current weights
+    mStream->synchronize();
+#if NV_TENSORRT_MAJOR >= 10
+    auto const isRefitted = refitter->refitCudaEngineAsync(mStream->get());
+    // The weights of the caller must stay valid until the copies are done
+    mStream->synchronize();
+#else
+    auto const isRefitted = refitter->refitCudaEngine();
+#endif // NV_TENSORRT_MAJOR >= 10
+    TLLM_CHECK_WITH_INFO(isRefitted, "Failed to refit the engine.");
+    auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    TLLM_LOG_INFO("Refitted %zu weights of %.2f MiB in %.2f s.", weights.size(),
+        static_cast<double>(numBytes) / 1048576.0, elapsed);
+}
+
+void TllmRuntime::refitWeights(std::filesystem::path const& weightsPath)
+{
+    MappedFile const file{weightsPath};
+    refitWeights(wrapSafetensors(file));
+}
+
 void TllmRuntime::setLayerProfiler()
 {
     mLayerProfiler.reset(new LayerProfiler);
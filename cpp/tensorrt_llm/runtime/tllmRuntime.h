@@ -22,6 +22,7 @@
 #include <NvInferRuntime.h>
 
 #include <cstdint>
+#include <filesystem>
 #include <memory>
 #include <vector>
 
@@ -53,6 +54,21 @@ public:
     {
     }
 
+    /// @brief Deserialize the engine straight from a file. The file is memory mapped and, with TensorRT 10 or later,
+    /// streamed to the engine, so that the host never holds a full copy of the engine.
+    explicit TllmRuntime(
+        std::filesystem::path const& enginePath, float const gpuWeightsPercent, nvinfer1::ILogger& logger);
+
+    explicit TllmRuntime(std::filesystem::path const& enginePath, float const gpuWeightsPercent);
+
+    /// @brief Create a runtime sharing the deserialized engine of this one, and so its weights on the GPU, e.g. to run
+    /// several sessions of the same engine in one process while paying for the weights once. The new runtime has its
+    /// own stream, execution contexts and activation memory. Settings of the engine, like the weight streaming budget,
+    /// and refits apply to all the runtimes sharing it. The engine lives as long as any of them.
+    [[nodiscard]] std::unique_ptr<TllmRuntime> shareEngine() const;
+
+    ~TllmRuntime();
+
     SizeType32 getNbContexts() const
     {
         return static_cast<SizeType32>(mContexts.size());
@@ -94,6 +110,9 @@ public:
 
     bool executeContext(SizeType32 contextIndex) const;
 
+    /// @brief Enqueue a context on another stream than the runtime stream, see TllmRuntimePipeline.
+    bool executeContext(SizeType32 contextIndex, CudaStream const& stream) const;
+
     CudaStream const& getStream() const;
 
     BufferManager::CudaStreamPtr getStreamPtr()
@@ -131,12 +150,63 @@ public:
         return mBufferManager;
     }
 
+    /// @brief Size of the device memory needed by the execution contexts for activations.
+    [[nodiscard]] std::size_t getDeviceMemorySize() const;
+
+    /// @brief Run the execution contexts on a device buffer provided by the caller instead of the one allocated by
+    /// the runtime, which is released. This allows runtimes of several engines to share activation memory, as long
+    /// as the caller never executes their contexts concurrently.
+    /// @param engineBuffer A GPU buffer of at least getDeviceMemorySize() bytes. The runtime holds a view of it, which
+    /// keeps it alive.
+    void setEngineBuffer(IBuffer::SharedPtr engineBuffer);
+
+    [[nodiscard]] IBuffer& getEngineBuffer()
+    {
+        return *mEngineBuffer;
+    }
+
+    [[nodiscard]] IBuffer const& getEngineBuffer() const
+    {
+        return *mEngineBuffer;
+    }
+
+    /// @brief Measure the bandwidth of pinned host to device copies on the runtime stream.
+    /// @return The bandwidth in bytes per second.
+    [[nodiscard]] double measureHostToDeviceBandwidth(
+        std::size_t copySize = std::size_t{64} << 20, SizeType32 numIterations = 4) const;
+
+    /// @brief Choose the weight streaming budget from the measured host to device bandwidth. Every forward pass
+    /// streams the weights that don't fit into the budget, which TensorRT prefetches ahead of the layers using them,
+    /// so the budget is the smallest one for which streaming takes at most maxStreamingTimeMs per forward pass. This
+    /// gives a bounded throughput cost instead of a cliff when the budget is too small. Must be called before any
+    /// context is added. A buffer set with setEngineBuffer is kept, so it must fit the activations of the budget.
+    /// @return The budget in bytes.
+    std::int64_t setWeightStreamingBudgetForStreamingTime(float maxStreamingTimeMs);
+
+    /// @brief Whether the weights of the engine can be updated in place, i.e. the engine was built refittable.
+    [[nodiscard]] bool isRefittable() const;
+
+    /// @brief Update weights of the engine in place, e.g. to roll out fine-tuned weights of the same model. The
+    /// contexts, their activation memory and the plugins are kept, so this takes about as long as copying the weights.
+    /// Must not overlap with the execution of the contexts. The weights not given keep their values.
+    /// @param weights The new weights by name, on the host or, with TensorRT 10 or later, on the GPU.
+    void refitWeights(TensorMap const& weights);
+
+    /// @brief Update weights of the engine in place from a safetensors file, which is memory mapped and never fully
+    /// copied on the host.
+    void refitWeights(std::filesystem::path const& weightsPath);
+
     void setLayerProfiler();
     bool hasLayerProfiler(SizeType32 contextId) const;
     std::string getLayerProfileInfo() const;
     void reportToProfiler(SizeType32 contextId);
 
 private:
+    //! @brief Create a runtime for an engine already counted in the shared engines, see shareEngine().
+    TllmRuntime(nvinfer1::IRuntime* runtime, nvinfer1::ICudaEngine* engine);
+
+    void initialize(float gpuWeightsPercent);
+
     BufferManager::CudaStreamPtr mStream;
     BufferManager mBufferManager;
     std::unique_ptr<nvinfer1::IRuntime> mRuntime;
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tllmRuntimePipeline.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+
+namespace tensorrt_llm::runtime
+{
+
+TllmRuntimePipeline::TllmRuntimePipeline(TllmRuntime& runtime, SizeType32 numStages)
+    : mRuntime{runtime}
+{
+    TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
+    TLLM_CHECK_WITH_INFO(numStages > 0, "The pipeline needs at least one stage.");
+    auto const devMemorySize = runtime.getDeviceMemorySize();
+    auto const& manager = runtime.getBufferManager();
+    mStages.reserve(numStages);
+    for (SizeType32 stage = 0; stage < numStages; ++stage)
+    {
+        // The first stage runs on the engine buffer of the runtime
+        IBuffer::SharedPtr engineBuffer = stage == 0 ? nullptr : IBuffer::SharedPtr{manager.gpu(devMemorySize)};
+        mStages.push_back(
+            Stage{std::make_shared<CudaStream>(StreamPriority::kHIGH), std::move(engineBuffer), CudaEvent{}});
+    }
+    // The buffers are allocated on the runtime stream but used on the stage streams
+    runtime.getStream().synchronize();
+    TLLM_LOG_INFO("[MemUsageChange] Allocated %.2f MiB for the execution context memory of %d pipeline stages.",
+        static_cast<double>(devMemorySize) * (numStages - 1) / 1048576.0, numStages - 1);
+    TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
+}
+
+void TllmRuntimePipeline::bindContext(SizeType32 contextIndex, SizeType32 stage)
+{
+    TLLM_CHECK(0 <= contextIndex && contextIndex < mRuntime.getNbContexts());
+    TLLM_CHECK(0 <= stage && stage < getNbStages());
+    if (static_cast<SizeType32>(mContextStages.size()) <= contextIndex)
+    {
+        mContextStages.resize(contextIndex + 1, -1);
+    }
+    auto& engineBuffer = stage == 0 ? mRuntime.getEngineBuffer() : *mStages[stage].engineBuffer;
+    mRuntime.getContext(contextIndex).setDeviceMemory(engineBuffer.data());
+    mContextStages[contextIndex] = stage;
+}
+
+SizeType32 TllmRuntimePipeline::getStage(SizeType32 contextIndex) const
+{
+    TLLM_CHECK(0 <= contextIndex);
+    return contextIndex < static_cast<SizeType32>(mContextStages.size()) ? mContextStages[contextIndex] : -1;
+}
+
+bool TllmRuntimePipeline::execute(SizeType32 contextIndex, CudaStream const& inputStream)
+{
+    NVTX3_FUNC_RANGE();
+    auto const stageIndex = getStage(contextIndex);
+    TLLM_CHECK_WITH_INFO(stageIndex >= 0, "Context %d is not bound to a pipeline stage.", contextIndex);
+    auto& stage = mStages[stageIndex];
+    // Previous executions of the stage are ordered by its stream, only the inputs need an event
+    inputStream.record(mInputsReady);
+    stage.stream->wait(mInputsReady);
+    auto const enqueued = mRuntime.executeContext(contextIndex, *stage.stream);
+    stage.stream->record(stage.executed);
+    return enqueued;
+}
+
+void TllmRuntimePipeline::waitForStage(SizeType32 stage, CudaStream const& stream) const
+{
+    stream.wait(mStages.at(stage).executed);
+}
+
+void TllmRuntimePipeline::synchronize() const
+{
+    for (auto const& stage : mStages)
+    {
+        stage.stream->synchronize();
+    }
+}
+
+} // namespace tensorrt_llm::runtime
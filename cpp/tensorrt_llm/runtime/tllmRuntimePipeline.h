@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+#include "tllmRuntime.h"
+
+#include <memory>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+/**
+ * \brief Executes the contexts of a TllmRuntime on several streams, so that the enqueue of a micro batch overlaps the
+ * execution of the previous ones.
+ * \details Each stage has its own stream and activation memory, so contexts bound to different stages can run
+ * concurrently. Micro batch i typically runs on stage i % getNbStages(). All ordering uses events: an execution waits
+ * for the work enqueued so far on the stream its inputs were prepared on, and consumers such as the decoder wait for
+ * a stage with waitForStage, so the host never blocks between micro batches. Contexts must be bound after any call
+ * to TllmRuntime::setEngineBuffer, which rebinds all contexts to a single buffer.
+ */
+class TllmRuntimePipeline
+{
+public:
+    /**
+     * \param numStages Number of micro batches in flight. Every stage but the first allocates
+     * TllmRuntime::getDeviceMemorySize() bytes of activation memory, the first one uses the runtime's engine buffer.
+     */
+    TllmRuntimePipeline(TllmRuntime& runtime, SizeType32 numStages);
+
+    [[nodiscard]] SizeType32 getNbStages() const noexcept
+    {
+        return static_cast<SizeType32>(mStages.size());
+    }
+
+    /**
+     * \brief Run a context on the stream and activation memory of a stage.
+     */
+    void bindContext(SizeType32 contextIndex, SizeType32 stage);
+
+    /**
+     * \brief Enqueue a bound context on the stream of its stage, after the work enqueued so far on inputStream.
+     * \returns -- Whether TensorRT enqueued the context.
+     */
+    bool execute(SizeType32 contextIndex, CudaStream const& inputStream);
+
+    /**
+     * \brief Enqueue a bound context after the work enqueued so far on the runtime stream.
+     */
+    bool execute(SizeType32 contextIndex)
+    {
+        return execute(contextIndex, mRuntime.getStream());
+    }
+
+    /**
+     * \brief Make a stream wait for the executions enqueued so far on a stage.
+     */
+    void waitForStage(SizeType32 stage, CudaStream const& stream) const;
+
+    [[nodiscard]] CudaStream const& getStream(SizeType32 stage) const
+    {
+        return *mStages.at(stage).stream;
+    }
+
+    [[nodiscard]] SizeType32 getStage(SizeType32 contextIndex) const;
+
+    void synchronize() const;
+
+private:
+    struct Stage
+    {
+        BufferManager::CudaStreamPtr stream;
+        //! Null for the first stage, which uses the engine buffer of the runtime.
+        IBuffer::SharedPtr engineBuffer;
+        CudaEvent executed;
+    };
+
+    TllmRuntime& mRuntime;
+    std::vector<Stage> mStages;
+    //! Stage of every context, -1 for unbound contexts.
+    std::vector<SizeType32> mContextStages;
+    CudaEvent mInputsReady;
+};
+
+} // namespace tensorrt_llm::runtime
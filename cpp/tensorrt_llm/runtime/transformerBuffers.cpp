@@ -36,6 +36,9 @@ TransformerBuffers::TransformerBuffers()
     kvCacheBlockPoolPointers = nullptr;
     kvCacheBlockOffsetsHost = nullptr;
     kvCacheBlockOffsetsDevice = nullptr;
+    kvCacheBlockOffsetsCopyPairs = nullptr;
+    kvCacheBlockOffsetsCopyEvent = nullptr;
+    kvCacheBlockOffsetsSliceCopyEvents.clear();
 }
 
 TransformerBuffers::TransformerBuffers(
@@ -71,14 +74,19 @@ TransformerBuffers::TransformerBuffers(
     if (modelConfig.usePagedKvCache())
     {
         auto const kvCacheBlockOffsetsType = engine.getTensorDataType("kv_cache_block_offsets");
-        kvCacheBlockOffsetsHost = manager.emptyTensor(MemoryType::kCPU, kvCacheBlockOffsetsType);
+        // Pinned so that changed rows can be gathered to the device by a kernel
+        kvCacheBlockOffsetsHost = manager.emptyTensor(MemoryType::kPINNED, kvCacheBlockOffsetsType);
         kvCacheBlockOffsetsDevice = manager.emptyTensor(MemoryType::kGPU, kvCacheBlockOffsetsType);
+        kvCacheBlockOffsetsCopyPairs = manager.emptyTensor(MemoryType::kPINNED, nvinfer1::DataType::kINT32);
+        kvCacheBlockOffsetsCopyEvent = std::make_shared<CudaEvent>();
     }
     else
     {
         presentKeysVals = utils::createBufferVector(runtime, localNbLayers, MemoryType::kGPU, kvDtype);
     }
 
+    positionIds = manager.emptyTensor(MemoryType::kGPU, nvinfer1::DataType::kINT32);
+
     if (modelConfig.useGptAttentionPlugin())
     {
         pastKeyValueLengths = manager.emptyTensor(MemoryType::kCPU, nvinfer1::DataType::kINT32);
@@ -114,6 +122,7 @@ void TransformerBuffers::reshape(
             cacheBlockOffsetsShape.d[0] = batchSize;
             kvCacheBlockOffsetsHost->reshape(cacheBlockOffsetsShape);
             kvCacheBlockOffsetsDevice->reshape(cacheBlockOffsetsShape);
+            kvCacheBlockOffsetsStale = true;
         }
         else
         {
@@ -144,6 +153,28 @@ void TransformerBuffers::reshape(
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+void TransformerBuffers::reserve(GenerationConfig const& generationConfig, ModelConfig const& modelConfig)
+{
+    // Context steps have up to maxInputLength < maxSeqLength positions per sequence, generation steps one per beam
+    // and GLM two ids per position
+    auto const idsPerPosition = modelConfig.getModelVariant() == ModelConfig::ModelVariant::kGlm ? 2 : 1;
+    auto const maxPositions = generationConfig.batchSize
+        * std::max(generationConfig.maxSeqLength, generationConfig.beamWidth) * idsPerPosition;
+    positionIds->reshape(ITensor::makeShape({maxPositions}));
+}
+
+void TransformerBuffers::copyPositionIds(
+    std::vector<SizeType32> const& positionIdsVec, ITensor::Shape const& shape, BufferManager const& manager)
+{
+    // The context buffers split from the generation buffers have none
+    if (!positionIds)
+    {
+        positionIds = manager.emptyTensor(MemoryType::kGPU, nvinfer1::DataType::kINT32);
+    }
+    positionIds->reshape(shape);
+    manager.copy(positionIdsVec.data(), *positionIds);
+}
+
 void TransformerBuffers::reshapeKvTensors(
     SizeType32 maxBatchSize, SizeType32 maxBeamWidth, SizeType32 maxBlocksPerSeq, runtime::TllmRuntime const& runtime)
 {
@@ -156,6 +187,8 @@ void TransformerBuffers::reshapeKvTensors(
 
     kvCacheBlockOffsetsDevice->reshape(cacheBlockOffsetsShape);
     manager.setZero(*kvCacheBlockOffsetsDevice);
+
+    kvCacheBlockOffsetsStale = true;
 }
 
 void TransformerBuffers::setKvPoolPointers(KvCacheManager const* kvCacheManager)
@@ -185,6 +218,18 @@ TransformerBuffers TransformerBuffers::sliceTo(
         buffers.kvCacheBlockOffsetsHost->reshape(cacheBlockOffsetsShape);
         buffers.kvCacheBlockOffsetsDevice = ITensor::slice(kvCacheBlockOffsetsDeviceView, offset, batchSize);
         buffers.kvCacheBlockOffsetsDevice->reshape(cacheBlockOffsetsShape);
+        // The context step copies whole slices, so only the event that guards the host rows is needed. It is created
+        // once per slice offset, since the buffers are split for every generate call.
+        if (kvCacheBlockOffsetsSliceCopyEvents.size() <= static_cast<std::size_t>(offset))
+        {
+            kvCacheBlockOffsetsSliceCopyEvents.resize(offset + 1);
+        }
+        auto& sliceCopyEvent = kvCacheBlockOffsetsSliceCopyEvents[offset];
+        if (!sliceCopyEvent)
+        {
+            sliceCopyEvent = std::make_shared<CudaEvent>();
+        }
+        buffers.kvCacheBlockOffsetsCopyEvent = sliceCopyEvent;
 
         buffers.kvCacheBlockPoolPointers = kvCacheBlockPoolPointers;
     }
@@ -306,7 +351,7 @@ void TransformerBuffers::prepareContextStep(RuntimeBuffers* runtimeBuffers, Tens
                 std::iota(begin, end, 0);
                 begin = end;
             }
-            positionIds = manager.copyFrom(positionIdsVec, inputShape, MemoryType::kGPU);
+            copyPositionIds(positionIdsVec, inputShape, manager);
         }
         else if (modelVariant == ModelConfig::ModelVariant::kGlm)
         {
@@ -316,12 +361,12 @@ void TransformerBuffers::prepareContextStep(RuntimeBuffers* runtimeBuffers, Tens
             {
                 int num_tokens = (int) positionIdsVec.size() / 2;
                 auto const positionIdsShape = ITensor::makeShape({2, num_tokens});
-                positionIds = manager.copyFrom(positionIdsVec, positionIdsShape, MemoryType::kGPU);
+                copyPositionIds(positionIdsVec, positionIdsShape, manager);
             }
             else
             {
                 auto const positionIdsShape = ITensor::makeShape({batchSize, 2, maxInputLength});
-                positionIds = manager.copyFrom(positionIdsVec, positionIdsShape, MemoryType::kGPU);
+                copyPositionIds(positionIdsVec, positionIdsShape, manager);
             }
         }
         else
@@ -367,7 +412,7 @@ void TransformerBuffers::prepareContextStep(RuntimeBuffers* runtimeBuffers, Tens
         for (std::size_t i = 0; i < positionIdsVec.size(); ++i)
             if (attentionMaskData[i] == 0)
                 positionIdsVec[i] = 1;
-        positionIds = manager.copyFrom(positionIdsVec, attentionMask->getShape(), MemoryType::kGPU);
+        copyPositionIds(positionIdsVec, attentionMask->getShape(), manager);
     }
 
     if (worldConfig.isPipelineParallel())
@@ -382,9 +427,10 @@ void TransformerBuffers::prepareContextStep(RuntimeBuffers* runtimeBuffers, Tens
     if (modelConfig.useGptAttentionPlugin() && modelConfig.usePagedKvCache())
     {
         auto constexpr contextBeamWidth = 1;
+        waitBlockOffsetsCopy();
         kvCacheManager->getBlockOffsetsOfBatch(
             *kvCacheBlockOffsetsHost, firstBatchSlotIdx, batchSize, contextBeamWidth);
-        manager.copy(*kvCacheBlockOffsetsHost, *kvCacheBlockOffsetsDevice);
+        copyBlockOffsetsToDevice(manager);
     }
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
@@ -508,9 +554,6 @@ void TransformerBuffers::postContextStep(RuntimeBuffers* runtimeBuffers,
         copyAttentionMasks(runtimeBuffers, contextBuffers, manager);
     }
 
-    // TODO(rkobus) handle this more gracefully
-    positionIds = manager.emptyTensor(MemoryType::kGPU, nvinfer1::DataType::kINT32);
-
     if (modelConfig.computeContextLogits())
     {
         runtimeBuffers->gatherLastTokenLogits(manager, modelConfig, worldConfig);
@@ -527,6 +570,7 @@ void TransformerBuffers::postContextStep(RuntimeBuffers* runtimeBuffers,
         cacheBlockOffsetsShape.d[0] = batchSize * beamWidth;
         kvCacheBlockOffsetsHost->reshape(cacheBlockOffsetsShape);
         kvCacheBlockOffsetsDevice->reshape(cacheBlockOffsetsShape);
+        kvCacheBlockOffsetsStale = true;
     }
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
@@ -585,12 +629,12 @@ void TransformerBuffers::prepareNextStep(RuntimeBuffers* runtimeBuffers, SizeTyp
             if (modelConfig.usePackedInput())
             {
                 auto const positionIdsShape = ITensor::makeShape({2, batchSize * beamWidth});
-                positionIds = manager.copyFrom(positionIdsVec, positionIdsShape, MemoryType::kGPU);
+                copyPositionIds(positionIdsVec, positionIdsShape, manager);
             }
             else
             {
                 auto const positionIdsShape = ITensor::makeShape({batchSize * beamWidth, 2, 1});
-                positionIds = manager.copyFrom(positionIdsVec, positionIdsShape, MemoryType::kGPU);
+                copyPositionIds(positionIdsVec, positionIdsShape, manager);
             }
         }
         else
@@ -627,7 +671,7 @@ void TransformerBuffers::prepareNextStep(RuntimeBuffers* runtimeBuffers, SizeTyp
         for (SizeType32 i = 0; i < nbInputs; ++i)
             positionIdsEndVec[i] = positionIdsVec[(i + 1) * newLength - 1];
 
-        positionIds = manager.copyFrom(positionIdsEndVec, ITensor::makeShape({nbInputs, 1}), MemoryType::kGPU);
+        copyPositionIds(positionIdsEndVec, ITensor::makeShape({nbInputs, 1}), manager);
     }
 
     if (worldConfig.isPipelineParallel())
@@ -641,16 +685,78 @@ void TransformerBuffers::prepareNextStep(RuntimeBuffers* runtimeBuffers, SizeTyp
 
     if (modelConfig.usePagedKvCache())
     {
+        // Only the sequences for which addToken allocates blocks get new offsets.
+        std::vector<SizeType32> changedRows;
         for (auto batchIdx = firstBatchSlotIdx; batchIdx < firstBatchSlotIdx + batchSize; ++batchIdx)
         {
+            auto const numUsedBlocks = kvCacheManager->getUsedNumBlocks();
             kvCacheManager->addToken(batchIdx);
+            if (kvCacheManager->getUsedNumBlocks() != numUsedBlocks)
+            {
+                for (SizeType32 beam = 0; beam < beamWidth; ++beam)
+                {
+                    changedRows.push_back((batchIdx - firstBatchSlotIdx) * beamWidth + beam);
+                }
+            }
         }
+        waitBlockOffsetsCopy();
         kvCacheManager->getBlockOffsetsOfBatch(*kvCacheBlockOffsetsHost, firstBatchSlotIdx, batchSize, beamWidth);
-        manager.copy(*kvCacheBlockOffsetsHost, *kvCacheBlockOffsetsDevice);
+        if (kvCacheBlockOffsetsStale)
+        {
+            copyBlockOffsetsToDevice(manager);
+        }
+        else
+        {
+            copyBlockOffsetsToDevice(manager, changedRows);
+        }
     }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+void TransformerBuffers::waitBlockOffsetsCopy() const
+{
+    kvCacheBlockOffsetsCopyEvent->synchronize();
+}
+
+void TransformerBuffers::copyBlockOffsetsToDevice(BufferManager const& manager)
+{
+    manager.copy(*kvCacheBlockOffsetsHost, *kvCacheBlockOffsetsDevice);
+    manager.getStream().record(*kvCacheBlockOffsetsCopyEvent);
+    kvCacheBlockOffsetsStale = false;
+}
+
+void TransformerBuffers::copyBlockOffsetsToDevice(
+    BufferManager const& manager, std::vector<SizeType32> const& changedRows)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    auto const numRows = static_cast<SizeType32>(kvCacheBlockOffsetsHost->getShape().d[0]);
+    auto const numChangedRows = static_cast<SizeType32>(changedRows.size());
+    if (2 * numChangedRows > numRows)
+    {
+        copyBlockOffsetsToDevice(manager);
+        return;
+    }
+    if (numChangedRows == 0)
+    {
+        return;
+    }
+
+    // The previous copy has completed (see waitBlockOffsetsCopy), so the pairs can be resized and overwritten.
+    kvCacheBlockOffsetsCopyPairs->reshape(ITensor::makeShape({numChangedRows, 2}));
+    auto* pairsPtr = bufferCast<SizeType32>(*kvCacheBlockOffsetsCopyPairs);
+    for (SizeType32 i = 0; i < numChangedRows; ++i)
+    {
+        pairsPtr[2 * i] = changedRows[i];
+        pairsPtr[2 * i + 1] = changedRows[i];
+    }
+
+    auto const& stream = manager.getStream();
+    kernels::invokeCopyBlocks(
+        *kvCacheBlockOffsetsHost, *kvCacheBlockOffsetsDevice, *kvCacheBlockOffsetsCopyPairs, numChangedRows, stream);
+    stream.record(*kvCacheBlockOffsetsCopyEvent);
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 void TransformerBuffers::getRuntimeBuffers(RuntimeBuffers const* runtimeBuffers, TensorMap& inputBuffers,
     TensorMap& outputBuffers, SizeType32 const step, TensorPtr const& inputIds, ModelConfig const& modelConfig,
     WorldConfig const& worldConfig) const
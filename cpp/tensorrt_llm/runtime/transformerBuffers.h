@@ -18,6 +18,7 @@
 
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
 #include "tensorrt_llm/runtime/generationConfig.h"
 #include "tensorrt_llm/runtime/iTensor.h"
 #include "tensorrt_llm/runtime/modelConfig.h"
@@ -49,6 +50,9 @@ public:
     void reshape(
         GenerationConfig const& generationConfig, ModelConfig const& modelConfig, WorldConfig const& worldConfig);
 
+    //! \brief Reshapes the tensors that vary with the input and the step to their largest shape for generationConfig.
+    void reserve(GenerationConfig const& generationConfig, ModelConfig const& modelConfig);
+
     void reshapeKvTensors(SizeType32 maxBatchSize, SizeType32 maxBeamWidth, SizeType32 maxBlocksPerSeq,
         runtime::TllmRuntime const& runtime);
 
@@ -81,6 +85,21 @@ protected:
     void tile(RuntimeBuffers* runtimeBuffers, BufferManager& manager, ModelConfig const& modelConfig,
         WorldConfig const& worldConfig);
 
+    //! \brief Copy positionIdsVec into positionIds, reusing its memory.
+    void copyPositionIds(
+        std::vector<SizeType32> const& positionIdsVec, ITensor::Shape const& shape, BufferManager const& manager);
+
+    //! \brief Wait until the previous copy of kvCacheBlockOffsetsHost has been consumed, before overwriting it.
+    void waitBlockOffsetsCopy() const;
+
+    //! \brief Copy kvCacheBlockOffsetsHost to the device.
+    void copyBlockOffsetsToDevice(BufferManager const& manager);
+
+    //! \brief Copy the given rows of kvCacheBlockOffsetsHost to the device, the other rows are up to date.
+    //! \details Between generation steps only sequences that allocated a new block have new offsets, so at large batch
+    //! sizes and long contexts this avoids copying the whole [batchSize * beamWidth, 2, maxBlocksPerSeq] table.
+    void copyBlockOffsetsToDevice(BufferManager const& manager, std::vector<SizeType32> const& changedRows);
+
 public:
     // engine
     TensorPtr pastKeyValueLengths; // with attention plugin, host tensor
@@ -94,6 +113,14 @@ public:
     TensorPtr kvCacheBlockPoolPointers;
     TensorPtr kvCacheBlockOffsetsHost;         // [batchSize * beamWidth, 2, maxBlocksPerSeq * 2]
     TensorPtr kvCacheBlockOffsetsDevice;       // [batchSize * beamWidth, 2, maxBlocksPerSeq * 2]
+
+private:
+    TensorPtr kvCacheBlockOffsetsCopyPairs; // pinned, (row, row) pairs of the rows to copy
+    std::shared_ptr<CudaEvent> kvCacheBlockOffsetsCopyEvent;
+    // Events of the context batch slices by offset, kept across sliceTo calls
+    std::vector<std::shared_ptr<CudaEvent>> kvCacheBlockOffsetsSliceCopyEvents;
+    // The device table does not match the layout of the host table, e.g. after the context step
+    bool kvCacheBlockOffsetsStale{true};
 };
 
 } // namespace tensorrt_llm::runtime
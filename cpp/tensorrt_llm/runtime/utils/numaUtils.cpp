@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/utils/numaUtils.h"
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tc = tensorrt_llm::common;
+
+namespace tensorrt_llm::runtime::utils
+{
+
+namespace
+{
+//! \returns The sysfs directory of the PCI device of device, e.g. /sys/bus/pci/devices/0000:3b:00.0
+std::string getDeviceSysfsPath(int device)
+{
+    char busId[32]{};
+    if (cudaDeviceGetPCIBusId(busId, sizeof(busId), device) != cudaSuccess)
+    {
+        return {};
+    }
+    std::string path{"/sys/bus/pci/devices/"};
+    for (char const* c = busId; *c != '\0'; ++c)
+    {
+        path += static_cast<char>(std::tolower(static_cast<unsigned char>(*c)));
+    }
+    return path;
+}
+
+std::string readFirstLine(std::string const& path)
+{
+    std::ifstream file{path};
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+} // namespace
+
+std::vector<int> parseCpuList(std::string const& cpuList)
+{
+    std::vector<int> cpus;
+    std::stringstream ss{cpuList};
+    std::string range;
+    while (std::getline(ss, range, ','))
+    {
+        if (range.empty())
+        {
+            continue;
+        }
+        auto const dash = range.find('-');
+        auto const first = std::stoi(range.substr(0, dash));
+        auto const last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        TLLM_CHECK_WITH_INFO(first >= 0 && first <= last, "Invalid CPU range %s.", range.c_str());
+        for (int cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+int getDeviceNumaNode(int device)
+{
+    auto const path = getDeviceSysfsPath(device);
+    if (path.empty())
+    {
+        return -1;
+    }
+    auto const node = readFirstLine(path + "/numa_node");
+    // Single node hosts report -1
+    return node.empty() ? -1 : std::stoi(node);
+}
+
+std::vector<int> getDeviceLocalCpus(int device)
+{
+    auto const path = getDeviceSysfsPath(device);
+    if (path.empty())
+    {
+        return {};
+    }
+    return parseCpuList(readFirstLine(path + "/local_cpulist"));
+}
+
+std::vector<int> getDeviceThreadAffinity(int device)
+{
+    auto const affinity = tc::getEnvCpuAffinity();
+    if (!affinity)
+    {
+        return {};
+    }
+    if (*affinity == "gpu")
+    {
+        return getDeviceLocalCpus(device);
+    }
+    return parseCpuList(*affinity);
+}
+
+bool setThreadAffinity(std::vector<int> const& cpus)
+{
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (auto const cpu : cpus)
+    {
+        TLLM_CHECK_WITH_INFO(cpu < CPU_SETSIZE, "CPU %d is out of range.", cpu);
+        CPU_SET(cpu, &cpuSet);
+    }
+    if (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) != 0)
+    {
+        TLLM_LOG_WARNING("Failed to set the CPU affinity of the thread: %s", std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void bindThreadToDevice(int device)
+{
+    auto const cpus = getDeviceThreadAffinity(device);
+    if (!cpus.empty())
+    {
+        setThreadAffinity(cpus);
+    }
+}
+
+bool bindMemoryToNode(void* ptr, std::size_t size, int node)
+{
+    auto constexpr maxNode = static_cast<int>(sizeof(unsigned long) * 8);
+    if (node < 0 || node >= maxNode)
+    {
+        return false;
+    }
+    unsigned long const nodeMask = 1UL << node;
+    // The kernel ignores the last bit of the mask
+    if (syscall(SYS_mbind, ptr, size, MPOL_PREFERRED, &nodeMask, maxNode + 1, 0) != 0)
+    {
+        TLLM_LOG_WARNING("Failed to bind host memory to NUMA node %d: %s", node, std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+} // namespace tensorrt_llm::runtime::utils
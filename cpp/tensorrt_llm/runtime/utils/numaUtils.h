@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm::runtime::utils
+{
+
+//! \brief Parses a Linux CPU list such as "0-3,8,10-11".
+std::vector<int> parseCpuList(std::string const& cpuList);
+
+//! \returns The NUMA node attached to device, or -1 if unknown.
+int getDeviceNumaNode(int device);
+
+//! \returns The CPUs of the NUMA node attached to device, empty if unknown.
+std::vector<int> getDeviceLocalCpus(int device);
+
+//! \returns The CPUs that the threads driving device are pinned to, from TRTLLM_CPU_AFFINITY: "gpu" for the CPUs local
+//! to the device, or a CPU list. Empty if the threads are not pinned.
+std::vector<int> getDeviceThreadAffinity(int device);
+
+//! \brief Pins the calling thread to cpus.
+//! \returns False, with a warning, if the affinity couldn't be set.
+bool setThreadAffinity(std::vector<int> const& cpus);
+
+//! \brief Pins the calling thread according to getDeviceThreadAffinity, no-op if unset.
+void bindThreadToDevice(int device);
+
+//! \brief Makes node the preferred node of the pages of [ptr, ptr + size), which must not be touched yet.
+//! \returns False if the policy couldn't be set, the pages are then placed by the default policy.
+bool bindMemoryToNode(void* ptr, std::size_t size, int node);
+
+} // namespace tensorrt_llm::runtime::utils
@@ -17,12 +17,20 @@
 #include "tensorrt_llm/runtime/utils/numpyUtils.h"
 
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/common/stringUtils.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/iTensor.h"
 #include <NvInferRuntime.h>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -180,6 +188,160 @@ int parseNpyHeader(FILE*& f_ptr, uint32_t header_len, nvinfer1::DataType& type,
     return tensor;
 }
 
+namespace
+{
+
+//! \brief Read-only mapping of a numpy file, owning the mapping and its registration with CUDA.
+class MappedNpyBuffer : public IBuffer
+{
+public:
+    MappedNpyBuffer(std::string const& npyFile, std::size_t dataOffset, std::size_t size, DataType type, bool pinned)
+        : mSize{size}
+        , mType{type}
+    {
+        auto const fd = ::open(npyFile.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            TLLM_THROW("Could not open file %s: %s", npyFile.c_str(), std::strerror(errno));
+        }
+        struct stat fileStat
+        {
+        };
+        if (::fstat(fd, &fileStat) != 0)
+        {
+            ::close(fd);
+            TLLM_THROW("Failed to get the size of file %s", npyFile.c_str());
+        }
+        mMappingSize = static_cast<std::size_t>(fileStat.st_size);
+        auto const dataBytes = BufferDataType(type).getSize() * size;
+        if (mMappingSize < dataOffset + dataBytes)
+        {
+            ::close(fd);
+            TLLM_THROW("File %s is truncated, %zu bytes of data expected", npyFile.c_str(), dataBytes);
+        }
+        // Shared and read-only, so that the pages of the page cache are used and pinned as they are, never copied
+        mMapping = ::mmap(nullptr, mMappingSize, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mMapping == MAP_FAILED)
+        {
+            TLLM_THROW("Failed to map file %s: %s", npyFile.c_str(), std::strerror(errno));
+        }
+        if (pinned)
+        {
+            auto const status = ::cudaHostRegister(mMapping, mMappingSize, cudaHostRegisterReadOnly);
+            if (status != cudaSuccess)
+            {
+                ::munmap(mMapping, mMappingSize);
+                TLLM_CUDA_CHECK(status);
+            }
+            mRegistered = true;
+        }
+        else
+        {
+            ::madvise(mMapping, mMappingSize, MADV_SEQUENTIAL);
+        }
+        mData = static_cast<std::uint8_t*>(mMapping) + dataOffset;
+    }
+
+    ~MappedNpyBuffer() override
+    {
+        release();
+    }
+
+    [[nodiscard]] void* data() override
+    {
+        return mData;
+    }
+
+    [[nodiscard]] void const* data() const override
+    {
+        return mData;
+    }
+
+    [[nodiscard]] std::size_t getSize() const override
+    {
+        return mSize;
+    }
+
+    [[nodiscard]] std::size_t getCapacity() const override
+    {
+        return mSize;
+    }
+
+    [[nodiscard]] DataType getDataType() const override
+    {
+        return mType;
+    }
+
+    [[nodiscard]] MemoryType getMemoryType() const override
+    {
+        return mRegistered ? MemoryType::kPINNED : MemoryType::kCPU;
+    }
+
+    void resize(std::size_t newSize) override
+    {
+        TLLM_CHECK_WITH_INFO(newSize <= mSize, "A mapped numpy file can't grow.");
+        mSize = newSize;
+    }
+
+    void release() override
+    {
+        if (mMapping == nullptr)
+        {
+            return;
+        }
+        if (mRegistered)
+        {
+            TLLM_CUDA_CHECK_FREE_RESOURCE(::cudaHostUnregister(mMapping));
+        }
+        ::munmap(mMapping, mMappingSize);
+        mMapping = nullptr;
+        mData = nullptr;
+        mSize = 0;
+    }
+
+private:
+    void* mMapping{nullptr};
+    std::size_t mMappingSize{0};
+    void* mData{nullptr};
+    std::size_t mSize;
+    DataType mType;
+    bool mRegistered{false};
+};
+
+} // namespace
+
+ITensor::SharedPtr mapNpy(std::string const& npyFile, bool pinned)
+{
+    FILE* f_ptr = fopen(npyFile.c_str(), "rb");
+    if (f_ptr == nullptr)
+    {
+        throw std::runtime_error("Could not open file " + npyFile);
+    }
+    uint32_t header_len, start_data;
+    nvinfer1::DataType type;
+    std::vector<size_t> shape;
+    try
+    {
+        utils::parseNpyIntro(f_ptr, header_len, start_data);
+        utils::parseNpyHeader(f_ptr, header_len, type, shape);
+    }
+    catch (...)
+    {
+        fclose(f_ptr);
+        throw;
+    }
+    fclose(f_ptr);
+
+    nvinfer1::Dims dims;
+    dims.nbDims = shape.size();
+    std::copy(shape.begin(), shape.end(), dims.d);
+    auto const size = static_cast<std::size_t>(ITensor::volume(dims));
+
+    auto buffer = std::make_shared<MappedNpyBuffer>(npyFile, start_data, size, type, pinned);
+    return ITensor::view(std::move(buffer), dims);
+}
+
 void saveNpy(BufferManager& manager, ITensor const& tensor, std::string const& filename)
 {
     // Save tensor to NPY 1.0 format (see https://numpy.org/neps/nep-0001-npy-format.html)
@@ -27,6 +27,13 @@ namespace tensorrt_llm::runtime::utils
 //! \brief Create new tensor from numpy file.
 [[nodiscard]] ITensor::UniquePtr loadNpy(BufferManager& manager, std::string const& npyFile, const MemoryType where);
 
+//! \brief Create a tensor viewing the data of a numpy file mapped in memory, without reading it into a buffer.
+//! \details The pages are read from the page cache as they're touched, and the mapping lives as long as the tensor.
+//! The tensor is read-only, writing to it faults.
+//! \param pinned Register the mapping with CUDA, so that copies to the GPU are DMAs from the mapped pages instead of
+//! being staged through pageable memory. The tensor is then kPINNED, otherwise kCPU.
+[[nodiscard]] ITensor::SharedPtr mapNpy(std::string const& npyFile, bool pinned = false);
+
 //! \brief Save tensor to numpy file.
 void saveNpy(BufferManager& manager, ITensor const& tensor, std::string const& filename);
 
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/workerPool.h"
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/utils/numaUtils.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+// The pool and the index of the worker running on this thread, so that tasks submit to their own queue
+thread_local WorkerPool const* tlPool{nullptr};
+thread_local std::size_t tlWorkerIdx{0};
+} // namespace
+
+WorkerPool::WorkerPool(std::size_t numWorkers, int device)
+    : mNumWorkers(numWorkers)
+    , mDevice(device)
+{
+    if (mNumWorkers > kMaxNumWorkers)
+    {
+        throw std::runtime_error(
+            "numWorker > maxNumWorkers " + std::to_string(mNumWorkers) + " > " + std::to_string(kMaxNumWorkers));
+    }
+    mQueues.reserve(mNumWorkers);
+    for (std::size_t i = 0; i < mNumWorkers; ++i)
+    {
+        mQueues.emplace_back(std::make_unique<Queue>());
+    }
+    mThreads.reserve(mNumWorkers);
+    for (std::size_t i = 0; i < mNumWorkers; ++i)
+    {
+        mThreads.emplace_back(&WorkerPool::doWork, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    shutdown();
+}
+
+void WorkerPool::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mIdleMutex);
+        if (mShutdown)
+        {
+            return;
+        }
+        mShutdown = true;
+    }
+    mIdleCv.notify_all();
+    for (auto& thread : mThreads)
+    {
+        thread.join();
+    }
+}
+
+void WorkerPool::push(WorkerTask task, TaskPriority priority)
+{
+    if (mShutdown)
+    {
+        throw std::runtime_error("WorkerPool is shutdown cannot enqueue new tasks");
+    }
+    if (mNumWorkers == 0)
+    {
+        throw std::runtime_error("WorkerPool has no workers to run tasks");
+    }
+
+    auto const queueIdx
+        = tlPool == this ? tlWorkerIdx : mNextQueue.fetch_add(1, std::memory_order_relaxed) % mNumWorkers;
+    auto& queue = *mQueues[queueIdx];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.lanes[static_cast<std::size_t>(priority)].push_back(std::move(task));
+        // Counted under the lock of the queue, so that the pop of this task can't decrement it first
+        mPending.fetch_add(1);
+    }
+    // Either this sees the idle worker, or the worker sees the pending task before it sleeps
+    if (mNumIdle.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mIdleMutex);
+        }
+        mIdleCv.notify_one();
+    }
+}
+
+WorkerTask WorkerPool::pop(std::size_t workerIdx)
+{
+    for (std::size_t lane = 0; lane < kNumPriorities; ++lane)
+    {
+        for (std::size_t i = 0; i < mNumWorkers; ++i)
+        {
+            auto const victimIdx = (workerIdx + i) % mNumWorkers;
+            auto& queue = *mQueues[victimIdx];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            auto& tasks = queue.lanes[lane];
+            if (tasks.empty())
+            {
+                continue;
+            }
+            // The owner takes the oldest task, thieves the newest one, so that they meet at different ends
+            WorkerTask task;
+            if (victimIdx == workerIdx)
+            {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            else
+            {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+            }
+            mPending.fetch_sub(1);
+            return task;
+        }
+    }
+    return {};
+}
+
+void WorkerPool::doWork(std::size_t workerIdx)
+{
+    if (mDevice >= 0)
+    {
+        TLLM_CUDA_CHECK(cudaSetDevice(mDevice));
+        utils::bindThreadToDevice(mDevice);
+    }
+    else
+    {
+        TLLM_LOG_WARNING("WorkerPool did not set cuda device");
+    }
+    tlPool = this;
+    tlWorkerIdx = workerIdx;
+
+    while (!mShutdown)
+    {
+        if (auto task = pop(workerIdx))
+        {
+            try
+            {
+                task();
+            }
+            catch (std::exception const& e)
+            {
+                TLLM_LOG_EXCEPTION(e);
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mIdleMutex);
+        mNumIdle.fetch_add(1);
+        mIdleCv.wait(lock, [this]() { return mPending.load() > 0 || mShutdown; });
+        mNumIdle.fetch_sub(1);
+    }
+    tlPool = nullptr;
+}
+
+} // namespace tensorrt_llm::runtime
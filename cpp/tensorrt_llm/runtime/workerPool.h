@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2022-2023, NVIDIA CORPORATION.  All rights reserved.
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -16,138 +16,218 @@
 
 #pragma once
 
-#include "tensorrt_llm/common/cudaUtils.h"
-#include "tensorrt_llm/common/logger.h"
+#include <array>
+#include <atomic>
 #include <condition_variable>
-#include <exception>
-#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
-#include <stdexcept>
+#include <new>
 #include <thread>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace tensorrt_llm::runtime
 {
 
-class WorkerPool
+//! \brief Lane of a task in the WorkerPool. Workers always run the tasks of a higher lane first.
+enum class TaskPriority : std::uint8_t
+{
+    kHIGH = 0,
+    kNORMAL = 1,
+    kLOW = 2,
+};
+
+//! \brief Move-only type-erased void() callable. Callables of up to kInlineSize bytes are stored in place, without
+//! heap allocation.
+class WorkerTask
 {
 public:
-    explicit WorkerPool(std::size_t numWorkers = 1, int device = -1)
-        : mNumWorkers(numWorkers)
-        , mShutdown(false)
-        , mDevice(device)
-    {
-        initThreads();
-    }
+    static constexpr std::size_t kInlineSize = 48;
+
+    WorkerTask() noexcept = default;
 
-    ~WorkerPool()
+    template <typename Function, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Function>, WorkerTask>>>
+    WorkerTask(Function&& function) // NOLINT(*-explicit-constructor)
     {
-        shutdown();
+        using Fn = std::decay_t<Function>;
+        if constexpr (isInline<Fn>())
+        {
+            new (&mStorage) Fn(std::forward<Function>(function));
+            mOps = &kInlineOps<Fn>;
+        }
+        else
+        {
+            *reinterpret_cast<Fn**>(&mStorage) = new Fn(std::forward<Function>(function));
+            mOps = &kHeapOps<Fn>;
+        }
     }
 
-    template <typename Function, typename Return = std::invoke_result_t<std::decay_t<Function>>>
-    std::future<Return> enqueue(Function&& task)
+    WorkerTask(WorkerTask&& other) noexcept
+        : mOps{std::exchange(other.mOps, nullptr)}
     {
-        if (mShutdown)
+        if (mOps)
         {
-            throw std::runtime_error("WorkerPool is shutdown cannot enqueue new tasks");
+            mOps->move(&mStorage, &other.mStorage);
         }
+    }
 
-        auto const taskPromise = std::make_shared<std::promise<Return>>();
-        std::lock_guard<std::mutex> lock(mTasksMutex);
-        mTasks.push(
-            [task = std::forward<Function>(task), taskPromise]()
+    WorkerTask& operator=(WorkerTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            mOps = std::exchange(other.mOps, nullptr);
+            if (mOps)
             {
-                try
-                {
-                    if constexpr (std::is_void_v<Return>)
-                    {
-                        task();
-                        taskPromise->set_value();
-                    }
-                    else
-                    {
-                        taskPromise->set_value(task());
-                    }
-                }
-                catch (...)
-                {
-                    taskPromise->set_exception(std::current_exception());
-                }
-            });
-        mTasksCv.notify_one();
-        return taskPromise->get_future();
+                mOps->move(&mStorage, &other.mStorage);
+            }
+        }
+        return *this;
     }
 
-private:
-    static constexpr size_t kMaxNumWorkers = 128;
-    std::size_t mNumWorkers;
+    WorkerTask(WorkerTask const&) = delete;
+    WorkerTask& operator=(WorkerTask const&) = delete;
 
-    std::queue<std::function<void()>> mTasks{};
-    mutable std::mutex mTasksMutex;
-    std::condition_variable mTasksCv;
+    ~WorkerTask()
+    {
+        reset();
+    }
 
-    std::atomic<bool> mShutdown = false;
+    void operator()()
+    {
+        mOps->invoke(&mStorage);
+    }
 
-    std::thread mThreads[kMaxNumWorkers];
+    explicit operator bool() const noexcept
+    {
+        return mOps != nullptr;
+    }
 
-    int mDevice{-1};
+    //! \returns True if the callable is stored in place.
+    [[nodiscard]] bool isInline() const noexcept
+    {
+        return mOps != nullptr && mOps->isInline;
+    }
 
-    void shutdown()
+private:
+    struct Ops
+    {
+        void (*invoke)(void* storage);
+        // Moves the callable from src to dst and destroys what is left in src
+        void (*move)(void* dst, void* src) noexcept;
+        void (*destroy)(void* storage) noexcept;
+        bool isInline;
+    };
+
+    template <typename Fn>
+    static constexpr bool isInline()
     {
-        if (mShutdown)
+        return sizeof(Fn) <= kInlineSize && alignof(Fn) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template <typename Fn>
+    static constexpr Ops kInlineOps{[](void* storage) { (*static_cast<Fn*>(storage))(); },
+        [](void* dst, void* src) noexcept
         {
-            return;
-        }
-        mShutdown = true;
-        mTasksCv.notify_all();
-        for (std::size_t i = 0; i < mNumWorkers; ++i)
+            new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* storage) noexcept { static_cast<Fn*>(storage)->~Fn(); }, true};
+
+    template <typename Fn>
+    static constexpr Ops kHeapOps{[](void* storage) { (**static_cast<Fn**>(storage))(); },
+        [](void* dst, void* src) noexcept { *static_cast<Fn**>(dst) = *static_cast<Fn**>(src); },
+        [](void* storage) noexcept { delete *static_cast<Fn**>(storage); }, false};
+
+    void reset() noexcept
+    {
+        if (mOps)
         {
-            mThreads[i].join();
+            mOps->destroy(&mStorage);
+            mOps = nullptr;
         }
     }
 
-    void initThreads()
+    alignas(std::max_align_t) std::byte mStorage[kInlineSize];
+    Ops const* mOps{nullptr};
+};
+
+//! \brief Work-stealing thread pool with priority lanes.
+//! \details Every worker owns a queue per lane. Tasks submitted from outside of the pool are spread over the queues
+//! round-robin, tasks submitted by a worker go to its own queue. An idle worker takes the oldest task of its own queue
+//! and otherwise steals the newest one of another worker, lane by lane, so that e.g. LoRA loads, KV cache offload
+//! bookkeeping and response serialization don't wait behind each other on a single queue. The queues are guarded by
+//! one mutex each, which is only contended by stealing.
+class WorkerPool
+{
+public:
+    static constexpr std::size_t kNumPriorities = 3;
+
+    //! \param device Device of the worker threads, or -1 to leave it unset.
+    explicit WorkerPool(std::size_t numWorkers = 1, int device = -1);
+
+    ~WorkerPool();
+
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+
+    //! \brief Runs task on a worker.
+    //! \returns The result of task, or the exception it threw.
+    template <typename Function, typename Return = std::invoke_result_t<std::decay_t<Function>>>
+    std::future<Return> enqueue(Function&& task, TaskPriority priority = TaskPriority::kNORMAL)
     {
-        if (mNumWorkers > kMaxNumWorkers)
-        {
-            throw std::runtime_error(
-                "numWorker > maxNumWorkers " + std::to_string(mNumWorkers) + " > " + std::to_string(kMaxNumWorkers));
-        }
-        for (std::size_t i = 0; i < mNumWorkers; ++i)
-        {
-            mThreads[i] = std::thread(&WorkerPool::doWork, this);
-        }
+        std::packaged_task<Return()> packagedTask{std::forward<Function>(task)};
+        auto future = packagedTask.get_future();
+        push(WorkerTask{std::move(packagedTask)}, priority);
+        return future;
     }
 
-    void doWork()
+    //! \brief Runs task on a worker, without a future. Small tasks don't allocate. Exceptions are logged.
+    template <typename Function>
+    void post(Function&& task, TaskPriority priority = TaskPriority::kNORMAL)
     {
-        if (mDevice >= 0)
-        {
-            TLLM_CUDA_CHECK(cudaSetDevice(mDevice));
-        }
-        else
-        {
-            TLLM_LOG_WARNING("WorkerPool did not set cuda device");
-        }
-        while (!mShutdown)
-        {
-            std::function<void()> task;
-            {
-                std::unique_lock<std::mutex> lock(mTasksMutex);
-                mTasksCv.wait(lock, [this]() { return !mTasks.empty() || mShutdown; });
-                if (mTasks.empty())
-                {
-                    continue;
-                }
-                task = mTasks.front();
-                mTasks.pop();
-            }
+        push(WorkerTask{std::forward<Function>(task)}, priority);
+    }
 
-            task();
-        }
+    [[nodiscard]] std::size_t getNumWorkers() const noexcept
+    {
+        return mNumWorkers;
     }
+
+private:
+    static constexpr size_t kMaxNumWorkers = 128;
+
+    struct alignas(64) Queue
+    {
+        std::mutex mutex;
+        std::array<std::deque<WorkerTask>, kNumPriorities> lanes;
+    };
+
+    void push(WorkerTask task, TaskPriority priority);
+    WorkerTask pop(std::size_t workerIdx);
+    void shutdown();
+    void doWork(std::size_t workerIdx);
+
+    std::size_t mNumWorkers;
+    int mDevice{-1};
+
+    std::vector<std::unique_ptr<Queue>> mQueues;
+    std::atomic<std::size_t> mNextQueue{0};
+    // Number of queued tasks, incremented after a push and decremented by a pop
+    std::atomic<std::size_t> mPending{0};
+
+    std::mutex mIdleMutex;
+    std::condition_variable mIdleCv;
+    std::atomic<std::size_t> mNumIdle{0};
+    std::atomic<bool> mShutdown{false};
+
+    std::vector<std::thread> mThreads;
 };
+
 } // namespace tensorrt_llm::runtime
@@ -20,6 +20,7 @@
 #include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/common/mpiUtils.h"
 #include "tensorrt_llm/common/stringUtils.h"
+#include "tensorrt_llm/runtime/inProcessWorld.h"
 
 #include <algorithm>
 #include <numeric>
@@ -82,6 +83,10 @@ WorldConfig::WorldConfig(SizeType32 tensorParallelism, SizeType32 pipelineParall
 
 bool WorldConfig::validMpiConfig() const
 {
+    if (auto const* world = InProcessWorld::current())
+    {
+        return world->getSize() == getSize();
+    }
     return COMM_SESSION.getSize() == getSize();
 }
 
@@ -18,6 +18,7 @@
 
 #include "tensorrt_llm/common/tensorConversion.h"
 #include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/kernels/stopCriteriaKernels.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/thop/thUtils.h"
 #include "tensorrt_llm/thop/torchAllocator.h"
@@ -36,6 +37,8 @@ FtDynamicDecode<T>::FtDynamicDecode(size_t const max_batch_size, size_t const ma
     size_t const vocab_size_padded, int const tensor_para_size, int const pipeline_para_size)
     : finished_sum_(tr::BufferManager::pinned(
         tr::ITensor::makeShape({static_cast<int32_t>(max_batch_size)}), nvinfer1::DataType::kINT32))
+    , finished_sum_device_(torch::zeros({static_cast<int64_t>(max_batch_size)},
+          torch::dtype(torch::kInt32).device(torch::kCUDA).requires_grad(false)))
 {
     TLLM_CHECK_WITH_INFO(vocab_size_padded % tensor_para_size == 0,
         tensorrt_llm::common::fmtstr(
@@ -153,6 +156,14 @@ void FtDynamicDecode<T>::forward(th::Tensor const& logits, int const step, int c
     th::optional<th::Tensor> beam_hyps_min_normed_scores_opt, th::optional<th::Tensor> beam_hyps_num_beams_opt,
     th::optional<th::Tensor> beam_hyps_is_done_opt, bool const use_beam_hyps)
 {
+    // should_stop on the device selects the capture-safe mode, the layers then follow the stream being captured
+    bool const capture_safe = should_stop.is_cuda();
+    auto const stream = at::cuda::getCurrentCUDAStream().stream();
+    if (capture_safe)
+    {
+        dynamic_decode_layer_->setStream(stream);
+    }
+
     auto forwardParams = std::make_shared<tensorrt_llm::layers::DynamicDecodeInputParams>(step, static_cast<int>(ite),
         max_input_length, max_attention_window, sink_token_length, local_batch_size, convert_tensor<int>(end_id));
 
@@ -182,7 +193,13 @@ void FtDynamicDecode<T>::forward(th::Tensor const& logits, int const step, int c
     safeUpdate<int>(tgt_cache_indirection_opt, outputParams->tgt_cache_indirection);
 
     std::int32_t* finished_sum_host = nullptr;
-    if (forwardParams->sequence_limit_length && outputParams->finished.has_value())
+    if (forwardParams->sequence_limit_length && outputParams->finished.has_value() && capture_safe)
+    {
+        outputParams->finished_sum = convert_tensor<int>(finished_sum_device_);
+        TLLM_CUDA_CHECK(
+            cudaMemsetAsync(finished_sum_device_.data_ptr(), 0, sizeof(std::int32_t) * local_batch_size, stream));
+    }
+    else if (forwardParams->sequence_limit_length && outputParams->finished.has_value())
     {
         // Skip the initialization and later calculation if there is no limit of sequence length or no finished beam
         outputParams->finished_sum = tcc::toTllmTensor(*finished_sum_);
@@ -209,7 +226,23 @@ void FtDynamicDecode<T>::forward(th::Tensor const& logits, int const step, int c
 
     dynamic_decode_layer_->forwardAsync(outputParams, forwardParams);
 
-    if (finished_sum_host)
+    if (capture_safe)
+    {
+        // Reduced on the device, the host reads should_stop after the graph when it needs it
+        auto* should_stop_device = should_stop.data_ptr<bool>();
+        if (outputParams->finished_sum)
+        {
+            auto const numToFinish = static_cast<int32_t>(outputParams->finished->size());
+            tensorrt_llm::kernels::invokeAllFinished(should_stop_device,
+                outputParams->finished_sum->template getPtr<int32_t const>(), nullptr, local_batch_size, numToFinish,
+                stream);
+        }
+        else
+        {
+            TLLM_CUDA_CHECK(cudaMemsetAsync(should_stop_device, 0, sizeof(bool), stream));
+        }
+    }
+    else if (finished_sum_host)
     {
         TLLM_CUDA_CHECK(::cudaStreamSynchronize(dynamic_decode_layer_->getStream()));
         int32_t numRealFinished = 0;
@@ -255,6 +288,15 @@ void DynamicDecodeOp::createInstance()
     }
 }
 
+void DynamicDecodeOp::setCaptureSafe(bool capture_safe)
+{
+    capture_safe_ = capture_safe;
+    if (capture_safe_ && !should_stop_.defined())
+    {
+        should_stop_ = torch::zeros({1}, torch::dtype(torch::kBool).device(torch::kCUDA).requires_grad(false));
+    }
+}
+
 void DynamicDecodeOp::setup(int64_t const batch_size, int64_t const beam_width,
     th::optional<th::Tensor> runtime_top_k_opt, th::optional<th::Tensor> runtime_top_p_opt,
     th::optional<th::Tensor> temperature_opt, th::optional<th::Tensor> repetition_penalty_opt,
@@ -358,7 +400,8 @@ th::Tensor DynamicDecodeOp::forward(
     CHECK_OPTIONAL_INPUT(parent_ids_opt, torch::kInt32);
     CHECK_OPTIONAL_INPUT(tgt_cache_indirection_opt, torch::kInt32);
 
-    th::Tensor should_stop = torch::zeros({1}, torch::dtype(torch::kBool).requires_grad(false));
+    th::Tensor should_stop
+        = capture_safe_ ? should_stop_ : torch::zeros({1}, torch::dtype(torch::kBool).requires_grad(false));
 
     dynamic_decode_->forward(
         // Inputs
@@ -383,4 +426,5 @@ static auto trtllmGptContextDecoderTHS
     = torch::jit::class_<torch_ext::DynamicDecodeOp>("trtllm", "DynamicDecodeOp")
           .def(torch::jit::init<int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, at::ScalarType>())
           .def("setup", &torch_ext::DynamicDecodeOp::setup)
+          .def("set_capture_safe", &torch_ext::DynamicDecodeOp::setCaptureSafe)
           .def("forward", &torch_ext::DynamicDecodeOp::forward);
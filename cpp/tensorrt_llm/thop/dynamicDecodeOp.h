@@ -95,6 +95,7 @@ public:
 
 private:
     tensorrt_llm::runtime::ITensor::SharedPtr finished_sum_; // [batch_size] pinned
+    th::Tensor finished_sum_device_;                         // [batch_size] on the device, for the capture-safe mode
     std::shared_ptr<tensorrt_llm::layers::DynamicDecodeLayer<T>> dynamic_decode_layer_;
 };
 
@@ -115,6 +116,12 @@ public:
         th::optional<th::Tensor> top_p_reset_ids_opt, th::optional<th::Tensor> no_repeat_ngram_size_opt,
         bool output_log_probs, bool cum_log_probs);
 
+    //! \brief Makes forward capturable in a CUDA graph.
+    //! \details forward then runs on the current stream without synchronizing or allocating, and returns should_stop
+    //! as a preallocated tensor on the device, reduced from the finished states on the device. Run setup and a step
+    //! with the inputs of the graph before capturing, so that the workspaces of the layers are allocated.
+    void setCaptureSafe(bool capture_safe);
+
     th::Tensor forward(th::Tensor const& logits, int64_t const step, int64_t const max_input_length,
         int64_t const max_attention_window, int64_t const sink_token_length, int64_t const ite,
         int64_t const local_batch_size, th::Tensor end_id, th::optional<th::Tensor> embedding_bias_opt,
@@ -143,6 +150,8 @@ private:
     int const pipeline_para_size_;
     at::ScalarType const scalar_type_;                 // Data type of expected input logits
     std::unique_ptr<IFtDynamicDecode> dynamic_decode_; // FT Dynamic decode layer wrapper instance
+    bool capture_safe_{false};
+    th::Tensor should_stop_; // [1] on the device, returned by forward in the capture-safe mode
 
     void createInstance();
 };
@@ -49,6 +49,12 @@ ReallocType TorchAllocator::reallocType(void const* ptr, size_t size) const
 void* TorchAllocator::malloc(size_t size, bool const setZero)
 {
     TLLM_LOG_TRACE(__PRETTY_FUNCTION__);
+    // A buffer allocated while capturing would belong to the graph, the layers must be sized by an eager step first
+    cudaStreamCaptureStatus captureStatus{cudaStreamCaptureStatusNone};
+    check_cuda_error(cudaStreamIsCapturing(at::cuda::getCurrentCUDAStream().stream(), &captureStatus));
+    TLLM_CHECK_WITH_INFO(captureStatus == cudaStreamCaptureStatusNone,
+        "Allocating %zu bytes while capturing a CUDA graph, run a decoding step with the same inputs before capturing.",
+        size);
     auto const bufSize = static_cast<int64_t>(size);
     torch::Tensor buf = torch::empty({bufSize}, torch::dtype(torch::kUInt8).device(torch::kCUDA));
     void* ptr{buf.data_ptr()};
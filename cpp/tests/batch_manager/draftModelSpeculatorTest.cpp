@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/draftModelSpeculator.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager;
+
+TEST(DraftModelSpeculatorTest, rewindLengths)
+{
+    DraftModelSpeculator speculator{4, 8};
+    speculator.addSequence(2, 4);
+
+    // Partial acceptance, the draft model processed the last accepted token and 3 draft tokens
+    EXPECT_EQ(speculator.beginStep(2), 1);
+    auto rewindLengths = speculator.endStep(2, 1);
+    EXPECT_EQ(rewindLengths.draft, 2);
+    EXPECT_EQ(rewindLengths.target, 3);
+
+    // Everything but the last draft token accepted, which the draft model never processed
+    EXPECT_EQ(speculator.beginStep(2), 1);
+    rewindLengths = speculator.endStep(2, 3);
+    EXPECT_EQ(rewindLengths.draft, 0);
+    EXPECT_EQ(rewindLengths.target, 1);
+
+    // Full acceptance, the draft model catches up on the last draft token in the next step
+    EXPECT_EQ(speculator.beginStep(2), 1);
+    rewindLengths = speculator.endStep(2, 4);
+    EXPECT_EQ(rewindLengths.draft, 0);
+    EXPECT_EQ(rewindLengths.target, 0);
+    EXPECT_EQ(speculator.beginStep(2), 2);
+    rewindLengths = speculator.endStep(2, 0);
+    EXPECT_EQ(rewindLengths.draft, 3);
+    EXPECT_EQ(rewindLengths.target, 4);
+    EXPECT_EQ(speculator.beginStep(2), 1);
+}
+
+TEST(DraftModelSpeculatorTest, draftLength)
+{
+    DraftModelSpeculator speculator{2, 4};
+    EXPECT_THROW(speculator.addSequence(0, 5), tensorrt_llm::common::TllmException);
+    speculator.addSequence(0, 4);
+    EXPECT_THROW(speculator.addSequence(0, 2), tensorrt_llm::common::TllmException);
+
+    speculator.setNumDraftTokens(0, 2);
+    EXPECT_EQ(speculator.getNumDraftTokens(0), 2);
+    speculator.beginStep(0);
+    EXPECT_THROW(speculator.setNumDraftTokens(0, 3), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(static_cast<void>(speculator.endStep(0, 3)), tensorrt_llm::common::TllmException);
+    auto const rewindLengths = speculator.endStep(0, 2);
+    EXPECT_EQ(rewindLengths.target, 0);
+
+    speculator.removeSequence(0);
+    EXPECT_THROW(speculator.beginStep(0), tensorrt_llm::common::TllmException);
+    speculator.addSequence(0, 1);
+    EXPECT_EQ(speculator.beginStep(0), 1);
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/fairShareScheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+using namespace tensorrt_llm::batch_manager;
+using Candidate = FairShareScheduler::Candidate;
+using Config = FairShareScheduler::Config;
+using RequestIds = std::vector<FairShareScheduler::RequestIdType>;
+using TenantIdType = FairShareScheduler::TenantIdType;
+
+namespace
+{
+//! Requests firstId, firstId + 1, ... of the tenant, waiting for their context
+std::vector<Candidate> makeRequests(TenantIdType tenantId, FairShareScheduler::RequestIdType firstId, int count)
+{
+    std::vector<Candidate> candidates;
+    for (int i = 0; i < count; ++i)
+    {
+        candidates.push_back(Candidate{firstId + i, tenantId, false, 1, 1});
+    }
+    return candidates;
+}
+
+std::vector<Candidate> concat(std::vector<Candidate> lhs, std::vector<Candidate> const& rhs)
+{
+    lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+    return lhs;
+}
+
+long countTenant(RequestIds const& scheduled, FairShareScheduler::RequestIdType firstId)
+{
+    return std::count_if(scheduled.begin(), scheduled.end(),
+        [firstId](auto requestId) { return firstId <= requestId && requestId < firstId + 100; });
+}
+} // namespace
+
+TEST(FairShareSchedulerTest, heavyTenantDoesNotStarveOthers)
+{
+    FairShareScheduler scheduler{Config{4, 100}};
+    auto const candidates = concat(makeRequests(1, 100, 10), makeRequests(2, 200, 2));
+
+    auto const schedule = scheduler.schedule(candidates);
+    EXPECT_EQ(schedule.scheduled, (RequestIds{100, 200, 101, 201}));
+    EXPECT_TRUE(schedule.preempted.empty());
+}
+
+TEST(FairShareSchedulerTest, sharesByWeight)
+{
+    FairShareScheduler scheduler{Config{8, 100}};
+    scheduler.setWeight(1, 3.f);
+    auto const candidates = concat(makeRequests(1, 100, 10), makeRequests(2, 200, 10));
+
+    auto const schedule = scheduler.schedule(candidates);
+    EXPECT_EQ(countTenant(schedule.scheduled, 100), 6);
+    EXPECT_EQ(countTenant(schedule.scheduled, 200), 2);
+    EXPECT_NEAR(scheduler.getVirtualTime(1), 2., 1e-6);
+    EXPECT_NEAR(scheduler.getVirtualTime(2), 2., 1e-6);
+    EXPECT_THROW(scheduler.setWeight(3, 0.f), tensorrt_llm::common::TllmException);
+}
+
+TEST(FairShareSchedulerTest, boundsTenantShare)
+{
+    FairShareScheduler scheduler{Config{4, 10, 0.5f}};
+    EXPECT_EQ(scheduler.schedule(makeRequests(1, 100, 4)).scheduled, (RequestIds{100, 101}));
+
+    // The first request of the tenant takes 4 of its 5 blocks, the next one doesn't fit in its share
+    std::vector<Candidate> candidates{Candidate{1, 7, false, 4, 16}, Candidate{2, 7, false, 4, 16}};
+    EXPECT_EQ(scheduler.schedule(candidates).scheduled, (RequestIds{1}));
+
+    // A single request larger than the share still runs
+    candidates = {Candidate{3, 8, false, 8, 64}};
+    EXPECT_EQ(scheduler.schedule(candidates).scheduled, (RequestIds{3}));
+}
+
+TEST(FairShareSchedulerTest, preemptsGeneratingRequestsBeyondShare)
+{
+    FairShareScheduler scheduler{Config{2, 100, 0.5f}};
+    std::vector<Candidate> const candidates{
+        Candidate{1, 1, true, 2, 1},
+        Candidate{2, 1, true, 2, 1},
+        Candidate{3, 2, false, 2, 8},
+    };
+
+    auto const schedule = scheduler.schedule(candidates);
+    EXPECT_EQ(schedule.scheduled, (RequestIds{1, 3}));
+    EXPECT_EQ(schedule.preempted, (RequestIds{2}));
+    EXPECT_EQ(scheduler.getStats().numPreempted, 1);
+}
+
+TEST(FairShareSchedulerTest, groupsTenantsIntoConsecutiveIterations)
+{
+    auto const candidates = concat(makeRequests(1, 100, 50), makeRequests(2, 200, 50));
+    auto const runIterations = [&candidates](float tenantAffinity)
+    {
+        FairShareScheduler scheduler{Config{2, 100, 1.f, 1, tenantAffinity}};
+        std::vector<TenantIdType> tenants;
+        for (int iteration = 0; iteration < 4; ++iteration)
+        {
+            auto const schedule = scheduler.schedule(candidates);
+            EXPECT_EQ(schedule.scheduled.size(), 2);
+            tenants.push_back(schedule.scheduled.front() / 100);
+        }
+        return std::make_pair(tenants, scheduler.getStats().numTenantSwitches);
+    };
+
+    auto const [grouped, groupedSwitches] = runIterations(4.f);
+    EXPECT_EQ(grouped, (std::vector<TenantIdType>{1, 1, 1, 2}));
+    EXPECT_EQ(groupedSwitches, 2);
+
+    auto const [alternating, alternatingSwitches] = runIterations(0.f);
+    EXPECT_EQ(alternating, (std::vector<TenantIdType>{1, 2, 1, 2}));
+    EXPECT_EQ(alternatingSwitches, 4);
+}
+
+TEST(FairShareSchedulerTest, idleTenantDoesNotBankCredit)
+{
+    FairShareScheduler scheduler{Config{2, 100, 1.f, std::nullopt, 0.f}};
+    for (int iteration = 0; iteration < 3; ++iteration)
+    {
+        static_cast<void>(scheduler.schedule(makeRequests(1, 100, 4)));
+    }
+    EXPECT_DOUBLE_EQ(scheduler.getVirtualTime(1), 6.);
+    EXPECT_DOUBLE_EQ(scheduler.getVirtualTime(2), 6.);
+
+    auto const candidates = concat(makeRequests(1, 100, 4), makeRequests(2, 200, 4));
+    auto const schedule = scheduler.schedule(candidates);
+    EXPECT_EQ(countTenant(schedule.scheduled, 100), 1);
+    EXPECT_EQ(countTenant(schedule.scheduled, 200), 1);
+}
+
+TEST(FairShareSchedulerTest, tenantOfRequest)
+{
+    namespace texec = tensorrt_llm::executor;
+    texec::Request request{{1, 2, 3}, 8};
+    EXPECT_EQ(FairShareScheduler::getTenantId(request), FairShareScheduler::kNO_ADAPTER);
+    request.setLoraConfig(texec::LoraConfig{42});
+    EXPECT_EQ(FairShareScheduler::getTenantId(request), 42);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/iterationTracer.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <thread>
+
+using namespace tensorrt_llm::batch_manager;
+using namespace std::chrono_literals;
+
+namespace
+{
+std::size_t countOccurrences(std::string const& str, std::string const& pattern)
+{
+    std::size_t count = 0;
+    for (auto pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + pattern.size()))
+    {
+        ++count;
+    }
+    return count;
+}
+} // namespace
+
+TEST(IterationTracerTest, recordsPhasesOfIterations)
+{
+    IterationTracer tracer{16};
+
+    tracer.beginIteration(7);
+    {
+        auto const scheduling = tracer.scope(TracePhase::kSCHEDULING);
+    }
+    tracer.setBatchComposition({2, 3, 100, 3});
+    std::thread worker([&tracer]() { auto const offload = tracer.scope(TracePhase::kKV_CACHE_OFFLOAD); });
+    worker.join();
+    tracer.endIteration();
+
+    auto const events = tracer.getEvents();
+    ASSERT_EQ(events.size(), 3);
+    EXPECT_EQ(events[0].phase, TracePhase::kSCHEDULING);
+    EXPECT_EQ(events[1].phase, TracePhase::kKV_CACHE_OFFLOAD);
+    EXPECT_NE(events[1].threadId, events[0].threadId);
+    EXPECT_EQ(events[2].phase, TracePhase::kITERATION);
+    EXPECT_EQ(events[2].batch.numContextTokens, 100);
+    for (auto const& event : events)
+    {
+        EXPECT_EQ(event.iteration, 7);
+    }
+    EXPECT_GE(events[2].duration, events[0].duration);
+
+    std::ostringstream trace;
+    tracer.dumpChromeTrace(trace);
+    auto const json = trace.str();
+    EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0);
+    EXPECT_EQ(countOccurrences(json, "\"ph\":\"X\""), 3);
+    EXPECT_EQ(countOccurrences(json, "\"name\":\"kv_cache_offload\""), 1);
+    EXPECT_EQ(countOccurrences(json, "\"numContextRequests\":2"), 1);
+}
+
+TEST(IterationTracerTest, ringBufferKeepsNewestEvents)
+{
+    IterationTracer tracer{4};
+    for (std::uint64_t iteration = 0; iteration < 3; ++iteration)
+    {
+        tracer.beginIteration(iteration);
+        auto const now = IterationTracer::Clock::now();
+        tracer.record(TracePhase::kDECODER, now, now);
+        tracer.endIteration();
+    }
+
+    EXPECT_EQ(tracer.getNumRecorded(), 6);
+    auto const events = tracer.getEvents();
+    ASSERT_EQ(events.size(), 4);
+    EXPECT_EQ(events.front().iteration, 1);
+    EXPECT_EQ(events.front().phase, TracePhase::kDECODER);
+    EXPECT_EQ(events.back().iteration, 2);
+    EXPECT_EQ(events.back().phase, TracePhase::kITERATION);
+}
+
+TEST(IterationTracerTest, dumpsSlowIterations)
+{
+    std::vector<std::uint64_t> slowIterations;
+    std::string lastTrace;
+    IterationTracer tracer{64, 5ms,
+        [&](std::uint64_t iteration, std::string const& trace)
+        {
+            slowIterations.push_back(iteration);
+            lastTrace = trace;
+        }};
+
+    tracer.beginIteration(0);
+    tracer.endIteration();
+    tracer.beginIteration(1);
+    {
+        auto const forward = tracer.scope(TracePhase::kFORWARD_ENQUEUE);
+        std::this_thread::sleep_for(10ms);
+    }
+    EXPECT_GE(tracer.endIteration(), 10ms);
+
+    EXPECT_EQ(slowIterations, (std::vector<std::uint64_t>{1}));
+    EXPECT_EQ(countOccurrences(lastTrace, "\"name\":\"forward_enqueue\""), 1);
+    EXPECT_EQ(countOccurrences(lastTrace, "\"name\":\"iteration\""), 2);
+}
+
+TEST(IterationTracerTest, invalidArguments)
+{
+    EXPECT_THROW(IterationTracer{0}, tensorrt_llm::common::TllmException);
+    EXPECT_THROW((IterationTracer{16, 1ms}), tensorrt_llm::common::TllmException);
+}
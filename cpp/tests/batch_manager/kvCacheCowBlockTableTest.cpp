@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/kvCacheCowBlockTable.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager::kv_cache_manager;
+
+namespace
+{
+using IdType = CowBlockTable::IdType;
+} // namespace
+
+TEST(CowBlockTableTest, forkSharesUntilWrite)
+{
+    CowBlockTable table(4);
+    IdType nextBlockId{10};
+    auto const allocator = [&nextBlockId]() { return nextBlockId++; };
+
+    // Prompt of 10 tokens: 2 full blocks and a partial one.
+    table.addSequence(0, {0, 1, 2}, 10);
+    for (CowBlockTable::SequenceIdType seq = 1; seq < 8; ++seq)
+    {
+        table.fork(0, seq);
+    }
+    EXPECT_EQ(table.getNumUsedBlocks(), 3);
+    EXPECT_EQ(table.getRefCount(2), 8);
+
+    // The first write of a fork copies the 2 tokens already in the shared partial block.
+    auto const copy = table.addToken(1, allocator);
+    ASSERT_TRUE(copy.has_value());
+    EXPECT_EQ(copy->srcBlockId, 2);
+    EXPECT_EQ(copy->dstBlockId, 10);
+    EXPECT_EQ(copy->numTokens, 2);
+    EXPECT_EQ(table.getBlockIds(1), (std::vector<IdType>{0, 1, 10}));
+    EXPECT_EQ(table.getRefCount(2), 7);
+    EXPECT_EQ(table.getRefCount(0), 8);
+
+    // Subsequent writes into the now private block don't copy.
+    EXPECT_FALSE(table.addToken(1, allocator).has_value());
+    EXPECT_FALSE(table.addToken(1, allocator).has_value());
+    EXPECT_EQ(table.getNumTokens(1), 13);
+    // Crossing a block boundary allocates without copying.
+    EXPECT_FALSE(table.addToken(1, allocator).has_value());
+    EXPECT_EQ(table.getBlockIds(1).back(), 11);
+}
+
+TEST(CowBlockTableTest, lastReferenceWritesInPlace)
+{
+    CowBlockTable table(4);
+    IdType nextBlockId{10};
+    auto const allocator = [&nextBlockId]() { return nextBlockId++; };
+
+    table.addSequence(0, {0, 1}, 6);
+    table.fork(0, 1);
+    ASSERT_TRUE(table.addToken(0, allocator).has_value());
+    // Sequence 1 is now the only one referencing block 1.
+    EXPECT_FALSE(table.addToken(1, allocator).has_value());
+    EXPECT_EQ(table.getBlockIds(1), (std::vector<IdType>{0, 1}));
+}
+
+TEST(CowBlockTableTest, removeReleasesUnreferencedBlocks)
+{
+    CowBlockTable table(4);
+    IdType nextBlockId{10};
+    auto const allocator = [&nextBlockId]() { return nextBlockId++; };
+
+    table.addSequence(0, {0, 1}, 6);
+    table.fork(0, 1);
+    (void) table.addToken(1, allocator);
+
+    EXPECT_EQ(table.removeSequence(0), (std::vector<IdType>{1}));
+    EXPECT_EQ(table.removeSequence(1), (std::vector<IdType>{0, 10}));
+    EXPECT_EQ(table.getNumUsedBlocks(), 0);
+    EXPECT_THROW(table.removeSequence(1), tensorrt_llm::common::TllmException);
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/kvCacheCrossReuse.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager::kv_cache_manager;
+
+namespace
+{
+using IdType = CrossKvCacheIndex::IdType;
+} // namespace
+
+TEST(CrossKvCacheIndexTest, hashEncoderInput)
+{
+    std::vector<tensorrt_llm::runtime::TokenIdType> const tokens{1, 2, 3, 4, 5};
+    EXPECT_EQ(hashEncoderInput(tokens.data(), 5), hashEncoderInput(tokens.data(), 5));
+    EXPECT_NE(hashEncoderInput(tokens.data(), 5), hashEncoderInput(tokens.data(), 4));
+    EXPECT_NE(hashEncoderInput(tokens.data(), 5), hashEncoderInput(tokens.data(), 5, 1));
+
+    std::vector<float> features(13, 0.5f);
+    auto const hash = hashEncoderInput(features.data(), features.size() * sizeof(float));
+    features.back() = 0.25f;
+    EXPECT_NE(hashEncoderInput(features.data(), features.size() * sizeof(float)), hash);
+}
+
+TEST(CrossKvCacheIndexTest, hitSharesBlocks)
+{
+    CrossKvCacheIndex index;
+    EXPECT_FALSE(index.acquire(42).has_value());
+    index.insert(42, {{0, 1, 2}, 1500});
+
+    auto const hit = index.acquire(42);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit->blockIds, (std::vector<IdType>{0, 1, 2}));
+    EXPECT_EQ(hit->encoderOutputLen, 1500);
+    EXPECT_EQ(index.getNumHits(), 1);
+    EXPECT_EQ(index.getNumMisses(), 1);
+
+    // Referenced by two requests, nothing can be evicted.
+    index.release(42);
+    EXPECT_TRUE(index.evict(3).empty());
+    index.release(42);
+    EXPECT_EQ(index.getNumEvictableBlocks(), 3);
+
+    // A new request referencing the cached input makes it unevictable again.
+    ASSERT_TRUE(index.acquire(42).has_value());
+    EXPECT_EQ(index.getNumEvictableBlocks(), 0);
+    EXPECT_TRUE(index.evict(3).empty());
+}
+
+TEST(CrossKvCacheIndexTest, evictLeastRecentlyReleased)
+{
+    CrossKvCacheIndex index;
+    index.insert(1, {{0, 1}, 10});
+    index.insert(2, {{2, 3}, 10});
+    index.insert(3, {{4}, 5});
+    index.release(2);
+    index.release(1);
+    index.release(3);
+    EXPECT_EQ(index.getNumCachedBlocks(), 5);
+
+    EXPECT_EQ(index.evict(3), (std::vector<IdType>{2, 3, 0, 1}));
+    EXPECT_FALSE(index.contains(1));
+    EXPECT_FALSE(index.contains(2));
+    EXPECT_TRUE(index.contains(3));
+    EXPECT_EQ(index.getNumCachedBlocks(), 1);
+    EXPECT_EQ(index.getNumEvictableBlocks(), 1);
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/kvCacheDefragmenter.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager::kv_cache_manager;
+
+namespace
+{
+using IdType = KVCacheDefragmenter::IdType;
+
+std::vector<bool> makeFreeMap(std::size_t numBlocks, std::vector<std::vector<IdType>> const& blockTables)
+{
+    std::vector<bool> isFree(numBlocks, true);
+    for (auto const& blocks : blockTables)
+    {
+        for (auto const block : blocks)
+        {
+            isFree[block] = false;
+        }
+    }
+    return isFree;
+}
+} // namespace
+
+TEST(KVCacheDefragmenterTest, countDiscontinuities)
+{
+    EXPECT_EQ(KVCacheDefragmenter::countDiscontinuities({}), 0);
+    EXPECT_EQ(KVCacheDefragmenter::countDiscontinuities({3, 4, 5}), 0);
+    EXPECT_EQ(KVCacheDefragmenter::countDiscontinuities({3, 7, 8, 1}), 2);
+}
+
+TEST(KVCacheDefragmenterTest, movesFragmentedSequences)
+{
+    std::vector<std::vector<IdType>> const blockTables{{0, 5, 2}, {3, 4}, {7, 1}};
+    auto const plan
+        = KVCacheDefragmenter::plan(blockTables, makeFreeMap(12, blockTables), std::vector<bool>(12, false), 16);
+
+    // The first sequence goes to the first free run of 3 blocks, the contiguous one stays.
+    ASSERT_TRUE(plan.newBlockTables[0].has_value());
+    EXPECT_EQ(plan.newBlockTables[0].value(), (std::vector<IdType>{8, 9, 10}));
+    EXPECT_FALSE(plan.newBlockTables[1].has_value());
+    // Blocks vacated by the first sequence are not reused in the same pass.
+    EXPECT_FALSE(plan.newBlockTables[2].has_value());
+
+    ASSERT_EQ(plan.moves.size(), 3);
+    EXPECT_EQ(plan.moves[1].srcBlockIdx, 5);
+    EXPECT_EQ(plan.moves[1].dstBlockIdx, 9);
+}
+
+TEST(KVCacheDefragmenterTest, respectsBudget)
+{
+    std::vector<std::vector<IdType>> const blockTables{{0, 5, 2}, {7, 1}};
+    auto const plan
+        = KVCacheDefragmenter::plan(blockTables, makeFreeMap(16, blockTables), std::vector<bool>(16, false), 2);
+
+    EXPECT_FALSE(plan.newBlockTables[0].has_value());
+    ASSERT_TRUE(plan.newBlockTables[1].has_value());
+    EXPECT_EQ(plan.newBlockTables[1].value(), (std::vector<IdType>{3, 4}));
+    EXPECT_EQ(plan.moves.size(), 2);
+}
+
+TEST(KVCacheDefragmenterTest, keepsSharedBlocks)
+{
+    // Both sequences start with the same reused prefix block 0, and block 6 of the third one is in the reuse tree.
+    std::vector<std::vector<IdType>> const blockTables{{0, 5, 2}, {0, 3}, {7, 6}, {9, 1}};
+    std::vector<bool> isShared(12, false);
+    isShared[0] = true;
+    isShared[6] = true;
+    auto const plan = KVCacheDefragmenter::plan(blockTables, makeFreeMap(12, blockTables), isShared, 16);
+
+    EXPECT_FALSE(plan.newBlockTables[0].has_value());
+    EXPECT_FALSE(plan.newBlockTables[1].has_value());
+    EXPECT_FALSE(plan.newBlockTables[2].has_value());
+    // Only the sequence without shared blocks is moved, and no shared block is a source.
+    ASSERT_TRUE(plan.newBlockTables[3].has_value());
+    EXPECT_EQ(plan.newBlockTables[3].value(), (std::vector<IdType>{10, 11}));
+    ASSERT_EQ(plan.moves.size(), 2);
+    for (auto const& move : plan.moves)
+    {
+        EXPECT_FALSE(isShared[move.srcBlockIdx]);
+    }
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/kvCacheEvictionPolicy.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager::kv_cache_manager;
+
+TEST(KvCacheEvictionPolicyTest, lru)
+{
+    auto policy = createEvictionPolicy(EvictionPolicyType::kLRU, 4);
+    EXPECT_FALSE(policy->getFreeBlock().has_value());
+    policy->releaseBlock(0);
+    policy->releaseBlock(1);
+    policy->releaseBlock(2, true);
+    EXPECT_EQ(policy->getNumFreeBlocks(), 3);
+    EXPECT_EQ(policy->getFreeBlock().value(), 2);
+    policy->claimBlock(2);
+    EXPECT_EQ(policy->getFreeBlock().value(), 0);
+    // Blocks rejected by the predicate are skipped.
+    EXPECT_EQ(policy->getFreeBlock([](auto blockId) { return blockId != 0; }).value(), 1);
+    EXPECT_FALSE(policy->getFreeBlock([](auto) { return false; }).has_value());
+    EXPECT_THROW(policy->releaseBlock(0), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(policy->claimBlock(3), tensorrt_llm::common::TllmException);
+}
+
+TEST(KvCacheEvictionPolicyTest, lfuKeepsReusedBlocks)
+{
+    LFUEvictionPolicy policy(4);
+    for (int i = 0; i < 4; ++i)
+    {
+        policy.releaseBlock(i);
+    }
+    // Block 0 holds a shared prefix that is reused twice.
+    policy.claimBlock(0, true);
+    policy.releaseBlock(0);
+    policy.claimBlock(0, true);
+    policy.releaseBlock(0);
+    EXPECT_EQ(policy.getFrequency(0), 2);
+
+    // A burst of one-off blocks doesn't evict it.
+    for (int i = 0; i < 3; ++i)
+    {
+        auto const victim = policy.getFreeBlock().value();
+        EXPECT_NE(victim, 0);
+        policy.claimBlock(victim);
+    }
+    EXPECT_EQ(policy.getFreeBlock().value(), 0);
+}
+
+TEST(KvCacheEvictionPolicyTest, lfuAges)
+{
+    LFUEvictionPolicy policy(2);
+    policy.releaseBlock(0);
+    policy.claimBlock(0, true);
+    policy.releaseBlock(0);
+    EXPECT_EQ(policy.getFrequency(0), 1);
+    policy.claimBlock(0, true);
+    // Two reuses with two blocks trigger aging.
+    EXPECT_EQ(policy.getFrequency(0), 1);
+    policy.releaseBlock(0);
+    // Reallocating a block resets its frequency.
+    policy.claimBlock(0);
+    EXPECT_EQ(policy.getFrequency(0), 0);
+}
+
+TEST(KvCacheEvictionPolicyTest, priority)
+{
+    auto policy = createEvictionPolicy(EvictionPolicyType::kPRIORITY, 5);
+    policy->releaseBlock(0, false, 90);
+    policy->releaseBlock(1);
+    policy->releaseBlock(2, false, 10);
+    policy->releaseBlock(3);
+    policy->releaseBlock(4, true, 100);
+
+    std::vector<BaseEvictionPolicy::IdType> order;
+    while (auto const blockId = policy->getFreeBlock())
+    {
+        order.push_back(blockId.value());
+        policy->claimBlock(blockId.value());
+    }
+    EXPECT_EQ(order, (std::vector<BaseEvictionPolicy::IdType>{4, 2, 1, 3, 0}));
+}
+
+TEST(KvCacheEvictionPolicyTest, pinnedBlocksAreNotEvicted)
+{
+    auto policy = createEvictionPolicy(EvictionPolicyType::kLRU, 3);
+    policy->releaseBlock(0);
+    policy->releaseBlock(1);
+    policy->pinBlock(0);
+    policy->pinBlock(2);
+    policy->pinBlock(2);
+    EXPECT_EQ(policy->getNumPinnedBlocks(), 2);
+    EXPECT_EQ(policy->getNumFreeBlocks(), 1);
+    EXPECT_EQ(policy->getFreeBlock(), 1);
+
+    // A pinned block in use stays out of the free set once released, but can still be reused.
+    policy->releaseBlock(2);
+    EXPECT_TRUE(policy->isFree(2));
+    EXPECT_EQ(policy->getNumFreeBlocks(), 1);
+    policy->claimBlock(2, true);
+    policy->releaseBlock(2);
+
+    policy->claimBlock(1);
+    EXPECT_FALSE(policy->getFreeBlock().has_value());
+
+    policy->unpinBlock(0);
+    EXPECT_EQ(policy->getFreeBlock(), 0);
+    policy->unpinBlock(2);
+    EXPECT_TRUE(policy->isPinned(2));
+    policy->unpinBlock(2);
+    EXPECT_FALSE(policy->isPinned(2));
+    EXPECT_EQ(policy->getNumPinnedBlocks(), 0);
+    EXPECT_EQ(policy->getNumFreeBlocks(), 2);
+}
+
+TEST(KvCacheEvictionPolicyTest, configKeepsRetentionPriorities)
+{
+    EvictionPolicyConfig config(EvictionPolicyType::kPRIORITY);
+    EXPECT_EQ(config.getType(), EvictionPolicyType::kPRIORITY);
+    EXPECT_NE(dynamic_cast<PriorityEvictionPolicy*>(config.createPolicy(2).get()), nullptr);
+
+    config.setRetentionPriority(3, 80);
+    EXPECT_EQ(config.getRetentionPriority(3), 80);
+    EXPECT_EQ(config.getRetentionPriority(4), BaseEvictionPolicy::kDefaultRetentionPriority);
+    EXPECT_THROW(config.setRetentionPriority(4, BaseEvictionPolicy::kMaxRetentionPriority + 1),
+        tensorrt_llm::common::TllmException);
+    config.eraseRetentionPriority(3);
+    EXPECT_EQ(config.getRetentionPriority(3), BaseEvictionPolicy::kDefaultRetentionPriority);
+}
+
+TEST(KvCacheEvictionPolicyTest, unpinnedFreeBlockKeepsItsPriority)
+{
+    auto policy = createEvictionPolicy(EvictionPolicyType::kPRIORITY, 3);
+    policy->releaseBlock(0, false, 90);
+    policy->releaseBlock(1, false, 50);
+    policy->releaseBlock(2, false, 10);
+
+    // Pin and unpin a block that is free already, it goes back with the priority it was released with.
+    policy->pinBlock(0);
+    EXPECT_EQ(policy->getNumFreeBlocks(), 2);
+    policy->unpinBlock(0);
+    EXPECT_EQ(policy->getNumFreeBlocks(), 3);
+
+    std::vector<BaseEvictionPolicy::IdType> order;
+    while (auto const blockId = policy->getFreeBlock())
+    {
+        order.push_back(blockId.value());
+        policy->claimBlock(blockId.value());
+    }
+    EXPECT_EQ(order, (std::vector<BaseEvictionPolicy::IdType>{2, 1, 0}));
+}
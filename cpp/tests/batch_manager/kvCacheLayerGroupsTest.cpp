@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/kvCacheLayerGroups.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager::kv_cache_manager;
+
+TEST(KvCacheLayerGroupsTest, interleavedSlidingWindow)
+{
+    auto constexpr maxSequenceLength = 8192;
+    auto constexpr tokensPerBlock = 64;
+    LayerKvCacheConfig const local{8, 128, 4096, nvinfer1::DataType::kHALF};
+    LayerKvCacheConfig const global{8, 128, maxSequenceLength, nvinfer1::DataType::kHALF};
+    // Gemma-2 style alternating local and global layers
+    std::vector<LayerKvCacheConfig> const layers{local, global, local, global, local, global};
+
+    auto const groups = groupLayersByKvCacheConfig(layers);
+    ASSERT_EQ(groups.size(), 2);
+    EXPECT_EQ(groups[0].layerIds, (std::vector<int32_t>{0, 2, 4}));
+    EXPECT_EQ(groups[1].layerIds, (std::vector<int32_t>{1, 3, 5}));
+
+    EXPECT_EQ(groups[0].getMaxBlocksPerSeq(tokensPerBlock, maxSequenceLength), 65);
+    EXPECT_EQ(groups[1].getMaxBlocksPerSeq(tokensPerBlock, maxSequenceLength), 128);
+    EXPECT_EQ(groups[0].getBlockSizeInBytes(tokensPerBlock), 3 * 2 * 8 * 64 * 128 * 2);
+
+    auto const bytesPerSequence = groups[0].getBlockSizeInBytes(tokensPerBlock) * (65 + 128);
+    auto const blocks = calculateBlocksPerPoolGroup(groups, tokensPerBlock, maxSequenceLength, 10 * bytesPerSequence);
+    EXPECT_EQ(blocks, (std::vector<int32_t>{650, 1280}));
+}
+
+TEST(KvCacheLayerGroupsTest, differentDtypesAreSeparateGroups)
+{
+    LayerKvCacheConfig const fp8{8, 128, 1024, nvinfer1::DataType::kFP8};
+    LayerKvCacheConfig const fp16{8, 128, 1024, nvinfer1::DataType::kHALF};
+    auto const groups = groupLayersByKvCacheConfig({fp16, fp8, fp16});
+    ASSERT_EQ(groups.size(), 2);
+    EXPECT_EQ(groups[0].getBlockSizeInBytes(32), 2 * groups[1].getBlockSizeInBytes(32) * 2);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/kvCachePrefixSummary.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <vector>
+
+using namespace tensorrt_llm::batch_manager::kv_cache_manager;
+
+namespace
+{
+using Tree = BlockRadixTree<std::int32_t>;
+using VecTokens = Tree::VecTokens;
+
+auto constexpr kTokensPerBlock = 4;
+
+VecTokens makeTokens(std::int32_t numTokens, std::int32_t start = 0)
+{
+    VecTokens tokens(numTokens);
+    std::iota(tokens.begin(), tokens.end(), start);
+    return tokens;
+}
+
+std::vector<BlockHashType> hashBlocks(VecTokens const& tokens)
+{
+    std::vector<BlockHashType> hashes;
+    auto hash = kRootBlockHash;
+    for (std::size_t offset = 0; offset + kTokensPerBlock <= tokens.size(); offset += kTokensPerBlock)
+    {
+        hash = hashBlockTokens(hash, tokens.data() + offset, kTokensPerBlock);
+        hashes.push_back(hash);
+    }
+    return hashes;
+}
+} // namespace
+
+TEST(PrefixCacheSummaryTest, matchesCachedPrefixes)
+{
+    Tree tree(kTokensPerBlock);
+    auto const cached = makeTokens(16);
+    EXPECT_EQ(tree.insert(cached, {0, 1, 2, 3}), 4);
+    auto branch = makeTokens(8);
+    auto const tail = makeTokens(8, 100);
+    branch.insert(branch.end(), tail.begin(), tail.end());
+    EXPECT_EQ(tree.insert(branch, {0, 1, 4, 5}), 2);
+
+    auto const summary = PrefixCacheSummary::fromTree(tree, 1024, 7);
+    EXPECT_EQ(summary.getWords().size(), 16);
+
+    // Prompt sharing the first 3 blocks with the cached sequence
+    auto prompt = makeTokens(12);
+    auto const other = makeTokens(8, 1000);
+    prompt.insert(prompt.end(), other.begin(), other.end());
+    EXPECT_EQ(summary.getNumMatchedBlocks(hashBlocks(prompt)), 3);
+    EXPECT_EQ(summary.getNumMatchedBlocks(hashBlocks(branch)), 4);
+    EXPECT_EQ(summary.getNumMatchedBlocks(hashBlocks(makeTokens(16, 5000))), 0);
+
+    // Round trip through the serialized words
+    PrefixCacheSummary const restored{summary.getWords(), summary.getNumHashes()};
+    EXPECT_EQ(restored.getNumMatchedBlocks(hashBlocks(cached)), 4);
+}
+
+TEST(PrefixCacheSummaryTest, merge)
+{
+    auto const first = hashBlocks(makeTokens(8));
+    auto const second = hashBlocks(makeTokens(8, 50));
+    PrefixCacheSummary a{256, 4};
+    PrefixCacheSummary b{256, 4};
+    for (auto const hash : first)
+    {
+        a.add(hash);
+    }
+    for (auto const hash : second)
+    {
+        b.add(hash);
+    }
+    EXPECT_EQ(a.getNumMatchedBlocks(second), 0);
+    a.merge(b);
+    EXPECT_EQ(a.getNumMatchedBlocks(first), 2);
+    EXPECT_EQ(a.getNumMatchedBlocks(second), 2);
+    a.clear();
+    EXPECT_FALSE(a.mightContain(first.front()));
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/kvCacheRadixTree.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <vector>
+
+using namespace tensorrt_llm::batch_manager::kv_cache_manager;
+
+namespace
+{
+using Tree = BlockRadixTree<std::int32_t>;
+using VecTokens = Tree::VecTokens;
+
+VecTokens makeTokens(std::int32_t numTokens, std::int32_t start = 0)
+{
+    VecTokens tokens(numTokens);
+    std::iota(tokens.begin(), tokens.end(), start);
+    return tokens;
+}
+} // namespace
+
+TEST(BlockRadixTreeTest, hashIsChained)
+{
+    auto const tokens = makeTokens(8);
+    auto const h0 = hashBlockTokens(kRootBlockHash, tokens.data(), 4);
+    auto const h1 = hashBlockTokens(h0, tokens.data() + 4, 4);
+    // Same block tokens behind a different prefix must not collide.
+    auto const h1Root = hashBlockTokens(kRootBlockHash, tokens.data() + 4, 4);
+    EXPECT_NE(h1, h1Root);
+    EXPECT_EQ(h1, hashBlockTokens(hashBlockTokens(kRootBlockHash, tokens.data(), 4), tokens.data() + 4, 4));
+}
+
+TEST(BlockRadixTreeTest, insertAndMatch)
+{
+    Tree tree(4);
+    auto const tokens = makeTokens(14);
+    // Only the 3 full blocks are indexed.
+    EXPECT_EQ(tree.insert(tokens, {10, 11, 12, 13}), 3);
+    EXPECT_EQ(tree.getNumBlocks(), 3);
+
+    auto const match = tree.match(tokens);
+    EXPECT_EQ(match.values, (std::vector<std::int32_t>{10, 11, 12}));
+    EXPECT_EQ(match.hashes.size(), 3);
+    EXPECT_EQ(tree.getNumMatchedTokens(tokens), 12);
+
+    // Prefix shorter than a block doesn't match.
+    EXPECT_EQ(tree.getNumMatchedTokens(makeTokens(3)), 0);
+
+    // Re-inserting existing blocks keeps the old values.
+    EXPECT_EQ(tree.insert(tokens, {20, 21, 22}), 0);
+    EXPECT_EQ(tree.match(tokens).values, (std::vector<std::int32_t>{10, 11, 12}));
+}
+
+TEST(BlockRadixTreeTest, branchSplitsEdge)
+{
+    Tree tree(2);
+    auto const a = VecTokens{1, 2, 3, 4, 5, 6, 7, 8};
+    auto const b = VecTokens{1, 2, 3, 4, 9, 9, 7, 8};
+    EXPECT_EQ(tree.insert(a, {0, 1, 2, 3}), 4);
+    EXPECT_EQ(tree.insert(b, {0, 1, 4, 5}), 2);
+    EXPECT_EQ(tree.getNumBlocks(), 6);
+
+    EXPECT_EQ(tree.match(a).values, (std::vector<std::int32_t>{0, 1, 2, 3}));
+    EXPECT_EQ(tree.match(b).values, (std::vector<std::int32_t>{0, 1, 4, 5}));
+    EXPECT_EQ(tree.getNumMatchedTokens(VecTokens{1, 2, 3, 4, 5, 6, 0, 0}), 6);
+
+    // Shared prefix blocks have the same identity in both sequences.
+    EXPECT_EQ(tree.match(a).hashes.at(1), tree.match(b).hashes.at(1));
+    EXPECT_NE(tree.match(a).hashes.at(2), tree.match(b).hashes.at(2));
+}
+
+TEST(BlockRadixTreeTest, eraseLeaf)
+{
+    Tree tree(2);
+    auto const a = VecTokens{1, 2, 3, 4, 5, 6};
+    auto const b = VecTokens{1, 2, 3, 4, 7, 8};
+    tree.insert(a, {0, 1, 2});
+    tree.insert(b, {0, 1, 3});
+
+    // Inner block can't be erased.
+    EXPECT_FALSE(tree.eraseLeaf(VecTokens{1, 2, 3, 4}).has_value());
+    // Unknown block can't be erased.
+    EXPECT_FALSE(tree.eraseLeaf(VecTokens{1, 2, 3, 4, 0, 0}).has_value());
+
+    EXPECT_EQ(tree.eraseLeaf(b).value(), 3);
+    EXPECT_EQ(tree.getNumBlocks(), 3);
+    EXPECT_EQ(tree.getNumMatchedTokens(b), 4);
+    EXPECT_EQ(tree.match(a).values, (std::vector<std::int32_t>{0, 1, 2}));
+
+    // After the branch is gone, the remaining chain can be unwound block by block.
+    EXPECT_EQ(tree.eraseLeaf(a).value(), 2);
+    EXPECT_EQ(tree.eraseLeaf(VecTokens{1, 2, 3, 4}).value(), 1);
+    EXPECT_EQ(tree.eraseLeaf(VecTokens{1, 2}).value(), 0);
+    EXPECT_EQ(tree.getNumBlocks(), 0);
+    EXPECT_EQ(tree.getNumMatchedTokens(a), 0);
+
+    // Tree is still usable after being emptied.
+    EXPECT_EQ(tree.insert(a, {5, 6, 7}), 3);
+    EXPECT_EQ(tree.match(a).values, (std::vector<std::int32_t>{5, 6, 7}));
+}
+
+TEST(BlockRadixTreeTest, extendLeaf)
+{
+    Tree tree(2);
+    auto const tokens = makeTokens(8);
+    EXPECT_EQ(tree.insert(tokens.data(), 4, {0, 1}), 2);
+    EXPECT_EQ(tree.insert(tokens, {0, 1, 2, 3}), 2);
+    EXPECT_EQ(tree.match(tokens).values, (std::vector<std::int32_t>{0, 1, 2, 3}));
+    EXPECT_EQ(tree.eraseLeaf(tokens).value(), 3);
+    EXPECT_EQ(tree.getNumMatchedTokens(tokens), 6);
+}
+
+TEST(ReusableTokensEstimatesTest, estimateFromTree)
+{
+    Tree tree(4);
+    auto const cached = makeTokens(12);
+    tree.insert(cached, {0, 1, 2});
+
+    ReusableTokensEstimates estimates;
+    auto prompt = makeTokens(11);
+    prompt.push_back(100);
+    // Two full blocks match, the third one differs in its last token.
+    EXPECT_EQ(estimates.estimate(7, tree, prompt), 8);
+    EXPECT_EQ(estimates.get(7), 8);
+    EXPECT_EQ(estimates.get(8), 0);
+
+    // Estimates never exceed the prompt.
+    estimates.set(8, 20, 12);
+    EXPECT_EQ(estimates.get(8), 12);
+    EXPECT_EQ(estimates.size(), 2);
+
+    estimates.erase(7);
+    EXPECT_EQ(estimates.get(7), 0);
+    EXPECT_EQ(estimates.size(), 1);
+    EXPECT_THROW(estimates.set(9, -1, 12), tensorrt_llm::common::TllmException);
+}
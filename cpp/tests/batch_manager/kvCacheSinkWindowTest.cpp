@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/kvCacheSinkWindow.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager::kv_cache_manager;
+
+namespace
+{
+using IdType = SinkWindowBlockTable::IdType;
+} // namespace
+
+TEST(SinkWindowBlockTableTest, layoutMatchesCyclicKvCache)
+{
+    // 6 sink tokens padded with a bubble of 2 to 2 blocks, then a ring of 16 - 6 + 4 = 14 tokens in 4 blocks.
+    SinkWindowBlockTable table(4, 16, 6, true);
+    EXPECT_EQ(table.getNumSinkBlocks(), 2);
+    EXPECT_EQ(table.getMaxBlocksPerSeq(), 6);
+
+    EXPECT_EQ(table.getBlockSlot(5), 1);
+    EXPECT_EQ(table.getBlockSlot(6), 2);
+    EXPECT_EQ(table.getBlockSlot(19), 5);
+    // Token 20 wraps around to the first cyclic block, the sink blocks are never overwritten.
+    EXPECT_EQ(table.getBlockSlot(20), 2);
+    EXPECT_EQ(table.getBlockSlot(1000), 2 + ((1000 - 6) % 14) / 4);
+}
+
+TEST(SinkWindowBlockTableTest, neededBlocksAreBoundedByWindow)
+{
+    SinkWindowBlockTable table(4, 16, 4, false);
+    EXPECT_EQ(table.getMaxBlocksPerSeq(), 4);
+    EXPECT_EQ(table.getNumBlocks(3), 1);
+    EXPECT_EQ(table.getNumBlocks(9), 3);
+    EXPECT_EQ(table.getNeededBlocksToCompletion(9, 1 << 20), 1);
+    EXPECT_EQ(table.getNeededBlocksToCompletion(100, 1 << 20), 0);
+}
+
+TEST(SinkWindowBlockTableTest, slidingWindowReusesBlocks)
+{
+    SinkWindowBlockTable table(4, 16, 4, false);
+    IdType nextBlockId{0};
+    auto const allocator = [&nextBlockId]() { return nextBlockId++; };
+
+    table.addSequence(0, 10, allocator);
+    EXPECT_EQ(table.getBlockIds(0), (std::vector<IdType>{0, 1, 2}));
+    for (int i = 0; i < 1000; ++i)
+    {
+        table.addToken(0, allocator);
+    }
+    EXPECT_EQ(table.getNumTokens(0), 1010);
+    EXPECT_EQ(table.getBlockIds(0), (std::vector<IdType>{0, 1, 2, 3}));
+    EXPECT_EQ(table.getNumUsedBlocks(), 4);
+    EXPECT_EQ(nextBlockId, 4);
+
+    // Token 1012 is the next one starting a block, it overwrites the block in place.
+    EXPECT_FALSE(table.addToken(0, allocator));
+    EXPECT_FALSE(table.addToken(0, allocator));
+    EXPECT_TRUE(table.addToken(0, allocator));
+    EXPECT_EQ(nextBlockId, 4);
+
+    EXPECT_EQ(table.removeSequence(0), (std::vector<IdType>{0, 1, 2, 3}));
+    EXPECT_EQ(table.getNumUsedBlocks(), 0);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/batch_manager/kvCacheStatsCollector.h"
+#include "tensorrt_llm/executor/executor.h"
+
+#include <vector>
+
+using namespace tensorrt_llm::batch_manager;
+using Snapshot = KvCacheStatsCollector::Snapshot;
+
+namespace
+{
+Snapshot makeSnapshot(std::size_t numAllocTotal, std::size_t numAllocNew, std::vector<bool> isPrimary,
+    std::vector<bool> hasRefs, int numFreeSecondaryBlocks = 2)
+{
+    Snapshot snapshot;
+    snapshot.numAllocTotalBlocks = numAllocTotal;
+    snapshot.numAllocNewBlocks = numAllocNew;
+    snapshot.numSecondaryBlocks = 2;
+    snapshot.numFreeSecondaryBlocks = numFreeSecondaryBlocks;
+    snapshot.isPrimary = std::move(isPrimary);
+    snapshot.hasRefs = std::move(hasRefs);
+    return snapshot;
+}
+} // namespace
+
+TEST(KvCacheStatsCollectorTest, reuseCountersPerIteration)
+{
+    KvCacheStatsCollector collector{32};
+    auto stats = collector.endIteration(makeSnapshot(10, 10, {true, true, false}, {true, true, false}));
+    EXPECT_EQ(stats.numAllocatedBlocks, 10);
+    EXPECT_EQ(stats.numReusedBlocks, 0);
+
+    stats = collector.endIteration(makeSnapshot(18, 12, {true, true, false}, {true, true, false}));
+    EXPECT_EQ(stats.numAllocatedBlocks, 8);
+    EXPECT_EQ(stats.numReusedBlocks, 6);
+    EXPECT_EQ(stats.numReusedTokens, 6 * 32);
+    EXPECT_FLOAT_EQ(stats.getReuseHitRate(), 0.75F);
+}
+
+TEST(KvCacheStatsCollectorTest, onboardAndOffload)
+{
+    KvCacheStatsCollector collector{16};
+    std::vector<bool> const free(4, false);
+    static_cast<void>(collector.endIteration(makeSnapshot(0, 0, {true, true, false, false}, free)));
+    // Block 1 was offloaded, its memory swapped with block 2, and block 3 onboarded
+    auto const stats = collector.endIteration(makeSnapshot(0, 0, {true, false, true, true}, free, 1));
+    EXPECT_EQ(stats.numOffloadedBlocks, 1);
+    EXPECT_EQ(stats.numOnboardedBlocks, 2);
+    EXPECT_EQ(stats.numUsedSecondaryBlocks, 1);
+    EXPECT_FLOAT_EQ(stats.getSecondaryOccupancy(), 0.5F);
+}
+
+TEST(KvCacheStatsCollectorTest, freeBlockAges)
+{
+    KvCacheStatsCollector collector{16};
+    std::vector<bool> const primary(3, true);
+    // Block 0 is held in the first iteration, block 1 until the third, block 2 never
+    static_cast<void>(collector.endIteration(makeSnapshot(0, 0, primary, {true, true, false})));
+    static_cast<void>(collector.endIteration(makeSnapshot(0, 0, primary, {false, true, false})));
+    static_cast<void>(collector.endIteration(makeSnapshot(0, 0, primary, {false, true, false})));
+    auto stats = collector.endIteration(makeSnapshot(0, 0, primary, {false, false, false}));
+    ASSERT_EQ(stats.freeBlockAgeHistogram.size(), static_cast<std::size_t>(KvCacheStatsCollector::kNUM_AGE_BUCKETS));
+    // Block 0 was released 3 iterations ago, block 1 in the last one
+    EXPECT_EQ(stats.freeBlockAgeHistogram[0], 0);
+    EXPECT_EQ(stats.freeBlockAgeHistogram[1], 1);
+    EXPECT_EQ(stats.freeBlockAgeHistogram[2], 1);
+
+    auto const json = tensorrt_llm::executor::JsonSerialization::toJsonStr(stats);
+    EXPECT_NE(json.find("\"freeBlockAgeHistogram\":[0,1,1,0"), std::string::npos) << json;
+}
+
+TEST(KvCacheStatsCollectorTest, inconsistentSnapshots)
+{
+    KvCacheStatsCollector collector{16};
+    EXPECT_THROW(collector.endIteration(makeSnapshot(0, 0, {true}, {true, false})),
+        tensorrt_llm::common::TllmException);
+    static_cast<void>(collector.endIteration(makeSnapshot(0, 0, {true}, {true})));
+    EXPECT_THROW(collector.endIteration(makeSnapshot(0, 0, {true, true}, {true, true})),
+        tensorrt_llm::common::TllmException);
+}
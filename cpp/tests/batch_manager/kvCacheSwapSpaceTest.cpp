@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/kvCacheSwapSpace.h"
+
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+using namespace tensorrt_llm::batch_manager::kv_cache_manager;
+using IdType = KVCacheSwapSpace::IdType;
+
+namespace
+{
+// Records the queued moves like KVCacheTransferManager would submit them
+struct FakeTransferManager
+{
+    void offload(IdType primaryBlockIdx, IdType secondaryBlockIdx)
+    {
+        offloads.emplace_back(primaryBlockIdx, secondaryBlockIdx);
+    }
+
+    void onboard(IdType secondaryBlockIdx, IdType primaryBlockIdx)
+    {
+        onboards.emplace_back(secondaryBlockIdx, primaryBlockIdx);
+    }
+
+    std::vector<std::pair<IdType, IdType>> offloads;
+    std::vector<std::pair<IdType, IdType>> onboards;
+};
+} // namespace
+
+TEST(KVCacheSwapSpaceTest, swapOutAndIn)
+{
+    KVCacheSwapSpace swapSpace{{0, 1, 2, 3}};
+    FakeTransferManager transferManager;
+
+    EXPECT_EQ(swapSpace.choosePreemptionMode(16384, 3, 4096), PreemptionMode::kSWAP);
+    EXPECT_EQ(swapSpace.choosePreemptionMode(1024, 3, 4096), PreemptionMode::kRECOMPUTE);
+    EXPECT_EQ(swapSpace.choosePreemptionMode(16384, 5, 4096), PreemptionMode::kRECOMPUTE);
+
+    swapSpace.swapOut(7, {10, 11, 12}, transferManager);
+    EXPECT_TRUE(swapSpace.isSwappedOut(7));
+    EXPECT_EQ(swapSpace.getNumSwappedBlocks(7), 3);
+    EXPECT_EQ(swapSpace.getNumFreeBlocks(), 1);
+    ASSERT_EQ(transferManager.offloads.size(), 3);
+    EXPECT_FALSE(swapSpace.canSwapOut(2));
+    EXPECT_THROW(swapSpace.swapOut(8, {20, 21}, transferManager), tensorrt_llm::common::TllmException);
+
+    // Resume into different primary blocks, in the same order
+    swapSpace.swapIn(7, {30, 31, 32}, transferManager);
+    ASSERT_EQ(transferManager.onboards.size(), 3);
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(transferManager.onboards[i].first, transferManager.offloads[i].second);
+        EXPECT_EQ(transferManager.onboards[i].second, 30 + static_cast<IdType>(i));
+    }
+    EXPECT_FALSE(swapSpace.isSwappedOut(7));
+    EXPECT_EQ(swapSpace.getNumFreeBlocks(), 4);
+}
+
+TEST(KVCacheSwapSpaceTest, drop)
+{
+    KVCacheSwapSpace swapSpace{{0, 1}};
+    FakeTransferManager transferManager;
+    swapSpace.swapOut(1, {5, 6}, transferManager);
+    EXPECT_THROW(swapSpace.swapIn(1, {7}, transferManager), tensorrt_llm::common::TllmException);
+    swapSpace.drop(1);
+    EXPECT_EQ(swapSpace.getNumFreeBlocks(), 2);
+    EXPECT_TRUE(transferManager.onboards.empty());
+}
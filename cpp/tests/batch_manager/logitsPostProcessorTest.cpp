@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/logitsPostProcessor.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+using namespace tensorrt_llm::batch_manager;
+
+namespace
+{
+
+// Minimal stand-in for LlmRequest with a float as logits "tensor" and an int as stream
+struct FakeRequest
+{
+    using RequestIdType = std::uint64_t;
+    using BeamTokens = std::vector<std::vector<std::int32_t>>;
+    using TensorPtr = std::shared_ptr<float>;
+    using LogitsPostProcessor = std::function<void(RequestIdType, TensorPtr&, BeamTokens const&, int)>;
+    using LogitsPostProcessorBatched = std::function<void(std::vector<RequestIdType> const&, std::vector<TensorPtr>&,
+        std::vector<std::reference_wrapper<BeamTokens const>> const&, int const&)>;
+
+    [[nodiscard]] BeamTokens const& getTokens() const
+    {
+        return tokens;
+    }
+
+    RequestIdType mRequestId;
+    std::optional<LogitsPostProcessor> mLogitsPostProcessor;
+    BeamTokens tokens;
+};
+
+} // namespace
+
+TEST(LogitsPostProcessorTest, batchedAndPerRequest)
+{
+    int numSingleCalls{0};
+    FakeRequest::LogitsPostProcessor const single
+        = [&numSingleCalls](FakeRequest::RequestIdType, FakeRequest::TensorPtr& logits, FakeRequest::BeamTokens const&,
+              int)
+    {
+        *logits += 1.f;
+        ++numSingleCalls;
+    };
+
+    int numBatchedCalls{0};
+    std::vector<FakeRequest::RequestIdType> batchedIds;
+    FakeRequest::LogitsPostProcessorBatched const batched
+        = [&](std::vector<FakeRequest::RequestIdType> const& ids, std::vector<FakeRequest::TensorPtr>& logits,
+              std::vector<std::reference_wrapper<FakeRequest::BeamTokens const>> const& tokens, int const& stream)
+    {
+        EXPECT_EQ(stream, 7);
+        ASSERT_EQ(logits.size(), ids.size());
+        ASSERT_EQ(tokens.size(), ids.size());
+        batchedIds = ids;
+        for (auto& tensor : logits)
+        {
+            tensor = std::make_shared<float>(*tensor * 10.f);
+        }
+        ++numBatchedCalls;
+    };
+
+    std::vector<std::shared_ptr<FakeRequest>> const requests{
+        std::make_shared<FakeRequest>(FakeRequest{1, std::nullopt, {{1, 2}}}),
+        std::make_shared<FakeRequest>(FakeRequest{2, single, {{3}}}),
+        std::make_shared<FakeRequest>(FakeRequest{3, std::nullopt, {{4}}}),
+        std::make_shared<FakeRequest>(FakeRequest{4, single, {{5}}}),
+    };
+    std::unordered_set<FakeRequest::RequestIdType> const batchedRequestIds{1, 4};
+    std::vector<FakeRequest::TensorPtr> logits;
+    for (int i = 0; i < 4; ++i)
+    {
+        logits.push_back(std::make_shared<float>(static_cast<float>(i)));
+    }
+
+    EXPECT_TRUE(applyLogitsPostProcessors(requests, logits, 7, std::make_optional(batched), batchedRequestIds));
+    EXPECT_EQ(numBatchedCalls, 1);
+    EXPECT_EQ(numSingleCalls, 1);
+    EXPECT_EQ(batchedIds, (std::vector<FakeRequest::RequestIdType>{1, 4}));
+    EXPECT_FLOAT_EQ(*logits[0], 0.f);
+    EXPECT_FLOAT_EQ(*logits[1], 2.f);
+    EXPECT_FLOAT_EQ(*logits[2], 2.f);
+    EXPECT_FLOAT_EQ(*logits[3], 30.f);
+
+    // Without batched post-processor, requests fall back to their own one
+    EXPECT_TRUE(applyLogitsPostProcessors(requests, logits, 7,
+        std::optional<FakeRequest::LogitsPostProcessorBatched>{std::nullopt}, batchedRequestIds));
+    EXPECT_EQ(numBatchedCalls, 1);
+    EXPECT_EQ(numSingleCalls, 3);
+}
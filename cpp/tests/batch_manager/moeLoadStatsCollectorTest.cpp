@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/moeLoadStatsCollector.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager;
+using tensorrt_llm::runtime::SizeType32;
+
+TEST(MoeLoadStatsCollectorTest, iterationAndTotalCounts)
+{
+    MoeLoadStatsCollector collector{2, 4};
+
+    // Two ranks with two experts each report their slice
+    collector.recordLayer(0, 0, {6, 2});
+    collector.recordLayer(0, 2, {0, 0});
+    collector.recordLayer(1, 2, {1, 3});
+
+    auto stats = collector.endIteration();
+    ASSERT_EQ(stats.expertTokenCounts.size(), 2);
+    EXPECT_EQ(stats.expertTokenCounts[0], (std::vector<SizeType32>{6, 2, 0, 0}));
+    EXPECT_EQ(stats.expertTokenCounts[1], (std::vector<SizeType32>{0, 0, 1, 3}));
+    // Layer 0 puts all 8 tokens on rank 0
+    EXPECT_FLOAT_EQ(stats.getMaxRankImbalance(2), 2.F);
+    EXPECT_FLOAT_EQ(stats.getMaxRankImbalance(1), 1.F);
+
+    collector.recordLayer(0, 0, {1, 1, 1, 1});
+    stats = collector.endIteration();
+    EXPECT_EQ(stats.expertTokenCounts[0], (std::vector<SizeType32>{1, 1, 1, 1}));
+    EXPECT_EQ(stats.expertTokenCounts[1], (std::vector<SizeType32>{0, 0, 0, 0}));
+    EXPECT_FLOAT_EQ(stats.getMaxRankImbalance(2), 1.F);
+
+    EXPECT_EQ(collector.getTotalCounts(0), (std::vector<std::int64_t>{7, 3, 1, 1}));
+    collector.resetTotals();
+    EXPECT_EQ(collector.getTotalCounts(0), (std::vector<std::int64_t>{0, 0, 0, 0}));
+}
+
+TEST(MoeLoadStatsCollectorTest, rejectsInvalidLayers)
+{
+    MoeLoadStatsCollector collector{1, 4};
+    EXPECT_THROW(collector.recordLayer(1, 0, {1}), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(collector.recordLayer(0, 3, {1, 1}), tensorrt_llm::common::TllmException);
+}
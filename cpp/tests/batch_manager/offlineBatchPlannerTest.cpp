@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/offlineBatchPlanner.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+using namespace tensorrt_llm::batch_manager;
+using SizeType32 = OfflineBatchPlanner::SizeType32;
+using TokenIdType = OfflineBatchPlanner::TokenIdType;
+using VecTokens = OfflineBatchPlanner::VecTokens;
+using Indices = std::vector<std::size_t>;
+
+namespace
+{
+VecTokens makePrompt(TokenIdType first, SizeType32 length)
+{
+    VecTokens prompt(length);
+    std::iota(prompt.begin(), prompt.end(), first);
+    return prompt;
+}
+
+VecTokens withSuffix(VecTokens prompt, VecTokens const& suffix)
+{
+    prompt.insert(prompt.end(), suffix.begin(), suffix.end());
+    return prompt;
+}
+} // namespace
+
+TEST(OfflineBatchPlannerTest, groupsSharedPrefixesLongestFirst)
+{
+    OfflineBatchPlanner planner{4, 100};
+    auto const systemPrompt = makePrompt(100, 8);
+    std::vector<VecTokens> const prompts{
+        makePrompt(0, 3),                    // 0: short, no shared block
+        withSuffix(systemPrompt, {9, 9}),    // 1
+        makePrompt(500, 12),                 // 2: the longest, alone
+        withSuffix(systemPrompt, {1}),       // 3: shares the prompt of 1
+        makePrompt(900, 6),                  // 4
+        withSuffix(systemPrompt, {5, 5, 5}), // 5: shares the prompt of 1
+    };
+    std::vector<SizeType32> const outputLengths{2, 4, 40, 4, 1, 4};
+    planner.plan(prompts, outputLengths);
+    EXPECT_EQ(planner.getNumBlocks(2), 13);
+    EXPECT_EQ(planner.getNumBlocks(0), 2);
+
+    // Without capacity, the lookahead is released in the planned order
+    EXPECT_EQ(planner.next(), (Indices{2, 3, 5, 1, 4, 0}));
+    EXPECT_TRUE(planner.next().empty());
+    for (std::size_t idx = 0; idx < prompts.size(); ++idx)
+    {
+        planner.complete(idx);
+    }
+    EXPECT_TRUE(planner.isDone());
+    EXPECT_EQ(planner.getNumInFlightBlocks(), 0);
+}
+
+TEST(OfflineBatchPlannerTest, packsWithinCapacity)
+{
+    OfflineBatchPlanner planner{4, 8};
+    planner.setMaxNumBlocks(10);
+    // Total lengths 24, 20, 16, 4 tokens: 6, 5, 4 and 1 blocks
+    std::vector<VecTokens> const prompts{makePrompt(0, 3), makePrompt(10, 3), makePrompt(20, 3), makePrompt(30, 3)};
+    planner.plan(prompts, {21, 17, 13, 1});
+
+    // The first request and the one after next fill the cache, the second one waits
+    EXPECT_EQ(planner.next(), (Indices{0, 2}));
+    EXPECT_EQ(planner.getNumInFlightBlocks(), 10);
+    EXPECT_TRUE(planner.next().empty());
+
+    planner.complete(2);
+    EXPECT_EQ(planner.next(), (Indices{3}));
+    planner.complete(0);
+    EXPECT_EQ(planner.next(), (Indices{1}));
+    planner.complete(1);
+    planner.complete(3);
+    EXPECT_TRUE(planner.isDone());
+}
+
+TEST(OfflineBatchPlannerTest, oversizeRequestRunsAlone)
+{
+    OfflineBatchPlanner planner{4, 8};
+    planner.setMaxNumBlocks(4);
+    planner.plan({makePrompt(0, 3), makePrompt(10, 3)}, {61, 1});
+
+    EXPECT_EQ(planner.next(), (Indices{0}));
+    EXPECT_TRUE(planner.next().empty());
+    planner.complete(0);
+    EXPECT_EQ(planner.next(), (Indices{1}));
+}
+
+TEST(OfflineBatchPlannerTest, limitsLookahead)
+{
+    OfflineBatchPlanner planner{4, 2};
+    planner.setMaxNumBlocks(3);
+    planner.plan({makePrompt(0, 3), makePrompt(10, 3), makePrompt(20, 3), makePrompt(30, 1)}, {9, 9, 9, 1});
+
+    // Only the first two pending requests are considered, the small last one can't jump the queue
+    EXPECT_EQ(planner.next(), (Indices{0}));
+    EXPECT_TRUE(planner.next().empty());
+    EXPECT_THROW(OfflineBatchPlanner(0, 1), tensorrt_llm::common::TllmException);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/overlapStepPlanner.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace tensorrt_llm::batch_manager;
+using SizeType32 = OverlapStepPlanner::SizeType32;
+
+TEST(OverlapStepPlannerTest, speculationHolds)
+{
+    OverlapStepPlanner planner{8};
+
+    auto const& prepared = planner.speculate({3, 1, 5});
+    EXPECT_EQ(prepared, (std::vector<SizeType32>{3, 1, 5}));
+    EXPECT_TRUE(planner.isPending());
+
+    auto const patch = planner.reconcile({});
+    EXPECT_TRUE(patch.empty());
+    EXPECT_FALSE(planner.isPending());
+    EXPECT_EQ(planner.getPrepared(), (std::vector<SizeType32>{3, 1, 5}));
+    EXPECT_EQ(planner.getNumSpeculatedSteps(), 1u);
+    EXPECT_EQ(planner.getNumPatchedSteps(), 0u);
+}
+
+TEST(OverlapStepPlannerTest, earlyFinishes)
+{
+    OverlapStepPlanner planner{8};
+    planner.speculate({3, 1, 5, 0});
+
+    // Slot 7 finished with its context and was never prepared
+    auto const patch = planner.reconcile({5, 7, 3});
+    EXPECT_EQ(patch.rows, (std::vector<SizeType32>{0, 2}));
+    EXPECT_EQ(patch.seqSlots, (std::vector<SizeType32>{3, 5}));
+    EXPECT_EQ(planner.getPrepared(), (std::vector<SizeType32>{1, 0}));
+    EXPECT_EQ(planner.getNumPatchedSteps(), 1u);
+
+    // The block offsets of the prepared rows, two per row
+    std::vector<int> offsets{30, 31, 10, 11, 50, 51, 0, 1};
+    auto const numRows = OverlapStepPlanner::compact(offsets.data(), 4, 2, patch);
+    ASSERT_EQ(numRows, 2);
+    offsets.resize(numRows * 2);
+    EXPECT_EQ(offsets, (std::vector<int>{10, 11, 0, 1}));
+
+    // The next speculation starts from the patched batch
+    auto const& prepared = planner.speculate(planner.getPrepared());
+    EXPECT_EQ(prepared, (std::vector<SizeType32>{1, 0}));
+    auto const next = planner.reconcile({0});
+    EXPECT_EQ(next.rows, (std::vector<SizeType32>{1}));
+    EXPECT_EQ(planner.getPrepared(), (std::vector<SizeType32>{1}));
+}
+
+TEST(OverlapStepPlannerTest, invalidUse)
+{
+    OverlapStepPlanner planner{4};
+    EXPECT_THROW(static_cast<void>(planner.reconcile({})), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(planner.speculate({4}), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(planner.speculate({1, 1}), tensorrt_llm::common::TllmException);
+
+    planner.speculate({0, 2});
+    EXPECT_THROW(planner.speculate({0, 2}), tensorrt_llm::common::TllmException);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/batch_manager/parallelSampling.h"
+
+#include <set>
+
+using namespace tensorrt_llm::batch_manager;
+namespace texec = tensorrt_llm::executor;
+using SizeType32 = ParallelSampleGroup::SizeType32;
+
+namespace
+{
+texec::Result makeResult(texec::VecTokens tokens, float cumLogProb)
+{
+    texec::Result result{};
+    result.isFinal = true;
+    result.outputTokenIds = {std::move(tokens)};
+    result.cumLogProbs = texec::VecLogProbs{cumLogProb};
+    return result;
+}
+} // namespace
+
+TEST(ParallelSampleGroupTest, mergesSamplesInOrder)
+{
+    ParallelSampleGroup group{3};
+    EXPECT_FALSE(group.addResult(2, makeResult({7, 8}, -3.f)));
+    EXPECT_FALSE(group.addResult(0, makeResult({1, 2, 3}, -1.f)));
+    EXPECT_FALSE(group.isComplete());
+    EXPECT_THROW(static_cast<void>(group.merge()), tensorrt_llm::common::TllmException);
+    EXPECT_TRUE(group.addResult(1, makeResult({4}, -2.f)));
+
+    auto const merged = group.merge();
+    EXPECT_TRUE(merged.isFinal);
+    ASSERT_EQ(merged.outputTokenIds.size(), 3);
+    EXPECT_EQ(merged.outputTokenIds[0], (texec::VecTokens{1, 2, 3}));
+    EXPECT_EQ(merged.outputTokenIds[1], (texec::VecTokens{4}));
+    EXPECT_EQ(merged.outputTokenIds[2], (texec::VecTokens{7, 8}));
+    ASSERT_TRUE(merged.cumLogProbs);
+    EXPECT_EQ(*merged.cumLogProbs, (texec::VecLogProbs{-1.f, -2.f, -3.f}));
+    EXPECT_FALSE(merged.logProbs);
+}
+
+TEST(ParallelSampleGroupTest, countsRepeatedResultsOnce)
+{
+    ParallelSampleGroup group{2};
+    EXPECT_FALSE(group.addResult(0, makeResult({1}, 0.f)));
+    EXPECT_FALSE(group.addResult(0, makeResult({2}, 0.f)));
+    EXPECT_TRUE(group.addResult(1, makeResult({3}, 0.f)));
+    EXPECT_EQ(group.merge().outputTokenIds.front(), (texec::VecTokens{2}));
+}
+
+TEST(ParallelSampleGroupTest, rejectsInvalidSamples)
+{
+    EXPECT_THROW(ParallelSampleGroup{0}, tensorrt_llm::common::TllmException);
+    ParallelSampleGroup group{2};
+    EXPECT_THROW(group.addResult(2, makeResult({1}, 0.f)), tensorrt_llm::common::TllmException);
+    auto beams = makeResult({1}, 0.f);
+    beams.outputTokenIds.push_back({2});
+    EXPECT_THROW(group.addResult(0, beams), tensorrt_llm::common::TllmException);
+}
+
+TEST(ParallelSampleGroupTest, derivesDistinctSeeds)
+{
+    EXPECT_EQ(ParallelSampleGroup::getSampleSeed(42, 1, 0), 42);
+    EXPECT_EQ(ParallelSampleGroup::getSampleSeed(42, 7, 3), 45);
+
+    std::set<texec::RandomSeedType> seeds;
+    for (texec::IdType requestId = 1; requestId <= 16; ++requestId)
+    {
+        for (SizeType32 sampleIdx = 0; sampleIdx < 16; ++sampleIdx)
+        {
+            auto const seed = ParallelSampleGroup::getSampleSeed(std::nullopt, requestId, sampleIdx);
+            EXPECT_EQ(seed, ParallelSampleGroup::getSampleSeed(std::nullopt, requestId, sampleIdx));
+            seeds.insert(seed);
+        }
+    }
+    EXPECT_EQ(seeds.size(), 256);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/pipelineMicroBatchScheduler.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager;
+using RequestIdType = PipelineMicroBatchScheduler::RequestIdType;
+
+TEST(PipelineMicroBatchSchedulerTest, spreadsRequestsOverStages)
+{
+    PipelineMicroBatchScheduler scheduler{4, 8};
+    for (RequestIdType id = 0; id < 8; ++id)
+    {
+        scheduler.addRequest(id, 1);
+    }
+
+    // Every stage gets a micro batch of two requests
+    for (int i = 0; i < 4; ++i)
+    {
+        auto const microBatch = scheduler.launchNext();
+        ASSERT_TRUE(microBatch.has_value());
+        EXPECT_EQ(microBatch->microBatchIdx, i);
+        EXPECT_EQ(microBatch->requestIds.size(), 2);
+    }
+    EXPECT_EQ(scheduler.getNumInFlight(), 4);
+    EXPECT_EQ(scheduler.getNumReady(), 0);
+    EXPECT_FALSE(scheduler.launchNext().has_value());
+}
+
+TEST(PipelineMicroBatchSchedulerTest, rebalancesFinishedRequests)
+{
+    PipelineMicroBatchScheduler scheduler{2, 8};
+    for (RequestIdType id = 0; id < 4; ++id)
+    {
+        scheduler.addRequest(id, 1);
+    }
+    auto const first = scheduler.launchNext();
+    auto const second = scheduler.launchNext();
+    EXPECT_EQ(first->requestIds, (std::vector<RequestIdType>{0, 1}));
+    EXPECT_EQ(second->requestIds, (std::vector<RequestIdType>{2, 3}));
+
+    // Both requests of the first micro batch finish, it takes a new request and one of the second micro batch
+    scheduler.removeRequest(0);
+    scheduler.removeRequest(1);
+    scheduler.addRequest(4, 1);
+    scheduler.completeMicroBatch(0);
+    scheduler.completeMicroBatch(1);
+    auto const next = scheduler.launchNext();
+    EXPECT_EQ(next->microBatchIdx, 0);
+    EXPECT_EQ(next->requestIds, (std::vector<RequestIdType>{4, 2}));
+    EXPECT_EQ(scheduler.launchNext()->requestIds, (std::vector<RequestIdType>{3}));
+
+    // A long prompt fills a micro batch on its own
+    scheduler.completeMicroBatch(0);
+    scheduler.updateRequest(4, 1000);
+    EXPECT_EQ(scheduler.launchNext()->requestIds, (std::vector<RequestIdType>{4}));
+}
+
+TEST(PipelineMicroBatchSchedulerTest, interleavedStageOrder)
+{
+    PipelineMicroBatchScheduler const scheduler{2, 8, 2, 4};
+    auto const order = scheduler.getRankStageOrder();
+    std::vector<std::pair<int, int>> const expected{
+        {0, 0}, {1, 0}, {0, 1}, {1, 1}, {2, 0}, {3, 0}, {2, 1}, {3, 1}};
+    ASSERT_EQ(order.size(), expected.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        EXPECT_EQ(order[i].microBatchIdx, expected[i].first);
+        EXPECT_EQ(order[i].virtualStage, expected[i].second);
+    }
+
+    EXPECT_THROW((PipelineMicroBatchScheduler{4, 8, 1, 2}), tensorrt_llm::common::TllmException);
+    EXPECT_THROW((PipelineMicroBatchScheduler{2, 8, 2, 3}), tensorrt_llm::common::TllmException);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/promptTableCache.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace tensorrt_llm::batch_manager;
+namespace tc = tensorrt_llm::common;
+namespace texec = tensorrt_llm::executor;
+
+class PromptTableCacheTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP();
+        }
+        mStream = std::make_shared<tensorrt_llm::runtime::CudaStream>();
+    }
+
+    texec::Tensor::CudaStreamPtr mStream;
+};
+
+TEST_F(PromptTableCacheTest, hashFollowsContent)
+{
+    std::vector<float> a(24, 1.0f);
+    std::vector<float> b(a);
+    auto const tableA = texec::Tensor::of(a.data(), {4, 6});
+    auto const tableB = texec::Tensor::of(b.data(), {4, 6});
+    EXPECT_EQ(PromptTableCache::hashTable(tableA), PromptTableCache::hashTable(tableB));
+
+    b[23] = 2.0f;
+    EXPECT_NE(PromptTableCache::hashTable(tableA), PromptTableCache::hashTable(tableB));
+    // Same bytes in another shape
+    EXPECT_NE(PromptTableCache::hashTable(tableA), PromptTableCache::hashTable(texec::Tensor::of(a.data(), {6, 4})));
+}
+
+TEST_F(PromptTableCacheTest, uploadsOncePerContent)
+{
+    PromptTableCache cache{1 << 20, mStream};
+    std::vector<float> image(32, 0.5f);
+    auto const first = cache.getOrUpload(texec::Tensor::of(image.data(), {4, 8})).getEmbeddingTable();
+    EXPECT_EQ(first.getMemoryType(), texec::MemoryType::kGPU);
+
+    std::vector<float> sameImage(image);
+    auto const second = cache.getOrUpload(texec::Tensor::of(sameImage.data(), {4, 8})).getEmbeddingTable();
+    EXPECT_EQ(second.getData(), first.getData());
+    EXPECT_EQ(cache.getNumHits(), 1);
+    EXPECT_EQ(cache.getNumMisses(), 1);
+    EXPECT_EQ(cache.getResidentBytes(), image.size() * sizeof(float));
+
+    auto const host = second.copyToCpu(mStream);
+    mStream->synchronize();
+    auto const* values = static_cast<float const*>(host.getData());
+    EXPECT_EQ(std::vector<float>(values, values + image.size()), image);
+}
+
+TEST_F(PromptTableCacheTest, evictsLeastRecentlyUsed)
+{
+    std::size_t constexpr tableBytes = 16 * sizeof(float);
+    PromptTableCache cache{2 * tableBytes, mStream};
+    std::vector<std::vector<float>> images{std::vector<float>(16, 1.0f), std::vector<float>(16, 2.0f),
+        std::vector<float>(16, 3.0f)};
+
+    auto const upload = [&](std::size_t i) { return cache.getOrUpload(texec::Tensor::of(images[i].data(), {2, 8})); };
+    (void) upload(0);
+    auto const held = upload(1).getEmbeddingTable();
+    (void) upload(0);
+    (void) upload(2);
+
+    EXPECT_EQ(cache.getNumTables(), 2);
+    EXPECT_EQ(cache.getResidentBytes(), 2 * tableBytes);
+    EXPECT_TRUE(cache.contains(PromptTableCache::hashTable(texec::Tensor::of(images[0].data(), {2, 8}))));
+    EXPECT_FALSE(cache.contains(PromptTableCache::hashTable(texec::Tensor::of(images[1].data(), {2, 8}))));
+    // The evicted table stays valid for its holders
+    EXPECT_NE(held.getData(), nullptr);
+}
+
+TEST_F(PromptTableCacheTest, callerKey)
+{
+    PromptTableCache cache{1 << 20, mStream};
+    std::vector<float> image(8, 1.0f);
+    std::vector<float> other(8, 2.0f);
+    auto const first = cache.getOrUpload(texec::Tensor::of(image.data(), {1, 8}), 42).getEmbeddingTable();
+    // The key is trusted, the content isn't hashed again
+    auto const second = cache.getOrUpload(texec::Tensor::of(other.data(), {1, 8}), 42).getEmbeddingTable();
+    EXPECT_EQ(second.getData(), first.getData());
+    EXPECT_TRUE(cache.erase(42));
+    EXPECT_FALSE(cache.contains(42));
+    EXPECT_EQ(cache.getResidentBytes(), 0);
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/batch_manager/replicaRouter.h"
+
+#include <numeric>
+#include <vector>
+
+using namespace tensorrt_llm::batch_manager;
+using SizeType32 = ReplicaRouter::SizeType32;
+using TokenIdType = ReplicaRouter::TokenIdType;
+
+namespace
+{
+std::vector<TokenIdType> makePrompt(TokenIdType first, SizeType32 length)
+{
+    std::vector<TokenIdType> prompt(length);
+    std::iota(prompt.begin(), prompt.end(), first);
+    return prompt;
+}
+} // namespace
+
+TEST(ReplicaRouterTest, balancesWithoutPrefixes)
+{
+    ReplicaRouter router{3, 16};
+    for (SizeType32 replica = 0; replica < 3; ++replica)
+    {
+        router.updateStats(replica, 100, 100);
+    }
+    std::vector<int> numRouted(3, 0);
+    for (TokenIdType i = 0; i < 30; ++i)
+    {
+        auto const decision = router.route(makePrompt(i * 1000, 64));
+        EXPECT_EQ(decision.numMatchedBlocks, 0);
+        EXPECT_EQ(decision.numReservedBlocks, 4);
+        ++numRouted[decision.replica];
+    }
+    EXPECT_EQ(numRouted, (std::vector<int>{10, 10, 10}));
+    EXPECT_EQ(router.getNumReservedBlocks(0), 40);
+}
+
+TEST(ReplicaRouterTest, prefersCachedPrefix)
+{
+    ReplicaRouter router{2, 16};
+    router.updateStats(0, 50, 100);
+    router.updateStats(1, 100, 100);
+    auto const prompt = makePrompt(0, 160);
+    auto const first = router.route(prompt);
+    EXPECT_EQ(first.replica, 1);
+    router.release(1, first.numReservedBlocks);
+    router.updateStats(1, 90, 100);
+
+    // Fewer free blocks, but the whole prompt is cached there
+    auto const second = router.route(prompt);
+    EXPECT_EQ(second.replica, 1);
+    EXPECT_EQ(second.numMatchedBlocks, 10);
+    EXPECT_EQ(second.numReservedBlocks, 0);
+
+    // A shared prefix with a new suffix only reserves the new blocks
+    auto extended = prompt;
+    auto const suffix = makePrompt(5000, 40);
+    extended.insert(extended.end(), suffix.begin(), suffix.end());
+    auto const third = router.route(extended);
+    EXPECT_EQ(third.replica, 1);
+    EXPECT_EQ(third.numMatchedBlocks, 10);
+    EXPECT_EQ(third.numReservedBlocks, 3);
+}
+
+TEST(ReplicaRouterTest, hotPrefixSpillsOver)
+{
+    ReplicaRouter router{2, 16};
+    router.updateStats(0, 100, 100);
+    router.updateStats(1, 100, 100);
+    auto const prompt = makePrompt(0, 160);
+    static_cast<void>(router.route(prompt));
+    // The replica caching the prefix is almost full
+    router.updateStats(0, 5, 100);
+    router.updateStats(1, 100, 100);
+    EXPECT_EQ(router.route(prompt).replica, 1);
+}
+
+TEST(ReplicaRouterTest, summaryForgetsBeyondCapacity)
+{
+    ReplicaRouter router{1, 16};
+    router.updateStats(0, 8, 8);
+    auto const prompt = makePrompt(0, 64);
+    static_cast<void>(router.route(prompt));
+    // Repeated prompts don't fill the summary
+    EXPECT_EQ(router.route(prompt).numMatchedBlocks, 4);
+    EXPECT_EQ(router.route(prompt).numMatchedBlocks, 4);
+    static_cast<void>(router.route(makePrompt(1000, 64)));
+    // The summary would hold 12 blocks, the replica can't cache more than 8
+    static_cast<void>(router.route(makePrompt(2000, 64)));
+    EXPECT_EQ(router.route(prompt).numMatchedBlocks, 0);
+}
+
+TEST(ReplicaRouterTest, invalidArguments)
+{
+    EXPECT_THROW(ReplicaRouter(0, 16), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(ReplicaRouter(2, 0), tensorrt_llm::common::TllmException);
+    ReplicaRouter router{2, 16};
+    EXPECT_THROW(router.updateStats(2, 10, 10), tensorrt_llm::common::TllmException);
+}
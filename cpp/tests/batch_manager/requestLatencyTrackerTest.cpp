@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/requestLatencyTracker.h"
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/executor/executor.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager;
+using WaitReason = RequestLatencyTracker::WaitReason;
+
+namespace
+{
+
+RequestLatencyTracker::TimePoint at(int ms)
+{
+    return RequestLatencyTracker::TimePoint{std::chrono::milliseconds{ms}};
+}
+
+} // namespace
+
+TEST(RequestLatencyTrackerTest, breakdown)
+{
+    RequestLatencyTracker tracker;
+    tracker.onArrival(1, at(0));
+    tracker.beginWait(1, WaitReason::kKV_CAPACITY, at(10));
+    tracker.endWait(1, WaitReason::kKV_CAPACITY, at(30));
+    tracker.beginWait(1, WaitReason::kLORA_LOAD, at(30));
+    tracker.endWait(1, WaitReason::kLORA_LOAD, at(35));
+    tracker.onScheduled(1, at(40));
+    tracker.recordContextChunk(1, at(40), at(50));
+    tracker.recordContextChunk(1, at(50), at(58));
+    tracker.onFirstToken(1, at(60));
+    tracker.recordGenerationStep(1, at(60), at(62));
+    // Paused for KV cache capacity during the generation, the queueing time doesn't change
+    tracker.beginWait(1, WaitReason::kKV_CAPACITY, at(62));
+    tracker.endWait(1, WaitReason::kKV_CAPACITY, at(70));
+    tracker.onScheduled(1, at(70));
+    tracker.recordGenerationStep(1, at(70), at(72));
+    tracker.onFirstToken(1, at(72));
+    tracker.recordResponseSerialization(1, at(72), at(73));
+
+    auto const stats = tracker.finish(1, at(75));
+    EXPECT_EQ(stats.id, 1U);
+    EXPECT_FLOAT_EQ(stats.queueTimeMs, 15.F);
+    EXPECT_FLOAT_EQ(stats.kvCapacityWaitTimeMs, 28.F);
+    EXPECT_FLOAT_EQ(stats.loraLoadWaitTimeMs, 5.F);
+    EXPECT_FLOAT_EQ(stats.kvOnboardWaitTimeMs, 0.F);
+    EXPECT_EQ(stats.contextChunkTimesMs, (std::vector<float>{10.F, 8.F}));
+    EXPECT_FLOAT_EQ(stats.getContextTimeMs(), 18.F);
+    EXPECT_FLOAT_EQ(stats.generationTimeMs, 4.F);
+    EXPECT_EQ(stats.numGenerationSteps, 2);
+    EXPECT_FLOAT_EQ(stats.responseSerializationTimeMs, 1.F);
+    EXPECT_FLOAT_EQ(stats.timeToFirstTokenMs, 60.F);
+    EXPECT_FLOAT_EQ(stats.endToEndTimeMs, 75.F);
+    EXPECT_EQ(tracker.getNumRequests(), 0U);
+    EXPECT_FALSE(tracker.getStats(1));
+}
+
+TEST(RequestLatencyTrackerTest, openWaitsCloseOnFinish)
+{
+    RequestLatencyTracker tracker;
+    tracker.onArrival(2, at(0));
+    tracker.beginWait(2, WaitReason::kKV_ONBOARD, at(5));
+    tracker.beginWait(2, WaitReason::kKV_ONBOARD, at(8));
+    EXPECT_FLOAT_EQ(tracker.getStats(2)->kvOnboardWaitTimeMs, 0.F);
+    // Cancelled while waiting
+    auto const stats = tracker.finish(2, at(9));
+    EXPECT_FLOAT_EQ(stats.kvOnboardWaitTimeMs, 4.F);
+    EXPECT_FLOAT_EQ(stats.queueTimeMs, 0.F);
+    EXPECT_FLOAT_EQ(stats.timeToFirstTokenMs, 0.F);
+
+    EXPECT_THROW(tracker.onScheduled(2, at(10)), tensorrt_llm::common::TllmException);
+    tracker.onArrival(3, at(0));
+    EXPECT_THROW(tracker.onArrival(3, at(1)), tensorrt_llm::common::TllmException);
+}
+
+TEST(RequestLatencyTrackerTest, json)
+{
+    tensorrt_llm::executor::RequestLatencyStats stats;
+    stats.id = 7;
+    stats.queueTimeMs = 1.5F;
+    stats.contextChunkTimesMs = {2.F, 3.F};
+    stats.numGenerationSteps = 4;
+    auto const json = tensorrt_llm::executor::JsonSerialization::toJsonStr(stats);
+    EXPECT_NE(json.find("\"id\":7"), std::string::npos);
+    EXPECT_NE(json.find("\"queueTimeMs\":1.5"), std::string::npos);
+    EXPECT_NE(json.find("\"contextTimeMs\":5"), std::string::npos);
+    EXPECT_NE(json.find("\"contextChunkTimesMs\":[2,3]"), std::string::npos);
+    EXPECT_NE(json.find("\"numGenerationSteps\":4"), std::string::npos);
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+}
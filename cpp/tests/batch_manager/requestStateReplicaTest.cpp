@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/requestStateReplica.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager;
+
+namespace
+{
+struct ScheduledState
+{
+    std::int32_t contextChunkSize;
+    std::int32_t numGeneratedTokens;
+};
+
+using Replica = RequestStateReplica<ScheduledState>;
+} // namespace
+
+TEST(RequestStateReplicaTest, onlyChangesAreSent)
+{
+    Replica leader;
+    Replica follower;
+
+    std::map<Replica::RequestIdType, ScheduledState> states{{1, {128, 0}}, {2, {64, 0}}};
+    auto delta = leader.encodeDelta(states, {{1, {'a', 'b'}}});
+    auto applied = follower.applyDelta(delta.data(), delta.size());
+    EXPECT_EQ(applied.iteration, 0);
+    ASSERT_EQ(applied.newRequests.size(), 2);
+    EXPECT_EQ(applied.newRequests[0].first, 1);
+    EXPECT_EQ(applied.newRequests[0].second, (std::vector<char>{'a', 'b'}));
+    EXPECT_TRUE(applied.newRequests[1].second.empty());
+    EXPECT_EQ(follower.getStates().size(), 2);
+
+    // Nothing changed, only the header is sent
+    auto const emptyDelta = leader.encodeDelta(states);
+    EXPECT_EQ(emptyDelta.size(), sizeof(std::uint64_t) + 3 * sizeof(std::uint32_t));
+    applied = follower.applyDelta(emptyDelta.data(), emptyDelta.size());
+    EXPECT_TRUE(applied.newRequests.empty() && applied.changedRequests.empty() && applied.finishedRequests.empty());
+
+    // Request 1 generates, request 2 finishes, request 3 arrives
+    states.erase(2);
+    states[1] = {0, 1};
+    states[3] = {32, 0};
+    delta = leader.encodeDelta(states);
+    applied = follower.applyDelta(delta.data(), delta.size());
+    EXPECT_EQ(applied.changedRequests, (std::vector<Replica::RequestIdType>{1}));
+    EXPECT_EQ(applied.finishedRequests, (std::vector<Replica::RequestIdType>{2}));
+    ASSERT_EQ(applied.newRequests.size(), 1);
+    EXPECT_EQ(applied.newRequests[0].first, 3);
+    ASSERT_EQ(follower.getStates().size(), 2);
+    EXPECT_EQ(follower.getStates().at(1).numGeneratedTokens, 1);
+    EXPECT_EQ(follower.getIteration(), leader.getIteration());
+}
+
+TEST(RequestStateReplicaTest, rejectsOutOfOrderDeltas)
+{
+    Replica leader;
+    Replica follower;
+    auto const first = leader.encodeDelta({{1, {1, 0}}});
+    auto const second = leader.encodeDelta({{1, {2, 0}}});
+    EXPECT_THROW(follower.applyDelta(second.data(), second.size()), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(follower.applyDelta(first.data(), first.size() - 1), tensorrt_llm::common::TllmException);
+}
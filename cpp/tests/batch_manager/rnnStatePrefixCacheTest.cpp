@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/rnnStatePrefixCache.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <numeric>
+#include <vector>
+
+using namespace tensorrt_llm::batch_manager::kv_cache_manager;
+
+namespace
+{
+//! Records the snapshots as the request they were taken from.
+struct FakeStateStore
+{
+    std::map<std::uint64_t, std::uint64_t> snapshots;
+    std::map<std::uint64_t, std::uint64_t> restoredFrom;
+
+    void saveSnapshot(std::uint64_t key, std::uint64_t requestId)
+    {
+        snapshots[key] = requestId;
+    }
+
+    bool restoreSnapshot(std::uint64_t key, std::uint64_t requestId)
+    {
+        auto const it = snapshots.find(key);
+        if (it == snapshots.end())
+        {
+            return false;
+        }
+        restoredFrom[requestId] = it->second;
+        return true;
+    }
+
+    bool hasSnapshot(std::uint64_t key) const
+    {
+        return snapshots.count(key) > 0;
+    }
+
+    bool dropSnapshot(std::uint64_t key)
+    {
+        return snapshots.erase(key) > 0;
+    }
+};
+
+using Cache = RnnStatePrefixCache<FakeStateStore>;
+
+std::vector<std::int32_t> makeTokens(std::int32_t numTokens, std::int32_t start = 0)
+{
+    std::vector<std::int32_t> tokens(numTokens);
+    std::iota(tokens.begin(), tokens.end(), start);
+    return tokens;
+}
+} // namespace
+
+TEST(RnnStatePrefixCacheTest, saveOnlyOnSnapshotBoundaries)
+{
+    FakeStateStore store;
+    Cache cache(store, 4, 2);
+    auto const tokens = makeTokens(20);
+    EXPECT_FALSE(cache.save(1, tokens.data(), 0));
+    EXPECT_FALSE(cache.save(1, tokens.data(), 4));
+    EXPECT_FALSE(cache.save(1, tokens.data(), 10));
+    EXPECT_TRUE(cache.save(1, tokens.data(), 8));
+    EXPECT_TRUE(cache.save(1, tokens.data(), 16));
+    EXPECT_EQ(store.snapshots.size(), 2);
+
+    // The key is the hash of the last block of the prefix.
+    auto const h0 = hashBlockTokens(kRootBlockHash, tokens.data(), 4);
+    EXPECT_TRUE(store.hasSnapshot(hashBlockTokens(h0, tokens.data() + 4, 4)));
+}
+
+TEST(RnnStatePrefixCacheTest, restoreLongestPrefix)
+{
+    FakeStateStore store;
+    Cache cache(store, 4);
+    auto const prompt = makeTokens(16);
+    EXPECT_EQ(cache.restore(1, prompt), 0);
+    cache.save(1, prompt.data(), 4);
+    cache.save(1, prompt.data(), 8);
+
+    auto longer = makeTokens(30);
+    EXPECT_EQ(cache.restore(2, longer), 8);
+    EXPECT_EQ(store.restoredFrom.at(2), 1);
+
+    // A different second block only shares the first snapshot.
+    longer[5] = -1;
+    EXPECT_EQ(cache.restore(3, longer), 4);
+
+    EXPECT_EQ(cache.getNumHits(), 2);
+    EXPECT_EQ(cache.getNumMisses(), 1);
+    EXPECT_EQ(cache.getNumReusedTokens(), 12);
+}
+
+TEST(RnnStatePrefixCacheTest, restoreKeepsLastToken)
+{
+    FakeStateStore store;
+    Cache cache(store, 4);
+    auto const prompt = makeTokens(8);
+    cache.save(1, prompt.data(), 4);
+    cache.save(1, prompt.data(), 8);
+    // The snapshot of the whole prompt can't be used, the last token has to be run.
+    EXPECT_EQ(cache.restore(2, prompt), 4);
+}
+
+TEST(RnnStatePrefixCacheTest, evictedBlockDropsSnapshot)
+{
+    FakeStateStore store;
+    Cache cache(store, 4);
+    auto const prompt = makeTokens(12);
+    cache.save(1, prompt.data(), 4);
+    cache.onBlockEvicted(hashBlockTokens(kRootBlockHash, prompt.data(), 4));
+    EXPECT_EQ(cache.restore(2, prompt), 0);
+}
+
+TEST(RnnStatePrefixCacheTest, contextChunkEndsOnBoundary)
+{
+    FakeStateStore store;
+    Cache cache(store, 4, 2);
+    // The whole prompt fits, the chunk stops at the last boundary before its end.
+    EXPECT_EQ(cache.getContextChunkEnd(0, 21, 64), 16);
+    EXPECT_EQ(cache.getContextChunkEnd(16, 21, 64), 21);
+    // A prompt ending on a boundary stops one boundary earlier, as its last token isn't reusable.
+    EXPECT_EQ(cache.getContextChunkEnd(0, 16, 64), 8);
+    // Limited by the chunk size.
+    EXPECT_EQ(cache.getContextChunkEnd(0, 100, 20), 16);
+    // No boundary in range.
+    EXPECT_EQ(cache.getContextChunkEnd(0, 100, 5), 5);
+    EXPECT_EQ(cache.getContextChunkEnd(0, 6, 64), 6);
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/sloAwareScheduler.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager;
+using Candidate = SloAwareScheduler::Candidate;
+using RequestIds = std::vector<SloAwareScheduler::RequestIdType>;
+
+TEST(SloAwareSchedulerTest, interactivePreemptsBatch)
+{
+    SloAwareScheduler scheduler{4, 10};
+    auto const now = SloAwareScheduler::Clock::now();
+    std::vector<Candidate> const candidates{
+        Candidate{1, 0, true, 4, std::nullopt},
+        Candidate{2, 0, true, 4, std::nullopt},
+        Candidate{3, 10, false, 5, now + std::chrono::milliseconds(200)},
+    };
+
+    auto const schedule = scheduler.schedule(candidates, now);
+    EXPECT_EQ(schedule.scheduled, (RequestIds{3, 1}));
+    EXPECT_EQ(schedule.preempted, (RequestIds{2}));
+    EXPECT_EQ(schedule.numDeadlineMisses, 0);
+}
+
+TEST(SloAwareSchedulerTest, earliestDeadlineFirst)
+{
+    SloAwareScheduler scheduler{2, 100};
+    auto const now = SloAwareScheduler::Clock::now();
+    std::vector<Candidate> const candidates{
+        Candidate{1, 0, false, 1, std::nullopt},
+        Candidate{2, 0, false, 1, now + std::chrono::milliseconds(50)},
+        Candidate{3, 0, false, 1, now - std::chrono::milliseconds(10)},
+    };
+
+    auto const schedule = scheduler.schedule(candidates, now);
+    EXPECT_EQ(schedule.scheduled, (RequestIds{3, 2}));
+    EXPECT_TRUE(schedule.preempted.empty());
+    EXPECT_EQ(schedule.numDeadlineMisses, 1);
+    EXPECT_EQ(scheduler.getStats().numDeadlineMisses, 1);
+    EXPECT_EQ(scheduler.getStats().numScheduled, 2);
+}
+
+TEST(SloAwareSchedulerTest, inProgressWinsTies)
+{
+    SloAwareScheduler scheduler{1, 100};
+    std::vector<Candidate> const candidates{
+        Candidate{1, 0, false, 1, std::nullopt},
+        Candidate{2, 0, true, 1, std::nullopt},
+    };
+
+    auto const schedule = scheduler.schedule(candidates);
+    EXPECT_EQ(schedule.scheduled, (RequestIds{2}));
+    EXPECT_TRUE(schedule.preempted.empty());
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/specDecodingStatsCollector.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager;
+using tensorrt_llm::runtime::SizeType32;
+
+TEST(SpecDecodingStatsCollectorTest, iterationAndRequestStats)
+{
+    SpecDecodingStatsCollector collector{4};
+
+    collector.recordStep(1, 4, 2);
+    collector.recordStep(2, 3, 3);
+    // Context phase without draft tokens
+    collector.recordStep(3, 0, 0);
+    collector.recordDraftTime(2.F);
+    collector.recordVerificationTime(5.F);
+
+    auto stats = collector.endIteration();
+    EXPECT_EQ(stats.numDraftTokens, 7);
+    EXPECT_EQ(stats.numAcceptedTokens, 5);
+    EXPECT_EQ(stats.numRequestsWithDraftTokens, 2);
+    EXPECT_EQ(stats.acceptanceLengthHistogram, (std::vector<SizeType32>{0, 0, 1, 1, 0}));
+    EXPECT_FLOAT_EQ(stats.getAcceptanceRate(), 5.F / 7.F);
+    EXPECT_FLOAT_EQ(stats.getAvgAcceptanceLength(), 2.5F);
+    EXPECT_FLOAT_EQ(stats.draftTimeMs, 2.F);
+    EXPECT_FLOAT_EQ(stats.verificationTimeMs, 5.F);
+    EXPECT_FALSE(collector.getRequestStats(3).has_value());
+
+    collector.recordStep(1, 4, 0);
+    collector.recordDraftTime(1.F);
+    stats = collector.endIteration();
+    EXPECT_EQ(stats.numDraftTokens, 4);
+    EXPECT_EQ(stats.numAcceptedTokens, 0);
+    EXPECT_EQ(stats.acceptanceLengthHistogram, (std::vector<SizeType32>{1, 0, 0, 0, 0}));
+    EXPECT_FLOAT_EQ(stats.verificationTimeMs, 0.F);
+
+    auto const requestStats = collector.getRequestStats(1);
+    ASSERT_TRUE(requestStats.has_value());
+    EXPECT_EQ(requestStats->numDraftTokens, 8);
+    EXPECT_EQ(requestStats->numAcceptedTokens, 2);
+    EXPECT_EQ(requestStats->numRequestsWithDraftTokens, 2);
+    EXPECT_EQ(requestStats->acceptanceLengthHistogram, (std::vector<SizeType32>{1, 0, 1, 0, 0}));
+    EXPECT_FLOAT_EQ(requestStats->draftTimeMs, 3.F);
+    EXPECT_FLOAT_EQ(requestStats->verificationTimeMs, 5.F);
+
+    collector.removeRequest(1);
+    EXPECT_FALSE(collector.getRequestStats(1).has_value());
+    EXPECT_TRUE(collector.getRequestStats(2).has_value());
+}
+
+TEST(SpecDecodingStatsCollectorTest, rejectsInvalidSteps)
+{
+    SpecDecodingStatsCollector collector{4};
+    EXPECT_THROW(collector.recordStep(1, 5, 0), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(collector.recordStep(1, 2, 3), tensorrt_llm::common::TllmException);
+}
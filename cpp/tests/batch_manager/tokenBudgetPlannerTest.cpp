@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/tokenBudgetPlanner.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::batch_manager;
+using ContextRequest = TokenBudgetPlanner::ContextRequest;
+
+TEST(TokenBudgetPlannerTest, decodeFirst)
+{
+    TokenBudgetPlanner const planner{512, 64};
+
+    // A long prompt only gets what the generation requests leave
+    auto plan = planner.plan(100, {ContextRequest{1, 10000}});
+    EXPECT_EQ(plan.numGenerationTokens, 100);
+    ASSERT_EQ(plan.contextChunks.size(), 1);
+    EXPECT_EQ(plan.contextChunks[0].requestId, 1);
+    EXPECT_EQ(plan.contextChunks[0].chunkSize, 384);
+    EXPECT_LE(plan.getNumTokens(), planner.getMaxNumTokensPerIteration());
+
+    // Heavier decode load, smaller chunk
+    plan = planner.plan(400, {ContextRequest{1, 10000}});
+    ASSERT_EQ(plan.contextChunks.size(), 1);
+    EXPECT_EQ(plan.contextChunks[0].chunkSize, 64);
+
+    // No room left for a full chunk unit
+    plan = planner.plan(500, {ContextRequest{1, 10000}});
+    EXPECT_TRUE(plan.contextChunks.empty());
+}
+
+TEST(TokenBudgetPlannerTest, lastChunkAndMultipleContexts)
+{
+    TokenBudgetPlanner const planner{512, 64};
+
+    auto const plan = planner.plan(10, {ContextRequest{1, 30}, ContextRequest{2, 0}, ContextRequest{3, 1000}});
+    ASSERT_EQ(plan.contextChunks.size(), 2);
+    EXPECT_EQ(plan.contextChunks[0].requestId, 1);
+    EXPECT_EQ(plan.contextChunks[0].chunkSize, 30);
+    EXPECT_EQ(plan.contextChunks[1].requestId, 3);
+    EXPECT_EQ(plan.contextChunks[1].chunkSize, 448);
+    EXPECT_EQ(plan.getNumTokens(), 488);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/asyncLogWriter.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tensorrt_llm::common;
+
+TEST(AsyncLogWriter, WritesInOrder)
+{
+    testing::internal::CaptureStdout();
+    {
+        AsyncLogWriter writer;
+        for (int i = 0; i < 100; ++i)
+        {
+            writer.write(std::to_string(i) + "\n", false);
+        }
+        writer.flush();
+    }
+    std::string expected;
+    for (int i = 0; i < 100; ++i)
+    {
+        expected += std::to_string(i) + "\n";
+    }
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), expected);
+}
+
+TEST(AsyncLogWriter, WritesSynchronouslyOnceStopped)
+{
+    testing::internal::CaptureStderr();
+    AsyncLogWriter writer;
+    writer.write("queued\n", true);
+    writer.stop();
+    writer.write("direct\n", true);
+    EXPECT_EQ(testing::internal::GetCapturedStderr(), "queued\ndirect\n");
+    EXPECT_EQ(writer.getNumDropped(), 0);
+}
+
+TEST(AsyncLogWriter, ManyWriters)
+{
+    constexpr int kNumThreads = 4;
+    constexpr int kNumRecords = 1000;
+    testing::internal::CaptureStdout();
+    AsyncLogWriter writer;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t)
+    {
+        threads.emplace_back(
+            [&writer]()
+            {
+                for (int i = 0; i < kNumRecords; ++i)
+                {
+                    writer.write("x\n", false);
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    writer.stop();
+    auto const output = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(output.size(), 2 * (kNumThreads * kNumRecords - writer.getNumDropped()));
+}
+
+TEST(LogRateLimiter, OneRecordPerPeriod)
+{
+    using Clock = LogRateLimiter::Clock;
+    LogRateLimiter limiter{std::chrono::milliseconds{100}};
+    auto const start = Clock::now();
+
+    EXPECT_EQ(limiter.tryAcquire(start), 0);
+    EXPECT_FALSE(limiter.tryAcquire(start + std::chrono::milliseconds{10}).has_value());
+    EXPECT_FALSE(limiter.tryAcquire(start + std::chrono::milliseconds{99}).has_value());
+    EXPECT_EQ(limiter.tryAcquire(start + std::chrono::milliseconds{100}), 2);
+    EXPECT_FALSE(limiter.tryAcquire(start + std::chrono::milliseconds{150}).has_value());
+    EXPECT_EQ(limiter.tryAcquire(start + std::chrono::milliseconds{300}), 1);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/cublasAlgoCache.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+using namespace tensorrt_llm::common;
+
+namespace
+{
+CublasAlgoKey makeKey(std::int32_t m)
+{
+    CublasAlgoKey key;
+    key.m = m;
+    key.n = 4096;
+    key.k = 4096;
+    key.lda = 4096;
+    key.ldb = 4096;
+    key.ldc = 4096;
+    return key;
+}
+
+cublasLtMatmulAlgo_t makeAlgo(std::uint8_t value)
+{
+    cublasLtMatmulAlgo_t algo;
+    std::memset(&algo, value, sizeof(algo));
+    return algo;
+}
+
+bool isSameAlgo(cublasLtMatmulAlgo_t const& lhs, cublasLtMatmulAlgo_t const& rhs)
+{
+    return std::memcmp(&lhs, &rhs, sizeof(cublasLtMatmulAlgo_t)) == 0;
+}
+} // namespace
+
+TEST(CublasAlgoCacheTest, findAndInsert)
+{
+    CublasAlgoCache cache{90, 1};
+    EXPECT_FALSE(cache.find(makeKey(16)));
+
+    cache.insert(makeKey(16), makeAlgo(1));
+    cache.insert(makeKey(32), std::nullopt);
+    EXPECT_EQ(cache.size(), 2U);
+
+    auto const found = cache.find(makeKey(16));
+    ASSERT_TRUE(found);
+    ASSERT_TRUE(found->has_value());
+    EXPECT_TRUE(isSameAlgo(found->value(), makeAlgo(1)));
+
+    // Resolved to the default of cuBLASLt, which is a hit too
+    auto const resolvedToDefault = cache.find(makeKey(32));
+    ASSERT_TRUE(resolvedToDefault);
+    EXPECT_FALSE(resolvedToDefault->has_value());
+
+    // The first entry of a key wins
+    cache.insert(makeKey(16), makeAlgo(2));
+    EXPECT_TRUE(isSameAlgo(cache.find(makeKey(16))->value(), makeAlgo(1)));
+
+    // The requested algo is part of the key
+    auto withRequestedAlgo = makeKey(16);
+    withRequestedAlgo.requestedAlgoHash = 1;
+    EXPECT_FALSE(cache.find(withRequestedAlgo));
+}
+
+TEST(CublasAlgoCacheTest, serialize)
+{
+    CublasAlgoCache cache{90, 1};
+    cache.insert(makeKey(16), makeAlgo(1));
+    cache.insert(makeKey(32), std::nullopt);
+    auto const data = cache.serialize();
+
+    CublasAlgoCache restarted{90, 1};
+    ASSERT_TRUE(restarted.deserialize(data.data(), data.size()));
+    EXPECT_EQ(restarted.size(), 2U);
+    ASSERT_TRUE(restarted.find(makeKey(16)));
+    EXPECT_TRUE(isSameAlgo(restarted.find(makeKey(16))->value(), makeAlgo(1)));
+    EXPECT_FALSE(restarted.find(makeKey(32))->has_value());
+
+    // Algos resolved on another GPU or by another cuBLASLt are not reused
+    CublasAlgoCache otherSm{80, 1};
+    EXPECT_FALSE(otherSm.deserialize(data.data(), data.size()));
+    EXPECT_EQ(otherSm.size(), 0U);
+    CublasAlgoCache otherCublasLt{90, 2};
+    EXPECT_FALSE(otherCublasLt.deserialize(data.data(), data.size()));
+
+    EXPECT_FALSE(restarted.deserialize(data.data(), data.size() - 1));
+}
@@ -16,6 +16,7 @@
 
 #include <gtest/gtest.h>
 
+#include "tensorrt_llm/common/mpiBroadcastChannel.h"
 #include "tensorrt_llm/common/mpiUtils.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 
@@ -25,6 +26,7 @@
 #endif // ENABLE_MULTI_DEVICE
 
 #include <algorithm>
+#include <numeric>
 
 namespace mpi = tensorrt_llm::mpi;
 namespace tr = tensorrt_llm::runtime;
@@ -230,6 +232,40 @@ TEST(MPIUtils, SessionCommunicator)
     EXPECT_EQ(session.getSize(), 1);
 }
 
+TEST(MPIUtils, BroadcastChannel)
+{
+    auto& comm = mpi::MpiComm::world();
+    auto constexpr root = 0;
+    // Messages below, at and above the inline size of the blocks
+    std::vector<std::size_t> const sizes{0, 10, 56, 57, 1000, 3, 5000};
+    auto const expected = [](std::size_t size, std::size_t index)
+    {
+        std::vector<char> message(size);
+        std::iota(message.begin(), message.end(), static_cast<char>(index));
+        return message;
+    };
+
+    mpi::MpiBroadcastChannel channel{comm, root, 64};
+    if (comm.getRank() == root)
+    {
+        for (std::size_t i = 0; i < sizes.size(); ++i)
+        {
+            channel.send(expected(sizes[i], i));
+        }
+        channel.close();
+    }
+    else
+    {
+        for (std::size_t i = 0; i < sizes.size(); ++i)
+        {
+            auto const message = channel.receive();
+            ASSERT_TRUE(message.has_value());
+            EXPECT_EQ(*message, expected(sizes[i], i));
+        }
+        EXPECT_FALSE(channel.receive().has_value());
+    }
+}
+
 TEST(MPIUtils, VectorBcastEmpty)
 {
     auto& session = mpi::MpiComm::session();
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/mpscQueue.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using tensorrt_llm::common::MpscQueue;
+
+TEST(MpscQueue, PushPop)
+{
+    MpscQueue<int> queue;
+    EXPECT_FALSE(queue.tryPop().has_value());
+    for (int i = 0; i < 3; ++i)
+    {
+        queue.push(i);
+    }
+    EXPECT_EQ(queue.size(), 3);
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(queue.tryPop(), i);
+    }
+    EXPECT_FALSE(queue.tryPop().has_value());
+    EXPECT_EQ(queue.size(), 0);
+}
+
+TEST(MpscQueue, MoveOnly)
+{
+    MpscQueue<std::unique_ptr<int>> queue;
+    queue.push(std::make_unique<int>(42));
+    queue.push(std::make_unique<int>(43));
+    auto popped = queue.tryPop();
+    ASSERT_TRUE(popped.has_value());
+    EXPECT_EQ(**popped, 42);
+    // The remaining item is freed with the queue
+}
+
+TEST(MpscQueue, ProducersConsumer)
+{
+    constexpr int kNumProducers = 4;
+    constexpr int kNumItems = 50000;
+    MpscQueue<std::pair<int, int>> queue;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kNumProducers; ++p)
+    {
+        producers.emplace_back(
+            [&queue, p]()
+            {
+                for (int i = 0; i < kNumItems; ++i)
+                {
+                    queue.push(std::make_pair(p, i));
+                }
+            });
+    }
+
+    // Items of a producer come out in the order it pushed them
+    std::vector<int> expected(kNumProducers, 0);
+    int numPopped = 0;
+    while (numPopped < kNumProducers * kNumItems)
+    {
+        if (auto item = queue.tryPop())
+        {
+            auto const [p, i] = *item;
+            ASSERT_EQ(i, expected[p]);
+            ++expected[p];
+            ++numPopped;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    EXPECT_FALSE(queue.tryPop().has_value());
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/objectPool.h"
+
+#include <thread>
+#include <vector>
+
+using tensorrt_llm::common::ObjectPool;
+
+TEST(ObjectPool, ReusesReleasedObjects)
+{
+    ObjectPool<std::vector<int>> pool{2};
+    EXPECT_EQ(pool.getNumFree(), 2);
+    int* data{nullptr};
+    {
+        auto object = pool.acquire();
+        EXPECT_EQ(pool.getNumFree(), 1);
+        object->resize(100);
+        data = object->data();
+    }
+    EXPECT_EQ(pool.getNumFree(), 2);
+    auto first = pool.acquire();
+    EXPECT_EQ(first->data(), data);
+    EXPECT_EQ(pool.getNumReused(), 2);
+    EXPECT_EQ(pool.getNumCreated(), 0);
+}
+
+TEST(ObjectPool, ResetKeepsCapacity)
+{
+    ObjectPool<std::vector<int>> pool{1, [](std::vector<int>& object) { object.clear(); }};
+    {
+        auto object = pool.acquire();
+        object->assign(64, 1);
+    }
+    auto object = pool.acquire();
+    EXPECT_TRUE(object->empty());
+    EXPECT_GE(object->capacity(), 64);
+}
+
+TEST(ObjectPool, GrowsPastCapacity)
+{
+    ObjectPool<int> pool{1};
+    {
+        auto first = pool.acquire();
+        auto second = pool.acquire();
+        auto third = pool.acquire();
+        EXPECT_EQ(pool.getNumFree(), 0);
+        EXPECT_EQ(pool.getNumCreated(), 2);
+    }
+    // Only capacity objects are kept, the others are destroyed
+    EXPECT_EQ(pool.getNumFree(), 1);
+}
+
+TEST(ObjectPool, ConcurrentAcquireRelease)
+{
+    constexpr int kNumThreads = 4;
+    constexpr int kNumIterations = 10000;
+    ObjectPool<std::vector<int>> pool{kNumThreads, [](std::vector<int>& object) { object.clear(); }};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t)
+    {
+        threads.emplace_back(
+            [&pool, t]()
+            {
+                for (int i = 0; i < kNumIterations; ++i)
+                {
+                    auto object = pool.acquire();
+                    EXPECT_TRUE(object->empty());
+                    object->push_back(t);
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(pool.getNumFree(), kNumThreads);
+    EXPECT_EQ(pool.getNumReused() + pool.getNumCreated(), kNumThreads * kNumIterations);
+}
@@ -35,6 +35,12 @@ TEST(Quantization, Constructor)
     static_assert(QuantMode::int8KvCache().hasInt8KvCache());
     static_assert(QuantMode::fp8KvCache().hasFp8KvCache());
     static_assert(QuantMode::fp8Qdq().hasFp8Qdq());
+    static_assert(QuantMode::int4KvCache().hasInt4KvCache());
+    static_assert(QuantMode::int4KvCache().hasKvCacheQuant());
+    static_assert(QuantMode::mxfp4Weights().hasMxfp4Weights());
+    static_assert(QuantMode::nvfp4Weights().hasNvfp4Weights());
+    static_assert(QuantMode::nvfp4Weights().hasFp4Weights());
+    static_assert(!QuantMode::nvfp4Weights().hasInt4Weights());
 }
 
 TEST(Quantization, PlusMinus)
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/shmMessageChannel.h"
+#include "tensorrt_llm/common/tllmException.h"
+
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using tensorrt_llm::common::ShmMessageChannel;
+
+namespace
+{
+std::string getChannelName(std::string const& test)
+{
+    return "tllm_" + test + "_" + std::to_string(getpid());
+}
+
+// A batch of strings, each prefixed by its length
+std::size_t batchSize(std::vector<std::string> const& batch)
+{
+    std::size_t size{sizeof(std::uint32_t)};
+    for (auto const& item : batch)
+    {
+        size += sizeof(std::uint32_t) + item.size();
+    }
+    return size;
+}
+
+void writeBatch(std::ostream& os, std::vector<std::string> const& batch)
+{
+    auto const count = static_cast<std::uint32_t>(batch.size());
+    os.write(reinterpret_cast<char const*>(&count), sizeof(count));
+    for (auto const& item : batch)
+    {
+        auto const length = static_cast<std::uint32_t>(item.size());
+        os.write(reinterpret_cast<char const*>(&length), sizeof(length));
+        os.write(item.data(), length);
+    }
+}
+
+std::vector<std::string> readBatch(std::istream& is)
+{
+    std::uint32_t count{0};
+    is.read(reinterpret_cast<char*>(&count), sizeof(count));
+    std::vector<std::string> batch(count);
+    for (auto& item : batch)
+    {
+        std::uint32_t length{0};
+        is.read(reinterpret_cast<char*>(&length), sizeof(length));
+        item.resize(length);
+        is.read(item.data(), length);
+    }
+    return batch;
+}
+} // namespace
+
+TEST(ShmMessageChannel, BatchedMessages)
+{
+    auto const name = getChannelName("batched");
+    auto producer = ShmMessageChannel::create(name, 256);
+    auto consumer = ShmMessageChannel::open(name);
+    EXPECT_EQ(producer.getMaxMessageSize(), 120);
+
+    std::vector<std::string> const batch{"request 1", "request 22", ""};
+    EXPECT_FALSE(consumer.tryRead([](std::istream&) { FAIL(); }));
+    EXPECT_TRUE(producer.tryWrite(batchSize(batch), [&](std::ostream& os) { writeBatch(os, batch); }));
+    EXPECT_TRUE(consumer.tryRead([&](std::istream& is) { EXPECT_EQ(readBatch(is), batch); }));
+    EXPECT_FALSE(consumer.tryRead([](std::istream&) { FAIL(); }));
+
+    // The message must be exactly as large as announced
+    EXPECT_THROW((void) producer.tryWrite(batchSize(batch) + 1, [&](std::ostream& os) { writeBatch(os, batch); }),
+        tensorrt_llm::common::TllmException);
+    EXPECT_THROW((void) producer.tryWrite(producer.getMaxMessageSize() + 1, [](std::ostream&) {}),
+        tensorrt_llm::common::TllmException);
+}
+
+TEST(ShmMessageChannel, FullAndWrapAround)
+{
+    auto const name = getChannelName("wrap");
+    auto producer = ShmMessageChannel::create(name, 256);
+    auto consumer = ShmMessageChannel::open(name);
+
+    std::string const payload(100, 'x');
+    auto const write = [&](char c)
+    {
+        return producer.tryWrite(payload.size(), [&](std::ostream& os) { os << std::string(payload.size(), c); });
+    };
+    auto const read = [&](char c)
+    {
+        return consumer.tryRead([&](std::istream& is)
+            { EXPECT_EQ(std::string(std::istreambuf_iterator<char>(is), {}), std::string(payload.size(), c)); });
+    };
+
+    // Two frames of 112 bytes fill the ring
+    EXPECT_TRUE(write('a'));
+    EXPECT_TRUE(write('b'));
+    EXPECT_FALSE(write('c'));
+    EXPECT_TRUE(read('a'));
+    // The third frame doesn't fit before the end of the ring and starts over at the beginning
+    EXPECT_TRUE(write('c'));
+    EXPECT_TRUE(read('b'));
+    EXPECT_TRUE(read('c'));
+    EXPECT_FALSE(read('d'));
+}
+
+TEST(ShmMessageChannel, ProducerConsumerThreads)
+{
+    auto const name = getChannelName("threads");
+    auto producer = ShmMessageChannel::create(name, 1024);
+    auto consumer = ShmMessageChannel::open(name);
+    constexpr int kNumMessages = 10000;
+
+    std::thread producerThread(
+        [&]()
+        {
+            for (int i = 0; i < kNumMessages; ++i)
+            {
+                std::vector<std::string> const batch(i % 5, std::to_string(i));
+                while (!producer.tryWrite(batchSize(batch), [&](std::ostream& os) { writeBatch(os, batch); }))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+    for (int i = 0; i < kNumMessages; ++i)
+    {
+        std::vector<std::string> received;
+        while (!consumer.tryRead([&](std::istream& is) { received = readBatch(is); }))
+        {
+            std::this_thread::yield();
+        }
+        ASSERT_EQ(received, std::vector<std::string>(i % 5, std::to_string(i)));
+    }
+    producerThread.join();
+}
+
+TEST(ShmMessageChannel, OpenMissingChannel)
+{
+    EXPECT_THROW(ShmMessageChannel::open(getChannelName("missing")), tensorrt_llm::common::TllmException);
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/spscRingBuffer.h"
+
+#include <memory>
+#include <thread>
+
+using tensorrt_llm::common::SpscRingBuffer;
+
+TEST(SpscRingBuffer, PushPop)
+{
+    SpscRingBuffer<int> ring{3};
+    EXPECT_EQ(ring.capacity(), 4);
+    EXPECT_TRUE(ring.empty());
+    EXPECT_FALSE(ring.tryPop().has_value());
+
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(ring.tryPush(i));
+    }
+    EXPECT_FALSE(ring.tryPush(4));
+    EXPECT_EQ(ring.size(), 4);
+
+    EXPECT_EQ(ring.tryPop(), 0);
+    EXPECT_TRUE(ring.tryPush(4));
+    for (int i = 1; i < 5; ++i)
+    {
+        EXPECT_EQ(ring.tryPop(), i);
+    }
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRingBuffer, MoveOnly)
+{
+    SpscRingBuffer<std::unique_ptr<int>> ring{2};
+    auto item = std::make_unique<int>(42);
+    EXPECT_TRUE(ring.tryPush(std::move(item)));
+    auto popped = ring.tryPop();
+    ASSERT_TRUE(popped.has_value());
+    EXPECT_EQ(**popped, 42);
+}
+
+TEST(SpscRingBuffer, ProducerConsumer)
+{
+    constexpr int kNumItems = 100000;
+    SpscRingBuffer<int> ring{64};
+
+    std::thread producer(
+        [&ring]()
+        {
+            for (int i = 0; i < kNumItems; ++i)
+            {
+                while (!ring.tryPush(i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+    int expected = 0;
+    while (expected < kNumItems)
+    {
+        if (auto item = ring.tryPop())
+        {
+            ASSERT_EQ(*item, expected);
+            ++expected;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}
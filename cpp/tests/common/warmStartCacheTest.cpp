@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/warmStartCache.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+
+using namespace tensorrt_llm::common;
+namespace fs = std::filesystem;
+
+class WarmStartCacheTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        mCacheDir = fs::temp_directory_path() / ("warmStartCacheTest" + std::to_string(::getpid()));
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(mCacheDir);
+    }
+
+    fs::path mCacheDir;
+};
+
+TEST_F(WarmStartCacheTest, storeAndLoad)
+{
+    WarmStartCache cache{mCacheDir};
+    ASSERT_TRUE(cache.isEnabled());
+    EXPECT_FALSE(cache.load("entry"));
+
+    std::string const value{"cubin"};
+    cache.setEngineHash(1);
+    cache.store("entry", value.data(), value.size());
+    auto const loaded = cache.load("entry");
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(std::string(loaded->begin(), loaded->end()), value);
+
+    // Entries of another engine are separate
+    cache.setEngineHash(2);
+    EXPECT_FALSE(cache.load("entry"));
+
+    // A restarted process finds the entry
+    WarmStartCache restarted{mCacheDir};
+    restarted.setEngineHash(1);
+    EXPECT_TRUE(restarted.load("entry"));
+}
+
+TEST_F(WarmStartCacheTest, disabled)
+{
+    WarmStartCache cache{std::nullopt};
+    EXPECT_FALSE(cache.isEnabled());
+    std::string const value{"cubin"};
+    cache.store("entry", value.data(), value.size());
+    EXPECT_FALSE(cache.load("entry"));
+}
+
+TEST(WarmStartCacheHashTest, chained)
+{
+    std::string const data{"engine"};
+    auto const hash = WarmStartCache::hash(data.data(), data.size());
+    EXPECT_EQ(hash, WarmStartCache::hash(data.data(), data.size()));
+    EXPECT_EQ(WarmStartCache::hash(data.data() + 3, 3, WarmStartCache::hash(data.data(), 3)), hash);
+    EXPECT_NE(WarmStartCache::hash(data.data(), 5), hash);
+}
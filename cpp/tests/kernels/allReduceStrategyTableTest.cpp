@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/kernels/customAllReduceKernels.h"
+#include "tensorrt_llm/common/tllmException.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::kernels;
+
+TEST(AllReduceStrategyTableTest, lookupCrossover)
+{
+    // No table measured for these ranks, the plugin keeps its fixed thresholds.
+    EXPECT_FALSE(lookupAllReduceStrategy(3, 1024).has_value());
+
+    setAllReduceStrategyTable(3,
+        {{64 * 1024, AllReduceStrategyType::ONESHOT}, {1024 * 1024, AllReduceStrategyType::TWOSHOT},
+            {4 * 1024 * 1024, AllReduceStrategyType::NCCL}});
+    EXPECT_EQ(lookupAllReduceStrategy(3, 1), AllReduceStrategyType::ONESHOT);
+    EXPECT_EQ(lookupAllReduceStrategy(3, 64 * 1024), AllReduceStrategyType::ONESHOT);
+    EXPECT_EQ(lookupAllReduceStrategy(3, 64 * 1024 + 1), AllReduceStrategyType::TWOSHOT);
+    EXPECT_EQ(lookupAllReduceStrategy(3, 2 * 1024 * 1024), AllReduceStrategyType::NCCL);
+    // Beyond the measured sizes.
+    EXPECT_FALSE(lookupAllReduceStrategy(3, 8 * 1024 * 1024).has_value());
+    // Tables are per number of ranks.
+    EXPECT_FALSE(lookupAllReduceStrategy(5, 1024).has_value());
+}
+
+TEST(AllReduceStrategyTableTest, rejectsUnsortedTable)
+{
+    EXPECT_THROW(setAllReduceStrategyTable(
+                     7, {{1024 * 1024, AllReduceStrategyType::TWOSHOT}, {1024, AllReduceStrategyType::ONESHOT}}),
+        tensorrt_llm::common::TllmException);
+}
+
+TEST(AllReduceStrategyTableTest, deserializeNodeBuffers)
+{
+    // Four buffers of 4 TP ranks over two nodes, the 2 ranks of this node come first.
+    std::vector<int64_t> ptrs(4 * 4, 0);
+    for (size_t i = 0; i < ptrs.size(); ++i)
+    {
+        ptrs[i] = (i % 4 < 2) ? static_cast<int64_t>(0x1000 * (i + 1)) : 0;
+    }
+    auto const* buffer = reinterpret_cast<int32_t const*>(ptrs.data());
+
+    auto params = AllReduceParams::deserializeNode(buffer, 4, 2, 1, 3);
+    EXPECT_EQ(params.ranks_per_node, 2);
+    EXPECT_EQ(params.local_rank, 1);
+    // Odd flags use the pong buffers.
+    EXPECT_EQ(params.peer_comm_buffer_ptrs[0], reinterpret_cast<void*>(ptrs[4]));
+    EXPECT_EQ(params.peer_comm_buffer_ptrs[1], reinterpret_cast<void*>(ptrs[5]));
+    EXPECT_EQ(params.peer_barrier_ptrs_in[1], reinterpret_cast<uint32_t*>(ptrs[9]));
+    EXPECT_EQ(params.peer_barrier_ptrs_out[0], reinterpret_cast<uint32_t*>(ptrs[12]));
+
+    // The hierarchical all reduce splits a message between the ranks of the node.
+    EXPECT_TRUE(configurationSupported(AllReduceStrategyType::HIERARCHICAL, 2 * 8, 2, nvinfer1::DataType::kHALF));
+    EXPECT_FALSE(configurationSupported(AllReduceStrategyType::HIERARCHICAL, 8, 2, nvinfer1::DataType::kHALF));
+}
+
+TEST(AllReduceStrategyTableTest, nvlsBuffers)
+{
+    // The NVLS strategy is unavailable until the runtime sets up the multicast buffers.
+    EXPECT_FALSE(getNvlsBuffers(6).has_value());
+
+    int unicast{0};
+    int multicast{0};
+    setNvlsBuffers(6, NvlsBuffers{&unicast, &multicast, 1024});
+    auto const buffers = getNvlsBuffers(6);
+    ASSERT_TRUE(buffers.has_value());
+    EXPECT_EQ(buffers->unicast_ptr, &unicast);
+    EXPECT_EQ(buffers->multicast_ptr, &multicast);
+    EXPECT_EQ(buffers->size_bytes, std::size_t{1024});
+    // Buffers are per number of ranks.
+    EXPECT_FALSE(getNvlsBuffers(8).has_value());
+
+    setNvlsBuffers(6, std::nullopt);
+    EXPECT_FALSE(getNvlsBuffers(6).has_value());
+
+    // The NVLS all reduce splits a message between the ranks like the two shot one.
+    EXPECT_TRUE(configurationSupported(AllReduceStrategyType::NVLS, 6 * 8, 6, nvinfer1::DataType::kHALF));
+    EXPECT_FALSE(configurationSupported(AllReduceStrategyType::NVLS, 8, 6, nvinfer1::DataType::kHALF));
+}
+
+TEST(AllReduceStrategyTableTest, gatherScatterStrategy)
+{
+    auto constexpr kHALF = nvinfer1::DataType::kHALF;
+    EXPECT_EQ(
+        selectGatherScatterStrategy(AllReduceStrategyType::NCCL, 4 * 1024, 4, kHALF), AllReduceStrategyType::NCCL);
+    // The automatic selection keeps the one shot kernels to the messages bound by latency.
+    EXPECT_EQ(selectGatherScatterStrategy(AllReduceStrategyType::AUTO, 4 * 1024, 4, kHALF),
+        AllReduceStrategyType::ONESHOT);
+    EXPECT_EQ(selectGatherScatterStrategy(AllReduceStrategyType::AUTO, 1024 * 1024, 4, kHALF),
+        AllReduceStrategyType::NCCL);
+    // An explicit one shot strategy is bound by the workspace only.
+    EXPECT_EQ(selectGatherScatterStrategy(AllReduceStrategyType::ONESHOT, 1024 * 1024, 4, kHALF),
+        AllReduceStrategyType::ONESHOT);
+    EXPECT_EQ(selectGatherScatterStrategy(AllReduceStrategyType::ONESHOT, 8 * 1024 * 1024, 4, kHALF),
+        AllReduceStrategyType::NCCL);
+    // The parts of the ranks must be aligned, and the kernels exist for 2, 4, 6 and 8 ranks.
+    EXPECT_EQ(selectGatherScatterStrategy(AllReduceStrategyType::AUTO, 4 * 1024 + 4, 4, kHALF),
+        AllReduceStrategyType::NCCL);
+    EXPECT_EQ(selectGatherScatterStrategy(AllReduceStrategyType::AUTO, 3 * 1024, 3, kHALF),
+        AllReduceStrategyType::NCCL);
+}
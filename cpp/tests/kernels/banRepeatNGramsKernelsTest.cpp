@@ -184,6 +184,48 @@ public:
         verifyBanRepeatNGramResults(nGramSizes, expectedLastId);
     }
 
+    void runBanRepeatNGramIncrementalTest(std::vector<std::vector<SizeType32>> const& outputIds,
+        std::vector<SizeType32> const& nGramSizes, std::vector<SizeType32> const& expectedLastId)
+    {
+        SizeType32 const batchSize = expectedLastId.size();
+        initData(outputIds, nGramSizes);
+
+        auto ngramTables = mBufferManager->gpu(
+            ITensor::makeShape({2 * batchSize, tk::getRepeatNgramTableSize(mMaxSeqLen)}), nvinfer1::DataType::kINT32);
+        tk::invokeResetRepeatNgramTables(
+            bufferCast<int32_t>(*ngramTables), mMaxSeqLen, nullptr, 2 * batchSize, mStream->get());
+
+        // Grow the sequences token by token, so that the tables are built incrementally up to the last step
+        auto scratchLogits
+            = mBufferManager->gpu(ITensor::makeShape({batchSize, mVocabSizePadded}), nvinfer1::DataType::kFLOAT);
+        auto finalSequenceLengths = mBufferManager->copyFrom(*mSequenceLengths, MemoryType::kCPU);
+        auto sequenceLengthsPtr = bufferCast<SizeType32>(*mSequenceLengths);
+        auto batchSlotsPtr = bufferCast<int32_t>(*mBatchSlots);
+        auto finalSequenceLengthsPtr = bufferCast<SizeType32>(*finalSequenceLengths);
+        SizeType32 maxSequenceLength = 0;
+        for (SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            maxSequenceLength = std::max(maxSequenceLength, finalSequenceLengthsPtr[batchSlotsPtr[bi]]);
+        }
+        for (SizeType32 step = 1; step <= maxSequenceLength; ++step)
+        {
+            for (SizeType32 bi = 0; bi < batchSize; ++bi)
+            {
+                auto const batchSlot = batchSlotsPtr[bi];
+                sequenceLengthsPtr[batchSlot] = std::min(step, finalSequenceLengthsPtr[batchSlot]);
+            }
+            auto* logits = bufferCast<float>(step == maxSequenceLength ? *mLogits : *scratchLogits);
+            tk::invokeBanRepeatNgramIncremental(logits, bufferCast<int32_t>(*ngramTables), mMaxSeqLen,
+                reinterpret_cast<int32_t const**>(bufferCast<int64_t>(*mOutputIdsPtr)),
+                reinterpret_cast<tk::FinishedState*>(bufferCast<tk::FinishedState::UnderlyingType>(*mFinished)),
+                bufferCast<int32_t>(*mBatchSlots), sequenceLengthsPtr, batchSize, bufferCast<int32_t>(*mNGramSizes),
+                mVocabSizePadded, mStream->get());
+            mStream->synchronize();
+        }
+
+        verifyBanRepeatNGramResults(nGramSizes, expectedLastId);
+    }
+
 protected:
     std::shared_ptr<tensorrt_llm::runtime::BufferManager> mBufferManager;
     std::shared_ptr<tensorrt_llm::runtime::CudaStream> mStream;
@@ -232,4 +274,17 @@ TEST_F(BanRepeatNgramKernelsTest, noRepeatNGramsBS2BW1Test)
     }
 }
 
+TEST_F(BanRepeatNgramKernelsTest, noRepeatNGramsIncrementalBS2BW1Test)
+{
+    std::vector<std::vector<std::vector<SizeType32>>> outputIds = {{{1, 2, 3, 4, 5, 6, 2, 3}, {1, 2, 3, 4, 5, 6, 2, 3}},
+        {{1, 2, 3, 6, 2, 3}, {1, 3, 3, 4, 5, 6, 2, 3}}, {{1, 2, 3, 2, 3}, {1, 2, 3, 4, 5, 6, 2, 3}}};
+    std::vector<std::vector<SizeType32>> nGramSizes = {{2, 3}, {2, 2}, {3, 2}};
+    // Positive value shows expected id of the last token. Negative value shows not-expected id of the last token
+    std::vector<std::vector<SizeType32>> expectedOutputIds = {{-3, 3}, {-3, 3}, {3, -3}};
+    for (SizeType32 ti = 0; ti < nGramSizes.size(); ++ti)
+    {
+        this->runBanRepeatNGramIncrementalTest(outputIds[ti], nGramSizes[ti], expectedOutputIds[ti]);
+    }
+}
+
 } // end of namespace
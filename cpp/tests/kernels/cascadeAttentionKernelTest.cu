@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/cascadeAttentionKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+using namespace tensorrt_llm::kernels;
+
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+
+class CascadeAttentionKernelTest : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP();
+        }
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    // Requests of a group share the first prefixBlocks blocks of their K and V caches, followed by private blocks.
+    void runTest(std::vector<int> const& groupSizes, std::vector<int> const& prefixLengths,
+        std::vector<int> const& seqLengths, int numHeads, int numKvHeads, int headSize)
+    {
+        int constexpr tokensPerBlock = 16;
+        int const numQueries = static_cast<int>(seqLengths.size());
+        int const numGroups = static_cast<int>(groupSizes.size());
+        int const maxSeqLen = *std::max_element(seqLengths.begin(), seqLengths.end());
+        int const maxBlocksPerSeq = tc::divUp(maxSeqLen, tokensPerBlock);
+        int const blockSize = numKvHeads * tokensPerBlock * headSize;
+
+        std::vector<int> groupOffsets{0};
+        std::vector<int> queryPrefixLengths;
+        for (int g = 0; g < numGroups; ++g)
+        {
+            groupOffsets.push_back(groupOffsets.back() + groupSizes[g]);
+            queryPrefixLengths.insert(queryPrefixLengths.end(), groupSizes[g], prefixLengths[g]);
+        }
+
+        // Assign the blocks, the prefix blocks of a group are those of its first request.
+        std::vector<KVCacheIndex::UnderlyingType> blockOffsets(numQueries * 2 * maxBlocksPerSeq, 0);
+        int numBlocks = 0;
+        for (int g = 0; g < numGroups; ++g)
+        {
+            int const prefixBlocks = prefixLengths[g] / tokensPerBlock;
+            for (int q = groupOffsets[g]; q < groupOffsets[g + 1]; ++q)
+            {
+                for (int kv = 0; kv < 2; ++kv)
+                {
+                    for (int b = 0; b < tc::divUp(seqLengths[q], tokensPerBlock); ++b)
+                    {
+                        auto& offset = blockOffsets[(q * 2 + kv) * maxBlocksPerSeq + b];
+                        offset = (b < prefixBlocks && q > groupOffsets[g])
+                            ? blockOffsets[(groupOffsets[g] * 2 + kv) * maxBlocksPerSeq + b]
+                            : numBlocks++;
+                    }
+                }
+            }
+        }
+
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        std::vector<float> pool(static_cast<size_t>(numBlocks) * blockSize);
+        std::vector<float> q(static_cast<size_t>(numQueries) * numHeads * headSize);
+        for (auto& v : pool)
+        {
+            v = dist(gen);
+        }
+        for (auto& v : q)
+        {
+            v = dist(gen);
+        }
+
+        auto poolDevice = mBufferManager->copyFrom(pool, MemoryType::kGPU);
+        auto blockOffsetsDevice = mBufferManager->copyFrom(blockOffsets, MemoryType::kGPU);
+        auto qDevice = mBufferManager->copyFrom(q, MemoryType::kGPU);
+        auto groupOffsetsDevice = mBufferManager->copyFrom(groupOffsets, MemoryType::kGPU);
+        auto prefixLengthsDevice = mBufferManager->copyFrom(queryPrefixLengths, MemoryType::kGPU);
+        auto seqLengthsDevice = mBufferManager->copyFrom(seqLengths, MemoryType::kGPU);
+        auto outDevice = mBufferManager->gpu(q.size(), nvinfer1::DataType::kFLOAT);
+        auto workspace = mBufferManager->gpu(
+            getCascadeAttentionWorkspaceSize(numQueries, numHeads, headSize), nvinfer1::DataType::kINT8);
+
+        float const qkScale = 1.f / std::sqrt(static_cast<float>(headSize));
+        CascadeAttentionParams<float> params;
+        params.q = bufferCast<float>(*qDevice);
+        params.out = bufferCast<float>(*outDevice);
+        params.kv_cache = KVBlockArray(numQueries, maxBlocksPerSeq, tokensPerBlock,
+            numKvHeads * headSize * sizeof(float), maxSeqLen, 0, bufferCast<float>(*poolDevice), nullptr,
+            reinterpret_cast<KVBlockArray::DataType*>(bufferCast<KVCacheIndex::UnderlyingType>(*blockOffsetsDevice)));
+        params.group_offsets = bufferCast<int>(*groupOffsetsDevice);
+        params.prefix_lengths = bufferCast<int>(*prefixLengthsDevice);
+        params.seq_lengths = bufferCast<int>(*seqLengthsDevice);
+        params.workspace = workspace->data();
+        params.num_queries = numQueries;
+        params.num_groups = numGroups;
+        params.max_group_size = *std::max_element(groupSizes.begin(), groupSizes.end());
+        params.num_heads = numHeads;
+        params.num_kv_heads = numKvHeads;
+        params.head_size = headSize;
+        params.qk_scale = qkScale;
+        invokeCascadeAttention(params, mStream->get());
+
+        std::vector<float> out(q.size());
+        mBufferManager->copy(*outDevice, out.data());
+        mStream->synchronize();
+
+        auto const kvValue = [&](int query, int kv, int token, int kvHead, int d)
+        {
+            auto const block = blockOffsets[(query * 2 + kv) * maxBlocksPerSeq + token / tokensPerBlock];
+            return pool[static_cast<size_t>(block) * blockSize + (kvHead * tokensPerBlock + token % tokensPerBlock)
+                    * headSize
+                + d];
+        };
+        for (int query = 0; query < numQueries; ++query)
+        {
+            for (int head = 0; head < numHeads; ++head)
+            {
+                int const kvHead = head / (numHeads / numKvHeads);
+                float const* qRow = q.data() + (static_cast<size_t>(query) * numHeads + head) * headSize;
+                std::vector<float> scores(seqLengths[query]);
+                float maxScore = -INFINITY;
+                for (int t = 0; t < seqLengths[query]; ++t)
+                {
+                    float s = 0.f;
+                    for (int d = 0; d < headSize; ++d)
+                    {
+                        s += qRow[d] * kvValue(query, 0, t, kvHead, d);
+                    }
+                    scores[t] = s * qkScale;
+                    maxScore = std::max(maxScore, scores[t]);
+                }
+                float sum = 0.f;
+                for (auto& s : scores)
+                {
+                    s = std::exp(s - maxScore);
+                    sum += s;
+                }
+                for (int d = 0; d < headSize; ++d)
+                {
+                    float ref = 0.f;
+                    for (int t = 0; t < seqLengths[query]; ++t)
+                    {
+                        ref += scores[t] * kvValue(query, 1, t, kvHead, d);
+                    }
+                    ref /= sum;
+                    EXPECT_NEAR(out[(static_cast<size_t>(query) * numHeads + head) * headSize + d], ref, 1e-4f)
+                        << "query " << query << " head " << head << " dim " << d;
+                }
+            }
+        }
+    }
+
+protected:
+    std::shared_ptr<BufferManager> mBufferManager;
+    std::shared_ptr<CudaStream> mStream;
+};
+
+} // namespace
+
+TEST_F(CascadeAttentionKernelTest, sharedPrefixMha)
+{
+    // One group of 5 requests sharing 4 blocks, and a request without shared prefix.
+    runTest({5, 1}, {64, 0}, {65, 70, 93, 64 + 40, 66, 37}, 8, 8, 64);
+}
+
+TEST_F(CascadeAttentionKernelTest, sharedPrefixGqa)
+{
+    runTest({3, 2}, {32, 48}, {40, 33, 51, 49, 80}, 8, 2, 128);
+}
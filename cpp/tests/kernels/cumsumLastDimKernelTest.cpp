@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/cumsumLastDim.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <cmath>
+#include <cuda_fp16.h>
+#include <random>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+template <typename T>
+class CumsumLastDimKernelTest : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    //! \brief Scan [batchSize, inputLength] random values in {-1, 0, 1} on the device and compare each row with its
+    //! prefix sum on the host.
+    void runTest(SizeType32 batchSize, SizeType32 inputLength, bool withWorkspace = true)
+    {
+        auto constexpr dataType = TRTDataType<T>::value;
+        auto const shape = ITensor::makeShape({batchSize, inputLength});
+        auto input = mBufferManager->pinned(shape, dataType);
+        auto* inputPtr = bufferCast<T>(*input);
+
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> valueDistr(-1, 1);
+        std::vector<float> expected(batchSize * inputLength);
+        for (SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            float sum = 0.f;
+            for (SizeType32 ii = 0; ii < inputLength; ++ii)
+            {
+                auto value = valueDistr(generator);
+                // Bounded sums are exact in half precision too
+                if (std::abs(sum + value) > 64.f)
+                {
+                    value = -value;
+                }
+                inputPtr[bi * inputLength + ii] = static_cast<T>(value);
+                sum += static_cast<float>(value);
+                expected[bi * inputLength + ii] = sum;
+            }
+        }
+
+        auto inputDevice = mBufferManager->copyFrom(*input, MemoryType::kGPU);
+        auto outputDevice = mBufferManager->gpu(shape, dataType);
+        auto const workspaceBytes = withWorkspace ? tk::getCumsumLastDimWorkspaceSize(batchSize, inputLength) : 0;
+        auto workspace = mBufferManager->gpu(workspaceBytes);
+        // Leftovers of a previous launch must not leak into the next one
+        for (auto launch = 0; launch < 2; ++launch)
+        {
+            mBufferManager->setZero(*outputDevice);
+            tk::invokeCumsumLastDim<T>(batchSize, inputLength, inputDevice->data(), outputDevice->data(),
+                withWorkspace ? workspace->data() : nullptr, workspaceBytes, mStream->get());
+            sync_check_cuda_error();
+
+            auto output = mBufferManager->copyFrom(*outputDevice, MemoryType::kCPU);
+            mStream->synchronize();
+            auto const* outputPtr = bufferCast<T>(*output);
+            for (SizeType32 bi = 0; bi < batchSize; ++bi)
+            {
+                for (SizeType32 ii = 0; ii < inputLength; ++ii)
+                {
+                    auto const idx = bi * inputLength + ii;
+                    ASSERT_EQ(static_cast<float>(outputPtr[idx]), expected[idx])
+                        << "batch " << bi << " position " << ii << " launch " << launch;
+                }
+            }
+        }
+    }
+
+protected:
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+typedef testing::Types<int, float, half> CumsumTypes;
+
+TYPED_TEST_SUITE(CumsumLastDimKernelTest, CumsumTypes);
+
+} // namespace
+
+TYPED_TEST(CumsumLastDimKernelTest, ShortRows)
+{
+    // Scanned by a warp per row, including a partial block of rows
+    this->runTest(1, 7);
+    this->runTest(13, 100);
+    this->runTest(64, 256);
+}
+
+TYPED_TEST(CumsumLastDimKernelTest, MediumRows)
+{
+    // Scanned by a block per row, the rows fit in one tile of the single-pass scan
+    this->runTest(3, 257);
+    this->runTest(5, 2048);
+}
+
+TYPED_TEST(CumsumLastDimKernelTest, LongRows)
+{
+    // Small batches use the single-pass scan with decoupled look-back, over many tiles and a partial last tile
+    this->runTest(1, 2049);
+    this->runTest(2, 100000);
+    this->runTest(3, 300001);
+    // Without workspace, and with more rows than SMs, every row is scanned by a block
+    this->runTest(2, 100000, false);
+    this->runTest(tc::getMultiProcessorCount() + 1, 5000);
+}
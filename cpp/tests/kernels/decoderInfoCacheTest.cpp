@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/plugins/gptAttentionCommon/decoderInfoCache.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+using namespace tensorrt_llm::plugins;
+namespace tk = tensorrt_llm::kernels;
+using tensorrt_llm::runtime::CudaStream;
+
+namespace
+{
+
+class DecoderInfoCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        TLLM_CUDA_CHECK(cudaMalloc(&mLengths, sizeof(int) * kMaxBatchSize));
+    }
+
+    void TearDown() override
+    {
+        mStream.synchronize();
+        TLLM_CUDA_CHECK(cudaFree(mLengths));
+    }
+
+    void setLengths(std::vector<int> const& lengths, int offset = 0)
+    {
+        TLLM_CUDA_CHECK(cudaMemcpyAsync(
+            mLengths + offset, lengths.data(), sizeof(int) * lengths.size(), cudaMemcpyHostToDevice, mStream.get()));
+        mStream.synchronize();
+    }
+
+    //! The cache keys on the length buffers and shapes, each test uses its own batch sizes to not see the entries of
+    //! the others.
+    tk::BuildDecoderInfoParams<half> makeParams(int batchSize, int offset = 0) const
+    {
+        tk::BuildDecoderInfoParams<half> params;
+        std::memset(&params, 0, sizeof(params));
+        params.seqQLengths = mLengths + offset;
+        params.seqKVLengths = mLengths + offset;
+        params.batchSize = batchSize;
+        params.maxQSeqLength = 64;
+        params.removePadding = true;
+        params.numTokens = 64 * batchSize;
+        params.rotaryScalingType = tk::RotaryScalingType::kNONE;
+        return params;
+    }
+
+    std::vector<int> readOffsets(DecoderInfoCache::Buffers const& buffers, int batchSize)
+    {
+        std::vector<int> offsets(batchSize + 1);
+        TLLM_CUDA_CHECK(cudaMemcpyAsync(offsets.data(), buffers.seqQOffsets, sizeof(int) * offsets.size(),
+            cudaMemcpyDeviceToHost, mStream.get()));
+        mStream.synchronize();
+        return offsets;
+    }
+
+    static std::vector<int> prefixSum(std::vector<int> const& lengths)
+    {
+        std::vector<int> offsets(lengths.size() + 1, 0);
+        std::partial_sum(lengths.begin(), lengths.end(), offsets.begin() + 1);
+        return offsets;
+    }
+
+    static constexpr int kMaxBatchSize = 256;
+
+    CudaStream mStream;
+    int* mLengths{nullptr};
+};
+
+} // namespace
+
+TEST_F(DecoderInfoCacheTest, sharesInfoWithinPass)
+{
+    auto& cache = DecoderInfoCache::getInstance();
+    auto const params = makeParams(3);
+
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        std::vector<int> const lengths{3 + pass, 5, 2 * pass + 1};
+        setLengths(lengths);
+        auto const first = cache.get(params, 0, mStream.get());
+        ASSERT_TRUE(first.has_value());
+        EXPECT_EQ(readOffsets(*first, 3), prefixSum(lengths));
+
+        // The following layers of the pass reuse the info, they don't rebuild it from the changed lengths.
+        setLengths({1, 1, 1});
+        for (int layerIdx = 1; layerIdx < 4; ++layerIdx)
+        {
+            auto const next = cache.get(params, layerIdx, mStream.get());
+            ASSERT_TRUE(next.has_value());
+            EXPECT_EQ(next->seqQOffsets, first->seqQOffsets);
+            EXPECT_EQ(readOffsets(*next, 3), prefixSum(lengths));
+        }
+    }
+
+    // The build resets the tile counters of all layers.
+    auto const buffers = cache.get(params, 0, mStream.get());
+    ASSERT_TRUE(buffers.has_value());
+    TLLM_CUDA_CHECK(cudaMemsetAsync(buffers->fmhaTileCounter, 0xff, sizeof(uint32_t) * 4, mStream.get()));
+    auto const rebuilt = cache.get(params, 0, mStream.get());
+    ASSERT_TRUE(rebuilt.has_value());
+    std::vector<uint32_t> counters(4);
+    TLLM_CUDA_CHECK(cudaMemcpyAsync(counters.data(), rebuilt->fmhaTileCounter, sizeof(uint32_t) * counters.size(),
+        cudaMemcpyDeviceToHost, mStream.get()));
+    mStream.synchronize();
+    EXPECT_EQ(counters, std::vector<uint32_t>(4, 0));
+}
+
+TEST_F(DecoderInfoCacheTest, pipelineLayerRange)
+{
+    auto& cache = DecoderInfoCache::getInstance();
+    auto const params = makeParams(5);
+
+    // A pipeline stage owns layers 16-23, each pass starts again at its first layer.
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        std::vector<int> const lengths{1, 2 + pass, 3, 4, 5 * pass + 1};
+        setLengths(lengths);
+        for (int layerIdx = 16; layerIdx < 24; ++layerIdx)
+        {
+            auto const buffers = cache.get(params, layerIdx, mStream.get());
+            ASSERT_TRUE(buffers.has_value());
+            EXPECT_EQ(readOffsets(*buffers, 5), prefixSum(lengths)) << pass << " " << layerIdx;
+            setLengths({7, 7, 7, 7, 7});
+        }
+    }
+
+    // Layers beyond the tile counters don't use the cache.
+    EXPECT_FALSE(cache.get(params, DecoderInfoCache::kMaxNumLayers, mStream.get()).has_value());
+    EXPECT_FALSE(cache.get(params, -1, mStream.get()).has_value());
+}
+
+TEST_F(DecoderInfoCacheTest, growsBuffers)
+{
+    auto& cache = DecoderInfoCache::getInstance();
+
+    // More length buffers than entries, with growing batch sizes: the least recently used entries are reused for
+    // larger batches.
+    for (int i = 0; i < 12; ++i)
+    {
+        int const batchSize = 7 + 16 * i;
+        std::vector<int> lengths(batchSize);
+        std::iota(lengths.begin(), lengths.end(), i);
+        setLengths(lengths, i);
+        auto const params = makeParams(batchSize, i);
+        for (int layerIdx = 0; layerIdx < 2; ++layerIdx)
+        {
+            auto const buffers = cache.get(params, layerIdx, mStream.get());
+            ASSERT_TRUE(buffers.has_value());
+            EXPECT_EQ(readOffsets(*buffers, batchSize), prefixSum(lengths)) << batchSize;
+        }
+    }
+}
+
+TEST_F(DecoderInfoCacheTest, bypassedDuringCapture)
+{
+    auto& cache = DecoderInfoCache::getInstance();
+    auto const params = makeParams(11);
+    std::vector<int> const lengths(11, 4);
+    setLengths(lengths);
+    ASSERT_TRUE(cache.get(params, 0, mStream.get()).has_value());
+
+    // Neither the buffers of the current pass nor new ones are handed to a graph.
+    TLLM_CUDA_CHECK(cudaStreamBeginCapture(mStream.get(), cudaStreamCaptureModeThreadLocal));
+    auto const captured = cache.get(params, 1, mStream.get());
+    auto const capturedNewPass = cache.get(params, 0, mStream.get());
+    cudaGraph_t graph;
+    TLLM_CUDA_CHECK(cudaStreamEndCapture(mStream.get(), &graph));
+    TLLM_CUDA_CHECK(cudaGraphDestroy(graph));
+    EXPECT_FALSE(captured.has_value());
+    EXPECT_FALSE(capturedNewPass.has_value());
+
+    // The pass in progress is unaffected.
+    auto const next = cache.get(params, 2, mStream.get());
+    ASSERT_TRUE(next.has_value());
+    EXPECT_EQ(readOffsets(*next, 11), prefixSum(lengths));
+}
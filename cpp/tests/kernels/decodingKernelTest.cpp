@@ -21,12 +21,14 @@
 
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/speculativeDecoding/common.h"
 #include "tensorrt_llm/kernels/speculativeDecoding/externalDraftTokensKernels.h"
 #include "tensorrt_llm/kernels/speculativeDecoding/medusaDecodingKernels.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
 #include <curand_kernel.h>
 #include <random>
+#include <set>
 #include <unordered_set>
 
 namespace tk = tensorrt_llm::kernels;
@@ -1093,4 +1095,156 @@ TYPED_TEST(DecodingKernelsTest, DISABLED_acceptDraftTokensByIdsWithPathsKernelLa
                       .setMaxNumHeads(7)
                       .setAcceptMode(AcceptKernelMode::BY_IDS_WITH_PATH));
 }
+
+TEST(DraftAcceptanceTest, adaptsDraftLengthToAcceptanceRate)
+{
+    SizeType32 constexpr batchSize{3};
+    SizeType32 constexpr maxBatchSize{2 * batchSize};
+    SizeType32 constexpr maxDraftLen{8};
+    SizeType32 constexpr numSteps{50};
+
+    auto stream = std::make_shared<CudaStream>();
+    auto acceptedLengths = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    auto acceptanceRates = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kFLOAT);
+    auto nextNumDraftTokens = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    auto batchSlots = BufferManager::pinned(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+
+    // Requests accepting all, none and 2 of 8 draft tokens per step, the target model adds one token to each
+    std::vector<SizeType32> const requestAcceptedLengths{maxDraftLen + 1, 1, 3};
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const slot = 2 * bi + 1;
+        bufferCast<SizeType32>(*batchSlots)[bi] = slot;
+        bufferCast<SizeType32>(*acceptedLengths)[slot] = requestAcceptedLengths[bi];
+        bufferCast<float>(*acceptanceRates)[slot] = 1.f;
+    }
+
+    tksp::DraftAcceptanceParams params;
+    params.acceptedLengths = bufferCast<SizeType32>(*acceptedLengths);
+    params.acceptanceRates = bufferCast<float>(*acceptanceRates);
+    params.nextNumDraftTokens = bufferCast<SizeType32>(*nextNumDraftTokens);
+    params.batchSlots = bufferCast<SizeType32>(*batchSlots);
+    params.batchSize = batchSize;
+    params.maxDraftLen = maxDraftLen;
+    for (SizeType32 step = 0; step < numSteps; ++step)
+    {
+        tksp::invokeUpdateDraftAcceptance(params, stream->get());
+    }
+    stream->synchronize();
+
+    auto const rates = bufferCast<float>(*acceptanceRates);
+    auto const nextLens = bufferCast<SizeType32>(*nextNumDraftTokens);
+    EXPECT_FLOAT_EQ(rates[1], 1.f);
+    EXPECT_EQ(nextLens[1], maxDraftLen);
+    EXPECT_LT(rates[3], 0.01f);
+    EXPECT_EQ(nextLens[3], 1);
+    // The rate converges to 2 / 3, 2 draft tokens are expected to waste 0.9 tokens and 3 draft tokens 1.6 tokens
+    EXPECT_NEAR(rates[5], 2.f / 3.f, 0.01f);
+    EXPECT_EQ(nextLens[5], 2);
+}
+
+TEST(MedusaTreePruningTest, prunesTreePerRequest)
+{
+    SizeType32 constexpr batchSize{2};
+    SizeType32 constexpr maxBatchSize{2 * batchSize};
+    SizeType32 constexpr maxDecodingTokens{8};
+    SizeType32 constexpr maxDraftPathLen{2};
+    SizeType32 constexpr pathWidth{maxDraftPathLen + 1};
+
+    auto stream = std::make_shared<CudaStream>();
+    auto const makeBuffer = [](std::initializer_list<SizeType32> dims, nvinfer1::DataType type)
+    { return BufferManager::pinned(ITensor::makeShape(dims), type); };
+    auto treeParents = makeBuffer({maxBatchSize, maxDecodingTokens}, nvinfer1::DataType::kINT32);
+    auto nodeProbs = makeBuffer({batchSize, maxDecodingTokens}, nvinfer1::DataType::kFLOAT);
+    auto treeDraftIds = makeBuffer({maxBatchSize, maxDecodingTokens - 1}, nvinfer1::DataType::kINT32);
+    auto maxNumNodes = makeBuffer({maxBatchSize}, nvinfer1::DataType::kINT32);
+    auto minPathProbs = makeBuffer({maxBatchSize}, nvinfer1::DataType::kFLOAT);
+    auto prunedDraftIds = makeBuffer({maxBatchSize, maxDecodingTokens - 1}, nvinfer1::DataType::kINT32);
+    auto prunedNodeIds = makeBuffer({maxBatchSize, maxDecodingTokens}, nvinfer1::DataType::kINT32);
+    auto generationLengths = makeBuffer({maxBatchSize}, nvinfer1::DataType::kINT32);
+    auto positionOffsets = makeBuffer({maxBatchSize, maxDecodingTokens}, nvinfer1::DataType::kINT32);
+    auto packedMasks = makeBuffer({maxBatchSize, maxDecodingTokens, 1}, nvinfer1::DataType::kINT32);
+    auto paths = makeBuffer({maxBatchSize, maxDecodingTokens, pathWidth}, nvinfer1::DataType::kINT32);
+    auto batchSlots = makeBuffer({batchSize}, nvinfer1::DataType::kINT32);
+
+    // Full tree of both requests: root 0, nodes 1 and 2 at depth 1, nodes 3 and 4 under 1 and node 5 under 2
+    std::vector<SizeType32> const parents{-1, 0, 0, 1, 1, 2, -1, -1};
+    // The first request is confident in the path 0-1-3 and is pruned to 4 nodes,
+    // the second one is uncertain and only keeps the paths more probable than 0.2
+    std::vector<std::vector<float>> const probs{
+        {0.f, 0.9f, 0.1f, 0.8f, 0.1f, 0.9f, 0.f, 0.f}, {0.f, 0.5f, 0.4f, 0.3f, 0.3f, 0.9f, 0.f, 0.f}};
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const slot = 2 * bi + 1;
+        bufferCast<SizeType32>(*batchSlots)[bi] = slot;
+        for (SizeType32 ni = 0; ni < maxDecodingTokens; ++ni)
+        {
+            bufferCast<SizeType32>(*treeParents)[slot * maxDecodingTokens + ni] = parents[ni];
+            bufferCast<float>(*nodeProbs)[bi * maxDecodingTokens + ni] = probs[bi][ni];
+            if (ni > 0)
+            {
+                bufferCast<SizeType32>(*treeDraftIds)[slot * (maxDecodingTokens - 1) + ni - 1] = 100 + ni;
+            }
+        }
+    }
+    bufferCast<SizeType32>(*maxNumNodes)[1] = 4;
+    bufferCast<float>(*minPathProbs)[1] = 0.f;
+    bufferCast<SizeType32>(*maxNumNodes)[3] = maxDecodingTokens;
+    bufferCast<float>(*minPathProbs)[3] = 0.2f;
+
+    tksp::MedusaTreePruningParams params;
+    params.treeParents = bufferCast<SizeType32>(*treeParents);
+    params.nodeProbs = bufferCast<float>(*nodeProbs);
+    params.treeDraftIds = bufferCast<SizeType32>(*treeDraftIds);
+    params.maxNumNodes = bufferCast<SizeType32>(*maxNumNodes);
+    params.minPathProbs = bufferCast<float>(*minPathProbs);
+    params.prunedDraftIds = bufferCast<SizeType32>(*prunedDraftIds);
+    params.prunedNodeIds = bufferCast<SizeType32>(*prunedNodeIds);
+    params.generationLengths = bufferCast<SizeType32>(*generationLengths);
+    params.positionOffsets = bufferCast<SizeType32>(*positionOffsets);
+    params.packedMasks = bufferCast<SizeType32>(*packedMasks);
+    params.paths = bufferCast<SizeType32>(*paths);
+    params.batchSlots = bufferCast<SizeType32>(*batchSlots);
+    params.batchSize = batchSize;
+    params.maxDecodingTokens = maxDecodingTokens;
+    params.maxDraftPathLen = maxDraftPathLen;
+    params.numPackedMasks = 1;
+    tksp::invokePruneMedusaTree(params, stream->get());
+    stream->synchronize();
+
+    std::vector<std::vector<SizeType32>> const expectedNodeIds{{0, 1, 2, 3}, {0, 1, 2, 5}};
+    std::vector<std::vector<SizeType32>> const expectedMasks{{0b1, 0b11, 0b101, 0b1011}, {0b1, 0b11, 0b101, 0b1101}};
+    std::vector<std::set<std::vector<SizeType32>>> const expectedPaths{
+        {{0, 2, -1}, {0, 1, 3}}, {{0, 1, -1}, {0, 2, 3}}};
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const slot = 2 * bi + 1;
+        ASSERT_EQ(bufferCast<SizeType32>(*generationLengths)[slot], 4) << "request " << bi;
+        std::set<std::vector<SizeType32>> requestPaths;
+        for (SizeType32 ni = 0; ni < maxDecodingTokens; ++ni)
+        {
+            auto const idx = slot * maxDecodingTokens + ni;
+            auto const pathPtr = bufferCast<SizeType32>(*paths) + idx * pathWidth;
+            if (pathPtr[0] != -1)
+            {
+                requestPaths.emplace(pathPtr, pathPtr + pathWidth);
+            }
+            if (ni >= 4)
+            {
+                EXPECT_EQ(bufferCast<SizeType32>(*prunedNodeIds)[idx], -1);
+                continue;
+            }
+            auto const nodeId = expectedNodeIds[bi][ni];
+            EXPECT_EQ(bufferCast<SizeType32>(*prunedNodeIds)[idx], nodeId);
+            EXPECT_EQ(bufferCast<SizeType32>(*positionOffsets)[idx], ni == 0 ? 0 : (ni < 3 ? 1 : 2));
+            EXPECT_EQ(bufferCast<SizeType32>(*packedMasks)[idx], expectedMasks[bi][ni]) << "request " << bi;
+            if (ni > 0)
+            {
+                EXPECT_EQ(bufferCast<SizeType32>(*prunedDraftIds)[slot * (maxDecodingTokens - 1) + ni - 1],
+                    100 + nodeId);
+            }
+        }
+        EXPECT_EQ(requestPaths, expectedPaths[bi]) << "request " << bi;
+    }
+}
 } // end of namespace
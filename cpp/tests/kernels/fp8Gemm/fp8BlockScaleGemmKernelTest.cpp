@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef ENABLE_FP8
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/fp8BlockScaleGemm.h"
+#include "tensorrt_llm/kernels/quantization.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+using namespace tensorrt_llm::kernels;
+using namespace tensorrt_llm::kernels::fp8_block_scale_gemm;
+
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+
+class Fp8BlockScaleGemmKernelTest : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP();
+        }
+        mArch = tc::getSMVersion();
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    // Quantizes random activations and weights, and checks the GEMM against the product of the dequantized values.
+    void runTest(int m, int n, int k)
+    {
+        if (m > kMaxGemvM && mArch < 89)
+        {
+            GTEST_SKIP() << "The tensor core kernel needs SM89";
+        }
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        std::vector<float> act(static_cast<size_t>(m) * k);
+        std::vector<float> weight(static_cast<size_t>(n) * k);
+        for (auto& v : act)
+        {
+            v = dist(gen);
+        }
+        // Weight blocks of very different ranges, so that wrong block scales show
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = 0; j < k; ++j)
+            {
+                float const range = 1 + (i / kBlockScaleSize + j / kBlockScaleSize) % 4;
+                weight[static_cast<size_t>(i) * k + j] = dist(gen) * range;
+            }
+        }
+        int const kBlocks = k / kBlockScaleSize;
+        int const nBlocks = tc::divUp(n, kBlockScaleSize);
+
+        auto actDevice = mBufferManager->copyFrom(act, MemoryType::kGPU);
+        auto weightDevice = mBufferManager->copyFrom(weight, MemoryType::kGPU);
+        auto actQuant = mBufferManager->gpu(act.size(), nvinfer1::DataType::kFP8);
+        auto weightQuant = mBufferManager->gpu(weight.size(), nvinfer1::DataType::kFP8);
+        auto actScales = mBufferManager->gpu(m * kBlocks, nvinfer1::DataType::kFLOAT);
+        auto weightScales = mBufferManager->gpu(nBlocks * kBlocks, nvinfer1::DataType::kFLOAT);
+        auto output = mBufferManager->gpu(static_cast<size_t>(m) * n, nvinfer1::DataType::kFLOAT);
+
+        invokeFp8PerTokenGroupQuantization(bufferCast<__nv_fp8_e4m3>(*actQuant), bufferCast<float>(*actDevice), m, k,
+            bufferCast<float>(*actScales), kBlockScaleSize, mStream->get());
+        invokeFp8BlockQuantization(bufferCast<__nv_fp8_e4m3>(*weightQuant), bufferCast<float>(*weightDevice), n, k,
+            bufferCast<float>(*weightScales), kBlockScaleSize, mStream->get());
+
+        Params params{actQuant->data(), bufferCast<float>(*actScales), weightQuant->data(),
+            bufferCast<float>(*weightScales), output->data(), m, n, k};
+        fp8BlockScaleGemmLauncher<float>(params, mArch, mStream->get());
+
+        std::vector<__nv_fp8_e4m3> actQ(act.size());
+        std::vector<__nv_fp8_e4m3> weightQ(weight.size());
+        std::vector<float> actS(m * kBlocks);
+        std::vector<float> weightS(nBlocks * kBlocks);
+        std::vector<float> out(static_cast<size_t>(m) * n);
+        mBufferManager->copy(*actQuant, actQ.data());
+        mBufferManager->copy(*weightQuant, weightQ.data());
+        mBufferManager->copy(*actScales, actS.data());
+        mBufferManager->copy(*weightScales, weightS.data());
+        mBufferManager->copy(*output, out.data());
+        mStream->synchronize();
+
+        for (int i = 0; i < m; ++i)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                double ref = 0;
+                double refAbs = 0;
+                for (int l = 0; l < k; ++l)
+                {
+                    double const a = static_cast<float>(actQ[static_cast<size_t>(i) * k + l])
+                        * actS[i * kBlocks + l / kBlockScaleSize];
+                    double const w = static_cast<float>(weightQ[static_cast<size_t>(j) * k + l])
+                        * weightS[(j / kBlockScaleSize) * kBlocks + l / kBlockScaleSize];
+                    ref += a * w;
+                    refAbs += std::abs(a * w);
+                }
+                // The quantization itself stays close to the unquantized product
+                double unquantized = 0;
+                for (int l = 0; l < k; ++l)
+                {
+                    unquantized += act[static_cast<size_t>(i) * k + l] * weight[static_cast<size_t>(j) * k + l];
+                }
+                ASSERT_NEAR(out[static_cast<size_t>(i) * n + j], ref, 1e-4 * refAbs + 1e-4) << "m " << i << " n " << j;
+                ASSERT_NEAR(ref, unquantized, 0.1 * refAbs) << "m " << i << " n " << j;
+            }
+        }
+    }
+
+protected:
+    int mArch{0};
+    std::shared_ptr<BufferManager> mBufferManager;
+    std::shared_ptr<CudaStream> mStream;
+};
+
+} // namespace
+
+TEST_F(Fp8BlockScaleGemmKernelTest, gemv)
+{
+    for (int m = 1; m <= kMaxGemvM; ++m)
+    {
+        runTest(m, 384, 1024);
+    }
+}
+
+TEST_F(Fp8BlockScaleGemmKernelTest, gemm)
+{
+    runTest(64, 256, 512);
+    // Partial tiles in M and N
+    runTest(77, 200, 384);
+}
+
+#endif
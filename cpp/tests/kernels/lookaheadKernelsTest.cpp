@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/speculativeDecoding/lookaheadKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tests/layers/randomLlm.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace tensorrt_llm::tests::kernels
+{
+using namespace tensorrt_llm::runtime;
+using namespace tensorrt_llm::tests::layers;
+namespace tksd = tensorrt_llm::kernels::speculative_decoding;
+
+namespace
+{
+
+TensorPtr pinned(std::initializer_list<ITensor::DimType64> dims, nvinfer1::DataType type)
+{
+    auto tensor = BufferManager::pinned(ITensor::makeShape(dims), type);
+    std::memset(tensor->data(), 0, tensor->getSizeInBytes());
+    return tensor;
+}
+
+struct RequestConfig
+{
+    SizeType32 w;
+    SizeType32 n;
+    SizeType32 g;
+    SizeType32 promptLen;
+    SizeType32 batchSlot;
+};
+
+} // namespace
+
+//! Runs the lookahead of several requests with different w, n and g in different batch slots through the kernels
+//! against the same random LLM as LookaheadAlgorithmTest. Every step must accept a prefix of the oracle.
+TEST(LookaheadKernelsTest, predictBatched)
+{
+    SizeType32 constexpr maxW{5};
+    SizeType32 constexpr maxN{5};
+    SizeType32 constexpr maxG{5};
+    SizeType32 constexpr maxBatchSize{8};
+    SizeType32 constexpr numPoolBuckets{256};
+    auto const maxDraftLen = tksd::getLookaheadMaxDraftLen(maxW, maxN, maxG);
+
+    std::vector<RequestConfig> const requests{{5, 5, 5, 20, 1}, {3, 3, 2, 15, 3}, {4, 4, 3, 25, 6}, {2, 5, 4, 30, 7}};
+    auto const batchSize = static_cast<SizeType32>(requests.size());
+
+    auto ascii = std::make_shared<AsciiRandomTokenLogits>();
+    std::string oracle(
+        "The following example uses the following lambda-expression to increment all of the elements of a vector and "
+        "then uses an overloaded operator() in a function object (a.k.a., \"functor\") to compute their sum. Note that "
+        "to compute the sum, it is recommended to use the dedicated algorithm std::accumulate.&");
+    LookaheadRandomLlm llm(ascii, oracle);
+    auto const oracleLen = static_cast<SizeType32>(oracle.size());
+
+    auto stream = std::make_shared<CudaStream>();
+    auto constexpr kINT32 = nvinfer1::DataType::kINT32;
+
+    auto poolKeys = pinned({maxBatchSize, numPoolBuckets}, kINT32);
+    auto poolSizes = pinned({maxBatchSize, numPoolBuckets}, kINT32);
+    auto poolNgrams = pinned({maxBatchSize, numPoolBuckets, maxG, maxN - 1}, kINT32);
+    auto prefills = pinned({maxBatchSize, maxN - 2}, kINT32);
+    auto pastTokens = pinned({maxBatchSize, maxW, maxN - 1}, kINT32);
+    auto goldenTokens = pinned({maxBatchSize, 2 * maxN - 1}, kINT32);
+    auto guessTokens = pinned({maxBatchSize, maxG, maxN - 1}, kINT32);
+    auto guessSizes = pinned({maxBatchSize}, kINT32);
+    auto fillings = pinned({maxBatchSize}, kINT32);
+    auto windowSizes = pinned({maxBatchSize}, kINT32);
+    auto ngramSizes = pinned({maxBatchSize}, kINT32);
+    auto guessSetSizes = pinned({maxBatchSize}, kINT32);
+
+    tksd::LookaheadDecodingState state;
+    state.poolKeys = bufferCast<TokenIdType>(*poolKeys);
+    state.poolSizes = bufferCast<SizeType32>(*poolSizes);
+    state.poolNgrams = bufferCast<TokenIdType>(*poolNgrams);
+    state.prefills = bufferCast<TokenIdType>(*prefills);
+    state.pastTokens = bufferCast<TokenIdType>(*pastTokens);
+    state.goldenTokens = bufferCast<TokenIdType>(*goldenTokens);
+    state.guessTokens = bufferCast<TokenIdType>(*guessTokens);
+    state.guessSizes = bufferCast<SizeType32>(*guessSizes);
+    state.fillings = bufferCast<SizeType32>(*fillings);
+    state.windowSizes = bufferCast<SizeType32>(*windowSizes);
+    state.ngramSizes = bufferCast<SizeType32>(*ngramSizes);
+    state.guessSetSizes = bufferCast<SizeType32>(*guessSetSizes);
+    state.numPoolBuckets = numPoolBuckets;
+    state.maxW = maxW;
+    state.maxN = maxN;
+    state.maxG = maxG;
+
+    // Each sequence holds the prompt and the first token generated by the context phase
+    std::vector<std::vector<TokenIdType>> sequences(batchSize);
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        sequences[bi].assign(oracle.begin(), oracle.begin() + requests[bi].promptLen + 1);
+    }
+
+    auto const maxPromptLen = oracleLen;
+    auto prompts = pinned({batchSize, maxPromptLen}, kINT32);
+    auto promptLengths = pinned({batchSize}, kINT32);
+    auto setupW = pinned({batchSize}, kINT32);
+    auto setupN = pinned({batchSize}, kINT32);
+    auto setupG = pinned({batchSize}, kINT32);
+    auto randomSeeds = pinned({batchSize}, nvinfer1::DataType::kINT64);
+    auto batchSlots = pinned({batchSize}, kINT32);
+    auto endIds = pinned({maxBatchSize}, kINT32);
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const& sequence = sequences[bi];
+        std::copy(sequence.begin(), sequence.end(), bufferCast<TokenIdType>(*prompts) + bi * maxPromptLen);
+        bufferCast<SizeType32>(*promptLengths)[bi] = static_cast<SizeType32>(sequence.size());
+        bufferCast<SizeType32>(*setupW)[bi] = requests[bi].w;
+        bufferCast<SizeType32>(*setupN)[bi] = requests[bi].n;
+        bufferCast<SizeType32>(*setupG)[bi] = requests[bi].g;
+        bufferCast<int64_t>(*randomSeeds)[bi] = 42 + bi;
+        bufferCast<SizeType32>(*batchSlots)[bi] = requests[bi].batchSlot;
+        bufferCast<TokenIdType>(*endIds)[requests[bi].batchSlot] = ascii->getEndToken();
+    }
+
+    tksd::LookaheadSetupParams setupParams;
+    setupParams.prompts = bufferCast<TokenIdType>(*prompts);
+    setupParams.promptLengths = bufferCast<SizeType32>(*promptLengths);
+    setupParams.windowSizes = bufferCast<SizeType32>(*setupW);
+    setupParams.ngramSizes = bufferCast<SizeType32>(*setupN);
+    setupParams.guessSetSizes = bufferCast<SizeType32>(*setupG);
+    setupParams.randomSeeds = reinterpret_cast<uint64_t const*>(bufferCast<int64_t>(*randomSeeds));
+    setupParams.batchSlots = bufferCast<SizeType32>(*batchSlots);
+    setupParams.batchSize = batchSize;
+    setupParams.maxPromptLen = maxPromptLen;
+    tksd::invokeLookaheadSetup(state, setupParams, stream->get());
+    stream->synchronize();
+
+    auto positionOffsets = pinned({batchSize}, kINT32);
+    auto activeSlots = pinned({batchSize}, kINT32);
+    auto draftTokens = pinned({batchSize, maxDraftLen}, kINT32);
+    auto positionIds = pinned({batchSize, maxDraftLen}, kINT32);
+    auto samplingMask = pinned({batchSize, maxDraftLen}, nvinfer1::DataType::kBOOL);
+    auto draftLengths = pinned({batchSize}, kINT32);
+    auto sampledTokens = pinned({batchSize, maxDraftLen + 1}, kINT32);
+    auto acceptedTokens = pinned({batchSize, maxN}, kINT32);
+    auto acceptedOffsets = pinned({batchSize, maxN}, kINT32);
+    auto acceptedLengths = pinned({batchSize}, kINT32);
+
+    tksd::LookaheadPrepareParams prepareParams;
+    prepareParams.positionOffsets = bufferCast<SizeType32>(*positionOffsets);
+    prepareParams.draftTokens = bufferCast<TokenIdType>(*draftTokens);
+    prepareParams.positionIds = bufferCast<SizeType32>(*positionIds);
+    prepareParams.samplingMask = bufferCast<bool>(*samplingMask);
+    prepareParams.draftLengths = bufferCast<SizeType32>(*draftLengths);
+    prepareParams.batchSlots = bufferCast<SizeType32>(*activeSlots);
+    prepareParams.maxDraftLen = maxDraftLen;
+
+    tksd::LookaheadUpdateParams updateParams;
+    updateParams.sampledTokens = bufferCast<TokenIdType>(*sampledTokens);
+    updateParams.endIds = bufferCast<TokenIdType>(*endIds);
+    updateParams.acceptedTokens = bufferCast<TokenIdType>(*acceptedTokens);
+    updateParams.acceptedOffsets = bufferCast<SizeType32>(*acceptedOffsets);
+    updateParams.acceptedLengths = bufferCast<SizeType32>(*acceptedLengths);
+    updateParams.batchSlots = bufferCast<SizeType32>(*activeSlots);
+    updateParams.maxDraftLen = maxDraftLen;
+
+    SizeType32 numSteps{0};
+    SizeType32 numAcceptedDrafts{0};
+    while (true)
+    {
+        // Finished requests leave the batch, the remaining ones keep their batch slots
+        std::vector<SizeType32> active;
+        for (SizeType32 ri = 0; ri < batchSize; ++ri)
+        {
+            if (static_cast<SizeType32>(sequences[ri].size()) < oracleLen)
+            {
+                active.push_back(ri);
+            }
+        }
+        if (active.empty())
+        {
+            break;
+        }
+        auto const activeSize = static_cast<SizeType32>(active.size());
+        for (SizeType32 bi = 0; bi < activeSize; ++bi)
+        {
+            bufferCast<SizeType32>(*activeSlots)[bi] = requests[active[bi]].batchSlot;
+            bufferCast<SizeType32>(*positionOffsets)[bi] = static_cast<SizeType32>(sequences[active[bi]].size());
+        }
+
+        prepareParams.batchSize = activeSize;
+        tksd::invokeLookaheadPrepare(state, prepareParams, stream->get());
+        stream->synchronize();
+
+        // The golden token is followed by the draft tokens as the input of the model
+        for (SizeType32 bi = 0; bi < activeSize; ++bi)
+        {
+            auto const& sequence = sequences[active[bi]];
+            auto const draftLen = bufferCast<SizeType32>(*draftLengths)[bi];
+            ASSERT_LE(draftLen, maxDraftLen);
+            auto const inputShape = ITensor::makeShape({1 + draftLen});
+            TensorPtr input = BufferManager::cpu(inputShape, kINT32);
+            TensorPtr posid = BufferManager::cpu(inputShape, kINT32);
+            TensorPtr smask = BufferManager::cpu(inputShape, nvinfer1::DataType::kBOOL);
+            bufferCast<TokenIdType>(*input)[0] = sequence.back();
+            bufferCast<SizeType32>(*posid)[0] = static_cast<SizeType32>(sequence.size()) - 1;
+            bufferCast<bool>(*smask)[0] = true;
+            for (SizeType32 di = 0; di < draftLen; ++di)
+            {
+                bufferCast<TokenIdType>(*input)[1 + di] = bufferCast<TokenIdType>(*draftTokens)[bi * maxDraftLen + di];
+                bufferCast<SizeType32>(*posid)[1 + di] = bufferCast<SizeType32>(*positionIds)[bi * maxDraftLen + di];
+                bufferCast<bool>(*smask)[1 + di] = bufferCast<bool>(*samplingMask)[bi * maxDraftLen + di];
+            }
+
+            TensorPtr output = BufferManager::cpu(inputShape, kINT32);
+            llm.foretell(output, input, posid);
+            llm.sampleByMask(output, smask);
+            auto const outputRange = BufferRange<TokenIdType>(*output);
+            std::copy(outputRange.begin(), outputRange.end(),
+                bufferCast<TokenIdType>(*sampledTokens) + bi * (maxDraftLen + 1));
+        }
+
+        updateParams.batchSize = activeSize;
+        tksd::invokeLookaheadUpdate(state, updateParams, stream->get());
+        stream->synchronize();
+
+        for (SizeType32 bi = 0; bi < activeSize; ++bi)
+        {
+            auto& sequence = sequences[active[bi]];
+            auto const acceptedLen = bufferCast<SizeType32>(*acceptedLengths)[bi];
+            ASSERT_GE(acceptedLen, 1);
+            ASSERT_LE(acceptedLen, requests[active[bi]].n);
+            auto const* accepted = bufferCast<TokenIdType>(*acceptedTokens) + bi * maxN;
+            auto const* offsets = bufferCast<SizeType32>(*acceptedOffsets) + bi * maxN;
+            auto const* sampled = bufferCast<TokenIdType>(*sampledTokens) + bi * (maxDraftLen + 1);
+            for (SizeType32 ai = 0; ai < acceptedLen; ++ai)
+            {
+                EXPECT_EQ(sampled[offsets[ai]], accepted[ai]) << "request " << active[bi] << " token " << ai;
+            }
+            TensorPtr acceptedTensor = BufferManager::cpu(ITensor::makeShape({acceptedLen}), kINT32);
+            std::copy(accepted, accepted + acceptedLen, bufferCast<TokenIdType>(*acceptedTensor));
+            EXPECT_TRUE(llm.verify(static_cast<SizeType32>(sequence.size()), acceptedTensor));
+
+            sequence.insert(sequence.end(), accepted, accepted + acceptedLen);
+            numAcceptedDrafts += acceptedLen - 1;
+        }
+        ++numSteps;
+        ASSERT_LT(numSteps, oracleLen);
+    }
+
+    for (SizeType32 ri = 0; ri < batchSize; ++ri)
+    {
+        EXPECT_EQ(static_cast<SizeType32>(sequences[ri].size()), oracleLen) << "request " << ri;
+        EXPECT_TRUE(std::equal(sequences[ri].begin(), sequences[ri].end(), oracle.begin())) << "request " << ri;
+    }
+    // The oracle repeats itself, the pool must produce some hits
+    EXPECT_GT(numAcceptedDrafts, 0);
+}
+
+} // namespace tensorrt_llm::tests::kernels
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/lookupKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+using namespace tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+
+class LookupKernelsTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "No GPU";
+        }
+        mStream = std::make_shared<CudaStream>();
+        mManager = std::make_unique<BufferManager>(mStream);
+    }
+
+    std::vector<float> toHost(ITensor const& tensor)
+    {
+        std::vector<float> values(tensor.getSize());
+        mManager->copy(tensor, values.data());
+        mStream->synchronize();
+        return values;
+    }
+
+    BufferManager::CudaStreamPtr mStream;
+    std::unique_ptr<BufferManager> mManager;
+};
+
+std::vector<float> random(std::mt19937& gen, std::size_t size)
+{
+    std::uniform_real_distribution<float> dist(-1.F, 1.F);
+    std::vector<float> values(size);
+    for (auto& v : values)
+    {
+        v = dist(gen);
+    }
+    return values;
+}
+
+} // namespace
+
+TEST_F(LookupKernelsTest, FusedMatchesSeparatePasses)
+{
+    int constexpr vocabSize = 10;
+    int constexpr taskVocabSize = 3;
+    int constexpr numTasks = 2;
+    int constexpr hidden = 64;
+    int constexpr maxPosition = 16;
+    int constexpr numShards = 2;
+    int constexpr shardSize = vocabSize / numShards;
+    float constexpr scale = 8.F;
+
+    std::mt19937 gen(3);
+    auto const weight = random(gen, vocabSize * hidden);
+    auto const promptTable = random(gen, numTasks * taskVocabSize * hidden);
+    auto const positionTable = random(gen, maxPosition * hidden);
+    // Prompt tokens of both tasks followed by text tokens of both shards
+    std::vector<int> const ids{10, 11, 12, 0, 4, 5, 9, 10, 12, 7};
+    std::vector<int> const tasks{0, 0, 0, 0, 0, 0, 0, 1, 1, 1};
+    std::vector<int> const positions{0, 1, 2, 3, 4, 5, 6, 0, 1, 2};
+    auto const numTokens = static_cast<int>(ids.size());
+
+    std::vector<float> expected(numTokens * hidden);
+    for (int t = 0; t < numTokens; ++t)
+    {
+        for (int i = 0; i < hidden; ++i)
+        {
+            auto const id = ids[t];
+            auto const embedding = id >= vocabSize
+                ? promptTable[(tasks[t] * taskVocabSize + id - vocabSize) * hidden + i]
+                : weight[id * hidden + i];
+            expected[t * hidden + i] = embedding * scale + positionTable[positions[t] * hidden + i];
+        }
+    }
+
+    auto idsDevice = mManager->copyFrom(ids, MemoryType::kGPU);
+    auto tasksDevice = mManager->copyFrom(tasks, MemoryType::kGPU);
+    auto positionsDevice = mManager->copyFrom(positions, MemoryType::kGPU);
+    auto promptTableDevice = mManager->copyFrom(promptTable, MemoryType::kGPU);
+    auto positionTableDevice = mManager->copyFrom(positionTable, MemoryType::kGPU);
+
+    // Vocab-parallel: the outputs of the shards add up to the embedding
+    std::vector<float> sum(numTokens * hidden, 0.F);
+    for (int shard = 0; shard < numShards; ++shard)
+    {
+        auto weightShard = mManager->copyFrom(
+            std::vector<float>(weight.begin() + shard * shardSize * hidden,
+                weight.begin() + (shard + 1) * shardSize * hidden),
+            MemoryType::kGPU);
+        auto out = mManager->gpu(ITensor::makeShape({numTokens, hidden}), nvinfer1::DataType::kFLOAT);
+
+        FusedLookUpParams<float, float, int> params{};
+        params.out = bufferCast<float>(*out);
+        params.input = bufferCast<int>(*idsDevice);
+        params.token_num = numTokens;
+        params.n_embed = hidden;
+        params.weight = bufferCast<float>(*weightShard);
+        params.offset = shard * shardSize;
+        params.size = shardSize;
+        params.prompt_table = bufferCast<float>(*promptTableDevice);
+        params.prompt_tasks = bufferCast<int>(*tasksDevice);
+        params.vocab_size = vocabSize;
+        params.task_vocab_size = taskVocabSize;
+        params.scale = scale;
+        params.position_table = bufferCast<float>(*positionTableDevice);
+        params.position_ids = bufferCast<int>(*positionsDevice);
+        params.is_first_shard = shard == 0;
+        invokeFusedLookUp(params, mStream->get());
+
+        auto const partial = toHost(*out);
+        for (std::size_t i = 0; i < sum.size(); ++i)
+        {
+            sum[i] += partial[i];
+        }
+    }
+    TLLM_CUDA_CHECK(cudaGetLastError());
+
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        ASSERT_NEAR(sum[i], expected[i], 1e-5F * (1.F + std::abs(expected[i]))) << "element " << i;
+    }
+}
+
+TEST_F(LookupKernelsTest, LookUpOutOfShardIsZero)
+{
+    int constexpr hidden = 32;
+    std::mt19937 gen(4);
+    auto const weight = random(gen, 4 * hidden);
+    std::vector<int> const ids{3, 4, 5, 7, 8};
+    auto const numTokens = static_cast<int>(ids.size());
+
+    auto idsDevice = mManager->copyFrom(ids, MemoryType::kGPU);
+    auto weightDevice = mManager->copyFrom(weight, MemoryType::kGPU);
+    auto out = mManager->gpu(ITensor::makeShape({numTokens, hidden}), nvinfer1::DataType::kFLOAT);
+    invokeLookUp<float, float, int>(bufferCast<float>(*out), bufferCast<int>(*idsDevice),
+        bufferCast<float>(*weightDevice), numTokens, 4, 4, hidden, nullptr, mStream->get());
+    auto const result = toHost(*out);
+
+    for (int t = 0; t < numTokens; ++t)
+    {
+        auto const row = ids[t] - 4;
+        for (int i = 0; i < hidden; ++i)
+        {
+            auto const expected = row >= 0 && row < 4 ? weight[row * hidden + i] : 0.F;
+            ASSERT_EQ(result[t * hidden + i], expected);
+        }
+    }
+}
+
+TEST_F(LookupKernelsTest, Int4WeightIsDequantized)
+{
+    int constexpr vocabSize = 6;
+    int constexpr hidden = 16;
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> valueDist(-8, 7);
+    std::vector<int> values(vocabSize * hidden);
+    for (auto& v : values)
+    {
+        v = valueDist(gen);
+    }
+    // Two values per byte, the even column in the low bits
+    std::vector<int8_t> packed(vocabSize * hidden / 2);
+    for (std::size_t i = 0; i < packed.size(); ++i)
+    {
+        packed[i] = static_cast<int8_t>((values[2 * i] & 0xf) | ((values[2 * i + 1] & 0xf) << 4));
+    }
+    std::vector<float> scales(vocabSize);
+    for (int row = 0; row < vocabSize; ++row)
+    {
+        scales[row] = 0.5F * static_cast<float>(row + 1);
+    }
+    std::vector<int> const ids{0, 5, 2, 2, 3};
+    auto const numTokens = static_cast<int>(ids.size());
+
+    auto idsDevice = mManager->copyFrom(ids, MemoryType::kGPU);
+    auto weightDevice = mManager->copyFrom(packed, MemoryType::kGPU);
+    auto scalesDevice = mManager->copyFrom(scales, MemoryType::kGPU);
+    auto out = mManager->gpu(ITensor::makeShape({numTokens, hidden}), nvinfer1::DataType::kFLOAT);
+
+    FusedLookUpParams<float, int8_t, int> params{};
+    params.out = bufferCast<float>(*out);
+    params.input = bufferCast<int>(*idsDevice);
+    params.token_num = numTokens;
+    params.n_embed = hidden;
+    params.weight = bufferCast<int8_t>(*weightDevice);
+    params.offset = 0;
+    params.size = vocabSize;
+    params.perTokenScales = bufferCast<float>(*scalesDevice);
+    params.int4_weight = true;
+    invokeFusedLookUp(params, mStream->get());
+    auto const result = toHost(*out);
+
+    for (int t = 0; t < numTokens; ++t)
+    {
+        for (int i = 0; i < hidden; ++i)
+        {
+            auto const expected = static_cast<float>(values[ids[t] * hidden + i]) * scales[ids[t]];
+            ASSERT_EQ(result[t * hidden + i], expected) << "token " << t << " column " << i;
+        }
+    }
+}
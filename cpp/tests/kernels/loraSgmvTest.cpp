@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cublasMMWrapper.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/loraSgmv.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <cuda_fp16.h>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+struct Segment
+{
+    SizeType32 numTokens;
+    SizeType32 rank;
+    SizeType32 outHiddenSize;
+};
+
+template <typename T>
+class LoraSgmvTest : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+
+        mCublasHandle = std::make_shared<cublasHandle_t>();
+        TLLM_CUDA_CHECK(cublasCreate(mCublasHandle.get()));
+        mCublasLtHandle = std::make_shared<cublasLtHandle_t>();
+        TLLM_CUDA_CHECK(cublasLtCreate(mCublasLtHandle.get()));
+        mCublasWrapper = std::make_shared<tc::CublasMMWrapper>(mCublasHandle, mCublasLtHandle, mStream->get(), nullptr);
+        if constexpr (std::is_same_v<T, half>)
+        {
+            mCublasWrapper->setFP16GemmConfig();
+        }
+        else
+        {
+            mCublasWrapper->setFP32GemmConfig();
+        }
+    }
+
+    void TearDown() override
+    {
+        mCublasWrapper.reset();
+        TLLM_CUDA_CHECK(cublasLtDestroy(*mCublasLtHandle));
+        TLLM_CUDA_CHECK(cublasDestroy(*mCublasHandle));
+    }
+
+    //! \brief The GEMM of the LoRA plugin's cuBLAS path for activations [M, K] and weights [N, K] (transB).
+    void runGemm(SizeType32 M, SizeType32 N, SizeType32 K, void const* act, void const* weight, void* output)
+    {
+        mCublasWrapper->createDescriptors(CUBLAS_OP_T, CUBLAS_OP_N, N, M, K, K, K, N);
+        mCublasWrapper->Gemm(CUBLAS_OP_T, CUBLAS_OP_N, N, M, K, weight, K, act, K, output, N, std::nullopt);
+        mCublasWrapper->destroyDescriptors();
+    }
+
+    //! \brief Run the segments, whose tokens follow each other in the input, with the SGMV kernel and with two cuBLAS
+    //! GEMMs each, and compare the outputs.
+    void runTest(std::vector<Segment> const& segments, SizeType32 inHiddenSize, SizeType32 maxLowRank, float atol)
+    {
+        auto constexpr dataType = TRTDataType<T>::value;
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> inputDistr(-1.f, 1.f);
+        std::uniform_real_distribution<float> weightDistr(-0.1f, 0.1f);
+        auto fillRandom = [&generator](ITensor& tensor, auto& distr)
+        {
+            auto* ptr = bufferCast<T>(tensor);
+            for (std::size_t i = 0; i < tensor.getSize(); ++i)
+            {
+                ptr[i] = static_cast<T>(distr(generator));
+            }
+        };
+
+        SizeType32 numTokens{0};
+        for (auto const& segment : segments)
+        {
+            numTokens += segment.numTokens;
+        }
+        auto inputHost = mBufferManager->pinned(ITensor::makeShape({numTokens, inHiddenSize}), dataType);
+        fillRandom(*inputHost, inputDistr);
+        ITensor::SharedPtr input = mBufferManager->copyFrom(*inputHost, MemoryType::kGPU);
+
+        std::vector<tk::LoraSgmvProblem> problems;
+        std::vector<ITensor::SharedPtr> buffers;
+        std::vector<ITensor::SharedPtr> outputs;
+        std::vector<ITensor::SharedPtr> expectedOutputs;
+        SizeType32 tokenOffset{0};
+        for (auto const& segment : segments)
+        {
+            auto const rank = segment.rank;
+            auto const outHiddenSize = segment.outHiddenSize;
+            // Weights as stored in the LoRA cache pages, [rank, inHiddenSize] and [outHiddenSize, rank]
+            auto const storedRank = std::max(rank, 1);
+            auto weightsInHost = mBufferManager->pinned(ITensor::makeShape({storedRank, inHiddenSize}), dataType);
+            fillRandom(*weightsInHost, weightDistr);
+            auto weightsOutHost = mBufferManager->pinned(ITensor::makeShape({outHiddenSize, storedRank}), dataType);
+            fillRandom(*weightsOutHost, weightDistr);
+            ITensor::SharedPtr weightsIn = mBufferManager->copyFrom(*weightsInHost, MemoryType::kGPU);
+            ITensor::SharedPtr weightsOut = mBufferManager->copyFrom(*weightsOutHost, MemoryType::kGPU);
+
+            auto const outputShape = ITensor::makeShape({segment.numTokens, outHiddenSize});
+            ITensor::SharedPtr output = mBufferManager->gpu(outputShape, dataType);
+            mBufferManager->setZero(*output);
+            ITensor::SharedPtr expectedOutput = mBufferManager->gpu(outputShape, dataType);
+            mBufferManager->setZero(*expectedOutput);
+            ITensor::SharedPtr segmentInput = ITensor::slice(input, tokenOffset, segment.numTokens);
+
+            if (rank > 0)
+            {
+                ITensor::SharedPtr lowRank
+                    = mBufferManager->gpu(ITensor::makeShape({segment.numTokens, rank}), dataType);
+                runGemm(segment.numTokens, rank, inHiddenSize, segmentInput->data(), weightsIn->data(),
+                    lowRank->data());
+                runGemm(segment.numTokens, outHiddenSize, rank, lowRank->data(), weightsOut->data(),
+                    expectedOutput->data());
+                buffers.push_back(lowRank);
+            }
+
+            problems.push_back(tk::LoraSgmvProblem{segmentInput->data(), weightsIn->data(), weightsOut->data(),
+                output->data(), segment.numTokens, rank, outHiddenSize});
+            buffers.insert(buffers.end(), {segmentInput, weightsIn, weightsOut});
+            outputs.push_back(output);
+            expectedOutputs.push_back(expectedOutput);
+            tokenOffset += segment.numTokens;
+        }
+
+        auto const workspaceSize = tk::getLoraSgmvWorkSpaceSize(static_cast<int64_t>(problems.size()));
+        auto workspace = mBufferManager->gpu(workspaceSize);
+        tk::invokeLoraSgmv(
+            problems, inHiddenSize, maxLowRank, workspace->data(), workspaceSize, dataType, mStream->get());
+
+        for (std::size_t pi = 0; pi < problems.size(); ++pi)
+        {
+            auto outputHost = mBufferManager->copyFrom(*outputs[pi], MemoryType::kCPU);
+            auto expectedHost = mBufferManager->copyFrom(*expectedOutputs[pi], MemoryType::kCPU);
+            mStream->synchronize();
+            auto const* outputPtr = bufferCast<T>(*outputHost);
+            auto const* expectedPtr = bufferCast<T>(*expectedHost);
+            for (std::size_t i = 0; i < outputHost->getSize(); ++i)
+            {
+                // Segments of rank 0 keep their output untouched
+                ASSERT_NEAR(static_cast<float>(outputPtr[i]), static_cast<float>(expectedPtr[i]), atol)
+                    << "problem " << pi << " element " << i;
+            }
+        }
+    }
+
+protected:
+    std::shared_ptr<BufferManager> mBufferManager;
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<cublasHandle_t> mCublasHandle;
+    std::shared_ptr<cublasLtHandle_t> mCublasLtHandle;
+    std::shared_ptr<tc::CublasMMWrapper> mCublasWrapper;
+};
+
+using FloatAndHalfTypes = testing::Types<float, half>;
+TYPED_TEST_SUITE(LoraSgmvTest, FloatAndHalfTypes);
+
+TYPED_TEST(LoraSgmvTest, GenerationSegments)
+{
+    // One token per request, each with its own adapter, for two modules with different output sizes
+    std::vector<Segment> segments;
+    for (SizeType32 i = 0; i < 12; ++i)
+    {
+        segments.push_back(Segment{1, 4 + 4 * (i % 4), i < 6 ? 384 : 128});
+    }
+    auto const atol = std::is_same_v<TypeParam, half> ? 5e-3f : 1e-4f;
+    this->runTest(segments, 256, 16, atol);
+}
+
+TYPED_TEST(LoraSgmvTest, MixedSegments)
+{
+    // Segments up to the SGMV token limit, spanning several token blocks, and a request without LoRA
+    std::vector<Segment> segments{{tk::kLORA_SGMV_MAX_NUM_TOKENS_PER_PROBLEM, 8, 512}, {3, 64, 200}, {5, 0, 200},
+        {9, 1, 96}, {1, 32, 1000}};
+    auto const atol = std::is_same_v<TypeParam, half> ? 5e-3f : 1e-4f;
+    this->runTest(segments, 320, 64, atol);
+}
+
+} // namespace
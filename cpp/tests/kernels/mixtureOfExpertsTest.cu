@@ -6,7 +6,10 @@
 #include <algorithm>
 #include <gtest/gtest.h>
 #include <numeric>
+#include <random>
 
+#include "tensorrt_llm/kernels/mixtureOfExperts/moeAllToAll.h"
+#include "tensorrt_llm/kernels/mixtureOfExperts/moeExpertReplication.h"
 #include "tensorrt_llm/kernels/mixtureOfExperts/moe_kernels.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 
@@ -1048,6 +1051,53 @@ TYPED_TEST(MixtureOfExpertsTest, PermuteK3)
     this->BasicPermuteTest(3);
 }
 
+// Small batches route with a fused kernel and large ones with the radix sort, both must give the sorted order
+TYPED_TEST(MixtureOfExpertsTest, PermuteFusedAndSortedRouting)
+{
+    using DataType = typename TypeParam::DataType;
+    if constexpr (TestFixture::FP8)
+    {
+        this->mUseBias = false;
+    }
+    int64_t const hidden_size = this->DEFAULT_HIDDEN_SIZE;
+    int64_t const num_experts = 4;
+    int const k = 2;
+    float const token_probs[][4] = {
+        {0.5, 0.1, 0.25, 0.15},
+        {0.03, 0.2, 0.07, 0.7},
+        {0.25, 0.21, 0.35, 0.19},
+    };
+    // 600 and 1400 expanded rows
+    for (int64_t num_tokens : {300, 700})
+    {
+        std::vector<DataType> hidden_states(hidden_size * num_tokens);
+        auto raw_unquant_input = this->populateTokens(hidden_states);
+        std::vector<float> probs;
+        for (int64_t t = 0; t < num_tokens; ++t)
+        {
+            probs.insert(probs.end(), std::begin(token_probs[(t * 7) % 3]), std::end(token_probs[(t * 7) % 3]));
+        }
+
+        this->runMoEPermute({hidden_states}, {probs}, hidden_size, num_experts, k);
+
+        auto selected_expert = this->getDataFromDevice(this->mSelectedExpert, num_tokens * k);
+        std::vector<int> order(num_tokens * k);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+            [&](int a, int b) { return selected_expert[a] < selected_expert[b]; });
+        std::vector<int> permute_map(num_tokens * k);
+        for (int dest = 0; dest < num_tokens * k; ++dest)
+        {
+            int const token = order[dest] / k;
+            int const k_idx = order[dest] % k;
+            permute_map[k_idx * num_tokens + token] = dest;
+        }
+        auto proj_map = this->getDataFromDevice(this->mSourceToExpandedMap, num_tokens * k);
+        ASSERT_EQ(permute_map, proj_map) << "num tokens " << num_tokens;
+        this->compareFinal(selected_expert, probs, raw_unquant_input);
+    }
+}
+
 TYPED_TEST(MixtureOfExpertsTest, PermuteNoBias)
 {
     this->mUseBias = false;
@@ -1355,6 +1405,48 @@ TYPED_TEST(MixtureOfExpertsTest, TensorParallelSwiglu)
     this->TensorParallelTest(3);
 }
 
+TYPED_TEST(MixtureOfExpertsTest, SkewedExpertLoad)
+{
+    using DataType = typename TypeParam::DataType;
+    if constexpr (TestFixture::FP8)
+    {
+        this->mUseBias = false;
+    }
+    int64_t const hidden_size = this->DEFAULT_HIDDEN_SIZE;
+    int64_t const num_experts = 16;
+    // One hot expert with 24 rows, the other 16 rows spread over the remaining experts. Tiles taller than 32 rows
+    // split the experts by load between two grouped GEMMs
+    int64_t const num_tokens = 40;
+    std::vector<float> probs;
+    for (int64_t t = 0; t < num_tokens; ++t)
+    {
+        int64_t const expert = t < 24 ? 0 : 1 + t % (num_experts - 1);
+        for (int64_t e = 0; e < num_experts; ++e)
+        {
+            probs.push_back(e == expert ? 0.55f : 0.03f);
+        }
+    }
+
+    for (auto conf : this->mMoERunner.getTactics())
+    {
+        if (conf.is_sm90)
+        {
+            continue;
+        }
+        std::vector<DataType> hidden_states(hidden_size * num_tokens);
+        auto raw_unquant_input = this->populateTokens(hidden_states);
+
+        this->mSelectedConfig = conf;
+        this->runMoEPermute({hidden_states}, {probs}, hidden_size, num_experts, 1);
+
+        auto selected_expert = this->getDataFromDevice(this->mSelectedExpert, num_tokens);
+        this->compareFinal(selected_expert, probs, raw_unquant_input);
+        ASSERT_FALSE(::testing::Test::HasFailure())
+            << "Failed tactic with tile shape " << (int) conf.tile_config << " and stages " << conf.stages;
+    }
+    this->mSelectedConfig = std::nullopt;
+}
+
 TYPED_TEST(MixtureOfExpertsTest, ConfigSweep)
 {
     std::vector<tensorrt_llm::ActivationType> actiavtion_pool = {
@@ -1469,3 +1561,200 @@ TYPED_TEST(LargeMixtureOfExpertsTest, PermuteVeryLongSequence)
     std::vector<typename TypeParam::OutputType> unquant_states(this->mTotalTokens * hidden_size);
     this->compareFinal(selected_expert, probs, unquant_states);
 }
+
+TEST(MoeAllToAllTest, DispatchCombine)
+{
+    if (getDeviceCount() <= 0)
+    {
+        GTEST_SKIP();
+    }
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager manager(stream);
+
+    // Enough expanded rows for several chunks of the layout kernel
+    int64_t const num_rows = 700;
+    int64_t const hidden_size = 64;
+    int const k = 3;
+    int const num_experts = 16;
+    int const ep_size = 4;
+    int const experts_per_rank = num_experts / ep_size;
+
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<int> expert_dist(0, num_experts - 1);
+    std::uniform_real_distribution<float> dist(0.1f, 1.f);
+    std::vector<int> experts(num_rows * k);
+    std::vector<float> scales(num_rows * k);
+    std::vector<float> input(num_rows * hidden_size);
+    for (int64_t i = 0; i < num_rows * k; ++i)
+    {
+        // Some finished tokens, routed nowhere
+        experts[i] = (i / k) % 17 == 0 ? num_experts : expert_dist(gen);
+        scales[i] = dist(gen);
+    }
+    for (auto& v : input)
+    {
+        v = dist(gen);
+    }
+
+    auto experts_device = manager.copyFrom(experts, MemoryType::kGPU);
+    auto scales_device = manager.copyFrom(scales, MemoryType::kGPU);
+    auto input_device = manager.copyFrom(input, MemoryType::kGPU);
+    auto send_counts = manager.gpu(ep_size, nvinfer1::DataType::kINT32);
+    auto slots = manager.gpu(num_rows * k, nvinfer1::DataType::kINT32);
+    auto expanded_rows = manager.gpu(num_rows * k, nvinfer1::DataType::kINT32);
+    auto local_experts = manager.gpu(num_rows * k, nvinfer1::DataType::kINT32);
+    auto send_rows = manager.gpu(num_rows * k * hidden_size, nvinfer1::DataType::kFLOAT);
+    auto output = manager.gpu(num_rows * hidden_size, nvinfer1::DataType::kFLOAT);
+
+    invokeMoeDispatchLayout(bufferCast<int>(*experts_device), num_rows, k, num_experts, ep_size,
+        bufferCast<int>(*send_counts), bufferCast<int>(*slots), bufferCast<int>(*expanded_rows),
+        bufferCast<int>(*local_experts), stream->get());
+
+    std::vector<int> counts(ep_size);
+    std::vector<int> slot(num_rows * k);
+    std::vector<int> expanded(num_rows * k);
+    std::vector<int> local(num_rows * k);
+    manager.copy(*send_counts, counts.data());
+    manager.copy(*slots, slot.data());
+    manager.copy(*expanded_rows, expanded.data());
+    manager.copy(*local_experts, local.data());
+    stream->synchronize();
+
+    // Rows are grouped by rank, in their original order within a rank
+    std::vector<std::vector<int>> rank_rows(ep_size);
+    for (int64_t i = 0; i < num_rows * k; ++i)
+    {
+        if (experts[i] < num_experts)
+        {
+            rank_rows[experts[i] / experts_per_rank].push_back(i);
+        }
+    }
+    int64_t pos = 0;
+    for (int r = 0; r < ep_size; ++r)
+    {
+        ASSERT_EQ(counts[r], static_cast<int>(rank_rows[r].size()));
+        for (int row : rank_rows[r])
+        {
+            ASSERT_EQ(expanded[pos], row);
+            ASSERT_EQ(slot[row], pos);
+            ASSERT_EQ(local[pos], experts[row] - r * experts_per_rank);
+            ++pos;
+        }
+    }
+    for (int64_t i = 0; i < num_rows * k; ++i)
+    {
+        if (experts[i] == num_experts)
+        {
+            ASSERT_EQ(slot[i], -1);
+        }
+    }
+
+    // With identity experts the rows come back unchanged, so the combine scales every token by its routing weights
+    invokeMoeDispatchGather(bufferCast<float>(*input_device), bufferCast<float>(*send_rows),
+        bufferCast<int>(*expanded_rows), pos, hidden_size, k, stream->get());
+    for (auto mode : {MOEExpertScaleNormalizationMode::NONE, MOEExpertScaleNormalizationMode::RENORMALIZE})
+    {
+        invokeMoeCombine(bufferCast<float>(*send_rows), bufferCast<float>(*output), bufferCast<float>(*scales_device),
+            bufferCast<int>(*slots), num_rows, hidden_size, k, mode, stream->get());
+        std::vector<float> out(num_rows * hidden_size);
+        manager.copy(*output, out.data());
+        stream->synchronize();
+        for (int64_t t = 0; t < num_rows; ++t)
+        {
+            float weight = 0.f;
+            for (int j = 0; j < k; ++j)
+            {
+                weight += experts[t * k + j] < num_experts ? scales[t * k + j] : 0.f;
+            }
+            if (mode == MOEExpertScaleNormalizationMode::RENORMALIZE && weight > 0.f)
+            {
+                weight = 1.f;
+            }
+            for (int64_t c = 0; c < hidden_size; ++c)
+            {
+                ASSERT_NEAR(out[t * hidden_size + c], weight * input[t * hidden_size + c], 1e-5)
+                    << "token " << t << " channel " << c;
+            }
+        }
+    }
+}
+
+TEST(MoeReplicationTest, PlanSpreadsHotExpert)
+{
+    // Two experts per node, expert 0 takes most of the tokens
+    std::vector<int64_t> const loads = {100, 10, 10, 10, 10, 10, 10, 10};
+    MoeReplicationPlan plan(loads, 4, 1);
+
+    EXPECT_EQ(plan.getNumReplicas(0), 4);
+    for (int r = 1; r < 4; ++r)
+    {
+        EXPECT_EQ(plan.getReplicaExperts(r), std::vector<int>{0});
+    }
+    auto const node_loads = plan.getNodeLoads();
+    EXPECT_NEAR(*std::max_element(node_loads.begin(), node_loads.end()), 45.0, 1e-6);
+    EXPECT_NEAR(std::accumulate(node_loads.begin(), node_loads.end(), 0.0), 170.0, 1e-6);
+
+    // A balanced load gains nothing from replicas
+    MoeReplicationPlan balanced(std::vector<int64_t>(8, 10), 4, 1);
+    for (int e = 0; e < 8; ++e)
+    {
+        EXPECT_EQ(balanced.getNumReplicas(e), 1);
+    }
+}
+
+TEST(MoeReplicationTest, RoutingComputesEveryRowOnce)
+{
+    if (getDeviceCount() <= 0)
+    {
+        GTEST_SKIP();
+    }
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager manager(stream);
+
+    int64_t const num_rows = 300;
+    int const k = 2;
+    int const num_experts = 8;
+    int const ep_size = 4;
+    int const experts_per_node = num_experts / ep_size;
+    std::vector<int64_t> const loads = {100, 10, 10, 10, 40, 10, 10, 10};
+    MoeReplicationPlan plan(loads, ep_size, 2);
+
+    std::mt19937 gen(1234);
+    std::discrete_distribution<int> expert_dist(loads.begin(), loads.end());
+    std::vector<int> experts(num_rows * k);
+    for (int64_t i = 0; i < num_rows * k; ++i)
+    {
+        experts[i] = (i / k) % 13 == 0 ? num_experts : expert_dist(gen);
+    }
+
+    std::vector<int> claims(num_rows * k, 0);
+    for (int r = 0; r < ep_size; ++r)
+    {
+        auto table = manager.copyFrom(plan.getNodeTable(r), MemoryType::kGPU);
+        auto routed_device = manager.copyFrom(experts, MemoryType::kGPU);
+        invokeMoeReplicaRouting(
+            bufferCast<int>(*routed_device), num_rows, k, num_experts, bufferCast<int>(*table), stream->get());
+        std::vector<int> routed(num_rows * k);
+        manager.copy(*routed_device, routed.data());
+        stream->synchronize();
+
+        auto const& replica_experts = plan.getReplicaExperts(r);
+        for (int64_t i = 0; i < num_rows * k; ++i)
+        {
+            int const slot = routed[i];
+            if (slot == num_experts)
+            {
+                continue;
+            }
+            ASSERT_LT(slot, experts_per_node + 2);
+            int const expert
+                = slot < experts_per_node ? r * experts_per_node + slot : replica_experts[slot - experts_per_node];
+            ASSERT_EQ(expert, experts[i]) << "rank " << r << " row " << i;
+            claims[i]++;
+        }
+    }
+    for (int64_t i = 0; i < num_rows * k; ++i)
+    {
+        ASSERT_EQ(claims[i], experts[i] < num_experts ? 1 : 0) << "row " << i;
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/multiBlockHeuristic.h"
+#include "tensorrt_llm/common/tllmException.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+using namespace tensorrt_llm::kernels;
+
+TEST(MultiBlockHeuristicTest, fillsIdleSms)
+{
+    MultiBlockHeuristic heuristic;
+    // 16 blocks on 132 SMs at 128k, split to fill the GPU.
+    auto decision = heuristic.decide(2, 8, 128 * 1024, 132, 17);
+    EXPECT_EQ(decision.numSplits, 9);
+    EXPECT_FALSE(decision.profiled);
+    // Capped by the workspace.
+    EXPECT_EQ(heuristic.decide(2, 8, 128 * 1024, 132, 4).numSplits, 4);
+    // Capped by the KV length, every split needs enough tokens.
+    EXPECT_EQ(heuristic.decide(2, 8, 600, 132, 17).numSplits, 2);
+    EXPECT_EQ(heuristic.decide(2, 8, 100, 132, 17).numSplits, 1);
+    // The batch already fills all SMs.
+    EXPECT_EQ(heuristic.decide(64, 32, 128 * 1024, 132, 5).numSplits, 1);
+}
+
+TEST(MultiBlockHeuristicTest, profiledTable)
+{
+    MultiBlockHeuristic heuristic;
+    std::istringstream table("# batchBeam kvLength numHeads multiProcessorCount numSplits\n"
+                             "2 4096 8 132 4\n"
+                             "\n"
+                             "2 65536 8 132 12\n");
+    heuristic.loadProfiledTable(table);
+    EXPECT_TRUE(heuristic.hasProfiledEntries());
+
+    // Shorter than all profiled lengths, the built-in rule applies.
+    auto decision = heuristic.decide(2, 8, 1000, 132, 17);
+    EXPECT_EQ(decision.numSplits, 3);
+    EXPECT_FALSE(decision.profiled);
+
+    decision = heuristic.decide(2, 8, 5000, 132, 17);
+    EXPECT_EQ(decision.numSplits, 4);
+    EXPECT_TRUE(decision.profiled);
+    EXPECT_EQ(heuristic.decide(2, 8, 100000, 132, 17).numSplits, 12);
+    EXPECT_EQ(heuristic.decide(2, 8, 100000, 132, 8).numSplits, 8);
+    // Other SM count, not profiled.
+    EXPECT_FALSE(heuristic.decide(2, 8, 100000, 108, 17).profiled);
+
+    std::istringstream malformed("2 4096 8\n");
+    EXPECT_THROW(heuristic.loadProfiledTable(malformed), tensorrt_llm::common::TllmException);
+}
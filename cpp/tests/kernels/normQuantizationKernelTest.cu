@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/layernormKernels.h"
+#include "tensorrt_llm/kernels/rmsnormKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+using namespace tensorrt_llm::kernels;
+
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+
+class NormQuantizationKernelTest : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP();
+        }
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    // Quantizes the normed rows per token and checks the dequantized values against the reference norm. With
+    // withResidual, the norm is applied to input + residual and the sum is checked too. singlePass selects the
+    // single pass layernorm, inputOffset shifts the mean of the input away from zero.
+    template <typename QuantT>
+    void runTest(int tokens, int hiddenDim, bool rmsnorm, float quantMax, float relTolerance, bool withResidual = false,
+        bool singlePass = false, float inputOffset = 0.f)
+    {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<float> dist(-2.f, 2.f);
+        std::vector<half> input(tokens * hiddenDim);
+        std::vector<half> gamma(hiddenDim);
+        std::vector<half> beta(hiddenDim);
+        std::vector<half> residual(tokens * hiddenDim);
+        for (auto& v : input)
+        {
+            v = __float2half(dist(gen) + inputOffset);
+        }
+        for (auto& v : residual)
+        {
+            v = __float2half(dist(gen));
+        }
+        for (int i = 0; i < hiddenDim; ++i)
+        {
+            gamma[i] = __float2half(dist(gen));
+            beta[i] = __float2half(dist(gen) * 0.1f);
+        }
+
+        auto inputDevice = mBufferManager->copyFrom(input, MemoryType::kGPU);
+        auto gammaDevice = mBufferManager->copyFrom(gamma, MemoryType::kGPU);
+        auto betaDevice = mBufferManager->copyFrom(beta, MemoryType::kGPU);
+        auto residualDevice = mBufferManager->copyFrom(residual, MemoryType::kGPU);
+        auto residualOutDevice = mBufferManager->gpu(residual.size(), nvinfer1::DataType::kHALF);
+        auto quantDevice = mBufferManager->gpu(input.size() * sizeof(QuantT), nvinfer1::DataType::kINT8);
+        auto scalesDevice = mBufferManager->gpu(tokens, nvinfer1::DataType::kFLOAT);
+        auto* quantPtr = reinterpret_cast<QuantT*>(quantDevice->data());
+        auto* scalesPtr = bufferCast<float>(*scalesDevice);
+        auto const* inputPtr = bufferCast<half>(*inputDevice);
+        auto const* gammaPtr = bufferCast<half>(*gammaDevice);
+        auto const* betaPtr = bufferCast<half>(*betaDevice);
+        float const eps = 1e-6f;
+        if (rmsnorm)
+        {
+            invokeGeneralRmsNorm((half*) nullptr, inputPtr, gammaPtr, betaPtr, eps, tokens, hiddenDim, mStream->get(),
+                nullptr, scalesPtr, quantPtr, withResidual ? bufferCast<half>(*residualDevice) : nullptr,
+                withResidual ? bufferCast<half>(*residualOutDevice) : nullptr);
+        }
+        else
+        {
+            invokeGeneralLayerNorm((half*) nullptr, inputPtr, gammaPtr, betaPtr, eps, tokens, hiddenDim,
+                mStream->get(), singlePass, nullptr, scalesPtr, quantPtr,
+                withResidual ? bufferCast<half>(*residualDevice) : nullptr,
+                withResidual ? bufferCast<half>(*residualOutDevice) : nullptr);
+        }
+
+        std::vector<QuantT> quant(input.size());
+        std::vector<float> scales(tokens);
+        std::vector<half> residualOut(residual.size());
+        mBufferManager->copy(*quantDevice, quant.data());
+        mBufferManager->copy(*scalesDevice, scales.data());
+        mBufferManager->copy(*residualOutDevice, residualOut.data());
+        mStream->synchronize();
+
+        if (withResidual)
+        {
+            for (size_t i = 0; i < input.size(); ++i)
+            {
+                half const sum = __float2half(__half2float(input[i]) + __half2float(residual[i]));
+                ASSERT_EQ(__half2float(residualOut[i]), __half2float(sum)) << "element " << i;
+                input[i] = sum;
+            }
+        }
+
+        for (int t = 0; t < tokens; ++t)
+        {
+            double mean = 0.;
+            for (int i = 0; i < hiddenDim; ++i)
+            {
+                mean += __half2float(input[t * hiddenDim + i]);
+            }
+            mean = rmsnorm ? 0. : mean / hiddenDim;
+            double sumSquares = 0.;
+            for (int i = 0; i < hiddenDim; ++i)
+            {
+                double const x = __half2float(input[t * hiddenDim + i]) - mean;
+                sumSquares += x * x;
+            }
+            float const invStd = static_cast<float>(1. / std::sqrt(sumSquares / hiddenDim + eps));
+            std::vector<float> ref(hiddenDim);
+            float amax = 0.f;
+            for (int i = 0; i < hiddenDim; ++i)
+            {
+                float const x = static_cast<float>(__half2float(input[t * hiddenDim + i]) - mean);
+                ref[i] = x * invStd * __half2float(gamma[i]) + __half2float(beta[i]);
+                amax = std::max(amax, std::abs(ref[i]));
+            }
+            EXPECT_NEAR(scales[t], amax / quantMax, amax / quantMax * 1e-2f) << "token " << t;
+            for (int i = 0; i < hiddenDim; ++i)
+            {
+                float const dequant = static_cast<float>(quant[t * hiddenDim + i]) * scales[t];
+                EXPECT_NEAR(dequant, ref[i], std::abs(ref[i]) * relTolerance + scales[t])
+                    << "token " << t << " dim " << i;
+            }
+        }
+    }
+
+protected:
+    std::shared_ptr<BufferManager> mBufferManager;
+    std::shared_ptr<CudaStream> mStream;
+};
+
+} // namespace
+
+TEST_F(NormQuantizationKernelTest, rmsnormPerTokenInt8)
+{
+    runTest<int8_t>(7, 1024, true, 127.f, 1e-2f);
+}
+
+TEST_F(NormQuantizationKernelTest, rmsnormResidualPerTokenInt8)
+{
+    runTest<int8_t>(7, 1024, true, 127.f, 1e-2f, true);
+}
+
+TEST_F(NormQuantizationKernelTest, layernormResidualPerTokenInt8)
+{
+    runTest<int8_t>(7, 1024, false, 127.f, 1e-2f, true);
+}
+
+TEST_F(NormQuantizationKernelTest, layernormSinglePassPerTokenInt8)
+{
+    runTest<int8_t>(7, 1024, false, 127.f, 1e-2f, true, true);
+    // Rows of odd size take the scalar path
+    runTest<int8_t>(3, 1024 + 2, false, 127.f, 1e-2f, false, true);
+}
+
+TEST_F(NormQuantizationKernelTest, layernormSinglePassLargeMean)
+{
+    // E[x²] - E[x]² would lose most of the variance to cancellation here
+    runTest<int8_t>(4, 2048, false, 127.f, 1e-2f, false, true, 200.f);
+}
+
+#ifdef ENABLE_FP8
+TEST_F(NormQuantizationKernelTest, rmsnormPerTokenFp8)
+{
+    // e4m3 keeps 3 mantissa bits
+    runTest<__nv_fp8_e4m3>(7, 1024, true, 448.f, 1.f / 8);
+}
+
+TEST_F(NormQuantizationKernelTest, layernormPerTokenFp8)
+{
+    runTest<__nv_fp8_e4m3>(5, 4096 + 2, false, 448.f, 1.f / 8);
+}
+#endif
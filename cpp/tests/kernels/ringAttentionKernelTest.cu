@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/ringAttentionKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/contextParallelPlan.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+using namespace tensorrt_llm::kernels;
+
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+
+class RingAttentionKernelTest : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP();
+        }
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    // Runs the steps of every rank of the ring on one GPU, each over the KV share it would hold at that step, and
+    // compares the outputs with causal attention over the whole prompt.
+    void runTest(int cpSize, int promptLength, int numHeads, int numKvHeads, int headSize)
+    {
+        ContextParallelPlan const plan{cpSize, promptLength};
+        int const tokenSize = numHeads * headSize;
+        int const kvTokenSize = numKvHeads * headSize;
+
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        std::vector<float> q(static_cast<size_t>(promptLength) * tokenSize);
+        std::vector<float> k(static_cast<size_t>(promptLength) * kvTokenSize);
+        std::vector<float> v(k.size());
+        for (auto* values : {&q, &k, &v})
+        {
+            for (auto& value : *values)
+            {
+                value = dist(gen);
+            }
+        }
+
+        // The tokens of each share, gathered as the rank would hold them
+        auto const gather = [](std::vector<float> const& src, std::vector<SizeType32> const& positions, int rowSize)
+        {
+            std::vector<float> dst;
+            dst.reserve(positions.size() * rowSize);
+            for (auto const pos : positions)
+            {
+                dst.insert(dst.end(), src.begin() + static_cast<size_t>(pos) * rowSize,
+                    src.begin() + static_cast<size_t>(pos + 1) * rowSize);
+            }
+            return dst;
+        };
+        std::vector<std::vector<SizeType32>> positions;
+        std::vector<ITensor::SharedPtr> positionsDevice, kDevice, vDevice;
+        for (int rank = 0; rank < cpSize; ++rank)
+        {
+            positions.push_back(plan.getPositions(rank));
+            positionsDevice.push_back(mBufferManager->copyFrom(positions[rank], MemoryType::kGPU));
+            kDevice.push_back(mBufferManager->copyFrom(gather(k, positions[rank], kvTokenSize), MemoryType::kGPU));
+            vDevice.push_back(mBufferManager->copyFrom(gather(v, positions[rank], kvTokenSize), MemoryType::kGPU));
+        }
+
+        float const qkScale = 1.f / std::sqrt(static_cast<float>(headSize));
+        std::vector<float> out(q.size());
+        for (int rank = 0; rank < cpSize; ++rank)
+        {
+            int const numTokens = plan.getNumTokens(rank);
+            auto qDevice = mBufferManager->copyFrom(gather(q, positions[rank], tokenSize), MemoryType::kGPU);
+            auto const outSize = static_cast<size_t>(numTokens) * tokenSize;
+            auto accOut = mBufferManager->gpu(outSize, nvinfer1::DataType::kFLOAT);
+            auto accLse = mBufferManager->gpu(static_cast<size_t>(numTokens) * numHeads, nvinfer1::DataType::kFLOAT);
+            auto outDevice = mBufferManager->gpu(outSize, nvinfer1::DataType::kFLOAT);
+            invokeRingAttentionInit(
+                bufferCast<float>(*accOut), bufferCast<float>(*accLse), numTokens, numHeads, headSize, mStream->get());
+            for (int step = 0; step < cpSize; ++step)
+            {
+                auto const source = plan.getSourceRank(rank, step);
+                RingAttentionStepParams<float> params;
+                params.q = bufferCast<float>(*qDevice);
+                params.q_positions = bufferCast<SizeType32>(*positionsDevice[rank]);
+                params.k = bufferCast<float>(*kDevice[source]);
+                params.v = bufferCast<float>(*vDevice[source]);
+                params.kv_positions = bufferCast<SizeType32>(*positionsDevice[source]);
+                params.acc_out = bufferCast<float>(*accOut);
+                params.acc_lse = bufferCast<float>(*accLse);
+                params.num_q_tokens = numTokens;
+                params.num_kv_tokens = plan.getNumTokens(source);
+                params.num_heads = numHeads;
+                params.num_kv_heads = numKvHeads;
+                params.head_size = headSize;
+                params.qk_scale = qkScale;
+                invokeRingAttentionStep(params, mStream->get());
+            }
+            invokeRingAttentionFinalize(
+                bufferCast<float>(*outDevice), bufferCast<float>(*accOut), outDevice->getSize(), mStream->get());
+
+            std::vector<float> rankOut(outDevice->getSize());
+            mBufferManager->copy(*outDevice, rankOut.data());
+            mStream->synchronize();
+            for (int i = 0; i < numTokens; ++i)
+            {
+                std::copy_n(rankOut.begin() + static_cast<size_t>(i) * tokenSize, tokenSize,
+                    out.begin() + static_cast<size_t>(positions[rank][i]) * tokenSize);
+            }
+        }
+
+        for (int pos = 0; pos < promptLength; ++pos)
+        {
+            for (int head = 0; head < numHeads; ++head)
+            {
+                int const kvHead = head / (numHeads / numKvHeads);
+                float const* qRow = q.data() + (static_cast<size_t>(pos) * numHeads + head) * headSize;
+                std::vector<float> scores(pos + 1);
+                float maxScore = -INFINITY;
+                for (int t = 0; t <= pos; ++t)
+                {
+                    float s = 0.f;
+                    for (int d = 0; d < headSize; ++d)
+                    {
+                        s += qRow[d] * k[(static_cast<size_t>(t) * numKvHeads + kvHead) * headSize + d];
+                    }
+                    scores[t] = s * qkScale;
+                    maxScore = std::max(maxScore, scores[t]);
+                }
+                float sum = 0.f;
+                for (auto& s : scores)
+                {
+                    s = std::exp(s - maxScore);
+                    sum += s;
+                }
+                for (int d = 0; d < headSize; ++d)
+                {
+                    float ref = 0.f;
+                    for (int t = 0; t <= pos; ++t)
+                    {
+                        ref += scores[t] * v[(static_cast<size_t>(t) * numKvHeads + kvHead) * headSize + d];
+                    }
+                    ref /= sum;
+                    EXPECT_NEAR(out[(static_cast<size_t>(pos) * numHeads + head) * headSize + d], ref, 1e-4f)
+                        << "position " << pos << " head " << head << " dim " << d;
+                }
+            }
+        }
+    }
+
+protected:
+    std::shared_ptr<BufferManager> mBufferManager;
+    std::shared_ptr<CudaStream> mStream;
+};
+
+} // namespace
+
+TEST_F(RingAttentionKernelTest, singleRank)
+{
+    runTest(1, 77, 4, 4, 64);
+}
+
+TEST_F(RingAttentionKernelTest, ringMha)
+{
+    runTest(4, 203, 8, 8, 64);
+}
+
+TEST_F(RingAttentionKernelTest, ringGqa)
+{
+    // Shares of unequal size, the queries of the first chunks have no KV token in the shares of the later ones
+    runTest(3, 130, 8, 2, 128);
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/kernels/samplingFusedPenaltyTopKKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+TEST(SamplingFusedPenaltyTopKTest, greedyMatchesUnfusedSemantics)
+{
+    SizeType32 constexpr batchSize{3};
+    SizeType32 constexpr maxBatchSize{2 * batchSize};
+    // Spans several chunks, with a partial last one
+    SizeType32 constexpr vocabSize{2 * tk::FUSED_PENALTY_TOP_K_CHUNK_SIZE + 100};
+    SizeType32 constexpr vocabSizePadded{vocabSize + 8};
+    SizeType32 constexpr maxSeqLen{16};
+    SizeType32 constexpr inputLen{6};
+
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager manager{stream};
+
+    auto logits = BufferManager::pinned(ITensor::makeShape({batchSize, vocabSizePadded}), nvinfer1::DataType::kFLOAT);
+    auto logitsPtrs = BufferManager::pinned(ITensor::makeShape({batchSize}), TRTDataType<float*>::value);
+    auto outputIds = BufferManager::pinned(ITensor::makeShape({maxBatchSize, maxSeqLen}), nvinfer1::DataType::kINT32);
+    auto outputIdsPtrs = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), TRTDataType<TokenIdType*>::value);
+    auto penaltyWorkspace = manager.gpu(ITensor::makeShape({batchSize, vocabSize}), nvinfer1::DataType::kINT32);
+    auto batchSlots = BufferManager::pinned(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+    auto temperatures = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kFLOAT);
+    auto repetitionPenalties = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kFLOAT);
+    auto minLengths = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    auto inputLengths = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    auto sequenceLengths = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    auto endIds = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    auto finished = BufferManager::pinned(
+        ITensor::makeShape({maxBatchSize}), TRTDataType<tk::FinishedState::UnderlyingType>::value);
+    auto curandStates
+        = manager.gpu(ITensor::makeShape({maxBatchSize, sizeof(curandState_t)}), nvinfer1::DataType::kINT8);
+
+    auto logitsPtr = bufferCast<float>(*logits);
+    auto finishedPtr = reinterpret_cast<tk::FinishedState*>(bufferCast<tk::FinishedState::UnderlyingType>(*finished));
+    auto outputIdsPtr = bufferCast<TokenIdType>(*outputIds);
+    auto batchSlotsPtr = bufferCast<SizeType32>(*batchSlots);
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> logitDist(-3.f, 3.f);
+    std::uniform_int_distribution<TokenIdType> tokenDist(0, vocabSize - 1);
+    for (SizeType32 bi = 0; bi < maxBatchSize; ++bi)
+    {
+        bufferCast<TokenIdType*>(*outputIdsPtrs)[bi] = outputIdsPtr + bi * maxSeqLen;
+        bufferCast<float>(*temperatures)[bi] = 0.7f;
+        bufferCast<float>(*repetitionPenalties)[bi] = 1.0f;
+        bufferCast<SizeType32>(*minLengths)[bi] = 0;
+        bufferCast<SizeType32>(*inputLengths)[bi] = inputLen;
+        bufferCast<SizeType32>(*sequenceLengths)[bi] = inputLen;
+        bufferCast<TokenIdType>(*endIds)[bi] = vocabSize - 1;
+        finishedPtr[bi] = tk::FinishedState::empty();
+    }
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        batchSlotsPtr[bi] = 2 * bi;
+        bufferCast<float*>(*logitsPtrs)[bi] = logitsPtr + bi * vocabSizePadded;
+        for (SizeType32 vi = 0; vi < vocabSize; ++vi)
+        {
+            logitsPtr[bi * vocabSizePadded + vi] = logitDist(gen);
+        }
+        for (SizeType32 ti = 0; ti < inputLen; ++ti)
+        {
+            outputIdsPtr[batchSlotsPtr[bi] * maxSeqLen + ti] = tokenDist(gen);
+        }
+    }
+    // The best token of request 1 is in its prompt and penalized away
+    auto const promptToken = outputIdsPtr[batchSlotsPtr[1] * maxSeqLen];
+    logitsPtr[1 * vocabSizePadded + promptToken] = 4.f;
+    bufferCast<float>(*repetitionPenalties)[batchSlotsPtr[1]] = 10.f;
+    // The best token of request 2 is its end id, masked by the min length
+    logitsPtr[2 * vocabSizePadded + vocabSize - 1] = 4.f;
+    bufferCast<SizeType32>(*minLengths)[batchSlotsPtr[2]] = 1;
+
+    std::vector<TokenIdType> expectedIds(batchSize);
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const slot = batchSlotsPtr[bi];
+        auto const* prompt = outputIdsPtr + slot * maxSeqLen;
+        float bestLogit{-FLT_MAX};
+        for (SizeType32 vi = 0; vi < vocabSize; ++vi)
+        {
+            auto logit = logitsPtr[bi * vocabSizePadded + vi] * (1.0f / (0.7f + 1e-6f));
+            if (std::find(prompt, prompt + inputLen, vi) != prompt + inputLen)
+            {
+                auto const penalty = bufferCast<float>(*repetitionPenalties)[slot];
+                logit = logit < 0.0f ? logit * penalty : logit / penalty;
+            }
+            if (vi == vocabSize - 1 && bufferCast<SizeType32>(*minLengths)[slot] > 0)
+            {
+                continue;
+            }
+            if (logit > bestLogit)
+            {
+                bestLogit = logit;
+                expectedIds[bi] = vi;
+            }
+        }
+    }
+    EXPECT_NE(expectedIds[1], promptToken);
+    EXPECT_NE(expectedIds[2], vocabSize - 1);
+
+    auto const curandStatesPtr = reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*curandStates));
+    tk::invokeCurandInitialize(curandStatesPtr, batchSlotsPtr, batchSize, 0, stream->get());
+    SizeType32 constexpr maxTopK{1};
+    auto workspace = manager.gpu(tk::getFusedPenaltyTopKWorkspaceSize(batchSize, maxTopK, vocabSize));
+
+    tk::FusedPenaltyTopKSamplingParams<float> params;
+    params.logitsPtrs = bufferCast<float*>(*logitsPtrs);
+    params.penaltyWorkspace = bufferCast<TokenIdType>(*penaltyWorkspace);
+    params.temperatures = bufferCast<float>(*temperatures);
+    params.repetitionPenalties = bufferCast<float>(*repetitionPenalties);
+    params.minLengths = bufferCast<SizeType32>(*minLengths);
+    params.inputLengths = bufferCast<SizeType32>(*inputLengths);
+    params.outputIdsPtrs = bufferCast<TokenIdType*>(*outputIdsPtrs);
+    params.sequenceLengths = bufferCast<SizeType32>(*sequenceLengths);
+    params.endIds = bufferCast<TokenIdType>(*endIds);
+    params.batchSlots = batchSlotsPtr;
+    params.finishedInput = finishedPtr;
+    params.finishedOutput = finishedPtr;
+    params.curandState = curandStatesPtr;
+    params.maxTopK = maxTopK;
+    params.workspace = workspace->data();
+    params.batchSize = batchSize;
+    params.maxBatchSize = maxBatchSize;
+    params.maxSeqLen = maxSeqLen;
+    params.vocabSize = vocabSize;
+    params.vocabSizePadded = vocabSizePadded;
+    tk::invokeBatchFusedPenaltyTopKSampling(params, stream->get());
+    stream->synchronize();
+
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const slot = batchSlotsPtr[bi];
+        EXPECT_EQ(outputIdsPtr[slot * maxSeqLen + inputLen], expectedIds[bi]) << "request " << bi;
+        EXPECT_EQ(bufferCast<SizeType32>(*sequenceLengths)[slot], inputLen + 1);
+    }
+}
+
+} // namespace
@@ -680,6 +680,24 @@ public:
         bool passed = checkResult(param.toString(), bufferCast<T>(*logitsOutHost), bufferCast<T>(*mLogitsRefHost),
             mBatchSize * mMaxTokensPerStep * mVocabSizePadded);
         EXPECT_TRUE(passed);
+
+        // Occurrences counted per batch slot give the same result
+        auto slotPenaltyWorkspace
+            = mBufferManager->gpu(ITensor::makeShape({mMaxBatchSize, mVocabSize}), nvinfer1::DataType::kINT32);
+        auto penaltyCountedLengths
+            = mBufferManager->gpu(ITensor::makeShape({mMaxBatchSize}), nvinfer1::DataType::kINT32);
+        tk::invokeResetPenaltyCountedLengths(
+            bufferCast<int32_t>(*penaltyCountedLengths), nullptr, mMaxBatchSize, mStream->get());
+        trk::invokeFill(*mOutLogitsDevice, T{0.0f}, *mStream);
+        penaltyParams.penaltyWorkspace = bufferCast<int32_t>(*slotPenaltyWorkspace);
+        penaltyParams.penaltyCountedLengths = bufferCast<int32_t>(*penaltyCountedLengths);
+        tk::invokeBatchApplyPenalty(penaltyParams);
+        logitsOutHost = mBufferManager->copyFrom(*mOutLogitsDevice, MemoryType::kCPU);
+        mStream->synchronize();
+
+        passed = checkResult(param.toString(), bufferCast<T>(*logitsOutHost), bufferCast<T>(*mLogitsRefHost),
+            mBatchSize * mMaxTokensPerStep * mVocabSizePadded);
+        EXPECT_TRUE(passed);
     }
 };
 
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/kernels/samplingProbsTruncationKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+//! Reference truncation, the typical set is computed by sorting the tokens by their deviation from the entropy
+std::vector<float> truncateProbsReference(std::vector<float> const& probs, float minP, float typicalP, float eta)
+{
+    auto const vocabSize = static_cast<SizeType32>(probs.size());
+    auto const maxProb = *std::max_element(probs.begin(), probs.end());
+    double entropy{0};
+    for (auto const prob : probs)
+    {
+        entropy -= prob > 0.f ? prob * std::log(prob) : 0.f;
+    }
+
+    auto probThreshold = minP * maxProb;
+    if (eta > 0.f)
+    {
+        probThreshold = std::max(probThreshold, std::min(eta, std::sqrt(eta) * static_cast<float>(std::exp(-entropy))));
+    }
+    probThreshold = std::min(probThreshold, maxProb);
+
+    std::vector<bool> typical(vocabSize, true);
+    if (typicalP < 1.f)
+    {
+        std::vector<SizeType32> order(vocabSize);
+        std::iota(order.begin(), order.end(), 0);
+        auto const deviation = [&](SizeType32 vi) { return std::abs(-std::log(probs[vi]) - entropy); };
+        std::sort(order.begin(), order.end(), [&](SizeType32 a, SizeType32 b) { return deviation(a) < deviation(b); });
+        std::fill(typical.begin(), typical.end(), false);
+        float mass{0.f};
+        for (auto const vi : order)
+        {
+            typical[vi] = true;
+            mass += probs[vi];
+            if (mass >= typicalP)
+            {
+                break;
+            }
+        }
+    }
+
+    std::vector<float> truncated(vocabSize, 0.f);
+    float keptMass{0.f};
+    for (SizeType32 vi = 0; vi < vocabSize; ++vi)
+    {
+        if (probs[vi] >= probThreshold && typical[vi])
+        {
+            truncated[vi] = probs[vi];
+            keptMass += probs[vi];
+        }
+    }
+    for (auto& prob : truncated)
+    {
+        prob /= keptMass;
+    }
+    return truncated;
+}
+
+TEST(SamplingProbsTruncationTest, matchesReference)
+{
+    SizeType32 constexpr batchSize{4};
+    SizeType32 constexpr maxBatchSize{2 * batchSize};
+    SizeType32 constexpr vocabSize{1000};
+    SizeType32 constexpr vocabSizePadded{1024};
+
+    auto stream = std::make_shared<CudaStream>();
+
+    auto probs = BufferManager::pinned(ITensor::makeShape({batchSize, vocabSizePadded}), nvinfer1::DataType::kFLOAT);
+    auto minPs = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kFLOAT);
+    auto typicalPs = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kFLOAT);
+    auto etaCutoffs = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kFLOAT);
+    auto batchSlots = BufferManager::pinned(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+
+    // Requests use min-p, typical-p, eta and none of them, co-batched in one launch
+    std::vector<float> const requestMinPs{0.1f, 0.f, 0.f, 0.f};
+    std::vector<float> const requestTypicalPs{1.f, 0.6f, 1.f, 1.f};
+    std::vector<float> const requestEtaCutoffs{0.f, 0.f, 3e-3f, 0.f};
+
+    auto probsPtr = bufferCast<float>(*probs);
+    auto batchSlotsPtr = bufferCast<SizeType32>(*batchSlots);
+    std::mt19937 gen(42);
+    std::normal_distribution<float> logitDist(0.f, 2.f);
+    std::vector<std::vector<float>> expectedProbs;
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const slot = 2 * bi + 1;
+        batchSlotsPtr[bi] = slot;
+        bufferCast<float>(*minPs)[slot] = requestMinPs[bi];
+        bufferCast<float>(*typicalPs)[slot] = requestTypicalPs[bi];
+        bufferCast<float>(*etaCutoffs)[slot] = requestEtaCutoffs[bi];
+
+        std::vector<float> requestProbs(vocabSize);
+        std::generate(requestProbs.begin(), requestProbs.end(), [&]() { return std::exp(logitDist(gen)); });
+        auto const sum = std::accumulate(requestProbs.begin(), requestProbs.end(), 0.f);
+        for (auto& prob : requestProbs)
+        {
+            prob /= sum;
+        }
+        std::copy(requestProbs.begin(), requestProbs.end(), probsPtr + bi * vocabSizePadded);
+        expectedProbs.push_back(truncateProbsReference(
+            requestProbs, requestMinPs[bi], requestTypicalPs[bi], requestEtaCutoffs[bi]));
+    }
+
+    tk::ProbsTruncationKernelParams<float> params;
+    params.probs = probsPtr;
+    params.minPs = bufferCast<float>(*minPs);
+    params.typicalPs = bufferCast<float>(*typicalPs);
+    params.etaCutoffs = bufferCast<float>(*etaCutoffs);
+    params.batchSlots = batchSlotsPtr;
+    params.batchSize = batchSize;
+    params.vocabSize = vocabSize;
+    params.vocabSizePadded = vocabSizePadded;
+    tk::invokeTruncateProbs(params, stream->get());
+    stream->synchronize();
+
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        SizeType32 numKept{0};
+        for (SizeType32 vi = 0; vi < vocabSize; ++vi)
+        {
+            auto const prob = probsPtr[bi * vocabSizePadded + vi];
+            EXPECT_NEAR(prob, expectedProbs[bi][vi], 1e-4f) << "request " << bi << " token " << vi;
+            numKept += prob > 0.f ? 1 : 0;
+        }
+        // Every truncation keeps some but not all tokens, except for the request without it
+        EXPECT_GT(numKept, 0) << "request " << bi;
+        if (bi < batchSize - 1)
+        {
+            EXPECT_LT(numKept, vocabSize) << "request " << bi;
+        }
+        else
+        {
+            EXPECT_EQ(numKept, vocabSize);
+        }
+    }
+}
+
+} // namespace
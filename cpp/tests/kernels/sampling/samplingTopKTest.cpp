@@ -19,6 +19,9 @@
 
 #include "tensorrt_llm/common/tllmException.h"
 #include "tests/kernels/sampling/samplingTest.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <random>
 
 namespace tc = tensorrt_llm::common;
@@ -157,4 +160,179 @@ TYPED_TEST(TopKSamplingKernelTest, CorrectnessLogitsPtrs)
                       .setMaxTokensPerStep(4)
                       .setUseLogitsPtrs());
 };
+
+TEST(TopKSamplingTopLogProbsTest, MatchesLogSoftmaxOfLogits)
+{
+    SizeType32 constexpr batchSize{4};
+    SizeType32 constexpr maxBatchSize{2 * batchSize};
+    SizeType32 constexpr vocabSize{3000};
+    SizeType32 constexpr topK{4};
+    // More alternatives than sampling candidates, the kernel has to widen its selection
+    SizeType32 constexpr numTopLogProbs{8};
+
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager bufferManager(stream);
+
+    auto logits = BufferManager::pinned(ITensor::makeShape({batchSize, vocabSize}), nvinfer1::DataType::kFLOAT);
+    auto outputIds = BufferManager::pinned(ITensor::makeShape({maxBatchSize, 1}), nvinfer1::DataType::kINT32);
+    auto outputIdsPtrs = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT64);
+    auto outputLogProbs = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kFLOAT);
+    auto topLogProbs
+        = BufferManager::pinned(ITensor::makeShape({maxBatchSize, numTopLogProbs}), nvinfer1::DataType::kFLOAT);
+    auto topLogProbIds
+        = BufferManager::pinned(ITensor::makeShape({maxBatchSize, numTopLogProbs}), nvinfer1::DataType::kINT32);
+    auto topKs = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    auto batchSlots = BufferManager::pinned(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+    auto curandStates = bufferManager.gpu(
+        ITensor::makeShape({maxBatchSize, sizeof(curandState_t)}), nvinfer1::DataType::kINT8);
+    auto workspace = bufferManager.gpu(
+        tk::getTopKWorkspaceSize<float>(batchSize, 1, numTopLogProbs, vocabSize), nvinfer1::DataType::kINT8);
+
+    auto logitsPtr = bufferCast<float>(*logits);
+    auto batchSlotsPtr = bufferCast<SizeType32>(*batchSlots);
+    std::mt19937 gen(42);
+    std::normal_distribution<float> logitDist(0.f, 3.f);
+    std::generate(logitsPtr, logitsPtr + batchSize * vocabSize, [&]() { return logitDist(gen); });
+    for (SizeType32 bi = 0; bi < maxBatchSize; ++bi)
+    {
+        reinterpret_cast<TokenIdType**>(bufferCast<int64_t>(*outputIdsPtrs))[bi]
+            = bufferCast<TokenIdType>(*outputIds) + bi;
+        bufferCast<SizeType32>(*topKs)[bi] = topK;
+    }
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        batchSlotsPtr[bi] = 2 * bi + 1;
+    }
+    tk::invokeCurandInitialize(reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*curandStates)), batchSlotsPtr,
+        batchSize, 0, stream->get());
+
+    tk::TopKSamplingKernelParams<float> params;
+    params.logProbs = logitsPtr;
+    params.outputIdsPtrs = reinterpret_cast<TokenIdType**>(bufferCast<int64_t>(*outputIdsPtrs));
+    params.workspace = workspace->data();
+    params.topKs = bufferCast<SizeType32>(*topKs);
+    params.maxTopK = numTopLogProbs;
+    params.batchSlots = batchSlotsPtr;
+    params.outputLogProbs = bufferCast<float>(*outputLogProbs);
+    params.outputTopLogProbs = bufferCast<float>(*topLogProbs);
+    params.outputTopLogProbIds = bufferCast<TokenIdType>(*topLogProbIds);
+    params.numTopLogProbs = numTopLogProbs;
+    params.curandState = reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*curandStates));
+    params.batchSize = batchSize;
+    params.maxBatchSize = maxBatchSize;
+    params.maxTokensPerStep = 1;
+    params.vocabSizePadded = vocabSize;
+    params.logitsHasProbs = false;
+    tk::invokeBatchTopKSampling(params, stream->get());
+    stream->synchronize();
+
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const slot = batchSlotsPtr[bi];
+        auto const* requestLogits = logitsPtr + bi * vocabSize;
+        auto const maxLogit = *std::max_element(requestLogits, requestLogits + vocabSize);
+        double sumExp{0};
+        for (SizeType32 vi = 0; vi < vocabSize; ++vi)
+        {
+            sumExp += std::exp(requestLogits[vi] - maxLogit);
+        }
+        auto const logSumExp = static_cast<float>(maxLogit + std::log(sumExp));
+
+        std::vector<SizeType32> order(vocabSize);
+        std::iota(order.begin(), order.end(), 0);
+        std::partial_sort(order.begin(), order.begin() + numTopLogProbs, order.end(),
+            [&](SizeType32 a, SizeType32 b) { return requestLogits[a] > requestLogits[b]; });
+        for (SizeType32 ni = 0; ni < numTopLogProbs; ++ni)
+        {
+            auto const idx = slot * numTopLogProbs + ni;
+            EXPECT_EQ(bufferCast<TokenIdType>(*topLogProbIds)[idx], order[ni]) << "request " << bi << " rank " << ni;
+            EXPECT_NEAR(bufferCast<float>(*topLogProbs)[idx], requestLogits[order[ni]] - logSumExp, 1e-4f)
+                << "request " << bi << " rank " << ni;
+        }
+
+        // The sampled token is among the top-K and its log prob is relative to the whole vocab
+        auto const outputId = bufferCast<TokenIdType>(*outputIds)[slot];
+        EXPECT_NE(std::find(order.begin(), order.begin() + topK, outputId), order.begin() + topK);
+        EXPECT_NEAR(bufferCast<float>(*outputLogProbs)[slot], requestLogits[outputId] - logSumExp, 1e-4f);
+    }
+};
+
+TEST(TopKSamplingPhiloxTest, SamplesDoNotDependOnBatchComposition)
+{
+    SizeType32 constexpr batchSize{8};
+    SizeType32 constexpr maxBatchSize{2 * batchSize};
+    SizeType32 constexpr vocabSize{64};
+    SizeType32 constexpr maxSeqLen{4};
+    SizeType32 constexpr numSeeds{4};
+
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager bufferManager(stream);
+
+    auto logits = BufferManager::pinned(ITensor::makeShape({batchSize, vocabSize}), nvinfer1::DataType::kFLOAT);
+    auto outputIds = BufferManager::pinned(ITensor::makeShape({maxBatchSize, maxSeqLen}), nvinfer1::DataType::kINT32);
+    auto outputIdsPtrs = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT64);
+    auto sequenceLengths = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    auto endIds = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    auto randomSeeds = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT64);
+    auto batchSlots = BufferManager::pinned(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+    auto workspace = bufferManager.gpu(
+        tk::getTopKWorkspaceSize<float>(batchSize, 1, vocabSize, vocabSize), nvinfer1::DataType::kINT8);
+
+    // All requests see the same uniform logits, a request is identified by its seed only
+    std::fill(bufferCast<float>(*logits), bufferCast<float>(*logits) + batchSize * vocabSize, 0.f);
+    std::fill(bufferCast<TokenIdType>(*endIds), bufferCast<TokenIdType>(*endIds) + maxBatchSize, -1);
+    auto sequenceLengthsPtr = bufferCast<SizeType32>(*sequenceLengths);
+    auto randomSeedsPtr = reinterpret_cast<uint64_t*>(bufferCast<int64_t>(*randomSeeds));
+    auto batchSlotsPtr = bufferCast<SizeType32>(*batchSlots);
+    for (SizeType32 bi = 0; bi < maxBatchSize; ++bi)
+    {
+        reinterpret_cast<TokenIdType**>(bufferCast<int64_t>(*outputIdsPtrs))[bi]
+            = bufferCast<TokenIdType>(*outputIds) + bi * maxSeqLen;
+    }
+    // The first half of the batch occupies the low slots in order, the second half the high slots in reverse order
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const slot = bi < batchSize / 2 ? bi : maxBatchSize - 1 - (bi - batchSize / 2);
+        batchSlotsPtr[bi] = slot;
+        randomSeedsPtr[slot] = bi % numSeeds;
+        sequenceLengthsPtr[slot] = 0;
+    }
+
+    tk::TopKSamplingKernelParams<float> params;
+    params.logProbs = bufferCast<float>(*logits);
+    params.outputIdsPtrs = reinterpret_cast<TokenIdType**>(bufferCast<int64_t>(*outputIdsPtrs));
+    params.workspace = workspace->data();
+    params.maxTopK = vocabSize;
+    params.sequenceLengths = sequenceLengthsPtr;
+    params.endIds = bufferCast<TokenIdType>(*endIds);
+    params.batchSlots = batchSlotsPtr;
+    params.randomSeeds = randomSeedsPtr;
+    params.batchSize = batchSize;
+    params.maxBatchSize = maxBatchSize;
+    params.maxTokensPerStep = 1;
+    params.maxSeqLen = maxSeqLen;
+    params.vocabSizePadded = vocabSize;
+    for (SizeType32 step = 0; step < maxSeqLen; ++step)
+    {
+        tk::invokeBatchTopKSampling(params, stream->get());
+    }
+    stream->synchronize();
+
+    auto const outputIdsPtr = bufferCast<TokenIdType>(*outputIds);
+    for (SizeType32 bi = numSeeds; bi < batchSize; ++bi)
+    {
+        auto const slot = batchSlotsPtr[bi];
+        auto const refSlot = batchSlotsPtr[bi % numSeeds];
+        EXPECT_EQ(sequenceLengthsPtr[slot], maxSeqLen);
+        for (SizeType32 ti = 0; ti < maxSeqLen; ++ti)
+        {
+            EXPECT_EQ(outputIdsPtr[slot * maxSeqLen + ti], outputIdsPtr[refSlot * maxSeqLen + ti])
+                << "request " << bi << " step " << ti;
+        }
+    }
+    // Different seeds give different sequences
+    auto const firstSeq = outputIdsPtr + batchSlotsPtr[0] * maxSeqLen;
+    auto const secondSeq = outputIdsPtr + batchSlotsPtr[1] * maxSeqLen;
+    EXPECT_FALSE(std::equal(firstSeq, firstSeq + maxSeqLen, secondSeq));
+};
 } // end of namespace
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/kernels/samplingVocabParallelKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+TEST(SamplingVocabParallelTest, greedyMatchesFullVocab)
+{
+    SizeType32 constexpr batchSize{3};
+    SizeType32 constexpr maxBatchSize{2 * batchSize};
+    SizeType32 constexpr tpSize{2};
+    // Every shard spans several chunks, with a partial last one
+    SizeType32 constexpr shardVocabSize{5000};
+    SizeType32 constexpr vocabSize{tpSize * shardVocabSize};
+    SizeType32 constexpr maxSeqLen{16};
+    SizeType32 constexpr inputLen{6};
+    SizeType32 constexpr maxTopK{1};
+    auto constexpr summarySize = tk::getVocabShardSummarySize(maxTopK);
+
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager manager{stream};
+
+    auto logits = BufferManager::pinned(ITensor::makeShape({batchSize, vocabSize}), nvinfer1::DataType::kFLOAT);
+    auto summaries
+        = BufferManager::pinned(ITensor::makeShape({tpSize, batchSize, summarySize}), nvinfer1::DataType::kFLOAT);
+    auto outputIds = BufferManager::pinned(ITensor::makeShape({maxBatchSize, maxSeqLen}), nvinfer1::DataType::kINT32);
+    auto outputIdsPtrs = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), TRTDataType<TokenIdType*>::value);
+    auto batchSlots = BufferManager::pinned(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+    auto sequenceLengths = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    auto outputLogProbs
+        = BufferManager::pinned(ITensor::makeShape({maxSeqLen, maxBatchSize}), nvinfer1::DataType::kFLOAT);
+    auto curandStates
+        = manager.gpu(ITensor::makeShape({maxBatchSize, sizeof(curandState_t)}), nvinfer1::DataType::kINT8);
+
+    auto logitsPtr = bufferCast<float>(*logits);
+    auto outputIdsPtr = bufferCast<TokenIdType>(*outputIds);
+    auto batchSlotsPtr = bufferCast<SizeType32>(*batchSlots);
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> logitDist(-3.f, 3.f);
+    for (SizeType32 bi = 0; bi < maxBatchSize; ++bi)
+    {
+        bufferCast<TokenIdType*>(*outputIdsPtrs)[bi] = outputIdsPtr + bi * maxSeqLen;
+        bufferCast<SizeType32>(*sequenceLengths)[bi] = inputLen;
+    }
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        batchSlotsPtr[bi] = 2 * bi;
+        for (SizeType32 vi = 0; vi < vocabSize; ++vi)
+        {
+            logitsPtr[bi * vocabSize + vi] = logitDist(gen);
+        }
+    }
+    // The best tokens are in the first shard, the second shard and at the shard boundary
+    logitsPtr[0 * vocabSize + 17] = 4.f;
+    logitsPtr[1 * vocabSize + shardVocabSize + 4321] = 4.f;
+    logitsPtr[2 * vocabSize + shardVocabSize] = 4.f;
+
+    std::vector<TokenIdType> expectedIds(batchSize);
+    std::vector<float> expectedLogProbs(batchSize);
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const* requestLogits = logitsPtr + bi * vocabSize;
+        auto const maxLogit = *std::max_element(requestLogits, requestLogits + vocabSize);
+        double sumExp{0};
+        for (SizeType32 vi = 0; vi < vocabSize; ++vi)
+        {
+            sumExp += std::exp(requestLogits[vi] - maxLogit);
+            if (requestLogits[vi] == maxLogit)
+            {
+                expectedIds[bi] = vi;
+            }
+        }
+        expectedLogProbs[bi] = static_cast<float>(-std::log(sumExp));
+    }
+
+    auto const curandStatesPtr = reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*curandStates));
+    tk::invokeCurandInitialize(curandStatesPtr, batchSlotsPtr, batchSize, 0, stream->get());
+    auto workspace = manager.gpu(tk::getVocabShardSummaryWorkspaceSize(batchSize, maxTopK, shardVocabSize));
+
+    tk::VocabParallelSamplingParams<float> params;
+    params.shardVocabSize = shardVocabSize;
+    params.shardVocabSizePadded = vocabSize;
+    params.tpSize = tpSize;
+    params.workspace = workspace->data();
+    params.outputIdsPtrs = bufferCast<TokenIdType*>(*outputIdsPtrs);
+    params.sequenceLengths = bufferCast<SizeType32>(*sequenceLengths);
+    params.batchSlots = batchSlotsPtr;
+    params.outputLogProbs = bufferCast<float>(*outputLogProbs);
+    params.curandState = curandStatesPtr;
+    params.maxTopK = maxTopK;
+    params.batchSize = batchSize;
+    params.maxBatchSize = maxBatchSize;
+    params.maxSeqLen = maxSeqLen;
+
+    // Every rank writes its summary to its slice of the all-gathered buffer
+    for (SizeType32 rank = 0; rank < tpSize; ++rank)
+    {
+        params.logitsShard = logitsPtr + rank * shardVocabSize;
+        params.shardVocabOffset = rank * shardVocabSize;
+        params.shardSummary = bufferCast<float>(*summaries) + rank * batchSize * summarySize;
+        tk::invokeVocabShardSummary(params, stream->get());
+    }
+    params.gatheredSummaries = bufferCast<float>(*summaries);
+    tk::invokeVocabParallelSampling(params, stream->get());
+    stream->synchronize();
+
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const slot = batchSlotsPtr[bi];
+        EXPECT_EQ(outputIdsPtr[slot * maxSeqLen + inputLen], expectedIds[bi]) << "request " << bi;
+        EXPECT_NEAR(bufferCast<float>(*outputLogProbs)[inputLen * maxBatchSize + slot], expectedLogProbs[bi], 1e-3f);
+    }
+}
+
+TEST(SamplingVocabParallelTest, lmHeadSummaryMatchesLogits)
+{
+    SizeType32 constexpr batchSize{3};
+    // Several chunks, with a partial last one
+    SizeType32 constexpr vocabSize{9000};
+    SizeType32 constexpr hiddenSize{72};
+    SizeType32 constexpr maxTopK{4};
+    auto constexpr summarySize = tk::getVocabShardSummarySize(maxTopK);
+
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager manager{stream};
+
+    auto hidden = BufferManager::pinned(ITensor::makeShape({batchSize, hiddenSize}), nvinfer1::DataType::kFLOAT);
+    auto weight = BufferManager::pinned(ITensor::makeShape({vocabSize, hiddenSize}), nvinfer1::DataType::kFLOAT);
+    auto summary = BufferManager::pinned(ITensor::makeShape({batchSize, summarySize}), nvinfer1::DataType::kFLOAT);
+
+    auto hiddenPtr = bufferCast<float>(*hidden);
+    auto weightPtr = bufferCast<float>(*weight);
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    std::generate(hiddenPtr, hiddenPtr + hidden->getSize(), [&]() { return dist(gen); });
+    std::generate(weightPtr, weightPtr + weight->getSize(), [&]() { return dist(gen); });
+
+    auto workspace = manager.gpu(tk::getVocabShardSummaryWorkspaceSize(batchSize, maxTopK, vocabSize));
+
+    tk::VocabParallelSamplingParams<float> params;
+    params.hiddenStates = hiddenPtr;
+    params.lmHeadWeight = weightPtr;
+    params.hiddenSize = hiddenSize;
+    params.shardVocabSize = vocabSize;
+    params.shardVocabSizePadded = vocabSize;
+    params.shardSummary = bufferCast<float>(*summary);
+    params.workspace = workspace->data();
+    params.maxTopK = maxTopK;
+    params.batchSize = batchSize;
+    params.maxBatchSize = batchSize;
+    tk::invokeLmHeadShardSummary(params, stream->get());
+    stream->synchronize();
+
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        std::vector<float> logits(vocabSize);
+        for (SizeType32 vi = 0; vi < vocabSize; ++vi)
+        {
+            double acc{0};
+            for (SizeType32 hi = 0; hi < hiddenSize; ++hi)
+            {
+                acc += static_cast<double>(weightPtr[vi * hiddenSize + hi]) * hiddenPtr[bi * hiddenSize + hi];
+            }
+            logits[vi] = static_cast<float>(acc);
+        }
+        std::vector<SizeType32> order(vocabSize);
+        std::iota(order.begin(), order.end(), 0);
+        std::partial_sort(order.begin(), order.begin() + maxTopK, order.end(),
+            [&](SizeType32 lhs, SizeType32 rhs) { return logits[lhs] > logits[rhs]; });
+        auto const maxLogit = logits[order[0]];
+        double sumExp{0};
+        for (auto const logit : logits)
+        {
+            sumExp += std::exp(logit - maxLogit);
+        }
+
+        auto const* requestSummary = bufferCast<float>(*summary) + bi * summarySize;
+        auto const* summaryIds = reinterpret_cast<SizeType32 const*>(requestSummary + maxTopK);
+        for (SizeType32 ki = 0; ki < maxTopK; ++ki)
+        {
+            EXPECT_EQ(summaryIds[ki], order[ki]) << "request " << bi << " k " << ki;
+            EXPECT_NEAR(requestSummary[ki], logits[order[ki]], 1e-4f) << "request " << bi << " k " << ki;
+        }
+        EXPECT_NEAR(requestSummary[2 * maxTopK], maxLogit, 1e-4f) << "request " << bi;
+        EXPECT_NEAR(requestSummary[2 * maxTopK + 1], sumExp, 1e-3 * sumExp) << "request " << bi;
+    }
+}
+
+} // namespace
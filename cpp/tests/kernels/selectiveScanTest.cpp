@@ -0,0 +1,488 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/selectiveScan.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+using namespace tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+
+auto constexpr kDState = 16;
+auto constexpr kDtRank = 4;
+auto constexpr kDim = 128;
+
+struct ScanInputs
+{
+    std::vector<int> seqLengths;
+    bool removePadding;
+    int maxSeqLen;
+    int numTokens;
+    std::vector<float> x, dt, z, BC, A, D, dtBias;
+    std::vector<int> lastTokenIds;
+};
+
+ScanInputs makeInputs(std::vector<int> const& seqLengths, bool removePadding)
+{
+    ScanInputs in;
+    in.seqLengths = seqLengths;
+    in.removePadding = removePadding;
+    in.maxSeqLen = *std::max_element(seqLengths.begin(), seqLengths.end());
+    in.numTokens = 0;
+    for (auto const length : seqLengths)
+    {
+        in.numTokens += removePadding ? length : in.maxSeqLen;
+        in.lastTokenIds.push_back(removePadding ? in.numTokens : length);
+    }
+    std::mt19937 gen(42);
+    auto fill = [&gen](std::vector<float>& v, std::size_t size, float lo, float hi)
+    {
+        std::uniform_real_distribution<float> dist(lo, hi);
+        v.resize(size);
+        for (auto& e : v)
+        {
+            e = dist(gen);
+        }
+    };
+    fill(in.x, in.numTokens * kDim, -1.F, 1.F);
+    fill(in.dt, in.numTokens * kDim, -2.F, 0.F);
+    fill(in.z, in.numTokens * kDim, -1.F, 1.F);
+    fill(in.BC, in.numTokens * (kDtRank + 2 * kDState), -1.F, 1.F);
+    fill(in.A, kDState * kDim, -1.5F, -0.5F);
+    fill(in.D, kDim, 0.F, 1.F);
+    fill(in.dtBias, kDim, -0.5F, 0.5F);
+    return in;
+}
+
+//! \brief Sequential reference of the scan, returns the outputs and fills the final states.
+std::vector<float> referenceScan(ScanInputs const& in, std::vector<float>& states)
+{
+    std::vector<float> out(in.numTokens * kDim, 0.F);
+    auto const batch = static_cast<int>(in.seqLengths.size());
+    states.assign(batch * kDState * kDim, 0.F);
+    auto const bcCols = kDtRank + 2 * kDState;
+    for (int sample = 0; sample < batch; ++sample)
+    {
+        int const start = in.removePadding ? (sample == 0 ? 0 : in.lastTokenIds[sample - 1]) : sample * in.maxSeqLen;
+        for (int channel = 0; channel < kDim; ++channel)
+        {
+            std::vector<float> h(kDState, 0.F);
+            for (int t = 0; t < in.seqLengths[sample]; ++t)
+            {
+                auto const row = start + t;
+                auto const dtB = in.dt[row * kDim + channel] + in.dtBias[channel];
+                auto const dtSp = dtB <= 20.F ? std::log1p(std::exp(dtB)) : dtB;
+                auto const x = in.x[row * kDim + channel];
+                auto y = x * in.D[channel];
+                for (int i = 0; i < kDState; ++i)
+                {
+                    auto const B = in.BC[row * bcCols + kDtRank + i];
+                    auto const C = in.BC[row * bcCols + kDtRank + kDState + i];
+                    h[i] = h[i] * std::exp(in.A[i * kDim + channel] * dtSp) + B * dtSp * x;
+                    y += h[i] * C;
+                }
+                auto const z = in.z[row * kDim + channel];
+                out[row * kDim + channel] = y * z / (1.F + std::exp(-z));
+            }
+            for (int i = 0; i < kDState; ++i)
+            {
+                states[(sample * kDState + i) * kDim + channel] = h[i];
+            }
+        }
+    }
+    return out;
+}
+
+class SelectiveScanTest : public ::testing::TestWithParam<bool>
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "No GPU";
+        }
+        mStream = std::make_shared<CudaStream>();
+        mManager = std::make_unique<BufferManager>(mStream);
+    }
+
+    //! \brief Runs the context scan on the GPU, chunked if requested, and compares it with the reference.
+    void runAndCompare(ScanInputs const& in, bool chunked)
+    {
+        auto const batch = static_cast<int>(in.seqLengths.size());
+        auto const toDevice = [this](auto const& v) { return mManager->copyFrom(v, MemoryType::kGPU); };
+        auto x = toDevice(in.x);
+        auto dt = toDevice(in.dt);
+        auto z = toDevice(in.z);
+        auto BC = toDevice(in.BC);
+        auto A = toDevice(in.A);
+        auto D = toDevice(in.D);
+        auto dtBias = toDevice(in.dtBias);
+        auto lastTokenIds = toDevice(in.lastTokenIds);
+        auto out = mManager->gpu(ITensor::makeShape({in.numTokens, kDim}), nvinfer1::DataType::kFLOAT);
+        auto states = mManager->gpu(ITensor::makeShape({batch, kDState, kDim}), nvinfer1::DataType::kFLOAT);
+        auto workspace = mManager->gpu(getSelectiveScanWorkspaceSize(batch, in.numTokens, kDim, kDState));
+
+        SSMParamsBase params{};
+        params.batch = batch;
+        params.dim = kDim;
+        params.dstate = kDState;
+        params.dt_rank = kDtRank;
+        params.max_seqlen = in.removePadding ? -1 : in.maxSeqLen;
+        params.remove_padding = in.removePadding;
+        params.is_variable_B = true;
+        params.is_variable_C = true;
+        params.delta_softplus = true;
+        params.A_ptr = A->data();
+        params.BC_ptr = BC->data();
+        params.D_ptr = D->data();
+        params.u_ptr = x->data();
+        params.delta_ptr = dt->data();
+        params.delta_bias_ptr = dtBias->data();
+        params.out_ptr = out->data();
+        params.x_ptr = states->data();
+        params.z_ptr = z->data();
+        params.last_token_ids_ptr = bufferCast<int>(*lastTokenIds);
+        params.slot_mapping_ptr = nullptr;
+        if (chunked)
+        {
+            params.chunk_states_ptr = workspace->data();
+            params.max_chunks
+                = ((in.removePadding ? in.numTokens : in.maxSeqLen) + kSelectiveScanChunkSize - 1)
+                / kSelectiveScanChunkSize;
+        }
+        invokeSelectiveScan<float, float>(params, mStream->get());
+
+        std::vector<float> outHost(in.numTokens * kDim);
+        std::vector<float> statesHost(batch * kDState * kDim);
+        mManager->copy(*out, outHost.data());
+        mManager->copy(*states, statesHost.data());
+        mStream->synchronize();
+        TLLM_CUDA_CHECK(cudaGetLastError());
+
+        std::vector<float> refStates;
+        auto const refOut = referenceScan(in, refStates);
+        for (int sample = 0; sample < batch; ++sample)
+        {
+            int const start
+                = in.removePadding ? (sample == 0 ? 0 : in.lastTokenIds[sample - 1]) : sample * in.maxSeqLen;
+            for (int i = start * kDim; i < (start + in.seqLengths[sample]) * kDim; ++i)
+            {
+                ASSERT_NEAR(outHost[i], refOut[i], 1e-3F * (1.F + std::abs(refOut[i]))) << "token element " << i;
+            }
+        }
+        for (std::size_t i = 0; i < refStates.size(); ++i)
+        {
+            ASSERT_NEAR(statesHost[i], refStates[i], 1e-3F * (1.F + std::abs(refStates[i]))) << "state " << i;
+        }
+    }
+
+    BufferManager::CudaStreamPtr mStream;
+    std::unique_ptr<BufferManager> mManager;
+};
+
+} // namespace
+
+TEST_P(SelectiveScanTest, Sequential)
+{
+    runAndCompare(makeInputs({300, 1, 77}, GetParam()), false);
+}
+
+TEST_P(SelectiveScanTest, Chunked)
+{
+    // Lengths below, at and above multiples of the chunk size
+    auto const chunk = kSelectiveScanChunkSize;
+    runAndCompare(makeInputs({4 * chunk + 3, chunk, 1}, GetParam()), true);
+}
+
+TEST_P(SelectiveScanTest, ChunkedLongSequence)
+{
+    runAndCompare(makeInputs({8192}, GetParam()), true);
+}
+
+INSTANTIATE_TEST_SUITE_P(SelectiveScan, SelectiveScanTest, ::testing::Bool(),
+    [](::testing::TestParamInfo<bool> const& info) { return info.param ? "Packed" : "Padded"; });
+
+TEST(SelectiveScanUpdateTest, FusedConv1dMatchesSeparateKernels)
+{
+    if (tc::getDeviceCount() == 0)
+    {
+        GTEST_SKIP() << "No GPU";
+    }
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager manager(stream);
+    auto constexpr batch = 3;
+    auto constexpr dConv = 4;
+
+    std::mt19937 gen(7);
+    auto random = [&gen](std::size_t size, float lo, float hi)
+    {
+        std::uniform_real_distribution<float> dist(lo, hi);
+        std::vector<float> v(size);
+        for (auto& e : v)
+        {
+            e = dist(gen);
+        }
+        return v;
+    };
+    auto const xIn = random(batch * kDim, -1.F, 1.F);
+    auto const convState = random(batch * (dConv - 1) * kDim, -1.F, 1.F);
+    auto const ssmState = random(batch * kDState * kDim, -1.F, 1.F);
+
+    auto runLayer = [&](bool fused)
+    {
+        auto const toDevice = [&manager](auto const& v) { return manager.copyFrom(v, MemoryType::kGPU); };
+        // Same weights for both runs
+        gen.seed(11);
+        auto x = toDevice(xIn);
+        auto convStates = toDevice(convState);
+        auto ssmStates = toDevice(ssmState);
+        auto convWeight = toDevice(random(dConv * kDim, -0.5F, 0.5F));
+        auto convBias = toDevice(random(kDim, -0.5F, 0.5F));
+        auto dt = toDevice(random(batch * kDim, -2.F, 0.F));
+        auto z = toDevice(random(batch * kDim, -1.F, 1.F));
+        auto BC = toDevice(random(batch * (kDtRank + 2 * kDState), -1.F, 1.F));
+        auto A = toDevice(random(kDState * kDim, -1.5F, -0.5F));
+        auto D = toDevice(random(kDim, 0.F, 1.F));
+        auto dtBias = toDevice(random(kDim, -0.5F, 0.5F));
+        auto convOut = manager.gpu(ITensor::makeShape({batch, kDim}), nvinfer1::DataType::kFLOAT);
+        auto out = manager.gpu(ITensor::makeShape({batch, kDim}), nvinfer1::DataType::kFLOAT);
+
+        MambaConv1dParamsBase convParams{};
+        convParams.batch = batch;
+        convParams.dim = kDim;
+        convParams.max_seqlen = 1;
+        convParams.dconv = dConv;
+        convParams.apply_silu = true;
+        convParams.in_ptr = x->data();
+        convParams.state_in_ptr = convStates->data();
+        convParams.state_out_ptr = convStates->data();
+        convParams.weight_ptr = convWeight->data();
+        convParams.bias_ptr = convBias->data();
+        convParams.out_ptr = convOut->data();
+
+        SSMParamsBase params{};
+        params.batch = batch;
+        params.dim = kDim;
+        params.dstate = kDState;
+        params.dt_rank = kDtRank;
+        params.is_variable_B = true;
+        params.is_variable_C = true;
+        params.delta_softplus = true;
+        params.A_ptr = A->data();
+        params.BC_ptr = BC->data();
+        params.D_ptr = D->data();
+        params.u_ptr = convOut->data();
+        params.delta_ptr = dt->data();
+        params.delta_bias_ptr = dtBias->data();
+        params.out_ptr = out->data();
+        params.x_ptr = ssmStates->data();
+        params.z_ptr = z->data();
+
+        if (fused)
+        {
+            invokeMambaConv1dSelectiveScanUpdate<float, float>(convParams, params, stream->get());
+        }
+        else
+        {
+            invokeMambaConv1dGeneration<float>(convParams, stream->get());
+            invokeSelectiveScanUpdate<float, float>(params, stream->get());
+        }
+        std::vector<std::vector<float>> results(4);
+        results[0].resize(out->getSize());
+        results[1].resize(convOut->getSize());
+        results[2].resize(convStates->getSize());
+        results[3].resize(ssmStates->getSize());
+        manager.copy(*out, results[0].data());
+        manager.copy(*convOut, results[1].data());
+        manager.copy(*convStates, results[2].data());
+        manager.copy(*ssmStates, results[3].data());
+        stream->synchronize();
+        TLLM_CUDA_CHECK(cudaGetLastError());
+        return results;
+    };
+
+    auto const expected = runLayer(false);
+    auto const actual = runLayer(true);
+    for (std::size_t t = 0; t < expected.size(); ++t)
+    {
+        for (std::size_t i = 0; i < expected[t].size(); ++i)
+        {
+            ASSERT_NEAR(actual[t][i], expected[t][i], 1e-4F * (1.F + std::abs(expected[t][i])))
+                << "tensor " << t << " element " << i;
+        }
+    }
+}
+
+TEST(SelectiveScanUpdateTest, SpecTokenCheckpointsMatchSingleSteps)
+{
+    if (tc::getDeviceCount() == 0)
+    {
+        GTEST_SKIP() << "No GPU";
+    }
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager manager(stream);
+    auto constexpr batch = 2;
+    auto constexpr dConv = 4;
+    auto constexpr numSpecTokens = 3;
+    auto constexpr numRows = batch * numSpecTokens;
+
+    std::mt19937 gen(5);
+    auto random = [&gen](std::size_t size, float lo, float hi)
+    {
+        std::uniform_real_distribution<float> dist(lo, hi);
+        std::vector<float> v(size);
+        for (auto& e : v)
+        {
+            e = dist(gen);
+        }
+        return v;
+    };
+    auto const toDevice = [&manager](auto const& v) { return manager.copyFrom(v, MemoryType::kGPU); };
+    auto const toHost = [&manager, &stream](ITensor const& t)
+    {
+        std::vector<float> v(t.getSize());
+        manager.copy(t, v.data());
+        stream->synchronize();
+        return v;
+    };
+
+    // Inputs of all tokens, row sample * numSpecTokens + t
+    auto x = toDevice(random(numRows * kDim, -1.F, 1.F));
+    auto dt = toDevice(random(numRows * kDim, -2.F, 0.F));
+    auto z = toDevice(random(numRows * kDim, -1.F, 1.F));
+    auto BC = toDevice(random(numRows * (kDtRank + 2 * kDState), -1.F, 1.F));
+    auto convWeight = toDevice(random(dConv * kDim, -0.5F, 0.5F));
+    auto convBias = toDevice(random(kDim, -0.5F, 0.5F));
+    auto A = toDevice(random(kDState * kDim, -1.5F, -0.5F));
+    auto D = toDevice(random(kDim, 0.F, 1.F));
+    auto dtBias = toDevice(random(kDim, -0.5F, 0.5F));
+    auto const convStateInit = random(batch * (dConv - 1) * kDim, -1.F, 1.F);
+    auto const ssmStateInit = random(batch * kDState * kDim, -1.F, 1.F);
+
+    auto convStates = toDevice(convStateInit);
+    auto ssmStates = toDevice(ssmStateInit);
+    auto convOut = manager.gpu(ITensor::makeShape({numRows, kDim}), nvinfer1::DataType::kFLOAT);
+    auto out = manager.gpu(ITensor::makeShape({numRows, kDim}), nvinfer1::DataType::kFLOAT);
+    auto convCheckpoints
+        = manager.gpu(ITensor::makeShape({batch, numSpecTokens, dConv - 1, kDim}), nvinfer1::DataType::kFLOAT);
+    auto ssmCheckpoints
+        = manager.gpu(ITensor::makeShape({batch, numSpecTokens, kDState, kDim}), nvinfer1::DataType::kFLOAT);
+
+    MambaConv1dParamsBase convParams{};
+    convParams.batch = batch;
+    convParams.dim = kDim;
+    convParams.dconv = dConv;
+    convParams.apply_silu = true;
+    convParams.weight_ptr = convWeight->data();
+    convParams.bias_ptr = convBias->data();
+
+    SSMParamsBase params{};
+    params.batch = batch;
+    params.dim = kDim;
+    params.dstate = kDState;
+    params.dt_rank = kDtRank;
+    params.is_variable_B = true;
+    params.is_variable_C = true;
+    params.delta_softplus = true;
+    params.A_ptr = A->data();
+    params.D_ptr = D->data();
+    params.delta_bias_ptr = dtBias->data();
+
+    // All tokens in one step with checkpoints
+    convParams.in_ptr = x->data();
+    convParams.state_in_ptr = convStates->data();
+    convParams.state_out_ptr = convStates->data();
+    convParams.out_ptr = convOut->data();
+    convParams.state_checkpoints_ptr = convCheckpoints->data();
+    convParams.num_spec_tokens = numSpecTokens;
+    invokeMambaConv1dGeneration<float>(convParams, stream->get());
+    params.u_ptr = convOut->data();
+    params.delta_ptr = dt->data();
+    params.z_ptr = z->data();
+    params.BC_ptr = BC->data();
+    params.out_ptr = out->data();
+    params.x_ptr = ssmStates->data();
+    params.state_checkpoints_ptr = ssmCheckpoints->data();
+    params.num_spec_tokens = numSpecTokens;
+    invokeSelectiveScanUpdate<float, float>(params, stream->get());
+
+    auto const outHost = toHost(*out);
+    auto const convCheckpointsHost = toHost(*convCheckpoints);
+    auto const ssmCheckpointsHost = toHost(*ssmCheckpoints);
+    // The cached states are left unchanged
+    EXPECT_EQ(toHost(*convStates), convStateInit);
+    EXPECT_EQ(toHost(*ssmStates), ssmStateInit);
+
+    // One token at a time, each sample separately so that its rows are contiguous
+    convParams.state_checkpoints_ptr = nullptr;
+    params.state_checkpoints_ptr = nullptr;
+    convParams.batch = 1;
+    params.batch = 1;
+    for (int sample = 0; sample < batch; ++sample)
+    {
+        auto convState = ITensor::slice(convStates, sample, 1);
+        auto ssmState = ITensor::slice(ssmStates, sample, 1);
+        for (int t = 0; t < numSpecTokens; ++t)
+        {
+            auto const row = sample * numSpecTokens + t;
+            auto stepOut = manager.gpu(ITensor::makeShape({1, kDim}), nvinfer1::DataType::kFLOAT);
+            auto stepConvOut = manager.gpu(ITensor::makeShape({1, kDim}), nvinfer1::DataType::kFLOAT);
+            convParams.in_ptr = ITensor::slice(x, row * kDim, kDim)->data();
+            convParams.state_in_ptr = convState->data();
+            convParams.state_out_ptr = convState->data();
+            convParams.out_ptr = stepConvOut->data();
+            invokeMambaConv1dGeneration<float>(convParams, stream->get());
+            params.u_ptr = stepConvOut->data();
+            params.delta_ptr = ITensor::slice(dt, row * kDim, kDim)->data();
+            params.z_ptr = ITensor::slice(z, row * kDim, kDim)->data();
+            auto const bcCols = kDtRank + 2 * kDState;
+            params.BC_ptr = ITensor::slice(BC, row * bcCols, bcCols)->data();
+            params.out_ptr = stepOut->data();
+            params.x_ptr = ssmState->data();
+            invokeSelectiveScanUpdate<float, float>(params, stream->get());
+
+            auto const expectedOut = toHost(*stepOut);
+            auto const expectedConv = toHost(*convState);
+            auto const expectedSsm = toHost(*ssmState);
+            for (int i = 0; i < kDim; ++i)
+            {
+                ASSERT_NEAR(outHost[row * kDim + i], expectedOut[i], 1e-4F * (1.F + std::abs(expectedOut[i])));
+            }
+            for (std::size_t i = 0; i < expectedConv.size(); ++i)
+            {
+                ASSERT_EQ(convCheckpointsHost[row * expectedConv.size() + i], expectedConv[i]);
+            }
+            for (std::size_t i = 0; i < expectedSsm.size(); ++i)
+            {
+                ASSERT_NEAR(ssmCheckpointsHost[row * expectedSsm.size() + i], expectedSsm[i],
+                    1e-4F * (1.F + std::abs(expectedSsm[i])));
+            }
+        }
+    }
+}
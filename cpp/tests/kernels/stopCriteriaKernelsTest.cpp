@@ -621,4 +621,34 @@ TEST_F(StopCriteriaKernelsTest, explicitEOSCriteria)
     }
 }
 
+TEST_F(StopCriteriaKernelsTest, allFinishedCriteria)
+{
+    SizeType32 constexpr batchSize = 300;
+    SizeType32 constexpr beamWidth = 2;
+    auto finishedSum = BufferManager::pinned(ITensor::makeShape({2 * batchSize}), nvinfer1::DataType::kINT32);
+    auto batchSlots = BufferManager::pinned(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+    auto allFinished = BufferManager::pinned(ITensor::makeShape({1}), nvinfer1::DataType::kBOOL);
+    auto finishedSumPtr = bufferCast<SizeType32>(*finishedSum);
+    auto batchSlotsPtr = bufferCast<SizeType32>(*batchSlots);
+    auto allFinishedPtr = bufferCast<bool>(*allFinished);
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        batchSlotsPtr[bi] = 2 * bi;
+        finishedSumPtr[2 * bi] = beamWidth;
+        // Unused slots are not summed
+        finishedSumPtr[2 * bi + 1] = 1;
+    }
+
+    tk::invokeAllFinished(
+        allFinishedPtr, finishedSumPtr, batchSlotsPtr, batchSize, batchSize * beamWidth, mStream->get());
+    mStream->synchronize();
+    EXPECT_TRUE(allFinishedPtr[0]);
+
+    finishedSumPtr[2 * (batchSize - 1)] = beamWidth - 1;
+    tk::invokeAllFinished(
+        allFinishedPtr, finishedSumPtr, batchSlotsPtr, batchSize, batchSize * beamWidth, mStream->get());
+    mStream->synchronize();
+    EXPECT_FALSE(allFinishedPtr[0]);
+}
+
 } // end of namespace
@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/tokenMaskAutomaton.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cuda_fp16.h>
+#include <random>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+namespace trk = tensorrt_llm::runtime::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+//! \brief Host reference of the automaton state of one batch slot.
+struct ReferenceAutomaton
+{
+    std::vector<SizeType32> const* transitions{nullptr};
+    SizeType32 state{0};
+    SizeType32 consumedLength{-1};
+
+    void reset()
+    {
+        state = 0;
+        consumedLength = -1;
+    }
+
+    void advance(std::vector<TokenIdType> const& outputIds, SizeType32 sequenceLength, SizeType32 vocabSize)
+    {
+        if (consumedLength >= 0)
+        {
+            for (auto pos = consumedLength; pos < sequenceLength && state >= 0; ++pos)
+            {
+                auto const token = outputIds[pos];
+                state = (0 <= token && token < vocabSize) ? (*transitions)[state * vocabSize + token] : -1;
+            }
+        }
+        consumedLength = sequenceLength;
+    }
+
+    [[nodiscard]] bool isAllowed(TokenIdType token, TokenIdType endId, SizeType32 vocabSize) const
+    {
+        return state >= 0 ? token < vocabSize && (*transitions)[state * vocabSize + token] >= 0 : token == endId;
+    }
+};
+
+template <typename T>
+class TokenMaskAutomatonTest : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    void TearDown() override {}
+
+    void initData(SizeType32 batchSize, std::mt19937& gen)
+    {
+        auto const maxBatchSize = 2 * batchSize;
+        auto const ptrType = TRTDataType<void*>::value;
+
+        mBatchSlots = BufferManager::pinned(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+        auto* batchSlotsPtr = bufferCast<SizeType32>(*mBatchSlots);
+        for (SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            batchSlotsPtr[bi] = 2 * bi + 1;
+        }
+
+        mLogits = BufferManager::pinned(ITensor::makeShape({batchSize, kVocabSizePadded}), TRTDataType<T>::value);
+        mStates = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+        mConsumedLengths = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+        mSequenceLengths = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+        mEndIds = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+        mOutputIds = BufferManager::pinned(ITensor::makeShape({maxBatchSize, kMaxSeqLen}), nvinfer1::DataType::kINT32);
+        mOutputIdsPtr = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), ptrType);
+        mAutomatonPtrs = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), ptrType);
+        trk::invokeFill(*mOutputIds, TokenIdType{0}, *mStream);
+        trk::invokeFill(*mStates, SizeType32{-2}, *mStream);
+        trk::invokeFill(*mConsumedLengths, SizeType32{-2}, *mStream);
+        mStream->synchronize();
+
+        // Random tables, where about a third of the transitions is banned
+        std::uniform_int_distribution<SizeType32> stateDist(0, kNumStates - 1);
+        std::bernoulli_distribution bannedDist(0.35);
+        mTransitions.assign(batchSize, {});
+        mTables.clear();
+        for (SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            auto& transitions = mTransitions[bi];
+            transitions.resize(kNumStates * kVocabSize);
+            for (auto& next : transitions)
+            {
+                next = bannedDist(gen) ? -1 : stateDist(gen);
+            }
+            // Keep at least one allowed token per state
+            for (SizeType32 state = 0; state < kNumStates; ++state)
+            {
+                transitions[state * kVocabSize + 1 + state] = (state + 1) % kNumStates;
+            }
+            auto table
+                = BufferManager::pinned(ITensor::makeShape({kNumStates, kVocabSize}), nvinfer1::DataType::kINT32);
+            std::copy(transitions.begin(), transitions.end(), bufferCast<SizeType32>(*table));
+            mTables.push_back(std::move(table));
+        }
+
+        auto automatonPtrs = BufferRange<void*>(*mAutomatonPtrs);
+        auto outputIdsPtr = BufferRange<void*>(*mOutputIdsPtr);
+        auto* outputIds = bufferCast<TokenIdType>(*mOutputIds);
+        auto* sequenceLengths = bufferCast<SizeType32>(*mSequenceLengths);
+        auto* endIds = bufferCast<TokenIdType>(*mEndIds);
+        for (SizeType32 slot = 0; slot < maxBatchSize; ++slot)
+        {
+            automatonPtrs[slot] = nullptr;
+            outputIdsPtr[slot] = outputIds + slot * kMaxSeqLen;
+            sequenceLengths[slot] = 0;
+            endIds[slot] = kEndId;
+        }
+
+        mReferences.assign(batchSize, {});
+        mHostOutputIds.assign(batchSize, std::vector<TokenIdType>(kMaxSeqLen, 0));
+        std::uniform_int_distribution<TokenIdType> tokenDist(0, kVocabSize - 1);
+        for (SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            auto const slot = batchSlotsPtr[bi];
+            // The last request is unconstrained
+            if (bi < batchSize - 1)
+            {
+                automatonPtrs[slot] = bufferCast<SizeType32>(*mTables[bi]);
+            }
+            mReferences[bi].transitions = &mTransitions[bi];
+            // Random prompts of different lengths, which the automata must not consume
+            sequenceLengths[slot] = 2 + bi;
+            for (SizeType32 pos = 0; pos < sequenceLengths[slot]; ++pos)
+            {
+                mHostOutputIds[bi][pos] = tokenDist(gen);
+                outputIds[slot * kMaxSeqLen + pos] = mHostOutputIds[bi][pos];
+            }
+        }
+    }
+
+    void resetAutomata(SizeType32 batchSize)
+    {
+        tk::invokeResetTokenMaskAutomaton(bufferCast<SizeType32>(*mStates), bufferCast<SizeType32>(*mConsumedLengths),
+            bufferCast<SizeType32>(*mBatchSlots), batchSize, mStream->get());
+        for (auto& reference : mReferences)
+        {
+            reference.reset();
+        }
+    }
+
+    void applyAndVerify(SizeType32 batchSize)
+    {
+        trk::invokeFill(*mLogits, T{0.f}, *mStream);
+        tk::invokeApplyTokenMaskAutomaton(bufferCast<T>(*mLogits),
+            reinterpret_cast<SizeType32 const* const*>(bufferCast<int64_t>(*mAutomatonPtrs)),
+            bufferCast<SizeType32>(*mStates), bufferCast<SizeType32>(*mConsumedLengths),
+            reinterpret_cast<TokenIdType const* const*>(bufferCast<int64_t>(*mOutputIdsPtr)),
+            bufferCast<SizeType32>(*mSequenceLengths), bufferCast<TokenIdType>(*mEndIds),
+            bufferCast<SizeType32>(*mBatchSlots), batchSize, kVocabSize, kVocabSizePadded, mStream->get());
+        mStream->synchronize();
+
+        auto const* batchSlotsPtr = bufferCast<SizeType32>(*mBatchSlots);
+        auto const* states = bufferCast<SizeType32>(*mStates);
+        auto const* consumedLengths = bufferCast<SizeType32>(*mConsumedLengths);
+        auto const* sequenceLengths = bufferCast<SizeType32>(*mSequenceLengths);
+        auto const* logits = bufferCast<T>(*mLogits);
+        for (SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            auto const slot = batchSlotsPtr[bi];
+            bool const constrained = bi < batchSize - 1;
+            auto& reference = mReferences[bi];
+            if (constrained)
+            {
+                reference.advance(mHostOutputIds[bi], sequenceLengths[slot], kVocabSize);
+                EXPECT_EQ(states[slot], reference.state) << "bi: " << bi;
+                EXPECT_EQ(consumedLengths[slot], reference.consumedLength) << "bi: " << bi;
+            }
+            for (SizeType32 token = 0; token < kVocabSizePadded; ++token)
+            {
+                bool const allowed = !constrained || reference.isAllowed(token, kEndId, kVocabSize);
+                auto const logit = static_cast<float>(logits[bi * kVocabSizePadded + token]);
+                if (allowed)
+                {
+                    EXPECT_EQ(logit, 0.f) << "bi: " << bi << " token: " << token;
+                }
+                else
+                {
+                    EXPECT_TRUE(std::isinf(logit) && logit < 0.f) << "bi: " << bi << " token: " << token;
+                }
+            }
+        }
+    }
+
+    //! \brief Append one token to every request, allowed by its automaton unless `forceBanned` is set.
+    void appendTokens(SizeType32 batchSize, std::mt19937& gen, bool forceBanned)
+    {
+        auto const* batchSlotsPtr = bufferCast<SizeType32>(*mBatchSlots);
+        auto* sequenceLengths = bufferCast<SizeType32>(*mSequenceLengths);
+        auto* outputIds = bufferCast<TokenIdType>(*mOutputIds);
+        for (SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            auto const slot = batchSlotsPtr[bi];
+            auto const& reference = mReferences[bi];
+            std::vector<TokenIdType> candidates;
+            for (TokenIdType token = 0; token < kVocabSize; ++token)
+            {
+                if (reference.isAllowed(token, kEndId, kVocabSize) != forceBanned)
+                {
+                    candidates.push_back(token);
+                }
+            }
+            ASSERT_FALSE(candidates.empty());
+            std::uniform_int_distribution<std::size_t> dist(0, candidates.size() - 1);
+            auto const pos = sequenceLengths[slot];
+            ASSERT_LT(pos, kMaxSeqLen);
+            mHostOutputIds[bi][pos] = candidates[dist(gen)];
+            outputIds[slot * kMaxSeqLen + pos] = mHostOutputIds[bi][pos];
+            sequenceLengths[slot] = pos + 1;
+        }
+    }
+
+protected:
+    static SizeType32 constexpr kNumStates{6};
+    static SizeType32 constexpr kVocabSize{37};
+    static SizeType32 constexpr kVocabSizePadded{40};
+    static SizeType32 constexpr kMaxSeqLen{32};
+    static TokenIdType constexpr kEndId{0};
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+
+    ITensor::SharedPtr mBatchSlots;
+    ITensor::SharedPtr mLogits;
+    ITensor::SharedPtr mStates;
+    ITensor::SharedPtr mConsumedLengths;
+    ITensor::SharedPtr mSequenceLengths;
+    ITensor::SharedPtr mEndIds;
+    ITensor::SharedPtr mOutputIds;
+    ITensor::SharedPtr mOutputIdsPtr;
+    ITensor::SharedPtr mAutomatonPtrs;
+    std::vector<ITensor::SharedPtr> mTables;
+
+    std::vector<std::vector<SizeType32>> mTransitions;
+    std::vector<ReferenceAutomaton> mReferences;
+    std::vector<std::vector<TokenIdType>> mHostOutputIds;
+};
+
+using FloatAndHalfTypes = testing::Types<float, half>;
+TYPED_TEST_SUITE(TokenMaskAutomatonTest, FloatAndHalfTypes);
+
+TYPED_TEST(TokenMaskAutomatonTest, ResetSkipsPrompt)
+{
+    SizeType32 constexpr batchSize{4};
+    std::mt19937 gen(42);
+    this->initData(batchSize, gen);
+    this->resetAutomata(batchSize);
+    this->mStream->synchronize();
+
+    auto const* batchSlotsPtr = bufferCast<SizeType32>(*this->mBatchSlots);
+    auto const* states = bufferCast<SizeType32>(*this->mStates);
+    auto const* consumedLengths = bufferCast<SizeType32>(*this->mConsumedLengths);
+    for (SizeType32 slot = 0; slot < 2 * batchSize; ++slot)
+    {
+        bool const isSetUp = std::find(batchSlotsPtr, batchSlotsPtr + batchSize, slot) != batchSlotsPtr + batchSize;
+        EXPECT_EQ(states[slot], isSetUp ? 0 : -2) << "slot: " << slot;
+        EXPECT_EQ(consumedLengths[slot], isSetUp ? -1 : -2) << "slot: " << slot;
+    }
+
+    // The first step masks from the initial state, whatever the prompt
+    this->applyAndVerify(batchSize);
+    for (SizeType32 bi = 0; bi < batchSize - 1; ++bi)
+    {
+        EXPECT_EQ(states[batchSlotsPtr[bi]], 0) << "bi: " << bi;
+    }
+}
+
+TYPED_TEST(TokenMaskAutomatonTest, FollowsAllowedTokens)
+{
+    SizeType32 constexpr batchSize{5};
+    std::mt19937 gen(7);
+    this->initData(batchSize, gen);
+    this->resetAutomata(batchSize);
+    this->applyAndVerify(batchSize);
+    for (SizeType32 step = 0; step < 12; ++step)
+    {
+        this->appendTokens(batchSize, gen, false);
+        this->applyAndVerify(batchSize);
+    }
+}
+
+TYPED_TEST(TokenMaskAutomatonTest, MultipleTokensPerStep)
+{
+    SizeType32 constexpr batchSize{3};
+    std::mt19937 gen(11);
+    this->initData(batchSize, gen);
+    this->resetAutomata(batchSize);
+    this->applyAndVerify(batchSize);
+    auto const* batchSlotsPtr = bufferCast<SizeType32>(*this->mBatchSlots);
+    auto const* sequenceLengths = bufferCast<SizeType32>(*this->mSequenceLengths);
+    for (SizeType32 step = 0; step < 4; ++step)
+    {
+        // The host reference follows each token to pick the next one, the kernel consumes them all at once
+        for (SizeType32 ti = 0; ti < 3; ++ti)
+        {
+            this->appendTokens(batchSize, gen, false);
+            for (SizeType32 bi = 0; bi < batchSize; ++bi)
+            {
+                this->mReferences[bi].advance(
+                    this->mHostOutputIds[bi], sequenceLengths[batchSlotsPtr[bi]], TestFixture::kVocabSize);
+            }
+        }
+        this->applyAndVerify(batchSize);
+    }
+}
+
+TYPED_TEST(TokenMaskAutomatonTest, BannedTokenOnlyAllowsEndId)
+{
+    SizeType32 constexpr batchSize{4};
+    std::mt19937 gen(3);
+    this->initData(batchSize, gen);
+    this->resetAutomata(batchSize);
+    this->applyAndVerify(batchSize);
+    this->appendTokens(batchSize, gen, false);
+    this->applyAndVerify(batchSize);
+    this->appendTokens(batchSize, gen, true);
+    this->applyAndVerify(batchSize);
+
+    auto const* batchSlotsPtr = bufferCast<SizeType32>(*this->mBatchSlots);
+    auto const* states = bufferCast<SizeType32>(*this->mStates);
+    for (SizeType32 bi = 0; bi < batchSize - 1; ++bi)
+    {
+        EXPECT_EQ(states[batchSlotsPtr[bi]], -1) << "bi: " << bi;
+    }
+
+    // Once left, the automaton stays out, and a reset brings it back to its initial state
+    this->appendTokens(batchSize, gen, false);
+    this->applyAndVerify(batchSize);
+    this->resetAutomata(batchSize);
+    this->applyAndVerify(batchSize);
+    for (SizeType32 bi = 0; bi < batchSize - 1; ++bi)
+    {
+        EXPECT_EQ(states[batchSlotsPtr[bi]], 0) << "bi: " << bi;
+    }
+}
+
+} // namespace
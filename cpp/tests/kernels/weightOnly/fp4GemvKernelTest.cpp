@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/cutlass_kernels/cutlass_preprocessors.h"
+#include "tensorrt_llm/kernels/weightOnlyBatchedGemv/fp4Gemm.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <cuda_fp16.h>
+#include <cuda_fp8.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+using namespace tensorrt_llm::kernels;
+using namespace tensorrt_llm::kernels::fp4_gemm;
+
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+
+float e2m1ToFloat(uint8_t code)
+{
+    static constexpr float kValues[] = {0.f, 0.5f, 1.f, 1.5f, 2.f, 3.f, 4.f, 6.f};
+    return (code & 0x8 ? -1.f : 1.f) * kValues[code & 0x7];
+}
+
+float blockScaleToFloat(uint8_t scale, Fp4Format format)
+{
+    if (format == Fp4Format::MXFP4)
+    {
+        return std::ldexp(1.f, static_cast<int>(scale) - 127);
+    }
+    return static_cast<float>(reinterpret_cast<__nv_fp8_e4m3 const&>(scale));
+}
+
+class Fp4GemvKernelTest : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP();
+        }
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    // Quantizes random weights on the host, and checks the GEMV against the product with the dequantized weights.
+    void runTest(int m, int n, int k, Fp4Format format)
+    {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        std::vector<half> act(static_cast<size_t>(m) * k);
+        std::vector<float> weight(static_cast<size_t>(n) * k);
+        std::vector<half> bias(n);
+        for (auto& v : act)
+        {
+            v = __float2half(dist(gen));
+        }
+        // Blocks of very different ranges, so that wrong block scales show
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = 0; j < k; ++j)
+            {
+                weight[static_cast<size_t>(i) * k + j] = dist(gen) * (1 + (i + j / 16) % 7);
+            }
+        }
+        for (auto& v : bias)
+        {
+            v = __float2half(dist(gen));
+        }
+
+        int const blockSize = getFp4BlockSize(format);
+        std::vector<uint8_t> weightQ(static_cast<size_t>(n) * k / 2);
+        std::vector<uint8_t> scales(static_cast<size_t>(n) * k / blockSize);
+        float alpha = 0.f;
+        cutlass_kernels::fp4_block_quantize(weightQ.data(), scales.data(), &alpha, weight.data(),
+            {static_cast<size_t>(n), static_cast<size_t>(k)}, format);
+
+        auto actDevice = mBufferManager->copyFrom(act, MemoryType::kGPU);
+        auto weightDevice = mBufferManager->copyFrom(weightQ, MemoryType::kGPU);
+        auto scalesDevice = mBufferManager->copyFrom(scales, MemoryType::kGPU);
+        auto biasDevice = mBufferManager->copyFrom(bias, MemoryType::kGPU);
+        auto output = mBufferManager->gpu(static_cast<size_t>(m) * n, nvinfer1::DataType::kHALF);
+
+        Params params{actDevice->data(), weightDevice->data(), scalesDevice->data(), biasDevice->data(),
+            output->data(), alpha, m, n, k, format};
+        fp4GemvLauncher<half>(params, mStream->get());
+
+        std::vector<half> out(static_cast<size_t>(m) * n);
+        mBufferManager->copy(*output, out.data());
+        mStream->synchronize();
+
+        for (int i = 0; i < m; ++i)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                double ref = 0;
+                double refAbs = 0;
+                double unquantized = 0;
+                for (int l = 0; l < k; ++l)
+                {
+                    size_t const idx = static_cast<size_t>(j) * k + l;
+                    uint8_t const code = (weightQ[idx / 2] >> (4 * (l % 2))) & 0xF;
+                    double const w
+                        = e2m1ToFloat(code) * blockScaleToFloat(scales[idx / blockSize], format) * alpha;
+                    double const a = __half2float(act[static_cast<size_t>(i) * k + l]);
+                    ref += a * w;
+                    refAbs += std::abs(a * w);
+                    unquantized += a * weight[idx];
+                }
+                ref += __half2float(bias[j]);
+                unquantized += __half2float(bias[j]);
+                ASSERT_NEAR(__half2float(out[static_cast<size_t>(i) * n + j]), ref, 2e-3 * refAbs + 1e-2)
+                    << "m " << i << " n " << j;
+                // The quantization itself stays close to the unquantized product
+                ASSERT_NEAR(ref, unquantized, 0.15 * refAbs) << "m " << i << " n " << j;
+            }
+        }
+    }
+
+protected:
+    std::shared_ptr<BufferManager> mBufferManager;
+    std::shared_ptr<CudaStream> mStream;
+};
+
+} // namespace
+
+TEST_F(Fp4GemvKernelTest, mxfp4)
+{
+    for (int m = 1; m <= kMaxFp4GemvM; ++m)
+    {
+        runTest(m, 256, 1024, Fp4Format::MXFP4);
+    }
+}
+
+TEST_F(Fp4GemvKernelTest, nvfp4)
+{
+    for (int m = 1; m <= kMaxFp4GemvM; ++m)
+    {
+        runTest(m, 256, 1024, Fp4Format::NVFP4);
+    }
+    // k not a multiple of the 4096 handled by a CTA per step
+    runTest(3, 130, 1440, Fp4Format::NVFP4);
+}
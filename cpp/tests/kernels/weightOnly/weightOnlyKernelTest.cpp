@@ -212,6 +212,16 @@ void exec_cutlass_kernel(
     using AType = typename cutlassTypeMapper<KT>::AType;
     static constexpr cutlass::WeightOnlyQuantOp QuantOp = cutlassTypeMapper<KT>::QuantOp;
     void* act = params.act;
+    if constexpr (QuantOp == cutlass::WeightOnlyQuantOp::FINEGRAINED_SCALE_AND_ZEROS)
+    {
+        // The configs that can scale the activations in the mainloop skip the separate kernel
+        if (params.act_scale && runner.supportsFusedActScale(config))
+        {
+            runner.gemm(act, params.act_scale, params.weight, params.scales, params.zeros, params.bias, 1.f,
+                params.out, params.m, params.n, params.k, params.groupsize, config, ws, ws_size, stream);
+            return;
+        }
+    }
     if (params.act_scale)
     {
         tensorrt_llm::kernels::apply_per_channel_scale_kernel_launcher<AType, AType>(
@@ -414,3 +424,89 @@ TEST(Kernel, WeightOnly)
         }
     }
 }
+
+// Runs the gated kernel and checks it against x * silu(gate) computed from the output of the plain kernel over the
+// 2 * n columns of the same weight.
+template <wo::KernelType KT>
+bool verify_gated(int m, int n, int k, int groupsize)
+{
+    std::srand(20240123);
+    using AType = typename cutlassTypeMapper<KT>::AType;
+    static constexpr int ASizeInBits = sizeof(AType) * 8;
+    static constexpr int WSizeInBits = cutlassTypeMapper<KT>::WSizeInBits;
+    int const gs_factor = groupsize == 0 ? 1 : groupsize;
+    int const weight_n = 2 * n;
+    printf("Gated kernel %s\n", cutlassTypeMapper<KT>::str(m, n, k, groupsize).c_str());
+
+    CudaBuffer d_act(m * k * ASizeInBits / 8);
+    CudaBuffer d_weight(k * weight_n * WSizeInBits / 8);
+    CudaBuffer d_scales(weight_n * k / gs_factor * ASizeInBits / 8);
+    CudaBuffer d_zeros(weight_n * k / gs_factor * ASizeInBits / 8);
+    CudaBuffer d_bias(weight_n * ASizeInBits / 8);
+    CudaBuffer d_out(m * weight_n * ASizeInBits / 8);
+    CudaBuffer d_gated_out(m * n * ASizeInBits / 8);
+    std::vector<AType> h_act(m * k);
+    std::vector<uint8_t> h_weight(k * weight_n);
+    std::vector<AType> h_scales(weight_n * k), h_zeros(weight_n * k), h_bias(weight_n);
+    std::vector<AType> h_out(m * weight_n), h_gated_out(m * n), h_ref(m * n);
+
+    random_fill(h_act, -1.f, 1.f);
+    random_fill(h_scales, -1.f, 1.f);
+    random_fill(h_zeros, -1.f, 1.f);
+    random_fill(h_bias, -1.f, 1.f);
+    for (uint8_t& v : h_weight)
+    {
+        v = rand() % 256;
+    }
+    d_act.copy_from(h_act.data());
+    d_weight.copy_from(h_weight.data());
+    d_scales.copy_from(h_scales.data());
+    d_zeros.copy_from(h_zeros.data());
+    d_bias.copy_from(h_bias.data());
+
+    void* p_zeros = groupsize != 0 ? d_zeros.data() : nullptr;
+    void* p_bias = groupsize != 0 ? d_bias.data() : nullptr;
+    wo::Params params(d_act.data(), nullptr, d_weight.data(), d_scales.data(), p_zeros, p_bias, d_out.data(), 1.f, m,
+        weight_n, k, groupsize, KT);
+    run_cuda_kernel(params, 0, 1);
+    d_out.copy_to(h_out.data());
+
+    wo::Params gated_params(d_act.data(), nullptr, d_weight.data(), d_scales.data(), p_zeros, p_bias,
+        d_gated_out.data(), 1.f, m, n, k, groupsize, KT);
+    gated_params.gated = true;
+    run_cuda_kernel(gated_params, 0, 1);
+    d_gated_out.copy_to(h_gated_out.data());
+
+    for (int i = 0; i < m; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            float const x = static_cast<float>(h_out[i * weight_n + j]);
+            float const gate = static_cast<float>(h_out[i * weight_n + n + j]);
+            h_ref[i * n + j] = static_cast<AType>(x * gate / (1.f + std::exp(-gate)));
+        }
+    }
+    float quant_scale = 1.f / (1 << (WSizeInBits - 1));
+    return compare<AType>(h_gated_out.data(), h_ref.data(), m * n, quant_scale);
+}
+
+TEST(Kernel, WeightOnlyGated)
+{
+    int const arch = tensorrt_llm::common::getSMVersion();
+    for (int m : {1, 3, 4, 9})
+    {
+        EXPECT_TRUE(verify_gated<wo::KernelType::FP16Int8PerChannel>(m, 2048, 2048, 0));
+        EXPECT_TRUE(verify_gated<wo::KernelType::FP16Int4PerChannel>(m, 2048, 2048, 0));
+        if (arch >= 75)
+        {
+            EXPECT_TRUE(verify_gated<wo::KernelType::FP16Int4Groupwise>(m, 2048, 2048, 128));
+#if defined(ENABLE_BF16)
+            if (arch >= 80)
+            {
+                EXPECT_TRUE(verify_gated<wo::KernelType::BF16Int4Groupwise>(m, 2048, 2048, 64));
+                EXPECT_TRUE(verify_gated<wo::KernelType::BF16Int8PerChannel>(m, 2048, 2048, 0));
+            }
+#endif
+        }
+    }
+}
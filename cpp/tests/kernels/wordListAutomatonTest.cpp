@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/kernels/banBadWords.h"
+#include "tensorrt_llm/kernels/stopCriteriaKernels.h"
+#include "tensorrt_llm/kernels/wordListAutomaton.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class WordListAutomatonTest : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    //! Fills random sequences over a small vocab and random word lists, so that words occur often
+    void initData(SizeType32 seed)
+    {
+        std::mt19937 generator(seed);
+        std::uniform_int_distribution<TokenIdType> tokenDistr(0, mVocabSize - 1);
+        std::uniform_int_distribution<SizeType32> numWordsDistr(0, 4);
+        std::uniform_int_distribution<SizeType32> wordLenDistr(1, 4);
+
+        mOutputIds
+            = BufferManager::pinned(ITensor::makeShape({mMaxBatchSize, mMaxSeqLen}), nvinfer1::DataType::kINT32);
+        mOutputIdsPtrs = BufferManager::pinned(ITensor::makeShape({mMaxBatchSize}), nvinfer1::DataType::kINT64);
+        mWords
+            = BufferManager::pinned(ITensor::makeShape({mMaxBatchSize, 2, mMaxWordsLen}), nvinfer1::DataType::kINT32);
+        mWordsPtrs = BufferManager::pinned(ITensor::makeShape({mMaxBatchSize}), nvinfer1::DataType::kINT64);
+        mWordsLens = BufferManager::pinned(ITensor::makeShape({mMaxBatchSize}), nvinfer1::DataType::kINT32);
+        mBatchSlots = BufferManager::pinned(ITensor::makeShape({mBatchSize}), nvinfer1::DataType::kINT32);
+        mAutomata = mBufferManager->gpu(ITensor::makeShape({mMaxBatchSize, tk::getWordListAutomatonSize(mMaxWordsLen)}),
+            nvinfer1::DataType::kINT32);
+
+        auto outputIds = bufferCast<TokenIdType>(*mOutputIds);
+        auto words = bufferCast<TokenIdType>(*mWords);
+        auto wordsLens = bufferCast<SizeType32>(*mWordsLens);
+        for (SizeType32 bi = 0; bi < mMaxBatchSize; ++bi)
+        {
+            reinterpret_cast<TokenIdType**>(bufferCast<int64_t>(*mOutputIdsPtrs))[bi] = outputIds + bi * mMaxSeqLen;
+            reinterpret_cast<TokenIdType**>(bufferCast<int64_t>(*mWordsPtrs))[bi] = words + bi * 2 * mMaxWordsLen;
+            for (SizeType32 ti = 0; ti < mMaxSeqLen; ++ti)
+            {
+                outputIds[bi * mMaxSeqLen + ti] = tokenDistr(generator);
+            }
+
+            std::vector<TokenIdType> tokens;
+            std::vector<SizeType32> offsets;
+            auto const numWords = numWordsDistr(generator);
+            for (SizeType32 wi = 0; wi < numWords; ++wi)
+            {
+                auto const wordLen
+                    = std::min(wordLenDistr(generator), mMaxWordsLen - static_cast<SizeType32>(tokens.size()));
+                for (SizeType32 ti = 0; ti < wordLen; ++ti)
+                {
+                    tokens.push_back(tokenDistr(generator));
+                }
+                offsets.push_back(static_cast<SizeType32>(tokens.size()));
+            }
+            // Words list of the request is [2, wordsLen], offsets padded with -1
+            auto const wordsLen = static_cast<SizeType32>(tokens.size());
+            offsets.resize(wordsLen, -1);
+            auto* requestWords = words + bi * 2 * mMaxWordsLen;
+            std::copy(tokens.begin(), tokens.end(), requestWords);
+            std::copy(offsets.begin(), offsets.end(), requestWords + wordsLen);
+            wordsLens[bi] = wordsLen;
+        }
+
+        auto batchSlots = bufferCast<SizeType32>(*mBatchSlots);
+        for (SizeType32 bi = 0; bi < mBatchSize; ++bi)
+        {
+            batchSlots[bi] = 2 * bi;
+        }
+        mBufferManager->setZero(*mAutomata);
+    }
+
+protected:
+    SizeType32 const mBatchSize{8};
+    SizeType32 const mMaxBatchSize{2 * mBatchSize};
+    SizeType32 const mMaxSeqLen{48};
+    SizeType32 const mMaxWordsLen{12};
+    SizeType32 const mVocabSize{4};
+    SizeType32 const mInputLen{4};
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+
+    ITensor::SharedPtr mOutputIds;
+    ITensor::SharedPtr mOutputIdsPtrs;
+    ITensor::SharedPtr mWords;
+    ITensor::SharedPtr mWordsPtrs;
+    ITensor::SharedPtr mWordsLens;
+    ITensor::SharedPtr mBatchSlots;
+    ITensor::SharedPtr mAutomata;
+};
+
+TEST_F(WordListAutomatonTest, stopWordsMatchBruteForce)
+{
+    initData(0);
+
+    auto sequenceLengths = BufferManager::pinned(ITensor::makeShape({mMaxBatchSize}), nvinfer1::DataType::kINT32);
+    auto finished = BufferManager::pinned(
+        ITensor::makeShape({2, mMaxBatchSize}), TRTDataType<tk::FinishedState::UnderlyingType>::value);
+    auto sequenceLengthsPtr = bufferCast<SizeType32>(*sequenceLengths);
+    auto finishedPtr = reinterpret_cast<tk::FinishedState*>(bufferCast<tk::FinishedState::UnderlyingType>(*finished));
+    std::fill(finishedPtr, finishedPtr + 2 * mMaxBatchSize, tk::FinishedState::empty());
+
+    auto const outputIdsPtrs = reinterpret_cast<TokenIdType const**>(bufferCast<int64_t>(*mOutputIdsPtrs));
+    auto const wordsPtrs = reinterpret_cast<TokenIdType const**>(bufferCast<int64_t>(*mWordsPtrs));
+    auto const batchSlots = bufferCast<SizeType32>(*mBatchSlots);
+    for (SizeType32 step = mInputLen; step < mMaxSeqLen; ++step)
+    {
+        // Both kernels see the sequence grow by one token per step
+        std::fill(sequenceLengthsPtr, sequenceLengthsPtr + mMaxBatchSize, step + 1);
+        tk::invokeStopWordsAutomatonCriterion(bufferCast<SizeType32>(*mAutomata), mMaxWordsLen, outputIdsPtrs,
+            wordsPtrs, finishedPtr, sequenceLengthsPtr, batchSlots, bufferCast<SizeType32>(*mWordsLens), nullptr,
+            mBatchSize, mStream->get());
+        tk::invokeStopWordsCriterion(outputIdsPtrs, nullptr, wordsPtrs, finishedPtr + mMaxBatchSize, sequenceLengthsPtr,
+            batchSlots, bufferCast<SizeType32>(*mWordsLens), nullptr, mMaxWordsLen, mBatchSize, 1, mMaxSeqLen,
+            mStream->get());
+        mStream->synchronize();
+
+        for (SizeType32 bi = 0; bi < mBatchSize; ++bi)
+        {
+            auto const slot = batchSlots[bi];
+            EXPECT_EQ(finishedPtr[slot].isFinished(), finishedPtr[mMaxBatchSize + slot].isFinished())
+                << "request " << bi << " step " << step;
+            // Keep stepping with finished requests to check that the automaton stays in sync
+            finishedPtr[slot] = tk::FinishedState::empty();
+            finishedPtr[mMaxBatchSize + slot] = tk::FinishedState::empty();
+        }
+    }
+}
+
+TEST_F(WordListAutomatonTest, badWordsMatchBruteForce)
+{
+    initData(1);
+
+    auto logits = BufferManager::pinned(ITensor::makeShape({2, mBatchSize, mVocabSize}), nvinfer1::DataType::kFLOAT);
+    auto sequenceLengths = BufferManager::pinned(ITensor::makeShape({mMaxBatchSize}), nvinfer1::DataType::kINT32);
+    auto logitsPtr = bufferCast<float>(*logits);
+    auto sequenceLengthsPtr = bufferCast<SizeType32>(*sequenceLengths);
+
+    auto const outputIdsPtrs = reinterpret_cast<TokenIdType const**>(bufferCast<int64_t>(*mOutputIdsPtrs));
+    auto const wordsPtrs = reinterpret_cast<TokenIdType const**>(bufferCast<int64_t>(*mWordsPtrs));
+    auto const batchSlots = bufferCast<SizeType32>(*mBatchSlots);
+    for (SizeType32 step = mInputLen; step < mMaxSeqLen; ++step)
+    {
+        // Skipping a step forces the automaton to recompute its state from the tail of the sequence
+        if (step % 7 == 0)
+        {
+            continue;
+        }
+        std::fill(sequenceLengthsPtr, sequenceLengthsPtr + mMaxBatchSize, step);
+        std::fill(logitsPtr, logitsPtr + 2 * mBatchSize * mVocabSize, 0.f);
+        tk::invokeBanBadWordsAutomaton(logitsPtr, bufferCast<SizeType32>(*mAutomata), mMaxWordsLen, outputIdsPtrs,
+            wordsPtrs, bufferCast<SizeType32>(*mWordsLens), sequenceLengthsPtr, batchSlots, mBatchSize, mVocabSize,
+            mStream->get());
+        tk::invokeBanBadWords(logitsPtr + mBatchSize * mVocabSize, outputIdsPtrs, nullptr, batchSlots, mBatchSize, 1,
+            wordsPtrs, bufferCast<SizeType32>(*mWordsLens), mMaxWordsLen, mVocabSize, sequenceLengthsPtr, mMaxSeqLen,
+            mStream->get());
+        mStream->synchronize();
+
+        for (SizeType32 vi = 0; vi < mBatchSize * mVocabSize; ++vi)
+        {
+            EXPECT_EQ(logitsPtr[vi], logitsPtr[mBatchSize * mVocabSize + vi]) << "index " << vi << " step " << step;
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQARunner.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+using namespace tensorrt_llm::kernels;
+
+namespace
+{
+
+XQAParams makeParams(int headSize, int numQHeads, int numKVHeads, int tokensPerBlock, int beamWidth = 1)
+{
+    XQAParams params{};
+    params.data_type = DATA_TYPE_FP16;
+    params.kv_cache_data_type = DATA_TYPE_FP16;
+    params.unidirectional = 1;
+    params.q_scaling = 1.0f;
+    params.mask_type = AttentionMaskType::CAUSAL;
+    params.cross_attention = false;
+    params.paged_kv_cache = true;
+    params.tokens_per_block = tokensPerBlock;
+    params.beam_width = beamWidth;
+    params.max_attention_window_size = 4096;
+    params.cyclic_attention_window_size = 4096;
+    params.num_q_heads = numQHeads;
+    params.num_kv_heads = numKVHeads;
+    params.head_size = headSize;
+    return params;
+}
+
+class XQAJitShapesTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        // Read once by getEnvEnableXQAJIT, before any runner is created.
+        setenv("TRTLLM_ENABLE_XQA_JIT", "1", 1);
+    }
+
+    static bool hasJitGpu()
+    {
+        int deviceCount = 0;
+        if (cudaGetDeviceCount(&deviceCount) != cudaSuccess || deviceCount == 0)
+        {
+            return false;
+        }
+        auto const sm = tensorrt_llm::common::getSMVersion();
+        return sm >= 80 && sm < 90;
+    }
+};
+
+} // namespace
+
+TEST_F(XQAJitShapesTest, validatesShapesWithoutPrecompiledCubins)
+{
+    for (int const headSize : {64, 80, 96, 128, 160, 256})
+    {
+        EXPECT_TRUE(DecoderXQAImplJIT::isValidatedShape(makeParams(headSize, 32, 8, 64))) << headSize;
+    }
+    for (int const groupSize : {1, 2, 4, 8, 16})
+    {
+        EXPECT_TRUE(DecoderXQAImplJIT::isValidatedShape(makeParams(128, 2 * groupSize, 2, 32))) << groupSize;
+    }
+    for (int const tokensPerBlock : {16, 32, 64, 128})
+    {
+        EXPECT_TRUE(DecoderXQAImplJIT::isValidatedShape(makeParams(96, 8, 8, tokensPerBlock))) << tokensPerBlock;
+    }
+
+    // Unvalidated head sizes, group sizes and tokens per block.
+    EXPECT_FALSE(DecoderXQAImplJIT::isValidatedShape(makeParams(72, 8, 8, 64)));
+    EXPECT_FALSE(DecoderXQAImplJIT::isValidatedShape(makeParams(512, 8, 8, 64)));
+    EXPECT_FALSE(DecoderXQAImplJIT::isValidatedShape(makeParams(128, 6, 2, 64)));
+    EXPECT_FALSE(DecoderXQAImplJIT::isValidatedShape(makeParams(128, 64, 2, 64)));
+    EXPECT_FALSE(DecoderXQAImplJIT::isValidatedShape(makeParams(128, 8, 8, 8)));
+    // Query heads that aren't a multiple of the KV heads.
+    EXPECT_FALSE(DecoderXQAImplJIT::isValidatedShape(makeParams(128, 12, 8, 64)));
+    // Beam search and Medusa only have precompiled kernels.
+    EXPECT_FALSE(DecoderXQAImplJIT::isValidatedShape(makeParams(128, 8, 8, 64, 4)));
+    auto medusa = makeParams(128, 8, 8, 64);
+    medusa.multi_query_tokens = true;
+    EXPECT_FALSE(DecoderXQAImplJIT::isValidatedShape(medusa));
+}
+
+TEST_F(XQAJitShapesTest, compilesShapesWithoutPrecompiledCubins)
+{
+    if (!hasJitGpu())
+    {
+        GTEST_SKIP() << "The XQA JIT implementation needs sm80-sm89";
+    }
+    ASSERT_TRUE(tensorrt_llm::common::getEnvEnableXQAJIT());
+
+    // Shapes outside the precompiled grid: head sizes 80/96/160, 2/4/16 query heads per KV head, 16/32 tokens per
+    // block.
+    for (auto const& params : {makeParams(80, 32, 8, 64), makeParams(96, 16, 8, 32), makeParams(160, 32, 32, 16),
+             makeParams(128, 32, 2, 64), makeParams(64, 8, 2, 128)})
+    {
+        DecoderXQARunner::Resource resource;
+        DecoderXQARunner runner(
+            &resource, DATA_TYPE_FP16, params.num_q_heads, params.num_kv_heads, params.head_size, false);
+        ASSERT_TRUE(runner.shouldUse<half>(params, /*forConfigurePlugin=*/true)) << params.head_size;
+        auto const emptySize = resource.getSerializationSize();
+        runner.prepare(params);
+        // The compiled cubin is in the registry, so that it is serialized with the plugin.
+        EXPECT_GT(resource.getSerializationSize(), emptySize) << params.head_size;
+        EXPECT_TRUE(runner.shouldUse<half>(params, /*forConfigurePlugin=*/true)) << params.head_size;
+    }
+}
+
+TEST_F(XQAJitShapesTest, rejectsUnvalidatedShapes)
+{
+    if (!hasJitGpu())
+    {
+        GTEST_SKIP() << "The XQA JIT implementation needs sm80-sm89";
+    }
+
+    for (auto const& params : {makeParams(72, 8, 8, 64), makeParams(128, 6, 2, 64), makeParams(128, 12, 8, 64),
+             makeParams(128, 8, 8, 8), makeParams(96, 8, 8, 64, 4)})
+    {
+        DecoderXQARunner::Resource resource;
+        DecoderXQARunner runner(
+            &resource, DATA_TYPE_FP16, params.num_q_heads, params.num_kv_heads, params.head_size, false);
+        EXPECT_FALSE(runner.shouldUse<half>(params, /*forConfigurePlugin=*/true)) << params.head_size;
+    }
+}
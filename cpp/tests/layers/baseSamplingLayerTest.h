@@ -128,7 +128,7 @@ protected:
     TensorPtr mCumLogProbsDevice;
     TensorPtr mOutputLogProbsDevice;
 
-    TensorPtr mCurandStatesDevice;
+    TensorPtr mRandomSeedsDevice;
     TensorPtr mPenaltyWorkspaceDevice;
     BufferPtr mSamplingWorkspaceDevice;
 
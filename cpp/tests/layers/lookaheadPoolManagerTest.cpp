@@ -26,8 +26,9 @@ using namespace tensorrt_llm::layers;
 using TensorPtr = runtime::ITensor::SharedPtr;
 using TensorConstPtr = runtime::ITensor::SharedConstPtr;
 
-void printMap(
-    char const* name, std::unordered_map<LookaheadPoolManager::Key, std::list<TensorConstPtr>> const& tokenMap)
+using NgramView = LookaheadPoolManager::NgramView;
+
+void printMap(char const* name, std::unordered_map<LookaheadPoolManager::Key, std::vector<NgramView>> const& tokenMap)
 {
     std::ostringstream buf;
     buf << name << std::endl;
@@ -37,7 +38,7 @@ void printMap(
         for (auto const& tup : value)
         {
             buf << "(";
-            for (auto const& token : BufferRange<LookaheadPoolManager::Key const>(*tup))
+            for (auto const& token : tup)
             {
                 buf << static_cast<char>(token) << ",";
             }
@@ -48,11 +49,10 @@ void printMap(
     TLLM_LOG_DEBUG(buf.str());
 }
 
-bool isTensorEqString(TensorConstPtr const& a, std::string b)
+bool isNgramEqString(NgramView const& a, std::string b)
 {
-    TLLM_CHECK(ITensor::volume(a->getShape()) == static_cast<SizeType32>(b.size()));
-    auto ar = BufferRange<TokenIdType const>(*a);
-    return std::equal(ar.begin(), ar.end(), b.begin());
+    TLLM_CHECK(a.size() == b.size());
+    return std::equal(a.begin(), a.end(), b.begin());
 }
 
 TEST(LookaheadPoolManagerTest, fillAndUpdate)
@@ -85,7 +85,7 @@ TEST(LookaheadPoolManagerTest, fillAndUpdate)
     auto list = pm.guess(lastToken, G);
     for (auto const& ngram : list)
     {
-        PRINT_TOKENS(ngram);
+        TLLM_LOG_DEBUG("%s", std::string(ngram.begin(), ngram.end()).c_str());
     }
     /***
      l: (l,o, ,),(o, ,w,),(d,., ,),(i,v,e,),(i,f,e,),
@@ -117,7 +117,7 @@ TEST(LookaheadPoolManagerTest, fillAndUpdate)
     list = pm.guess(lastToken, G);
     for (auto const& ngram : list)
     {
-        PRINT_TOKENS(ngram);
+        TLLM_LOG_DEBUG("%s", std::string(ngram.begin(), ngram.end()).c_str());
     }
     /**
      w: (o,r,l,),(2,3,4,),
@@ -125,9 +125,9 @@ TEST(LookaheadPoolManagerTest, fillAndUpdate)
 
     ASSERT_EQ(list.size(), 2);
     auto it = list.begin();
-    EXPECT_TRUE(isTensorEqString(*it, "orl"));
+    EXPECT_TRUE(isNgramEqString(*it, "orl"));
     it++;
-    EXPECT_TRUE(isTensorEqString(*it, "234"));
+    EXPECT_TRUE(isNgramEqString(*it, "234"));
 
     pastTokens = initTensor(std::string("dogde12345hijkm"), ITensor::makeShape({5, 3}));
     pm.update(keyTokens, pastTokens);
@@ -160,15 +160,36 @@ TEST(LookaheadPoolManagerTest, fillAndUpdate)
     list = pm.guess(lastToken, G);
     ASSERT_EQ(list.size(), G);
     it = list.begin();
-    EXPECT_TRUE(isTensorEqString(*it, "ive"));
+    EXPECT_TRUE(isNgramEqString(*it, "ive"));
     it++;
-    EXPECT_TRUE(isTensorEqString(*it, "ife"));
+    EXPECT_TRUE(isNgramEqString(*it, "ife"));
     it++;
-    EXPECT_TRUE(isTensorEqString(*it, "dog"));
+    EXPECT_TRUE(isNgramEqString(*it, "dog"));
     it++;
-    EXPECT_TRUE(isTensorEqString(*it, "cat"));
+    EXPECT_TRUE(isNgramEqString(*it, "cat"));
     it++;
-    EXPECT_TRUE(isTensorEqString(*it, "abc"));
+    EXPECT_TRUE(isNgramEqString(*it, "abc"));
+}
+
+TEST(LookaheadPoolManagerTest, setupRecyclesPool)
+{
+    SizeType32 constexpr G{2};
+    LookaheadPoolManager pm(G);
+    pm.setup(G);
+    pm.accept(initTensor("abcabdabe"), 3);
+    auto list = pm.guess('a', G);
+    ASSERT_EQ(list.size(), 2);
+    EXPECT_TRUE(isNgramEqString(list[0], "bd"));
+    EXPECT_TRUE(isNgramEqString(list[1], "be"));
+
+    // The next request reuses the arena with another n-gram length and must not see the previous n-grams
+    pm.setup(G);
+    pm.accept(initTensor("xyzwxyqr"), 4);
+    EXPECT_TRUE(pm.guess('a', G).empty());
+    list = pm.guess('x', G);
+    ASSERT_EQ(list.size(), 2);
+    EXPECT_TRUE(isNgramEqString(list[0], "yzw"));
+    EXPECT_TRUE(isNgramEqString(list[1], "yqr"));
 }
 
 } // namespace tensorrt_llm::tests::layers
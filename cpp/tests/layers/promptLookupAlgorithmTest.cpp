@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/layers/promptLookupAlgorithm.h"
+#include "tests/layers/randomLlm.h"
+
+namespace tensorrt_llm::tests::layers
+{
+using namespace tensorrt_llm::runtime;
+using namespace tensorrt_llm::layers;
+using TensorPtr = runtime::ITensor::SharedPtr;
+
+namespace
+{
+std::string toString(TensorPtr const& tokens, SizeType32 length)
+{
+    BufferRange<TokenIdType const> range(*tokens);
+    return std::string(range.begin(), range.begin() + length);
+}
+} // namespace
+
+TEST(PromptLookupAlgorithmTest, longestMatchWins)
+{
+    SizeType32 constexpr maxDraftLen{4};
+    PromptLookupAlgorithm algo(maxDraftLen, 3, 8);
+    auto draftTokens = BufferManager::cpu(ITensor::makeShape({maxDraftLen}), nvinfer1::DataType::kINT32);
+    auto length = BufferManager::cpu(ITensor::makeShape({1}), nvinfer1::DataType::kINT32);
+
+    // "c" follows "ab" at the beginning and "xb" in the middle, the older occurrence matches one more token
+    algo.setup(initTensor("abc123 xbc456 abc"), 3, 3);
+    algo.prepare(draftTokens, length);
+    ASSERT_EQ(BufferRange<SizeType32>(*length)[0], 3);
+    EXPECT_EQ(toString(draftTokens, 3), "123");
+
+    // Matching the last token only, the newest occurrence wins
+    algo.setup(initTensor("abc123 xbc456 abc"), 3, 1);
+    algo.prepare(draftTokens, length);
+    ASSERT_EQ(BufferRange<SizeType32>(*length)[0], 3);
+    EXPECT_EQ(toString(draftTokens, 3), "456");
+
+    // No earlier occurrence of the last token
+    algo.setup(initTensor("abcdefg"), 3, 3);
+    algo.prepare(draftTokens, length);
+    EXPECT_EQ(BufferRange<SizeType32>(*length)[0], 0);
+}
+
+TEST(PromptLookupAlgorithmTest, acceptsAndIndexesOutput)
+{
+    SizeType32 constexpr maxDraftLen{4};
+    PromptLookupAlgorithm algo(maxDraftLen, 3, 8);
+    auto draftTokens = BufferManager::cpu(ITensor::makeShape({maxDraftLen}), nvinfer1::DataType::kINT32);
+    auto length = BufferManager::cpu(ITensor::makeShape({1}), nvinfer1::DataType::kINT32);
+    auto acceptedTokens = BufferManager::cpu(ITensor::makeShape({maxDraftLen + 1}), nvinfer1::DataType::kINT32);
+    auto acceptedLength = BufferManager::cpu(ITensor::makeShape({1}), nvinfer1::DataType::kINT32);
+    auto endToken = initTensor("$");
+
+    algo.setup(initTensor("abc123 xbc456 abc"), 3, 3);
+    algo.prepare(draftTokens, length);
+    EXPECT_EQ(toString(draftTokens, 3), "123");
+
+    // The model agrees on the first 2 draft tokens and then diverges
+    algo.update(acceptedTokens, acceptedLength, initTensor("12#9"), endToken);
+    ASSERT_EQ(BufferRange<SizeType32>(*acceptedLength)[0], 3);
+    EXPECT_EQ(toString(acceptedTokens, 3), "12#");
+    algo.prepare(draftTokens, length);
+    EXPECT_EQ(BufferRange<SizeType32>(*length)[0], 0);
+
+    // The output is indexed as well, "#" is followed by the 3 tokens copied from the prompt
+    algo.accept(initTensor(" xbc456 #"));
+    algo.prepare(draftTokens, length);
+    ASSERT_EQ(BufferRange<SizeType32>(*length)[0], 3);
+    EXPECT_EQ(toString(draftTokens, 3), " xb");
+
+    // Acceptance stops at the end token
+    algo.update(acceptedTokens, acceptedLength, initTensor(" $bc"), endToken);
+    ASSERT_EQ(BufferRange<SizeType32>(*acceptedLength)[0], 2);
+    EXPECT_EQ(toString(acceptedTokens, 2), " $");
+}
+
+} // namespace tensorrt_llm::tests::layers
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/beamStreamTracker.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+using Tokens = std::vector<TokenIdType>;
+
+//! Backtracks the beam over the whole length, like gatherTree
+Tokens gather(std::vector<Tokens> const& tokens, std::vector<std::vector<SizeType32>> const& parents, SizeType32 beam)
+{
+    Tokens result(tokens.size());
+    for (auto step = static_cast<SizeType32>(tokens.size()) - 1; step >= 0; --step)
+    {
+        result[step] = tokens[step][beam];
+        beam = parents[step][beam];
+    }
+    return result;
+}
+} // namespace
+
+TEST(BeamStreamTrackerTest, stableBestBeam)
+{
+    BeamStreamTracker tracker{2};
+    std::vector<SizeType32> const parents{0, 0};
+    tracker.addStep(Tokens{1, 2}.data(), parents.data());
+    auto delta = tracker.takeDelta();
+    EXPECT_EQ(delta.tokens, Tokens{1});
+    EXPECT_EQ(delta.rewriteFrom, 0);
+    EXPECT_FALSE(delta.rewrite);
+
+    tracker.addStep(Tokens{3, 4}.data(), std::vector<SizeType32>{0, 1}.data());
+    tracker.addStep(Tokens{5, 6}.data(), std::vector<SizeType32>{0, 1}.data());
+    delta = tracker.takeDelta();
+    EXPECT_EQ(delta.tokens, (Tokens{3, 5}));
+    EXPECT_EQ(delta.rewriteFrom, 1);
+    EXPECT_FALSE(delta.rewrite);
+
+    // Nothing new
+    delta = tracker.takeDelta();
+    EXPECT_TRUE(delta.tokens.empty());
+    EXPECT_EQ(delta.rewriteFrom, 3);
+}
+
+TEST(BeamStreamTrackerTest, bestBeamChanges)
+{
+    BeamStreamTracker tracker{2};
+    tracker.addStep(Tokens{1, 2}.data(), nullptr);
+    tracker.addStep(Tokens{3, 4}.data(), std::vector<SizeType32>{0, 1}.data());
+    EXPECT_EQ(tracker.takeDelta().tokens, (Tokens{1, 3}));
+
+    // Both beams now extend the second beam of the previous step, the streamed tokens are replaced from the start
+    tracker.addStep(Tokens{5, 6}.data(), std::vector<SizeType32>{1, 1}.data());
+    auto const delta = tracker.takeDelta();
+    EXPECT_TRUE(delta.rewrite);
+    EXPECT_EQ(delta.rewriteFrom, 0);
+    EXPECT_EQ(delta.tokens, (Tokens{2, 4, 5}));
+    EXPECT_EQ(tracker.getStreamed(), (Tokens{2, 4, 5}));
+}
+
+TEST(BeamStreamTrackerTest, partialRewrite)
+{
+    BeamStreamTracker tracker{2};
+    tracker.addStep(Tokens{1, 2}.data(), nullptr);
+    tracker.addStep(Tokens{3, 4}.data(), std::vector<SizeType32>{0, 0}.data());
+    EXPECT_EQ(tracker.takeDelta().tokens, (Tokens{1, 3}));
+    // The second beam, which shares the first token, becomes the best
+    auto const delta = tracker.takeDelta(1);
+    EXPECT_TRUE(delta.rewrite);
+    EXPECT_EQ(delta.rewriteFrom, 1);
+    EXPECT_EQ(delta.tokens, Tokens{4});
+}
+
+TEST(BeamStreamTrackerTest, matchesGather)
+{
+    SizeType32 constexpr beamWidth = 4;
+    SizeType32 constexpr numSteps = 200;
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<SizeType32> beamDist{0, beamWidth - 1};
+    std::uniform_int_distribution<TokenIdType> tokenDist{0, 1000};
+
+    BeamStreamTracker tracker{beamWidth};
+    std::vector<Tokens> tokens;
+    std::vector<std::vector<SizeType32>> parents;
+    Tokens streamed;
+    for (SizeType32 step = 0; step < numSteps; ++step)
+    {
+        Tokens stepTokens(beamWidth);
+        std::vector<SizeType32> stepParents(beamWidth);
+        for (SizeType32 beam = 0; beam < beamWidth; ++beam)
+        {
+            stepTokens[beam] = tokenDist(rng);
+            // Mostly extend the best beam, so that the paths share prefixes
+            stepParents[beam] = beamDist(rng) < 3 ? 0 : beamDist(rng);
+        }
+        tokens.push_back(stepTokens);
+        parents.push_back(stepParents);
+        tracker.addStep(stepTokens.data(), stepParents.data());
+
+        auto const bestBeam = beamDist(rng) == 0 ? beamDist(rng) : 0;
+        auto const delta = tracker.takeDelta(bestBeam);
+        ASSERT_LE(delta.rewriteFrom, static_cast<SizeType32>(streamed.size()));
+        EXPECT_EQ(delta.rewrite, delta.rewriteFrom < static_cast<SizeType32>(streamed.size()));
+        streamed.resize(delta.rewriteFrom);
+        streamed.insert(streamed.end(), delta.tokens.begin(), delta.tokens.end());
+        ASSERT_EQ(streamed, gather(tokens, parents, bestBeam)) << "step " << step;
+        ASSERT_EQ(tracker.getBeam(bestBeam), streamed);
+    }
+}
+
+TEST(BeamStreamTrackerTest, decoderLayout)
+{
+    // [beamWidth, maxSeqLen] with an input of 2 tokens, the steps start at position 2
+    SizeType32 constexpr beamWidth = 2;
+    SizeType32 constexpr maxSeqLen = 6;
+    SizeType32 constexpr inputLength = 2;
+    std::vector<TokenIdType> const outputIds{7, 8, 1, 3, 5, 0, 7, 8, 2, 4, 6, 0};
+    std::vector<SizeType32> const parentIds{0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0};
+
+    BeamStreamTracker tracker{beamWidth};
+    tracker.addSteps(outputIds.data(), parentIds.data(), maxSeqLen, inputLength, 0, 1);
+    EXPECT_EQ(tracker.takeDelta().tokens, Tokens{1});
+    tracker.addSteps(outputIds.data(), parentIds.data(), maxSeqLen, inputLength, 1, 3);
+    EXPECT_EQ(tracker.getNumSteps(), 3);
+    auto const delta = tracker.takeDelta();
+    EXPECT_TRUE(delta.rewrite);
+    EXPECT_EQ(delta.rewriteFrom, 0);
+    EXPECT_EQ(delta.tokens, (Tokens{2, 4, 5}));
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/bufferArena.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <memory>
+#include <new>
+#include <numeric>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+namespace tc = tensorrt_llm::common;
+
+class BufferArenaTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP();
+        }
+        mManager = std::make_unique<BufferManager>(std::make_shared<CudaStream>());
+    }
+
+    std::unique_ptr<BufferManager> mManager;
+};
+
+TEST_F(BufferArenaTest, ReplacesTensorsByViews)
+{
+    std::vector<std::int32_t> values(4 * 8);
+    std::iota(values.begin(), values.end(), 0);
+    BufferArena::TensorPtr ids = mManager->copyFrom(values, ITensor::makeShape({4, 8}), MemoryType::kGPU);
+    BufferArena::TensorPtr scores = mManager->gpu(ITensor::makeShape({3}), nvinfer1::DataType::kFLOAT);
+    BufferArena::TensorPtr unused;
+    auto const* oldIds = ids.get();
+
+    BufferArena arena{{&ids, &scores, &unused}, *mManager};
+    // Each tensor is aligned to 256 bytes
+    EXPECT_EQ(arena.getSizeInBytes(), 2 * 256);
+    EXPECT_NE(ids.get(), oldIds);
+    EXPECT_EQ(ids->getMemoryType(), MemoryType::kGPU);
+    EXPECT_EQ(ids->getShape().d[0], 4);
+    EXPECT_EQ(ids->getCapacity(), values.size());
+    EXPECT_EQ(static_cast<std::uint8_t*>(scores->data()) - static_cast<std::uint8_t*>(ids->data()), 256);
+    EXPECT_EQ(unused, nullptr);
+
+    std::vector<std::int32_t> copied(values.size());
+    mManager->copy(*ids, copied.data());
+    mManager->getStream().synchronize();
+    EXPECT_EQ(copied, values);
+
+    // Reshapes within the capacity keep the memory, larger ones fail instead of allocating
+    auto* data = ids->data();
+    ids->reshape(ITensor::makeShape({2, 8}));
+    EXPECT_EQ(ids->data(), data);
+    ids->reshape(ITensor::makeShape({32}));
+    EXPECT_EQ(ids->data(), data);
+    EXPECT_THROW(ids->reshape(ITensor::makeShape({5, 8})), std::bad_alloc);
+}
+
+TEST_F(BufferArenaTest, MixedMemoryTypes)
+{
+    BufferArena::TensorPtr device = mManager->gpu(ITensor::makeShape({4}), nvinfer1::DataType::kINT32);
+    BufferArena::TensorPtr host = BufferManager::cpu(ITensor::makeShape({4}), nvinfer1::DataType::kINT32);
+    EXPECT_THROW(BufferArena({&device, &host}, *mManager), tc::TllmException);
+}
@@ -19,8 +19,10 @@
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 
+#include <algorithm>
 #include <limits>
 #include <memory>
+#include <vector>
 
 using namespace tensorrt_llm::runtime;
 namespace tc = tensorrt_llm::common;
@@ -197,3 +199,29 @@ TEST_F(BufferManagerTest, TrimPoolOnDestruction)
     EXPECT_LE(memoryPoolReserved(), reserved);
     EXPECT_LE(memoryPoolFree(), free);
 }
+
+TEST_F(BufferManagerTest, StagedPageableCopies)
+{
+    BufferManager manager(mStream);
+    // More copies in flight than fit in the staging ring, each source is overwritten right after its copy
+    auto constexpr kNumCopies = 64;
+    auto constexpr kCopySize = 16 * 1024;
+    auto constexpr kNumValues = kCopySize / sizeof(std::int32_t);
+    IBuffer::SharedPtr device = manager.gpu(kNumCopies * kNumValues, nvinfer1::DataType::kINT32);
+    std::vector<std::int32_t> source(kNumValues);
+    for (auto i = 0; i < kNumCopies; ++i)
+    {
+        std::fill(source.begin(), source.end(), i);
+        auto slice = IBuffer::slice(device, i * kNumValues, kNumValues);
+        manager.copy(source.data(), *slice);
+        std::fill(source.begin(), source.end(), -1);
+    }
+    auto host = manager.copyFrom(*device, MemoryType::kPINNED);
+    manager.getStream().synchronize();
+    auto const* values = bufferCast<std::int32_t>(*host);
+    for (auto i = 0; i < kNumCopies; ++i)
+    {
+        EXPECT_EQ(values[i * kNumValues], i);
+        EXPECT_EQ(values[(i + 1) * kNumValues - 1], i);
+    }
+}
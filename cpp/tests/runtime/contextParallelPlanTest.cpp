@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/runtime/contextParallelPlan.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+TEST(ContextParallelPlanTest, zigzagShares)
+{
+    ContextParallelPlan const plan{2, 12};
+    EXPECT_EQ(plan.getPositions(0), (std::vector<SizeType32>{0, 1, 2, 9, 10, 11}));
+    EXPECT_EQ(plan.getPositions(1), (std::vector<SizeType32>{3, 4, 5, 6, 7, 8}));
+    EXPECT_EQ(plan.getMaxNumTokens(), 6);
+}
+
+TEST(ContextParallelPlanTest, sharesCoverThePrompt)
+{
+    for (SizeType32 const cpSize : {1, 3, 4, 8})
+    {
+        for (SizeType32 const promptLength : {0, 5, 31, 1000})
+        {
+            ContextParallelPlan const plan{cpSize, promptLength};
+            std::vector<int> owners(promptLength, 0);
+            SizeType32 minNumTokens{promptLength};
+            for (SizeType32 rank = 0; rank < cpSize; ++rank)
+            {
+                auto const positions = plan.getPositions(rank);
+                EXPECT_EQ(static_cast<SizeType32>(positions.size()), plan.getNumTokens(rank));
+                for (auto const pos : positions)
+                {
+                    ++owners.at(pos);
+                }
+                minNumTokens = std::min(minNumTokens, plan.getNumTokens(rank));
+            }
+            for (auto const count : owners)
+            {
+                EXPECT_EQ(count, 1);
+            }
+            // Each share has two chunks, which differ by one token at most
+            EXPECT_LE(plan.getMaxNumTokens() - minNumTokens, 2) << cpSize << " ranks, " << promptLength << " tokens";
+        }
+    }
+}
+
+TEST(ContextParallelPlanTest, ringVisitsEveryShare)
+{
+    ContextParallelPlan const plan{4, 64};
+    for (SizeType32 rank = 0; rank < 4; ++rank)
+    {
+        EXPECT_EQ(plan.getPrevRank(plan.getNextRank(rank)), rank);
+        std::vector<bool> visited(4, false);
+        for (SizeType32 step = 0; step < 4; ++step)
+        {
+            auto const source = plan.getSourceRank(rank, step);
+            visited[source] = true;
+            if (step > 0)
+            {
+                // The share held at a step is the one the previous rank held at the step before
+                EXPECT_EQ(source, plan.getSourceRank(plan.getPrevRank(rank), step - 1));
+            }
+        }
+        EXPECT_EQ(std::count(visited.begin(), visited.end(), true), 4);
+    }
+    EXPECT_EQ(plan.getSourceRank(0, 0), 0);
+    EXPECT_EQ(plan.getSourceRank(0, 1), 3);
+}
+
+TEST(ContextParallelPlanTest, invalidArguments)
+{
+    EXPECT_THROW(ContextParallelPlan(0, 16), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(ContextParallelPlan(2, -1), tensorrt_llm::common::TllmException);
+    ContextParallelPlan const plan{2, 16};
+    EXPECT_THROW(static_cast<void>(plan.getPositions(2)), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(static_cast<void>(plan.getSourceRank(0, 2)), tensorrt_llm::common::TllmException);
+}
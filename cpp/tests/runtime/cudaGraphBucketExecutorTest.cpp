@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/cudaGraphBucketExecutor.h"
+#include "tensorrt_llm/common/tllmException.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+TEST(CudaGraphBucketExecutor, buckets)
+{
+    EXPECT_EQ(CudaGraphBucketExecutor::makeBuckets(1), (std::vector<SizeType32>{1}));
+    EXPECT_EQ(CudaGraphBucketExecutor::makeBuckets(8), (std::vector<SizeType32>{1, 2, 4, 8}));
+    EXPECT_EQ(CudaGraphBucketExecutor::makeBuckets(12), (std::vector<SizeType32>{1, 2, 4, 8, 12}));
+
+    CudaGraphBucketExecutor executor{12};
+    EXPECT_EQ(executor.getBucket(1), 1);
+    EXPECT_EQ(executor.getBucket(3), 4);
+    EXPECT_EQ(executor.getBucket(8), 8);
+    EXPECT_EQ(executor.getBucket(9), 12);
+    EXPECT_EQ(executor.getNumPaddingSlots(5), 3);
+    EXPECT_THROW(static_cast<void>(executor.getBucket(0)), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(static_cast<void>(executor.getBucket(13)), tensorrt_llm::common::TllmException);
+    EXPECT_FALSE(executor.hasGraph(4));
+    EXPECT_THROW(executor.launch(4, CudaStream{}), tensorrt_llm::common::TllmException);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/encoderBatchPlanner.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+TEST(EncoderBatchPlannerTest, tokenBudget)
+{
+    EncoderBatchPlanner const planner{8, 100};
+    EXPECT_EQ(planner.plan(std::vector<SizeType32>{40, 30, 30, 1}), 3);
+    EXPECT_EQ(planner.plan(std::vector<SizeType32>{100, 1}), 1);
+    EXPECT_EQ(planner.plan(std::vector<SizeType32>{}), 0);
+}
+
+TEST(EncoderBatchPlannerTest, arrivalOrder)
+{
+    // The short request behind the long one waits, so that the long one isn't starved
+    EncoderBatchPlanner const planner{8, 100};
+    EXPECT_EQ(planner.plan(std::vector<SizeType32>{60, 50, 10}), 1);
+}
+
+TEST(EncoderBatchPlannerTest, batchSize)
+{
+    EncoderBatchPlanner const planner{2, 100};
+    EXPECT_EQ(planner.plan(std::vector<SizeType32>{1, 1, 1}), 2);
+}
+
+TEST(EncoderBatchPlannerTest, fits)
+{
+    EncoderBatchPlanner const planner{8, 100};
+    EXPECT_TRUE(planner.fits(1));
+    EXPECT_TRUE(planner.fits(100));
+    EXPECT_FALSE(planner.fits(0));
+    EXPECT_FALSE(planner.fits(101));
+    EXPECT_THROW(EncoderBatchPlanner(0, 100), tensorrt_llm::common::TllmException);
+}
@@ -242,7 +242,8 @@ TEST_P(ParamTest, Test)
 }
 
 INSTANTIATE_TEST_SUITE_P(DecoderTest, ParamTest,
-    testing::Combine(testing::Values(nvinfer1::DataType::kFLOAT, nvinfer1::DataType::kHALF), testing::Values(1, 3)),
+    testing::Combine(
+        testing::Values(nvinfer1::DataType::kFLOAT, nvinfer1::DataType::kHALF), testing::Values(1, 3, 128, 256)),
     [](testing::TestParamInfo<ParamTest::ParamType> const& info)
     {
         std::string name{std::get<0>(info.param) == nvinfer1::DataType::kFLOAT ? "Float" : "Half"};
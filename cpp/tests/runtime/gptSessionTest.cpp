@@ -95,6 +95,7 @@ public:
         , mPPSize(1)
         , mTPSize(1)
         , mRandomEndId(false)
+        , mDecoderOverlap(false)
     {
     }
 
@@ -140,6 +141,12 @@ public:
         return *this;
     }
 
+    ModelSpec& useDecoderOverlap()
+    {
+        mDecoderOverlap = true;
+        return *this;
+    }
+
     fs::path mModelPath;
     fs::path mResultsFile;
     nvinfer1::DataType mDataType;
@@ -150,6 +157,7 @@ public:
     int mPPSize;
     int mTPSize;
     bool mRandomEndId;
+    bool mDecoderOverlap;
 };
 
 struct MicroBatchSizes
@@ -301,6 +309,7 @@ void testGptSession(fs::path const& modelPath, ModelSpec const& modelSpec, Model
     sessionConfig.ctxMicroBatchSize = microBatchSizes.ctxMicroBatchSize;
     sessionConfig.genMicroBatchSize = microBatchSizes.genMicroBatchSize;
     sessionConfig.cudaGraphMode = cudaGraphMode;
+    sessionConfig.decoderOverlap = modelSpec.mDecoderOverlap;
     sessionConfig.kvCacheConfig.useUvm = false;
 
     GptSession session{sessionConfig, modelConfig, worldConfig, enginePath.string(), logger};
@@ -480,6 +489,8 @@ std::string generateTestName(testing::TestParamInfo<ParamType> const& info)
         name.append("TP" + std::to_string(modelSpec.mTPSize));
     if (modelSpec.mRandomEndId)
         name.append("EndId");
+    if (modelSpec.mDecoderOverlap)
+        name.append("DecoderOverlap");
     return name;
 }
 } // namespace
@@ -598,6 +609,58 @@ INSTANTIATE_TEST_SUITE_P(GptSessionTest, ParamTest,
         ),
     generateTestName);
 
+// The engine launch of a step doesn't wait for the decoder of the previous one. Also with micro batches, and with
+// pipeline parallelism, where the overlap is disabled.
+INSTANTIATE_TEST_SUITE_P(GptSessionDecoderOverlapTest, ParamTest,
+    testing::Combine(testing::Values(ModelParams{GPT_MODEL_DIR, {50256, 50256}}),
+        testing::Values(
+            ModelSpec{
+                FP16_GPT_ATTENTION_PACKED_PAGED_DIR, FP16_PLUGIN_PACKED_PAGED_RESULT_FILE, nvinfer1::DataType::kHALF}
+                .useGptAttentionPlugin()
+                .usePackedInput()
+                .usePagedKvCache()
+                .useDecoderOverlap(),
+            ModelSpec{
+                FP16_GPT_ATTENTION_PACKED_PAGED_DIR, FP16_PLUGIN_PACKED_PAGED_RESULT_FILE, nvinfer1::DataType::kHALF}
+                .useGptAttentionPlugin()
+                .usePackedInput()
+                .usePagedKvCache()
+                .useRandomEndId()
+                .useDecoderOverlap()
+
+                ),
+        testing::Values(1),           // beamWidth
+        testing::Values(false, true), // cudaGraphMode
+        testing::Values(MicroBatchSizes(), MicroBatchSizes{3, 3}, MicroBatchSizes{3, 6}),
+        testing::Values(false)        // isChatGlmTest
+        ),
+    generateTestName);
+
+INSTANTIATE_TEST_SUITE_P(LlamaSessionDecoderOverlapTest, ParamTest,
+    testing::Combine(testing::Values(ModelParams{LLAMA_MODEL_DIR, {2, 2}}),
+        testing::Values(
+            ModelSpec{
+                FP16_GPT_ATTENTION_PACKED_PAGED_DIR, FP16_PLUGIN_PACKED_PAGED_RESULT_FILE, nvinfer1::DataType::kHALF}
+                .useGptAttentionPlugin()
+                .usePackedInput()
+                .usePagedKvCache()
+                .useDecoderOverlap(),
+            ModelSpec{FP16_GPT_ATTENTION_PACKED_PAGED_DIR, FP16_PLUGIN_PACKED_PAGED_RESULT_TP1_PP4_FILE,
+                nvinfer1::DataType::kHALF}
+                .useGptAttentionPlugin()
+                .usePackedInput()
+                .usePagedKvCache()
+                .usePipelineParallelism(4)
+                .useDecoderOverlap()
+
+                ),
+        testing::Values(1),     // beamWidth
+        testing::Values(false), // cudaGraphMode
+        testing::Values(MicroBatchSizes(), MicroBatchSizes{3, 3}),
+        testing::Values(false)  // isChatGlmTest
+        ),
+    generateTestName);
+
 INSTANTIATE_TEST_SUITE_P(GptjSessionTest, ParamTest,
     testing::Combine(testing::Values(ModelParams{GPTJ_MODEL_DIR, {50256, 50256}}),
         testing::Values(
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/inProcessWorld.h"
+#include "tensorrt_llm/common/tllmException.h"
+
+#include <cuda_runtime_api.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+bool hasDevices(SizeType32 numDevices)
+{
+    int deviceCount{0};
+    return cudaGetDeviceCount(&deviceCount) == cudaSuccess && deviceCount >= numDevices;
+}
+} // namespace
+
+TEST(InProcessWorldTest, worldConfigs)
+{
+    InProcessWorld const world{2, 2, std::vector<SizeType32>{4, 5, 6, 7}};
+    EXPECT_EQ(world.getSize(), 4);
+    EXPECT_EQ(InProcessWorld::current(), nullptr);
+    EXPECT_THROW(static_cast<void>(InProcessWorld::currentRank()), tensorrt_llm::common::TllmException);
+
+    for (SizeType32 rank = 0; rank < world.getSize(); ++rank)
+    {
+        auto const worldConfig = world.getWorldConfig(rank);
+        EXPECT_EQ(worldConfig.getRank(), rank);
+        EXPECT_EQ(worldConfig.getTensorParallelism(), 2);
+        EXPECT_EQ(worldConfig.getPipelineParallelism(), 2);
+        EXPECT_EQ(worldConfig.getDevice(), 4 + rank);
+    }
+    EXPECT_THROW(InProcessWorld(2, 1, std::vector<SizeType32>{0}), tensorrt_llm::common::TllmException);
+}
+
+TEST(InProcessWorldTest, broadcast)
+{
+    if (!hasDevices(2))
+    {
+        GTEST_SKIP() << "Needs two devices";
+    }
+    InProcessWorld world{2, 1};
+    std::atomic<int> numCreated{0};
+    std::vector<std::vector<std::uint64_t>> received(world.getSize());
+    world.run(
+        [&](WorldConfig const& worldConfig)
+        {
+            auto* current = InProcessWorld::current();
+            ASSERT_EQ(current, &world);
+            EXPECT_EQ(InProcessWorld::currentRank(), worldConfig.getRank());
+            // The same key is exchanged repeatedly, each round gets the value of its root
+            for (std::uint64_t round = 0; round < 16; ++round)
+            {
+                received[worldConfig.getRank()].push_back(current->broadcastValue<std::uint64_t>("value", {0, 1},
+                    [&numCreated, round]()
+                    {
+                        ++numCreated;
+                        return 100 + round;
+                    }));
+            }
+        });
+    EXPECT_EQ(numCreated, 16);
+    for (auto const& values : received)
+    {
+        ASSERT_EQ(values.size(), 16u);
+        for (std::uint64_t round = 0; round < 16; ++round)
+        {
+            EXPECT_EQ(values[round], 100 + round);
+        }
+    }
+}
+
+TEST(InProcessWorldTest, sharedObjectsAndFailures)
+{
+    if (!hasDevices(2))
+    {
+        GTEST_SKIP() << "Needs two devices";
+    }
+    InProcessWorld world{2, 1};
+    std::vector<std::shared_ptr<int>> shared(world.getSize());
+    world.run(
+        [&shared](WorldConfig const& worldConfig)
+        {
+            shared[worldConfig.getRank()]
+                = InProcessWorld::current()->getShared<int>("cache", []() { return std::make_shared<int>(42); });
+        });
+    EXPECT_EQ(shared[0], shared[1]);
+    EXPECT_EQ(*shared[0], 42);
+
+    // The root fails, the other rank stops waiting for its value
+    auto const failingRun = [&world]()
+    {
+        world.run(
+            [](WorldConfig const& worldConfig)
+            {
+                if (worldConfig.getRank() == 0)
+                {
+                    TLLM_THROW("rank 0 failed");
+                }
+                static_cast<void>(
+                    InProcessWorld::current()->broadcastValue<int>("value", {0, 1}, []() { return 1; }));
+            });
+    };
+    EXPECT_THROW(failingRun(), tensorrt_llm::common::TllmException);
+}
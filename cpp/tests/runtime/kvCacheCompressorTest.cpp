@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheCompressor.h"
+#include "tensorrt_llm/common/tllmException.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+TEST(KvCacheCompressorTest, config)
+{
+    EXPECT_NO_THROW(KvCompressionConfig(16, 2, 4, 8));
+    // Nothing left for the middle tokens
+    EXPECT_THROW(KvCompressionConfig(6, 2, 4, 8), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(KvCompressionConfig(16, 2, 4, 0), tensorrt_llm::common::TllmException);
+}
+
+TEST(KvCacheCompressorTest, keepsAllWithinBudget)
+{
+    KvCompressionConfig const config{8, 1, 2, 4};
+    std::vector<float> const scores(8, 0.f);
+    EXPECT_EQ(
+        KvCacheCompressor::selectTokens(scores.data(), 8, config), (std::vector<SizeType32>{0, 1, 2, 3, 4, 5, 6, 7}));
+}
+
+TEST(KvCacheCompressorTest, keepsSinkRecentAndHeavyHitters)
+{
+    KvCompressionConfig const config{6, 2, 2, 4};
+    //                                  sink        middle                      recent
+    std::vector<float> const scores{0.f, 0.f, 0.1f, 0.9f, 0.2f, 0.5f, 0.3f, 0.f, 0.f, 0.f};
+    EXPECT_EQ(
+        KvCacheCompressor::selectTokens(scores.data(), 10, config), (std::vector<SizeType32>{0, 1, 3, 5, 8, 9}));
+}
+
+TEST(KvCacheCompressorTest, tiesKeepTheLaterTokens)
+{
+    KvCompressionConfig const config{4, 1, 1, 4};
+    std::vector<float> const scores(8, 1.f);
+    EXPECT_EQ(KvCacheCompressor::selectTokens(scores.data(), 8, config), (std::vector<SizeType32>{0, 5, 6, 7}));
+}
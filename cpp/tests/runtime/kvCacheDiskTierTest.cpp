@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheDiskTier.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+std::filesystem::path tierPath()
+{
+    auto const* info = ::testing::UnitTest::GetInstance()->current_test_info();
+    return std::filesystem::temp_directory_path() / (std::string("kvCacheDiskTierTest_") + info->name());
+}
+
+std::vector<std::uint8_t> makeBlock(std::size_t size, std::uint8_t value)
+{
+    return std::vector<std::uint8_t>(size, value);
+}
+} // namespace
+
+TEST(KVCacheDiskTierTest, storeAndLoad)
+{
+    auto const path = tierPath();
+    {
+        std::size_t constexpr blockSize = 1000;
+        KVCacheDiskTier tier(path, blockSize, 4);
+        EXPECT_TRUE(std::filesystem::exists(path));
+
+        auto const a = makeBlock(blockSize, 1);
+        auto const b = makeBlock(blockSize, 2);
+        tier.store(11, a.data());
+        tier.store(22, b.data());
+        EXPECT_EQ(tier.getNumBlocks(), 2);
+        EXPECT_TRUE(tier.contains(11));
+
+        std::vector<std::uint8_t> out(blockSize);
+        EXPECT_TRUE(tier.load(22, out.data()));
+        EXPECT_EQ(out, b);
+        EXPECT_TRUE(tier.load(11, out.data()));
+        EXPECT_EQ(out, a);
+        EXPECT_FALSE(tier.load(33, out.data()));
+
+        EXPECT_TRUE(tier.erase(11));
+        EXPECT_FALSE(tier.erase(11));
+        EXPECT_FALSE(tier.contains(11));
+
+        auto const stats = tier.getStats();
+        EXPECT_EQ(stats.numStored, 2);
+        EXPECT_EQ(stats.numHits, 2);
+        EXPECT_EQ(stats.numMisses, 1);
+        EXPECT_EQ(stats.numEvicted, 0);
+    }
+    // The backing file is removed with the tier.
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(KVCacheDiskTierTest, evictsLeastRecentlyUsed)
+{
+    std::size_t constexpr blockSize = 64;
+    KVCacheDiskTier tier(tierPath(), blockSize, 2);
+    auto const a = makeBlock(blockSize, 1);
+    auto const b = makeBlock(blockSize, 2);
+    auto const c = makeBlock(blockSize, 3);
+    std::vector<std::uint8_t> out(blockSize);
+
+    tier.store(1, a.data());
+    tier.store(2, b.data());
+    // Touching 1 makes 2 the eviction candidate.
+    EXPECT_TRUE(tier.load(1, out.data()));
+    tier.store(3, c.data());
+
+    EXPECT_EQ(tier.getNumBlocks(), 2);
+    EXPECT_TRUE(tier.contains(1));
+    EXPECT_FALSE(tier.contains(2));
+    EXPECT_TRUE(tier.load(3, out.data()));
+    EXPECT_EQ(out, c);
+    EXPECT_TRUE(tier.load(1, out.data()));
+    EXPECT_EQ(out, a);
+    EXPECT_EQ(tier.getStats().numEvicted, 1);
+}
+
+TEST(KVCacheDiskTierTest, concurrentStoreAndLoad)
+{
+    std::size_t constexpr blockSize = 4096;
+    SizeType32 constexpr maxNumBlocks = 8;
+    int constexpr numKeys = 32;
+    int constexpr numIters = 200;
+    KVCacheDiskTier tier(tierPath(), blockSize, maxNumBlocks);
+
+    // Fewer slots than keys, so offloads keep evicting blocks that other threads are loading.
+    auto const valueOf = [](KVCacheDiskTier::KeyType key) { return static_cast<std::uint8_t>(key * 7 + 1); };
+    std::atomic<int> numTorn{0};
+    std::atomic<int> numLoaded{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back(
+            [&, t]()
+            {
+                for (int i = 0; i < numIters; ++i)
+                {
+                    KVCacheDiskTier::KeyType const key = (t * numIters + i) % numKeys;
+                    auto const block = makeBlock(blockSize, valueOf(key));
+                    tier.store(key, block.data());
+                }
+            });
+        threads.emplace_back(
+            [&, t]()
+            {
+                std::vector<std::uint8_t> out(blockSize);
+                for (int i = 0; i < numIters; ++i)
+                {
+                    KVCacheDiskTier::KeyType const key = (t * 5 + i) % numKeys;
+                    if (tier.load(key, out.data()))
+                    {
+                        ++numLoaded;
+                        if (out != makeBlock(blockSize, valueOf(key)))
+                        {
+                            ++numTorn;
+                        }
+                    }
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(numTorn.load(), 0);
+    EXPECT_LE(tier.getNumBlocks(), maxNumBlocks);
+    auto const stats = tier.getStats();
+    EXPECT_EQ(stats.numHits, static_cast<std::size_t>(numLoaded.load()));
+    EXPECT_EQ(stats.numStored - stats.numEvicted, static_cast<std::size_t>(tier.getNumBlocks()));
+
+    // Every slot is usable again once all I/O has finished.
+    for (KVCacheDiskTier::KeyType key = 100; key < 100 + maxNumBlocks; ++key)
+    {
+        auto const block = makeBlock(blockSize, valueOf(key));
+        tier.store(key, block.data());
+    }
+    std::vector<std::uint8_t> out(blockSize);
+    for (KVCacheDiskTier::KeyType key = 100; key < 100 + maxNumBlocks; ++key)
+    {
+        EXPECT_TRUE(tier.load(key, out.data()));
+        EXPECT_EQ(out, makeBlock(blockSize, valueOf(key)));
+    }
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheTransferManager.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+
+class KVCacheTransferManagerTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "No GPUs found";
+        }
+        mStream = std::make_shared<CudaStream>();
+        mManager = std::make_unique<BufferManager>(mStream);
+        mPrimaryPool
+            = mManager->gpu(ITensor::makeShape({kNumPrimaryBlocks, kEltsPerBlock}), nvinfer1::DataType::kINT32);
+        mSecondaryPool = BufferManager::pinned(
+            ITensor::makeShape({kNumSecondaryBlocks, kEltsPerBlock}), nvinfer1::DataType::kINT32);
+    }
+
+    //! Fills primary block i with values starting at i * kEltsPerBlock.
+    void fillPrimaryPool()
+    {
+        auto host = BufferManager::pinned(mPrimaryPool->getShape(), nvinfer1::DataType::kINT32);
+        auto* hostPtr = bufferCast<std::int32_t>(*host);
+        std::iota(hostPtr, hostPtr + host->getSize(), 0);
+        mManager->copy(*host, *mPrimaryPool);
+        mStream->synchronize();
+    }
+
+    std::vector<std::int32_t> readPrimaryBlock(SizeType32 blockIdx)
+    {
+        auto host = mManager->copyFrom(*ITensor::slice(mPrimaryPool, blockIdx, 1), MemoryType::kCPU);
+        mStream->synchronize();
+        auto const* hostPtr = bufferCast<std::int32_t>(*host);
+        return {hostPtr, hostPtr + kEltsPerBlock};
+    }
+
+    static std::vector<std::int32_t> blockValues(SizeType32 blockIdx)
+    {
+        std::vector<std::int32_t> values(kEltsPerBlock);
+        std::iota(values.begin(), values.end(), blockIdx * kEltsPerBlock);
+        return values;
+    }
+
+    static SizeType32 constexpr kNumPrimaryBlocks{64};
+    static SizeType32 constexpr kNumSecondaryBlocks{48};
+    static SizeType32 constexpr kEltsPerBlock{256};
+
+    std::shared_ptr<CudaStream> mStream;
+    std::unique_ptr<BufferManager> mManager;
+    ITensor::SharedPtr mPrimaryPool;
+    ITensor::SharedPtr mSecondaryPool;
+};
+
+} // namespace
+
+TEST_F(KVCacheTransferManagerTest, offloadAndOnboard)
+{
+    fillPrimaryPool();
+    // Chunks of 5 moves use more launches than there are staging buffers.
+    KVCacheTransferManager transferManager{mPrimaryPool, mSecondaryPool, mStream, 5};
+
+    for (SizeType32 i = 0; i < 32; ++i)
+    {
+        transferManager.offload(i, kNumSecondaryBlocks - 1 - i);
+    }
+    EXPECT_EQ(transferManager.getNumPendingOffloads(), 32);
+    transferManager.submit();
+    EXPECT_EQ(transferManager.getNumPendingOffloads(), 0);
+    transferManager.syncMainStream();
+    mStream->synchronize();
+
+    auto const* secondaryPtr = bufferCast<std::int32_t>(*mSecondaryPool);
+    for (SizeType32 i = 0; i < 32; ++i)
+    {
+        auto const* block = secondaryPtr + (kNumSecondaryBlocks - 1 - i) * kEltsPerBlock;
+        EXPECT_EQ(std::vector<std::int32_t>(block, block + kEltsPerBlock), blockValues(i)) << i;
+    }
+
+    // Restore the offloaded blocks into the upper half of the primary pool.
+    for (SizeType32 i = 0; i < 32; ++i)
+    {
+        transferManager.onboard(kNumSecondaryBlocks - 1 - i, 32 + i);
+    }
+    transferManager.submit();
+    transferManager.syncMainStream();
+    for (SizeType32 i = 0; i < 32; ++i)
+    {
+        EXPECT_EQ(readPrimaryBlock(32 + i), blockValues(i)) << i;
+    }
+}
+
+TEST_F(KVCacheTransferManagerTest, onboardWaitsForMainStream)
+{
+    fillPrimaryPool();
+    KVCacheTransferManager transferManager{mPrimaryPool, mSecondaryPool, mStream};
+    auto* secondaryPtr = bufferCast<std::int32_t>(*mSecondaryPool);
+    std::fill_n(secondaryPtr, kEltsPerBlock, 7);
+
+    // The main stream is held by a host function, then overwrites primary block 3, e.g. the previous owner of the
+    // block finishing with it.
+    std::atomic<bool> release{false};
+    TLLM_CUDA_CHECK(cudaLaunchHostFunc(
+        mStream->get(),
+        [](void* userData)
+        {
+            auto const& flag = *static_cast<std::atomic<bool>*>(userData);
+            while (!flag.load())
+            {
+                std::this_thread::yield();
+            }
+        },
+        &release));
+    TLLM_CUDA_CHECK(cudaMemsetAsync(
+        bufferCast<std::int32_t>(*mPrimaryPool) + 3 * kEltsPerBlock, 0, sizeof(std::int32_t) * kEltsPerBlock,
+        mStream->get()));
+
+    // Onboarding block 3 must not run before the main stream is done with it.
+    transferManager.onboard(0, 3);
+    transferManager.submit();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    release = true;
+    transferManager.syncMainStream();
+    EXPECT_EQ(readPrimaryBlock(3), std::vector<std::int32_t>(kEltsPerBlock, 7));
+}
+
+TEST_F(KVCacheTransferManagerTest, offloadWaitsForMainStream)
+{
+    fillPrimaryPool();
+    KVCacheTransferManager transferManager{mPrimaryPool, mSecondaryPool, mStream};
+
+    std::atomic<bool> release{false};
+    TLLM_CUDA_CHECK(cudaLaunchHostFunc(
+        mStream->get(),
+        [](void* userData)
+        {
+            auto const& flag = *static_cast<std::atomic<bool>*>(userData);
+            while (!flag.load())
+            {
+                std::this_thread::yield();
+            }
+        },
+        &release));
+    // The forward pass writes the block before it is offloaded.
+    TLLM_CUDA_CHECK(cudaMemsetAsync(bufferCast<std::int32_t>(*mPrimaryPool) + 5 * kEltsPerBlock, 0,
+        sizeof(std::int32_t) * kEltsPerBlock, mStream->get()));
+
+    transferManager.offload(5, 9);
+    transferManager.submit();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    release = true;
+    transferManager.syncMainStream();
+    mStream->synchronize();
+    auto const* block = bufferCast<std::int32_t>(*mSecondaryPool) + 9 * kEltsPerBlock;
+    EXPECT_EQ(std::vector<std::int32_t>(block, block + kEltsPerBlock), std::vector<std::int32_t>(kEltsPerBlock, 0));
+}
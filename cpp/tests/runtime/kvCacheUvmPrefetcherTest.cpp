@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheUvmPrefetcher.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+using Ranges = std::vector<KvCacheUvmPrefetcher::BlockRange>;
+} // namespace
+
+TEST(KvCacheUvmPrefetcherTest, coalesceEmpty)
+{
+    EXPECT_TRUE(KvCacheUvmPrefetcher::coalesce({}).empty());
+}
+
+TEST(KvCacheUvmPrefetcherTest, coalesceContiguousBlocks)
+{
+    EXPECT_EQ(KvCacheUvmPrefetcher::coalesce({7, 3, 4, 5, 9, 8, 12}), (Ranges{{3, 3}, {7, 3}, {12, 1}}));
+}
+
+TEST(KvCacheUvmPrefetcherTest, coalesceSharedBlocks)
+{
+    // Beams share the blocks of their context
+    EXPECT_EQ(KvCacheUvmPrefetcher::coalesce({0, 1, 2, 0, 1, 3, 0, 1, 4}), (Ranges{{0, 5}}));
+}
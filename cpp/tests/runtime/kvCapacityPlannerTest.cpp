@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCapacityPlanner.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+namespace tle = tensorrt_llm::executor;
+
+namespace
+{
+ModelConfig makeModelConfig()
+{
+    ModelConfig modelConfig{1000, 4, 0, 8, 512, nvinfer1::DataType::kHALF};
+    modelConfig.setNbKvHeads(2);
+    modelConfig.usePagedKvCache(true);
+    modelConfig.setTokensPerBlock(16);
+    modelConfig.setMaxBatchSize(32);
+    modelConfig.setMaxBeamWidth(2);
+    modelConfig.setMaxInputLen(128);
+    modelConfig.setMaxSequenceLen(256);
+    return modelConfig;
+}
+
+// 2 * 4 layers * 2 KV heads * 64 per head * 2 bytes
+std::size_t constexpr kBYTES_PER_TOKEN = 2048;
+std::size_t constexpr kBYTES_PER_BLOCK = kBYTES_PER_TOKEN * 16;
+// 256 tokens * (2 ids + 1 log prob) * 4 bytes + 1000 vocab * 2 * 4 bytes
+std::size_t constexpr kDECODER_BYTES_PER_SEQUENCE = 256 * 12 + 1000 * 8;
+} // namespace
+
+TEST(KvCapacityPlannerTest, sizes)
+{
+    KvCapacityPlanner const planner{makeModelConfig(), WorldConfig{}};
+    EXPECT_EQ(planner.getKvBytesPerToken(), kBYTES_PER_TOKEN);
+    EXPECT_EQ(planner.getBytesPerBlock(), kBYTES_PER_BLOCK);
+    EXPECT_EQ(planner.getDecoderBytesPerSequence(), kDECODER_BYTES_PER_SEQUENCE);
+
+    // Halved by pipeline parallelism
+    KvCapacityPlanner const pipelined{makeModelConfig(), WorldConfig{1, 2, 0}};
+    EXPECT_EQ(pipelined.getKvBytesPerToken(), kBYTES_PER_TOKEN / 2);
+}
+
+TEST(KvCapacityPlannerTest, blocksPerSequence)
+{
+    KvCapacityPlanner const planner{makeModelConfig(), WorldConfig{}};
+    EXPECT_EQ(planner.getBlocksPerSequence(100, 28), 8);
+    EXPECT_EQ(planner.getBlocksPerSequence(100, 29), 9);
+    // Capped by the max sequence length
+    EXPECT_EQ(planner.getBlocksPerSequence(200, 200), 16);
+
+    // The full context blocks are shared by the beams
+    KvCapacityPlanner const beamPlanner{makeModelConfig(), WorldConfig{}, 2};
+    EXPECT_EQ(beamPlanner.getBlocksPerSequence(100, 28), 6 + 2 * 2);
+    EXPECT_THROW(KvCapacityPlanner(makeModelConfig(), WorldConfig{}, 4), tensorrt_llm::common::TllmException);
+}
+
+TEST(KvCapacityPlannerTest, plan)
+{
+    KvCapacityPlanner const planner{makeModelConfig(), WorldConfig{}};
+    KvCapacityPlanner::MemoryBudget budget;
+    budget.activationMemory = 1 << 20;
+    budget.workspaceMemory = 1 << 16;
+    budget.freeDeviceMemory = budget.activationMemory + budget.workspaceMemory + 32 * kDECODER_BYTES_PER_SEQUENCE
+        + 100 * kBYTES_PER_BLOCK + 1000;
+    budget.hostCacheMemory = 10 * kBYTES_PER_BLOCK;
+    budget.memoryFraction = 1.0f;
+
+    // Three quarters of the requests take 8 blocks, a quarter 16
+    std::vector<KvCapacityPlanner::WorkloadSample> const workload{{100, 28, 3.0f}, {200, 56, 1.0f}};
+    auto const plan = planner.plan(budget, workload);
+    EXPECT_EQ(plan.bytesPerBlock, kBYTES_PER_BLOCK);
+    EXPECT_EQ(plan.decoderMemory, 32 * kDECODER_BYTES_PER_SEQUENCE);
+    EXPECT_EQ(plan.numBlocks, 100);
+    EXPECT_EQ(plan.maxTokens, 1600);
+    EXPECT_EQ(plan.numSecondaryBlocks, 10);
+    EXPECT_DOUBLE_EQ(plan.meanBlocksPerSequence, 10.0);
+    EXPECT_EQ(plan.quantileBlocksPerSequence, 16);
+    EXPECT_EQ(plan.numConcurrentSequences, 10);
+    EXPECT_EQ(plan.numConcurrentSequencesAtQuantile, 6);
+    EXPECT_TRUE(plan.kvCacheBound);
+
+    // Bound by the max batch size of the engine with short requests
+    auto const shortPlan = planner.plan(budget, {{10, 6}});
+    EXPECT_EQ(shortPlan.numConcurrentSequences, 32);
+    EXPECT_FALSE(shortPlan.kvCacheBound);
+
+    // Nothing left for the KV cache
+    budget.freeDeviceMemory = budget.activationMemory;
+    EXPECT_THROW((void) planner.plan(budget, workload), tensorrt_llm::common::TllmException);
+}
+
+TEST(KvCapacityPlannerTest, configure)
+{
+    KvCapacityPlanner const planner{makeModelConfig(), WorldConfig{}};
+    KvCapacityPlanner::MemoryBudget budget;
+    budget.freeDeviceMemory = 32 * kDECODER_BYTES_PER_SEQUENCE + 100 * kBYTES_PER_BLOCK + (1 << 20);
+    budget.loraCacheMemory = 1 << 19;
+    budget.memoryFraction = 1.0f;
+    auto const plan = planner.plan(budget, {});
+    EXPECT_EQ(plan.numBlocks, 100 + static_cast<SizeType32>((1 << 19) / kBYTES_PER_BLOCK));
+    EXPECT_FLOAT_EQ(plan.loraDeviceCachePercent, 1.0f);
+
+    tle::ExecutorConfig executorConfig{1, tle::SchedulerConfig{}, tle::KvCacheConfig{true}};
+    planner.configure(executorConfig, plan, budget);
+    auto const kvCacheConfig = executorConfig.getKvCacheConfig();
+    EXPECT_TRUE(kvCacheConfig.getEnableBlockReuse());
+    EXPECT_EQ(kvCacheConfig.getMaxTokens(), plan.maxTokens);
+    EXPECT_EQ(kvCacheConfig.getFreeGpuMemoryFraction(), budget.memoryFraction);
+    ASSERT_TRUE(executorConfig.getPeftCacheConfig().has_value());
+    EXPECT_EQ(executorConfig.getPeftCacheConfig()->getDeviceCachePercent(), plan.loraDeviceCachePercent);
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/loraAdapterStore.h"
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/loraCache.h"
+#include "tensorrt_llm/runtime/loraCachePageManagerConfig.h"
+#include "tensorrt_llm/runtime/loraModule.h"
+#include "tensorrt_llm/runtime/utils/numpyUtils.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+auto const TEST_RESOURCE_PATH = fs::path{TOP_LEVEL_DIR} / "cpp/tests/resources/data";
+auto const TEST_SOURCE_LORA_TP2 = TEST_RESOURCE_PATH / "lora-test-weights-tp2/source.npy";
+auto const TEST_KEYS_LORA_TP2 = TEST_RESOURCE_PATH / "lora-test-weights-tp2/config.npy";
+} // namespace
+
+namespace tensorrt_llm::runtime
+{
+
+using TensorPtr = ITensor::SharedPtr;
+
+class LoraAdapterStoreTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    using TaskIdType = LoraAdapterStore::TaskIdType;
+
+    static TaskIdType constexpr kTaskId{1234};
+    static TaskIdType constexpr kOtherTaskId{5678};
+    static TaskIdType constexpr kMissingTaskId{99};
+
+    void SetUp() override
+    {
+        mModelConfig = std::make_unique<ModelConfig>(0, 2, 0, 1, 16, nvinfer1::DataType::kFLOAT);
+        mModelConfig->setMlpHiddenSize(32);
+        mWorldConfig = std::make_unique<WorldConfig>(2, 1, 0);
+        std::vector<LoraModule> modules{
+            LoraModule(LoraModule::ModuleType::kATTN_QKV, 16, 3 * 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kATTN_Q, 16, 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kATTN_K, 16, 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kATTN_V, 16, 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kATTN_DENSE, 16, 16, false, true, 1, -1),
+            LoraModule(LoraModule::ModuleType::kMLP_H_TO_4H, 16, 32, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kMLP_4H_TO_H, 32, 16, false, true, 1, -1),
+            LoraModule(LoraModule::ModuleType::kMLP_GATE, 16, 32, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kCROSS_ATTN_QKV, 16, 3 * 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kCROSS_ATTN_Q, 16, 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kCROSS_ATTN_K, 16, 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kCROSS_ATTN_V, 16, 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kCROSS_ATTN_DENSE, 16, 16, false, true, 1, -1),
+        };
+        mModelConfig->setLoraModules(modules);
+        mStream = std::make_shared<CudaStream>();
+        mManager = std::make_unique<BufferManager>(mStream);
+
+        mPageConfig = std::make_unique<LoraCachePageManagerConfig>(
+            runtime::MemoryType::kCPU, nvinfer1::DataType::kFLOAT, 2 * 8, 6, 64, 4 * 16, 1);
+        mPageConfig->setInitToZero(true);
+        mHostCache = makeCache();
+
+        // One directory per task id, the layout of the gptManagerBenchmark lora dir
+        auto const* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        mAdapterDir = fs::temp_directory_path() / (std::string("loraAdapterStoreTest_") + info->name());
+        fs::remove_all(mAdapterDir);
+        for (auto const taskId : {kTaskId, kOtherTaskId})
+        {
+            auto const taskDir = mAdapterDir / std::to_string(taskId);
+            fs::create_directories(taskDir);
+            fs::copy_file(TEST_SOURCE_LORA_TP2, taskDir / "model.lora_weights.npy");
+            fs::copy_file(TEST_KEYS_LORA_TP2, taskDir / "model.lora_config.npy");
+        }
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(mAdapterDir);
+    }
+
+    [[nodiscard]] std::shared_ptr<LoraCache> makeCache() const
+    {
+        return std::make_shared<LoraCache>(*mPageConfig, *mModelConfig, *mWorldConfig, *mManager);
+    }
+
+    //! \brief Expect the adapter of taskId in the host cache to match the one put from the source files directly.
+    void expectCached(TaskIdType taskId)
+    {
+        ASSERT_TRUE(mHostCache->has(taskId));
+        EXPECT_TRUE(mHostCache->isLoaded(taskId));
+        // Prefetched adapters are not in use, so they stay evictable
+        EXPECT_TRUE(mHostCache->isDone(taskId));
+
+        auto referenceCache = makeCache();
+        TensorPtr weights = utils::loadNpy(*mManager, TEST_SOURCE_LORA_TP2.string(), MemoryType::kCPU);
+        TensorPtr config = utils::loadNpy(*mManager, TEST_KEYS_LORA_TP2.string(), MemoryType::kCPU);
+        referenceCache->put(taskId, weights, config);
+
+        auto const& values = *mHostCache->get(taskId);
+        auto const& expectedValues = *referenceCache->get(taskId);
+        ASSERT_EQ(values.size(), expectedValues.size());
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            auto const& value = values.at(i);
+            auto const& expected = expectedValues.at(i);
+            EXPECT_EQ(value.adapterSize, expected.adapterSize);
+            EXPECT_EQ(value.moduleId, expected.moduleId);
+            EXPECT_EQ(value.layerId, expected.layerId);
+            ASSERT_EQ(value.inSize, expected.inSize);
+            ASSERT_EQ(value.outSize, expected.outSize);
+            auto const* in = reinterpret_cast<float const*>(value.weightsInPointer);
+            auto const* expectedIn = reinterpret_cast<float const*>(expected.weightsInPointer);
+            for (SizeType32 j = 0; j < value.inSize; ++j)
+            {
+                EXPECT_FLOAT_EQ(in[j], expectedIn[j]);
+            }
+            auto const* out = reinterpret_cast<float const*>(value.weightsOutPointer);
+            auto const* expectedOut = reinterpret_cast<float const*>(expected.weightsOutPointer);
+            for (SizeType32 j = 0; j < value.outSize; ++j)
+            {
+                EXPECT_FLOAT_EQ(out[j], expectedOut[j]);
+            }
+        }
+    }
+
+    std::shared_ptr<BufferManager> mManager;
+    BufferManager::CudaStreamPtr mStream;
+    std::unique_ptr<ModelConfig> mModelConfig;
+    std::unique_ptr<WorldConfig> mWorldConfig;
+    std::unique_ptr<LoraCachePageManagerConfig> mPageConfig;
+    std::shared_ptr<LoraCache> mHostCache;
+    fs::path mAdapterDir;
+};
+
+TEST_F(LoraAdapterStoreTest, contains)
+{
+    LoraAdapterStore store(mAdapterDir, mHostCache);
+    EXPECT_TRUE(store.contains(kTaskId));
+    EXPECT_TRUE(store.contains(kOtherTaskId));
+    EXPECT_FALSE(store.contains(kMissingTaskId));
+
+    EXPECT_THROW(LoraAdapterStore(mAdapterDir / "missing", mHostCache), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(LoraAdapterStore(mAdapterDir, nullptr), tensorrt_llm::common::TllmException);
+}
+
+TEST_F(LoraAdapterStoreTest, load)
+{
+    LoraAdapterStore store(mAdapterDir, mHostCache);
+    EXPECT_FALSE(mHostCache->has(kTaskId));
+    store.load(kTaskId);
+    EXPECT_EQ(store.getNumPendingLoads(), 0);
+    expectCached(kTaskId);
+    EXPECT_FALSE(mHostCache->has(kOtherTaskId));
+
+    // Loading again is served by the host cache
+    store.load(kTaskId);
+    EXPECT_EQ(store.getNumPendingLoads(), 0);
+    expectCached(kTaskId);
+}
+
+TEST_F(LoraAdapterStoreTest, prefetch)
+{
+    LoraAdapterStore store(mAdapterDir, mHostCache, 2);
+    auto first = store.prefetch(kTaskId);
+    auto second = store.prefetch(kTaskId);
+    // Prefetches of the same task share a single load
+    EXPECT_LE(store.getNumPendingLoads(), 1);
+    first.get();
+    second.get();
+    EXPECT_EQ(store.getNumPendingLoads(), 0);
+    expectCached(kTaskId);
+
+    auto cached = store.prefetch(kTaskId);
+    EXPECT_EQ(cached.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(store.getNumPendingLoads(), 0);
+}
+
+TEST_F(LoraAdapterStoreTest, prefetchMany)
+{
+    LoraAdapterStore store(mAdapterDir, mHostCache, 2);
+    store.prefetch(std::vector<TaskIdType>{kTaskId, kOtherTaskId});
+    // Loads of prefetched adapters are waited for rather than issued again
+    store.load(kTaskId);
+    store.load(kOtherTaskId);
+    EXPECT_EQ(store.getNumPendingLoads(), 0);
+    expectCached(kTaskId);
+    expectCached(kOtherTaskId);
+}
+
+TEST_F(LoraAdapterStoreTest, prefetchMissing)
+{
+    LoraAdapterStore store(mAdapterDir, mHostCache);
+    auto missing = store.prefetch(kMissingTaskId);
+    EXPECT_THROW(missing.get(), tensorrt_llm::common::TllmException);
+    EXPECT_EQ(store.getNumPendingLoads(), 0);
+    EXPECT_FALSE(mHostCache->has(kMissingTaskId));
+
+    // A failed load is not cached, the next attempt tries again
+    EXPECT_THROW(store.load(kMissingTaskId), tensorrt_llm::common::TllmException);
+}
+
+} // namespace tensorrt_llm::runtime
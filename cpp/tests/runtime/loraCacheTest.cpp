@@ -30,6 +30,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <cstring>
 #include <filesystem>
 #include <memory>
 
@@ -164,6 +165,47 @@ TEST_F(LoraCacheTest, LoraCachePageManagerTest)
     EXPECT_EQ(manager.pagePtr(singlePageId2.value().at(0))->data(), expectedPages.at(0)->data());
 }
 
+TEST_F(LoraCacheTest, LoraCachePageManagerBestFit)
+{
+    LoraCachePageManagerConfig config(runtime::MemoryType::kCPU, nvinfer1::DataType::kFLOAT, 8, 8, 4, 8, 1);
+    LoraCachePageManager manager(config, *mManager);
+
+    auto pages0 = manager.claimPages(2).value();
+    auto pages1 = manager.claimPages(3).value();
+    auto pages2 = manager.claimPages(3).value();
+    EXPECT_THAT(pages1, ::testing::ElementsAre(2, 3, 4));
+    manager.releasePages(pages0);
+    manager.releasePages(pages2);
+
+    auto stats = manager.getStats();
+    EXPECT_EQ(stats.numPages, 8);
+    EXPECT_EQ(stats.numFreePages, 5);
+    EXPECT_EQ(stats.numFreeRuns, 2);
+    EXPECT_EQ(stats.largestFreeRun, 3);
+    EXPECT_FLOAT_EQ(stats.getFragmentation(), 0.4f);
+
+    // The smallest run holding all pages is used
+    auto pages3 = manager.claimPages(2).value();
+    EXPECT_THAT(pages3, ::testing::ElementsAre(0, 1));
+    manager.releasePages(pages3);
+
+    // No run is large enough, the largest runs are used first
+    auto pages4 = manager.claimPages(4).value();
+    EXPECT_THAT(pages4, ::testing::ElementsAre(5, 6, 7, 0));
+    manager.releasePages(pages4);
+
+    // Compaction moves the claimed pages to the front
+    auto const moves = manager.compact();
+    ASSERT_EQ(moves.size(), 2);
+    EXPECT_EQ(moves[0], std::make_pair(std::size_t{4}, std::size_t{0}));
+    EXPECT_EQ(moves[1], std::make_pair(std::size_t{3}, std::size_t{1}));
+    stats = manager.getStats();
+    EXPECT_EQ(stats.numFreeRuns, 1);
+    EXPECT_EQ(stats.largestFreeRun, 5);
+    EXPECT_FLOAT_EQ(stats.getFragmentation(), 0.f);
+    EXPECT_THAT(manager.claimPages(5).value(), ::testing::ElementsAre(3, 4, 5, 6, 7));
+}
+
 TEST_F(LoraCacheTest, determineNumPages)
 {
     ModelConfig modelConfig(0, 2, 0, 1, 4, nvinfer1::DataType::kFLOAT);
@@ -356,6 +398,83 @@ TEST_F(LoraCacheTest, basicPutGet)
     }
 }
 
+TEST_F(LoraCacheTest, mapNpy)
+{
+    TensorPtr loaded = utils::loadNpy(*mManager, TEST_SOURCE_LORA_TP2.string(), MemoryType::kCPU);
+    for (bool const pinned : {false, true})
+    {
+        TensorPtr mapped = utils::mapNpy(TEST_SOURCE_LORA_TP2.string(), pinned);
+        EXPECT_EQ(mapped->getMemoryType(), pinned ? MemoryType::kPINNED : MemoryType::kCPU);
+        EXPECT_EQ(mapped->getDataType(), loaded->getDataType());
+        EXPECT_EQ(ITensor::toString(mapped->getShape()), ITensor::toString(loaded->getShape()));
+        ASSERT_EQ(mapped->getSizeInBytes(), loaded->getSizeInBytes());
+        EXPECT_EQ(std::memcmp(mapped->data(), loaded->data(), loaded->getSizeInBytes()), 0);
+
+        auto gpu = mManager->copyFrom(*mapped, MemoryType::kGPU);
+        auto host = mManager->copyFrom(*gpu, MemoryType::kCPU);
+        mStream->synchronize();
+        EXPECT_EQ(std::memcmp(host->data(), loaded->data(), loaded->getSizeInBytes()), 0);
+    }
+}
+
+TEST_F(LoraCacheTest, quantizedHostCache)
+{
+    TensorPtr loraReqWeights = utils::loadNpy(*mManager, TEST_SOURCE_LORA_TP2.string(), MemoryType::kCPU);
+    TensorPtr loraReqKeys = utils::loadNpy(*mManager, TEST_KEYS_LORA_TP2.string(), MemoryType::kCPU);
+
+    auto pageConfig = LoraCachePageManagerConfig(
+        runtime::MemoryType::kCPU, nvinfer1::DataType::kINT8, 2 * 8, 6, 64, 4 * 16, 1);
+    LoraCache quantCache(pageConfig, *mModelConfig, *mWorldConfig, *mManager);
+    EXPECT_LT(quantCache.getPagePtr(0)->getSizeInBytes(), mLoraCache->getPagePtr(0)->getSizeInBytes() / 2);
+
+    // Reference weights in the float host cache
+    mLoraCache->put(1234, loraReqWeights, loraReqKeys);
+    auto const& expectedValues = *mLoraCache->get(1234);
+    float amax = 0.f;
+    for (auto const& value : expectedValues)
+    {
+        auto const* expectedIn = reinterpret_cast<float const*>(value.weightsInPointer);
+        auto const* expectedOut = reinterpret_cast<float const*>(value.weightsOutPointer);
+        for (SizeType32 j = 0; j < value.inSize; ++j)
+        {
+            amax = std::max(amax, std::abs(expectedIn[j]));
+        }
+        for (SizeType32 j = 0; j < value.outSize; ++j)
+        {
+            amax = std::max(amax, std::abs(expectedOut[j]));
+        }
+    }
+    // INT8 rounding error is at most half a step of the group scale
+    auto const tolerance = amax / 254.f + 1e-6f;
+
+    quantCache.put(1234, loraReqWeights, loraReqKeys);
+    quantCache.copyTask(1234, *mLoraCache2);
+
+    auto const& values = *mLoraCache2->get(1234);
+    ASSERT_EQ(values.size(), expectedValues.size());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        auto const& value = values.at(i);
+        EXPECT_EQ(value, expectedValues.at(i));
+        auto const page = mLoraCache2->getPagePtr(value.pageId);
+        auto const hostPage = mManager->copyFrom(*page, runtime::MemoryType::kCPU);
+        auto const pageOffset = [&](std::int64_t pointer)
+        { return (pointer - reinterpret_cast<std::int64_t>(page->data())) / static_cast<std::int64_t>(sizeof(float)); };
+        float const* weightsIn = bufferCast<float>(*hostPage) + pageOffset(value.weightsInPointer);
+        float const* weightsOut = bufferCast<float>(*hostPage) + pageOffset(value.weightsOutPointer);
+        auto const* expectedIn = reinterpret_cast<float const*>(expectedValues.at(i).weightsInPointer);
+        auto const* expectedOut = reinterpret_cast<float const*>(expectedValues.at(i).weightsOutPointer);
+        for (SizeType32 j = 0; j < value.inSize; ++j)
+        {
+            EXPECT_NEAR(weightsIn[j], expectedIn[j], tolerance);
+        }
+        for (SizeType32 j = 0; j < value.outSize; ++j)
+        {
+            EXPECT_NEAR(weightsOut[j], expectedOut[j], tolerance);
+        }
+    }
+}
+
 TEST_F(LoraCacheTest, splitTransposeCpu)
 {
     auto modelConfig = ModelConfig(0, 2, 0, 1, 16, nvinfer1::DataType::kFLOAT);
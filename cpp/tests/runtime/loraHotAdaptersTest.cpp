@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/loraHotAdapters.h"
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+using TaskIdType = LoraHotAdapters::TaskIdType;
+using TaskIds = std::vector<std::optional<TaskIdType>>;
+} // namespace
+
+TEST(LoraHotAdaptersTest, HottestAdaptersUpToMaxNumHot)
+{
+    LoraHotAdapters hotAdapters{2, 0.5f, 0.f};
+    hotAdapters.record(1, 10);
+    hotAdapters.record(2, 300);
+    hotAdapters.record(3, 100);
+    hotAdapters.record(2, 100);
+    EXPECT_EQ(hotAdapters.step(), (std::vector<TaskIdType>{2, 3}));
+    EXPECT_TRUE(hotAdapters.isHot(3));
+    EXPECT_FALSE(hotAdapters.isHot(1));
+}
+
+TEST(LoraHotAdaptersTest, FollowsShiftOfTraffic)
+{
+    LoraHotAdapters hotAdapters{1, 0.5f, 0.f};
+    hotAdapters.record(1, 100);
+    EXPECT_EQ(hotAdapters.step(), std::vector<TaskIdType>{1});
+    // A single step of other traffic doesn't evict the hot adapter, a sustained one does
+    hotAdapters.record(2, 40);
+    EXPECT_EQ(hotAdapters.step(), std::vector<TaskIdType>{1});
+    hotAdapters.record(2, 40);
+    EXPECT_EQ(hotAdapters.step(), std::vector<TaskIdType>{2});
+}
+
+TEST(LoraHotAdaptersTest, IdleAdaptersCoolDown)
+{
+    LoraHotAdapters hotAdapters{4, 0.5f, 0.f};
+    hotAdapters.record(1, 1);
+    EXPECT_EQ(hotAdapters.step(), std::vector<TaskIdType>{1});
+    for (int i = 0; i < 16; ++i)
+    {
+        hotAdapters.step();
+    }
+    EXPECT_TRUE(hotAdapters.getHot().empty());
+}
+
+TEST(LoraHotAdaptersTest, MinShare)
+{
+    LoraHotAdapters hotAdapters{4, 0.5f, 0.25f};
+    hotAdapters.record(1, 70);
+    hotAdapters.record(2, 25);
+    hotAdapters.record(3, 5);
+    EXPECT_EQ(hotAdapters.step(), (std::vector<TaskIdType>{1, 2}));
+}
+
+TEST(LoraHotAdaptersTest, SingleAdapter)
+{
+    EXPECT_EQ(LoraHotAdapters::getSingleAdapter(TaskIds{3, 3, 3}), std::optional<TaskIdType>{3});
+    EXPECT_EQ(LoraHotAdapters::getSingleAdapter(std::vector<TaskIdType>{5}), std::optional<TaskIdType>{5});
+    // Mixed batches and requests without adapter use the lora plugin
+    EXPECT_FALSE(LoraHotAdapters::getSingleAdapter(TaskIds{3, 4, 3}));
+    EXPECT_FALSE(LoraHotAdapters::getSingleAdapter(TaskIds{3, std::nullopt}));
+    EXPECT_FALSE(LoraHotAdapters::getSingleAdapter(TaskIds{}));
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/utils/numaUtils.h"
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace tru = tensorrt_llm::runtime::utils;
+namespace tc = tensorrt_llm::common;
+
+TEST(NumaUtils, ParseCpuList)
+{
+    EXPECT_EQ(tru::parseCpuList("0-3,8,10-11"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(tru::parseCpuList("5,1-2,2"), (std::vector<int>{1, 2, 5}));
+    EXPECT_TRUE(tru::parseCpuList("").empty());
+    EXPECT_THROW(tru::parseCpuList("4-2"), tc::TllmException);
+}
+
+TEST(NumaUtils, ThreadAffinity)
+{
+    cpu_set_t original;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(original), &original), 0);
+    auto cpu = 0;
+    while (!CPU_ISSET(cpu, &original))
+    {
+        ++cpu;
+    }
+
+    EXPECT_TRUE(tru::setThreadAffinity({cpu}));
+    cpu_set_t pinned;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(pinned), &pinned), 0);
+    EXPECT_EQ(CPU_COUNT(&pinned), 1);
+    EXPECT_TRUE(CPU_ISSET(cpu, &pinned));
+
+    ASSERT_EQ(sched_setaffinity(0, sizeof(original), &original), 0);
+}
+
+TEST(NumaUtils, DeviceTopology)
+{
+    if (tc::getDeviceCount() == 0)
+    {
+        GTEST_SKIP() << "No GPU";
+    }
+    auto const node = tru::getDeviceNumaNode(0);
+    EXPECT_GE(node, -1);
+    for (auto const cpu : tru::getDeviceLocalCpus(0))
+    {
+        EXPECT_GE(cpu, 0);
+    }
+
+    // Binding untouched pages is allowed whether or not the host has several nodes
+    auto const size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(mapping, MAP_FAILED);
+    EXPECT_EQ(tru::bindMemoryToNode(mapping, size, node), node >= 0);
+    munmap(mapping, size);
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/numericSentinel.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <memory>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+constexpr std::uint32_t bit(SentinelSite site)
+{
+    return 1u << static_cast<std::uint32_t>(site);
+}
+
+class NumericSentinelTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mManager = std::make_unique<BufferManager>(mStream);
+    }
+
+    //! \brief A [numRows, rowSize] float tensor on the GPU with the value at the index.
+    ITensor::SharedPtr makeRows(SizeType32 numRows, SizeType32 rowSize, std::size_t index, float value)
+    {
+        std::vector<float> host(numRows * rowSize, 1.f);
+        if (index < host.size())
+        {
+            host[index] = value;
+        }
+        return mManager->copyFrom(host, ITensor::makeShape({numRows, rowSize}), MemoryType::kGPU);
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::unique_ptr<BufferManager> mManager;
+};
+
+} // namespace
+
+TEST_F(NumericSentinelTest, disabled)
+{
+    NumericSentinel sentinel{false, 0.f};
+    EXPECT_FALSE(sentinel.isEnabled());
+    auto const rows = makeRows(2, 8, 3, std::numeric_limits<float>::quiet_NaN());
+    sentinel.check(SentinelSite::kLOGITS, rows->data(), rows->getDataType(), 2, 8, mStream->get());
+    mStream->synchronize();
+    EXPECT_EQ(sentinel.poll(), 0);
+}
+
+TEST_F(NumericSentinelTest, cleanValues)
+{
+    NumericSentinel sentinel{true, 0.f};
+    ASSERT_TRUE(sentinel.isEnabled());
+    auto const rows = makeRows(4, 1000, 0, 65000.f);
+    sentinel.check(SentinelSite::kATTENTION_OUTPUT, rows->data(), rows->getDataType(), 4, 1000, mStream->get());
+    mStream->synchronize();
+    EXPECT_EQ(sentinel.poll(), 0);
+    EXPECT_EQ(sentinel.getNumDetections(SentinelSite::kATTENTION_OUTPUT), 0);
+}
+
+TEST_F(NumericSentinelTest, nonFiniteValues)
+{
+    NumericSentinel sentinel{true, 0.f};
+    auto const nanRows = makeRows(4, 1000, 2500, std::numeric_limits<float>::quiet_NaN());
+    auto const infRows = makeRows(3, 100, 0, -std::numeric_limits<float>::infinity());
+    sentinel.check(SentinelSite::kATTENTION_OUTPUT, nanRows->data(), nanRows->getDataType(), 4, 1000, mStream->get());
+    sentinel.check(SentinelSite::kMOE_OUTPUT, infRows->data(), infRows->getDataType(), 3, 100, mStream->get());
+    mStream->synchronize();
+    EXPECT_EQ(sentinel.poll(), bit(SentinelSite::kATTENTION_OUTPUT) | bit(SentinelSite::kMOE_OUTPUT));
+    EXPECT_EQ(sentinel.getNumDetections(SentinelSite::kATTENTION_OUTPUT), 1);
+    EXPECT_EQ(sentinel.getNumDetections(SentinelSite::kMOE_OUTPUT), 1);
+    // Cleared by the poll
+    EXPECT_EQ(sentinel.poll(), 0);
+}
+
+TEST_F(NumericSentinelTest, overflow)
+{
+    NumericSentinel sentinel{true, 60000.f};
+    auto const rows = makeRows(2, 16, 20, 65000.f);
+    sentinel.check(SentinelSite::kMOE_OUTPUT, rows->data(), rows->getDataType(), 2, 16, mStream->get());
+    mStream->synchronize();
+    EXPECT_EQ(sentinel.poll(), bit(SentinelSite::kMOE_OUTPUT));
+}
+
+TEST_F(NumericSentinelTest, rowFlags)
+{
+    NumericSentinel sentinel{true, 0.f};
+    SizeType32 constexpr numRows = 8;
+    SizeType32 constexpr rowSize = 64;
+    auto const rows = makeRows(numRows, rowSize, 5 * rowSize + 7, std::numeric_limits<float>::infinity());
+    auto const rowFlags = BufferManager::pinned(ITensor::makeShape({numRows}), nvinfer1::DataType::kINT32);
+    auto* flags = bufferCast<std::int32_t>(*rowFlags);
+    std::fill_n(flags, numRows, 0);
+    sentinel.check(
+        SentinelSite::kENCODER_OUTPUT, rows->data(), rows->getDataType(), numRows, rowSize, mStream->get(), flags);
+    mStream->synchronize();
+    EXPECT_EQ(sentinel.poll(), bit(SentinelSite::kENCODER_OUTPUT));
+    for (SizeType32 row = 0; row < numRows; ++row)
+    {
+        EXPECT_EQ(flags[row], row == 5 ? 1 : 0) << "row " << row;
+    }
+}
+
+TEST_F(NumericSentinelTest, slots)
+{
+    NumericSentinel sentinel{true, 0.f};
+    auto const clean = makeRows(2, 512, 0, 1.f);
+    auto const nan = makeRows(2, 512, 700, std::numeric_limits<float>::quiet_NaN());
+    sentinel.checkSlot(SentinelSite::kLOGITS, 0, clean->data(), clean->getDataType(), clean->getSize(), mStream->get());
+    sentinel.checkSlot(SentinelSite::kLOGITS, 3, nan->data(), nan->getDataType(), nan->getSize(), mStream->get());
+    mStream->synchronize();
+    EXPECT_EQ(sentinel.poll(), bit(SentinelSite::kLOGITS));
+    EXPECT_EQ(sentinel.getLastFlaggedSlots(), std::vector<SizeType32>{3});
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/pluginTimer.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+void launch(PluginTimer& timer, PluginKind kind, CudaStream const& stream, void* buffer)
+{
+    auto const timingScope = timer.scope(kind, stream.get());
+    TLLM_CUDA_CHECK(cudaMemsetAsync(buffer, 0, 1 << 20, stream.get()));
+}
+
+} // namespace
+
+TEST(PluginTimer, names)
+{
+    EXPECT_STREQ(toString(PluginKind::kATTENTION), "attention");
+    EXPECT_STREQ(toString(PluginKind::kALL_REDUCE), "all_reduce");
+}
+
+TEST(PluginTimer, disabled)
+{
+    PluginTimer timer{0};
+    CudaStream stream;
+    void* buffer{nullptr};
+    TLLM_CUDA_CHECK(cudaMalloc(&buffer, 1 << 20));
+    for (int i = 0; i < 4; ++i)
+    {
+        timer.beginExecution();
+        EXPECT_FALSE(timer.isSampling());
+        launch(timer, PluginKind::kGEMM, stream, buffer);
+    }
+    stream.synchronize();
+    EXPECT_EQ(timer.getNumSampledExecutions(), 0);
+    EXPECT_EQ(timer.getStats()[static_cast<std::size_t>(PluginKind::kGEMM)].numLaunches, 0);
+    TLLM_CUDA_CHECK(cudaFree(buffer));
+}
+
+TEST(PluginTimer, sampledExecutions)
+{
+    PluginTimer timer{3};
+    CudaStream stream;
+    void* buffer{nullptr};
+    TLLM_CUDA_CHECK(cudaMalloc(&buffer, 1 << 20));
+    for (int i = 0; i < 7; ++i)
+    {
+        timer.beginExecution();
+        EXPECT_EQ(timer.isSampling(), i % 3 == 0);
+        launch(timer, PluginKind::kGEMM, stream, buffer);
+        launch(timer, PluginKind::kGEMM, stream, buffer);
+        launch(timer, PluginKind::kMOE, stream, buffer);
+    }
+    stream.synchronize();
+    EXPECT_EQ(timer.getNumSampledExecutions(), 3);
+
+    auto const stats = timer.getStats();
+    auto const& gemm = stats[static_cast<std::size_t>(PluginKind::kGEMM)];
+    EXPECT_EQ(gemm.numLaunches, 6);
+    EXPECT_GE(gemm.totalMs, 0.0);
+    EXPECT_LE(gemm.maxMs, gemm.totalMs);
+    EXPECT_EQ(stats[static_cast<std::size_t>(PluginKind::kMOE)].numLaunches, 3);
+    EXPECT_EQ(stats[static_cast<std::size_t>(PluginKind::kATTENTION)].numLaunches, 0);
+    TLLM_CUDA_CHECK(cudaFree(buffer));
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/probsTruncationConfig.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tr = tensorrt_llm::runtime;
+namespace tl = tensorrt_llm::layers;
+
+TEST(ProbsTruncationConfigTest, fuseConfigs)
+{
+    tr::ProbsTruncationConfig withMinP;
+    withMinP.minP = std::vector<float>{0.1f};
+    tr::ProbsTruncationConfig withTypicalP;
+    withTypicalP.typicalP = std::vector<float>{0.9f};
+
+    tr::ProbsTruncationConfig const fused({withMinP, withTypicalP, tr::ProbsTruncationConfig{}});
+    EXPECT_THAT(fused.minP.value(),
+        testing::ElementsAre(0.1f, tl::DefaultDecodingParams::getMinP(), tl::DefaultDecodingParams::getMinP()));
+    EXPECT_THAT(fused.typicalP.value(),
+        testing::ElementsAre(
+            tl::DefaultDecodingParams::getTypicalP(), 0.9f, tl::DefaultDecodingParams::getTypicalP()));
+    EXPECT_FALSE(fused.etaCutoff.has_value());
+    EXPECT_TRUE(fused.validate());
+}
+
+TEST(ProbsTruncationConfigTest, fuseDefaultConfigs)
+{
+    tr::ProbsTruncationConfig const fused({tr::ProbsTruncationConfig{}, tr::ProbsTruncationConfig{}});
+    EXPECT_EQ(fused, tr::ProbsTruncationConfig{});
+}
+
+TEST(ProbsTruncationConfigTest, validate)
+{
+    tr::ProbsTruncationConfig config;
+    config.minP = std::vector<float>{0.f, 1.f};
+    config.typicalP = std::vector<float>{1.f};
+    config.etaCutoff = std::vector<float>{0.f};
+    EXPECT_TRUE(config.validate());
+
+    config.typicalP = std::vector<float>{0.f};
+    EXPECT_FALSE(config.validate());
+
+    config.typicalP = std::nullopt;
+    config.etaCutoff = std::vector<float>{1.f};
+    EXPECT_FALSE(config.validate());
+
+    config.etaCutoff = std::nullopt;
+    config.minP = std::vector<float>{1.5f};
+    EXPECT_FALSE(config.validate());
+}
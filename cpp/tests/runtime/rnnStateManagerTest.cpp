@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/rnnStateManager.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+namespace tc = tensorrt_llm::common;
+
+class RnnStateManagerTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "No GPU";
+        }
+        mStream = std::make_shared<CudaStream>();
+        mModelConfig.setModelVariant(ModelConfig::ModelVariant::kMamba);
+        mModelConfig.setRnnConfig({kStateSize, kConvKernel, kRnnHiddenSize});
+        mModelConfig.setLayerTypes(std::vector<ModelConfig::LayerType>(kNbLayers, ModelConfig::LayerType::kRECURRENT));
+        mModelConfig.usePagedState(true);
+    }
+
+    //! \returns The SSM state of slot in every layer.
+    std::vector<float> getRnnState(RnnStateManager const& manager, SizeType32 slot) const
+    {
+        BufferManager bufferManager{mStream};
+        auto const pool = bufferManager.copyFrom(*manager.getRnnStates(), MemoryType::kCPU);
+        mStream->synchronize();
+        auto const* data = bufferCast<float>(*pool);
+        auto const slotSize = kStateSize * kRnnHiddenSize;
+        std::vector<float> state;
+        for (SizeType32 layer = 0; layer < kNbLayers; ++layer)
+        {
+            auto const* begin = data + (layer * manager.getMaxNumSlots() + slot) * slotSize;
+            state.insert(state.end(), begin, begin + slotSize);
+        }
+        return state;
+    }
+
+    void fillRnnState(RnnStateManager const& manager, SizeType32 slot, float value) const
+    {
+        BufferManager bufferManager{mStream};
+        std::vector<float> const state(kStateSize * kRnnHiddenSize, value);
+        for (SizeType32 layer = 0; layer < kNbLayers; ++layer)
+        {
+            auto view = ITensor::slice(manager.getRnnStates(), layer * manager.getMaxNumSlots() + slot, 1);
+            bufferManager.copy(state.data(), *view);
+        }
+        mStream->synchronize();
+    }
+
+    static auto constexpr kNbLayers = 2;
+    static auto constexpr kStateSize = 4;
+    static auto constexpr kConvKernel = 4;
+    static auto constexpr kRnnHiddenSize = 8;
+
+    BufferManager::CudaStreamPtr mStream;
+    ModelConfig mModelConfig{32, 0, kNbLayers, 1, kRnnHiddenSize, nvinfer1::DataType::kFLOAT};
+    WorldConfig mWorldConfig{};
+};
+
+TEST_F(RnnStateManagerTest, Slots)
+{
+    RnnStateManager manager{2, mModelConfig, mWorldConfig, mStream};
+    EXPECT_EQ(manager.getNumFreeSlots(), 2);
+    EXPECT_EQ(manager.addRequest(10), 0);
+    EXPECT_EQ(manager.addRequest(11), 1);
+    EXPECT_THROW(manager.addRequest(12), tc::TllmException);
+    EXPECT_THROW(manager.addRequest(10), tc::TllmException);
+
+    auto slotMapping = BufferManager::cpu(ITensor::makeShape({2}), nvinfer1::DataType::kINT32);
+    manager.fillSlotMapping(*slotMapping, {11, 10});
+    EXPECT_EQ(bufferCast<std::int32_t>(*slotMapping)[0], 1);
+    EXPECT_EQ(bufferCast<std::int32_t>(*slotMapping)[1], 0);
+
+    manager.removeRequest(10);
+    EXPECT_FALSE(manager.getSlot(10).has_value());
+    EXPECT_EQ(manager.addRequest(12), 0);
+
+    RnnStateManager::TensorMap inputBuffers;
+    manager.getPtrBuffers(inputBuffers, mModelConfig, mWorldConfig);
+    EXPECT_EQ(inputBuffers.count("rnn_state_ptr_0"), 1);
+    EXPECT_EQ(inputBuffers.count("conv_state_ptr_1"), 1);
+}
+
+TEST_F(RnnStateManagerTest, OffloadAndOnboard)
+{
+    RnnStateManager manager{1, mModelConfig, mWorldConfig, mStream};
+    auto const slot = manager.addRequest(1);
+    fillRnnState(manager, slot, 3.F);
+
+    manager.offloadRequest(1);
+    EXPECT_TRUE(manager.isOffloaded(1));
+    EXPECT_FALSE(manager.getSlot(1).has_value());
+    // The freed slot is zeroed for the next request
+    EXPECT_EQ(manager.addRequest(2), slot);
+    auto const zeros = getRnnState(manager, slot);
+    EXPECT_TRUE(std::all_of(zeros.begin(), zeros.end(), [](float v) { return v == 0.F; }));
+    manager.removeRequest(2);
+
+    EXPECT_EQ(manager.onboardRequest(1), slot);
+    EXPECT_FALSE(manager.isOffloaded(1));
+    auto const state = getRnnState(manager, slot);
+    EXPECT_TRUE(std::all_of(state.begin(), state.end(), [](float v) { return v == 3.F; }));
+}
+
+TEST_F(RnnStateManagerTest, PrefixSnapshots)
+{
+    RnnStateManager manager{3, mModelConfig, mWorldConfig, mStream};
+    auto const prefixSlot = manager.addRequest(1);
+    fillRnnState(manager, prefixSlot, 5.F);
+    manager.saveSnapshot(42, 1);
+    EXPECT_TRUE(manager.hasSnapshot(42));
+    EXPECT_EQ(manager.getNumFreeSlots(), 1);
+    manager.removeRequest(1);
+
+    auto const slot = manager.addRequest(2);
+    EXPECT_FALSE(manager.restoreSnapshot(7, 2));
+    EXPECT_TRUE(manager.restoreSnapshot(42, 2));
+    auto const state = getRnnState(manager, slot);
+    EXPECT_TRUE(std::all_of(state.begin(), state.end(), [](float v) { return v == 5.F; }));
+
+    // Requests take the slot of the least recently used snapshot when none is free
+    manager.addRequest(3);
+    EXPECT_EQ(manager.getNumFreeSlots(), 0);
+    manager.addRequest(4);
+    EXPECT_FALSE(manager.hasSnapshot(42));
+    EXPECT_FALSE(manager.dropSnapshot(42));
+}
@@ -27,9 +27,11 @@
 #include <NvInferRuntime.h>
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <numeric>
+#include <random>
 #include <vector>
 
 using namespace tensorrt_llm::runtime;
@@ -998,3 +1000,381 @@ TEST_F(RuntimeKernelTest, CopyBatchStride5)
 {
     testCopyBatch(5, *mManager, *mStream);
 }
+
+namespace
+{
+void testGatherLastTokenLogits(bool packed, SizeType32 vocabSizePadded, BufferManager& manager, CudaStream& stream)
+{
+    std::vector<SizeType32> const contextLengths{5, 1, 3};
+    auto const batchSize = static_cast<SizeType32>(contextLengths.size());
+    SizeType32 constexpr beamWidth{2};
+    auto const maxInputLength = *std::max_element(contextLengths.begin(), contextLengths.end());
+    auto const numTokens = std::accumulate(contextLengths.begin(), contextLengths.end(), SizeType32{0});
+
+    // Row r of the input holds r * vocabSizePadded + [0, vocabSizePadded)
+    auto const inputShape = packed ? ITensor::makeShape({numTokens, vocabSizePadded})
+                                   : ITensor::makeShape({batchSize, maxInputLength, vocabSizePadded});
+    std::vector<float> input(ITensor::volume(inputShape));
+    std::iota(input.begin(), input.end(), 0.f);
+    std::vector<SizeType32> lastTokenIds(contextLengths);
+    std::vector<SizeType32> lastRows(batchSize);
+    if (packed)
+    {
+        std::partial_sum(contextLengths.begin(), contextLengths.end(), lastTokenIds.begin());
+    }
+    for (SizeType32 b = 0; b < batchSize; ++b)
+    {
+        lastRows[b] = lastTokenIds[b] - 1 + (packed ? 0 : b * maxInputLength);
+    }
+
+    auto inputTensor = manager.copyFrom(input, inputShape, MemoryType::kGPU);
+    auto lastTokenIdsTensor = manager.copyFrom(lastTokenIds, ITensor::makeShape({batchSize}), MemoryType::kGPU);
+    auto outputTensor
+        = manager.gpu(ITensor::makeShape({batchSize, beamWidth, vocabSizePadded}), nvinfer1::DataType::kFLOAT);
+
+    kernels::gatherLastTokenLogits(*outputTensor, *inputTensor, *lastTokenIdsTensor, packed, stream);
+
+    auto outputHost = manager.copyFrom(*outputTensor, MemoryType::kCPU);
+    auto outputPtr = bufferCast<float>(*outputHost);
+    for (SizeType32 b = 0; b < batchSize; ++b)
+    {
+        for (SizeType32 beam = 0; beam < beamWidth; ++beam)
+        {
+            for (SizeType32 v = 0; v < vocabSizePadded; ++v)
+            {
+                auto const outputIdx = tc::flat_index3(b, beam, v, beamWidth, vocabSizePadded);
+                EXPECT_EQ(outputPtr[outputIdx], input[tc::flat_index2(lastRows[b], v, vocabSizePadded)])
+                    << "Error at index (" << b << ',' << beam << ',' << v << ')';
+            }
+        }
+    }
+}
+} // namespace
+
+TEST_F(RuntimeKernelTest, GatherLastTokenLogitsPacked)
+{
+    testGatherLastTokenLogits(true, 64, *mManager, *mStream);
+    testGatherLastTokenLogits(true, 13, *mManager, *mStream);
+}
+
+TEST_F(RuntimeKernelTest, GatherLastTokenLogitsPadded)
+{
+    testGatherLastTokenLogits(false, 64, *mManager, *mStream);
+    testGatherLastTokenLogits(false, 13, *mManager, *mStream);
+}
+
+namespace
+{
+void testGatherPromptLogProbs(bool packed, SizeType32 vocabSize, BufferManager& manager, CudaStream& stream)
+{
+    std::vector<SizeType32> const contextLengths{5, 1, 3};
+    auto const batchSize = static_cast<SizeType32>(contextLengths.size());
+    auto const vocabSizePadded = vocabSize + 3;
+    auto const maxInputLength = *std::max_element(contextLengths.begin(), contextLengths.end());
+    auto const numTokens = std::accumulate(contextLengths.begin(), contextLengths.end(), SizeType32{0});
+    auto const numRows = packed ? numTokens : batchSize * maxInputLength;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> logitDist(-4.f, 4.f);
+    std::uniform_int_distribution<TokenIdType> tokenDist(0, vocabSize - 1);
+    std::vector<float> logits(numRows * vocabSizePadded);
+    std::generate(logits.begin(), logits.end(), [&]() { return logitDist(gen); });
+    std::vector<TokenIdType> inputIds(numRows);
+    std::generate(inputIds.begin(), inputIds.end(), [&]() { return tokenDist(gen); });
+
+    auto const logitsShape = packed ? ITensor::makeShape({numTokens, vocabSizePadded})
+                                    : ITensor::makeShape({batchSize, maxInputLength, vocabSizePadded});
+    auto const idsShape = packed ? ITensor::makeShape({numTokens}) : ITensor::makeShape({batchSize, maxInputLength});
+    auto logitsTensor = manager.copyFrom(logits, logitsShape, MemoryType::kGPU);
+    auto idsTensor = manager.copyFrom(inputIds, idsShape, MemoryType::kGPU);
+    auto lengthsTensor = manager.copyFrom(contextLengths, ITensor::makeShape({batchSize}), MemoryType::kGPU);
+    auto outputTensor = manager.gpu(ITensor::makeShape({batchSize, maxInputLength}), nvinfer1::DataType::kFLOAT);
+
+    kernels::gatherPromptLogProbs(*outputTensor, *logitsTensor, *idsTensor, *lengthsTensor, vocabSize, packed, stream);
+
+    auto outputHost = manager.copyFrom(*outputTensor, MemoryType::kCPU);
+    auto outputPtr = bufferCast<float>(*outputHost);
+    SizeType32 seqOffset{0};
+    for (SizeType32 b = 0; b < batchSize; ++b)
+    {
+        if (!packed)
+        {
+            seqOffset = b * maxInputLength;
+        }
+        for (SizeType32 t = 0; t < maxInputLength; ++t)
+        {
+            float expected{0.f};
+            if (t > 0 && t < contextLengths[b])
+            {
+                auto const* row = logits.data() + static_cast<std::size_t>(seqOffset + t - 1) * vocabSizePadded;
+                auto const maxVal = *std::max_element(row, row + vocabSize);
+                double sumExp{0};
+                for (SizeType32 v = 0; v < vocabSize; ++v)
+                {
+                    sumExp += std::exp(row[v] - maxVal);
+                }
+                expected = row[inputIds[seqOffset + t]] - maxVal - static_cast<float>(std::log(sumExp));
+            }
+            EXPECT_NEAR(outputPtr[tc::flat_index2(b, t, maxInputLength)], expected, 1e-4f)
+                << "Error at index (" << b << ',' << t << ')';
+        }
+        if (packed)
+        {
+            seqOffset += contextLengths[b];
+        }
+    }
+}
+} // namespace
+
+TEST_F(RuntimeKernelTest, GatherPromptLogProbsPacked)
+{
+    testGatherPromptLogProbs(true, 1000, *mManager, *mStream);
+    testGatherPromptLogProbs(true, 13, *mManager, *mStream);
+}
+
+TEST_F(RuntimeKernelTest, GatherPromptLogProbsPadded)
+{
+    testGatherPromptLogProbs(false, 1000, *mManager, *mStream);
+    testGatherPromptLogProbs(false, 13, *mManager, *mStream);
+}
+
+namespace
+{
+void testCopyBlocks(SizeType32 numBlocks, SizeType32 eltsPerBlock, BufferManager& manager, CudaStream& stream)
+{
+    auto srcHost = BufferManager::pinned(ITensor::makeShape({numBlocks, eltsPerBlock}), nvinfer1::DataType::kINT32);
+    auto srcHostPtr = bufferCast<std::int32_t>(*srcHost);
+    std::iota(srcHostPtr, srcHostPtr + numBlocks * eltsPerBlock, 0);
+    auto srcDevice = manager.copyFrom(*srcHost, MemoryType::kGPU);
+    auto dstDevice = manager.gpu(ITensor::makeShape({numBlocks, eltsPerBlock}), nvinfer1::DataType::kINT32);
+    kernels::invokeFill(*dstDevice, std::int32_t{-1}, stream);
+
+    // Every other block is copied, in reverse order.
+    auto const numCopies = numBlocks / 2;
+    auto pairs = BufferManager::pinned(ITensor::makeShape({numCopies, 2}), nvinfer1::DataType::kINT32);
+    auto pairsPtr = bufferCast<std::int32_t>(*pairs);
+    for (SizeType32 i = 0; i < numCopies; ++i)
+    {
+        pairsPtr[2 * i] = 2 * i;
+        pairsPtr[2 * i + 1] = numBlocks - 1 - 2 * i;
+    }
+    kernels::invokeCopyBlocks(*srcDevice, *dstDevice, *pairs, numCopies, stream);
+
+    auto dstHost = manager.copyFrom(*dstDevice, MemoryType::kCPU);
+    auto dstHostPtr = bufferCast<std::int32_t>(*dstHost);
+    SizeType32 numMismatches{0};
+    for (SizeType32 block = 0; block < numBlocks; ++block)
+    {
+        auto const mirrored = numBlocks - 1 - block;
+        auto const srcBlock = mirrored % 2 == 0 && mirrored / 2 < numCopies ? mirrored : -1;
+        for (SizeType32 idx = 0; idx < eltsPerBlock; ++idx)
+        {
+            auto const expected = srcBlock < 0 ? -1 : srcHostPtr[srcBlock * eltsPerBlock + idx];
+            numMismatches += dstHostPtr[block * eltsPerBlock + idx] != expected;
+        }
+    }
+    EXPECT_EQ(numMismatches, 0);
+}
+} // namespace
+
+TEST_F(RuntimeKernelTest, CopyBlocks)
+{
+    // 16-byte and 4-byte vectors
+    testCopyBlocks(16, 1024, *mManager, *mStream);
+    testCopyBlocks(9, 3, *mManager, *mStream);
+}
+
+TEST_F(RuntimeKernelTest, CopyBlocksBeyondGridLimit)
+{
+    // More copies than the 65535 CTAs of the grid y dimension.
+    testCopyBlocks(2 * 70000 + 1, 4, *mManager, *mStream);
+}
+
+namespace
+{
+void testQuantizeBlocks(nvinfer1::DataType quantType, float relTolerance, BufferManager& manager, CudaStream& stream)
+{
+    SizeType32 constexpr numBlocks{4};
+    SizeType32 constexpr eltsPerBlock{4 * kernels::kBlockQuantGroupSize};
+    auto const quantBlockSize = static_cast<SizeType32>(kernels::getQuantizedBlockSize(eltsPerBlock, quantType));
+
+    auto srcHost = BufferManager::cpu(ITensor::makeShape({numBlocks, eltsPerBlock}), nvinfer1::DataType::kFLOAT);
+    auto srcHostPtr = bufferCast<float>(*srcHost);
+    for (SizeType32 i = 0; i < numBlocks * eltsPerBlock; ++i)
+    {
+        // Vary the magnitude across groups to exercise per-group scales.
+        auto const group = i / kernels::kBlockQuantGroupSize;
+        srcHostPtr[i] = static_cast<float>((i % 17) - 8) * static_cast<float>(1 << (group % 4));
+    }
+    auto srcDevice = manager.copyFrom(*srcHost, MemoryType::kGPU);
+    auto quantPool = BufferManager::pinned(ITensor::makeShape({numBlocks, quantBlockSize}), nvinfer1::DataType::kUINT8);
+    auto dstDevice = manager.gpu(ITensor::makeShape({numBlocks, eltsPerBlock}), nvinfer1::DataType::kFLOAT);
+    kernels::invokeFill(*dstDevice, 0.f, stream);
+
+    // Quantize blocks 0, 2 into 1, 3 and restore them into blocks 3, 1.
+    auto pairs = BufferManager::pinned(ITensor::makeShape({2, 2}), nvinfer1::DataType::kINT32);
+    auto pairsPtr = bufferCast<std::int32_t>(*pairs);
+    pairsPtr[0] = 0;
+    pairsPtr[1] = 1;
+    pairsPtr[2] = 2;
+    pairsPtr[3] = 3;
+    kernels::invokeQuantizeBlocks(*srcDevice, *quantPool, quantType, *pairs, 2, stream);
+    stream.synchronize();
+    pairsPtr[0] = 1;
+    pairsPtr[1] = 3;
+    pairsPtr[2] = 3;
+    pairsPtr[3] = 1;
+    kernels::invokeDequantizeBlocks(*quantPool, *dstDevice, quantType, *pairs, 2, stream);
+
+    auto dstHost = manager.copyFrom(*dstDevice, MemoryType::kCPU);
+    auto dstHostPtr = bufferCast<float>(*dstHost);
+    for (SizeType32 block = 0; block < numBlocks; ++block)
+    {
+        auto const refBlock = block == 3 ? 0 : (block == 1 ? 2 : -1);
+        for (SizeType32 idx = 0; idx < eltsPerBlock; ++idx)
+        {
+            auto const out = dstHostPtr[block * eltsPerBlock + idx];
+            if (refBlock < 0)
+            {
+                EXPECT_EQ(out, 0.f) << "Error at block " << block << " index " << idx;
+                continue;
+            }
+            auto const ref = srcHostPtr[refBlock * eltsPerBlock + idx];
+            EXPECT_NEAR(out, ref, std::abs(ref) * relTolerance + 1e-6f)
+                << "Error at block " << block << " index " << idx;
+        }
+    }
+}
+} // namespace
+
+TEST_F(RuntimeKernelTest, QuantizeBlocksInt8)
+{
+    // Rounding error is at most half a step of amax / 127, below 4% of the smallest non-zero magnitude.
+    testQuantizeBlocks(nvinfer1::DataType::kINT8, 0.07f, *mManager, *mStream);
+}
+
+#ifdef ENABLE_FP8
+TEST_F(RuntimeKernelTest, QuantizeBlocksFp8)
+{
+    testQuantizeBlocks(nvinfer1::DataType::kFP8, 0.07f, *mManager, *mStream);
+}
+#endif // ENABLE_FP8
+
+TEST_F(RuntimeKernelTest, InitNewRequests)
+{
+    SizeType32 constexpr maxBatchSize{4};
+    SizeType32 constexpr maxBeamWidth{2};
+    SizeType32 constexpr maxSequenceLength{16};
+    SizeType32 constexpr maxTokensPerStep{2};
+    SizeType32 constexpr vocabSizePadded{8};
+    auto constexpr nvTokenIdType = TRTDataType<TokenIdType>::value;
+    auto constexpr nvSizeType = TRTDataType<SizeType32>::value;
+    auto constexpr nvFloatType = TRTDataType<float>::value;
+
+    auto const batchBeams = ITensor::makeShape({maxBatchSize, maxBeamWidth});
+    auto const batchBeamTokens = ITensor::makeShape({maxBatchSize, maxBeamWidth, maxSequenceLength});
+    auto const stepBatchBeams = ITensor::makeShape({maxTokensPerStep, maxBatchSize, maxBeamWidth});
+    TensorPtr endIds = mManager->gpu(batchBeams, nvTokenIdType);
+    TensorPtr sequenceLimitLength = mManager->gpu(ITensor::makeShape({maxBatchSize}), nvSizeType);
+    TensorPtr lengths = mManager->gpu(batchBeams, nvSizeType);
+    TensorPtr embeddingBias = mManager->gpu(ITensor::makeShape({maxBatchSize, vocabSizePadded}), nvFloatType);
+    TensorPtr outputIds = mManager->gpu(batchBeamTokens, nvTokenIdType);
+    TensorPtr parentIds = mManager->gpu(batchBeamTokens, nvTokenIdType);
+    TensorPtr finishedSum = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvSizeType);
+    TensorPtr newTokensSteps = mManager->gpu(stepBatchBeams, nvTokenIdType);
+    TensorPtr finishedSteps = mManager->gpu(stepBatchBeams, nvinfer1::DataType::kUINT8);
+    TensorPtr cumLogProbs = mManager->gpu(batchBeams, nvFloatType);
+    TensorPtr logProbs = mManager->gpu(batchBeamTokens, nvFloatType);
+    // Leftovers of previous requests
+    for (auto const& tensor : {endIds, sequenceLimitLength, lengths, outputIds, parentIds, newTokensSteps})
+    {
+        kernels::invokeFill(*tensor, SizeType32{7}, *mStream);
+    }
+    for (auto const& tensor : {embeddingBias, cumLogProbs, logProbs})
+    {
+        kernels::invokeFill(*tensor, 7.f, *mStream);
+    }
+    mManager->setMem(*finishedSteps, 7);
+    std::fill_n(bufferCast<SizeType32>(*finishedSum), maxBatchSize, 7);
+
+    std::vector<TokenIdType> const inputIds{11, 12, 13};
+    auto const inputIdsDevice = mManager->copyFrom(inputIds, MemoryType::kGPU);
+
+    // A beam search request with log probs in slot 1, a sampling request with an embedding bias in slot 3
+    std::vector<kernels::DecoderNewRequest> requests(2);
+    requests[0] = {bufferCast<TokenIdType>(*inputIdsDevice), 3, 1, 3, 10, 2, 99, true, true, true};
+    requests[1] = {bufferCast<TokenIdType>(*inputIdsDevice), 2, 3, 2, 12, 1, 98, false, false, false};
+    auto requestsDevice = mManager->gpu(requests.size() * sizeof(kernels::DecoderNewRequest));
+    mManager->copy(requests.data(), *requestsDevice, MemoryType::kCPU);
+
+    kernels::DecoderSlotBuffers buffers{bufferCast<TokenIdType>(*endIds), bufferCast<SizeType32>(*sequenceLimitLength),
+        bufferCast<SizeType32>(*lengths), bufferCast<float>(*embeddingBias), bufferCast<TokenIdType>(*outputIds),
+        bufferCast<TokenIdType>(*parentIds), bufferCast<SizeType32>(*finishedSum),
+        bufferCast<TokenIdType>(*newTokensSteps), bufferCast<std::uint8_t>(*finishedSteps),
+        bufferCast<float>(*cumLogProbs), bufferCast<float>(*logProbs), maxBatchSize, maxBeamWidth, maxSequenceLength,
+        maxTokensPerStep, vocabSizePadded, -1e20f};
+    kernels::invokeInitNewRequests(reinterpret_cast<kernels::DecoderNewRequest const*>(requestsDevice->data()),
+        static_cast<SizeType32>(requests.size()), buffers, *mStream);
+
+    auto const endIdsHost = mManager->copyFrom(*endIds, MemoryType::kCPU);
+    auto const limitsHost = mManager->copyFrom(*sequenceLimitLength, MemoryType::kCPU);
+    auto const lengthsHost = mManager->copyFrom(*lengths, MemoryType::kCPU);
+    auto const biasHost = mManager->copyFrom(*embeddingBias, MemoryType::kCPU);
+    auto const outputIdsHost = mManager->copyFrom(*outputIds, MemoryType::kCPU);
+    auto const parentIdsHost = mManager->copyFrom(*parentIds, MemoryType::kCPU);
+    auto const newTokensHost = mManager->copyFrom(*newTokensSteps, MemoryType::kCPU);
+    auto const finishedStepsHost = mManager->copyFrom(*finishedSteps, MemoryType::kCPU);
+    auto const cumLogProbsHost = mManager->copyFrom(*cumLogProbs, MemoryType::kCPU);
+    auto const logProbsHost = mManager->copyFrom(*logProbs, MemoryType::kCPU);
+    mStream->synchronize();
+
+    auto const* endIdsPtr = bufferCast<TokenIdType>(*endIdsHost);
+    auto const* limitsPtr = bufferCast<SizeType32>(*limitsHost);
+    auto const* lengthsPtr = bufferCast<SizeType32>(*lengthsHost);
+    auto const* biasPtr = bufferCast<float>(*biasHost);
+    auto const* outputIdsPtr = bufferCast<TokenIdType>(*outputIdsHost);
+    auto const* parentIdsPtr = bufferCast<TokenIdType>(*parentIdsHost);
+    auto const* newTokensPtr = bufferCast<TokenIdType>(*newTokensHost);
+    auto const* finishedStepsPtr = bufferCast<std::uint8_t>(*finishedStepsHost);
+    auto const* cumLogProbsPtr = bufferCast<float>(*cumLogProbsHost);
+    auto const* logProbsPtr = bufferCast<float>(*logProbsHost);
+    auto const* finishedSumPtr = bufferCast<SizeType32>(*finishedSum);
+
+    for (SizeType32 slot = 0; slot < maxBatchSize; ++slot)
+    {
+        auto const* request = slot == 1 ? &requests[0] : slot == 3 ? &requests[1] : nullptr;
+        EXPECT_EQ(limitsPtr[slot], request ? request->sequenceLimitLength : 7) << "slot " << slot;
+        EXPECT_EQ(finishedSumPtr[slot], request ? 0 : 7) << "slot " << slot;
+        for (SizeType32 beam = 0; beam < maxBeamWidth; ++beam)
+        {
+            auto const idx = slot * maxBeamWidth + beam;
+            EXPECT_EQ(endIdsPtr[idx], request ? request->endId : 7) << "slot " << slot;
+            EXPECT_EQ(lengthsPtr[idx], request ? request->inputLength : 7) << "slot " << slot;
+            auto const expectedCumLogProb = slot != 1 ? 7.f : beam == 0 ? 0.f : -1e20f;
+            EXPECT_EQ(cumLogProbsPtr[idx], expectedCumLogProb) << "slot " << slot << " beam " << beam;
+            for (SizeType32 step = 0; step < maxTokensPerStep; ++step)
+            {
+                auto const stepIdx = (step * maxBatchSize + slot) * maxBeamWidth + beam;
+                EXPECT_EQ(newTokensPtr[stepIdx], request ? 0 : 7) << "slot " << slot;
+                EXPECT_EQ(finishedStepsPtr[stepIdx], request ? 0 : 7) << "slot " << slot;
+            }
+            for (SizeType32 pos = 0; pos < maxSequenceLength; ++pos)
+            {
+                auto const tokenIdx = idx * maxSequenceLength + pos;
+                auto expectedId = 7;
+                if (request && beam < request->beamWidth)
+                {
+                    expectedId = pos < request->inputIdsLength ? inputIds[pos] : request->endId;
+                }
+                EXPECT_EQ(outputIdsPtr[tokenIdx], expectedId) << "slot " << slot << " beam " << beam << " pos " << pos;
+                auto const expectedParentId = slot == 1 ? 0 : 7;
+                EXPECT_EQ(parentIdsPtr[tokenIdx], expectedParentId) << "slot " << slot;
+                EXPECT_EQ(logProbsPtr[tokenIdx], slot == 1 ? 0.f : 7.f) << "slot " << slot;
+            }
+        }
+        for (SizeType32 token = 0; token < vocabSizePadded; ++token)
+        {
+            EXPECT_EQ(biasPtr[slot * vocabSizePadded + token], slot == 1 ? 0.f : 7.f) << "slot " << slot;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/startupProfiler.h"
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+namespace tensorrt_llm::runtime
+{
+
+TEST(StartupProfiler, phases)
+{
+    StartupProfiler profiler;
+    auto const begin = StartupProfiler::Clock::now();
+    profiler.record(StartupPhase::kCONTEXT_CREATION, begin, begin + std::chrono::milliseconds{3});
+    profiler.record(StartupPhase::kCONTEXT_CREATION, begin, begin + std::chrono::milliseconds{2});
+    {
+        auto const scope = profiler.scope(StartupPhase::kXQA_JIT);
+    }
+
+    auto const contexts = profiler.getPhaseStats(StartupPhase::kCONTEXT_CREATION);
+    EXPECT_EQ(contexts.count, 2U);
+    EXPECT_NEAR(contexts.totalMs, 5.0, 1e-6);
+    EXPECT_GE(contexts.lastEndMs, 3.0);
+    EXPECT_EQ(profiler.getPhaseStats(StartupPhase::kXQA_JIT).count, 1U);
+    EXPECT_EQ(profiler.getPhaseStats(StartupPhase::kCUDA_GRAPH_CAPTURE).count, 0U);
+    EXPECT_GE(profiler.getElapsedMs(), 0.0);
+
+    auto const json = nlohmann::json::parse(profiler.toJsonStr());
+    EXPECT_EQ(json.size(), StartupProfiler::kNumPhases);
+    EXPECT_EQ(json["context_creation"]["count"], 2);
+    EXPECT_NEAR(json["context_creation"]["totalMs"].get<double>(), 5.0, 1e-6);
+    EXPECT_NE(profiler.report().find("engine_deserialization"), std::string::npos);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -67,6 +67,29 @@ TEST_F(TllmBuffersTest, Stream)
     EXPECT_EQ(lease.get(), ptr->get());
 }
 
+TEST_F(TllmBuffersTest, StreamPriority)
+{
+    if (mDeviceCount == 0)
+        GTEST_SKIP();
+
+    int leastPriority{0};
+    int greatestPriority{0};
+    TLLM_CUDA_CHECK(cudaDeviceGetStreamPriorityRange(&leastPriority, &greatestPriority));
+    EXPECT_EQ(CudaStream::getCudaPriority(StreamPriority::kNORMAL), 0);
+
+    for (auto const priority : {StreamPriority::kLOW, StreamPriority::kNORMAL, StreamPriority::kHIGH})
+    {
+        CudaStream stream{priority};
+        int streamPriority{0};
+        TLLM_CUDA_CHECK(cudaStreamGetPriority(stream.get(), &streamPriority));
+        EXPECT_EQ(streamPriority, CudaStream::getCudaPriority(priority));
+        EXPECT_GE(streamPriority, greatestPriority);
+        EXPECT_LE(streamPriority, leastPriority);
+    }
+    // Lower numbers are higher priorities
+    EXPECT_LE(CudaStream::getCudaPriority(StreamPriority::kHIGH), CudaStream::getCudaPriority(StreamPriority::kLOW));
+}
+
 TEST_F(TllmBuffersTest, CudaAllocator)
 {
     auto constexpr size = 1024;
@@ -117,6 +140,124 @@ TEST_F(TllmBuffersTest, HostAllocator)
     EXPECT_EQ(allocator.getMemoryType(), MemoryType::kCPU);
 }
 
+TEST_F(TllmBuffersTest, TaggedHostAllocations)
+{
+    auto constexpr size = 1024;
+    auto& counters = MemoryCounters::getInstance();
+    counters.resetPeaks();
+    auto constexpr tag = MemoryTag::kLORA_CACHE;
+    EXPECT_EQ(counters.getTagged(tag, MemoryType::kCPU), 0);
+    EXPECT_EQ(MemoryCounters::getCurrentTag(), MemoryTag::kUNTAGGED);
+
+    HostAllocator allocator{};
+    void* first{nullptr};
+    {
+        MemoryCounters::ScopedTag const scope{tag};
+        EXPECT_EQ(MemoryCounters::getCurrentTag(), tag);
+        {
+            MemoryCounters::ScopedTag const nested{MemoryTag::kDECODER};
+            EXPECT_EQ(MemoryCounters::getCurrentTag(), MemoryTag::kDECODER);
+        }
+        EXPECT_EQ(MemoryCounters::getCurrentTag(), tag);
+        first = allocator.allocate(size);
+    }
+    EXPECT_EQ(MemoryCounters::getCurrentTag(), MemoryTag::kUNTAGGED);
+    EXPECT_EQ(counters.getTagged(tag, MemoryType::kCPU), size);
+    EXPECT_EQ(counters.getTaggedPeak(tag, MemoryType::kCPU), size);
+    EXPECT_EQ(counters.getTagged(tag, MemoryType::kGPU), 0);
+
+    // Released outside of the scope, the memory still leaves its tag
+    allocator.deallocate(first, size);
+    EXPECT_EQ(counters.getTagged(tag, MemoryType::kCPU), 0);
+    EXPECT_EQ(counters.getTaggedPeak(tag, MemoryType::kCPU), size);
+    counters.resetPeaks();
+    EXPECT_EQ(counters.getTaggedPeak(tag, MemoryType::kCPU), 0);
+
+    {
+        MemoryCounters::ScopedTag const scope{tag};
+        HostBuffer buffer{size, nvinfer1::DataType::kINT8};
+        EXPECT_EQ(counters.getTagged(tag, MemoryType::kCPU), size);
+        buffer.resize(2 * size);
+        EXPECT_EQ(counters.getTagged(tag, MemoryType::kCPU), 2 * size);
+    }
+    EXPECT_EQ(counters.getTagged(tag, MemoryType::kCPU), 0);
+    // A growing buffer releases its memory before it reallocates
+    EXPECT_EQ(counters.getTaggedPeak(tag, MemoryType::kCPU), 2 * size);
+    EXPECT_EQ(counters.getCpu(), 0);
+}
+
+TEST_F(TllmBuffersTest, TaggedSharedAllocator)
+{
+    auto constexpr size = 1024;
+    auto& counters = MemoryCounters::getInstance();
+    auto constexpr kvTag = MemoryTag::kKV_CACHE;
+    auto constexpr decoderTag = MemoryTag::kDECODER;
+
+    // One allocator serves allocations of different tags, each is released from its own tag
+    HostAllocator allocator{};
+    void* kvPtr{nullptr};
+    void* decoderPtr{nullptr};
+    void* untaggedPtr = allocator.allocate(size);
+    {
+        MemoryCounters::ScopedTag const scope{kvTag};
+        kvPtr = allocator.allocate(size);
+    }
+    {
+        MemoryCounters::ScopedTag const scope{decoderTag};
+        decoderPtr = allocator.allocate(2 * size);
+    }
+    EXPECT_EQ(counters.getTagged(kvTag, MemoryType::kCPU), size);
+    EXPECT_EQ(counters.getTagged(decoderTag, MemoryType::kCPU), 2 * size);
+    EXPECT_EQ(counters.getTagged(MemoryTag::kUNTAGGED, MemoryType::kCPU), size);
+
+    {
+        MemoryCounters::ScopedTag const scope{MemoryTag::kLORA_CACHE};
+        allocator.deallocate(kvPtr, size);
+    }
+    EXPECT_EQ(counters.getTagged(kvTag, MemoryType::kCPU), 0);
+    EXPECT_EQ(counters.getTagged(decoderTag, MemoryType::kCPU), 2 * size);
+    EXPECT_EQ(counters.getTagged(MemoryTag::kLORA_CACHE, MemoryType::kCPU), 0);
+    allocator.deallocate(decoderPtr, 2 * size);
+    EXPECT_EQ(counters.getTagged(decoderTag, MemoryType::kCPU), 0);
+    allocator.deallocate(untaggedPtr, size);
+    EXPECT_EQ(counters.getTagged(MemoryTag::kUNTAGGED, MemoryType::kCPU), 0);
+    EXPECT_EQ(counters.getCpu(), 0);
+}
+
+TEST_F(TllmBuffersTest, TaggedMemoryPoolChunks)
+{
+    auto constexpr chunkSize = 1024;
+    auto& counters = MemoryCounters::getInstance();
+    auto constexpr kvTag = MemoryTag::kKV_CACHE;
+    auto constexpr loraTag = MemoryTag::kLORA_CACHE;
+    {
+        MemoryPool<HostAllocator> pool{chunkSize};
+        void* first{nullptr};
+        void* second{nullptr};
+        {
+            MemoryCounters::ScopedTag const scope{kvTag};
+            first = pool.allocate(chunkSize);
+        }
+        {
+            // Does not fit into the first chunk, so the pool grows under this tag
+            MemoryCounters::ScopedTag const scope{loraTag};
+            second = pool.allocate(chunkSize);
+        }
+        EXPECT_EQ(pool.getReservedSize(), 2 * chunkSize);
+        EXPECT_EQ(counters.getTagged(kvTag, MemoryType::kCPU), chunkSize);
+        EXPECT_EQ(counters.getTagged(loraTag, MemoryType::kCPU), chunkSize);
+
+        // Chunks stay reserved, and attributed, until the pool is destroyed
+        pool.deallocate(first, chunkSize);
+        pool.deallocate(second, chunkSize);
+        EXPECT_EQ(counters.getTagged(kvTag, MemoryType::kCPU), chunkSize);
+        EXPECT_EQ(counters.getTagged(loraTag, MemoryType::kCPU), chunkSize);
+    }
+    EXPECT_EQ(counters.getTagged(kvTag, MemoryType::kCPU), 0);
+    EXPECT_EQ(counters.getTagged(loraTag, MemoryType::kCPU), 0);
+    EXPECT_EQ(counters.getCpu(), 0);
+}
+
 TEST_F(TllmBuffersTest, UVMAllocator)
 {
     auto constexpr size = 1024;
@@ -60,6 +60,28 @@ std::unique_ptr<trt::IHostMemory> buildMnistEngine(trt::ILogger& logger)
     auto config = makeUnique(builder->createBuilderConfig());
     return makeUnique(builder->buildSerializedNetwork(*network, *config));
 }
+
+auto constexpr kREFIT_WEIGHTS_NAME = "weights";
+auto constexpr kREFIT_SIZE = 4;
+
+//! y = x * W, with W refittable
+std::unique_ptr<trt::IHostMemory> buildRefittableEngine(trt::ILogger& logger, std::vector<float> const& weights)
+{
+    auto builder = makeUnique(trt::createInferBuilder(logger));
+    auto const explicitBatch = 1U << static_cast<uint32_t>(trt::NetworkDefinitionCreationFlag::kEXPLICIT_BATCH);
+    auto network = makeUnique(builder->createNetworkV2(explicitBatch));
+    auto* input = network->addInput("x", trt::DataType::kFLOAT, trt::Dims2{1, kREFIT_SIZE});
+    trt::Weights const values{trt::DataType::kFLOAT, weights.data(), static_cast<std::int64_t>(weights.size())};
+    auto* constant = network->addConstant(trt::Dims2{kREFIT_SIZE, kREFIT_SIZE}, values);
+    network->setWeightsName(values, kREFIT_WEIGHTS_NAME);
+    auto* matmul = network->addMatrixMultiply(
+        *input, trt::MatrixOperation::kNONE, *constant->getOutput(0), trt::MatrixOperation::kNONE);
+    matmul->getOutput(0)->setName("y");
+    network->markOutput(*matmul->getOutput(0));
+    auto config = makeUnique(builder->createBuilderConfig());
+    config->setFlag(trt::BuilderFlag::kREFIT);
+    return makeUnique(builder->buildSerializedNetwork(*network, *config));
+}
 } // namespace
 
 using namespace tensorrt_llm::runtime;
@@ -144,3 +166,122 @@ TEST_F(TllmRuntimeTest, SinglePass)
     auto max = std::max_element(output.begin(), output.end());
     EXPECT_NEAR(*max, 0.140218f, 1e-5f);
 }
+
+TEST_F(TllmRuntimeTest, RefitWeights)
+{
+    TllmRuntime mnist{*mSerializedEngine, 1.0F, mLogger};
+    EXPECT_FALSE(mnist.isRefittable());
+
+    std::vector<float> const ones(kREFIT_SIZE * kREFIT_SIZE, 1.F);
+    auto const serializedEngine = buildRefittableEngine(mLogger, ones);
+    ASSERT_NE(serializedEngine, nullptr);
+    TllmRuntime rt{*serializedEngine, 1.0F, mLogger};
+    ASSERT_TRUE(rt.isRefittable());
+    rt.addContext(0);
+
+    auto& manager = rt.getBufferManager();
+    std::vector<float> const x(kREFIT_SIZE, 1.F);
+    TllmRuntime::TensorMap tensorMap{};
+    auto input = manager.copyFrom(x.data(), ITensor::makeShape({1, kREFIT_SIZE}), MemoryType::kGPU);
+    tensorMap.emplace("x", std::shared_ptr<ITensor>{std::move(input)});
+    rt.setInputTensors(0, tensorMap);
+    rt.setOutputTensors(0, tensorMap);
+    auto const run = [&]()
+    {
+        EXPECT_TRUE(rt.executeContext(0));
+        std::vector<float> y(kREFIT_SIZE);
+        manager.copy(*tensorMap.at("y"), y.data());
+        rt.getStream().synchronize();
+        return y;
+    };
+    EXPECT_EQ(run(), std::vector<float>(kREFIT_SIZE, 4.F));
+
+    // The context and its tensors are kept across the refit
+    std::vector<float> doubled(kREFIT_SIZE * kREFIT_SIZE, 2.F);
+    TllmRuntime::TensorMap weights{};
+    weights.emplace(kREFIT_WEIGHTS_NAME,
+        std::shared_ptr<ITensor>{ITensor::wrap(doubled, ITensor::makeShape({kREFIT_SIZE, kREFIT_SIZE}))});
+    rt.refitWeights(weights);
+    EXPECT_EQ(run(), std::vector<float>(kREFIT_SIZE, 8.F));
+
+    TllmRuntime::TensorMap unknown{};
+    unknown.emplace("unknown", weights.at(kREFIT_WEIGHTS_NAME));
+    EXPECT_THROW(rt.refitWeights(unknown), tc::TllmException);
+}
+
+TEST_F(TllmRuntimeTest, ShareEngine)
+{
+    auto owner = std::make_unique<TllmRuntime>(*mSerializedEngine, 1.0F, mLogger);
+    auto const shared = owner->shareEngine();
+    EXPECT_EQ(&owner->getEngine(), &shared->getEngine());
+    EXPECT_NE(&owner->getStream(), &shared->getStream());
+    EXPECT_NE(owner->getEngineBuffer().data(), shared->getEngineBuffer().data());
+    owner->addContext(0);
+    // The engine outlives the runtime that deserialized it
+    owner.reset();
+
+    shared->addContext(0);
+    auto& engine = shared->getEngine();
+    auto& manager = shared->getBufferManager();
+    auto const inputName = engine.getIOTensorName(0);
+    TllmRuntime::TensorMap tensorMap{};
+    auto input = std::shared_ptr<ITensor>{manager.gpu(engine.getTensorShape(inputName), trt::DataType::kFLOAT)};
+    manager.setZero(*input);
+    tensorMap.emplace(inputName, input);
+    shared->setInputTensors(0, tensorMap);
+    shared->setOutputTensors(0, tensorMap);
+    EXPECT_TRUE(shared->executeContext(0));
+    std::vector<float> output(tensorMap.at(engine.getIOTensorName(1))->getSize());
+    manager.copy(*tensorMap.at(engine.getIOTensorName(1)), output.data());
+    shared->getStream().synchronize();
+    EXPECT_NEAR(*std::max_element(output.begin(), output.end()), 0.140218f, 1e-5f);
+}
+
+TEST_F(TllmRuntimeTest, SetEngineBuffer)
+{
+    TllmRuntime first{*mSerializedEngine, 1.0F, mLogger};
+    TllmRuntime second{*mSerializedEngine, 1.0F, mLogger};
+    auto& manager = first.getBufferManager();
+    IBuffer::SharedPtr const sharedBuffer = manager.gpu(first.getDeviceMemorySize());
+    EXPECT_THROW(first.setEngineBuffer(manager.gpu(first.getDeviceMemorySize() - 1)), tc::TllmException);
+    EXPECT_THROW(first.setEngineBuffer(manager.cpu(first.getDeviceMemorySize())), tc::TllmException);
+
+    // Contexts added before and after the buffer is set both use it
+    first.addContext(0);
+    first.setEngineBuffer(sharedBuffer);
+    second.setEngineBuffer(sharedBuffer);
+    second.addContext(0);
+    EXPECT_EQ(first.getEngineBuffer().data(), sharedBuffer->data());
+    EXPECT_EQ(second.getEngineBuffer().data(), sharedBuffer->data());
+    // The views held by the runtimes keep the buffer alive
+    EXPECT_EQ(sharedBuffer.use_count(), 3);
+
+    auto const run = [](TllmRuntime& rt)
+    {
+        auto& engine = rt.getEngine();
+        auto& rtManager = rt.getBufferManager();
+        auto const inputName = engine.getIOTensorName(0);
+        auto const outputName = engine.getIOTensorName(1);
+        TllmRuntime::TensorMap tensorMap{};
+        auto input
+            = std::shared_ptr<ITensor>{rtManager.gpu(engine.getTensorShape(inputName), trt::DataType::kFLOAT)};
+        rtManager.setZero(*input);
+        tensorMap.emplace(inputName, input);
+        rt.setInputTensors(0, tensorMap);
+        rt.setOutputTensors(0, tensorMap);
+        EXPECT_TRUE(rt.executeContext(0));
+        std::vector<float> output(tensorMap.at(outputName)->getSize());
+        rtManager.copy(*tensorMap.at(outputName), output.data());
+        rt.getStream().synchronize();
+        return output;
+    };
+    // The runtimes never run concurrently, so they give the same results as with their own buffers
+    for (auto i = 0; i < 2; ++i)
+    {
+        auto const firstOutput = run(first);
+        auto const secondOutput = run(second);
+        EXPECT_NEAR(*std::min_element(firstOutput.begin(), firstOutput.end()), -0.126409f, 1e-5f);
+        EXPECT_NEAR(*std::max_element(firstOutput.begin(), firstOutput.end()), 0.140218f, 1e-5f);
+        EXPECT_EQ(firstOutput, secondOutput);
+    }
+}
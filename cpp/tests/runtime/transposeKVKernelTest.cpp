@@ -98,7 +98,7 @@ float castTo(__nv_fp8_e4m3 value)
 template <typename T, typename T_DST, typename KVCacheBuffer>
 void verifyKVTransposed(int batchSize, int headsNum, int dimsPerHead, int seqLen, int maxSeqLen, KVCacheBuffer& buffer,
     std::vector<T> const& refKCacheVec, std::vector<T> const& vTransposedCacheVec, bool b8bitKVCache,
-    float kvScaleOrigQuant)
+    std::vector<float> const& kvScalesOrigQuant)
 {
     for (int bi = 0; bi < batchSize; ++bi)
     {
@@ -123,6 +123,7 @@ void verifyKVTransposed(int batchSize, int headsNum, int dimsPerHead, int seqLen
                         T refV = vTransposedCacheVec[refKVIdx];
                         if (b8bitKVCache)
                         {
+                            float const kvScaleOrigQuant = kvScalesOrigQuant[kvScalesOrigQuant.size() > 1 ? hi : 0];
                             refK = castTo<float, T>(castTo<T, float>(refK) * kvScaleOrigQuant);
                             refV = castTo<float, T>(castTo<T, float>(refV) * kvScaleOrigQuant);
                         }
@@ -148,7 +149,7 @@ void verifyKVTransposed(int batchSize, int headsNum, int dimsPerHead, int seqLen
 }
 
 template <typename T, typename T_DST>
-void testTransposeBatch4dPaged(bool multiQueryMode, bool int8KVCache, bool fp8KVCache)
+void testTransposeBatch4dPaged(bool multiQueryMode, bool int8KVCache, bool fp8KVCache, bool kvScalePerHead = false)
 {
     // Fix seed
     srand(42);
@@ -216,12 +217,19 @@ void testTransposeBatch4dPaged(bool multiQueryMode, bool int8KVCache, bool fp8KV
         sinkTokenLen, kvMemoryPool, nullptr, offsetsArray);
 
     float kvScaleOrigQuant = 1.0f;
+    std::vector<float> kvScalesOrigQuant(kvScalePerHead ? headsNum : 1, kvScaleOrigQuant);
     float* kvScaleOrigQuantPtr = nullptr;
     if (int8KVCache || fp8KVCache)
     {
         kvScaleOrigQuant = 0.1f;
-        cudaMalloc(&kvScaleOrigQuantPtr, sizeof(float));
-        cudaMemcpy(kvScaleOrigQuantPtr, &kvScaleOrigQuant, sizeof(float), cudaMemcpyHostToDevice);
+        for (size_t hi = 0; hi < kvScalesOrigQuant.size(); ++hi)
+        {
+            // Different scales per head, the smallest one is used to init the inputs.
+            kvScalesOrigQuant[hi] = kvScaleOrigQuant * (1 + hi);
+        }
+        cudaMalloc(&kvScaleOrigQuantPtr, sizeof(float) * kvScalesOrigQuant.size());
+        cudaMemcpy(kvScaleOrigQuantPtr, kvScalesOrigQuant.data(), sizeof(float) * kvScalesOrigQuant.size(),
+            cudaMemcpyHostToDevice);
     }
     int* sequenceLengths = nullptr;
     cudaMalloc(&sequenceLengths, sizeof(int) * batchSize);
@@ -243,8 +251,8 @@ void testTransposeBatch4dPaged(bool multiQueryMode, bool int8KVCache, bool fp8KV
     KvCacheDataType const cache_type
         = int8KVCache ? KvCacheDataType::INT8 : (fp8KVCache ? KvCacheDataType::FP8 : KvCacheDataType::BASE);
     invokeTranspose4dBatchMajor(bufferCast<T>(*kTransposedCache), bufferCast<T>(*vTransposedCache), blockArray,
-        batchSize, seqLen, maxSeqLen, dimsPerHead, headsNum, cache_type, kvScaleOrigQuantPtr, sequenceLengths,
-        streamPtr->get());
+        batchSize, seqLen, maxSeqLen, dimsPerHead, headsNum, cache_type, kvScaleOrigQuantPtr, kvScalePerHead,
+        sequenceLengths, streamPtr->get());
 
     // Synchronize
     streamPtr->synchronize();
@@ -260,7 +268,7 @@ void testTransposeBatch4dPaged(bool multiQueryMode, bool int8KVCache, bool fp8KV
     blockArrayHost.data = offsetsHost.data();
 
     verifyKVTransposed<T, T_DST>(batchSize, headsNum, dimsPerHead, seqLen, maxSeqLen, blockArrayHost,
-        kTransposedCacheVec, vTransposedCacheVec, int8KVCache || fp8KVCache, kvScaleOrigQuant);
+        kTransposedCacheVec, vTransposedCacheVec, int8KVCache || fp8KVCache, kvScalesOrigQuant);
 
     cudaFree(sequenceLengths);
     if (int8KVCache || fp8KVCache)
@@ -324,8 +332,8 @@ void testTransposeBatch4dContiguous(bool multiQueryMode, bool int8KVCache, bool
     KvCacheDataType const cache_type
         = int8KVCache ? KvCacheDataType::INT8 : (fp8KVCache ? KvCacheDataType::FP8 : KvCacheDataType::BASE);
     invokeTranspose4dBatchMajor(bufferCast<T>(*kTransposedCache), bufferCast<T>(*vTransposedCache), kvLinearBuffer,
-        batchSize, seqLen, maxSeqLen, dimsPerHead, headsNum, cache_type, kvScaleOrigQuantPtr, sequenceLengths,
-        streamPtr->get());
+        batchSize, seqLen, maxSeqLen, dimsPerHead, headsNum, cache_type, kvScaleOrigQuantPtr,
+        /*kvScalePerHead=*/false, sequenceLengths, streamPtr->get());
 
     // Synchronize
     streamPtr->synchronize();
@@ -339,7 +347,7 @@ void testTransposeBatch4dContiguous(bool multiQueryMode, bool int8KVCache, bool
     kvLinearBufferHost.data = reinterpret_cast<int8_t*>(kvMemoryPoolHost.data());
 
     verifyKVTransposed<T, T_DST>(batchSize, headsNum, dimsPerHead, seqLen, maxSeqLen, kvLinearBufferHost,
-        kTransposedCacheVec, vTransposedCacheVec, int8KVCache || fp8KVCache, kvScaleOrigQuant);
+        kTransposedCacheVec, vTransposedCacheVec, int8KVCache || fp8KVCache, {kvScaleOrigQuant});
 
     cudaFree(sequenceLengths);
     if (int8KVCache || fp8KVCache)
@@ -370,11 +378,21 @@ TEST(AttentionKernelTest, transposeBatch4dPagedInt8)
     testTransposeBatch4dPaged<float, int8_t>(false, true, false);
 }
 
+TEST(AttentionKernelTest, transposeBatch4dPagedInt8PerHeadScales)
+{
+    testTransposeBatch4dPaged<float, int8_t>(false, true, false, true);
+}
+
 #ifdef ENABLE_FP8
 TEST(AttentionKernelTest, transposeBatch4dPagedFp8)
 {
     testTransposeBatch4dPaged<float, __nv_fp8_e4m3>(false, false, true);
 }
+
+TEST(AttentionKernelTest, transposeBatch4dPagedFp8PerHeadScales)
+{
+    testTransposeBatch4dPaged<float, __nv_fp8_e4m3>(false, false, true, true);
+}
 #endif
 
 TEST(AttentionKernelTest, transposeBatch4dContiguousFloat)
@@ -18,6 +18,13 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
 namespace tensorrt_llm::runtime
 {
 
@@ -68,4 +75,79 @@ TEST(WorkerPool, voidReturn)
     EXPECT_EQ(returnVal2, 10002);
     EXPECT_EQ(returnVal3, 10003);
 }
+TEST(WorkerPool, exception)
+{
+    WorkerPool pool(2);
+
+    auto f = pool.enqueue([]() -> int { throw std::runtime_error("task failed"); });
+    EXPECT_THROW(f.get(), std::runtime_error);
+
+    // A posted task that throws doesn't take its worker down
+    pool.post([]() { throw std::runtime_error("task failed"); });
+    EXPECT_EQ(pool.enqueue([]() { return 1; }).get(), 1);
+}
+
+TEST(WorkerPool, manySmallTasks)
+{
+    WorkerPool pool(4);
+
+    auto constexpr numTasks = 10000;
+    std::atomic<int> count{0};
+    for (int i = 0; i < numTasks; ++i)
+    {
+        pool.post([&count]() { count.fetch_add(1); }, static_cast<TaskPriority>(i % WorkerPool::kNumPriorities));
+    }
+    // Tasks submitted by a worker go to its own queue and can be stolen
+    auto nested = pool.enqueue([&pool, &count]() { return pool.enqueue([&count]() { return count.load(); }); });
+    EXPECT_GE(nested.get().get(), 0);
+
+    while (count.load() < numTasks)
+    {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(count.load(), numTasks);
+}
+
+TEST(WorkerPool, priorityLanes)
+{
+    WorkerPool pool(1);
+
+    std::promise<void> gate;
+    auto blocked = gate.get_future().share();
+    pool.post([blocked]() { blocked.wait(); });
+
+    std::vector<int> order;
+    std::mutex orderMutex;
+    auto record = [&order, &orderMutex](int value)
+    {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        order.push_back(value);
+    };
+    pool.post([&record]() { record(2); }, TaskPriority::kLOW);
+    pool.post([&record]() { record(1); }, TaskPriority::kNORMAL);
+    pool.post([&record]() { record(0); }, TaskPriority::kHIGH);
+    gate.set_value();
+    pool.enqueue([]() {}, TaskPriority::kLOW).get();
+
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+}
+
+TEST(WorkerPool, smallBufferTask)
+{
+    int value = 0;
+    WorkerTask small{[&value]() { value = 1; }};
+    EXPECT_TRUE(small.isInline());
+    WorkerTask moved{std::move(small)};
+    EXPECT_FALSE(small);
+    moved();
+    EXPECT_EQ(value, 1);
+
+    std::array<char, WorkerTask::kInlineSize + 1> payload{};
+    payload.back() = 2;
+    WorkerTask large{[&value, payload]() { value = payload.back(); }};
+    EXPECT_FALSE(large.isInline());
+    moved = std::move(large);
+    moved();
+    EXPECT_EQ(value, 2);
+}
 } // namespace tensorrt_llm::runtime